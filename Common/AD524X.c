@@ -168,3 +168,86 @@ void AD524XSetRDAC2Midscale(void)
 
     *instructionByte &= 0b10111111;
 }
+
+
+/**
+ * Initializes the descriptor of a device, its RDACs and outputs are written
+ * by the first AD524XWrite().
+ * @param device Descriptor of the device.
+ * @param address #AD524X_DEVICE_A0 to #AD524X_DEVICE_A3.
+ */
+void AD524XInit(tAD524X *device, unsigned char address)
+{
+    device->Address = AD524X_DEVICE_ADDRESS | (address & 0x03);
+    device->Valid = 0;
+}
+
+/**
+ * Forgets the values programmed, i.e. after a power cycle of the device.
+ * @param device Descriptor of the device.
+ */
+void AD524XInvalidate(tAD524X *device)
+{
+    device->Valid = 0;
+}
+
+/**
+ * Sets both RDACs and the outputs of a device, writing only what changed.
+ * The outputs are part of every instruction byte, so they go with the RDAC
+ * writes. When both RDACs change they are written in one transaction, the
+ * second instruction after a repeated start as the device needs a new
+ * address for every instruction.
+ * @param device Descriptor of the device.
+ * @param rdac1 Value of the RDAC 1.
+ * @param rdac2 Value of the RDAC 2, not used by the AD5241.
+ * @param outputs #AD524X_OUTPUT1 and #AD524X_OUTPUT2 bits, set for high.
+ */
+void AD524XWrite(tAD524X *device,
+                 unsigned char rdac1,
+                 unsigned char rdac2,
+                 unsigned char outputs)
+{
+    unsigned char messages[4];
+    unsigned char changed = 0;
+
+    outputs &= AD524X_OUTPUT1 | AD524X_OUTPUT2;
+
+    if (!(device->Valid & 0x01) || device->RDAC[0] != rdac1)
+        changed |= 0x01;
+    if (!(device->Valid & 0x02) || device->RDAC[1] != rdac2)
+        changed |= 0x02;
+    if (!(device->Valid & 0x04) || device->Outputs != outputs)
+        changed |= 0x04;
+
+    if (changed == 0)
+        return;
+
+    I2CDeviceSetDeviceAddress(device->Address);
+
+    if ((changed & 0x03) == 0x03)
+    {
+        messages[0] = outputs;
+        messages[1] = rdac1;
+        messages[2] = AD524X_RDAC2 | outputs;
+        messages[3] = rdac2;
+        I2CDeviceWriteMessages(2, 2, messages);
+    }
+    else if (changed & 0x01)
+    {
+        I2CDeviceWriteByte(outputs, rdac1);
+    }
+    else if (changed & 0x02)
+    {
+        I2CDeviceWriteByte(AD524X_RDAC2 | outputs, rdac2);
+    }
+    else
+    {
+        //only the outputs, an instruction byte without data
+        I2CDeviceWriteBytes(outputs, 0, 0x00);
+    }
+
+    device->RDAC[0] = rdac1;
+    device->RDAC[1] = rdac2;
+    device->Outputs = outputs;
+    device->Valid = 0x07;
+}
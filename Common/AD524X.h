@@ -37,6 +37,29 @@
 /**Standard device address*/
 #define AD524X_DEVICE_ADDRESS   0b00101100
 
+/**Bits of the instruction byte.*/
+#define AD524X_RDAC2            0b10000000
+#define AD524X_MIDSCALE         0b01000000
+/**Outputs for AD524XWrite().*/
+#define AD524X_OUTPUT1          0b00010000
+#define AD524X_OUTPUT2          0b00001000
+
+/**
+ * A device with the values it was programmed with, so that only the changes
+ * are written.
+ */
+typedef struct
+{
+    /**Address of the device NOT SHIFTED.*/
+    unsigned char Address;
+    unsigned char RDAC[2];
+    /**AD524X_OUTPUT1 and AD524X_OUTPUT2 bits.*/
+    unsigned char Outputs;
+    /**Bit 0 and 1 set when RDAC 1 or 2 has its value, bit 2 for the
+     outputs.*/
+    unsigned char Valid;
+} tAD524X;
+
 void AD524XSetDeviceAddress(unsigned char address);
 void AD524XSetRDAC1Value(unsigned char value);
 void AD524XSetRDAC2Value(unsigned char value);
@@ -46,5 +69,11 @@ void AD524XClearOutput1(void);
 void AD524XClearOutput2(void);
 void AD524XSetRDAC1Midscale(void);
 void AD524XSetRDAC2Midscale(void);
+void AD524XInit(tAD524X *device, unsigned char address);
+void AD524XWrite(tAD524X *device,
+                 unsigned char rdac1,
+                 unsigned char rdac2,
+                 unsigned char outputs);
+void AD524XInvalidate(tAD524X *device);
 
 #endif	/* AD5241_H */
@@ -13,6 +13,14 @@
 
 unsigned char ADXL345Buffer[6];
 
+/** Ring of the samples drained from the FIFO*/
+static tADXL345Sample ADXL345Ring[ADXL345_SAMPLE_RING_SIZE];
+static unsigned char ADXL345RingHead;
+static unsigned char ADXL345RingTail;
+static unsigned int ADXL345RingOverruns;
+/** Data rate of the stream, for the timestamps*/
+static unsigned char ADXL345StreamRate;
+
 /**
  * Power on and prepare for general usage.
  * This will activate the accelerometer, so be sure to adjust the power settings
@@ -21,12 +29,19 @@ unsigned char ADXL345Buffer[6];
  */
 void ADXL345Initialize(void)
 {
-    // reset all power settings
-    I2CDeviceWriteByte(ADXL345_RA_POWER_CTL, 0);
-    ADXL345SetAutoSleepEnabled(true);
-    ADXL345SetMeasureEnabled(true);
-    ADXL345SetFullResolution(1);
-    ADXL345SetRange(ADXL345_RANGE_16G);
+    // reset all power settings, then auto sleep and measure, in one write
+    I2CDeviceWriteByte(ADXL345_RA_POWER_CTL,
+                       REGISTER_BIT_MASK(ADXL345_PCTL_AUTOSLEEP_BIT) |
+                       REGISTER_BIT_MASK(ADXL345_PCTL_MEASURE_BIT));
+    // full resolution and range together
+    I2CDeviceUpdateByte(ADXL345_RA_DATA_FORMAT,
+                        REGISTER_BIT_MASK(ADXL345_FORMAT_FULL_RES_BIT) |
+                        REGISTER_FIELD_MASK(ADXL345_FORMAT_RANGE_BIT,
+                                            ADXL345_FORMAT_RANGE_LENGTH),
+                        REGISTER_BIT_MASK(ADXL345_FORMAT_FULL_RES_BIT) |
+                        REGISTER_FIELD_VALUE(ADXL345_FORMAT_RANGE_BIT,
+                                             ADXL345_FORMAT_RANGE_LENGTH,
+                                             ADXL345_RANGE_16G));
 }
 
 /**
@@ -1841,6 +1856,23 @@ void ADXL345GetAcceleration(int* x, int* y, int* z)
     *z = (((int) ADXL345Buffer[5]) << 8) | ADXL345Buffer[4];
 }
 
+/**
+ * Get the tilt from the gravity, with the sensor at rest. The angles come
+ * from the CORDIC of FixedMath.c, without atan() and sqrt().
+ * @param pitch Rotation about the Y axis, the X axis up is positive
+ * @param roll Rotation about the X axis, 0 with the Z axis up
+ * @see ADXL345GetAcceleration()
+ */
+void ADXL345GetTilt(tFixedAngle *pitch, tFixedAngle *roll)
+{
+    int x, y, z;
+
+    ADXL345GetAcceleration(&x, &y, &z);
+
+    *pitch = FixedMathAtan2(x, (int32_t) FixedMathMagnitude(y, z));
+    *roll = FixedMathAtan2(y, z);
+}
+
 /**
  * Get X-axis accleration measurement.
  * @return 16-bit signed X-axis acceleration value
@@ -1999,12 +2031,12 @@ void ADXL345SetFIFOSamples(unsigned char size)
  * A 1 in the FIFO_TRIG bit corresponds to a trigger event occurring, and a 0
  * means that a FIFO trigger event has not occurred.
  * @return FIFO trigger occurred status
- * @see ADXL345_RA_FIFO_CTL
+ * @see ADXL345_RA_FIFO_STATUS
  * @see ADXL345_FIFOSTAT_TRIGGER_BIT
  */
 boolean ADXL345GetFIFOTriggerOccurred(void)
 {
-    return I2CDeviceReadBit(ADXL345_RA_FIFO_CTL,
+    return I2CDeviceReadBit(ADXL345_RA_FIFO_STATUS,
                             ADXL345_FIFOSTAT_TRIGGER_BIT);
 }
 
@@ -2018,13 +2050,126 @@ boolean ADXL345GetFIFOTriggerOccurred(void)
  * available at any given time because an additional entry is available at the
  * output filter of the I2CDevice
  * @return Current FIFO length
- * @see ADXL345_RA_FIFO_CTL
+ * @see ADXL345_RA_FIFO_STATUS
  * @see ADXL345_FIFOSTAT_LENGTH_BIT
  * @see ADXL345_FIFOSTAT_LENGTH_LENGTH
  */
 unsigned char ADXL345GetFIFOLength(void)
 {
-    return I2CDeviceReadBits(ADXL345_RA_FIFO_CTL,
+    return I2CDeviceReadBits(ADXL345_RA_FIFO_STATUS,
                              ADXL345_FIFOSTAT_LENGTH_BIT,
                              ADXL345_FIFOSTAT_LENGTH_LENGTH);
 }
+
+/**
+ * Start the FIFO in stream mode with the watermark interrupt, for
+ * ADXL345FIFODrain().
+ * @param rate Data rate, ADXL345_RATE_3200 to ADXL345_RATE_0P10
+ * @param watermark FIFO entries that trigger the interrupt (1 - 31)
+ * @param pin Interrupt pin of the watermark (0 = INT1, 1 = INT2)
+ * @see ADXL345FIFODrain()
+ */
+void ADXL345FIFOStreamBegin(unsigned char rate, unsigned char watermark,
+                            unsigned char pin)
+{
+    ADXL345StreamRate = rate & 0x0F;
+    ADXL345RingHead = 0;
+    ADXL345RingTail = 0;
+
+    ADXL345SetRate(ADXL345StreamRate);
+    // bypass clears the FIFO, the watermark and the stream mode go together
+    ADXL345SetFIFOMode(ADXL345_FIFO_MODE_BYPASS);
+    I2CDeviceUpdateByte(ADXL345_RA_FIFO_CTL,
+                        REGISTER_FIELD_MASK(ADXL345_FIFO_MODE_BIT,
+                                            ADXL345_FIFO_MODE_LENGTH) |
+                        REGISTER_FIELD_MASK(ADXL345_FIFO_SAMPLES_BIT,
+                                            ADXL345_FIFO_SAMPLES_LENGTH),
+                        REGISTER_FIELD_VALUE(ADXL345_FIFO_MODE_BIT,
+                                             ADXL345_FIFO_MODE_LENGTH,
+                                             ADXL345_FIFO_MODE_STREAM) |
+                        REGISTER_FIELD_VALUE(ADXL345_FIFO_SAMPLES_BIT,
+                                             ADXL345_FIFO_SAMPLES_LENGTH,
+                                             watermark));
+    ADXL345SetIntWatermarkPin(pin);
+    ADXL345SetIntWatermarkEnabled(true);
+}
+
+/**
+ * Drain the FIFO into the ring of samples.
+ * FIFO_STATUS is read once and then every entry is read with a 6 byte burst
+ * from DATAX0, which pops it. The timestamps are those of the data rate,
+ * backwards from the newest sample, taken at timestamp. Call it from a task
+ * after the watermark interrupt, not from the interrupt itself (the I2C is
+ * blocking). The samples that don't fit in the ring are lost, see
+ * ADXL345SampleOverruns().
+ * @param timestamp Time of the watermark interrupt in microseconds
+ * @return Number of samples read from the FIFO
+ * @see ADXL345FIFOStreamBegin()
+ */
+unsigned char ADXL345FIFODrain(unsigned long timestamp)
+{
+    unsigned char entries = ADXL345GetFIFOLength();
+    unsigned char i;
+    unsigned char next;
+    unsigned char shift = 0x0F - ADXL345StreamRate;
+    tADXL345Sample *sample;
+
+    for (i = 0; i < entries; i++)
+    {
+        // the burst has to be read even if there is no room, to pop it
+        I2CDeviceReadBytes(ADXL345_RA_DATAX0, 6, ADXL345Buffer);
+
+        next = (ADXL345RingHead + 1) & (ADXL345_SAMPLE_RING_SIZE - 1);
+
+        if (next == ADXL345RingTail)
+        {
+            ADXL345RingOverruns++;
+            continue;
+        }
+
+        sample = &ADXL345Ring[ADXL345RingHead];
+        sample->x = (((int) ADXL345Buffer[1]) << 8) | ADXL345Buffer[0];
+        sample->y = (((int) ADXL345Buffer[3]) << 8) | ADXL345Buffer[2];
+        sample->z = (((int) ADXL345Buffer[5]) << 8) | ADXL345Buffer[4];
+        // 312.5 us at 3200 Hz, doubling at every rate below
+        sample->timestamp = timestamp -
+                ((((unsigned long) (entries - 1 - i) * 625u) << shift) >> 1);
+        ADXL345RingHead = next;
+    }
+
+    return entries;
+}
+
+/**
+ * Take the oldest sample of the ring.
+ * @param sample Where the sample is copied
+ * @return true if there was a sample
+ */
+boolean ADXL345SampleRead(tADXL345Sample *sample)
+{
+    if (ADXL345RingTail == ADXL345RingHead)
+        return false;
+
+    *sample = ADXL345Ring[ADXL345RingTail];
+    ADXL345RingTail = (ADXL345RingTail + 1) & (ADXL345_SAMPLE_RING_SIZE - 1);
+
+    return true;
+}
+
+/**
+ * Get the number of samples in the ring.
+ * @return Samples waiting for ADXL345SampleRead()
+ */
+unsigned char ADXL345SampleCount(void)
+{
+    return (ADXL345RingHead - ADXL345RingTail) & (ADXL345_SAMPLE_RING_SIZE - 1);
+}
+
+/**
+ * Get the number of samples lost because the ring was full.
+ * @return Samples lost since the start
+ */
+unsigned int ADXL345SampleOverruns(void)
+{
+    return ADXL345RingOverruns;
+}
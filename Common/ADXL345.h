@@ -13,6 +13,7 @@
 
 #include "stdboolean.h"
 #include "I2CDevice.h"
+#include "FixedMath.h"
 
 #define ADXL345_ADDRESS             0x53
 
@@ -140,6 +141,22 @@
 #define ADXL345_FIFOSTAT_LENGTH_BIT         5
 #define ADXL345_FIFOSTAT_LENGTH_LENGTH      6
 
+/** Number of samples of the ring filled by ADXL345FIFODrain(), a power of 2*/
+#ifndef ADXL345_SAMPLE_RING_SIZE
+#define ADXL345_SAMPLE_RING_SIZE            64
+#endif
+
+/**
+ * Sample of the ring, with the time it was taken in microseconds.
+ */
+typedef struct
+{
+    int x;
+    int y;
+    int z;
+    unsigned long timestamp;
+} tADXL345Sample;
+
 void ADXL345Initialize(void);
 unsigned char ADXL345GetDeviceID(void);
 unsigned char ADXL345GetTapThreshold(void);
@@ -266,6 +283,7 @@ void ADXL345SetDataJustification(unsigned char justification);
 unsigned char ADXL345GetRange(void);
 void ADXL345SetRange(unsigned char range);
 void ADXL345GetAcceleration(int* x, int* y, int* z);
+void ADXL345GetTilt(tFixedAngle *pitch, tFixedAngle *roll);
 int ADXL345GetAccelerationX(void);
 int ADXL345GetAccelerationY(void);
 int ADXL345GetAccelerationZ(void);
@@ -277,6 +295,12 @@ unsigned char ADXL345GetFIFOSamples(void);
 void ADXL345SetFIFOSamples(unsigned char size);
 boolean ADXL345GetFIFOTriggerOccurred(void);
 unsigned char ADXL345GetFIFOLength(void);
+void ADXL345FIFOStreamBegin(unsigned char rate, unsigned char watermark,
+                            unsigned char pin);
+unsigned char ADXL345FIFODrain(unsigned long timestamp);
+boolean ADXL345SampleRead(tADXL345Sample *sample);
+unsigned char ADXL345SampleCount(void);
+unsigned int ADXL345SampleOverruns(void);
 
 
 
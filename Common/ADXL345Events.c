@@ -0,0 +1,178 @@
+/**
+ *  @file       ADXL345Events.c
+ *  @author     Luis Maduro
+ *  @version    1.00
+ *  @date       14/10/2026
+ *  @brief      Interrupt driven events of the ADXL345 (tap, double tap,
+ *              activity, inactivity, free fall).
+ *
+ *  Copyright (C) 2026  Luis Maduro
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <stddef.h>
+#include "ADXL345Events.h"
+
+static tI2CTransaction transaction;
+static unsigned char source;
+static unsigned char enabled;
+static uKernelTaskDescriptor *eventTask;
+/**An edge came while INT_SOURCE was being read, read it again.*/
+static volatile unsigned char again;
+
+/**Events counted by the interrupt, and the counts already taken.*/
+static volatile unsigned char posted[8];
+static unsigned char taken[8];
+static unsigned int errors;
+
+static void ADXL345EventsReadDone(tI2CTransaction *done);
+
+/**
+ * Enables the events on the INT1 pin. The thresholds and times of the
+ * events are configured before with the driver of the chip, and the
+ * interrupt of the pin must call ADXL345EventsInterrupt().
+ * @param task Task signaled on the events, UKERNEL_EVENT usually.
+ * @param events ADXL345_EVENT_SINGLE_TAP..., ADXL345_EVENT_MOTION for all.
+ */
+void ADXL345EventsInit(uKernelTaskDescriptor *task, unsigned char events)
+{
+    unsigned char i;
+
+    eventTask = task;
+    enabled = events;
+    again = 0;
+    errors = 0;
+
+    for (i = 0; i < 8; i++)
+    {
+        posted[i] = 0;
+        taken[i] = 0;
+    }
+
+    transaction.deviceAddress = ADXL345_ADDRESS;
+    transaction.registerAddress = ADXL345_RA_INT_SOURCE;
+    transaction.direction = I2C_Direction_Receiver;
+    transaction.length = 1;
+    transaction.data = &source;
+    transaction.callback = ADXL345EventsReadDone;
+    transaction.status = I2C_TRANSACTION_IDLE;
+
+    I2CDeviceSetDeviceAddress(ADXL345_ADDRESS);
+    //all on INT1
+    I2CDeviceWriteByte(ADXL345_RA_INT_MAP,
+                       I2CDeviceReadByte(ADXL345_RA_INT_MAP) & ~events);
+    I2CDeviceWriteByte(ADXL345_RA_INT_ENABLE,
+                       I2CDeviceReadByte(ADXL345_RA_INT_ENABLE) | events);
+    //events that came before are dropped
+    I2CDeviceReadByte(ADXL345_RA_INT_SOURCE);
+}
+
+/**
+ * Gives the edge of the INT1 pin, to call from its interrupt at the same
+ * priority as the I2C interrupt.
+ */
+void ADXL345EventsInterrupt(void)
+{
+    if (transaction.status == I2C_TRANSACTION_BUSY)
+    {
+        again = 1;
+        return;
+    }
+
+    if (I2CDeviceStartTransaction(&transaction))
+        errors++;
+}
+
+/**
+ * Callback of the read of INT_SOURCE, from the I2C interrupt.
+ */
+static void ADXL345EventsReadDone(tI2CTransaction *done)
+{
+    unsigned char events = source & enabled;
+    unsigned char i;
+
+    if (done->status != I2C_TRANSACTION_DONE)
+    {
+        errors++;
+        events = 0;
+    }
+
+    done->status = I2C_TRANSACTION_IDLE;
+
+    if (events && (eventTask != NULL))
+        uKernelSignal(eventTask);
+
+    for (i = 0; events; i++, events >>= 1)
+    {
+        if (events & 1)
+            posted[i]++;
+    }
+
+    if (again)
+    {
+        again = 0;
+
+        if (I2CDeviceStartTransaction(&transaction))
+            errors++;
+    }
+}
+
+/**
+ * Takes the events that came since the last call, from the event task.
+ * @return ADXL345_EVENT_SINGLE_TAP... of the events, 0 if none.
+ */
+unsigned char ADXL345EventsTake(void)
+{
+    unsigned char events = 0;
+    unsigned char count;
+    unsigned char i;
+
+    for (i = 0; i < 8; i++)
+    {
+        count = posted[i];
+
+        if (count != taken[i])
+        {
+            taken[i] = count;
+            events |= 1 << i;
+        }
+    }
+
+    return events;
+}
+
+/**
+ * Number of times an event came since ADXL345EventsInit(), modulo 256. Two
+ * events of the same kind between two ADXL345EventsTake() (i.e. two taps)
+ * are seen by the difference of the counts.
+ * @param event ADXL345_EVENT_SINGLE_TAP... one of them.
+ */
+unsigned char ADXL345EventsCount(unsigned char event)
+{
+    unsigned char i = 0;
+
+    while ((event >>= 1) != 0)
+        i++;
+
+    return posted[i];
+}
+
+/**
+ * Number of reads of INT_SOURCE that failed, their events are lost.
+ */
+unsigned int ADXL345EventsErrors(void)
+{
+    return errors;
+}
@@ -0,0 +1,66 @@
+/**
+ *  @file       ADXL345Events.h
+ *  @author     Luis Maduro
+ *  @version    1.00
+ *  @date       14/10/2026
+ *  @brief      Interrupt driven events of the ADXL345 (tap, double tap,
+ *              activity, inactivity, free fall).
+ *
+ *  The interrupt of the INT pin calls ADXL345EventsInterrupt(), which
+ *  queues a read of INT_SOURCE on the interrupt driven I2C
+ *  (I2CDeviceStartTransaction()). The read clears the events in the chip,
+ *  its callback decodes all the bits that are set and signals the event
+ *  task with uKernelSignal(). The task takes the events with
+ *  ADXL345EventsTake(). Nothing polls the chip, the processor can sleep in
+ *  UKERNEL_IDLE() until the next motion.
+ *
+ *  Every event has a counter incremented by the interrupt and a copy of it
+ *  kept by the task, so the events are passed without disabling the
+ *  interrupts and an event that comes while the task runs is not lost.
+ *
+ *  The pin is active high, level: the data ready, watermark and overrun
+ *  bits are only cleared by reading the data, don't enable them with the
+ *  events (or read the data in the task) or the pin stays high. The PIC18F
+ *  queued I2C engine is needed, the STM32F1 I2CDevice has none.
+ *
+ *  Copyright (C) 2026  Luis Maduro
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef ADXL345EVENTS_H
+#define ADXL345EVENTS_H
+
+#include "ADXL345.h"
+#include "uKernel/uKernel.h"
+
+/**Events, the bits of INT_SOURCE and INT_ENABLE.*/
+#define ADXL345_EVENT_SINGLE_TAP    (1 << ADXL345_INT_SINGLE_TAP_BIT)
+#define ADXL345_EVENT_DOUBLE_TAP    (1 << ADXL345_INT_DOUBLE_TAP_BIT)
+#define ADXL345_EVENT_ACTIVITY      (1 << ADXL345_INT_ACTIVITY_BIT)
+#define ADXL345_EVENT_INACTIVITY    (1 << ADXL345_INT_INACTIVITY_BIT)
+#define ADXL345_EVENT_FREE_FALL     (1 << ADXL345_INT_FREE_FALL_BIT)
+#define ADXL345_EVENT_MOTION        (ADXL345_EVENT_SINGLE_TAP | \
+                                     ADXL345_EVENT_DOUBLE_TAP | \
+                                     ADXL345_EVENT_ACTIVITY | \
+                                     ADXL345_EVENT_INACTIVITY | \
+                                     ADXL345_EVENT_FREE_FALL)
+
+void ADXL345EventsInit(uKernelTaskDescriptor *task, unsigned char events);
+void ADXL345EventsInterrupt(void);
+unsigned char ADXL345EventsTake(void);
+unsigned char ADXL345EventsCount(unsigned char event);
+unsigned int ADXL345EventsErrors(void);
+
+#endif
@@ -0,0 +1,77 @@
+/**
+ *  @file       AccessRAM.h
+ *  @brief      Placement of the most used variables in the access bank of
+ *              the PIC18.
+ *  @author     Luis Maduro
+ *  @version    1.00
+ *  @date       14/10/2026
+ *
+ *  The PIC18 reaches a variable of the access bank without selecting its
+ *  bank in BSR first. The other variables take a MOVLB before each access
+ *  from a function that used another bank, and the interrupts do not know
+ *  the bank at their entry. The qualifiers of this file put the variables of
+ *  the ISRs and of the main loop of the library there, with XC8 only: its
+ *  __near qualifier asks for the access bank (--ADDRQUAL=request, the
+ *  default, or require to get an error when the bank is full). With any
+ *  other compiler, or ACCESS_RAM_LEVEL at 0, they are empty.
+ *
+ *  The access bank is 96 bytes on the PIC18F K parts, less the temporaries
+ *  of the compiler and of the interrupt context, so the level is chosen for
+ *  the part and the rest of the application:
+ *  - 1, ACCESS_RAM_KERNEL: _counterMs, the current task, the mask of the
+ *    ready priorities and the signal indices of uKernel.c, 9 bytes;
+ *  - 2, ACCESS_RAM_DRIVER as well: the state of the I2C and SPI transfers
+ *    of the interrupts of PIC18F/, 6 bytes more.
+ *  The application places its own variables, i.e. a tSPSCFIFO of an ISR,
+ *  with ACCESS_RAM.
+ *
+ *  The qualifiers go where a const would go, in the definitions and the
+ *  extern declarations, after the '*' for a pointer:
+ *  @code
+ *  static uKernelTaskDescriptor * ACCESS_RAM_KERNEL pTaskCurrent;
+ *  @endcode
+ *
+ *  Copyright (C) 2026  Luis Maduro
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef ACCESSRAM_H
+#define ACCESSRAM_H
+
+/**Variables of the library in the access bank, 0 for none, defined by
+ the project of a PIC18.*/
+#ifndef ACCESS_RAM_LEVEL
+#define ACCESS_RAM_LEVEL            0
+#endif
+
+#if defined(__XC8) && (ACCESS_RAM_LEVEL > 0)
+#define ACCESS_RAM                  __near
+#else
+#define ACCESS_RAM
+#endif
+
+#if ACCESS_RAM_LEVEL >= 1
+#define ACCESS_RAM_KERNEL           ACCESS_RAM
+#else
+#define ACCESS_RAM_KERNEL
+#endif
+
+#if ACCESS_RAM_LEVEL >= 2
+#define ACCESS_RAM_DRIVER           ACCESS_RAM
+#else
+#define ACCESS_RAM_DRIVER
+#endif
+
+#endif /* ACCESSRAM_H */
@@ -0,0 +1,365 @@
+/**
+ *  @file       DriverBenchmark.c
+ *  @brief      Workloads of the drivers, run on the target.
+ *  @author     Luis Maduro
+ *  @version    1.00
+ *  @date       14/10/2026
+ *
+ *  Copyright (C) 2026  Luis Maduro
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <stdbool.h>
+#include "DriverBenchmark.h"
+#include "uCFIFO/uFIFO.h"
+
+#ifdef BENCHMARK_I2C
+#include "I2CDevice.h"
+#endif
+#ifdef BENCHMARK_SD
+#include "SDCardRaw.h"
+#endif
+#ifdef BENCHMARK_FLASH
+#include "SST25VF064C.h"
+#endif
+#ifdef BENCHMARK_MRF24J
+#include "MRF24J.h"
+#endif
+#ifdef BENCHMARK_RFM23
+#include "RFM23.h"
+#endif
+
+/**Bytes of the FIFO of the FIFO workload.*/
+#define BENCHMARK_FIFO_SIZE         128
+/**Bytes moved through the FIFO per chunk size.*/
+#define BENCHMARK_FIFO_BYTES        65536UL
+
+#if defined(BENCHMARK_SD) && (BENCHMARK_BUFFER_SIZE < 512 * BENCHMARK_SD_CHUNK)
+#error "DriverBenchmark: BENCHMARK_BUFFER_SIZE too small for BENCHMARK_SD_CHUNK"
+#endif
+#if defined(BENCHMARK_FLASH) && (BENCHMARK_BUFFER_SIZE < FLASH_PAGE_SIZE)
+#error "DriverBenchmark: BENCHMARK_BUFFER_SIZE too small for a flash page"
+#endif
+
+static unsigned char buffer[BENCHMARK_BUFFER_SIZE];
+static char line[80];
+
+/**
+ * Puts a string at the end of the line.
+ * @return Length of the line.
+ */
+static unsigned char BenchmarkAppend(unsigned char length, const char *text)
+{
+    while ((*text != '\0') && (length < sizeof (line) - 1))
+    {
+        line[length++] = *text++;
+    }
+
+    line[length] = '\0';
+
+    return length;
+}
+
+/**
+ * Puts ',' and the decimal digits of a value at the end of the line.
+ * @return Length of the line.
+ */
+static unsigned char BenchmarkAppendNumber(unsigned char length, uint32_t value)
+{
+    char digits[11];
+    unsigned char i = sizeof (digits) - 1;
+
+    digits[i] = '\0';
+    do
+    {
+        digits[--i] = (char) ('0' + value % 10);
+        value /= 10;
+    } while (value != 0);
+
+    length = BenchmarkAppend(length, ",");
+
+    return BenchmarkAppend(length, &digits[i]);
+}
+
+/**
+ * Prints the line of a result.
+ * @param workload Name of the workload.
+ * @param size Parameter of the workload.
+ * @param operations Operations done.
+ * @param bytes Bytes moved.
+ * @param start BenchmarkMicros() at the start.
+ */
+static void BenchmarkResult(const char *workload, uint32_t size,
+                            uint32_t operations, uint32_t bytes,
+                            uint32_t start)
+{
+    uint32_t us = BenchmarkMicros() - start;
+    unsigned char length;
+
+    length = BenchmarkAppend(0, "bench," BENCHMARK_PLATFORM ",");
+    length = BenchmarkAppend(length, workload);
+    length = BenchmarkAppendNumber(length, size);
+    length = BenchmarkAppendNumber(length, operations);
+    length = BenchmarkAppendNumber(length, bytes);
+    BenchmarkAppendNumber(length, us);
+
+    BenchmarkPrint(line);
+}
+
+#ifdef BENCHMARK_SD
+
+static void BenchmarkError(const char *workload)
+{
+    BenchmarkAppend(BenchmarkAppend(0, "bench_error,"), workload);
+    BenchmarkPrint(line);
+}
+#endif
+
+/**
+ * Puts and gets bytes through a FIFO in chunks of 1, 16 and 64 bytes.
+ */
+static void BenchmarkFIFO(void)
+{
+    static unsigned char storage[BENCHMARK_FIFO_SIZE];
+    static const unsigned char chunks[] = {1, 16, 64};
+    tFIFO fifo;
+    uint32_t start;
+    uint32_t moved;
+    unsigned char i;
+
+    for (i = 0; i < sizeof (chunks); i++)
+    {
+        uFIFOInit(&fifo, storage, sizeof (storage));
+
+        start = BenchmarkMicros();
+        for (moved = 0; moved < BENCHMARK_FIFO_BYTES; moved += chunks[i])
+        {
+            uFIFOPut(&fifo, buffer, chunks[i]);
+            uFIFOGet(&fifo, buffer, chunks[i]);
+        }
+        BenchmarkResult("fifo", chunks[i], BENCHMARK_FIFO_BYTES / chunks[i], moved, start);
+    }
+}
+
+#ifdef BENCHMARK_I2C
+
+/**
+ * Reads bursts of 1, 6, 14 and 32 registers.
+ */
+static void BenchmarkI2C(void)
+{
+    static const unsigned char bursts[] = {1, 6, 14, 32};
+    uint32_t start;
+    unsigned int n;
+    unsigned char i;
+
+    I2CDeviceSetDeviceAddress(BENCHMARK_I2C_ADDRESS);
+
+    for (i = 0; i < sizeof (bursts); i++)
+    {
+        start = BenchmarkMicros();
+        for (n = 0; n < BENCHMARK_REPEAT; n++)
+        {
+            I2CDeviceReadBytes(BENCHMARK_I2C_REGISTER, bursts[i], buffer);
+        }
+        BenchmarkResult("i2c_read", bursts[i], BENCHMARK_REPEAT,
+                        (uint32_t) BENCHMARK_REPEAT * bursts[i], start);
+    }
+}
+#endif
+
+#ifdef BENCHMARK_SD
+
+/**
+ * Writes then reads BENCHMARK_SD_BLOCKS sequential blocks.
+ */
+static void BenchmarkSD(void)
+{
+    uint32_t start;
+    block_t block;
+
+    if (!sd_raw_init())
+    {
+        BenchmarkError("sd");
+        return;
+    }
+
+    start = BenchmarkMicros();
+    for (block = 0; block < BENCHMARK_SD_BLOCKS; block += BENCHMARK_SD_CHUNK)
+    {
+        if (!sd_raw_write_multi(BENCHMARK_SD_FIRST_BLOCK + block, buffer, BENCHMARK_SD_CHUNK))
+        {
+            BenchmarkError("sd_write");
+            return;
+        }
+    }
+    sd_raw_sync();
+    BenchmarkResult("sd_write", 512UL * BENCHMARK_SD_CHUNK, BENCHMARK_SD_BLOCKS / BENCHMARK_SD_CHUNK,
+                    512UL * BENCHMARK_SD_BLOCKS, start);
+
+    start = BenchmarkMicros();
+    for (block = 0; block < BENCHMARK_SD_BLOCKS; block += BENCHMARK_SD_CHUNK)
+    {
+        if (!sd_raw_read_multi(BENCHMARK_SD_FIRST_BLOCK + block, buffer, BENCHMARK_SD_CHUNK))
+        {
+            BenchmarkError("sd_read");
+            return;
+        }
+    }
+    BenchmarkResult("sd_read", 512UL * BENCHMARK_SD_CHUNK, BENCHMARK_SD_BLOCKS / BENCHMARK_SD_CHUNK,
+                    512UL * BENCHMARK_SD_BLOCKS, start);
+}
+#endif
+
+#ifdef BENCHMARK_FLASH
+
+/**
+ * Erases a sector, programs its 16 pages and reads it back.
+ */
+static void BenchmarkFlash(void)
+{
+    uint32_t start;
+    uint32_t address;
+
+    start = BenchmarkMicros();
+    FlashSector4KErase(BENCHMARK_FLASH_ADDRESS);
+    FlashWaitForWrite();
+    BenchmarkResult("flash_erase", FLASH_SECTOR_SIZE, 1, FLASH_SECTOR_SIZE, start);
+
+    start = BenchmarkMicros();
+    for (address = 0; address < FLASH_SECTOR_SIZE; address += FLASH_PAGE_SIZE)
+    {
+        FlashWriteBuffer(BENCHMARK_FLASH_ADDRESS + address, buffer, FLASH_PAGE_SIZE);
+    }
+    FlashWaitForWrite();
+    BenchmarkResult("flash_program", FLASH_PAGE_SIZE, FLASH_SECTOR_SIZE / FLASH_PAGE_SIZE,
+                    FLASH_SECTOR_SIZE, start);
+
+    start = BenchmarkMicros();
+    for (address = 0; address < FLASH_SECTOR_SIZE; address += FLASH_PAGE_SIZE)
+    {
+        FlashReadBuffer(BENCHMARK_FLASH_ADDRESS + address, buffer, FLASH_PAGE_SIZE);
+    }
+    BenchmarkResult("flash_read", FLASH_PAGE_SIZE, FLASH_SECTOR_SIZE / FLASH_PAGE_SIZE,
+                    FLASH_SECTOR_SIZE, start);
+}
+#endif
+
+#ifdef BENCHMARK_MRF24J
+
+/**
+ * Sends packets of 16 and 100 bytes, each one waited until sent.
+ */
+static void BenchmarkMRF24J(void)
+{
+    static const unsigned char sizes[] = {16, 100};
+    uint32_t start;
+    uint32_t sent;
+    unsigned int n;
+    unsigned char i;
+
+    for (i = 0; i < sizeof (sizes); i++)
+    {
+        sent = 0;
+        start = BenchmarkMicros();
+        for (n = 0; n < BENCHMARK_RADIO_PACKETS; n++)
+        {
+            uint32_t wait = BenchmarkMicros();
+
+            MRF24J40SendPacket(0xFFFF, sizes[i], buffer);
+
+            //the interrupt flag, read and cleared by the poll
+            while ((MRF24J40GetInterrupts() & MRF_I_TXNIF) == 0)
+            {
+                if (BenchmarkMicros() - wait > 100000UL)
+                    break;
+            }
+
+            if (BenchmarkMicros() - wait <= 100000UL)
+                sent++;
+        }
+        BenchmarkResult("mrf24j_send", sizes[i], sent, sent * sizes[i], start);
+    }
+}
+#endif
+
+#ifdef BENCHMARK_RFM23
+
+/**
+ * Sends packets of 16 and 60 bytes, each one waited until sent, the
+ * interrupt of the radio has to call RFM2xInterruptHandler().
+ */
+static void BenchmarkRFM23(void)
+{
+    static const unsigned char sizes[] = {16, 60};
+    uint32_t start;
+    uint32_t sent;
+    uint32_t wait;
+    unsigned int n;
+    unsigned char i;
+
+    for (i = 0; i < sizeof (sizes); i++)
+    {
+        sent = 0;
+        start = BenchmarkMicros();
+        for (n = 0; n < BENCHMARK_RADIO_PACKETS; n++)
+        {
+            if (!RFM2xSendPacket(buffer, sizes[i]))
+                continue;
+
+            wait = BenchmarkMicros();
+            while (RFM2xIsSending() && (BenchmarkMicros() - wait < 100000UL));
+
+            if (!RFM2xIsSending())
+                sent++;
+        }
+        BenchmarkResult("rfm23_send", sizes[i], sent, sent * sizes[i], start);
+    }
+}
+#endif
+
+/**
+ * Runs all the workloads built, one line per result.
+ */
+void DriverBenchmarkRun(void)
+{
+    unsigned int i;
+
+    for (i = 0; i < sizeof (buffer); i++)
+    {
+        buffer[i] = (unsigned char) i;
+    }
+
+    BenchmarkPrint("bench,platform,workload,size,operations,bytes,us");
+
+    BenchmarkFIFO();
+#ifdef BENCHMARK_I2C
+    BenchmarkI2C();
+#endif
+#ifdef BENCHMARK_SD
+    BenchmarkSD();
+#endif
+#ifdef BENCHMARK_FLASH
+    BenchmarkFlash();
+#endif
+#ifdef BENCHMARK_MRF24J
+    BenchmarkMRF24J();
+#endif
+#ifdef BENCHMARK_RFM23
+    BenchmarkRFM23();
+#endif
+
+    BenchmarkPrint("bench_end");
+}
@@ -0,0 +1,102 @@
+/**
+ *  @file       DriverBenchmark.h
+ *  @brief      Workloads of the drivers, run on the target.
+ *  @author     Luis Maduro
+ *  @version    1.00
+ *  @date       14/10/2026
+ *
+ *  The same workloads run on the PIC18F and on the STM32F1, from the
+ *  main.c of PIC18F/Benchmark and STM32F1/Benchmark, with the hardware
+ *  connected. The main of the platform gives the time and the output:
+ *  - uint32_t BenchmarkMicros(void), microseconds, wrapping at 2^32;
+ *  - void BenchmarkPrint(const char *line), a line without its end;
+ *  and its BenchmarkConfig.h, found in the include paths, defines the name
+ *  of the platform and the workloads its board has: BENCHMARK_I2C,
+ *  BENCHMARK_SD, BENCHMARK_FLASH, BENCHMARK_MRF24J and BENCHMARK_RFM23.
+ *  The FIFO workload runs without hardware.
+ *
+ *  Every result is one line of comma separated values, after a header:
+ *  @code
+ *  bench,platform,workload,size,operations,bytes,us
+ *  bench,stm32f1,i2c_read,14,1000,14000,118234
+ *  @endcode
+ *  size is the parameter of the workload (bytes of a burst, of a packet, of
+ *  a block), the rates (bytes/s, operations/s) are computed on the host from
+ *  the counts and the time, without floats on the target. A run ends with
+ *  "bench_end". A failed workload prints "bench_error,workload".
+ *
+ *  The SD and the flash workloads write: BENCHMARK_SD_FIRST_BLOCK and
+ *  BENCHMARK_FLASH_ADDRESS must point to space that can be lost.
+ *
+ *  Copyright (C) 2026  Luis Maduro
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef DRIVERBENCHMARK_H
+#define DRIVERBENCHMARK_H
+
+#include <stdint.h>
+#include "BenchmarkConfig.h"
+
+/**Name of the platform in the results.*/
+#ifndef BENCHMARK_PLATFORM
+#define BENCHMARK_PLATFORM          "target"
+#endif
+
+/**Repetitions of the short workloads.*/
+#ifndef BENCHMARK_REPEAT
+#define BENCHMARK_REPEAT            1000
+#endif
+
+/**Device and first register of the I2C bursts, the data registers of the
+ * MPU9150 by default, any register range that reads back works.*/
+#ifndef BENCHMARK_I2C_ADDRESS
+#define BENCHMARK_I2C_ADDRESS       0x68
+#define BENCHMARK_I2C_REGISTER      0x3B
+#endif
+
+/**Blocks of the sequential SD workloads, 2048 for 1 MB, and per call.*/
+#ifndef BENCHMARK_SD_FIRST_BLOCK
+#define BENCHMARK_SD_FIRST_BLOCK    0x100000UL
+#endif
+#ifndef BENCHMARK_SD_BLOCKS
+#define BENCHMARK_SD_BLOCKS         2048
+#endif
+#ifndef BENCHMARK_SD_CHUNK
+#define BENCHMARK_SD_CHUNK          1
+#endif
+
+/**Sector of the SPI flash workloads, erased and programmed.*/
+#ifndef BENCHMARK_FLASH_ADDRESS
+#define BENCHMARK_FLASH_ADDRESS     0x7FF000UL
+#endif
+
+/**Packets of the radio workloads.*/
+#ifndef BENCHMARK_RADIO_PACKETS
+#define BENCHMARK_RADIO_PACKETS     100
+#endif
+
+/**Bytes of the largest buffer, the SD workload needs
+ * 512 * BENCHMARK_SD_CHUNK.*/
+#ifndef BENCHMARK_BUFFER_SIZE
+#define BENCHMARK_BUFFER_SIZE       512
+#endif
+
+uint32_t BenchmarkMicros(void);
+void BenchmarkPrint(const char *line);
+
+void DriverBenchmarkRun(void);
+
+#endif /* DRIVERBENCHMARK_H */
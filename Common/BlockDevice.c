@@ -0,0 +1,506 @@
+/**
+ *  @file       BlockDevice.c
+ *  @author     Luis Maduro
+ *  @version    1.00
+ *  @date       14/10/2026
+ *  @brief      Common block device interface with queued requests, merged
+ *              into multi-block transfers.
+ *
+ *  Copyright (C) 2026  Luis Maduro
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <stddef.h>
+#include "BlockDevice.h"
+
+#ifdef BLOCK_DEVICE_USE_SD_RAW
+#include "SDCardRaw.h"
+#endif
+
+#ifdef BLOCK_DEVICE_USE_SST25
+#include "SST25VF064C.h"
+#endif
+
+/**
+ * Sets up a device with an empty queue.
+ * @param device Device, kept by the application.
+ * @param read Read function of the driver.
+ * @param write Write function of the driver, NULL if it is read only.
+ * @param context For the driver.
+ * @param blockSize Bytes of a block.
+ * @param blockCount Blocks of the medium.
+ * @param maxBlocks Most blocks the driver moves in one call, at least 1.
+ */
+void BlockDeviceInit(tBlockDevice *device, tBlockDeviceTransfer read,
+                     tBlockDeviceTransfer write, void *context,
+                     uint16_t blockSize, uint32_t blockCount,
+                     uint16_t maxBlocks)
+{
+    device->read = read;
+    device->write = write;
+    device->context = context;
+    device->base = 0;
+    device->blockSize = blockSize;
+    device->blockCount = blockCount;
+    device->maxBlocks = maxBlocks;
+    device->queue = NULL;
+    device->last = NULL;
+    device->batch = NULL;
+    device->complete = false;
+    device->failed = false;
+    device->Requests = 0;
+    device->Transfers = 0;
+    device->Merged = 0;
+}
+
+/**
+ * Queues a request, done by BlockDeviceTasks().
+ * @param device Device.
+ * @param request Request, kept by the caller until its callback.
+ * @param write Write or read.
+ * @param block First block.
+ * @param buffer Data of the blocks, not changed (a write) or used (a read)
+ *               until the end of the request.
+ * @param count Blocks, 1 to the maxBlocks of the device.
+ * @param callback Called at the end, can be NULL.
+ * @return False if the blocks are out of the device, if it can't be written
+ *         or if the request is already queued.
+ */
+bool BlockDeviceSubmit(tBlockDevice *device, tBlockRequest *request,
+                       bool write, uint32_t block, uint8_t *buffer,
+                       uint16_t count, tBlockRequestCallback callback)
+{
+    if ((count == 0) || (count > device->maxBlocks)
+        || (block >= device->blockCount)
+        || (count > device->blockCount - block)
+        || (write && (device->write == NULL))
+        || (request->status == BLOCK_REQUEST_QUEUED)
+        || (request->status == BLOCK_REQUEST_ACTIVE))
+    {
+        return false;
+    }
+
+    request->next = NULL;
+    request->block = block;
+    request->buffer = buffer;
+    request->count = count;
+    request->write = write;
+    request->callback = callback;
+    request->status = BLOCK_REQUEST_QUEUED;
+
+    if (device->queue == NULL)
+    {
+        device->queue = request;
+    }
+    else
+    {
+        device->last->next = request;
+    }
+
+    device->last = request;
+    device->Requests++;
+
+    return true;
+}
+
+/**
+ * Tells if a request has to stay after another one: they share a block and
+ * one of them writes it.
+ */
+static bool BlockDeviceConflict(tBlockRequest *a, tBlockRequest *b)
+{
+    if (!a->write && !b->write)
+    {
+        return false;
+    }
+
+    return (a->block < b->block + b->count) && (b->block < a->block + a->count);
+}
+
+/**
+ * Tells if a request can go before the ones queued before it.
+ */
+static bool BlockDeviceCanMove(tBlockDevice *device, tBlockRequest *request)
+{
+    tBlockRequest *r;
+
+    for (r = device->queue; r != request; r = r->next)
+    {
+        if (BlockDeviceConflict(r, request))
+        {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+/**
+ * Takes a request out of the queue.
+ */
+static void BlockDeviceUnlink(tBlockDevice *device, tBlockRequest *request)
+{
+    tBlockRequest *previous = NULL;
+    tBlockRequest *r = device->queue;
+
+    while (r != request)
+    {
+        previous = r;
+        r = r->next;
+    }
+
+    if (previous == NULL)
+    {
+        device->queue = request->next;
+    }
+    else
+    {
+        previous->next = request->next;
+    }
+
+    if (device->last == request)
+    {
+        device->last = previous;
+    }
+
+    request->next = NULL;
+}
+
+/**
+ * Takes the requests of the next transfer out of the queue, and starts it.
+ */
+static void BlockDeviceStart(tBlockDevice *device)
+{
+    tBlockRequest *first;
+    tBlockRequest *tail;
+    tBlockRequest *r;
+    uint32_t end;
+    uint8_t *next;
+    uint16_t count;
+    uint8_t result;
+
+    //the first read that no queued write has to go before, else the oldest
+    first = device->queue;
+
+    for (r = device->queue; r != NULL; r = r->next)
+    {
+        if (!r->write && BlockDeviceCanMove(device, r))
+        {
+            first = r;
+            break;
+        }
+    }
+
+    BlockDeviceUnlink(device, first);
+
+    device->batch = first;
+    tail = first;
+    count = first->count;
+    end = first->block + count;
+    next = first->buffer + (uint32_t) count * device->blockSize;
+
+    //append the requests that go on from the end of the batch, on the
+    //medium and in memory
+    r = device->queue;
+
+    while (r != NULL)
+    {
+        if ((r->write == first->write) && (r->block == end)
+            && (r->buffer == next)
+            && (r->count <= device->maxBlocks - count)
+            && BlockDeviceCanMove(device, r))
+        {
+            BlockDeviceUnlink(device, r);
+            tail->next = r;
+            tail = r;
+            count += r->count;
+            end += r->count;
+            next += (uint32_t) r->count * device->blockSize;
+            device->Merged++;
+
+            //an earlier request can go on from this one
+            r = device->queue;
+        }
+        else
+        {
+            r = r->next;
+        }
+    }
+
+    for (r = first; r != NULL; r = r->next)
+    {
+        r->status = BLOCK_REQUEST_ACTIVE;
+    }
+
+    //an asynchronous driver can end before it returns
+    device->complete = false;
+    device->failed = false;
+    device->Transfers++;
+
+    if (first->write)
+    {
+        result = device->write(device, first->block, first->buffer, count);
+    }
+    else
+    {
+        result = device->read(device, first->block, first->buffer, count);
+    }
+
+    if (result != BLOCK_DEVICE_STARTED)
+    {
+        BlockDeviceComplete(device, result == BLOCK_DEVICE_DONE);
+    }
+}
+
+/**
+ * Ends the requests of the transfer done.
+ */
+static void BlockDeviceEnd(tBlockDevice *device)
+{
+    tBlockRequest *r = device->batch;
+    tBlockRequest *next;
+    tBlockRequestStatus status = device->failed ?
+            BLOCK_REQUEST_FAILED : BLOCK_REQUEST_DONE;
+
+    //a callback can submit a new request
+    device->batch = NULL;
+
+    while (r != NULL)
+    {
+        next = r->next;
+        r->next = NULL;
+        r->status = status;
+
+        if (r->callback != NULL)
+        {
+            r->callback(r);
+        }
+
+        r = next;
+    }
+}
+
+/**
+ * Ends the transfer done and starts the next one, to be called from a task.
+ * @param device Device.
+ * @return True while there are requests not ended.
+ */
+bool BlockDeviceTasks(tBlockDevice *device)
+{
+    if (device->batch != NULL)
+    {
+        if (!device->complete)
+        {
+            return true;
+        }
+
+        BlockDeviceEnd(device);
+    }
+
+    if (device->queue != NULL)
+    {
+        BlockDeviceStart(device);
+
+        if (device->complete)
+        {
+            BlockDeviceEnd(device);
+        }
+    }
+
+    return (device->batch != NULL) || (device->queue != NULL);
+}
+
+/**
+ * End of a transfer started by a driver, it can be called from the
+ * interrupts. The requests are ended by the next BlockDeviceTasks().
+ * @param device Device.
+ * @param ok False if the transfer failed.
+ */
+void BlockDeviceComplete(tBlockDevice *device, bool ok)
+{
+    device->failed = !ok;
+    device->complete = true;
+}
+
+/**
+ * Tells if all the requests are ended.
+ * @param device Device.
+ */
+bool BlockDeviceIdle(tBlockDevice *device)
+{
+    return (device->batch == NULL) && (device->queue == NULL);
+}
+
+/**
+ * Waits for a request, and the ones queued before it.
+ */
+static bool BlockDeviceWait(tBlockDevice *device, tBlockRequest *request)
+{
+    while ((request->status == BLOCK_REQUEST_QUEUED)
+           || (request->status == BLOCK_REQUEST_ACTIVE))
+    {
+        BlockDeviceTasks(device);
+    }
+
+    return request->status == BLOCK_REQUEST_DONE;
+}
+
+/**
+ * Reads blocks, waiting for them.
+ * @param device Device.
+ * @param block First block.
+ * @param buffer Data.
+ * @param count Blocks, 1 to the maxBlocks of the device.
+ * @return False if the read failed or the blocks are out of the device.
+ */
+bool BlockDeviceRead(tBlockDevice *device, uint32_t block, uint8_t *buffer,
+                     uint16_t count)
+{
+    tBlockRequest request;
+
+    request.status = BLOCK_REQUEST_IDLE;
+
+    if (!BlockDeviceSubmit(device, &request, false, block, buffer, count, NULL))
+    {
+        return false;
+    }
+
+    return BlockDeviceWait(device, &request);
+}
+
+/**
+ * Writes blocks, waiting for them.
+ * @param device Device.
+ * @param block First block.
+ * @param buffer Data.
+ * @param count Blocks, 1 to the maxBlocks of the device.
+ * @return False if the write failed, the blocks are out of the device or it
+ *         is read only.
+ */
+bool BlockDeviceWrite(tBlockDevice *device, uint32_t block,
+                      const uint8_t *buffer, uint16_t count)
+{
+    tBlockRequest request;
+
+    request.status = BLOCK_REQUEST_IDLE;
+
+    //the driver doesn't change the data of a write
+    if (!BlockDeviceSubmit(device, &request, true, block, (uint8_t *) buffer,
+                           count, NULL))
+    {
+        return false;
+    }
+
+    return BlockDeviceWait(device, &request);
+}
+
+#ifdef BLOCK_DEVICE_USE_SD_RAW
+
+static uint8_t BlockDeviceSDRawRead(tBlockDevice *device, uint32_t block,
+                                    uint8_t *buffer, uint16_t count)
+{
+    return sd_raw_read_multi(device->base + block, buffer, count) ?
+            BLOCK_DEVICE_DONE : BLOCK_DEVICE_FAILED;
+}
+
+#if SD_RAW_WRITE_SUPPORT
+static uint8_t BlockDeviceSDRawWrite(tBlockDevice *device, uint32_t block,
+                                     uint8_t *buffer, uint16_t count)
+{
+    return sd_raw_write_multi(device->base + block, buffer, count) ?
+            BLOCK_DEVICE_DONE : BLOCK_DEVICE_FAILED;
+}
+#endif
+
+/**
+ * Sets up a device on blocks of 512 bytes of the SD card, initialized with
+ * sd_raw_init() before.
+ * @param device Device.
+ * @param first First block of the card.
+ * @param blocks Blocks of the device, 0 for the rest of the card.
+ * @return False if the card gives no information.
+ */
+bool BlockDeviceInitSDRaw(tBlockDevice *device, uint32_t first,
+                          uint32_t blocks)
+{
+    struct SDCardInfo info;
+
+    if (blocks == 0)
+    {
+        if (!sd_raw_get_info(&info) || (info.blocks <= first))
+        {
+            return false;
+        }
+
+        blocks = info.blocks - first;
+    }
+
+#if SD_RAW_WRITE_SUPPORT
+    BlockDeviceInit(device, BlockDeviceSDRawRead, BlockDeviceSDRawWrite, NULL,
+                    512, blocks, UINT16_MAX);
+#else
+    BlockDeviceInit(device, BlockDeviceSDRawRead, NULL, NULL,
+                    512, blocks, UINT16_MAX);
+#endif
+    device->base = first;
+
+    return true;
+}
+
+#endif
+
+#ifdef BLOCK_DEVICE_USE_SST25
+
+static uint8_t BlockDeviceSST25Read(tBlockDevice *device, uint32_t block,
+                                    uint8_t *buffer, uint16_t count)
+{
+    FlashReadBuffer(device->base + block * FLASH_SECTOR_SIZE, buffer,
+                    count * FLASH_SECTOR_SIZE);
+
+    return BLOCK_DEVICE_DONE;
+}
+
+static uint8_t BlockDeviceSST25Write(tBlockDevice *device, uint32_t block,
+                                     uint8_t *buffer, uint16_t count)
+{
+    uint32_t address = device->base + block * FLASH_SECTOR_SIZE;
+
+    //a block is a sector, erased before it is programmed
+    while (count--)
+    {
+        FlashSector4KErase(address);
+        FlashWriteBuffer(address, buffer, FLASH_SECTOR_SIZE);
+        address += FLASH_SECTOR_SIZE;
+        buffer += FLASH_SECTOR_SIZE;
+    }
+
+    return BLOCK_DEVICE_DONE;
+}
+
+/**
+ * Sets up a device on 4 KB sectors of the SST25VF064C.
+ * @param device Device.
+ * @param address First byte, at the start of a sector.
+ * @param sectors Sectors of the device.
+ */
+void BlockDeviceInitSST25(tBlockDevice *device, uint32_t address,
+                          uint32_t sectors)
+{
+    BlockDeviceInit(device, BlockDeviceSST25Read, BlockDeviceSST25Write, NULL,
+                    FLASH_SECTOR_SIZE, sectors, 16);
+    device->base = address;
+}
+
+#endif
@@ -0,0 +1,187 @@
+/**
+ *  @file       BlockDevice.h
+ *  @author     Luis Maduro
+ *  @version    1.00
+ *  @date       14/10/2026
+ *  @brief      Common block device interface with queued requests, merged
+ *              into multi-block transfers.
+ *
+ *  A tBlockDevice is a medium of blocks of one size with a read and a write
+ *  function: SDCardRaw, the SST25VF064C (in blocks of a 4 KB sector), the
+ *  MAL of the Mass_Storage project (SD card and NAND of the STM32 boards)
+ *  or any other driver wrapped in two functions. The layers above (a cache,
+ *  a logger, a file system) are written once against it.
+ *
+ *  The requests are given by the caller, queued by BlockDeviceSubmit() and
+ *  done by BlockDeviceTasks(), that calls the callback of each one at its
+ *  end. Before a transfer the queue is scheduled:
+ *  - the reads go before the writes, someone waits for a read while a
+ *    write can end later, except a read of a block that a write queued
+ *    before it changes, both keep their order;
+ *  - the requests of the same direction that follow each other on the
+ *    medium, and in memory, are merged into one multi-block transfer (one
+ *    CMD18 or CMD25 of the SD card instead of one command per block), up to
+ *    the maxBlocks of the driver;
+ *  - the writes keep their order.
+ *  The merged requests are ended together.
+ *
+ *  A driver function does the transfer before returning
+ *  (BLOCK_DEVICE_DONE or BLOCK_DEVICE_FAILED), or starts it
+ *  (BLOCK_DEVICE_STARTED) and calls BlockDeviceComplete() at its end, i.e.
+ *  from the interrupt of the DMA. The MAL is wrapped as:
+ *  @code
+ *  static uint8_t MALBlockRead(tBlockDevice *device, uint32_t block,
+ *                              uint8_t *buffer, uint16_t count)
+ *  {
+ *      return MAL_Read(0, block * Mass_Block_Size[0], (uint32_t *) buffer,
+ *                      count * Mass_Block_Size[0]) == MAL_OK ?
+ *              BLOCK_DEVICE_DONE : BLOCK_DEVICE_FAILED;
+ *  }
+ *
+ *  BlockDeviceInit(&card, MALBlockRead, MALBlockWrite, NULL,
+ *                  Mass_Block_Size[0], Mass_Block_Count[0], 64);
+ *  @endcode
+ *
+ *  BlockDeviceSubmit() and BlockDeviceTasks() are called from the tasks,
+ *  not from the interrupts.
+ *
+ *  Copyright (C) 2026  Luis Maduro
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef BLOCKDEVICE_H
+#define BLOCKDEVICE_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+/**Drivers of this library wrapped by BlockDevice.c, uncomment the ones
+ used.*/
+//#define BLOCK_DEVICE_USE_SD_RAW
+//#define BLOCK_DEVICE_USE_SST25
+
+/**Results of the functions of a driver.*/
+#define BLOCK_DEVICE_DONE           0
+#define BLOCK_DEVICE_FAILED         1
+#define BLOCK_DEVICE_STARTED        2
+
+/**
+ * State of a request.
+ */
+typedef enum
+{
+    BLOCK_REQUEST_IDLE,
+    /** In the queue*/
+    BLOCK_REQUEST_QUEUED,
+    /** Being transferred*/
+    BLOCK_REQUEST_ACTIVE,
+    BLOCK_REQUEST_DONE,
+    BLOCK_REQUEST_FAILED
+} tBlockRequestStatus;
+
+struct _tBlockDevice;
+struct _tBlockRequest;
+
+/**
+ * Transfer of a driver.
+ * @param device Device, its context and base for the driver.
+ * @param block First block, of the device.
+ * @param buffer Data, count blocks.
+ * @param count Blocks, 1 to maxBlocks.
+ * @return BLOCK_DEVICE_DONE, BLOCK_DEVICE_FAILED or BLOCK_DEVICE_STARTED.
+ */
+typedef uint8_t (*tBlockDeviceTransfer)(struct _tBlockDevice *device,
+        uint32_t block, uint8_t *buffer, uint16_t count);
+
+/**
+ * End of a request, called by BlockDeviceTasks().
+ * @param request Request, BLOCK_REQUEST_DONE or BLOCK_REQUEST_FAILED.
+ */
+typedef void (*tBlockRequestCallback)(struct _tBlockRequest *request);
+
+/**
+ * A read or a write of blocks, kept by the caller until its end.
+ */
+typedef struct _tBlockRequest
+{
+    struct _tBlockRequest *next;
+    uint32_t block;
+    uint8_t *buffer;
+    uint16_t count;
+    bool write;
+    volatile tBlockRequestStatus status;
+    /** Can be NULL*/
+    tBlockRequestCallback callback;
+    /** For the caller*/
+    void *context;
+} tBlockRequest;
+
+/**
+ * A medium and its queue.
+ */
+typedef struct _tBlockDevice
+{
+    tBlockDeviceTransfer read;
+    /** NULL for a read only medium*/
+    tBlockDeviceTransfer write;
+    /** For the driver*/
+    void *context;
+    /** First block or byte of the region, for the drivers of this library*/
+    uint32_t base;
+    uint16_t blockSize;
+    /** Most blocks of a transfer*/
+    uint16_t maxBlocks;
+    uint32_t blockCount;
+    /** Requests waiting, in the order of submission*/
+    tBlockRequest *queue;
+    tBlockRequest *last;
+    /** Requests of the transfer running*/
+    tBlockRequest *batch;
+    /** The transfer started has ended, and its result*/
+    volatile bool complete;
+    volatile bool failed;
+    /** Requests submitted, transfers done, and requests merged in a
+     transfer of another one*/
+    uint32_t Requests;
+    uint32_t Transfers;
+    uint32_t Merged;
+} tBlockDevice;
+
+void BlockDeviceInit(tBlockDevice *device, tBlockDeviceTransfer read,
+                     tBlockDeviceTransfer write, void *context,
+                     uint16_t blockSize, uint32_t blockCount,
+                     uint16_t maxBlocks);
+bool BlockDeviceSubmit(tBlockDevice *device, tBlockRequest *request,
+                       bool write, uint32_t block, uint8_t *buffer,
+                       uint16_t count, tBlockRequestCallback callback);
+bool BlockDeviceTasks(tBlockDevice *device);
+void BlockDeviceComplete(tBlockDevice *device, bool ok);
+bool BlockDeviceIdle(tBlockDevice *device);
+bool BlockDeviceRead(tBlockDevice *device, uint32_t block, uint8_t *buffer,
+                     uint16_t count);
+bool BlockDeviceWrite(tBlockDevice *device, uint32_t block,
+                      const uint8_t *buffer, uint16_t count);
+
+#ifdef BLOCK_DEVICE_USE_SD_RAW
+bool BlockDeviceInitSDRaw(tBlockDevice *device, uint32_t first,
+                          uint32_t blocks);
+#endif
+
+#ifdef BLOCK_DEVICE_USE_SST25
+void BlockDeviceInitSST25(tBlockDevice *device, uint32_t address,
+                          uint32_t sectors);
+#endif
+
+#endif /* BLOCKDEVICE_H */
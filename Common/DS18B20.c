@@ -69,11 +69,12 @@ bool DS18B20IssueTemperatureConvertion(tLaseredROMCode *device)
 }
 
 /**
- * Gets the value of the temperature from the configured sensor.
- * @param device Pointer to the structure containing the information of the sensor.
+ * Reads the scratchpad of a sensor and converts the temperature.
+ * @param device Sensor, NULL for the only sensor of the bus (Skip ROM).
+ * @param temperature Where the temperature is stored.
  * @return Result of the communication.
  */
-bool DS18B20GetTemperature(tLaseredROMCode *device, float *temperature)
+static bool DS18B20ReadTemperature(tLaseredROMCode *device, float *temperature)
 {
     int int_temp;
     float temp_float;
@@ -82,19 +83,13 @@ bool DS18B20GetTemperature(tLaseredROMCode *device, float *temperature)
     if (OneWireReset() == 0)
         return false;
 
-    OneWireSelect(device);
-    OneWireWrite(READ_SCRATCHPAD);
-    Data[0] = OneWireRead();
-    Data[1] = OneWireRead();
-    Data[2] = OneWireRead();
-    Data[3] = OneWireRead();
-    Data[4] = OneWireRead();
-    Data[5] = OneWireRead();
-    Data[6] = OneWireRead();
-    Data[7] = OneWireRead();
-    Data[8] = OneWireRead();
+    if (device != NULL)
+        OneWireSelect(device);
+    else
+        OneWireSkip();
 
-    if (Data[8] != OneWireCRC8(&Data[0], 8))
+    OneWireWrite(READ_SCRATCHPAD);
+    if (OneWireReadBytesCRC8(Data, 9) != 0)
     {
         return false;
     }
@@ -109,3 +104,182 @@ bool DS18B20GetTemperature(tLaseredROMCode *device, float *temperature)
         return true;
     }
 }
+
+/**
+ * Gets the value of the temperature from the configured sensor.
+ * @param device Pointer to the structure containing the information of the sensor.
+ * @return Result of the communication.
+ */
+bool DS18B20GetTemperature(tLaseredROMCode *device, float *temperature)
+{
+    return DS18B20ReadTemperature(device, temperature);
+}
+
+/**
+ * Issue a temperature convertion to all the sensors of the bus at once
+ * (Skip ROM), they all convert in the time of one. With parasite powered
+ * sensors the bus has to be kept high for the whole convertion time.
+ * @return Returns if all went well.
+ */
+bool DS18B20IssueTemperatureConvertionAll(void)
+{
+    if (OneWireReset() == 0)
+        return false;
+
+    OneWireSkip();
+    OneWireWrite(CONVERT_TEMPERATURE);
+
+    return true;
+}
+
+/**
+ * Checks, without waiting, if the convertion is done. A sensor converting
+ * answers 0 to a read slot, so this is true when all the sensors of the bus
+ * are done. It only works with externally powered sensors, see
+ * DS18B20IsAnyParasitePowered(), the parasite ones need the convertion
+ * time instead.
+ * @return True if the convertion is done.
+ */
+bool DS18B20IsConvertionDone(void)
+{
+    return OneWireReadBit() != 0;
+}
+
+/**
+ * Checks if any sensor of the bus is parasite powered, they pull the bus
+ * low on the read slot after Read Power Supply.
+ * @return True if at least one sensor is parasite powered, or if none
+ *         answered.
+ */
+bool DS18B20IsAnyParasitePowered(void)
+{
+    if (OneWireReset() == 0)
+        return true;
+
+    OneWireSkip();
+    OneWireWrite(READ_POWER_SUPPLY);
+
+    return OneWireReadBit() == 0;
+}
+
+/**
+ * Reads the temperatures of several sensors, after
+ * DS18B20IssueTemperatureConvertionAll() and the convertion time or
+ * DS18B20IsConvertionDone().
+ * @param devices Sensors to read.
+ * @param count Number of sensors.
+ * @param temperatures Where the temperatures are stored, one per sensor.
+ *                     The ones that failed are left as they were.
+ * @return Number of sensors read with a valid CRC.
+ */
+unsigned char DS18B20GetTemperatureAll(tLaseredROMCode *devices,
+                                       unsigned char count,
+                                       float *temperatures)
+{
+    unsigned char i;
+    unsigned char read = 0;
+
+    for (i = 0; i < count; i++)
+    {
+        if (DS18B20ReadTemperature(&devices[i], &temperatures[i]))
+            read++;
+    }
+
+    return read;
+}
+
+/**
+ * Prepares an acquisition. The sensors are asked if any of them is
+ * parasite powered.
+ * @param acquisition Acquisition.
+ * @param devices Sensors, already configured to the resolution.
+ * @param count Number of sensors.
+ * @param temperatures Where the temperatures are stored, one per sensor.
+ * @param resolution Resolution of the sensors, gives the convertion time.
+ * @param callback Called at the end of every acquisition, can be NULL.
+ */
+void DS18B20AcquisitionInit(tDS18B20Acquisition *acquisition,
+                            tLaseredROMCode *devices, unsigned char count,
+                            float *temperatures,
+                            DS18B20Resolution resolution,
+                            tDS18B20Callback callback)
+{
+    acquisition->devices = devices;
+    acquisition->count = count;
+    acquisition->temperatures = temperatures;
+    acquisition->resolution = resolution;
+    acquisition->callback = callback;
+    acquisition->status = DS18B20_ACQUISITION_IDLE;
+    acquisition->read = 0;
+    acquisition->parasite = DS18B20IsAnyParasitePowered();
+}
+
+/**
+ * Issues the convertion and returns at once.
+ * @param acquisition Acquisition.
+ * @return False if no sensor answered.
+ */
+bool DS18B20AcquisitionStart(tDS18B20Acquisition *acquisition)
+{
+    bool issued;
+
+    if (acquisition->count == 1)
+        issued = DS18B20IssueTemperatureConvertion(acquisition->devices);
+    else
+        issued = DS18B20IssueTemperatureConvertionAll();
+
+    acquisition->read = 0;
+    acquisition->start = _counterMs;
+    acquisition->status = issued ? DS18B20_ACQUISITION_CONVERTING :
+            DS18B20_ACQUISITION_ERROR;
+
+    return issued;
+}
+
+/**
+ * Goes on with the acquisition, to be called from a task every few ms. The
+ * end of the convertion is polled with a read slot, or the convertion time
+ * of the resolution waited with parasite powered sensors. A convertion
+ * that goes past twice that time is an error.
+ * @param acquisition Acquisition.
+ * @return State of the acquisition.
+ */
+DS18B20AcquisitionStatus DS18B20AcquisitionPoll(tDS18B20Acquisition *acquisition)
+{
+    uint32_t elapsed;
+    uint32_t time;
+
+    if (acquisition->status != DS18B20_ACQUISITION_CONVERTING)
+        return acquisition->status;
+
+    elapsed = _counterMs - acquisition->start;
+    time = DS18B20_CONVERTION_TIME(acquisition->resolution);
+
+    if (acquisition->parasite)
+    {
+        if (elapsed < time)
+            return acquisition->status;
+    }
+    else if (!DS18B20IsConvertionDone())
+    {
+        if (elapsed < 2 * time)
+            return acquisition->status;
+
+        acquisition->status = DS18B20_ACQUISITION_ERROR;
+
+        if (acquisition->callback != NULL)
+            acquisition->callback(acquisition);
+
+        return acquisition->status;
+    }
+
+    acquisition->read = DS18B20GetTemperatureAll(acquisition->devices,
+                                                 acquisition->count,
+                                                 acquisition->temperatures);
+    acquisition->status = DS18B20_ACQUISITION_DONE;
+
+    if (acquisition->callback != NULL)
+        acquisition->callback(acquisition);
+
+    return acquisition->status;
+}
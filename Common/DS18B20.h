@@ -13,6 +13,7 @@
 #include <stdlib.h>
 #include <stdbool.h>
 #include "OneWire.h"
+#include "uKernel/uKernel.h"
 
 /**
  * @def     READ_ROM_COMMAND
@@ -58,9 +59,79 @@ typedef enum
     DS18B20Resolution_12Bits = 0x7F
 } DS18B20Resolution;
 
+/**
+ * @def     DS18B20_CONVERTION_TIME
+ * @brief   Maximum convertion time in ms of a resolution, 94 ms at 9 bits
+ *          doubling up to 752 ms at 12 bits (750 ms in the datasheet).
+ */
+#define DS18B20_CONVERTION_TIME(resolution) \
+    (94u << (((resolution) >> 5) & 0x03))
+
+/**
+ * State of an acquisition.
+ */
+typedef enum
+{
+    /** Not started*/
+    DS18B20_ACQUISITION_IDLE,
+    /** Waiting for the convertion*/
+    DS18B20_ACQUISITION_CONVERTING,
+    /** Temperatures read, some can have failed the CRC*/
+    DS18B20_ACQUISITION_DONE,
+    /** No sensor answered, or the convertion didn't end in time*/
+    DS18B20_ACQUISITION_ERROR
+} DS18B20AcquisitionStatus;
+
+struct _tDS18B20Acquisition;
+
+/**
+ * Called by DS18B20AcquisitionPoll() at the end of an acquisition.
+ */
+typedef void (*tDS18B20Callback)(struct _tDS18B20Acquisition *acquisition);
+
+/**
+ * Acquisition of the temperature of one or several sensors of a bus,
+ * without waiting: DS18B20AcquisitionStart() issues the convertion and
+ * returns, DS18B20AcquisitionPoll() is called from a task until the
+ * convertion ends, reads the sensors and calls the callback.
+ */
+typedef struct _tDS18B20Acquisition
+{
+    /** Sensors, converted all at once when more than one*/
+    tLaseredROMCode *devices;
+    unsigned char count;
+    /** Where the temperatures are stored, one per sensor*/
+    float *temperatures;
+    /** Resolution the sensors are configured to*/
+    DS18B20Resolution resolution;
+    /** Set if a sensor is parasite powered, the convertion time is always
+     waited then*/
+    bool parasite;
+    tDS18B20Callback callback;
+    /** State of the acquisition*/
+    volatile DS18B20AcquisitionStatus status;
+    /** Number of sensors read with a valid CRC*/
+    unsigned char read;
+    /** Start of the convertion, in ms*/
+    uint32_t start;
+} tDS18B20Acquisition;
+
 
 bool DS18B20Configure(tLaseredROMCode *device, DS18B20Resolution resolution);
 bool DS18B20IssueTemperatureConvertion(tLaseredROMCode *device);
 bool DS18B20GetTemperature(tLaseredROMCode *device, float *temperature);
+bool DS18B20IssueTemperatureConvertionAll(void);
+bool DS18B20IsConvertionDone(void);
+bool DS18B20IsAnyParasitePowered(void);
+unsigned char DS18B20GetTemperatureAll(tLaseredROMCode *devices,
+                                       unsigned char count,
+                                       float *temperatures);
+void DS18B20AcquisitionInit(tDS18B20Acquisition *acquisition,
+                            tLaseredROMCode *devices, unsigned char count,
+                            float *temperatures,
+                            DS18B20Resolution resolution,
+                            tDS18B20Callback callback);
+bool DS18B20AcquisitionStart(tDS18B20Acquisition *acquisition);
+DS18B20AcquisitionStatus DS18B20AcquisitionPoll(tDS18B20Acquisition *acquisition);
 
 #endif
\ No newline at end of file
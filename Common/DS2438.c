@@ -8,8 +8,114 @@
 
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 #include "DS2438.h"
 
+/**
+ * Addresses a device, or all of them.
+ * @param device Device, NULL for all the devices of the bus (Skip ROM).
+ */
+static void DS2438Select(tLaseredROMCode *device)
+{
+    if (device == NULL)
+    {
+        OneWireWriteByte(SKIP_ROM_COMMAND);
+        return;
+    }
+
+    OneWireWriteByte(MATCH_ROM_COMMAND);
+    OneWireWriteByte(device->FamilyCode);
+    OneWireWriteByte(device->ROMCodeByte1);
+    OneWireWriteByte(device->ROMCodeByte2);
+    OneWireWriteByte(device->ROMCodeByte3);
+    OneWireWriteByte(device->ROMCodeByte4);
+    OneWireWriteByte(device->ROMCodeByte5);
+    OneWireWriteByte(device->ROMCodeByte6);
+    OneWireWriteByte(device->OWICRC);
+}
+
+/**
+ * Copies a page of the memory to its scratchpad.
+ * @param device Device, NULL for all the devices of the bus.
+ * @param page Page to recall.
+ * @return Returns false if no device answered.
+ */
+static bool DS2438RecallPage(tLaseredROMCode *device, unsigned char page)
+{
+    if (OneWireReset() == 0)
+        return false;
+
+    DS2438Select(device);
+    OneWireWriteByte(RECALL_E_E);
+    OneWireWriteByte(page);
+
+    return true;
+}
+
+/**
+ * Reads the scratchpad of a page, the CRC is computed as the bytes come in.
+ * @param device Device, NULL for the only device of the bus.
+ * @param page Page to read.
+ * @param data Where the 8 bytes and the CRC are stored.
+ * @return Returns false if no device answered or the CRC is wrong.
+ */
+static bool DS2438ReadPage(tLaseredROMCode *device, unsigned char page,
+                           uint8_t *data)
+{
+    unsigned char crc = 0;
+    unsigned char i;
+    unsigned char j;
+
+    if (OneWireReset() == 0)
+        return false;
+
+    DS2438Select(device);
+    OneWireWriteByte(READ_SCRATCHPAD);
+    OneWireWriteByte(page);
+
+    for (i = 0; i < 9; i++)
+    {
+        data[i] = OneWireReadByte();
+
+        //the CRC of the 8 bytes and the CRC is 0
+        crc ^= data[i];
+        for (j = 0; j < 8; j++)
+            crc = (crc & 0x01) ? (crc >> 1) ^ 0x8C : crc >> 1;
+    }
+
+    return crc == 0;
+}
+
+/**
+ * Converts the registers of the page 0.
+ * @param data Page 0.
+ */
+static void DS2438Decode(const uint8_t *data, float *temperature,
+                         float *voltage, float *current)
+{
+    int16_t temp;
+
+    temp = (int16_t) data[TEMP_MSB];
+    temp <<= 8;
+    temp |= data[TEMP_LSB];
+    *temperature = (float) temp;
+    *temperature *= 0.00390625;
+
+    temp = (int16_t) data[VOLT_MSB];
+    temp <<= 8;
+    temp |= data[VOLT_LSB];
+    *voltage = (float) temp;
+
+    *voltage *= 0.01;
+
+    temp = (int16_t) data[CURR_MSB];
+    temp <<= 8;
+    temp |= data[CURR_LSB];
+    *current = (float) temp;
+
+    *current /= (4096.0 * DS2438_SENSE_RESISTOR);
+}
+
 /**
  * This funtion configures the DS2438 with the specified confguration.
  * @param Config Configuration that will be sent to the DS2438. 
@@ -23,15 +129,7 @@ unsigned char DS2438Configure(tLaseredROMCode device, tDS2438Config Config)
     if (OneWireReset() == 0)
         return false;
 
-    OneWireWriteByte(MATCH_ROM_COMMAND);
-    OneWireWriteByte(device.FamilyCode);
-    OneWireWriteByte(device.ROMCodeByte1);
-    OneWireWriteByte(device.ROMCodeByte2);
-    OneWireWriteByte(device.ROMCodeByte3);
-    OneWireWriteByte(device.ROMCodeByte4);
-    OneWireWriteByte(device.ROMCodeByte5);
-    OneWireWriteByte(device.ROMCodeByte6);
-    OneWireWriteByte(device.OWICRC);
+    DS2438Select(&device);
 
     OneWireWriteByte(WRITE_SCRATCHPAD);
     OneWireWriteByte(DS2438_PAGE_0);
@@ -40,15 +138,7 @@ unsigned char DS2438Configure(tLaseredROMCode device, tDS2438Config Config)
     if (OneWireReset() == 0)
         return false;
 
-    OneWireWriteByte(MATCH_ROM_COMMAND);
-    OneWireWriteByte(device.FamilyCode);
-    OneWireWriteByte(device.ROMCodeByte1);
-    OneWireWriteByte(device.ROMCodeByte2);
-    OneWireWriteByte(device.ROMCodeByte3);
-    OneWireWriteByte(device.ROMCodeByte4);
-    OneWireWriteByte(device.ROMCodeByte5);
-    OneWireWriteByte(device.ROMCodeByte6);
-    OneWireWriteByte(device.OWICRC);
+    DS2438Select(&device);
 
     OneWireWriteByte(READ_SCRATCHPAD);
     OneWireWriteByte(DS2438_PAGE_0);
@@ -68,15 +158,7 @@ unsigned char DS2438Configure(tLaseredROMCode device, tDS2438Config Config)
     if (OneWireReset() == 0)
         return false;
 
-    OneWireWriteByte(MATCH_ROM_COMMAND);
-    OneWireWriteByte(device.FamilyCode);
-    OneWireWriteByte(device.ROMCodeByte1);
-    OneWireWriteByte(device.ROMCodeByte2);
-    OneWireWriteByte(device.ROMCodeByte3);
-    OneWireWriteByte(device.ROMCodeByte4);
-    OneWireWriteByte(device.ROMCodeByte5);
-    OneWireWriteByte(device.ROMCodeByte6);
-    OneWireWriteByte(device.OWICRC);
+    DS2438Select(&device);
 
     OneWireWriteByte(COPY_SCRATCHPAD);
     OneWireWriteByte(DS2438_PAGE_0);
@@ -96,152 +178,147 @@ unsigned char DS2438GetData(tLaseredROMCode *device, float *temperature,
 {
     uint8_t DS2438Data[9] = {0};
 
-    int16_t temp;
-
-    if (OneWireReset() == 0)
+    if (DS2438RecallPage(device, DS2438_PAGE_0) == false)
         return false;
 
-    OneWireWriteByte(MATCH_ROM_COMMAND);
-    OneWireWriteByte(device->FamilyCode);
-    OneWireWriteByte(device->ROMCodeByte1);
-    OneWireWriteByte(device->ROMCodeByte2);
-    OneWireWriteByte(device->ROMCodeByte3);
-    OneWireWriteByte(device->ROMCodeByte4);
-    OneWireWriteByte(device->ROMCodeByte5);
-    OneWireWriteByte(device->ROMCodeByte6);
-    OneWireWriteByte(device->OWICRC);
-    OneWireWriteByte(RECALL_E_E);
-    OneWireWriteByte(DS2438_PAGE_0);
-
-    //read scratchpad
-    if (OneWireReset() == 0)
+    if (DS2438ReadPage(device, DS2438_PAGE_0, DS2438Data) == false)
         return false;
 
-    OneWireWriteByte(MATCH_ROM_COMMAND);
-    OneWireWriteByte(device->FamilyCode);
-    OneWireWriteByte(device->ROMCodeByte1);
-    OneWireWriteByte(device->ROMCodeByte2);
-    OneWireWriteByte(device->ROMCodeByte3);
-    OneWireWriteByte(device->ROMCodeByte4);
-    OneWireWriteByte(device->ROMCodeByte5);
-    OneWireWriteByte(device->ROMCodeByte6);
-    OneWireWriteByte(device->OWICRC);
-    OneWireWriteByte(READ_SCRATCHPAD);
-    OneWireWriteByte(DS2438_PAGE_0);
-    DS2438Data[STATUS] = OneWireReadByte();
-    DS2438Data[TEMP_LSB] = OneWireReadByte();
-    DS2438Data[TEMP_MSB] = OneWireReadByte();
-    DS2438Data[VOLT_LSB] = OneWireReadByte();
-    DS2438Data[VOLT_MSB] = OneWireReadByte();
-    DS2438Data[CURR_LSB] = OneWireReadByte();
-    DS2438Data[CURR_MSB] = OneWireReadByte();
-    DS2438Data[THRESH] = OneWireReadByte();
-    DS2438Data[CRC8] = OneWireReadByte();
+    DS2438Decode(DS2438Data, temperature, voltage, current);
 
-    if (DS2438Data[CRC8] != OneWireCRC8(&DS2438Data[0], 8))
+    if (DS2438RecallPage(device, DS2438_PAGE_1) == false)
         return false;
 
-    temp = (int16_t) DS2438Data[TEMP_MSB];
-    temp <<= 8;
-    temp |= DS2438Data[TEMP_LSB];
-    *temperature = (float) temp;
-    *temperature *= 0.00390625;
-
-    temp = (int16_t) DS2438Data[VOLT_MSB];
-    temp <<= 8;
-    temp |= DS2438Data[VOLT_LSB];
-    *voltage = (float) temp;
-
-    *voltage *= 0.01;
+    if (DS2438ReadPage(device, DS2438_PAGE_1, DS2438Data) == false)
+        return false;
 
-    temp = (int16_t) DS2438Data[CURR_MSB];
-    temp <<= 8;
-    temp |= DS2438Data[CURR_MSB];
-    *current = (float) temp;
+    *energy = (float) DS2438Data[ICA_REG];
+    *energy /= (2048.0 * DS2438_SENSE_RESISTOR);
 
-    *current /= (4096.0 * 0.05);
+    return true;
+}
 
+unsigned char DS2438IssueConvertions(tLaseredROMCode *device)
+{
+    //Convert Temperature
     if (OneWireReset() == 0)
         return false;
 
-    OneWireWriteByte(MATCH_ROM_COMMAND);
-    OneWireWriteByte(device->FamilyCode);
-    OneWireWriteByte(device->ROMCodeByte1);
-    OneWireWriteByte(device->ROMCodeByte2);
-    OneWireWriteByte(device->ROMCodeByte3);
-    OneWireWriteByte(device->ROMCodeByte4);
-    OneWireWriteByte(device->ROMCodeByte5);
-    OneWireWriteByte(device->ROMCodeByte6);
-    OneWireWriteByte(device->OWICRC);
-    OneWireWriteByte(RECALL_E_E);
-    OneWireWriteByte(DS2438_PAGE_1);
+    DS2438Select(device);
+    OneWireWriteByte(CONVERT_TEMPERATURE);
 
-    //read scratchpad
     if (OneWireReset() == 0)
         return false;
 
-    OneWireWriteByte(MATCH_ROM_COMMAND);
-    OneWireWriteByte(device->FamilyCode);
-    OneWireWriteByte(device->ROMCodeByte1);
-    OneWireWriteByte(device->ROMCodeByte2);
-    OneWireWriteByte(device->ROMCodeByte3);
-    OneWireWriteByte(device->ROMCodeByte4);
-    OneWireWriteByte(device->ROMCodeByte5);
-    OneWireWriteByte(device->ROMCodeByte6);
-    OneWireWriteByte(device->OWICRC);
-    OneWireWriteByte(READ_SCRATCHPAD);
-    OneWireWriteByte(DS2438_PAGE_1);
-    DS2438Data[0] = OneWireReadByte();
-    DS2438Data[1] = OneWireReadByte();
-    DS2438Data[2] = OneWireReadByte();
-    DS2438Data[3] = OneWireReadByte();
-    DS2438Data[4] = OneWireReadByte();
-    DS2438Data[5] = OneWireReadByte();
-    DS2438Data[6] = OneWireReadByte();
-    DS2438Data[7] = OneWireReadByte();
-    DS2438Data[8] = OneWireReadByte();
-
-    if (DS2438Data[CRC8] != OneWireCRC8(&DS2438Data[0], 8))
-        return false;
-
-    temp = (int16_t) DS2438Data[0];
-    *energy = (float) temp;
-
-    *energy /= (2048.0 * 0.05);
+    DS2438Select(device);
+    OneWireWriteByte(CONVERT_VOLTAGE);
 
     return true;
 }
 
-unsigned char DS2438IssueConvertions(tLaseredROMCode *device)
+/**
+ * Issue the temperature and voltage convertions to all the DS2438 of the
+ * bus at once (Skip ROM), they all convert in the time of one, 10 ms.
+ * @return Returns if all went well.
+ */
+unsigned char DS2438IssueConvertionsAll(void)
 {
-    //Convert Temperature
     if (OneWireReset() == 0)
         return false;
 
-    OneWireWriteByte(MATCH_ROM_COMMAND);
-    OneWireWriteByte(device->FamilyCode);
-    OneWireWriteByte(device->ROMCodeByte1);
-    OneWireWriteByte(device->ROMCodeByte2);
-    OneWireWriteByte(device->ROMCodeByte3);
-    OneWireWriteByte(device->ROMCodeByte4);
-    OneWireWriteByte(device->ROMCodeByte5);
-    OneWireWriteByte(device->ROMCodeByte6);
-    OneWireWriteByte(device->OWICRC);
+    DS2438Select(NULL);
     OneWireWriteByte(CONVERT_TEMPERATURE);
 
     if (OneWireReset() == 0)
         return false;
 
-    OneWireWriteByte(MATCH_ROM_COMMAND);
-    OneWireWriteByte(device->FamilyCode);
-    OneWireWriteByte(device->ROMCodeByte1);
-    OneWireWriteByte(device->ROMCodeByte2);
-    OneWireWriteByte(device->ROMCodeByte3);
-    OneWireWriteByte(device->ROMCodeByte4);
-    OneWireWriteByte(device->ROMCodeByte5);
-    OneWireWriteByte(device->ROMCodeByte6);
-    OneWireWriteByte(device->OWICRC);
+    DS2438Select(NULL);
     OneWireWriteByte(CONVERT_VOLTAGE);
 
     return true;
 }
+
+/**
+ * Tells if the current of a page 0 is inside the threshold, it is then not
+ * accumulated and the ICA does not move.
+ * @param current Current register.
+ * @param threshold Threshold register.
+ */
+static bool DS2438IsBelowThreshold(int16_t current, unsigned char threshold)
+{
+    //TH2 TH1: none, +-2, +-4 and +-8 LSB
+    int16_t limit = (threshold >> 6) ? (1 << (threshold >> 6)) : 0;
+
+    return (current >= -limit) && (current <= limit);
+}
+
+/**
+ * Reads the batteries after DS2438IssueConvertionsAll() and the convertion
+ * time. The page 0 of all the devices is recalled at once, then each
+ * scratchpad is read, a single reset and Match ROM per device. The page 1
+ * (ICA) is only read again when the current of this poll or of the last one
+ * was outside the threshold of the device, else the ICA has not moved.
+ * @param batteries Batteries to read, Device set, Valid false the first time.
+ * @param count Number of batteries.
+ * @return Number of batteries read with a valid CRC, the others keep the
+ *         last values and Changed is false.
+ */
+unsigned char DS2438PollAll(tDS2438Battery *batteries, unsigned char count)
+{
+    uint8_t data[9];
+    unsigned char i;
+    unsigned char read = 0;
+    int16_t current;
+    bool idle;
+
+    if (DS2438RecallPage(NULL, DS2438_PAGE_0) == false)
+        return 0;
+
+    if (DS2438RecallPage(NULL, DS2438_PAGE_1) == false)
+        return 0;
+
+    for (i = 0; i < count; i++)
+    {
+        tDS2438Battery *battery = &batteries[i];
+
+        battery->Changed = false;
+
+        if (DS2438ReadPage(battery->Device, DS2438_PAGE_0, data) == false)
+            continue;
+
+        battery->Changed = (battery->Valid == false)
+                || (memcmp(battery->Page0, data, THRESH) != 0);
+        memcpy(battery->Page0, data, sizeof (battery->Page0));
+
+        current = (int16_t) (((uint16_t) data[CURR_MSB] << 8) | data[CURR_LSB]);
+        idle = DS2438IsBelowThreshold(current, data[THRESH]);
+
+        if ((battery->Valid == false) || (idle == false) || (battery->Idle == false))
+        {
+            if (DS2438ReadPage(battery->Device, DS2438_PAGE_1, data) == false)
+            {
+                battery->Valid = false;
+                continue;
+            }
+
+            if (battery->ICA != data[ICA_REG])
+                battery->Changed = true;
+            battery->ICA = data[ICA_REG];
+        }
+
+        battery->Idle = idle;
+        battery->Valid = true;
+
+        if (battery->Changed)
+        {
+            DS2438Decode(battery->Page0, &battery->Temperature,
+                         &battery->Voltage, &battery->Current);
+            battery->Energy = (float) battery->ICA;
+            battery->Energy /= (2048.0 * DS2438_SENSE_RESISTOR);
+        }
+
+        read++;
+    }
+
+    return read;
+}
@@ -33,8 +33,15 @@
 #define CURR_MSB                6
 #define THRESH                  7
 #define CRC8                    8
+
+#define ICA_REG                 4
 /** @endcond*/
 
+/**Sense resistor of the current, in ohms.*/
+#ifndef DS2438_SENSE_RESISTOR
+#define DS2438_SENSE_RESISTOR   0.05
+#endif
+
 /**
  * @union Configuration
  * @brief Configuration register of the DS2438.*/
@@ -56,9 +63,28 @@ typedef union
 
 } tDS2438Config; /*!< Varable to configure the DS2438. */
 
+/**
+ * @struct tDS2438Battery
+ * @brief A battery read by DS2438PollAll().*/
+typedef struct
+{
+    tLaseredROMCode *Device; /*!< Device of the battery.*/
+    float Temperature; /*!< Temperature in C.*/
+    float Voltage; /*!< Voltage in V.*/
+    float Current; /*!< Current in A.*/
+    float Energy; /*!< Remaining capacity of the ICA in Ah.*/
+    bool Valid; /*!< The values were read.*/
+    bool Changed; /*!< The values changed in the last poll.*/
+    bool Idle; /*!< The last current was inside the threshold.*/
+    unsigned char ICA; /*!< Last ICA register.*/
+    unsigned char Page0[9]; /*!< Last page 0.*/
+} tDS2438Battery;
+
 unsigned char DS2438Configure(tLaseredROMCode device, tDS2438Config Config);
 unsigned char DS2438GetData(tLaseredROMCode *device, float *temperature,
                             float *voltage, float *current, float *energy);
 unsigned char DS2438IssueConvertions(tLaseredROMCode *device);
+unsigned char DS2438IssueConvertionsAll(void);
+unsigned char DS2438PollAll(tDS2438Battery *batteries, unsigned char count);
 
 #endif
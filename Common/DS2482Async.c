@@ -0,0 +1,563 @@
+/**
+ *  @file       DS2482Async.c
+ *  @author     Luis Maduro
+ *  @version    1.00
+ *  @date       14/10/2026
+ *  @brief      Interrupt driven DS2482 One Wire to I2C converter.
+ *
+ *  Copyright (C) 2026  Luis Maduro
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <stddef.h>
+#include "DS2482Async.h"
+
+/**
+ * Steps of an operation.
+ */
+enum
+{
+    DS2482_STEP_SELECT,
+    DS2482_STEP_SELECT_CHECK,
+    DS2482_STEP_COMMAND,
+    DS2482_STEP_POLL,
+    DS2482_STEP_POINTER,
+    DS2482_STEP_DATA
+};
+
+/** Codes of the Channel Select command and of its read back*/
+static const unsigned char channelCode[8] = {
+    DS2482_CH_IO0, DS2482_CH_IO1, DS2482_CH_IO2, DS2482_CH_IO3,
+    DS2482_CH_IO4, DS2482_CH_IO5, DS2482_CH_IO6, DS2482_CH_IO7
+};
+static const unsigned char channelReadCode[8] = {
+    DS2482_RCH_IO0, DS2482_RCH_IO1, DS2482_RCH_IO2, DS2482_RCH_IO3,
+    DS2482_RCH_IO4, DS2482_RCH_IO5, DS2482_RCH_IO6, DS2482_RCH_IO7
+};
+
+static void DS2482AsyncTransactionDone(tI2CTransaction *transaction);
+static void DS2482AsyncSearchStep(tDS2482Bus *bus, unsigned char ok);
+
+/**
+ * Queues the transaction of the bus, one byte from or to the buffer.
+ */
+static void DS2482AsyncQueue(tDS2482Bus *bus, unsigned char direction,
+                             unsigned char command, unsigned char length)
+{
+    tI2CTransaction *transaction = &bus->transaction;
+
+    transaction->deviceAddress = bus->chip->address;
+    transaction->registerAddress = command;
+    transaction->direction = direction;
+    transaction->length = length;
+    transaction->data = &bus->buffer;
+    transaction->callback = DS2482AsyncTransactionDone;
+    transaction->status = I2C_TRANSACTION_IDLE;
+
+    I2CDeviceStartTransaction(transaction);
+}
+
+/**
+ * Sends the command of the operation, the status is read after it.
+ */
+static void DS2482AsyncCommand(tDS2482Bus *bus)
+{
+    bus->step = DS2482_STEP_COMMAND;
+    bus->buffer = bus->parameter;
+    DS2482AsyncQueue(bus, I2C_Direction_Transmitter, bus->command,
+                     bus->parameterLength);
+}
+
+/**
+ * Starts the operation of the bus that has the chip, with a channel select
+ * first if the chip is on another channel.
+ */
+static void DS2482AsyncBegin(tDS2482Bus *bus)
+{
+    if (bus->chip->channel != bus->channel)
+    {
+        bus->step = DS2482_STEP_SELECT;
+        bus->buffer = channelCode[bus->channel];
+        DS2482AsyncQueue(bus, I2C_Direction_Transmitter, DS2482_CMD_CHSL, 1);
+    }
+    else
+    {
+        DS2482AsyncCommand(bus);
+    }
+}
+
+/**
+ * Gives the chip to the bus, or puts the bus at the end of the queue.
+ */
+static void DS2482AsyncAcquire(tDS2482Bus *bus)
+{
+    tDS2482Chip *chip = bus->chip;
+    unsigned char lock = I2CDeviceLock();
+    unsigned char start = 0;
+
+    bus->next = NULL;
+
+    if (chip->owner == NULL)
+    {
+        chip->owner = bus;
+        start = 1;
+    }
+    else if (chip->waitHead == NULL)
+    {
+        chip->waitHead = bus;
+        chip->waitTail = bus;
+    }
+    else
+    {
+        chip->waitTail->next = bus;
+        chip->waitTail = bus;
+    }
+
+    I2CDeviceUnlock(lock);
+
+    if (start)
+    {
+        DS2482AsyncBegin(bus);
+    }
+}
+
+/**
+ * Gives the chip to the next bus waiting, from the interrupt.
+ */
+static void DS2482AsyncRelease(tDS2482Chip *chip)
+{
+    tDS2482Bus *next = chip->waitHead;
+
+    chip->owner = next;
+
+    if (next != NULL)
+    {
+        chip->waitHead = next->next;
+        DS2482AsyncBegin(next);
+    }
+}
+
+/**
+ * Ends the operation of the user, calling the callback.
+ */
+static void DS2482AsyncFinish(tDS2482Bus *bus, tDS2482AsyncStatus status)
+{
+    bus->searching = 0;
+    bus->status = status;
+
+    if (bus->callback != NULL)
+    {
+        bus->callback(bus);
+    }
+}
+
+/**
+ * The operation is done, the chip goes to the next bus.
+ */
+static void DS2482AsyncOperationDone(tDS2482Bus *bus, unsigned char ok)
+{
+    DS2482AsyncRelease(bus->chip);
+
+    if (bus->searching)
+    {
+        DS2482AsyncSearchStep(bus, ok);
+    }
+    else if (!ok)
+    {
+        DS2482AsyncFinish(bus, DS2482_ASYNC_ERROR);
+    }
+    else if ((bus->command == DS2482_CMD_1WRS) &&
+             !(bus->result & DS2482_STATUS_PPD))
+    {
+        //no presence pulse
+        DS2482AsyncFinish(bus, DS2482_ASYNC_ERROR);
+    }
+    else
+    {
+        DS2482AsyncFinish(bus, DS2482_ASYNC_DONE);
+    }
+}
+
+/**
+ * Callback of the transactions of all the buses, goes to the next step.
+ */
+static void DS2482AsyncTransactionDone(tI2CTransaction *transaction)
+{
+    tDS2482Bus *bus = (tDS2482Bus *) transaction;
+
+    if (transaction->status != I2C_TRANSACTION_DONE)
+    {
+        bus->chip->channel = DS2482_CHANNEL_UNKNOWN;
+        DS2482AsyncOperationDone(bus, 0);
+        return;
+    }
+
+    switch (bus->step)
+    {
+        case DS2482_STEP_SELECT:
+            bus->step = DS2482_STEP_SELECT_CHECK;
+            DS2482AsyncQueue(bus, I2C_Direction_ReceiverCurrent, 0, 1);
+            break;
+
+        case DS2482_STEP_SELECT_CHECK:
+            if (bus->buffer != channelReadCode[bus->channel])
+            {
+                bus->chip->channel = DS2482_CHANNEL_UNKNOWN;
+                DS2482AsyncOperationDone(bus, 0);
+                break;
+            }
+
+            bus->chip->channel = bus->channel;
+            DS2482AsyncCommand(bus);
+            break;
+
+        case DS2482_STEP_COMMAND:
+            //the read pointer is on the status register after a command
+            bus->step = DS2482_STEP_POLL;
+            bus->polls = 0;
+            DS2482AsyncQueue(bus, I2C_Direction_ReceiverCurrent, 0, 1);
+            break;
+
+        case DS2482_STEP_POLL:
+            if (bus->buffer & DS2482_STATUS_1WB)
+            {
+                if (bus->polls++ < POLL_LIMIT)
+                {
+                    DS2482AsyncQueue(bus, I2C_Direction_ReceiverCurrent, 0, 1);
+                }
+                else
+                {
+                    DS2482AsyncOperationDone(bus, 0);
+                }
+                break;
+            }
+
+            bus->result = bus->buffer;
+
+            if (bus->readData)
+            {
+                bus->step = DS2482_STEP_POINTER;
+                bus->buffer = DS2482_READPTR_RDR;
+                DS2482AsyncQueue(bus, I2C_Direction_Transmitter, DS2482_CMD_SRP, 1);
+            }
+            else
+            {
+                DS2482AsyncOperationDone(bus, 1);
+            }
+            break;
+
+        case DS2482_STEP_POINTER:
+            bus->step = DS2482_STEP_DATA;
+            DS2482AsyncQueue(bus, I2C_Direction_ReceiverCurrent, 0, 1);
+            break;
+
+        case DS2482_STEP_DATA:
+            bus->result = bus->buffer;
+            DS2482AsyncOperationDone(bus, 1);
+            break;
+
+        default:
+            break;
+    }
+}
+
+/**
+ * Prepares an operation and waits for the chip.
+ */
+static void DS2482AsyncOperation(tDS2482Bus *bus, unsigned char command,
+                                 unsigned char parameter,
+                                 unsigned char parameterLength,
+                                 unsigned char readData)
+{
+    bus->command = command;
+    bus->parameter = parameter;
+    bus->parameterLength = parameterLength;
+    bus->readData = readData;
+    DS2482AsyncAcquire(bus);
+}
+
+/**
+ * Starts a user operation, if the bus is free.
+ */
+static unsigned char DS2482AsyncStart(tDS2482Bus *bus, tDS2482Callback callback)
+{
+    if (bus->status == DS2482_ASYNC_BUSY)
+    {
+        return 1;
+    }
+
+    bus->status = DS2482_ASYNC_BUSY;
+    bus->callback = callback;
+    bus->searching = 0;
+
+    return 0;
+}
+
+/**
+ * Initiates a chip, DS2482Detect() has to be called before to configure
+ * it.
+ * @param chip Chip.
+ * @param address I2C address of the chip.
+ */
+void DS2482AsyncInitChip(tDS2482Chip *chip, unsigned char address)
+{
+    chip->address = address;
+    chip->channel = DS2482_CHANNEL_UNKNOWN;
+    chip->owner = NULL;
+    chip->waitHead = NULL;
+    chip->waitTail = NULL;
+}
+
+/**
+ * Initiates a bus.
+ * @param bus Bus.
+ * @param chip Chip of the bus.
+ * @param channel Channel, 0 to 7 on the DS2482-800, 0 on the DS2482-100.
+ *                The DS2482-100 is never sent a channel select.
+ */
+void DS2482AsyncInitBus(tDS2482Bus *bus, tDS2482Chip *chip,
+                        unsigned char channel)
+{
+    bus->chip = chip;
+    bus->channel = channel & 0x07;
+    bus->callback = NULL;
+    bus->status = DS2482_ASYNC_IDLE;
+    bus->transaction.status = I2C_TRANSACTION_IDLE;
+    bus->searching = 0;
+    DS2482AsyncResetSearch(bus);
+
+    //a single channel chip is always on its channel
+    if (chip->channel == DS2482_CHANNEL_UNKNOWN && channel == 0)
+    {
+        chip->channel = 0;
+    }
+}
+
+/**
+ * Tells if the bus has an operation running.
+ * @param bus Bus.
+ * @return !=0 while the operation runs.
+ */
+unsigned char DS2482AsyncIsBusy(tDS2482Bus *bus)
+{
+    return bus->status == DS2482_ASYNC_BUSY;
+}
+
+/**
+ * Starts a 1-Wire reset.
+ * @param bus Bus.
+ * @param callback Called at the end, can be NULL. The status of the bus is
+ *                 DS2482_ASYNC_ERROR if no device answered.
+ * @return 0 if started, 1 if the bus is busy.
+ */
+unsigned char DS2482AsyncReset(tDS2482Bus *bus, tDS2482Callback callback)
+{
+    if (DS2482AsyncStart(bus, callback))
+    {
+        return 1;
+    }
+
+    DS2482AsyncOperation(bus, DS2482_CMD_1WRS, 0, 0, 0);
+    return 0;
+}
+
+/**
+ * Starts the write of a byte to the 1-Wire bus.
+ * @param bus Bus.
+ * @param sendbyte Byte to write.
+ * @param callback Called at the end, can be NULL.
+ * @return 0 if started, 1 if the bus is busy.
+ */
+unsigned char DS2482AsyncWriteByte(tDS2482Bus *bus, unsigned char sendbyte,
+                                   tDS2482Callback callback)
+{
+    if (DS2482AsyncStart(bus, callback))
+    {
+        return 1;
+    }
+
+    DS2482AsyncOperation(bus, DS2482_CMD_1WWB, sendbyte, 1, 0);
+    return 0;
+}
+
+/**
+ * Starts the read of a byte from the 1-Wire bus, it is in the result of
+ * the bus at the end.
+ * @param bus Bus.
+ * @param callback Called at the end, can be NULL.
+ * @return 0 if started, 1 if the bus is busy.
+ */
+unsigned char DS2482AsyncReadByte(tDS2482Bus *bus, tDS2482Callback callback)
+{
+    if (DS2482AsyncStart(bus, callback))
+    {
+        return 1;
+    }
+
+    DS2482AsyncOperation(bus, DS2482_CMD_1WRB, 0, 0, 1);
+    return 0;
+}
+
+/**
+ * Starts a 1-Wire triplet, two read bits and the write of the direction,
+ * the status register is in the result at the end
+ * (DS2482_STATUS_SBR, DS2482_STATUS_TSB and DS2482_STATUS_DIR).
+ * @param bus Bus.
+ * @param direction Direction written if the two bits read differ.
+ * @param callback Called at the end, can be NULL.
+ * @return 0 if started, 1 if the bus is busy.
+ */
+unsigned char DS2482AsyncTriplet(tDS2482Bus *bus, unsigned char direction,
+                                 tDS2482Callback callback)
+{
+    if (DS2482AsyncStart(bus, callback))
+    {
+        return 1;
+    }
+
+    DS2482AsyncOperation(bus, DS2482_CMD_1WT, direction ? 0x80 : 0x00, 1, 0);
+    return 0;
+}
+
+/**
+ * Makes the next DS2482AsyncSearch() start from the first device.
+ * @param bus Bus.
+ */
+void DS2482AsyncResetSearch(tDS2482Bus *bus)
+{
+    unsigned char i;
+
+    bus->lastDiscrepancy = 0;
+    bus->lastDeviceFlag = 0;
+
+    for (i = 0; i < 8; i++)
+    {
+        bus->rom[i] = 0;
+    }
+}
+
+/**
+ * Next step of a search, called at the end of each of its operations.
+ */
+static void DS2482AsyncSearchStep(tDS2482Bus *bus, unsigned char ok)
+{
+    unsigned char byte = (bus->bitNumber - 1) >> 3;
+    unsigned char mask = 1 << ((bus->bitNumber - 1) & 0x07);
+    unsigned char direction;
+    unsigned char status = bus->result;
+
+    if (!ok)
+    {
+        DS2482AsyncFinish(bus, DS2482_ASYNC_ERROR);
+        return;
+    }
+
+    if (bus->command == DS2482_CMD_1WRS)
+    {
+        if (!(status & DS2482_STATUS_PPD))
+        {
+            //no devices
+            DS2482AsyncResetSearch(bus);
+            bus->result = 0;
+            DS2482AsyncFinish(bus, DS2482_ASYNC_DONE);
+            return;
+        }
+
+        DS2482AsyncOperation(bus, DS2482_CMD_1WWB, 0xF0, 1, 0);
+        return;
+    }
+
+    if (bus->command == DS2482_CMD_1WT)
+    {
+        //both bits 1, no device answered this bit
+        if ((status & DS2482_STATUS_SBR) && (status & DS2482_STATUS_TSB))
+        {
+            DS2482AsyncResetSearch(bus);
+            bus->result = 0;
+            DS2482AsyncFinish(bus, DS2482_ASYNC_DONE);
+            return;
+        }
+
+        //a discrepancy where 0 was taken
+        if (!(status & DS2482_STATUS_SBR) && !(status & DS2482_STATUS_TSB) &&
+            !(status & DS2482_STATUS_DIR))
+        {
+            bus->lastZero = bus->bitNumber;
+        }
+
+        if (status & DS2482_STATUS_DIR)
+            bus->rom[byte] |= mask;
+        else
+            bus->rom[byte] &= ~mask;
+
+        if (bus->bitNumber == 64)
+        {
+            bus->lastDiscrepancy = bus->lastZero;
+            bus->lastDeviceFlag = (bus->lastZero == 0);
+            bus->result = (OneWireCRC8(bus->rom, 7) == bus->rom[7]);
+
+            if (!bus->result)
+            {
+                DS2482AsyncResetSearch(bus);
+            }
+
+            DS2482AsyncFinish(bus, DS2482_ASYNC_DONE);
+            return;
+        }
+
+        bus->bitNumber++;
+        byte = (bus->bitNumber - 1) >> 3;
+        mask = 1 << ((bus->bitNumber - 1) & 0x07);
+    }
+
+    //after the search command or a triplet, the next bit
+    if (bus->bitNumber < bus->lastDiscrepancy)
+        direction = (bus->rom[byte] & mask) != 0;
+    else
+        direction = (bus->bitNumber == bus->lastDiscrepancy);
+
+    DS2482AsyncOperation(bus, DS2482_CMD_1WT, direction ? 0x80 : 0x00, 1, 0);
+}
+
+/**
+ * Starts the search of the next device of the bus, with the triplet
+ * command of the DS2482. At the end the result of the bus is 1 and the ROM
+ * of the device is in the bus if one was found, 0 if there are no more
+ * devices (the next search starts from the first one).
+ * @param bus Bus.
+ * @param callback Called at the end, can be NULL.
+ * @return 0 if started, 1 if the bus is busy.
+ */
+unsigned char DS2482AsyncSearch(tDS2482Bus *bus, tDS2482Callback callback)
+{
+    if (DS2482AsyncStart(bus, callback))
+    {
+        return 1;
+    }
+
+    if (bus->lastDeviceFlag)
+    {
+        DS2482AsyncResetSearch(bus);
+        bus->result = 0;
+        DS2482AsyncFinish(bus, DS2482_ASYNC_DONE);
+        return 0;
+    }
+
+    bus->searching = 1;
+    bus->bitNumber = 1;
+    bus->lastZero = 0;
+    DS2482AsyncOperation(bus, DS2482_CMD_1WRS, 0, 0, 0);
+    return 0;
+}
@@ -0,0 +1,133 @@
+/**
+ *  @file       DS2482Async.h
+ *  @author     Luis Maduro
+ *  @version    1.00
+ *  @date       14/10/2026
+ *  @brief      Interrupt driven DS2482 One Wire to I2C converter.
+ *
+ *  The 1-Wire operations are chains of queued I2C transactions
+ *  (I2CDeviceStartTransaction()): the command, the reads of the status
+ *  register until the 1-Wire busy bit is clear and the read of the data
+ *  register. The next transaction is queued from the callback of the one
+ *  before, so the CPU is free while the DS2482 works and gets the result
+ *  by a callback or by polling the status.
+ *
+ *  Every 1-Wire bus is a tDS2482Bus, a channel of a tDS2482Chip. The buses
+ *  of different chips run at the same time. The buses of the same chip (the
+ *  channels of a DS2482-800) take turns: the chip is given to the next bus
+ *  waiting after every operation (a reset, a byte or a triplet of a
+ *  search), so the searches of all the channels go on together.
+ *
+ *  Copyright (C) 2026  Luis Maduro
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef DS2482ASYNC_H
+#define DS2482ASYNC_H
+
+#include "DS2482.h"
+
+/** Channel selected of a chip not known yet*/
+#define DS2482_CHANNEL_UNKNOWN      0xFF
+
+/**
+ * Status of the operation of a bus.
+ */
+typedef enum
+{
+    /** No operation started*/
+    DS2482_ASYNC_IDLE,
+    /** Operation running or waiting for the chip*/
+    DS2482_ASYNC_BUSY,
+    /** Operation done, the result is in the bus*/
+    DS2482_ASYNC_DONE,
+    /** The DS2482 didn't answer, stayed busy, or no device on the reset*/
+    DS2482_ASYNC_ERROR
+} tDS2482AsyncStatus;
+
+struct _tDS2482Bus;
+
+/**
+ * Called from the I2C interrupt at the end of an operation.
+ */
+typedef void (*tDS2482Callback)(struct _tDS2482Bus *bus);
+
+/**
+ * A DS2482, shared by its channels.
+ */
+typedef struct _tDS2482Chip
+{
+    /** I2C address of the chip, as for the blocking functions*/
+    unsigned char address;
+    /** Channel selected, DS2482_CHANNEL_UNKNOWN at the start*/
+    unsigned char channel;
+    /** Bus doing an operation*/
+    struct _tDS2482Bus *owner;
+    /** Buses waiting for the chip*/
+    struct _tDS2482Bus *waitHead;
+    struct _tDS2482Bus *waitTail;
+} tDS2482Chip;
+
+/**
+ * A 1-Wire bus on a channel of a DS2482.
+ */
+typedef struct _tDS2482Bus
+{
+    /** I2C transaction of the bus, it must be the first member*/
+    tI2CTransaction transaction;
+    tDS2482Chip *chip;
+    /** Channel of the DS2482-800, 0 for the DS2482-100*/
+    unsigned char channel;
+    tDS2482Callback callback;
+    volatile tDS2482AsyncStatus status;
+    /** Status register after a reset or a triplet, byte read, or 1 if a
+     search found a device*/
+    unsigned char result;
+    /** ROM of the device found by the last search*/
+    unsigned char rom[8];
+    /** Operation: command, its parameter and if the data is read*/
+    unsigned char command;
+    unsigned char parameter;
+    unsigned char parameterLength;
+    unsigned char readData;
+    /** Step of the operation and number of status reads*/
+    unsigned char step;
+    unsigned char polls;
+    /** Byte written or read by the transaction*/
+    unsigned char buffer;
+    /** Search state, as in the blocking search*/
+    unsigned char searching;
+    unsigned char bitNumber;
+    unsigned char lastZero;
+    unsigned char lastDiscrepancy;
+    unsigned char lastDeviceFlag;
+    /** Next bus waiting for the chip*/
+    struct _tDS2482Bus *next;
+} tDS2482Bus;
+
+void DS2482AsyncInitChip(tDS2482Chip *chip, unsigned char address);
+void DS2482AsyncInitBus(tDS2482Bus *bus, tDS2482Chip *chip,
+                        unsigned char channel);
+unsigned char DS2482AsyncIsBusy(tDS2482Bus *bus);
+unsigned char DS2482AsyncReset(tDS2482Bus *bus, tDS2482Callback callback);
+unsigned char DS2482AsyncWriteByte(tDS2482Bus *bus, unsigned char sendbyte,
+                                   tDS2482Callback callback);
+unsigned char DS2482AsyncReadByte(tDS2482Bus *bus, tDS2482Callback callback);
+unsigned char DS2482AsyncTriplet(tDS2482Bus *bus, unsigned char direction,
+                                 tDS2482Callback callback);
+void DS2482AsyncResetSearch(tDS2482Bus *bus);
+unsigned char DS2482AsyncSearch(tDS2482Bus *bus, tDS2482Callback callback);
+
+#endif
@@ -0,0 +1,122 @@
+/**
+ *  @file       DeferredWork.c
+ *  @brief      ISR-safe deferred work queue for the schedulers.
+ *  @author     Luis Maduro
+ *  @version    1.00
+ *  @date       14/10/2026
+ *
+ *  Copyright (C) 2026  Luis Maduro
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <stddef.h>
+#include "DeferredWork.h"
+
+#if defined(__GNUC__)
+#define DEFERRED_WORK_BARRIER()     __asm__ __volatile__("" ::: "memory")
+#else
+#define DEFERRED_WORK_BARRIER()
+#endif
+
+typedef struct
+{
+    DeferredWorkFunction function;
+    void *argument;
+} tDeferredWork;
+
+static tDeferredWork workQueue[DEFERRED_WORK_SIZE];
+/**Only written by DeferredWorkPost(), runs freely.*/
+static volatile uint8_t workHead = 0;
+/**Only written by DeferredWorkRun(), runs freely.*/
+static volatile uint8_t workTail = 0;
+/**Number of items that were lost because the queue was full.*/
+static volatile uint8_t workDropped = 0;
+
+/**
+ * Queues a function to be called later in task context. Meant to be used
+ * by the interrupt routines, to keep them short.
+ * @param function Function to be called.
+ * @param argument Argument given to the function.
+ * @return True if the work was queued, false if the queue was full.
+ */
+bool DeferredWorkPost(DeferredWorkFunction function, void *argument)
+{
+    uint8_t head;
+
+    DEFERRED_WORK_ENTER_CRITICAL();
+
+    head = workHead;
+
+    if ((uint8_t) (head - workTail) == DEFERRED_WORK_SIZE)
+    {
+        if (workDropped != 0xFF)
+        {
+            workDropped++;
+        }
+        DEFERRED_WORK_EXIT_CRITICAL();
+        return false;
+    }
+
+    workQueue[head & (DEFERRED_WORK_SIZE - 1)].function = function;
+    workQueue[head & (DEFERRED_WORK_SIZE - 1)].argument = argument;
+
+    DEFERRED_WORK_BARRIER(); //the item must be there before it is published
+
+    workHead = head + 1;
+
+    DEFERRED_WORK_EXIT_CRITICAL();
+
+    return true;
+}
+
+/**
+ * Tells if there is work waiting to be run.
+ * @return True if DeferredWorkRun() has something to do.
+ */
+bool DeferredWorkPending(void)
+{
+    return (workHead != workTail);
+}
+
+/**
+ * Runs all the work that is queued, in the order it was posted. Called by
+ * the schedulers before looking at the tasks.
+ */
+void DeferredWorkRun(void)
+{
+    uint8_t tail = workTail;
+    tDeferredWork work;
+
+    while (tail != workHead)
+    {
+        DEFERRED_WORK_BARRIER(); //read the item only after seeing the head
+
+        work = workQueue[tail & (DEFERRED_WORK_SIZE - 1)];
+
+        DEFERRED_WORK_BARRIER(); //free the slot only after reading it
+
+        workTail = ++tail;
+        work.function(work.argument);
+    }
+}
+
+/**
+ * Number of work items lost because the queue was full (saturates at 255).
+ * @return Number of items dropped.
+ */
+uint8_t DeferredWorkGetDropped(void)
+{
+    return workDropped;
+}
@@ -0,0 +1,63 @@
+/**
+ *  @file       DeferredWork.h
+ *  @brief      ISR-safe deferred work queue for the schedulers.
+ *  @author     Luis Maduro
+ *  @version    1.00
+ *  @date       14/10/2026
+ *
+ *  Copyright (C) 2026  Luis Maduro
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef DEFERREDWORK_H
+#define DEFERREDWORK_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+/**Uncomment to let uKernel and pKernel run the work posted by the interrupt
+ routines before any task, on every pass of the scheduler.*/
+//#define USE_DEFERRED_WORK
+
+/**Number of work items that can be waiting (power of two, max 128).*/
+#ifndef DEFERRED_WORK_SIZE
+#define DEFERRED_WORK_SIZE          16
+#endif
+
+#if (DEFERRED_WORK_SIZE & (DEFERRED_WORK_SIZE - 1)) || (DEFERRED_WORK_SIZE > 128)
+#error "DeferredWork: DEFERRED_WORK_SIZE must be a power of two up to 128"
+#endif
+
+/**
+ * The queue is lock-free for one producer. If interrupt routines of
+ * different priorities (that can nest) post work, define these to disable
+ * and enable the interrupts, i.e. on the PIC18 with priorities enabled:
+ * #define DEFERRED_WORK_ENTER_CRITICAL()   INTCONbits.GIEL = 0
+ * #define DEFERRED_WORK_EXIT_CRITICAL()    INTCONbits.GIEL = 1
+ */
+#ifndef DEFERRED_WORK_ENTER_CRITICAL
+#define DEFERRED_WORK_ENTER_CRITICAL()
+#define DEFERRED_WORK_EXIT_CRITICAL()
+#endif
+
+/**Function called in task context with the argument given when posted.*/
+typedef void (*DeferredWorkFunction)(void *argument);
+
+bool DeferredWorkPost(DeferredWorkFunction function, void *argument);
+bool DeferredWorkPending(void);
+void DeferredWorkRun(void);
+uint8_t DeferredWorkGetDropped(void);
+
+#endif /* DEFERREDWORK_H */
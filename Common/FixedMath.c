@@ -0,0 +1,229 @@
+/**
+ *  @file       FixedMath.c
+ *  @author     Luis Maduro
+ *  @version    1.00
+ *  @date       14/10/2026
+ *  @brief      Integer atan2, magnitude, square root, sine and cosine.
+ *
+ *  Copyright (C) 2026  Luis Maduro
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "FixedMath.h"
+
+#if FIXED_MATH_CORDIC_STEPS > 16
+#error "FixedMath: the table has 16 steps"
+#endif
+
+/**atan(2^-i) in 2^32 per turn.*/
+static const uint32_t cordicAngles[16] = {
+    536870912UL, 316933406UL, 167458907UL, 85004756UL,
+    42667331UL, 21354465UL, 10679838UL, 5340245UL,
+    2670163UL, 1335087UL, 667544UL, 333772UL,
+    166886UL, 83443UL, 41722UL, 20861UL
+};
+
+/**1 / gain of the CORDIC in Q0.16, 0.60725.*/
+#define FIXED_MATH_CORDIC_INVERSE_GAIN  39797UL
+
+/**sin() of the first quarter of a turn in Q1.15, 64 steps.*/
+static const int16_t sineTable[65] = {
+    0, 804, 1608, 2410, 3212, 4011, 4808, 5602,
+    6393, 7179, 7962, 8739, 9512, 10278, 11039, 11793,
+    12539, 13279, 14010, 14732, 15446, 16151, 16846, 17530,
+    18204, 18868, 19519, 20159, 20787, 21403, 22005, 22594,
+    23170, 23731, 24279, 24811, 25329, 25832, 26319, 26790,
+    27245, 27683, 28105, 28510, 28898, 29268, 29621, 29956,
+    30273, 30571, 30852, 31113, 31356, 31580, 31785, 31971,
+    32137, 32285, 32412, 32521, 32609, 32678, 32728, 32757,
+    32767
+};
+
+/**
+ * Turns a vector onto the positive x axis.
+ * @param x X, its length times the gain of the CORDIC on return.
+ * @param y Y, starts the vector.
+ * @param shift Where the shift that scaled the vector up is stored.
+ * @return Angle of the vector, 2^32 per turn.
+ */
+static uint32_t FixedMathVector(int32_t *x, int32_t y, unsigned char *shift)
+{
+    int32_t vx = *x;
+    int32_t vy = y;
+    int32_t t;
+    uint32_t angle = 0;
+    unsigned char i;
+
+    //into the right half plane, the steps turn by less than 100 degrees
+    if (vx < 0)
+    {
+        vx = -vx;
+        vy = -vy;
+        angle = 0x80000000UL;
+    }
+
+    //the shifts of the steps lose the low bits of small values
+    *shift = 0;
+
+    while (((uint32_t) vx | (uint32_t) (vy < 0 ? -vy : vy)) < 0x10000000UL)
+    {
+        vx <<= 1;
+        vy <<= 1;
+        (*shift)++;
+    }
+
+    for (i = 0; i < FIXED_MATH_CORDIC_STEPS; i++)
+    {
+        t = vx;
+
+        if (vy > 0)
+        {
+            vx += vy >> i;
+            vy -= t >> i;
+            angle += cordicAngles[i];
+        }
+        else
+        {
+            vx -= vy >> i;
+            vy += t >> i;
+            angle -= cordicAngles[i];
+        }
+    }
+
+    *x = vx;
+
+    return angle;
+}
+
+/**
+ * Angle of a vector, as atan2() of the C library.
+ * @param y Y, up to 2^29 in absolute value.
+ * @param x X, up to 2^29 in absolute value.
+ * @return Angle from the x axis, 0 for a null vector.
+ */
+tFixedAngle FixedMathAtan2(int32_t y, int32_t x)
+{
+    unsigned char shift;
+
+    if ((x == 0) && (y == 0))
+        return 0;
+
+    return (tFixedAngle) ((FixedMathVector(&x, y, &shift) + 0x8000UL) >> 16);
+}
+
+/**
+ * Length of a vector, sqrt(x * x + y * y) without the products.
+ * @param x X, up to 2^29 in absolute value.
+ * @param y Y, up to 2^29 in absolute value.
+ * @return Length, rounded.
+ */
+uint32_t FixedMathMagnitude(int32_t x, int32_t y)
+{
+    unsigned char shift;
+    uint32_t length;
+
+    if ((x == 0) && (y == 0))
+        return 0;
+
+    FixedMathVector(&x, y, &shift);
+
+    //times 1 / gain in 32 bits, x is below 2^31
+    length = ((uint32_t) x >> 16) * FIXED_MATH_CORDIC_INVERSE_GAIN +
+            ((((uint32_t) x & 0xFFFF) * FIXED_MATH_CORDIC_INVERSE_GAIN) >> 16);
+
+    return (shift == 0) ? length : (length + (1UL << (shift - 1))) >> shift;
+}
+
+/**
+ * Length of a vector of 3 axes.
+ * @param x X, up to 2^28 in absolute value.
+ * @param y Y, up to 2^28 in absolute value.
+ * @param z Z, up to 2^28 in absolute value.
+ * @return Length, rounded.
+ */
+uint32_t FixedMathMagnitude3(int32_t x, int32_t y, int32_t z)
+{
+    return FixedMathMagnitude((int32_t) FixedMathMagnitude(x, y), z);
+}
+
+/**
+ * Square root, bit by bit.
+ * @param x Value.
+ * @return sqrt(x) rounded down.
+ */
+uint16_t FixedMathSqrt(uint32_t x)
+{
+    uint32_t root = 0;
+    uint32_t bit = 1UL << 30;
+    uint32_t t;
+
+    while (bit > x)
+    {
+        bit >>= 2;
+    }
+
+    while (bit != 0)
+    {
+        t = root + bit;
+        root >>= 1;
+
+        if (x >= t)
+        {
+            x -= t;
+            root += bit;
+        }
+
+        bit >>= 2;
+    }
+
+    return (uint16_t) root;
+}
+
+/**
+ * Sine, from the table with a linear interpolation.
+ * @param angle Angle.
+ * @return sin(angle) in Q1.15, within 4 of the exact value.
+ */
+int16_t FixedMathSin(tFixedAngle angle)
+{
+    uint16_t a = (uint16_t) angle;
+    uint16_t offset = a & 0x3FFF;
+    unsigned char index;
+    unsigned char fraction;
+    int16_t value;
+
+    //the second and the fourth quarters go down the table
+    if (a & 0x4000)
+        offset = 0x4000 - offset;
+
+    index = (unsigned char) (offset >> 8);
+    fraction = (unsigned char) offset;
+    value = sineTable[index];
+
+    if (fraction != 0)
+        value += (int16_t) (((int32_t) (sineTable[index + 1] - value) * fraction) >> 8);
+
+    return (a & 0x8000) ? -value : value;
+}
+
+/**
+ * Cosine, the sine a quarter of a turn later.
+ * @param angle Angle.
+ * @return cos(angle) in Q1.15.
+ */
+int16_t FixedMathCos(tFixedAngle angle)
+{
+    return FixedMathSin((tFixedAngle) ((uint16_t) angle + 0x4000));
+}
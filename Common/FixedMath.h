@@ -0,0 +1,73 @@
+/**
+ *  @file       FixedMath.h
+ *  @author     Luis Maduro
+ *  @version    1.00
+ *  @date       14/10/2026
+ *  @brief      Integer atan2, magnitude, square root, sine and cosine.
+ *
+ *  The heading of a magnetometer and the tilt of an accelerometer are
+ *  atan2() and sqrt() of the raw axes. In float they take thousands of
+ *  cycles on the parts without FPU, tens of thousands on the PIC18. Here
+ *  atan2() and the magnitude of a vector are the vectoring mode of a CORDIC
+ *  of FIXED_MATH_CORDIC_STEPS steps, only shifts and 32 bit additions. The
+ *  square root is found bit by bit. The sine and the cosine come from a
+ *  table of a quarter of a period, 65 values, interpolated.
+ *
+ *  The angles are binary: a tFixedAngle is a 16 bit signed value,
+ *  65536 for a turn, -32768 for -180 degrees and 32767 for just under
+ *  180 degrees. They wrap around by themselves, and a difference of two
+ *  headings needs no correction for the jump at 180 degrees.
+ *  FIXED_MATH_TO_DECIDEGREES() converts them for display. The sine and the
+ *  cosine are in Q1.15, FIXED_MATH_ONE_Q15 for 1.
+ *
+ *  The components given to FixedMathAtan2() and FixedMathMagnitude() are
+ *  up to 2^29 in absolute value, and up to 2^28 for FixedMathMagnitude3().
+ *  They are scaled up inside, so small raw values keep the precision: the
+ *  angle within 0.005 degrees and the magnitude within 0.5 plus a few parts
+ *  per million.
+ *
+ *  Copyright (C) 2026  Luis Maduro
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef FIXEDMATH_H
+#define FIXEDMATH_H
+
+#include <stdint.h>
+
+/**Binary angle, 65536 per turn.*/
+typedef int16_t tFixedAngle;
+
+/**Steps of the CORDIC, the last one turns by 0.0017 degrees.*/
+#ifndef FIXED_MATH_CORDIC_STEPS
+#define FIXED_MATH_CORDIC_STEPS     16
+#endif
+
+#define FIXED_MATH_ONE_Q15          32767
+
+/**Angle of a constant in degrees, only for constant expressions.*/
+#define FIXED_MATH_DEGREES(x)       ((tFixedAngle) (int32_t) ((x) * 65536.0 / 360.0 + ((x) < 0 ? -0.5 : 0.5)))
+/**Angle in tenths of a degree, -1800 to 1799.*/
+#define FIXED_MATH_TO_DECIDEGREES(angle) \
+                                    ((int16_t) (((int32_t) (angle) * 3600L) >> 16))
+
+tFixedAngle FixedMathAtan2(int32_t y, int32_t x);
+uint32_t FixedMathMagnitude(int32_t x, int32_t y);
+uint32_t FixedMathMagnitude3(int32_t x, int32_t y, int32_t z);
+uint16_t FixedMathSqrt(uint32_t x);
+int16_t FixedMathSin(tFixedAngle angle);
+int16_t FixedMathCos(tFixedAngle angle);
+
+#endif /* FIXEDMATH_H */
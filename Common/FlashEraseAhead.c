@@ -0,0 +1,152 @@
+/**
+ *  @file       FlashEraseAhead.c
+ *  @author     Luis Maduro
+ *  @version    1.00
+ *  @date       14/10/2026
+ *  @brief      Log on the SST25VF064C with its sectors erased ahead of time.
+ *
+ *  Copyright (C) 2026  Luis Maduro
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "FlashEraseAhead.h"
+
+static uint32_t regionFirst;
+static uint16_t regionSectors;
+/**Next address written, its sector and the bytes left in the sector.*/
+static uint32_t head;
+static uint16_t headSector;
+static uint16_t room;
+/**Sectors erased after the one of the head.*/
+static uint16_t erased;
+
+/**
+ * Sets the region of the log and its write head, nothing is erased here.
+ * The sector of the head must already be erased from the head on, the ones
+ * after it are erased later by FlashEraseAheadTasks().
+ * @param first Address of the first sector, at a 4 KB boundary.
+ * @param sectors Sectors of the region, 2 or more.
+ * @param next Next address to write, in the region.
+ */
+void FlashEraseAheadInit(uint32_t first, uint16_t sectors, uint32_t next)
+{
+    regionFirst = first;
+    regionSectors = sectors;
+    head = next;
+    headSector = (uint16_t) ((head - first) / FLASH_SECTOR_SIZE);
+    room = (uint16_t) (FLASH_SECTOR_SIZE - (head & (FLASH_SECTOR_SIZE - 1)));
+    erased = 0;
+}
+
+/**
+ * Starts the erase of the next sector when less than
+ * FLASH_ERASE_AHEAD_SECTORS are erased ahead of the head. Called from the
+ * main loop or a task, it returns at once while the flash is busy.
+ * @return True if the sectors ahead are all erased.
+ */
+bool FlashEraseAheadTasks(void)
+{
+    uint32_t address;
+    uint16_t ahead = FLASH_ERASE_AHEAD_SECTORS;
+
+    if (ahead > regionSectors - 1)
+    {
+        ahead = regionSectors - 1;
+    }
+
+    if (erased >= ahead)
+    {
+        return true;
+    }
+
+    if (FlashIsBusy())
+    {
+        return false;
+    }
+
+    address = regionFirst + (uint32_t) ((headSector + 1 + erased) % regionSectors) *
+        FLASH_SECTOR_SIZE;
+
+    //the status register tells the end of it on a next call
+    FlashSector4KErase(address);
+    erased++;
+
+    return false;
+}
+
+/**
+ * Appends data at the head, without waiting for an erase.
+ * @param data Data.
+ * @param length Bytes of data.
+ * @return False if the flash is busy or the sectors needed are not erased
+ *         yet, nothing is written.
+ */
+bool FlashEraseAheadWrite(const void *data, uint16_t length)
+{
+    const uint8_t *bytes = (const uint8_t *) data;
+    uint16_t part;
+
+    if (length > FlashEraseAheadAvailable())
+    {
+        return false;
+    }
+
+    if (FlashIsBusy())
+    {
+        return false;
+    }
+
+    while (length != 0)
+    {
+        //the next erased sector becomes the one of the head
+        if (room == 0)
+        {
+            headSector = (headSector + 1) % regionSectors;
+            head = regionFirst + (uint32_t) headSector * FLASH_SECTOR_SIZE;
+            room = (uint16_t) FLASH_SECTOR_SIZE;
+            erased--;
+        }
+
+        part = (room > length) ? length : room;
+
+        FlashWriteBuffer(head, bytes, part);
+        bytes += part;
+        length -= part;
+        head += part;
+        room -= part;
+    }
+
+    return true;
+}
+
+/**
+ * Gives the write head.
+ * @return The next address written, the end of the sector of the head
+ *         when it is full.
+ */
+uint32_t FlashEraseAheadHead(void)
+{
+    return head;
+}
+
+/**
+ * Gives the bytes that can be written now without an erase.
+ * @return The bytes left in the sector of the head and in the erased
+ *         sectors after it.
+ */
+uint32_t FlashEraseAheadAvailable(void)
+{
+    return room + (uint32_t) erased * FLASH_SECTOR_SIZE;
+}
@@ -0,0 +1,54 @@
+/**
+ *  @file       FlashEraseAhead.h
+ *  @author     Luis Maduro
+ *  @version    1.00
+ *  @date       14/10/2026
+ *  @brief      Log on the SST25VF064C with its sectors erased ahead of time.
+ *
+ *  A log is written in order through a ring of 4 KB sectors. A 4 KB erase
+ *  takes about 25 ms, and no page can be programmed meanwhile (the
+ *  SST25VF064C can't suspend an erase). FlashEraseAheadTasks() keeps
+ *  FLASH_ERASE_AHEAD_SECTORS sectors erased ahead of the write head. It
+ *  starts one erase at a time and checks the status register on the next
+ *  call instead of waiting for it.
+ *
+ *  FlashEraseAheadWrite() never waits for an erase. It returns false while
+ *  the flash is busy or the next sector is not erased yet, and the caller
+ *  keeps the data in RAM for the next try. Writes of a page or less keep the
+ *  time in it to one page program.
+ *
+ *  Copyright (C) 2026  Luis Maduro
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef FLASHERASEAHEAD_H
+#define FLASHERASEAHEAD_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "SST25VF064C.h"
+
+/**Sectors kept erased past the one being written.*/
+#ifndef FLASH_ERASE_AHEAD_SECTORS
+#define FLASH_ERASE_AHEAD_SECTORS   2
+#endif
+
+void FlashEraseAheadInit(uint32_t first, uint16_t sectors, uint32_t next);
+bool FlashEraseAheadTasks(void);
+bool FlashEraseAheadWrite(const void *data, uint16_t length);
+uint32_t FlashEraseAheadHead(void);
+uint32_t FlashEraseAheadAvailable(void);
+
+#endif /* FLASHERASEAHEAD_H */
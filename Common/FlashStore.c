@@ -0,0 +1,644 @@
+/**
+ *  @file       FlashStore.c
+ *  @author     Luis Maduro
+ *  @version    1.00
+ *  @date       14/10/2026
+ *  @brief      Log structured key/value store on the SST25VF064C.
+ *
+ *  Copyright (C) 2026  Luis Maduro
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <stddef.h>
+#include "FlashStore.h"
+#include "CRCDevice.h"
+
+/**"FS", marks a sector in use.*/
+#define FLASHSTORE_MAGIC            0x5346
+
+/**Bytes of a sector, as an offset in it.*/
+#define FLASHSTORE_SECTOR_SIZE      ((uint16_t) FLASH_SECTOR_SIZE)
+
+/**Most bytes taken by a record.*/
+#define FLASHSTORE_RECORD_MAX       (FLASHSTORE_RECORD_HEADER + 255)
+
+/**Most bytes of current records. One sector is kept for the collection and
+ one is the head, every other sector can waste less than a record at its
+ end, so the collection always frees a sector.*/
+#define FLASHSTORE_CAPACITY         ((uint32_t) (FLASHSTORE_SECTORS - 2) * \
+    (FLASHSTORE_SECTOR_SIZE - FLASHSTORE_SECTOR_HEADER - FLASHSTORE_RECORD_MAX))
+
+/**Bytes moved at a time when a record is read back or copied, a multiple of
+ 4 so the CRC of a value read in chunks is the one of the whole value.*/
+#define FLASHSTORE_CHUNK            32
+
+/**
+ * Start of every sector in use.
+ */
+typedef struct
+{
+    /**One more than the sector written before.*/
+    uint32_t Sequence;
+    uint16_t Magic;
+    uint16_t Check;
+} tFlashStoreSector;
+
+/**
+ * Start of every record, followed by Length bytes of value. A Length of 0
+ * deletes the key.
+ */
+typedef struct
+{
+    uint8_t Key;
+    uint8_t Length;
+    /**Low half of the CRC of the key, the length and the value.*/
+    uint16_t Check;
+} tFlashStoreRecord;
+
+/**
+ * Newest record of a key.
+ */
+typedef struct
+{
+    uint32_t Address;
+    uint8_t Key;
+    uint8_t Length;
+} tFlashStoreEntry;
+
+tFlashStoreStatistics FlashStoreStatistics;
+
+static tFlashStoreEntry entries[FLASHSTORE_KEYS];
+
+/**Sector written, the next free byte in it and its sequence number.*/
+static uint16_t head;
+static uint16_t headOffset;
+static uint32_t headSequence;
+/**Oldest sector in use and the next record the collection looks at.*/
+static uint16_t tail;
+static uint16_t tailOffset;
+/**Sectors in use, from the tail to the head.*/
+static uint16_t used;
+/**Bytes of the current records, headers included.*/
+static uint32_t live;
+
+static uint8_t chunk[FLASHSTORE_CHUNK];
+
+/**
+ * Gives the flash address of a sector of the region.
+ * @param sector Sector, from 0.
+ * @return The address of its first byte.
+ */
+static uint32_t FlashStoreAddress(uint16_t sector)
+{
+    return FLASHSTORE_ADDRESS + (uint32_t) sector * FLASH_SECTOR_SIZE;
+}
+
+/**
+ * Gives the check of the header of a sector.
+ * @param sequence Sequence number of the sector.
+ * @return The check.
+ */
+static uint16_t FlashStoreSectorCheck(uint32_t sequence)
+{
+    return (uint16_t) ~(FLASHSTORE_MAGIC ^ (uint16_t) sequence ^ (uint16_t) (sequence >> 16));
+}
+
+/**
+ * Reads the header of a sector.
+ * @param sector Sector, from 0.
+ * @param sequence Its sequence number.
+ * @return False if the sector is not in use.
+ */
+static bool FlashStoreReadSector(uint16_t sector, uint32_t *sequence)
+{
+    tFlashStoreSector header;
+
+    FlashReadBuffer(FlashStoreAddress(sector), (uint8_t *) &header, sizeof (header));
+    *sequence = header.Sequence;
+
+    return (header.Magic == FLASHSTORE_MAGIC) &&
+        (header.Check == FlashStoreSectorCheck(header.Sequence));
+}
+
+/**
+ * Gives the check of a record, its value being in the flash.
+ * @param address Address of the record.
+ * @param record Its header.
+ * @return The check.
+ */
+static uint16_t FlashStoreRecordCheck(uint32_t address, const tFlashStoreRecord *record)
+{
+    uint32_t check = CRCDeviceCompute(CRC_DEVICE_INIT, &record->Key, 2);
+    uint8_t length = record->Length;
+    uint8_t part;
+
+    address += FLASHSTORE_RECORD_HEADER;
+
+    while (length != 0)
+    {
+        part = (length > FLASHSTORE_CHUNK) ? FLASHSTORE_CHUNK : length;
+        FlashReadBuffer(address, chunk, part);
+        check = CRCDeviceCompute(check, chunk, part);
+        address += part;
+        length -= part;
+    }
+
+    return (uint16_t) check;
+}
+
+/**
+ * Gives the entry of a key.
+ * @param key Key.
+ * @return The entry, NULL if the key is not stored.
+ */
+static tFlashStoreEntry *FlashStoreFind(uint8_t key)
+{
+    unsigned char i;
+
+    for (i = 0; i < FLASHSTORE_KEYS; i++)
+    {
+        if (entries[i].Key == key)
+        {
+            return &entries[i];
+        }
+    }
+
+    return NULL;
+}
+
+/**
+ * Makes a record the newest one of its key.
+ * @param key Key.
+ * @param address Address of the record.
+ * @param length Bytes of its value, 0 deletes the key.
+ * @return False if the index is full.
+ */
+static bool FlashStoreIndex(uint8_t key, uint32_t address, uint8_t length)
+{
+    tFlashStoreEntry *entry = FlashStoreFind(key);
+
+    if (entry != NULL)
+    {
+        live -= FLASHSTORE_RECORD_HEADER + entry->Length;
+        entry->Key = FLASHSTORE_NO_KEY;
+    }
+
+    if (length == 0)
+    {
+        return true;
+    }
+
+    if (entry == NULL)
+    {
+        entry = FlashStoreFind(FLASHSTORE_NO_KEY);
+
+        if (entry == NULL)
+        {
+            return false;
+        }
+    }
+
+    entry->Address = address;
+    entry->Key = key;
+    entry->Length = length;
+    live += FLASHSTORE_RECORD_HEADER + length;
+
+    return true;
+}
+
+/**
+ * Makes the sector after the head the new head, erased and with its header.
+ * @return False if all the sectors are in use.
+ */
+static bool FlashStoreOpen(void)
+{
+    tFlashStoreSector header;
+    uint16_t sector;
+    uint32_t address;
+
+    if (used == FLASHSTORE_SECTORS)
+    {
+        return false;
+    }
+
+    sector = (used == 0) ? head : (head + 1) % FLASHSTORE_SECTORS;
+    address = FlashStoreAddress(sector);
+
+    //the collection erases the sectors it frees, the other ones are erased here
+    FlashReadBuffer(address, (uint8_t *) &header, sizeof (header));
+
+    if ((header.Sequence != 0xFFFFFFFFUL) || (header.Magic != 0xFFFF) ||
+        (header.Check != 0xFFFF))
+    {
+        FlashSector4KErase(address);
+        FlashStoreStatistics.Erases++;
+    }
+
+    header.Sequence = headSequence + 1;
+    header.Magic = FLASHSTORE_MAGIC;
+    header.Check = FlashStoreSectorCheck(header.Sequence);
+    FlashWriteBuffer(address, (const uint8_t *) &header, sizeof (header));
+
+    if (used == 0)
+    {
+        tail = sector;
+        tailOffset = FLASHSTORE_SECTOR_HEADER;
+    }
+
+    head = sector;
+    headOffset = FLASHSTORE_SECTOR_HEADER;
+    headSequence = header.Sequence;
+    used++;
+
+    return true;
+}
+
+/**
+ * Makes room at the head for a record, opening a new sector if it doesn't
+ * fit.
+ * @param length Bytes of the value.
+ * @return The address of the record, or 0 if no sector could be opened.
+ */
+static uint32_t FlashStoreReserve(uint8_t length)
+{
+    uint32_t address;
+
+    if ((used == 0) ||
+        (headOffset + FLASHSTORE_RECORD_HEADER + length > FLASHSTORE_SECTOR_SIZE))
+    {
+        if (!FlashStoreOpen())
+        {
+            return 0;
+        }
+    }
+
+    address = FlashStoreAddress(head) + headOffset;
+    headOffset += FLASHSTORE_RECORD_HEADER + length;
+
+    return address;
+}
+
+/**
+ * Copies a current record to the head.
+ * @param entry Entry of the record, its address is changed.
+ * @param record Header of the record.
+ * @return False if no sector could be opened.
+ */
+static bool FlashStoreCopy(tFlashStoreEntry *entry, const tFlashStoreRecord *record)
+{
+    uint32_t from = entry->Address + FLASHSTORE_RECORD_HEADER;
+    uint32_t to = FlashStoreReserve(record->Length);
+    uint8_t length = record->Length;
+    uint8_t part;
+
+    if (to == 0)
+    {
+        return false;
+    }
+
+    entry->Address = to;
+    FlashWriteBuffer(to, (const uint8_t *) record, sizeof (*record));
+    to += FLASHSTORE_RECORD_HEADER;
+
+    while (length != 0)
+    {
+        part = (length > FLASHSTORE_CHUNK) ? FLASHSTORE_CHUNK : length;
+        FlashReadBuffer(from, chunk, part);
+        FlashWriteBuffer(to, chunk, part);
+        from += part;
+        to += part;
+        length -= part;
+    }
+
+    FlashStoreStatistics.Copies++;
+
+    return true;
+}
+
+/**
+ * One step of the collection of the tail: copies its next current record,
+ * or erases it if there is none left.
+ * @return False if the tail can't be collected, it is the head.
+ */
+static bool FlashStoreCollect(void)
+{
+    tFlashStoreRecord record;
+    tFlashStoreEntry *entry;
+    uint32_t address = FlashStoreAddress(tail);
+
+    if (used <= 1)
+    {
+        return false;
+    }
+
+    while (tailOffset + FLASHSTORE_RECORD_HEADER <= FLASHSTORE_SECTOR_SIZE)
+    {
+        FlashReadBuffer(address + tailOffset, (uint8_t *) &record, sizeof (record));
+
+        if ((record.Key == FLASHSTORE_NO_KEY) ||
+            (tailOffset + FLASHSTORE_RECORD_HEADER + record.Length > FLASHSTORE_SECTOR_SIZE))
+        {
+            break;
+        }
+
+        entry = FlashStoreFind(record.Key);
+        tailOffset += FLASHSTORE_RECORD_HEADER + record.Length;
+
+        //older records and deletions are dropped
+        if ((entry != NULL) && (entry->Address == address + tailOffset -
+                                FLASHSTORE_RECORD_HEADER - record.Length))
+        {
+            return FlashStoreCopy(entry, &record);
+        }
+    }
+
+    FlashSector4KErase(address);
+    FlashStoreStatistics.Erases++;
+    tail = (tail + 1) % FLASHSTORE_SECTORS;
+    tailOffset = FLASHSTORE_SECTOR_HEADER;
+    used--;
+
+    return true;
+}
+
+/**
+ * Appends a record to the head. A new sector is only opened if one is left
+ * for the collection after it, the collection is done first if needed.
+ * @param key Key.
+ * @param data Value.
+ * @param length Bytes of the value, 0 to delete the key.
+ * @return The address of the record, or 0 on failure.
+ */
+static uint32_t FlashStoreAppend(uint8_t key, const void *data, uint8_t length)
+{
+    tFlashStoreRecord record;
+    uint32_t address;
+
+    if ((used == 0) ||
+        (headOffset + FLASHSTORE_RECORD_HEADER + length > FLASHSTORE_SECTOR_SIZE))
+    {
+        while (FLASHSTORE_SECTORS - used < 2)
+        {
+            if (!FlashStoreCollect())
+            {
+                return 0;
+            }
+        }
+    }
+
+    address = FlashStoreReserve(length);
+
+    if (address == 0)
+    {
+        return 0;
+    }
+
+    record.Key = key;
+    record.Length = length;
+    record.Check = (uint16_t) CRCDeviceCompute(CRCDeviceCompute(CRC_DEVICE_INIT, &record.Key, 2),
+                                               data, length);
+
+    FlashWriteBuffer(address, (const uint8_t *) &record, sizeof (record));
+
+    if (length != 0)
+    {
+        FlashWriteBuffer(address + FLASHSTORE_RECORD_HEADER, (const uint8_t *) data, length);
+    }
+
+    return address;
+}
+
+/**
+ * Finds the sectors in use and builds the index from their records. The
+ * sector written last before a power loss is not written again, it may end
+ * with a record cut short.
+ * @return False if the region holds no sector in use, the store is empty.
+ */
+bool FlashStoreInit(void)
+{
+    tFlashStoreRecord record;
+    uint32_t sequence;
+    uint32_t previous;
+    uint32_t address;
+    uint16_t sector;
+    uint16_t offset;
+    uint16_t i;
+
+    CRCDeviceInit();
+
+    for (i = 0; i < FLASHSTORE_KEYS; i++)
+    {
+        entries[i].Key = FLASHSTORE_NO_KEY;
+    }
+
+    FlashStoreStatistics.Erases = 0;
+    FlashStoreStatistics.Copies = 0;
+    FlashStoreStatistics.Corrupted = 0;
+    live = 0;
+    used = 0;
+    head = 0;
+    headSequence = 0;
+
+    //the head is the sector with the highest sequence number
+    for (i = 0; i < FLASHSTORE_SECTORS; i++)
+    {
+        if (FlashStoreReadSector(i, &sequence) &&
+            ((used == 0) || (sequence > headSequence)))
+        {
+            head = i;
+            headSequence = sequence;
+            used = 1;
+        }
+    }
+
+    if (used == 0)
+    {
+        return false;
+    }
+
+    //the tail is found going back while the sequence numbers follow
+    tail = head;
+    sequence = headSequence;
+
+    while (used < FLASHSTORE_SECTORS)
+    {
+        sector = (tail + FLASHSTORE_SECTORS - 1) % FLASHSTORE_SECTORS;
+
+        if (!FlashStoreReadSector(sector, &previous) || (previous != sequence - 1))
+        {
+            break;
+        }
+
+        tail = sector;
+        sequence = previous;
+        used++;
+    }
+
+    tailOffset = FLASHSTORE_SECTOR_HEADER;
+
+    //the records, from the oldest one
+    for (i = 0, sector = tail; i < used; i++, sector = (sector + 1) % FLASHSTORE_SECTORS)
+    {
+        offset = FLASHSTORE_SECTOR_HEADER;
+
+        while (offset + FLASHSTORE_RECORD_HEADER <= FLASHSTORE_SECTOR_SIZE)
+        {
+            address = FlashStoreAddress(sector) + offset;
+            FlashReadBuffer(address, (uint8_t *) &record, sizeof (record));
+
+            if (record.Key == FLASHSTORE_NO_KEY)
+            {
+                break;
+            }
+
+            if ((offset + FLASHSTORE_RECORD_HEADER + record.Length > FLASHSTORE_SECTOR_SIZE) ||
+                (record.Check != FlashStoreRecordCheck(address, &record)))
+            {
+                //nothing is written after it
+                FlashStoreStatistics.Corrupted++;
+                offset = FLASHSTORE_SECTOR_SIZE;
+                break;
+            }
+
+            FlashStoreIndex(record.Key, address, record.Length);
+            offset += FLASHSTORE_RECORD_HEADER + record.Length;
+        }
+
+        headOffset = offset;
+    }
+
+    return true;
+}
+
+/**
+ * Erases the whole region, the store is then empty.
+ */
+void FlashStoreFormat(void)
+{
+    uint16_t i;
+
+    for (i = 0; i < FLASHSTORE_SECTORS; i++)
+    {
+        FlashSector4KErase(FlashStoreAddress(i));
+    }
+
+    FlashStoreInit();
+    FlashStoreStatistics.Erases = FLASHSTORE_SECTORS;
+}
+
+/**
+ * Stores a value, it replaces the one the key had.
+ * @param key Key, from 0 to 0xFE.
+ * @param data Value.
+ * @param length Bytes of the value, 1 to 255.
+ * @return False if the index or the region is full.
+ */
+bool FlashStoreWrite(uint8_t key, const void *data, uint8_t length)
+{
+    tFlashStoreEntry *entry;
+    uint32_t total = live + FLASHSTORE_RECORD_HEADER + length;
+    uint32_t address;
+
+    if ((key == FLASHSTORE_NO_KEY) || (length == 0))
+    {
+        return false;
+    }
+
+    entry = FlashStoreFind(key);
+
+    if (entry != NULL)
+    {
+        total -= FLASHSTORE_RECORD_HEADER + entry->Length;
+    }
+    else if (FlashStoreFind(FLASHSTORE_NO_KEY) == NULL)
+    {
+        return false;
+    }
+
+    if (total > FLASHSTORE_CAPACITY)
+    {
+        return false;
+    }
+
+    address = FlashStoreAppend(key, data, length);
+
+    if (address == 0)
+    {
+        return false;
+    }
+
+    return FlashStoreIndex(key, address, length);
+}
+
+/**
+ * Deletes a key.
+ * @param key Key.
+ * @return False if the deletion could not be written.
+ */
+bool FlashStoreDelete(uint8_t key)
+{
+    if (FlashStoreFind(key) == NULL)
+    {
+        return true;
+    }
+
+    if (FlashStoreAppend(key, NULL, 0) == 0)
+    {
+        return false;
+    }
+
+    return FlashStoreIndex(key, 0, 0);
+}
+
+/**
+ * Reads the value of a key.
+ * @param key Key.
+ * @param buffer Buffer of the value.
+ * @param size Size of the buffer, a longer value is cut.
+ * @return The length of the value, -1 if the key is not stored.
+ */
+int FlashStoreRead(uint8_t key, void *buffer, uint8_t size)
+{
+    tFlashStoreEntry *entry = FlashStoreFind(key);
+
+    if (entry == NULL)
+    {
+        return -1;
+    }
+
+    if (size > entry->Length)
+    {
+        size = entry->Length;
+    }
+
+    FlashReadBuffer(entry->Address + FLASHSTORE_RECORD_HEADER, (uint8_t *) buffer, size);
+
+    return entry->Length;
+}
+
+/**
+ * Does a step of the collection when less than FLASHSTORE_FREE_SECTORS
+ * sectors are erased. Called from the main loop or a task, it returns at
+ * once while the flash is busy.
+ */
+void FlashStoreTasks(void)
+{
+    if ((FLASHSTORE_SECTORS - used >= FLASHSTORE_FREE_SECTORS) || FlashIsBusy())
+    {
+        return;
+    }
+
+    FlashStoreCollect();
+}
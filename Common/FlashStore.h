@@ -0,0 +1,103 @@
+/**
+ *  @file       FlashStore.h
+ *  @author     Luis Maduro
+ *  @version    1.00
+ *  @date       14/10/2026
+ *  @brief      Log structured key/value store on the SST25VF064C.
+ *
+ *  The values are appended as records to a ring of 4 KB sectors, so an
+ *  update costs a page program instead of an erase and a rewrite, and the
+ *  erases go round all the sectors of the region. Every sector starts with
+ *  a header with its sequence number. FlashStoreInit() reads the sectors in
+ *  the order they were written and keeps in RAM the address of the newest
+ *  record of every key.
+ *
+ *  FlashStoreTasks() collects the oldest sector when less than
+ *  FLASHSTORE_FREE_SECTORS are erased: one call copies one record that is
+ *  still current to the head, or erases the sector once it holds none. It
+ *  returns at once while the flash is busy. A write that finds no erased
+ *  sector does the collection itself.
+ *
+ *  The region must not be write protected (see FlashWriteSR()) and is only
+ *  used by the store.
+ *
+ *  Copyright (C) 2026  Luis Maduro
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef FLASHSTORE_H
+#define FLASHSTORE_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "SST25VF064C.h"
+
+/**Address of the first sector of the region, at a 4 KB boundary.*/
+#ifndef FLASHSTORE_ADDRESS
+#define FLASHSTORE_ADDRESS          0x700000UL
+#endif
+
+/**Sectors of the region, 3 or more. Up to 2048, the whole SST25VF064C, the
+ more sectors the less each one is erased but the longer FlashStoreInit()
+ reads.*/
+#ifndef FLASHSTORE_SECTORS
+#define FLASHSTORE_SECTORS          16
+#endif
+
+/**Keys kept in the RAM index, 6 bytes each.*/
+#ifndef FLASHSTORE_KEYS
+#define FLASHSTORE_KEYS             16
+#endif
+
+/**Erased sectors kept ahead of the head by FlashStoreTasks().*/
+#ifndef FLASHSTORE_FREE_SECTORS
+#define FLASHSTORE_FREE_SECTORS     2
+#endif
+
+#if FLASHSTORE_SECTORS < 3
+#error "FlashStore needs 3 or more sectors"
+#endif
+
+/**Key of the erased flash, not a valid key.*/
+#define FLASHSTORE_NO_KEY           0xFF
+
+/**Header of a sector and of a record.*/
+#define FLASHSTORE_SECTOR_HEADER    8
+#define FLASHSTORE_RECORD_HEADER    4
+
+/**
+ * Counters of the store.
+ */
+typedef struct
+{
+    /**Sectors erased since FlashStoreInit().*/
+    uint16_t Erases;
+    /**Records copied by the collection.*/
+    uint16_t Copies;
+    /**Records with a bad check found by FlashStoreInit(), i.e. cut by a
+     power loss.*/
+    uint16_t Corrupted;
+} tFlashStoreStatistics;
+
+extern tFlashStoreStatistics FlashStoreStatistics;
+
+bool FlashStoreInit(void);
+void FlashStoreFormat(void);
+bool FlashStoreWrite(uint8_t key, const void *data, uint8_t length);
+bool FlashStoreDelete(uint8_t key);
+int FlashStoreRead(uint8_t key, void *buffer, uint8_t size);
+void FlashStoreTasks(void);
+
+#endif /* FLASHSTORE_H */
@@ -9,10 +9,35 @@
  
 #include "I2CDevice.h"
 #include "HMC5883L.h"
+#include "RegisterTable.h"
 
 unsigned char HMC5883LBuffer[6];
 unsigned char mode;
 
+/**Registers written by HMC5883LInitialize(), CONFIG_A to MODE in one burst.*/
+static const tRegisterWrite HMC5883LInitTable[] = {
+    {HMC5883L_RA_CONFIG_A,
+        (HMC5883L_AVERAGING_8 << (HMC5883L_CRA_AVERAGE_BIT - HMC5883L_CRA_AVERAGE_LENGTH + 1)) |
+        (HMC5883L_RATE_15 << (HMC5883L_CRA_RATE_BIT - HMC5883L_CRA_RATE_LENGTH + 1)) |
+        (HMC5883L_BIAS_NORMAL << (HMC5883L_CRA_BIAS_BIT - HMC5883L_CRA_BIAS_LENGTH + 1)),
+        REGISTER_ALL_BITS, 0},
+    {HMC5883L_RA_CONFIG_B,
+        HMC5883L_GAIN_1090 << (HMC5883L_CRB_GAIN_BIT - HMC5883L_CRB_GAIN_LENGTH + 1),
+        REGISTER_ALL_BITS, 0},
+    {HMC5883L_RA_MODE,
+        HMC5883L_MODE_SINGLE << (HMC5883L_MODEREG_BIT - HMC5883L_MODEREG_LENGTH + 1),
+        REGISTER_ALL_BITS, 0}
+};
+
+static void HMC5883LWriteRegisters(unsigned char address,
+                                   unsigned char length,
+                                   unsigned char *data)
+{
+    I2CDeviceWriteBytes(address, length, data);
+}
+
+static const tRegisterBus HMC5883LBus = {HMC5883LWriteRegisters, NULL, NULL, 1};
+
 /**
  * Power on and prepare for general usage.
  * This will prepare the magnetometer with default settings, ready for single-
@@ -24,18 +49,9 @@ unsigned char mode;
  */
 void HMC5883LInitialize(void)
 {
-    // write CONFIG_A register
-    //I2CDeviceWriteByte(HMC5883L_RA_CONFIG_A, 0b01110000);
-    I2CDeviceWriteByte(HMC5883L_RA_CONFIG_A,
-                       (HMC5883L_AVERAGING_8 << (HMC5883L_CRA_AVERAGE_BIT - HMC5883L_CRA_AVERAGE_LENGTH + 1)) |
-                       (HMC5883L_RATE_15 << (HMC5883L_CRA_RATE_BIT - HMC5883L_CRA_RATE_LENGTH + 1)) |
-                       (HMC5883L_BIAS_NORMAL << (HMC5883L_CRA_BIAS_BIT - HMC5883L_CRA_BIAS_LENGTH + 1)));
-
-    // write CONFIG_B register
-    HMC5883LSetGain(HMC5883L_GAIN_1090);
-
-    // write MODE register
-    HMC5883LSetMode(HMC5883L_MODE_SINGLE);
+    RegisterTableWrite(&HMC5883LBus, HMC5883LInitTable,
+                       sizeof (HMC5883LInitTable) / sizeof (HMC5883LInitTable[0]));
+    mode = HMC5883L_MODE_SINGLE;
 }
 
 /**
@@ -246,7 +262,7 @@ void HMC5883LSetMode(unsigned char newMode)
     // requirement specified in the datasheet; it's actually more efficient than
     // using the I2Cdev.writeBits method
     I2CDeviceWriteByte(HMC5883L_RA_MODE,
-                       mode << (HMC5883L_MODEREG_BIT - HMC5883L_MODEREG_LENGTH + 1));
+                       newMode << (HMC5883L_MODEREG_BIT - HMC5883L_MODEREG_LENGTH + 1));
     mode = newMode; // track to tell if we have to clear bit 7 after a read
 }
 
@@ -277,6 +293,69 @@ void HMC5883LGetHeading(int *x, int *y, int *z)
     *z = (((int) HMC5883LBuffer[2]) << 8) | HMC5883LBuffer[3];
 }
 
+/**
+ * Get the heading of the sensor held level, the angle of the horizontal
+ * field from the X axis, by the CORDIC of FixedMath.c instead of atan2().
+ * The tilt is not compensated.
+ * @return Heading, FIXED_MATH_TO_DECIDEGREES() for tenths of a degree
+ * @see HMC5883LGetHeading()
+ */
+tFixedAngle HMC5883LGetHeadingAngle(void)
+{
+    int x, y, z;
+
+    HMC5883LGetHeading(&x, &y, &z);
+
+    return FixedMathAtan2(y, x);
+}
+
+/**
+ * Starts the continuous measurement mode, to read the samples on the DRDY
+ * pin with HMC5883LStreamRead(). The registers of the data are then read
+ * once, so the register pointer of the chip is left on DATAX_H: after
+ * DATAY_L is read the pointer goes back to DATAX_H by itself, and every read
+ * of the stream is a single 6 bytes burst without the register address.
+ * @param rate Data output rate, HMC5883L_RATE_0P75 to HMC5883L_RATE_75
+ * @param averaging Samples averaged per measurement, HMC5883L_AVERAGING_1 to
+ *                  HMC5883L_AVERAGING_8
+ * @see HMC5883LSetDataRate()
+ * @see HMC5883LSetSampleAveraging()
+ */
+void HMC5883LStreamBegin(unsigned char rate, unsigned char averaging)
+{
+    HMC5883LSetSampleAveraging(averaging);
+    HMC5883LSetDataRate(rate);
+    HMC5883LSetMode(HMC5883L_MODE_CONTINUOUS);
+
+    I2CDeviceReadBytes(HMC5883L_RA_DATAX_H, 6,
+                       HMC5883LBuffer);
+}
+
+/**
+ * Reads a sample of the continuous mode, from the interrupt of DRDY or after
+ * it. Any access to another register moves the register pointer, call
+ * HMC5883LGetHeading() (it reads the 6 registers of the data and leaves the
+ * pointer back on DATAX_H) before going on with the stream.
+ * @param x 16-bit signed integer container for X-axis heading
+ * @param y 16-bit signed integer container for Y-axis heading
+ * @param z 16-bit signed integer container for Z-axis heading
+ * @return false if an axis overflowed (-4096)
+ * @see HMC5883LStreamBegin()
+ */
+boolean HMC5883LStreamRead(int *x, int *y, int *z)
+{
+    I2CDeviceReadCurrentBytes(6, HMC5883LBuffer);
+
+    *x = (((int) HMC5883LBuffer[0]) << 8) | HMC5883LBuffer[1];
+    *y = (((int) HMC5883LBuffer[4]) << 8) | HMC5883LBuffer[5];
+    *z = (((int) HMC5883LBuffer[2]) << 8) | HMC5883LBuffer[3];
+
+    //-4096 is 0xF000
+    return !((HMC5883LBuffer[0] == 0xF0 && HMC5883LBuffer[1] == 0x00) ||
+            (HMC5883LBuffer[2] == 0xF0 && HMC5883LBuffer[3] == 0x00) ||
+            (HMC5883LBuffer[4] == 0xF0 && HMC5883LBuffer[5] == 0x00));
+}
+
 /**
  * Get X-axis heading measurement.
  * @return 16-bit signed integer with X-axis heading
@@ -12,6 +12,7 @@
 
 #include "stdboolean.h"
 #include "I2CDevice.h"
+#include "FixedMath.h"
 
 #define HMC5883L_ADDRESS       0x1E
 
@@ -85,6 +86,9 @@ int HMC5883LGetHeadingZ(void);
 int HMC5883LGetHeadingY(void);
 int HMC5883LGetHeadingX(void);
 void HMC5883LGetHeading(int *x, int *y, int *z);
+tFixedAngle HMC5883LGetHeadingAngle(void);
+void HMC5883LStreamBegin(unsigned char rate, unsigned char averaging);
+boolean HMC5883LStreamRead(int *x, int *y, int *z);
 unsigned char HMC5883LGetMode(void);
 unsigned char HMC5883LGetGain(void);
 void HMC5883LSetMeasurementBias(unsigned char bias);
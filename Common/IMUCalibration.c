@@ -0,0 +1,562 @@
+/**
+ *  @file       IMUCalibration.c
+ *  @author     Luis Maduro
+ *  @version    1.00
+ *  @date       14/10/2026
+ *  @brief      Calibration of accelerometers and magnetometers.
+ *
+ *  Copyright (C) 2026  Luis Maduro
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <stddef.h>
+#include <math.h>
+#include "IMUCalibration.h"
+#ifdef IMU_CALIBRATION_USE_ADXL345
+#include "ADXL345.h"
+#endif
+#ifdef IMU_CALIBRATION_USE_FLASH
+#include "SST25VF064C.h"
+#endif
+#ifdef IMU_CALIBRATION_USE_FLASHSTORE
+#include "FlashStore.h"
+#endif
+
+/**Identifier of a calibration in the flash.*/
+#define IMU_CALIBRATION_MAGIC       0x4943
+/**The magnetometer values are divided by this in the fit, so the terms of
+ the normal equations are all close to 1.*/
+#define MAG_FIT_SCALE               1024.0
+/**Unknowns of the ellipsoid fit.*/
+#define MAG_FIT_TERMS               6
+
+/**
+ * Magnetometer calibration, min/max and the normal equations of the fit.
+ */
+static struct
+{
+    int minimum[3];
+    int maximum[3];
+    unsigned int count;
+    /**Upper triangle of the sum of v * v', v = (x^2, y^2, z^2, x, y, z).*/
+    float normal[MAG_FIT_TERMS * (MAG_FIT_TERMS + 1) / 2];
+    /**Sum of v.*/
+    float sum[MAG_FIT_TERMS];
+} mag;
+
+/**
+ * Accelerometer calibration, sum of the vertical axis on every face.
+ */
+static struct
+{
+    int32_t sum[6];
+    unsigned char count[6];
+} accel;
+
+/**
+ * Correction that does nothing, offset 0 and scale 1.
+ * @param axes Correction.
+ */
+void IMUCalibrationReset(tIMUCalibrationAxes *axes)
+{
+    unsigned char i;
+
+    for (i = 0; i < 3; i++)
+    {
+        axes->offset[i] = 0;
+        axes->scale[i] = IMU_CALIBRATION_ONE;
+    }
+}
+
+/**
+ * Corrects a sample.
+ * @param axes Correction.
+ * @param x Values of the sample, replaced by the corrected ones.
+ */
+void IMUCalibrationCorrect(const tIMUCalibrationAxes *axes, int *x, int *y, int *z)
+{
+    *x = (int) (((int32_t) (*x - axes->offset[0]) * axes->scale[0]) >> 14);
+    *y = (int) (((int32_t) (*y - axes->offset[1]) * axes->scale[1]) >> 14);
+    *z = (int) (((int32_t) (*z - axes->offset[2]) * axes->scale[2]) >> 14);
+}
+
+/**
+ * Starts a magnetometer calibration.
+ */
+void IMUCalibrationMagBegin(void)
+{
+    unsigned char i;
+
+    for (i = 0; i < 3; i++)
+    {
+        mag.minimum[i] = 32767;
+        mag.maximum[i] = -32767;
+    }
+
+    for (i = 0; i < sizeof (mag.normal) / sizeof (mag.normal[0]); i++)
+    {
+        mag.normal[i] = 0;
+    }
+
+    for (i = 0; i < MAG_FIT_TERMS; i++)
+    {
+        mag.sum[i] = 0;
+    }
+
+    mag.count = 0;
+}
+
+/**
+ * Adds a sample of the magnetometer.
+ * @param x Raw values.
+ */
+void IMUCalibrationMagAdd(int x, int y, int z)
+{
+    int raw[3];
+    float v[MAG_FIT_TERMS];
+    unsigned char i;
+    unsigned char j;
+    unsigned char k = 0;
+
+    raw[0] = x;
+    raw[1] = y;
+    raw[2] = z;
+
+    for (i = 0; i < 3; i++)
+    {
+        if (raw[i] < mag.minimum[i])
+            mag.minimum[i] = raw[i];
+        if (raw[i] > mag.maximum[i])
+            mag.maximum[i] = raw[i];
+
+        v[i + 3] = (float) (raw[i] / MAG_FIT_SCALE);
+        v[i] = v[i + 3] * v[i + 3];
+    }
+
+    for (i = 0; i < MAG_FIT_TERMS; i++)
+    {
+        for (j = i; j < MAG_FIT_TERMS; j++)
+        {
+            mag.normal[k++] += v[i] * v[j];
+        }
+
+        mag.sum[i] += v[i];
+    }
+
+    mag.count++;
+}
+
+/**
+ * Number of samples of the magnetometer calibration.
+ */
+unsigned int IMUCalibrationMagCount(void)
+{
+    return mag.count;
+}
+
+/**
+ * Solves the normal equations of the fit, Gauss with partial pivoting.
+ * @return false if the system is singular, the samples don't cover all the
+ *         directions.
+ */
+static boolean IMUCalibrationMagSolve(float *solution)
+{
+    float m[MAG_FIT_TERMS][MAG_FIT_TERMS + 1];
+    float factor;
+    float t;
+    unsigned char i;
+    unsigned char j;
+    unsigned char k = 0;
+    unsigned char pivot;
+
+    for (i = 0; i < MAG_FIT_TERMS; i++)
+    {
+        for (j = i; j < MAG_FIT_TERMS; j++)
+        {
+            m[i][j] = mag.normal[k];
+            m[j][i] = mag.normal[k++];
+        }
+
+        m[i][MAG_FIT_TERMS] = mag.sum[i];
+    }
+
+    for (i = 0; i < MAG_FIT_TERMS; i++)
+    {
+        pivot = i;
+
+        for (j = i + 1; j < MAG_FIT_TERMS; j++)
+        {
+            if (fabs(m[j][i]) > fabs(m[pivot][i]))
+                pivot = j;
+        }
+
+        if (fabs(m[pivot][i]) < 1e-9)
+            return false;
+
+        for (k = i; k <= MAG_FIT_TERMS; k++)
+        {
+            t = m[i][k];
+            m[i][k] = m[pivot][k];
+            m[pivot][k] = t;
+        }
+
+        for (j = i + 1; j < MAG_FIT_TERMS; j++)
+        {
+            factor = m[j][i] / m[i][i];
+
+            for (k = i; k <= MAG_FIT_TERMS; k++)
+            {
+                m[j][k] -= factor * m[i][k];
+            }
+        }
+    }
+
+    for (i = MAG_FIT_TERMS; i-- > 0;)
+    {
+        t = m[i][MAG_FIT_TERMS];
+
+        for (k = i + 1; k < MAG_FIT_TERMS; k++)
+        {
+            t -= m[i][k] * solution[k];
+        }
+
+        solution[i] = t / m[i][i];
+    }
+
+    return true;
+}
+
+/**
+ * Scale of every axis from its radius, to the mean radius.
+ */
+static void IMUCalibrationScale(tIMUCalibrationAxes *axes, const float *radius)
+{
+    float mean = (radius[0] + radius[1] + radius[2]) / 3;
+    unsigned char i;
+
+    for (i = 0; i < 3; i++)
+    {
+        axes->scale[i] = (int16_t) (IMU_CALIBRATION_ONE * mean / radius[i] + 0.5);
+    }
+}
+
+/**
+ * Ends a magnetometer calibration. The ellipsoid fit is used if there are
+ * enough samples and its result agrees with the min/max, otherwise the
+ * min/max is used.
+ * @param axes Correction of the magnetometer, hard iron offset and soft
+ *             iron scale.
+ * @return false if the samples don't cover the axes, the correction is not
+ *         changed.
+ */
+boolean IMUCalibrationMagFinish(tIMUCalibrationAxes *axes)
+{
+    float solution[MAG_FIT_TERMS];
+    float center[3];
+    float radius[3];
+    float g = 1;
+    float half;
+    unsigned char i;
+    boolean fit;
+
+    for (i = 0; i < 3; i++)
+    {
+        if (mag.maximum[i] <= mag.minimum[i])
+            return false;
+    }
+
+    fit = (mag.count >= IMU_CALIBRATION_MAG_SAMPLES) &&
+            IMUCalibrationMagSolve(solution);
+
+    for (i = 0; fit && i < 3; i++)
+    {
+        if (solution[i] <= 0)
+        {
+            fit = false;
+            break;
+        }
+
+        center[i] = -solution[i + 3] / (2 * solution[i]);
+        g += solution[i] * center[i] * center[i];
+    }
+
+    for (i = 0; fit && i < 3; i++)
+    {
+        radius[i] = (float) (sqrt(g / solution[i]) * MAG_FIT_SCALE);
+        center[i] *= (float) MAG_FIT_SCALE;
+        half = (mag.maximum[i] - mag.minimum[i]) / 2.0f;
+
+        //the fit has to be close to the box of the samples
+        if ((center[i] < mag.minimum[i]) || (center[i] > mag.maximum[i]) ||
+            (radius[i] < half * 0.5f) || (radius[i] > half * 2.0f))
+        {
+            fit = false;
+        }
+    }
+
+    for (i = 0; i < 3; i++)
+    {
+        if (!fit)
+        {
+            center[i] = (mag.maximum[i] + mag.minimum[i]) / 2.0f;
+            radius[i] = (mag.maximum[i] - mag.minimum[i]) / 2.0f;
+        }
+
+        axes->offset[i] = (int) (center[i] + (center[i] < 0 ? -0.5f : 0.5f));
+    }
+
+    IMUCalibrationScale(axes, radius);
+
+    return true;
+}
+
+/**
+ * Starts an accelerometer calibration.
+ */
+void IMUCalibrationAccelBegin(void)
+{
+    unsigned char i;
+
+    for (i = 0; i < 6; i++)
+    {
+        accel.sum[i] = 0;
+        accel.count[i] = 0;
+    }
+}
+
+static int IMUCalibrationAbs(int value)
+{
+    return value < 0 ? -value : value;
+}
+
+/**
+ * Adds a sample of the accelerometer, the board has to be still. The
+ * sample is used if one axis is clearly vertical (the other two below half
+ * of it) and its face is not complete.
+ * @param x Raw values.
+ * @return IMU_CALIBRATION_FACE_X_UP... of the face of the sample, 0 if not
+ *         used.
+ */
+unsigned char IMUCalibrationAccelAdd(int x, int y, int z)
+{
+    int raw[3];
+    unsigned char axis = 0;
+    unsigned char face;
+    unsigned char i;
+
+    raw[0] = x;
+    raw[1] = y;
+    raw[2] = z;
+
+    for (i = 1; i < 3; i++)
+    {
+        if (IMUCalibrationAbs(raw[i]) > IMUCalibrationAbs(raw[axis]))
+            axis = i;
+    }
+
+    for (i = 0; i < 3; i++)
+    {
+        if ((i != axis) &&
+            (IMUCalibrationAbs(raw[i]) * 2 > IMUCalibrationAbs(raw[axis])))
+        {
+            return 0;
+        }
+    }
+
+    face = axis * 2 + (raw[axis] < 0 ? 1 : 0);
+
+    if (accel.count[face] >= IMU_CALIBRATION_ACCEL_SAMPLES)
+        return 0;
+
+    accel.sum[face] += raw[axis];
+    accel.count[face]++;
+
+    return 1 << face;
+}
+
+/**
+ * Faces of the accelerometer calibration that are complete.
+ * @return IMU_CALIBRATION_FACE_X_UP..., IMU_CALIBRATION_FACES_ALL when the
+ *         calibration can end.
+ */
+unsigned char IMUCalibrationAccelFaces(void)
+{
+    unsigned char faces = 0;
+    unsigned char i;
+
+    for (i = 0; i < 6; i++)
+    {
+        if (accel.count[i] >= IMU_CALIBRATION_ACCEL_SAMPLES)
+            faces |= 1 << i;
+    }
+
+    return faces;
+}
+
+/**
+ * Ends an accelerometer calibration, the offset of every axis is the middle
+ * of up and down and the scale takes half of their difference to 1 g.
+ * @param axes Correction of the accelerometer.
+ * @param oneG Value of 1 g after the correction, in LSB (i.e. 256 for the
+ *             ADXL345 in full resolution).
+ * @return false if a face is not complete, the correction is not changed.
+ */
+boolean IMUCalibrationAccelFinish(tIMUCalibrationAxes *axes, int oneG)
+{
+    int32_t up;
+    int32_t down;
+    unsigned char i;
+
+    if (IMUCalibrationAccelFaces() != IMU_CALIBRATION_FACES_ALL)
+        return false;
+
+    for (i = 0; i < 3; i++)
+    {
+        up = accel.sum[i * 2] / IMU_CALIBRATION_ACCEL_SAMPLES;
+        down = accel.sum[i * 2 + 1] / IMU_CALIBRATION_ACCEL_SAMPLES;
+
+        if (up - down <= 0)
+            return false;
+
+        axes->offset[i] = (int) ((up + down) / 2);
+        axes->scale[i] = (int16_t) (((int32_t) oneG * 2 * IMU_CALIBRATION_ONE +
+                (up - down) / 2) / (up - down));
+    }
+
+    return true;
+}
+
+#ifdef IMU_CALIBRATION_USE_ADXL345
+
+/**
+ * Moves the offset of the accelerometer to the offset registers of the
+ * ADXL345 (15.6 mg/LSB), only the remainder stays in the software
+ * correction. Call after IMUCalibrationAccelFinish() with the format of the
+ * calibration samples, and after IMUCalibrationLoad() to write the registers
+ * again (then the offset of the correction is already the remainder).
+ * @param calibration Calibration, accelHardware and the accelerometer offset
+ *                    are updated.
+ */
+void IMUCalibrationApplyADXL345(tIMUCalibration *calibration)
+{
+    int32_t registerValue;
+    unsigned char halfLsb;
+    unsigned char i;
+
+    //a step of the offset registers in 1/2 LSB of the data
+    halfLsb = ADXL345GetFullResolution() ? 8 : (8 >> ADXL345GetRange());
+
+    for (i = 0; i < 3; i++)
+    {
+        registerValue = calibration->accelHardware[i] -
+                ((int32_t) calibration->accel.offset[i] * 2 + halfLsb / 2) / halfLsb;
+
+        if (registerValue > 127)
+            registerValue = 127;
+        else if (registerValue < -128)
+            registerValue = -128;
+
+        calibration->accel.offset[i] -= (int) (((calibration->accelHardware[i] -
+                registerValue) * halfLsb) / 2);
+        calibration->accelHardware[i] = (signed char) registerValue;
+    }
+
+    ADXL345SetOffset(calibration->accelHardware[0], calibration->accelHardware[1],
+                     calibration->accelHardware[2]);
+}
+#endif
+
+#ifdef IMU_CALIBRATION_USE_FLASH
+
+/**
+ * Fletcher-16 of the calibration, without the checksum.
+ */
+static uint16_t IMUCalibrationChecksum(const tIMUCalibration *calibration)
+{
+    const uint8_t *data = (const uint8_t *) calibration;
+    uint16_t a = 0;
+    uint16_t b = 0;
+    unsigned int i;
+
+    for (i = 0; i < offsetof(tIMUCalibration, checksum); i++)
+    {
+        a = (a + data[i]) % 255;
+        b = (b + a) % 255;
+    }
+
+    return (b << 8) | a;
+}
+
+/**
+ * Saves a calibration in the flash, at IMU_CALIBRATION_FLASH_ADDRESS or in
+ * the FlashStore.
+ * @param calibration Calibration, its magic and checksum are set.
+ */
+void IMUCalibrationSave(tIMUCalibration *calibration)
+{
+    const uint8_t *data = (const uint8_t *) calibration;
+
+    calibration->magic = IMU_CALIBRATION_MAGIC;
+    calibration->checksum = IMUCalibrationChecksum(calibration);
+
+#ifdef IMU_CALIBRATION_USE_FLASHSTORE
+    FlashStoreWrite(IMU_CALIBRATION_FLASHSTORE_KEY, data, sizeof (tIMUCalibration));
+#else
+    FlashSectorErase(IMU_CALIBRATION_FLASH_ADDRESS);
+
+    FlashWriteBuffer(IMU_CALIBRATION_FLASH_ADDRESS, data, sizeof (tIMUCalibration));
+
+    FlashWaitForWrite();
+#endif
+}
+
+/**
+ * Reads the calibration from the flash.
+ * @param calibration Calibration read. If the flash has no valid calibration
+ *                    it is reset to the correction that does nothing.
+ * @return true if the flash had a valid calibration.
+ */
+boolean IMUCalibrationLoad(tIMUCalibration *calibration)
+{
+    unsigned int i;
+
+#ifdef IMU_CALIBRATION_USE_FLASHSTORE
+    if (FlashStoreRead(IMU_CALIBRATION_FLASHSTORE_KEY, calibration,
+                       sizeof (tIMUCalibration)) != sizeof (tIMUCalibration))
+    {
+        calibration->magic = 0;
+    }
+#else
+    FlashReadBuffer(IMU_CALIBRATION_FLASH_ADDRESS, (uint8_t *) calibration,
+                    sizeof (tIMUCalibration));
+#endif
+
+    if ((calibration->magic == IMU_CALIBRATION_MAGIC) &&
+        (calibration->checksum == IMUCalibrationChecksum(calibration)))
+    {
+        return true;
+    }
+
+    IMUCalibrationReset(&calibration->accel);
+    IMUCalibrationReset(&calibration->mag);
+
+    for (i = 0; i < 3; i++)
+    {
+        calibration->accelHardware[i] = 0;
+    }
+
+    return false;
+}
+#endif
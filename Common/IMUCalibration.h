@@ -0,0 +1,146 @@
+/**
+ *  @file       IMUCalibration.h
+ *  @author     Luis Maduro
+ *  @version    1.00
+ *  @date       14/10/2026
+ *  @brief      Calibration of accelerometers and magnetometers.
+ *
+ *  Streaming calibration, the samples are given one at a time and only sums
+ *  are kept:
+ *  - magnetometer, running min/max and a least squares fit of an ellipsoid
+ *    aligned with the axes, a x^2 + b y^2 + c z^2 + d x + e y + f z = 1.
+ *    The center is the hard iron offset and the radii give the soft iron
+ *    scale of every axis. The board is turned in all directions while the
+ *    samples are added;
+ *  - accelerometer, 6 positions, every axis up and down. The position of
+ *    every sample is found from its largest axis, the board is held still
+ *    on every face until IMUCalibrationAccelFaces() has its bit.
+ *
+ *  The result is an offset, subtracted from the raw values, and a scale in
+ *  Q2.14 per axis, applied with IMUCalibrationCorrect(). The ADXL345 has
+ *  offset registers, IMUCalibrationApplyADXL345() moves the offset to them so
+ *  it costs nothing at runtime. The HMC5883L has none (its measurement bias
+ *  is the self test field), its offset stays in the software correction.
+ *
+ *  The fit is done once at the end of the calibration, in float, the
+ *  runtime correction is in fixed point. The calibration is kept in the
+ *  SST25VF064C flash with a checksum.
+ *
+ *  Copyright (C) 2026  Luis Maduro
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef IMUCALIBRATION_H
+#define IMUCALIBRATION_H
+
+#include <stdint.h>
+#include "stdboolean.h"
+
+/*
+ * Comment out to build without the SST25VF064C, IMUCalibrationSave() and
+ * IMUCalibrationLoad() are then not available.
+ */
+#define IMU_CALIBRATION_USE_FLASH
+/*
+ * Comment out to build without the ADXL345 driver.
+ */
+#define IMU_CALIBRATION_USE_ADXL345
+
+/**Address of the calibration in the flash, at the start of a 64 KB block
+ (the block is erased on every save). By default the last block of the
+ SST25VF064C.*/
+#ifndef IMU_CALIBRATION_FLASH_ADDRESS
+#define IMU_CALIBRATION_FLASH_ADDRESS   0x7F0000UL
+#endif
+
+/*
+ * Uncomment to keep the calibration in the FlashStore under
+ * IMU_CALIBRATION_FLASHSTORE_KEY instead of its own block, a save is then a
+ * page program. FlashStoreInit() is called before IMUCalibrationLoad().
+ */
+//#define IMU_CALIBRATION_USE_FLASHSTORE
+#ifndef IMU_CALIBRATION_FLASHSTORE_KEY
+#define IMU_CALIBRATION_FLASHSTORE_KEY  0x01
+#endif
+
+/**Samples averaged on every face of the accelerometer calibration.*/
+#ifndef IMU_CALIBRATION_ACCEL_SAMPLES
+#define IMU_CALIBRATION_ACCEL_SAMPLES   64
+#endif
+
+/**Minimum number of samples for the ellipsoid fit, with less only the
+ min/max is used.*/
+#ifndef IMU_CALIBRATION_MAG_SAMPLES
+#define IMU_CALIBRATION_MAG_SAMPLES     100
+#endif
+
+/**Scale of 1 in Q2.14.*/
+#define IMU_CALIBRATION_ONE             16384
+
+/**Faces of the accelerometer calibration, bits of IMUCalibrationAccelFaces().*/
+#define IMU_CALIBRATION_FACE_X_UP       0x01
+#define IMU_CALIBRATION_FACE_X_DOWN     0x02
+#define IMU_CALIBRATION_FACE_Y_UP       0x04
+#define IMU_CALIBRATION_FACE_Y_DOWN     0x08
+#define IMU_CALIBRATION_FACE_Z_UP       0x10
+#define IMU_CALIBRATION_FACE_Z_DOWN     0x20
+#define IMU_CALIBRATION_FACES_ALL       0x3F
+
+/**
+ * Correction of the three axes of a sensor,
+ * corrected = (raw - offset) * scale / IMU_CALIBRATION_ONE.
+ */
+typedef struct
+{
+    int offset[3];
+    int16_t scale[3];
+} tIMUCalibrationAxes;
+
+/**
+ * Calibration of a board, as kept in the flash.
+ */
+typedef struct
+{
+    uint16_t magic;
+    tIMUCalibrationAxes accel;
+    tIMUCalibrationAxes mag;
+    /**Offset registers of the ADXL345, written by
+     IMUCalibrationApplyADXL345().*/
+    signed char accelHardware[3];
+    uint16_t checksum;
+} tIMUCalibration;
+
+void IMUCalibrationReset(tIMUCalibrationAxes *axes);
+void IMUCalibrationCorrect(const tIMUCalibrationAxes *axes, int *x, int *y, int *z);
+
+void IMUCalibrationMagBegin(void);
+void IMUCalibrationMagAdd(int x, int y, int z);
+unsigned int IMUCalibrationMagCount(void);
+boolean IMUCalibrationMagFinish(tIMUCalibrationAxes *axes);
+
+void IMUCalibrationAccelBegin(void);
+unsigned char IMUCalibrationAccelAdd(int x, int y, int z);
+unsigned char IMUCalibrationAccelFaces(void);
+boolean IMUCalibrationAccelFinish(tIMUCalibrationAxes *axes, int oneG);
+
+#ifdef IMU_CALIBRATION_USE_ADXL345
+void IMUCalibrationApplyADXL345(tIMUCalibration *calibration);
+#endif
+#ifdef IMU_CALIBRATION_USE_FLASH
+void IMUCalibrationSave(tIMUCalibration *calibration);
+boolean IMUCalibrationLoad(tIMUCalibration *calibration);
+#endif
+
+#endif
@@ -0,0 +1,389 @@
+/**
+ *  @file       IMUFusion.c
+ *  @author     Luis Maduro
+ *  @version    1.00
+ *  @date       14/10/2026
+ *  @brief      Fixed point orientation filter (Mahony).
+ *
+ *  Copyright (C) 2026  Luis Maduro
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "IMUFusion.h"
+
+#define HALF                        (IMU_FUSION_ONE_Q30 / 2)
+
+/**
+ * 1/sqrt(f) in Q1.15 for f in [0.25, 1), 24 steps of 1/32 from the middle
+ * of each step.
+ */
+static const uint16_t invSqrtTable[24] = {
+    63579, 60140, 57205, 54661, 52429, 50450, 48679, 47082,
+    45633, 44310, 43096, 41977, 40940, 39977, 39078, 38238,
+    37449, 36708, 36008, 35347, 34722, 34128, 33564, 33027
+};
+
+static inline q30_t IMUFusionMul(q30_t a, q30_t b)
+{
+    return (q30_t) (((int64_t) a * b) >> 30);
+}
+
+/**
+ * 1/sqrt(f), with x = f * 2^(32 - shift) and f in [0.25, 1).
+ * @param x Value, not 0.
+ * @param shift Where the even shift that normalizes x is stored.
+ * @return 1/sqrt(f) in Q2.30, (1, 2].
+ */
+static uint32_t IMUFusionInvSqrtMantissa(uint32_t x, unsigned char *shift)
+{
+    uint64_t r;
+    uint64_t f;
+    uint64_t t;
+
+    *shift = 0;
+
+    while (x < 0x40000000UL)
+    {
+        x <<= 2;
+        *shift += 2;
+    }
+
+    //f in Q2.30, first guess from the table in Q2.30
+    f = x >> 2;
+    r = (uint64_t) invSqrtTable[(x >> 27) - 8] << 15;
+
+    //two Newton steps, r = r * (3 - f * r * r) / 2
+    t = (((r * r) >> 30) * f) >> 30;
+    r = (r * (3ULL * IMU_FUSION_ONE_Q30 - t)) >> 31;
+    t = (((r * r) >> 30) * f) >> 30;
+    r = (r * (3ULL * IMU_FUSION_ONE_Q30 - t)) >> 31;
+
+    return (uint32_t) r;
+}
+
+/**
+ * 1/sqrt(x), x and the result in Q16.16.
+ * @param x Value, 0 gives 0.
+ * @return 1/sqrt(x).
+ */
+q16_t IMUFusionInvSqrt(uint32_t x)
+{
+    unsigned char shift;
+    uint32_t r;
+
+    if (x == 0)
+        return 0;
+
+    r = IMUFusionInvSqrtMantissa(x, &shift);
+
+    //x is f * 2^(16 - shift) in Q16.16
+    return (q16_t) (r >> (22 - shift / 2));
+}
+
+/**
+ * Normalizes a vector of raw values to Q2.30.
+ * @return 0 if the vector is null.
+ */
+static unsigned char IMUFusionNormalize(int x, int y, int z,
+                                        q30_t *nx, q30_t *ny, q30_t *nz)
+{
+    uint32_t norm = (uint32_t) ((int32_t) x * x) + (uint32_t) ((int32_t) y * y) +
+            (uint32_t) ((int32_t) z * z);
+    unsigned char shift;
+    int32_t r;
+
+    if (norm == 0)
+        return 0;
+
+    //1/sqrt(norm) = r * 2^(shift / 2 - 46)
+    r = (int32_t) IMUFusionInvSqrtMantissa(norm, &shift);
+    shift = 16 - shift / 2;
+    *nx = (q30_t) (((int64_t) x * r) >> shift);
+    *ny = (q30_t) (((int64_t) y * r) >> shift);
+    *nz = (q30_t) (((int64_t) z * r) >> shift);
+
+    return 1;
+}
+
+/**
+ * Normalizes the quaternion, its norm is always close to 1.
+ */
+static void IMUFusionNormalizeQuaternion(tIMUFusion *fusion)
+{
+    uint32_t norm = (uint32_t) IMUFusionMul(fusion->q0, fusion->q0) +
+            (uint32_t) IMUFusionMul(fusion->q1, fusion->q1) +
+            (uint32_t) IMUFusionMul(fusion->q2, fusion->q2) +
+            (uint32_t) IMUFusionMul(fusion->q3, fusion->q3);
+    unsigned char shift;
+    q30_t inverse;
+
+    if (norm == 0)
+    {
+        fusion->q0 = IMU_FUSION_ONE_Q30;
+        return;
+    }
+
+    //in Q2.30 1/sqrt(norm) = r * 2^(shift / 2 - 1)
+    inverse = (q30_t) IMUFusionInvSqrtMantissa(norm, &shift);
+    inverse = (shift == 0) ? inverse >> 1 : inverse << (shift / 2 - 1);
+
+    fusion->q0 = IMUFusionMul(fusion->q0, inverse);
+    fusion->q1 = IMUFusionMul(fusion->q1, inverse);
+    fusion->q2 = IMUFusionMul(fusion->q2, inverse);
+    fusion->q3 = IMUFusionMul(fusion->q3, inverse);
+}
+
+/**
+ * Rate of the gyroscope in Q16.16 rad/s.
+ */
+static q16_t IMUFusionRate(tIMUFusion *fusion, int raw)
+{
+    return (q16_t) (((int32_t) raw * fusion->gyroScale) >> 8);
+}
+
+/**
+ * Initiates a filter, the orientation is the identity.
+ * @param fusion Filter.
+ * @param rate Updates per second.
+ * @param gyroScale Scale of the gyroscope, IMU_FUSION_GYRO_SCALE().
+ */
+void IMUFusionInit(tIMUFusion *fusion, unsigned int rate, int32_t gyroScale)
+{
+    fusion->q0 = IMU_FUSION_ONE_Q30;
+    fusion->q1 = 0;
+    fusion->q2 = 0;
+    fusion->q3 = 0;
+    fusion->integralX = 0;
+    fusion->integralY = 0;
+    fusion->integralZ = 0;
+    fusion->twoKp = IMU_FUSION_TWO_KP;
+    fusion->twoKi = IMU_FUSION_TWO_KI;
+    fusion->period = (q30_t) ((IMU_FUSION_ONE_Q30 + rate / 2) / rate);
+    fusion->gyroScale = gyroScale;
+}
+
+/**
+ * Sets the gains of a filter.
+ * @param fusion Filter.
+ * @param twoKp 2 * proportional gain in Q16.16, the speed of the correction
+ *              by the accelerometer and the magnetometer.
+ * @param twoKi 2 * integral gain in Q16.16, the correction of the bias of
+ *              the gyroscope, 0 to disable.
+ */
+void IMUFusionSetGains(tIMUFusion *fusion, q16_t twoKp, q16_t twoKi)
+{
+    fusion->twoKp = twoKp;
+    fusion->twoKi = twoKi;
+
+    if (twoKi == 0)
+    {
+        fusion->integralX = 0;
+        fusion->integralY = 0;
+        fusion->integralZ = 0;
+    }
+}
+
+/**
+ * Feedback of the error and integration of the rotation, the common part
+ * of the updates.
+ * @param gx Rates in Q16.16 rad/s.
+ * @param halfex Half of the error in Q2.30.
+ */
+static void IMUFusionIntegrate(tIMUFusion *fusion,
+                               q16_t gx, q16_t gy, q16_t gz,
+                               q30_t halfex, q30_t halfey, q30_t halfez)
+{
+    q30_t qa, qb, qc;
+
+    if (fusion->twoKi > 0)
+    {
+        fusion->integralX += IMUFusionMul((q30_t) (((int64_t) fusion->twoKi * halfex) >> 16),
+                                          fusion->period);
+        fusion->integralY += IMUFusionMul((q30_t) (((int64_t) fusion->twoKi * halfey) >> 16),
+                                          fusion->period);
+        fusion->integralZ += IMUFusionMul((q30_t) (((int64_t) fusion->twoKi * halfez) >> 16),
+                                          fusion->period);
+        gx += fusion->integralX >> 14;
+        gy += fusion->integralY >> 14;
+        gz += fusion->integralZ >> 14;
+    }
+
+    gx += (q16_t) (((int64_t) fusion->twoKp * halfex) >> 30);
+    gy += (q16_t) (((int64_t) fusion->twoKp * halfey) >> 30);
+    gz += (q16_t) (((int64_t) fusion->twoKp * halfez) >> 30);
+
+    //rotation of half a period, in Q2.30 rad
+    gx = (q30_t) (((int64_t) gx * fusion->period) >> 17);
+    gy = (q30_t) (((int64_t) gy * fusion->period) >> 17);
+    gz = (q30_t) (((int64_t) gz * fusion->period) >> 17);
+
+    qa = fusion->q0;
+    qb = fusion->q1;
+    qc = fusion->q2;
+    fusion->q0 += -IMUFusionMul(qb, gx) - IMUFusionMul(qc, gy) -
+            IMUFusionMul(fusion->q3, gz);
+    fusion->q1 += IMUFusionMul(qa, gx) + IMUFusionMul(qc, gz) -
+            IMUFusionMul(fusion->q3, gy);
+    fusion->q2 += IMUFusionMul(qa, gy) - IMUFusionMul(qb, gz) +
+            IMUFusionMul(fusion->q3, gx);
+    fusion->q3 += IMUFusionMul(qa, gz) + IMUFusionMul(qb, gy) -
+            IMUFusionMul(qc, gx);
+
+    IMUFusionNormalizeQuaternion(fusion);
+}
+
+/**
+ * Updates the orientation with the gyroscope, the accelerometer and the
+ * magnetometer. Without magnetometer values (all 0), this is
+ * IMUFusionUpdateIMU().
+ * @param fusion Filter.
+ * @param gx Raw values of the gyroscope.
+ * @param ax Raw values of the accelerometer, any scale.
+ * @param mx Raw values of the magnetometer, any scale.
+ */
+void IMUFusionUpdate(tIMUFusion *fusion,
+                     int gx, int gy, int gz,
+                     int ax, int ay, int az,
+                     int mx, int my, int mz)
+{
+    q30_t nax, nay, naz;
+    q30_t nmx, nmy, nmz;
+    q30_t q0q0, q0q1, q0q2, q0q3, q1q1, q1q2, q1q3, q2q2, q2q3, q3q3;
+    q30_t hx, hy, bx, bz;
+    q30_t halfvx, halfvy, halfvz;
+    q30_t halfwx, halfwy, halfwz;
+    uint32_t norm;
+    unsigned char shift;
+
+    if (!IMUFusionNormalize(mx, my, mz, &nmx, &nmy, &nmz) ||
+        !IMUFusionNormalize(ax, ay, az, &nax, &nay, &naz))
+    {
+        IMUFusionUpdateIMU(fusion, gx, gy, gz, ax, ay, az);
+        return;
+    }
+
+    q0q0 = IMUFusionMul(fusion->q0, fusion->q0);
+    q0q1 = IMUFusionMul(fusion->q0, fusion->q1);
+    q0q2 = IMUFusionMul(fusion->q0, fusion->q2);
+    q0q3 = IMUFusionMul(fusion->q0, fusion->q3);
+    q1q1 = IMUFusionMul(fusion->q1, fusion->q1);
+    q1q2 = IMUFusionMul(fusion->q1, fusion->q2);
+    q1q3 = IMUFusionMul(fusion->q1, fusion->q3);
+    q2q2 = IMUFusionMul(fusion->q2, fusion->q2);
+    q2q3 = IMUFusionMul(fusion->q2, fusion->q3);
+    q3q3 = IMUFusionMul(fusion->q3, fusion->q3);
+
+    //reference direction of the earth's magnetic field
+    hx = 2 * (IMUFusionMul(nmx, HALF - q2q2 - q3q3) +
+            IMUFusionMul(nmy, q1q2 - q0q3) + IMUFusionMul(nmz, q1q3 + q0q2));
+    hy = 2 * (IMUFusionMul(nmx, q1q2 + q0q3) +
+            IMUFusionMul(nmy, HALF - q1q1 - q3q3) + IMUFusionMul(nmz, q2q3 - q0q1));
+    bz = 2 * (IMUFusionMul(nmx, q1q3 - q0q2) +
+            IMUFusionMul(nmy, q2q3 + q0q1) + IMUFusionMul(nmz, HALF - q1q1 - q2q2));
+
+    //bx = sqrt(hx^2 + hy^2) = norm * r * 2^(shift / 2 - 31) in Q2.30
+    norm = (uint32_t) IMUFusionMul(hx, hx) + (uint32_t) IMUFusionMul(hy, hy);
+    bx = 0;
+    if (norm != 0)
+    {
+        bx = (q30_t) (((uint64_t) norm * IMUFusionInvSqrtMantissa(norm, &shift))
+                >> (31 - shift / 2));
+    }
+
+    //estimated direction of the gravity and of the magnetic field
+    halfvx = q1q3 - q0q2;
+    halfvy = q0q1 + q2q3;
+    halfvz = q0q0 - HALF + q3q3;
+    halfwx = IMUFusionMul(bx, HALF - q2q2 - q3q3) + IMUFusionMul(bz, q1q3 - q0q2);
+    halfwy = IMUFusionMul(bx, q1q2 - q0q3) + IMUFusionMul(bz, q0q1 + q2q3);
+    halfwz = IMUFusionMul(bx, q0q2 + q1q3) + IMUFusionMul(bz, HALF - q1q1 - q2q2);
+
+    //error, cross product of the estimated and the measured directions
+    IMUFusionIntegrate(fusion, IMUFusionRate(fusion, gx),
+                       IMUFusionRate(fusion, gy), IMUFusionRate(fusion, gz),
+                       IMUFusionMul(nay, halfvz) - IMUFusionMul(naz, halfvy) +
+                       IMUFusionMul(nmy, halfwz) - IMUFusionMul(nmz, halfwy),
+                       IMUFusionMul(naz, halfvx) - IMUFusionMul(nax, halfvz) +
+                       IMUFusionMul(nmz, halfwx) - IMUFusionMul(nmx, halfwz),
+                       IMUFusionMul(nax, halfvy) - IMUFusionMul(nay, halfvx) +
+                       IMUFusionMul(nmx, halfwy) - IMUFusionMul(nmy, halfwx));
+}
+
+/**
+ * Updates the orientation with the gyroscope and the accelerometer only,
+ * the yaw drifts with the bias of the gyroscope.
+ * @param fusion Filter.
+ * @param gx Raw values of the gyroscope.
+ * @param ax Raw values of the accelerometer, any scale, all 0 to use only
+ *           the gyroscope.
+ */
+void IMUFusionUpdateIMU(tIMUFusion *fusion,
+                        int gx, int gy, int gz,
+                        int ax, int ay, int az)
+{
+    q30_t nax, nay, naz;
+    q30_t halfvx, halfvy, halfvz;
+    q30_t halfex = 0, halfey = 0, halfez = 0;
+
+    if (IMUFusionNormalize(ax, ay, az, &nax, &nay, &naz))
+    {
+        halfvx = IMUFusionMul(fusion->q1, fusion->q3) -
+                IMUFusionMul(fusion->q0, fusion->q2);
+        halfvy = IMUFusionMul(fusion->q0, fusion->q1) +
+                IMUFusionMul(fusion->q2, fusion->q3);
+        halfvz = IMUFusionMul(fusion->q0, fusion->q0) - HALF +
+                IMUFusionMul(fusion->q3, fusion->q3);
+
+        halfex = IMUFusionMul(nay, halfvz) - IMUFusionMul(naz, halfvy);
+        halfey = IMUFusionMul(naz, halfvx) - IMUFusionMul(nax, halfvz);
+        halfez = IMUFusionMul(nax, halfvy) - IMUFusionMul(nay, halfvx);
+    }
+
+    IMUFusionIntegrate(fusion, IMUFusionRate(fusion, gx),
+                       IMUFusionRate(fusion, gy), IMUFusionRate(fusion, gz),
+                       halfex, halfey, halfez);
+}
+
+/**
+ * Gives the orientation as yaw, pitch and roll (Z, Y then X), the angles of
+ * the float version of S. Madgwick, from the CORDIC of FixedMath.c.
+ * @param fusion Filter.
+ * @param yaw Heading, about Z.
+ * @param pitch About Y, +/-90 degrees.
+ * @param roll About X.
+ */
+void IMUFusionGetAngles(const tIMUFusion *fusion, tFixedAngle *yaw,
+                        tFixedAngle *pitch, tFixedAngle *roll)
+{
+    q30_t sine;
+    q30_t cosine2;
+
+    //the terms are within +/-0.5 in Q2.30, 2^29 at most
+    *roll = FixedMathAtan2(IMUFusionMul(fusion->q0, fusion->q1) + IMUFusionMul(fusion->q2, fusion->q3),
+                           HALF - IMUFusionMul(fusion->q1, fusion->q1) - IMUFusionMul(fusion->q2, fusion->q2));
+    *yaw = FixedMathAtan2(IMUFusionMul(fusion->q1, fusion->q2) + IMUFusionMul(fusion->q0, fusion->q3),
+                          HALF - IMUFusionMul(fusion->q2, fusion->q2) - IMUFusionMul(fusion->q3, fusion->q3));
+
+    //asin(s) = atan2(s, sqrt(1 - s^2)), both in Q1.15
+    sine = 2 * (IMUFusionMul(fusion->q0, fusion->q2) - IMUFusionMul(fusion->q1, fusion->q3));
+
+    if (sine > IMU_FUSION_ONE_Q30)
+        sine = IMU_FUSION_ONE_Q30;
+    else if (sine < -IMU_FUSION_ONE_Q30)
+        sine = -IMU_FUSION_ONE_Q30;
+
+    cosine2 = IMU_FUSION_ONE_Q30 - IMUFusionMul(sine, sine);
+    *pitch = FixedMathAtan2(sine >> 15, FixedMathSqrt((uint32_t) cosine2));
+}
@@ -0,0 +1,92 @@
+/**
+ *  @file       IMUFusion.h
+ *  @author     Luis Maduro
+ *  @version    1.00
+ *  @date       14/10/2026
+ *  @brief      Fixed point orientation filter (Mahony).
+ *
+ *  The orientation is a quaternion in Q2.30, updated from the raw values
+ *  of a gyroscope, an accelerometer and optionally a magnetometer with the
+ *  complementary filter of R. Mahony (the same steps as the float version
+ *  of S. Madgwick). There is no floating point: the products are 32 x 32
+ *  bits to 64 bits and the vectors are normalized with a 1/sqrt made of a
+ *  small table and two Newton steps. The unit vectors and the quaternion
+ *  are in Q2.30, the rates and the gains in Q16.16: at 500 Hz a step of the
+ *  quaternion is a few 1e-5, too small for Q16.16. About 80 products per
+ *  update with the magnetometer, 500 Hz is a small part of an STM32F1
+ *  without FPU; on the PIC18 use a lower rate (50 Hz).
+ *
+ *  The axes of the three sensors have to be the same, the board specific
+ *  rotation of the magnetometer (i.e. HMC5883L) is done by the caller.
+ *
+ *  Copyright (C) 2026  Luis Maduro
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef IMUFUSION_H
+#define IMUFUSION_H
+
+#include <stdint.h>
+#include "FixedMath.h"
+
+/**Q16.16 and Q2.30 fixed point.*/
+typedef int32_t q16_t;
+typedef int32_t q30_t;
+
+#define IMU_FUSION_ONE              65536L
+#define IMU_FUSION_ONE_Q30          1073741824L
+/**Constant in Q16.16, only for constant expressions (the double is folded
+ by the compiler).*/
+#define IMU_FUSION_Q16(x)           ((q16_t) ((x) * 65536.0 + ((x) < 0 ? -0.5 : 0.5)))
+/**Scale of a gyroscope, in Q8.24 rad/s per LSB, from its LSB per degree/s
+ (ITG3200 14.375, MPU9150 131, 65.5, 32.8 or 16.4).*/
+#define IMU_FUSION_GYRO_SCALE(lsbPerDps) \
+                                    ((int32_t) (16777216.0 * 0.0174532925199433 / (lsbPerDps) + 0.5))
+
+/**Gains by default, 2 * Kp and 2 * Ki of the Mahony filter.*/
+#define IMU_FUSION_TWO_KP           IMU_FUSION_Q16(1.0)
+#define IMU_FUSION_TWO_KI           IMU_FUSION_Q16(0.0)
+
+/**
+ * State of a filter.
+ */
+typedef struct
+{
+    /**Orientation, from the earth frame to the sensor frame.*/
+    q30_t q0, q1, q2, q3;
+    /**Integral of the error, the bias of the gyroscope, in rad/s.*/
+    q30_t integralX, integralY, integralZ;
+    /**2 * Kp and 2 * Ki.*/
+    q16_t twoKp, twoKi;
+    /**Period of the updates in s.*/
+    q30_t period;
+    /**Scale of the gyroscope, IMU_FUSION_GYRO_SCALE().*/
+    int32_t gyroScale;
+} tIMUFusion;
+
+void IMUFusionInit(tIMUFusion *fusion, unsigned int rate, int32_t gyroScale);
+void IMUFusionSetGains(tIMUFusion *fusion, q16_t twoKp, q16_t twoKi);
+void IMUFusionUpdate(tIMUFusion *fusion,
+                     int gx, int gy, int gz,
+                     int ax, int ay, int az,
+                     int mx, int my, int mz);
+void IMUFusionUpdateIMU(tIMUFusion *fusion,
+                        int gx, int gy, int gz,
+                        int ax, int ay, int az);
+q16_t IMUFusionInvSqrt(uint32_t x);
+void IMUFusionGetAngles(const tIMUFusion *fusion, tFixedAngle *yaw,
+                        tFixedAngle *pitch, tFixedAngle *roll);
+
+#endif
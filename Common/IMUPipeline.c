@@ -0,0 +1,259 @@
+/**
+ *  @file       IMUPipeline.c
+ *  @author     Luis Maduro
+ *  @version    1.00
+ *  @date       14/10/2026
+ *  @brief      Synchronized sampling of an ADXL345, an ITG3200 and a
+ *              HMC5883L.
+ *
+ *  Copyright (C) 2026  Luis Maduro
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <stddef.h>
+#include "IMUPipeline.h"
+
+/**Addresses and first data register of the sensors.*/
+static const unsigned char sensorAddress[IMU_PIPELINE_SENSORS] = {
+    ADXL345_ADDRESS, ITG3200_ADDRESS, HMC5883L_ADDRESS
+};
+static const unsigned char sensorRegister[IMU_PIPELINE_SENSORS] = {
+    ADXL345_RA_DATAX0, ITG3200_RA_GYRO_XOUT_H, HMC5883L_RA_DATAX_H
+};
+
+static tI2CTransaction transaction[IMU_PIPELINE_SENSORS];
+static unsigned char sensorData[IMU_PIPELINE_SENSORS][6];
+
+static unsigned char masterSensor;
+/**Sensors with a data ready since their last read.*/
+static volatile unsigned char readyMask;
+static volatile uint32_t readyTime[IMU_PIPELINE_SENSORS];
+/**Frame being read, and the number of reads not finished.*/
+static tIMUFrame current;
+static volatile unsigned char pending;
+static unsigned char frameError;
+
+static tIMUFrame ring[IMU_PIPELINE_RING_SIZE];
+static volatile unsigned char ringHead;
+static volatile unsigned char ringTail;
+static unsigned int overruns;
+static unsigned int errors;
+
+static void IMUPipelineReadDone(tI2CTransaction *done);
+
+/**
+ * Initiates the pipeline and enables the data ready interrupts of the
+ * ADXL345 and the ITG3200 (the DRDY pin of the HMC5883L is always on).
+ * The rates and ranges are configured with the drivers of the chips, and
+ * the interrupts of the pins must call IMUPipelineDataReady(). The HMC5883L
+ * is read without its register address, start it first with
+ * HMC5883LStreamBegin().
+ * @param master Sensor whose data ready starts a frame, IMU_PIPELINE_GYRO
+ *               usually.
+ */
+void IMUPipelineInit(unsigned char master)
+{
+    unsigned char i;
+
+    masterSensor = master;
+    readyMask = 0;
+    pending = 0;
+    ringHead = 0;
+    ringTail = 0;
+    overruns = 0;
+    errors = 0;
+
+    for (i = 0; i < IMU_PIPELINE_SENSORS; i++)
+    {
+        transaction[i].deviceAddress = sensorAddress[i];
+        transaction[i].registerAddress = sensorRegister[i];
+        transaction[i].direction = (i == IMU_PIPELINE_MAG) ?
+                I2C_Direction_ReceiverCurrent : I2C_Direction_Receiver;
+        transaction[i].length = 6;
+        transaction[i].data = sensorData[i];
+        transaction[i].callback = IMUPipelineReadDone;
+        transaction[i].status = I2C_TRANSACTION_IDLE;
+        current.sensorTimestamp[i] = 0;
+    }
+
+    current.ax = current.ay = current.az = 0;
+    current.gx = current.gy = current.gz = 0;
+    current.mx = current.my = current.mz = 0;
+
+    I2CDeviceSetDeviceAddress(ADXL345_ADDRESS);
+    ADXL345SetIntDataReadyEnabled(true);
+    I2CDeviceSetDeviceAddress(ITG3200_ADDRESS);
+    ITG3200SetIntDataReadyEnabled(true);
+}
+
+/**
+ * Gives a data ready to the pipeline, to call from the interrupt of the
+ * pin of the sensor, at the same priority as the I2C interrupt. The data
+ * ready of the master sensor queues the reads of the frame.
+ * @param sensor IMU_PIPELINE_ACCEL, IMU_PIPELINE_GYRO or IMU_PIPELINE_MAG.
+ */
+void IMUPipelineDataReady(unsigned char sensor)
+{
+    unsigned char i;
+
+    readyTime[sensor] = IMU_PIPELINE_TIME();
+    readyMask |= IMU_PIPELINE_FRESH(sensor);
+
+    if (sensor != masterSensor)
+        return;
+
+    //the frame before is not read yet, this data ready is lost
+    if (pending)
+    {
+        overruns++;
+        return;
+    }
+
+    current.timestamp = readyTime[sensor];
+    current.fresh = readyMask;
+    readyMask = 0;
+    frameError = 0;
+
+    for (i = 0; i < IMU_PIPELINE_SENSORS; i++)
+    {
+        if (current.fresh & IMU_PIPELINE_FRESH(i))
+        {
+            current.sensorTimestamp[i] = readyTime[i];
+            pending++;
+        }
+    }
+
+    //back to back, joined by repeated starts if they are alone in the queue
+    for (i = 0; i < IMU_PIPELINE_SENSORS; i++)
+    {
+        if ((current.fresh & IMU_PIPELINE_FRESH(i)) &&
+            I2CDeviceStartTransaction(&transaction[i]))
+        {
+            frameError = 1;
+            pending--;
+        }
+    }
+
+    if (frameError && pending == 0)
+        errors++;
+}
+
+/**
+ * Decodes the data of a sensor in the frame.
+ */
+static void IMUPipelineDecode(unsigned char sensor)
+{
+    unsigned char *data = sensorData[sensor];
+
+    switch (sensor)
+    {
+        case IMU_PIPELINE_ACCEL:
+            current.ax = (((int) data[1]) << 8) | data[0];
+            current.ay = (((int) data[3]) << 8) | data[2];
+            current.az = (((int) data[5]) << 8) | data[4];
+            break;
+
+        case IMU_PIPELINE_GYRO:
+            current.gx = (((int) data[0]) << 8) | data[1];
+            current.gy = (((int) data[2]) << 8) | data[3];
+            current.gz = (((int) data[4]) << 8) | data[5];
+            break;
+
+        default:
+            //the registers are X, Z, Y
+            current.mx = (((int) data[0]) << 8) | data[1];
+            current.my = (((int) data[4]) << 8) | data[5];
+            current.mz = (((int) data[2]) << 8) | data[3];
+            break;
+    }
+}
+
+/**
+ * Callback of the reads, from the I2C interrupt. The last one puts the
+ * frame in the ring.
+ */
+static void IMUPipelineReadDone(tI2CTransaction *done)
+{
+    unsigned char sensor = (unsigned char) (done - transaction);
+    unsigned char next;
+
+    if (done->status == I2C_TRANSACTION_DONE)
+        IMUPipelineDecode(sensor);
+    else
+        frameError = 1;
+
+    done->status = I2C_TRANSACTION_IDLE;
+
+    if (--pending)
+        return;
+
+    if (frameError)
+    {
+        errors++;
+        return;
+    }
+
+    next = (ringHead + 1) & (IMU_PIPELINE_RING_SIZE - 1);
+
+    if (next == ringTail)
+    {
+        overruns++;
+        return;
+    }
+
+    ring[ringHead] = current;
+    ringHead = next;
+}
+
+/**
+ * Takes the oldest frame of the ring.
+ * @param frame Where the frame is copied.
+ * @return 1 if there was a frame, 0 if the ring is empty.
+ */
+unsigned char IMUPipelineRead(tIMUFrame *frame)
+{
+    if (ringTail == ringHead)
+        return 0;
+
+    *frame = ring[ringTail];
+    ringTail = (ringTail + 1) & (IMU_PIPELINE_RING_SIZE - 1);
+
+    return 1;
+}
+
+/**
+ * Number of frames in the ring.
+ */
+unsigned char IMUPipelineCount(void)
+{
+    return (ringHead - ringTail) & (IMU_PIPELINE_RING_SIZE - 1);
+}
+
+/**
+ * Number of frames lost, because the reads of the frame before were not
+ * finished or the ring was full.
+ */
+unsigned int IMUPipelineOverruns(void)
+{
+    return overruns;
+}
+
+/**
+ * Number of frames dropped because a sensor didn't answer.
+ */
+unsigned int IMUPipelineErrors(void)
+{
+    return errors;
+}
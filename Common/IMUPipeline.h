@@ -0,0 +1,94 @@
+/**
+ *  @file       IMUPipeline.h
+ *  @author     Luis Maduro
+ *  @version    1.00
+ *  @date       14/10/2026
+ *  @brief      Synchronized sampling of an ADXL345, an ITG3200 and a
+ *              HMC5883L.
+ *
+ *  The data ready interrupt of every chip is given to
+ *  IMUPipelineDataReady(), with the time it came. The data ready of the
+ *  master sensor (usually the gyroscope, the fastest) starts a frame: the
+ *  burst reads of the three chips are queued back to back on the
+ *  interrupt driven I2C (I2CDeviceStartTransaction()), so the three are
+ *  read within a few hundred microseconds, and the last callback puts the
+ *  frame in a ring. The sensors that had no new data since the frame before
+ *  keep their last values, and their bit is clear in the fresh mask of the
+ *  frame.
+ *
+ *  The HMC5883L has to be in continuous mode, and the data ready of the
+ *  ITG3200 not latched (or latched with clear on any read). The PIC18F
+ *  queued I2C engine is needed, the STM32F1 I2CDevice has none.
+ *
+ *  Copyright (C) 2026  Luis Maduro
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef IMUPIPELINE_H
+#define IMUPIPELINE_H
+
+#include <stdint.h>
+#include "ADXL345.h"
+#include "ITG3200.h"
+#include "HMC5883L.h"
+#include "uKernel/uKernel.h"
+
+/**Number of frames of the ring, a power of 2.*/
+#ifndef IMU_PIPELINE_RING_SIZE
+#define IMU_PIPELINE_RING_SIZE      16
+#endif
+
+/**Time of the data ready interrupts in us. Can be defined before including
+ this file, i.e. #define IMU_PIPELINE_TIME() TimerMicros()*/
+#ifndef IMU_PIPELINE_TIME
+#ifdef UKERNEL_USE_US_TIMEBASE
+#define IMU_PIPELINE_TIME()         uKernelMicros()
+#else
+#define IMU_PIPELINE_TIME()         (_counterMs * 1000UL)
+#endif
+#endif
+
+/**Sensors of the pipeline, and their bit in the fresh mask.*/
+#define IMU_PIPELINE_ACCEL          0
+#define IMU_PIPELINE_GYRO           1
+#define IMU_PIPELINE_MAG            2
+#define IMU_PIPELINE_SENSORS        3
+#define IMU_PIPELINE_FRESH(sensor)  (1 << (sensor))
+
+/**
+ * A frame of the three sensors, read one after the other.
+ */
+typedef struct
+{
+    int ax, ay, az;
+    int gx, gy, gz;
+    int mx, my, mz;
+    /**Time of the data ready of the master sensor, in us.*/
+    uint32_t timestamp;
+    /**Time of the data ready of every sensor, in us. A sensor not fresh
+     keeps the time of its last data.*/
+    uint32_t sensorTimestamp[IMU_PIPELINE_SENSORS];
+    /**IMU_PIPELINE_FRESH() of the sensors with new data in this frame.*/
+    unsigned char fresh;
+} tIMUFrame;
+
+void IMUPipelineInit(unsigned char master);
+void IMUPipelineDataReady(unsigned char sensor);
+unsigned char IMUPipelineRead(tIMUFrame *frame);
+unsigned char IMUPipelineCount(void);
+unsigned int IMUPipelineOverruns(void);
+unsigned int IMUPipelineErrors(void);
+
+#endif
@@ -8,7 +8,8 @@
  */
 #include "ITG3200.h"
 
-unsigned char ITG3200Buffer[6];
+/**Data of the reads, 8 bytes for the burst of ITG3200GetMotion().*/
+unsigned char ITG3200Buffer[8];
 
 /**
  * Power on and prepare for general usage.
@@ -407,6 +408,128 @@ void ITG3200GetRotation(int* x, int* y, int* z)
     *z = (((int) ITG3200Buffer[4]) << 8) | ITG3200Buffer[5];
 }
 
+/**
+ * Get the temperature and the 3-axis gyroscope readings in one burst, from
+ * TEMP_OUT_H to GYRO_ZOUT_L. The values are of the same sample and it's a
+ * single transaction, instead of one for the temperature and one per axis.
+ * @param sample Temperature and rotation
+ * @see ITG3200_RA_TEMP_OUT_H
+ */
+void ITG3200GetMotion(tITG3200Sample *sample)
+{
+    I2CDeviceSetDeviceAddress(ITG3200_ADDRESS);
+    I2CDeviceReadBytes(ITG3200_RA_TEMP_OUT_H, 8, ITG3200Buffer);
+    sample->temperature = (((int) ITG3200Buffer[0]) << 8) | ITG3200Buffer[1];
+    sample->x = (((int) ITG3200Buffer[2]) << 8) | ITG3200Buffer[3];
+    sample->y = (((int) ITG3200Buffer[4]) << 8) | ITG3200Buffer[5];
+    sample->z = (((int) ITG3200Buffer[6]) << 8) | ITG3200Buffer[7];
+}
+
+/**
+ * Subtracts the bias at the temperature of the sample.
+ * @param bias Bias, from ITG3200BiasFinish()
+ * @param sample Sample, the rotation is corrected
+ */
+void ITG3200BiasCorrect(const tITG3200Bias *bias, tITG3200Sample *sample)
+{
+    int32_t delta = (int32_t) sample->temperature - bias->temperature0;
+
+    sample->x -= bias->offset[0] + (int) ((delta * bias->slope[0]) >> 16);
+    sample->y -= bias->offset[1] + (int) ((delta * bias->slope[1]) >> 16);
+    sample->z -= bias->offset[2] + (int) ((delta * bias->slope[2]) >> 16);
+}
+
+/**
+ * Starts a fit of the bias. The gyroscope has to be still while the samples
+ * are added, over a range of temperature to fit the slope (i.e. while the
+ * board warms up).
+ * @param fit Sums of the fit
+ */
+void ITG3200BiasBegin(tITG3200BiasFit *fit)
+{
+    unsigned char i;
+
+    fit->count = 0;
+    fit->sumT = 0;
+    fit->sumTT = 0;
+
+    for (i = 0; i < 3; i++)
+    {
+        fit->sum[i] = 0;
+        fit->sumT_G[i] = 0;
+    }
+}
+
+/**
+ * Adds a sample to the fit of the bias.
+ * @param fit Sums of the fit
+ * @param sample Sample of the gyroscope still
+ */
+void ITG3200BiasAdd(tITG3200BiasFit *fit, const tITG3200Sample *sample)
+{
+    int32_t t;
+
+    //the temperatures are kept from the first one, the sums stay small
+    if (fit->count == 0)
+        fit->temperature0 = sample->temperature;
+
+    t = (int32_t) sample->temperature - fit->temperature0;
+
+    fit->count++;
+    fit->sumT += t;
+    fit->sumTT += t * t;
+    fit->sum[0] += sample->x;
+    fit->sum[1] += sample->y;
+    fit->sum[2] += sample->z;
+    fit->sumT_G[0] += t * sample->x;
+    fit->sumT_G[1] += t * sample->y;
+    fit->sumT_G[2] += t * sample->z;
+}
+
+/**
+ * Ends a fit of the bias, a line of the bias of every axis against the
+ * temperature. If the temperature didn't change by
+ * ITG3200_BIAS_MINIMUM_SPREAD the slope is 0 and the bias is the mean.
+ * @param fit Sums of the fit
+ * @param bias Bias, at the mean temperature of the samples
+ * @return false if there are no samples, the bias is not changed
+ */
+boolean ITG3200BiasFinish(const tITG3200BiasFit *fit, tITG3200Bias *bias)
+{
+    int64_t n = fit->count;
+    int64_t variance;
+    int64_t covariance;
+    int32_t meanT;
+    unsigned char i;
+
+    if (fit->count == 0)
+        return false;
+
+    meanT = fit->sumT / (int32_t) fit->count;
+    //n^2 times the variance of the temperature
+    variance = n * fit->sumTT - (int64_t) fit->sumT * fit->sumT;
+
+    bias->temperature0 = fit->temperature0 + (int) meanT;
+
+    for (i = 0; i < 3; i++)
+    {
+        bias->slope[i] = 0;
+
+        if (variance > n * n * ITG3200_BIAS_MINIMUM_SPREAD / 4 *
+            ITG3200_BIAS_MINIMUM_SPREAD / 4)
+        {
+            covariance = n * fit->sumT_G[i] - (int64_t) fit->sumT * fit->sum[i];
+            bias->slope[i] = (int32_t) ((covariance * 65536) / variance);
+        }
+
+        //the line goes through the means
+        bias->offset[i] = (int) ((fit->sum[i] -
+                ((((int64_t) fit->sumT - meanT * n) * bias->slope[i]) >> 16)) / n);
+    }
+
+    return true;
+}
+
 /**
  * Get X-axis gyroscope reading.
  * @return X-axis rotation measurement in 16-bit 2's complement format
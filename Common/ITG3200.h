@@ -10,6 +10,7 @@
 #ifndef _ITG3200_H_
 #define _ITG3200_H_
 
+#include <stdint.h>
 #include "stdboolean.h"
 #include "I2CDevice.h"
 
@@ -85,6 +86,47 @@
 #define ITG3200_CLOCK_PLL_EXT32K    0x04
 #define ITG3200_CLOCK_PLL_EXT19M    0x05
 
+/**Temperature in 1/100 degC from the raw value (280 LSB/degC, -13200 at
+ 35 degC).*/
+#define ITG3200_TEMPERATURE_CENTI(raw) \
+                                    (3500L + (((long) (raw) + 13200L) * 100L) / 280L)
+/**Smaller spread of the temperature for a bias fit with slope, 2 degC.*/
+#define ITG3200_BIAS_MINIMUM_SPREAD 560
+
+/**
+ * Temperature and rotation, read together by ITG3200GetMotion().
+ */
+typedef struct
+{
+    int temperature;
+    int x, y, z;
+} tITG3200Sample;
+
+/**
+ * Bias of the gyroscope as a function of the temperature,
+ * bias = offset + slope * (temperature - temperature0) / 65536.
+ */
+typedef struct
+{
+    int temperature0;
+    int offset[3];
+    /**Bias change per LSB of temperature, in 1/65536 LSB.*/
+    int32_t slope[3];
+} tITG3200Bias;
+
+/**
+ * Sums of the least squares fit of the bias, filled by ITG3200BiasAdd().
+ */
+typedef struct
+{
+    int temperature0;
+    unsigned int count;
+    int32_t sumT;
+    int64_t sumTT;
+    int32_t sum[3];
+    int64_t sumT_G[3];
+} tITG3200BiasFit;
+
 void ITG3200SetClockSource(unsigned char source);
 unsigned char ITG3200GetClockSource(void);
 void ITG3200SetStandbyZEnabled(boolean enabled);
@@ -100,6 +142,11 @@ int ITG3200GetRotationZ(void);
 int ITG3200GetRotationY(void);
 int ITG3200GetRotationX(void);
 void ITG3200GetRotation(int *x,int *y,int *z);
+void ITG3200GetMotion(tITG3200Sample *sample);
+void ITG3200BiasCorrect(const tITG3200Bias *bias, tITG3200Sample *sample);
+void ITG3200BiasBegin(tITG3200BiasFit *fit);
+void ITG3200BiasAdd(tITG3200BiasFit *fit, const tITG3200Sample *sample);
+boolean ITG3200BiasFinish(const tITG3200BiasFit *fit, tITG3200Bias *bias);
 int ITG3200GetTemperature(void);
 boolean ITG3200GetIntDataReadyStatus(void);
 boolean ITG3200GetIntDeviceReadyStatus(void);
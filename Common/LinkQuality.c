@@ -0,0 +1,204 @@
+/**
+ *  @file       LinkQuality.c
+ *  @author     Luis Maduro
+ *  @version    1.00
+ *  @date       14/10/2026
+ *  @brief      Link quality statistics of the neighbours of a radio.
+ *
+ *  Copyright (C) 2026  Luis Maduro
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "LinkQuality.h"
+
+static tLinkQuality links[LINKQUALITY_NEIGHBOURS];
+static unsigned char linkNext;
+
+/**
+ * Adds a sample to an exponential average.
+ * @param average Average, in the scale of the sample.
+ * @param sample Sample, already scaled.
+ * @return New average.
+ */
+static unsigned int LinkQualityAverage(unsigned int average, unsigned int sample)
+{
+    return average - (average >> LINKQUALITY_SHIFT) + (sample >> LINKQUALITY_SHIFT);
+}
+
+/**
+ * Finds a neighbour, or takes the place of the oldest one for it.
+ * @param address Address of the neighbour.
+ * @return Its statistics.
+ */
+static tLinkQuality *LinkQualityFind(unsigned int address)
+{
+    tLinkQuality *link;
+    unsigned char i;
+
+    for (i = 0; i < LINKQUALITY_NEIGHBOURS; i++)
+    {
+        if (links[i].Valid && (links[i].Address == address))
+        {
+            return &links[i];
+        }
+    }
+
+    link = &links[linkNext];
+    linkNext = (linkNext + 1) % LINKQUALITY_NEIGHBOURS;
+
+    link->Address = address;
+    link->RSSI = 0;
+    link->LQI = 0;
+    link->PER = 0;
+    link->Retries = 0;
+    link->Received = 0;
+    link->Sent = 0;
+    link->Failed = 0;
+    link->Valid = true;
+
+    return link;
+}
+
+/**
+ * Forgets all the neighbours.
+ */
+void LinkQualityInit(void)
+{
+    unsigned char i;
+
+    for (i = 0; i < LINKQUALITY_NEIGHBOURS; i++)
+    {
+        links[i].Valid = false;
+    }
+
+    linkNext = 0;
+}
+
+/**
+ * Takes note of a frame received from a neighbour.
+ * @param address Address of the sender.
+ * @param rssi RSSI of the frame.
+ * @param lqi LQI of the frame, 0 if the radio doesn't give it.
+ */
+void LinkQualityReceived(unsigned int address, unsigned char rssi, unsigned char lqi)
+{
+    tLinkQuality *link = LinkQualityFind(address);
+
+    //the first frame starts the averages
+    if (link->Received == 0)
+    {
+        link->RSSI = (unsigned int) rssi * LINKQUALITY_AVERAGE_ONE;
+        link->LQI = (unsigned int) lqi * LINKQUALITY_AVERAGE_ONE;
+    }
+    else
+    {
+        link->RSSI = LinkQualityAverage(link->RSSI, (unsigned int) rssi * LINKQUALITY_AVERAGE_ONE);
+        link->LQI = LinkQualityAverage(link->LQI, (unsigned int) lqi * LINKQUALITY_AVERAGE_ONE);
+    }
+
+    if (link->Received != 0xFFFF)
+    {
+        link->Received++;
+    }
+}
+
+/**
+ * Takes note of the end of a transmission to a neighbour.
+ * @param address Address of the destination.
+ * @param retries Retransmissions of the frame.
+ * @param acknowledged True if the destination acknowledged it.
+ */
+void LinkQualitySent(unsigned int address, unsigned char retries, bool acknowledged)
+{
+    tLinkQuality *link = LinkQualityFind(address);
+
+    link->PER = LinkQualityAverage(link->PER, acknowledged ? 0 : LINKQUALITY_PER_ONE);
+    link->Retries = LinkQualityAverage(link->Retries, (unsigned int) retries * LINKQUALITY_AVERAGE_ONE);
+
+    if (link->Sent != 0xFFFF)
+    {
+        link->Sent++;
+    }
+
+    if (!acknowledged && (link->Failed != 0xFFFF))
+    {
+        link->Failed++;
+    }
+}
+
+/**
+ * Gives the statistics of a neighbour.
+ * @param address Address of the neighbour.
+ * @return Statistics, NULL if nothing was heard from or sent to it.
+ */
+const tLinkQuality *LinkQualityGet(unsigned int address)
+{
+    unsigned char i;
+
+    for (i = 0; i < LINKQUALITY_NEIGHBOURS; i++)
+    {
+        if (links[i].Valid && (links[i].Address == address))
+        {
+            return &links[i];
+        }
+    }
+
+    return NULL;
+}
+
+/**
+ * Gives the packet error rate of a link.
+ * @param link Statistics of the neighbour.
+ * @return Packet error rate, in %.
+ */
+unsigned char LinkQualityPER(const tLinkQuality *link)
+{
+    return (unsigned char) (((unsigned long) link->PER * 100) / LINKQUALITY_PER_ONE);
+}
+
+/**
+ * Tells if the TX power to a neighbour can be lowered, or the data rate
+ * raised, or if the link needs more power. With the MRF24J40 more power is
+ * a lower TX_POWER_ attenuation for MRF24J40SetPower().
+ * @param link Statistics of the neighbour.
+ * @return LINKQUALITY_LOWER, LINKQUALITY_KEEP or LINKQUALITY_RAISE.
+ */
+signed char LinkQualityAdvice(const tLinkQuality *link)
+{
+    unsigned char per;
+
+    if ((link == NULL) || (link->Sent < LINKQUALITY_MIN_SAMPLES))
+    {
+        return LINKQUALITY_KEEP;
+    }
+
+    per = LinkQualityPER(link);
+
+    //more than one retry per frame is a bad link even if they get through
+    if ((per > LINKQUALITY_PER_HIGH) || (link->Retries > LINKQUALITY_AVERAGE_ONE))
+    {
+        return LINKQUALITY_RAISE;
+    }
+
+    if ((per < LINKQUALITY_PER_LOW)
+            && (link->Retries < LINKQUALITY_AVERAGE_ONE / 4)
+            && (link->Received != 0)
+            && (link->RSSI >= (unsigned int) LINKQUALITY_RSSI_GOOD * LINKQUALITY_AVERAGE_ONE))
+    {
+        return LINKQUALITY_LOWER;
+    }
+
+    return LINKQUALITY_KEEP;
+}
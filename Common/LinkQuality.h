@@ -0,0 +1,106 @@
+/**
+ *  @file       LinkQuality.h
+ *  @author     Luis Maduro
+ *  @version    1.00
+ *  @date       14/10/2026
+ *  @brief      Link quality statistics of the neighbours of a radio.
+ *
+ *  Keeps, for every neighbour, running averages of the RSSI and LQI of the
+ *  frames received from it and of the packet error rate and retries of the
+ *  frames sent to it. They are updated on every frame with shifts only, an
+ *  exponential average with a weight of 1 / 2^LINKQUALITY_SHIFT for the new
+ *  sample. The layer doesn't depend on the radio: the MAC layer of the
+ *  MRF24J40 feeds it with MRF24JMAC_USE_LINK_QUALITY, with the RFM23 the
+ *  application does it with RFM2xPacketRSSI() and its own acknowledgements.
+ *
+ *  LinkQualityAdvice() tells if a link has margin to lower the TX power
+ *  (or raise the data rate) or needs more of it.
+ *
+ *  Copyright (C) 2026  Luis Maduro
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef LINKQUALITY_H
+#define LINKQUALITY_H
+
+#include <stdbool.h>
+#include <stddef.h>
+
+/**Neighbours kept, the oldest one is replaced by a new one.*/
+#ifndef LINKQUALITY_NEIGHBOURS
+#define LINKQUALITY_NEIGHBOURS      8
+#endif
+
+/**Weight of a new sample in the averages, 1 / 2^LINKQUALITY_SHIFT.*/
+#ifndef LINKQUALITY_SHIFT
+#define LINKQUALITY_SHIFT           3
+#endif
+
+/**Packet error rate, in %, above which a link needs more power and below
+ which it can do with less.*/
+#ifndef LINKQUALITY_PER_HIGH
+#define LINKQUALITY_PER_HIGH        10
+#endif
+#ifndef LINKQUALITY_PER_LOW
+#define LINKQUALITY_PER_LOW         2
+#endif
+
+/**RSSI, as given by the radio, above which a link has margin.*/
+#ifndef LINKQUALITY_RSSI_GOOD
+#define LINKQUALITY_RSSI_GOOD       0xB0
+#endif
+
+/**Frames sent to a neighbour before an advice is given.*/
+#ifndef LINKQUALITY_MIN_SAMPLES
+#define LINKQUALITY_MIN_SAMPLES     8
+#endif
+
+/**Scale of the averages (RSSI, LQI and retries) and of the packet error
+ rate.*/
+#define LINKQUALITY_AVERAGE_ONE     16
+#define LINKQUALITY_PER_ONE         4096
+
+/**Advices of LinkQualityAdvice().*/
+#define LINKQUALITY_LOWER           -1
+#define LINKQUALITY_KEEP            0
+#define LINKQUALITY_RAISE           1
+
+/**
+ * Statistics of a neighbour.
+ */
+typedef struct
+{
+    unsigned int Address;
+    /**Averages of the frames received, in 1/LINKQUALITY_AVERAGE_ONE.*/
+    unsigned int RSSI;
+    unsigned int LQI;
+    /**Packet error rate of the frames sent, in 1/LINKQUALITY_PER_ONE.*/
+    unsigned int PER;
+    /**Average retries of the frames sent, in 1/LINKQUALITY_AVERAGE_ONE.*/
+    unsigned int Retries;
+    unsigned int Received;
+    unsigned int Sent;
+    unsigned int Failed;
+    bool Valid;
+} tLinkQuality;
+
+void LinkQualityInit(void);
+void LinkQualityReceived(unsigned int address, unsigned char rssi, unsigned char lqi);
+void LinkQualitySent(unsigned int address, unsigned char retries, bool acknowledged);
+const tLinkQuality *LinkQualityGet(unsigned int address);
+unsigned char LinkQualityPER(const tLinkQuality *link);
+signed char LinkQualityAdvice(const tLinkQuality *link);
+
+#endif /* LINKQUALITY_H */
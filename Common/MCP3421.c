@@ -28,6 +28,12 @@ float lsb = MCP3421_LSB_12BITS;
 char gain = MCP3421_GAIN_1_VALUE;
 MCP3421ConfigurationRegister configuration;
 
+/**Size of the LSB in nV, by sample rate (12, 14, 16 and 18 bits).*/
+static const long MCP3421Nanovolts[4] = {1000000L, 250000L, 62500L, 15625L};
+/**Scale of the raw values of the stream, 1 after MCP3421StreamBegin().*/
+static long streamNanovolts = 1000000L;
+static long streamDivisor = 1000L;
+
 /**
  * Sends a command to the MCP3421 to initiate a new convertion. One-Shot convertion
  * must be configured. In continuous mode this funtion as no effect on the ADC.
@@ -149,27 +155,123 @@ void MCP3421SetPGAGain(unsigned char value)
 float MCP3421GetValue(void)
 {
     float voltage = 0.0;
-    MCP3421Data data;
+    unsigned char buffer[4];
+    long value;
 
     I2CDeviceSetDeviceAddress(MCP3421_DEVICE_ADDRESS);
 
     do
     {
-        I2CStart();
-        I2CWrite(deviceAddressRead);
-        data.upper = I2CRead();
-        I2CAck();
-        data.middle = I2CRead();
-        I2CAck();
-        data.lower = I2CRead();
-        I2CAck();
-        configuration.byte = I2CRead();
-        I2CNotAck();
-        I2CStop();
+        I2CDeviceReadCurrentBytes(4, buffer);
+        configuration.byte = buffer[3];
     }
     while (configuration.ReadyBit == MCP3421_VALUE_IS_NOT_UPDATED);
 
-    voltage = data.value * (lsb / gain);
+    //upper, middle and lower bytes, a signed 24 bits value
+    value = ((long) buffer[0] << 16) | ((long) buffer[1] << 8) | buffer[2];
+    if (value & 0x800000L)
+        value |= 0xFF000000L;
+
+    voltage = value * (lsb / gain);
 
     return voltage;
 }
+
+/**
+ * Starts the continuous conversions, with the rate and the gain, in one
+ * write of the configuration. The integer scale of the raw values is
+ * computed here, the reads are then MCP3421StreamRead().
+ * @param rate #MCP3421_SAMPLE_RATE_240_SPS to #MCP3421_SAMPLE_RATE_3_75_SPS.
+ * @param pgaGain #MCP3421_GAIN_1 to #MCP3421_GAIN_8.
+ */
+void MCP3421StreamBegin(unsigned char rate, unsigned char pgaGain)
+{
+    configuration.ConvertionModeBit = MCP3421_MODE_CONTINUOUS;
+    configuration.SampleRateSelectionBits = rate;
+    configuration.PGAGainSelectionBits = pgaGain;
+
+    I2CDeviceSetDeviceAddress(MCP3421_DEVICE_ADDRESS);
+    I2CDeviceWriteBytes(configuration.byte, 0, 0x00);
+
+    //|raw| * nV per LSB is up to 2.048 V in nV, it fits in a long
+    streamNanovolts = MCP3421Nanovolts[rate & 0x03];
+    streamDivisor = 1000L << (pgaGain & 0x03);
+}
+
+/**
+ * Reads the last conversion of the continuous mode, without waiting. The
+ * read is 3 bytes, the data and the configuration (4 at 18 bits), and a
+ * conversion already read is seen by the ready bit and skipped, so it can
+ * be polled faster than the sample rate.
+ * @param value Raw value, sign extended.
+ * @return 1 if the value is a new conversion, 0 if it was already read.
+ */
+unsigned char MCP3421StreamRead(long *value)
+{
+    unsigned char buffer[4];
+    unsigned char length = 3;
+    long raw;
+
+    if (configuration.SampleRateSelectionBits == MCP3421_SAMPLE_RATE_3_75_SPS)
+        length = 4;
+
+    I2CDeviceSetDeviceAddress(MCP3421_DEVICE_ADDRESS);
+    I2CDeviceReadCurrentBytes(length, buffer);
+
+    if (buffer[length - 1] & MCP3421_READY_BIT)
+        return 0;
+
+    if (length == 4)
+    {
+        raw = ((long) buffer[0] << 16) | ((long) buffer[1] << 8) | buffer[2];
+        //18 bits, the upper byte repeats the sign
+        if (raw & 0x800000L)
+            raw |= 0xFF000000L;
+    }
+    else
+    {
+        raw = ((long) buffer[0] << 8) | buffer[1];
+        if (raw & 0x8000L)
+            raw |= 0xFFFF0000L;
+    }
+
+    *value = raw;
+
+    return 1;
+}
+
+/**
+ * Converts a raw value of the stream to microvolts, in integers with the
+ * scale of MCP3421StreamBegin().
+ * @param raw Raw value from MCP3421StreamRead().
+ * @return Voltage on the terminals of the ADC in uV.
+ */
+long MCP3421StreamMicrovolts(long raw)
+{
+    return (raw * streamNanovolts) / streamDivisor;
+}
+
+/**
+ * Reads the stream and publishes a new conversion in a sample ring, the
+ * payload is the raw value (values32[0]).
+ * @param ring Sample ring.
+ * @param timestamp Time of the read.
+ * @return 1 if a sample was published.
+ */
+unsigned char MCP3421StreamPublish(tSampleRing *ring, uint32_t timestamp)
+{
+    tSample *sample;
+    long raw;
+
+    if (!MCP3421StreamRead(&raw))
+        return 0;
+
+    sample = uSampleRingReserve(ring);
+    sample->sensor = USAMPLERING_SENSOR_MCP3421;
+    sample->length = 4;
+    sample->timestamp = timestamp;
+    sample->payload.values32[0] = raw;
+    uSampleRingPublish(ring);
+
+    return 1;
+}
@@ -24,6 +24,8 @@
 #ifndef MCP3421_H
 #define	MCP3421_H
 
+#include "uCFIFO/uSampleRing.h"
+
 /**MCP3421 device address*/
 #define MCP3421_DEVICE_ADDRESS      0b01101000
 
@@ -108,8 +110,10 @@ typedef union
     /**MCP3421 Configuration Register Format*/
 } MCP3421ConfigurationRegister;
 
+#if defined(__18CXX) || defined(__XC8)
 /**Union to simplify the convertion of the values. From the bytes retrieved by
- the MCP3421 a signed short long is updated (24 bits)*/
+ the MCP3421 a signed short long is updated (24 bits), a type of the PIC18
+ compilers only.*/
 typedef union
 {
     /**Value retrieved from the ADC signed.*/
@@ -126,6 +130,7 @@ typedef union
     };
     /**MCP3421 Data Format*/
 } MCP3421Data;
+#endif
 
 void MCP3421InitiateConvertion(void);
 void MCP3421SetConvertionModeContinuous(void);
@@ -133,5 +138,9 @@ void MCP3421SetConvertionModeOneShot(void);
 void MCP3421SetConvertionRate(unsigned char value);
 void MCP3421SetPGAGain(unsigned char value);
 float MCP3421GetValue(void);
+void MCP3421StreamBegin(unsigned char rate, unsigned char pgaGain);
+unsigned char MCP3421StreamRead(long *value);
+long MCP3421StreamMicrovolts(long raw);
+unsigned char MCP3421StreamPublish(tSampleRing *ring, uint32_t timestamp);
 
 #endif
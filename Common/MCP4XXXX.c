@@ -152,4 +152,140 @@ void MCP4XXXXSetPotenciometersValue(volatile unsigned char *port,
     SPIWrite(resistance);
 
     *port |= (0x01 << portBit);
-}
\ No newline at end of file
+}
+
+/**
+ * Initializes a daisy chain of MCP42XXX chips. All the potenciometers are
+ * written on the first MCP4XXXXChainUpdate().
+ *
+ * @param chain     Descriptor of the chain.
+ * @param bus       SPI device with the chip select of the chain, mode 0.
+ * @param devices   One entry per chip, kept by the caller.
+ * @param count     Chips on the chain, up to MCP4XXXX_CHAIN_MAX.
+ */
+void MCP4XXXXChainInit(tMCP4XXXXChain *chain,
+                       tSPIDevice *bus,
+                       tMCP4XXXXDevice *devices,
+                       unsigned char count)
+{
+    unsigned char i;
+
+    if (count > MCP4XXXX_CHAIN_MAX)
+    {
+        count = MCP4XXXX_CHAIN_MAX;
+    }
+
+    chain->Bus = bus;
+    chain->Devices = devices;
+    chain->Count = count;
+
+    for (i = 0; i < count; i++)
+    {
+        devices[i].Value[0] = 0;
+        devices[i].Value[1] = 0;
+        devices[i].Valid = 0;
+    }
+}
+
+/**
+ * Sets the value wanted for a potenciometer of the chain, it is written by
+ * the next MCP4XXXXChainUpdate().
+ *
+ * @param chain         Descriptor of the chain.
+ * @param device        Chip on the chain.
+ * @param potenciometer 0 or 1.
+ * @param resistance    Byte value of the potenciometer.
+ */
+void MCP4XXXXChainSetValue(tMCP4XXXXChain *chain,
+                           unsigned char device,
+                           unsigned char potenciometer,
+                           unsigned char resistance)
+{
+    tMCP4XXXXDevice *chip;
+
+    if (device >= chain->Count || potenciometer > 1)
+    {
+        return;
+    }
+
+    chip = &chain->Devices[device];
+    chip->Value[potenciometer] = resistance;
+
+    if (chip->Programmed[potenciometer] != resistance)
+    {
+        chip->Valid &= ~(1 << potenciometer);
+    }
+}
+
+/**
+ * Writes the potenciometers that changed, a command per chip shifted through
+ * the chain in one chip select window. The chips with nothing to change get
+ * a NOP. Both potenciometers of a chip that changed to different values take
+ * a second frame.
+ *
+ * @param chain Descriptor of the chain.
+ * @return Frames sent, 0 if nothing changed.
+ */
+unsigned char MCP4XXXXChainUpdate(tMCP4XXXXChain *chain)
+{
+    unsigned char frame[MCP4XXXX_CHAIN_MAX * 2];
+    unsigned char frames = 0;
+    unsigned char pending;
+    unsigned char i;
+    unsigned char n;
+    tMCP4XXXXDevice *chip;
+
+    do
+    {
+        pending = 0;
+        n = 0;
+
+        //the first bytes shifted in end on the last chip of the chain
+        for (i = chain->Count; i-- != 0;)
+        {
+            chip = &chain->Devices[i];
+
+            if ((chip->Valid & 0x03) == 0 && chip->Value[0] == chip->Value[1])
+            {
+                frame[n++] = MCP4XXXX_WRITE_DATA_BOTH_POTS;
+                frame[n++] = chip->Value[0];
+                chip->Programmed[0] = chip->Value[0];
+                chip->Programmed[1] = chip->Value[0];
+                chip->Valid |= 0x03;
+            }
+            else if ((chip->Valid & 0x01) == 0)
+            {
+                frame[n++] = MCP4XXXX_WRITE_DATA_POT_0;
+                frame[n++] = chip->Value[0];
+                chip->Programmed[0] = chip->Value[0];
+                chip->Valid |= 0x01;
+            }
+            else if ((chip->Valid & 0x02) == 0)
+            {
+                frame[n++] = MCP4XXXX_WRITE_DATA_POT_1;
+                frame[n++] = chip->Value[1];
+                chip->Programmed[1] = chip->Value[1];
+                chip->Valid |= 0x02;
+            }
+            else
+            {
+                frame[n++] = MCP4XXXX_NOP;
+                frame[n++] = 0x00;
+                continue;
+            }
+
+            pending = 1;
+        }
+
+        if (pending)
+        {
+            SPIDeviceSelect(chain->Bus);
+            SPIDeviceSendData(frame, n);
+            SPIDeviceDeselect(chain->Bus);
+            frames++;
+        }
+    }
+    while (pending);
+
+    return frames;
+}
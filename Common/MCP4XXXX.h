@@ -34,8 +34,46 @@
 #define MCP4XXXX_SHUTDOWN_POT_1             0b00100010
 #define MCP4XXXX_SHUTDOWN_BOTH_POTS         0b00100011
 
+/**Command that leaves the potenciometers of a chip unchanged, to shift the
+ commands of the other chips of a daisy chain through it.*/
+#define MCP4XXXX_NOP                        0b00000000
 
+/**Most chips on a daisy chain, MCP42XXX chips.*/
+#ifndef MCP4XXXX_CHAIN_MAX
+#define MCP4XXXX_CHAIN_MAX                  8
+#endif
 
+/**
+ * A chip of a daisy chain, with the values wanted and the ones it has.
+ */
+typedef struct
+{
+    unsigned char Value[2];
+    unsigned char Programmed[2];
+    /**Bit 0 and 1 set when the potenciometer 0 or 1 has Value.*/
+    unsigned char Valid;
+} tMCP4XXXXDevice;
+
+/**
+ * MCP42XXX chips daisy chained from SO to SI on a single chip select. The
+ * device 0 is the one on the SDO of the microcontroller.
+ */
+typedef struct
+{
+    tSPIDevice *Bus;
+    tMCP4XXXXDevice *Devices;
+    unsigned char Count;
+} tMCP4XXXXChain;
+
+void MCP4XXXXChainInit(tMCP4XXXXChain *chain,
+                       tSPIDevice *bus,
+                       tMCP4XXXXDevice *devices,
+                       unsigned char count);
+void MCP4XXXXChainSetValue(tMCP4XXXXChain *chain,
+                           unsigned char device,
+                           unsigned char potenciometer,
+                           unsigned char resistance);
+unsigned char MCP4XXXXChainUpdate(tMCP4XXXXChain *chain);
 
 void MCP4XXXXShutdownPotenciometer0(volatile unsigned char *port,
                                     unsigned char portBit);
@@ -96,4 +96,157 @@ void MCP6S2XSelectChannel(volatile unsigned char *port,
     SPIWrite(channel);
 
     *port |= (0x01 << portBit);
-}
\ No newline at end of file
+}
+
+/**
+ * Initializes a daisy chain of PGAs. The gain and channel of all the chips
+ * are written on the first MCP6S2XChainUpdate().
+ *
+ * @param chain     Descriptor of the chain.
+ * @param bus       SPI device with the chip select of the chain, mode 0.
+ * @param devices   One entry per chip, kept by the caller.
+ * @param count     Chips on the chain, up to MCP6S2X_CHAIN_MAX.
+ */
+void MCP6S2XChainInit(tMCP6S2XChain *chain,
+                      tSPIDevice *bus,
+                      tMCP6S2XDevice *devices,
+                      unsigned char count)
+{
+    unsigned char i;
+
+    if (count > MCP6S2X_CHAIN_MAX)
+    {
+        count = MCP6S2X_CHAIN_MAX;
+    }
+
+    chain->Bus = bus;
+    chain->Devices = devices;
+    chain->Count = count;
+
+    for (i = 0; i < count; i++)
+    {
+        devices[i].Gain = MCP6S2X_SET_GAIN_TO_1;
+        devices[i].Channel = MCP6S2X_SET_CHANNEL_0;
+        devices[i].Valid = 0;
+    }
+}
+
+/**
+ * Sets the gain wanted for a chip of the chain, it is written by the next
+ * MCP6S2XChainUpdate().
+ *
+ * @param chain     Descriptor of the chain.
+ * @param device    Chip on the chain.
+ * @param gainValue Gain value, MCP6S2X_SET_GAIN_TO_x.
+ */
+void MCP6S2XChainSetGain(tMCP6S2XChain *chain,
+                         unsigned char device,
+                         unsigned char gainValue)
+{
+    tMCP6S2XDevice *chip;
+
+    if (device >= chain->Count)
+    {
+        return;
+    }
+
+    chip = &chain->Devices[device];
+    chip->Gain = gainValue;
+
+    if (chip->ProgrammedGain != gainValue)
+    {
+        chip->Valid &= ~0x01;
+    }
+}
+
+/**
+ * Sets the channel wanted for a chip of the chain, it is written by the next
+ * MCP6S2XChainUpdate().
+ *
+ * @param chain     Descriptor of the chain.
+ * @param device    Chip on the chain.
+ * @param channel   Channel, MCP6S2X_SET_CHANNEL_x.
+ */
+void MCP6S2XChainSelectChannel(tMCP6S2XChain *chain,
+                               unsigned char device,
+                               unsigned char channel)
+{
+    tMCP6S2XDevice *chip;
+
+    if (device >= chain->Count)
+    {
+        return;
+    }
+
+    chip = &chain->Devices[device];
+    chip->Channel = channel;
+
+    if (chip->ProgrammedChannel != channel)
+    {
+        chip->Valid &= ~0x02;
+    }
+}
+
+/**
+ * Writes the gains and channels that changed, a command per chip shifted
+ * through the chain in one chip select window. The chips with nothing to
+ * change get a NOP. A chip whose gain and channel both changed takes a
+ * second frame.
+ *
+ * @param chain Descriptor of the chain.
+ * @return Frames sent, 0 if nothing changed.
+ */
+unsigned char MCP6S2XChainUpdate(tMCP6S2XChain *chain)
+{
+    unsigned char frame[MCP6S2X_CHAIN_MAX * 2];
+    unsigned char frames = 0;
+    unsigned char pending;
+    unsigned char i;
+    unsigned char n;
+    tMCP6S2XDevice *chip;
+
+    do
+    {
+        pending = 0;
+        n = 0;
+
+        //the first bytes shifted in end on the last chip of the chain
+        for (i = chain->Count; i-- != 0;)
+        {
+            chip = &chain->Devices[i];
+
+            if ((chip->Valid & 0x01) == 0)
+            {
+                frame[n++] = MCP6S2X_WRITE_TO_GAIN_REGISTER;
+                frame[n++] = chip->Gain;
+                chip->ProgrammedGain = chip->Gain;
+                chip->Valid |= 0x01;
+                pending = 1;
+            }
+            else if ((chip->Valid & 0x02) == 0)
+            {
+                frame[n++] = MCP6S2X_WRITE_TO_CHANNEL_REGISTER;
+                frame[n++] = chip->Channel;
+                chip->ProgrammedChannel = chip->Channel;
+                chip->Valid |= 0x02;
+                pending = 1;
+            }
+            else
+            {
+                frame[n++] = MCP6S2X_NOP;
+                frame[n++] = 0x00;
+            }
+        }
+
+        if (pending)
+        {
+            SPIDeviceSelect(chain->Bus);
+            SPIDeviceSendData(frame, n);
+            SPIDeviceDeselect(chain->Bus);
+            frames++;
+        }
+    }
+    while (pending);
+
+    return frames;
+}
@@ -34,6 +34,9 @@
 #define MCP6S2X_SHUTDOWN                    0b00100000
 #define MCP6S2X_WRITE_TO_CHANNEL_REGISTER   0b01000001
 #define MCP6S2X_WRITE_TO_GAIN_REGISTER      0b01000000
+/**Command that leaves a chip unchanged, to shift the commands of the other
+ chips of a daisy chain through it.*/
+#define MCP6S2X_NOP                         0b00000000
 
 #define MCP6S2X_SET_GAIN_TO_1               0b00000000
 #define MCP6S2X_SET_GAIN_TO_2               0b00000001
@@ -70,6 +73,37 @@
 #define MCP6S2X_SET_CHANNEL_7               0b00000111
 #endif
 
+/**Most chips on a daisy chain. The MCP6S21 has no SO pin and can only be
+ the last chip of a chain.*/
+#ifndef MCP6S2X_CHAIN_MAX
+#define MCP6S2X_CHAIN_MAX                   8
+#endif
+
+/**
+ * A chip of a daisy chain, with the gain and channel wanted and the ones it
+ * has.
+ */
+typedef struct
+{
+    unsigned char Gain;
+    unsigned char Channel;
+    unsigned char ProgrammedGain;
+    unsigned char ProgrammedChannel;
+    /**Bit 0 set when the chip has Gain, bit 1 when it has Channel.*/
+    unsigned char Valid;
+} tMCP6S2XDevice;
+
+/**
+ * PGAs daisy chained from SO to SI on a single chip select. The device 0 is
+ * the one on the SDO of the microcontroller.
+ */
+typedef struct
+{
+    tSPIDevice *Bus;
+    tMCP6S2XDevice *Devices;
+    unsigned char Count;
+} tMCP6S2XChain;
+
 void MCP6S2XShutdown(volatile unsigned char *port,
                      unsigned char portBit);
 void MCP6S2XSetGain(volatile unsigned char *port,
@@ -78,6 +112,17 @@ void MCP6S2XSetGain(volatile unsigned char *port,
 void MCP6S2XSelectChannel(volatile unsigned char *port,
                            unsigned char portBit,
                            unsigned char channel);
+void MCP6S2XChainInit(tMCP6S2XChain *chain,
+                      tSPIDevice *bus,
+                      tMCP6S2XDevice *devices,
+                      unsigned char count);
+void MCP6S2XChainSetGain(tMCP6S2XChain *chain,
+                         unsigned char device,
+                         unsigned char gainValue);
+void MCP6S2XChainSelectChannel(tMCP6S2XChain *chain,
+                               unsigned char device,
+                               unsigned char channel);
+unsigned char MCP6S2XChainUpdate(tMCP6S2XChain *chain);
 
 
 #endif
@@ -1,7 +1,32 @@
 
 #include "MPU9150.h"
 
-uint8_t buffer[16];
+uint8_t buffer[24];
+/** Configuration of the FIFO, to decode its packets*/
+static uint8_t fifoEnable;
+static uint8_t fifoExternalLength;
+static uint16_t fifoOverflows;
+static uint8_t fifoBuffer[MPU9150_FIFO_BURST_SIZE];
+/** The magnetometer is read by the auxiliary I2C master, into
+ EXT_SENS_DATA_00 and in the FIFO if magnetometerFIFO*/
+static bool magnetometerMaster;
+static bool magnetometerFIFO;
+
+/**
+ * Value of a register pair of the MPU-9150, high byte first.
+ */
+static int16_t MPU9150Big(const uint8_t *data)
+{
+    return (int16_t) ((data[0] << 8) | data[1]);
+}
+
+/**
+ * Value of a register pair of the magnetometer, low byte first.
+ */
+static int16_t MPU9150Little(const uint8_t *data)
+{
+    return (int16_t) ((data[1] << 8) | data[0]);
+}
 
 void MPU9150Init(void)
 {
@@ -180,6 +205,7 @@ uint8_t MPU9150GetFifoEn(void)
 
 void MPU9150SetFifoEn(uint8_t config)
 {
+    fifoEnable = config;
     I2CDeviceSetDeviceAddress(MPU9150_ADD_DEFAULT);
     I2CDeviceWriteByte(MPU9150_REG_FIFO_EN, config);
 }
@@ -462,49 +488,49 @@ int16_t MPU9150GetAccelX(void)
 {
     I2CDeviceSetDeviceAddress(MPU9150_ADD_DEFAULT);
     I2CDeviceReadBytes(MPU9150_REG_ACCEL_XOUT_H, 2, buffer);
-    return (buffer[0] << 8) || (buffer[1]);
+    return (int16_t) ((buffer[0] << 8) | buffer[1]);
 }
 
 int16_t MPU9150GetAccelY(void)
 {
     I2CDeviceSetDeviceAddress(MPU9150_ADD_DEFAULT);
     I2CDeviceReadBytes(MPU9150_REG_ACCEL_YOUT_H, 2, buffer);
-    return (buffer[0] << 8) || (buffer[1]);
+    return (int16_t) ((buffer[0] << 8) | buffer[1]);
 }
 
 int16_t MPU9150GetAccelZ(void)
 {
     I2CDeviceSetDeviceAddress(MPU9150_ADD_DEFAULT);
     I2CDeviceReadBytes(MPU9150_REG_ACCEL_ZOUT_H, 2, buffer);
-    return (buffer[0] << 8) || (buffer[1]);
+    return (int16_t) ((buffer[0] << 8) | buffer[1]);
 }
 
 int16_t MPU9150GetTemp(void)
 {
     I2CDeviceSetDeviceAddress(MPU9150_ADD_DEFAULT);
     I2CDeviceReadBytes(MPU9150_REG_TEMP_OUT_H, 2, buffer);
-    return (buffer[0] << 8) || (buffer[1]);
+    return (int16_t) ((buffer[0] << 8) | buffer[1]);
 }
 
 int16_t MPU9150GetGyroX(void)
 {
     I2CDeviceSetDeviceAddress(MPU9150_ADD_DEFAULT);
     I2CDeviceReadBytes(MPU9150_REG_GYRO_XOUT_H, 2, buffer);
-    return (buffer[0] << 8) || (buffer[1]);
+    return (int16_t) ((buffer[0] << 8) | buffer[1]);
 }
 
 int16_t MPU9150GetGyroY(void)
 {
     I2CDeviceSetDeviceAddress(MPU9150_ADD_DEFAULT);
     I2CDeviceReadBytes(MPU9150_REG_GYRO_YOUT_H, 2, buffer);
-    return (buffer[0] << 8) || (buffer[1]);
+    return (int16_t) ((buffer[0] << 8) | buffer[1]);
 }
 
 int16_t MPU9150GetGyroZ(void)
 {
     I2CDeviceSetDeviceAddress(MPU9150_ADD_DEFAULT);
     I2CDeviceReadBytes(MPU9150_REG_GYRO_ZOUT_H, 2, buffer);
-    return (buffer[0] << 8) || (buffer[1]);
+    return (int16_t) ((buffer[0] << 8) | buffer[1]);
 }
 
 uint8_t MPU9150GetMotionDetectionStatus(void)
@@ -664,6 +690,145 @@ void MPU9150SetFIFO(uint8_t data)
     I2CDeviceWriteByte(MPU9150_REG_FIFO_R_W, data);
 }
 
+void MPU9150SetFIFOExternalLength(uint8_t length)
+{
+    fifoExternalLength = length;
+}
+
+uint8_t MPU9150GetFIFOPacketSize(void)
+{
+    uint8_t size = fifoExternalLength;
+
+    if (fifoEnable & MPU9150_FIFO_ACCEL_EN)
+        size += 6;
+    if (fifoEnable & MPU9150_FIFO_TEMP_EN)
+        size += 2;
+    if (fifoEnable & MPU9150_FIFO_XG_EN)
+        size += 2;
+    if (fifoEnable & MPU9150_FIFO_YG_EN)
+        size += 2;
+    if (fifoEnable & MPU9150_FIFO_ZG_EN)
+        size += 2;
+
+    return size;
+}
+
+void MPU9150FIFOReset(void)
+{
+    uint8_t control = MPU9150GetUserControl() & ~MPU9150_FIFO_EN;
+
+    //the FIFO is only reset while it is disabled
+    MPU9150SetUserControl(control);
+    MPU9150SetUserControl(control | MPU9150_FIFO_RESET);
+    MPU9150SetUserControl(control | MPU9150_FIFO_EN);
+}
+
+/**
+ * Decodes a FIFO packet, the values are in the order of the registers.
+ */
+static const uint8_t *MPU9150FIFODecode(const uint8_t *data,
+                                        tMPU9150Sample *sample)
+{
+    static const tMPU9150Sample empty = {0};
+
+    *sample = empty;
+
+    if (fifoEnable & MPU9150_FIFO_ACCEL_EN)
+    {
+        sample->ax = MPU9150Big(&data[0]);
+        sample->ay = MPU9150Big(&data[2]);
+        sample->az = MPU9150Big(&data[4]);
+        data += 6;
+    }
+    if (fifoEnable & MPU9150_FIFO_TEMP_EN)
+    {
+        sample->temp = MPU9150Big(data);
+        data += 2;
+    }
+    if (fifoEnable & MPU9150_FIFO_XG_EN)
+    {
+        sample->gx = MPU9150Big(data);
+        data += 2;
+    }
+    if (fifoEnable & MPU9150_FIFO_YG_EN)
+    {
+        sample->gy = MPU9150Big(data);
+        data += 2;
+    }
+    if (fifoEnable & MPU9150_FIFO_ZG_EN)
+    {
+        sample->gz = MPU9150Big(data);
+        data += 2;
+    }
+
+    //ST1, HXL...HZH and ST2 of the magnetometer first, from slave 0
+    if (magnetometerFIFO)
+    {
+        sample->mx = MPU9150Little(&data[1]);
+        sample->my = MPU9150Little(&data[3]);
+        sample->mz = MPU9150Little(&data[5]);
+        sample->magnetometerStatus = data[7];
+    }
+
+    return data + fifoExternalLength;
+}
+
+uint16_t MPU9150FIFODrain(tMPU9150Sample *samples, uint16_t max)
+{
+    uint8_t packetSize = MPU9150GetFIFOPacketSize();
+    uint8_t perBurst;
+    uint8_t burst;
+    uint16_t packets;
+    uint16_t count;
+    uint16_t read = 0;
+    const uint8_t *data;
+
+    if (packetSize == 0 || packetSize > MPU9150_FIFO_BURST_SIZE)
+        return 0;
+
+    count = MPU9150GetFIFOCount();
+
+    //the oldest bytes were lost, the packets are not aligned anymore
+    if ((MPU9150GetInterruptStatus() & MPU9150_INT_FIFO_OFLOW) ||
+        count >= MPU9150_FIFO_SIZE)
+    {
+        fifoOverflows++;
+        MPU9150FIFOReset();
+        return 0;
+    }
+
+    //a packet being written stays for the next drain
+    packets = count / packetSize;
+    if (packets > max)
+        packets = max;
+
+    perBurst = MPU9150_FIFO_BURST_SIZE / packetSize;
+
+    I2CDeviceSetDeviceAddress(MPU9150_ADD_DEFAULT);
+
+    while (read < packets)
+    {
+        burst = perBurst;
+        if (burst > packets - read)
+            burst = packets - read;
+
+        I2CDeviceReadBytes(MPU9150_REG_FIFO_R_W, burst * packetSize,
+                           fifoBuffer);
+
+        for (data = fifoBuffer; burst; burst--)
+        {
+            data = MPU9150FIFODecode(data, &samples[read++]);
+        }
+    }
+
+    return read;
+}
+
+uint16_t MPU9150GetFIFOOverflows(void)
+{
+    return fifoOverflows;
+}
+
 uint8_t MPU9150GetDeviceID(void)
 {
     I2CDeviceSetDeviceAddress(MPU9150_ADD_DEFAULT);
@@ -703,21 +868,21 @@ int16_t MPU9150GetMagX(void)
 {
     I2CDeviceSetDeviceAddress(MPU9150_ADD_MAG);
     I2CDeviceReadBytes(MPU9150_REG_HXL, 2, &buffer[0]);
-    return (buffer[1] << 8) || buffer[0];
+    return (int16_t) ((buffer[1] << 8) | buffer[0]);
 }
 
 int16_t MPU9150GetMagY(void)
 {
     I2CDeviceSetDeviceAddress(MPU9150_ADD_MAG);
     I2CDeviceReadBytes(MPU9150_REG_HYL, 2, buffer);
-    return (buffer[1] << 8) || buffer[0];
+    return (int16_t) ((buffer[1] << 8) | buffer[0]);
 }
 
 int16_t MPU9150GetMagZ(void)
 {
     I2CDeviceSetDeviceAddress(MPU9150_ADD_MAG);
     I2CDeviceReadBytes(MPU9150_REG_HZL, 2, buffer);
-    return (buffer[1] << 8) || buffer[0];
+    return (int16_t) ((buffer[1] << 8) | buffer[0]);
 }
 
 uint8_t MPU9150GetMagControl(void)
@@ -806,24 +971,127 @@ void MPU9150SetMagASAZ(uint8_t data)
     I2CDeviceWriteByte(MPU9150_REG_ASAZ, data);
 }
 
-void MPU9150Get9AxisValue(int16_t* ax, int16_t* ay, int16_t* az,
-                          int16_t* gx, int16_t* gy, int16_t* gz,
-                          int16_t* mx, int16_t* my, int16_t* mz)
+void MPU9150GetMotion6(int16_t* ax, int16_t* ay, int16_t* az,
+                       int16_t* gx, int16_t* gy, int16_t* gz)
 {
+    //accelerometer, temperature and gyroscope in one burst, all of the same
+    //sample
     I2CDeviceSetDeviceAddress(MPU9150_ADD_DEFAULT);
     I2CDeviceReadBytes(MPU9150_REG_ACCEL_XOUT_H, 14, &buffer[0]);
-    *ax = (((int16_t) buffer[0]) << 8) | buffer[1];
-    *ay = (((int16_t) buffer[2]) << 8) | buffer[3];
-    *az = (((int16_t) buffer[4]) << 8) | buffer[5];
-    *gx = (((int16_t) buffer[8]) << 8) | buffer[9];
-    *gy = (((int16_t) buffer[10]) << 8) | buffer[11];
-    *gz = (((int16_t) buffer[12]) << 8) | buffer[13];
-
-    I2CDeviceWriteByte(MPU9150_REG_INT_PIN_CFG, 0x02);
+    *ax = MPU9150Big(&buffer[0]);
+    *ay = MPU9150Big(&buffer[2]);
+    *az = MPU9150Big(&buffer[4]);
+    *gx = MPU9150Big(&buffer[8]);
+    *gy = MPU9150Big(&buffer[10]);
+    *gz = MPU9150Big(&buffer[12]);
+}
+
+bool MPU9150GetMotion9(int16_t* ax, int16_t* ay, int16_t* az,
+                       int16_t* gx, int16_t* gy, int16_t* gz,
+                       int16_t* mx, int16_t* my, int16_t* mz)
+{
+    if (magnetometerMaster)
+    {
+        //EXT_SENS_DATA_00 follows GYRO_ZOUT_L, everything in one burst
+        I2CDeviceSetDeviceAddress(MPU9150_ADD_DEFAULT);
+        I2CDeviceReadBytes(MPU9150_REG_ACCEL_XOUT_H,
+                           14 + MPU9150_MAG_MASTER_LENGTH, &buffer[0]);
+        *ax = MPU9150Big(&buffer[0]);
+        *ay = MPU9150Big(&buffer[2]);
+        *az = MPU9150Big(&buffer[4]);
+        *gx = MPU9150Big(&buffer[8]);
+        *gy = MPU9150Big(&buffer[10]);
+        *gz = MPU9150Big(&buffer[12]);
+        *mx = MPU9150Little(&buffer[15]);
+        *my = MPU9150Little(&buffer[17]);
+        *mz = MPU9150Little(&buffer[19]);
+
+        return !(buffer[21] & (MPU9150_MAG_HOFL | MPU9150_MAG_DERR));
+    }
+
+    MPU9150GetMotion6(ax, ay, az, gx, gy, gz);
+
+    //the measurement and ST2 in one burst, reading them releases the data
     I2CDeviceSetDeviceAddress(MPU9150_ADD_MAG);
-    I2CDeviceWriteByte(MPU9150_REG_CNTL, 0x01); //enable the magnetometer
-    I2CDeviceReadBytes(MPU9150_REG_HXL, 6, &buffer[0]);
-    *mx = (((int16_t) buffer[0]) << 8) | buffer[1];
-    *my = (((int16_t) buffer[2]) << 8) | buffer[3];
-    *mz = (((int16_t) buffer[4]) << 8) | buffer[5];
+    I2CDeviceReadBytes(MPU9150_REG_HXL, 7, &buffer[0]);
+    *mx = MPU9150Little(&buffer[0]);
+    *my = MPU9150Little(&buffer[2]);
+    *mz = MPU9150Little(&buffer[4]);
+
+    //next measurement, ready for the next call (7.3 ms at most)
+    I2CDeviceWriteByte(MPU9150_REG_CNTL, MPU9150_MAG_MEASURE);
+
+    return !(buffer[6] & (MPU9150_MAG_HOFL | MPU9150_MAG_DERR));
+}
+
+void MPU9150MagMasterBegin(uint8_t delay, bool fifo)
+{
+    I2CDeviceSetDeviceAddress(MPU9150_ADD_DEFAULT);
+
+    //the auxiliary bus is not connected to the host anymore
+    MPU9150SetInterruptPinConfig(MPU9150GetInterruptPinConfig() &
+                                 ~MPU9150_I2C_BYPASS_EN);
+    MPU9150SetI2CMasterControl(MPU9150_WAIT_FOR_ES | MPU9150_I2C_MST_CLK_400);
+
+    //slave 0 reads ST1 to ST2, slave 1 starts the next measurement
+    MPU9150SetI2CSlave0Address(MPU9150_I2C_SLV_READ | MPU9150_ADD_MAG);
+    MPU9150SetI2CSlave0Register(MPU9150_REG_ST1);
+    MPU9150SetI2CSlave0Control(MPU9150_I2C_SLV_EN | MPU9150_MAG_MASTER_LENGTH);
+    MPU9150SetI2CSlave1Address(MPU9150_I2C_SLV_WRITE | MPU9150_ADD_MAG);
+    MPU9150SetI2CSlave1Register(MPU9150_REG_CNTL);
+    MPU9150SetI2CSlave1DataOut(MPU9150_MAG_MEASURE);
+    MPU9150SetI2CSlave1Control(MPU9150_I2C_SLV_EN | 1);
+
+    //the slaves are accessed every delay + 1 samples
+    MPU9150SetI2CSlave4Control(delay & 0x1F);
+    MPU9150SetI2CMasterDelayControl(MPU9150_I2C_DELAY_ES_SHADOW |
+                                    MPU9150_I2C_DELAY_SLV1_EN |
+                                    MPU9150_I2C_DELAY_SLV0_EN);
+
+    magnetometerMaster = true;
+    magnetometerFIFO = fifo;
+
+    if (fifo)
+    {
+        MPU9150SetFIFOExternalLength(MPU9150_MAG_MASTER_LENGTH);
+        MPU9150SetFifoEn(fifoEnable | MPU9150_FIFO_SLV0_EN);
+    }
+
+    MPU9150SetUserControl(MPU9150GetUserControl() | MPU9150_I2C_MST_EN);
+
+    if (fifo)
+        MPU9150FIFOReset();
+}
+
+void MPU9150MagMasterEnd(void)
+{
+    I2CDeviceSetDeviceAddress(MPU9150_ADD_DEFAULT);
+
+    if (magnetometerFIFO)
+    {
+        MPU9150SetFifoEn(fifoEnable & ~MPU9150_FIFO_SLV0_EN);
+        MPU9150SetFIFOExternalLength(0);
+    }
+
+    MPU9150SetUserControl(MPU9150GetUserControl() & ~MPU9150_I2C_MST_EN);
+    MPU9150SetI2CSlave0Control(0);
+    MPU9150SetI2CSlave1Control(0);
+    MPU9150SetInterruptPinConfig(MPU9150GetInterruptPinConfig() |
+                                 MPU9150_I2C_BYPASS_EN);
+
+    magnetometerMaster = false;
+    magnetometerFIFO = false;
+}
+
+void MPU9150Get9AxisValue(int16_t* ax, int16_t* ay, int16_t* az,
+                          int16_t* gx, int16_t* gy, int16_t* gz,
+                          int16_t* mx, int16_t* my, int16_t* mz)
+{
+    if (!magnetometerMaster)
+    {
+        I2CDeviceSetDeviceAddress(MPU9150_ADD_DEFAULT);
+        I2CDeviceWriteByte(MPU9150_REG_INT_PIN_CFG, MPU9150_I2C_BYPASS_EN);
+    }
+
+    MPU9150GetMotion9(ax, ay, az, gx, gy, gz, mx, my, mz);
 }
@@ -375,6 +375,31 @@ along with this program.	If not, see <http://www.gnu.org/licenses/>.
 #define MPU9150_MAG_ASTC_SELF	0b01000000
 #define MPU9150_MAG_I2C_DISABLE	0x01
 
+/** Bytes of the magnetometer read by the auxiliary I2C master, ST1 to ST2*/
+#define MPU9150_MAG_MASTER_LENGTH	8
+
+/** FIFO **/
+#define MPU9150_FIFO_SIZE		1024
+/** Bytes read from FIFO_R_W in a burst, only whole packets are read so it
+ has to be at least the size of a packet (255 at most)*/
+#ifndef MPU9150_FIFO_BURST_SIZE
+#define MPU9150_FIFO_BURST_SIZE	48
+#endif
+
+/**
+ * Sample read from the FIFO, the values not enabled in the FIFO are 0.
+ */
+typedef struct
+{
+    int16_t ax, ay, az;
+    int16_t temp;
+    int16_t gx, gy, gz;
+    /** Magnetometer, with MPU9150MagMasterBegin() in FIFO mode*/
+    int16_t mx, my, mz;
+    /** ST2 of the magnetometer, MPU9150_MAG_HOFL and MPU9150_MAG_DERR*/
+    uint8_t magnetometerStatus;
+} tMPU9150Sample;
+
 void MPU9150Init(void);
 
 bool MPU9150TestConnection(void);
@@ -488,6 +513,32 @@ void MPU9150SetPowerManagement2(uint8_t config);
 uint16_t MPU9150GetFIFOCount(void);
 uint8_t MPU9150GetFIFO(void);
 void MPU9150SetFIFO(uint8_t data);
+/**
+ * Number of bytes of the slaves of the auxiliary I2C master in a FIFO
+ * packet, they are skipped by MPU9150FIFODrain().
+ */
+void MPU9150SetFIFOExternalLength(uint8_t length);
+/**
+ * Size of a FIFO packet, from the last MPU9150SetFifoEn().
+ */
+uint8_t MPU9150GetFIFOPacketSize(void);
+/**
+ * Empties the FIFO, the packets start again from the first byte.
+ */
+void MPU9150FIFOReset(void);
+/**
+ * Reads the whole packets of the FIFO, up to max, in bursts of
+ * MPU9150_FIFO_BURST_SIZE bytes. On an overflow the FIFO is reset, to be
+ * aligned on a packet again, and nothing is read.
+ * @param samples Where the samples are stored, the oldest first.
+ * @param max Number of samples that fit in samples.
+ * @return Number of samples read.
+ */
+uint16_t MPU9150FIFODrain(tMPU9150Sample *samples, uint16_t max);
+/**
+ * Number of times the FIFO overflowed, see MPU9150FIFODrain().
+ */
+uint16_t MPU9150GetFIFOOverflows(void);
 
 uint8_t MPU9150GetDeviceID(void);
 
@@ -514,6 +565,37 @@ uint8_t MPU9150GetMagASAY(void);
 void MPU9150SetMagASAY(uint8_t data);
 uint8_t MPU9150GetMagASAZ(void);
 void MPU9150SetMagASAZ(uint8_t data);
+
+/**
+ * Reads the accelerometer and the gyroscope in a single burst, all the axes
+ * are of the same sample.
+ */
+void MPU9150GetMotion6(int16_t* ax, int16_t* ay, int16_t* az,
+                       int16_t* gx, int16_t* gy, int16_t* gz);
+/**
+ * MPU9150GetMotion6() and the last measurement of the magnetometer, in a
+ * second burst, then starts the next measurement. The bypass has to be
+ * enabled (MPU9150_I2C_BYPASS_EN) and a measurement started once before.
+ * @return false if the magnetometer overflowed or had a data error.
+ */
+bool MPU9150GetMotion9(int16_t* ax, int16_t* ay, int16_t* az,
+                       int16_t* gx, int16_t* gy, int16_t* gz,
+                       int16_t* mx, int16_t* my, int16_t* mz);
+/**
+ * Reads the magnetometer with the auxiliary I2C master of the MPU-9150
+ * instead of the host: slave 0 copies ST1 to ST2 in EXT_SENS_DATA_00 and
+ * slave 1 starts the next measurement. MPU9150GetMotion9() is then a single
+ * burst.
+ * @param delay The magnetometer is accessed every delay + 1 samples (0 to
+ *              31), it needs 7.3 ms for a measurement.
+ * @param fifo The magnetometer data goes in the FIFO too, after the other
+ *             values enabled, and MPU9150FIFODrain() decodes it.
+ */
+void MPU9150MagMasterBegin(uint8_t delay, bool fifo);
+/**
+ * Stops the auxiliary I2C master, the magnetometer is in bypass again.
+ */
+void MPU9150MagMasterEnd(void);
 void MPU9150Get9AxisValue(int16_t* ax, int16_t* ay, int16_t* az,
                           int16_t* gx, int16_t* gy, int16_t* gz,
                           int16_t* mx, int16_t* my, int16_t* mz);
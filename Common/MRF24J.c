@@ -1,13 +1,49 @@
 
 #include "MRF24J.h"
 
-unsigned char MRF24J40ReadShort(unsigned char address);
-unsigned char MRF24J40ReadLong(unsigned int address);
-void MRF24J40WriteShort(unsigned char address, unsigned char data);
-void MRF24J40WriteLong(unsigned int address, unsigned char data);
-
 unsigned short panID = 0;
 unsigned short ownAirAddress = 0;
+unsigned char sequenceNumber = 0;
+unsigned char currentChannel = 11;
+
+/**Long address, the source of the secured frames.*/
+static unsigned char ownLongAddress[8];
+/**SECCON0 of the secured mode, the ciphers of TX and RX.*/
+static unsigned char securityControl = 0;
+/**Bytes of the MIC, 0 when the frames are not secured.*/
+static unsigned char securityMicLength = 0;
+static unsigned char securityKeySequence;
+static uint32_t securityFrameCounter;
+
+/**Short registers whose last written value is kept, they are written again
+ only when the value changes and are read from the cache.*/
+static const unsigned char cachedAddress[] = {
+    MRF_RXMCR, MRF_RXFLUSH, MRF_TXMCR, MRF_BBREG1, MRF_BBREG2, MRF_BBREG6,
+    MRF_CCAEDTH, MRF_INTCON
+};
+static unsigned char cachedValue[sizeof (cachedAddress)];
+/**Bit of every register of the cache whose value is known.*/
+static unsigned char cachedValid = 0;
+
+/**
+ * Gives the place of a short register in the cache.
+ * @param address Short address.
+ * @return Index in the cache, 0xFF if the register is not kept.
+ */
+static unsigned char MRF24J40CacheIndex(unsigned char address)
+{
+    unsigned char i;
+
+    for (i = 0; i < sizeof (cachedAddress); i++)
+    {
+        if (cachedAddress[i] == address)
+        {
+            return i;
+        }
+    }
+
+    return 0xFF;
+}
 
 unsigned char MRF24J40ReadShort(unsigned char address)
 {
@@ -25,29 +61,62 @@ unsigned char MRF24J40ReadShort(unsigned char address)
     return data;
 }
 
-unsigned char MRF24J40ReadLong(unsigned int address)
+/**
+ * Sends the 2 bytes of a long address, the device has to be selected. The
+ * following bytes go to or come from the next addresses, the address is
+ * incremented by the device.
+ * @param address Long address, 10 bits.
+ * @param write Non zero to write.
+ */
+static void MRF24J40LongAddress(unsigned int address, unsigned char write)
 {
-    unsigned char data = 0, msb = 0, lsb = 0;
-
     address &= 0x03FF; //Trim address to 10 bits
     address <<= 5; //Shift the address to the msb's
-    address &= ~0x0010; //Clear write bit (read)
+    if (write)
+        address |= 0x0010; //Set write bit (write)
     address |= 0x8000; //Set long addr bit
 
-    msb = (unsigned char) ((address & 0xFF00) >> 8); //Get the 8 msb and shift it into position
-    lsb = (unsigned char) (address & 0x00FF); //Get the 8 lsb
+    SPIWrite((unsigned char) ((address & 0xFF00) >> 8)); //the 8 msb
+    SPIWrite((unsigned char) (address & 0x00FF)); //the 8 lsb
+}
+
+unsigned char MRF24J40ReadLong(unsigned int address)
+{
+    unsigned char data = 0;
 
     RadioSelect();
-    SPIWrite(msb);
-    SPIWrite(lsb);
+    MRF24J40LongAddress(address, 0);
     data = SPIRead();
     RadioDeselect();
 
     return data;
 }
 
+/**
+ * Reads sequential long addresses in one access, the address is sent once.
+ * @param address First long address.
+ * @param data Buffer for the bytes read.
+ * @param length Number of bytes to read.
+ */
+void MRF24J40ReadLongBurst(unsigned int address, unsigned char *data, unsigned int length)
+{
+    RadioSelect();
+    MRF24J40LongAddress(address, 0);
+    SPIDeviceReceiveData(data, length);
+    RadioDeselect();
+}
+
 void MRF24J40WriteShort(unsigned char address, unsigned char data)
 {
+    unsigned char index = MRF24J40CacheIndex(address);
+
+    if (index != 0xFF)
+    {
+        // RXFLUSH bit 0 clears itself
+        cachedValue[index] = (address == MRF_RXFLUSH) ? (data & ~0x01) : data;
+        cachedValid |= 1 << index;
+    }
+
     address &= 0x3f; /* Trim address to 6 bits */
     address <<= 1; /* Shift into the right position */
     address |= 0x01; /* Set R/W bit to write */
@@ -60,32 +129,72 @@ void MRF24J40WriteShort(unsigned char address, unsigned char data)
 
 void MRF24J40WriteLong(unsigned int address, unsigned char data)
 {
-    unsigned char msb = 0, lsb = 0;
-
-    address &= 0x03FF; //Trim address to 10 bits
-    address <<= 5; //Shift the address to the msb's
-    address |= 0x0010; //Clear write bit (write)
-    address |= 0x8000; //Set long addr bit
-
-    msb = (unsigned char) ((address & 0xFF00) >> 8);
-    lsb = (unsigned char) (address & 0x00FF);
-
     RadioSelect();
-    SPIWrite(msb);
-    SPIWrite(lsb);
+    MRF24J40LongAddress(address, 1);
     SPIWrite(data);
     RadioDeselect();
 }
 
+/**
+ * Writes sequential long addresses in one access, the address is sent once.
+ * @param address First long address.
+ * @param data Bytes to write.
+ * @param length Number of bytes to write.
+ */
+void MRF24J40WriteLongBurst(unsigned int address, const unsigned char *data, unsigned int length)
+{
+    RadioSelect();
+    MRF24J40LongAddress(address, 1);
+    SPIDeviceSendData(data, length);
+    RadioDeselect();
+}
+
+/**
+ * Writes a short register only if its value changes, the register has to be
+ * one of the cache.
+ * @param address Short address.
+ * @param data Value.
+ */
+void MRF24J40WriteShortCached(unsigned char address, unsigned char data)
+{
+    unsigned char index = MRF24J40CacheIndex(address);
+
+    if ((index != 0xFF) && (cachedValid & (1 << index))
+            && (cachedValue[index] == data))
+    {
+        return;
+    }
+
+    MRF24J40WriteShort(address, data);
+}
+
+/**
+ * Reads a short register from the cache, from the device if it is not
+ * there.
+ * @param address Short address.
+ * @return Value of the register.
+ */
+unsigned char MRF24J40ReadShortCached(unsigned char address)
+{
+    unsigned char index = MRF24J40CacheIndex(address);
+
+    if ((index != 0xFF) && (cachedValid & (1 << index)))
+    {
+        return cachedValue[index];
+    }
+
+    return MRF24J40ReadShort(address);
+}
+
 void MRF24J40Reset(void)
 {
+    cachedValid = 0;
     RadioHardwareReset();
 }
 
 unsigned int MRF24J40GetPanID(void)
 {
-    unsigned int panh = MRF24J40ReadShort(MRF_PANIDH);
-    return (panh << 8 | MRF24J40ReadShort(MRF_PANIDL));
+    return panID;
 }
 
 void MRF24J40SetPanID(unsigned int panid)
@@ -99,12 +208,12 @@ void MRF24J40ShortAddressWrite(unsigned int address)
 {
     MRF24J40WriteShort(MRF_SADRH, address >> 8);
     MRF24J40WriteShort(MRF_SADRL, address & 0xff);
+    ownAirAddress = address;
 }
 
 unsigned int MRF24J40ShortAddressRead(void)
 {
-    unsigned int a16h = MRF24J40ReadShort(MRF_SADRH);
-    return (a16h << 8 | MRF24J40ReadShort(MRF_SADRL));
+    return ownAirAddress;
 }
 
 void MRF24J40LongAddressWrite(unsigned char * address)
@@ -114,6 +223,7 @@ void MRF24J40LongAddressWrite(unsigned char * address)
     for (i = 0; i < 8; i++)
     {
         MRF24J40WriteShort(MRF_EADR0 + i, address[i]); // 0x05 address of EADR0
+        ownLongAddress[i] = address[i];
     }
 }
 
@@ -128,50 +238,126 @@ void MRF24J40LongAddressRead(unsigned char * address)
 }
 
 /**
- * Simple send 16, with acks, not much of anything.. assumes src16 and local pan only.
- * @param data
+ * Writes a secured frame to the TX normal FIFO and starts its transmission,
+ * the device encrypts the payload and appends the MIC. The header, the
+ * frame counter and the key sequence number are only authenticated.
+ * @param dest Short address of the destination.
+ * @param sequence Sequence number of the frame.
+ * @param len Payload length.
+ * @param packet Payload.
  */
-void MRF24J40SendPacket(unsigned int dest, unsigned int len, unsigned char* packet)
+static void MRF24J40SendSecuredFrame(unsigned int dest, unsigned char sequence, unsigned int len, unsigned char* packet)
 {
-    int i = 0, q = 0;
+    unsigned char header[22];
+    bool ack = (dest != 0xFFFF);
+    unsigned char i;
 
-    MRF24J40WriteLong(i++, 11); // header length
-    MRF24J40WriteLong(i++, 11 + len);
+    header[0] = 20; // header length, up to the key sequence number
+    header[1] = 20 + len + securityMicLength;
 
-    // 0 | pan compression | ack | no security | no data pending | data frame[3 bits]
-    MRF24J40WriteLong(i++, 0x61); // first byte of Frame Control
+    // 0 | pan compression | ack | security | no data pending | data frame[3 bits]
+    header[2] = ack ? 0x69 : 0x49;
 
-    // 16 bit source, 802.15.4 (2003), 16 bit dest
-    MRF24J40WriteLong(i++, 0x88); // second byte of frame control
+    // 64 bit source, 802.15.4 (2003), 16 bit dest
+    header[3] = 0xC8;
 
-    MRF24J40WriteLong(i++, 1); // sequence number 1
+    header[4] = sequence;
 
-    MRF24J40WriteLong(i++, panID & 0xff); // dest panid
-    MRF24J40WriteLong(i++, panID >> 8);
+    header[5] = panID & 0xff; // dest panid
+    header[6] = panID >> 8;
 
-    MRF24J40WriteLong(i++, dest & 0xff); // dest16 low
-    MRF24J40WriteLong(i++, dest >> 8); // dest16 high
+    header[7] = dest & 0xff; // dest16 low
+    header[8] = dest >> 8; // dest16 high
 
-    MRF24J40WriteLong(i++, panID & 0xff); // dest panid
-    MRF24J40WriteLong(i++, panID >> 8);
+    for (i = 0; i < 8; i++)
+    {
+        header[9 + i] = ownLongAddress[i]; // src64, for the nonce
+    }
 
-    MRF24J40WriteLong(i++, ownAirAddress & 0xff); // src16 low
-    MRF24J40WriteLong(i++, ownAirAddress >> 8); // src16 high
+    header[17] = securityFrameCounter & 0xff;
+    header[18] = (securityFrameCounter >> 8) & 0xff;
+    header[19] = (securityFrameCounter >> 16) & 0xff;
+    header[20] = securityFrameCounter >> 24;
+    header[21] = securityKeySequence;
+    securityFrameCounter++;
 
-    for (q = 0; q < len; q++)
+    RadioSelect();
+    MRF24J40LongAddress(MRF_TXNORMALFIFO, 1);
+    SPIDeviceSendData(header, sizeof (header));
+    SPIDeviceSendData(packet, len);
+    RadioDeselect();
+
+    // ack on, encryption on, and go!
+    MRF24J40WriteShort(MRF_TXNCON, (ack ? 0x05 : 0x01) | (1 << MRF_TXNSECEN));
+}
+
+/**
+ * Writes a frame to the TX normal FIFO and starts its transmission. A frame
+ * to a short address asks for an acknowledgement, the device waits for it
+ * and retransmits it itself, a broadcast (0xFFFF) doesn't.
+ * @param dest Short address of the destination.
+ * @param sequence Sequence number of the frame.
+ * @param len Payload length.
+ * @param packet Payload.
+ */
+void MRF24J40SendFrame(unsigned int dest, unsigned char sequence, unsigned int len, unsigned char* packet)
+{
+    unsigned char header[13];
+    bool ack = (dest != 0xFFFF);
+
+    if (securityMicLength != 0)
     {
-        MRF24J40WriteLong(i++, packet[q]);
+        MRF24J40SendSecuredFrame(dest, sequence, len, packet);
+        return;
     }
 
+    header[0] = 11; // header length
+    header[1] = 11 + len;
+
+    // 0 | pan compression | ack | no security | no data pending | data frame[3 bits]
+    header[2] = ack ? 0x61 : 0x41; // first byte of Frame Control
+
+    // 16 bit source, 802.15.4 (2003), 16 bit dest
+    header[3] = 0x88; // second byte of frame control
+
+    header[4] = sequence;
+
+    header[5] = panID & 0xff; // dest panid
+    header[6] = panID >> 8;
+
+    header[7] = dest & 0xff; // dest16 low
+    header[8] = dest >> 8; // dest16 high
+
+    header[9] = panID & 0xff; // dest panid
+    header[10] = panID >> 8;
+
+    header[11] = ownAirAddress & 0xff; // src16 low
+    header[12] = ownAirAddress >> 8; // src16 high
+
+    // the TX normal FIFO is written in one access, the payload follows the header
+    RadioSelect();
+    MRF24J40LongAddress(0, 1);
+    SPIDeviceSendData(header, sizeof (header));
+    SPIDeviceSendData(packet, len);
+    RadioDeselect();
+
     // ack on, and go!
-    MRF24J40WriteShort(MRF_TXNCON, 0x05);
+    MRF24J40WriteShort(MRF_TXNCON, ack ? 0x05 : 0x01);
+}
+
+/**
+ * Simple send 16, with acks, not much of anything.. assumes src16 and local pan only.
+ * @param data
+ */
+void MRF24J40SendPacket(unsigned int dest, unsigned int len, unsigned char* packet)
+{
+    MRF24J40SendFrame(dest, sequenceNumber++, len, packet);
 }
 
 unsigned char MRF24J40ReceivePacket(unsigned char* packet)
 {
     unsigned char frameLength = 0;
 //     unsigned char header[12] = {0};
-    unsigned char i = 0x00;
 //     unsigned char lqi = 0, rssi = 0;
 
     // We got a packet.
@@ -185,9 +371,9 @@ unsigned char MRF24J40ReceivePacket(unsigned char* packet)
 //     for (i = 0; i < 12; i++)
 //         header[i] = MRF24J40ReadLong(MRF_RXFIFO + i);
 
-    for (i = 12; i < frameLength - 1; i++)
+    if (frameLength > 13)
     {
-        packet[i - 12] = MRF24J40ReadLong(MRF_RXFIFO + i);
+        MRF24J40ReadLongBurst(MRF_RXFIFO + 12, packet, frameLength - 13);
     }
 
 //     lqi = MRF24J40ReadLong(MRF_RXFIFO + frameLength + 1);
@@ -202,6 +388,114 @@ unsigned char MRF24J40ReceivePacket(unsigned char* packet)
     return frameLength;
 }
 
+/**
+ * Sends the data of a buffer of the packet pool, from the buffer itself. The
+ * frame is in the TX FIFO when it returns, the caller can release the
+ * buffer.
+ * @param dest Short address of the destination.
+ * @param handle Buffer with the payload.
+ */
+void MRF24J40SendBuffer(unsigned int dest, tPacketHandle handle)
+{
+    MRF24J40SendPacket(dest, uPacketPoolLength(handle), uPacketPoolData(handle));
+}
+
+/**
+ * Receives a frame straight into a buffer of the packet pool, the header
+ * and the payload are read from the RX FIFO in one burst each. The frame is
+ * dropped if the pool is empty. A secured frame was decrypted by the device
+ * after MRF24J40SecurityInterrupt(), it is dropped if its MIC is wrong or
+ * the secured mode is off.
+ * @param info Source, sequence number and link quality of the frame, can be
+ *             NULL.
+ * @return Handle of the buffer with the payload, of uPacketPoolLength()
+ *         bytes, or UPACKETPOOL_NONE. The caller releases it.
+ */
+tPacketHandle MRF24J40ReceiveFrame(tMRF24J40FrameInfo *info)
+{
+    tPacketHandle handle = uPacketPoolAlloc();
+    unsigned char header[21];
+    unsigned char quality[2];
+    unsigned char length = 0;
+    unsigned char start = 12;
+    unsigned char overhead = 13;
+    bool secured;
+
+    // Disable receiving packets off air, set RXDECINV = 1
+    MRF24J40RXDisable();
+
+    // frame length, frame control, sequence, dest pan, dest16, src pan, src16
+    MRF24J40ReadLongBurst(MRF_RXFIFO, header, 12);
+    secured = (header[1] & 0x08) != 0;
+
+    if (secured)
+    {
+        // dest16, src64, frame counter, key sequence, then the decrypted
+        // payload and the MIC
+        MRF24J40ReadLongBurst(MRF_RXFIFO + 12, header + 12, sizeof (header) - 12);
+        start = 21;
+        overhead = 22 + securityMicLength;
+
+        if ((securityMicLength == 0)
+                || (MRF24J40ReadShort(MRF_RXSR) & (1 << MRF_SECDECERR)))
+        {
+            overhead = 0xFF;
+        }
+    }
+
+    if ((handle != UPACKETPOOL_NONE) && (header[0] > overhead))
+    {
+        length = MIN(header[0] - overhead, UPACKETPOOL_BUFFER_SIZE);
+        MRF24J40ReadLongBurst(MRF_RXFIFO + start, uPacketPoolData(handle), length);
+        uPacketPoolSetLength(handle, length);
+
+        if (info != NULL)
+        {
+            MRF24J40ReadLongBurst(MRF_RXFIFO + header[0] + 1, quality, sizeof (quality));
+            info->Sequence = header[3];
+            info->LQI = quality[0];
+            info->RSSI = quality[1];
+            info->Secured = secured;
+
+            if (secured)
+            {
+                info->Source = ((unsigned int) header[9] << 8) | header[8];
+                info->FrameCounter = ((uint32_t) header[19] << 24) |
+                        ((uint32_t) header[18] << 16) |
+                        ((uint32_t) header[17] << 8) | header[16];
+            }
+            else
+            {
+                info->Source = ((unsigned int) header[11] << 8) | header[10];
+                info->FrameCounter = 0;
+            }
+        }
+    }
+    else if (handle != UPACKETPOOL_NONE)
+    {
+        uPacketPoolRelease(handle);
+        handle = UPACKETPOOL_NONE;
+    }
+
+    // Flush rx fifo
+    MRF24J40RXFlush();
+
+    // Enable receiving packets off air, set RXDECINV = 0
+    MRF24J40RXEnable();
+
+    return handle;
+}
+
+/**
+ * Receives a frame straight into a buffer of the packet pool, see
+ * MRF24J40ReceiveFrame().
+ * @return Handle of the buffer with the payload, or UPACKETPOOL_NONE.
+ */
+tPacketHandle MRF24J40ReceiveBuffer(void)
+{
+    return MRF24J40ReceiveFrame(NULL);
+}
+
 void MRF24J40SetInterrupts(void)
 {
     // interrupts for rx and tx normal complete
@@ -215,18 +509,30 @@ unsigned char MRF24J40GetInterrupts(void)
     return (MRF24J40ReadShort(MRF_INTSTAT));
 }
 
-/** use the 802.15.4 channel numbers..
+/**
+ * Sets the channel, using the 802.15.4 channel numbers (11..26). Channel 26
+ * is not allowed with the PA of the MRF24J40MB/MC modules.
+ * @param channel Channel number.
+ * @return False if the channel is not valid.
  */
-void MRF24J40SetChannel(unsigned char channel)
+bool MRF24J40SetChannel(unsigned char channel)
 {
-    MRF24J40WriteLong(MRF_RFCON0, (((channel) << 4) | 0x03));
+    if ((channel < 11) || (channel > MRF24J40_MAX_CHANNEL))
+    {
+        return false;
+    }
+
+    currentChannel = channel;
+    MRF24J40WriteLong(MRF_RFCON0, ((channel - 11) << 4) | 0x03);
     MRF24J40WriteShort(MRF_RFCTL, 0x04); //  â??? Reset RF state machine.
     MRF24J40WriteShort(MRF_RFCTL, 0x00); // part 2
+
+    return true;
 }
 
 unsigned char MRF24J40GetChannel(void)
 {
-    return (11 + (MRF24J40ReadLong(MRF_RFCON0) >> 4));
+    return currentChannel;
 }
 
 void MRF24J40SetPower(unsigned char power)
@@ -258,13 +564,19 @@ void MRF24J40Init(unsigned char channel, unsigned char power, unsigned int pan,
 
     RadioWake();
 
+#if defined(MRF24J40_ENABLE_PA_LNA)
+#if defined(MRF24J40MC)
+    MRF24J40WriteShort(MRF_TRISGPIO, 0x08);
+    MRF24J40WriteShort(MRF_GPIO, 0x08);
+#endif
     MRF24J40WriteLong(MRF_TESTMODE, 0x0f); //enable PA/LNA
+#endif
 
     MRF24J40WriteShort(MRF_RFCTL, 0x04); // Reset RF state machine.
     MRF24J40WriteShort(MRF_RFCTL, 0x00); // part 2
 
     MRF24J40WriteLong(MRF_RFCON0, 0x03); //Initialize RFOPT = 0x03.
-    MRF24J40WriteLong(MRF_RFCON1, 0x01); //Initialize VCOOPT = 0x02.
+    MRF24J40WriteLong(MRF_RFCON1, 0x02); //Initialize VCOOPT = 0x02, stable under extreme temperatures.
     MRF24J40WriteLong(MRF_RFCON2, 0x80); //Enable PLL (PLLEN = 1).
     MRF24J40SetPower(power);
     MRF24J40WriteLong(MRF_RFCON6, 0x90); //Initialize TXFIL = 1 and 20MRECVR = 1.
@@ -281,12 +593,17 @@ void MRF24J40Init(unsigned char channel, unsigned char power, unsigned int pan,
     MRF24J40WriteShort(MRF_PACON2, 0x98); //Initialize FIFOEN = 1 and TXONTS = 0x6.
     MRF24J40WriteShort(MRF_TXSTBL, 0x95); //Initialize RFSTBL = 0x9.
 
+#if defined(MRF24J40_TURBO_MODE)
+    MRF24J40WriteShort(MRF_BBREG0, 0x01); // 625 kbps
+    MRF24J40WriteShort(MRF_BBREG3, 0x38);
+    MRF24J40WriteShort(MRF_BBREG4, 0x5C);
+#endif
+
     MRF24J40SetInterrupts();
     MRF24J40SetChannel(channel);
 
     MRF24J40SetPanID(pan);
     MRF24J40ShortAddressWrite(short_address);
-    ownAirAddress = short_address;
 
     // wait for mrf to be in receive mode
     while ((MRF24J40ReadLong(MRF_RFSTATE) & 0xA0) != 0xA0);
@@ -301,17 +618,17 @@ void MRF24J40SetPromiscuous(bool enabled)
 {
     if (enabled == true)
     {
-        MRF24J40WriteShort(MRF_RXMCR, 0x01);
+        MRF24J40WriteShortCached(MRF_RXMCR, 0x01);
     }
     else
     {
-        MRF24J40WriteShort(MRF_RXMCR, 0x00);
+        MRF24J40WriteShortCached(MRF_RXMCR, 0x00);
     }
 }
 
 void MRF24J40RXFlush(void)
 {
-    MRF24J40WriteShort(MRF_RXFLUSH, MRF24J40ReadShort(MRF_RXFLUSH) | 0x01);
+    MRF24J40WriteShort(MRF_RXFLUSH, MRF24J40ReadShortCached(MRF_RXFLUSH) | 0x01);
 }
 
 void MRF24J40RXDisable(void)
@@ -323,3 +640,84 @@ void MRF24J40RXEnable(void)
 {
     MRF24J40WriteShort(MRF_BBREG1, 0x00); // RXDECINV - enable receiver
 }
+
+/**
+ * Programs the key and the cipher of the secured mode, the frames sent
+ * after it are encrypted and authenticated by the device and the secured
+ * frames received are decrypted by it. Both ends use the same key and
+ * cipher. Called after MRF24J40Init() and MRF24J40LongAddressWrite().
+ * @param cipher MRF_CIPHER_AES_CCM_128, _64 or _32, the MIC is 16, 8 or 4
+ *               bytes.
+ * @param key Key of 16 bytes, in the order of the key FIFO.
+ * @param keySequence Key sequence number sent in the frames, for the
+ *                    nonce.
+ * @param frameCounter Frame counter of the next frame, never lower than the
+ *                     last one sent with this key, before the reset too.
+ */
+void MRF24J40SecurityInit(unsigned char cipher, const unsigned char *key, unsigned char keySequence,
+                          uint32_t frameCounter)
+{
+    MRF24J40WriteLongBurst(MRF_TXNORMALKEY, key, MRF_KEY_LENGTH);
+    MRF24J40WriteLongBurst(MRF_RXKEY, key, MRF_KEY_LENGTH);
+
+    securityControl = (cipher << MRF_RXCIPHER0) | (cipher << MRF_TXNCIPHER0);
+    MRF24J40WriteShort(MRF_SECCON0, securityControl);
+
+    switch (cipher)
+    {
+    case MRF_CIPHER_AES_CCM_128:
+        securityMicLength = 16;
+        break;
+    case MRF_CIPHER_AES_CCM_64:
+        securityMicLength = 8;
+        break;
+    default:
+        securityMicLength = 4;
+        break;
+    }
+
+    securityKeySequence = keySequence;
+    securityFrameCounter = frameCounter;
+
+    // SECIE, the security interrupt
+    MRF24J40WriteShortCached(MRF_INTCON, MRF24J40ReadShortCached(MRF_INTCON) & ~0x10);
+}
+
+/**
+ * Gives the frame counter of the next secured frame, to be saved by the
+ * application for MRF24J40SecurityInit() after the next reset.
+ * @return Frame counter.
+ */
+uint32_t MRF24J40SecurityFrameCounter(void)
+{
+    return securityFrameCounter;
+}
+
+/**
+ * Sends the frames in plain again, the secured frames received are
+ * ignored by the device and dropped.
+ */
+void MRF24J40SecurityDisable(void)
+{
+    securityControl = 0;
+    securityMicLength = 0;
+    MRF24J40WriteShort(MRF_SECCON0, 0);
+    MRF24J40WriteShortCached(MRF_INTCON, MRF24J40ReadShortCached(MRF_INTCON) | 0x10);
+}
+
+/**
+ * Answers SECIF, a secured frame is being received: the device decrypts it
+ * with the RX key, or ignores it when the secured mode is off. RXIF
+ * follows.
+ */
+void MRF24J40SecurityInterrupt(void)
+{
+    if (securityMicLength != 0)
+    {
+        MRF24J40WriteShort(MRF_SECCON0, securityControl | (1 << MRF_SECSTART));
+    }
+    else
+    {
+        MRF24J40WriteShort(MRF_SECCON0, 1 << MRF_SECIGNORE);
+    }
+}
@@ -8,6 +8,46 @@
 #include <stdint.h>
 #include "uwn_common.h"
 #include "SPIDevice.h"
+#include "uCFIFO/uPacketPool.h"
+
+/*
+ * Configuration of the driver.
+ *
+ * MRF24J40_ENABLE_PA_LNA: the module has an external PA/LNA (MRF24J40MB,
+ * MRF24J40MC), it is driven by the device.
+ * MRF24J40MB / MRF24J40MC: the module, channel 26 is not allowed with their
+ * PA; the MC also needs GPIO3 set.
+ * MRF24J40_TURBO_MODE: 625 kbps instead of the 250 kbps of 802.15.4, both
+ * ends need it.
+ *
+ * Secured frames: after MRF24J40SecurityInit() the frames are sent with the
+ * security bit of the frame control and encrypted and authenticated by the
+ * AES engine of the device in the TX FIFO (802.15.4-2003 security, CCM). The
+ * nonce is made of the long source address, the frame counter and the key
+ * sequence number, so a secured frame carries the long address of the
+ * sender, written with MRF24J40LongAddressWrite(), and 5 more bytes before
+ * its payload. Its Source is the 2 low bytes of that address: every node
+ * gets a long address that ends with its short address. On reception the
+ * device raises SECIF when the header is in, MRF24J40SecurityInterrupt()
+ * tells it to decrypt the frame with the RX key, RXIF follows. A frame whose
+ * MIC is wrong is dropped. The payload of a secured frame is up to 105
+ * bytes less the MIC, 4 to 16 bytes with the cipher.
+ * CCM is broken if a nonce is used twice with the same key: the frame
+ * counter must go on across the resets. The application keeps
+ * MRF24J40SecurityFrameCounter() in backup RAM or EEPROM and gives it back
+ * to MRF24J40SecurityInit(), i.e. saved every 256 frames and restored with
+ * 256 added, or changes the key.
+ */
+#define MRF24J40_ENABLE_PA_LNA
+//#define MRF24J40MB
+//#define MRF24J40MC
+//#define MRF24J40_TURBO_MODE
+
+#if defined(MRF24J40_ENABLE_PA_LNA) && (defined(MRF24J40MB) || defined(MRF24J40MC))
+#define MRF24J40_MAX_CHANNEL    25
+#else
+#define MRF24J40_MAX_CHANNEL    26
+#endif
 
 #define MRF_RXMCR       0x00
 #define MRF_PANIDL      0x01
@@ -56,6 +96,7 @@
 
 #define MRF_I_TXNIF     0x01
 #define MRF_I_RXIF      0x08
+#define MRF_I_SECIF     0x10
 #define MRF_I_WAKEIF    0x40
 #define MRF_I_SLEEPIF   0x80
 // TXSTAT: TX MAC STATUS REGISTER (ADDRESS: 0x24)
@@ -77,11 +118,21 @@
 #define MRF_HSYMTMRH    0x29
 #define MRF_SOFTRST     0x2A
 //#define MRF_Reserved 0x2B
+// SECCON0: SECURITY CONTROL REGISTER 0 (ADDRESS: 0x2C)
 #define MRF_SECCON0     0x2C
+#define MRF_SECIGNORE   7
+#define MRF_SECSTART    6
+#define MRF_RXCIPHER0   3
+#define MRF_TXNCIPHER0  0
+
 #define MRF_SECCON1     0x2D
 #define MRF_TXSTBL      0x2E
 //#define MRF_Reserved 0x2F
+// RXSR: RX MAC STATUS REGISTER (ADDRESS: 0x30)
 #define MRF_RXSR        0x30
+#define MRF_UPSECERR    6
+#define MRF_SECDECERR   2
+
 #define MRF_INTSTAT     0x31
 #define MRF_INTCON      0x32
 #define MRF_GPIO        0x33
@@ -156,6 +207,9 @@
 #define MRF_TXGTS2FIFO_MAX_LENGTH       128
 #define MRF_SECURITYKEYFIFO             0x280
 #define MRF_SECURITYKEYFIFO_MAX_LENGTH  64
+#define MRF_TXNORMALKEY                 0x280
+#define MRF_RXKEY                       0x2B0
+#define MRF_KEY_LENGTH                  16
 #define MRF_RXFIFO                      0x300
 #define MRF_RXFIFO_LENGTH               144
 
@@ -210,12 +264,43 @@
 #define CHANNEL_25          0x0E
 #define CHANNEL_26          0x0F
 
+// Ciphers of the security engine, TXNCIPHER and RXCIPHER of SECCON0
+#define MRF_CIPHER_NONE             0x00
+#define MRF_CIPHER_AES_CTR          0x01
+#define MRF_CIPHER_AES_CCM_128      0x02
+#define MRF_CIPHER_AES_CCM_64       0x03
+#define MRF_CIPHER_AES_CCM_32       0x04
+
 // MIN/MAX/ABS macros
 #define MIN(a,b)			((a<b)?(a):(b))
 #define MAX(a,b)			((a>b)?(a):(b))
 #define ABS(x)				((x>0)?(x):(-x))
 
 
+/**
+ * Information of a received frame.
+ */
+typedef struct
+{
+    /**Short address of the sender.*/
+    unsigned int Source;
+    /**Sequence number of the frame.*/
+    unsigned char Sequence;
+    unsigned char LQI;
+    unsigned char RSSI;
+    /**The frame was decrypted and its MIC checked by the device.*/
+    bool Secured;
+    /**Frame counter of a secured frame, for the replay check of the
+     caller.*/
+    uint32_t FrameCounter;
+} tMRF24J40FrameInfo;
+
+unsigned char MRF24J40ReadShort(unsigned char address);
+unsigned char MRF24J40ReadLong(unsigned int address);
+void MRF24J40WriteShort(unsigned char address, unsigned char data);
+void MRF24J40WriteLong(unsigned int address, unsigned char data);
+void MRF24J40WriteShortCached(unsigned char address, unsigned char data);
+unsigned char MRF24J40ReadShortCached(unsigned char address);
 void MRF24J40Reset(void);
 void MRF24J40Init(unsigned char channel,
                   unsigned char power,
@@ -234,13 +319,24 @@ void MRF24J40SetPower(unsigned char power);
 /**
  * Set the channel, using 802.15.4 channel numbers (11..26)
  */
-void MRF24J40SetChannel(unsigned char channel);
+bool MRF24J40SetChannel(unsigned char channel);
 unsigned char MRF24J40GetChannel(void);
 void MRF24J40RXEnable(void);
 void MRF24J40RXDisable(void);
 /** If you want to throw away rx data */
 void MRF24J40RXFlush(void);
+void MRF24J40ReadLongBurst(unsigned int address, unsigned char *data, unsigned int length);
+void MRF24J40WriteLongBurst(unsigned int address, const unsigned char *data, unsigned int length);
+void MRF24J40SendFrame(unsigned int dest, unsigned char sequence, unsigned int len, unsigned char* packet);
 void MRF24J40SendPacket(unsigned int dest, unsigned int len, unsigned char* packet);
 unsigned char MRF24J40ReceivePacket(unsigned char* packet);
+void MRF24J40SendBuffer(unsigned int dest, tPacketHandle handle);
+tPacketHandle MRF24J40ReceiveFrame(tMRF24J40FrameInfo *info);
+tPacketHandle MRF24J40ReceiveBuffer(void);
+void MRF24J40SecurityInit(unsigned char cipher, const unsigned char *key, unsigned char keySequence,
+                          uint32_t frameCounter);
+uint32_t MRF24J40SecurityFrameCounter(void);
+void MRF24J40SecurityDisable(void);
+void MRF24J40SecurityInterrupt(void);
 
 #endif  /* LIB_MRF24J_H */
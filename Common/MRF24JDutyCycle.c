@@ -0,0 +1,254 @@
+/**
+ *  @file       MRF24JDutyCycle.c
+ *  @author     Luis Maduro
+ *  @version    1.00
+ *  @date       14/10/2026
+ *  @brief      Duty cycled listening of the MRF24J40 for battery nodes.
+ *
+ *  Copyright (C) 2026  Luis Maduro
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "MRF24JDutyCycle.h"
+
+static uKernelTaskDescriptor *dutyTask;
+static tMRF24JDutyState dutyState;
+/**Sleep clock periods of a sleep, from the calibration.*/
+static uint32_t sleepTicks;
+static uint8_t listenWindow;
+/**When the window ends and when the radio woke up, in ms.*/
+static uint32_t listenEnd;
+static uint32_t wakeTime;
+
+static void MRF24JDutyCycleTask(void);
+
+/**
+ * Measures the sleep clock against the 20 MHz oscillator and gives the
+ * number of its periods in an interval.
+ * @param intervalMs Interval.
+ * @return Periods of the sleep clock.
+ */
+static uint32_t MRF24JDutyCycleTicks(uint16_t intervalMs)
+{
+    unsigned char calibration[3];
+    uint32_t slpcal;
+    uint32_t a;
+    uint32_t ticks;
+
+    MRF24J40WriteLong(MRF_SLPCAL2, 0x10); //SLPCALEN
+    while ((MRF24J40ReadLong(MRF_SLPCAL2) & 0x80) == 0); //SLPCALRDY
+
+    //time of 16 periods of the sleep clock, in 50 ns
+    MRF24J40ReadLongBurst(MRF_SLPCAL0, calibration, sizeof (calibration));
+    slpcal = ((uint32_t) (calibration[2] & 0x0F) << 16)
+            | ((uint32_t) calibration[1] << 8) | calibration[0];
+
+    if (slpcal == 0)
+    {
+        slpcal = 1;
+    }
+
+    if (intervalMs > MRF24JDUTY_MAX_INTERVAL)
+    {
+        intervalMs = MRF24JDUTY_MAX_INTERVAL;
+    }
+
+    //ticks = intervalMs * 320000 / slpcal, without overflow
+    a = (uint32_t) intervalMs * 10000UL;
+    ticks = (a / slpcal) * 32 + ((a % slpcal) * 32) / slpcal;
+
+    //the wake up is part of the interval
+    return (ticks > MRF24JDUTY_WAKETIME) ? (ticks - MRF24JDUTY_WAKETIME) : 1;
+}
+
+/**
+ * Puts the radio to sleep on the sleep clock counter, it wakes itself after
+ * the interval.
+ */
+static void MRF24JDutyCycleSleep(void)
+{
+    unsigned char count[4];
+
+    count[0] = (unsigned char) sleepTicks;
+    count[1] = (unsigned char) (sleepTicks >> 8);
+    count[2] = (unsigned char) (sleepTicks >> 16);
+    count[3] = ((unsigned char) (sleepTicks >> 24) & 0x03) | 0x80; //STARTCNT
+
+    //MAINCNT3 is written last, STARTCNT starts the sleep
+    MRF24J40WriteLongBurst(MRF_MAINCNT0, count, sizeof (count));
+
+    dutyState = MRF24JDUTY_SLEEPING;
+    uKernelModifyTask(dutyTask, UKERNEL_NO_TIMEOUT, UKERNEL_EVENT);
+}
+
+/**
+ * Starts a listen window after a wake up.
+ */
+static void MRF24JDutyCycleListen(void)
+{
+    MRF24J40WriteShort(MRF_RFCTL, 0x04); // Reset RF state machine.
+    MRF24J40WriteShort(MRF_RFCTL, 0x00); // part 2
+    UWN_DelayMiliSeconds(1); // delay at least 192usec
+
+    wakeTime = _counterMs;
+    listenEnd = wakeTime + listenWindow;
+    dutyState = MRF24JDUTY_LISTENING;
+
+    //preamble sampling, a sender repeating its frame is seen as energy
+    MRF24J40WriteShort(MRF_BBREG6, 0xC0); //RSSIMODE1, start a measure
+    while ((MRF24J40ReadShort(MRF_BBREG6) & 0x01) == 0); //RSSIRDY
+
+    if (MRF24J40ReadLong(MRF_RSSI) >= MRF24JDUTY_ED_THRESHOLD)
+    {
+        listenEnd += listenWindow;
+    }
+
+    MRF24J40WriteShortCached(MRF_BBREG6, 0x40);
+}
+
+/**
+ * Programs the wake up of the radio and adds the task that runs the duty
+ * cycle. The radio, the packet pool and the MAC layer are initialized
+ * before. The radio listens all the time until MRF24JDutyCycleStart().
+ * @param task Descriptor of the task, kept by the caller.
+ * @param intervalMs Time from a wake up to the next one.
+ * @param windowMs Time the radio listens after a wake up if there is no
+ *                 traffic.
+ */
+void MRF24JDutyCycleInit(uKernelTaskDescriptor *task,
+                         uint16_t intervalMs,
+                         uint8_t windowMs)
+{
+    unsigned char wake[2];
+
+    dutyTask = task;
+    dutyState = MRF24JDUTY_OFF;
+    listenWindow = windowMs;
+    sleepTicks = MRF24JDutyCycleTicks(intervalMs);
+
+    //oscillator start up, WAKECNT[6:0] in SLPACK and WAKECNT[8:7] in RFCTL
+    MRF24J40WriteShort(MRF_SLPACK, MRF24JDUTY_WAKECNT & 0x7F);
+    MRF24J40WriteShort(MRF_RFCTL, (MRF24JDUTY_WAKECNT >> 4) & 0x18);
+
+    wake[0] = MRF24JDUTY_WAKETIME & 0xFF;
+    wake[1] = (MRF24JDUTY_WAKETIME >> 8) & 0x07;
+    MRF24J40WriteLongBurst(MRF_WAKETIMEL, wake, sizeof (wake));
+
+    //rx, tx and wake interrupts, and security if it is on
+    MRF24J40WriteShortCached(MRF_INTCON, MRF24J40ReadShortCached(MRF_INTCON) & 0xB6);
+
+    uKernelAddTask(task, MRF24JDutyCycleTask, UKERNEL_NO_TIMEOUT, UKERNEL_EVENT);
+}
+
+/**
+ * Starts the duty cycle, the radio goes to sleep at the end of the current
+ * window.
+ */
+void MRF24JDutyCycleStart(void)
+{
+    if (dutyState != MRF24JDUTY_OFF)
+    {
+        return;
+    }
+
+    wakeTime = _counterMs;
+    listenEnd = wakeTime + listenWindow;
+    dutyState = MRF24JDUTY_LISTENING;
+    uKernelModifyTask(dutyTask, listenWindow, UKERNEL_EVENT);
+}
+
+/**
+ * Stops the duty cycle, the radio is woken up with its WAKE pin if it
+ * sleeps and listens all the time. Also used to send from a sleeping node,
+ * MRF24JDutyCycleStart() then lets it sleep again after the frames.
+ */
+void MRF24JDutyCycleStop(void)
+{
+    if (dutyState == MRF24JDUTY_SLEEPING)
+    {
+        RadioWake();
+        MRF24JDutyCycleListen();
+        RadioPutToSleep(); //WAKE pin back low, the radio stays awake
+    }
+
+    dutyState = MRF24JDUTY_OFF;
+    uKernelModifyTask(dutyTask, UKERNEL_NO_TIMEOUT, UKERNEL_EVENT);
+}
+
+/**
+ * Gives the state of the duty cycle.
+ * @return State.
+ */
+tMRF24JDutyState MRF24JDutyCycleState(void)
+{
+    return dutyState;
+}
+
+/**
+ * Called from the interrupt routine of the INT pin of the radio, instead of
+ * MRF24JMACInterrupt().
+ */
+void MRF24JDutyCycleInterrupt(void)
+{
+    MRF24JMACInterrupt();
+    uKernelSignal(dutyTask);
+}
+
+/**
+ * Task of the duty cycle, runs on the interrupts of the radio and at the end
+ * of the listen window.
+ */
+static void MRF24JDutyCycleTask(void)
+{
+    unsigned char status = MRF24JMACTasks();
+    uint32_t now;
+
+    if (dutyState == MRF24JDUTY_OFF)
+    {
+        return;
+    }
+
+    if (dutyState == MRF24JDUTY_SLEEPING)
+    {
+        if ((status & MRF_I_WAKEIF) == 0)
+        {
+            return;
+        }
+
+        MRF24JDutyCycleListen();
+    }
+
+    now = _counterMs;
+
+    //traffic keeps the radio awake for another window
+    if ((status & MRF_I_RXIF) || !MRF24JMACIsIdle())
+    {
+        listenEnd = now + listenWindow;
+    }
+
+    if (((int32_t) (now - listenEnd) >= 0)
+            || ((now - wakeTime) >= MRF24JDUTY_MAX_LISTEN))
+    {
+        if (MRF24JMACIsIdle())
+        {
+            MRF24JDutyCycleSleep();
+            return;
+        }
+
+        listenEnd = now + listenWindow;
+    }
+
+    uKernelModifyTask(dutyTask, listenEnd - now, UKERNEL_EVENT);
+}
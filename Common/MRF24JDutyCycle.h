@@ -0,0 +1,84 @@
+/**
+ *  @file       MRF24JDutyCycle.h
+ *  @author     Luis Maduro
+ *  @version    1.00
+ *  @date       14/10/2026
+ *  @brief      Duty cycled listening of the MRF24J40 for battery nodes.
+ *
+ *  The radio sleeps on its sleep clock counter and wakes itself every
+ *  interval (WAKEIF on the INT pin). It then listens for a short window: the
+ *  energy on the channel is sampled once, a sender that is repeating its
+ *  frame for the whole interval (MRF24JMACSetRetries()) is heard as energy,
+ *  and the window is extended while frames come in, energy is seen or frames
+ *  are waiting to be sent. When the window ends without traffic the radio is
+ *  put back to sleep.
+ *
+ *  The work is done by an UKERNEL_EVENT task that is signaled by
+ *  MRF24JDutyCycleInterrupt(), called from the interrupt routine of the INT
+ *  pin instead of MRF24JMACInterrupt(). While the radio sleeps the task has
+ *  no timeout, so with UKERNEL_USE_TICKLESS the microcontroller sleeps too
+ *  until the radio wakes up. The task calls MRF24JMACTasks(), the
+ *  application doesn't.
+ *
+ *  Broadcasts are only received by the nodes that are listening.
+ *
+ *  Copyright (C) 2026  Luis Maduro
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef MRF24JDUTYCYCLE_H
+#define MRF24JDUTYCYCLE_H
+
+#include <stdint.h>
+#include "MRF24JMAC.h"
+#include "uKernel/uKernel.h"
+
+/**Energy (RSSI) above which the channel is taken as busy at the start of a
+ window, as CCAEDTH.*/
+#ifndef MRF24JDUTY_ED_THRESHOLD
+#define MRF24JDUTY_ED_THRESHOLD     0x60
+#endif
+
+/**Longest time the radio stays awake after a wake up, in ms, so that a
+ noisy channel doesn't keep it listening.*/
+#ifndef MRF24JDUTY_MAX_LISTEN
+#define MRF24JDUTY_MAX_LISTEN       100
+#endif
+
+/**Sleep clock periods for the 20 MHz oscillator to start (WAKECNT) and to
+ the end of the wake up (WAKETIME, larger than WAKECNT).*/
+#define MRF24JDUTY_WAKECNT          0x5F
+#define MRF24JDUTY_WAKETIME         0x0D2
+
+/**Longest interval, in ms.*/
+#define MRF24JDUTY_MAX_INTERVAL     60000U
+
+typedef enum
+{
+    /**The radio listens all the time.*/
+    MRF24JDUTY_OFF = 0,
+    MRF24JDUTY_LISTENING,
+    MRF24JDUTY_SLEEPING
+} tMRF24JDutyState;
+
+void MRF24JDutyCycleInit(uKernelTaskDescriptor *task,
+                         uint16_t intervalMs,
+                         uint8_t windowMs);
+void MRF24JDutyCycleStart(void);
+void MRF24JDutyCycleStop(void);
+tMRF24JDutyState MRF24JDutyCycleState(void);
+void MRF24JDutyCycleInterrupt(void);
+
+#endif /* MRF24JDUTYCYCLE_H */
@@ -0,0 +1,445 @@
+/**
+ *  @file       MRF24JMAC.c
+ *  @author     Luis Maduro
+ *  @version    1.00
+ *  @date       14/10/2026
+ *  @brief      MAC layer of the MRF24J40 with its hardware ACK and CSMA-CA.
+ *
+ *  Copyright (C) 2026  Luis Maduro
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "MRF24JMAC.h"
+#include "uKernel/uKernel.h"
+
+/**
+ * A frame waiting to be sent.
+ */
+typedef struct
+{
+    tPacketHandle handle;
+    unsigned int dest;
+    unsigned char sequence;
+    /**Retransmissions of this layer left.*/
+    unsigned char retries;
+} tMRF24JMACFrame;
+
+/**
+ * A frame received.
+ */
+typedef struct
+{
+    tPacketHandle handle;
+    tMRF24J40FrameInfo info;
+} tMRF24JMACReceived;
+
+/**
+ * Last sequence number received from a sender.
+ */
+typedef struct
+{
+    unsigned int source;
+    unsigned char sequence;
+    bool valid;
+} tMRF24JMACNeighbour;
+
+tMRF24JMACStatistics MRF24JMACStatistics;
+
+static tMRF24JMACFrame txQueue[MRF24JMAC_TX_QUEUE_SIZE];
+static unsigned char txHead;
+static unsigned char txTail;
+/**The frame at the tail is being sent by the device.*/
+static bool txBusy;
+/**No new frame is started, i.e. outside the slot of the node.*/
+static bool txHold;
+static unsigned char txSequence;
+/**Retransmissions of this layer for every unicast frame.*/
+static unsigned char txRetries = MRF24JMAC_RETRIES;
+
+static tMRF24JMACReceived rxQueue[MRF24JMAC_RX_QUEUE_SIZE];
+static unsigned char rxHead;
+static unsigned char rxTail;
+
+static tMRF24JMACNeighbour neighbours[MRF24JMAC_NEIGHBOURS];
+static unsigned char neighbourNext;
+
+/**Set by the interrupt routine.*/
+static volatile bool interruptPending;
+/**_counterMs of the last interrupt, when a frame received was complete.*/
+static volatile uint32_t interruptTime;
+
+/**Called with the frames received before they are queued.*/
+static bool (*receiveHook)(tPacketHandle handle, const tMRF24J40FrameInfo *info);
+
+/**
+ * Writes the frame at the tail of the queue to the device and starts it.
+ */
+static void MRF24JMACStart(void)
+{
+    tMRF24JMACFrame *frame;
+
+    if (txBusy || txHold || (txHead == txTail))
+    {
+        return;
+    }
+
+    frame = &txQueue[txTail & (MRF24JMAC_TX_QUEUE_SIZE - 1)];
+    txBusy = true;
+    MRF24J40SendFrame(frame->dest, frame->sequence,
+                      uPacketPoolLength(frame->handle),
+                      uPacketPoolData(frame->handle));
+}
+
+/**
+ * Handles the end of a transmission, from TXSTAT.
+ */
+static void MRF24JMACTransmitted(void)
+{
+    tMRF24JMACFrame *frame;
+    unsigned char status;
+
+    if (!txBusy)
+    {
+        return;
+    }
+
+    frame = &txQueue[txTail & (MRF24JMAC_TX_QUEUE_SIZE - 1)];
+    status = MRF24J40ReadShort(MRF_TXSTAT);
+    txBusy = false;
+
+    MRF24JMACStatistics.Retries += status >> TXNRETRY0;
+
+#ifdef MRF24JMAC_USE_LINK_QUALITY
+    if (frame->dest != 0xFFFF)
+    {
+        LinkQualitySent(frame->dest, status >> TXNRETRY0,
+                        (status & (1 << TXNSTAT)) == 0);
+    }
+#endif
+
+    if (status & (1 << TXNSTAT))
+    {
+        if (status & (1 << CCAFAIL))
+        {
+            MRF24JMACStatistics.ChannelBusy++;
+        }
+
+        if (frame->retries != 0)
+        {
+            //same sequence number, the receiver drops it if it got it
+            frame->retries--;
+            MRF24JMACStatistics.Retries++;
+            MRF24JMACStart();
+            return;
+        }
+
+        MRF24JMACStatistics.Failed++;
+    }
+    else
+    {
+        MRF24JMACStatistics.Sent++;
+    }
+
+    uPacketPoolRelease(frame->handle);
+    txTail++;
+
+    MRF24JMACStart();
+}
+
+/**
+ * Tells if a frame was already received from its sender, and keeps its
+ * sequence number.
+ * @param info Frame received.
+ * @return True if it's a duplicate.
+ */
+static bool MRF24JMACDuplicate(const tMRF24J40FrameInfo *info)
+{
+    unsigned char i;
+
+    for (i = 0; i < MRF24JMAC_NEIGHBOURS; i++)
+    {
+        if (neighbours[i].valid && (neighbours[i].source == info->Source))
+        {
+            if (neighbours[i].sequence == info->Sequence)
+            {
+                return true;
+            }
+
+            neighbours[i].sequence = info->Sequence;
+            return false;
+        }
+    }
+
+    //a new sender takes the place of the oldest one
+    neighbours[neighbourNext].source = info->Source;
+    neighbours[neighbourNext].sequence = info->Sequence;
+    neighbours[neighbourNext].valid = true;
+    neighbourNext = (neighbourNext + 1) % MRF24JMAC_NEIGHBOURS;
+
+    return false;
+}
+
+/**
+ * Reads a received frame into the receive queue.
+ */
+static void MRF24JMACReceived(void)
+{
+    tMRF24JMACReceived *received;
+    tMRF24J40FrameInfo info;
+    tPacketHandle handle;
+
+    handle = MRF24J40ReceiveFrame(&info);
+
+    if (handle == UPACKETPOOL_NONE)
+    {
+        MRF24JMACStatistics.Dropped++;
+        return;
+    }
+
+#ifdef MRF24JMAC_USE_LINK_QUALITY
+    //a duplicate also tells about the link
+    LinkQualityReceived(info.Source, info.RSSI, info.LQI);
+#endif
+
+    if ((receiveHook != NULL) && receiveHook(handle, &info))
+    {
+        return;
+    }
+
+    if (MRF24JMACDuplicate(&info))
+    {
+        MRF24JMACStatistics.Duplicates++;
+        uPacketPoolRelease(handle);
+        return;
+    }
+
+    if ((unsigned char) (rxHead - rxTail) >= MRF24JMAC_RX_QUEUE_SIZE)
+    {
+        MRF24JMACStatistics.Dropped++;
+        uPacketPoolRelease(handle);
+        return;
+    }
+
+    received = &rxQueue[rxHead & (MRF24JMAC_RX_QUEUE_SIZE - 1)];
+    received->handle = handle;
+    received->info = info;
+    rxHead++;
+}
+
+/**
+ * Clears the queues and programs the CSMA-CA of the device. The device and
+ * the packet pool are initialized before.
+ */
+void MRF24JMACInit(void)
+{
+    unsigned char i;
+
+    txHead = 0;
+    txTail = 0;
+    txBusy = false;
+    txHold = false;
+    txSequence = 0;
+    txRetries = MRF24JMAC_RETRIES;
+    rxHead = 0;
+    rxTail = 0;
+    neighbourNext = 0;
+    interruptPending = false;
+    receiveHook = NULL;
+
+#ifdef MRF24JMAC_USE_LINK_QUALITY
+    LinkQualityInit();
+#endif
+
+    for (i = 0; i < MRF24JMAC_NEIGHBOURS; i++)
+    {
+        neighbours[i].valid = false;
+    }
+
+    MRF24JMACStatistics.Sent = 0;
+    MRF24JMACStatistics.Failed = 0;
+    MRF24JMACStatistics.Retries = 0;
+    MRF24JMACStatistics.ChannelBusy = 0;
+    MRF24JMACStatistics.Duplicates = 0;
+    MRF24JMACStatistics.Dropped = 0;
+
+    //unslotted CSMA-CA, macMinBE and macMaxCSMABackoffs
+    MRF24J40WriteShort(MRF_TXMCR, (MRF24JMAC_MIN_BE << 3) | MRF24JMAC_CSMA_BACKOFFS);
+}
+
+/**
+ * Queues a frame to send, it takes a reference to the buffer and releases it
+ * once the frame is sent or dropped. Not to be called from interrupts.
+ * @param dest Short address of the destination, 0xFFFF to broadcast.
+ * @param handle Buffer with the payload.
+ * @return False if the queue is full.
+ */
+bool MRF24JMACSend(unsigned int dest, tPacketHandle handle)
+{
+    tMRF24JMACFrame *frame;
+
+    if ((unsigned char) (txHead - txTail) >= MRF24JMAC_TX_QUEUE_SIZE)
+    {
+        return false;
+    }
+
+    uPacketPoolRetain(handle);
+
+    frame = &txQueue[txHead & (MRF24JMAC_TX_QUEUE_SIZE - 1)];
+    frame->handle = handle;
+    frame->dest = dest;
+    frame->sequence = txSequence++;
+    frame->retries = (dest == 0xFFFF) ? 0 : txRetries;
+    txHead++;
+
+    MRF24JMACStart();
+
+    return true;
+}
+
+/**
+ * Sets the retransmissions of this layer for the next unicast frames, i.e.
+ * enough to cover the sleep interval of a duty cycled receiver.
+ * @param retries Retransmissions after the ones of the device.
+ */
+void MRF24JMACSetRetries(unsigned char retries)
+{
+    txRetries = retries;
+}
+
+/**
+ * Holds the frames of the queue, the one being sent is finished. They are
+ * started again when the hold is released.
+ * @param hold True to hold them.
+ */
+void MRF24JMACSetHold(bool hold)
+{
+    txHold = hold;
+
+    if (!hold)
+    {
+        MRF24JMACStart();
+    }
+}
+
+/**
+ * Sets the function that sees the frames received first, i.e. the beacons
+ * of MRF24JSlots.c. Reset by MRF24JMACInit().
+ * @param hook Function, returns true if it took the frame and released the
+ *             buffer, false to let it be queued. NULL for none.
+ */
+void MRF24JMACSetReceiveHook(bool (*hook)(tPacketHandle handle, const tMRF24J40FrameInfo *info))
+{
+    receiveHook = hook;
+}
+
+/**
+ * Gives the next frame received.
+ * @param info Sender and link quality of the frame, can be NULL.
+ * @return Handle of the buffer with the payload, or UPACKETPOOL_NONE. The
+ *         caller releases it.
+ */
+tPacketHandle MRF24JMACReceive(tMRF24J40FrameInfo *info)
+{
+    tMRF24JMACReceived *received;
+
+    if (rxHead == rxTail)
+    {
+        return UPACKETPOOL_NONE;
+    }
+
+    received = &rxQueue[rxTail & (MRF24JMAC_RX_QUEUE_SIZE - 1)];
+    rxTail++;
+
+    if (info != NULL)
+    {
+        *info = received->info;
+    }
+
+    return received->handle;
+}
+
+/**
+ * Tells if all the queued frames were sent.
+ * @return True if there is nothing to send.
+ */
+bool MRF24JMACIsIdle(void)
+{
+    return (txHead == txTail);
+}
+
+/**
+ * Tells if the device is sending a frame of the queue.
+ * @return True until the end of its transmission.
+ */
+bool MRF24JMACIsSending(void)
+{
+    return txBusy;
+}
+
+/**
+ * Gives the time of the last interrupt of the device, for a frame received
+ * it is the end of the frame on the air.
+ * @return _counterMs in the interrupt routine.
+ */
+uint32_t MRF24JMACInterruptTime(void)
+{
+    return interruptTime;
+}
+
+/**
+ * Called from the interrupt routine of the INT pin of the device.
+ */
+void MRF24JMACInterrupt(void)
+{
+    interruptTime = _counterMs;
+    interruptPending = true;
+}
+
+/**
+ * Reads the interrupts of the device and handles the end of the
+ * transmissions and the frames received. Called from the main loop or a task.
+ * @return The interrupts of the device (INTSTAT), the other ones (wake,
+ *         sleep) are for the caller. 0 if there was no interrupt.
+ */
+unsigned char MRF24JMACTasks(void)
+{
+    unsigned char status;
+
+    if (!interruptPending)
+    {
+        return 0;
+    }
+
+    //cleared before reading INTSTAT so that a new interrupt is not lost
+    interruptPending = false;
+    status = MRF24J40GetInterrupts();
+
+    if (status & MRF_I_SECIF)
+    {
+        MRF24J40SecurityInterrupt();
+    }
+
+    if (status & MRF_I_TXNIF)
+    {
+        MRF24JMACTransmitted();
+    }
+
+    if (status & MRF_I_RXIF)
+    {
+        MRF24JMACReceived();
+    }
+
+    return status;
+}
@@ -0,0 +1,116 @@
+/**
+ *  @file       MRF24JMAC.h
+ *  @author     Luis Maduro
+ *  @version    1.00
+ *  @date       14/10/2026
+ *  @brief      MAC layer of the MRF24J40 with its hardware ACK and CSMA-CA.
+ *
+ *  The device does the CSMA-CA, the automatic acknowledgement of the frames
+ *  it receives and up to 3 retransmissions of a frame that is not
+ *  acknowledged. This layer queues the frames to send (buffers of the
+ *  packet pool), gives them incrementing sequence numbers, reads TXSTAT
+ *  when the transmission ends and sends the frame again, with the same
+ *  sequence number, MRF24JMAC_RETRIES times when the device gives up. The
+ *  received frames are queued for the application after the duplicates
+ *  (same sender and sequence number, an acknowledgement that was lost) are
+ *  dropped.
+ *
+ *  MRF24JMACInterrupt() is called from the interrupt routine of the INT pin
+ *  of the device, it only takes note of it; MRF24JMACTasks() does the SPI
+ *  work from the main loop or a task.
+ *
+ *  Copyright (C) 2026  Luis Maduro
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef MRF24JMAC_H
+#define MRF24JMAC_H
+
+#include "MRF24J.h"
+
+/**Feeds LinkQuality.c with the frames sent and received.*/
+//#define MRF24JMAC_USE_LINK_QUALITY
+
+#ifdef MRF24JMAC_USE_LINK_QUALITY
+#include "LinkQuality.h"
+#endif
+
+/**Frames waiting to be sent, power of 2.*/
+#ifndef MRF24JMAC_TX_QUEUE_SIZE
+#define MRF24JMAC_TX_QUEUE_SIZE     4
+#endif
+
+/**Frames received waiting for the application, power of 2.*/
+#ifndef MRF24JMAC_RX_QUEUE_SIZE
+#define MRF24JMAC_RX_QUEUE_SIZE     4
+#endif
+
+/**Transmissions of a frame after the one of the device failed.*/
+#ifndef MRF24JMAC_RETRIES
+#define MRF24JMAC_RETRIES           2
+#endif
+
+/**Senders whose last sequence number is kept to drop the duplicates.*/
+#ifndef MRF24JMAC_NEIGHBOURS
+#define MRF24JMAC_NEIGHBOURS        4
+#endif
+
+/**CSMA-CA of the device: minimum backoff exponent and number of backoffs.*/
+#ifndef MRF24JMAC_MIN_BE
+#define MRF24JMAC_MIN_BE            3
+#endif
+#ifndef MRF24JMAC_CSMA_BACKOFFS
+#define MRF24JMAC_CSMA_BACKOFFS     4
+#endif
+
+#if (MRF24JMAC_TX_QUEUE_SIZE & (MRF24JMAC_TX_QUEUE_SIZE - 1)) || (MRF24JMAC_RX_QUEUE_SIZE & (MRF24JMAC_RX_QUEUE_SIZE - 1))
+#error "MRF24JMAC: the queue sizes must be a power of two"
+#endif
+
+/**
+ * Counters of the MAC layer.
+ */
+typedef struct
+{
+    /**Frames acknowledged (or broadcast).*/
+    unsigned int Sent;
+    /**Frames dropped after all the retries.*/
+    unsigned int Failed;
+    /**Retransmissions, of the device and of this layer.*/
+    unsigned int Retries;
+    /**Transmissions that failed because the channel was busy.*/
+    unsigned int ChannelBusy;
+    /**Frames received again and dropped.*/
+    unsigned int Duplicates;
+    /**Frames received and dropped, the pool or the queue was full or the
+     MIC of a secured frame was wrong.*/
+    unsigned int Dropped;
+} tMRF24JMACStatistics;
+
+extern tMRF24JMACStatistics MRF24JMACStatistics;
+
+void MRF24JMACInit(void);
+bool MRF24JMACSend(unsigned int dest, tPacketHandle handle);
+void MRF24JMACSetRetries(unsigned char retries);
+tPacketHandle MRF24JMACReceive(tMRF24J40FrameInfo *info);
+bool MRF24JMACIsIdle(void);
+bool MRF24JMACIsSending(void);
+void MRF24JMACSetHold(bool hold);
+void MRF24JMACSetReceiveHook(bool (*hook)(tPacketHandle handle, const tMRF24J40FrameInfo *info));
+uint32_t MRF24JMACInterruptTime(void);
+void MRF24JMACInterrupt(void);
+unsigned char MRF24JMACTasks(void);
+
+#endif /* MRF24JMAC_H */
@@ -0,0 +1,368 @@
+/**
+ *  @file       MRF24JSlots.c
+ *  @author     Luis Maduro
+ *  @version    1.00
+ *  @date       14/10/2026
+ *  @brief      Beacon time synchronisation and slotted access of the
+ *              MRF24J40 over MRF24JMAC.c.
+ *
+ *  Copyright (C) 2026  Luis Maduro
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "MRF24JSlots.h"
+
+/**First byte of the payload of a beacon.*/
+#define MRF24JSLOTS_BEACON_ID       0xBE
+/**Identifier, network time, and the owners of the node slots.*/
+#define MRF24JSLOTS_BEACON_LENGTH   (5 + 2 * (MRF24JSLOTS_COUNT - MRF24JSLOTS_FIRST_NODE_SLOT))
+
+#if MRF24JSLOTS_BEACON_LENGTH > UPACKETPOOL_BUFFER_SIZE
+#error "MRF24JSlots: the beacon doesn't fit in a buffer of the packet pool"
+#endif
+
+/**Owner of a slot that is free.*/
+#define MRF24JSLOTS_FREE            0xFFFF
+
+static uKernelTaskDescriptor *slotsTask;
+static tMRF24JSlotsRole slotsRole;
+/**Network time less _counterMs.*/
+static uint32_t timeOffset;
+static bool synchronized;
+static unsigned char lostBeacons;
+/**A beacon was received since the start of the beacon slot.*/
+static bool beaconSeen;
+static unsigned int slotOwner[MRF24JSLOTS_COUNT];
+/**Slot the node sends in, MRF24JSLOTS_NONE if it has none.*/
+static unsigned char txSlot;
+/**Slot being run, and the slot whose guard time was handled.*/
+static unsigned char slotCurrent;
+static unsigned char slotPrepared;
+static bool radioAsleep;
+static unsigned char beaconSequence;
+static unsigned char beacon[MRF24JSLOTS_BEACON_LENGTH];
+
+static void MRF24JSlotsTask(void);
+
+/**
+ * Puts the radio to sleep at once, it is woken with its WAKE pin.
+ */
+static void MRF24JSlotsSleep(void)
+{
+    MRF24J40WriteShort(MRF_SOFTRST, 0x04); //RSTPWR
+    MRF24J40WriteShort(MRF_SLPACK, 0x80); //SLPACK
+    radioAsleep = true;
+}
+
+/**
+ * Wakes the radio with its WAKE pin, it receives again within 1 ms.
+ */
+static void MRF24JSlotsWake(void)
+{
+    RadioWake();
+    MRF24J40WriteShort(MRF_RFCTL, 0x04); // Reset RF state machine.
+    MRF24J40WriteShort(MRF_RFCTL, 0x00); // part 2
+    UWN_DelayMiliSeconds(1); // delay at least 192usec
+    RadioPutToSleep(); //WAKE pin back low, the radio stays awake
+    radioAsleep = false;
+}
+
+/**
+ * Tells if the radio of the node is needed in a slot.
+ * @param slot Slot.
+ * @return True to listen or to send.
+ */
+static bool MRF24JSlotsAwake(unsigned char slot)
+{
+    return (slotsRole == MRF24JSLOTS_COORDINATOR) || !synchronized
+            || (slot == MRF24JSLOTS_BEACON_SLOT)
+            || (slot == MRF24JSLOTS_COORDINATOR_SLOT) || (slot == txSlot);
+}
+
+/**
+ * Sends the beacon of the coordinator, with its time and the slot owners.
+ */
+static void MRF24JSlotsSendBeacon(void)
+{
+    uint32_t now = MRF24JSlotsNetworkTime();
+    unsigned char i;
+    unsigned char *owner = &beacon[5];
+
+    beacon[0] = MRF24JSLOTS_BEACON_ID;
+    beacon[1] = (unsigned char) now;
+    beacon[2] = (unsigned char) (now >> 8);
+    beacon[3] = (unsigned char) (now >> 16);
+    beacon[4] = (unsigned char) (now >> 24);
+
+    for (i = MRF24JSLOTS_FIRST_NODE_SLOT; i < MRF24JSLOTS_COUNT; i++)
+    {
+        *owner++ = (unsigned char) slotOwner[i];
+        *owner++ = (unsigned char) (slotOwner[i] >> 8);
+    }
+
+    MRF24J40SendFrame(0xFFFF, beaconSequence++, sizeof (beacon), beacon);
+}
+
+/**
+ * Takes the beacons from the frames received, before the MAC layer queues
+ * them.
+ * @param handle Frame.
+ * @param info Sender of the frame.
+ * @return True if it was a beacon, its buffer is released.
+ */
+static bool MRF24JSlotsReceived(tPacketHandle handle, const tMRF24J40FrameInfo *info)
+{
+    const uint8_t *data = uPacketPoolData(handle);
+    unsigned int own = MRF24J40ShortAddressRead();
+    uint32_t time;
+    unsigned char i;
+
+    if ((uPacketPoolLength(handle) != MRF24JSLOTS_BEACON_LENGTH)
+            || (data[0] != MRF24JSLOTS_BEACON_ID))
+    {
+        return false;
+    }
+
+    if (slotsRole == MRF24JSLOTS_NODE)
+    {
+        time = ((uint32_t) data[4] << 24) | ((uint32_t) data[3] << 16)
+                | ((uint32_t) data[2] << 8) | data[1];
+
+        //the frame was complete at the interrupt
+        timeOffset = time + MRF24JSLOTS_BEACON_LATENCY - MRF24JMACInterruptTime();
+
+        txSlot = MRF24JSLOTS_NONE;
+        data += 5;
+
+        for (i = MRF24JSLOTS_FIRST_NODE_SLOT; i < MRF24JSLOTS_COUNT; i++)
+        {
+            slotOwner[i] = ((unsigned int) data[1] << 8) | data[0];
+            data += 2;
+
+            if (slotOwner[i] == own)
+            {
+                txSlot = i;
+            }
+        }
+
+        synchronized = true;
+        lostBeacons = 0;
+        beaconSeen = true;
+    }
+
+    (void) info;
+    uPacketPoolRelease(handle);
+
+    return true;
+}
+
+/**
+ * Starts a slot: the beacon, the hold of the frames and the sleep of the
+ * radio outside the slots of the node.
+ * @param slot Slot.
+ */
+static void MRF24JSlotsEnter(unsigned char slot)
+{
+    slotCurrent = slot;
+
+    if (slot == MRF24JSLOTS_BEACON_SLOT)
+    {
+        beaconSeen = false;
+
+        if ((slotsRole == MRF24JSLOTS_COORDINATOR) && !MRF24JMACIsSending())
+        {
+            MRF24JSlotsSendBeacon();
+        }
+    }
+    else if ((slot == MRF24JSLOTS_BEACON_SLOT + 1) && (slotsRole == MRF24JSLOTS_NODE)
+             && synchronized && !beaconSeen)
+    {
+        if (++lostBeacons >= MRF24JSLOTS_LOST_BEACONS)
+        {
+            //listen until the next beacon
+            synchronized = false;
+            txSlot = MRF24JSLOTS_NONE;
+        }
+    }
+
+    MRF24JMACSetHold(!synchronized || (slot != txSlot));
+}
+
+/**
+ * Handles the guard time before a slot: the sending stops at the end of the
+ * slot of the node and the radio wakes up for its next slot.
+ * @param slot Next slot.
+ */
+static void MRF24JSlotsPrepare(unsigned char slot)
+{
+    slotPrepared = slot;
+    MRF24JMACSetHold(true);
+
+    if (radioAsleep && MRF24JSlotsAwake(slot))
+    {
+        MRF24JSlotsWake();
+    }
+}
+
+/**
+ * Sets the role of the device and adds the task that runs the slots. The
+ * radio, the packet pool and the MAC layer are initialized before. A node
+ * listens all the time until its first beacon.
+ * @param task Descriptor of the task, kept by the caller.
+ * @param role MRF24JSLOTS_COORDINATOR or MRF24JSLOTS_NODE.
+ */
+void MRF24JSlotsInit(uKernelTaskDescriptor *task, tMRF24JSlotsRole role)
+{
+    unsigned char i;
+
+    slotsTask = task;
+    slotsRole = role;
+    timeOffset = 0;
+    synchronized = (role == MRF24JSLOTS_COORDINATOR);
+    lostBeacons = 0;
+    beaconSeen = false;
+    txSlot = (role == MRF24JSLOTS_COORDINATOR) ? MRF24JSLOTS_COORDINATOR_SLOT : MRF24JSLOTS_NONE;
+    slotCurrent = MRF24JSLOTS_NONE;
+    slotPrepared = MRF24JSLOTS_NONE;
+    radioAsleep = false;
+
+    for (i = 0; i < MRF24JSLOTS_COUNT; i++)
+    {
+        slotOwner[i] = MRF24JSLOTS_FREE;
+    }
+
+    MRF24JMACSetHold(true);
+    MRF24JMACSetReceiveHook(MRF24JSlotsReceived);
+
+    uKernelAddTask(task, MRF24JSlotsTask, 1, UKERNEL_EVENT);
+}
+
+/**
+ * Gives a node slot to a node, on the coordinator. Sent in the next beacon.
+ * @param slot Slot, from MRF24JSLOTS_FIRST_NODE_SLOT.
+ * @param address Short address of the node, 0xFFFF to free the slot.
+ * @return False if it is not a node slot.
+ */
+bool MRF24JSlotsAssign(unsigned char slot, unsigned int address)
+{
+    if ((slot < MRF24JSLOTS_FIRST_NODE_SLOT) || (slot >= MRF24JSLOTS_COUNT))
+    {
+        return false;
+    }
+
+    slotOwner[slot] = address;
+
+    return true;
+}
+
+/**
+ * Gives the slot the device sends in.
+ * @return Slot, MRF24JSLOTS_NONE for a node without a slot or not
+ *         synchronized.
+ */
+unsigned char MRF24JSlotsGetSlot(void)
+{
+    return txSlot;
+}
+
+/**
+ * Tells if the node follows the beacons, always true on the coordinator.
+ * @return True if synchronized.
+ */
+bool MRF24JSlotsIsSynchronized(void)
+{
+    return synchronized;
+}
+
+/**
+ * Gives the time of the coordinator.
+ * @return Network time, in ms.
+ */
+uint32_t MRF24JSlotsNetworkTime(void)
+{
+    return _counterMs + timeOffset;
+}
+
+/**
+ * Converts a network time to _counterMs, for the deadlines of the tasks.
+ * @param networkTime Network time, in ms.
+ * @return Same time in _counterMs.
+ */
+uint32_t MRF24JSlotsToLocal(uint32_t networkTime)
+{
+    return networkTime - timeOffset;
+}
+
+/**
+ * Called from the interrupt routine of the INT pin of the radio, instead of
+ * MRF24JMACInterrupt().
+ */
+void MRF24JSlotsInterrupt(void)
+{
+    MRF24JMACInterrupt();
+    uKernelSignal(slotsTask);
+}
+
+/**
+ * Task of the slots, runs on the interrupts of the radio, at the start of
+ * every slot and at the start of every guard time.
+ */
+static void MRF24JSlotsTask(void)
+{
+    uint32_t now;
+    uint32_t phase;
+    unsigned char slot;
+    uint32_t delay;
+
+    //the beacons are taken by MRF24JSlotsReceived()
+    MRF24JMACTasks();
+
+    //the superframes are counted from 0 of the network time
+    now = MRF24JSlotsNetworkTime() % MRF24JSLOTS_SUPERFRAME_MS;
+    slot = (unsigned char) (now / MRF24JSLOTS_SLOT_MS);
+    phase = now % MRF24JSLOTS_SLOT_MS;
+
+    if (phase < MRF24JSLOTS_SLOT_MS - MRF24JSLOTS_GUARD_MS)
+    {
+        if (slot != slotCurrent)
+        {
+            MRF24JSlotsEnter(slot);
+        }
+
+        delay = MRF24JSLOTS_SLOT_MS - MRF24JSLOTS_GUARD_MS - phase;
+    }
+    else
+    {
+        slot = (slot + 1) % MRF24JSLOTS_COUNT;
+
+        if (slot != slotPrepared)
+        {
+            MRF24JSlotsPrepare(slot);
+        }
+
+        delay = MRF24JSLOTS_SLOT_MS - phase;
+        slot = slotCurrent;
+    }
+
+    //a frame still being sent is finished before the sleep
+    if (!radioAsleep && !MRF24JSlotsAwake(slot) && (slot == slotCurrent)
+            && (slotPrepared != (slot + 1) % MRF24JSLOTS_COUNT)
+            && !MRF24JMACIsSending())
+    {
+        MRF24JSlotsSleep();
+    }
+
+    uKernelModifyTask(slotsTask, delay, UKERNEL_EVENT);
+}
@@ -0,0 +1,121 @@
+/**
+ *  @file       MRF24JSlots.h
+ *  @author     Luis Maduro
+ *  @version    1.00
+ *  @date       14/10/2026
+ *  @brief      Beacon time synchronisation and slotted access of the
+ *              MRF24J40 over MRF24JMAC.c.
+ *
+ *  The time is cut in superframes of MRF24JSLOTS_COUNT slots of
+ *  MRF24JSLOTS_SLOT_MS. In slot 0 the coordinator broadcasts a beacon with
+ *  its time and the owner of every node slot. Slot 1 is the slot of the
+ *  coordinator, it sends its frames to the nodes there, and the slots from
+ *  MRF24JSLOTS_FIRST_NODE_SLOT are given to one node each with
+ *  MRF24JSlotsAssign(). A node only sends in its own slot, so the nodes of
+ *  a network never collide, and the radio of a node sleeps in the slots of
+ *  the other nodes: it is awake in slots 0, 1 and its own, 3 slots of the
+ *  superframe whatever the number of nodes.
+ *
+ *  A node takes the network time from the beacons: MRF24JSlotsNetworkTime()
+ *  is _counterMs plus the offset of the last beacon. _counterMs itself is
+ *  not stepped, the deadlines of the tasks depend on it, and
+ *  MRF24JSlotsToLocal() converts a network time for them. A beacon is timed
+ *  on the interrupt of its reception, MRF24JSLOTS_BEACON_LATENCY covers the
+ *  backoff and the time on the air. The crystals drift by a few tens of ppm,
+ *  much less than a guard time (MRF24JSLOTS_GUARD_MS) over a superframe:
+ *  the radio wakes up that long before its slots and the last frame of a
+ *  slot is started that long before its end. After MRF24JSLOTS_LOST_BEACONS
+ *  beacons missed in a row the node listens all the time, without sending,
+ *  until the next beacon.
+ *
+ *  The work is done by an UKERNEL_EVENT task signaled by
+ *  MRF24JSlotsInterrupt(), called from the interrupt routine of the INT pin
+ *  of the radio instead of MRF24JMACInterrupt(). The task calls
+ *  MRF24JMACTasks(), the application doesn't. The frames are queued with
+ *  MRF24JMACSend() at any time, they wait for the slot. MRF24JDutyCycle.c
+ *  is not used with this file.
+ *
+ *  Copyright (C) 2026  Luis Maduro
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef MRF24JSLOTS_H
+#define MRF24JSLOTS_H
+
+#include <stdint.h>
+#include "MRF24JMAC.h"
+#include "uKernel/uKernel.h"
+
+/**Slots of a superframe, the beacon, the coordinator and the nodes.*/
+#ifndef MRF24JSLOTS_COUNT
+#define MRF24JSLOTS_COUNT           8
+#endif
+
+/**Length of a slot in ms, a frame of 127 bytes and its acknowledgement
+ take 5 ms at 250 kbps.*/
+#ifndef MRF24JSLOTS_SLOT_MS
+#define MRF24JSLOTS_SLOT_MS         25
+#endif
+
+/**Time in ms the radio wakes up before its slots and the sending stops
+ before their end.*/
+#ifndef MRF24JSLOTS_GUARD_MS
+#define MRF24JSLOTS_GUARD_MS        3
+#endif
+
+/**Time in ms from the time written in a beacon to its reception.*/
+#ifndef MRF24JSLOTS_BEACON_LATENCY
+#define MRF24JSLOTS_BEACON_LATENCY  2
+#endif
+
+/**Beacons missed in a row before a node is no longer synchronized.*/
+#ifndef MRF24JSLOTS_LOST_BEACONS
+#define MRF24JSLOTS_LOST_BEACONS    4
+#endif
+
+#define MRF24JSLOTS_BEACON_SLOT     0
+#define MRF24JSLOTS_COORDINATOR_SLOT 1
+#define MRF24JSLOTS_FIRST_NODE_SLOT 2
+/**Value of a slot without an owner.*/
+#define MRF24JSLOTS_NONE            0xFF
+
+/**Length of a superframe, in ms.*/
+#define MRF24JSLOTS_SUPERFRAME_MS   ((uint32_t) MRF24JSLOTS_COUNT * MRF24JSLOTS_SLOT_MS)
+
+#if MRF24JSLOTS_COUNT < 3
+#error "MRF24JSlots: at least 3 slots"
+#endif
+
+#if MRF24JSLOTS_GUARD_MS * 2 >= MRF24JSLOTS_SLOT_MS
+#error "MRF24JSlots: the guard time takes the whole slot"
+#endif
+
+typedef enum
+{
+    /**Sends the beacons and listens all the time.*/
+    MRF24JSLOTS_COORDINATOR = 0,
+    /**Follows the beacons and sleeps outside its slots.*/
+    MRF24JSLOTS_NODE
+} tMRF24JSlotsRole;
+
+void MRF24JSlotsInit(uKernelTaskDescriptor *task, tMRF24JSlotsRole role);
+bool MRF24JSlotsAssign(unsigned char slot, unsigned int address);
+unsigned char MRF24JSlotsGetSlot(void);
+bool MRF24JSlotsIsSynchronized(void);
+uint32_t MRF24JSlotsNetworkTime(void);
+uint32_t MRF24JSlotsToLocal(uint32_t networkTime);
+void MRF24JSlotsInterrupt(void);
+
+#endif /* MRF24JSLOTS_H */
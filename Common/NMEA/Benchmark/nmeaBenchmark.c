@@ -0,0 +1,402 @@
+/**
+ *  @file       nmeaBenchmark.c
+ *  @author     Luis Maduro
+ *  @version    1.00
+ *  @date       14/10/2026
+ *  @brief      Host benchmark and fuzzer of the NMEA library.
+ *
+ *  Replays a recorded NMEA log (or a built in one) through nmeaParseByte()
+ *  and reports the sentences per second and the cycles per sentence of the
+ *  host. Then mutates the sentences (bit flips, missing '*', truncation,
+ *  extra '$', sentences too long, random bytes) and feeds them to
+ *  nmeaParseByte(), nmeaParseSentence(), nmeaCalculateChecksum() and
+ *  nmeaGetChecksumReceived(), checking the state of the parser after every
+ *  character. Every mutated sentence is in a buffer of its exact size, so
+ *  with the sanitizers any read past its end stops the program.
+ *
+ *  Build and run on the host, from this folder:
+ *  @code
+ *  gcc -O2 -DNMEA_USE_GSA -DNMEA_USE_GSV -DNMEA_USE_VTG -I../.. \
+ *      nmeaBenchmark.c ../nmea.c -o nmeaBenchmark
+ *  ./nmeaBenchmark [log file] [fuzz iterations]
+ *  @endcode
+ *  Add -fsanitize=address,undefined -g to catch the overruns. The program
+ *  returns 1 if a check fails.
+ *
+ *  Copyright (C) 2026  Luis Maduro
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <stdint.h>
+#include <time.h>
+#include "NMEA/nmea.h"
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#define BENCHMARK_CYCLES()          __rdtsc()
+#endif
+
+/** Passes over the log for the benchmark*/
+#define BENCHMARK_PASSES            2000
+/** Fuzz iterations by default*/
+#define FUZZ_ITERATIONS             200000
+/** Maximum number of sentences of the log*/
+#define LOG_MAXIMUM_SENTENCES       4096
+/** Maximum length of a mutated sentence*/
+#define FUZZ_MAXIMUM_LENGTH         256
+
+/**
+ * Built in log, a second of several receivers. The checksums are added at
+ * the start, the recorded logs must have theirs.
+ */
+static const char *defaultLog[] = {
+    "$GPRMC,123519,A,4807.038,N,01131.000,E,022.4,084.4,230394,003.1,W",
+    "$GPGGA,123519,4807.038,N,01131.000,E,1,08,0.9,545.4,M,46.9,M,,",
+    "$GPGSA,A,3,04,05,,09,12,,,24,,,,,2.5,1.3,2.1",
+    "$GPGSV,2,1,08,01,40,083,46,02,17,308,41,12,07,344,39,14,22,228,45",
+    "$GPGSV,2,2,08,15,31,151,42,18,55,042,47,20,12,095,35,25,03,281,",
+    "$GPVTG,054.7,T,034.4,M,005.5,N,010.2,K,A",
+    "$GNRMC,001225.00,A,2832.18345,N,08101.05362,W,0.012,,251211,,,D",
+    "$GNGGA,001225.00,2832.18345,N,08101.05362,W,2,12,0.71,25.3,M,-31.5,M,,0000",
+    "$GNGSA,A,3,10,07,05,02,29,04,08,13,,,,,1.72,1.03,1.38",
+    "$GLGSV,3,1,09,65,22,035,31,66,64,324,26,67,40,250,,72,52,061,33",
+    "$GAGSV,1,1,03,02,45,120,38,11,33,276,35,12,08,010,",
+    "$GNVTG,,T,,M,0.012,N,0.022,K,D",
+    "$GPZDA,001225.00,25,12,2011,00,00",
+};
+
+static char *logSentences[LOG_MAXIMUM_SENTENCES];
+static unsigned int logLength;
+static uint32_t randomState = 1;
+static unsigned long failures;
+
+static uint32_t FuzzRandom(void)
+{
+    randomState = randomState * 1103515245u + 12345u;
+
+    return randomState >> 8;
+}
+
+static double HostSeconds(void)
+{
+    struct timespec now;
+
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return now.tv_sec + now.tv_nsec / 1e9;
+}
+
+static void Fail(const char *check, const char *sentence, size_t length)
+{
+    failures++;
+    printf("FAIL %s: \"%.*s\"\n", check, (int) length, sentence);
+}
+
+/**
+ * Adds a sentence to the log.
+ */
+static void LogAdd(const char *sentence)
+{
+    if (logLength < LOG_MAXIMUM_SENTENCES)
+    {
+        logSentences[logLength++] = strdup(sentence);
+    }
+}
+
+/**
+ * Loads the built in log, with its checksums.
+ */
+static void LogDefault(void)
+{
+    char sentence[FUZZ_MAXIMUM_LENGTH];
+    unsigned int i;
+
+    for (i = 0; i < sizeof (defaultLog) / sizeof (defaultLog[0]); i++)
+    {
+        snprintf(sentence, sizeof (sentence), "%s*%02X\r\n", defaultLog[i],
+                 (unsigned char) nmeaCalculateChecksum((char *) defaultLog[i]));
+        LogAdd(sentence);
+    }
+}
+
+/**
+ * Loads a recorded log, one sentence per line.
+ */
+static bool LogLoad(const char *name)
+{
+    char line[FUZZ_MAXIMUM_LENGTH];
+    FILE *file = fopen(name, "r");
+
+    if (file == NULL)
+    {
+        return false;
+    }
+
+    while (fgets(line, sizeof (line) - 2, file) != NULL)
+    {
+        line[strcspn(line, "\r\n")] = '\0';
+
+        if (line[0] == '$')
+        {
+            strcat(line, "\r\n");
+            LogAdd(line);
+        }
+    }
+
+    fclose(file);
+    return true;
+}
+
+/**
+ * Replays the log, the sentences per second and cycles per sentence are
+ * those of the host.
+ */
+static void Benchmark(void)
+{
+    unsigned long sentences = 0;
+    unsigned long valid = 0;
+    unsigned long bytes = 0;
+    unsigned int pass;
+    unsigned int i;
+    const char *c;
+    double seconds;
+#ifdef BENCHMARK_CYCLES
+    uint64_t cycles = BENCHMARK_CYCLES();
+#endif
+
+    seconds = HostSeconds();
+    nmeaParserReset();
+
+    for (pass = 0; pass < BENCHMARK_PASSES; pass++)
+    {
+        for (i = 0; i < logLength; i++)
+        {
+            for (c = logSentences[i]; *c != '\0'; c++)
+            {
+                valid += nmeaParseByte(*c);
+            }
+
+            bytes += c - logSentences[i];
+        }
+
+        sentences += logLength;
+    }
+
+    seconds = HostSeconds() - seconds;
+#ifdef BENCHMARK_CYCLES
+    cycles = BENCHMARK_CYCLES() - cycles;
+#endif
+
+    printf("benchmark: %lu sentences (%lu valid), %lu bytes in %.3f s\n",
+           sentences, valid, bytes, seconds);
+    printf("  %.0f sentences/s, %.1f ns/sentence", sentences / seconds,
+           seconds * 1e9 / sentences);
+#ifdef BENCHMARK_CYCLES
+    printf(", %.0f cycles/sentence, %.1f cycles/byte",
+           (double) cycles / sentences, (double) cycles / bytes);
+#endif
+    printf("\n");
+
+    if (valid != sentences)
+    {
+        printf("  %lu sentences of the log have a bad checksum\n",
+               sentences - valid);
+    }
+}
+
+/**
+ * Mutates a sentence of the log.
+ * @return Length of the mutated sentence.
+ */
+static size_t FuzzMutate(char *out, const char *in)
+{
+    size_t length = strlen(in);
+    size_t position;
+    char *star;
+
+    memcpy(out, in, length);
+
+    switch (FuzzRandom() % 8)
+    {
+        case 0:
+            //bit flips
+            out[FuzzRandom() % length] ^= 1 << (FuzzRandom() % 8);
+            break;
+        case 1:
+            //missing '*', the checksum functions must stop at the end
+            star = memchr(out, '*', length);
+            if (star != NULL)
+            {
+                memmove(star, star + 1, length - (star - out) - 1);
+                length--;
+            }
+            break;
+        case 2:
+            //truncated sentence
+            length = FuzzRandom() % length;
+            break;
+        case 3:
+            //a new '$' in the middle
+            out[FuzzRandom() % length] = '$';
+            break;
+        case 4:
+            //too long, too many fields
+            while (length < FUZZ_MAXIMUM_LENGTH - 1)
+            {
+                out[length++] = (FuzzRandom() & 1) ? ',' : '1';
+            }
+            break;
+        case 5:
+            //random bytes
+            for (position = FuzzRandom() % length; position < length; position++)
+            {
+                out[position] = (char) FuzzRandom();
+            }
+            break;
+        case 6:
+            //truncated right after the '*'
+            star = memchr(out, '*', length);
+            if (star != NULL)
+            {
+                length = star - out + 1 + FuzzRandom() % 2;
+            }
+            break;
+        default:
+            //lower case checksum, must be accepted
+            for (position = 0; position < length; position++)
+            {
+                if (out[position] == '*')
+                {
+                    out[position + 1] = tolower(out[position + 1]);
+                    out[position + 2] = tolower(out[position + 2]);
+                }
+            }
+            break;
+    }
+
+    return length;
+}
+
+/**
+ * The fields of a sentence just accepted must be inside the buffer.
+ */
+static void FuzzCheckFields(const char *mutated, size_t length)
+{
+    unsigned char i;
+
+    for (i = 0; i < NMEA.Fields; i++)
+    {
+        if (nmeaGetField(i) + nmeaGetFieldLength(i) > &NMEA.Buffer[NMEA.Length] ||
+            nmeaGetFieldLength(i) != strlen(nmeaGetField(i)))
+        {
+            Fail("field length", mutated, length);
+        }
+    }
+}
+
+/**
+ * Feeds mutated sentences to the library, the parser must stay consistent
+ * and nothing can be read out of the sentence.
+ */
+static void Fuzz(unsigned long iterations, bool checkLog)
+{
+    char mutated[FUZZ_MAXIMUM_LENGTH];
+    unsigned long accepted = 0;
+    unsigned long i;
+    size_t length;
+    size_t j;
+    char *sentence;
+
+    //the built in log is all valid, a recorded one can have errors
+    for (i = 0; checkLog && i < logLength; i++)
+    {
+        if (!nmeaParseSentence(logSentences[i]))
+        {
+            Fail("valid sentence rejected", logSentences[i], strlen(logSentences[i]));
+        }
+    }
+
+    for (i = 0; i < iterations; i++)
+    {
+        length = FuzzMutate(mutated, logSentences[FuzzRandom() % logLength]);
+
+        //byte at a time, as from the USART
+        for (j = 0; j < length; j++)
+        {
+            if (nmeaParseByte(mutated[j]))
+            {
+                accepted++;
+                FuzzCheckFields(mutated, length);
+            }
+
+            if (NMEA.Length > NMEA_MAXIMUM_LENGTH ||
+                NMEA.Fields > NMEA_MAXIMUM_FIELDS ||
+                NMEA.State > NMEA_END)
+            {
+                Fail("parser state", mutated, length);
+                nmeaParserReset();
+            }
+        }
+
+        //exact size, without room after the '\0'
+        sentence = malloc(length + 1);
+        memcpy(sentence, mutated, length);
+        sentence[length] = '\0';
+
+        nmeaParseSentence(sentence);
+        nmeaCalculateChecksum(sentence);
+        nmeaGetChecksumReceived(sentence);
+        free(sentence);
+    }
+
+    printf("fuzz: %lu mutated sentences, %lu accepted, %lu failures\n",
+           iterations, accepted, failures);
+}
+
+int main(int argc, char **argv)
+{
+    unsigned long iterations = FUZZ_ITERATIONS;
+    bool recorded = false;
+
+    if (argc > 1 && strcmp(argv[1], "-") != 0)
+    {
+        if (!LogLoad(argv[1]))
+        {
+            fprintf(stderr, "%s: can't read %s\n", argv[0], argv[1]);
+            return 1;
+        }
+
+        recorded = true;
+    }
+    else
+    {
+        LogDefault();
+    }
+
+    if (argc > 2)
+    {
+        iterations = strtoul(argv[2], NULL, 10);
+    }
+
+    if (logLength == 0)
+    {
+        fprintf(stderr, "%s: no sentences in the log\n", argv[0]);
+        return 1;
+    }
+
+    Benchmark();
+    Fuzz(iterations, !recorded);
+
+    return failures ? 1 : 0;
+}
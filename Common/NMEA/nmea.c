@@ -21,54 +21,370 @@
  *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
  */
 
-#include "nmea/nmea.h"
+#include "NMEA/nmea.h"
 
+nmeaParser NMEA;
+#ifdef NMEA_USE_RMC
 nmeaGPRMC GPRMC;
+#endif
+#ifdef NMEA_USE_GGA
+nmeaGGA GGA;
+#endif
+#ifdef NMEA_USE_GSA
+nmeaGSA GSA;
+#endif
+#ifdef NMEA_USE_GSV
+nmeaGSV GSV;
+#endif
+#ifdef NMEA_USE_VTG
+nmeaVTG VTG;
+#endif
 
+static unsigned char nmeaHexValue(char c);
+static unsigned char nmeaTwoDigits(const char *field);
+static unsigned long nmeaDecimal(const char *field, unsigned char decimals);
+static long nmeaSignedDecimal(const char *field, unsigned char decimals);
+static long nmeaCoordinate(const char *field, char hemisphere);
+static bool nmeaDecodeSentence(void);
+
+/**
+ * Drops the sentence being received, the parser waits for the next '$'.
+ */
+void nmeaParserReset(void)
+{
+    NMEA.State = NMEA_WAIT_START;
+    NMEA.Length = 0;
+    NMEA.Fields = 0;
+}
+
+/**
+ * Feeds one character to the parser, from the USART interrupt or from a
+ * uFIFO. The checksum is computed and the fields are split as the
+ * characters arrive, so a sentence is decoded as soon as its "*hh<CR><LF>"
+ * is received, without reading it again.
+ * @param c Character received.
+ * @return True when a sentence with a valid checksum was completed by this
+ *         character. Its fields are then given by nmeaGetField() until the
+ *         next '$', and the sentences enabled in nmea.h are already decoded
+ *         (NMEA.Sentence tells which one it was).
+ */
+bool nmeaParseByte(char c)
+{
+    unsigned char value;
+
+    if (c == '$')
+    {
+        //a start always begins a new sentence, even in the middle of one
+        NMEA.State = NMEA_DATA;
+        NMEA.Length = 0;
+        NMEA.Field[0] = 0;
+        NMEA.Fields = 1;
+        NMEA.Checksum = 0;
+        return false;
+    }
+
+    switch (NMEA.State)
+    {
+        case NMEA_DATA:
+            if (c == '*')
+            {
+                NMEA.Buffer[NMEA.Length] = '\0';
+                NMEA.State = NMEA_CHECKSUM_HIGH;
+            }
+            else if (NMEA.Length >= NMEA_MAXIMUM_LENGTH || c == '\r' || c == '\n')
+            {
+                nmeaParserReset();
+            }
+            else if (c == ',')
+            {
+                NMEA.Checksum ^= c;
+                NMEA.Buffer[NMEA.Length++] = '\0';
+
+                if (NMEA.Fields >= NMEA_MAXIMUM_FIELDS)
+                {
+                    nmeaParserReset();
+                }
+                else
+                {
+                    NMEA.Field[NMEA.Fields++] = NMEA.Length;
+                }
+            }
+            else
+            {
+                NMEA.Checksum ^= c;
+                NMEA.Buffer[NMEA.Length++] = c;
+            }
+            break;
+
+        case NMEA_CHECKSUM_HIGH:
+            value = nmeaHexValue(c);
+
+            if (value > 0x0F)
+            {
+                nmeaParserReset();
+            }
+            else
+            {
+                NMEA.ChecksumReceived = value << 4;
+                NMEA.State = NMEA_CHECKSUM_LOW;
+            }
+            break;
+
+        case NMEA_CHECKSUM_LOW:
+            value = nmeaHexValue(c);
+
+            if (value > 0x0F)
+            {
+                nmeaParserReset();
+            }
+            else
+            {
+                NMEA.ChecksumReceived |= value;
+                NMEA.State = NMEA_END;
+            }
+            break;
+
+        case NMEA_END:
+            NMEA.State = NMEA_WAIT_START;
+
+            if ((c == '\r' || c == '\n') &&
+                NMEA.Checksum == NMEA.ChecksumReceived)
+            {
+                nmeaDecodeSentence();
+                return true;
+            }
+            break;
+
+        default:
+            break;
+    }
+
+    return false;
+}
+
+/**
+ * Gives a field of the last sentence received.
+ * @param field Number of the field, 0 is the address (e.g. "GPRMC").
+ * @return Pointer to the field, an empty string if the sentence doesn't have
+ *         that field.
+ */
+char *nmeaGetField(unsigned char field)
+{
+    if (field >= NMEA.Fields)
+    {
+        return &NMEA.Buffer[NMEA.Length];
+    }
+
+    return &NMEA.Buffer[NMEA.Field[field]];
+}
+
+/**
+ * Length of a field of the last sentence received, without a search: a
+ * field ends one character before the start of the next one.
+ * @param field Number of the field, 0 is the address.
+ * @return Number of characters of the field, 0 if it is empty or the
+ *         sentence doesn't have it.
+ */
+unsigned char nmeaGetFieldLength(unsigned char field)
+{
+    if (field >= NMEA.Fields)
+    {
+        return 0;
+    }
+
+    if (field == NMEA.Fields - 1)
+    {
+        return NMEA.Length - NMEA.Field[field];
+    }
+
+    return NMEA.Field[field + 1] - NMEA.Field[field] - 1;
+}
+
+/**
+ * Parses a whole sentence, already in memory, through nmeaParseByte().
+ * @param sentence Sentence, from the '$' to the <CR><LF>.
+ * @return True if the sentence has a valid checksum and was decoded.
+ */
 bool nmeaParseSentence(char *sentence)
 {
-    bool allOK = true;
+    nmeaParserReset();
+
+    while (*sentence != '\0')
+    {
+        if (nmeaParseByte(*sentence++))
+            return true;
+    }
 
-    char checksumCalculated, checksumReceived;
+    return false;
+}
+
+#ifdef NMEA_USE_RMC
+
+/**
+ * Decodes the fields of the last sentence received as a RMC sentence, of
+ * any talker.
+ * @return True if the sentence has all the fields.
+ */
+bool nmeaParseGPRMC(void)
+{
+    char *field;
 
-    if ((unsigned char) strlen(sentence) < MINIMUM_SENTENCE_LENGTH)
+    if (NMEA.Fields < 12)
         return false;
 
-    checksumCalculated = nmeaCalculateChecksum(sentence);
-    checksumReceived = nmeaGetChecksumReceived(sentence);
+    field = nmeaGetField(1);
+
+    if (nmeaGetFieldLength(1) >= 6)
+    {
+        GPRMC.UTC.Hour = nmeaTwoDigits(field);
+        GPRMC.UTC.Minutes = nmeaTwoDigits(field + 2);
+        GPRMC.UTC.Seconds = nmeaTwoDigits(field + 4);
+    }
+
+    GPRMC.Status = *nmeaGetField(2);
+    GPRMC.North_South = *nmeaGetField(4);
+    GPRMC.Latitude = nmeaCoordinate(nmeaGetField(3), GPRMC.North_South);
+    GPRMC.East_West = *nmeaGetField(6);
+    GPRMC.Longitude = nmeaCoordinate(nmeaGetField(5), GPRMC.East_West);
+    GPRMC.Speed = nmeaDecimal(nmeaGetField(7), 2);
+    GPRMC.True_Course = (unsigned int) nmeaDecimal(nmeaGetField(8), 2);
+
+    field = nmeaGetField(9);
+
+    if (nmeaGetFieldLength(9) >= 6)
+    {
+        GPRMC.UTC.Day = nmeaTwoDigits(field);
+        GPRMC.UTC.Month = nmeaTwoDigits(field + 2) - 1;
+        GPRMC.UTC.Year = nmeaTwoDigits(field + 4) + 100;
+    }
+
+    GPRMC.Declination = (unsigned int) nmeaDecimal(nmeaGetField(10), 2);
+    GPRMC.Declination_Direction = *nmeaGetField(11);
+    GPRMC.Mode = *nmeaGetField(12);
+    GPRMC.Checksum = NMEA.ChecksumReceived;
+
+    return true;
+}
+#endif
 
-    if (checksumCalculated != checksumReceived)
+#ifdef NMEA_USE_GGA
+
+/**
+ * Decodes the fields of the last sentence received as a GGA sentence.
+ * @return True if the sentence has all the fields.
+ */
+bool nmeaParseGGA(void)
+{
+    char *field;
+
+    if (NMEA.Fields < 12)
         return false;
 
-    if (strncmppgm2ram(sentence, (const MEM_MODEL rom char *) "$GPRMC,", 7) == 0)
-        allOK &= nmeaParseGPRMC(sentence);
+    field = nmeaGetField(1);
+
+    if (nmeaGetFieldLength(1) >= 6)
+    {
+        GGA.UTC.Hour = nmeaTwoDigits(field);
+        GGA.UTC.Minutes = nmeaTwoDigits(field + 2);
+        GGA.UTC.Seconds = nmeaTwoDigits(field + 4);
+    }
+
+    GGA.Latitude = nmeaCoordinate(nmeaGetField(2), *nmeaGetField(3));
+    GGA.Longitude = nmeaCoordinate(nmeaGetField(4), *nmeaGetField(5));
+    GGA.Quality = (unsigned char) nmeaDecimal(nmeaGetField(6), 0);
+    GGA.Satellites = (unsigned char) nmeaDecimal(nmeaGetField(7), 0);
+    GGA.HDOP = (unsigned int) nmeaDecimal(nmeaGetField(8), 2);
+    GGA.Altitude = nmeaSignedDecimal(nmeaGetField(9), 2);
+    GGA.Geoid_Separation = nmeaSignedDecimal(nmeaGetField(11), 2);
+
+    return true;
+}
+#endif
+
+#ifdef NMEA_USE_GSA
+
+/**
+ * Decodes the fields of the last sentence received as a GSA sentence.
+ * @return True if the sentence has all the fields.
+ */
+bool nmeaParseGSA(void)
+{
+    unsigned char i;
 
-    if (allOK == true)
-        return true;
-    else
+    if (NMEA.Fields < 18)
         return false;
+
+    GSA.Mode = *nmeaGetField(1);
+    GSA.Fix_Type = (unsigned char) nmeaDecimal(nmeaGetField(2), 0);
+
+    for (i = 0; i < NMEA_GSA_SATELLITES; i++)
+    {
+        GSA.Satellite[i] = (unsigned char) nmeaDecimal(nmeaGetField(3 + i), 0);
+    }
+
+    GSA.PDOP = (unsigned int) nmeaDecimal(nmeaGetField(15), 2);
+    GSA.HDOP = (unsigned int) nmeaDecimal(nmeaGetField(16), 2);
+    GSA.VDOP = (unsigned int) nmeaDecimal(nmeaGetField(17), 2);
+
+    return true;
 }
+#endif
 
-bool nmeaParseGPRMC(char *sentence)
+#ifdef NMEA_USE_GSV
+
+/**
+ * Decodes the fields of the last sentence received as a GSV sentence, the
+ * satellites of one message of the sequence.
+ * @return True if the sentence has the header fields.
+ */
+bool nmeaParseGSV(void)
 {
-    char tempChar[10] = {0};
-    char *tempCharPtr = &tempChar[0];
+    unsigned char i;
+    unsigned char field;
 
-    strncpy(tempCharPtr, sentence + 7, 2);
-    GPRMC.UTC.Hour = atob(tempCharPtr);
+    if (NMEA.Fields < 4)
+        return false;
 
-    strncpy(tempCharPtr, sentence + 9, 2);
-    GPRMC.UTC.Minutes = atob(tempCharPtr);
+    GSV.Messages = (unsigned char) nmeaDecimal(nmeaGetField(1), 0);
+    GSV.Message = (unsigned char) nmeaDecimal(nmeaGetField(2), 0);
+    GSV.Satellites_In_View = (unsigned char) nmeaDecimal(nmeaGetField(3), 0);
 
-    strncpy(tempCharPtr, sentence + 11, 2);
-    GPRMC.UTC.Seconds = atob(tempCharPtr);
+    //4 fields per satellite, the last message can have less than 4
+    for (i = 0, field = 4;
+         i < NMEA_GSV_SATELLITES && field + 3 < NMEA.Fields; i++, field += 4)
+    {
+        GSV.Satellite[i].PRN = (unsigned char) nmeaDecimal(nmeaGetField(field), 0);
+        GSV.Satellite[i].Elevation = (unsigned char) nmeaDecimal(nmeaGetField(field + 1), 0);
+        GSV.Satellite[i].Azimuth = (unsigned int) nmeaDecimal(nmeaGetField(field + 2), 0);
+        GSV.Satellite[i].SNR = (unsigned char) nmeaDecimal(nmeaGetField(field + 3), 0);
+    }
 
-    strncpy(tempCharPtr, sentence + 14, 1);
-    GPRMC.Status = *tempCharPtr;
+    GSV.Count = i;
 
-    strncpy(tempCharPtr, sentence + 16, 7);
-    GPRMC.Latitude = atof(tempCharPtr);
+    return true;
 }
+#endif
+
+#ifdef NMEA_USE_VTG
+
+/**
+ * Decodes the fields of the last sentence received as a VTG sentence.
+ * @return True if the sentence has all the fields.
+ */
+bool nmeaParseVTG(void)
+{
+    if (NMEA.Fields < 9)
+        return false;
+
+    VTG.True_Course = (unsigned int) nmeaDecimal(nmeaGetField(1), 2);
+    VTG.Magnetic_Course = (unsigned int) nmeaDecimal(nmeaGetField(3), 2);
+    VTG.Speed_Knots = nmeaDecimal(nmeaGetField(5), 2);
+    VTG.Speed_Kmh = nmeaDecimal(nmeaGetField(7), 2);
+    VTG.Mode = *nmeaGetField(9);
+
+    return true;
+}
+#endif
 
 /**
  * Function to calculate the checksum of the received NMEA sentence.
@@ -77,15 +393,15 @@ bool nmeaParseGPRMC(char *sentence)
  */
 char nmeaCalculateChecksum(char *sentence)
 {
-    char checksum, i;
+    char checksum = 0;
 
-    i = 1;
+    if (*sentence == '$')
+        sentence++;
 
-    do
+    while (*sentence != '*' && *sentence != '\0')
     {
-        checksum = checksum ^ sentence[i++];
+        checksum ^= *sentence++;
     }
-    while (sentence[i] != '*');
 
     return checksum;
 }
@@ -94,24 +410,199 @@ char nmeaCalculateChecksum(char *sentence)
  * Funtion to get the checksum from the received NMEA sentence.
  * @param sentence Pointer to the firt character of the sentence.
  * @return The value of the checksum present on the sentence in hexadecimal.
- * @todo Better implementation of this method!!!! Ugly as hell!!! Garantir que
- * est tudo em uppercase e tirar 55.
  */
 char nmeaGetChecksumReceived(char *sentence)
 {
-    char checksum, i, c;
+    sentence = strchr(sentence, '*');
 
-    i = 0;
-    checksum = 0;
+    //a truncated sentence can end right after the '*'
+    if (sentence == NULL || sentence[1] == '\0')
+        return 0;
 
-    while (sentence[i] != '*')
-        i++;
+    return (nmeaHexValue(sentence[1]) << 4) | nmeaHexValue(sentence[2]);
+}
 
-    c = toupper(sentence[++i]);
-    checksum += (c - 0x30) << 4;
+/**
+ * Decodes the sentence just completed, if it is one of the known ones. The
+ * talker is checked once and the type is turned in a number, so there is a
+ * single switch instead of a string compare per sentence.
+ * @return True if the sentence was decoded.
+ */
+static bool nmeaDecodeSentence(void)
+{
+    char *address = nmeaGetField(0);
 
-    c = toupper(sentence[++i]);
-    checksum += (c - 0x30);
+    NMEA.Sentence = 0;
 
-    return checksum;
-}
\ No newline at end of file
+    if (nmeaGetFieldLength(0) != 5 || address[0] != 'G')
+        return false;
+
+    switch (address[1])
+    {
+        case 'P':
+        case 'N':
+        case 'L':
+        case 'A':
+            break;
+        default:
+            return false;
+    }
+
+    NMEA.Talker = address[1];
+    NMEA.Sentence = NMEA_ID(address[2], address[3], address[4]);
+
+    switch (NMEA.Sentence)
+    {
+#ifdef NMEA_USE_RMC
+        case NMEA_RMC:
+            return nmeaParseGPRMC();
+#endif
+#ifdef NMEA_USE_GGA
+        case NMEA_GGA:
+            return nmeaParseGGA();
+#endif
+#ifdef NMEA_USE_GSA
+        case NMEA_GSA:
+            return nmeaParseGSA();
+#endif
+#ifdef NMEA_USE_GSV
+        case NMEA_GSV:
+            return nmeaParseGSV();
+#endif
+#ifdef NMEA_USE_VTG
+        case NMEA_VTG:
+            return nmeaParseVTG();
+#endif
+        default:
+            return false;
+    }
+}
+
+/**
+ * Value of a hexadecimal digit, upper or lower case.
+ * @return Value of the digit, 0xFF if the character is not a digit.
+ */
+static unsigned char nmeaHexValue(char c)
+{
+    if (c >= '0' && c <= '9')
+        return c - '0';
+
+    c = toupper(c);
+
+    if (c >= 'A' && c <= 'F')
+        return c - 'A' + 10;
+
+    return 0xFF;
+}
+
+/**
+ * Value of a number of two decimal digits, 0 if they are not digits.
+ */
+static unsigned char nmeaTwoDigits(const char *field)
+{
+    if (!isdigit(field[0]) || !isdigit(field[1]))
+        return 0;
+
+    return (field[0] - '0') * 10 + (field[1] - '0');
+}
+
+/**
+ * Value of a decimal number in fixed point, without floating point. The
+ * digits after the ones wanted are truncated.
+ * @param field Number, e.g. "022.4".
+ * @param decimals Number of decimal places of the result (2 gives 2240).
+ * @return The number times 10^decimals.
+ */
+static unsigned long nmeaDecimal(const char *field, unsigned char decimals)
+{
+    unsigned long value = 0;
+
+    while (isdigit(*field))
+    {
+        value = value * 10 + (*field++ - '0');
+    }
+
+    if (*field == '.')
+    {
+        field++;
+    }
+
+    while (decimals != 0)
+    {
+        value *= 10;
+
+        if (isdigit(*field))
+        {
+            value += *field++ - '0';
+        }
+
+        decimals--;
+    }
+
+    return value;
+}
+
+/**
+ * Value of a decimal number that can be negative, in fixed point.
+ * @param field Number, e.g. "-12.5".
+ * @param decimals Number of decimal places of the result.
+ * @return The number times 10^decimals.
+ */
+static long nmeaSignedDecimal(const char *field, unsigned char decimals)
+{
+    if (*field == '-')
+    {
+        return -(long) nmeaDecimal(field + 1, decimals);
+    }
+
+    return (long) nmeaDecimal(field, decimals);
+}
+
+/**
+ * Converts a NMEA coordinate, [degrees][minutes].[decimals of minute], to
+ * 1e-7 degrees.
+ * @param field Coordinate, e.g. "4807.038" or "01131.000".
+ * @param hemisphere 'N', 'S', 'E' or 'W', south and west are negative.
+ * @return The coordinate in 1e-7 degrees.
+ */
+static long nmeaCoordinate(const char *field, char hemisphere)
+{
+    unsigned long degreesMinutes = 0;
+    unsigned long minutes;
+    unsigned char decimals;
+    long coordinate;
+
+    while (isdigit(*field))
+    {
+        degreesMinutes = degreesMinutes * 10 + (*field++ - '0');
+    }
+
+    if (*field == '.')
+    {
+        field++;
+    }
+
+    //minutes in 1e-5 minute
+    minutes = degreesMinutes % 100;
+
+    for (decimals = 0; decimals < 5; decimals++)
+    {
+        minutes *= 10;
+
+        if (isdigit(*field))
+        {
+            minutes += *field++ - '0';
+        }
+    }
+
+    //1e-5 minute = 1e-7 degree * 100 / 60, rounded
+    coordinate = (long) ((degreesMinutes / 100) * 10000000UL +
+            (minutes * 5 + 1) / 3);
+
+    if (hemisphere == 'S' || hemisphere == 'W')
+    {
+        coordinate = -coordinate;
+    }
+
+    return coordinate;
+}
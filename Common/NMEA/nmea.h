@@ -30,10 +30,93 @@
 #include <string.h>
 #include <ctype.h>
 
+/*
+ * Sentences decoded, comment out the ones not used to save ROM. The other
+ * sentences are still checked and their fields given by nmeaGetField().
+ */
+#define NMEA_USE_RMC
+#define NMEA_USE_GGA
+//#define NMEA_USE_GSA
+//#define NMEA_USE_GSV
+//#define NMEA_USE_VTG
+
 /** Number of characters of the smaller NMEA sentence*/
 #define MINIMUM_SENTENCE_LENGTH     70
 /** GPRMC datatype identifier*/
 #define GPRMC_HEADER                "$GPRMC,"
+/** Maximum number of characters between the '$' and the '*' (82 for the
+ whole sentence in NMEA 0183)*/
+#define NMEA_MAXIMUM_LENGTH         80
+/** Maximum number of fields of a sentence, the address field included*/
+#define NMEA_MAXIMUM_FIELDS         24
+
+/** Conversion of the fixed point values to floating point, only for the
+ code that needs it (there is no floating point in the library).*/
+#define NMEA_DEGREES(fixed)         ((double) (fixed) / 10000000.0)
+#define NMEA_HUNDREDTHS(fixed)      ((double) (fixed) / 100.0)
+
+/** Identifier of a sentence type, from the three letters after the talker
+ (5 bits each), so the decoder is picked with a switch.*/
+#define NMEA_ID(a, b, c)            ((((unsigned int) (a) & 0x1F) << 10) | \
+                                     (((unsigned int) (b) & 0x1F) << 5) | \
+                                     ((unsigned int) (c) & 0x1F))
+#define NMEA_RMC                    NMEA_ID('R', 'M', 'C')
+#define NMEA_GGA                    NMEA_ID('G', 'G', 'A')
+#define NMEA_GSA                    NMEA_ID('G', 'S', 'A')
+#define NMEA_GSV                    NMEA_ID('G', 'S', 'V')
+#define NMEA_VTG                    NMEA_ID('V', 'T', 'G')
+
+/** Number of satellites of a GSA sentence*/
+#define NMEA_GSA_SATELLITES         12
+/** Number of satellites of a GSV sentence*/
+#define NMEA_GSV_SATELLITES         4
+
+/**
+ * State of the byte at a time parser.
+ */
+typedef enum
+{
+    /** Waiting for the '$' that starts a sentence*/
+    NMEA_WAIT_START,
+    /** Receiving the fields*/
+    NMEA_DATA,
+    /** First digit of the checksum*/
+    NMEA_CHECKSUM_HIGH,
+    /** Second digit of the checksum*/
+    NMEA_CHECKSUM_LOW,
+    /** Waiting for the <CR><LF>*/
+    NMEA_END
+} nmeaParserState;
+
+/**
+ * Sentence being received by nmeaParseByte(). The commas are replaced by
+ * '\0' as they arrive, so every field is a string in the buffer, and the
+ * start of every field is recorded: a field is reached by its number, and
+ * its length known, in O(1) whatever the precision of the fields before it
+ * or if they are empty.
+ */
+typedef struct _nmeaParser
+{
+    /** Fields of the sentence, without the '$' and the '*'*/
+    char Buffer[NMEA_MAXIMUM_LENGTH + 1];
+    /** Number of characters in the buffer*/
+    unsigned char Length;
+    /** Position of every field in the buffer*/
+    unsigned char Field[NMEA_MAXIMUM_FIELDS];
+    /** Number of fields received*/
+    unsigned char Fields;
+    /** XOR of the characters received, computed on the fly*/
+    unsigned char Checksum;
+    /** Checksum present on the sentence*/
+    unsigned char ChecksumReceived;
+    /** State of the parser*/
+    nmeaParserState State;
+    /** Second letter of the talker of the last sentence (GP = GPS,
+     GL = GLONASS, GA = Galileo, GN = several constellations)*/
+    char Talker;
+    /** Type of the last sentence, NMEA_RMC, NMEA_GGA..., 0 if unknown*/
+    unsigned int Sentence;
+} nmeaParser;
 
 /**
  * RMC packet information structure (Recommended Minimum sentence C)
@@ -61,20 +144,21 @@ typedef struct _nmeaGPRMC
 
     /** Status (A = active or V = Invalid) */
     char Status;
-    /** Latitude in NDEG - [degree][min].[sec/60] */
-    double Latitude;
+    /** Latitude in 1e-7 degrees, positive to the North */
+    long Latitude;
     /** [N]orth or [S]outh */
     char North_South;
-    /** Longitude in NDEG - [degree][min].[sec/60] */
-    double Longitude;
+    /** Longitude in 1e-7 degrees, positive to the East */
+    long Longitude;
     /** [E]ast or [W]est */
     char East_West;
-    /** Speed over the ground in knots */
-    double Speed;
-    /** True course angle in degrees */
-    double True_Course;
-    /** Magnetic variation degrees (Easterly var. subtracts from true course)*/
-    double Declination;
+    /** Speed over the ground in 1/100 knots */
+    unsigned long Speed;
+    /** True course angle in 1/100 degrees */
+    unsigned int True_Course;
+    /** Magnetic variation in 1/100 degrees (Easterly var. subtracts from
+     true course)*/
+    unsigned int Declination;
     /** [E]ast or [W]est */
     char Declination_Direction;
     /** Mode indicator of fix type (A = autonomous, D = differential,
@@ -85,10 +169,142 @@ typedef struct _nmeaGPRMC
 
 } nmeaGPRMC;
 
+/**
+ * GGA packet information structure (Global positioning system fix data)
+ */
+typedef struct _nmeaGGA
+{
+    /** UTC of position*/
+    struct
+    {
+        /** Hours since midnight - [0,23] */
+        unsigned char Hour;
+        /** Minutes after the hour - [0,59] */
+        unsigned char Minutes;
+        /** Seconds after the minute - [0,59] */
+        unsigned char Seconds;
+    } UTC;
+
+    /** Latitude in 1e-7 degrees, positive to the North */
+    long Latitude;
+    /** Longitude in 1e-7 degrees, positive to the East */
+    long Longitude;
+    /** Fix quality (0 = invalid, 1 = GPS, 2 = DGPS...) */
+    unsigned char Quality;
+    /** Number of satellites in use */
+    unsigned char Satellites;
+    /** Horizontal dilution of precision in 1/100 */
+    unsigned int HDOP;
+    /** Altitude above the mean sea level in cm */
+    long Altitude;
+    /** Height of the geoid above the WGS84 ellipsoid in cm */
+    long Geoid_Separation;
+
+} nmeaGGA;
+
+/**
+ * GSA packet information structure (DOP and active satellites)
+ */
+typedef struct _nmeaGSA
+{
+    /** Selection mode (M = manual, A = automatic) */
+    char Mode;
+    /** Fix type (1 = none, 2 = 2D, 3 = 3D) */
+    unsigned char Fix_Type;
+    /** PRN of the satellites used, 0 for the empty fields */
+    unsigned char Satellite[NMEA_GSA_SATELLITES];
+    /** Dilutions of precision in 1/100 */
+    unsigned int PDOP;
+    unsigned int HDOP;
+    unsigned int VDOP;
+
+} nmeaGSA;
+
+/**
+ * GSV packet information structure (Satellites in view), one message of
+ * the sequence, up to four satellites.
+ */
+typedef struct _nmeaGSV
+{
+    /** Number of messages of the sequence */
+    unsigned char Messages;
+    /** Number of this message - [1,Messages] */
+    unsigned char Message;
+    /** Total number of satellites in view */
+    unsigned char Satellites_In_View;
+    /** Satellites of this message, Count of them are valid */
+    unsigned char Count;
+
+    struct
+    {
+        /** Satellite PRN number */
+        unsigned char PRN;
+        /** Elevation in degrees - [0,90] */
+        unsigned char Elevation;
+        /** Azimuth in degrees - [0,359] */
+        unsigned int Azimuth;
+        /** Signal to noise ratio in dB, 0 if not tracking */
+        unsigned char SNR;
+    } Satellite[NMEA_GSV_SATELLITES];
+
+} nmeaGSV;
+
+/**
+ * VTG packet information structure (Track made good and ground speed)
+ */
+typedef struct _nmeaVTG
+{
+    /** True course in 1/100 degrees */
+    unsigned int True_Course;
+    /** Magnetic course in 1/100 degrees */
+    unsigned int Magnetic_Course;
+    /** Speed over the ground in 1/100 knots */
+    unsigned long Speed_Knots;
+    /** Speed over the ground in 1/100 km/h */
+    unsigned long Speed_Kmh;
+    /** Mode indicator (A = autonomous, D = differential, E = estimated,
+     * N = not valid) */
+    char Mode;
+
+} nmeaVTG;
+
+extern nmeaParser NMEA;
+#ifdef NMEA_USE_RMC
 extern nmeaGPRMC GPRMC;
+#endif
+#ifdef NMEA_USE_GGA
+extern nmeaGGA GGA;
+#endif
+#ifdef NMEA_USE_GSA
+extern nmeaGSA GSA;
+#endif
+#ifdef NMEA_USE_GSV
+extern nmeaGSV GSV;
+#endif
+#ifdef NMEA_USE_VTG
+extern nmeaVTG VTG;
+#endif
 
+void nmeaParserReset(void);
+bool nmeaParseByte(char c);
+char *nmeaGetField(unsigned char field);
+unsigned char nmeaGetFieldLength(unsigned char field);
 bool nmeaParseSentence(char *sentence);
-bool nmeaParseGPRMC(char *sentence);
+#ifdef NMEA_USE_RMC
+bool nmeaParseGPRMC(void);
+#endif
+#ifdef NMEA_USE_GGA
+bool nmeaParseGGA(void);
+#endif
+#ifdef NMEA_USE_GSA
+bool nmeaParseGSA(void);
+#endif
+#ifdef NMEA_USE_GSV
+bool nmeaParseGSV(void);
+#endif
+#ifdef NMEA_USE_VTG
+bool nmeaParseVTG(void);
+#endif
 char nmeaCalculateChecksum(char * sentence);
 char nmeaGetChecksumReceived(char *sentence);
 
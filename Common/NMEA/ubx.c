@@ -0,0 +1,403 @@
+/**
+ *  @file       ubx.c
+ *  @author     Luis Maduro
+ *  @version    1.00
+ *  @date       14/10/2026
+ *  @brief      u-blox UBX binary protocol decoding, alongside the NMEA
+ *              library.
+ *
+ *  Copyright (C) 2026  Luis Maduro
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "NMEA/ubx.h"
+
+/** Bits of the valid field of NAV-PVT*/
+#define UBX_PVT_VALID_DATE          0x01
+#define UBX_PVT_VALID_TIME          0x02
+#define UBX_PVT_VALID_MAG           0x08
+/** Bits of the flags field of NAV-PVT*/
+#define UBX_PVT_FIX_OK              0x01
+#define UBX_PVT_DIFF_SOLN           0x02
+/** Fix types of NAV-PVT*/
+#define UBX_FIX_NONE                0
+#define UBX_FIX_DEAD_RECKONING      1
+#define UBX_FIX_TIME_ONLY           5
+/** Bit of the valid field of NAV-TIMEUTC*/
+#define UBX_TIMEUTC_VALID_UTC       0x04
+
+ubxParser UBX;
+
+static uint16_t ubxU2(uint8_t offset);
+static uint32_t ubxU4(uint8_t offset);
+static bool ubxDecodeMessage(void);
+
+/**
+ * Drops the message being received, the parser waits for the next sync.
+ */
+void ubxParserReset(void)
+{
+    UBX.State = UBX_WAIT_SYNC1;
+}
+
+/**
+ * Feeds one byte to the parser, from the USART interrupt or from a uFIFO.
+ * @param c Byte received.
+ * @return True when a message with a valid checksum was completed by this
+ *         byte and decoded: NAV-PVT, NAV-TIMEUTC or a message that fits in
+ *         UBX.Payload, UBX.Class and UBX.Id tell which one.
+ */
+bool ubxParseByte(uint8_t c)
+{
+    switch (UBX.State)
+    {
+        case UBX_WAIT_SYNC1:
+            if (c == UBX_SYNC1)
+            {
+                UBX.State = UBX_WAIT_SYNC2;
+            }
+            return false;
+
+        case UBX_WAIT_SYNC2:
+            if (c == UBX_SYNC2)
+            {
+                UBX.CheckA = 0;
+                UBX.CheckB = 0;
+                UBX.State = UBX_CLASS;
+            }
+            else if (c != UBX_SYNC1)
+            {
+                UBX.State = UBX_WAIT_SYNC1;
+            }
+            return false;
+
+        case UBX_CHECKSUM_A:
+            UBX.State = (c == UBX.CheckA) ? UBX_CHECKSUM_B : UBX_WAIT_SYNC1;
+            return false;
+
+        case UBX_CHECKSUM_B:
+            UBX.State = UBX_WAIT_SYNC1;
+
+            if ((c != UBX.CheckB) || (UBX.Length > UBX_MAXIMUM_LENGTH))
+            {
+                return false;
+            }
+
+            return ubxDecodeMessage();
+
+        default:
+            break;
+    }
+
+    //the checksum covers the class, the id, the length and the payload
+    UBX.CheckA += c;
+    UBX.CheckB += UBX.CheckA;
+
+    switch (UBX.State)
+    {
+        case UBX_CLASS:
+            UBX.Class = c;
+            UBX.State = UBX_ID;
+            break;
+
+        case UBX_ID:
+            UBX.Id = c;
+            UBX.State = UBX_LENGTH_LOW;
+            break;
+
+        case UBX_LENGTH_LOW:
+            UBX.Length = c;
+            UBX.State = UBX_LENGTH_HIGH;
+            break;
+
+        case UBX_LENGTH_HIGH:
+            UBX.Length |= (uint16_t) c << 8;
+            UBX.Count = 0;
+            UBX.State = (UBX.Length == 0) ? UBX_CHECKSUM_A : UBX_PAYLOAD;
+            break;
+
+        default:
+            //a payload too long is only checked, not kept
+            if (UBX.Count < UBX_MAXIMUM_LENGTH)
+            {
+                UBX.Payload[UBX.Count] = c;
+            }
+
+            if (++UBX.Count == UBX.Length)
+            {
+                UBX.State = UBX_CHECKSUM_A;
+            }
+            break;
+    }
+
+    return false;
+}
+
+/**
+ * Reads a little endian field of the payload.
+ */
+static uint16_t ubxU2(uint8_t offset)
+{
+    return (uint16_t) UBX.Payload[offset] | ((uint16_t) UBX.Payload[offset + 1] << 8);
+}
+
+static uint32_t ubxU4(uint8_t offset)
+{
+    return (uint32_t) ubxU2(offset) | ((uint32_t) ubxU2(offset + 2) << 16);
+}
+
+/**
+ * Decodes the message received if it is one of the NAV messages.
+ */
+static bool ubxDecodeMessage(void)
+{
+    if (UBX.Class == UBX_CLASS_NAV)
+    {
+        switch (UBX.Id)
+        {
+            case UBX_NAV_PVT:
+                return ubxParseNavPVT();
+            case UBX_NAV_TIMEUTC:
+                return ubxParseNavTimeUTC();
+            default:
+                break;
+        }
+    }
+
+    return true;
+}
+
+/**
+ * Decodes the last message received as a NAV-PVT message into GPRMC, and
+ * GGA.
+ * @return True if the message has the length of NAV-PVT.
+ */
+bool ubxParseNavPVT(void)
+{
+    uint8_t valid;
+    uint8_t fixType;
+    uint8_t flags;
+    int16_t declination;
+#ifdef NMEA_USE_GGA
+    long value;
+#endif
+
+    if (UBX.Length < UBX_NAV_PVT_LENGTH)
+        return false;
+
+    valid = UBX.Payload[11];
+    fixType = UBX.Payload[20];
+    flags = UBX.Payload[21];
+
+    if (valid & UBX_PVT_VALID_DATE)
+    {
+        GPRMC.UTC.Year = (unsigned char) (ubxU2(4) - 1900);
+        GPRMC.UTC.Month = UBX.Payload[6] - 1;
+        GPRMC.UTC.Day = UBX.Payload[7];
+    }
+
+    if (valid & UBX_PVT_VALID_TIME)
+    {
+        GPRMC.UTC.Hour = UBX.Payload[8];
+        GPRMC.UTC.Minutes = UBX.Payload[9];
+        GPRMC.UTC.Seconds = UBX.Payload[10];
+    }
+
+    GPRMC.Status = ((flags & UBX_PVT_FIX_OK) && (fixType != UBX_FIX_NONE)
+                    && (fixType != UBX_FIX_TIME_ONLY)) ? 'A' : 'V';
+
+    //the same 1e-7 degrees as the decoder of the sentences
+    GPRMC.Longitude = (long) (int32_t) ubxU4(24);
+    GPRMC.Latitude = (long) (int32_t) ubxU4(28);
+    GPRMC.North_South = (GPRMC.Latitude < 0) ? 'S' : 'N';
+    GPRMC.East_West = (GPRMC.Longitude < 0) ? 'W' : 'E';
+
+    //mm/s to 1/100 knots, 1 m/s is 1.9438 knots
+    GPRMC.Speed = (unsigned long) ((uint32_t) (int32_t) ubxU4(60) / 10 * 1944 / 1000);
+    //1e-5 to 1/100 degrees
+    GPRMC.True_Course = (unsigned int) ((uint32_t) (int32_t) ubxU4(64) / 1000);
+
+    if (valid & UBX_PVT_VALID_MAG)
+    {
+        declination = (int16_t) ubxU2(88);
+        GPRMC.Declination = (unsigned int) ((declination < 0) ? -declination : declination);
+        GPRMC.Declination_Direction = (declination < 0) ? 'W' : 'E';
+    }
+    else
+    {
+        //as an empty field of a sentence
+        GPRMC.Declination = 0;
+        GPRMC.Declination_Direction = '\0';
+    }
+
+    if (fixType == UBX_FIX_NONE)
+    {
+        GPRMC.Mode = 'N';
+    }
+    else if (fixType == UBX_FIX_DEAD_RECKONING)
+    {
+        GPRMC.Mode = 'E';
+    }
+    else
+    {
+        GPRMC.Mode = (flags & UBX_PVT_DIFF_SOLN) ? 'D' : 'A';
+    }
+
+    //no sentence was received, so no checksum
+    GPRMC.Checksum = 0;
+
+#ifdef NMEA_USE_GGA
+    GGA.UTC.Hour = GPRMC.UTC.Hour;
+    GGA.UTC.Minutes = GPRMC.UTC.Minutes;
+    GGA.UTC.Seconds = GPRMC.UTC.Seconds;
+    GGA.Latitude = GPRMC.Latitude;
+    GGA.Longitude = GPRMC.Longitude;
+
+    if (GPRMC.Status != 'A')
+    {
+        GGA.Quality = 0;
+    }
+    else if (fixType == UBX_FIX_DEAD_RECKONING)
+    {
+        GGA.Quality = 6;
+    }
+    else
+    {
+        GGA.Quality = (flags & UBX_PVT_DIFF_SOLN) ? 2 : 1;
+    }
+
+    GGA.Satellites = UBX.Payload[23];
+    //mm to cm, the height above the ellipsoid less the one above the sea
+    value = (long) (int32_t) ubxU4(36);
+    GGA.Altitude = value / 10;
+    GGA.Geoid_Separation = ((long) (int32_t) ubxU4(32) - value) / 10;
+#endif
+
+    return true;
+}
+
+/**
+ * Decodes the last message received as a NAV-TIMEUTC message into the time
+ * of GPRMC.
+ * @return True if the message has the length of NAV-TIMEUTC.
+ */
+bool ubxParseNavTimeUTC(void)
+{
+    if (UBX.Length < UBX_NAV_TIMEUTC_LENGTH)
+        return false;
+
+    if (UBX.Payload[19] & UBX_TIMEUTC_VALID_UTC)
+    {
+        GPRMC.UTC.Year = (unsigned char) (ubxU2(12) - 1900);
+        GPRMC.UTC.Month = UBX.Payload[14] - 1;
+        GPRMC.UTC.Day = UBX.Payload[15];
+        GPRMC.UTC.Hour = UBX.Payload[16];
+        GPRMC.UTC.Minutes = UBX.Payload[17];
+        GPRMC.UTC.Seconds = UBX.Payload[18];
+    }
+
+    return true;
+}
+
+/**
+ * Builds a message to send to the receiver.
+ * @param buffer Where to build it, UBX_MESSAGE_LENGTH(length) bytes.
+ * @param messageClass Class.
+ * @param id Id.
+ * @param payload Payload, NULL if it is already in buffer + 6.
+ * @param length Bytes of the payload.
+ * @return Bytes of the message.
+ */
+unsigned int ubxBuildMessage(uint8_t *buffer, uint8_t messageClass, uint8_t id,
+                             const uint8_t *payload, uint16_t length)
+{
+    uint8_t checkA = 0;
+    uint8_t checkB = 0;
+    uint16_t i;
+
+    buffer[0] = UBX_SYNC1;
+    buffer[1] = UBX_SYNC2;
+    buffer[2] = messageClass;
+    buffer[3] = id;
+    buffer[4] = (uint8_t) length;
+    buffer[5] = (uint8_t) (length >> 8);
+
+    for (i = 0; payload != NULL && i < length; i++)
+    {
+        buffer[6 + i] = payload[i];
+    }
+
+    for (i = 2; i < length + 6; i++)
+    {
+        checkA += buffer[i];
+        checkB += checkA;
+    }
+
+    buffer[length + 6] = checkA;
+    buffer[length + 7] = checkB;
+
+    return UBX_MESSAGE_LENGTH(length);
+}
+
+/**
+ * Builds a CFG-PRT message that sets the UART 1 of the receiver to UBX out
+ * only, UBX and NMEA in, 8N1.
+ * @param buffer Where to build it, UBX_MESSAGE_LENGTH(UBX_CFG_PRT_LENGTH) bytes.
+ * @param baudRate Baud rate, the current one to keep the link.
+ * @return Bytes of the message.
+ */
+unsigned int ubxConfigurePort(uint8_t *buffer, uint32_t baudRate)
+{
+    uint8_t *payload = &buffer[6];
+    uint8_t i;
+
+    for (i = 0; i < UBX_CFG_PRT_LENGTH; i++)
+    {
+        payload[i] = 0;
+    }
+
+    //port 1, mode 0x000008D0 (8 bits, no parity, 1 stop)
+    payload[0] = 1;
+    payload[4] = 0xD0;
+    payload[5] = 0x08;
+    payload[8] = (uint8_t) baudRate;
+    payload[9] = (uint8_t) (baudRate >> 8);
+    payload[10] = (uint8_t) (baudRate >> 16);
+    payload[11] = (uint8_t) (baudRate >> 24);
+    //in UBX and NMEA, out UBX
+    payload[12] = 0x03;
+    payload[14] = 0x01;
+
+    return ubxBuildMessage(buffer, UBX_CLASS_CFG, UBX_CFG_PRT, NULL, UBX_CFG_PRT_LENGTH);
+}
+
+/**
+ * Builds a CFG-MSG message that sets the rate of a message on the current
+ * port.
+ * @param buffer Where to build it, UBX_MESSAGE_LENGTH(UBX_CFG_MSG_LENGTH) bytes.
+ * @param messageClass Class of the message, i.e. UBX_CLASS_NAV.
+ * @param id Id of the message, i.e. UBX_NAV_PVT.
+ * @param rate One message every rate solutions, 0 to stop it.
+ * @return Bytes of the message.
+ */
+unsigned int ubxConfigureRate(uint8_t *buffer, uint8_t messageClass, uint8_t id,
+                              uint8_t rate)
+{
+    buffer[6] = messageClass;
+    buffer[7] = id;
+    buffer[8] = rate;
+
+    return ubxBuildMessage(buffer, UBX_CLASS_CFG, UBX_CFG_MSG, NULL, UBX_CFG_MSG_LENGTH);
+}
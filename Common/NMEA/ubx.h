@@ -0,0 +1,137 @@
+/**
+ *  @file       ubx.h
+ *  @author     Luis Maduro
+ *  @version    1.00
+ *  @date       14/10/2026
+ *  @brief      u-blox UBX binary protocol decoding, alongside the NMEA
+ *              library.
+ *
+ *  A UBX message is 0xB5 0x62, a class, an id, a little endian length, the
+ *  payload and a Fletcher checksum of 2 bytes over the class to the end of
+ *  the payload. The fields of the payload have fixed places and sizes, so
+ *  decoding is reading integers: there is no text to split or to convert.
+ *  ubxParseByte() takes the bytes one at a time like nmeaParseByte(), from
+ *  the same USART, and the two can be fed every byte: the UBX sync never
+ *  starts a sentence and a '$' in a payload only starts a sentence whose
+ *  checksum fails.
+ *
+ *  NAV-PVT fills GPRMC, in the units of the NMEA decoder, and GGA when
+ *  NMEA_USE_GGA is defined (PVT gives no HDOP, GGA.HDOP is left as it is).
+ *  GPRMC.Checksum is 0, it is the one of a received sentence only.
+ *  NAV-TIMEUTC fills the time of GPRMC. The receiver is switched to these
+ *  messages with the buffers built by ubxConfigurePort() and
+ *  ubxConfigureRate(), written to its USART as they are:
+ *  @code
+ *  uint8_t message[UBX_MESSAGE_LENGTH(UBX_CFG_PRT_LENGTH)];
+ *
+ *  UARTWrite(message, ubxConfigurePort(message, 9600));
+ *  UARTWrite(message, ubxConfigureRate(message, UBX_CLASS_NAV, UBX_NAV_PVT, 1));
+ *  UARTWrite(message, ubxConfigureRate(message, UBX_CLASS_NAV, UBX_NAV_TIMEUTC, 1));
+ *  @endcode
+ *  Each one is acknowledged by an ACK-ACK (UBX.Class is UBX_CLASS_ACK,
+ *  UBX.Id UBX_ACK_ACK, the class and id acknowledged are the payload).
+ *
+ *  Copyright (C) 2026  Luis Maduro
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef UBX_H
+#define UBX_H
+
+#include <stdint.h>
+#include "NMEA/nmea.h"
+
+#ifndef NMEA_USE_RMC
+#error "ubx: NMEA_USE_RMC is needed for GPRMC"
+#endif
+
+/** Sync characters of a message*/
+#define UBX_SYNC1                   0xB5
+#define UBX_SYNC2                   0x62
+
+/** Classes and ids of the messages used*/
+#define UBX_CLASS_NAV               0x01
+#define UBX_CLASS_ACK               0x05
+#define UBX_CLASS_CFG               0x06
+#define UBX_NAV_PVT                 0x07
+#define UBX_NAV_TIMEUTC             0x21
+#define UBX_ACK_NAK                 0x00
+#define UBX_ACK_ACK                 0x01
+#define UBX_CFG_PRT                 0x00
+#define UBX_CFG_MSG                 0x01
+
+/** Payload lengths*/
+#define UBX_NAV_PVT_LENGTH          92
+#define UBX_NAV_TIMEUTC_LENGTH      20
+#define UBX_CFG_PRT_LENGTH          20
+#define UBX_CFG_MSG_LENGTH          3
+
+/** Longest payload kept, the longer messages are skipped*/
+#define UBX_MAXIMUM_LENGTH          UBX_NAV_PVT_LENGTH
+
+/** Bytes of a message with its sync, header and checksum*/
+#define UBX_MESSAGE_LENGTH(payload) ((payload) + 8)
+
+/**
+ * State of the byte at a time parser.
+ */
+typedef enum
+{
+    /** Waiting for the first sync character*/
+    UBX_WAIT_SYNC1,
+    UBX_WAIT_SYNC2,
+    UBX_CLASS,
+    UBX_ID,
+    UBX_LENGTH_LOW,
+    UBX_LENGTH_HIGH,
+    UBX_PAYLOAD,
+    UBX_CHECKSUM_A,
+    UBX_CHECKSUM_B
+} ubxParserState;
+
+/**
+ * Message being received by ubxParseByte().
+ */
+typedef struct _ubxParser
+{
+    /** Payload of the last message, if it fits*/
+    uint8_t Payload[UBX_MAXIMUM_LENGTH];
+    /** Class and id of the last message*/
+    uint8_t Class;
+    uint8_t Id;
+    /** Length of the payload*/
+    uint16_t Length;
+    /** Bytes of the payload received*/
+    uint16_t Count;
+    /** Fletcher checksum computed on the fly*/
+    uint8_t CheckA;
+    uint8_t CheckB;
+    /** State of the parser*/
+    ubxParserState State;
+} ubxParser;
+
+extern ubxParser UBX;
+
+void ubxParserReset(void);
+bool ubxParseByte(uint8_t c);
+bool ubxParseNavPVT(void);
+bool ubxParseNavTimeUTC(void);
+unsigned int ubxBuildMessage(uint8_t *buffer, uint8_t messageClass, uint8_t id,
+                             const uint8_t *payload, uint16_t length);
+unsigned int ubxConfigurePort(uint8_t *buffer, uint32_t baudRate);
+unsigned int ubxConfigureRate(uint8_t *buffer, uint8_t messageClass, uint8_t id,
+                              uint8_t rate);
+
+#endif
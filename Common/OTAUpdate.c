@@ -0,0 +1,678 @@
+/**
+ *  @file       OTAUpdate.c
+ *  @author     Luis Maduro
+ *  @version    1.00
+ *  @date       14/10/2026
+ *  @brief      Firmware images over the radio, staged in the SST25VF064C.
+ *
+ *  Copyright (C) 2026  Luis Maduro
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "OTAUpdate.h"
+#include "CRCDevice.h"
+#include "uKernel/uKernel.h"
+
+/**First byte of the frames, then the session.*/
+#define OTA_BEGIN                   0xA0
+#define OTA_DATA                    0xA1
+/**A block that asks for an acknowledgement.*/
+#define OTA_DATA_ACK                0xA2
+#define OTA_END                     0xA3
+#define OTA_ACK                     0xA8
+
+/**Type and session, then the block number for the blocks.*/
+#define OTA_HEADER_LENGTH           2
+#define OTA_DATA_HEADER             4
+#define OTA_BEGIN_LENGTH            10
+#define OTA_ACK_LENGTH              9
+
+/**Receiver.*/
+static tOTAUpdateSend sendFunction;
+static tOTAUpdateState state = OTA_UPDATE_IDLE;
+static uint32_t stagingAddress;
+static uint32_t stagingSize;
+static unsigned int sender;
+static uint8_t session;
+static uint32_t imageSize;
+static uint32_t imageCRC;
+static uint16_t blocks;
+/**First block missing and the blocks after it already written, bit 0 is
+ base itself.*/
+static uint16_t base;
+static uint32_t bitmap;
+/**Next sector to erase, then next byte to read back for the CRC.*/
+static uint32_t position;
+static uint32_t crc;
+static uint32_t lastFrame;
+static bool ackPending;
+
+/**Sender.*/
+static tOTAUpdateState senderState = OTA_UPDATE_IDLE;
+static tOTAUpdateRead readFunction;
+static unsigned int receiver;
+static uint8_t senderSession;
+static uint32_t senderSize;
+static uint32_t senderCRC;
+static uint16_t senderBlocks;
+static uint16_t senderBase;
+static uint32_t senderBitmap;
+/**Next block to send, from senderBase.*/
+static uint16_t next;
+static unsigned char retries;
+static uint32_t sentTime;
+/**The frame is sent from the start again.*/
+static bool restart;
+
+static uint8_t frame[OTA_DATA_HEADER + OTA_UPDATE_BLOCK_SIZE];
+
+/**
+ * Writes a 32 bit value, little endian.
+ * @param buffer Where to write it.
+ * @param value Value.
+ */
+static void OTAUpdatePut32(uint8_t *buffer, uint32_t value)
+{
+    buffer[0] = (uint8_t) value;
+    buffer[1] = (uint8_t) (value >> 8);
+    buffer[2] = (uint8_t) (value >> 16);
+    buffer[3] = (uint8_t) (value >> 24);
+}
+
+static uint32_t OTAUpdateGet32(const uint8_t *buffer)
+{
+    return (uint32_t) buffer[0] | ((uint32_t) buffer[1] << 8)
+            | ((uint32_t) buffer[2] << 16) | ((uint32_t) buffer[3] << 24);
+}
+
+/**
+ * Gives the bytes of a block, the last one may be shorter.
+ * @param size Bytes of the image.
+ * @param block Block.
+ */
+static uint8_t OTAUpdateBlockLength(uint32_t size, uint16_t block)
+{
+    uint32_t left = size - (uint32_t) block * OTA_UPDATE_BLOCK_SIZE;
+
+    return (left < OTA_UPDATE_BLOCK_SIZE) ? (uint8_t) left : OTA_UPDATE_BLOCK_SIZE;
+}
+
+/**
+ * Sets up the receiver.
+ * @param staging Address of the staging region in the flash, at the start of
+ *                a sector.
+ * @param size Bytes of the staging region, the header sector included.
+ * @param send Sends a frame.
+ */
+void OTAUpdateInit(uint32_t staging, uint32_t size, tOTAUpdateSend send)
+{
+    stagingAddress = staging;
+    stagingSize = size;
+    sendFunction = send;
+    state = OTA_UPDATE_IDLE;
+    senderState = OTA_UPDATE_IDLE;
+    CRCDeviceInit();
+}
+
+/**
+ * Sends the state of the receiver to the sender, again from OTAUpdateTasks()
+ * if the send function can't take it.
+ */
+static void OTAUpdateSendAck(void)
+{
+    uint8_t ack[OTA_ACK_LENGTH];
+
+    ack[0] = OTA_ACK;
+    ack[1] = session;
+    ack[2] = (uint8_t) state;
+    ack[3] = (uint8_t) base;
+    ack[4] = (uint8_t) (base >> 8);
+    OTAUpdatePut32(&ack[5], bitmap);
+
+    ackPending = !sendFunction(sender, ack, OTA_ACK_LENGTH);
+}
+
+/**
+ * Starts a transfer on the receiver.
+ */
+static void OTAUpdateBegin(unsigned int source, const uint8_t *data, uint8_t length)
+{
+    uint32_t size;
+
+    if (length < OTA_BEGIN_LENGTH)
+    {
+        return;
+    }
+
+    //the same BEGIN again, its acknowledgement was lost
+    if ((state != OTA_UPDATE_IDLE) && (source == sender) && (data[1] == session))
+    {
+        OTAUpdateSendAck();
+        return;
+    }
+
+    //a transfer of another sender is not dropped while it goes on
+    if (((state == OTA_UPDATE_ERASING) || (state == OTA_UPDATE_RECEIVING)
+         || (state == OTA_UPDATE_VERIFYING)) && (source != sender))
+    {
+        return;
+    }
+
+    size = OTAUpdateGet32(&data[2]);
+    sender = source;
+    session = data[1];
+    base = 0;
+    bitmap = 0;
+    lastFrame = _counterMs;
+
+    if ((size == 0) || (size > stagingSize - FLASH_SECTOR_SIZE))
+    {
+        state = OTA_UPDATE_ERROR;
+    }
+    else
+    {
+        imageSize = size;
+        imageCRC = OTAUpdateGet32(&data[6]);
+        blocks = (uint16_t) ((size + OTA_UPDATE_BLOCK_SIZE - 1) / OTA_UPDATE_BLOCK_SIZE);
+        position = stagingAddress;
+        state = OTA_UPDATE_ERASING;
+    }
+
+    OTAUpdateSendAck();
+}
+
+/**
+ * Writes a block to the flash if it is in the window and not written.
+ */
+static void OTAUpdateData(const uint8_t *data, uint8_t length, bool ack)
+{
+    uint16_t block = (uint16_t) data[2] | ((uint16_t) data[3] << 8);
+    uint16_t offset = block - base;
+
+    lastFrame = _counterMs;
+
+    if ((block < blocks) && (block >= base) && (offset < OTA_UPDATE_WINDOW)
+        && ((bitmap & (1UL << offset)) == 0)
+        && (length - OTA_DATA_HEADER == OTAUpdateBlockLength(imageSize, block)))
+    {
+        FlashWriteBuffer(OTAUpdateImageAddress(stagingAddress)
+                         + (uint32_t) block * OTA_UPDATE_BLOCK_SIZE,
+                         &data[OTA_DATA_HEADER], length - OTA_DATA_HEADER);
+        bitmap |= 1UL << offset;
+
+        while (bitmap & 1)
+        {
+            bitmap >>= 1;
+            base++;
+        }
+
+        if (base == blocks)
+        {
+            position = 0;
+            crc = CRC_DEVICE_INIT;
+            state = OTA_UPDATE_VERIFYING;
+        }
+    }
+
+    if (ack)
+    {
+        OTAUpdateSendAck();
+    }
+}
+
+/**
+ * Updates the sender with an acknowledgement.
+ */
+static void OTAUpdateAck(unsigned int source, const uint8_t *data, uint8_t length)
+{
+    uint16_t ackBase;
+
+    if ((length < OTA_ACK_LENGTH) || (senderState == OTA_UPDATE_IDLE)
+        || (source != receiver) || (data[1] != senderSession))
+    {
+        return;
+    }
+
+    ackBase = (uint16_t) data[3] | ((uint16_t) data[4] << 8);
+
+    switch ((tOTAUpdateState) data[2])
+    {
+        case OTA_UPDATE_ERASING:
+            //the BEGIN went through, not the erase
+            retries = 0;
+            sentTime = _counterMs;
+            break;
+        case OTA_UPDATE_RECEIVING:
+            if ((senderState != OTA_UPDATE_ERASING) && (senderState != OTA_UPDATE_SENDING))
+            {
+                break;
+            }
+
+            //an old acknowledgement, one of a window already moved
+            if (ackBase < senderBase)
+            {
+                break;
+            }
+
+            senderBase = ackBase;
+            senderBitmap = OTAUpdateGet32(&data[5]);
+
+            //what is missing is sent over, from the first one
+            next = 0;
+            retries = 0;
+            restart = false;
+            senderState = OTA_UPDATE_SENDING;
+            break;
+        case OTA_UPDATE_VERIFYING:
+            senderBase = senderBlocks;
+            senderState = OTA_UPDATE_VERIFYING;
+            retries = 0;
+            sentTime = _counterMs;
+            break;
+        case OTA_UPDATE_READY:
+            senderState = OTA_UPDATE_READY;
+            break;
+        default:
+            senderState = OTA_UPDATE_ERROR;
+            break;
+    }
+}
+
+/**
+ * Takes a frame received, call it for every frame of the radio.
+ * @param source Address of the sender.
+ * @param data Payload of the frame.
+ * @param length Bytes of the payload.
+ * @return True if it was a frame of this file, the application drops it.
+ */
+bool OTAUpdateReceive(unsigned int source, const uint8_t *data, uint8_t length)
+{
+    if (length < OTA_HEADER_LENGTH)
+    {
+        return false;
+    }
+
+    switch (data[0])
+    {
+        case OTA_BEGIN:
+            OTAUpdateBegin(source, data, length);
+            break;
+        case OTA_DATA:
+        case OTA_DATA_ACK:
+            if ((length > OTA_DATA_HEADER) && (source == sender) && (data[1] == session))
+            {
+                if (state == OTA_UPDATE_RECEIVING)
+                {
+                    OTAUpdateData(data, length, data[0] == OTA_DATA_ACK);
+                }
+                else if ((state != OTA_UPDATE_IDLE) && (data[0] == OTA_DATA_ACK))
+                {
+                    OTAUpdateSendAck();
+                }
+            }
+            break;
+        case OTA_END:
+            if ((state != OTA_UPDATE_IDLE) && (source == sender) && (data[1] == session))
+            {
+                lastFrame = _counterMs;
+                OTAUpdateSendAck();
+            }
+            break;
+        case OTA_ACK:
+            OTAUpdateAck(source, data, length);
+            break;
+        default:
+            return false;
+    }
+
+    return true;
+}
+
+/**
+ * Erases the staging region, one sector a call without waiting.
+ */
+static void OTAUpdateErase(void)
+{
+    if (FlashIsBusy())
+    {
+        return;
+    }
+
+    if (position < OTAUpdateImageAddress(stagingAddress) + imageSize)
+    {
+        FlashSector4KErase(position);
+        position += FLASH_SECTOR_SIZE;
+    }
+    else
+    {
+        state = OTA_UPDATE_RECEIVING;
+        OTAUpdateSendAck();
+    }
+}
+
+/**
+ * Reads back OTA_UPDATE_VERIFY_CHUNK bytes of the image for the CRC, then
+ * writes the header.
+ */
+static void OTAUpdateVerify(void)
+{
+    static uint8_t chunk[OTA_UPDATE_VERIFY_CHUNK];
+    uint32_t length = imageSize - position;
+    tOTAUpdateHeader header;
+
+    if (FlashIsBusy())
+    {
+        return;
+    }
+
+    if (length > OTA_UPDATE_VERIFY_CHUNK)
+    {
+        length = OTA_UPDATE_VERIFY_CHUNK;
+    }
+
+    FlashReadBuffer(OTAUpdateImageAddress(stagingAddress) + position, chunk, length);
+    crc = CRCDeviceCompute(crc, chunk, length);
+    position += length;
+
+    if (position < imageSize)
+    {
+        return;
+    }
+
+    if (crc == imageCRC)
+    {
+        header.Magic = OTA_UPDATE_MAGIC;
+        header.Size = imageSize;
+        header.CRC = imageCRC;
+        header.Applied = 0xFFFFFFFFUL;
+        FlashWriteBuffer(stagingAddress, (const uint8_t *) &header, sizeof (header));
+        state = OTA_UPDATE_READY;
+    }
+    else
+    {
+        state = OTA_UPDATE_ERROR;
+    }
+
+    OTAUpdateSendAck();
+}
+
+/**
+ * Sends the next frame of the sender, returns false if the send function
+ * can't take it.
+ */
+static bool OTAUpdateSenderSend(void)
+{
+    uint16_t block;
+    uint16_t last;
+    uint8_t length;
+
+    if (senderState == OTA_UPDATE_ERASING)
+    {
+        frame[0] = OTA_BEGIN;
+        frame[1] = senderSession;
+        OTAUpdatePut32(&frame[2], senderSize);
+        OTAUpdatePut32(&frame[6], senderCRC);
+        length = OTA_BEGIN_LENGTH;
+    }
+    else if ((senderState == OTA_UPDATE_VERIFYING) || (senderBase == senderBlocks))
+    {
+        senderState = OTA_UPDATE_VERIFYING;
+        frame[0] = OTA_END;
+        frame[1] = senderSession;
+        length = OTA_HEADER_LENGTH;
+    }
+    else
+    {
+        //skips the blocks of the window the receiver has
+        while ((next < OTA_UPDATE_WINDOW) && (senderBitmap & (1UL << next)))
+        {
+            next++;
+        }
+
+        last = senderBlocks - senderBase;
+
+        if (last > OTA_UPDATE_WINDOW)
+        {
+            last = OTA_UPDATE_WINDOW;
+        }
+
+        if (next >= last)
+        {
+            //the window is out, waits for its acknowledgement
+            return true;
+        }
+
+        block = senderBase + next;
+        length = OTAUpdateBlockLength(senderSize, block);
+        readFunction((uint32_t) block * OTA_UPDATE_BLOCK_SIZE, &frame[OTA_DATA_HEADER], length);
+
+        //the acknowledgement is asked by the last block sent of the window
+        frame[0] = OTA_DATA;
+
+        while ((++next < last) && (senderBitmap & (1UL << next)))
+        {
+        }
+
+        if (next >= last)
+        {
+            frame[0] = OTA_DATA_ACK;
+        }
+
+        frame[1] = senderSession;
+        frame[2] = (uint8_t) block;
+        frame[3] = (uint8_t) (block >> 8);
+        length += OTA_DATA_HEADER;
+
+        if (!sendFunction(receiver, frame, length))
+        {
+            next = block - senderBase;
+            return false;
+        }
+
+        if (frame[0] == OTA_DATA_ACK)
+        {
+            sentTime = _counterMs;
+        }
+
+        return true;
+    }
+
+    if (!sendFunction(receiver, frame, length))
+    {
+        return false;
+    }
+
+    sentTime = _counterMs;
+
+    return true;
+}
+
+/**
+ * Runs the sender: the window is sent a block a call, then the sender waits
+ * for the acknowledgement and sends the window again from its first missing
+ * block if it doesn't come.
+ */
+static void OTAUpdateSenderTasks(void)
+{
+    uint16_t last;
+
+    if ((senderState != OTA_UPDATE_ERASING) && (senderState != OTA_UPDATE_SENDING)
+        && (senderState != OTA_UPDATE_VERIFYING))
+    {
+        return;
+    }
+
+    if (restart)
+    {
+        if (OTAUpdateSenderSend())
+        {
+            restart = false;
+        }
+
+        return;
+    }
+
+    last = senderBlocks - senderBase;
+
+    if (last > OTA_UPDATE_WINDOW)
+    {
+        last = OTA_UPDATE_WINDOW;
+    }
+
+    if ((senderState == OTA_UPDATE_SENDING) && (senderBase < senderBlocks) && (next < last))
+    {
+        OTAUpdateSenderSend();
+        return;
+    }
+
+    if ((uint32_t) (_counterMs - sentTime) < OTA_UPDATE_RETRY_MS)
+    {
+        return;
+    }
+
+    if (++retries > OTA_UPDATE_RETRIES)
+    {
+        senderState = OTA_UPDATE_ERROR;
+        return;
+    }
+
+    //the frame that asks for the acknowledgement was lost, or the answer
+    next = 0;
+    restart = !OTAUpdateSenderSend();
+}
+
+/**
+ * Erases, checks and retries, call it from the main loop or a task.
+ */
+void OTAUpdateTasks(void)
+{
+    if (ackPending)
+    {
+        OTAUpdateSendAck();
+    }
+
+    switch (state)
+    {
+        case OTA_UPDATE_ERASING:
+            OTAUpdateErase();
+            break;
+        case OTA_UPDATE_RECEIVING:
+            if ((uint32_t) (_counterMs - lastFrame) >= OTA_UPDATE_TIMEOUT_MS)
+            {
+                state = OTA_UPDATE_IDLE;
+            }
+            break;
+        case OTA_UPDATE_VERIFYING:
+            OTAUpdateVerify();
+            break;
+        default:
+            break;
+    }
+
+    OTAUpdateSenderTasks();
+}
+
+/**
+ * Gives the state of the receiver.
+ */
+tOTAUpdateState OTAUpdateGetState(void)
+{
+    return state;
+}
+
+/**
+ * Gives the bytes of the image the receiver has in a row from the start.
+ */
+uint32_t OTAUpdateGetProgress(void)
+{
+    uint32_t bytes = (uint32_t) base * OTA_UPDATE_BLOCK_SIZE;
+
+    if ((state == OTA_UPDATE_IDLE) || (state == OTA_UPDATE_ERROR))
+    {
+        return 0;
+    }
+
+    return (bytes > imageSize) ? imageSize : bytes;
+}
+
+/**
+ * Starts sending an image, OTAUpdateInit() gives the send function.
+ * @param dest Address of the receiver.
+ * @param size Bytes of the image.
+ * @param crc CRC-32 of CRCDevice.h of the image.
+ * @param read Reads the image.
+ * @return False if a transfer is going on.
+ */
+bool OTAUpdateStart(unsigned int dest, uint32_t size, uint32_t crc, tOTAUpdateRead read)
+{
+    if ((senderState == OTA_UPDATE_ERASING) || (senderState == OTA_UPDATE_SENDING)
+        || (senderState == OTA_UPDATE_VERIFYING) || (size == 0))
+    {
+        return false;
+    }
+
+    receiver = dest;
+    senderSize = size;
+    senderCRC = crc;
+    readFunction = read;
+    senderBlocks = (uint16_t) ((size + OTA_UPDATE_BLOCK_SIZE - 1) / OTA_UPDATE_BLOCK_SIZE);
+    senderBase = 0;
+    senderBitmap = 0;
+    next = 0;
+    retries = 0;
+    //a new session, the frames of an old transfer are not taken
+    senderSession = (uint8_t) (senderSession + 1 + (uint8_t) _counterMs);
+    senderState = OTA_UPDATE_ERASING;
+    restart = !OTAUpdateSenderSend();
+
+    return true;
+}
+
+/**
+ * Gives the state of the sender: OTA_UPDATE_ERASING until the receiver is
+ * ready, OTA_UPDATE_SENDING, OTA_UPDATE_VERIFYING after the last block,
+ * then OTA_UPDATE_READY or OTA_UPDATE_ERROR.
+ */
+tOTAUpdateState OTAUpdateGetSenderState(void)
+{
+    return senderState;
+}
+
+/**
+ * Reads the header of a staging region, without OTAUpdateInit() in the
+ * bootloader.
+ * @param staging Address of the staging region.
+ * @param header Where to put the header.
+ * @return True if there is a checked image not applied.
+ */
+bool OTAUpdateGetStaged(uint32_t staging, tOTAUpdateHeader *header)
+{
+    FlashReadBuffer(staging, (uint8_t *) header, sizeof (*header));
+
+    return (header->Magic == OTA_UPDATE_MAGIC) && (header->Applied == 0xFFFFFFFFUL);
+}
+
+/**
+ * Marks the image of a staging region as applied, the next transfer erases
+ * the header.
+ * @param staging Address of the staging region.
+ */
+void OTAUpdateSetApplied(uint32_t staging)
+{
+    uint8_t applied[4] = {0, 0, 0, 0};
+
+    FlashWriteBuffer(staging + 12, applied, 4);
+    FlashWaitForWrite();
+}
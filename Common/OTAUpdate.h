@@ -0,0 +1,171 @@
+/**
+ *  @file       OTAUpdate.h
+ *  @author     Luis Maduro
+ *  @version    1.00
+ *  @date       14/10/2026
+ *  @brief      Firmware images over the radio, staged in the SST25VF064C.
+ *
+ *  The sender (a gateway with the image) cuts the image in blocks of
+ *  OTA_UPDATE_BLOCK_SIZE bytes and sends OTA_UPDATE_WINDOW of them in a row
+ *  without waiting. The last one of the window asks for an
+ *  acknowledgement: the receiver answers with the first block it is
+ *  missing and a bitmap of the blocks it already has after it, and the
+ *  sender only sends the missing ones again before it moves the window. On
+ *  the receiver every block goes straight to its place in the staging
+ *  region of the flash with page programs, in any order, there is no
+ *  buffer of the image in RAM.
+ *
+ *  The staging region starts with a header sector followed by the image.
+ *  The region is erased sector by sector by OTAUpdateTasks() when the
+ *  transfer begins, the sender waits for the end of the erase. When all the
+ *  blocks are in, the image is read back and checked with the CRC of
+ *  CRCDevice.h, the same CRC-32 as FirmwareUpdate.c of the STM32F1, and
+ *  only then the header is written: a header whose magic is there describes
+ *  a checked image. The bootloader, or the application through
+ *  FirmwareUpdate.c, applies it:
+ *  @code
+ *  tOTAUpdateHeader header;
+ *
+ *  if (OTAUpdateGetStaged(OTA_STAGING, &header))
+ *  {
+ *      //copy OTAUpdateImageAddress(OTA_STAGING), header.Size bytes, to the
+ *      //flash of the MCU, check header.CRC, then
+ *      OTAUpdateSetApplied(OTA_STAGING);
+ *  }
+ *  @endcode
+ *  Applied is programmed to 0 without an erase, an image is applied once.
+ *
+ *  The frames go through any radio link with a send function of the
+ *  application, i.e. MRF24JMACSend() with a buffer of the packet pool or
+ *  RFM2xSendPacketTo(). The application gives every frame received to
+ *  OTAUpdateReceive(), it tells if it was one of this file. Both sides call
+ *  OTAUpdateTasks() from the main loop or a task.
+ *
+ *  Copyright (C) 2026  Luis Maduro
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef OTAUPDATE_H
+#define OTAUPDATE_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "SST25VF064C.h"
+
+/**Bytes of image in a frame, the frame takes 4 more. A divisor of
+ FLASH_PAGE_SIZE, so that a block is one page program.*/
+#ifndef OTA_UPDATE_BLOCK_SIZE
+#define OTA_UPDATE_BLOCK_SIZE       64
+#endif
+
+/**Blocks sent before an acknowledgement, up to 32.*/
+#ifndef OTA_UPDATE_WINDOW
+#define OTA_UPDATE_WINDOW           16
+#endif
+
+/**Time in ms the sender waits for an acknowledgement before it sends
+ again, and the times it does.*/
+#ifndef OTA_UPDATE_RETRY_MS
+#define OTA_UPDATE_RETRY_MS         250
+#endif
+#ifndef OTA_UPDATE_RETRIES
+#define OTA_UPDATE_RETRIES          20
+#endif
+
+/**Time in ms without a frame after which the receiver drops a transfer.*/
+#ifndef OTA_UPDATE_TIMEOUT_MS
+#define OTA_UPDATE_TIMEOUT_MS       30000UL
+#endif
+
+/**Bytes read back from the flash for the CRC by each OTAUpdateTasks(), a
+ multiple of 4 for CRCDeviceCompute().*/
+#ifndef OTA_UPDATE_VERIFY_CHUNK
+#define OTA_UPDATE_VERIFY_CHUNK     128
+#endif
+
+#if (OTA_UPDATE_WINDOW == 0) || (OTA_UPDATE_WINDOW > 32)
+#error "OTAUpdate: the window is 1 to 32 blocks"
+#endif
+
+#if (FLASH_PAGE_SIZE % OTA_UPDATE_BLOCK_SIZE) != 0
+#error "OTAUpdate: the block size must divide the page size"
+#endif
+
+/**Value of Magic of a header that describes a checked image.*/
+#define OTA_UPDATE_MAGIC            0x4F544131UL
+
+/**Address of the image in a staging region.*/
+#define OTAUpdateImageAddress(staging)  ((staging) + FLASH_SECTOR_SIZE)
+
+/**
+ * Header sector of a staging region.
+ */
+typedef struct
+{
+    uint32_t Magic;
+    /**Bytes of the image.*/
+    uint32_t Size;
+    /**CRC-32 of CRCDevice.h of the image.*/
+    uint32_t CRC;
+    /**0xFFFFFFFF until the image is applied, then 0.*/
+    uint32_t Applied;
+} tOTAUpdateHeader;
+
+/**
+ * State of a transfer, on the receiver and on the sender.
+ */
+typedef enum
+{
+    OTA_UPDATE_IDLE = 0,
+    /**The staging region is being erased.*/
+    OTA_UPDATE_ERASING,
+    OTA_UPDATE_RECEIVING,
+    /**All the blocks are in, the CRC is being computed.*/
+    OTA_UPDATE_VERIFYING,
+    /**Checked and staged, for the bootloader.*/
+    OTA_UPDATE_READY,
+    OTA_UPDATE_ERROR,
+    /**Sender only: blocks are being sent.*/
+    OTA_UPDATE_SENDING
+} tOTAUpdateState;
+
+/**
+ * Sends a frame over the radio.
+ * @param dest Address of the other side.
+ * @param data Frame.
+ * @param length Bytes of the frame.
+ * @return False if it could not be queued, it is sent again later.
+ */
+typedef bool (*tOTAUpdateSend)(unsigned int dest, const uint8_t *data, uint8_t length);
+
+/**
+ * Reads a part of the image on the sender.
+ * @param offset Offset in the image.
+ * @param data Where to put it.
+ * @param length Bytes to read.
+ */
+typedef void (*tOTAUpdateRead)(uint32_t offset, uint8_t *data, uint8_t length);
+
+void OTAUpdateInit(uint32_t staging, uint32_t size, tOTAUpdateSend send);
+bool OTAUpdateReceive(unsigned int source, const uint8_t *data, uint8_t length);
+void OTAUpdateTasks(void);
+tOTAUpdateState OTAUpdateGetState(void);
+uint32_t OTAUpdateGetProgress(void);
+bool OTAUpdateStart(unsigned int dest, uint32_t size, uint32_t crc, tOTAUpdateRead read);
+tOTAUpdateState OTAUpdateGetSenderState(void);
+bool OTAUpdateGetStaged(uint32_t staging, tOTAUpdateHeader *header);
+void OTAUpdateSetApplied(uint32_t staging);
+
+#endif /* OTAUPDATE_H */
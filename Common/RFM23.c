@@ -5,10 +5,35 @@ volatile unsigned int _txGood = 0;
 volatile unsigned char rssi = 0;
 volatile tInterruptStatus1 RFM2xITStatus1;
 volatile tInterruptStatus2 RFM2xITStatus2;
-volatile tPackageFormat RFM2xRXPacket;
-volatile tPackageFormat RFM2xTXPacket;
 volatile bool NewPacketReceived;
 
+/**Packet being sent, from the caller, and the bytes already in the FIFO.*/
+static const unsigned char *volatile txData;
+static volatile unsigned char txLength;
+static volatile unsigned char txIndex;
+static volatile bool txBusy = false;
+
+/**Packet being received and the bytes already read from the FIFO.*/
+static unsigned char rxBuffer[RFM2X_MAX_MESSAGE_LEN];
+static volatile unsigned char rxIndex;
+static volatile unsigned char rxLength;
+/**RSSI of the packet in rxBuffer.*/
+static volatile unsigned char rxRSSI;
+/**Sender of the packet in rxBuffer, its header 2.*/
+static volatile unsigned char rxSource;
+
+/**Address of the node, checked by the device in the header 3.*/
+static unsigned char ownAddress = RFM2X_ADDRESS;
+
+/**Register values of the channels and the current channel.*/
+static tRFM2xChannel channelTable[RFM2X_CHANNELS];
+static unsigned char channelCount = 0;
+static unsigned char channelCurrent = 0;
+
+/**Value of RFM2X_REG_05_INTERRUPT_ENABLE1, the TX FIFO almost empty
+ interrupt is only on while a packet is streamed.*/
+static unsigned char interruptEnable1;
+
 unsigned char RFM2xReadByte(unsigned char reg)
 {
     unsigned char val;
@@ -47,22 +72,119 @@ void RFM2xBurstWriteByte(unsigned char reg, unsigned char *src, unsigned char le
     WirelessDeselectChip();
 }
 
+/**
+ * Writes the next bytes of the packet being sent to the TX FIFO, as many as
+ * fit above the almost empty threshold. The almost empty interrupt is turned
+ * off with the last ones.
+ */
+static void RFM2xFillTXFIFO(void)
+{
+    unsigned char chunk = txLength - txIndex;
+
+    if (chunk > (RFM2X_FIFO_SIZE - RFM2X_TXFFAEM_THRESHOLD))
+    {
+        chunk = RFM2X_FIFO_SIZE - RFM2X_TXFFAEM_THRESHOLD;
+    }
+
+    RFM2xBurstWriteByte(RFM2X_REG_7F_FIFO_ACCESS, (unsigned char *) &txData[txIndex], chunk);
+    txIndex += chunk;
+
+    if (txIndex == txLength)
+    {
+        interruptEnable1 &= ~RFM2X_ENTXFFAEM;
+        RFM2xWriteByte(RFM2X_REG_05_INTERRUPT_ENABLE1, interruptEnable1);
+    }
+}
+
+/**
+ * Reads bytes of the packet being received from the RX FIFO. The packet is
+ * dropped if it doesn't fit or if the last one wasn't read yet.
+ * @param len Bytes to read.
+ */
+static void RFM2xDrainRXFIFO(unsigned char len)
+{
+    if (NewPacketReceived || ((unsigned int) rxIndex + len > RFM2X_MAX_MESSAGE_LEN))
+    {
+        RFM2xResetRXFIFO();
+        return;
+    }
+
+    RFM2xBurstReadByte(RFM2X_REG_7F_FIFO_ACCESS, &rxBuffer[rxIndex], len);
+    rxIndex += len;
+}
+
 void RFM2xInterruptHandler(void)
 {
+    unsigned char length;
+
     RFM2xITStatus1.IRQReg = RFM2xReadByte(RFM2X_REG_03_INTERRUPT_STATUS1);
     RFM2xITStatus2.IRQReg = RFM2xReadByte(RFM2X_REG_04_INTERRUPT_STATUS2);
 
+#ifdef RFM2X_RSSI_ON_SYNC
+    if (RFM2xITStatus2.bits.SyncDetected)
+    {
+        rssi = RFM2xReadRSSI();
+        rxIndex = 0;
+    }
+#else
+    if (RFM2xITStatus1.bits.ValidPacketReceived)
+    {
+        //the end of the packet, the sender is still on the air
+        rssi = RFM2xReadRSSI();
+    }
+#endif
+    if (RFM2xITStatus1.bits.FIFOUnderflowOverflowError)
+    {
+        //the packet on the air is lost, start over in RX mode
+        RFM2xSetModeIdle();
+        RFM2xResetAllFIFO();
+        interruptEnable1 &= ~RFM2X_ENTXFFAEM;
+        RFM2xWriteByte(RFM2X_REG_05_INTERRUPT_ENABLE1, interruptEnable1);
+        txBusy = false;
+        rxIndex = 0;
+        RFM2xSetModeRX();
+        return;
+    }
+    if (RFM2xITStatus1.bits.TXFIFOAlmostEmpty && txBusy && (txIndex < txLength))
+    {
+        RFM2xFillTXFIFO();
+    }
     if (RFM2xITStatus1.bits.PacketSentInterrupt)
     {
+        txBusy = false;
         RFM2xSetModeRX();
     }
     if (RFM2xITStatus1.bits.RXFIFOAlmostFull)
     {
-        RFM2xReceiveData();
+        RFM2xDrainRXFIFO(RFM2X_RXFFAFULL_THRESHOLD);
     }
-    if (RFM2xITStatus2.bits.SyncDetected)
+    if (RFM2xITStatus1.bits.ValidPacketReceived)
     {
-        rssi = RFM2xReadRSSI();
+        //the rest of the packet, after the last almost full chunk
+        length = RFM2xReadByte(RFM2X_REG_4B_RECEIVED_PACKET_LENGTH);
+
+        if (length >= rxIndex)
+        {
+            RFM2xDrainRXFIFO(length - rxIndex);
+        }
+
+        if (!NewPacketReceived && (rxIndex == length))
+        {
+            rxLength = length;
+            rxRSSI = rssi;
+            rxSource = RFM2xReadByte(RFM2X_REG_48_RECEIVED_HEADER2);
+            NewPacketReceived = true;
+        }
+
+        rxIndex = 0;
+        RFM2xResetRXFIFO();
+        RFM2xSetModeRX();
+    }
+    if (RFM2xITStatus1.bits.CRCError)
+    {
+        rxIndex = 0;
+        RFM2xResetRXFIFO();
+        RFM2xSetModeRX();
     }
 }
 
@@ -80,8 +202,14 @@ unsigned char RFM2xInit(void)
     TaskerDelayMiliseconds(20);
 
     /**Enable the necessary registers, put the module into ready mode*/
-    RFM2xWriteByte(RFM2X_REG_05_INTERRUPT_ENABLE1, RFM2X_ENRXFFAFULL | RFM2X_ENPKSENT);
+    interruptEnable1 = RFM2X_ENFFERR | RFM2X_ENRXFFAFULL | RFM2X_ENPKSENT
+            | RFM2X_ENPKVALID | RFM2X_ENCRCERROR;
+    RFM2xWriteByte(RFM2X_REG_05_INTERRUPT_ENABLE1, interruptEnable1);
+#ifdef RFM2X_RSSI_ON_SYNC
     RFM2xWriteByte(RFM2X_REG_06_INTERRUPT_ENABLE2, RFM2X_ENSWDET);
+#else
+    RFM2xWriteByte(RFM2X_REG_06_INTERRUPT_ENABLE2, 0x00);
+#endif
     RFM2xWriteByte(RFM2X_REG_07_OPERATING_MODE1, 0x01);
     RFM2xWriteByte(RFM2X_REG_08_OPERATING_MODE2, 0x00);
 
@@ -112,12 +240,21 @@ unsigned char RFM2xInit(void)
     RFM2xWriteByte(RFM2X_REG_25_CLOCK_RECOVERY_TIMING_LOOP_GAIN0, 0xFB);
     RFM2xWriteByte(RFM2X_REG_2A_AFC_LIMITER, 0x50);
 
-    //Disable package handle, msb first, disable crc.
-    RFM2xWriteByte(RFM2X_REG_30_DATA_ACCESS_CONTROL, 0x61);
-    //No address and header check
-    RFM2xWriteByte(RFM2X_REG_32_HEADER_CONTROL1, 0x00);
-    //Header not used for header length,packet length not included, sync on 3&2
-    RFM2xWriteByte(RFM2X_REG_33_HEADER_CONTROL2, 0x0A);
+    //Packet handling on RX and TX, msb first, CRC-16 on the header and the data.
+    RFM2xWriteByte(RFM2X_REG_30_DATA_ACCESS_CONTROL,
+                   RFM2X_ENPACRX | RFM2X_CRCHDRS | RFM2X_ENPACTX
+                   | RFM2X_ENCRC | RFM2X_CRC_CRC_16_IBM);
+    //Destination in header 3, checked against our address or the broadcast
+    RFM2xWriteByte(RFM2X_REG_32_HEADER_CONTROL1,
+                   RFM2X_BCEN_HEADER3 | RFM2X_HDCH_HEADER3);
+    RFM2xWriteByte(RFM2X_REG_43_HEADER_ENABLE3, 0xFF);
+    RFM2xWriteByte(RFM2X_REG_44_HEADER_ENABLE2, 0x00);
+    RFM2xWriteByte(RFM2X_REG_45_HEADER_ENABLE1, 0x00);
+    RFM2xWriteByte(RFM2X_REG_46_HEADER_ENABLE0, 0x00);
+    RFM2xSetAddress(ownAddress);
+    //Destination and source header, length byte sent in the packet, sync on 3&2
+    RFM2xWriteByte(RFM2X_REG_33_HEADER_CONTROL2,
+                   RFM2X_HDLEN_2 | RFM2X_VARPKLEN | RFM2X_SYNCLEN_2);
     //Preamble has 6 byte (12 nibbles)
     RFM2xWriteByte(RFM2X_REG_34_PREAMBLE_LENGTH, 0x0C);
     //Preamble must have at least 6 nible to be correct
@@ -191,20 +328,107 @@ void RFM2xSetModeTX(void)
     RFM2xResetRXFIFO();
 }
 
-void RFM2xSendData(void)
+/**
+ * Starts sending a packet to every node, see RFM2xSendPacketTo().
+ * @param data Payload.
+ * @param length Bytes of the payload, 1 to RFM2X_MAX_MESSAGE_LEN.
+ * @return False if a packet is being sent or the length is wrong.
+ */
+bool RFM2xSendPacket(const unsigned char *data, unsigned char length)
+{
+    return RFM2xSendPacketTo(RFM2X_BROADCAST, data, length);
+}
+
+/**
+ * Starts sending a packet. The first bytes go to the TX FIFO and the rest is
+ * streamed from the TX FIFO almost empty interrupt, so the data must stay
+ * unchanged until RFM2xIsSending() is false. The preamble, sync word,
+ * header, length and CRC are added by the device.
+ * @param dest Address of the destination, RFM2X_BROADCAST for every node.
+ * @param data Payload.
+ * @param length Bytes of the payload, 1 to RFM2X_MAX_MESSAGE_LEN.
+ * @return False if a packet is being sent or the length is wrong.
+ */
+bool RFM2xSendPacketTo(unsigned char dest, const unsigned char *data, unsigned char length)
 {
+    unsigned char header[2];
+
+    if (txBusy || (length == 0) || (length > RFM2X_MAX_MESSAGE_LEN))
+    {
+        return false;
+    }
+
     RFM2xSetModeIdle();
     RFM2xResetTXFIFO();
-    RFM2xBurstWriteByte(RFM2X_REG_7F_FIFO_ACCESS, (unsigned char *) &(RFM2xTXPacket.Preamble[0]), RFM2X_FIFO_SIZE);
+
+    //header 3 and 2, then the packet length
+    header[0] = dest;
+    header[1] = ownAddress;
+    RFM2xBurstWriteByte(RFM2X_REG_3A_TRANSMIT_HEADER3, header, sizeof (header));
+    RFM2xWriteByte(RFM2X_REG_3E_PACKET_LENGTH, length);
+
+    txData = data;
+    txLength = length;
+    txIndex = 0;
+    txBusy = true;
+
+    if (length > RFM2X_FIFO_SIZE)
+    {
+        RFM2xBurstWriteByte(RFM2X_REG_7F_FIFO_ACCESS, (unsigned char *) data, RFM2X_FIFO_SIZE);
+        txIndex = RFM2X_FIFO_SIZE;
+
+        interruptEnable1 |= RFM2X_ENTXFFAEM;
+        RFM2xWriteByte(RFM2X_REG_05_INTERRUPT_ENABLE1, interruptEnable1);
+    }
+    else
+    {
+        RFM2xBurstWriteByte(RFM2X_REG_7F_FIFO_ACCESS, (unsigned char *) data, length);
+        txIndex = length;
+    }
+
     RFM2xSetModeTX();
+
+    return true;
 }
 
-void RFM2xReceiveData(void)
+/**
+ * Tells if a packet is being sent.
+ * @return True until the packet sent interrupt.
+ */
+bool RFM2xIsSending(void)
 {
-    RFM2xSetModeIdle();
-    RFM2xBurstReadByte(RFM2X_REG_7F_FIFO_ACCESS, (unsigned char *) &(RFM2xRXPacket.CommandID), RFM2X_RXFFAFULL_THRESHOLD);
-    RFM2xRXPacket.SignalStrength = rssi;
-    RFM2xResetRXFIFO();
+    return txBusy;
+}
+
+/**
+ * Copies the last packet received, when NewPacketReceived is set, and lets
+ * the next one be received.
+ * @param dest Where to copy the payload.
+ * @param size Size of dest, a longer payload is cut.
+ * @return Bytes of the payload, 0 if there is no packet.
+ */
+unsigned char RFM2xReceivePacket(unsigned char *dest, unsigned char size)
+{
+    unsigned char i;
+
+    if (!NewPacketReceived)
+    {
+        return 0;
+    }
+
+    if (size > rxLength)
+    {
+        size = rxLength;
+    }
+
+    for (i = 0; i < size; i++)
+    {
+        dest[i] = rxBuffer[i];
+    }
+
+    NewPacketReceived = false;
+
+    return size;
 }
 
 void RFM2xResetRXFIFO(void)
@@ -225,6 +449,48 @@ void RFM2xResetAllFIFO(void)
     RFM2xWriteByte(RFM2X_REG_08_OPERATING_MODE2, 0x00);
 }
 
+/**
+ * Gives the RSSI of the last packet received, read on its sync word with
+ * RFM2X_RSSI_ON_SYNC or at its end, for the link statistics. Valid while
+ * NewPacketReceived is set.
+ * @return RSSI.
+ */
+unsigned char RFM2xPacketRSSI(void)
+{
+    return rxRSSI;
+}
+
+/**
+ * Gives the address of the sender of the last packet received. Valid while
+ * NewPacketReceived is set.
+ * @return Address.
+ */
+unsigned char RFM2xPacketSource(void)
+{
+    return rxSource;
+}
+
+/**
+ * Sets the address of the node, the device only gives the packets sent to
+ * it or to RFM2X_BROADCAST. The others are dropped in the device without
+ * an interrupt.
+ * @param address Address, not RFM2X_BROADCAST.
+ */
+void RFM2xSetAddress(unsigned char address)
+{
+    ownAddress = address;
+    RFM2xWriteByte(RFM2X_REG_3F_CHECK_HEADER3, address);
+}
+
+/**
+ * Gives the address of the node.
+ * @return Address.
+ */
+unsigned char RFM2xGetAddress(void)
+{
+    return ownAddress;
+}
+
 unsigned char RFM2xReadRSSI(void)
 {
     return RFM2xReadByte(RFM2X_REG_26_RSSI);
@@ -271,4 +537,103 @@ bool RFM2xSetFrequency(float centre, float afcPullInRange)
     RFM2xWriteByte(RFM2X_REG_77_NOMINAL_CARRIER_FREQUENCY0, fc & 0xff);
     RFM2xWriteByte(RFM2X_REG_2A_AFC_LIMITER, afclimiter);
     return !(RFM2xStatusRead() & RFM2X_FREQERR);
-}
\ No newline at end of file
+}
+/**
+ * Works out the band and carrier registers of a frequency with integer math.
+ * The carrier is fc / 64000 of the 10 MHz band step (20 MHz in the high
+ * band), so fc = kHz remainder * 32 / 5 (* 16 / 5 in the high band).
+ * @param kHz Frequency, 240000 to 960000 kHz.
+ * @param channel Register values.
+ * @return False if the frequency is out of range.
+ */
+static bool RFM2xChannelRegisters(unsigned long kHz, tRFM2xChannel *channel)
+{
+    unsigned char fbsel = RFM2X_SBSEL;
+    unsigned long fc;
+
+    if ((kHz < 240000UL) || (kHz > 960000UL))
+    {
+        return false;
+    }
+
+    if (kHz >= 480000UL)
+    {
+        fbsel |= RFM2X_HBSEL | (unsigned char) (kHz / 20000UL - 24);
+        fc = (kHz % 20000UL) * 16 / 5;
+    }
+    else
+    {
+        fbsel |= (unsigned char) (kHz / 10000UL - 24);
+        fc = (kHz % 10000UL) * 32 / 5;
+    }
+
+    channel->BandSelect = fbsel;
+    channel->CarrierHigh = (unsigned char) (fc >> 8);
+    channel->CarrierLow = (unsigned char) fc;
+
+    return true;
+}
+
+/**
+ * Fills the channel table once so that RFM2xSetChannel() only writes the
+ * registers, and tunes to the first channel. The AFC limiter and the
+ * frequency offset set before are kept.
+ * @param firstKHz Frequency of the channel 0, in kHz.
+ * @param spacingKHz Frequency between channels, in kHz.
+ * @param count Number of channels, up to RFM2X_CHANNELS.
+ * @return False if a channel is out of range, the table is then empty.
+ */
+bool RFM2xSetupChannels(unsigned long firstKHz, unsigned int spacingKHz, unsigned char count)
+{
+    unsigned char i;
+
+    channelCount = 0;
+
+    if ((count == 0) || (count > RFM2X_CHANNELS))
+    {
+        return false;
+    }
+
+    for (i = 0; i < count; i++)
+    {
+        if (!RFM2xChannelRegisters(firstKHz + (unsigned long) i * spacingKHz, &channelTable[i]))
+        {
+            return false;
+        }
+    }
+
+    channelCount = count;
+
+    return RFM2xSetChannel(0);
+}
+
+/**
+ * Tunes to a channel of the table with a single burst of the three band and
+ * carrier registers, fast enough to hop at every packet. The device is in
+ * ready or RX mode, the PLL settles on the next TX or RX.
+ * @param channel Channel of the table.
+ * @return False if the channel is not in the table.
+ */
+bool RFM2xSetChannel(unsigned char channel)
+{
+    if (channel >= channelCount)
+    {
+        return false;
+    }
+
+    RFM2xBurstWriteByte(RFM2X_REG_75_FREQUENCY_BAND_SELECT,
+                        (unsigned char *) &channelTable[channel],
+                        sizeof (tRFM2xChannel));
+    channelCurrent = channel;
+
+    return true;
+}
+
+/**
+ * Gives the channel of the table that was tuned last.
+ * @return Channel.
+ */
+unsigned char RFM2xGetChannel(void)
+{
+    return channelCurrent;
+}
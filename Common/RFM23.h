@@ -47,8 +47,9 @@ extern "C"
 // Rx FIFO during reception
 // Can be pre-defined to a smaller size (to save SRAM) prior to including this header
 
-//#define RFM2X_MAX_MESSAGE_LEN 255
-#define RFM2X_MAX_MESSAGE_LEN 64
+#ifndef RFM2X_MAX_MESSAGE_LEN
+#define RFM2X_MAX_MESSAGE_LEN 255
+#endif
 
 // Max number of octets the RFM2X Rx and Tx FIFOs can hold
 #define RFM2X_FIFO_SIZE 64
@@ -58,6 +59,25 @@ extern "C"
 #define RFM2X_TXFFAFULL_THRESHOLD                       63
 #define RFM2X_RXFFAFULL_THRESHOLD                       (63-7)
 
+// Address of the node in the header of the packets, the device drops the
+// packets sent to another address before they reach the FIFO. Changed with
+// RFM2xSetAddress().
+#ifndef RFM2X_ADDRESS
+#define RFM2X_ADDRESS                                   0x01
+#endif
+// Destination of the packets for every node, accepted by all of them
+#define RFM2X_BROADCAST                                 0xFF
+
+// Reads the RSSI of a packet on its sync word, the sync word interrupt then
+// wakes the MCU for every packet on the air, foreign ones included. Without
+// it the RSSI is read at the valid packet interrupt.
+//#define RFM2X_RSSI_ON_SYNC
+
+// Number of entries of the channel table filled by RFM2xSetupChannels()
+#ifndef RFM2X_CHANNELS
+#define RFM2X_CHANNELS                                  16
+#endif
+
 #define SUPPORTED_DEVICE_TYPE                           0x08
 #define SUPPORTED_DEVICE_VERSION                        0x06
 
@@ -422,26 +442,17 @@ typedef union
     unsigned char IRQReg;
 } tInterruptStatus2;
 
+/**
+ * Values of RFM2X_REG_75_FREQUENCY_BAND_SELECT to
+ * RFM2X_REG_77_NOMINAL_CARRIER_FREQUENCY0 for a channel, in register order.
+ */
 typedef struct
 {
-    unsigned char Preamble[6];
-    unsigned char SyncWord[2];
-    unsigned char CommandID;
-    unsigned char DestinationID[4];
-    unsigned char SourceID[4];
-    unsigned char TransmissionCodeID;
-    unsigned char SequenceNumber;
-    unsigned char PacketInfo;
-    unsigned char PayloadLength;
-    unsigned char Payload[32];
-    unsigned char BatteryLevel[2];
-    unsigned char RTC[4];
-    unsigned char SignalStrength;
-    unsigned char CRC[4];
-} tPackageFormat;
-
-extern volatile tPackageFormat RFM2xRXPacket;
-extern volatile tPackageFormat RFM2xTXPacket;
+    unsigned char BandSelect;
+    unsigned char CarrierHigh;
+    unsigned char CarrierLow;
+} tRFM2xChannel;
+
 extern volatile tInterruptStatus1 RFM2xITStatus1;
 extern volatile tInterruptStatus2 RFM2xITStatus2;
 
@@ -459,13 +470,22 @@ void RFM2xSetModeStandby(void);
 void RFM2xSetModeIdle(void);
 void RFM2xSetModeRX(void);
 void RFM2xSetModeTX(void);
-void RFM2xSendData(void);
-void RFM2xReceiveData(void);
+bool RFM2xSendPacket(const unsigned char *data, unsigned char length);
+bool RFM2xSendPacketTo(unsigned char dest, const unsigned char *data, unsigned char length);
+bool RFM2xIsSending(void);
+unsigned char RFM2xReceivePacket(unsigned char *dest, unsigned char size);
 void RFM2xResetRXFIFO(void);
 void RFM2xResetTXFIFO(void);
 void RFM2xResetAllFIFO(void);
 unsigned char RFM2xReadRSSI(void);
+unsigned char RFM2xPacketRSSI(void);
+unsigned char RFM2xPacketSource(void);
+void RFM2xSetAddress(unsigned char address);
+unsigned char RFM2xGetAddress(void);
 bool RFM2xSetFrequency(float centre, float afcPullInRange);
+bool RFM2xSetupChannels(unsigned long firstKHz, unsigned int spacingKHz, unsigned char count);
+bool RFM2xSetChannel(unsigned char channel);
+unsigned char RFM2xGetChannel(void);
 #ifdef	__cplusplus
 }
 #endif
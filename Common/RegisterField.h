@@ -0,0 +1,66 @@
+/**
+ *  @file       RegisterField.h
+ *  @brief      Masks and shifts of the bit fields of device registers.
+ *  @author     Luis Maduro
+ *  @version    1.00
+ *  @date       14/10/2026
+ *
+ *  The fields are given as in the headers of the drivers, by their highest
+ *  bit and their length (i.e. ADXL345_FORMAT_RANGE_BIT and
+ *  ADXL345_FORMAT_RANGE_LENGTH). With constant positions the compiler folds
+ *  the masks and the shifts, no shift loop runs on the 8 bit parts. Fields
+ *  of the same register are joined with '|' and written at once:
+ *  @code
+ *  I2CDeviceUpdateByte(ADXL345_RA_DATA_FORMAT,
+ *                      REGISTER_BIT_MASK(ADXL345_FORMAT_FULL_RES_BIT) |
+ *                      REGISTER_FIELD_MASK(ADXL345_FORMAT_RANGE_BIT,
+ *                                          ADXL345_FORMAT_RANGE_LENGTH),
+ *                      REGISTER_BIT_MASK(ADXL345_FORMAT_FULL_RES_BIT) |
+ *                      REGISTER_FIELD_VALUE(ADXL345_FORMAT_RANGE_BIT,
+ *                                           ADXL345_FORMAT_RANGE_LENGTH,
+ *                                           ADXL345_RANGE_16G));
+ *  @endcode
+ *
+ *  Copyright (C) 2026  Luis Maduro
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef REGISTERFIELD_H
+#define REGISTERFIELD_H
+
+/**Mask of a single bit.*/
+#define REGISTER_BIT_MASK(bit)                                              \
+    ((unsigned char) (1U << (bit)))
+
+/**Position of the lowest bit of a field.*/
+#define REGISTER_FIELD_SHIFT(bitStart, length)                              \
+    ((bitStart) - (length) + 1)
+
+/**Mask of the bits of a field, in place.*/
+#define REGISTER_FIELD_MASK(bitStart, length)                               \
+    ((unsigned char) (((1U << (length)) - 1) << REGISTER_FIELD_SHIFT(bitStart, length)))
+
+/**Right aligned value moved to the bits of a field, the bits above its
+ length are dropped.*/
+#define REGISTER_FIELD_VALUE(bitStart, length, value)                       \
+    ((unsigned char) (((unsigned char) (value) << REGISTER_FIELD_SHIFT(bitStart, length)) \
+                      & REGISTER_FIELD_MASK(bitStart, length)))
+
+/**Right aligned value of a field of a register.*/
+#define REGISTER_FIELD_GET(byte, bitStart, length)                          \
+    ((unsigned char) (((byte) & REGISTER_FIELD_MASK(bitStart, length))      \
+                      >> REGISTER_FIELD_SHIFT(bitStart, length)))
+
+#endif /* REGISTERFIELD_H */
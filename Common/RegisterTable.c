@@ -0,0 +1,76 @@
+/**
+ *  @file       RegisterTable.c
+ *  @brief      Table driven register writes for the initialization of devices.
+ *  @author     Luis Maduro
+ *  @version    1.00
+ *  @date       14/10/2026
+ *
+ *  Copyright (C) 2026  Luis Maduro
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "RegisterTable.h"
+
+/**
+ * Writes a table of registers, in order. The entries that write whole
+ * registers, without delay, to consecutive addresses are joined in one
+ * transfer when the device auto increments the address, so an
+ * initialization takes a few bus transactions instead of one per register.
+ * @param bus Functions to access the device.
+ * @param table Registers to write.
+ * @param length Number of entries of the table.
+ */
+void RegisterTableWrite(const tRegisterBus *bus,
+                        const tRegisterWrite *table,
+                        unsigned char length)
+{
+    unsigned char burst[REGISTER_TABLE_BURST];
+    unsigned char count;
+    unsigned char i = 0;
+    unsigned char value;
+
+    while (i < length)
+    {
+        value = table[i].value;
+
+        if (table[i].mask != REGISTER_ALL_BITS)
+        {
+            value = (bus->readByte(table[i].address) & ~table[i].mask) |
+                    (value & table[i].mask);
+        }
+
+        burst[0] = value;
+        count = 1;
+
+        //the next entries continue the burst
+        while (bus->autoIncrement &&
+               count < REGISTER_TABLE_BURST && i + count < length &&
+               table[i + count].mask == REGISTER_ALL_BITS &&
+               table[i + count].address == table[i].address + count &&
+               table[i + count - 1].delay == 0)
+        {
+            burst[count] = table[i + count].value;
+            count++;
+        }
+
+        bus->writeBytes(table[i].address, count, burst);
+        i += count;
+
+        if (table[i - 1].delay != 0)
+        {
+            bus->delayMs(table[i - 1].delay);
+        }
+    }
+}
@@ -0,0 +1,78 @@
+/**
+ *  @file       RegisterTable.h
+ *  @brief      Table driven register writes for the initialization of devices.
+ *  @author     Luis Maduro
+ *  @version    1.00
+ *  @date       14/10/2026
+ *
+ *  Copyright (C) 2026  Luis Maduro
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef REGISTERTABLE_H
+#define REGISTERTABLE_H
+
+#include <stddef.h>
+
+/**Maximum number of registers written in one burst.*/
+#ifndef REGISTER_TABLE_BURST
+#define REGISTER_TABLE_BURST        16
+#endif
+
+/**Mask of an entry that writes the whole register.*/
+#define REGISTER_ALL_BITS           0xFF
+
+/**
+ * One register write of an initialization table. The tables are const, so
+ * they stay in ROM.
+ */
+typedef struct
+{
+    /**Register address.*/
+    unsigned char address;
+    /**Value to write, only the bits of the mask are used.*/
+    unsigned char value;
+    /**Bits changed, REGISTER_ALL_BITS to write the register without
+     reading it first.*/
+    unsigned char mask;
+    /**Milliseconds to wait after the write.*/
+    unsigned char delay;
+} tRegisterWrite;
+
+/**
+ * Access to the registers of a device, I2C or SPI.
+ */
+typedef struct
+{
+    /**Writes consecutive registers, starting at address.*/
+    void (*writeBytes)(unsigned char address,
+                       unsigned char length,
+                       unsigned char *data);
+    /**Reads a register, for the entries that don't write all the bits. Can
+     be NULL if the table has none.*/
+    unsigned char (*readByte)(unsigned char address);
+    /**Waits some milliseconds, for the entries with a delay. Can be NULL if
+     the table has none.*/
+    void (*delayMs)(unsigned int ms);
+    /**Not 0 if the device increments the register address during a
+     transfer, consecutive registers are then written in one burst.*/
+    unsigned char autoIncrement;
+} tRegisterBus;
+
+void RegisterTableWrite(const tRegisterBus *bus,
+                        const tRegisterWrite *table,
+                        unsigned char length);
+
+#endif /* REGISTERTABLE_H */
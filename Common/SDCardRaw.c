@@ -24,21 +24,66 @@
 
 #if !SD_RAW_SAVE_RAM
 #pragma udata sdfat
-/* static data buffer for acceleration */
-static unsigned char raw_block[512];
+/* static data buffers for acceleration */
+static unsigned char raw_block[SD_RAW_CACHE_BLOCKS][512];
 #pragma udata
-/* offset where the data within raw_block lies on the card */
-static offset_t raw_block_address;
-#if SD_RAW_WRITE_BUFFERING
-/* flag to remember if raw_block was written to the card */
-static unsigned char raw_block_written;
+/* block of the card held by each raw_block */
+static block_t raw_block_address[SD_RAW_CACHE_BLOCKS];
+/* use order of the blocks, 0 for the last one used */
+static unsigned char raw_block_age[SD_RAW_CACHE_BLOCKS];
+/* SD_RAW_BLOCK_DIRTY and SD_RAW_BLOCK_PINNED */
+static unsigned char raw_block_flags[SD_RAW_CACHE_BLOCKS];
+
+#define SD_RAW_BLOCK_DIRTY 0x01
+#define SD_RAW_BLOCK_PINNED 0x02
+#define SD_RAW_BLOCK_NONE SD_RAW_CACHE_BLOCKS
+#define SD_RAW_BLOCK_INVALID ((block_t) - 1)
 #endif
+
+#if SD_RAW_READ_AHEAD
+/* states of the read ahead, driven by the SPI interrupt */
+#define SD_RAW_AHEAD_IDLE 0
+#define SD_RAW_AHEAD_TOKEN 1
+#define SD_RAW_AHEAD_DATA 2
+#define SD_RAW_AHEAD_CRC 3
+#define SD_RAW_AHEAD_FAILING 4
+#define SD_RAW_AHEAD_DONE 5
+#define SD_RAW_AHEAD_FAILED 6
+/* bytes waited for the data block */
+#define SD_RAW_AHEAD_POLLS 0x7fff
+
+static tSPIDevice sd_raw_device;
+static tSPITransfer sd_raw_transfer;
+static volatile unsigned char sd_raw_ahead_state;
+/* block read ahead and its place in the cache */
+static block_t sd_raw_ahead_block;
+static unsigned char sd_raw_ahead_slot;
+static unsigned char sd_raw_ahead_bytes[3];
+static unsigned int sd_raw_ahead_polls;
+/* last block used by sd_raw_read() */
+static block_t sd_raw_ahead_last;
 #endif
 
 /* card type state */
 static unsigned char sd_raw_card_type;
+/* SPI clock set, in kHz */
+static unsigned long sd_raw_clock;
+/* the card programs a block written, it answers busy */
+static unsigned char sd_raw_programming;
 
 static unsigned char sd_raw_send_command(unsigned char command, unsigned long arg);
+static unsigned long sd_raw_block_arg(block_t block);
+static unsigned char sd_raw_wait_ready(void);
+static unsigned char sd_raw_wait_token(void);
+static unsigned char sd_raw_read_csd(unsigned char* csd);
+static unsigned long sd_raw_tran_speed(unsigned char tran_speed);
+static void sd_raw_set_fast_clock(void);
+#if !SD_RAW_SAVE_RAM
+static unsigned char sd_raw_cache_get(block_t block, unsigned char load);
+#endif
+#if SD_RAW_READ_AHEAD
+static void sd_raw_ahead_wait(void);
+#endif
 unsigned char sd_raw_available(void);
 unsigned char sd_raw_sync(void);
 
@@ -51,6 +96,7 @@ unsigned char sd_raw_sync(void);
 unsigned char sd_raw_init(void)
 {
     unsigned char i;
+    unsigned int retry;
     unsigned char response;
     /* enable inputs for reading card status */
     //    configure_pin_available();
@@ -64,10 +110,12 @@ unsigned char sd_raw_init(void)
 
     unselect_card();
 
-    SPIInit(0x00, 0);
+    SPIInit();
+    sd_raw_clock = SPISetClock(SD_RAW_INIT_KHZ);
 
     /* initialization procedure */
     sd_raw_card_type = 0;
+    sd_raw_programming = 0;
 
     if (!sd_raw_available())
         return 0;
@@ -83,36 +131,38 @@ unsigned char sd_raw_init(void)
     select_card();
 
     /* reset card */
-    for (i = 0;; ++i)
+    for (retry = 0;; ++retry)
     {
         response = sd_raw_send_command(CMD_GO_IDLE_STATE, 0);
         if (response == (1 << R1_IDLE_STATE))
             break;
 
-        if (i == 0x1ff)
+        if (retry == 0x1ff)
         {
             unselect_card();
             return 0;
         }
     }
 
-#if SD_RAW_SDHC
-    /* check for version of SD card specification */
+    /* check for version of SD card specification, SD 1 cards and MMC
+     * don't know CMD8
+     */
     response = sd_raw_send_command(CMD_SEND_IF_COND, 0x100 /* 2.7V - 3.6V */ | 0xaa /* test pattern */);
     if ((response & (1 << R1_ILL_COMMAND)) == 0)
     {
         SPIRead();
         SPIRead();
-        if ((SPIRead() & 0x01) == 0)
-            return 0; /* card operation voltage range doesn't match */
-        if (SPIRead() != 0xaa)
-            return 0; /* wrong test pattern */
+        if ((SPIRead() & 0x01) == 0 || SPIRead() != 0xaa)
+        {
+            /* card operation voltage range doesn't match or wrong test pattern */
+            unselect_card();
+            return 0;
+        }
 
         /* card conforms to SD 2 card specification */
         sd_raw_card_type |= (1 << SD_RAW_SPEC_2);
     }
     else
-#endif
     {
         /* determine SD/MMC card type */
         sd_raw_send_command(CMD_APP, 0);
@@ -129,15 +179,14 @@ unsigned char sd_raw_init(void)
     }
 
     /* wait for card to get ready */
-    for (i = 0;; ++i)
+    for (retry = 0;; ++retry)
     {
         if (sd_raw_card_type & ((1 << SD_RAW_SPEC_1) | (1 << SD_RAW_SPEC_2)))
         {
             unsigned long arg = 0;
-#if SD_RAW_SDHC
+            /* HCS, the host supports high capacity cards */
             if (sd_raw_card_type & (1 << SD_RAW_SPEC_2))
                 arg = 0x40000000;
-#endif
             sd_raw_send_command(CMD_APP, 0);
             response = sd_raw_send_command(CMD_SD_SEND_OP_COND, arg);
         }
@@ -149,14 +198,13 @@ unsigned char sd_raw_init(void)
         if ((response & (1 << R1_IDLE_STATE)) == 0)
             break;
 
-        if (i == 0x7fff)
+        if (retry == 0x7fff)
         {
             unselect_card();
             return 0;
         }
     }
 
-#if SD_RAW_SDHC
     if (sd_raw_card_type & (1 << SD_RAW_SPEC_2))
     {
         if (sd_raw_send_command(CMD_READ_OCR, 0))
@@ -165,6 +213,7 @@ unsigned char sd_raw_init(void)
             return 0;
         }
 
+        /* CCS, SDHC and SDXC cards are addressed in blocks */
         if (SPIRead() & 0x40)
             sd_raw_card_type |= (1 << SD_RAW_SPEC_SDHC);
 
@@ -172,7 +221,6 @@ unsigned char sd_raw_init(void)
         SPIRead();
         SPIRead();
     }
-#endif
 
     /* set block size to 512 bytes */
     if (sd_raw_send_command(CMD_SET_BLOCKLEN, 512))
@@ -184,19 +232,124 @@ unsigned char sd_raw_init(void)
     /* deaddress card */
     unselect_card();
 
+    /* identification done, data transfers at the rate of the card */
+    sd_raw_set_fast_clock();
+
+#if SD_RAW_READ_AHEAD
+    /* the transfers configure the bus with the clock just set */
+    SPIDeviceInit(&sd_raw_device, SD_RAW_CS_PORT, SD_RAW_CS_MASK, 0, SPIGetClock());
+    sd_raw_ahead_state = SD_RAW_AHEAD_IDLE;
+    sd_raw_ahead_last = SD_RAW_BLOCK_INVALID;
+#endif
+
 #if !SD_RAW_SAVE_RAM
+    for (i = 0; i < SD_RAW_CACHE_BLOCKS; ++i)
+    {
+        raw_block_address[i] = SD_RAW_BLOCK_INVALID;
+        raw_block_age[i] = i;
+        raw_block_flags[i] = 0;
+    }
+
     /* the first block is likely to be accessed first, so precache it here */
-    raw_block_address = (offset_t) - 1;
-#if SD_RAW_WRITE_BUFFERING
-    raw_block_written = 1;
-#endif
-    if (!sd_raw_read(0, raw_block, sizeof (raw_block)))
+    if (sd_raw_cache_get(0, 1) == SD_RAW_BLOCK_NONE)
         return 0;
 #endif
 
     return 1;
 }
 
+/**
+ * \ingroup sd_raw
+ * Reads the CSD register of the card.
+ *
+ * \param[out] csd The 16 bytes of the register.
+ * \returns 0 on failure, 1 on success.
+ */
+static unsigned char sd_raw_read_csd(unsigned char* csd)
+{
+    select_card();
+
+    if (sd_raw_send_command(CMD_SEND_CSD, 0))
+    {
+        unselect_card();
+        return 0;
+    }
+
+    /* the clock may be too fast */
+    if (!sd_raw_wait_token())
+    {
+        unselect_card();
+        return 0;
+    }
+
+    SPIDeviceReceiveData(csd, 16);
+
+    /* read crc16 */
+    SPIRead();
+    SPIRead();
+
+    unselect_card();
+
+    return 1;
+}
+
+/**
+ * \ingroup sd_raw
+ * Decodes the TRAN_SPEED field of the CSD, the highest data clock.
+ *
+ * \param[in] tran_speed The field, unit in bits 2-0 and value in bits 6-3.
+ * \returns The clock in kHz, 0 if the field is invalid.
+ */
+static unsigned long sd_raw_tran_speed(unsigned char tran_speed)
+{
+    /* time value, times 10 */
+    static const unsigned char values[16] = {
+        0, 10, 12, 13, 15, 20, 25, 30, 35, 40, 45, 50, 55, 60, 70, 80
+    };
+    unsigned long kHz = values[(tran_speed >> 3) & 0x0f];
+
+    switch (tran_speed & 0x07)
+    {
+    case 0: /* 100 kbit/s */
+        return kHz * 10;
+    case 1: /* 1 Mbit/s */
+        return kHz * 100;
+    case 2: /* 10 Mbit/s */
+        return kHz * 1000;
+    case 3: /* 100 Mbit/s */
+        return kHz * 10000;
+    default:
+        return 0;
+    }
+}
+
+/**
+ * \ingroup sd_raw
+ * Raises the SPI clock to the transfer rate of the card, up to
+ * SD_RAW_MAX_KHZ. The CSD is read again at the new clock and the clock goes
+ * back to SD_RAW_INIT_KHZ if it doesn't match.
+ */
+static void sd_raw_set_fast_clock(void)
+{
+    unsigned char csd[16];
+    unsigned char check[16];
+    unsigned long kHz;
+
+    if (!sd_raw_read_csd(csd))
+        return;
+
+    kHz = sd_raw_tran_speed(csd[3]);
+    if (kHz <= SD_RAW_INIT_KHZ)
+        return;
+    if (kHz > SD_RAW_MAX_KHZ)
+        kHz = SD_RAW_MAX_KHZ;
+
+    sd_raw_clock = SPISetClock(kHz);
+
+    if (!sd_raw_read_csd(check) || memcmp(csd, check, sizeof (csd)) != 0)
+        sd_raw_clock = SPISetClock(SD_RAW_INIT_KHZ);
+}
+
 /**
  * \ingroup sd_raw
  * Checks wether a memory card is located in the slot.
@@ -219,6 +372,29 @@ unsigned char sd_raw_locked(void)
     return get_pin_locked() == 0x00;
 }
 
+/**
+ * \ingroup sd_raw
+ * Gives the SPI clock set by sd_raw_init().
+ *
+ * \returns The clock in kHz.
+ */
+unsigned long sd_raw_get_clock(void)
+{
+    return sd_raw_clock;
+}
+
+/**
+ * \ingroup sd_raw
+ * Checks wether the card is a high capacity card (SDHC or SDXC), found by
+ * sd_raw_init().
+ *
+ * \returns 1 if the card is SDHC or SDXC, 0 if it is not.
+ */
+unsigned char sd_raw_is_sdhc(void)
+{
+    return (sd_raw_card_type & (1 << SD_RAW_SPEC_SDHC)) != 0;
+}
+
 /**
  * \ingroup sd_raw
  * Send a command to the memory card which responses with a R1 response (and possibly others).
@@ -232,111 +408,581 @@ unsigned char sd_raw_send_command(unsigned char command, unsigned long arg)
     unsigned char response;
     unsigned char i;
 
-    /* wait some clock cycles */
-    SPIRead();
+    /* the card answers busy while it programs a block written before */
+    if (sd_raw_programming && !sd_raw_wait_ready())
+        return 0xff;
+
+    /* wait some clock cycles */
+    SPIRead();
+
+    /* send command via SPI */
+    SPIWrite(0x40 | command);
+    SPIWrite((arg >> 24) & 0xff);
+    SPIWrite((arg >> 16) & 0xff);
+    SPIWrite((arg >> 8) & 0xff);
+    SPIWrite((arg >> 0) & 0xff);
+    switch (command)
+    {
+    case CMD_GO_IDLE_STATE:
+        SPIWrite(0x95);
+        break;
+    case CMD_SEND_IF_COND:
+        SPIWrite(0x87);
+        break;
+    default:
+        SPIWrite(0xff);
+        break;
+    }
+
+    /* receive response */
+    for (i = 0; i < 10; ++i)
+    {
+        response = SPIRead();
+        if (response != 0xff)
+            break;
+    }
+
+    return response;
+}
+
+/**
+ * \ingroup sd_raw
+ * Gives the address argument of a block command, the block number for SDHC
+ * cards or its byte offset for the others.
+ *
+ * \param[in] block The block.
+ * \returns The argument of the command.
+ */
+static unsigned long sd_raw_block_arg(block_t block)
+{
+    if (sd_raw_card_type & (1 << SD_RAW_SPEC_SDHC))
+        return block;
+    return block << 9;
+}
+
+/**
+ * \ingroup sd_raw
+ * Gives the number of bytes clocked in a time, at the clock of the card.
+ *
+ * \param[in] ms The time in ms.
+ * \returns The number of bytes, at least 1.
+ */
+static unsigned long sd_raw_timeout_bytes(unsigned int ms)
+{
+    return sd_raw_clock * ms / 8 + 1;
+}
+
+/**
+ * \ingroup sd_raw
+ * Waits while the card holds MISO low, busy after a write or a stop, for
+ * SD_RAW_WRITE_TIMEOUT at most.
+ *
+ * \returns 0 on timeout, 1 when the card is ready.
+ */
+static unsigned char sd_raw_wait_ready(void)
+{
+    unsigned long limit = sd_raw_timeout_bytes(SD_RAW_WRITE_TIMEOUT);
+
+    do
+    {
+        if (SPIRead() == 0xff)
+        {
+            sd_raw_programming = 0;
+            return 1;
+        }
+    }
+    while (--limit);
+
+    return 0;
+}
+
+/**
+ * \ingroup sd_raw
+ * Waits for the start of a data block (start byte 0xfe), for
+ * SD_RAW_READ_TIMEOUT at most.
+ *
+ * \returns 0 on timeout or an error token, 1 on the start byte.
+ */
+static unsigned char sd_raw_wait_token(void)
+{
+    unsigned long limit = sd_raw_timeout_bytes(SD_RAW_READ_TIMEOUT);
+    unsigned char b;
+
+    do
+    {
+        b = SPIRead();
+        if (b != 0xff)
+            return b == 0xfe;
+    }
+    while (--limit);
+
+    return 0;
+}
+
+#if !SD_RAW_SAVE_RAM
+
+/**
+ * \ingroup sd_raw
+ * Reads a whole block from the card.
+ *
+ * \param[in] block The block.
+ * \param[out] buffer The buffer of 512 bytes for the data.
+ * \returns 0 on failure, 1 on success.
+ */
+static unsigned char sd_raw_read_block(block_t block, unsigned char* buffer)
+{
+#if SD_RAW_READ_AHEAD
+    sd_raw_ahead_wait();
+#endif
+
+    /* address card */
+    select_card();
+
+    /* send single block request */
+    if (sd_raw_send_command(CMD_READ_SINGLE_BLOCK, sd_raw_block_arg(block)))
+    {
+        unselect_card();
+        return 0;
+    }
+
+    /* wait for data block (start byte 0xfe) */
+    if (!sd_raw_wait_token())
+    {
+        unselect_card();
+        return 0;
+    }
+
+    /* read byte block */
+    SPIDeviceReceiveData(buffer, 512);
+
+    /* read crc16 */
+    SPIRead();
+    SPIRead();
+
+    /* deaddress card */
+    unselect_card();
+
+    /* let card some time to finish */
+    SPIRead();
+
+    return 1;
+}
+
+#if SD_RAW_WRITE_SUPPORT
+/**
+ * \ingroup sd_raw
+ * Writes a whole block to the card.
+ *
+ * \param[in] block The block.
+ * \param[in] buffer The 512 bytes of the block.
+ * \returns 0 on failure, 1 on success.
+ */
+static unsigned char sd_raw_write_block(block_t block, const unsigned char* buffer)
+{
+    unsigned char response;
+
+#if SD_RAW_READ_AHEAD
+    sd_raw_ahead_wait();
+#endif
+
+    /* address card */
+    select_card();
+
+    /* send single block request */
+    if (sd_raw_send_command(CMD_WRITE_SINGLE_BLOCK, sd_raw_block_arg(block)))
+    {
+        unselect_card();
+        return 0;
+    }
+
+    /* send start byte */
+    SPIWrite(0xfe);
+
+    /* write byte block */
+    SPIDeviceSendData(buffer, 512);
+
+    /* write dummy crc16 */
+    SPIWrite(0xff);
+    SPIWrite(0xff);
+
+    /* the card programs the block while it is deselected, the next
+     * command waits for it
+     */
+    response = SPIRead() & 0x1f;
+    sd_raw_programming = 1;
+
+    /* deaddress card */
+    unselect_card();
+
+    /* let card some time to finish */
+    SPIRead();
+
+    return response == DR_STATUS_ACCEPTED;
+}
+#endif
+
+/**
+ * \ingroup sd_raw
+ * Writes a cached block back to the card if it was changed.
+ *
+ * \param[in] i The cached block.
+ * \returns 0 on failure, 1 on success.
+ */
+static unsigned char sd_raw_cache_flush(unsigned char i)
+{
+#if SD_RAW_WRITE_SUPPORT
+    if (raw_block_flags[i] & SD_RAW_BLOCK_DIRTY)
+    {
+        if (!sd_raw_write_block(raw_block_address[i], raw_block[i]))
+            return 0;
+        raw_block_flags[i] &= ~SD_RAW_BLOCK_DIRTY;
+    }
+#else
+    (void) i;
+#endif
+    return 1;
+}
+
+/**
+ * \ingroup sd_raw
+ * Makes a cached block the last one used.
+ *
+ * \param[in] i The cached block.
+ */
+static void sd_raw_cache_touch(unsigned char i)
+{
+    unsigned char j;
+
+    for (j = 0; j < SD_RAW_CACHE_BLOCKS; ++j)
+    {
+        if (raw_block_age[j] < raw_block_age[i])
+            ++raw_block_age[j];
+    }
+    raw_block_age[i] = 0;
+}
+
+#if SD_RAW_READ_AHEAD
+/**
+ * \ingroup sd_raw
+ * Looks for a block in the cache.
+ *
+ * \param[in] block The block.
+ * \returns The cached block, SD_RAW_BLOCK_NONE if it is not cached.
+ */
+static unsigned char sd_raw_cache_find(block_t block)
+{
+    unsigned char i;
+
+    for (i = 0; i < SD_RAW_CACHE_BLOCKS; ++i)
+    {
+        if (raw_block_address[i] == block)
+            return i;
+    }
+
+    return SD_RAW_BLOCK_NONE;
+}
+
+static void sd_raw_ahead_callback(tSPITransfer* transfer);
+
+/**
+ * \ingroup sd_raw
+ * Queues the next transfer of the read ahead, received into a buffer.
+ *
+ * \param[out] buffer The buffer for the bytes received.
+ * \param[in] length The number of bytes.
+ * \param[in] keep 1 to keep the card selected at the end.
+ */
+static void sd_raw_ahead_transfer(unsigned char* buffer, unsigned int length, unsigned char keep)
+{
+    sd_raw_transfer.device = &sd_raw_device;
+    sd_raw_transfer.txData = NULL;
+    sd_raw_transfer.rxData = buffer;
+    sd_raw_transfer.length = length;
+    sd_raw_transfer.keepSelected = keep;
+    sd_raw_transfer.callback = sd_raw_ahead_callback;
+    SPIDeviceStartTransfer(&sd_raw_transfer);
+}
+
+/**
+ * \ingroup sd_raw
+ * Goes on with the read ahead at the end of each of its transfers, called
+ * from the SPI interrupt. The data token is polled one byte at a time.
+ *
+ * \param[in] transfer The transfer that ended.
+ */
+static void sd_raw_ahead_callback(tSPITransfer* transfer)
+{
+    (void) transfer;
+
+    switch (sd_raw_ahead_state)
+    {
+    case SD_RAW_AHEAD_TOKEN:
+        if (sd_raw_ahead_bytes[0] == 0xfe)
+        {
+            sd_raw_ahead_state = SD_RAW_AHEAD_DATA;
+            sd_raw_ahead_transfer(raw_block[sd_raw_ahead_slot], 512, 1);
+        }
+        else if (sd_raw_ahead_bytes[0] == 0xff && ++sd_raw_ahead_polls < SD_RAW_AHEAD_POLLS)
+        {
+            sd_raw_ahead_transfer(sd_raw_ahead_bytes, 1, 1);
+        }
+        else
+        {
+            /* error token or no data, the card is deselected */
+            sd_raw_ahead_state = SD_RAW_AHEAD_FAILING;
+            sd_raw_ahead_transfer(sd_raw_ahead_bytes, 1, 0);
+        }
+        break;
+    case SD_RAW_AHEAD_DATA:
+        /* crc16 and some time for the card to finish */
+        sd_raw_ahead_state = SD_RAW_AHEAD_CRC;
+        sd_raw_ahead_transfer(sd_raw_ahead_bytes, 3, 0);
+        break;
+    case SD_RAW_AHEAD_CRC:
+        sd_raw_ahead_state = SD_RAW_AHEAD_DONE;
+        break;
+    case SD_RAW_AHEAD_FAILING:
+        sd_raw_ahead_state = SD_RAW_AHEAD_FAILED;
+        break;
+    }
+}
+
+/**
+ * \ingroup sd_raw
+ * Waits for the end of the read ahead and puts its block in the cache, as
+ * the last one used.
+ */
+static void sd_raw_ahead_wait(void)
+{
+    if (sd_raw_ahead_state == SD_RAW_AHEAD_IDLE)
+        return;
+
+    while (sd_raw_ahead_state != SD_RAW_AHEAD_DONE && sd_raw_ahead_state != SD_RAW_AHEAD_FAILED);
+
+    if (sd_raw_ahead_state == SD_RAW_AHEAD_DONE)
+    {
+        raw_block_address[sd_raw_ahead_slot] = sd_raw_ahead_block;
+        sd_raw_cache_touch(sd_raw_ahead_slot);
+    }
+
+    sd_raw_ahead_state = SD_RAW_AHEAD_IDLE;
+}
+
+/**
+ * \ingroup sd_raw
+ * Starts reading a block in the background into the least recently used
+ * cached block, other than the one in use. Nothing is done if a read ahead
+ * is running or the block is cached.
+ *
+ * \param[in] block The block.
+ */
+static void sd_raw_ahead_start(block_t block)
+{
+    unsigned char i;
+    unsigned char victim = SD_RAW_BLOCK_NONE;
+
+    if (sd_raw_ahead_state != SD_RAW_AHEAD_IDLE || sd_raw_cache_find(block) != SD_RAW_BLOCK_NONE)
+        return;
+
+    /* the command would wait for the card to program a block */
+    if (!sd_raw_ready())
+        return;
+
+    for (i = 0; i < SD_RAW_CACHE_BLOCKS; ++i)
+    {
+        if (!(raw_block_flags[i] & SD_RAW_BLOCK_PINNED) && raw_block_age[i] != 0
+                && (victim == SD_RAW_BLOCK_NONE || raw_block_age[i] > raw_block_age[victim]))
+            victim = i;
+    }
+
+    if (victim == SD_RAW_BLOCK_NONE || !sd_raw_cache_flush(victim))
+        return;
+
+    raw_block_address[victim] = SD_RAW_BLOCK_INVALID;
+
+    /* the command is sent here, the data block comes from the interrupt */
+    select_card();
+
+    if (sd_raw_send_command(CMD_READ_SINGLE_BLOCK, sd_raw_block_arg(block)))
+    {
+        unselect_card();
+        return;
+    }
+
+    sd_raw_ahead_block = block;
+    sd_raw_ahead_slot = victim;
+    sd_raw_ahead_polls = 0;
+    sd_raw_ahead_state = SD_RAW_AHEAD_TOKEN;
+    sd_raw_ahead_transfer(sd_raw_ahead_bytes, 1, 1);
+}
+#endif
+
+/**
+ * \ingroup sd_raw
+ * Gives the cached copy of a block, replacing the least recently used
+ * block that is not pinned, written back first if it was changed.
+ *
+ * \param[in] block The block.
+ * \param[in] load 0 if the whole block is going to be overwritten, it is
+ *                 then not read from the card.
+ * \returns The cached block, SD_RAW_BLOCK_NONE on failure.
+ */
+static unsigned char sd_raw_cache_get(block_t block, unsigned char load)
+{
+    unsigned char i;
+    unsigned char victim = SD_RAW_BLOCK_NONE;
+
+#if SD_RAW_READ_AHEAD
+    /* it may be the block being read ahead, the bus is needed anyway */
+    if (sd_raw_cache_find(block) == SD_RAW_BLOCK_NONE)
+        sd_raw_ahead_wait();
+#endif
+
+    for (i = 0; i < SD_RAW_CACHE_BLOCKS; ++i)
+    {
+        if (raw_block_address[i] == block)
+        {
+            sd_raw_cache_touch(i);
+            return i;
+        }
+
+        if (!(raw_block_flags[i] & SD_RAW_BLOCK_PINNED)
+                && (victim == SD_RAW_BLOCK_NONE || raw_block_age[i] > raw_block_age[victim]))
+            victim = i;
+    }
+
+    if (victim == SD_RAW_BLOCK_NONE || !sd_raw_cache_flush(victim))
+        return SD_RAW_BLOCK_NONE;
+
+    raw_block_address[victim] = SD_RAW_BLOCK_INVALID;
+    if (load && !sd_raw_read_block(block, raw_block[victim]))
+        return SD_RAW_BLOCK_NONE;
+
+    raw_block_address[victim] = block;
+    sd_raw_cache_touch(victim);
+
+    return victim;
+}
+
+/**
+ * \ingroup sd_raw
+ * Keeps a block in the cache, for metadata used all the time (FAT sectors,
+ * directory), or lets it be replaced again. One block always stays unpinned.
+ *
+ * \param[in] block The block.
+ * \param[in] pin 1 to pin the block, 0 to unpin it.
+ * \returns 0 on failure, 1 on success.
+ */
+unsigned char sd_raw_pin(block_t block, unsigned char pin)
+{
+    unsigned char i;
+    unsigned char unpinned = 0;
+
+    if (!pin)
+    {
+        for (i = 0; i < SD_RAW_CACHE_BLOCKS; ++i)
+        {
+            if (raw_block_address[i] == block)
+                raw_block_flags[i] &= ~SD_RAW_BLOCK_PINNED;
+        }
+        return 1;
+    }
 
-    /* send command via SPI */
-    SPIWrite(0x40 | command);
-    SPIWrite((arg >> 24) & 0xff);
-    SPIWrite((arg >> 16) & 0xff);
-    SPIWrite((arg >> 8) & 0xff);
-    SPIWrite((arg >> 0) & 0xff);
-    switch (command)
+    for (i = 0; i < SD_RAW_CACHE_BLOCKS; ++i)
     {
-    case CMD_GO_IDLE_STATE:
-        SPIWrite(0x95);
-        break;
-    case CMD_SEND_IF_COND:
-        SPIWrite(0x87);
-        break;
-    default:
-        SPIWrite(0xff);
-        break;
+        if (!(raw_block_flags[i] & SD_RAW_BLOCK_PINNED))
+            ++unpinned;
     }
 
-    /* receive response */
-    for (i = 0; i < 10; ++i)
+    i = sd_raw_cache_get(block, 1);
+    if (i == SD_RAW_BLOCK_NONE)
+        return 0;
+
+    if (!(raw_block_flags[i] & SD_RAW_BLOCK_PINNED))
     {
-        response = SPIRead();
-        if (response != 0xff)
-            break;
+        if (unpinned <= 1)
+            return 0;
+        raw_block_flags[i] |= SD_RAW_BLOCK_PINNED;
     }
 
-    return response;
+    return 1;
 }
+#endif
 
 /**
  * \ingroup sd_raw
  * Reads raw data from the card.
  *
- * \param[in] offset The offset from which to read.
+ * \param[in] block The block from which to read.
+ * \param[in] offset The byte offset within the block, it can go past the
+ *            block for the following ones.
  * \param[out] buffer The buffer into which to write the data.
  * \param[in] length The number of bytes to read.
  * \returns 0 on failure, 1 on success.
  * \see sd_raw_read_interval, sd_raw_write, sd_raw_write_interval
  */
-unsigned char sd_raw_read(offset_t offset, unsigned char* buffer, uintptr_t length)
+unsigned char sd_raw_read(block_t block, unsigned int offset, unsigned char* buffer, uintptr_t length)
 {
-    unsigned int i;
-    unsigned char *cache;
-    offset_t block_address;
-    unsigned int block_offset;
     unsigned int read_length;
+#if !SD_RAW_SAVE_RAM
+    unsigned char i;
+#endif
+
+    block += offset >> 9;
+    offset &= 0x01ff;
+
     while (length > 0)
     {
         /* determine byte count to read at once */
-        block_offset = offset & 0x01ff;
-        block_address = offset - block_offset;
-        read_length = 512 - block_offset; /* read up to block border */
+        read_length = 512 - offset; /* read up to block border */
         if (read_length > length)
             read_length = length;
 
 #if !SD_RAW_SAVE_RAM
-        /* check if the requested data is cached */
-        if (block_address != raw_block_address)
-#endif
+        /* use the cached data, the block is read if it isn't cached */
+        i = sd_raw_cache_get(block, 1);
+        if (i == SD_RAW_BLOCK_NONE)
+            return 0;
+
+        memcpy(buffer, raw_block[i] + offset, read_length);
+        buffer += read_length;
+
+#if SD_RAW_READ_AHEAD
+        /* block after block, the next one is read while this one is used */
+        if (block != sd_raw_ahead_last)
         {
-#if SD_RAW_WRITE_BUFFERING
-            if (!sd_raw_sync())
-                return 0;
+            if (block == sd_raw_ahead_last + 1)
+                sd_raw_ahead_start(block + 1);
+            sd_raw_ahead_last = block;
+        }
 #endif
-
+#else
+        {
             /* address card */
             select_card();
 
             /* send single block request */
-#if SD_RAW_SDHC
-            if (sd_raw_send_command(CMD_READ_SINGLE_BLOCK, (sd_raw_card_type & (1 << SD_RAW_SPEC_SDHC) ? block_address / 512 : block_address)))
-#else
-            if (sd_raw_send_command(CMD_READ_SINGLE_BLOCK, block_address))
-#endif
+            if (sd_raw_send_command(CMD_READ_SINGLE_BLOCK, sd_raw_block_arg(block)))
             {
                 unselect_card();
                 return 0;
             }
 
             /* wait for data block (start byte 0xfe) */
-            while (SPIRead() != 0xfe);
+            if (!sd_raw_wait_token())
+            {
+                unselect_card();
+                return 0;
+            }
 
-#if SD_RAW_SAVE_RAM
             /* read byte block */
-            unsigned int read_to = block_offset + read_length;
+            unsigned int read_to = offset + read_length;
             for (unsigned int i = 0; i < 512; ++i)
             {
                 unsigned char b = SPIRead();
-                if (i >= block_offset && i < read_to)
+                if (i >= offset && i < read_to)
                     *buffer++ = b;
             }
-#else
-            /* read byte block */
-            cache = raw_block;
-            for (i = 0; i < 512; ++i)
-                *cache++ = SPIRead();
-            raw_block_address = block_address;
-
-            memcpy(buffer, raw_block + block_offset, read_length);
-            buffer += read_length;
-#endif
 
             /* read crc16 */
             SPIRead();
@@ -348,17 +994,11 @@ unsigned char sd_raw_read(offset_t offset, unsigned char* buffer, uintptr_t leng
             /* let card some time to finish */
             SPIRead();
         }
-#if !SD_RAW_SAVE_RAM
-        else
-        {
-            /* use cached data */
-            memcpy(buffer, raw_block + block_offset, read_length);
-            buffer += read_length;
-        }
 #endif
 
         length -= read_length;
-        offset += read_length;
+        offset = 0;
+        ++block;
     }
 
     return 1;
@@ -368,18 +1008,19 @@ unsigned char sd_raw_read(offset_t offset, unsigned char* buffer, uintptr_t leng
  * \ingroup sd_raw
  * Continuously reads units of \c interval bytes and calls a callback function.
  *
- * This function starts reading at the specified offset. Every \c interval bytes,
- * it calls the callback function with the associated data buffer.
+ * This function starts reading at the specified position. Every \c interval
+ * bytes, it calls the callback function with the associated data buffer.
  *
  * By returning zero, the callback may stop reading.
  *
  * \note Within the callback function, you can not start another read or
  *       write operation.
  * \note This function only works if the following conditions are met:
- *       - (offset - (offset % 512)) % interval == 0
+ *       - 512 % interval == 0 and offset % interval == 0
  *       - length % interval == 0
  *
- * \param[in] offset Offset from which to start reading.
+ * \param[in] block Block from which to start reading.
+ * \param[in] offset Byte offset within the block.
  * \param[in] buffer Pointer to a buffer which is at least interval bytes in size.
  * \param[in] interval Number of bytes to read before calling the callback function.
  * \param[in] length Number of bytes to read altogether.
@@ -388,22 +1029,27 @@ unsigned char sd_raw_read(offset_t offset, unsigned char* buffer, uintptr_t leng
  * \returns 0 on failure, 1 on success
  * \see sd_raw_write_interval, sd_raw_read, sd_raw_write
  */
-unsigned char sd_raw_read_interval(offset_t offset, unsigned char* buffer, uintptr_t interval, uintptr_t length, sd_raw_read_interval_handler_t callback, void* p)
+unsigned char sd_raw_read_interval(block_t block, unsigned int offset, unsigned char* buffer, uintptr_t interval, uintptr_t length, sd_raw_read_interval_handler_t callback, void* p)
 {
     if (!buffer || interval == 0 || length < interval || !callback)
         return 0;
 
+    block += offset >> 9;
+    offset &= 0x01ff;
+
 #if !SD_RAW_SAVE_RAM
     while (length >= interval)
     {
         /* as reading is now buffered, we directly
          * hand over the request to sd_raw_read()
          */
-        if (!sd_raw_read(offset, buffer, interval))
+        if (!sd_raw_read(block, offset, buffer, interval))
             return 0;
-        if (!callback(buffer, offset, p))
+        if (!callback(buffer, block, offset, p))
             break;
         offset += interval;
+        block += offset >> 9;
+        offset &= 0x01ff;
         length -= interval;
     }
 
@@ -412,32 +1058,30 @@ unsigned char sd_raw_read_interval(offset_t offset, unsigned char* buffer, uintp
     /* address card */
     select_card();
 
-    unsigned int block_offset;
     unsigned int read_length;
     unsigned char* buffer_cur;
     unsigned char finished = 0;
     do
     {
         /* determine byte count to read at once */
-        block_offset = offset & 0x01ff;
-        read_length = 512 - block_offset;
+        read_length = 512 - offset;
 
         /* send single block request */
-#if SD_RAW_SDHC
-        if (sd_raw_send_command(CMD_READ_SINGLE_BLOCK, (sd_raw_card_type & (1 << SD_RAW_SPEC_SDHC) ? offset / 512 : offset - block_offset)))
-#else
-        if (sd_raw_send_command(CMD_READ_SINGLE_BLOCK, offset - block_offset))
-#endif
+        if (sd_raw_send_command(CMD_READ_SINGLE_BLOCK, sd_raw_block_arg(block)))
         {
             unselect_card();
             return 0;
         }
 
         /* wait for data block (start byte 0xfe) */
-        while (SPIRead() != 0xfe);
+        if (!sd_raw_wait_token())
+        {
+            unselect_card();
+            return 0;
+        }
 
         /* read up to the data of interest */
-        for (unsigned int i = 0; i < block_offset; ++i)
+        for (unsigned int i = 0; i < offset; ++i)
             SPIRead();
 
         /* read interval bytes of data and execute the callback */
@@ -450,7 +1094,7 @@ unsigned char sd_raw_read_interval(offset_t offset, unsigned char* buffer, uintp
             for (unsigned int i = 0; i < interval; ++i)
                 *buffer_cur++ = SPIRead();
 
-            if (!callback(buffer, offset + (512 - read_length), p))
+            if (!callback(buffer, block, 512 - read_length, p))
             {
                 finished = 1;
                 break;
@@ -473,7 +1117,8 @@ unsigned char sd_raw_read_interval(offset_t offset, unsigned char* buffer, uintp
         if (length < interval)
             break;
 
-        offset = offset - block_offset + 512;
+        offset = 0;
+        ++block;
 
     }
     while (!finished);
@@ -488,6 +1133,82 @@ unsigned char sd_raw_read_interval(offset_t offset, unsigned char* buffer, uintp
 #endif
 }
 
+/**
+ * \ingroup sd_raw
+ * Reads consecutive blocks with a single READ_MULTIPLE_BLOCK command, the
+ * card streams them without the access time of a command per block. The
+ * data doesn't go through the block cache, its changed blocks of the range
+ * are written first.
+ *
+ * \param[in] block The first block.
+ * \param[out] buffer The buffer for the data, blocks * 512 bytes.
+ * \param[in] blocks The number of blocks to read.
+ * \returns 0 on failure, 1 on success.
+ * \see sd_raw_read, sd_raw_write_multi
+ */
+unsigned char sd_raw_read_multi(block_t block, unsigned char* buffer, unsigned int blocks)
+{
+#if !SD_RAW_SAVE_RAM
+    unsigned char i;
+#endif
+
+    if (blocks == 0)
+        return 0;
+
+#if SD_RAW_READ_AHEAD
+    sd_raw_ahead_wait();
+#endif
+
+#if !SD_RAW_SAVE_RAM
+    /* the card must have the changed cached blocks of the range */
+    for (i = 0; i < SD_RAW_CACHE_BLOCKS; ++i)
+    {
+        if (raw_block_address[i] != SD_RAW_BLOCK_INVALID && raw_block_address[i] - block < blocks
+                && !sd_raw_cache_flush(i))
+            return 0;
+    }
+#endif
+
+    /* address card */
+    select_card();
+
+    if (sd_raw_send_command(CMD_READ_MULTIPLE_BLOCK, sd_raw_block_arg(block)))
+    {
+        unselect_card();
+        return 0;
+    }
+
+    while (blocks--)
+    {
+        /* wait for data block (start byte 0xfe) */
+        if (!sd_raw_wait_token())
+            break;
+
+        SPIDeviceReceiveData(buffer, 512);
+        buffer += 512;
+
+        /* read crc16 */
+        SPIRead();
+        SPIRead();
+    }
+
+    /* the response of the stop is preceded by a stuff byte, it is only
+     * waited to end being busy
+     */
+    sd_raw_send_command(CMD_STOP_TRANSMISSION, 0);
+    if (!sd_raw_wait_ready())
+        blocks = 0;
+
+    /* deaddress card */
+    unselect_card();
+
+    /* let card some time to finish */
+    SPIRead();
+
+    /* all the blocks were read if the count went past 0 */
+    return blocks == (unsigned int) - 1;
+}
+
 #if DOXYGEN || SD_RAW_WRITE_SUPPORT
 
 /**
@@ -498,103 +1219,51 @@ unsigned char sd_raw_read_interval(offset_t offset, unsigned char* buffer, uintp
  *       call sd_raw_sync() before disconnecting the card
  *       to ensure all remaining data has been written.
  *
- * \param[in] offset The offset where to start writing.
+ * \param[in] block The block where to start writing.
+ * \param[in] offset The byte offset within the block, it can go past the
+ *            block for the following ones.
  * \param[in] buffer The buffer containing the data to be written.
  * \param[in] length The number of bytes to write.
  * \returns 0 on failure, 1 on success.
  * \see sd_raw_write_interval, sd_raw_read, sd_raw_read_interval
  */
-unsigned char sd_raw_write(offset_t offset, const unsigned char* buffer, uintptr_t length)
+unsigned char sd_raw_write(block_t block, unsigned int offset, const unsigned char* buffer, uintptr_t length)
 {
-    unsigned char *cache;
-    unsigned int i;
-    offset_t block_address;
-    unsigned int block_offset;
+    unsigned char i;
     unsigned int write_length;
 
     if (sd_raw_locked())
         return 0;
 
+    block += offset >> 9;
+    offset &= 0x01ff;
 
     while (length > 0)
     {
         /* determine byte count to write at once */
-        block_offset = offset & 0x01ff;
-        block_address = offset - block_offset;
-        write_length = 512 - block_offset; /* write up to block border */
+        write_length = 512 - offset; /* write up to block border */
         if (write_length > length)
             write_length = length;
 
-        /* Merge the data to write with the content of the block.
-         * Use the cached block if available.
+        /* Merge the data to write with the content of the block, it is only
+         * read from the card when it is not all overwritten.
          */
-        if (block_address != raw_block_address)
-        {
-#if SD_RAW_WRITE_BUFFERING
-            if (!sd_raw_sync())
-                return 0;
-#endif
-
-            if (block_offset || write_length < 512)
-            {
-                if (!sd_raw_read(block_address, raw_block, sizeof (raw_block)))
-                    return 0;
-            }
-            raw_block_address = block_address;
-        }
-
-        if (buffer != raw_block)
-        {
-            memcpy(raw_block + block_offset, buffer, write_length);
-
-#if SD_RAW_WRITE_BUFFERING
-            raw_block_written = 0;
-
-            if (length == write_length)
-                return 1;
-#endif
-        }
-
-        /* address card */
-        select_card();
-
-        /* send single block request */
-#if SD_RAW_SDHC
-        if (sd_raw_send_command(CMD_WRITE_SINGLE_BLOCK, (sd_raw_card_type & (1 << SD_RAW_SPEC_SDHC) ? block_address / 512 : block_address)))
-#else
-        if (sd_raw_send_command(CMD_WRITE_SINGLE_BLOCK, block_address))
-#endif
-        {
-            unselect_card();
+        i = sd_raw_cache_get(block, offset || write_length < 512);
+        if (i == SD_RAW_BLOCK_NONE)
             return 0;
-        }
-
-        /* send start byte */
-        SPIWrite(0xfe);
-
-        /* write byte block */
-        cache = raw_block;
-        for (i = 0; i < 512; ++i)
-            SPIWrite(*cache++);
-
-        /* write dummy crc16 */
-        SPIWrite(0xff);
-        SPIWrite(0xff);
 
-        /* wait while card is busy */
-        while (SPIRead() != 0xff);
-        SPIRead();
+        memcpy(raw_block[i] + offset, buffer, write_length);
+        raw_block_flags[i] |= SD_RAW_BLOCK_DIRTY;
 
-        /* deaddress card */
-        unselect_card();
+#if !SD_RAW_WRITE_BUFFERING
+        if (!sd_raw_cache_flush(i))
+            return 0;
+#endif
 
         buffer += write_length;
-        offset += write_length;
         length -= write_length;
-
-#if SD_RAW_WRITE_BUFFERING
-        raw_block_written = 1;
-#endif
+        offset = 0;
+        ++block;
     }
 
     return 1;
@@ -607,13 +1276,14 @@ unsigned char sd_raw_write(offset_t offset, const unsigned char* buffer, uintptr
  * \ingroup sd_raw
  * Writes a continuous data stream obtained from a callback function.
  *
- * This function starts writing at the specified offset. To obtain the
+ * This function starts writing at the specified position. To obtain the
  * next bytes to write, it calls the callback function. The callback fills the
  * provided data buffer and returns the number of bytes it has put into the buffer.
  *
  * By returning zero, the callback may stop writing.
  *
- * \param[in] offset Offset where to start writing.
+ * \param[in] block Block where to start writing.
+ * \param[in] offset Byte offset within the block.
  * \param[in] buffer Pointer to a buffer which is used for the callback function.
  * \param[in] length Number of bytes to write in total. May be zero for endless writes.
  * \param[in] callback The function used to obtain the bytes to write.
@@ -621,7 +1291,7 @@ unsigned char sd_raw_write(offset_t offset, const unsigned char* buffer, uintptr
  * \returns 0 on failure, 1 on success
  * \see sd_raw_read_interval, sd_raw_write, sd_raw_read
  */
-unsigned char sd_raw_write_interval(offset_t offset, unsigned char* buffer, uintptr_t length, sd_raw_write_interval_handler_t callback, void* p)
+unsigned char sd_raw_write_interval(block_t block, unsigned int offset, unsigned char* buffer, uintptr_t length, sd_raw_write_interval_handler_t callback, void* p)
 {
     unsigned char endless = (length == 0);
 #if SD_RAW_SAVE_RAM
@@ -631,9 +1301,12 @@ unsigned char sd_raw_write_interval(offset_t offset, unsigned char* buffer, uint
     if (!buffer || !callback)
         return 0;
 
+    block += offset >> 9;
+    offset &= 0x01ff;
+
     while (endless || length > 0)
     {
-        unsigned int bytes_to_write = callback(buffer, offset, p);
+        unsigned int bytes_to_write = callback(buffer, block, offset, p);
         if (!bytes_to_write)
             break;
         if (!endless && bytes_to_write > length)
@@ -642,10 +1315,12 @@ unsigned char sd_raw_write_interval(offset_t offset, unsigned char* buffer, uint
         /* as writing is always buffered, we directly
          * hand over the request to sd_raw_write()
          */
-        if (!sd_raw_write(offset, buffer, bytes_to_write))
+        if (!sd_raw_write(block, offset, buffer, bytes_to_write))
             return 0;
 
         offset += bytes_to_write;
+        block += offset >> 9;
+        offset &= 0x01ff;
         length -= bytes_to_write;
     }
 
@@ -655,6 +1330,99 @@ unsigned char sd_raw_write_interval(offset_t offset, unsigned char* buffer, uint
 
 #if DOXYGEN || SD_RAW_WRITE_SUPPORT
 
+/**
+ * \ingroup sd_raw
+ * Writes consecutive blocks with a single WRITE_MULTIPLE_BLOCK command. SD
+ * cards are told the number of blocks first (ACMD23) so they can pre-erase
+ * them. The data doesn't go through the block cache, the cached blocks of
+ * the range are updated with it.
+ *
+ * \param[in] block The first block.
+ * \param[in] buffer The data to write, blocks * 512 bytes.
+ * \param[in] blocks The number of blocks to write.
+ * \returns 0 on failure, 1 on success.
+ * \see sd_raw_write, sd_raw_read_multi
+ */
+unsigned char sd_raw_write_multi(block_t block, const unsigned char* buffer, unsigned int blocks)
+{
+    unsigned char response = DR_STATUS_ACCEPTED;
+    unsigned char i;
+
+    if (sd_raw_locked() || blocks == 0)
+        return 0;
+
+#if SD_RAW_READ_AHEAD
+    sd_raw_ahead_wait();
+#endif
+
+    /* the cached blocks of the range get the new data */
+    for (i = 0; i < SD_RAW_CACHE_BLOCKS; ++i)
+    {
+        if (raw_block_address[i] != SD_RAW_BLOCK_INVALID && raw_block_address[i] - block < blocks)
+        {
+            memcpy(raw_block[i], buffer + ((unsigned int) (raw_block_address[i] - block) << 9), 512);
+            raw_block_flags[i] &= ~SD_RAW_BLOCK_DIRTY;
+        }
+    }
+
+    /* address card */
+    select_card();
+
+    if (sd_raw_card_type & ((1 << SD_RAW_SPEC_1) | (1 << SD_RAW_SPEC_2)))
+    {
+        sd_raw_send_command(CMD_APP, 0);
+        sd_raw_send_command(CMD_SET_WR_BLK_ERASE_COUNT, blocks);
+    }
+
+    if (sd_raw_send_command(CMD_WRITE_MULTIPLE_BLOCK, sd_raw_block_arg(block)))
+    {
+        unselect_card();
+        return 0;
+    }
+
+    while (blocks--)
+    {
+        SPIRead();
+
+        /* send start byte */
+        SPIWrite(TOKEN_START_MULTI_BLOCK);
+
+        SPIDeviceSendData(buffer, 512);
+        buffer += 512;
+
+        /* write dummy crc16 */
+        SPIWrite(0xff);
+        SPIWrite(0xff);
+
+        response = SPIRead() & 0x1f;
+
+        /* wait while card is busy, it happens as the next block is sent */
+        if (!sd_raw_wait_ready())
+            response = 0;
+
+        if (response != DR_STATUS_ACCEPTED)
+            break;
+    }
+
+    /* stop the transfer, the card programs the last block while it is
+     * deselected and the next command waits for it
+     */
+    SPIWrite(TOKEN_STOP_TRAN);
+    SPIRead();
+    sd_raw_programming = 1;
+
+    /* deaddress card */
+    unselect_card();
+
+    /* let card some time to finish */
+    SPIRead();
+
+    return response == DR_STATUS_ACCEPTED;
+}
+#endif
+
+#if DOXYGEN || SD_RAW_WRITE_SUPPORT
+
 /**
  * \ingroup sd_raw
  * Writes the write buffer's content to the card.
@@ -670,16 +1438,53 @@ unsigned char sd_raw_write_interval(offset_t offset, unsigned char* buffer, uint
 unsigned char sd_raw_sync(void)
 {
 #if SD_RAW_WRITE_BUFFERING
-    if (raw_block_written)
-        return 1;
-    if (!sd_raw_write(raw_block_address, raw_block, sizeof (raw_block)))
-        return 0;
-    raw_block_written = 1;
+    unsigned char i;
+
+    for (i = 0; i < SD_RAW_CACHE_BLOCKS; ++i)
+    {
+        if (!sd_raw_cache_flush(i))
+            return 0;
+    }
 #endif
+
+    /* the last block written is on the card once it is programmed */
+    if (sd_raw_programming)
+    {
+        unsigned char ready;
+
+        select_card();
+        ready = sd_raw_wait_ready();
+        unselect_card();
+
+        return ready;
+    }
     return 1;
 }
 #endif
 
+/**
+ * \ingroup sd_raw
+ * Checks without waiting if the card has programmed the blocks written.
+ *
+ * The write functions return while the card programs the data, the next
+ * command waits for it. A task can call this first and come back later
+ * instead of waiting in the next access.
+ *
+ * \returns 0 while the card is busy, 1 when it is ready.
+ */
+unsigned char sd_raw_ready(void)
+{
+    if (!sd_raw_programming)
+        return 1;
+
+    select_card();
+    if (SPIRead() == 0xff)
+        sd_raw_programming = 0;
+    unselect_card();
+
+    return !sd_raw_programming;
+}
+
 /**
  * \ingroup sd_raw
  * Reads informational data from the card.
@@ -699,11 +1504,7 @@ unsigned char sd_raw_get_info(struct SDCardInfo* info)
 {
     unsigned char csd_read_bl_len = 0;
     unsigned char csd_c_size_mult = 0;
-#if SD_RAW_SDHC
-    unsigned int csd_c_size = 0;
-#else
     unsigned long csd_c_size = 0;
-#endif
     unsigned char csd_structure = 0;
 
     unsigned char i;
@@ -713,6 +1514,10 @@ unsigned char sd_raw_get_info(struct SDCardInfo* info)
 
     memset(info, 0, sizeof (*info));
 
+#if SD_RAW_READ_AHEAD
+    sd_raw_ahead_wait();
+#endif
+
     select_card();
 
     /* read cid register */
@@ -721,7 +1526,11 @@ unsigned char sd_raw_get_info(struct SDCardInfo* info)
         unselect_card();
         return 0;
     }
-    while (SPIRead() != 0xfe);
+    if (!sd_raw_wait_token())
+    {
+        unselect_card();
+        return 0;
+    }
     for (i = 0; i < 18; ++i)
     {
         unsigned char b = SPIRead();
@@ -767,7 +1576,11 @@ unsigned char sd_raw_get_info(struct SDCardInfo* info)
         unselect_card();
         return 0;
     }
-    while (SPIRead() != 0xfe);
+    if (!sd_raw_wait_token())
+    {
+        unselect_card();
+        return 0;
+    }
     for (i = 0; i < 18; ++i)
     {
         unsigned char b = SPIRead();
@@ -788,7 +1601,6 @@ unsigned char sd_raw_get_info(struct SDCardInfo* info)
         }
         else
         {
-#if SD_RAW_SDHC
             if (csd_structure == 0x01)
             {
                 switch (i)
@@ -803,12 +1615,11 @@ unsigned char sd_raw_get_info(struct SDCardInfo* info)
                 }
                 if (i == 9)
                 {
-                    ++csd_c_size;
-                    info->capacity = (offset_t) csd_c_size * 512 * 1024;
+                    /* units of 512 kB */
+                    info->blocks = (csd_c_size + 1) << 10;
                 }
             }
             else if (csd_structure == 0x00)
-#endif
             {
                 switch (i)
                 {
@@ -834,7 +1645,8 @@ unsigned char sd_raw_get_info(struct SDCardInfo* info)
                 case 10:
                     csd_c_size_mult |= b >> 7;
 
-                    info->capacity = (unsigned long) csd_c_size << (csd_c_size_mult + csd_read_bl_len + 2);
+                    /* the block length is at least 512 bytes */
+                    info->blocks = csd_c_size << (csd_c_size_mult + csd_read_bl_len + 2 - 9);
                     break;
                 }
             }
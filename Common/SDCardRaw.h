@@ -27,6 +27,30 @@
 #include <string.h>
 #include "SPIDevice.h"
 
+#ifdef __STM32F10x_H
+/* SPI1 pins are configured by SPIInit(), the select is PA4 */
+#define configure_pin_mosi()
+#define configure_pin_sck()
+#define configure_pin_ss()          SPIInitSelect(SD_RAW_CS_PORT, SD_RAW_CS_MASK)
+#define configure_pin_miso()
+
+#define select_card()               GPIO_ResetBits(SD_RAW_CS_PORT, SD_RAW_CS_MASK)
+#define unselect_card()             GPIO_SetBits(SD_RAW_CS_PORT, SD_RAW_CS_MASK)
+/* the same select for the transfers of the read ahead */
+#define SD_RAW_CS_PORT              GPIOA
+#define SD_RAW_CS_MASK              GPIO_Pin_4
+#elif defined(MOCKBUS_H)
+/* host build, the card is simulated on its chip select, see Simulation */
+#define configure_pin_mosi()
+#define configure_pin_sck()
+#define configure_pin_ss()
+#define configure_pin_miso()
+
+#define select_card()               MockSPISelect(MOCK_SPI_SD)
+#define unselect_card()             MockSPIDeselect(MOCK_SPI_SD)
+#define SD_RAW_CS_PORT              MOCK_SPI_SD
+#define SD_RAW_CS_MASK              0
+#else
 #define configure_pin_mosi()        (TRISCbits.TRISC4 = 1)
 #define configure_pin_sck()         (TRISCbits.TRISC3 = 0)
 #define configure_pin_ss()          (TRISBbits.RB4 = 0)
@@ -34,15 +58,21 @@
 
 #define select_card()               (TRISBbits.RB4 = 0)
 #define unselect_card()             (TRISBbits.RB4 = 1)
+/* the same select for the transfers of the read ahead */
+#define SD_RAW_CS_PORT              (&TRISB)
+#define SD_RAW_CS_MASK              0x10
+#endif
 
+/* no card detect nor write protect switch: always present, never locked,
+ * both switches are active low */
 #define get_pin_available()         (0)
-#define get_pin_locked()            (0)
+#define get_pin_locked()            (1)
 
-#if SD_RAW_SDHC
-typedef uint64_t offset_t;
-#else
-typedef unsigned long offset_t;
-#endif
+/**
+ * Number of a 512 byte block of the card, the unit of all the accesses. The
+ * blocks are numbered the same on SDSC and SDHC/SDXC cards.
+ */
+typedef unsigned long block_t;
 
 /**
  * The card's layout is harddisk-like, which means it contains
@@ -89,12 +119,66 @@ typedef unsigned long offset_t;
 #define SD_RAW_SAVE_RAM 1
 
 /**
- * Controls support for SDHC cards.
+ * \ingroup sd_raw_config
+ * Number of blocks of the cache, 512 bytes of RAM each.
  *
- * Set to 1 to support so-called SDHC memory cards, i.e. SD
- * cards with more than 2 gigabytes of memory.
+ * The least recently used block that is not pinned with sd_raw_pin() is
+ * replaced, and it is written back first if it was changed. More than one
+ * block keeps i.e. a FAT sector and a data sector cached together. Not used
+ * when SD_RAW_SAVE_RAM is 1.
+ *
+ * \note On the PIC18 the sdfat section of the linker script must hold
+ *       all the blocks.
  */
-#define SD_RAW_SDHC 0
+#ifndef SD_RAW_CACHE_BLOCKS
+#define SD_RAW_CACHE_BLOCKS 1
+#endif
+
+/**
+ * \ingroup sd_raw_config
+ * SPI clocks, in kHz.
+ *
+ * The card is identified at SD_RAW_INIT_KHZ (100 to 400 kHz), then
+ * sd_raw_init() raises the clock with SPISetClock() to the transfer rate of
+ * the card (TRAN_SPEED of its CSD), up to SD_RAW_MAX_KHZ. The clock stays at
+ * SD_RAW_INIT_KHZ when the CSD can't be read or doesn't read back the same
+ * at the fast clock.
+ */
+#ifndef SD_RAW_INIT_KHZ
+#define SD_RAW_INIT_KHZ 400
+#endif
+#ifndef SD_RAW_MAX_KHZ
+#define SD_RAW_MAX_KHZ 25000
+#endif
+
+/**
+ * \ingroup sd_raw_config
+ * Longest waits, in ms, for a data block after a read command and for the
+ * card to end being busy after a write. The access fails instead of hanging
+ * on a card that doesn't answer.
+ */
+#ifndef SD_RAW_READ_TIMEOUT
+#define SD_RAW_READ_TIMEOUT 100
+#endif
+#ifndef SD_RAW_WRITE_TIMEOUT
+#define SD_RAW_WRITE_TIMEOUT 500
+#endif
+
+/**
+ * \ingroup sd_raw_config
+ * Controls the read ahead of sequential reads.
+ *
+ * Set to 1 to read the next block into the cache in the background when
+ * sd_raw_read() goes from a block to the following one, so the block is
+ * already there when it is used. The block is read by the interrupt driven
+ * transfers of SPIDevice, SPIDeviceInterruptHandler() must be called from
+ * the interrupt routine (DMA1_Channel2_IRQHandler() on the STM32F1) and no
+ * other driver queues transfers while it runs. Needs SD_RAW_CACHE_BLOCKS of
+ * 2 or more.
+ */
+#ifndef SD_RAW_READ_AHEAD
+#define SD_RAW_READ_AHEAD 0
+#endif
 
 /* configuration checks */
 #if SD_RAW_WRITE_SUPPORT
@@ -105,6 +189,10 @@ typedef unsigned long offset_t;
 #define SD_RAW_WRITE_BUFFERING 0
 #endif
 
+#if SD_RAW_READ_AHEAD && (SD_RAW_SAVE_RAM || SD_RAW_CACHE_BLOCKS < 2)
+#error "SD_RAW_READ_AHEAD needs the cache and SD_RAW_CACHE_BLOCKS of 2 or more"
+#endif
+
 /* CMD0: response R1 */
 #define CMD_GO_IDLE_STATE 0x00
 /* CMD1: response R1 */
@@ -125,6 +213,8 @@ typedef unsigned long offset_t;
 #define CMD_READ_SINGLE_BLOCK 0x11
 /* CMD18: arg0[31:0]: data address, response R1 */
 #define CMD_READ_MULTIPLE_BLOCK 0x12
+/* ACMD23: arg0[22:0]: number of blocks to pre-erase, response R1 */
+#define CMD_SET_WR_BLK_ERASE_COUNT 0x17
 /* CMD24: arg0[31:0]: data address, response R1 */
 #define CMD_WRITE_SINGLE_BLOCK 0x18
 /* CMD25: arg0[31:0]: data address, response R1 */
@@ -198,6 +288,9 @@ typedef unsigned long offset_t;
 #define R3_ERASE_SEQ_ERR (R1_ERASE_SEQ_ERR + 32)
 #define R3_ADDR_ERR (R1_ADDR_ERR + 32)
 #define R3_PARAM_ERR (R1_PARAM_ERR + 32)
+/* Data tokens of the multiple block write */
+#define TOKEN_START_MULTI_BLOCK 0xfc
+#define TOKEN_STOP_TRAN 0xfd
 /* Data Response: size 1 byte */
 #define DR_STATUS_MASK 0x0e
 #define DR_STATUS_ACCEPTED 0x05
@@ -249,9 +342,9 @@ struct SDCardInfo
      */
     unsigned char manufacturing_month;
     /**
-     * The card's total capacity in bytes.
+     * The card's total capacity in 512 byte blocks.
      */
-    unsigned long capacity;
+    block_t blocks;
     /**
      * Defines wether the card's content is original or copied.
      *
@@ -282,18 +375,26 @@ struct SDCardInfo
     unsigned char format;
 };
 typedef unsigned long uintptr_t;
-typedef unsigned char (*sd_raw_read_interval_handler_t)(unsigned char* buffer, offset_t offset, void* p);
-typedef uintptr_t(*sd_raw_write_interval_handler_t)(unsigned char* buffer, offset_t offset, void* p);
+typedef unsigned char (*sd_raw_read_interval_handler_t)(unsigned char* buffer, block_t block, unsigned int offset, void* p);
+typedef uintptr_t(*sd_raw_write_interval_handler_t)(unsigned char* buffer, block_t block, unsigned int offset, void* p);
 
 unsigned char sd_raw_init();
 unsigned char sd_raw_available();
 unsigned char sd_raw_locked();
+unsigned char sd_raw_is_sdhc();
+unsigned long sd_raw_get_clock();
 
-unsigned char sd_raw_read(offset_t offset, unsigned char* buffer, uintptr_t length);
-unsigned char sd_raw_read_interval(offset_t offset, unsigned char* buffer, uintptr_t interval, uintptr_t length, sd_raw_read_interval_handler_t callback, void* p);
-unsigned char sd_raw_write(offset_t offset, const unsigned char* buffer, uintptr_t length);
-unsigned char sd_raw_write_interval(offset_t offset, unsigned char* buffer, uintptr_t length, sd_raw_write_interval_handler_t callback, void* p);
+unsigned char sd_raw_read(block_t block, unsigned int offset, unsigned char* buffer, uintptr_t length);
+unsigned char sd_raw_read_interval(block_t block, unsigned int offset, unsigned char* buffer, uintptr_t interval, uintptr_t length, sd_raw_read_interval_handler_t callback, void* p);
+unsigned char sd_raw_read_multi(block_t block, unsigned char* buffer, unsigned int blocks);
+unsigned char sd_raw_write(block_t block, unsigned int offset, const unsigned char* buffer, uintptr_t length);
+unsigned char sd_raw_write_multi(block_t block, const unsigned char* buffer, unsigned int blocks);
+unsigned char sd_raw_write_interval(block_t block, unsigned int offset, unsigned char* buffer, uintptr_t length, sd_raw_write_interval_handler_t callback, void* p);
 unsigned char sd_raw_sync();
+unsigned char sd_raw_ready();
+#if !SD_RAW_SAVE_RAM
+unsigned char sd_raw_pin(block_t block, unsigned char pin);
+#endif
 
 unsigned char sd_raw_get_info(struct SDCardInfo* info);
 
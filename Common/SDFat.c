@@ -0,0 +1,1110 @@
+/**
+ *  @file       SDFat.c
+ *  @author     Luis Maduro
+ *  @version    1.00
+ *  @date       14/10/2026
+ *  @brief      Minimal FAT16 and FAT32 files on a SD card.
+ *
+ *  Copyright (C) 2026  Luis Maduro
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "SDFat.h"
+
+/**End of a chain, written as 0xFFFF on FAT16.*/
+#define SDFAT_EOC                   0x0FFFFFFFUL
+
+/**Attributes of a directory entry.*/
+#define SDFAT_ATTR_READ_ONLY        0x01
+#define SDFAT_ATTR_VOLUME_ID        0x08
+#define SDFAT_ATTR_DIRECTORY        0x10
+#define SDFAT_ATTR_ARCHIVE          0x20
+
+/**Results of SDFatLookup().*/
+#define SDFAT_ENTRY_FOUND           0
+#define SDFAT_ENTRY_FREE            1
+#define SDFAT_ENTRY_NONE            2
+
+/**
+ * Directory entry, 32 bytes.
+ */
+typedef struct
+{
+    char Name[11];
+    uint8_t Attributes;
+    uint8_t Reserved[8];
+    uint16_t ClusterHigh;
+    uint8_t Time[4];
+    uint16_t ClusterLow;
+    uint32_t Size;
+} tSDFatEntry;
+
+static bool mounted;
+static bool fat32;
+/**First block of the first FAT, blocks of a FAT and number of FATs.*/
+static block_t fatStart;
+static uint32_t fatBlocks;
+static unsigned char fatCount;
+/**Root directory of FAT16, rootBlocks is 0 on FAT32.*/
+static block_t rootStart;
+static unsigned int rootBlocks;
+static uint32_t rootCluster;
+/**Block of cluster 2, the first one.*/
+static block_t dataStart;
+/**Blocks of a cluster, 1 << clusterShift.*/
+static unsigned char clusterShift;
+static uint32_t clusterCount;
+/**Where the search of free clusters starts.*/
+static uint32_t freeHint;
+
+/**
+ * Reads a little endian 16 bit value.
+ * @param bytes Value.
+ * @return Value.
+ */
+static uint16_t SDFatGet16(const unsigned char *bytes)
+{
+    return (uint16_t) bytes[0] | ((uint16_t) bytes[1] << 8);
+}
+
+/**
+ * Reads a little endian 32 bit value.
+ * @param bytes Value.
+ * @return Value.
+ */
+static uint32_t SDFatGet32(const unsigned char *bytes)
+{
+    return (uint32_t) SDFatGet16(bytes) | ((uint32_t) SDFatGet16(bytes + 2) << 16);
+}
+
+/**
+ * Tells if a FAT entry ends a chain (end of chain, bad or free cluster).
+ * @param cluster Entry.
+ * @return True if there is no next cluster.
+ */
+static bool SDFatIsEnd(uint32_t cluster)
+{
+    return (cluster < 2) || (cluster > clusterCount + 1);
+}
+
+/**
+ * Reads the FAT entry of a cluster.
+ * @param cluster Cluster.
+ * @param next Next cluster of the chain, 0 if it is free.
+ * @return False if the card failed.
+ */
+static bool SDFatGetEntry(uint32_t cluster, uint32_t *next)
+{
+    uint32_t offset;
+    uint16_t value;
+
+    if (fat32)
+    {
+        offset = cluster << 2;
+
+        if (!sd_raw_read(fatStart + (offset >> 9), offset & 0x1ff,
+                         (unsigned char *) next, sizeof (*next)))
+        {
+            return false;
+        }
+
+        *next &= 0x0FFFFFFFUL;
+    }
+    else
+    {
+        offset = cluster << 1;
+
+        if (!sd_raw_read(fatStart + (offset >> 9), offset & 0x1ff,
+                         (unsigned char *) &value, sizeof (value)))
+        {
+            return false;
+        }
+
+        *next = value;
+    }
+
+    return true;
+}
+
+/**
+ * Writes the FAT entry of a cluster in all the FATs.
+ * @param cluster Cluster.
+ * @param next Next cluster, SDFAT_EOC or 0 to free it.
+ * @return False if the card failed.
+ */
+static bool SDFatSetEntry(uint32_t cluster, uint32_t next)
+{
+    uint32_t offset;
+    uint32_t value;
+    uint16_t value16;
+    block_t block;
+    unsigned char i;
+
+    offset = fat32 ? (cluster << 2) : (cluster << 1);
+    block = fatStart + (offset >> 9);
+
+    for (i = 0; i < fatCount; i++, block += fatBlocks)
+    {
+        if (fat32)
+        {
+            //the 4 high bits are reserved
+            if (!sd_raw_read(block, offset & 0x1ff, (unsigned char *) &value, sizeof (value)))
+            {
+                return false;
+            }
+
+            value = (value & 0xF0000000UL) | (next & 0x0FFFFFFFUL);
+
+            if (!sd_raw_write(block, offset & 0x1ff, (const unsigned char *) &value, sizeof (value)))
+            {
+                return false;
+            }
+        }
+        else
+        {
+            value16 = (uint16_t) next;
+
+            if (!sd_raw_write(block, offset & 0x1ff, (const unsigned char *) &value16, sizeof (value16)))
+            {
+                return false;
+            }
+        }
+    }
+
+    return true;
+}
+
+/**
+ * Finds a run of free clusters.
+ * @param start Cluster where the search starts, it goes round the FAT once.
+ * @param count Clusters of the run.
+ * @return First cluster of the run, 0 if there is none.
+ */
+static uint32_t SDFatFindFree(uint32_t start, uint32_t count)
+{
+    uint32_t cluster = start;
+    uint32_t first = 0;
+    uint32_t length = 0;
+    uint32_t scanned;
+    uint32_t next;
+
+    for (scanned = 0; scanned < clusterCount; scanned++, cluster++)
+    {
+        //a run doesn't go round the end
+        if ((cluster < 2) || (cluster > clusterCount + 1))
+        {
+            cluster = 2;
+            length = 0;
+        }
+
+        if (!SDFatGetEntry(cluster, &next))
+        {
+            return 0;
+        }
+
+        if (next != 0)
+        {
+            length = 0;
+            continue;
+        }
+
+        if (length == 0)
+        {
+            first = cluster;
+        }
+
+        if (++length == count)
+        {
+            return first;
+        }
+    }
+
+    return 0;
+}
+
+/**
+ * Prepares a file (or a directory) with no runs.
+ * @param file File.
+ * @param cluster First cluster.
+ */
+static void SDFatInitFile(tSDFatFile *file, uint32_t cluster)
+{
+    file->Size = 0;
+    file->Position = 0;
+    file->FirstCluster = cluster;
+    file->EntryBlock = 0;
+    file->EntryOffset = 0;
+    file->RunCount = 0;
+    file->RunsEnd = false;
+    file->Changed = false;
+    file->Mode = 0;
+}
+
+/**
+ * Finds the run of a cluster of a file, the chain is walked from the last
+ * run if it is not kept.
+ * @param file File.
+ * @param index Cluster of the file.
+ * @return Run, NULL if the chain is shorter or the card failed.
+ */
+static tSDFatRun *SDFatFindRun(tSDFatFile *file, uint32_t index)
+{
+    tSDFatRun *run;
+    uint32_t next;
+    unsigned char i;
+
+    if (file->FirstCluster == 0)
+    {
+        return NULL;
+    }
+
+    if ((file->RunCount == 0) || (index < file->Runs[0].Index))
+    {
+        file->Runs[0].Index = 0;
+        file->Runs[0].Cluster = file->FirstCluster;
+        file->Runs[0].Length = 1;
+        file->RunCount = 1;
+        file->RunsEnd = false;
+    }
+
+    for (;;)
+    {
+        for (i = 0; i < file->RunCount; i++)
+        {
+            if (index - file->Runs[i].Index < file->Runs[i].Length)
+            {
+                return &file->Runs[i];
+            }
+        }
+
+        if (file->RunsEnd)
+        {
+            return NULL;
+        }
+
+        run = &file->Runs[file->RunCount - 1];
+
+        if (!SDFatGetEntry(run->Cluster + run->Length - 1, &next))
+        {
+            return NULL;
+        }
+
+        if (SDFatIsEnd(next))
+        {
+            file->RunsEnd = true;
+        }
+        else if (next == run->Cluster + run->Length)
+        {
+            run->Length++;
+        }
+        else
+        {
+            if (file->RunCount == SDFAT_RUNS)
+            {
+                file->Runs[0] = *run;
+                file->RunCount = 1;
+                run = &file->Runs[0];
+            }
+
+            file->Runs[file->RunCount].Index = run->Index + run->Length;
+            file->Runs[file->RunCount].Cluster = next;
+            file->Runs[file->RunCount].Length = 1;
+            file->RunCount++;
+        }
+    }
+}
+
+/**
+ * Gives the card block of a position of a file.
+ * @param run Run of the position.
+ * @param position Position.
+ * @return Block.
+ */
+static block_t SDFatBlock(const tSDFatRun *run, uint32_t position)
+{
+    uint32_t cluster = run->Cluster + ((position >> (9 + clusterShift)) - run->Index);
+
+    return dataStart + ((block_t) (cluster - 2) << clusterShift)
+            + ((position >> 9) & ((1U << clusterShift) - 1));
+}
+
+/**
+ * Gives the blocks of a run from a position to its end.
+ * @param run Run of the position.
+ * @param position Position.
+ * @return Blocks.
+ */
+static block_t SDFatRunBlocks(const tSDFatRun *run, uint32_t position)
+{
+    return ((block_t) (run->Index + run->Length) << clusterShift) - (position >> 9);
+}
+
+/**
+ * Adds a run of free clusters to the end of the chain of a file, after its
+ * last cluster if they are free.
+ * @param file File.
+ * @param count Clusters.
+ * @return False if there is no run of free clusters that long or the card
+ *         failed.
+ */
+static bool SDFatExtend(tSDFatFile *file, uint32_t count)
+{
+    tSDFatRun *run = NULL;
+    uint32_t last = 0;
+    uint32_t first;
+    uint32_t i;
+
+    if (file->FirstCluster != 0)
+    {
+        SDFatFindRun(file, 0xFFFFFFFFUL);
+
+        if (!file->RunsEnd)
+        {
+            return false;
+        }
+
+        run = &file->Runs[file->RunCount - 1];
+        last = run->Cluster + run->Length - 1;
+    }
+
+    first = SDFatFindFree((last != 0) ? last + 1 : freeHint, count);
+
+    if (first == 0)
+    {
+        return false;
+    }
+
+    //the new clusters are chained before the file is linked to them
+    for (i = 0; i < count; i++)
+    {
+        if (!SDFatSetEntry(first + i, (i + 1 < count) ? first + i + 1 : SDFAT_EOC))
+        {
+            return false;
+        }
+    }
+
+    freeHint = first + count;
+
+    if (run == NULL)
+    {
+        file->FirstCluster = first;
+        file->Changed = true;
+        file->Runs[0].Index = 0;
+        file->Runs[0].Cluster = first;
+        file->Runs[0].Length = count;
+        file->RunCount = 1;
+        file->RunsEnd = true;
+
+        return true;
+    }
+
+    if (!SDFatSetEntry(last, first))
+    {
+        return false;
+    }
+
+    if (first == last + 1)
+    {
+        run->Length += count;
+        return true;
+    }
+
+    if (file->RunCount == SDFAT_RUNS)
+    {
+        file->Runs[0] = *run;
+        file->RunCount = 1;
+        run = &file->Runs[0];
+    }
+
+    file->Runs[file->RunCount].Index = run->Index + run->Length;
+    file->Runs[file->RunCount].Cluster = first;
+    file->Runs[file->RunCount].Length = count;
+    file->RunCount++;
+
+    return true;
+}
+
+/**
+ * Frees the clusters of a file after its size, i.e. the ones preallocated
+ * and not written.
+ * @param file File.
+ * @return False if the card failed.
+ */
+static bool SDFatTrim(tSDFatFile *file)
+{
+    tSDFatRun *run;
+    uint32_t keep;
+    uint32_t last;
+    uint32_t cluster;
+    uint32_t next;
+
+    if (file->FirstCluster == 0)
+    {
+        return true;
+    }
+
+    keep = (file->Size + (512UL << clusterShift) - 1) >> (9 + clusterShift);
+
+    if (keep == 0)
+    {
+        cluster = file->FirstCluster;
+        file->FirstCluster = 0;
+        file->Changed = true;
+    }
+    else
+    {
+        run = SDFatFindRun(file, keep - 1);
+
+        if (run == NULL)
+        {
+            return false;
+        }
+
+        last = run->Cluster + (keep - 1 - run->Index);
+
+        if (!SDFatGetEntry(last, &cluster))
+        {
+            return false;
+        }
+
+        if (SDFatIsEnd(cluster))
+        {
+            return true;
+        }
+
+        if (!SDFatSetEntry(last, SDFAT_EOC))
+        {
+            return false;
+        }
+    }
+
+    while (!SDFatIsEnd(cluster))
+    {
+        if (!SDFatGetEntry(cluster, &next) || !SDFatSetEntry(cluster, 0))
+        {
+            return false;
+        }
+
+        if (cluster < freeHint)
+        {
+            freeHint = cluster;
+        }
+
+        cluster = next;
+    }
+
+    file->RunCount = 0;
+
+    return true;
+}
+
+/**
+ * Converts the first name of a path to the 8.3 form of the entries.
+ * @param path Path.
+ * @param name The 11 characters of the name, in upper case and padded with
+ *             spaces.
+ * @return Rest of the path, NULL if the name is not valid.
+ */
+static const char *SDFatName(const char *path, char *name)
+{
+    unsigned char i = 0;
+    unsigned char limit = 8;
+    char c;
+
+    memset(name, ' ', 11);
+
+    while (((c = *path) != '\0') && (c != '/'))
+    {
+        path++;
+
+        if (c == '.')
+        {
+            if ((limit == 11) || (i == 0))
+            {
+                return NULL;
+            }
+
+            i = 8;
+            limit = 11;
+            continue;
+        }
+
+        if (i == limit)
+        {
+            return NULL;
+        }
+
+        if ((c >= 'a') && (c <= 'z'))
+        {
+            c -= 'a' - 'A';
+        }
+
+        name[i++] = c;
+    }
+
+    return (name[0] == ' ') ? NULL : path;
+}
+
+/**
+ * Gives the block of an entry of a directory.
+ * @param dir Directory, FirstCluster 0 for the root directory of FAT16.
+ * @param position Byte of the entry.
+ * @param block Block.
+ * @return False past the end of the directory or if the card failed.
+ */
+static bool SDFatEntryBlock(tSDFatFile *dir, uint32_t position, block_t *block)
+{
+    tSDFatRun *run;
+
+    if (dir->FirstCluster == 0)
+    {
+        if (position >= (uint32_t) rootBlocks * 512)
+        {
+            return false;
+        }
+
+        *block = rootStart + (position >> 9);
+        return true;
+    }
+
+    run = SDFatFindRun(dir, position >> (9 + clusterShift));
+
+    if (run == NULL)
+    {
+        return false;
+    }
+
+    *block = SDFatBlock(run, position);
+
+    return true;
+}
+
+/**
+ * Looks for a name in a directory.
+ * @param dir Directory.
+ * @param name Name, 8.3 form.
+ * @param entry Entry found.
+ * @param block Block of the entry found, or of the first free one.
+ * @param offset Byte of the entry in the block.
+ * @return SDFAT_ENTRY_FOUND, SDFAT_ENTRY_FREE if it was not found or
+ *         SDFAT_ENTRY_NONE if there is no free entry either.
+ */
+static unsigned char SDFatLookup(tSDFatFile *dir, const char *name, tSDFatEntry *entry,
+                                 block_t *block, unsigned int *offset)
+{
+    uint32_t position;
+    block_t at;
+    bool freeFound = false;
+
+    for (position = 0; SDFatEntryBlock(dir, position, &at); position += sizeof (*entry))
+    {
+        if (!sd_raw_read(at, position & 0x1ff, (unsigned char *) entry, sizeof (*entry)))
+        {
+            break;
+        }
+
+        if ((entry->Name[0] == 0x00) || ((unsigned char) entry->Name[0] == 0xE5))
+        {
+            if (!freeFound)
+            {
+                freeFound = true;
+                *block = at;
+                *offset = position & 0x1ff;
+            }
+
+            //0 ends the directory
+            if (entry->Name[0] == 0x00)
+            {
+                break;
+            }
+
+            continue;
+        }
+
+        //volume label and long names
+        if (entry->Attributes & SDFAT_ATTR_VOLUME_ID)
+        {
+            continue;
+        }
+
+        if (memcmp(entry->Name, name, 11) == 0)
+        {
+            *block = at;
+            *offset = position & 0x1ff;
+            return SDFAT_ENTRY_FOUND;
+        }
+    }
+
+    return freeFound ? SDFAT_ENTRY_FREE : SDFAT_ENTRY_NONE;
+}
+
+/**
+ * Reads the boot sector of the first FAT16 or FAT32 partition of the card,
+ * or of the card itself. The card is initialized with sd_raw_init() before.
+ * @return False if there is no FAT16 or FAT32 volume.
+ */
+bool SDFatMount(void)
+{
+    unsigned char boot[64];
+    unsigned char partition[16];
+    block_t first = 0;
+    uint32_t total;
+    unsigned char i;
+
+    mounted = false;
+
+    if (!sd_raw_read(0, 0, boot, sizeof (boot)))
+    {
+        return false;
+    }
+
+    //a boot sector starts with a jump and has 512 byte sectors
+    if (((boot[0] != 0xEB) && (boot[0] != 0xE9)) || (SDFatGet16(&boot[11]) != 512))
+    {
+        for (i = 0; i < 4; i++)
+        {
+            if (!sd_raw_read(0, 446 + i * 16, partition, sizeof (partition)))
+            {
+                return false;
+            }
+
+            if ((partition[4] == 0x04) || (partition[4] == 0x06) || (partition[4] == 0x0E)
+                    || (partition[4] == 0x0B) || (partition[4] == 0x0C))
+            {
+                first = SDFatGet32(&partition[8]);
+                break;
+            }
+        }
+
+        if ((i == 4) || !sd_raw_read(first, 0, boot, sizeof (boot))
+                || (SDFatGet16(&boot[11]) != 512))
+        {
+            return false;
+        }
+    }
+
+    for (clusterShift = 0; (1U << clusterShift) < boot[13]; clusterShift++);
+
+    if ((boot[13] == 0) || ((1U << clusterShift) != boot[13]) || (boot[16] == 0))
+    {
+        return false;
+    }
+
+    fatCount = boot[16];
+    fatBlocks = SDFatGet16(&boot[22]);
+    if (fatBlocks == 0)
+    {
+        fatBlocks = SDFatGet32(&boot[36]);
+    }
+
+    total = SDFatGet16(&boot[19]);
+    if (total == 0)
+    {
+        total = SDFatGet32(&boot[32]);
+    }
+
+    fatStart = first + SDFatGet16(&boot[14]);
+    rootStart = fatStart + fatCount * fatBlocks;
+    rootBlocks = (SDFatGet16(&boot[17]) + 15) / 16;
+    dataStart = rootStart + rootBlocks;
+
+    if (total <= dataStart - first)
+    {
+        return false;
+    }
+
+    clusterCount = (total - (dataStart - first)) >> clusterShift;
+
+    //FAT12 is not supported
+    if (clusterCount < 4085)
+    {
+        return false;
+    }
+
+    fat32 = (clusterCount >= 65525);
+    rootCluster = fat32 ? SDFatGet32(&boot[44]) : 0;
+    freeHint = 2;
+    mounted = true;
+
+    return true;
+}
+
+/**
+ * Opens a file.
+ * @param file File.
+ * @param path Path from the root directory, 8.3 names separated by '/'.
+ * @param mode SDFAT_READ, SDFAT_WRITE, SDFAT_CREATE and SDFAT_APPEND.
+ * @return False if it doesn't exist (and is not created) or can't be
+ *         written.
+ */
+bool SDFatOpen(tSDFatFile *file, const char *path, unsigned char mode)
+{
+    tSDFatFile dir;
+    tSDFatEntry entry;
+    char name[11];
+    block_t block;
+    unsigned int offset;
+    unsigned char found;
+
+    if (!mounted)
+    {
+        return false;
+    }
+
+    SDFatInitFile(&dir, rootCluster);
+
+    for (;;)
+    {
+        while (*path == '/')
+        {
+            path++;
+        }
+
+        path = SDFatName(path, name);
+
+        if (path == NULL)
+        {
+            return false;
+        }
+
+        found = SDFatLookup(&dir, name, &entry, &block, &offset);
+
+        if (*path == '\0')
+        {
+            break;
+        }
+
+        if ((found != SDFAT_ENTRY_FOUND) || !(entry.Attributes & SDFAT_ATTR_DIRECTORY))
+        {
+            return false;
+        }
+
+        SDFatInitFile(&dir, ((uint32_t) entry.ClusterHigh << 16) | entry.ClusterLow);
+    }
+
+    if (found == SDFAT_ENTRY_FOUND)
+    {
+        if ((entry.Attributes & SDFAT_ATTR_DIRECTORY)
+                || ((mode & SDFAT_WRITE) && (entry.Attributes & SDFAT_ATTR_READ_ONLY)))
+        {
+            return false;
+        }
+    }
+    else
+    {
+        if (!(mode & SDFAT_CREATE) || (found != SDFAT_ENTRY_FREE))
+        {
+            return false;
+        }
+
+        memset(&entry, 0, sizeof (entry));
+        memcpy(entry.Name, name, sizeof (entry.Name));
+        entry.Attributes = SDFAT_ATTR_ARCHIVE;
+
+        if (!sd_raw_write(block, offset, (const unsigned char *) &entry, sizeof (entry)))
+        {
+            return false;
+        }
+    }
+
+    SDFatInitFile(file, ((uint32_t) entry.ClusterHigh << 16) | entry.ClusterLow);
+    file->Size = entry.Size;
+    file->EntryBlock = block;
+    file->EntryOffset = offset;
+    file->Mode = mode;
+
+    if (mode & SDFAT_APPEND)
+    {
+        file->Position = file->Size;
+    }
+
+    return true;
+}
+
+/**
+ * Reads from the position of a file, the whole blocks of a run are read
+ * with one command.
+ * @param file File.
+ * @param buffer Buffer.
+ * @param length Bytes to read.
+ * @return Bytes read, less at the end of the file or if the card failed.
+ */
+unsigned int SDFatRead(tSDFatFile *file, void *buffer, unsigned int length)
+{
+    unsigned char *bytes = buffer;
+    unsigned int done = 0;
+    unsigned int offset;
+    unsigned int part;
+    block_t blocks;
+    tSDFatRun *run;
+
+    if (file->Position >= file->Size)
+    {
+        return 0;
+    }
+
+    if (length > file->Size - file->Position)
+    {
+        length = file->Size - file->Position;
+    }
+
+    while (length > 0)
+    {
+        run = SDFatFindRun(file, file->Position >> (9 + clusterShift));
+
+        if (run == NULL)
+        {
+            break;
+        }
+
+        offset = file->Position & 0x1ff;
+
+        if ((offset == 0) && (length >= 512))
+        {
+            blocks = SDFatRunBlocks(run, file->Position);
+
+            if (blocks > (length >> 9))
+            {
+                blocks = length >> 9;
+            }
+
+            if (!sd_raw_read_multi(SDFatBlock(run, file->Position), bytes, (unsigned int) blocks))
+            {
+                break;
+            }
+
+            part = (unsigned int) blocks << 9;
+        }
+        else
+        {
+            part = 512 - offset;
+
+            if (part > length)
+            {
+                part = length;
+            }
+
+            if (!sd_raw_read(SDFatBlock(run, file->Position), offset, bytes, part))
+            {
+                break;
+            }
+        }
+
+        bytes += part;
+        length -= part;
+        done += part;
+        file->Position += part;
+    }
+
+    return done;
+}
+
+/**
+ * Writes at the position of a file, the clusters past the end of the chain
+ * are allocated one at a time, see SDFatPreallocate(). The whole blocks of a
+ * run are written with one command, the size in the directory changes with
+ * SDFatSync().
+ * @param file File opened with SDFAT_WRITE.
+ * @param data Data.
+ * @param length Bytes to write.
+ * @return Bytes written, less if the card is full or failed.
+ */
+unsigned int SDFatWrite(tSDFatFile *file, const void *data, unsigned int length)
+{
+    const unsigned char *bytes = data;
+    unsigned int done = 0;
+    unsigned int offset;
+    unsigned int part;
+    block_t blocks;
+    tSDFatRun *run;
+
+    if (!(file->Mode & SDFAT_WRITE))
+    {
+        return 0;
+    }
+
+    while (length > 0)
+    {
+        run = SDFatFindRun(file, file->Position >> (9 + clusterShift));
+
+        if (run == NULL)
+        {
+            if (!SDFatExtend(file, 1))
+            {
+                break;
+            }
+
+            continue;
+        }
+
+        offset = file->Position & 0x1ff;
+
+        if ((offset == 0) && (length >= 512))
+        {
+            blocks = SDFatRunBlocks(run, file->Position);
+
+            if (blocks > (length >> 9))
+            {
+                blocks = length >> 9;
+            }
+
+            if (!sd_raw_write_multi(SDFatBlock(run, file->Position), bytes, (unsigned int) blocks))
+            {
+                break;
+            }
+
+            part = (unsigned int) blocks << 9;
+        }
+        else
+        {
+            part = 512 - offset;
+
+            if (part > length)
+            {
+                part = length;
+            }
+
+            if (!sd_raw_write(SDFatBlock(run, file->Position), offset, bytes, part))
+            {
+                break;
+            }
+        }
+
+        bytes += part;
+        length -= part;
+        done += part;
+        file->Position += part;
+
+        if (file->Position > file->Size)
+        {
+            file->Size = file->Position;
+            file->Changed = true;
+        }
+    }
+
+    return done;
+}
+
+/**
+ * Moves the position of a file.
+ * @param file File.
+ * @param position Position, up to the size.
+ * @return False if it is past the size.
+ */
+bool SDFatSeek(tSDFatFile *file, uint32_t position)
+{
+    if (position > file->Size)
+    {
+        return false;
+    }
+
+    file->Position = position;
+
+    return true;
+}
+
+/**
+ * Allocates the clusters for a size of a file as one run, so that it is
+ * written with multiple block commands and without looking for free
+ * clusters. The size of the file doesn't change, the clusters not written
+ * are freed by SDFatClose().
+ * @param file File opened with SDFAT_WRITE.
+ * @param size Size.
+ * @return False if there is no run of free clusters that long or the card
+ *         failed.
+ */
+bool SDFatPreallocate(tSDFatFile *file, uint32_t size)
+{
+    uint32_t clusters;
+    uint32_t allocated = 0;
+
+    if (!(file->Mode & SDFAT_WRITE))
+    {
+        return false;
+    }
+
+    clusters = (size + (512UL << clusterShift) - 1) >> (9 + clusterShift);
+
+    if (file->FirstCluster != 0)
+    {
+        SDFatFindRun(file, 0xFFFFFFFFUL);
+
+        if (!file->RunsEnd)
+        {
+            return false;
+        }
+
+        allocated = file->Runs[file->RunCount - 1].Index + file->Runs[file->RunCount - 1].Length;
+    }
+
+    if (clusters <= allocated)
+    {
+        return true;
+    }
+
+    return SDFatExtend(file, clusters - allocated);
+}
+
+/**
+ * Writes the size and the first cluster of a file to its directory entry
+ * and the cached blocks to the card.
+ * @param file File.
+ * @return False if the card failed.
+ */
+bool SDFatSync(tSDFatFile *file)
+{
+    tSDFatEntry entry;
+
+    if (file->Changed)
+    {
+        if (!sd_raw_read(file->EntryBlock, file->EntryOffset, (unsigned char *) &entry, sizeof (entry)))
+        {
+            return false;
+        }
+
+        entry.ClusterHigh = (uint16_t) (file->FirstCluster >> 16);
+        entry.ClusterLow = (uint16_t) file->FirstCluster;
+        entry.Size = file->Size;
+        entry.Attributes |= SDFAT_ATTR_ARCHIVE;
+
+        if (!sd_raw_write(file->EntryBlock, file->EntryOffset, (const unsigned char *) &entry, sizeof (entry)))
+        {
+            return false;
+        }
+
+        file->Changed = false;
+    }
+
+    return sd_raw_sync();
+}
+
+/**
+ * Closes a file, the clusters preallocated and not written are freed.
+ * @param file File.
+ * @return False if the card failed.
+ */
+bool SDFatClose(tSDFatFile *file)
+{
+    bool ok = true;
+
+    if (file->Mode & SDFAT_WRITE)
+    {
+        ok = SDFatTrim(file) && SDFatSync(file);
+    }
+
+    file->Mode = 0;
+
+    return ok;
+}
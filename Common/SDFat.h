@@ -0,0 +1,98 @@
+/**
+ *  @file       SDFat.h
+ *  @author     Luis Maduro
+ *  @version    1.00
+ *  @date       14/10/2026
+ *  @brief      Minimal FAT16 and FAT32 files on a SD card.
+ *
+ *  Reads and writes the files of the first FAT16 or FAT32 partition of the
+ *  card (or of a card without a partition table), with 8.3 names in a path
+ *  of existing directories ("LOG/DATA.BIN"). Long names are skipped, files
+ *  are created in the free entries of their directory, which is not grown.
+ *
+ *  The FAT and the directories go through the block cache of SDCardRaw.c,
+ *  with SD_RAW_CACHE_BLOCKS of 2 or more a FAT block stays cached next to a
+ *  data block. A file keeps the clusters of its chain as runs of
+ *  consecutive clusters (first cluster, length), so the FAT is walked once
+ *  and the whole blocks of a run are read and written with the multiple
+ *  block commands. SDFatPreallocate() takes a run of free clusters in one
+ *  go for a file that is streamed.
+ *
+ *  Copyright (C) 2026  Luis Maduro
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef SDFAT_H
+#define SDFAT_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "SDCardRaw.h"
+
+/**Runs of the chain kept by a file. Past the last one the runs start again
+ from it, so only seeking back walks the FAT again.*/
+#ifndef SDFAT_RUNS
+#define SDFAT_RUNS                  4
+#endif
+
+/**Modes of SDFatOpen().*/
+#define SDFAT_READ                  0x01
+#define SDFAT_WRITE                 0x02
+/**Creates the file if it doesn't exist.*/
+#define SDFAT_CREATE                0x04
+/**Starts at the end of the file.*/
+#define SDFAT_APPEND                0x08
+
+/**
+ * Consecutive clusters of a chain.
+ */
+typedef struct
+{
+    /**Cluster of the file, from 0, of the first one.*/
+    uint32_t Index;
+    uint32_t Cluster;
+    uint32_t Length;
+} tSDFatRun;
+
+/**
+ * An open file.
+ */
+typedef struct
+{
+    uint32_t Size;
+    uint32_t Position;
+    uint32_t FirstCluster;
+    /**Block and byte of the directory entry.*/
+    block_t EntryBlock;
+    unsigned int EntryOffset;
+    tSDFatRun Runs[SDFAT_RUNS];
+    unsigned char RunCount;
+    /**The last run ends the chain.*/
+    bool RunsEnd;
+    /**The size or the first cluster are to be written to the entry.*/
+    bool Changed;
+    unsigned char Mode;
+} tSDFatFile;
+
+bool SDFatMount(void);
+bool SDFatOpen(tSDFatFile *file, const char *path, unsigned char mode);
+unsigned int SDFatRead(tSDFatFile *file, void *buffer, unsigned int length);
+unsigned int SDFatWrite(tSDFatFile *file, const void *data, unsigned int length);
+bool SDFatSeek(tSDFatFile *file, uint32_t position);
+bool SDFatPreallocate(tSDFatFile *file, uint32_t size);
+bool SDFatSync(tSDFatFile *file);
+bool SDFatClose(tSDFatFile *file);
+
+#endif /* SDFAT_H */
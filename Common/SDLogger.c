@@ -0,0 +1,577 @@
+/**
+ *  @file       SDLogger.c
+ *  @author     Luis Maduro
+ *  @version    1.00
+ *  @date       14/10/2026
+ *  @brief      Append only logger on a contiguous region of a SD card.
+ *
+ *  Copyright (C) 2026  Luis Maduro
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "SDLogger.h"
+#include "CRCDevice.h"
+
+/**"SDLG", marks a valid index.*/
+#define SDLOGGER_MAGIC              0x474C4453UL
+
+/**
+ * Start of every data block.
+ */
+typedef struct
+{
+    uint32_t Sequence;
+    uint16_t Session;
+    /**Bytes of records in the block, up to SDLOGGER_PAYLOAD_SIZE.*/
+    uint16_t Length;
+    /**CRC of the fields before and of the records.*/
+    uint32_t Check;
+} tSDLoggerHeader;
+
+/**
+ * Copy of the index at the start of the region.
+ */
+typedef struct
+{
+    uint32_t Magic;
+    /**Incremented on every write, the larger one of the copies is used.*/
+    uint32_t Index;
+    /**Sequence of the next data block when it was written.*/
+    uint32_t Head;
+    /**Incremented by SDLoggerFormat(), blocks of an older log don't match.*/
+    uint16_t Session;
+    uint16_t Check;
+} tSDLoggerIndex;
+
+tSDLoggerStatistics SDLoggerStatistics;
+
+#pragma udata sdlogger
+static unsigned char buffers[2][SDLOGGER_BUFFER_BLOCKS * 512];
+#pragma udata
+
+static block_t regionFirst;
+static block_t dataBlocks;
+static bool mounted;
+static uint16_t session;
+static uint32_t indexCount;
+/**Sequence of the next block written to the card, and when the index was
+ last written.*/
+static uint32_t head;
+static uint32_t indexHead;
+/**Sequence of the next block closed in the buffer.*/
+static uint32_t fillSequence;
+/**Half, block and byte in it of the next record.*/
+static unsigned char fillHalf;
+static unsigned char fillBlock;
+static unsigned int fillByte;
+/**Blocks of a half waiting to be written, 0 when it is free.*/
+static volatile unsigned char halfBlocks[2];
+/**Blocks of the waiting half already written, after a failed write.*/
+static unsigned char halfWritten;
+
+/**
+ * Gives the check of an index, the low half of the CRC of its fields.
+ * @param index Index.
+ * @return Check.
+ */
+static uint16_t SDLoggerCheck(const tSDLoggerIndex *index)
+{
+    return (uint16_t) CRCDeviceCompute(CRC_DEVICE_INIT, index,
+                                       sizeof (*index) - sizeof (index->Check));
+}
+
+/**
+ * Gives the check of a data block.
+ * @param header Its header.
+ * @param records Its records, header->Length bytes.
+ * @return Check.
+ */
+static uint32_t SDLoggerBlockCheck(const tSDLoggerHeader *header, const unsigned char *records)
+{
+    return CRCDeviceCompute(CRCDeviceCompute(CRC_DEVICE_INIT, header,
+                                             sizeof (*header) - sizeof (header->Check)),
+                            records, header->Length);
+}
+
+/**
+ * Reads a copy of the index.
+ * @param copy Copy, 0 or 1.
+ * @param index Index read.
+ * @return True if it is valid.
+ */
+static bool SDLoggerReadIndex(unsigned char copy, tSDLoggerIndex *index)
+{
+    if (!sd_raw_read(regionFirst + copy, 0, (unsigned char *) index, sizeof (*index)))
+    {
+        return false;
+    }
+
+    return (index->Magic == SDLOGGER_MAGIC) && (index->Check == SDLoggerCheck(index));
+}
+
+/**
+ * Finds the newest valid copy of the index.
+ * @param index Index found.
+ * @return False if there is none.
+ */
+static bool SDLoggerNewestIndex(tSDLoggerIndex *index)
+{
+    tSDLoggerIndex other;
+    bool valid;
+
+    valid = SDLoggerReadIndex(0, index);
+
+    if (SDLoggerReadIndex(1, &other)
+            && (!valid || ((int32_t) (other.Index - index->Index) > 0)))
+    {
+        *index = other;
+        valid = true;
+    }
+
+    return valid;
+}
+
+/**
+ * Writes the write head to the older copy of the index.
+ * @return False if the card failed.
+ */
+static bool SDLoggerWriteIndex(void)
+{
+    tSDLoggerIndex index;
+
+    index.Magic = SDLOGGER_MAGIC;
+    index.Index = indexCount + 1;
+    index.Head = head;
+    index.Session = session;
+    index.Check = SDLoggerCheck(&index);
+
+    if (!sd_raw_write(regionFirst + (index.Index & 1), 0,
+                      (const unsigned char *) &index, sizeof (index))
+            || !sd_raw_sync())
+    {
+        SDLoggerStatistics.Errors++;
+        return false;
+    }
+
+    indexCount = index.Index;
+    indexHead = head;
+
+    return true;
+}
+
+/**
+ * Sets the region of the card.
+ * @param first First block.
+ * @param blocks Blocks of the region, with the index.
+ * @return False if it is too small.
+ */
+static bool SDLoggerRegion(block_t first, block_t blocks)
+{
+    mounted = false;
+    CRCDeviceInit();
+
+    if (blocks <= SDLOGGER_INDEX_BLOCKS + 2 * SDLOGGER_BUFFER_BLOCKS)
+    {
+        return false;
+    }
+
+    regionFirst = first;
+    dataBlocks = blocks - SDLOGGER_INDEX_BLOCKS;
+
+    return true;
+}
+
+/**
+ * Empties the buffer, the next block closed is the write head.
+ */
+static void SDLoggerReset(void)
+{
+    fillSequence = head;
+    fillHalf = 0;
+    fillBlock = 0;
+    fillByte = SDLOGGER_HEADER_SIZE;
+    halfBlocks[0] = 0;
+    halfBlocks[1] = 0;
+    halfWritten = 0;
+
+    SDLoggerStatistics.Dropped = 0;
+    SDLoggerStatistics.Errors = 0;
+}
+
+/**
+ * Hands the filled blocks of the current half to SDLoggerTasks() and goes on
+ * with the other half, which must be free.
+ */
+static void SDLoggerCloseHalf(void)
+{
+    halfBlocks[fillHalf] = fillBlock;
+    fillHalf ^= 1;
+    fillBlock = 0;
+}
+
+/**
+ * Writes the header of the current block and goes on with the next one.
+ */
+static void SDLoggerCloseBlock(void)
+{
+    tSDLoggerHeader header;
+
+    header.Sequence = fillSequence++;
+    header.Session = session;
+    header.Length = fillByte - SDLOGGER_HEADER_SIZE;
+    memcpy(&buffers[fillHalf][(unsigned int) fillBlock * 512], &header, sizeof (header));
+
+    fillByte = SDLOGGER_HEADER_SIZE;
+    fillBlock++;
+
+    if (fillBlock == SDLOGGER_BUFFER_BLOCKS)
+    {
+        SDLoggerCloseHalf();
+    }
+}
+
+/**
+ * Writes the checks of the blocks of a half waiting to be written.
+ * @param half Half.
+ * @param blocks Its blocks.
+ */
+static void SDLoggerCheckHalf(unsigned char half, unsigned char blocks)
+{
+    tSDLoggerHeader header;
+    unsigned char *block;
+    unsigned char i;
+
+    for (i = 0; i < blocks; i++)
+    {
+        block = &buffers[half][(unsigned int) i * 512];
+        memcpy(&header, block, sizeof (header));
+        header.Check = SDLoggerBlockCheck(&header, block + SDLOGGER_HEADER_SIZE);
+        memcpy(block, &header, sizeof (header));
+    }
+}
+
+/**
+ * Closes the current block if it is full, the last one of a half stays open
+ * until the other half is free.
+ */
+static void SDLoggerAdvance(void)
+{
+    if ((fillByte == 512)
+            && ((fillBlock + 1 < SDLOGGER_BUFFER_BLOCKS) || (halfBlocks[fillHalf ^ 1] == 0)))
+    {
+        SDLoggerCloseBlock();
+    }
+}
+
+/**
+ * Starts a new log in a region of the card, the data of the last one is
+ * lost.
+ * @param first First block of the region.
+ * @param blocks Blocks of the region.
+ * @return False if the region is too small or the card failed.
+ */
+bool SDLoggerFormat(block_t first, block_t blocks)
+{
+    tSDLoggerIndex index;
+
+    if (!SDLoggerRegion(first, blocks))
+    {
+        return false;
+    }
+
+    session = SDLoggerNewestIndex(&index) ? index.Session + 1 : 1;
+    indexCount = 0;
+    head = 0;
+    SDLoggerReset();
+
+    //both copies, the old index is never the newest one
+    if (!SDLoggerWriteIndex() || !SDLoggerWriteIndex())
+    {
+        return false;
+    }
+
+    mounted = true;
+
+    return true;
+}
+
+/**
+ * Opens the log of a region of the card and finds its write head, from the
+ * index and the data blocks written after it.
+ * @param first First block of the region.
+ * @param blocks Blocks of the region.
+ * @return False if the region has no log (see SDLoggerFormat()) or the card
+ *         failed.
+ */
+bool SDLoggerInit(block_t first, block_t blocks)
+{
+    tSDLoggerIndex index;
+    tSDLoggerHeader header;
+    block_t scanned;
+
+    if (!SDLoggerRegion(first, blocks) || !SDLoggerNewestIndex(&index))
+    {
+        return false;
+    }
+
+    session = index.Session;
+    indexCount = index.Index;
+    head = index.Head;
+
+    for (scanned = 0; scanned < dataBlocks; scanned++)
+    {
+        if (!sd_raw_read(regionFirst + SDLOGGER_INDEX_BLOCKS + head % dataBlocks, 0,
+                         (unsigned char *) &header, sizeof (header)))
+        {
+            return false;
+        }
+
+        if ((header.Session != session) || (header.Sequence != head))
+        {
+            break;
+        }
+
+        head++;
+    }
+
+    SDLoggerReset();
+    mounted = true;
+
+    return SDLoggerWriteIndex();
+}
+
+/**
+ * Appends a record to the log, it is not split between the halves of the
+ * buffer that are waiting and is dropped if it doesn't fit.
+ * @param data Record.
+ * @param length Bytes of the record.
+ * @return False if it was dropped.
+ */
+bool SDLoggerWrite(const void *data, unsigned int length)
+{
+    const unsigned char *bytes = data;
+    unsigned int room;
+    unsigned int part;
+
+    if (!mounted)
+    {
+        return false;
+    }
+
+    SDLOGGER_ENTER_CRITICAL();
+
+    room = (unsigned int) (SDLOGGER_BUFFER_BLOCKS - fillBlock) * SDLOGGER_PAYLOAD_SIZE
+            - (fillByte - SDLOGGER_HEADER_SIZE);
+
+    if (halfBlocks[fillHalf ^ 1] == 0)
+    {
+        room += SDLOGGER_BUFFER_BLOCKS * SDLOGGER_PAYLOAD_SIZE;
+    }
+
+    if (length > room)
+    {
+        SDLoggerStatistics.Dropped++;
+        SDLOGGER_EXIT_CRITICAL();
+        return false;
+    }
+
+    while (length > 0)
+    {
+        part = 512 - fillByte;
+
+        if (part > length)
+        {
+            part = length;
+        }
+
+        memcpy(&buffers[fillHalf][(unsigned int) fillBlock * 512 + fillByte], bytes, part);
+        bytes += part;
+        length -= part;
+        fillByte += part;
+
+        SDLoggerAdvance();
+    }
+
+    SDLOGGER_EXIT_CRITICAL();
+
+    return true;
+}
+
+/**
+ * Writes the half of the buffer that is waiting to the card, and the index
+ * every SDLOGGER_INDEX_PERIOD blocks. Called from the main loop or a task,
+ * it returns at once while the card is busy.
+ * @return False if the card failed, the write is done again on the next
+ *         call.
+ */
+bool SDLoggerTasks(void)
+{
+    unsigned char half;
+    unsigned char blocks;
+    block_t at;
+    block_t part;
+
+    if (!mounted)
+    {
+        return false;
+    }
+
+    SDLOGGER_ENTER_CRITICAL();
+    half = fillHalf ^ 1;
+    blocks = halfBlocks[half];
+    SDLOGGER_EXIT_CRITICAL();
+
+    //busy programming the last blocks, the write waits for the next call
+    if ((blocks == 0) || !sd_raw_ready())
+    {
+        return true;
+    }
+
+    //here and not when the block is closed, the CRC unit is not shared with
+    //the interrupts
+    if (halfWritten == 0)
+    {
+        SDLoggerCheckHalf(half, blocks);
+    }
+
+    while (halfWritten < blocks)
+    {
+        //split where the ring wraps
+        at = head % dataBlocks;
+        part = dataBlocks - at;
+
+        if (part > (block_t) (blocks - halfWritten))
+        {
+            part = blocks - halfWritten;
+        }
+
+        if (!sd_raw_write_multi(regionFirst + SDLOGGER_INDEX_BLOCKS + at,
+                                &buffers[half][(unsigned int) halfWritten * 512],
+                                (unsigned int) part))
+        {
+            SDLoggerStatistics.Errors++;
+            return false;
+        }
+
+        halfWritten += (unsigned char) part;
+        head += part;
+    }
+
+    halfWritten = 0;
+
+    SDLOGGER_ENTER_CRITICAL();
+    halfBlocks[half] = 0;
+    SDLoggerAdvance();
+    SDLOGGER_EXIT_CRITICAL();
+
+    if (head - indexHead >= SDLOGGER_INDEX_PERIOD)
+    {
+        return SDLoggerWriteIndex();
+    }
+
+    return true;
+}
+
+/**
+ * Writes all the records to the card, the current block is closed even if
+ * it is not full, and updates the index. I.e. before the power goes down.
+ * @return False if the card failed.
+ */
+bool SDLoggerSync(void)
+{
+    if (!SDLoggerTasks())
+    {
+        return false;
+    }
+
+    SDLOGGER_ENTER_CRITICAL();
+
+    if (halfBlocks[fillHalf ^ 1] == 0)
+    {
+        if (fillByte > SDLOGGER_HEADER_SIZE)
+        {
+            SDLoggerCloseBlock();
+        }
+
+        if (fillBlock != 0)
+        {
+            SDLoggerCloseHalf();
+        }
+    }
+
+    SDLOGGER_EXIT_CRITICAL();
+
+    if (!SDLoggerTasks())
+    {
+        return false;
+    }
+
+    return (head == indexHead) || SDLoggerWriteIndex();
+}
+
+/**
+ * Gives the sequence of the next block written to the card, the blocks
+ * before it can be read.
+ * @return Sequence.
+ */
+uint32_t SDLoggerHead(void)
+{
+    return head;
+}
+
+/**
+ * Gives the sequence of the oldest block kept by the ring.
+ * @return Sequence.
+ */
+uint32_t SDLoggerOldest(void)
+{
+    return (head > dataBlocks) ? (head - dataBlocks) : 0;
+}
+
+/**
+ * Reads the records of a data block.
+ * @param sequence Sequence of the block, from SDLoggerOldest() to
+ *                 SDLoggerHead() - 1.
+ * @param buffer Buffer for the records, SDLOGGER_PAYLOAD_SIZE bytes.
+ * @return Bytes of records, 0 if the block is not in the log or is
+ *         corrupted.
+ */
+unsigned int SDLoggerRead(uint32_t sequence, unsigned char *buffer)
+{
+    tSDLoggerHeader header;
+    block_t block;
+
+    if (!mounted || (sequence >= head) || (head - sequence > dataBlocks))
+    {
+        return 0;
+    }
+
+    block = regionFirst + SDLOGGER_INDEX_BLOCKS + sequence % dataBlocks;
+
+    if (!sd_raw_read(block, 0, (unsigned char *) &header, sizeof (header))
+            || (header.Session != session) || (header.Sequence != sequence)
+            || (header.Length > SDLOGGER_PAYLOAD_SIZE))
+    {
+        return 0;
+    }
+
+    if (!sd_raw_read(block, SDLOGGER_HEADER_SIZE, buffer, header.Length)
+            || (SDLoggerBlockCheck(&header, buffer) != header.Check))
+    {
+        return 0;
+    }
+
+    return header.Length;
+}
@@ -0,0 +1,99 @@
+/**
+ *  @file       SDLogger.h
+ *  @author     Luis Maduro
+ *  @version    1.00
+ *  @date       14/10/2026
+ *  @brief      Append only logger on a contiguous region of a SD card.
+ *
+ *  The records are packed in RAM into two halves of SDLOGGER_BUFFER_BLOCKS
+ *  blocks. While one half fills, the other one is written to the card with
+ *  sd_raw_write_multi() by SDLoggerTasks(), so SDLoggerWrite() never waits
+ *  for the card and can be called from an interrupt. A record is dropped
+ *  when both halves are full.
+ *
+ *  The region is reserved for the logger (i.e. past the end of the file
+ *  system or in a partition of its own), there is no FAT on the way. Its
+ *  first SDLOGGER_INDEX_BLOCKS blocks hold two copies of an index, written
+ *  in turn every SDLOGGER_INDEX_PERIOD blocks, and the rest is a ring of
+ *  data blocks. Every data block starts with a header with its sequence
+ *  number and the session of the log, so after a power loss SDLoggerInit()
+ *  takes the newest valid index and only reads the blocks written after it
+ *  to find the write head. The header also holds the CRC of the block
+ *  (CRCDevice.h), SDLoggerRead() gives nothing of a corrupted block. When
+ *  the ring is full the oldest blocks are overwritten.
+ *
+ *  Copyright (C) 2026  Luis Maduro
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef SDLOGGER_H
+#define SDLOGGER_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "SDCardRaw.h"
+
+/**Blocks of each half of the buffer, written with one command. The buffer
+ takes 2 * 512 * SDLOGGER_BUFFER_BLOCKS bytes of RAM, on the PIC18 the
+ sdlogger section of the linker script must hold it.*/
+#ifndef SDLOGGER_BUFFER_BLOCKS
+#define SDLOGGER_BUFFER_BLOCKS      1
+#endif
+
+/**Data blocks written between two updates of the index, the most blocks
+ read by SDLoggerInit() to find the write head.*/
+#ifndef SDLOGGER_INDEX_PERIOD
+#define SDLOGGER_INDEX_PERIOD       64
+#endif
+
+/**
+ * SDLoggerWrite() can be called from interrupt routines, define these to
+ * disable and enable them while SDLoggerSync() closes the current block.
+ */
+#ifndef SDLOGGER_ENTER_CRITICAL
+#define SDLOGGER_ENTER_CRITICAL()
+#define SDLOGGER_EXIT_CRITICAL()
+#endif
+
+/**Blocks at the start of the region for the copies of the index.*/
+#define SDLOGGER_INDEX_BLOCKS       2
+
+/**Header of a data block and bytes of records in it.*/
+#define SDLOGGER_HEADER_SIZE        12
+#define SDLOGGER_PAYLOAD_SIZE       (512 - SDLOGGER_HEADER_SIZE)
+
+/**
+ * Counters of the logger.
+ */
+typedef struct
+{
+    /**Records dropped, the buffer was full.*/
+    unsigned int Dropped;
+    /**Writes to the card that failed, they are done again.*/
+    unsigned int Errors;
+} tSDLoggerStatistics;
+
+extern tSDLoggerStatistics SDLoggerStatistics;
+
+bool SDLoggerFormat(block_t first, block_t blocks);
+bool SDLoggerInit(block_t first, block_t blocks);
+bool SDLoggerWrite(const void *data, unsigned int length);
+bool SDLoggerTasks(void);
+bool SDLoggerSync(void);
+uint32_t SDLoggerHead(void);
+uint32_t SDLoggerOldest(void);
+unsigned int SDLoggerRead(uint32_t sequence, unsigned char *buffer);
+
+#endif /* SDLOGGER_H */
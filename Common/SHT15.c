@@ -1,8 +1,12 @@
 
 #include <p18cxxx.h>
-#include <delays.h>
+#include "delay.h"
 #include "SHT15.h"
 
+unsigned char sht15_state = SHT15_DONE;
+unsigned char sht15_command = 0;
+unsigned char sht15_status = 0;
+
 unsigned char sht15_wait_measure_complete(void)
 {
     unsigned long i = 0;
@@ -24,17 +28,17 @@ void sht15_connection_reset(void)
     DATA_TRIS = 0;
     SCK_TRIS = 0;
 
-    Delay1KTCYx(1);
+    SHT15_DELAY();
     DATA = 1;
-    Delay1KTCYx(1);
+    SHT15_DELAY();
     SCK = 0;
-    Delay1KTCYx(1);
+    SHT15_DELAY();
     for (i = 0; i < 9; i++)
     {
         SCK = 1;
-        Delay1KTCYx(1);
+        SHT15_DELAY();
         SCK = 0;
-        Delay1KTCYx(1);
+        SHT15_DELAY();
     }
 }
 
@@ -44,19 +48,19 @@ void sht15_transmition_start(void)
     SCK_TRIS = 0;
 
     DATA = 1;
-    Delay1KTCYx(1);
+    SHT15_DELAY();
     SCK = 1;
-    Delay1KTCYx(1);
+    SHT15_DELAY();
     DATA = 0;
-    Delay1KTCYx(1);
+    SHT15_DELAY();
     SCK = 0;
-    Delay1KTCYx(1);
+    SHT15_DELAY();
     SCK = 1;
-    Delay1KTCYx(1);
+    SHT15_DELAY();
     DATA = 1;
-    Delay1KTCYx(1);
+    SHT15_DELAY();
     SCK = 0;
-    Delay1KTCYx(1);
+    SHT15_DELAY();
 }
 
 unsigned char sht15_send_byte(unsigned char data)
@@ -68,7 +72,7 @@ unsigned char sht15_send_byte(unsigned char data)
 
     DATA = 1;
 
-    Delay1KTCYx(1);
+    SHT15_DELAY();
 
     for (i = 0x80; i > 0; i /= 2)
     {
@@ -76,22 +80,22 @@ unsigned char sht15_send_byte(unsigned char data)
             DATA = 1;
         else
             DATA = 0;
-        Delay1KTCYx(1);
+        SHT15_DELAY();
         SCK = 1;
-        Delay1KTCYx(1);
+        SHT15_DELAY();
         SCK = 0;
-        Delay1KTCYx(1);
+        SHT15_DELAY();
     }
 
     DATA = 1; //Libertar o bus
     DATA_TRIS = 1;
 
     SCK = 1;
-    Delay1KTCYx(1);
+    SHT15_DELAY();
     error = DATA;
-    Delay1KTCYx(1);
+    SHT15_DELAY();
     SCK = 0;
-    Delay1KTCYx(1);
+    SHT15_DELAY();
 
     return error;
 }
@@ -104,31 +108,31 @@ unsigned char sht15_read_byte(unsigned char ack)
     SCK_TRIS = 0;
 
     SCK = 0;
-    Delay1KTCYx(1);
+    SHT15_DELAY();
 
     for (i = 0x80; i > 0; i /= 2)
     {
         SCK = 1;
-        Delay1KTCYx(1);
+        SHT15_DELAY();
         if (DATA == 1)
             data = (data | i);
         else
             data = (data & ~i);
-        Delay1KTCYx(1);
+        SHT15_DELAY();
         SCK = 0;
-        Delay1KTCYx(1);
+        SHT15_DELAY();
     }
 
     DATA_TRIS = 0;
-    Delay1KTCYx(1);
+    SHT15_DELAY();
     DATA = !ack;
-    Delay1KTCYx(1);
+    SHT15_DELAY();
     SCK = 1;
-    Delay1KTCYx(1);
+    SHT15_DELAY();
     SCK = 0;
-    Delay1KTCYx(1);
+    SHT15_DELAY();
     DATA = 1;
-    Delay1KTCYx(1);
+    SHT15_DELAY();
 
     return data;
 }
@@ -156,57 +160,144 @@ unsigned char sht15_write_status_reg(unsigned char data)
     error += sht15_send_byte(WRITE_STATUS_REG);
     error += sht15_send_byte(data);
 
+    if (error == 0)
+        sht15_status = data;
+
     return error;
 }
 
-unsigned int measure_temperature(void)
+unsigned char sht15_reverse_byte(unsigned char data)
 {
-    unsigned int error = 0, msb = 0, lsb = 0, checksum = 0;
-    unsigned int temperature = 0;
+    unsigned char i = 0, reversed = 0;
 
-    sht15_connection_reset();
+    for (i = 0; i < 8; i++)
+    {
+        reversed = (reversed << 1) | (data & 0x01);
+        data >>= 1;
+    }
 
-    sht15_transmition_start();
+    return reversed;
+}
 
-    error += sht15_send_byte(MEASURE_TEMPERATURE);
+//CRC-8 of the sensor, x^8 + x^5 + x^4 + 1 from the low nibble of the status
+//register (reversed), over the command and the two bytes of the measure. The
+//sensor sends it reversed.
+unsigned char sht15_crc8(unsigned char crc, unsigned char data)
+{
+    unsigned char i = 0;
 
-    error += sht15_wait_measure_complete();
+    crc ^= data;
 
-    msb = sht15_read_byte(ACK);
-    lsb = sht15_read_byte(ACK);
-    checksum = sht15_read_byte(NOT_ACK);
+    for (i = 0; i < 8; i++)
+    {
+        if (crc & 0x80)
+            crc = (crc << 1) ^ 0x31;
+        else
+            crc <<= 1;
+    }
 
-    if (error != 0)
-        sht15_connection_reset();
+    return crc;
+}
+
+//Starts a measure and returns, without waiting for the sensor (up to 320 ms
+//at 14 bits). The result is taken with sht15_measure_poll().
+unsigned char sht15_measure_start(unsigned char command)
+{
+    unsigned char error = 0;
+
+    sht15_connection_reset();
+    sht15_transmition_start();
+
+    error = sht15_send_byte(command);
+
+    if (error == 0)
+    {
+        sht15_command = command;
+        sht15_state = SHT15_BUSY;
+    }
     else
     {
-        temperature = (msb << 8) + lsb;
-        return temperature;
+        sht15_state = SHT15_ERROR;
+        sht15_connection_reset();
     }
+
+    DATA_TRIS = 1;
+
+    return error;
 }
 
-unsigned int measure_humidity(void)
+//The sensor pulls DATA low when the measure is complete, it can be polled
+//from a task or seen by an interrupt on change of the pin.
+unsigned char sht15_measure_ready(void)
 {
-    unsigned int error = 0, msb = 0, lsb = 0, checksum = 0;
-    unsigned int humidity = 0;
+    DATA_TRIS = 1;
 
-    sht15_connection_reset();
+    return (sht15_state == SHT15_BUSY) && (DATA == 0);
+}
 
-    sht15_transmition_start();
+//Takes the result of the measure started by sht15_measure_start() if the
+//sensor is ready, and checks its CRC-8.
+//Returns SHT15_BUSY while the measure is not complete, SHT15_DONE with the
+//value or SHT15_ERROR (no measure started, or bad CRC).
+unsigned char sht15_measure_poll(unsigned int *value)
+{
+    unsigned char msb = 0, lsb = 0, checksum = 0, crc = 0;
 
-    error += sht15_send_byte(MEASURE_HUMIDITY);
+    if (sht15_state != SHT15_BUSY)
+        return SHT15_ERROR;
 
-    error += sht15_wait_measure_complete();
+    if (!sht15_measure_ready())
+        return SHT15_BUSY;
 
     msb = sht15_read_byte(ACK);
     lsb = sht15_read_byte(ACK);
     checksum = sht15_read_byte(NOT_ACK);
 
-    if (error != 0)
+    crc = sht15_reverse_byte(sht15_status & 0x0F);
+    crc = sht15_crc8(crc, sht15_command);
+    crc = sht15_crc8(crc, msb);
+    crc = sht15_crc8(crc, lsb);
+
+    if (sht15_reverse_byte(crc) != checksum)
+    {
+        sht15_state = SHT15_ERROR;
         sht15_connection_reset();
-    else
+        return SHT15_ERROR;
+    }
+
+    *value = ((unsigned int) msb << 8) + lsb;
+    sht15_state = SHT15_DONE;
+
+    return SHT15_DONE;
+}
+
+unsigned int sht15_measure(unsigned char command)
+{
+    unsigned int value = 0;
+
+    if (sht15_measure_start(command) != 0)
+        return 0;
+
+    if (sht15_wait_measure_complete() != 0)
     {
-        humidity = (msb << 8) + lsb;
-        return humidity;
+        sht15_state = SHT15_ERROR;
+        sht15_connection_reset();
+        return 0;
     }
-}
\ No newline at end of file
+
+    if (sht15_measure_poll(&value) != SHT15_DONE)
+        return 0;
+
+    return value;
+}
+
+//Blocking measures, 0 on error.
+unsigned int measure_temperature(void)
+{
+    return sht15_measure(MEASURE_TEMPERATURE);
+}
+
+unsigned int measure_humidity(void)
+{
+    return sht15_measure(MEASURE_HUMIDITY);
+}
@@ -9,6 +9,13 @@
 #define DATA PORTEbits.RE2
 #define SCK PORTEbits.RE3
 
+// Half period of SCK, the sensor needs 100 ns high and low and the data is
+// valid 250 ns after the falling edge, 1 us is below 500 kHz.
+#ifndef SHT15_DELAY_US
+#define SHT15_DELAY_US 1
+#endif
+#define SHT15_DELAY() DelayUs(SHT15_DELAY_US)
+
 #define ACK 1
 #define NOT_ACK 0
 //  adr     cmd     r/w
@@ -27,6 +34,11 @@
 #define LOW_RESOLUTION      0b00000111
 #define HIGH_RESOLUTION     0b00000110
 
+//State of the split phase measure
+#define SHT15_DONE          0
+#define SHT15_BUSY          1
+#define SHT15_ERROR         2
+
 //-----------------------FUNCOES--------------------//
 unsigned char sht15_wait_measure_complete(void);
 void sht15_connection_reset(void);
@@ -35,6 +47,12 @@ unsigned char sht15_send_byte(unsigned char);
 unsigned char sht15_read_byte(unsigned char);
 unsigned char sht15_read_status_reg(unsigned char *, unsigned char *);
 unsigned char sht15_write_status_reg(unsigned char);
+unsigned char sht15_reverse_byte(unsigned char);
+unsigned char sht15_crc8(unsigned char, unsigned char);
+unsigned char sht15_measure_start(unsigned char);
+unsigned char sht15_measure_ready(void);
+unsigned char sht15_measure_poll(unsigned int *);
+unsigned int sht15_measure(unsigned char);
 unsigned int measure_temperature(void);
 unsigned int measure_humidity(void);
 
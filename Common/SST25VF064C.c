@@ -140,6 +140,83 @@ void FlashWritePage(uint8_t writeData, uint32_t address)
 
 }
 
+void FlashWriteBuffer(uint32_t address, const uint8_t *writeData, uint16_t length)
+{
+    uint8_t sndByte[4] = {0, 0, 0, 0};
+    uint16_t pageLength;
+
+    while (length != 0)
+    {
+        //a page program wraps inside its 256 byte page, split at the boundary
+        pageLength = FLASH_PAGE_SIZE - (uint16_t) (address & (FLASH_PAGE_SIZE - 1));
+
+        if (pageLength > length)
+        {
+            pageLength = length;
+        }
+
+        //set command  0x02 for Page Program 
+        sndByte[0] = 0x02;
+        //set 3 byte address MSB first 
+        sndByte[1] = (address >> 16);
+        sndByte[2] = (address >> 8);
+        sndByte[3] = (address);
+
+        // the next page is prepared while the last one is programmed
+        FlashWaitForWrite();
+
+        //enable write
+        FlashWriteEnable();
+
+        FlashMemorySelect();
+
+        SPIDeviceSendData(sndByte, 4);
+        SPIDeviceSendData(writeData, pageLength);
+
+        FlashMemoryDeselect();
+
+        address += pageLength;
+        writeData += pageLength;
+        length -= pageLength;
+    }
+
+    // the last page is still being programmed, the next command waits for it
+}
+
+void FlashReadBuffer(uint32_t address, uint8_t *readData, uint32_t length)
+{
+    uint8_t sndByte[5] = {0, 0, 0, 0, 0};
+    uint16_t part;
+
+    //set command  0x0B for Read at fast speed 
+    sndByte[0] = 0x0B;
+    //set 3 byte address MSB first 
+    sndByte[1] = (address >> 16);
+    sndByte[2] = (address >> 8);
+    sndByte[3] = address;
+    sndByte[4] = 0x00;
+
+    // wait for any unfinished write or erase cycle
+    FlashWaitForWrite();
+
+    FlashMemorySelect();
+
+    SPIDeviceSendData(sndByte, 5);
+
+    //the address increments, the whole buffer is read in one command, in
+    //parts that fit the length of a block transfer
+    while (length != 0)
+    {
+        part = (length > 0x8000) ? 0x8000 : (uint16_t) length;
+
+        SPIDeviceReceiveData(readData, part);
+        readData += part;
+        length -= part;
+    }
+
+    FlashMemoryDeselect();
+}
+
 void FlashSectorErase(uint32_t address)
 {
     uint8_t sndByte[4] = {0, 0, 0, 0};
@@ -169,6 +246,32 @@ void FlashSectorErase(uint32_t address)
 
 }
 
+void FlashSector4KErase(uint32_t address)
+{
+    uint8_t sndByte[4] = {0, 0, 0, 0};
+
+    //set command  0x20 for 4 KB sector erase 
+    sndByte[0] = 0x20;
+    //set 3 byte address MSB first 
+    sndByte[1] = (address >> 16);
+    sndByte[2] = (address >> 8);
+    sndByte[3] = (address);
+
+    // wait for any unfinished write or erase cycle
+    // this is called as that command will not be ignored during a write or erase cycle
+    FlashWaitForWrite();
+
+    //enable write
+    FlashWriteEnable();
+
+    FlashMemorySelect();
+
+    SPIDeviceSendData(sndByte, 4);
+
+    FlashMemoryDeselect();
+
+}
+
 void FlashBulkErase(void)
 {
 
@@ -234,6 +337,12 @@ uint8_t FlashReadSR(void)
 
 }
 
+uint8_t FlashIsBusy(void)
+{
+    //0x1 means a write is in progess
+    return FlashReadSR() & 0x1;
+}
+
 void FlashWaitForWrite(void)
 {
     uint8_t SR;
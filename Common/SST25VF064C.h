@@ -4,15 +4,24 @@
 #include "SPIDevice.h"
 #include "uwn_common.h"
 
+//bytes programmed by one Page Program command
+#define FLASH_PAGE_SIZE     256
+//bytes erased by FlashSector4KErase(), FlashSectorErase() erases 64 KB
+#define FLASH_SECTOR_SIZE   4096UL
+
 uint8_t FlashGetDeviceID(void);
 uint8_t FlashNormalRead(uint32_t address);
 uint8_t FlashFastRead(uint32_t address);
 void FlashWritePage(uint8_t writeData, uint32_t address);
+void FlashWriteBuffer(uint32_t address, const uint8_t *writeData, uint16_t length);
+void FlashReadBuffer(uint32_t address, uint8_t *readData, uint32_t length);
 void FlashSectorErase(uint32_t address);
+void FlashSector4KErase(uint32_t address);
 void FlashBulkErase(void);
 void FlashWriteSR(uint8_t setReg);
 void FlashWriteEnable(void);
 uint8_t FlashReadSR(void);
+uint8_t FlashIsBusy(void);
 void FlashWaitForWrite(void);
 
 #endif
@@ -29,6 +29,8 @@
 tSTC31000Data STC3100Data;
 /**Stores the battery data.*/
 tBatteryData BatteryData;
+/**Stores the battery data in integer units.*/
+tBatteryState BatteryState;
 
 /**
  * Read the entire chip memory to the #STC3100Data variable.
@@ -87,3 +89,142 @@ void UpdateBatteryData(void)
 
     Nop();
 }
+
+/**
+ * Gives the value of a pair of registers of the #STC3100Data variable.
+ * @param address Address of the low byte.
+ * @return Value of the registers.
+ */
+static unsigned int STC3100Register(unsigned char address)
+{
+    return ((unsigned int) STC3100Data.ByteArray[address + 1] << 8)
+            | STC3100Data.ByteArray[address];
+}
+
+/**
+ * Converts the values of the #STC3100Data variable to the #BatteryState
+ * variable, without float.
+ * @param changed Values to convert, STC3100_CHANGED_... bits.
+ */
+static void STC3100Convert(unsigned char changed)
+{
+    int value;
+
+    if (changed & STC3100_CHANGED_CHARGE)
+    {
+        //6.70 uVh / Rsense per bit
+        value = (int) STC3100Register(REG_CHARGE_LOW);
+        BatteryState.Charge = ((long) value * 6700L) / STC3100_RSENSE;
+    }
+
+    if (changed & STC3100_CHANGED_COUNTER)
+    {
+        BatteryState.Counter = STC3100Register(REG_COUNTER_LOW);
+    }
+
+    if (changed & STC3100_CHANGED_CURRENT)
+    {
+        //14 bits signed, 11.77 uV / Rsense per bit
+        value = (int) ((STC3100Register(REG_CURRENT_LOW) & 0x3FFF) ^ 0x2000) - 0x2000;
+        BatteryState.Current = ((long) value * 11770L) / STC3100_RSENSE
+                - STC3100_CURRENT_OFFSET;
+    }
+
+    if (changed & STC3100_CHANGED_VOLTAGE)
+    {
+        //12 bits, 2.44 mV per bit
+        value = (int) (STC3100Register(REG_VOLTAGE_LOW) & 0x0FFF);
+        BatteryState.Voltage = (unsigned int) (((long) value * 244L) / 100L);
+    }
+
+    if (changed & STC3100_CHANGED_TEMPERATURE)
+    {
+        //12 bits signed, 0.125 C per bit
+        value = (int) ((STC3100Register(REG_TEMPERATURE_LOW) & 0x0FFF) ^ 0x0800) - 0x0800;
+        BatteryState.Temperature = (value * 5) / 4;
+    }
+}
+
+/**
+ * Copies a pair of registers to the #STC3100Data variable.
+ * @param address Address of the low byte.
+ * @param data New value of the registers.
+ * @return Non zero if the value changed.
+ */
+static unsigned char STC3100Copy(unsigned char address, unsigned char *data)
+{
+    if ((STC3100Data.ByteArray[address] == data[0])
+            && (STC3100Data.ByteArray[address + 1] == data[1]))
+    {
+        return 0;
+    }
+
+    STC3100Data.ByteArray[address] = data[0];
+    STC3100Data.ByteArray[address + 1] = data[1];
+
+    return 1;
+}
+
+/**
+ * Reads the entire chip and converts all the values to the #BatteryState
+ * variable. Needed once at boot, after that STC3100Update() only reads the
+ * registers that change.
+ */
+void STC3100Sync(void)
+{
+    STC3100ReadChip();
+    STC3100Convert(STC3100_CHANGED_CHARGE | STC3100_CHANGED_COUNTER
+                   | STC3100_CHANGED_CURRENT | STC3100_CHANGED_VOLTAGE
+                   | STC3100_CHANGED_TEMPERATURE);
+}
+
+/**
+ * Reads the control register and the measurement registers, from the
+ * charge to the temperature, in one burst and converts only the values that
+ * changed to the #BatteryState variable.
+ * @return The values that changed, STC3100_CHANGED_... bits.
+ */
+unsigned char STC3100Update(void)
+{
+    unsigned char buffer[REG_TEMPERATURE_HIGH - REG_CTRL + 1];
+    unsigned char changed = 0;
+
+    I2CDeviceSetDeviceAddress(STC3100_ADDRESS);
+    I2CDeviceReadBytes(REG_CTRL, sizeof (buffer), buffer);
+
+    STC3100Data.ControlStatus = buffer[0];
+
+    if (STC3100Data.CONTROLSTATUSbits.PowerOnReset)
+    {
+        changed |= STC3100_CHANGED_RESET;
+    }
+
+    if (STC3100Copy(REG_CHARGE_LOW, &buffer[REG_CHARGE_LOW - REG_CTRL]))
+    {
+        changed |= STC3100_CHANGED_CHARGE;
+    }
+
+    if (STC3100Copy(REG_COUNTER_LOW, &buffer[REG_COUNTER_LOW - REG_CTRL]))
+    {
+        changed |= STC3100_CHANGED_COUNTER;
+    }
+
+    if (STC3100Copy(REG_CURRENT_LOW, &buffer[REG_CURRENT_LOW - REG_CTRL]))
+    {
+        changed |= STC3100_CHANGED_CURRENT;
+    }
+
+    if (STC3100Copy(REG_VOLTAGE_LOW, &buffer[REG_VOLTAGE_LOW - REG_CTRL]))
+    {
+        changed |= STC3100_CHANGED_VOLTAGE;
+    }
+
+    if (STC3100Copy(REG_TEMPERATURE_LOW, &buffer[REG_TEMPERATURE_LOW - REG_CTRL]))
+    {
+        changed |= STC3100_CHANGED_TEMPERATURE;
+    }
+
+    STC3100Convert(changed);
+
+    return changed;
+}
@@ -26,7 +26,27 @@
 /**I2C Device Address*/
 #define STC3100_ADDRESS    0b01110000
 
-//INTERNAL REGISTERS MAP (NOT CURRENTLY USED)
+/**Value of the sense resistor in milliohm.*/
+#ifndef STC3100_RSENSE
+#define STC3100_RSENSE              10
+#endif
+
+/**Offset of the current measurement in uA, subtracted from every reading.*/
+#ifndef STC3100_CURRENT_OFFSET
+#define STC3100_CURRENT_OFFSET      0
+#endif
+
+/**Values changed by STC3100Update().*/
+#define STC3100_CHANGED_CHARGE      0x01
+#define STC3100_CHANGED_COUNTER     0x02
+#define STC3100_CHANGED_CURRENT     0x04
+#define STC3100_CHANGED_VOLTAGE     0x08
+#define STC3100_CHANGED_TEMPERATURE 0x10
+/**The chip was reset (power on or soft reset), its mode has to be written
+ again.*/
+#define STC3100_CHANGED_RESET       0x80
+
+//INTERNAL REGISTERS MAP
 #define REG_MODE                0
 #define REG_CTRL                1
 #define REG_CHARGE_LOW          2
@@ -285,11 +305,31 @@ typedef struct
     float Charge;
 } tBatteryData;
 
+/**
+ * Battery data in integer units, kept by STC3100Sync() and STC3100Update().
+ */
+typedef struct
+{
+    /**Value of the voltage in mV.*/
+    unsigned int Voltage;
+    /**Value of the current in uA, positive when charging.*/
+    long Current;
+    /**Value of the temperature in 0.1 C*/
+    int Temperature;
+    /**Value of the current charge of the battery in uAh*/
+    long Charge;
+    /**Number of conversions since the last gas gauge reset.*/
+    unsigned int Counter;
+} tBatteryState;
+
 extern tSTC31000Data STC3100Data;
 extern tBatteryData BatteryData;
+extern tBatteryState BatteryState;
 
 void STC3100ReadChip(void);
 void STC3100WriteChip(void);
 void UpdateBatteryData(void);
+void STC3100Sync(void);
+unsigned char STC3100Update(void);
 
 #endif
\ No newline at end of file
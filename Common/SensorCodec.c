@@ -0,0 +1,345 @@
+/**
+ *  @file       SensorCodec.c
+ *  @author     Luis Maduro
+ *  @version    1.00
+ *  @date       14/10/2026
+ *  @brief      Delta and varint coding of sensor records for the radio and
+ *              the logs.
+ *
+ *  Copyright (C) 2026  Luis Maduro
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "SensorCodec.h"
+
+/**0, -1, 1, -2... to 0, 1, 2, 3...*/
+static uint32_t SensorCodecZigzag(uint32_t value)
+{
+    return (value << 1) ^ ((value & 0x80000000UL) ? 0xFFFFFFFFUL : 0);
+}
+
+static uint32_t SensorCodecUnzigzag(uint32_t value)
+{
+    return (value >> 1) ^ ((value & 1) ? 0xFFFFFFFFUL : 0);
+}
+
+/**
+ * Gives the bytes of a varint.
+ * @param value Value.
+ * @return 1 to 5.
+ */
+static unsigned char SensorCodecVarintLength(uint32_t value)
+{
+    unsigned char length = 1;
+
+    while (value >= 0x80)
+    {
+        value >>= 7;
+        length++;
+    }
+
+    return length;
+}
+
+/**
+ * Gives the bits needed by a value.
+ * @param value Value.
+ * @return 0 to 32.
+ */
+static unsigned char SensorCodecWidth(uint32_t value)
+{
+    unsigned char width = 0;
+
+    while (value != 0)
+    {
+        value >>= 1;
+        width++;
+    }
+
+    return width;
+}
+
+/**
+ * Sets up a stream, its first record is a key record.
+ * @param codec State of the stream.
+ * @param channels Values of a record, 1 to SENSOR_CODEC_MAX_CHANNELS.
+ * @param keyInterval A key record every keyInterval records, 0 for only the
+ *                    first one. Not used by the decoder.
+ * @param packing Lets the encoder pack the differences.
+ * @return False if there are too many channels.
+ */
+bool SensorCodecInit(tSensorCodec *codec, uint8_t channels, uint8_t keyInterval, bool packing)
+{
+    if ((channels == 0) || (channels > SENSOR_CODEC_MAX_CHANNELS))
+    {
+        return false;
+    }
+
+    codec->channels = channels;
+    codec->keyInterval = keyInterval;
+    codec->packing = packing;
+    SensorCodecReset(codec);
+
+    return true;
+}
+
+/**
+ * Makes the next record a key record on the encoder, i.e. at the start of a
+ * new packet whose receiver may have lost the previous one. On the decoder
+ * the records are skipped until a key record.
+ * @param codec State of the stream.
+ */
+void SensorCodecReset(tSensorCodec *codec)
+{
+    codec->count = 0;
+    codec->synchronized = false;
+}
+
+/**
+ * Encodes a record.
+ * @param codec State of the stream.
+ * @param values Values of the channels.
+ * @param buffer Where to write the record.
+ * @param size Bytes free in the buffer, SENSOR_CODEC_MAX_RECORD() is always
+ *             enough.
+ * @return Bytes of the record, 0 if it doesn't fit: the state is kept and
+ *         the record can be written to the next buffer.
+ */
+unsigned int SensorCodecEncode(tSensorCodec *codec, const int32_t *values,
+                               uint8_t *buffer, unsigned int size)
+{
+    uint32_t coded[SENSOR_CODEC_MAX_CHANNELS];
+    uint32_t all = 0;
+    bool key;
+    unsigned int length = 1;
+    unsigned int packed;
+    unsigned char width;
+    unsigned char i;
+    unsigned char bits;
+    uint8_t *out;
+    uint32_t value;
+
+    key = !codec->synchronized
+            || ((codec->keyInterval != 0) && (codec->count >= codec->keyInterval));
+
+    for (i = 0; i < codec->channels; i++)
+    {
+        value = (uint32_t) values[i];
+
+        if (!key)
+        {
+            //wraps like the values, no overflow
+            value -= (uint32_t) codec->last[i];
+        }
+
+        coded[i] = SensorCodecZigzag(value);
+        all |= coded[i];
+        length += SensorCodecVarintLength(coded[i]);
+    }
+
+    //the widest difference gives the width of all of them
+    width = SensorCodecWidth(all);
+    packed = 1 + ((unsigned int) codec->channels * width + 7) / 8;
+
+    if (codec->packing && !key && (packed < length))
+    {
+        if (packed > size)
+        {
+            return 0;
+        }
+
+        buffer[0] = SENSOR_CODEC_PACKED | width;
+
+        for (length = 1; length < packed; length++)
+        {
+            buffer[length] = 0;
+        }
+
+        out = &buffer[1];
+        bits = 0;
+
+        for (i = 0; i < codec->channels; i++)
+        {
+            value = coded[i];
+
+            for (length = width; length != 0; length--)
+            {
+                if (value & 1)
+                {
+                    *out |= 1 << bits;
+                }
+
+                value >>= 1;
+
+                if (++bits == 8)
+                {
+                    bits = 0;
+                    out++;
+                }
+            }
+        }
+
+        length = packed;
+    }
+    else
+    {
+        if (length > size)
+        {
+            return 0;
+        }
+
+        buffer[0] = key ? SENSOR_CODEC_KEY : 0;
+        out = &buffer[1];
+
+        for (i = 0; i < codec->channels; i++)
+        {
+            value = coded[i];
+
+            while (value >= 0x80)
+            {
+                *out++ = (uint8_t) value | 0x80;
+                value >>= 7;
+            }
+
+            *out++ = (uint8_t) value;
+        }
+    }
+
+    for (i = 0; i < codec->channels; i++)
+    {
+        codec->last[i] = values[i];
+    }
+
+    codec->count = key ? 1 : codec->count + 1;
+    codec->synchronized = true;
+
+    return length;
+}
+
+/**
+ * Decodes a record.
+ * @param codec State of the stream, with the channels of the encoder.
+ * @param buffer Record.
+ * @param length Bytes left in the buffer.
+ * @param values Values of the channels.
+ * @return Bytes of the record, 0 if it is cut. The records before the first
+ *         key record are skipped: their length is given and the values are
+ *         not written, synchronized is still false.
+ */
+unsigned int SensorCodecDecode(tSensorCodec *codec, const uint8_t *buffer,
+                               unsigned int length, int32_t *values)
+{
+    uint32_t coded[SENSOR_CODEC_MAX_CHANNELS];
+    const uint8_t *in = &buffer[1];
+    const uint8_t *end = buffer + length;
+    unsigned char width;
+    unsigned char bits = 0;
+    unsigned char shift;
+    unsigned char i;
+    unsigned char j;
+    uint32_t value;
+
+    if (length == 0)
+    {
+        return 0;
+    }
+
+    if (buffer[0] & SENSOR_CODEC_PACKED)
+    {
+        width = buffer[0] & SENSOR_CODEC_WIDTH;
+
+        if ((width > 32) || ((unsigned int) (end - in) <
+                             ((unsigned int) codec->channels * width + 7) / 8))
+        {
+            return 0;
+        }
+
+        for (i = 0; i < codec->channels; i++)
+        {
+            value = 0;
+
+            for (j = 0; j < width; j++)
+            {
+                if (*in & (1 << bits))
+                {
+                    value |= 1UL << j;
+                }
+
+                if (++bits == 8)
+                {
+                    bits = 0;
+                    in++;
+                }
+            }
+
+            coded[i] = value;
+        }
+
+        if (bits != 0)
+        {
+            in++;
+        }
+    }
+    else
+    {
+        for (i = 0; i < codec->channels; i++)
+        {
+            value = 0;
+            shift = 0;
+
+            do
+            {
+                if ((in == end) || (shift > 28))
+                {
+                    return 0;
+                }
+
+                value |= (uint32_t) (*in & 0x7F) << shift;
+                shift += 7;
+            }
+            while (*in++ & 0x80);
+
+            coded[i] = value;
+        }
+    }
+
+    if (buffer[0] & SENSOR_CODEC_KEY)
+    {
+        codec->synchronized = true;
+
+        for (i = 0; i < codec->channels; i++)
+        {
+            codec->last[i] = (int32_t) SensorCodecUnzigzag(coded[i]);
+        }
+    }
+    else if (codec->synchronized)
+    {
+        for (i = 0; i < codec->channels; i++)
+        {
+            codec->last[i] = (int32_t) ((uint32_t) codec->last[i] + SensorCodecUnzigzag(coded[i]));
+        }
+    }
+    else
+    {
+        return (unsigned int) (in - buffer);
+    }
+
+    for (i = 0; i < codec->channels; i++)
+    {
+        values[i] = codec->last[i];
+    }
+
+    return (unsigned int) (in - buffer);
+}
@@ -0,0 +1,92 @@
+/**
+ *  @file       SensorCodec.h
+ *  @author     Luis Maduro
+ *  @version    1.00
+ *  @date       14/10/2026
+ *  @brief      Delta and varint coding of sensor records for the radio and
+ *              the logs.
+ *
+ *  A record is the set of the integer values of the channels of one
+ *  sample, i.e. the 6 axes of MPU9150GetMotion6(), a DS18B20 temperature
+ *  in hundredths of a degree or the code of the MCP3421. Consecutive
+ *  samples are close, so each value is coded as its difference with the
+ *  same channel of the previous record, zigzag mapped (0, -1, 1, -2...)
+ *  and written as a varint of 7 bits per byte. A difference within +-63
+ *  takes 1 byte instead of the 2 or 4 of the value. With the bit packing,
+ *  a record whose differences are all small takes the width of the largest
+ *  one for every channel instead, whichever is shorter: 6 axes that move by
+ *  +-3 take 1 + 3 bytes.
+ *
+ *  Every SensorCodecInit() keyInterval records, and the first one, is a
+ *  key record with the values themselves, so a receiver that lost a packet
+ *  or a reader that starts in the middle of a log finds the values again.
+ *  The state is the last record, in a tSensorCodec of the caller: one for
+ *  the encoder and one for the decoder of each stream. The records are
+ *  written straight into the buffer given, a buffer of the packet pool
+ *  (uPacketPoolData()) or the record passed to SDLoggerWrite().
+ *
+ *  Layout of a record: a byte with SENSOR_CODEC_KEY, SENSOR_CODEC_PACKED and
+ *  the width of the packed differences, then one varint per channel or the
+ *  packed differences, least significant bit first.
+ *
+ *  Copyright (C) 2026  Luis Maduro
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef SENSORCODEC_H
+#define SENSORCODEC_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+/**Channels of a record, the size of tSensorCodec.*/
+#ifndef SENSOR_CODEC_MAX_CHANNELS
+#define SENSOR_CODEC_MAX_CHANNELS   9
+#endif
+
+/**Bits of the first byte of a record.*/
+#define SENSOR_CODEC_KEY            0x80
+#define SENSOR_CODEC_PACKED         0x40
+#define SENSOR_CODEC_WIDTH          0x3F
+
+/**Longest record of a number of channels, in bytes.*/
+#define SENSOR_CODEC_MAX_RECORD(channels)   (1 + 5 * (channels))
+
+/**
+ * State of a stream of records, on each side.
+ */
+typedef struct
+{
+    /**Values of the last record.*/
+    int32_t last[SENSOR_CODEC_MAX_CHANNELS];
+    uint8_t channels;
+    /**A key record every keyInterval records, 0 for the first one only.*/
+    uint8_t keyInterval;
+    /**Records since the last key record.*/
+    uint8_t count;
+    /**The encoder may pack the differences.*/
+    bool packing;
+    /**The decoder got a key record.*/
+    bool synchronized;
+} tSensorCodec;
+
+bool SensorCodecInit(tSensorCodec *codec, uint8_t channels, uint8_t keyInterval, bool packing);
+void SensorCodecReset(tSensorCodec *codec);
+unsigned int SensorCodecEncode(tSensorCodec *codec, const int32_t *values,
+                               uint8_t *buffer, unsigned int size);
+unsigned int SensorCodecDecode(tSensorCodec *codec, const uint8_t *buffer,
+                               unsigned int length, int32_t *values);
+
+#endif /* SENSORCODEC_H */
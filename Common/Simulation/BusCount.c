@@ -0,0 +1,274 @@
+/**
+ *  @file       BusCount.c
+ *  @author     Luis Maduro
+ *  @version    1.00
+ *  @date       14/10/2026
+ *  @brief      Bus cost of the operations of the drivers, on the host.
+ *
+ *  Runs operations of the drivers of Common on the simulated buses and
+ *  prints, for each one, the transactions, the bytes written and read by
+ *  the master and the bit times it takes on its bus:
+ *  @code
+ *  operation,bus,transactions,written,read,bits
+ *  MPU9150GetAccelX,i2c,1,3,2,48
+ *  @endcode
+ *  The counts are exact and don't depend on the host, a copy of the output
+ *  kept with the sources is compared to the output of a change to find the
+ *  operations that got more expensive on the bus:
+ *  @code
+ *  ./buscount > new.csv && diff buscount.csv new.csv
+ *  @endcode
+ *
+ *  Build and run on the host, from this folder:
+ *  @code
+ *  gcc -O2 -Wno-unknown-pragmas -I. -I.. -I../uKernel BusCount.c MockBus.c Kernel.c I2CDevice.c \
+ *      SPIDevice.c OneWire.c MockSD.c ../MPU9150.c ../HMC5883L.c ../FixedMath.c \
+ *      ../RegisterTable.c ../SDCardRaw.c ../SST25VF064C.c ../DS18B20.c \
+ *      -lm -o buscount
+ *  ./buscount
+ *  @endcode
+ *  This folder has to come first in the include paths, its I2CDevice.h,
+ *  SPIDevice.h and OneWire.h replace the ones of the ports.
+ *
+ *  Copyright (C) 2026  Luis Maduro
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "MockBus.h"
+#include "MockSD.h"
+#include "I2CDevice.h"
+#include "SPIDevice.h"
+#include "OneWire.h"
+#include "MPU9150.h"
+#include "HMC5883L.h"
+#include "SDCardRaw.h"
+#include "SST25VF064C.h"
+#include "DS18B20.h"
+
+static const char *busNames[MOCK_BUSES] = {"i2c", "spi", "onewire"};
+
+/**Registers of the devices on I2C.*/
+static unsigned char mpu9150[128];
+static unsigned char magnetometer[16];
+static unsigned char hmc5883l[16];
+
+/**The status register of the flash reads 0, never busy.*/
+static unsigned char FlashExchange(unsigned char mosi)
+{
+    (void) mosi;
+
+    return 0x00;
+}
+
+/**DS18B20 alone on the bus: Skip ROM or Match ROM, then its function.*/
+static unsigned char scratchpad[9] = {0x50, 0x05, 0x4B, 0x46, 0x7F, 0xFF, 0x0C, 0x10, 0x00};
+static unsigned char sensorByte;
+static unsigned char sensorBits;
+static unsigned char sensorReceived;
+static unsigned char sensorROMCommand;
+static unsigned int sensorSending;
+
+static bool SensorReset(void)
+{
+    sensorBits = 0;
+    sensorReceived = 0;
+    sensorSending = 0;
+
+    return true;
+}
+
+static unsigned char SensorSlot(unsigned char bit)
+{
+    unsigned int index;
+
+    if (sensorSending != 0)
+    {
+        //the scratchpad, LSB first
+        index = 9 * 8 - sensorSending--;
+
+        return (scratchpad[index >> 3] >> (index & 0x07)) & 0x01;
+    }
+
+    sensorByte = (sensorByte >> 1) | (bit ? 0x80 : 0);
+
+    if (++sensorBits < 8)
+        return 1;
+
+    sensorBits = 0;
+
+    if (sensorReceived++ == 0)
+        sensorROMCommand = sensorByte;
+
+    //the function follows the ROM command, and the ROM code for Match ROM
+    if (sensorReceived == ((sensorROMCommand == 0x55) ? 10 : 2) && sensorByte == READ_SCRATCHPAD)
+        sensorSending = 9 * 8;
+
+    //a convertion is always done, its read slots answer 1
+    return 1;
+}
+
+/**
+ * Prints the counts of an operation, one line per bus it used.
+ */
+static void BusCountPrint(const char *operation)
+{
+    unsigned char bus;
+
+    for (bus = 0; bus < MOCK_BUSES; bus++)
+    {
+        MockBusEnd(bus);
+    }
+
+    for (bus = 0; bus < MOCK_BUSES; bus++)
+    {
+        tMockBusStatistics *statistics = &MockBusStatistics[bus];
+
+        if (statistics->Bits == 0)
+            continue;
+
+        printf("%s,%s,%lu,%lu,%lu,%lu\n", operation, busNames[bus],
+               (unsigned long) statistics->Transactions, (unsigned long) statistics->Written,
+               (unsigned long) statistics->Read, (unsigned long) statistics->Bits);
+    }
+
+    MockBusReset();
+}
+
+static void BusCountI2C(void)
+{
+    int16_t ax, ay, az, gx, gy, gz, mx, my, mz;
+    int x, y, z;
+
+    ax = MPU9150GetAccelX();
+    BusCountPrint("MPU9150GetAccelX");
+
+    MPU9150GetMotion6(&ax, &ay, &az, &gx, &gy, &gz);
+    BusCountPrint("MPU9150GetMotion6");
+
+    MPU9150GetMotion9(&ax, &ay, &az, &gx, &gy, &gz, &mx, &my, &mz);
+    BusCountPrint("MPU9150GetMotion9");
+
+    MPU9150SetAccelConfig(1 << 3);
+    BusCountPrint("MPU9150SetAccelConfig");
+
+    I2CDeviceSetDeviceAddress(HMC5883L_ADDRESS);
+    HMC5883LGetHeading(&x, &y, &z);
+    BusCountPrint("HMC5883LGetHeading");
+}
+
+static void BusCountSD(void)
+{
+    static unsigned char buffer[8 * 512];
+
+    if (!sd_raw_init())
+    {
+        fprintf(stderr, "sd_raw_init failed\n");
+        exit(1);
+    }
+    BusCountPrint("sd_raw_init");
+
+    sd_raw_read(1000, 0, buffer, 1);
+    BusCountPrint("sd_raw_read 1");
+
+    sd_raw_read(1001, 0, buffer, 64);
+    BusCountPrint("sd_raw_read 64");
+
+    sd_raw_read(1002, 0, buffer, 512);
+    BusCountPrint("sd_raw_read 512");
+
+    sd_raw_read(1010, 0, buffer, sizeof (buffer));
+    BusCountPrint("sd_raw_read 4096");
+
+    sd_raw_read_multi(1020, buffer, 8);
+    BusCountPrint("sd_raw_read_multi 8");
+
+    sd_raw_write(1030, 0, buffer, 512);
+    sd_raw_sync();
+    BusCountPrint("sd_raw_write 512");
+
+    sd_raw_write_multi(1040, buffer, 8);
+    BusCountPrint("sd_raw_write_multi 8");
+
+    if (memcmp(MockSDBlock(1040), buffer, 512) != 0)
+    {
+        fprintf(stderr, "sd_raw_write_multi wrote wrong data\n");
+        exit(1);
+    }
+}
+
+static void BusCountFlash(void)
+{
+    static uint8_t buffer[FLASH_PAGE_SIZE];
+
+    FlashReadBuffer(0x1000, buffer, sizeof (buffer));
+    BusCountPrint("FlashReadBuffer 256");
+
+    FlashWriteBuffer(0x1000, buffer, sizeof (buffer));
+    BusCountPrint("FlashWriteBuffer 256");
+
+    FlashSector4KErase(0x1000);
+    BusCountPrint("FlashSector4KErase");
+}
+
+static void BusCountOneWire(void)
+{
+    tLaseredROMCode rom = {{0x28, 1, 2, 3, 4, 5, 6, 0}};
+    float temperature;
+
+    scratchpad[8] = OneWireCRC8(scratchpad, 8);
+
+    DS18B20IssueTemperatureConvertion(&rom);
+    BusCountPrint("DS18B20IssueTemperatureConvertion");
+
+    if (!DS18B20GetTemperature(&rom, &temperature))
+    {
+        fprintf(stderr, "DS18B20GetTemperature failed\n");
+        exit(1);
+    }
+    BusCountPrint("DS18B20GetTemperature");
+
+    DS18B20GetTemperature(NULL, &temperature);
+    BusCountPrint("DS18B20GetTemperature skip");
+}
+
+int main(void)
+{
+    //MPU-9150 data ready, AK8975 data ready
+    mpu9150[0x75] = 0x68;
+    magnetometer[0x02] = 0x01;
+
+    MockI2CAttach(MPU9150_ADD_DEFAULT, mpu9150, sizeof (mpu9150));
+    MockI2CAttach(MPU9150_ADD_MAG, magnetometer, sizeof (magnetometer));
+    MockI2CAttach(HMC5883L_ADDRESS, hmc5883l, sizeof (hmc5883l));
+
+    MockSDInit();
+    MockSPIAttach(MOCK_SPI_SD, MockSDExchange);
+    MockSPIAttach(MOCK_SPI_FLASH, FlashExchange);
+
+    MockOneWireAttach(SensorReset, SensorSlot);
+
+    printf("operation,bus,transactions,written,read,bits\n");
+
+    MockBusReset();
+    BusCountI2C();
+    BusCountSD();
+    BusCountFlash();
+    BusCountOneWire();
+
+    return 0;
+}
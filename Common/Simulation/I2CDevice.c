@@ -0,0 +1,455 @@
+/**
+ *  @file       I2CDevice.c
+ *  @author     Luis Maduro
+ *  @version    1.00
+ *  @date       14/10/2026
+ *  @brief      I2C of the host build, on simulated devices.
+ *
+ *  Copyright (C) 2026  Luis Maduro
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <stddef.h>
+#include "I2CDevice.h"
+
+unsigned char deviceAddressRead;
+unsigned char deviceAddressWrite;
+
+typedef struct
+{
+    unsigned char address;
+    unsigned char *registers;
+    unsigned int size;
+    unsigned int pointer;
+} tMockI2CDevice;
+
+static tMockI2CDevice devices[MOCK_I2C_DEVICES];
+static unsigned char deviceCount;
+
+/**Device addressed since the last start, NULL if none answered.*/
+static tMockI2CDevice *addressed;
+/**The next byte written is the address byte.*/
+static bool addressNext;
+/**The device was addressed to read.*/
+static bool reading;
+/**The register pointer was written in this write.*/
+static bool pointerWritten;
+
+/**
+ * Puts a device on the bus.
+ * @param address Address of the slave NOT SHIFTED.
+ * @param registers Registers of the device, read and written by the bus.
+ * @param size Number of registers, the pointer wraps at the end.
+ * @return False if there is no room for it.
+ */
+bool MockI2CAttach(unsigned char address, unsigned char *registers, unsigned int size)
+{
+    if (deviceCount >= MOCK_I2C_DEVICES)
+        return false;
+
+    devices[deviceCount].address = address;
+    devices[deviceCount].registers = registers;
+    devices[deviceCount].size = size;
+    devices[deviceCount].pointer = 0;
+    deviceCount++;
+
+    return true;
+}
+
+void MockI2CDetachAll(void)
+{
+    deviceCount = 0;
+    addressed = NULL;
+}
+
+static tMockI2CDevice *MockI2CFind(unsigned char address)
+{
+    unsigned char i;
+
+    for (i = 0; i < deviceCount; i++)
+    {
+        if (devices[i].address == address)
+            return &devices[i];
+    }
+
+    return NULL;
+}
+
+void I2CInit(void)
+{
+    addressed = NULL;
+    addressNext = false;
+}
+
+void I2CStart(void)
+{
+    MockBusBegin(MOCK_BUS_I2C, 0);
+    MockBusBits(MOCK_BUS_I2C, 1);
+    addressNext = true;
+}
+
+/**
+ * A repeated start stays in the same transaction.
+ */
+void I2CRestart(void)
+{
+    MockBusBits(MOCK_BUS_I2C, 1);
+    addressNext = true;
+}
+
+void I2CStop(void)
+{
+    MockBusBits(MOCK_BUS_I2C, 1);
+    MockBusEnd(MOCK_BUS_I2C);
+    addressed = NULL;
+}
+
+/**
+ * The acknowledge is counted with its byte by I2CRead().
+ */
+void I2CAck(void)
+{
+}
+
+void I2CNotAck(void)
+{
+}
+
+void I2CSendAddress(unsigned char Address, unsigned char I2C_Direction)
+{
+    I2CDeviceSetDeviceAddress(Address);
+    if (I2C_Direction == I2C_Direction_Receiver)
+        I2CWrite(deviceAddressRead);
+    else if (I2C_Direction == I2C_Direction_Transmitter)
+        I2CWrite(deviceAddressWrite);
+}
+
+/**
+ * Sends a byte, the address byte after a start.
+ * @return 0 if the device acknowledged, -2 if not.
+ */
+unsigned char I2CWrite(unsigned char data_out)
+{
+    MockBusWrite(MOCK_BUS_I2C, 1);
+    MockBusBits(MOCK_BUS_I2C, 9);
+
+    if (addressNext)
+    {
+        addressNext = false;
+        addressed = MockI2CFind(data_out >> 1);
+        reading = (data_out & 0x01) != 0;
+        pointerWritten = false;
+
+        MockBusSetDevice(MOCK_BUS_I2C, data_out >> 1);
+
+        return (addressed == NULL) ? -2 : 0;
+    }
+
+    if (addressed == NULL || reading)
+        return -2;
+
+    if (!pointerWritten)
+    {
+        addressed->pointer = data_out % addressed->size;
+        pointerWritten = true;
+    }
+    else
+    {
+        addressed->registers[addressed->pointer] = data_out;
+        addressed->pointer = (addressed->pointer + 1) % addressed->size;
+    }
+
+    return 0;
+}
+
+/**
+ * Reads a byte from the current register of the device.
+ * @return The register, 0xFF without a device.
+ */
+unsigned char I2CRead(void)
+{
+    unsigned char value;
+
+    MockBusRead(MOCK_BUS_I2C, 1);
+    MockBusBits(MOCK_BUS_I2C, 9);
+
+    if (addressed == NULL || !reading)
+        return 0xFF;
+
+    value = addressed->registers[addressed->pointer];
+    addressed->pointer = (addressed->pointer + 1) % addressed->size;
+
+    return value;
+}
+
+void I2CDeviceSetDeviceAddress(unsigned char address)
+{
+    deviceAddressRead = (address << 1) | 0x01;
+    deviceAddressWrite = (address << 1) & 0xFE;
+}
+
+void I2CDeviceReadBytes(unsigned char address,
+                        unsigned char length,
+                        unsigned char *data)
+{
+    unsigned char i = 0;
+
+    I2CStart();
+    I2CWrite(deviceAddressWrite);
+    I2CWrite(address);
+    I2CRestart();
+
+    I2CWrite(deviceAddressRead);
+
+    for (i = 0; i < length; i++)
+    {
+        data[i] = I2CRead();
+
+        if (i == (length - 1))
+        {
+            I2CNotAck();
+        }
+        else
+        {
+            I2CAck();
+        }
+    }
+
+    I2CStop();
+}
+
+void I2CDeviceReadCurrentBytes(unsigned char length,
+                               unsigned char *data)
+{
+    unsigned char i = 0;
+
+    I2CStart();
+    I2CWrite(deviceAddressRead);
+
+    for (i = 0; i < length; i++)
+    {
+        data[i] = I2CRead();
+
+        if (i == (length - 1))
+        {
+            I2CNotAck();
+        }
+        else
+        {
+            I2CAck();
+        }
+    }
+
+    I2CStop();
+}
+
+void I2CDeviceWriteBytes(unsigned char address,
+                         unsigned char length,
+                         unsigned char *data)
+{
+    unsigned char i;
+
+    I2CStart();
+    I2CWrite(deviceAddressWrite);
+    I2CWrite(address);
+
+    for (i = 0; i < length; i++)
+    {
+        I2CWrite(data[i]);
+    }
+    I2CStop();
+}
+
+void I2CDeviceWriteMessages(unsigned char count,
+                            unsigned char size,
+                            unsigned char *data)
+{
+    unsigned char i;
+
+    I2CStart();
+
+    while (count--)
+    {
+        I2CWrite(deviceAddressWrite);
+
+        for (i = 0; i < size; i++)
+        {
+            I2CWrite(*data++);
+        }
+
+        if (count)
+        {
+            I2CRestart();
+        }
+    }
+
+    I2CStop();
+}
+
+unsigned char I2CDeviceReadByte(unsigned char address)
+{
+    unsigned char b = 0;
+    I2CDeviceReadBytes(address, 1, &b);
+    return b;
+}
+
+/**
+ * Read-modify-write, as the port without I2C_USE_REGISTER_CACHE.
+ */
+void I2CDeviceUpdateByte(unsigned char address,
+                         unsigned char mask,
+                         unsigned char value)
+{
+    unsigned char b;
+
+    b = I2CDeviceReadByte(address);
+
+    b = (b & ~mask) | (value & mask);
+
+    I2CDeviceWriteByte(address, b);
+}
+
+void I2CDeviceWriteByte(unsigned char address,
+                        unsigned char value)
+{
+    I2CDeviceWriteBytes(address, 1, &value);
+}
+
+/**
+ * Runs the transaction at once, with its callback, the bus is never busy.
+ * @return 0, or !=0 if the transaction is not valid.
+ */
+unsigned char I2CDeviceStartTransaction(tI2CTransaction *transaction)
+{
+    unsigned char i;
+    unsigned char acknowledge;
+
+    if (transaction == NULL || (transaction->length != 0 && transaction->data == NULL))
+        return 1;
+
+    transaction->status = I2C_TRANSACTION_BUSY;
+
+    I2CDeviceSetDeviceAddress(transaction->deviceAddress);
+    I2CStart();
+
+    if (transaction->direction == I2C_Direction_ReceiverCurrent)
+    {
+        acknowledge = I2CWrite(deviceAddressRead);
+    }
+    else
+    {
+        acknowledge = I2CWrite(deviceAddressWrite);
+        I2CWrite(transaction->registerAddress);
+
+        if (transaction->direction == I2C_Direction_Receiver)
+        {
+            I2CRestart();
+            I2CWrite(deviceAddressRead);
+        }
+    }
+
+    for (i = 0; i < transaction->length; i++)
+    {
+        if (transaction->direction == I2C_Direction_Transmitter)
+            I2CWrite(transaction->data[i]);
+        else
+            transaction->data[i] = I2CRead();
+    }
+
+    I2CStop();
+
+    transaction->status = acknowledge ? I2C_TRANSACTION_ERROR : I2C_TRANSACTION_DONE;
+
+    if (transaction->callback != NULL)
+        transaction->callback(transaction);
+
+    return 0;
+}
+
+unsigned char I2CDeviceQueueTransaction(tI2CDevice *device,
+                                        tI2CTransaction *transaction)
+{
+    if (device == NULL || transaction == NULL)
+        return 1;
+
+    transaction->deviceAddress = device->address;
+
+    return I2CDeviceStartTransaction(transaction);
+}
+
+unsigned char I2CDeviceIsBusy(void)
+{
+    return 0;
+}
+
+unsigned char I2CDeviceLock(void)
+{
+    return 0;
+}
+
+void I2CDeviceUnlock(unsigned char state)
+{
+    (void) state;
+}
+
+void I2CDeviceInitHandle(tI2CDevice *device, unsigned char address)
+{
+    device->address = address;
+}
+
+void I2CDeviceSelect(tI2CDevice *device)
+{
+    I2CDeviceSetDeviceAddress(device->address);
+}
+
+unsigned char I2CDeviceRead(tI2CDevice *device,
+                            unsigned char address,
+                            unsigned char length,
+                            unsigned char *data)
+{
+    tI2CTransaction transaction;
+
+    transaction.registerAddress = address;
+    transaction.direction = I2C_Direction_Receiver;
+    transaction.length = length;
+    transaction.data = data;
+    transaction.callback = NULL;
+    transaction.status = I2C_TRANSACTION_IDLE;
+
+    if (I2CDeviceQueueTransaction(device, &transaction))
+        return 1;
+
+    return transaction.status != I2C_TRANSACTION_DONE;
+}
+
+unsigned char I2CDeviceWrite(tI2CDevice *device,
+                             unsigned char address,
+                             unsigned char length,
+                             unsigned char *data)
+{
+    tI2CTransaction transaction;
+
+    transaction.registerAddress = address;
+    transaction.direction = I2C_Direction_Transmitter;
+    transaction.length = length;
+    transaction.data = data;
+    transaction.callback = NULL;
+    transaction.status = I2C_TRANSACTION_IDLE;
+
+    if (I2CDeviceQueueTransaction(device, &transaction))
+        return 1;
+
+    return transaction.status != I2C_TRANSACTION_DONE;
+}
@@ -0,0 +1,134 @@
+/**
+ *  @file       I2CDevice.h
+ *  @author     Luis Maduro
+ *  @version    1.00
+ *  @date       14/10/2026
+ *  @brief      I2C of the host build, on simulated devices.
+ *
+ *  The functions of the I2CDevice.h of the PIC18F, done the same way on the
+ *  bus (start, address, register, repeated start...) so the bytes counted
+ *  are the ones of the target. A device is a block of registers given to
+ *  MockI2CAttach(), its register pointer is written by the first byte after
+ *  the address and moves by one per byte read or written. A read from an
+ *  address without a device gets 0xFF and I2CWrite() reports the missing
+ *  acknowledge. The queued transactions run at once, before
+ *  I2CDeviceStartTransaction() returns.
+ *
+ *  Copyright (C) 2026  Luis Maduro
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef _I2CDEV_H_
+#define _I2CDEV_H_
+
+#include "MockBus.h"
+#include "RegisterField.h"
+
+extern unsigned char deviceAddressRead;
+extern unsigned char deviceAddressWrite;
+
+/**Devices that can be attached.*/
+#define MOCK_I2C_DEVICES            8
+
+#define  I2C_Direction_Transmitter      0x00
+#define  I2C_Direction_Receiver         0x01
+#define  I2C_Direction_ReceiverCurrent  0x02
+
+typedef enum
+{
+    I2C_TRANSACTION_IDLE,
+    I2C_TRANSACTION_BUSY,
+    I2C_TRANSACTION_DONE,
+    I2C_TRANSACTION_ERROR
+} tI2CTransactionStatus;
+
+typedef struct _tI2CTransaction
+{
+    unsigned char deviceAddress;
+    unsigned char registerAddress;
+    unsigned char direction;
+    unsigned char length;
+    unsigned char *data;
+    void (*callback)(struct _tI2CTransaction *transaction);
+    volatile tI2CTransactionStatus status;
+    struct _tI2CTransaction *next;
+} tI2CTransaction;
+
+typedef struct _tI2CDevice
+{
+    unsigned char address;
+} tI2CDevice;
+
+bool MockI2CAttach(unsigned char address, unsigned char *registers, unsigned int size);
+void MockI2CDetachAll(void);
+
+void I2CInit(void);
+void I2CStart(void);
+void I2CRestart(void);
+void I2CStop(void);
+void I2CAck(void);
+void I2CNotAck(void);
+void I2CSendAddress(unsigned char Address, unsigned char I2C_Direction);
+unsigned char I2CWrite(unsigned char data_out);
+unsigned char I2CRead(void);
+void I2CDeviceSetDeviceAddress(unsigned char address);
+unsigned char I2CDeviceReadByte(unsigned char address);
+void I2CDeviceReadBytes(unsigned char address,
+                        unsigned char length,
+                        unsigned char *data);
+void I2CDeviceReadCurrentBytes(unsigned char length,
+                               unsigned char *data);
+void I2CDeviceUpdateByte(unsigned char address,
+                         unsigned char mask,
+                         unsigned char value);
+void I2CDeviceWriteByte(unsigned char address,
+                        unsigned char value);
+void I2CDeviceWriteBytes(unsigned char address,
+                         unsigned char length,
+                         unsigned char *data);
+void I2CDeviceWriteMessages(unsigned char count,
+                            unsigned char size,
+                            unsigned char *data);
+unsigned char I2CDeviceStartTransaction(tI2CTransaction *transaction);
+unsigned char I2CDeviceQueueTransaction(tI2CDevice *device,
+                                        tI2CTransaction *transaction);
+unsigned char I2CDeviceIsBusy(void);
+unsigned char I2CDeviceLock(void);
+void I2CDeviceUnlock(unsigned char state);
+void I2CDeviceInitHandle(tI2CDevice *device, unsigned char address);
+void I2CDeviceSelect(tI2CDevice *device);
+unsigned char I2CDeviceRead(tI2CDevice *device,
+                            unsigned char address,
+                            unsigned char length,
+                            unsigned char *data);
+unsigned char I2CDeviceWrite(tI2CDevice *device,
+                             unsigned char address,
+                             unsigned char length,
+                             unsigned char *data);
+
+/**The bit accessors are macros over I2CDeviceReadByte() and
+ I2CDeviceUpdateByte(): with the positions of the drivers, constants, the
+ masks and the shifts are folded at compile time. See RegisterField.h.*/
+#define I2CDeviceReadBit(address, _bit)                                     \
+    (I2CDeviceReadByte(address) & REGISTER_BIT_MASK(_bit))
+#define I2CDeviceReadBits(address, bitStart, length)                        \
+    REGISTER_FIELD_GET(I2CDeviceReadByte(address), bitStart, length)
+#define I2CDeviceWriteBit(address, _bit, value)                             \
+    I2CDeviceUpdateByte((address), REGISTER_BIT_MASK(_bit), (value) ? 0xFF : 0)
+#define I2CDeviceWriteBits(address, bitStart, length, value)                \
+    I2CDeviceUpdateByte((address), REGISTER_FIELD_MASK(bitStart, length),  \
+                        REGISTER_FIELD_VALUE(bitStart, length, value))
+
+#endif /* _I2CDEV_H_ */
@@ -0,0 +1,36 @@
+/**
+ *  @file       Kernel.c
+ *  @author     Luis Maduro
+ *  @version    1.00
+ *  @date       14/10/2026
+ *  @brief      Services of the kernel used by the drivers, for the host
+ *              build.
+ *
+ *  The drivers only wait with the kernel, the time is simulated: a delay
+ *  moves the millisecond counter at once instead of waiting for the timer
+ *  interrupt. Not linked with uKernel.c.
+ *
+ *  Copyright (C) 2026  Luis Maduro
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "uKernel/uKernel.h"
+
+volatile uint32_t _counterMs;
+
+void uKernelDelayMiliseconds(unsigned int delay)
+{
+    _counterMs += delay;
+}
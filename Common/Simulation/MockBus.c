@@ -0,0 +1,104 @@
+/**
+ *  @file       MockBus.c
+ *  @author     Luis Maduro
+ *  @version    1.00
+ *  @date       14/10/2026
+ *  @brief      Transactions and bytes of the simulated buses.
+ *
+ *  Copyright (C) 2026  Luis Maduro
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <string.h>
+#include "MockBus.h"
+
+tMockBusStatistics MockBusStatistics[MOCK_BUSES];
+tMockBusTransaction MockBusLog[MOCK_BUS_LOG_SIZE];
+uint32_t MockBusLogCount;
+
+/**Transaction running on each bus.*/
+static tMockBusTransaction current[MOCK_BUSES];
+static bool open[MOCK_BUSES];
+
+/**
+ * Clears the counts and the log, before the operation measured.
+ */
+void MockBusReset(void)
+{
+    memset(MockBusStatistics, 0, sizeof (MockBusStatistics));
+    MockBusLogCount = 0;
+}
+
+/**
+ * Starts a transaction, the one running on the bus is ended first.
+ * @param bus MOCK_BUS_I2C, MOCK_BUS_SPI or MOCK_BUS_ONEWIRE.
+ * @param device Address or chip select.
+ */
+void MockBusBegin(uint8_t bus, uint8_t device)
+{
+    if (open[bus])
+        MockBusEnd(bus);
+
+    current[bus].Bus = bus;
+    current[bus].Device = device;
+    current[bus].Written = 0;
+    current[bus].Read = 0;
+    open[bus] = true;
+}
+
+/**
+ * Gives the device of the running transaction, known after its start on
+ * I2C.
+ */
+void MockBusSetDevice(uint8_t bus, uint8_t device)
+{
+    current[bus].Device = device;
+}
+
+void MockBusWrite(uint8_t bus, unsigned int bytes)
+{
+    MockBusStatistics[bus].Written += bytes;
+    current[bus].Written += bytes;
+}
+
+void MockBusRead(uint8_t bus, unsigned int bytes)
+{
+    MockBusStatistics[bus].Read += bytes;
+    current[bus].Read += bytes;
+}
+
+void MockBusBits(uint8_t bus, unsigned int bits)
+{
+    MockBusStatistics[bus].Bits += bits;
+}
+
+/**
+ * Ends the transaction running on the bus and logs it.
+ */
+void MockBusEnd(uint8_t bus)
+{
+    if (!open[bus])
+        return;
+
+    open[bus] = false;
+    MockBusStatistics[bus].Transactions++;
+    MockBusLog[MockBusLogCount % MOCK_BUS_LOG_SIZE] = current[bus];
+    MockBusLogCount++;
+}
+
+bool MockBusIsOpen(uint8_t bus)
+{
+    return open[bus];
+}
@@ -0,0 +1,91 @@
+/**
+ *  @file       MockBus.h
+ *  @author     Luis Maduro
+ *  @version    1.00
+ *  @date       14/10/2026
+ *  @brief      Transactions and bytes of the simulated buses.
+ *
+ *  The host build of the drivers of Common takes the I2CDevice.h,
+ *  SPIDevice.h and OneWire.h of this folder instead of the ones of a port:
+ *  the same functions, done on simulated devices instead of the SFRs. Each
+ *  of them counts what goes on its bus in MockBusStatistics, and keeps the
+ *  last transactions in MockBusLog, so the cost of a call of a driver is
+ *  the difference of the counts before and after it.
+ *
+ *  A transaction is a start to a stop on I2C, a select to a deselect on SPI
+ *  and a reset to the next reset on the 1-Wire bus. The bytes are counted
+ *  as they are clocked, with the overhead: the address bytes of I2C, the
+ *  commands and the dummy bytes of SPI, the ROM commands of 1-Wire.
+ *
+ *  Copyright (C) 2026  Luis Maduro
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef MOCKBUS_H
+#define MOCKBUS_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#define MOCK_BUS_I2C                0
+#define MOCK_BUS_SPI                1
+#define MOCK_BUS_ONEWIRE            2
+#define MOCK_BUSES                  3
+
+/**Transactions kept in MockBusLog, the older ones are overwritten.*/
+#ifndef MOCK_BUS_LOG_SIZE
+#define MOCK_BUS_LOG_SIZE           64
+#endif
+
+typedef struct
+{
+    /**Transactions ended.*/
+    uint32_t Transactions;
+    /**Bytes sent by the master.*/
+    uint32_t Written;
+    /**Bytes received by the master.*/
+    uint32_t Read;
+    /**Bit times: 9 per I2C byte with its acknowledge and 1 per start or
+     * stop, 8 per SPI byte, 1 per 1-Wire time slot.*/
+    uint32_t Bits;
+} tMockBusStatistics;
+
+typedef struct
+{
+    /**MOCK_BUS_I2C, MOCK_BUS_SPI or MOCK_BUS_ONEWIRE.*/
+    uint8_t Bus;
+    /**Address of the I2C slave, chip select of SPI, 0 for 1-Wire.*/
+    uint8_t Device;
+    /**Bytes of the transaction.*/
+    uint16_t Written;
+    uint16_t Read;
+} tMockBusTransaction;
+
+extern tMockBusStatistics MockBusStatistics[MOCK_BUSES];
+extern tMockBusTransaction MockBusLog[MOCK_BUS_LOG_SIZE];
+/**Transactions logged since MockBusReset(), the last one is
+ * MockBusLog[(MockBusLogCount - 1) % MOCK_BUS_LOG_SIZE].*/
+extern uint32_t MockBusLogCount;
+
+void MockBusReset(void);
+void MockBusBegin(uint8_t bus, uint8_t device);
+void MockBusSetDevice(uint8_t bus, uint8_t device);
+void MockBusWrite(uint8_t bus, unsigned int bytes);
+void MockBusRead(uint8_t bus, unsigned int bytes);
+void MockBusBits(uint8_t bus, unsigned int bits);
+void MockBusEnd(uint8_t bus);
+bool MockBusIsOpen(uint8_t bus);
+
+#endif /* MOCKBUS_H */
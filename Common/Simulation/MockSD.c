@@ -0,0 +1,295 @@
+/**
+ *  @file       MockSD.c
+ *  @author     Luis Maduro
+ *  @version    1.00
+ *  @date       14/10/2026
+ *  @brief      SD card in SPI mode, for the host build of SDCardRaw.
+ *
+ *  Copyright (C) 2026  Luis Maduro
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <string.h>
+#include "MockSD.h"
+
+/**Bytes of the longest answer queued at once: a block with its token and
+ * CRC.*/
+#define MOCK_SD_QUEUE               (1 + 512 + 2 + 4)
+
+#define MOCK_SD_IDLE                0
+/**A single block write waits for its start token.*/
+#define MOCK_SD_WRITE_TOKEN         1
+/**A multiple block write waits for a start or a stop token.*/
+#define MOCK_SD_WRITE_MULTI_TOKEN   2
+#define MOCK_SD_WRITE_DATA          3
+#define MOCK_SD_WRITE_MULTI_DATA    4
+
+static unsigned char card[MOCK_SD_BLOCKS][512];
+
+static unsigned char queue[MOCK_SD_QUEUE];
+static unsigned int queueHead;
+static unsigned int queueLength;
+
+static unsigned char command[6];
+static unsigned char commandLength;
+static unsigned char state;
+static unsigned char idle;
+static unsigned char application;
+/**Block of the next block sent by a multiple block read, or written.*/
+static uint32_t block;
+static unsigned char reading;
+static unsigned int dataLength;
+/**Busy bytes after a write.*/
+static unsigned char busy;
+
+/**CSD version 2, TRAN_SPEED 25 MHz.*/
+static const unsigned char csd[16] = {
+    0x40, 0x0E, 0x00, 0x32, 0x5B, 0x59, 0x00, 0x00,
+    0x01, 0x7F, 0x80, 0x0A, 0x40, 0x00, 0x00, 0x01
+};
+
+unsigned char *MockSDBlock(uint32_t number)
+{
+    return card[number % MOCK_SD_BLOCKS];
+}
+
+void MockSDInit(void)
+{
+    uint32_t i;
+
+    for (i = 0; i < MOCK_SD_BLOCKS; i++)
+    {
+        memset(card[i], (unsigned char) i, 512);
+    }
+
+    queueLength = 0;
+    commandLength = 0;
+    state = MOCK_SD_IDLE;
+    idle = 1;
+    application = 0;
+    reading = 0;
+    busy = 0;
+}
+
+static void MockSDQueue(const unsigned char *bytes, unsigned int length)
+{
+    if (queueLength == 0)
+        queueHead = 0;
+
+    memcpy(&queue[queueHead + queueLength], bytes, length);
+    queueLength += length;
+}
+
+static void MockSDQueueByte(unsigned char b)
+{
+    MockSDQueue(&b, 1);
+}
+
+/**
+ * Queues a data block, its start token and CRC, after a gap byte.
+ */
+static void MockSDQueueBlock(const unsigned char *data, unsigned int length)
+{
+    MockSDQueueByte(0xFF);
+    MockSDQueueByte(0xFE);
+    MockSDQueue(data, length);
+    MockSDQueueByte(0x00);
+    MockSDQueueByte(0x00);
+}
+
+/**
+ * Queues the response to the command received, after the byte before it.
+ */
+static void MockSDCommand(void)
+{
+    unsigned char index = command[0] & 0x3F;
+    uint32_t argument = ((uint32_t) command[1] << 24) | ((uint32_t) command[2] << 16)
+            | ((uint32_t) command[3] << 8) | command[4];
+    unsigned char r1 = idle;
+    unsigned char wasApplication = application;
+
+    application = 0;
+    queueLength = 0;
+
+    //the stop has a stuff byte before its response, and ends busy
+    if (index == 12)
+    {
+        reading = 0;
+        MockSDQueueByte(0xFF);
+        MockSDQueueByte(0xFF);
+        MockSDQueueByte(r1);
+        busy = 1;
+        return;
+    }
+
+    MockSDQueueByte(0xFF);
+
+    switch (index)
+    {
+    case 0:
+        idle = 1;
+        MockSDQueueByte(idle);
+        break;
+    case 8:
+        MockSDQueueByte(r1);
+        MockSDQueueByte(0x00);
+        MockSDQueueByte(0x00);
+        MockSDQueueByte(command[3] & 0x0F);
+        MockSDQueueByte(command[4]);
+        break;
+    case 41:
+        if (!wasApplication)
+        {
+            MockSDQueueByte(r1 | 0x04);
+            break;
+        }
+        idle = 0;
+        MockSDQueueByte(idle);
+        break;
+    case 55:
+        application = 1;
+        MockSDQueueByte(r1);
+        break;
+    case 58:
+        MockSDQueueByte(r1);
+        //powered up, CCS: a high capacity card
+        MockSDQueueByte(0xC0);
+        MockSDQueueByte(0xFF);
+        MockSDQueueByte(0x80);
+        MockSDQueueByte(0x00);
+        break;
+    case 9:
+        MockSDQueueByte(r1);
+        MockSDQueueBlock(csd, sizeof (csd));
+        break;
+    case 10:
+    {
+        static const unsigned char cid[16] = {0x03, 'S', 'M', 'S', 'I', 'M', 'U', 'L'};
+
+        MockSDQueueByte(r1);
+        MockSDQueueBlock(cid, sizeof (cid));
+        break;
+    }
+    case 16:
+    case 23:
+        MockSDQueueByte(r1);
+        break;
+    case 17:
+        MockSDQueueByte(r1);
+        MockSDQueueBlock(MockSDBlock(argument), 512);
+        break;
+    case 18:
+        MockSDQueueByte(r1);
+        block = argument;
+        reading = 1;
+        break;
+    case 24:
+        MockSDQueueByte(r1);
+        block = argument;
+        state = MOCK_SD_WRITE_TOKEN;
+        break;
+    case 25:
+        MockSDQueueByte(r1);
+        block = argument;
+        state = MOCK_SD_WRITE_MULTI_TOKEN;
+        break;
+    default:
+        //illegal command
+        MockSDQueueByte(r1 | 0x04);
+        break;
+    }
+}
+
+/**
+ * Takes a byte of a block written, the data response and the busy byte
+ * after its CRC.
+ */
+static void MockSDWriteData(unsigned char mosi)
+{
+    if (dataLength < 512)
+        MockSDBlock(block)[dataLength] = mosi;
+
+    if (++dataLength < 512 + 2)
+        return;
+
+    block++;
+    MockSDQueueByte(0xE5);
+    busy = 1;
+    state = (state == MOCK_SD_WRITE_MULTI_DATA) ? MOCK_SD_WRITE_MULTI_TOKEN : MOCK_SD_IDLE;
+}
+
+/**
+ * The card on the bus, see MockSPIAttach().
+ * @param mosi Byte sent by the master.
+ * @return Byte sent by the card.
+ */
+unsigned char MockSDExchange(unsigned char mosi)
+{
+    unsigned char miso = 0xFF;
+
+    //answer of the byte clocked now, from what was received before
+    if (queueLength != 0)
+    {
+        miso = queue[queueHead++];
+        queueLength--;
+    }
+    else if (busy != 0)
+    {
+        busy--;
+        miso = 0x00;
+    }
+    else if (reading)
+    {
+        MockSDQueueBlock(MockSDBlock(block++), 512);
+        miso = queue[queueHead++];
+        queueLength--;
+    }
+
+    switch (state)
+    {
+    case MOCK_SD_WRITE_TOKEN:
+    case MOCK_SD_WRITE_MULTI_TOKEN:
+        if (mosi == 0xFE || mosi == 0xFC)
+        {
+            dataLength = 0;
+            state = (state == MOCK_SD_WRITE_TOKEN) ? MOCK_SD_WRITE_DATA : MOCK_SD_WRITE_MULTI_DATA;
+        }
+        else if (mosi == 0xFD && state == MOCK_SD_WRITE_MULTI_TOKEN)
+        {
+            busy = 1;
+            state = MOCK_SD_IDLE;
+        }
+        break;
+    case MOCK_SD_WRITE_DATA:
+    case MOCK_SD_WRITE_MULTI_DATA:
+        MockSDWriteData(mosi);
+        break;
+    default:
+        //a command starts with 01, the bytes between are 0xFF
+        if (commandLength == 0 && (mosi & 0xC0) != 0x40)
+            break;
+
+        command[commandLength++] = mosi;
+
+        if (commandLength == sizeof (command))
+        {
+            commandLength = 0;
+            MockSDCommand();
+        }
+        break;
+    }
+
+    return miso;
+}
@@ -0,0 +1,46 @@
+/**
+ *  @file       MockSD.h
+ *  @author     Luis Maduro
+ *  @version    1.00
+ *  @date       14/10/2026
+ *  @brief      SD card in SPI mode, for the host build of SDCardRaw.
+ *
+ *  An SDHC card of MOCK_SD_BLOCKS blocks in RAM, the block numbers wrap at
+ *  the end. It answers the commands of sd_raw (reset, interface condition,
+ *  initialization, OCR, CSD, CID, block length, single and multiple block
+ *  reads and writes, stop) with the bytes of a real card: a byte before
+ *  every response, the start tokens, the CRC, the data response and one
+ *  busy byte after the writes. Put on the chip select of the card with
+ *  MockSPIAttach(MOCK_SPI_SD, MockSDExchange).
+ *
+ *  Copyright (C) 2026  Luis Maduro
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef MOCKSD_H
+#define MOCKSD_H
+
+#include <stdint.h>
+
+/**Blocks of the card, 1 MB.*/
+#ifndef MOCK_SD_BLOCKS
+#define MOCK_SD_BLOCKS              2048
+#endif
+
+void MockSDInit(void);
+unsigned char MockSDExchange(unsigned char mosi);
+unsigned char *MockSDBlock(uint32_t block);
+
+#endif /* MOCKSD_H */
@@ -0,0 +1,168 @@
+/**
+ *  @file       OneWire.c
+ *  @author     Luis Maduro
+ *  @version    1.00
+ *  @date       14/10/2026
+ *  @brief      1-Wire of the host build, on a simulated bus.
+ *
+ *  Copyright (C) 2026  Luis Maduro
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <stddef.h>
+#include "OneWire.h"
+
+static tMockOneWireReset deviceReset;
+static tMockOneWireSlot deviceSlot;
+
+/**
+ * Puts the devices on the bus, NULL to remove them.
+ */
+void MockOneWireAttach(tMockOneWireReset reset, tMockOneWireSlot slot)
+{
+    deviceReset = reset;
+    deviceSlot = slot;
+}
+
+/**
+ * A time slot, a bus without devices stays high.
+ */
+static unsigned char MockOneWireSlot(unsigned char bit)
+{
+    MockBusBits(MOCK_BUS_ONEWIRE, 1);
+
+    if (deviceSlot == NULL)
+        return bit;
+
+    return deviceSlot(bit) & bit;
+}
+
+void OneWireInit(void)
+{
+}
+
+/**
+ * Ends the transaction running and starts the next one.
+ * @return 1 for a presence pulse.
+ */
+unsigned char OneWireReset(void)
+{
+    MockBusBegin(MOCK_BUS_ONEWIRE, 0);
+
+    return (deviceReset != NULL) && deviceReset();
+}
+
+void OneWireSelect(tLaseredROMCode *device)
+{
+    OneWireWrite(0x55);
+    OneWireWriteBytes(device->Array, 8);
+}
+
+void OneWireSkip(void)
+{
+    OneWireWrite(0xCC);
+}
+
+void OneWireWrite(unsigned char v)
+{
+    unsigned char mask;
+
+    MockBusWrite(MOCK_BUS_ONEWIRE, 1);
+
+    for (mask = 0x01; mask; mask <<= 1)
+    {
+        MockOneWireSlot((v & mask) ? 1 : 0);
+    }
+}
+
+void OneWireWriteBytes(unsigned char *buf, unsigned int count)
+{
+    while (count--)
+    {
+        OneWireWrite(*buf++);
+    }
+}
+
+unsigned char OneWireRead(void)
+{
+    unsigned char mask;
+    unsigned char r = 0;
+
+    MockBusRead(MOCK_BUS_ONEWIRE, 1);
+
+    for (mask = 0x01; mask; mask <<= 1)
+    {
+        if (MockOneWireSlot(1))
+            r |= mask;
+    }
+
+    return r;
+}
+
+void OneWireReadBytes(unsigned char *buf, unsigned int count)
+{
+    while (count--)
+    {
+        *buf++ = OneWireRead();
+    }
+}
+
+void OneWireWriteBit(unsigned char v)
+{
+    MockOneWireSlot(v ? 1 : 0);
+}
+
+unsigned char OneWireReadBit(void)
+{
+    return MockOneWireSlot(1);
+}
+
+unsigned char OneWireCRC8Update(unsigned char crc, unsigned char inbyte)
+{
+    unsigned char i;
+
+    for (i = 8; i; i--)
+    {
+        unsigned char mix = (crc ^ inbyte) & 0x01;
+        crc >>= 1;
+        if (mix) crc ^= 0x8C;
+        inbyte >>= 1;
+    }
+    return crc;
+}
+
+unsigned char OneWireCRC8(unsigned char *addr, unsigned char len)
+{
+    unsigned char crc = 0;
+
+    while (len--)
+    {
+        crc = OneWireCRC8Update(crc, *addr++);
+    }
+    return crc;
+}
+
+unsigned char OneWireReadBytesCRC8(unsigned char *buf, unsigned int count)
+{
+    unsigned char crc = 0;
+    unsigned int i;
+
+    for (i = 0; i < count; i++)
+    {
+        buf[i] = OneWireRead();
+        crc = OneWireCRC8Update(crc, buf[i]);
+    }
+    return crc;
+}
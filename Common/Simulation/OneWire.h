@@ -0,0 +1,80 @@
+/**
+ *  @file       OneWire.h
+ *  @author     Luis Maduro
+ *  @version    1.00
+ *  @date       14/10/2026
+ *  @brief      1-Wire of the host build, on a simulated bus.
+ *
+ *  The byte and bit functions of the OneWire.h of the PIC18F, without the
+ *  search and the inventory. The devices on the bus are one model given to
+ *  MockOneWireAttach(): its reset gives the presence pulse and its slot
+ *  gets the bit of the master, 1 for a read slot, and gives the level of
+ *  the bus, the AND of the master and the devices.
+ *
+ *  Copyright (C) 2026  Luis Maduro
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef OneWire_h
+#define OneWire_h
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "MockBus.h"
+
+#define COPY_SCRATCHPAD         0x48
+#define WRITE_SCRATCHPAD        0x4E
+#define READ_SCRATCHPAD         0xBE
+#define RECALL_E_E              0xB8
+
+typedef union
+{
+    unsigned char Array[8];
+
+    struct
+    {
+        unsigned char FamilyCode;
+        unsigned char ROMCodeByte1;
+        unsigned char ROMCodeByte2;
+        unsigned char ROMCodeByte3;
+        unsigned char ROMCodeByte4;
+        unsigned char ROMCodeByte5;
+        unsigned char ROMCodeByte6;
+        unsigned char OWICRC;
+    };
+} tLaseredROMCode;
+
+/**Reset of the devices, true for a presence pulse.*/
+typedef bool (*tMockOneWireReset)(void);
+/**Time slot, the bit of the master in, the level of the bus out.*/
+typedef unsigned char (*tMockOneWireSlot)(unsigned char bit);
+
+void MockOneWireAttach(tMockOneWireReset reset, tMockOneWireSlot slot);
+
+void OneWireInit(void);
+unsigned char OneWireReset(void);
+void OneWireSelect(tLaseredROMCode *device);
+void OneWireSkip(void);
+void OneWireWrite(unsigned char v);
+void OneWireWriteBytes(unsigned char *buf, unsigned int count);
+unsigned char OneWireRead(void);
+void OneWireReadBytes(unsigned char *buf, unsigned int count);
+void OneWireWriteBit(unsigned char v);
+unsigned char OneWireReadBit(void);
+unsigned char OneWireCRC8(unsigned char *addr, unsigned char len);
+unsigned char OneWireCRC8Update(unsigned char crc, unsigned char inbyte);
+unsigned char OneWireReadBytesCRC8(unsigned char *buf, unsigned int count);
+
+#endif
@@ -0,0 +1,224 @@
+/**
+ *  @file       SPIDevice.c
+ *  @author     Luis Maduro
+ *  @version    1.00
+ *  @date       14/10/2026
+ *  @brief      SPI of the host build, on simulated devices.
+ *
+ *  Copyright (C) 2026  Luis Maduro
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <stddef.h>
+#include "SPIDevice.h"
+
+static tMockSPIExchange exchanges[MOCK_SPI_DEVICES];
+static unsigned char selected = MOCK_SPI_NONE;
+static unsigned long clockKHz;
+
+/**
+ * Puts a device on a chip select.
+ * @param cs Chip select, MOCK_SPI_SD...
+ * @param exchange Gives the byte clocked back for each byte sent, NULL to
+ *                 remove the device.
+ */
+void MockSPIAttach(unsigned char cs, tMockSPIExchange exchange)
+{
+    if (cs < MOCK_SPI_DEVICES)
+        exchanges[cs] = exchange;
+}
+
+/**
+ * Selects a device, a transaction until MockSPIDeselect().
+ */
+void MockSPISelect(unsigned char cs)
+{
+    if (selected == cs)
+        return;
+
+    selected = cs;
+    MockBusBegin(MOCK_BUS_SPI, cs);
+}
+
+void MockSPIDeselect(unsigned char cs)
+{
+    (void) cs;
+
+    selected = MOCK_SPI_NONE;
+    MockBusEnd(MOCK_BUS_SPI);
+}
+
+/**
+ * Clocks a byte, full duplex. The bytes clocked without a device selected
+ * (i.e. the clocks of the SD card before its select) count too.
+ * @param mosi Byte sent.
+ * @return Byte received.
+ */
+unsigned char MockSPIExchange(unsigned char mosi)
+{
+    MockBusBits(MOCK_BUS_SPI, 8);
+
+    if (selected < MOCK_SPI_DEVICES && exchanges[selected] != NULL)
+        return exchanges[selected](mosi);
+
+    return 0xFF;
+}
+
+void SPIInit(void)
+{
+    clockKHz = MOCK_SPI_MAX_KHZ;
+}
+
+unsigned long SPISetClock(unsigned long kHz)
+{
+    clockKHz = (kHz < MOCK_SPI_MAX_KHZ) ? kHz : MOCK_SPI_MAX_KHZ;
+
+    return clockKHz;
+}
+
+unsigned char SPIGetClock(void)
+{
+    return 0;
+}
+
+/**
+ * @return 0, as the PIC18F port, the byte received is dropped.
+ */
+unsigned char SPIWrite(unsigned char data)
+{
+    MockBusWrite(MOCK_BUS_SPI, 1);
+    MockSPIExchange(data);
+
+    return 0;
+}
+
+unsigned char SPIRead(void)
+{
+    MockBusRead(MOCK_BUS_SPI, 1);
+
+    return MockSPIExchange(0xFF);
+}
+
+void SPIDeviceReadBytes(unsigned char length,
+                        unsigned char *data)
+{
+    SPIDeviceReceiveData(data, length);
+}
+
+void SPIDeviceWriteBytes(unsigned char length,
+                         unsigned char *data)
+{
+    SPIDeviceSendData(data, length);
+}
+
+void SPIDeviceSendData(const unsigned char *data, unsigned int data_len)
+{
+    while (data_len--)
+    {
+        SPIWrite(*data++);
+    }
+}
+
+void SPIDeviceReceiveData(unsigned char *buffer, unsigned int buffer_len)
+{
+    while (buffer_len--)
+    {
+        *buffer++ = SPIRead();
+    }
+}
+
+void SPIDeviceInit(tSPIDevice *device,
+                   unsigned char cs,
+                   unsigned char mask,
+                   unsigned char mode,
+                   unsigned char clock)
+{
+    (void) mask;
+
+    device->cs = cs;
+    device->mode = mode;
+    device->clock = clock;
+}
+
+void SPIDeviceSetClock(tSPIDevice *device, unsigned char clock)
+{
+    device->clock = clock;
+}
+
+void SPIDeviceSelect(tSPIDevice *device)
+{
+    if (selected != MOCK_SPI_NONE && selected != device->cs)
+        MockSPIDeselect(selected);
+
+    MockSPISelect(device->cs);
+}
+
+void SPIDeviceDeselect(tSPIDevice *device)
+{
+    MockSPIDeselect(device->cs);
+}
+
+/**
+ * Runs the transfer at once, with its callback, the bus is never busy.
+ * @return 0, or !=0 if the transfer is not valid.
+ */
+unsigned char SPIDeviceStartTransfer(tSPITransfer *transfer)
+{
+    unsigned int i;
+    unsigned char received;
+
+    if (transfer == NULL || transfer->device == NULL)
+        return 1;
+
+    transfer->status = SPI_TRANSFER_BUSY;
+
+    SPIDeviceSelect(transfer->device);
+
+    for (i = 0; i < transfer->length; i++)
+    {
+        if (transfer->txData != NULL)
+        {
+            MockBusWrite(MOCK_BUS_SPI, 1);
+            received = MockSPIExchange(transfer->txData[i]);
+        }
+        else
+        {
+            MockBusRead(MOCK_BUS_SPI, 1);
+            received = MockSPIExchange(0xFF);
+        }
+
+        if (transfer->rxData != NULL)
+            transfer->rxData[i] = received;
+    }
+
+    if (!transfer->keepSelected)
+        SPIDeviceDeselect(transfer->device);
+
+    transfer->status = SPI_TRANSFER_DONE;
+
+    if (transfer->callback != NULL)
+        transfer->callback(transfer);
+
+    return 0;
+}
+
+unsigned char SPIDeviceIsBusy(void)
+{
+    return 0;
+}
+
+void SPIDeviceInterruptHandler(void)
+{
+}
@@ -0,0 +1,107 @@
+/**
+ *  @file       SPIDevice.h
+ *  @author     Luis Maduro
+ *  @version    1.00
+ *  @date       14/10/2026
+ *  @brief      SPI of the host build, on simulated devices.
+ *
+ *  The functions of the SPIDevice.h of the ports, on simulated devices.
+ *  Each chip select has an exchange function, given to MockSPIAttach(),
+ *  that gets the byte sent by the master and gives the byte it clocks
+ *  back. The select macros of the drivers (select_card(),
+ *  FlashMemorySelect()...) call MockSPISelect() with their chip select, a
+ *  select without a device reads 0xFF. The queued transfers run at once,
+ *  before SPIDeviceStartTransfer() returns.
+ *
+ *  SPIRead() sends 0xFF, the idle level of the SD cards.
+ *
+ *  Copyright (C) 2026  Luis Maduro
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef _SPIDEV_H_
+#define _SPIDEV_H_
+
+#include "MockBus.h"
+
+/**Chip selects of the simulated board.*/
+#define MOCK_SPI_SD                 0
+#define MOCK_SPI_FLASH              1
+#define MOCK_SPI_RADIO              2
+#define MOCK_SPI_DEVICES            4
+/**No device selected.*/
+#define MOCK_SPI_NONE               0xFF
+
+/**Clock of the simulated bus, the highest taken by SPISetClock().*/
+#define MOCK_SPI_MAX_KHZ            25000UL
+
+typedef unsigned char (*tMockSPIExchange)(unsigned char mosi);
+
+typedef struct _tSPIDevice
+{
+    /**Chip select, MOCK_SPI_SD...*/
+    unsigned char cs;
+    unsigned char mode;
+    unsigned char clock;
+} tSPIDevice;
+
+typedef enum
+{
+    SPI_TRANSFER_IDLE,
+    SPI_TRANSFER_BUSY,
+    SPI_TRANSFER_DONE
+} tSPITransferStatus;
+
+typedef struct _tSPITransfer
+{
+    tSPIDevice *device;
+    const unsigned char *txData;
+    unsigned char *rxData;
+    unsigned int length;
+    unsigned char keepSelected;
+    void (*callback)(struct _tSPITransfer *transfer);
+    volatile tSPITransferStatus status;
+    struct _tSPITransfer *next;
+} tSPITransfer;
+
+void MockSPIAttach(unsigned char cs, tMockSPIExchange exchange);
+void MockSPISelect(unsigned char cs);
+void MockSPIDeselect(unsigned char cs);
+unsigned char MockSPIExchange(unsigned char mosi);
+
+void SPIInit(void);
+unsigned long SPISetClock(unsigned long kHz);
+unsigned char SPIGetClock(void);
+unsigned char SPIWrite(unsigned char data);
+unsigned char SPIRead(void);
+void SPIDeviceReadBytes(unsigned char length,
+                        unsigned char *data);
+void SPIDeviceWriteBytes(unsigned char length,
+                         unsigned char *data);
+void SPIDeviceSendData(const unsigned char *data, unsigned int data_len);
+void SPIDeviceReceiveData(unsigned char *buffer, unsigned int buffer_len);
+void SPIDeviceInit(tSPIDevice *device,
+                   unsigned char cs,
+                   unsigned char mask,
+                   unsigned char mode,
+                   unsigned char clock);
+void SPIDeviceSetClock(tSPIDevice *device, unsigned char clock);
+void SPIDeviceSelect(tSPIDevice *device);
+void SPIDeviceDeselect(tSPIDevice *device);
+unsigned char SPIDeviceStartTransfer(tSPITransfer *transfer);
+unsigned char SPIDeviceIsBusy(void);
+void SPIDeviceInterruptHandler(void);
+
+#endif /* _SPIDEV_H_ */
@@ -0,0 +1,16 @@
+/**
+ *  @file       stdboolean.h
+ *  @author     Luis Maduro
+ *  @version    1.00
+ *  @date       14/10/2026
+ *  @brief      The boolean of the ports, for the host build.
+ */
+
+#ifndef __bool_true_and_false
+#define __bool_true_and_false
+
+#include <stdbool.h>
+
+typedef unsigned char boolean;
+
+#endif
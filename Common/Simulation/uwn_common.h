@@ -0,0 +1,26 @@
+/**
+ *  @file       uwn_common.h
+ *  @author     Luis Maduro
+ *  @version    1.00
+ *  @date       14/10/2026
+ *  @brief      Board of the host build, the pins of the devices on the
+ *              simulated buses.
+ */
+
+#ifndef UWN_COMMON_H
+#define UWN_COMMON_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "SPIDevice.h"
+
+#define FlashMemorySelect()         MockSPISelect(MOCK_SPI_FLASH)
+#define FlashMemoryDeselect()       MockSPIDeselect(MOCK_SPI_FLASH)
+
+#define RadioSelect()               MockSPISelect(MOCK_SPI_RADIO)
+#define RadioDeselect()             MockSPIDeselect(MOCK_SPI_RADIO)
+#define RadioHardwareReset()
+#define RadioPutToSleep()
+#define RadioWake()
+
+#endif /* UWN_COMMON_H */
@@ -0,0 +1,8 @@
+/**
+ *  @file       xc.h
+ *  @author     Luis Maduro
+ *  @version    1.00
+ *  @date       14/10/2026
+ *  @brief      Empty stand-in of the XC8 header for the host build, the
+ *              drivers built on the host don't use the SFRs directly.
+ */
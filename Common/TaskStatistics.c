@@ -0,0 +1,113 @@
+/**
+ *  @file       TaskStatistics.c
+ *  @brief      Execution time and start latency accounting for the schedulers.
+ *  @author     Luis Maduro
+ *  @version    1.00
+ *  @date       14/10/2026
+ *
+ *  Copyright (C) 2026  Luis Maduro
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "TaskStatistics.h"
+
+#ifdef USE_TASK_STATISTICS
+
+uint8_t TaskStatisticsWindow;
+
+/**
+ * Clears the statistics of a task.
+ * @param statistics Statistics of the task.
+ */
+void TaskStatisticsReset(tTaskStatistics *statistics)
+{
+    statistics->runs = 0;
+    statistics->lastRunTime = 0;
+    statistics->maxRunTime = 0;
+    statistics->totalRunTime = 0;
+    statistics->maxStartLatency = 0;
+    statistics->windowRunTime = 0;
+    statistics->lastWindowRunTime = 0;
+    statistics->window = TaskStatisticsWindow;
+}
+
+/**
+ * Accounts one execution of a task. Called by the schedulers.
+ * @param statistics Statistics of the task.
+ * @param startTime TASK_STATISTICS_TIMER() before calling the task.
+ * @param endTime TASK_STATISTICS_TIMER() after the task returned.
+ * @param startLatency How late the task started, in ms.
+ */
+void TaskStatisticsUpdate(tTaskStatistics *statistics,
+                          uint32_t startTime,
+                          uint32_t endTime,
+                          uint32_t startLatency)
+{
+    uint32_t runTime = endTime - startTime; //wrap safe
+
+    statistics->runs++;
+    statistics->lastRunTime = runTime;
+    statistics->totalRunTime += runTime;
+
+    if (statistics->window != TaskStatisticsWindow)
+    {
+        //the task didn't run in the windows in between
+        statistics->lastWindowRunTime = ((uint8_t) (TaskStatisticsWindow - statistics->window) == 1)
+                ? statistics->windowRunTime : 0;
+        statistics->windowRunTime = 0;
+        statistics->window = TaskStatisticsWindow;
+    }
+
+    statistics->windowRunTime += runTime;
+
+    if (runTime > statistics->maxRunTime)
+    {
+        statistics->maxRunTime = runTime;
+    }
+
+    if (startLatency > statistics->maxStartLatency)
+    {
+        statistics->maxStartLatency = startLatency;
+    }
+}
+
+/**
+ * Starts a new load window, called by the kernel at the end of each one.
+ */
+void TaskStatisticsNextWindow(void)
+{
+    TaskStatisticsWindow++;
+}
+
+/**
+ * Gives the run time of a task in the last complete load window.
+ * @param statistics Statistics of the task.
+ * @return Run time in TASK_STATISTICS_TIMER ticks.
+ */
+uint32_t TaskStatisticsGetWindowRunTime(const tTaskStatistics *statistics)
+{
+    switch ((uint8_t) (TaskStatisticsWindow - statistics->window))
+    {
+        case 0:
+            return statistics->lastWindowRunTime;
+        case 1:
+            //not run since the end of its window
+            return statistics->windowRunTime;
+        default:
+            return 0;
+    }
+}
+
+#endif
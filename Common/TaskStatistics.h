@@ -0,0 +1,113 @@
+/**
+ *  @file       TaskStatistics.h
+ *  @brief      Execution time and start latency accounting for the schedulers.
+ *  @author     Luis Maduro
+ *  @version    1.00
+ *  @date       14/10/2026
+ *
+ *  Copyright (C) 2026  Luis Maduro
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef TASKSTATISTICS_H
+#define TASKSTATISTICS_H
+
+#include <stdint.h>
+
+/**Uncomment to keep execution time and start latency statistics on every
+ task of Tasker, uKernel and pKernel.*/
+//#define USE_TASK_STATISTICS
+
+#ifdef USE_TASK_STATISTICS
+
+/**
+ * Free-running timer used to measure the run time of the tasks. It must
+ * count up and wrap at 2^32 (or be extended to 32 bits by the application).
+ * On the Cortex-M3 (STM32F1) the DWT cycle counter is used by default,
+ * other targets have to define it before including this file, i.e.
+ * #define TASK_STATISTICS_TIMER() ((uint32_t) TMR1)
+ */
+#ifndef TASK_STATISTICS_TIMER
+#if defined(__ARM_ARCH_7M__) || defined(__TARGET_ARCH_7_M) || defined(__CORTEX_M)
+#define DWT_CONTROL                 (*(volatile uint32_t *) 0xE0001000UL)
+#define DWT_CYCCNT                  (*(volatile uint32_t *) 0xE0001004UL)
+#define DEMCR                       (*(volatile uint32_t *) 0xE000EDFCUL)
+#define DEMCR_TRCENA                (1UL << 24)
+#define DWT_CYCCNTENA               (1UL << 0)
+#define TASK_STATISTICS_TIMER()     (DWT_CYCCNT)
+#define TASK_STATISTICS_TIMER_INIT()                \
+    do                                              \
+    {                                               \
+        DEMCR |= DEMCR_TRCENA;                      \
+        DWT_CYCCNT = 0;                             \
+        DWT_CONTROL |= DWT_CYCCNTENA;               \
+    } while (0)
+#else
+#error "TaskStatistics: define TASK_STATISTICS_TIMER() for this target"
+#endif
+#endif
+
+/**
+ * TASK_STATISTICS_TIMER ticks in a millisecond, for the time the timer is
+ * stopped in the tickless sleep of uKernel. The core clock for the DWT cycle
+ * counter, other targets define it if they use UKERNEL_USE_TICKLESS with
+ * UKERNEL_USE_CPU_LOAD.
+ */
+#if !defined(TASK_STATISTICS_TICKS_PER_MS) && defined(DWT_CYCCNT)
+extern uint32_t SystemCoreClock;
+#define TASK_STATISTICS_TICKS_PER_MS (SystemCoreClock / 1000)
+#endif
+
+/**Called once by the scheduler initialization to start the timer.*/
+#ifndef TASK_STATISTICS_TIMER_INIT
+#define TASK_STATISTICS_TIMER_INIT()
+#endif
+
+typedef struct
+{
+    /**Number of times the task ran.*/
+    uint32_t runs;
+    /**Run time of the last execution, in TASK_STATISTICS_TIMER ticks.*/
+    uint32_t lastRunTime;
+    /**Longest run time, in TASK_STATISTICS_TIMER ticks.*/
+    uint32_t maxRunTime;
+    /**Sum of all run times, in TASK_STATISTICS_TIMER ticks.*/
+    uint32_t totalRunTime;
+    /**Longest delay between the planned and the real start, in ms (in us
+     with UKERNEL_USE_US_TIMEBASE).*/
+    uint32_t maxStartLatency;
+    /**Run time in the current load window of the kernel and in the last
+     one, in TASK_STATISTICS_TIMER ticks. Only kept up to date when the task
+     runs, read them with TaskStatisticsGetWindowRunTime().*/
+    uint32_t windowRunTime;
+    uint32_t lastWindowRunTime;
+    /**Load window of windowRunTime.*/
+    uint8_t window;
+} tTaskStatistics;
+
+/**Number of the current load window, moved on by TaskStatisticsNextWindow().*/
+extern uint8_t TaskStatisticsWindow;
+
+void TaskStatisticsReset(tTaskStatistics *statistics);
+void TaskStatisticsUpdate(tTaskStatistics *statistics,
+                          uint32_t startTime,
+                          uint32_t endTime,
+                          uint32_t startLatency);
+void TaskStatisticsNextWindow(void);
+uint32_t TaskStatisticsGetWindowRunTime(const tTaskStatistics *statistics);
+
+#endif
+
+#endif /* TASKSTATISTICS_H */
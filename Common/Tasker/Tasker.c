@@ -6,212 +6,197 @@
 //include required libraries
 #include "Tasker.h"
 
-volatile unsigned long _counterMs = 0;
-volatile unsigned char _initialized = 0;
-volatile unsigned char numberTasks;
+void (*overrunHook)(void (*userTask)(void)) = NULL;
 
-TaskerCore Tasks[MAXIMUM_TASKS];
-
-void TaskerSetTimer();
-unsigned char TaskerSetTask(void (*)(void),
-                            unsigned char,
-                            unsigned long taskInterval);
+static void TaskerOverrun(uKernelTaskDescriptor *pTaskDescriptor);
 
 void TaskerBegin(void)
 {
-    _initialized = true;
-    numberTasks = 0;
+    uKernelInit();
 }
 
-unsigned char TaskerAddTask(void (*userTask)(void),
-                            unsigned long taskInterval,
-                            tTaskStatus taskStatus)
+tTaskHandle TaskerAddTask(void (*userTask)(void),
+                          unsigned long taskInterval,
+                          tTaskStatus taskStatus)
 {
-    if ((_initialized == false) || (numberTasks == MAXIMUM_TASKS))
+    TaskerCore *task;
+
+    //check if taskStatus is valid, if not schedule
+    if (taskStatus > IMMEDIATESTART)
     {
-        //max number of allowed tasks reached
-        return false;
+        taskStatus = SCHEDULED;
     }
 
-    if ((taskInterval < 1) || (taskInterval > MAX_TASK_INTERVAL))
+    //the interval is checked by uKernel, 50 ms if it is not valid
+    task = uKernelCreateTask(userTask, taskInterval,
+                             (uKernelTaskStatus) taskStatus);
+
+    if (task == NULL)
     {
-        taskInterval = 50; //50 ms by default
+        //max number of allowed tasks reached
+        return TASKER_INVALID_HANDLE;
     }
 
-    //check if taskStatus is valid, if not schedule
-    if (taskStatus > IMMEDIATESTART)
+    return uKernelGetPoolIndex(task) + 1;
+}
+
+tTaskHandle TaskerGetTaskHandle(void (*userTask)(void))
+{
+    TaskerCore *task;
+    unsigned char tempI;
+
+    for (tempI = 0; tempI < MAXIMUM_TASKS; tempI++)
     {
-        taskStatus = SCHEDULED;
+        task = uKernelGetPoolTask(tempI);
+
+        if ((task != NULL) && (task->taskPointer == *userTask))
+        {
+            return tempI + 1;
+        }
     }
 
-    Tasks[numberTasks].taskPointer = *userTask;
-    //I get only the first 2 bits - I don't need the IMMEDIATESTART bit
-    Tasks[numberTasks].taskIsActive = taskStatus & 0x03;
-    Tasks[numberTasks].userTasksInterval = taskInterval;
-    //no wait if the user wants the task up and running once added...
-    //...otherwise we wait for the interval before to run the task
-    Tasks[numberTasks].plannedTask =
-            _counterMs + ((taskStatus & 0x04) ? 0 : taskInterval);
+    return TASKER_INVALID_HANDLE;
+}
 
-    numberTasks++;
+TaskerCore *TaskerGetTaskDescriptor(tTaskHandle handle)
+{
+    if (handle == TASKER_INVALID_HANDLE)
+    {
+        return NULL;
+    }
 
-    return true;
+    return uKernelGetPoolTask(handle - 1);
 }
 
 unsigned char TaskerPauseTask(void (*userTask)(void))
 {
-    return (TaskerSetTask(userTask, PAUSED, NULL));
+    return TaskerPauseTaskHandle(TaskerGetTaskHandle(userTask));
+}
+
+unsigned char TaskerPauseTaskHandle(tTaskHandle handle)
+{
+    return uKernelPauseTask(TaskerGetTaskDescriptor(handle));
 }
 
 unsigned char TaskerResumeTask(void (*userTask)(void))
 {
-    return (TaskerSetTask(userTask, SCHEDULED, NULL));
+    return TaskerResumeTaskHandle(TaskerGetTaskHandle(userTask));
+}
+
+unsigned char TaskerResumeTaskHandle(tTaskHandle handle)
+{
+    return uKernelResumeTask(TaskerGetTaskDescriptor(handle));
 }
 
 unsigned char TaskerModifyTask(void (*userTask)(void),
                                unsigned long taskInterval,
                                tTaskStatus oneTimeTask)
 {
-    unsigned char tempI = 0;
-    unsigned char _done = 1;
+    return TaskerModifyTaskHandle(TaskerGetTaskHandle(userTask),
+                                  taskInterval, oneTimeTask);
+}
+
+unsigned char TaskerModifyTaskHandle(tTaskHandle handle,
+                                     unsigned long taskInterval,
+                                     tTaskStatus taskStatus)
+{
+    TaskerCore *task = TaskerGetTaskDescriptor(handle);
 
-    if ((oneTimeTask < SCHEDULED) && (oneTimeTask > ONETIME))
+    if (task == NULL)
     {
-        oneTimeTask = NULL;
+        return false;
     }
 
-    do
+    //an invalid status keeps the current one
+    if (taskStatus > IMMEDIATESTART)
     {
-        if (Tasks[tempI].taskPointer == *userTask)
-        { //task found
-            Tasks[tempI].userTasksInterval = taskInterval;
-            if (oneTimeTask != NULL)
-            {
-                Tasks[tempI].taskIsActive = oneTimeTask;
-            }
-            Tasks[tempI].plannedTask = _counterMs + taskInterval;
-            _done = 0;
-            break;
-        }
-        tempI++;
+        taskStatus = (tTaskStatus) task->taskStatus;
     }
-    while (tempI < numberTasks);
 
-    return _done;
+    return uKernelModifyTask(task, taskInterval,
+                             (uKernelTaskStatus) taskStatus);
 }
 
-unsigned char TaskerSetTask(void (*userTask)(void),
-                            unsigned char tempStatus,
-                            unsigned long taskInterval)
+unsigned char TaskerRemoveTask(void (*userTask)(void))
 {
-    unsigned char tempI = 0;
+    return TaskerRemoveTaskHandle(TaskerGetTaskHandle(userTask));
+}
 
-    if ((_initialized == 0) || (numberTasks == 0))
-    {
-        return false;
-    }
+unsigned char TaskerRemoveTaskHandle(tTaskHandle handle)
+{
+    return uKernelDeleteTask(TaskerGetTaskDescriptor(handle));
+}
 
-    do
-    {
-        if (Tasks[tempI].taskPointer == *userTask)
-        {
-            Tasks[tempI].taskIsActive = tempStatus;
-            if (tempStatus == SCHEDULED)
-            {
-                if (taskInterval == NULL)
-                {
-                    Tasks[tempI].plannedTask =
-                            _counterMs + Tasks[tempI].userTasksInterval;
-                }
-                else
-                {
-                    Tasks[tempI].plannedTask =
-                            _counterMs + taskInterval;
-                }
-            }
-            break;
-        }
-        else
-        {
-            tempI++;
-        }
-    }
-    while (tempI < numberTasks);
+tTaskStatus TaskerGetTaskStatus(void (*userTask)(void))
+{
+    //return 255 if the task was not found (almost impossible)
+    return TaskerGetTaskStatusHandle(TaskerGetTaskHandle(userTask));
+}
 
-    return true;
+tTaskStatus TaskerGetTaskStatusHandle(tTaskHandle handle)
+{
+    return (tTaskStatus) uKernelGetTaskStatus(TaskerGetTaskDescriptor(handle));
 }
 
-unsigned char TaskerRemoveTask(void (*userTask)(void))
+unsigned char TaskerSetTaskPolicy(void (*userTask)(void), tTaskPolicy policy)
 {
-    unsigned char tempI = 0, tempJ;
+    return uKernelSetTaskPolicy(
+            TaskerGetTaskDescriptor(TaskerGetTaskHandle(userTask)),
+            (uKernelTaskPolicy) policy);
+}
 
-    if ((_initialized == 0) || (numberTasks == 0))
-    {
-        return false;
-    }
+unsigned int TaskerGetTaskOverruns(void (*userTask)(void))
+{
+    TaskerCore *task = TaskerGetTaskDescriptor(TaskerGetTaskHandle(userTask));
 
-    do
+    if (task == NULL)
     {
-        if (Tasks[tempI].taskPointer == *userTask)
-        {
-            if ((tempI + 1) == numberTasks)
-            {
-                numberTasks--;
-            }
-            else if (numberTasks > 1)
-            {
-                for (tempJ = tempI; tempJ < numberTasks; tempJ++)
-                {
-                    Tasks[tempJ].taskPointer = Tasks[tempJ + 1].taskPointer;
-                    Tasks[tempJ].taskIsActive = Tasks[tempJ + 1].taskIsActive;
-                    Tasks[tempJ].userTasksInterval =
-                            Tasks[tempJ + 1].userTasksInterval;
-                    Tasks[tempJ].plannedTask = Tasks[tempJ + 1].plannedTask;
-                }
-                numberTasks--;
-            }
-            else
-            {
-                numberTasks = 0;
-            }
-            break;
-        }
-        else
-        {
-            tempI++;
-        }
+        return 0;
     }
-    while (tempI < numberTasks);
 
-    return true;
+    return task->overruns;
 }
 
-tTaskStatus TaskerGetTaskStatus(void (*userTask)(void))
+void TaskerSetOverrunHook(void (*hook)(void (*userTask)(void)))
 {
-    //return 255 if the task was not found (almost impossible)
-    unsigned char tempJ = ERROR;
-    unsigned char tempI = 0;
+    overrunHook = hook;
+    uKernelSetOverrunHook((hook != NULL) ? TaskerOverrun : NULL);
+}
 
-    if ((_initialized == false) || (numberTasks == 0))
-    {
-        return false;
-    }
+//gives the routine of the late task to the user's hook
 
-    do
+static void TaskerOverrun(uKernelTaskDescriptor *pTaskDescriptor)
+{
+    overrunHook(pTaskDescriptor->taskPointer);
+}
+
+#ifdef USE_TASK_STATISTICS
+tTaskStatistics *TaskerGetTaskStatistics(void (*userTask)(void))
+{
+    TaskerCore *task = TaskerGetTaskDescriptor(TaskerGetTaskHandle(userTask));
+
+    if (task == NULL)
     {
-        if (Tasks[tempI].taskPointer == *userTask)
-        {
-            //return its current status
-            tempJ = Tasks[tempI].taskIsActive;
-            break;
-        }
-        tempI++;
+        return NULL;
     }
 
-    while (tempI < numberTasks);
+    return &task->statistics;
+}
+#endif
+
+#ifdef UKERNEL_USE_CPU_LOAD
+unsigned int TaskerGetCpuLoad(uKernelLoadWindow window)
+{
+    return uKernelGetCpuLoad(window);
+}
 
-    return tempJ; //return the task status
+#ifdef USE_TASK_STATISTICS
+unsigned int TaskerGetTaskLoad(void (*userTask)(void))
+{
+    return uKernelGetTaskLoad(TaskerGetTaskDescriptor(TaskerGetTaskHandle(userTask)));
 }
+#endif
+#endif
 
 void TaskerTimerInterruptHandler(void)
 {
@@ -220,42 +205,15 @@ void TaskerTimerInterruptHandler(void)
 
 void TaskerScheduler(void)
 {
-    unsigned char tempI = 0;
-
-    while (1)
-    {
-        if (Tasks[tempI].taskIsActive > 0)
-        { //the task is running
-            //check if it's time to execute the task
-            if ((long) (_counterMs - Tasks[tempI].plannedTask) >= 0)
-            { //this trick overrun the overflow of _counterMs
-
-                //if it's a one-time task, than it has to be removed after running
-                if (Tasks[tempI].taskIsActive == ONETIME)
-                {
-                    Tasks[tempI].taskPointer(); //call the task
-                    Tasks[tempI].taskIsActive = PAUSED;
-                }
-                else
-                {
-                    //let's schedule next start
-                    Tasks[tempI].plannedTask =
-                            _counterMs + Tasks[tempI].userTasksInterval;
-
-                    Tasks[tempI].taskPointer(); //call the task
-                }
-            }
-        }
-
-        tempI++;
-
-        if (tempI >= numberTasks)
-            tempI = 0;
-    }
+    uKernelScheduler();
 }
 
 void TaskerDelayMiliseconds(unsigned int delay)
 {
-    unsigned long newTime = _counterMs + delay;
-    while (_counterMs < newTime);
-}
\ No newline at end of file
+    uKernelDelayMiliseconds(delay);
+}
+
+unsigned char TaskerTaskDelay(unsigned long delay)
+{
+    return uKernelTaskDelay(delay);
+}
@@ -29,42 +29,63 @@
 #ifndef TASKER_H
 #define TASKER_H
 
-#include <xc.h>
 #include <stddef.h>
 #include <stdbool.h>
+#include "uKernel/uKernel.h"
+
+/*
+ * Tasker is a compatibility layer over uKernel, which does the scheduling.
+ * The tasks live in the static descriptor pool of uKernel, so
+ * UKERNEL_STATIC_TASKS has to be defined in uKernel.h. A task can be reached
+ * with the uKernel API through its descriptor, TaskerGetTaskDescriptor().
+ */
+#ifndef UKERNEL_STATIC_TASKS
+#error "Tasker: define UKERNEL_STATIC_TASKS in uKernel/uKernel.h"
+#endif
 
 /**Tasker version*/
-#define TASKER_VERSION 112
-/**Define here the maximum number of tasks to handle.*/
-#define MAXIMUM_TASKS                   1
-/**Set your max interval here (max 2^32-1) - default 3600000 (1 hour)*/
-#define MAX_TASK_INTERVAL 3600000UL
+#define TASKER_VERSION 120
+/**Maximum number of tasks, the size of the uKernel pool. Set
+ MAX_TASKS_NUMBER in uKernel.h.*/
+#define MAXIMUM_TASKS                   MAX_TASKS_NUMBER
 
 typedef enum
 {
     /**For a task that doesn't have to start immediately.*/
-    PAUSED = 0x00, //0b00000000
+    PAUSED = UKERNEL_PAUSED, //0b00000000
     /**For a normal task that has to start after its scheduling*/
-    SCHEDULED = 0x01, //0b00000001
+    SCHEDULED = UKERNEL_SCHEDULED, //0b00000001
     /**For a task that has to run only once.*/
-    ONETIME = 0x02, //0b00000010
+    ONETIME = UKERNEL_ONETIME, //0b00000010
     /**For a task that has to be executed once it has been added to the scheduler.*/
-    IMMEDIATESTART = 0x05, //0b00000101
+    IMMEDIATESTART = UKERNEL_IMMEDIATESTART, //0b00000101
     /**Error, task not found.*/
-    ERROR = 0xFF
+    ERROR = UKERNEL_ERROR
 } tTaskStatus;
 
-typedef struct
+/**What a periodic task does when it starts late.*/
+typedef enum
 {
-    /**Used to store the pointers to user's tasks*/
-    void (*taskPointer)(void);
-    /**Used to store the interval between each task's run*/
-    volatile unsigned long userTasksInterval;
-    /**Used to store the next time a task will have to be executed*/
-    volatile unsigned long plannedTask;
-    /**Used to store the status of the tasks*/
-    volatile unsigned char taskIsActive;
-} TaskerCore;
+    /**Next start is one interval after the real start, the schedule drifts
+     by the delay of every late start (the original behaviour).*/
+    DRIFT = UKERNEL_POLICY_DRIFT,
+    /**Fixed rate, next start is one interval after the planned one. The
+     periods that were missed completely are skipped.*/
+    SKIP = UKERNEL_POLICY_SKIP,
+    /**Fixed rate, next start is one interval after the planned one. The
+     periods that were missed run back to back until the task catches up.*/
+    CATCHUP = UKERNEL_POLICY_CATCHUP
+} tTaskPolicy;
+
+/**Handle of a task, given by TaskerAddTask(). It never changes while the
+ task is in the scheduler and all the operations on it are O(1).*/
+typedef unsigned char tTaskHandle;
+
+/**Value of an invalid handle, the same as false.*/
+#define TASKER_INVALID_HANDLE           0
+
+/**A task of Tasker is a task of uKernel.*/
+typedef uKernelTaskDescriptor TaskerCore;
 
 
 /**
@@ -84,11 +105,60 @@ void TaskerBegin(void);
  *                   scheduling; ONETIME, for a task that has to run only once;
  *                   IMMEDIATESTART, for a task that has to be executed once it
  *                   has been added to the scheduler.
+ * @return Handle of the task if all went well (never 0, so it can be tested
+ *         as true), TASKER_INVALID_HANDLE (false) otherwise.
+ */
+tTaskHandle TaskerAddTask(void (*userTask)(void),
+                          unsigned long taskInterval,
+                          tTaskStatus taskStatus);
+/**
+ * Gives the handle of a task already in the scheduler. This is a search,
+ * keep the handle returned by TaskerAddTask() when possible.
+ * @param userTask Routine of the task.
+ * @return Handle of the task, TASKER_INVALID_HANDLE if not found.
+ */
+tTaskHandle TaskerGetTaskHandle(void (*userTask)(void));
+/**
+ * Gives the uKernel descriptor of a task, to use the uKernel functions that
+ * Tasker doesn't have (priorities, signals...).
+ * @param handle Handle of the task.
+ * @return Descriptor of the task, NULL if the handle is not valid.
+ */
+TaskerCore *TaskerGetTaskDescriptor(tTaskHandle handle);
+/**
+ * Removes the task from the scheduler.
+ * @param handle Handle of the task.
+ * @return Return true if all went well, false otherwise.
+ */
+unsigned char TaskerRemoveTaskHandle(tTaskHandle handle);
+/**
+ * Pauses the task.
+ * @param handle Handle of the task.
+ * @return Return true if all went well, false otherwise.
+ */
+unsigned char TaskerPauseTaskHandle(tTaskHandle handle);
+/**
+ * Restarts a task that has been paused.
+ * @param handle Handle of the task.
+ * @return Return true if all went well, false otherwise.
+ */
+unsigned char TaskerResumeTaskHandle(tTaskHandle handle);
+/**
+ * Modifies the interval and the status of a task.
+ * @param handle Handle of the task.
+ * @param taskInterval Scheduled interval in milliseconds.
+ * @param taskStatus PAUSED, SCHEDULED, ONETIME or IMMEDIATESTART.
  * @return Return true if all went well, false otherwise.
  */
-unsigned char TaskerAddTask(void (*userTask)(void),
-                            unsigned long taskInterval,
-                            tTaskStatus taskStatus);
+unsigned char TaskerModifyTaskHandle(tTaskHandle handle,
+                                     unsigned long taskInterval,
+                                     tTaskStatus taskStatus);
+/**
+ * Status of a task.
+ * @param handle Handle of the task.
+ * @return The status of the task, ERROR if the handle is not valid.
+ */
+tTaskStatus TaskerGetTaskStatusHandle(tTaskHandle handle);
 /**
  * This funtion is used to remove the task from the scheduler.
  * @param userTask Routine to be removed.
@@ -135,6 +205,49 @@ unsigned char TaskerModifyTask(void (*userTask)(void),
  * @retval ERROR There was an error (task not found)
  */
 tTaskStatus TaskerGetTaskStatus(void (*userTask)(void));
+/**
+ * Chooses what a periodic task does when it starts late.
+ * @param userTask Routine to be modified.
+ * @param policy DRIFT, SKIP or CATCHUP.
+ * @return Return true if all went well, false otherwise.
+ */
+unsigned char TaskerSetTaskPolicy(void (*userTask)(void), tTaskPolicy policy);
+/**
+ * Number of times a task started a whole interval or more late.
+ * @param userTask Task to check.
+ * @return Number of overruns, 0 if the task was not found.
+ */
+unsigned int TaskerGetTaskOverruns(void (*userTask)(void));
+/**
+ * Sets the function called, before the task runs, every time a task starts
+ * a whole interval or more late.
+ * @param hook Function to be called with the late task, or NULL to remove it.
+ */
+void TaskerSetOverrunHook(void (*hook)(void (*userTask)(void)));
+#ifdef USE_TASK_STATISTICS
+/**
+ * Gives access to the execution time and start latency of a task.
+ * @param userTask Task to get the statistics.
+ * @return Pointer to the statistics of the task, NULL if not found.
+ */
+tTaskStatistics *TaskerGetTaskStatistics(void (*userTask)(void));
+#endif
+#ifdef UKERNEL_USE_CPU_LOAD
+/**
+ * Load of the CPU, with UKERNEL_USE_CPU_LOAD in uKernel.h.
+ * @param window UKERNEL_LOAD_1S, UKERNEL_LOAD_10S or UKERNEL_LOAD_60S.
+ * @return Load in tenths of a percent, 0 to 1000.
+ */
+unsigned int TaskerGetCpuLoad(uKernelLoadWindow window);
+#ifdef USE_TASK_STATISTICS
+/**
+ * Share of the CPU a task took in the last load window.
+ * @param userTask Task to check.
+ * @return Load in tenths of a percent, 0 if the task was not found.
+ */
+unsigned int TaskerGetTaskLoad(void (*userTask)(void));
+#endif
+#endif
 /**
  * This funtion has to be called from the timer interrut routine.
  */
@@ -145,7 +258,17 @@ void TaskerTimerInterruptHandler(void);
  */
 void TaskerScheduler(void);
 /**
- * Just a simple delay in miliseconds. Not related to the Tasker system.
+ * Just a simple delay in miliseconds. Not related to the Tasker system. It
+ * blocks all the tasks, use TaskerTaskDelay() inside a task.
  */
 void TaskerDelayMiliseconds(unsigned int delay);
+/**
+ * Delay that doesn't block the other tasks. Called from a task, the task
+ * runs again once after the delay and then goes on with its schedule. The
+ * task has to return right after, keeping in a static variable where it has
+ * to continue (or using uKernelCoroutine.h).
+ * @param delay Milliseconds until the task runs again.
+ * @return Return true if all went well, false if not called from a task.
+ */
+unsigned char TaskerTaskDelay(unsigned long delay);
 #endif
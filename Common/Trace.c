@@ -0,0 +1,146 @@
+/**
+ *  @file       Trace.c
+ *  @brief      Binary event trace in a RAM ring, streamed out in the idle time.
+ *  @author     Luis Maduro
+ *  @version    1.00
+ *  @date       14/10/2026
+ *
+ *  Copyright (C) 2026  Luis Maduro
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "Trace.h"
+
+#ifdef USE_TRACE
+
+#if (TRACE_SIZE & (TRACE_SIZE - 1)) != 0
+#error "Trace: TRACE_SIZE must be a power of 2"
+#endif
+
+typedef struct
+{
+    uint32_t Time;
+    /**Event in the low byte, argument in the others.*/
+    uint32_t Data;
+} tTraceRecord;
+
+static tTraceRecord ring[TRACE_SIZE];
+/**Free running, the records are from tail to head.*/
+static volatile uint16_t head;
+static volatile uint16_t tail;
+/**Records dropped since the last TRACE_EVENT_LOST.*/
+static uint16_t lost;
+
+/**
+ * Empties the ring and writes TRACE_EVENT_START.
+ */
+void TraceInit(void)
+{
+    TRACE_TIMESTAMP_INIT();
+
+    head = 0;
+    tail = 0;
+    lost = 0;
+
+    TraceRecord(TRACE_EVENT_START, TRACE_START_MAGIC);
+}
+
+/**
+ * Puts a record in the ring, called by the TRACE() macros.
+ * @param event Event.
+ * @param arg Argument, the low 24 bits are kept.
+ */
+void TraceRecord(uint8_t event, uint32_t arg)
+{
+    uint32_t time;
+    uint16_t index;
+    TRACE_ENTER_CRITICAL();
+
+    //in the order of the ring
+    time = TRACE_TIMESTAMP();
+    index = head;
+
+    //room for the record and for the one telling the drops
+    if ((uint16_t) (index - tail) >= (uint16_t) (TRACE_SIZE - (lost != 0)))
+    {
+        if (lost != 0xFFFF)
+            lost++;
+    }
+    else
+    {
+        if (lost != 0)
+        {
+            ring[index & (TRACE_SIZE - 1)].Time = time;
+            ring[index & (TRACE_SIZE - 1)].Data = TRACE_EVENT_LOST | ((uint32_t) lost << 8);
+            index++;
+            lost = 0;
+        }
+
+        ring[index & (TRACE_SIZE - 1)].Time = time;
+        ring[index & (TRACE_SIZE - 1)].Data = event | (arg << 8);
+        head = index + 1;
+    }
+
+    TRACE_EXIT_CRITICAL();
+}
+
+/**
+ * Tells how many records wait to be read.
+ * @return Number of records.
+ */
+unsigned int TracePending(void)
+{
+    return (uint16_t) (head - tail);
+}
+
+/**
+ * Takes records out of the ring, as bytes to be sent.
+ * @param buffer Where the records are put, little endian.
+ * @param length Size of the buffer, the records that fit are taken.
+ * @return Bytes put, a multiple of TRACE_RECORD_SIZE.
+ */
+unsigned int TraceRead(uint8_t *buffer, unsigned int length)
+{
+    tTraceRecord *record;
+    unsigned int count = 0;
+    uint16_t index = tail;
+    uint16_t last = head;
+    uint8_t i;
+
+    while ((index != last) && (length - count >= TRACE_RECORD_SIZE))
+    {
+        record = &ring[index & (TRACE_SIZE - 1)];
+
+        for (i = 0; i < 4; i++)
+        {
+            buffer[count + i] = (uint8_t) (record->Time >> (8 * i));
+            buffer[count + 4 + i] = (uint8_t) (record->Data >> (8 * i));
+        }
+
+        count += TRACE_RECORD_SIZE;
+        index++;
+    }
+
+    //the writers read the tail, 16 bits are two accesses on the PIC18
+    {
+        TRACE_ENTER_CRITICAL();
+        tail = index;
+        TRACE_EXIT_CRITICAL();
+    }
+
+    return count;
+}
+
+#endif
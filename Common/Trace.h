@@ -0,0 +1,140 @@
+/**
+ *  @file       Trace.h
+ *  @brief      Binary event trace in a RAM ring, streamed out in the idle time.
+ *  @author     Luis Maduro
+ *  @version    1.00
+ *  @date       14/10/2026
+ *
+ *  A printf over the USART takes milliseconds and moves the timing looked
+ *  at. A trace record is 8 bytes, a timestamp and a word with the event in
+ *  the low byte and a 24 bit argument, put in the ring with the interrupts
+ *  disabled for a few instructions, from the tasks and the interrupts. The
+ *  application takes the records with TraceRead() when it has nothing else
+ *  to do, i.e. from UKERNEL_IDLE(), and sends them over the VCP or a USART,
+ *  TraceDecode.py turns them into a timeline on the host.
+ *
+ *  The records are little endian: the timestamp, then the event and the
+ *  argument. A full ring drops the new records, the next one written is
+ *  TRACE_EVENT_LOST with the number dropped. TraceInit() writes
+ *  TRACE_EVENT_START with TRACE_START_MAGIC, for the decoder to find the
+ *  first record in the stream.
+ *
+ *  uKernel (and Tasker and pKernel over it) traces the start and the end of
+ *  every task with the address of its function, the I2C and SPI drivers of
+ *  the STM32F1 trace their interrupts, with the IRQ number, and the start
+ *  and the end of their transactions.
+ *
+ *  Copyright (C) 2026  Luis Maduro
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef TRACE_H
+#define TRACE_H
+
+#include <stdint.h>
+
+/**Uncomment to record the trace.*/
+//#define USE_TRACE
+
+/**Records in the ring, a power of 2.*/
+#ifndef TRACE_SIZE
+#define TRACE_SIZE                  256
+#endif
+
+#define TRACE_RECORD_SIZE           8
+#define TRACE_START_MAGIC           0x7ACE
+
+/**Events, the application ones from TRACE_EVENT_USER.*/
+#define TRACE_EVENT_START           0
+#define TRACE_EVENT_LOST            1
+#define TRACE_EVENT_TASK_BEGIN      2
+#define TRACE_EVENT_TASK_END        3
+#define TRACE_EVENT_ISR_ENTER       4
+#define TRACE_EVENT_ISR_EXIT        5
+#define TRACE_EVENT_I2C_BEGIN       6
+#define TRACE_EVENT_I2C_END         7
+#define TRACE_EVENT_SPI_BEGIN       8
+#define TRACE_EVENT_SPI_END         9
+#define TRACE_EVENT_USER            32
+
+#ifdef USE_TRACE
+
+/**
+ * Free-running timer of the timestamps, counting up and wrapping at 2^32.
+ * On the Cortex-M3 the DWT cycle counter is used by default, other targets
+ * have to define it, i.e. #define TRACE_TIMESTAMP() ((uint32_t) TMR1)
+ */
+#ifndef TRACE_TIMESTAMP
+#if defined(__ARM_ARCH_7M__) || defined(__TARGET_ARCH_7_M) || defined(__CORTEX_M)
+#define TRACE_TIMESTAMP()           (*(volatile uint32_t *) 0xE0001004UL)
+#define TRACE_TIMESTAMP_INIT()                                  \
+    do                                                          \
+    {                                                           \
+        *(volatile uint32_t *) 0xE000EDFCUL |= (1UL << 24);     \
+        *(volatile uint32_t *) 0xE0001000UL |= (1UL << 0);      \
+    } while (0)
+#else
+#error "Trace: define TRACE_TIMESTAMP() for this target"
+#endif
+#endif
+
+#ifndef TRACE_TIMESTAMP_INIT
+#define TRACE_TIMESTAMP_INIT()
+#endif
+
+/**
+ * The records come from the tasks and the interrupts, the update of the
+ * ring is done with the interrupts disabled. The default is for GCC on the
+ * Cortex-M3, other targets define them, i.e. on the PIC18:
+ * #define TRACE_ENTER_CRITICAL()   uint8_t _traceGIE = INTCONbits.GIE; INTCONbits.GIE = 0
+ * #define TRACE_EXIT_CRITICAL()    INTCONbits.GIE = _traceGIE
+ */
+#ifndef TRACE_ENTER_CRITICAL
+#if defined(__GNUC__) && defined(__ARM_ARCH_7M__)
+#define TRACE_ENTER_CRITICAL()      uint32_t _tracePrimask;                                         \
+                                    __asm volatile ("mrs %0, primask\n\tcpsid i"                    \
+                                                    : "=r" (_tracePrimask) : : "memory")
+#define TRACE_EXIT_CRITICAL()       __asm volatile ("msr primask, %0" : : "r" (_tracePrimask) : "memory")
+#else
+#error "Trace: define TRACE_ENTER_CRITICAL() and TRACE_EXIT_CRITICAL() for this target"
+#endif
+#endif
+
+#define TRACE(event, arg)           TraceRecord((event), (uint32_t) (arg))
+#define TRACE_TASK_BEGIN(function)  TRACE(TRACE_EVENT_TASK_BEGIN, (uintptr_t) (function))
+#define TRACE_TASK_END(function)    TRACE(TRACE_EVENT_TASK_END, (uintptr_t) (function))
+#define TRACE_ISR_ENTER(irq)        TRACE(TRACE_EVENT_ISR_ENTER, (irq))
+#define TRACE_ISR_EXIT(irq)         TRACE(TRACE_EVENT_ISR_EXIT, (irq))
+
+void TraceInit(void);
+void TraceRecord(uint8_t event, uint32_t arg);
+unsigned int TracePending(void);
+unsigned int TraceRead(uint8_t *buffer, unsigned int length);
+
+#else
+
+#define TRACE(event, arg)
+#define TRACE_TASK_BEGIN(function)
+#define TRACE_TASK_END(function)
+#define TRACE_ISR_ENTER(irq)
+#define TRACE_ISR_EXIT(irq)
+
+#define TraceInit()
+#define TracePending()              0
+#define TraceRead(buffer, length)   0
+
+#endif
+
+#endif /* TRACE_H */
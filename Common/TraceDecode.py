@@ -0,0 +1,150 @@
+#!/usr/bin/env python3
+#
+#  @file       TraceDecode.py
+#  @brief      Timeline of the records of Trace.c.
+#  @author     Luis Maduro
+#  @version    1.00
+#  @date       14/10/2026
+#
+#  Reads the bytes sent by TraceRead(), from a file or a serial port dump,
+#  and prints one line per record: the time in microseconds, the time since
+#  the last record, the nesting and the event. A task, an interrupt or a
+#  transaction prints its length at its end.
+#
+#      python3 TraceDecode.py trace.bin --hz 72000000 --symbols symbols.txt
+#
+#  The symbols are the output of "arm-none-eabi-nm firmware.elf", to name
+#  the tasks, the 24 bits of the address recorded are matched to them.
+#
+#  Copyright (C) 2026  Luis Maduro
+#
+#  This program is free software: you can redistribute it and/or modify
+#  it under the terms of the GNU General Public License as published by
+#  the Free Software Foundation, either version 3 of the License, or
+#  (at your option) any later version.
+#
+#  This program is distributed in the hope that it will be useful,
+#  but WITHOUT ANY WARRANTY; without even the implied warranty of
+#  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+#  GNU General Public License for more details.
+#
+#  You should have received a copy of the GNU General Public License
+#  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+import argparse
+import struct
+import sys
+
+RECORD_SIZE = 8
+START_MAGIC = 0x7ACE
+
+EVENT_START = 0
+EVENT_USER = 32
+
+# event: (name, begin or end of a pair)
+EVENTS = {
+    0: ("start", None),
+    1: ("lost", None),
+    2: ("task", "begin"),
+    3: ("task", "end"),
+    4: ("isr", "begin"),
+    5: ("isr", "end"),
+    6: ("i2c", "begin"),
+    7: ("i2c", "end"),
+    8: ("spi", "begin"),
+    9: ("spi", "end"),
+}
+
+IRQ_NAMES = {11: "DMA1_Channel1", 12: "DMA1_Channel2", 13: "DMA1_Channel3",
+             14: "DMA1_Channel4", 15: "DMA1_Channel5", 16: "DMA1_Channel6",
+             17: "DMA1_Channel7", 31: "I2C1_EV", 32: "I2C1_ER",
+             35: "SPI1", 37: "USART1"}
+
+
+def read_symbols(path):
+    symbols = {}
+    with open(path) as names:
+        for line in names:
+            fields = line.split()
+            if len(fields) == 3 and fields[1] in "tT":
+                # thumb functions are called at the odd address
+                symbols[(int(fields[0], 16) | 1) & 0xFFFFFF] = fields[2]
+                symbols[int(fields[0], 16) & 0xFFFFFF] = fields[2]
+    return symbols
+
+
+def find_start(data):
+    """Offset of the first TRACE_EVENT_START, the stream can begin anywhere."""
+    start = struct.pack("<I", EVENT_START | (START_MAGIC << 8))
+    offset = data.find(start, 4)
+    return offset - 4 if offset >= 4 else 0
+
+
+def describe(event, arg, symbols):
+    if event >= EVENT_USER:
+        return "user %d" % (event - EVENT_USER), "0x%06X" % arg
+    name = EVENTS.get(event, ("event %d" % event, None))[0]
+    if name == "task":
+        return name, symbols.get(arg, "0x%06X" % arg)
+    if name == "isr":
+        return name, IRQ_NAMES.get(arg, "IRQ %d" % arg)
+    if name == "i2c":
+        return name, "0x%02X %d" % (arg & 0xFF, arg >> 8)
+    return name, "%d" % arg
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Decode a Trace.c stream")
+    parser.add_argument("file", help="bytes read with TraceRead(), - for stdin")
+    parser.add_argument("--hz", type=float, default=72e6,
+                        help="rate of TRACE_TIMESTAMP(), 72 MHz by default")
+    parser.add_argument("--symbols", help="output of nm, to name the tasks")
+    options = parser.parse_args()
+
+    data = sys.stdin.buffer.read() if options.file == "-" else open(options.file, "rb").read()
+    symbols = read_symbols(options.symbols) if options.symbols else {}
+
+    offset = find_start(data)
+    begins = {}
+    depth = 0
+    last = None
+    wraps = 0
+
+    for position in range(offset, len(data) - RECORD_SIZE + 1, RECORD_SIZE):
+        time, word = struct.unpack_from("<II", data, position)
+        event = word & 0xFF
+        arg = word >> 8
+
+        # the timestamps wrap at 2^32, the records are never that far apart
+        if last is not None and time < (last & 0xFFFFFFFF):
+            wraps += 1
+        now = (wraps << 32) | time
+        delta = 0 if last is None else now - last
+        last = now
+
+        if event == EVENT_START:
+            begins.clear()
+            depth = 0
+        name, detail = describe(event, arg, symbols)
+        pair = EVENTS.get(event, (None, None))[1]
+        length = ""
+
+        if pair == "end":
+            depth = max(depth - 1, 0)
+            key = (name, arg if name in ("task", "isr") else None)
+            if key in begins:
+                length = " %.2f us" % ((now - begins.pop(key)) * 1e6 / options.hz)
+
+        print("%12.2f %+10.2f %s%s %s%s%s" % (now * 1e6 / options.hz,
+                                              delta * 1e6 / options.hz,
+                                              "  " * depth, name,
+                                              pair + " " if pair else "",
+                                              detail, length))
+
+        if pair == "begin":
+            begins[(name, arg if name in ("task", "isr") else None)] = now
+            depth += 1
+
+
+if __name__ == "__main__":
+    main()
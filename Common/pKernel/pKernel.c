@@ -27,16 +27,13 @@
  *  customise for theirs owns applications. There are no
  *  priority between task like a round-robin task scheduling.
  */
-#include <xc.h>
 #include <stdio.h>
-#include <limits.h>
 #include "pKernel.h"
 
-/**Pointer of the scheduler*/
-pKernelTaskDescriptor *pTaskSchedule = NULL;
-static pKernelTaskDescriptor *pTaskFirst = NULL;
-/**Timer for the scheduler*/
-unsigned long _counterMs = 0;
+/**uKernel needs uKernelInit(), pKernel never had it.*/
+static bool kernelStarted = false;
+
+static void pKernelStart(void);
 
 /**
  * Delete all task of the scheduler in the offing to reconfigure it. This
@@ -45,67 +42,43 @@ unsigned long _counterMs = 0;
  */
 void pKernelDeleteAllTask(void)
 {
-    pKernelAddTask(NULL, 0, NULL);
+    pKernelAddTask(NULL, NULL, 0);
 }
 
 /**
- * Add a task into the circular linked list for the scheduler.
- * @param pTaskDescriptor   Descriptor of the task
- * @param usPeriod          Periodicity of the task
+ * Add a task into the scheduler. It runs for the first time one period after
+ * being added. A period of 0 is taken as 50 ms, as in uKernel.
+ * @param pTaskDescriptor   Descriptor of the task, NULL to delete all tasks
+ * @param usPeriod          Periodicity of the task in microseconds with
+ *                          UKERNEL_USE_US_TIMEBASE, in milliseconds otherwise
  * @param pTask             Function pointer on the task body
  */
 void pKernelAddTask(pKernelTaskDescriptor *pTaskDescriptor, TaskBody pTask, unsigned long usPeriod)
 {
-    pKernelTaskDescriptor *pTaskWork = NULL;
-
+    pKernelStart();
+#ifdef UKERNEL_USE_US_TIMEBASE
     if (pTaskDescriptor != NULL)
     {
-        if (pTaskFirst != NULL)
-        {
-            // Initialize the work pointer with the scheduler pointer (never mind is current state)
-            pTaskWork = pTaskSchedule;
-            // Research the last task from the circular linked list : so research the adresse of the
-            // first task in testing the pTaskNext fields of each structure
-            while (pTaskWork->pTaskNext != pTaskFirst)
-            {
-                // Set the work pointer on the next task
-                pTaskWork = pTaskWork->pTaskNext;
-            }
-            pTaskWork->pTaskNext = pTaskDescriptor; // Insert the new task at the end of the circular linked list
-
-            pTaskDescriptor->pTaskNext = pTaskFirst; // The next task is feedback at the first task
-        }
-        else
-        {
-            // There is no task in the scheduler, this task become the First task in the circular linked list
-            pTaskFirst = pTaskDescriptor; // The pTaskFirst pointer is initialize with the first task of the scheduler
-            pTaskSchedule = pTaskFirst; // Initialize the scheduler pointer at the first task
-            pTaskDescriptor->pTaskNext = pTaskDescriptor; // The next task is itself because there is just one task in the circular linked list
-        }
-        // Common initialization for all tasks
-        pTaskDescriptor->usNext = _counterMs + usPeriod; // Initialize the task timer with the current value of usTickCount
-        pTaskDescriptor->usPeriod = usPeriod; // Set the periodicity of the task
-        pTaskDescriptor->pTask = pTask; // Set the task pointer on the task body
-    }
-    else
-    {
-        // Delete all task of the scheduler
-        // This case is necessary at the time of the call of the function DeleteAllTask()
-        pTaskFirst = NULL;
-        pTaskSchedule = NULL;
+        uKernelAddTaskUs(pTaskDescriptor, pTask, usPeriod, UKERNEL_SCHEDULED);
+        return;
     }
+#endif
+    uKernelAddTask(pTaskDescriptor, pTask, usPeriod, UKERNEL_SCHEDULED);
 }
 
 /**
- * Set the periodicity of the task
+ * Set the periodicity of the task, and resume it if it was suspended
  * @param pTaskDescriptor   Descriptor of the task
- * @param usPeriod          Periodicity of the task
+ * @param usPeriod          Periodicity of the task, in the unit of
+ *                          pKernelAddTask()
  */
 void pKernelResumeTask(pKernelTaskDescriptor *pTaskDescriptor, unsigned long usPeriod)
 {
-    // Initialize the task timer with the current value of usTickCount
-    pTaskDescriptor->usNext = _counterMs + usPeriod;
-    pTaskDescriptor->usPeriod = usPeriod;
+#ifdef UKERNEL_USE_US_TIMEBASE
+    uKernelModifyTaskUs(pTaskDescriptor, usPeriod, UKERNEL_SCHEDULED);
+#else
+    uKernelModifyTask(pTaskDescriptor, usPeriod, UKERNEL_SCHEDULED);
+#endif
 }
 
 /**
@@ -114,7 +87,7 @@ void pKernelResumeTask(pKernelTaskDescriptor *pTaskDescriptor, unsigned long usP
  */
 void pKernelSuspendTask(pKernelTaskDescriptor *pTaskDescriptor)
 {
-    pTaskDescriptor->usPeriod = ULONG_MAX;
+    uKernelPauseTask(pTaskDescriptor);
 }
 
 /**
@@ -122,39 +95,48 @@ void pKernelSuspendTask(pKernelTaskDescriptor *pTaskDescriptor)
  */
 void pKernelScheduler(void)
 {
-    while (1)
-    {
-        if (pTaskSchedule != NULL)
-        {
-            if (pTaskSchedule->usPeriod != ULONG_MAX)
-            {
-                if ((long) (_counterMs - pTaskSchedule->usNext) >= 0)
-                {
-                    // Initialize the task timer with the current value of usTickCount
-                    pTaskSchedule->usNext = _counterMs + pTaskSchedule->usPeriod;
-                    pTaskSchedule->pTask(); // Call the task body
-                }
-            }
-            // If a task has called the function DeleteAllTask() and if no task are added, the pointer is null
-            if (pTaskSchedule != NULL)
-            {
-                // Set the scheduler pointer on the next task
-                pTaskSchedule = pTaskSchedule->pTaskNext;
-            }
-        }
-#ifdef USE_SLEEP
-        SLEEP();
-#endif
-    }
+    pKernelStart();
+    uKernelScheduler();
+}
+
+/**
+ * Time left until the next task is due.
+ * @return Milliseconds until the first task has to run, 0 if one is already
+ *         due, MAX_TASK_INTERVAL if all are suspended or there is none.
+ */
+unsigned long pKernelTimeToNextTask(void)
+{
+    return uKernelTimeToNextTask();
 }
 
 /**
- * Just a simple delay in miliseconds. Not related to the Tasker system.
+ * Just a simple delay in miliseconds. Not related to the Tasker system. It
+ * blocks all the tasks, use pKernelTaskDelay() inside a task.
  */
 void pKernelDelayMiliseconds(unsigned int delay)
 {
-    unsigned long newTime = _counterMs + delay;
-    while (_counterMs < newTime);
+    uKernelDelayMiliseconds(delay);
 }
 
+/**
+ * Delay that doesn't block the other tasks. Called from a task, the task
+ * runs again once after the delay, in milliseconds, and then goes on with
+ * its period. The task has to return right after.
+ * @param delay Milliseconds until the task runs again
+ */
+void pKernelTaskDelay(unsigned long delay)
+{
+    uKernelTaskDelay(delay);
+}
 
+/**
+ * Initializes uKernel the first time pKernel is used.
+ */
+static void pKernelStart(void)
+{
+    if (!kernelStarted)
+    {
+        kernelStarted = true;
+        uKernelInit();
+    }
+}
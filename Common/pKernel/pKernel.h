@@ -31,25 +31,22 @@
 #ifndef _KERNEL_H
 #define _KERNEL_H
 
-//#define USE_SLEEP
-
-/**Function pointer on the task body.*/
-typedef void (*TaskBody)(void);
+/*
+ * pKernel is a compatibility layer over uKernel, which does the scheduling.
+ * The descriptors are still owned by the application. USE_SLEEP and
+ * USE_TICKLESS are now set in uKernel.h: define UKERNEL_IDLE() as SLEEP(), or
+ * define UKERNEL_USE_TICKLESS and supply uKernelPortSleep() and
+ * uKernelPortResumeTick(). The timer interrupt increments _counterMs.
+ * The periods are in milliseconds, or in microseconds with
+ * UKERNEL_USE_US_TIMEBASE. The CPU load of UKERNEL_USE_CPU_LOAD is read
+ * with uKernelGetCpuLoad() and uKernelGetTaskLoad().
+ */
 
-typedef struct _TaskDescriptor
-{
-    /**Timer of the task*/
-    unsigned long usNext;
-    /**Periodicity of the task*/
-    unsigned long usPeriod;
-    /**Function pointer on the task body*/
-    TaskBody pTask;
-    /**Pointer on the next structure task*/
-    struct _TaskDescriptor *pTaskNext;
-    /**Task Descriptor Structor*/
-} pKernelTaskDescriptor;
+#include "uKernel/uKernel.h"
 
-extern unsigned long _counterMs;
+/**A task of pKernel is a task of uKernel, it can also be used with the
+ uKernel functions once added.*/
+typedef uKernelTaskDescriptor pKernelTaskDescriptor;
 
 void pKernelAddTask(pKernelTaskDescriptor *pTaskDescriptor, TaskBody pTask, unsigned long usPeriod);
 void pKernelSuspendTask(pKernelTaskDescriptor *pTaskDescriptor);
@@ -57,6 +54,7 @@ void pKernelResumeTask(pKernelTaskDescriptor *pTaskDescriptor, unsigned long usP
 void pKernelScheduler(void);
 void pKernelDeleteAllTask(void);
 void pKernelDelayMiliseconds(unsigned int delay);
+void pKernelTaskDelay(unsigned long delay);
+unsigned long pKernelTimeToNextTask(void);
 
 #endif
-
@@ -0,0 +1,192 @@
+/**
+ *  @file       uBlockPool.c
+ *  @author     Luis Maduro
+ *  @version    1.00
+ *  @date       14/10/2026
+ *  @brief      Fixed size block pools in size classes, shared by the drivers.
+ *
+ *  Copyright (C) 2026  Luis Maduro
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <stddef.h>
+#include "uBlockPool.h"
+
+/**Words of a block, the blocks are word aligned for the DMA.*/
+#define UBLOCKPOOL_WORDS(size)      (((size) + 3) / 4)
+
+/**
+ * A size class.
+ */
+typedef struct
+{
+    uint32_t *Blocks;
+    /**Indexes of the free blocks, a stack.*/
+    uint8_t *Free;
+    uint16_t Size;
+    uint8_t Count;
+} tBlockPoolClass;
+
+tBlockPoolStatistics uBlockPoolStatistics[UBLOCKPOOL_CLASSES];
+
+#if UBLOCKPOOL_CLASSES > 0
+static uint32_t uBlockPoolBlocks0[UBLOCKPOOL_CLASS0_COUNT * UBLOCKPOOL_WORDS(UBLOCKPOOL_CLASS0_SIZE)];
+static uint8_t uBlockPoolFree0[UBLOCKPOOL_CLASS0_COUNT];
+#endif
+#if UBLOCKPOOL_CLASSES > 1
+static uint32_t uBlockPoolBlocks1[UBLOCKPOOL_CLASS1_COUNT * UBLOCKPOOL_WORDS(UBLOCKPOOL_CLASS1_SIZE)];
+static uint8_t uBlockPoolFree1[UBLOCKPOOL_CLASS1_COUNT];
+#endif
+#if UBLOCKPOOL_CLASSES > 2
+static uint32_t uBlockPoolBlocks2[UBLOCKPOOL_CLASS2_COUNT * UBLOCKPOOL_WORDS(UBLOCKPOOL_CLASS2_SIZE)];
+static uint8_t uBlockPoolFree2[UBLOCKPOOL_CLASS2_COUNT];
+#endif
+#if UBLOCKPOOL_CLASSES > 3
+static uint32_t uBlockPoolBlocks3[UBLOCKPOOL_CLASS3_COUNT * UBLOCKPOOL_WORDS(UBLOCKPOOL_CLASS3_SIZE)];
+static uint8_t uBlockPoolFree3[UBLOCKPOOL_CLASS3_COUNT];
+#endif
+
+static const tBlockPoolClass uBlockPoolClasses[UBLOCKPOOL_CLASSES] = {
+#if UBLOCKPOOL_CLASSES > 0
+    {uBlockPoolBlocks0, uBlockPoolFree0, UBLOCKPOOL_WORDS(UBLOCKPOOL_CLASS0_SIZE) * 4, UBLOCKPOOL_CLASS0_COUNT},
+#endif
+#if UBLOCKPOOL_CLASSES > 1
+    {uBlockPoolBlocks1, uBlockPoolFree1, UBLOCKPOOL_WORDS(UBLOCKPOOL_CLASS1_SIZE) * 4, UBLOCKPOOL_CLASS1_COUNT},
+#endif
+#if UBLOCKPOOL_CLASSES > 2
+    {uBlockPoolBlocks2, uBlockPoolFree2, UBLOCKPOOL_WORDS(UBLOCKPOOL_CLASS2_SIZE) * 4, UBLOCKPOOL_CLASS2_COUNT},
+#endif
+#if UBLOCKPOOL_CLASSES > 3
+    {uBlockPoolBlocks3, uBlockPoolFree3, UBLOCKPOOL_WORDS(UBLOCKPOOL_CLASS3_SIZE) * 4, UBLOCKPOOL_CLASS3_COUNT},
+#endif
+};
+
+/**
+ * Frees all the blocks and clears the counters.
+ */
+void uBlockPoolInit(void)
+{
+    uint8_t class;
+    uint8_t i;
+
+    for (class = 0; class < UBLOCKPOOL_CLASSES; class++)
+    {
+        for (i = 0; i < uBlockPoolClasses[class].Count; i++)
+        {
+            uBlockPoolClasses[class].Free[i] = i;
+        }
+
+        uBlockPoolStatistics[class].InUse = 0;
+        uBlockPoolStatistics[class].HighWater = 0;
+        uBlockPoolStatistics[class].Failures = 0;
+    }
+}
+
+/**
+ * Takes a block of the smallest class that has one free.
+ * @param size Bytes needed.
+ * @return The block, word aligned, NULL if there is none.
+ */
+void *uBlockPoolAlloc(uint16_t size)
+{
+    const tBlockPoolClass *pool;
+    tBlockPoolStatistics *statistics;
+    uint8_t first;
+    uint8_t class;
+    uint8_t index;
+
+    for (first = 0; first < UBLOCKPOOL_CLASSES; first++)
+    {
+        if (uBlockPoolClasses[first].Size >= size)
+        {
+            break;
+        }
+    }
+
+    if (first == UBLOCKPOOL_CLASSES)
+    {
+        return NULL;
+    }
+
+    UBLOCKPOOL_ENTER_CRITICAL();
+
+    for (class = first; class < UBLOCKPOOL_CLASSES; class++)
+    {
+        pool = &uBlockPoolClasses[class];
+        statistics = &uBlockPoolStatistics[class];
+
+        if (statistics->InUse < pool->Count)
+        {
+            //the stack holds the free blocks above InUse
+            index = pool->Free[statistics->InUse];
+            statistics->InUse++;
+            if (statistics->InUse > statistics->HighWater)
+            {
+                statistics->HighWater = statistics->InUse;
+            }
+
+            UBLOCKPOOL_EXIT_CRITICAL();
+
+            return pool->Blocks + (uint32_t) index * (pool->Size / 4);
+        }
+    }
+
+    uBlockPoolStatistics[first].Failures++;
+
+    UBLOCKPOOL_EXIT_CRITICAL();
+
+    return NULL;
+}
+
+/**
+ * Gives a block back to its class.
+ * @param block Block of uBlockPoolAlloc(), NULL is ignored.
+ */
+void uBlockPoolFree(void *block)
+{
+    const tBlockPoolClass *pool;
+    tBlockPoolStatistics *statistics;
+    uint32_t *word = (uint32_t *) block;
+    uint8_t class;
+
+    if (block == NULL)
+    {
+        return;
+    }
+
+    for (class = 0; class < UBLOCKPOOL_CLASSES; class++)
+    {
+        pool = &uBlockPoolClasses[class];
+
+        if ((word >= pool->Blocks) &&
+                (word < pool->Blocks + (uint32_t) pool->Count * (pool->Size / 4)))
+        {
+            statistics = &uBlockPoolStatistics[class];
+
+            UBLOCKPOOL_ENTER_CRITICAL();
+
+            if (statistics->InUse != 0)
+            {
+                statistics->InUse--;
+                pool->Free[statistics->InUse] =
+                        (uint8_t) ((uint32_t) (word - pool->Blocks) / (pool->Size / 4));
+            }
+
+            UBLOCKPOOL_EXIT_CRITICAL();
+
+            return;
+        }
+    }
+}
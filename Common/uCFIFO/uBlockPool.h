@@ -0,0 +1,105 @@
+/**
+ *  @file       uBlockPool.h
+ *  @author     Luis Maduro
+ *  @version    1.00
+ *  @date       14/10/2026
+ *  @brief      Fixed size block pools in size classes, shared by the drivers.
+ *
+ *  The buffers that the drivers need only while they work (packets, cache
+ *  blocks, task descriptors) are taken from shared pools instead of each
+ *  driver keeping its own static buffer, the RAM used is then the peak of
+ *  the features running together and not their sum.
+ *
+ *  There are up to 4 size classes, each a static array of blocks of one
+ *  size. uBlockPoolAlloc() takes a block of the smallest class that fits
+ *  and has one free, of a larger class otherwise. Allocation and release
+ *  are O(1), a stack of the free blocks per class, and can be done from the
+ *  interrupts with UBLOCKPOOL_ENTER_CRITICAL() defined.
+ *
+ *  The classes are used from class 0 in increasing sizes, the first of
+ *  them with a count of 0 ends them.
+ *
+ *  Copyright (C) 2026  Luis Maduro
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef UBLOCKPOOL_H
+#define UBLOCKPOOL_H
+
+#include <stdint.h>
+
+/**Bytes of a block and number of blocks, 255 max, of every class.*/
+#ifndef UBLOCKPOOL_CLASS0_SIZE
+#define UBLOCKPOOL_CLASS0_SIZE      32
+#define UBLOCKPOOL_CLASS0_COUNT     8
+#endif
+
+#ifndef UBLOCKPOOL_CLASS1_SIZE
+#define UBLOCKPOOL_CLASS1_SIZE      128
+#define UBLOCKPOOL_CLASS1_COUNT     4
+#endif
+
+#ifndef UBLOCKPOOL_CLASS2_SIZE
+#define UBLOCKPOOL_CLASS2_SIZE      512
+#define UBLOCKPOOL_CLASS2_COUNT     2
+#endif
+
+#ifndef UBLOCKPOOL_CLASS3_SIZE
+#define UBLOCKPOOL_CLASS3_SIZE      0
+#define UBLOCKPOOL_CLASS3_COUNT     0
+#endif
+
+#if UBLOCKPOOL_CLASS0_COUNT == 0
+#define UBLOCKPOOL_CLASSES          0
+#elif UBLOCKPOOL_CLASS1_COUNT == 0
+#define UBLOCKPOOL_CLASSES          1
+#elif UBLOCKPOOL_CLASS2_COUNT == 0
+#define UBLOCKPOOL_CLASSES          2
+#elif UBLOCKPOOL_CLASS3_COUNT == 0
+#define UBLOCKPOOL_CLASSES          3
+#else
+#define UBLOCKPOOL_CLASSES          4
+#endif
+
+/**
+ * The blocks can be allocated and freed from interrupt routines and from
+ * the tasks. Define these to disable and enable the interrupts when both do
+ * it.
+ */
+#ifndef UBLOCKPOOL_ENTER_CRITICAL
+#define UBLOCKPOOL_ENTER_CRITICAL()
+#define UBLOCKPOOL_EXIT_CRITICAL()
+#endif
+
+/**
+ * Counters of a class.
+ */
+typedef struct
+{
+    /**Blocks allocated.*/
+    uint8_t InUse;
+    /**Most blocks allocated at once since the initialization.*/
+    uint8_t HighWater;
+    /**Allocations that found no block, in this class or a larger one.*/
+    uint16_t Failures;
+} tBlockPoolStatistics;
+
+extern tBlockPoolStatistics uBlockPoolStatistics[UBLOCKPOOL_CLASSES];
+
+void uBlockPoolInit(void);
+void *uBlockPoolAlloc(uint16_t size);
+void uBlockPoolFree(void *block);
+
+#endif /* UBLOCKPOOL_H */
@@ -14,6 +14,7 @@
 
  ************************************************************************/
 
+#include <string.h>
 #include "uFIFO.h"
 
 //This initializes the FIFO structure with the given buffer and size
@@ -25,39 +26,87 @@ void uFIFOInit(tFIFO *f, unsigned char *buf, unsigned int size)
     f->Size = size;
     f->SpaceOcupied = 0;
     f->bufferPointer = buf;
+#ifdef uFIFO_USE_STATISTICS
+    f->HighWatermark = 0;
+    f->LowWatermark = 0;
+    f->WatermarkCallback = NULL;
+    f->AboveWatermark = false;
+    uFIFOResetStatistics(f);
+#endif
 }
 
-//This reads nbytes bytes from the FIFO
-//The number of bytes read is returned
+#ifdef uFIFO_USE_STATISTICS
+//This sets the watermarks of the FIFO, a high watermark of 0 disables them
+//The callback may be NULL if only the AboveWatermark flag is used
 
-unsigned int uFIFOGet(tFIFO * f, unsigned char *buf, unsigned int nbytes)
+void uFIFOSetWatermarks(tFIFO *f, unsigned int low, unsigned int high,
+                        tFIFOWatermarkCallback callback)
+{
+    f->HighWatermark = high;
+    f->LowWatermark = low;
+    f->WatermarkCallback = callback;
+    f->AboveWatermark = false;
+}
+
+//This tells if the FIFO reached the high watermark and didn't yet drain
+//down to the low watermark
+
+bool uFIFOisAboveWatermark(tFIFO *f)
 {
-    unsigned int i;
+    return f->AboveWatermark;
+}
+
+//This clears the peak occupancy and the overflow and underflow counters
+
+void uFIFOResetStatistics(tFIFO *f)
+{
+    f->PeakOcupied = f->SpaceOcupied;
+    f->OverflowCount = 0;
+    f->UnderflowCount = 0;
+}
+
+//This updates the peak occupancy and checks the watermark crossings
+//Must be called every time SpaceOcupied changes
 
-    for (i = 0; i < nbytes; i++)
+static void uFIFOUpdateStatistics(tFIFO *f)
+{
+    if (f->SpaceOcupied > f->PeakOcupied)
     {
-        if (f->Tail != f->Head)
-        {
-            //see if any data is available
-            *buf = f->bufferPointer[f->Tail]; //grab a byte from the buffer
+        f->PeakOcupied = f->SpaceOcupied;
+    }
 
-            f->Tail++; //increment the tail
+    if (f->HighWatermark == 0)
+    {
+        return;
+    }
 
-            if (f->Tail == f->Size)
-            {
-                //check for wrap-around
-                f->Tail = 0;
-            }
+    if (!f->AboveWatermark && (f->SpaceOcupied >= f->HighWatermark))
+    {
+        f->AboveWatermark = true;
 
-            f->SpaceOcupied--;
+        if (f->WatermarkCallback != NULL)
+        {
+            f->WatermarkCallback(f, true);
         }
-        else
+    }
+    else if (f->AboveWatermark && (f->SpaceOcupied <= f->LowWatermark))
+    {
+        f->AboveWatermark = false;
+
+        if (f->WatermarkCallback != NULL)
         {
-            return i; //number of bytes read
+            f->WatermarkCallback(f, false);
         }
     }
+}
+#endif
 
-    return nbytes;
+//This reads nbytes bytes from the FIFO
+//The number of bytes read is returned
+
+unsigned int uFIFOGet(tFIFO * f, unsigned char *buf, unsigned int nbytes)
+{
+    return uFIFOGetBlock(f, buf, nbytes);
 }
 
 //This writes up to nbytes bytes to the FIFO
@@ -66,30 +115,346 @@ unsigned int uFIFOGet(tFIFO * f, unsigned char *buf, unsigned int nbytes)
 
 unsigned int uFIFOPut(tFIFO * f, unsigned char *buf, unsigned int nbytes)
 {
-    unsigned int i;
+    return uFIFOPutBlock(f, buf, nbytes);
+}
 
-    for (i = 0; i < nbytes; i++)
+//This reads up to nbytes bytes from the FIFO with at most two memcpy
+//calls, one up to the end of the buffer and one from its start.
+//Tail and SpaceOcupied are updated only once per call.
+//The number of bytes read is returned
+
+unsigned int uFIFOGetBlock(tFIFO * f, unsigned char *buf, unsigned int nbytes)
+{
+    unsigned int first;
+
+    if (nbytes > f->SpaceOcupied)
     {
-        //first check to see if there is space in the buffer
-        if (f->Head + 1 == f->Tail)
-        {
-            return i; //no more room
-        }
-        else
-        {
-            f->bufferPointer[f->Head] = *buf++;
+        nbytes = f->SpaceOcupied; //only what is available
+#ifdef uFIFO_USE_STATISTICS
+        f->UnderflowCount++;
+#endif
+    }
 
-            f->Head++; //increment the head
+    if (nbytes == 0)
+    {
+        return 0;
+    }
 
-            if (f->Head == f->Size && f->Tail != 0)
-            {
-                //check for wrap-around
-                f->Head = 0;
-            }
+    first = f->Size - f->Tail; //bytes until the wrap point
 
-            f->SpaceOcupied++;
-        }
+    if (first > nbytes)
+    {
+        first = nbytes;
+    }
+
+    memcpy(buf, &f->bufferPointer[f->Tail], first);
+    memcpy(buf + first, f->bufferPointer, nbytes - first);
+
+    f->Tail += nbytes;
+
+    if (f->Tail >= f->Size)
+    {
+        //check for wrap-around
+        f->Tail -= f->Size;
+    }
+
+    f->SpaceOcupied -= nbytes;
+
+#ifdef uFIFO_USE_STATISTICS
+    uFIFOUpdateStatistics(f);
+#endif
+
+    return nbytes;
+}
+
+//This writes up to nbytes bytes to the FIFO with at most two memcpy
+//calls, one up to the end of the buffer and one from its start.
+//Head and SpaceOcupied are updated only once per call.
+//The number of bytes written is returned
+
+unsigned int uFIFOPutBlock(tFIFO * f, const unsigned char *buf,
+                           unsigned int nbytes)
+{
+    unsigned int first;
+
+    if (nbytes > f->Size - f->SpaceOcupied)
+    {
+        nbytes = f->Size - f->SpaceOcupied; //no more room
+#ifdef uFIFO_USE_STATISTICS
+        f->OverflowCount++;
+#endif
+    }
+
+    if (nbytes == 0)
+    {
+        return 0;
+    }
+
+    first = f->Size - f->Head; //bytes until the wrap point
+
+    if (first > nbytes)
+    {
+        first = nbytes;
+    }
+
+    memcpy(&f->bufferPointer[f->Head], buf, first);
+    memcpy(f->bufferPointer, buf + first, nbytes - first);
+
+    f->Head += nbytes;
+
+    if (f->Head >= f->Size)
+    {
+        //check for wrap-around
+        f->Head -= f->Size;
+    }
+
+    f->SpaceOcupied += nbytes;
+
+#ifdef uFIFO_USE_STATISTICS
+    uFIFOUpdateStatistics(f);
+#endif
+
+    return nbytes;
+}
+
+//This tells if there is no more room in the FIFO
+
+bool uFIFOisFull(tFIFO *f)
+{
+    return (f->SpaceOcupied == f->Size);
+}
+
+//This tells if there is nothing to read from the FIFO
+
+bool uFIFOisEmpty(tFIFO *f)
+{
+    return (f->SpaceOcupied == 0);
+}
+
+//This returns the next byte to be read without removing it
+//If the FIFO is empty 0 is returned
+
+unsigned char uFIFOPeek(tFIFO *f)
+{
+    if (f->SpaceOcupied == 0)
+    {
+        return 0;
     }
 
+    return f->bufferPointer[f->Tail];
+}
+
+//This returns the number of bytes stored in the FIFO
+
+unsigned int uFIFOSpaceOcupied(tFIFO *f)
+{
+    return f->SpaceOcupied;
+}
+
+//This discards everything stored in the FIFO
+
+void uFIFOClear(tFIFO *f)
+{
+    f->Head = 0;
+    f->Tail = 0;
+    f->SpaceOcupied = 0;
+#ifdef uFIFO_USE_STATISTICS
+    uFIFOUpdateStatistics(f);
+#endif
+}
+
+//This gives the producer direct access to the free space of the FIFO
+//The returned pointer is the write position inside the buffer and length
+//receives how many bytes can be written there without wrapping
+//Nothing is added to the FIFO until uFIFOCommit is called
+
+unsigned char *uFIFOReserve(tFIFO *f, unsigned int *length)
+{
+    unsigned int contiguous = f->Size - f->Head;
+    unsigned int space = f->Size - f->SpaceOcupied;
+
+    *length = (contiguous < space) ? contiguous : space;
+
+    return &f->bufferPointer[f->Head];
+}
+
+//This adds nbytes bytes, written at the pointer given by uFIFOReserve,
+//to the FIFO
+//The number of bytes committed is returned
+
+unsigned int uFIFOCommit(tFIFO *f, unsigned int nbytes)
+{
+    unsigned int length;
+
+    uFIFOReserve(f, &length);
+
+    if (nbytes > length)
+    {
+        nbytes = length; //never past the reserved region
+    }
+
+    f->Head += nbytes;
+
+    if (f->Head == f->Size)
+    {
+        //check for wrap-around
+        f->Head = 0;
+    }
+
+    f->SpaceOcupied += nbytes;
+
+#ifdef uFIFO_USE_STATISTICS
+    uFIFOUpdateStatistics(f);
+#endif
+
+    return nbytes;
+}
+
+//This gives the consumer direct access to the data of the FIFO
+//The returned pointer is the read position inside the buffer and length
+//receives how many bytes can be read there without wrapping
+//Nothing is removed from the FIFO until uFIFOConsume is called
+
+unsigned char *uFIFOPeekContiguous(tFIFO *f, unsigned int *length)
+{
+    unsigned int contiguous = f->Size - f->Tail;
+
+    *length = (contiguous < f->SpaceOcupied) ? contiguous : f->SpaceOcupied;
+
+    return &f->bufferPointer[f->Tail];
+}
+
+//This removes nbytes bytes from the FIFO, normally after they have been
+//used through the pointer given by uFIFOPeekContiguous
+//The number of bytes removed is returned
+
+unsigned int uFIFOConsume(tFIFO *f, unsigned int nbytes)
+{
+    if (nbytes > f->SpaceOcupied)
+    {
+        nbytes = f->SpaceOcupied;
+    }
+
+    f->Tail += nbytes;
+
+    if (f->Tail >= f->Size)
+    {
+        //check for wrap-around
+        f->Tail -= f->Size;
+    }
+
+    f->SpaceOcupied -= nbytes;
+
+#ifdef uFIFO_USE_STATISTICS
+    uFIFOUpdateStatistics(f);
+#endif
+
+    return nbytes;
+}
+
+//This initializes the single-producer/single-consumer FIFO
+//The size must be a power of two, otherwise false is returned
+
+bool uFIFOSPSCInit(tSPSCFIFO *f, unsigned char *buf, unsigned int size)
+{
+    if ((size == 0) || ((size & (size - 1)) != 0))
+    {
+        return false;
+    }
+
+    f->bufferPointer = buf;
+    f->Head = 0;
+    f->Tail = 0;
+    f->Mask = size - 1;
+
+    return true;
+}
+
+//This returns the number of bytes stored in the FIFO
+//It can be called from both sides
+
+unsigned int uFIFOSPSCSpaceOcupied(tSPSCFIFO *f)
+{
+    return (uFIFO_SPSC_INDEX) (f->Head - f->Tail);
+}
+
+//This reads up to nbytes bytes from the FIFO
+//Must only be called by the consumer
+//The number of bytes read is returned
+
+unsigned int uFIFOSPSCGet(tSPSCFIFO *f, unsigned char *buf,
+                          unsigned int nbytes)
+{
+    uFIFO_SPSC_INDEX tail = f->Tail;
+    unsigned int available = (uFIFO_SPSC_INDEX) (f->Head - tail);
+    unsigned int index, first;
+
+    if (nbytes > available)
+    {
+        nbytes = available;
+    }
+
+    if (nbytes == 0)
+    {
+        return 0;
+    }
+
+    uFIFO_BARRIER(); //read the data only after seeing the head
+
+    index = tail & f->Mask;
+    first = (unsigned int) f->Mask + 1 - index; //bytes until the wrap point
+
+    if (first > nbytes)
+    {
+        first = nbytes;
+    }
+
+    memcpy(buf, &f->bufferPointer[index], first);
+    memcpy(buf + first, f->bufferPointer, nbytes - first);
+
+    uFIFO_BARRIER(); //release the space only after the copy
+
+    f->Tail = tail + nbytes;
+
+    return nbytes;
+}
+
+//This writes up to nbytes bytes to the FIFO
+//Must only be called by the producer
+//The number of bytes written is returned
+
+unsigned int uFIFOSPSCPut(tSPSCFIFO *f, const unsigned char *buf,
+                          unsigned int nbytes)
+{
+    uFIFO_SPSC_INDEX head = f->Head;
+    unsigned int space = (unsigned int) f->Mask + 1
+            - (uFIFO_SPSC_INDEX) (head - f->Tail);
+    unsigned int index, first;
+
+    if (nbytes > space)
+    {
+        nbytes = space;
+    }
+
+    if (nbytes == 0)
+    {
+        return 0;
+    }
+
+    index = head & f->Mask;
+    first = (unsigned int) f->Mask + 1 - index; //bytes until the wrap point
+
+    if (first > nbytes)
+    {
+        first = nbytes;
+    }
+
+    memcpy(&f->bufferPointer[index], buf, first);
+    memcpy(f->bufferPointer, buf + first, nbytes - first);
+
+    uFIFO_BARRIER(); //publish the data before moving the head
+
+    f->Head = head + nbytes;
+
     return nbytes;
 }
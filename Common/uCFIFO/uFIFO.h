@@ -45,20 +45,76 @@ USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 /* includes */
 #include <stdbool.h>
 
+/* Keeps watermarks and occupancy statistics on every tFIFO. Comment it
+   out to save the RAM and the cycles when they are not needed. */
+#define uFIFO_USE_STATISTICS
+
 /* typedefs */
-typedef struct
+struct _tFIFO;
+
+/* Called when the occupancy reaches the high watermark (high = true) and
+   when it falls back to the low watermark (high = false). It runs in the
+   context of the caller of uFIFOPut/uFIFOGet, possibly an ISR. */
+typedef void (*tFIFOWatermarkCallback)(struct _tFIFO *f, bool high);
+
+typedef struct _tFIFO
 {
     unsigned char *bufferPointer;
     unsigned int Head;
     unsigned int Tail;
     unsigned int Size;
     unsigned int SpaceOcupied;
+#ifdef uFIFO_USE_STATISTICS
+    unsigned int HighWatermark;
+    unsigned int LowWatermark;
+    tFIFOWatermarkCallback WatermarkCallback;
+    /* set from reaching the high watermark until back at the low one */
+    bool AboveWatermark;
+    /* highest SpaceOcupied seen */
+    unsigned int PeakOcupied;
+    /* number of puts that couldn't store all the bytes */
+    unsigned int OverflowCount;
+    /* number of gets that couldn't return all the bytes */
+    unsigned int UnderflowCount;
+#endif
 } tFIFO;
 
+/* Index type of the single-producer/single-consumer FIFO. It must be
+   read and written in one instruction by the target, so on 8 bit cores
+   (PIC18) define it to unsigned char before including this file and keep
+   the size at 128 bytes or less. The FIFO of an ISR can then be defined
+   ACCESS_RAM (AccessRAM.h), its indices in the access bank. */
+#ifndef uFIFO_SPSC_INDEX
+#define uFIFO_SPSC_INDEX            unsigned int
+#endif
+
+/* Compiler barrier used to keep the buffer accesses before the index
+   update that publishes them. */
+#if defined(__GNUC__)
+#define uFIFO_BARRIER()             __asm__ __volatile__("" ::: "memory")
+#else
+#define uFIFO_BARRIER()
+#endif
+
+/* Lock-free FIFO for one producer and one consumer (i.e. ISR and main
+   loop). Head is only written by the producer and Tail only by the
+   consumer, both run freely and are masked when accessing the buffer,
+   so there is no shared counter and no critical section is needed. */
+typedef struct
+{
+    unsigned char *bufferPointer;
+    volatile uFIFO_SPSC_INDEX Head;
+    volatile uFIFO_SPSC_INDEX Tail;
+    uFIFO_SPSC_INDEX Mask;
+} tSPSCFIFO;
+
 /* functions */
 void uFIFOInit(tFIFO * f, unsigned char *buf, unsigned int size);
 unsigned int uFIFOGet(tFIFO * f, unsigned char *buf, unsigned int nbytes);
 unsigned int uFIFOPut(tFIFO * f, unsigned char *buf, unsigned int nbytes);
+unsigned int uFIFOGetBlock(tFIFO * f, unsigned char *buf, unsigned int nbytes);
+unsigned int uFIFOPutBlock(tFIFO * f, const unsigned char *buf,
+                           unsigned int nbytes);
 
 bool uFIFOisFull(tFIFO *f);
 bool uFIFOisEmpty(tFIFO *f);
@@ -66,4 +122,23 @@ unsigned char uFIFOPeek(tFIFO *f);
 unsigned int uFIFOSpaceOcupied(tFIFO *f);
 void uFIFOClear(tFIFO *f);
 
+#ifdef uFIFO_USE_STATISTICS
+void uFIFOSetWatermarks(tFIFO *f, unsigned int low, unsigned int high,
+                        tFIFOWatermarkCallback callback);
+bool uFIFOisAboveWatermark(tFIFO *f);
+void uFIFOResetStatistics(tFIFO *f);
+#endif
+
+unsigned char *uFIFOReserve(tFIFO *f, unsigned int *length);
+unsigned int uFIFOCommit(tFIFO *f, unsigned int nbytes);
+unsigned char *uFIFOPeekContiguous(tFIFO *f, unsigned int *length);
+unsigned int uFIFOConsume(tFIFO *f, unsigned int nbytes);
+
+bool uFIFOSPSCInit(tSPSCFIFO *f, unsigned char *buf, unsigned int size);
+unsigned int uFIFOSPSCGet(tSPSCFIFO *f, unsigned char *buf,
+                          unsigned int nbytes);
+unsigned int uFIFOSPSCPut(tSPSCFIFO *f, const unsigned char *buf,
+                          unsigned int nbytes);
+unsigned int uFIFOSPSCSpaceOcupied(tSPSCFIFO *f);
+
 #endif // _FIFO_H_
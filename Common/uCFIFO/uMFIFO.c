@@ -0,0 +1,181 @@
+/**
+ *  @file       uMFIFO.c
+ *  @author     Luis Maduro
+ *  @version    1.00
+ *  @date       14/10/2026
+ *  @brief      Record oriented (variable length message) FIFO on top of uFIFO.
+ *
+ *  Copyright (C) 2026  Luis Maduro
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "uMFIFO.h"
+
+/**
+ * Initializes the record FIFO with the given buffer and size.
+ * @param m Record FIFO to initialize.
+ * @param buf Storage for the records and their length prefixes.
+ * @param size Size of buf in bytes.
+ * @param policy What to do when a record doesn't fit.
+ */
+void uMFIFOInit(tMFIFO *m, unsigned char *buf, unsigned int size,
+                tMFIFOPolicy policy)
+{
+    uFIFOInit(&m->fifo, buf, size);
+    m->Records = 0;
+    m->Dropped = 0;
+    m->Policy = policy;
+}
+
+/**
+ * Length of the next record, read from its prefix without removing it.
+ * @param m Record FIFO.
+ * @return Length of the next record, 0 if there is none.
+ */
+unsigned int uMFIFOPeekLength(tMFIFO *m)
+{
+    unsigned int second;
+
+    if (m->Records == 0)
+    {
+        return 0;
+    }
+
+    second = m->fifo.Tail + 1;
+
+    if (second == m->fifo.Size)
+    {
+        second = 0;
+    }
+
+    return m->fifo.bufferPointer[m->fifo.Tail]
+            | ((unsigned int) m->fifo.bufferPointer[second] << 8);
+}
+
+/**
+ * Discards the next record.
+ * @param m Record FIFO.
+ * @return True if a record was discarded, false if the FIFO was empty.
+ */
+bool uMFIFODrop(tMFIFO *m)
+{
+    unsigned int length = uMFIFOPeekLength(m);
+
+    if (m->Records == 0)
+    {
+        return false;
+    }
+
+    uFIFOConsume(&m->fifo, UMFIFO_HEADER_SIZE + length);
+    m->Records--;
+
+    return true;
+}
+
+/**
+ * Adds a whole record to the FIFO. If there isn't enough space the record
+ * is rejected or the oldest records are discarded, depending on the policy.
+ * @param m Record FIFO.
+ * @param record Data of the record.
+ * @param length Length of the record, from 1 to 65535 bytes.
+ * @return True if the record was stored, false otherwise.
+ */
+bool uMFIFOPush(tMFIFO *m, const unsigned char *record, unsigned int length)
+{
+    unsigned char header[UMFIFO_HEADER_SIZE];
+    unsigned int needed;
+
+    //checked before the header is added, it wraps with a 16 bit int (PIC18)
+    if ((length == 0) || (length > 0xFFFF) || (m->fifo.Size < UMFIFO_HEADER_SIZE)
+            || (length > m->fifo.Size - UMFIFO_HEADER_SIZE))
+    {
+        m->Dropped++;
+        return false; //it would never fit
+    }
+
+    needed = UMFIFO_HEADER_SIZE + length;
+
+    while (needed > m->fifo.Size - m->fifo.SpaceOcupied)
+    {
+        if (m->Policy == UMFIFO_REJECT_NEWEST)
+        {
+            m->Dropped++;
+            return false;
+        }
+
+        uMFIFODrop(m);
+        m->Dropped++;
+    }
+
+    header[0] = (unsigned char) (length & 0xFF);
+    header[1] = (unsigned char) (length >> 8);
+
+    uFIFOPutBlock(&m->fifo, header, UMFIFO_HEADER_SIZE);
+    uFIFOPutBlock(&m->fifo, record, length);
+    m->Records++;
+
+    return true;
+}
+
+/**
+ * Removes the next whole record from the FIFO. If buf is smaller than the
+ * record only the first size bytes are copied and the rest is discarded.
+ * @param m Record FIFO.
+ * @param buf Buffer to copy the record to.
+ * @param size Size of buf in bytes.
+ * @return Number of bytes copied to buf, 0 if the FIFO was empty.
+ */
+unsigned int uMFIFOPop(tMFIFO *m, unsigned char *buf, unsigned int size)
+{
+    unsigned int length = uMFIFOPeekLength(m);
+
+    if (length == 0)
+    {
+        return 0;
+    }
+
+    uFIFOConsume(&m->fifo, UMFIFO_HEADER_SIZE);
+
+    if (size > length)
+    {
+        size = length;
+    }
+
+    uFIFOGetBlock(&m->fifo, buf, size);
+    uFIFOConsume(&m->fifo, length - size);
+    m->Records--;
+
+    return size;
+}
+
+/**
+ * Number of complete records stored.
+ * @param m Record FIFO.
+ * @return Number of records.
+ */
+unsigned int uMFIFORecords(tMFIFO *m)
+{
+    return m->Records;
+}
+
+/**
+ * Discards all the records.
+ * @param m Record FIFO.
+ */
+void uMFIFOClear(tMFIFO *m)
+{
+    uFIFOClear(&m->fifo);
+    m->Records = 0;
+}
@@ -0,0 +1,66 @@
+/**
+ *  @file       uMFIFO.h
+ *  @author     Luis Maduro
+ *  @version    1.00
+ *  @date       14/10/2026
+ *  @brief      Record oriented (variable length message) FIFO on top of uFIFO.
+ *
+ *  Every record is stored in the byte FIFO preceded by a two byte length
+ *  (low byte first), so the size of the next record is known without
+ *  scanning the buffer and a whole record is removed in one call.
+ *
+ *  Copyright (C) 2026  Luis Maduro
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef UMFIFO_H
+#define UMFIFO_H
+
+#include <stdbool.h>
+#include "uFIFO.h"
+
+/**Number of bytes used by the length prefix of each record.*/
+#define UMFIFO_HEADER_SIZE          2
+
+typedef enum
+{
+    /**A record that doesn't fit is discarded, the queued ones are kept.*/
+    UMFIFO_REJECT_NEWEST = 0x00,
+    /**The oldest records are discarded until the new one fits.*/
+    UMFIFO_DROP_OLDEST = 0x01
+} tMFIFOPolicy;
+
+typedef struct
+{
+    /**Byte FIFO holding the length prefixed records.*/
+    tFIFO fifo;
+    /**Number of complete records stored.*/
+    unsigned int Records;
+    /**Number of records discarded by the overflow policy.*/
+    unsigned int Dropped;
+    /**What to do when a new record doesn't fit.*/
+    tMFIFOPolicy Policy;
+} tMFIFO;
+
+void uMFIFOInit(tMFIFO *m, unsigned char *buf, unsigned int size,
+                tMFIFOPolicy policy);
+bool uMFIFOPush(tMFIFO *m, const unsigned char *record, unsigned int length);
+unsigned int uMFIFOPop(tMFIFO *m, unsigned char *buf, unsigned int size);
+unsigned int uMFIFOPeekLength(tMFIFO *m);
+bool uMFIFODrop(tMFIFO *m);
+unsigned int uMFIFORecords(tMFIFO *m);
+void uMFIFOClear(tMFIFO *m);
+
+#endif /* UMFIFO_H */
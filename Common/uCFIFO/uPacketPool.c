@@ -0,0 +1,172 @@
+/**
+ *  @file       uPacketPool.c
+ *  @author     Luis Maduro
+ *  @version    1.00
+ *  @date       14/10/2026
+ *  @brief      Pool of packet buffers with reference counts.
+ *
+ *  Copyright (C) 2026  Luis Maduro
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "uPacketPool.h"
+
+/**
+ * A buffer of the pool.
+ */
+typedef struct
+{
+    /**References to the buffer, 0 when it is free.*/
+    uint8_t RefCount;
+    /**Bytes used in the data.*/
+    uint8_t Length;
+    uint8_t Data[UPACKETPOOL_BUFFER_SIZE];
+} tPacketBuffer;
+
+static tPacketBuffer uPacketPoolBuffers[UPACKETPOOL_BUFFERS];
+/**Number of free buffers.*/
+static uint8_t uPacketPoolFreeCount;
+
+/**
+ * Frees all the buffers of the pool.
+ */
+void uPacketPoolInit(void)
+{
+    uint8_t i;
+
+    for (i = 0; i < UPACKETPOOL_BUFFERS; i++)
+    {
+        uPacketPoolBuffers[i].RefCount = 0;
+        uPacketPoolBuffers[i].Length = 0;
+    }
+
+    uPacketPoolFreeCount = UPACKETPOOL_BUFFERS;
+}
+
+/**
+ * Takes a free buffer of the pool, with one reference and no data.
+ * @return Handle of the buffer, UPACKETPOOL_NONE if the pool is empty.
+ */
+tPacketHandle uPacketPoolAlloc(void)
+{
+    uint8_t i;
+
+    UPACKETPOOL_ENTER_CRITICAL();
+
+    for (i = 0; i < UPACKETPOOL_BUFFERS; i++)
+    {
+        if (uPacketPoolBuffers[i].RefCount == 0)
+        {
+            uPacketPoolBuffers[i].RefCount = 1;
+            uPacketPoolBuffers[i].Length = 0;
+            uPacketPoolFreeCount--;
+
+            UPACKETPOOL_EXIT_CRITICAL();
+
+            return i;
+        }
+    }
+
+    UPACKETPOOL_EXIT_CRITICAL();
+
+    return UPACKETPOOL_NONE;
+}
+
+/**
+ * Adds a reference to a buffer, for a layer that keeps it.
+ * @param handle Buffer.
+ */
+void uPacketPoolRetain(tPacketHandle handle)
+{
+    if (handle >= UPACKETPOOL_BUFFERS)
+    {
+        return;
+    }
+
+    UPACKETPOOL_ENTER_CRITICAL();
+    uPacketPoolBuffers[handle].RefCount++;
+    UPACKETPOOL_EXIT_CRITICAL();
+}
+
+/**
+ * Removes a reference to a buffer, it goes back to the pool with the last
+ * one.
+ * @param handle Buffer.
+ */
+void uPacketPoolRelease(tPacketHandle handle)
+{
+    if (handle >= UPACKETPOOL_BUFFERS)
+    {
+        return;
+    }
+
+    UPACKETPOOL_ENTER_CRITICAL();
+
+    if (uPacketPoolBuffers[handle].RefCount != 0)
+    {
+        uPacketPoolBuffers[handle].RefCount--;
+
+        if (uPacketPoolBuffers[handle].RefCount == 0)
+        {
+            uPacketPoolFreeCount++;
+        }
+    }
+
+    UPACKETPOOL_EXIT_CRITICAL();
+}
+
+/**
+ * Gives the data of a buffer, UPACKETPOOL_BUFFER_SIZE bytes.
+ * @param handle Buffer.
+ * @return Data of the buffer.
+ */
+uint8_t *uPacketPoolData(tPacketHandle handle)
+{
+    return uPacketPoolBuffers[handle].Data;
+}
+
+/**
+ * Gives the number of bytes used in a buffer.
+ * @param handle Buffer.
+ * @return Bytes used.
+ */
+uint8_t uPacketPoolLength(tPacketHandle handle)
+{
+    return uPacketPoolBuffers[handle].Length;
+}
+
+/**
+ * Sets the number of bytes used in a buffer.
+ * @param handle Buffer.
+ * @param length Bytes used, up to UPACKETPOOL_BUFFER_SIZE.
+ */
+void uPacketPoolSetLength(tPacketHandle handle, uint8_t length)
+{
+    if (length > UPACKETPOOL_BUFFER_SIZE)
+    {
+        length = UPACKETPOOL_BUFFER_SIZE;
+    }
+
+    uPacketPoolBuffers[handle].Length = length;
+}
+
+/**
+ * Gives the number of free buffers of the pool.
+ * @return Free buffers.
+ */
+uint8_t uPacketPoolFree(void)
+{
+    return uPacketPoolFreeCount;
+}
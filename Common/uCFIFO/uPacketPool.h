@@ -0,0 +1,71 @@
+/**
+ *  @file       uPacketPool.h
+ *  @author     Luis Maduro
+ *  @version    1.00
+ *  @date       14/10/2026
+ *  @brief      Pool of packet buffers with reference counts.
+ *
+ *  A fixed number of buffers of one size, allocated statically. The radio
+ *  driver receives a frame straight into a buffer of the pool and the upper
+ *  layers pass its handle instead of copying the bytes; the buffer is sent
+ *  from the handle. Every layer that keeps a buffer (a queue, a retry)
+ *  calls uPacketPoolRetain() and uPacketPoolRelease() when it is done, the
+ *  buffer goes back to the pool when the last reference is released.
+ *
+ *  Copyright (C) 2026  Luis Maduro
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef UPACKETPOOL_H
+#define UPACKETPOOL_H
+
+#include <stdint.h>
+
+/**Number of buffers of the pool, 254 max.*/
+#ifndef UPACKETPOOL_BUFFERS
+#define UPACKETPOOL_BUFFERS         4
+#endif
+
+/**Bytes of every buffer, an 802.15.4 frame is 127 bytes max.*/
+#ifndef UPACKETPOOL_BUFFER_SIZE
+#define UPACKETPOOL_BUFFER_SIZE     128
+#endif
+
+/**
+ * The buffers can be allocated and released from interrupt routines and
+ * from the tasks. Define these to disable and enable the interrupts when
+ * both do it.
+ */
+#ifndef UPACKETPOOL_ENTER_CRITICAL
+#define UPACKETPOOL_ENTER_CRITICAL()
+#define UPACKETPOOL_EXIT_CRITICAL()
+#endif
+
+/**Handle of no buffer, given when the pool is empty.*/
+#define UPACKETPOOL_NONE            0xFF
+
+/**Handle of a buffer of the pool.*/
+typedef uint8_t tPacketHandle;
+
+void uPacketPoolInit(void);
+tPacketHandle uPacketPoolAlloc(void);
+void uPacketPoolRetain(tPacketHandle handle);
+void uPacketPoolRelease(tPacketHandle handle);
+uint8_t *uPacketPoolData(tPacketHandle handle);
+uint8_t uPacketPoolLength(tPacketHandle handle);
+void uPacketPoolSetLength(tPacketHandle handle, uint8_t length);
+uint8_t uPacketPoolFree(void);
+
+#endif /* UPACKETPOOL_H */
@@ -0,0 +1,174 @@
+/**
+ *  @file       uRing.h
+ *  @author     Luis Maduro
+ *  @version    1.00
+ *  @date       14/10/2026
+ *  @brief      Typed single-producer/single-consumer rings, generated at
+ *              compile time.
+ *
+ *  tSPSCFIFO moves bytes: a 16 bit ADC sample, an IMU frame or a packet
+ *  handle has to be split in bytes, and the size and mask are read from
+ *  the structure at run time. DECLARE_RING(name, type, size) generates a
+ *  ring of elements of one type with the size as a constant, so the mask is
+ *  folded in the code, and push and pop of one element are static inline
+ *  functions: an assignment of the element and an index update.
+ *  @code
+ *  DECLARE_RING(ADCRing, int16_t, 64)
+ *
+ *  static tADCRing adcRing;
+ *
+ *  ADCRingInit(&adcRing);
+ *  ADCRingPush(&adcRing, &sample);     //in the ISR
+ *
+ *  while (ADCRingPop(&adcRing, &sample)) //in a task
+ *      ...
+ *  @endcode
+ *  generates tADCRing, ADCRing_SIZE and ADCRing_MASK, and ADCRingInit(),
+ *  ADCRingPush(), ADCRingPop(), ADCRingPeek(), ADCRingCount(),
+ *  ADCRingIsEmpty() and ADCRingIsFull(). DECLARE_RING() goes in the header
+ *  shared by the producer and the consumer, the rings themselves are
+ *  defined in one file.
+ *
+ *  The guarantees are the ones of tSPSCFIFO: Head is only written by the
+ *  producer and Tail only by the consumer, both run freely, so an ISR and
+ *  the main loop use a ring without a critical section. The indices are
+ *  uFIFO_SPSC_INDEX: on PIC18, where it is unsigned char, the ring has 128
+ *  elements at most. The size is a power of two, both checked at compile
+ *  time.
+ *
+ *  Copyright (C) 2026  Luis Maduro
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef URING_H
+#define URING_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include "uFIFO.h"
+
+/**
+ * Declares the type, the constants and the functions of a ring.
+ * @param name Prefix of all of them.
+ * @param type Type of the elements.
+ * @param size Elements, a power of two that fits uFIFO_SPSC_INDEX.
+ */
+#define DECLARE_RING(name, type, size)                                          \
+                                                                                \
+enum                                                                            \
+{                                                                               \
+    name##_SIZE = (size),                                                       \
+    name##_MASK = (size) - 1                                                    \
+};                                                                              \
+                                                                                \
+/* a negative array size if the size is not a power of two or needs a */       \
+/* wider index, the full and empty rings must differ by the size */            \
+typedef char name##_SizeCheck[(((size) > 0)                                     \
+        && (((size) & ((size) - 1)) == 0)                                       \
+        && ((size) - 1 <= (uFIFO_SPSC_INDEX) ~0u / 2)) ? 1 : -1];               \
+                                                                                \
+typedef struct                                                                  \
+{                                                                               \
+    type buffer[size];                                                          \
+    volatile uFIFO_SPSC_INDEX Head;                                             \
+    volatile uFIFO_SPSC_INDEX Tail;                                             \
+} t##name;                                                                      \
+                                                                                \
+/* empties the ring, before the producer and the consumer use it */            \
+static inline void name##Init(t##name *r)                                       \
+{                                                                               \
+    r->Head = 0;                                                                \
+    r->Tail = 0;                                                                \
+}                                                                               \
+                                                                                \
+/* elements stored, it can be called from both sides */                        \
+static inline uFIFO_SPSC_INDEX name##Count(t##name *r)                          \
+{                                                                               \
+    return (uFIFO_SPSC_INDEX) (r->Head - r->Tail);                              \
+}                                                                               \
+                                                                                \
+static inline bool name##IsEmpty(t##name *r)                                    \
+{                                                                               \
+    return r->Head == r->Tail;                                                  \
+}                                                                               \
+                                                                                \
+static inline bool name##IsFull(t##name *r)                                     \
+{                                                                               \
+    return name##Count(r) == name##_SIZE;                                       \
+}                                                                               \
+                                                                                \
+/* copies an element in, false if the ring is full */                          \
+/* must only be called by the producer */                                      \
+static inline bool name##Push(t##name *r, const type *item)                     \
+{                                                                               \
+    uFIFO_SPSC_INDEX head = r->Head;                                            \
+                                                                                \
+    if ((uFIFO_SPSC_INDEX) (head - r->Tail) == name##_SIZE)                     \
+    {                                                                           \
+        return false;                                                           \
+    }                                                                           \
+                                                                                \
+    r->buffer[head & name##_MASK] = *item;                                      \
+                                                                                \
+    uFIFO_BARRIER(); /* publish the element only after the copy */             \
+                                                                                \
+    r->Head = head + 1;                                                         \
+                                                                                \
+    return true;                                                                \
+}                                                                               \
+                                                                                \
+/* copies the oldest element out, or drops it after a peek if item is */     \
+/* NULL, false if the ring is empty */                                         \
+/* must only be called by the consumer */                                      \
+static inline bool name##Pop(t##name *r, type *item)                            \
+{                                                                               \
+    uFIFO_SPSC_INDEX tail = r->Tail;                                            \
+                                                                                \
+    if (tail == r->Head)                                                        \
+    {                                                                           \
+        return false;                                                           \
+    }                                                                           \
+                                                                                \
+    uFIFO_BARRIER(); /* read the element only after seeing the head */         \
+                                                                                \
+    if (item != NULL)                                                           \
+    {                                                                           \
+        *item = r->buffer[tail & name##_MASK];                                  \
+    }                                                                           \
+                                                                                \
+    uFIFO_BARRIER(); /* release the place only after the copy */               \
+                                                                                \
+    r->Tail = tail + 1;                                                         \
+                                                                                \
+    return true;                                                                \
+}                                                                               \
+                                                                                \
+/* oldest element where it is, NULL if the ring is empty, it stays in the */   \
+/* ring until the next pop, must only be called by the consumer */             \
+static inline type *name##Peek(t##name *r)                                      \
+{                                                                               \
+    uFIFO_SPSC_INDEX tail = r->Tail;                                            \
+                                                                                \
+    if (tail == r->Head)                                                        \
+    {                                                                           \
+        return NULL;                                                            \
+    }                                                                           \
+                                                                                \
+    uFIFO_BARRIER();                                                            \
+                                                                                \
+    return &r->buffer[tail & name##_MASK];                                      \
+}
+
+#endif /* URING_H */
@@ -0,0 +1,201 @@
+/**
+ *  @file       uSampleRing.c
+ *  @author     Luis Maduro
+ *  @version    1.00
+ *  @date       14/10/2026
+ *  @brief      Ring of timestamped sensor samples with several readers.
+ *
+ *  Copyright (C) 2026  Luis Maduro
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <stddef.h>
+#include "uSampleRing.h"
+
+/**
+ * Initializes a ring over the given slots.
+ * @param ring Ring to initialize.
+ * @param slots Storage of the samples.
+ * @param size Number of slots, a power of 2.
+ * @return False if the size is not a power of 2.
+ */
+bool uSampleRingInit(tSampleRing *ring, tSample *slots, unsigned int size)
+{
+    if ((size == 0) || ((size & (size - 1)) != 0))
+    {
+        return false;
+    }
+
+    ring->slots = slots;
+    ring->Mask = size - 1;
+    ring->Head = 0;
+
+    return true;
+}
+
+/**
+ * Gives the slot of the next sample, to fill in place. It is not seen by
+ * the readers until uSampleRingPublish(). Must only be called by the writer.
+ * @param ring Ring.
+ * @return Slot of the next sample.
+ */
+tSample *uSampleRingReserve(tSampleRing *ring)
+{
+    return &ring->slots[ring->Head & ring->Mask];
+}
+
+/**
+ * Makes the sample filled after uSampleRingReserve() visible to the
+ * readers. Must only be called by the writer.
+ * @param ring Ring.
+ */
+void uSampleRingPublish(tSampleRing *ring)
+{
+    uFIFO_BARRIER(); //the sample is written before moving the head
+    ring->Head = ring->Head + 1;
+}
+
+/**
+ * Writes a sample of 16 bit values, for the drivers that give their values
+ * through out parameters.
+ * @param ring Ring.
+ * @param sensor USAMPLERING_SENSOR_...
+ * @param timestamp Time of the sample.
+ * @param values Values of the sample.
+ * @param count Number of values.
+ * @return False if the values don't fit in a sample.
+ */
+bool uSampleRingWrite(tSampleRing *ring, uint8_t sensor, uint32_t timestamp,
+                      const int16_t *values, uint8_t count)
+{
+    tSample *sample;
+    uint8_t i;
+
+    if (count > USAMPLERING_PAYLOAD_SIZE / 2)
+    {
+        return false;
+    }
+
+    sample = uSampleRingReserve(ring);
+    sample->sensor = sensor;
+    sample->length = count * 2;
+    sample->timestamp = timestamp;
+
+    for (i = 0; i < count; i++)
+    {
+        sample->payload.values[i] = values[i];
+    }
+
+    uSampleRingPublish(ring);
+
+    return true;
+}
+
+/**
+ * Initializes a reader, it starts with the next sample published.
+ * @param cursor Reader.
+ * @param ring Ring to read.
+ */
+void uSampleRingCursorInit(tSampleCursor *cursor, tSampleRing *ring)
+{
+    cursor->ring = ring;
+    cursor->Next = ring->Head;
+    cursor->Lost = 0;
+}
+
+/**
+ * Number of samples the reader has not read yet. If the reader is more than
+ * a whole ring behind, it jumps to the oldest sample still in the ring.
+ * @param cursor Reader.
+ * @return Samples to read.
+ */
+unsigned int uSampleRingAvailable(tSampleCursor *cursor)
+{
+    USAMPLERING_INDEX head = cursor->ring->Head;
+    USAMPLERING_INDEX behind = (USAMPLERING_INDEX) (head - cursor->Next);
+
+    //the slot at the head can be being written, keep one slot away
+    if (behind > cursor->ring->Mask)
+    {
+        cursor->Lost += behind - cursor->ring->Mask;
+        cursor->Next = (USAMPLERING_INDEX) (head - cursor->ring->Mask);
+        behind = cursor->ring->Mask;
+    }
+
+    return behind;
+}
+
+/**
+ * Gives the next sample of the reader, in its slot.
+ * @param cursor Reader.
+ * @return Sample, NULL if there is none. It stays the same until
+ *         uSampleRingRelease().
+ */
+const tSample *uSampleRingPeek(tSampleCursor *cursor)
+{
+    if (uSampleRingAvailable(cursor) == 0)
+    {
+        return NULL;
+    }
+
+    return &cursor->ring->slots[cursor->Next & cursor->ring->Mask];
+}
+
+/**
+ * Gives the next sample of a sensor, the samples of the other sensors
+ * before it are skipped.
+ * @param cursor Reader.
+ * @param sensor USAMPLERING_SENSOR_...
+ * @return Sample, NULL if there is none.
+ */
+const tSample *uSampleRingPeekSensor(tSampleCursor *cursor, uint8_t sensor)
+{
+    const tSample *sample;
+
+    while ((sample = uSampleRingPeek(cursor)) != NULL)
+    {
+        if (sample->sensor == sensor)
+        {
+            return sample;
+        }
+
+        cursor->Next = cursor->Next + 1;
+    }
+
+    return NULL;
+}
+
+/**
+ * Ends the read of the sample given by uSampleRingPeek().
+ * @param cursor Reader.
+ * @return False if the writer reused the slot while it was being read, the
+ *         values read from it can be mixed and have to be discarded.
+ */
+bool uSampleRingRelease(tSampleCursor *cursor)
+{
+    USAMPLERING_INDEX behind;
+
+    uFIFO_BARRIER(); //the slot is read before looking at the head
+    behind = (USAMPLERING_INDEX) (cursor->ring->Head - cursor->Next);
+    cursor->Next = cursor->Next + 1;
+
+    if (behind > cursor->ring->Mask)
+    {
+        cursor->Lost++;
+        return false;
+    }
+
+    return true;
+}
@@ -0,0 +1,124 @@
+/**
+ *  @file       uSampleRing.h
+ *  @author     Luis Maduro
+ *  @version    1.00
+ *  @date       14/10/2026
+ *  @brief      Ring of timestamped sensor samples with several readers.
+ *
+ *  The drivers publish {sensor, timestamp, payload} records in the slots of
+ *  the ring: uSampleRingReserve() gives the next slot, the driver fills it
+ *  in place and uSampleRingPublish() makes it visible. Every reader (a
+ *  logger, the radio, a filter...) has its own cursor and reads the slots
+ *  where they are, uSampleRingPeek() gives a pointer to the slot and
+ *  uSampleRingRelease() moves the cursor. One read of a sensor feeds all
+ *  the readers, without copies and without reading the sensor again.
+ *
+ *  The writer never waits for the readers: a reader that falls a whole ring
+ *  behind loses the oldest samples, they are counted in its cursor.
+ *  uSampleRingRelease() tells if the slot was overwritten while it was being
+ *  read. There is one writer per ring (or the writers are serialized by the
+ *  caller), the readers don't change the ring so they need no lock.
+ *
+ *  Copyright (C) 2026  Luis Maduro
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef USAMPLERING_H
+#define USAMPLERING_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "uFIFO.h"
+
+/**Bytes of payload of a sample, the largest record of the drivers (an IMU
+ frame of 9 axes needs 18).*/
+#ifndef USAMPLERING_PAYLOAD_SIZE
+#define USAMPLERING_PAYLOAD_SIZE    12
+#endif
+
+/**Index type of the ring, read and written in one instruction by the
+ target. On 8 bit cores (PIC18) define it to unsigned char before including
+ this file and keep the ring at 128 slots or less.*/
+#ifndef USAMPLERING_INDEX
+#define USAMPLERING_INDEX           unsigned int
+#endif
+
+/**Sensor identifiers of the drivers of this library, the application can
+ use its own from USAMPLERING_SENSOR_USER.*/
+#define USAMPLERING_SENSOR_MCP3421      1
+#define USAMPLERING_SENSOR_SHT15        2
+#define USAMPLERING_SENSOR_STC3100      3
+#define USAMPLERING_SENSOR_ACCEL        4
+#define USAMPLERING_SENSOR_GYRO         5
+#define USAMPLERING_SENSOR_MAG          6
+#define USAMPLERING_SENSOR_ADC          7
+#define USAMPLERING_SENSOR_USER         32
+
+/**
+ * A sample, the slot of the ring.
+ */
+typedef struct
+{
+    /**USAMPLERING_SENSOR_...*/
+    uint8_t sensor;
+    /**Number of bytes of the payload used.*/
+    uint8_t length;
+    /**Time of the sample, in the unit of the writer (us or ms).*/
+    uint32_t timestamp;
+
+    union
+    {
+        int16_t values[USAMPLERING_PAYLOAD_SIZE / 2];
+        int32_t values32[USAMPLERING_PAYLOAD_SIZE / 4];
+        uint8_t bytes[USAMPLERING_PAYLOAD_SIZE];
+    } payload;
+} tSample;
+
+/**
+ * Ring of samples, the slots are given by the user.
+ */
+typedef struct
+{
+    tSample *slots;
+    USAMPLERING_INDEX Mask;
+    /**Samples published, running freely.*/
+    volatile USAMPLERING_INDEX Head;
+} tSampleRing;
+
+/**
+ * Position of a reader in a ring.
+ */
+typedef struct
+{
+    tSampleRing *ring;
+    /**Next sample to read, running freely as the head.*/
+    USAMPLERING_INDEX Next;
+    /**Samples overwritten before this reader got to them.*/
+    unsigned int Lost;
+} tSampleCursor;
+
+bool uSampleRingInit(tSampleRing *ring, tSample *slots, unsigned int size);
+tSample *uSampleRingReserve(tSampleRing *ring);
+void uSampleRingPublish(tSampleRing *ring);
+bool uSampleRingWrite(tSampleRing *ring, uint8_t sensor, uint32_t timestamp,
+                      const int16_t *values, uint8_t count);
+
+void uSampleRingCursorInit(tSampleCursor *cursor, tSampleRing *ring);
+const tSample *uSampleRingPeek(tSampleCursor *cursor);
+const tSample *uSampleRingPeekSensor(tSampleCursor *cursor, uint8_t sensor);
+bool uSampleRingRelease(tSampleCursor *cursor);
+unsigned int uSampleRingAvailable(tSampleCursor *cursor);
+
+#endif /* USAMPLERING_H */
@@ -0,0 +1,375 @@
+/**
+ *  @file           Benchmark.c
+ *  @author         Luis Maduro
+ *  @version        1.0
+ *  @date           14/10/2026
+ *  @copyright		GNU General Public License
+ *
+ *  @brief Host benchmark of the scheduler, through the uKernel, pKernel and
+ *  Tasker APIs.
+ *  A set of periodic tasks, with periods of 1 to 100 ms and a total load of
+ *  the processor chosen in the command line, runs on a simulated microsecond
+ *  clock. Every task body moves the clock by its execution time and, when
+ *  nothing is due, the idle hook moves it to the next deadline, so the
+ *  schedule is the one of a real target and the host only measures the
+ *  scheduler itself. For every API and number of tasks it gives:
+ *  - the host time used by the scheduler per task dispatch and per
+ *    simulated millisecond (the time in the task bodies and in the idle hook
+ *    is not counted);
+ *  - the deadline misses, starts a whole period or more late (the overruns
+ *    of the descriptors);
+ *  - a histogram of the start jitter, the difference between the real and
+ *    the nominal time between two starts of a task.
+ *
+ *  The uKernel runs are done without and with priorities, rate monotonic
+ *  (shorter period, higher priority).
+ *
+ *  Build and run on the host, from this folder:
+ *  @code
+ *  gcc -O2 -include Simulation.h -I../.. Benchmark.c ../uKernel.c \
+ *      ../../pKernel/pKernel.c ../../Tasker/Tasker.c -o benchmark
+ *  ./benchmark [seconds] [load %]
+ *  @endcode
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <setjmp.h>
+#include <time.h>
+#include "uKernel/uKernel.h"
+#include "pKernel/pKernel.h"
+#include "Tasker/Tasker.h"
+
+#ifndef UKERNEL_USE_US_TIMEBASE
+#error "Benchmark: build with -include Simulation.h"
+#endif
+
+/**Simulated time by default, in seconds.*/
+#define BENCHMARK_SECONDS               10
+/**Load of the processor by default, in %.*/
+#define BENCHMARK_LOAD                  60
+/**Number of jitter buckets.*/
+#define JITTER_BUCKETS                  6
+
+typedef enum
+{
+    API_UKERNEL,
+    API_UKERNEL_PRIORITIES,
+    API_PKERNEL,
+    API_TASKER
+} tBenchmarkApi;
+
+typedef struct
+{
+    uKernelTaskDescriptor *descriptor;
+    /**Period and execution time in us.*/
+    uint32_t period;
+    uint32_t cost;
+    /**Start of the last run and of the next one, in us.*/
+    uint32_t lastStart;
+    uint32_t nextStart;
+    uint32_t runs;
+} tBenchmarkTask;
+
+typedef struct
+{
+    uint64_t dispatches;
+    uint64_t schedulerNs;
+    uint32_t misses;
+    uint32_t jitter[JITTER_BUCKETS];
+} tBenchmarkResult;
+
+volatile uint32_t simMicros;
+
+static const char *apiNames[] = {"uKernel", "uKernel+prio", "pKernel", "Tasker"};
+/**Upper limit of the jitter buckets in us, the last one takes the rest.*/
+static const uint32_t jitterLimits[JITTER_BUCKETS - 1] = {1, 10, 100, 1000, 10000};
+static const uint32_t periods[] = {1000, 2000, 5000, 10000, 20000, 50000, 100000};
+
+static uKernelTaskDescriptor descriptors[MAX_TASKS_NUMBER];
+static tBenchmarkTask tasks[MAX_TASKS_NUMBER];
+static uint8_t numberTasks;
+static tBenchmarkApi api;
+static uint32_t simEnd;
+static uint64_t excludedNs;
+static uint32_t randomState;
+static jmp_buf simExit;
+static tBenchmarkResult result;
+
+static uint64_t HostNs(void)
+{
+    struct timespec now;
+
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (uint64_t) now.tv_sec * 1000000000u + (uint64_t) now.tv_nsec;
+}
+
+/**
+ * Deterministic pseudo random numbers, the same task set on every run.
+ */
+static uint32_t BenchmarkRandom(void)
+{
+    randomState = randomState * 1103515245u + 12345u;
+
+    return randomState >> 16;
+}
+
+static uint8_t BenchmarkTaskIndex(uKernelTaskDescriptor *pTaskDescriptor)
+{
+    if (api == API_TASKER)
+    {
+        return uKernelGetPoolIndex(pTaskDescriptor);
+    }
+
+    return (uint8_t) (pTaskDescriptor - descriptors);
+}
+
+/**
+ * Body of all the tasks, records the start and moves the clock by the
+ * execution time of the task.
+ */
+static void BenchmarkTask(void)
+{
+    uint64_t hostStart = HostNs();
+    tBenchmarkTask *pTask = &tasks[BenchmarkTaskIndex(uKernelCurrentTask())];
+    uint32_t start = simMicros;
+    uint32_t jitter;
+    uint8_t bucket;
+
+    if (pTask->runs != 0)
+    {
+        jitter = start - pTask->lastStart;
+        jitter = (jitter > pTask->period) ? jitter - pTask->period :
+                pTask->period - jitter;
+
+        for (bucket = 0; bucket < JITTER_BUCKETS - 1; bucket++)
+        {
+            if (jitter < jitterLimits[bucket])
+            {
+                break;
+            }
+        }
+
+        result.jitter[bucket]++;
+    }
+
+    pTask->runs++;
+    pTask->lastStart = start;
+    pTask->nextStart = start + pTask->period;
+    result.dispatches++;
+    simMicros += pTask->cost;
+    _counterMs = simMicros / 1000;
+
+    if ((int32_t) (simMicros - simEnd) >= 0)
+    {
+        longjmp(simExit, 1);
+    }
+
+    excludedNs += HostNs() - hostStart;
+}
+
+/**
+ * Idle hook of the scheduler, moves the clock to the next start.
+ */
+void SimIdle(void)
+{
+    uint64_t hostStart = HostNs();
+    uint32_t next = simMicros + 1000000;
+    uint8_t i;
+
+    for (i = 0; i < numberTasks; i++)
+    {
+        if ((int32_t) (tasks[i].nextStart - next) < 0)
+        {
+            next = tasks[i].nextStart;
+        }
+    }
+
+    //a start already due has to wait for the scheduler to see it
+    if ((int32_t) (next - simMicros) <= 0)
+    {
+        next = simMicros + 1;
+    }
+
+    simMicros = next;
+    _counterMs = simMicros / 1000;
+
+    if ((int32_t) (simMicros - simEnd) >= 0)
+    {
+        longjmp(simExit, 1);
+    }
+
+    excludedNs += HostNs() - hostStart;
+}
+
+static uKernelTaskPriority BenchmarkRateMonotonic(uint32_t period)
+{
+    if (period <= 2000)
+    {
+        return UKERNEL_PRIORITY_REALTIME;
+    }
+    else if (period <= 10000)
+    {
+        return UKERNEL_PRIORITY_HIGH;
+    }
+    else if (period <= 50000)
+    {
+        return UKERNEL_PRIORITY_NORMAL;
+    }
+
+    return UKERNEL_PRIORITY_LOW;
+}
+
+/**
+ * Creates the task set through the API under test.
+ */
+static void BenchmarkAddTasks(uint8_t count, uint8_t load)
+{
+    uint8_t i;
+    uint32_t period;
+
+    randomState = 1;
+    numberTasks = count;
+
+    if (api == API_TASKER)
+    {
+        TaskerBegin();
+    }
+    else
+    {
+        uKernelInit();
+    }
+
+    for (i = 0; i < count; i++)
+    {
+        period = periods[BenchmarkRandom() % (sizeof (periods) / sizeof (periods[0]))];
+        tasks[i].period = period;
+        tasks[i].cost = (uint32_t) ((uint64_t) period * load / (100u * count));
+        tasks[i].lastStart = 0;
+        tasks[i].nextStart = period;
+        tasks[i].runs = 0;
+
+        if (tasks[i].cost == 0)
+        {
+            tasks[i].cost = 1;
+        }
+
+        switch (api)
+        {
+            case API_UKERNEL:
+            case API_UKERNEL_PRIORITIES:
+                tasks[i].descriptor = &descriptors[i];
+                uKernelAddTaskUs(&descriptors[i], BenchmarkTask, period,
+                                 UKERNEL_SCHEDULED);
+                if (api == API_UKERNEL_PRIORITIES)
+                {
+                    uKernelSetTaskPriority(&descriptors[i],
+                                           BenchmarkRateMonotonic(period));
+                }
+                break;
+            case API_PKERNEL:
+                tasks[i].descriptor = &descriptors[i];
+                pKernelAddTask(&descriptors[i], BenchmarkTask, period);
+                break;
+            case API_TASKER:
+                tasks[i].descriptor = TaskerGetTaskDescriptor(
+                        TaskerAddTask(BenchmarkTask, period / 1000, SCHEDULED));
+                break;
+        }
+    }
+}
+
+static void BenchmarkRun(tBenchmarkApi benchmarkApi, uint8_t count,
+                         uint32_t seconds, uint8_t load)
+{
+    uint64_t hostStart;
+    uint8_t i;
+
+    api = benchmarkApi;
+    simMicros = 0;
+    _counterMs = 0;
+    simEnd = seconds * 1000000u;
+    excludedNs = 0;
+    result = (tBenchmarkResult) {0};
+
+    BenchmarkAddTasks(count, load);
+
+    hostStart = HostNs();
+
+    if (setjmp(simExit) == 0)
+    {
+        switch (api)
+        {
+            case API_PKERNEL:
+                pKernelScheduler();
+                break;
+            case API_TASKER:
+                TaskerScheduler();
+                break;
+            default:
+                uKernelScheduler();
+                break;
+        }
+    }
+
+    result.schedulerNs = HostNs() - hostStart - excludedNs;
+
+    for (i = 0; i < count; i++)
+    {
+        result.misses += tasks[i].descriptor->overruns;
+    }
+
+    printf("%-13s %5u %10llu %8.1f %9.1f %7u",
+           apiNames[api], count,
+           (unsigned long long) result.dispatches,
+           result.dispatches ? (double) result.schedulerNs / result.dispatches : 0.0,
+           (double) result.schedulerNs / (seconds * 1000.0),
+           result.misses);
+
+    for (i = 0; i < JITTER_BUCKETS; i++)
+    {
+        printf(" %8u", result.jitter[i]);
+    }
+
+    printf("\n");
+}
+
+int main(int argc, char **argv)
+{
+    static const uint8_t counts[] = {10, 50, 100, 254};
+    uint32_t seconds = BENCHMARK_SECONDS;
+    uint8_t load = BENCHMARK_LOAD;
+    uint8_t i;
+    uint8_t j;
+
+    if (argc > 1)
+    {
+        seconds = (uint32_t) strtoul(argv[1], NULL, 10);
+    }
+
+    if (argc > 2)
+    {
+        load = (uint8_t) strtoul(argv[2], NULL, 10);
+    }
+
+    if ((seconds == 0) || (seconds > 4000) || (load > 100))
+    {
+        fprintf(stderr, "usage: %s [seconds 1-4000] [load %% 0-100]\n", argv[0]);
+        return 1;
+    }
+
+    printf("%u s simulated, %u%% load\n", seconds, load);
+    printf("%-13s %5s %10s %8s %9s %7s %8s %8s %8s %8s %8s %8s\n",
+           "api", "tasks", "dispatches", "ns/disp", "ns/sim-ms", "misses",
+           "jit 0", "<10us", "<100us", "<1ms", "<10ms", ">=10ms");
+
+    for (i = 0; i < sizeof (counts); i++)
+    {
+        for (j = API_UKERNEL; j <= API_TASKER; j++)
+        {
+            BenchmarkRun((tBenchmarkApi) j, counts[i], seconds, load);
+        }
+    }
+
+    return 0;
+}
@@ -0,0 +1,36 @@
+/**
+ *  @file           Simulation.h
+ *  @author         Luis Maduro
+ *  @version        1.0
+ *  @date           14/10/2026
+ *  @copyright		GNU General Public License
+ *
+ *  @brief Configuration of the kernel for the host benchmark.
+ *  It is included before every file (gcc -include Simulation.h), so uKernel
+ *  runs on a simulated microsecond clock instead of a hardware timer, and
+ *  the scheduler moves the clock to the next deadline when it is idle.
+ *  @see Benchmark.c
+ */
+
+#ifndef SIMULATION_H
+#define	SIMULATION_H
+
+#include <stdint.h>
+
+/**As many tasks as the kernel can take.*/
+#define MAX_TASKS_NUMBER            254
+/**The descriptors of Tasker.*/
+#define UKERNEL_STATIC_TASKS
+
+/**Simulated time, in microseconds.*/
+#define UKERNEL_USE_US_TIMEBASE
+#define UKERNEL_TIMEBASE_US()       (simMicros)
+
+/**Nothing is due, jump to the next deadline.*/
+#define UKERNEL_IDLE()              SimIdle()
+
+extern volatile uint32_t simMicros;
+
+void SimIdle(void);
+
+#endif	/* SIMULATION_H */
@@ -10,21 +10,108 @@
  *  Just create a function, create a descriptor for that function and added to 
  *  the scheduler with a period and let the scheduler do the rest. There is no 
  *	priority and I am tring to keep it really simple due to the memory 
- *  limitations of micrcontrollers. The maximum number of task is 255 but I am
+ *  limitations of micrcontrollers. The maximum number of task is 254 but I am
  *  sure that the memory will go out first. If anyone needs more tasks let me know.
  */
  
 #include "uKernel.h"
 
+/**Time used for the deadlines and how many of its ticks make 1 ms.*/
+#ifdef UKERNEL_USE_US_TIMEBASE
+#define UKERNEL_NOW()               UKERNEL_TIMEBASE_US()
+#define UKERNEL_TICKS_PER_MS        1000UL
+#else
+#define UKERNEL_NOW()               _counterMs
+#define UKERNEL_TICKS_PER_MS        1UL
+#endif
+
+#if defined(UKERNEL_USE_TICKLESS) && defined(UKERNEL_USE_CPU_LOAD) && \
+    defined(USE_TASK_STATISTICS) && !defined(TASK_STATISTICS_TICKS_PER_MS)
+#error "uKernel: define TASK_STATISTICS_TICKS_PER_MS for the tickless CPU load"
+#endif
+
 uint8_t _initialized;
-uint32_t _counterMs;
+volatile ACCESS_RAM_KERNEL uint32_t _counterMs;
 uint8_t numberTasks;
-uKernelTaskDescriptor *pTaskSchedule;
-static uKernelTaskDescriptor *pTaskFirst = NULL;
+
+/**Binary min-heap of the scheduled tasks ordered by plannedTask, the next
+ task to be due is always at index 0.*/
+static uKernelTaskDescriptor *taskQueue[MAX_TASKS_NUMBER];
+/**Number of tasks inside taskQueue.*/
+static uint8_t queuedTasks;
+/**First and last task of the ready list of each priority. The tasks that
+ are due wait here, in the order they became due, to be dispatched.*/
+static uKernelTaskDescriptor *readyFirst[UKERNEL_PRIORITY_LEVELS];
+static uKernelTaskDescriptor *readyLast[UKERNEL_PRIORITY_LEVELS];
+/**Bit n is set when the ready list of priority n is not empty.*/
+static ACCESS_RAM_KERNEL uint8_t readyMask;
+/**Tasks signaled by uKernelSignal() waiting to be made ready by the
+ scheduler. signalHead is only written by uKernelSignal() and signalTail
+ only by the scheduler, both run freely.*/
+static uKernelTaskDescriptor *signalQueue[UKERNEL_SIGNAL_QUEUE_SIZE];
+static volatile ACCESS_RAM_KERNEL uint8_t signalHead;
+static volatile ACCESS_RAM_KERNEL uint8_t signalTail;
+/**Task being executed by the scheduler.*/
+static uKernelTaskDescriptor * ACCESS_RAM_KERNEL pTaskCurrent;
+/**Called when a task starts a whole interval or more late.*/
+static void (*overrunHook)(uKernelTaskDescriptor *pTaskDescriptor);
+
+#ifdef UKERNEL_USE_CPU_LOAD
+/**_counterMs at the start of the load window.*/
+static uint32_t loadWindowStart;
+/**Idle time of the window in TASK_STATISTICS_TIMER ticks, or passes of the
+ idle branch.*/
+static uint32_t idleTime;
+#ifdef USE_TASK_STATISTICS
+static uint32_t loadTimerStart;
+/**Length of the last window in TASK_STATISTICS_TIMER ticks.*/
+static uint32_t loadWindowTicks;
+#else
+/**Most passes of the idle branch in a window.*/
+static uint32_t idleBaseline;
+#endif
+/**Load of the last window in tenths of a percent, and its averages over 10
+ and 60 windows shifted by 8 bits.*/
+static uint16_t load1;
+static uint32_t load10;
+static uint32_t load60;
+#endif
+#ifdef UKERNEL_STATIC_TASKS
+/**Descriptors handed out by uKernelCreateTask(). The free ones have no
+ taskPointer and are chained through pTaskNext.*/
+static uKernelTaskDescriptor taskPool[MAX_TASKS_NUMBER];
+static uKernelTaskDescriptor *poolFree;
+#endif
 
 unsigned char uKernelSetTask(uKernelTaskDescriptor *pTaskDescriptor,
                              uint32_t taskInterval,
                              uKernelTaskStatus tStatus);
+static void uKernelQueueInsert(uKernelTaskDescriptor *pTaskDescriptor);
+static void uKernelQueueRemove(uKernelTaskDescriptor *pTaskDescriptor);
+static void uKernelQueueUpdate(uKernelTaskDescriptor *pTaskDescriptor);
+static void uKernelReadyAppend(uKernelTaskDescriptor *pTaskDescriptor);
+static void uKernelReadyRemove(uKernelTaskDescriptor *pTaskDescriptor);
+static void uKernelDetach(uKernelTaskDescriptor *pTaskDescriptor);
+static void uKernelPlanNext(uKernelTaskDescriptor *pTaskDescriptor);
+static void uKernelCollectSignals(void);
+static bool uKernelAddTaskTicks(uKernelTaskDescriptor *pTaskDescriptor,
+                                TaskBody userTask,
+                                uint32_t taskInterval,
+                                uKernelTaskStatus taskStatus,
+                                uKernelTaskPriority priority);
+static bool uKernelModifyTaskTicks(uKernelTaskDescriptor *pTaskDescriptor,
+                                   uint32_t taskInterval,
+                                   uKernelTaskStatus tStatus);
+static uint32_t uKernelMsToTicks(uint32_t ms);
+#ifdef UKERNEL_STATIC_TASKS
+static void uKernelPoolInit(void);
+#endif
+#ifdef UKERNEL_USE_TICKLESS
+static void uKernelIdle(uint32_t sleepMs);
+#endif
+#ifdef UKERNEL_USE_CPU_LOAD
+static void uKernelLoadUpdate(void);
+#endif
 
 /**
  * This funtion as to be called before doing anything with the tasker. It
@@ -33,15 +120,47 @@ unsigned char uKernelSetTask(uKernelTaskDescriptor *pTaskDescriptor,
  */
 void uKernelInit(void)
 {
+    uint8_t i;
+
     _initialized = true;
     _counterMs = 0;
     numberTasks = 0;
-    pTaskSchedule = NULL;
+    queuedTasks = 0;
+    readyMask = 0;
+    signalHead = 0;
+    signalTail = 0;
+    overrunHook = NULL;
+    pTaskCurrent = NULL;
+    for (i = 0; i < UKERNEL_PRIORITY_LEVELS; i++)
+    {
+        readyFirst[i] = NULL;
+        readyLast[i] = NULL;
+    }
+#ifdef UKERNEL_STATIC_TASKS
+    uKernelPoolInit();
+#endif
+#ifdef USE_TASK_STATISTICS
+    TASK_STATISTICS_TIMER_INIT();
+#endif
+#ifdef UKERNEL_USE_CPU_LOAD
+    loadWindowStart = 0;
+    idleTime = 0;
+#ifdef USE_TASK_STATISTICS
+    loadTimerStart = TASK_STATISTICS_TIMER();
+    loadWindowTicks = 0;
+#else
+    idleBaseline = 0;
+#endif
+    load1 = 0;
+    load10 = 0;
+    load60 = 0;
+#endif
 }
 
 /**
- * Add a task into the circular linked list for the scheduler.
- * @param pTaskDescriptor   Descriptor of the task.
+ * Add a task into the deadline queue of the scheduler.
+ * @param pTaskDescriptor   Descriptor of the task. If NULL all tasks are
+ *                          removed from the scheduler.
  * @param userTask          Function pointer on the task body
  * @param taskInterval Scheduled interval in milliseconds at which you want your
  *                     routine to be executed.
@@ -61,75 +180,154 @@ bool uKernelAddTask(uKernelTaskDescriptor *pTaskDescriptor,
                     uint32_t taskInterval,
                     uKernelTaskStatus taskStatus)
 {
-    uKernelTaskDescriptor *pTaskWork = NULL;
+    return uKernelAddTaskPriority(pTaskDescriptor, userTask, taskInterval,
+                                  taskStatus, UKERNEL_PRIORITY_NORMAL);
+}
+
+/**
+ * Add a task with the given priority into the scheduler.
+ * @param pTaskDescriptor   Descriptor of the task. If NULL all tasks are
+ *                          removed from the scheduler.
+ * @param userTask          Function pointer on the task body
+ * @param taskInterval      Scheduled interval in milliseconds.
+ * @param taskStatus        Status of the task, as for uKernelAddTask().
+ * @param priority          Priority of the task. When several tasks are due
+ *                          the one with the highest priority runs first.
+ * @return True or False
+ * @see uKernelAddTask()
+ */
+bool uKernelAddTaskPriority(uKernelTaskDescriptor *pTaskDescriptor,
+                            TaskBody userTask,
+                            uint32_t taskInterval,
+                            uKernelTaskStatus taskStatus,
+                            uKernelTaskPriority priority)
+{
+    return uKernelAddTaskTicks(pTaskDescriptor, userTask,
+                               uKernelMsToTicks(taskInterval), taskStatus,
+                               priority);
+}
 
-    if ((_initialized == false) || (numberTasks == MAX_TASKS_NUMBER)
-            || (userTask == NULL))
+#ifdef UKERNEL_USE_US_TIMEBASE
+/**
+ * Add a task with an interval in microseconds, with the normal priority.
+ * @param pTaskDescriptor   Descriptor of the task.
+ * @param userTask          Function pointer on the task body
+ * @param usInterval        Scheduled interval in microseconds.
+ * @param taskStatus        Status of the task, as for uKernelAddTask().
+ * @return True or False
+ * @see uKernelAddTask()
+ */
+bool uKernelAddTaskUs(uKernelTaskDescriptor *pTaskDescriptor,
+                      TaskBody userTask,
+                      uint32_t usInterval,
+                      uKernelTaskStatus taskStatus)
+{
+    if (pTaskDescriptor == NULL)
     {
         return false;
     }
 
-    if ((taskInterval < 1) || (taskInterval > MAX_TASK_INTERVAL))
-    {
-        taskInterval = 50; //50 ms by default
-    }
+    return uKernelAddTaskTicks(pTaskDescriptor, userTask, usInterval,
+                               taskStatus, UKERNEL_PRIORITY_NORMAL);
+}
+#endif
 
-    //check if taskStatus is valid, if not schedule
-    if (taskStatus > UKERNEL_ONETIME_IMMEDIATESTART)
+/**
+ * Adds a task with the interval in ticks of the timebase.
+ */
+static bool uKernelAddTaskTicks(uKernelTaskDescriptor *pTaskDescriptor,
+                                TaskBody userTask,
+                                uint32_t taskInterval,
+                                uKernelTaskStatus taskStatus,
+                                uKernelTaskPriority priority)
+{
+    uint8_t i;
+
+    if (_initialized == false)
     {
-        taskStatus = UKERNEL_SCHEDULED;
+        return false;
     }
 
-    if (pTaskDescriptor != NULL)
+    if (pTaskDescriptor == NULL)
     {
-        if (pTaskFirst != NULL)
+        // Delete all task of the scheduler
+        while (queuedTasks != 0)
         {
-            // Initialize the work pointer with the scheduler pointer (never mind is current state)
-            pTaskWork = pTaskSchedule;
-            // Research the last task from the circular linked list : so research the adresse of the
-            // first task in testing the pTaskNext fields of each structure
-            while (pTaskWork->pTaskNext != pTaskFirst)
-            {
-                // Set the work pointer on the next task
-                pTaskWork = pTaskWork->pTaskNext;
-            }
-            pTaskWork->pTaskNext = pTaskDescriptor; // Insert the new task at the end of the circular linked list
-
-            pTaskDescriptor->pTaskNext = pTaskFirst; // The next task is feedback at the first task
+            uKernelQueueRemove(taskQueue[0]);
         }
-        else
+        for (i = 0; i < UKERNEL_PRIORITY_LEVELS; i++)
         {
-            // There is no task in the scheduler, this task become the First task in the circular linked list
-            pTaskFirst = pTaskDescriptor; // The pTaskFirst pointer is initialize with the first task of the scheduler
-            pTaskSchedule = pTaskFirst; // Initialize the scheduler pointer at the first task
-            pTaskDescriptor->pTaskNext = pTaskDescriptor; // The next task is itself because there is just one task in the circular linked list
+            while (readyFirst[i] != NULL)
+            {
+                uKernelReadyRemove(readyFirst[i]);
+            }
         }
-        // Common initialization for all tasks
-        // no wait if the user wants the task up and running once added...
-        //...otherwise we wait for the interval before to run the task
-        pTaskDescriptor->plannedTask =
-                _counterMs + ((taskStatus & 0x04) ? 0 : taskInterval);
+        numberTasks = 0;
+#ifdef UKERNEL_STATIC_TASKS
+        uKernelPoolInit();
+#endif
 
-        // Set the periodicity of the task
-        pTaskDescriptor->userTasksInterval = taskInterval;
-        // Set the task pointer on the task body
-        pTaskDescriptor->taskPointer = userTask;
-        //I get only the first 2 bits - I don't need the IMMEDIATESTART bit
-        pTaskDescriptor->taskStatus = taskStatus & 0x03;
+        return true;
+    }
 
-        numberTasks++;
+    if (priority >= UKERNEL_PRIORITY_LEVELS)
+    {
+        priority = UKERNEL_PRIORITY_LEVELS - 1;
+    }
 
-        return true;
+    if ((numberTasks == MAX_TASKS_NUMBER) || (userTask == NULL))
+    {
+        return false;
     }
-    else
+
+    //check if taskStatus is valid, if not schedule
+    if ((taskStatus > UKERNEL_ONETIME_IMMEDIATESTART) &&
+            (taskStatus != UKERNEL_EVENT) &&
+            (taskStatus != UKERNEL_EVENT_IMMEDIATESTART))
     {
-        // Delete all task of the scheduler
-        // This case is necessary at the time of the call of the function DeleteAllTask()
-        pTaskFirst = NULL;
-        pTaskSchedule = NULL;
+        taskStatus = UKERNEL_SCHEDULED;
+    }
 
-        return true;
+    if (((taskInterval < 1) && !(taskStatus & UKERNEL_EVENT)) ||
+            (taskInterval > MAX_TASK_INTERVAL * UKERNEL_TICKS_PER_MS))
+    {
+        taskInterval = 50 * UKERNEL_TICKS_PER_MS; //50 ms by default
+    }
+
+    // no wait if the user wants the task up and running once added...
+    //...otherwise we wait for the interval before to run the task
+    pTaskDescriptor->plannedTask =
+            UKERNEL_NOW() + ((taskStatus & 0x04) ? 0 : taskInterval);
+
+    // Set the periodicity of the task
+    pTaskDescriptor->userTasksInterval = taskInterval;
+    // Set the task pointer on the task body
+    pTaskDescriptor->taskPointer = userTask;
+    //I don't need the IMMEDIATESTART bit
+    pTaskDescriptor->taskStatus = taskStatus & 0x0B;
+    pTaskDescriptor->priority = priority;
+    pTaskDescriptor->policy = UKERNEL_POLICY_DRIFT;
+    pTaskDescriptor->overruns = 0;
+    pTaskDescriptor->signaled = false;
+    pTaskDescriptor->continuation = 0;
+    pTaskDescriptor->queueIndex = UKERNEL_NOT_QUEUED;
+    pTaskDescriptor->pTaskNext = NULL;
+#ifdef USE_TASK_STATISTICS
+    TaskStatisticsReset(&pTaskDescriptor->statistics);
+#endif
+
+    if (taskStatus & 0x04)
+    {
+        uKernelQueueInsert(pTaskDescriptor);
+    }
+    else
+    {
+        uKernelQueueUpdate(pTaskDescriptor);
     }
+
+    numberTasks++;
+
+    return true;
 }
 
 /**
@@ -139,31 +337,14 @@ bool uKernelAddTask(uKernelTaskDescriptor *pTaskDescriptor,
  */
 bool uKernelRemoveTask(uKernelTaskDescriptor *pTaskDescriptor)
 {
-    uKernelTaskDescriptor *pTaskCurr = NULL;
-
     if ((_initialized == false) || (numberTasks == 0) ||
             pTaskDescriptor == NULL)
     {
         return false;
     }
 
-    // Initialize the work pointer with the scheduler pointer (never mind is current state)
-    pTaskCurr = pTaskFirst;
-
-    while (pTaskCurr->pTaskNext != pTaskDescriptor)
-    {
-        // Set the work pointer on the next task
-        pTaskCurr = pTaskCurr->pTaskNext;
-    }
-
-    if (pTaskCurr->pTaskNext == pTaskFirst)
-    {
-        pTaskFirst = pTaskCurr->pTaskNext->pTaskNext;
-    }
-    else
-    {
-        pTaskCurr->pTaskNext = pTaskDescriptor->pTaskNext;
-    }
+    uKernelDetach(pTaskDescriptor);
+    pTaskDescriptor->taskStatus = UKERNEL_PAUSED;
 
     numberTasks--;
 
@@ -177,7 +358,7 @@ bool uKernelRemoveTask(uKernelTaskDescriptor *pTaskDescriptor)
  */
 bool uKernelPauseTask(uKernelTaskDescriptor *pTaskDescriptor)
 {
-    return (uKernelSetTask(pTaskDescriptor, NULL, UKERNEL_PAUSED));
+    return (uKernelSetTask(pTaskDescriptor, 0, UKERNEL_PAUSED));
 }
 
 /**
@@ -187,11 +368,11 @@ bool uKernelPauseTask(uKernelTaskDescriptor *pTaskDescriptor)
  */
 bool uKernelResumeTask(uKernelTaskDescriptor *pTaskDescriptor)
 {
-    return (uKernelSetTask(pTaskDescriptor, NULL, UKERNEL_SCHEDULED));
+    return (uKernelSetTask(pTaskDescriptor, 0, UKERNEL_SCHEDULED));
 }
 
 /**
- * Add a task into the circular linked list for the scheduler.
+ * Modify the interval and the status of a task already in the scheduler.
  * @param pTaskDescriptor   Descriptor of the task.
  * @param taskInterval Scheduled interval in milliseconds at which you want your
  *                     routine to be executed.
@@ -210,29 +391,211 @@ bool uKernelModifyTask(uKernelTaskDescriptor *pTaskDescriptor,
                           uint32_t taskInterval,
                           uKernelTaskStatus tStatus)
 {
-    if ((_initialized == false) || (numberTasks == MAX_TASKS_NUMBER)
-            || (pTaskDescriptor == NULL))
+    return uKernelModifyTaskTicks(pTaskDescriptor,
+                                  uKernelMsToTicks(taskInterval), tStatus);
+}
+
+#ifdef UKERNEL_USE_US_TIMEBASE
+/**
+ * Modify the interval, in microseconds, and the status of a task already in
+ * the scheduler.
+ * @param pTaskDescriptor   Descriptor of the task.
+ * @param usInterval        Scheduled interval in microseconds.
+ * @param tStatus           Status of the task, as for uKernelModifyTask().
+ * @return True or False
+ * @see uKernelModifyTask()
+ */
+bool uKernelModifyTaskUs(uKernelTaskDescriptor *pTaskDescriptor,
+                         uint32_t usInterval,
+                         uKernelTaskStatus tStatus)
+{
+    return uKernelModifyTaskTicks(pTaskDescriptor, usInterval, tStatus);
+}
+#endif
+
+/**
+ * Modifies a task with the interval in ticks of the timebase.
+ */
+static bool uKernelModifyTaskTicks(uKernelTaskDescriptor *pTaskDescriptor,
+                                   uint32_t taskInterval,
+                                   uKernelTaskStatus tStatus)
+{
+    if ((_initialized == false) || (pTaskDescriptor == NULL))
     {
         return false;
     }
 
-    if (tStatus > UKERNEL_ONETIME_IMMEDIATESTART)
+    if ((tStatus > UKERNEL_ONETIME_IMMEDIATESTART) &&
+            (tStatus != UKERNEL_EVENT) &&
+            (tStatus != UKERNEL_EVENT_IMMEDIATESTART))
     {
         return false;
     }
 
     pTaskDescriptor->userTasksInterval = taskInterval;
-    pTaskDescriptor->taskStatus = tStatus;
+    pTaskDescriptor->taskStatus = tStatus & 0x0B;
+    pTaskDescriptor->plannedTask =
+            UKERNEL_NOW() + ((tStatus & 0x04) ? 0 : taskInterval);
+
+    if (tStatus & 0x04)
+    {
+        uKernelDetach(pTaskDescriptor);
+        uKernelQueueInsert(pTaskDescriptor);
+    }
+    else
+    {
+        uKernelQueueUpdate(pTaskDescriptor);
+    }
+
+    return true;
+}
+
+/**
+ * Changes the priority of a task. If the task is already due it is put at
+ * the end of the ready list of its new priority.
+ * @param pTaskDescriptor Descriptor of the task.
+ * @param priority New priority of the task.
+ * @return Return true if all went well, false otherwise.
+ */
+bool uKernelSetTaskPriority(uKernelTaskDescriptor *pTaskDescriptor,
+                            uKernelTaskPriority priority)
+{
+    if ((_initialized == false) || (pTaskDescriptor == NULL) ||
+            (priority >= UKERNEL_PRIORITY_LEVELS))
+    {
+        return false;
+    }
 
-    if (tStatus == UKERNEL_SCHEDULED || tStatus == UKERNEL_ONETIME)
+    if (pTaskDescriptor->queueIndex == UKERNEL_READY)
     {
-        pTaskDescriptor->plannedTask = _counterMs + taskInterval;
+        uKernelReadyRemove(pTaskDescriptor);
+        pTaskDescriptor->priority = priority;
+        uKernelReadyAppend(pTaskDescriptor);
     }
     else
     {
-        pTaskDescriptor->plannedTask = 0;
+        pTaskDescriptor->priority = priority;
+    }
+
+    return true;
+}
+
+/**
+ * Chooses what a periodic task does when it starts late.
+ * @param pTaskDescriptor Descriptor of the task.
+ * @param policy UKERNEL_POLICY_DRIFT, UKERNEL_POLICY_SKIP or
+ *               UKERNEL_POLICY_CATCHUP.
+ * @return Return true if all went well, false otherwise.
+ */
+bool uKernelSetTaskPolicy(uKernelTaskDescriptor *pTaskDescriptor,
+                          uKernelTaskPolicy policy)
+{
+    if ((_initialized == false) || (pTaskDescriptor == NULL) ||
+            (policy > UKERNEL_POLICY_CATCHUP))
+    {
+        return false;
+    }
+
+    pTaskDescriptor->policy = policy;
+
+    return true;
+}
+
+/**
+ * Sets the function called, before the task runs, every time a task starts
+ * a whole interval or more late.
+ * @param hook Function to be called with the descriptor of the late task, or
+ *             NULL to remove it.
+ */
+void uKernelSetOverrunHook(void (*hook)(uKernelTaskDescriptor *pTaskDescriptor))
+{
+    overrunHook = hook;
+}
+
+/**
+ * Wakes up an UKERNEL_EVENT task, that will run as soon as possible according
+ * to its priority. Can be called from an interrupt routine or from another
+ * task. Signals that arrive before the task runs count as one.
+ * @param pTaskDescriptor Descriptor of the task to be signaled.
+ * @return Return false if the signal queue is full, true otherwise.
+ */
+bool uKernelSignal(uKernelTaskDescriptor *pTaskDescriptor)
+{
+    uint8_t head;
+
+    UKERNEL_ENTER_CRITICAL();
+
+    if (pTaskDescriptor->signaled)
+    {
+        UKERNEL_EXIT_CRITICAL();
+        return true; //already on its way
+    }
+
+    head = signalHead;
+
+    if ((uint8_t) (head - signalTail) == UKERNEL_SIGNAL_QUEUE_SIZE)
+    {
+        UKERNEL_EXIT_CRITICAL();
+        return false;
+    }
+
+    pTaskDescriptor->signaled = true;
+    signalQueue[head & (UKERNEL_SIGNAL_QUEUE_SIZE - 1)] = pTaskDescriptor;
+    signalHead = head + 1;
+
+    UKERNEL_EXIT_CRITICAL();
+
+    return true;
+}
+
+/**
+ * Tells if signals wait to be collected by the scheduler, for the tickless
+ * port to check with the interrupts disabled before it sleeps.
+ * @return True if uKernelSignal() was called since the last collection.
+ */
+bool uKernelSignalsPending(void)
+{
+    return signalHead != signalTail;
+}
+
+/**
+ * Gives the descriptor of the task that is running, so that a task body
+ * (which has no arguments) can reach its own descriptor.
+ * @return Descriptor of the running task, NULL outside of a task.
+ */
+uKernelTaskDescriptor *uKernelCurrentTask(void)
+{
+    return pTaskCurrent;
+}
+
+/**
+ * Delay that doesn't block the other tasks: called from a task body, it
+ * makes the task run again once, delay ms from now, and then go on with its
+ * normal schedule. The body has to return to the scheduler right after,
+ * which is what UKERNEL_CR_DELAY() does in a coroutine. A one-time task
+ * (paused while it runs) runs one more time.
+ * @param delay Milliseconds until the task runs again.
+ * @return Return false if not called from a task, true otherwise.
+ */
+bool uKernelTaskDelay(uint32_t delay)
+{
+    uKernelTaskDescriptor *pTaskDescriptor = pTaskCurrent;
+
+    if (pTaskDescriptor == NULL)
+    {
+        return false;
+    }
+
+    if (pTaskDescriptor->taskStatus == UKERNEL_PAUSED)
+    {
+        pTaskDescriptor->taskStatus = UKERNEL_ONETIME;
     }
 
+    pTaskDescriptor->plannedTask = UKERNEL_NOW() + uKernelMsToTicks(delay);
+    // even an event task without timeout has to wait in the deadline queue
+    uKernelDetach(pTaskDescriptor);
+    uKernelQueueInsert(pTaskDescriptor);
+
     return true;
 }
 
@@ -247,8 +610,7 @@ bool uKernelModifyTask(uKernelTaskDescriptor *pTaskDescriptor,
  */
 uKernelTaskStatus uKernelGetTaskStatus(uKernelTaskDescriptor *pTaskDescriptor)
 {
-    if ((_initialized == false) || (numberTasks == MAX_TASKS_NUMBER)
-            || (pTaskDescriptor == NULL))
+    if ((_initialized == false) || (pTaskDescriptor == NULL))
     {
         return UKERNEL_ERROR;
     }
@@ -257,61 +619,477 @@ uKernelTaskStatus uKernelGetTaskStatus(uKernelTaskDescriptor *pTaskDescriptor)
 }
 
 /**
- * Scheduling. This runs the kernel itself.
+ * Scheduling. This runs the kernel itself. Only the top of the deadline queue
+ * is checked, so the cost of a pass doesn't depend on the number of tasks.
+ * The tasks that are due go to the ready list of their priority and the
+ * first task of the highest priority ready list is the next to run.
  */
 void uKernelScheduler(void)
 {
+    uKernelTaskDescriptor *pTaskSchedule;
+    uint8_t priority;
+#ifdef USE_TASK_STATISTICS
+    uint32_t startLatency, startTime;
+#endif
+
     while (1)
     {
-        if (pTaskSchedule != NULL && numberTasks != 0)
+#ifdef UKERNEL_USE_CPU_LOAD
+        uKernelLoadUpdate();
+#endif
+
+#ifdef USE_DEFERRED_WORK
+        // the work posted by the interrupts goes before any task
+        DeferredWorkRun();
+#endif
+
+        uKernelCollectSignals();
+
+        //this trick overrun the overflow of the timebase
+        while ((queuedTasks != 0) &&
+                ((int32_t) (UKERNEL_NOW() - taskQueue[0]->plannedTask) >= 0))
         {
-            //the task is running
-            if (pTaskSchedule->taskStatus > UKERNEL_PAUSED)
-            {
-                //this trick overrun the overflow of _counterMs
-                if ((long) (_counterMs - pTaskSchedule->plannedTask) >= 0)
-                {
-                    if (pTaskSchedule->taskStatus & UKERNEL_ONETIME)
-                    {
-                        pTaskSchedule->taskPointer(); //call the task
-                        pTaskSchedule->taskStatus = UKERNEL_PAUSED; //pause the task
-                    }
-                    else
-                    {
-                        //let's schedule next start
-                        pTaskSchedule->plannedTask =
-                                _counterMs + pTaskSchedule->userTasksInterval;
-
-                        pTaskSchedule->taskPointer(); //call the task
-                    }
-                }
-            }
-            // If a task has called the function DeleteAllTask() and if no
-            // task are added, the pointer is null
-            if (pTaskSchedule != NULL)
-            {
-                // Set the scheduler pointer on the next task
-                pTaskSchedule = pTaskSchedule->pTaskNext;
-            }
+            pTaskSchedule = taskQueue[0];
+            uKernelQueueRemove(pTaskSchedule);
+            uKernelReadyAppend(pTaskSchedule);
+        }
+
+        if (readyMask == 0)
+        {
+#if defined(UKERNEL_USE_CPU_LOAD) && defined(USE_TASK_STATISTICS)
+            startTime = TASK_STATISTICS_TIMER();
+#endif
+#ifdef UKERNEL_USE_TICKLESS
+            uKernelIdle(uKernelTimeToNextTask());
+#endif
+            UKERNEL_IDLE();
+#ifdef UKERNEL_USE_CPU_LOAD
+#ifdef USE_TASK_STATISTICS
+            idleTime += TASK_STATISTICS_TIMER() - startTime;
+#else
+            idleTime++;
+#endif
+#endif
+            continue;
+        }
+
+        priority = UKERNEL_PRIORITY_LEVELS - 1;
+
+        while ((readyMask & (1 << priority)) == 0)
+        {
+            priority--;
+        }
+
+        pTaskSchedule = readyFirst[priority];
+        uKernelReadyRemove(pTaskSchedule);
+
+#ifdef USE_TASK_STATISTICS
+        //a signaled event task can run before it was planned, no latency
+        startLatency = UKERNEL_NOW() - pTaskSchedule->plannedTask;
+        if ((int32_t) startLatency < 0)
+        {
+            startLatency = 0;
+        }
+#endif
+
+        if (pTaskSchedule->taskStatus & UKERNEL_ONETIME)
+        {
+            pTaskSchedule->taskStatus = UKERNEL_PAUSED; //pause the task
+        }
+        else if (pTaskSchedule->taskStatus & UKERNEL_EVENT)
+        {
+            //wait for the next signal or the timeout
+            pTaskSchedule->plannedTask =
+                    UKERNEL_NOW() + pTaskSchedule->userTasksInterval;
+            uKernelQueueUpdate(pTaskSchedule);
         }
+        else
+        {
+            //let's schedule next start
+            uKernelPlanNext(pTaskSchedule);
+            uKernelQueueInsert(pTaskSchedule);
+        }
+
+#ifdef USE_TASK_STATISTICS
+        startTime = TASK_STATISTICS_TIMER();
+#endif
+        pTaskCurrent = pTaskSchedule;
+        TRACE_TASK_BEGIN(pTaskSchedule->taskPointer);
+        pTaskSchedule->taskPointer(); //call the task
+        TRACE_TASK_END(pTaskSchedule->taskPointer);
+        pTaskCurrent = NULL;
+#ifdef USE_TASK_STATISTICS
+        TaskStatisticsUpdate(&pTaskSchedule->statistics, startTime,
+                             TASK_STATISTICS_TIMER(), startLatency);
+#endif
+    }
+}
+
+/**
+ * Time left until the next task is due.
+ * @return Milliseconds until the task at the top of the deadline queue has to
+ *         run, 0 if a task is already due, MAX_TASK_INTERVAL if there is none.
+ */
+uint32_t uKernelTimeToNextTask(void)
+{
+    int32_t remaining;
+
+    if ((readyMask != 0) || (signalHead != signalTail))
+    {
+        return 0;
+    }
+
+#ifdef USE_DEFERRED_WORK
+    if (DeferredWorkPending())
+    {
+        return 0;
+    }
+#endif
+
+    if (queuedTasks == 0)
+    {
+        return MAX_TASK_INTERVAL;
+    }
+
+    remaining = (int32_t) (taskQueue[0]->plannedTask - UKERNEL_NOW());
+
+    return (remaining > 0) ? (uint32_t) remaining / UKERNEL_TICKS_PER_MS : 0;
+}
+
+#ifdef UKERNEL_STATIC_TASKS
+/**
+ * Takes a descriptor from the static pool and adds its task to the
+ * scheduler, with the normal priority.
+ * @param userTask          Function pointer on the task body
+ * @param taskInterval      Scheduled interval in milliseconds.
+ * @param taskStatus        Status of the task, as for uKernelAddTask().
+ * @return Descriptor of the task, NULL if the pool is empty or the task
+ *         could not be added.
+ */
+uKernelTaskDescriptor *uKernelCreateTask(TaskBody userTask,
+                                         uint32_t taskInterval,
+                                         uKernelTaskStatus taskStatus)
+{
+    uKernelTaskDescriptor *pTaskDescriptor = poolFree;
+    uKernelTaskDescriptor *pTaskNextFree;
+
+    if ((_initialized == false) || (pTaskDescriptor == NULL))
+    {
+        return NULL;
+    }
+
+    // uKernelAddTask() uses pTaskNext, but doesn't touch a descriptor it refuses
+    pTaskNextFree = pTaskDescriptor->pTaskNext;
+
+    if (!uKernelAddTask(pTaskDescriptor, userTask, taskInterval, taskStatus))
+    {
+        return NULL;
+    }
+
+    poolFree = pTaskNextFree;
+
+    return pTaskDescriptor;
+}
+
+/**
+ * Removes from the scheduler a task made by uKernelCreateTask() and gives
+ * its descriptor back to the pool.
+ * @param pTaskDescriptor Descriptor of the task.
+ * @return Return true if all went well, false otherwise.
+ */
+bool uKernelDeleteTask(uKernelTaskDescriptor *pTaskDescriptor)
+{
+    if ((pTaskDescriptor == NULL) || (pTaskDescriptor < &taskPool[0]) ||
+            (pTaskDescriptor >= &taskPool[MAX_TASKS_NUMBER]) ||
+            (pTaskDescriptor->taskPointer == NULL))
+    {
+        return false;
+    }
+
+    if (!uKernelRemoveTask(pTaskDescriptor))
+    {
+        return false;
+    }
+
+    pTaskDescriptor->taskPointer = NULL;
+    pTaskDescriptor->pTaskNext = poolFree;
+    poolFree = pTaskDescriptor;
+
+    return true;
+}
+
+/**
+ * Gives a descriptor of the static pool by its position. O(1).
+ * @param index Position in the pool, from 0 to MAX_TASKS_NUMBER - 1.
+ * @return Descriptor at that position, NULL if it is free or out of range.
+ */
+uKernelTaskDescriptor *uKernelGetPoolTask(uint8_t index)
+{
+    if ((index >= MAX_TASKS_NUMBER) || (taskPool[index].taskPointer == NULL))
+    {
+        return NULL;
     }
+
+    return &taskPool[index];
+}
+
+/**
+ * Position of a descriptor inside the static pool.
+ * @param pTaskDescriptor Descriptor given by uKernelCreateTask().
+ * @return Position in the pool.
+ */
+uint8_t uKernelGetPoolIndex(uKernelTaskDescriptor *pTaskDescriptor)
+{
+    return (uint8_t) (pTaskDescriptor - taskPool);
+}
+
+/**
+ * Marks all the descriptors of the pool as free.
+ */
+static void uKernelPoolInit(void)
+{
+    uint8_t i;
+
+    poolFree = NULL;
+
+    for (i = MAX_TASKS_NUMBER; i > 0; i--)
+    {
+        taskPool[i - 1].taskPointer = NULL;
+        taskPool[i - 1].pTaskNext = poolFree;
+        poolFree = &taskPool[i - 1];
+    }
+}
+#endif
+
+#ifdef UKERNEL_USE_TICKLESS
+/**
+ * Sleeps until the next task is due, or until an interrupt wakes the
+ * microcontroller, and puts _counterMs right again.
+ * @param sleepMs Time until the next task is due.
+ */
+static void uKernelIdle(uint32_t sleepMs)
+{
+    uint32_t sleptMs;
+#if defined(UKERNEL_USE_CPU_LOAD) && defined(USE_TASK_STATISTICS)
+    uint32_t start, lost;
+#endif
+
+    if (sleepMs < UKERNEL_TICKLESS_MIN_SLEEP)
+    {
+        return;
+    }
+
+#if defined(UKERNEL_USE_CPU_LOAD) && defined(USE_TASK_STATISTICS)
+    start = TASK_STATISTICS_TIMER();
+#endif
+    sleptMs = uKernelPortSleep(sleepMs);
+    _counterMs += sleptMs;
+    uKernelPortResumeTick();
+
+#if defined(UKERNEL_USE_CPU_LOAD) && defined(USE_TASK_STATISTICS)
+    //the timer can stop in the sleep (DWT_CYCCNT in STOP mode), the time it
+    //missed is idle and also lengthens the window
+    lost = sleptMs * TASK_STATISTICS_TICKS_PER_MS
+            - (TASK_STATISTICS_TIMER() - start);
+    if ((int32_t) lost > 0)
+    {
+        idleTime += lost;
+        loadTimerStart -= lost;
+    }
+#endif
+}
+#endif
+
+#ifdef UKERNEL_USE_CPU_LOAD
+/**
+ * Gives part / whole in tenths of a percent without overflow.
+ */
+static uint16_t uKernelPerMille(uint32_t part, uint32_t whole)
+{
+    if (part >= whole)
+    {
+        return (whole == 0) ? 0 : 1000;
+    }
+
+    if (part < 4294967UL)
+    {
+        return (uint16_t) (part * 1000 / whole);
+    }
+
+    return (uint16_t) (part / (whole / 1000));
+}
+
+/**
+ * Closes the load window once UKERNEL_LOAD_WINDOW_MS have elapsed and
+ * updates the averages.
+ */
+static void uKernelLoadUpdate(void)
+{
+#ifdef USE_TASK_STATISTICS
+    uint32_t now;
+#endif
+
+    if ((uint32_t) (_counterMs - loadWindowStart) < UKERNEL_LOAD_WINDOW_MS)
+    {
+        return;
+    }
+
+    loadWindowStart = _counterMs;
+#ifdef USE_TASK_STATISTICS
+    now = TASK_STATISTICS_TIMER();
+    loadWindowTicks = now - loadTimerStart;
+    loadTimerStart = now;
+    load1 = 1000 - uKernelPerMille(idleTime, loadWindowTicks);
+    TaskStatisticsNextWindow();
+#else
+    if (idleTime > idleBaseline)
+    {
+        idleBaseline = idleTime;
+    }
+
+    load1 = 1000 - uKernelPerMille(idleTime, idleBaseline);
+#endif
+    idleTime = 0;
+
+    load10 = (uint32_t) ((int32_t) load10
+            + ((int32_t) ((uint32_t) load1 << 8) - (int32_t) load10) / 10);
+    load60 = (uint32_t) ((int32_t) load60
+            + ((int32_t) ((uint32_t) load1 << 8) - (int32_t) load60) / 60);
+}
+
+/**
+ * Gives the load of the CPU, the time spent out of the idle branch of the
+ * scheduler: in the tasks, the deferred work and the scheduling itself.
+ * @param window The last window or an average.
+ * @return Load in tenths of a percent, 0 to 1000.
+ */
+uint16_t uKernelGetCpuLoad(uKernelLoadWindow window)
+{
+    switch (window)
+    {
+        case UKERNEL_LOAD_1S:
+            return load1;
+        case UKERNEL_LOAD_10S:
+            return (uint16_t) ((load10 + 128) >> 8);
+        default:
+            return (uint16_t) ((load60 + 128) >> 8);
+    }
+}
+
+#ifdef USE_TASK_STATISTICS
+/**
+ * Gives the share of the CPU a task took in the last load window.
+ * @param pTaskDescriptor Descriptor of the task.
+ * @return Load in tenths of a percent, 0 to 1000.
+ */
+uint16_t uKernelGetTaskLoad(uKernelTaskDescriptor *pTaskDescriptor)
+{
+    if (pTaskDescriptor == NULL)
+    {
+        return 0;
+    }
+
+    return uKernelPerMille(TaskStatisticsGetWindowRunTime(&pTaskDescriptor->statistics),
+                           loadWindowTicks);
+}
+#else
+/**
+ * Sets the passes of the idle branch of a window without any task, measured
+ * once on the target. The baseline still goes up if a window counts more.
+ * @param passes Passes in UKERNEL_LOAD_WINDOW_MS.
+ */
+void uKernelSetIdleBaseline(uint32_t passes)
+{
+    idleBaseline = passes;
 }
+#endif
+#endif
 
+#ifdef UKERNEL_USE_US_TIMEBASE
 /**
- * Just a simple delay in miliseconds. Not related to the Tasker system.
+ * Reads the microsecond timebase of the scheduler.
+ * @return Microseconds, wraps at 2^32.
+ */
+uint32_t uKernelMicros(void)
+{
+    return UKERNEL_NOW();
+}
+
+/**
+ * Busy waits on the microsecond timebase, for the short delays of the
+ * bit-banged protocols. Not related to the Tasker system.
+ * @param delay Microseconds to wait, less than 2^31.
+ */
+void uKernelDelayMicroseconds(uint32_t delay)
+{
+    uint32_t start = UKERNEL_NOW();
+
+    while ((uint32_t) (UKERNEL_NOW() - start) < delay);
+}
+
+#ifdef UKERNEL_SYSTICK_TIMEBASE
+/**SysTick registers of the ARMv7-M core.*/
+#define SYST_RVR                    (*(volatile uint32_t *) 0xE000E014UL)
+#define SYST_CVR                    (*(volatile uint32_t *) 0xE000E018UL)
+
+/**
+ * Microseconds from the millisecond count and the SysTick counter, that
+ * counts down from SYST_RVR to 0 every millisecond. _counterMs * 1000 wraps
+ * at 2^32 like the result, so this is a true 32-bit counter. The SysTick
+ * interrupt must not be masked while it is read.
+ * @return Microseconds, wraps at 2^32.
+ */
+uint32_t uKernelSysTickMicros(void)
+{
+    uint32_t ms, count, reload;
+
+    // read again if the tick came in between
+    do
+    {
+        ms = _counterMs;
+        count = SYST_CVR;
+    }
+    while (ms != _counterMs);
+
+    reload = SYST_RVR + 1;
+
+    return (ms * 1000UL) + (((reload - 1 - count) * 1000UL) / reload);
+}
+#endif
+#endif
+
+/**
+ * Just a simple delay in miliseconds. Not related to the Tasker system. It
+ * blocks all the tasks, use uKernelTaskDelay() inside a task.
  */
 void uKernelDelayMiliseconds(unsigned int delay)
 {
-    unsigned long newTime = _counterMs + delay;
-    while (_counterMs < newTime);
+    uint32_t start = _counterMs;
+
+    //this trick overrun the overflow of _counterMs
+    while ((uint32_t) (_counterMs - start) < delay);
+}
+
+/**
+ * Converts an interval in ms to ticks of the timebase.
+ */
+static uint32_t uKernelMsToTicks(uint32_t ms)
+{
+#ifdef UKERNEL_USE_US_TIMEBASE
+    if (ms > MAX_TASK_INTERVAL)
+    {
+        return UINT32_MAX; //would overflow, and it is not valid anyway
+    }
+#endif
+
+    return ms * UKERNEL_TICKS_PER_MS;
 }
 
 unsigned char uKernelSetTask(uKernelTaskDescriptor *pTaskDescriptor,
                              uint32_t taskInterval,
                              uKernelTaskStatus tStatus)
 {
-    if ((_initialized == false) || (numberTasks == MAX_TASKS_NUMBER)
-            || (pTaskDescriptor == NULL))
+    if ((_initialized == false) || (pTaskDescriptor == NULL))
     {
         return false;
     }
@@ -320,17 +1098,299 @@ unsigned char uKernelSetTask(uKernelTaskDescriptor *pTaskDescriptor,
 
     if (tStatus == UKERNEL_SCHEDULED)
     {
-        if (taskInterval == NULL)
+        if (taskInterval == 0)
         {
             pTaskDescriptor->plannedTask =
-                    _counterMs + pTaskDescriptor->userTasksInterval;
+                    UKERNEL_NOW() + pTaskDescriptor->userTasksInterval;
         }
         else
         {
             pTaskDescriptor->plannedTask =
-                    _counterMs + taskInterval;
+                    UKERNEL_NOW() + taskInterval;
         }
     }
-    
+
+    uKernelQueueUpdate(pTaskDescriptor);
+
     return true;
 }
+
+/**
+ * Calculates the next start of a periodic task that is about to run,
+ * according to its policy, and accounts the overruns.
+ */
+static void uKernelPlanNext(uKernelTaskDescriptor *pTaskDescriptor)
+{
+    uint32_t interval = pTaskDescriptor->userTasksInterval;
+    uint32_t now = UKERNEL_NOW();
+    uint32_t late = now - pTaskDescriptor->plannedTask;
+
+    if (interval == 0)
+    {
+        pTaskDescriptor->plannedTask = now;
+        return;
+    }
+
+    if (late >= interval)
+    {
+        pTaskDescriptor->overruns++;
+
+        if (overrunHook != NULL)
+        {
+            overrunHook(pTaskDescriptor);
+        }
+    }
+
+    switch (pTaskDescriptor->policy)
+    {
+        case UKERNEL_POLICY_SKIP:
+            pTaskDescriptor->plannedTask += ((late / interval) + 1) * interval;
+            break;
+        case UKERNEL_POLICY_CATCHUP:
+            pTaskDescriptor->plannedTask += interval;
+            break;
+        default:
+            pTaskDescriptor->plannedTask = now + interval;
+            break;
+    }
+}
+
+/**
+ * Tells if task a is due before task b, taking care of the overflow of
+ * the timebase.
+ */
+static bool uKernelQueueBefore(uKernelTaskDescriptor *a,
+                               uKernelTaskDescriptor *b)
+{
+    return ((int32_t) (a->plannedTask - b->plannedTask) < 0);
+}
+
+static void uKernelQueuePlace(uint8_t index, uKernelTaskDescriptor *pTask)
+{
+    taskQueue[index] = pTask;
+    pTask->queueIndex = index;
+}
+
+/**
+ * Moves the task at index up until its parent is due before it.
+ */
+static void uKernelQueueSiftUp(uint8_t index)
+{
+    uKernelTaskDescriptor *pTask = taskQueue[index];
+    uint8_t parent;
+
+    while (index > 0)
+    {
+        parent = (index - 1) >> 1;
+
+        if (!uKernelQueueBefore(pTask, taskQueue[parent]))
+        {
+            break;
+        }
+
+        uKernelQueuePlace(index, taskQueue[parent]);
+        index = parent;
+    }
+
+    uKernelQueuePlace(index, pTask);
+}
+
+/**
+ * Moves the task at index down until its children are due after it.
+ */
+static void uKernelQueueSiftDown(uint8_t index)
+{
+    uKernelTaskDescriptor *pTask = taskQueue[index];
+    uint16_t child;
+
+    while ((child = ((uint16_t) index << 1) + 1) < queuedTasks)
+    {
+        if ((child + 1 < queuedTasks) &&
+                uKernelQueueBefore(taskQueue[child + 1], taskQueue[child]))
+        {
+            child++;
+        }
+
+        if (!uKernelQueueBefore(taskQueue[child], pTask))
+        {
+            break;
+        }
+
+        uKernelQueuePlace(index, taskQueue[child]);
+        index = (uint8_t) child;
+    }
+
+    uKernelQueuePlace(index, pTask);
+}
+
+/**
+ * Puts a task in the deadline queue. O(log n).
+ */
+static void uKernelQueueInsert(uKernelTaskDescriptor *pTaskDescriptor)
+{
+    if (pTaskDescriptor->queueIndex != UKERNEL_NOT_QUEUED ||
+            queuedTasks == MAX_TASKS_NUMBER)
+    {
+        return;
+    }
+
+    uKernelQueuePlace(queuedTasks, pTaskDescriptor);
+    queuedTasks++;
+    uKernelQueueSiftUp(pTaskDescriptor->queueIndex);
+}
+
+/**
+ * Takes a task out of the deadline queue. O(log n).
+ */
+static void uKernelQueueRemove(uKernelTaskDescriptor *pTaskDescriptor)
+{
+    uint8_t index = pTaskDescriptor->queueIndex;
+
+    if (index >= queuedTasks)
+    {
+        return; //not in the deadline queue
+    }
+
+    pTaskDescriptor->queueIndex = UKERNEL_NOT_QUEUED;
+    queuedTasks--;
+
+    if (index == queuedTasks)
+    {
+        return; //it was the last one
+    }
+
+    // Fill the hole with the last task and restore the heap order
+    uKernelQueuePlace(index, taskQueue[queuedTasks]);
+    uKernelQueueSiftUp(index);
+    uKernelQueueSiftDown(taskQueue[index]->queueIndex);
+}
+
+/**
+ * Puts the task in the right place after its status or plannedTask changed.
+ */
+static void uKernelQueueUpdate(uKernelTaskDescriptor *pTaskDescriptor)
+{
+    if (pTaskDescriptor->queueIndex == UKERNEL_READY)
+    {
+        uKernelReadyRemove(pTaskDescriptor);
+    }
+
+    if ((pTaskDescriptor->taskStatus == UKERNEL_PAUSED) ||
+            ((pTaskDescriptor->taskStatus & UKERNEL_EVENT) &&
+            (pTaskDescriptor->userTasksInterval == UKERNEL_NO_TIMEOUT)))
+    {
+        //nothing to wait for but a signal
+        uKernelQueueRemove(pTaskDescriptor);
+    }
+    else if (pTaskDescriptor->queueIndex == UKERNEL_NOT_QUEUED)
+    {
+        uKernelQueueInsert(pTaskDescriptor);
+    }
+    else
+    {
+        uKernelQueueSiftUp(pTaskDescriptor->queueIndex);
+        uKernelQueueSiftDown(pTaskDescriptor->queueIndex);
+    }
+}
+
+/**
+ * Puts a due task at the end of the ready list of its priority. O(1).
+ */
+static void uKernelReadyAppend(uKernelTaskDescriptor *pTaskDescriptor)
+{
+    uint8_t priority = pTaskDescriptor->priority;
+
+    pTaskDescriptor->queueIndex = UKERNEL_READY;
+    pTaskDescriptor->pTaskNext = NULL;
+
+    if (readyFirst[priority] == NULL)
+    {
+        readyFirst[priority] = pTaskDescriptor;
+    }
+    else
+    {
+        readyLast[priority]->pTaskNext = pTaskDescriptor;
+    }
+
+    readyLast[priority] = pTaskDescriptor;
+    UKERNEL_SET_BIT(readyMask, priority);
+}
+
+/**
+ * Takes a task out of the ready list of its priority. O(1) for the first
+ * task of the list, which is the case of the scheduler.
+ */
+static void uKernelReadyRemove(uKernelTaskDescriptor *pTaskDescriptor)
+{
+    uint8_t priority = pTaskDescriptor->priority;
+    uKernelTaskDescriptor *pTaskWork = readyFirst[priority];
+
+    if (pTaskWork == pTaskDescriptor)
+    {
+        readyFirst[priority] = pTaskDescriptor->pTaskNext;
+        pTaskWork = NULL;
+    }
+    else
+    {
+        while (pTaskWork->pTaskNext != pTaskDescriptor)
+        {
+            pTaskWork = pTaskWork->pTaskNext;
+        }
+        pTaskWork->pTaskNext = pTaskDescriptor->pTaskNext;
+    }
+
+    if (readyLast[priority] == pTaskDescriptor)
+    {
+        readyLast[priority] = pTaskWork;
+    }
+
+    if (readyFirst[priority] == NULL)
+    {
+        UKERNEL_CLEAR_BIT(readyMask, priority);
+    }
+
+    pTaskDescriptor->queueIndex = UKERNEL_NOT_QUEUED;
+    pTaskDescriptor->pTaskNext = NULL;
+    pTaskDescriptor->signaled = false; //signals from now on count again
+}
+
+/**
+ * Makes ready the UKERNEL_EVENT tasks that have been signaled. Signals to
+ * tasks of any other kind are dropped.
+ */
+static void uKernelCollectSignals(void)
+{
+    uKernelTaskDescriptor *pTaskDescriptor;
+    uint8_t tail = signalTail;
+
+    while (tail != signalHead)
+    {
+        pTaskDescriptor = signalQueue[tail & (UKERNEL_SIGNAL_QUEUE_SIZE - 1)];
+        signalTail = ++tail;
+
+        if (!(pTaskDescriptor->taskStatus & UKERNEL_EVENT))
+        {
+            pTaskDescriptor->signaled = false;
+        }
+        else if (pTaskDescriptor->queueIndex != UKERNEL_READY)
+        {
+            uKernelQueueRemove(pTaskDescriptor);
+            uKernelReadyAppend(pTaskDescriptor);
+        }
+    }
+}
+
+/**
+ * Takes a task out of the deadline queue or the ready list, wherever it is.
+ */
+static void uKernelDetach(uKernelTaskDescriptor *pTaskDescriptor)
+{
+    if (pTaskDescriptor->queueIndex == UKERNEL_READY)
+    {
+        uKernelReadyRemove(pTaskDescriptor);
+    }
+    else
+    {
+        uKernelQueueRemove(pTaskDescriptor);
+    }
+}
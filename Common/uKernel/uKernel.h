@@ -10,7 +10,8 @@
  *  Just create a function, create a descriptor for that function and added to 
  *  the scheduler with a period and let the scheduler do the rest. There is no 
  *	priority and I am tring to keep it really simple due to the memory 
- *  limitations of micrcontrollers. The maximum number of task is 255 but I am
+ *  limitations of micrcontrollers. Tasker and pKernel are thin layers over
+ *  this kernel. The maximum number of task is 254 but I am
  *  sure that the memory will go out first. If anyone needs more tasks let me
  *  know.
  */
@@ -26,11 +27,130 @@ extern "C"
 #include <stdio.h>
 #include <stdbool.h>
 #include <stdint.h>
+#include "TaskStatistics.h"
+#include "Trace.h"
+#include "DeferredWork.h"
+#include "AccessRAM.h"
 
-#define MAX_TASKS_NUMBER            255
+/**Maximum number of tasks (max 254). Each one takes a pointer in the
+ deadline queue, so keep it close to what the application really uses.*/
+#ifndef MAX_TASKS_NUMBER
+#define MAX_TASKS_NUMBER            32
+#endif
+
+/**Uncomment to keep MAX_TASKS_NUMBER task descriptors in a static array,
+ handed out by uKernelCreateTask() and given back by uKernelDeleteTask(). The
+ Tasker compatibility layer needs it. It costs MAX_TASKS_NUMBER descriptors
+ of RAM (about 1 KB on the PIC18 with the default), none is needed when the
+ application owns all the descriptors (uKernelAddTask(), pKernel).*/
+//#define UKERNEL_STATIC_TASKS
+
+/**Uncomment to let the scheduler sleep until the next task is due instead
+ of being woken by every tick. The application must then provide
+ uKernelPortSleep() and uKernelPortResumeTick().*/
+//#define UKERNEL_USE_TICKLESS
+
+/**Delays shorter than this (in ms) are not worth going to sleep for.*/
+#define UKERNEL_TICKLESS_MIN_SLEEP  2
+
+/**Uncomment to schedule with a 32-bit microsecond timebase instead of
+ _counterMs, for periods shorter than a millisecond. The tasks given in us
+ (uKernelAddTaskUs(), pKernel) and in ms (uKernelAddTask(), Tasker) share
+ it. The time is read with UKERNEL_TIMEBASE_US().*/
+//#define UKERNEL_USE_US_TIMEBASE
+
+#ifdef UKERNEL_USE_US_TIMEBASE
+/**
+ * Reads a free-running hardware timer counting microseconds, that must wrap
+ * at 2^32 (or be extended to 32 bits by the application). On the Cortex-M3
+ * (STM32F1) it is made from _counterMs and the count of SysTick, which must
+ * then be the 1 ms tick, other targets have to define it before including
+ * this file, i.e. #define UKERNEL_TIMEBASE_US() TimerMicros()
+ */
+#ifndef UKERNEL_TIMEBASE_US
+#if defined(__ARM_ARCH_7M__) || defined(__TARGET_ARCH_7_M) || defined(__CORTEX_M)
+#define UKERNEL_SYSTICK_TIMEBASE
+#define UKERNEL_TIMEBASE_US()       uKernelSysTickMicros()
+#else
+#error "uKernel: define UKERNEL_TIMEBASE_US() for this target"
+#endif
+#endif
+#endif
+
+/**Called by the scheduler when no task is due (after the tickless sleep
+ with UKERNEL_USE_TICKLESS). Define it as SLEEP() on a PIC to wait for the
+ next interrupt, as USE_SLEEP did in pKernel.*/
+#ifndef UKERNEL_IDLE
+#define UKERNEL_IDLE()
+#endif
+
+/**Uncomment to measure the load of the CPU: the share of the time the
+ scheduler is not in its idle branch, over windows of UKERNEL_LOAD_WINDOW_MS.
+ With USE_TASK_STATISTICS the idle time is measured with
+ TASK_STATISTICS_TIMER(), sleep included, and the run time of every task in
+ the window is given by uKernelGetTaskLoad(). Without it the passes of the
+ idle branch in a window are counted against the most ever counted in one,
+ the baseline of an idle CPU: it is found by the first quiet window, or set
+ with uKernelSetIdleBaseline() from a measure without tasks. The counting
+ needs an UKERNEL_IDLE() that doesn't sleep.*/
+//#define UKERNEL_USE_CPU_LOAD
+
+/**Length of a load window, in ms.*/
+#ifndef UKERNEL_LOAD_WINDOW_MS
+#define UKERNEL_LOAD_WINDOW_MS      1000
+#endif
+
+/**Interval of an UKERNEL_EVENT task that only runs when signaled.*/
+#define UKERNEL_NO_TIMEOUT          0
+
+/**Number of signaled tasks that can wait to be made ready (power of two,
+ max 128).*/
+#ifndef UKERNEL_SIGNAL_QUEUE_SIZE
+#define UKERNEL_SIGNAL_QUEUE_SIZE   8
+#endif
+
+/**
+ * uKernelSignal() is lock-free for one producer. If interrupt routines of
+ * different priorities (that can nest) signal tasks, define these to
+ * disable and enable the interrupts.
+ */
+#ifndef UKERNEL_ENTER_CRITICAL
+#define UKERNEL_ENTER_CRITICAL()
+#define UKERNEL_EXIT_CRITICAL()
+#endif
+
+/**
+ * Set and clear one bit of the ready bitmap and of the flags of the CMSIS
+ * threads. Define these to atomic operations where there are some, i.e.
+ * BITBAND_SET_BIT() and BITBAND_CLEAR_BIT() of BitBand.h on the STM32, and
+ * osSignalSet() no longer needs UKERNEL_ENTER_CRITICAL().
+ */
+#ifndef UKERNEL_SET_BIT
+#define UKERNEL_SET_BIT(variable, bit)      ((variable) |= (1UL << (bit)))
+#define UKERNEL_CLEAR_BIT(variable, bit)    ((variable) &= ~(1UL << (bit)))
+#else
+#define UKERNEL_ATOMIC_BITS
+#endif
+
+/**Value of queueIndex for a task that is not waiting for its deadline.*/
+#define UKERNEL_NOT_QUEUED          0xFF
+/**Value of queueIndex for a task that is due and waiting to be dispatched.*/
+#define UKERNEL_READY               0xFE
 
-/**Set your max interval here (max 2^32-1) - default 3600000 (1 hour)*/
+#if MAX_TASKS_NUMBER > 254
+#error "uKernel: MAX_TASKS_NUMBER can't be bigger than 254"
+#endif
+
+/**Set your max interval here, in ms. The deadlines are compared over half
+ the range of the timebase, which is 2^31 us (35 minutes) with
+ UKERNEL_USE_US_TIMEBASE - default 3600000 (1 hour) or 1800000 (30 minutes)*/
+#ifndef MAX_TASK_INTERVAL
+#ifdef UKERNEL_USE_US_TIMEBASE
+#define MAX_TASK_INTERVAL           1800000UL
+#else
 #define MAX_TASK_INTERVAL           3600000UL
+#endif
+#endif
 
 typedef enum
 {
@@ -44,44 +164,177 @@ typedef enum
     UKERNEL_IMMEDIATESTART = 0x05, //0b00000101
     /**For the task to be executed one time as soon as it is added.*/
     UKERNEL_ONETIME_IMMEDIATESTART = 0x07, //0b00000111
+    /**For a task that runs every time it is signaled with uKernelSignal()
+     and, unless the interval is UKERNEL_NO_TIMEOUT, when the interval
+     elapses without a signal. It is not looked at while it waits.*/
+    UKERNEL_EVENT = 0x08, //0b00001000
+    /**For an event task that runs once as soon as it is added.*/
+    UKERNEL_EVENT_IMMEDIATESTART = 0x0C, //0b00001100
     /**Error, task not found.*/
     UKERNEL_ERROR = 0xFF //0b11111111
 } uKernelTaskStatus;
 
+/**Priority of a task. When several tasks are due the one with the highest
+ priority runs first, tasks with the same priority run in the order they
+ became due. A running task is never interrupted.*/
+typedef enum
+{
+    UKERNEL_PRIORITY_LOW = 0,
+    /**Priority of the tasks added with uKernelAddTask().*/
+    UKERNEL_PRIORITY_NORMAL = 1,
+    UKERNEL_PRIORITY_HIGH = 2,
+    UKERNEL_PRIORITY_REALTIME = 3,
+    /**Number of priority levels.*/
+    UKERNEL_PRIORITY_LEVELS
+} uKernelTaskPriority;
+
+/**What a periodic task does when it starts late.*/
+typedef enum
+{
+    /**Next start is one interval after the real start, the schedule drifts
+     by the delay of every late start (the original behaviour).*/
+    UKERNEL_POLICY_DRIFT = 0x00,
+    /**Fixed rate, next start is one interval after the planned one. The
+     periods that were missed completely are skipped.*/
+    UKERNEL_POLICY_SKIP = 0x01,
+    /**Fixed rate, next start is one interval after the planned one. The
+     periods that were missed run back to back until the task catches up.*/
+    UKERNEL_POLICY_CATCHUP = 0x02
+} uKernelTaskPolicy;
+
+/**Average of the CPU load, over the windows of UKERNEL_LOAD_WINDOW_MS of
+ the default length.*/
+typedef enum
+{
+    /**The last window.*/
+    UKERNEL_LOAD_1S = 0,
+    /**Moving average of 10 windows.*/
+    UKERNEL_LOAD_10S,
+    /**Moving average of 60 windows.*/
+    UKERNEL_LOAD_60S
+} uKernelLoadWindow;
+
 /**Function pointer on the task body.*/
 typedef void (*TaskBody)(void);
 
 typedef struct _uKernelTaskDescriptor
 {
-    //    /**Pointer to the previous task in the list.*/
-    //    struct _uKernelTaskDescriptor *pTaskPrevious;
     /**Used to store the pointers to user's tasks*/
     TaskBody taskPointer;
-    /**Used to store the interval between each task's run*/
+    /**Used to store the interval between each task's run, in ms or in us
+     with UKERNEL_USE_US_TIMEBASE*/
     uint32_t userTasksInterval;
-    /**Used to store the next time a task will have to be executed*/
+    /**Used to store the next time a task will have to be executed, in the
+     same unit*/
     uint32_t plannedTask;
     /**Used to store the status of the tasks*/
     uKernelTaskStatus taskStatus;
-    /**Pointer to the next task in the list.*/
+    /**Used to store the priority of the task*/
+    uKernelTaskPriority priority;
+    /**Used to store what to do when the task starts late*/
+    uKernelTaskPolicy policy;
+    /**Number of times the task started a whole interval or more late*/
+    uint16_t overruns;
+    /**Set by uKernelSignal(), cleared when the task is dispatched*/
+    volatile uint8_t signaled;
+    /**Where a coroutine task resumes, 0 to start from the beginning.
+     @see uKernelCoroutine.h*/
+    uint16_t continuation;
+    /**Position of the task in the deadline queue, UKERNEL_READY or
+     UKERNEL_NOT_QUEUED.*/
+    uint8_t queueIndex;
+    /**Pointer to the next task in the ready list of its priority.*/
     struct _uKernelTaskDescriptor *pTaskNext;
+#ifdef USE_TASK_STATISTICS
+    /**Execution time and start latency of the task.*/
+    tTaskStatistics statistics;
+#endif
 } uKernelTaskDescriptor;
 
-extern uint32_t _counterMs;
+extern volatile ACCESS_RAM_KERNEL uint32_t _counterMs;
 
 void uKernelInit(void);
 bool uKernelAddTask(uKernelTaskDescriptor *pTaskDescriptor,
                     void (*userTask)(void),
                     uint32_t taskInterval,
                     uKernelTaskStatus taskStatus);
+bool uKernelAddTaskPriority(uKernelTaskDescriptor *pTaskDescriptor,
+                            void (*userTask)(void),
+                            uint32_t taskInterval,
+                            uKernelTaskStatus taskStatus,
+                            uKernelTaskPriority priority);
+bool uKernelSetTaskPriority(uKernelTaskDescriptor *pTaskDescriptor,
+                            uKernelTaskPriority priority);
+bool uKernelSetTaskPolicy(uKernelTaskDescriptor *pTaskDescriptor,
+                          uKernelTaskPolicy policy);
+void uKernelSetOverrunHook(void (*hook)(uKernelTaskDescriptor *pTaskDescriptor));
+bool uKernelSignal(uKernelTaskDescriptor *pTaskDescriptor);
+bool uKernelSignalsPending(void);
 bool uKernelRemoveTask(uKernelTaskDescriptor *userTaskDescriptor);
 bool uKernelPauseTask(uKernelTaskDescriptor *pTaskDescriptor);
 bool uKernelResumeTask(uKernelTaskDescriptor *pTaskDescriptor);
 bool uKernelModifyTask(uKernelTaskDescriptor *pTaskDescriptor,
                                 uint32_t taskInterval,
                                 uKernelTaskStatus tStatus);
+uKernelTaskStatus uKernelGetTaskStatus(uKernelTaskDescriptor *pTaskDescriptor);
+uKernelTaskDescriptor *uKernelCurrentTask(void);
+bool uKernelTaskDelay(uint32_t delay);
 void uKernelScheduler(void);
 void uKernelDelayMiliseconds(unsigned int delay);
+uint32_t uKernelTimeToNextTask(void);
+
+#ifdef UKERNEL_USE_CPU_LOAD
+uint16_t uKernelGetCpuLoad(uKernelLoadWindow window);
+#ifdef USE_TASK_STATISTICS
+uint16_t uKernelGetTaskLoad(uKernelTaskDescriptor *pTaskDescriptor);
+#else
+void uKernelSetIdleBaseline(uint32_t passes);
+#endif
+#endif
+
+#ifdef UKERNEL_USE_US_TIMEBASE
+bool uKernelAddTaskUs(uKernelTaskDescriptor *pTaskDescriptor,
+                      void (*userTask)(void),
+                      uint32_t usInterval,
+                      uKernelTaskStatus taskStatus);
+bool uKernelModifyTaskUs(uKernelTaskDescriptor *pTaskDescriptor,
+                         uint32_t usInterval,
+                         uKernelTaskStatus tStatus);
+uint32_t uKernelMicros(void);
+void uKernelDelayMicroseconds(uint32_t delay);
+#ifdef UKERNEL_SYSTICK_TIMEBASE
+uint32_t uKernelSysTickMicros(void);
+#endif
+#endif
+
+#ifdef UKERNEL_STATIC_TASKS
+uKernelTaskDescriptor *uKernelCreateTask(void (*userTask)(void),
+                                         uint32_t taskInterval,
+                                         uKernelTaskStatus taskStatus);
+bool uKernelDeleteTask(uKernelTaskDescriptor *pTaskDescriptor);
+uKernelTaskDescriptor *uKernelGetPoolTask(uint8_t index);
+uint8_t uKernelGetPoolIndex(uKernelTaskDescriptor *pTaskDescriptor);
+#endif
+
+#ifdef UKERNEL_USE_TICKLESS
+/**
+ * Supplied by the application. Stops the 1 ms tick, programs a one-shot
+ * timer for sleepMs milliseconds and puts the microcontroller to sleep until
+ * that timer or any other interrupt wakes it up. It must not go to sleep if
+ * uKernelSignalsPending(), or with USE_DEFERRED_WORK DeferredWorkPending(),
+ * both checked with the interrupts disabled until the sleep instruction: a
+ * signal from an interrupt after the scheduler collected them would
+ * otherwise wait for the timer.
+ * @param sleepMs Time until the next task is due.
+ * @return Milliseconds that really elapsed while sleeping. The tick must still
+ *         be stopped on return, the kernel adds this value to _counterMs.
+ */
+uint32_t uKernelPortSleep(uint32_t sleepMs);
+/**
+ * Supplied by the application. Restarts the 1 ms tick after uKernelPortSleep().
+ */
+void uKernelPortResumeTick(void);
+#endif
 
 #ifdef	__cplusplus
 }
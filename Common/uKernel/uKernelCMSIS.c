@@ -0,0 +1,653 @@
+/**
+ *  @file           uKernelCMSIS.c
+ *  @author         Luis Maduro
+ *  @version        1.0
+ *  @date           14/10/2026
+ *  @copyright		GNU General Public License
+ *
+ *  @brief CMSIS-RTOS (cmsis_os.h) backend over uKernel.
+ *  @see uKernelCMSIS.h for what is implemented and how it differs from a
+ *  preemptive RTOS.
+ */
+
+#include "uKernelCMSIS.h"
+
+/**Signal flags that can be used, osFeature_Signals of them.*/
+#define CMSIS_OS_SIGNAL_MASK        ((int32_t) ((1UL << osFeature_Signals) - 1))
+
+static struct os_thread_cb threads[CMSIS_OS_THREADS];
+static struct os_timer_cb timers[CMSIS_OS_TIMERS];
+static struct os_messageQ_cb messageQueues[CMSIS_OS_MESSAGE_QUEUES];
+/**uKernelInit() has been called.*/
+static bool kernelInitialized = false;
+/**osKernelStart() has been called.*/
+static bool kernelRunning = false;
+
+static void osStart(void);
+static void osThreadRun(void);
+static void osTimerRun(void);
+static bool osThreadValid(osThreadId thread_id);
+static bool osTimerValid(osTimerId timer_id);
+static bool osMessageValid(osMessageQId queue_id);
+static osStatus osWaitPending(osThreadId thread_id, uint32_t millisec);
+static uKernelTaskPriority osPriorityToKernel(osPriority priority);
+
+/**
+ * Creates the thread, if any, and runs the scheduler. Never returns.
+ */
+osStatus osKernelStart(osThreadDef_t *thread_def, void *argument)
+{
+    osStart();
+
+    if ((thread_def != NULL) &&
+            (osThreadCreate(thread_def, argument) == NULL))
+    {
+        return osErrorResource;
+    }
+
+    kernelRunning = true;
+    uKernelScheduler();
+
+    return osOK;
+}
+
+int32_t osKernelRunning(void)
+{
+    return kernelRunning ? 1 : 0;
+}
+
+/**
+ * The thread function runs once as soon as possible and then every time the
+ * thread gets a signal or a message. The number of instances and the stack
+ * size are not used.
+ */
+osThreadId osThreadCreate(osThreadDef_t *thread_def, void *argument)
+{
+    osThreadId thread_id = NULL;
+    uint8_t i;
+
+    osStart();
+
+    if ((thread_def == NULL) || (thread_def->pthread == NULL) ||
+            (thread_def->tpriority < osPriorityIdle) ||
+            (thread_def->tpriority > osPriorityRealtime))
+    {
+        return NULL;
+    }
+
+    for (i = 0; i < CMSIS_OS_THREADS; i++)
+    {
+        if (threads[i].pthread == NULL)
+        {
+            thread_id = &threads[i];
+            break;
+        }
+    }
+
+    if (thread_id == NULL)
+    {
+        return NULL;
+    }
+
+    thread_id->argument = argument;
+    thread_id->signals = 0;
+    thread_id->waiting = false;
+
+    if (!uKernelAddTaskPriority(&thread_id->task, osThreadRun,
+                                UKERNEL_NO_TIMEOUT,
+                                UKERNEL_EVENT_IMMEDIATESTART,
+                                osPriorityToKernel(thread_def->tpriority)))
+    {
+        return NULL;
+    }
+
+    thread_id->pthread = thread_def->pthread;
+
+    return thread_id;
+}
+
+osThreadId osThreadGetId(void)
+{
+    uKernelTaskDescriptor *pTaskDescriptor = uKernelCurrentTask();
+
+    if ((pTaskDescriptor == NULL) ||
+            (pTaskDescriptor->taskPointer != osThreadRun))
+    {
+        return NULL;
+    }
+
+    return (osThreadId) pTaskDescriptor;
+}
+
+osStatus osThreadTerminate(osThreadId thread_id)
+{
+    if (!osThreadValid(thread_id))
+    {
+        return osErrorParameter;
+    }
+
+    uKernelRemoveTask(&thread_id->task);
+    thread_id->pthread = NULL;
+
+    return osOK;
+}
+
+/**
+ * Makes the running thread run again after the threads of the same priority
+ * that are ready. The thread function has to return.
+ */
+osStatus osThreadYield(void)
+{
+    osThreadId thread_id = osThreadGetId();
+
+    if (thread_id == NULL)
+    {
+        return osErrorOS;
+    }
+
+    return uKernelSignal(&thread_id->task) ? osOK : osErrorResource;
+}
+
+osStatus osThreadSetPriority(osThreadId thread_id, osPriority priority)
+{
+    if (!osThreadValid(thread_id))
+    {
+        return osErrorParameter;
+    }
+
+    if ((priority < osPriorityIdle) || (priority > osPriorityRealtime))
+    {
+        return osErrorValue;
+    }
+
+    uKernelSetTaskPriority(&thread_id->task, osPriorityToKernel(priority));
+
+    return osOK;
+}
+
+/**
+ * uKernel has 4 priorities, the CMSIS ones below normal are all given as
+ * osPriorityLow and osPriorityAboveNormal as osPriorityHigh.
+ */
+osPriority osThreadGetPriority(osThreadId thread_id)
+{
+    if (!osThreadValid(thread_id))
+    {
+        return osPriorityError;
+    }
+
+    switch (thread_id->task.priority)
+    {
+        case UKERNEL_PRIORITY_LOW:
+            return osPriorityLow;
+        case UKERNEL_PRIORITY_HIGH:
+            return osPriorityHigh;
+        case UKERNEL_PRIORITY_REALTIME:
+            return osPriorityRealtime;
+        default:
+            return osPriorityNormal;
+    }
+}
+
+/**
+ * Inside a thread, the thread runs again after the delay and its function
+ * has to return. Anywhere else it is a busy wait.
+ */
+osStatus osDelay(uint32_t millisec)
+{
+    if (osThreadGetId() != NULL)
+    {
+        uKernelTaskDelay(millisec);
+    }
+    else
+    {
+        uKernelDelayMiliseconds(millisec);
+    }
+
+    return osEventTimeout;
+}
+
+osTimerId osTimerCreate(osTimerDef_t *timer_def, os_timer_type type,
+                        void *argument)
+{
+    uint8_t i;
+
+    osStart();
+
+    if ((timer_def == NULL) || (timer_def->ptimer == NULL) ||
+            (type > osTimerPeriodic))
+    {
+        return NULL;
+    }
+
+    for (i = 0; i < CMSIS_OS_TIMERS; i++)
+    {
+        if (timers[i].ptimer == NULL)
+        {
+            timers[i].ptimer = timer_def->ptimer;
+            timers[i].argument = argument;
+            timers[i].type = type;
+            timers[i].added = false;
+
+            return &timers[i];
+        }
+    }
+
+    return NULL;
+}
+
+osStatus osTimerStart(osTimerId timer_id, uint32_t millisec)
+{
+    uKernelTaskStatus status;
+
+    if (!osTimerValid(timer_id))
+    {
+        return osErrorParameter;
+    }
+
+    if ((millisec == 0) || (millisec > MAX_TASK_INTERVAL))
+    {
+        return osErrorValue;
+    }
+
+    status = (timer_id->type == osTimerOnce) ?
+            UKERNEL_ONETIME : UKERNEL_SCHEDULED;
+
+    if (timer_id->added)
+    {
+        return uKernelModifyTask(&timer_id->task, millisec, status) ?
+                osOK : osErrorOS;
+    }
+
+    if (!uKernelAddTask(&timer_id->task, osTimerRun, millisec, status))
+    {
+        return osErrorResource;
+    }
+
+    timer_id->added = true;
+
+    return osOK;
+}
+
+osStatus osTimerStop(osTimerId timer_id)
+{
+    if (!osTimerValid(timer_id))
+    {
+        return osErrorParameter;
+    }
+
+    if (!timer_id->added ||
+            (uKernelGetTaskStatus(&timer_id->task) == UKERNEL_PAUSED))
+    {
+        return osErrorResource; //not running
+    }
+
+    uKernelPauseTask(&timer_id->task);
+
+    return osOK;
+}
+
+/**
+ * Sets or clears flags of a thread. With UKERNEL_ATOMIC_BITS every bit is
+ * changed on its own, a flag set by an interrupt in between is kept, else
+ * the interrupts are held off by UKERNEL_ENTER_CRITICAL().
+ */
+static void osSignalChange(osThreadId thread_id, int32_t signal, bool set)
+{
+#ifdef UKERNEL_ATOMIC_BITS
+    uint8_t bit;
+
+    for (bit = 0; bit < osFeature_Signals; bit++)
+    {
+        if (signal & (1L << bit))
+        {
+            if (set)
+            {
+                UKERNEL_SET_BIT(thread_id->signals, bit);
+            }
+            else
+            {
+                UKERNEL_CLEAR_BIT(thread_id->signals, bit);
+            }
+        }
+    }
+#else
+    UKERNEL_ENTER_CRITICAL();
+    if (set)
+    {
+        thread_id->signals |= signal;
+    }
+    else
+    {
+        thread_id->signals &= ~signal;
+    }
+    UKERNEL_EXIT_CRITICAL();
+#endif
+}
+
+/**
+ * Sets the flags and wakes the thread up. Can be called from the interrupts.
+ */
+int32_t osSignalSet(osThreadId thread_id, int32_t signal)
+{
+    int32_t previous;
+
+    if (!osThreadValid(thread_id) || (signal & ~CMSIS_OS_SIGNAL_MASK))
+    {
+        return CMSIS_OS_SIGNAL_ERROR;
+    }
+
+    previous = thread_id->signals;
+    osSignalChange(thread_id, signal, true);
+
+    uKernelSignal(&thread_id->task);
+
+    return previous;
+}
+
+int32_t osSignalClear(osThreadId thread_id, int32_t signal)
+{
+    int32_t previous;
+
+    if (!osThreadValid(thread_id) || (signal & ~CMSIS_OS_SIGNAL_MASK))
+    {
+        return CMSIS_OS_SIGNAL_ERROR;
+    }
+
+    previous = thread_id->signals;
+    osSignalChange(thread_id, signal, false);
+
+    return previous;
+}
+
+int32_t osSignalGet(osThreadId thread_id)
+{
+    if (!osThreadValid(thread_id))
+    {
+        return CMSIS_OS_SIGNAL_ERROR;
+    }
+
+    return thread_id->signals;
+}
+
+/**
+ * Doesn't block, returns osOK if the flags are not set yet.
+ * @see uKernelCMSIS.h
+ */
+osEvent osSignalWait(int32_t signals, uint32_t millisec)
+{
+    osThreadId thread_id = osThreadGetId();
+    osEvent event;
+    int32_t flags;
+    bool done;
+
+    event.value.signals = 0;
+    event.def.message_id = NULL;
+
+    if (thread_id == NULL)
+    {
+        event.status = osErrorOS;
+        return event;
+    }
+
+    if (signals & ~CMSIS_OS_SIGNAL_MASK)
+    {
+        event.status = osErrorValue;
+        return event;
+    }
+
+    flags = thread_id->signals;
+    done = (signals == 0) ? (flags != 0) : ((flags & signals) == signals);
+
+    if (done)
+    {
+        // the flags that satisfied the wait are cleared, the ones set since
+        // the read are kept
+        osSignalChange(thread_id, (signals == 0) ? flags : signals, false);
+    }
+
+    if (done)
+    {
+        thread_id->waiting = false;
+        event.status = osEventSignal;
+        event.value.signals = flags;
+    }
+    else
+    {
+        event.status = osWaitPending(thread_id, millisec);
+    }
+
+    return event;
+}
+
+/**
+ * The memory of the queue is given by osMessageQDef(). If thread_id is not
+ * NULL the thread is signaled every time a message is put.
+ */
+osMessageQId osMessageCreate(osMessageQDef_t *queue_def, osThreadId thread_id)
+{
+    uint8_t i;
+
+    osStart();
+
+    if ((queue_def == NULL) || (queue_def->pool == NULL) ||
+            (queue_def->queue_sz == 0) ||
+            ((thread_id != NULL) && !osThreadValid(thread_id)))
+    {
+        return NULL;
+    }
+
+    for (i = 0; i < CMSIS_OS_MESSAGE_QUEUES; i++)
+    {
+        if (messageQueues[i].buffer == NULL)
+        {
+            messageQueues[i].size = queue_def->queue_sz + 1;
+            messageQueues[i].head = 0;
+            messageQueues[i].tail = 0;
+            messageQueues[i].thread = thread_id;
+            messageQueues[i].buffer = queue_def->pool;
+
+            return &messageQueues[i];
+        }
+    }
+
+    return NULL;
+}
+
+/**
+ * Doesn't block, a full queue gives osErrorResource (osErrorTimeoutResource
+ * with a timeout). Can be called from the interrupts.
+ */
+osStatus osMessagePut(osMessageQId queue_id, uint32_t info, uint32_t millisec)
+{
+    uint32_t head, next;
+
+    if (!osMessageValid(queue_id))
+    {
+        return osErrorParameter;
+    }
+
+    UKERNEL_ENTER_CRITICAL();
+    head = queue_id->head;
+    next = head + 1;
+
+    if (next == queue_id->size)
+    {
+        next = 0;
+    }
+
+    if (next == queue_id->tail)
+    {
+        UKERNEL_EXIT_CRITICAL();
+        return (millisec == 0) ? osErrorResource : osErrorTimeoutResource;
+    }
+
+    queue_id->buffer[head] = info;
+    queue_id->head = next;
+    UKERNEL_EXIT_CRITICAL();
+
+    if (queue_id->thread != NULL)
+    {
+        uKernelSignal(&queue_id->thread->task);
+    }
+
+    return osOK;
+}
+
+/**
+ * Doesn't block, returns osOK if the queue is empty.
+ * @see uKernelCMSIS.h
+ */
+osEvent osMessageGet(osMessageQId queue_id, uint32_t millisec)
+{
+    osThreadId thread_id;
+    osEvent event;
+    uint32_t tail;
+
+    event.value.v = 0;
+    event.def.message_id = queue_id;
+
+    if (!osMessageValid(queue_id))
+    {
+        event.status = osErrorParameter;
+        return event;
+    }
+
+    tail = queue_id->tail;
+    thread_id = osThreadGetId();
+
+    if (tail == queue_id->head)
+    {
+        if (thread_id != NULL)
+        {
+            event.status = osWaitPending(thread_id, millisec);
+        }
+        else
+        {
+            event.status = (millisec == 0) ? osOK : osEventTimeout;
+        }
+
+        return event;
+    }
+
+    event.value.v = queue_id->buffer[tail];
+    queue_id->tail = (tail + 1 == queue_id->size) ? 0 : tail + 1;
+    event.status = osEventMessage;
+
+    if (thread_id != NULL)
+    {
+        thread_id->waiting = false;
+    }
+
+    return event;
+}
+
+/**
+ * Initializes uKernel the first time a CMSIS function needs it.
+ */
+static void osStart(void)
+{
+    if (!kernelInitialized)
+    {
+        kernelInitialized = true;
+        uKernelInit();
+    }
+}
+
+/**
+ * Body of the tasks of all the threads.
+ */
+static void osThreadRun(void)
+{
+    osThreadId thread_id = (osThreadId) uKernelCurrentTask();
+
+    thread_id->pthread(thread_id->argument);
+}
+
+/**
+ * Body of the tasks of all the timers.
+ */
+static void osTimerRun(void)
+{
+    osTimerId timer_id = (osTimerId) uKernelCurrentTask();
+
+    timer_id->ptimer(timer_id->argument);
+}
+
+static bool osThreadValid(osThreadId thread_id)
+{
+    return (thread_id != NULL) && (thread_id >= &threads[0]) &&
+            (thread_id < &threads[CMSIS_OS_THREADS]) &&
+            (thread_id->pthread != NULL);
+}
+
+static bool osTimerValid(osTimerId timer_id)
+{
+    return (timer_id != NULL) && (timer_id >= &timers[0]) &&
+            (timer_id < &timers[CMSIS_OS_TIMERS]) &&
+            (timer_id->ptimer != NULL);
+}
+
+static bool osMessageValid(osMessageQId queue_id)
+{
+    return (queue_id != NULL) && (queue_id >= &messageQueues[0]) &&
+            (queue_id < &messageQueues[CMSIS_OS_MESSAGE_QUEUES]) &&
+            (queue_id->buffer != NULL);
+}
+
+/**
+ * A wait of the running thread that can't be satisfied yet. The thread
+ * runs again on a signal or a message, and when the timeout elapses.
+ * @return osOK while waiting, osEventTimeout once the timeout has elapsed.
+ */
+static osStatus osWaitPending(osThreadId thread_id, uint32_t millisec)
+{
+    int32_t remaining;
+
+    if ((millisec == 0) || (millisec == osWaitForever))
+    {
+        thread_id->waiting = false;
+        return osOK;
+    }
+
+    if (!thread_id->waiting)
+    {
+        thread_id->waiting = true;
+        thread_id->waitDeadline = _counterMs + millisec;
+    }
+
+    remaining = (int32_t) (thread_id->waitDeadline - _counterMs);
+
+    if (remaining <= 0)
+    {
+        thread_id->waiting = false;
+        return osEventTimeout;
+    }
+
+    uKernelTaskDelay((uint32_t) remaining);
+
+    return osOK;
+}
+
+/**
+ * Maps the 7 CMSIS priorities to the 4 of uKernel.
+ */
+static uKernelTaskPriority osPriorityToKernel(osPriority priority)
+{
+    if (priority < osPriorityNormal)
+    {
+        return UKERNEL_PRIORITY_LOW;
+    }
+
+    if (priority == osPriorityNormal)
+    {
+        return UKERNEL_PRIORITY_NORMAL;
+    }
+
+    if (priority < osPriorityRealtime)
+    {
+        return UKERNEL_PRIORITY_HIGH;
+    }
+
+    return UKERNEL_PRIORITY_REALTIME;
+}
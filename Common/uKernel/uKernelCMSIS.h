@@ -0,0 +1,96 @@
+/**
+ *  @file           uKernelCMSIS.h
+ *  @author         Luis Maduro
+ *  @version        1.0
+ *  @date           14/10/2026
+ *  @copyright		GNU General Public License
+ *
+ *  @brief CMSIS-RTOS (cmsis_os.h) backend over uKernel.
+ *  Only the timer, signal and message queue functions are implemented, with
+ *  the kernel, thread and osDelay() functions they need, so the code written
+ *  for them can later move to a preemptive RTOS. uKernel is cooperative, so
+ *  a thread is not an endless loop with its own stack but an UKERNEL_EVENT
+ *  task: the thread function runs to its end once when the thread is
+ *  created and then every time the thread gets a signal or a message.
+ *
+ *  The waits never block. osSignalWait() and osMessageGet() that can't be
+ *  satisfied return osOK at once and the thread function has to return; it
+ *  runs again when a signal or a message arrives or, with a timeout other
+ *  than 0 and osWaitForever, once the timeout elapses, and the wait then
+ *  returns osEventTimeout. osDelay() makes the thread run again after the
+ *  delay. osSignalSet(), osMessagePut() and osMessageGet() can be called
+ *  from the interrupts (a queue has a single reader).
+ *
+ *  uKernelInit() is called by the first CMSIS function used, don't call it
+ *  again afterwards.
+ */
+
+#ifndef UKERNEL_CMSIS_H
+#define	UKERNEL_CMSIS_H
+
+#include "cmsis_os.h"
+#include "uKernel.h"
+
+/**Number of threads that can exist at the same time.*/
+#ifndef CMSIS_OS_THREADS
+#define CMSIS_OS_THREADS            4
+#endif
+
+/**Number of timers that can be created.*/
+#ifndef CMSIS_OS_TIMERS
+#define CMSIS_OS_TIMERS             4
+#endif
+
+/**Number of message queues that can be created.*/
+#ifndef CMSIS_OS_MESSAGE_QUEUES
+#define CMSIS_OS_MESSAGE_QUEUES     4
+#endif
+
+/**Value returned by the signal functions on a wrong parameter.*/
+#define CMSIS_OS_SIGNAL_ERROR       ((int32_t) 0x80000000UL)
+
+struct os_thread_cb
+{
+    /**Event task that runs the thread function, must be the first field.*/
+    uKernelTaskDescriptor task;
+    /**Thread function, NULL when the control block is free.*/
+    os_pthread pthread;
+    /**Argument given to the thread function.*/
+    void *argument;
+    /**Signal flags of the thread.*/
+    volatile int32_t signals;
+    /**A wait with timeout is pending.*/
+    bool waiting;
+    /**_counterMs at which the pending wait times out.*/
+    uint32_t waitDeadline;
+};
+
+struct os_timer_cb
+{
+    /**Task that calls the timer function, must be the first field.*/
+    uKernelTaskDescriptor task;
+    /**Timer function, NULL when the control block is free.*/
+    os_ptimer ptimer;
+    /**Argument given to the timer function.*/
+    void *argument;
+    /**osTimerOnce or osTimerPeriodic.*/
+    os_timer_type type;
+    /**The task has already been added to the scheduler.*/
+    bool added;
+};
+
+struct os_messageQ_cb
+{
+    /**Memory of the messages, from osMessageQDef(). NULL when free.*/
+    uint32_t *buffer;
+    /**Number of slots of buffer, one more than the messages it holds.*/
+    uint32_t size;
+    /**Next slot to be written, only changed by osMessagePut().*/
+    volatile uint32_t head;
+    /**Next slot to be read, only changed by osMessageGet().*/
+    volatile uint32_t tail;
+    /**Thread signaled when a message is put, or NULL.*/
+    osThreadId thread;
+};
+
+#endif	/* UKERNEL_CMSIS_H */
@@ -0,0 +1,92 @@
+/**
+ *  @file           uKernelCoroutine.h
+ *  @author         Luis Maduro
+ *  @version        1.0
+ *  @date           14/10/2026
+ *  @copyright		GNU General Public License
+ *
+ *  @brief Stackless coroutines (protothreads) for uKernel tasks.
+ *  A long sequence, like the initialization of a device with waits between
+ *  the steps, can be written as one task body that gives the processor back
+ *  to the scheduler at every wait and continues from that point the next
+ *  time the task runs. The point where it stops is kept in the continuation
+ *  field of the descriptor, so there is no stack per task.
+ *
+ *  @code
+ *  void DeviceInitTask(void)
+ *  {
+ *      UKERNEL_CR_BEGIN();
+ *      DeviceReset();
+ *      UKERNEL_CR_WAIT_UNTIL(DeviceIsReady());
+ *      DeviceConfigure();
+ *      UKERNEL_CR_DELAY(100);
+ *      DeviceStart();
+ *      UKERNEL_CR_END();
+ *  }
+ *  @endcode
+ *
+ *  The local variables are lost at every wait, keep the state that has to
+ *  survive in static variables. A coroutine can't use switch statements
+ *  between UKERNEL_CR_BEGIN() and UKERNEL_CR_END(), and only one wait macro
+ *  can be on each line.
+ */
+
+#ifndef UKERNEL_COROUTINE_H
+#define	UKERNEL_COROUTINE_H
+
+#include "uKernel.h"
+
+/**Starts the body of the coroutine, must be the first statement.*/
+#define UKERNEL_CR_BEGIN()                                              \
+    switch (uKernelCurrentTask()->continuation)                         \
+    {                                                                   \
+        case 0:
+
+/**Returns to the scheduler, the next run continues after this point.*/
+#define UKERNEL_CR_YIELD()                                              \
+    do                                                                  \
+    {                                                                   \
+        uKernelCurrentTask()->continuation = __LINE__;                  \
+        return;                                                         \
+        case __LINE__:;                                                 \
+    } while (0)
+
+/**Returns to the scheduler for ms milliseconds, the other tasks run in the
+ meantime. The next run, after the delay, continues after this point.*/
+#define UKERNEL_CR_DELAY(ms)                                            \
+    do                                                                  \
+    {                                                                   \
+        uKernelTaskDelay(ms);                                           \
+        uKernelCurrentTask()->continuation = __LINE__;                  \
+        return;                                                         \
+        case __LINE__:;                                                 \
+    } while (0)
+
+/**Returns to the scheduler until the condition is true, it is checked
+ every time the task runs.*/
+#define UKERNEL_CR_WAIT_UNTIL(condition)                                \
+    do                                                                  \
+    {                                                                   \
+        uKernelCurrentTask()->continuation = __LINE__;                  \
+        case __LINE__:                                                  \
+        if (!(condition))                                               \
+        {                                                               \
+            return;                                                     \
+        }                                                               \
+    } while (0)
+
+/**Starts the coroutine again from UKERNEL_CR_BEGIN() on its next run.*/
+#define UKERNEL_CR_RESTART()                                            \
+    do                                                                  \
+    {                                                                   \
+        uKernelCurrentTask()->continuation = 0;                         \
+        return;                                                         \
+    } while (0)
+
+/**Ends the body of the coroutine, must be the last statement. The next run
+ starts again from the beginning.*/
+#define UKERNEL_CR_END()                                                \
+    }                                                                   \
+    uKernelCurrentTask()->continuation = 0
+
+#endif	/* UKERNEL_COROUTINE_H */
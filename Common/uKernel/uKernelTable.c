@@ -0,0 +1,235 @@
+/**
+ *  @file           uKernelTable.c
+ *  @author         Luis Maduro
+ *  @version        1.0
+ *  @date           14/10/2026
+ *  @copyright		GNU General Public License
+ *
+ *  @brief Scheduler for a fixed set of tasks, described by a table in ROM.
+ */
+
+#include "uKernelTable.h"
+
+static const uKernelTableEntry *taskTable;
+static uKernelTableState *taskState;
+static uint8_t taskCount;
+static uint8_t taskCurrent = UKERNEL_TABLE_NONE;
+
+/**
+ * Starts the tasks of a table with the status they have in it. Call it
+ * after uKernelInit(), which starts _counterMs.
+ * @param table Tasks, in ROM.
+ * @param state Their RAM, UKERNEL_TABLE_STATE() of the table.
+ * @param count Tasks of the table, UKERNEL_TABLE_COUNT() (max 254).
+ */
+void uKernelTableInit(const uKernelTableEntry *table, uKernelTableState *state,
+                      uint8_t count)
+{
+    uint8_t i;
+    uint32_t now = _counterMs;
+
+    taskTable = table;
+    taskState = state;
+    taskCount = count;
+    taskCurrent = UKERNEL_TABLE_NONE;
+
+    for (i = 0; i < count; i++)
+    {
+        //I don't need the IMMEDIATESTART bit
+        state[i].status = table[i].status & 0x0B;
+        state[i].signaled = false;
+
+        if (table[i].status & 0x04)
+        {
+            state[i].plannedTask = now;
+            //an event task without timeout is only looked at when signaled
+            state[i].signaled = (table[i].status & UKERNEL_EVENT) != 0;
+        }
+        else
+        {
+            state[i].plannedTask = now + table[i].interval;
+        }
+    }
+}
+
+/**
+ * Tells if a task has to run.
+ */
+static bool uKernelTableIsDue(uint8_t index, uint32_t now)
+{
+    uKernelTableState *state = &taskState[index];
+
+    if (state->status == UKERNEL_PAUSED)
+    {
+        return false;
+    }
+
+    if (state->status & UKERNEL_EVENT)
+    {
+        if (state->signaled)
+        {
+            return true;
+        }
+
+        if (taskTable[index].interval == UKERNEL_NO_TIMEOUT)
+        {
+            return false;
+        }
+    }
+
+    //this trick overrun the overflow of _counterMs
+    return (int32_t) (now - state->plannedTask) >= 0;
+}
+
+/**
+ * Scheduler of the table, never returns. Each pass runs the first due task
+ * of the highest priority.
+ */
+void uKernelTableScheduler(void)
+{
+    uint8_t i;
+    uint8_t next;
+    uKernelTaskPriority priority;
+    uint32_t now;
+    uint32_t interval;
+    uKernelTableState *state;
+
+    while (1)
+    {
+#ifdef USE_DEFERRED_WORK
+        // the work posted by the interrupts goes before any task
+        DeferredWorkRun();
+#endif
+
+        now = _counterMs;
+        next = UKERNEL_TABLE_NONE;
+        priority = UKERNEL_PRIORITY_LOW;
+
+        for (i = 0; i < taskCount; i++)
+        {
+            if (((next == UKERNEL_TABLE_NONE) || (taskTable[i].priority > priority))
+                && uKernelTableIsDue(i, now))
+            {
+                next = i;
+                priority = taskTable[i].priority;
+            }
+        }
+
+        if (next == UKERNEL_TABLE_NONE)
+        {
+            UKERNEL_IDLE();
+            continue;
+        }
+
+        state = &taskState[next];
+        interval = taskTable[next].interval;
+
+        if (state->status & UKERNEL_ONETIME)
+        {
+            state->status = UKERNEL_PAUSED; //pause the task
+        }
+        else if (state->status & UKERNEL_EVENT)
+        {
+            //wait for the next signal or the timeout
+            state->signaled = false;
+            state->plannedTask = now + interval;
+        }
+        else if (interval == 0)
+        {
+            state->plannedTask = now;
+        }
+        else
+        {
+            //fixed rate, the periods missed completely are skipped
+            state->plannedTask += ((now - state->plannedTask) / interval + 1) * interval;
+        }
+
+        taskCurrent = next;
+        TRACE_TASK_BEGIN(taskTable[next].body);
+        taskTable[next].body(); //call the task
+        TRACE_TASK_END(taskTable[next].body);
+        taskCurrent = UKERNEL_TABLE_NONE;
+    }
+}
+
+/**
+ * Makes an event task run, can be called from the interrupts.
+ * @param index Index of the task in the table.
+ * @return False if it is not an event task.
+ */
+bool uKernelTableSignal(uint8_t index)
+{
+    if ((index >= taskCount) || ((taskState[index].status & UKERNEL_EVENT) == 0))
+    {
+        return false;
+    }
+
+    taskState[index].signaled = true;
+
+    return true;
+}
+
+/**
+ * Pauses a task.
+ * @param index Index of the task in the table.
+ * @return False if there is no such task.
+ */
+bool uKernelTablePause(uint8_t index)
+{
+    if (index >= taskCount)
+    {
+        return false;
+    }
+
+    taskState[index].status = UKERNEL_PAUSED;
+
+    return true;
+}
+
+/**
+ * Starts a paused task again, one interval from now. A task paused in the
+ * table starts as a periodic task.
+ * @param index Index of the task in the table.
+ * @return False if there is no such task.
+ */
+bool uKernelTableResume(uint8_t index)
+{
+    uint8_t status;
+
+    if (index >= taskCount)
+    {
+        return false;
+    }
+
+    status = taskTable[index].status & 0x0B;
+
+    taskState[index].plannedTask = _counterMs + taskTable[index].interval;
+    taskState[index].status = (status == UKERNEL_PAUSED) ? UKERNEL_SCHEDULED : status;
+
+    return true;
+}
+
+/**
+ * Status of a task.
+ * @param index Index of the task in the table.
+ * @return UKERNEL_PAUSED, UKERNEL_SCHEDULED, UKERNEL_ONETIME, UKERNEL_EVENT
+ *         or UKERNEL_ERROR if there is no such task.
+ */
+uKernelTaskStatus uKernelTableGetStatus(uint8_t index)
+{
+    if (index >= taskCount)
+    {
+        return UKERNEL_ERROR;
+    }
+
+    return (uKernelTaskStatus) taskState[index].status;
+}
+
+/**
+ * Index of the task that is running.
+ * @return Index in the table, UKERNEL_TABLE_NONE out of the tasks.
+ */
+uint8_t uKernelTableCurrent(void)
+{
+    return taskCurrent;
+}
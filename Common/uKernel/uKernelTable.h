@@ -0,0 +1,88 @@
+/**
+ *  @file           uKernelTable.h
+ *  @author         Luis Maduro
+ *  @version        1.0
+ *  @date           14/10/2026
+ *  @copyright		GNU General Public License
+ *
+ *  @brief Scheduler for a fixed set of tasks, described by a table in ROM.
+ *  The body, the interval, the first status and the priority of every task
+ *  are a const uKernelTableEntry, in the program memory of the PIC18 and in
+ *  the flash of the STM32. Only the next start, the status and the signal of
+ *  each task are in RAM, 6 bytes in a dense array of uKernelTableState next
+ *  to the table, in the same order: there are no add calls at startup and
+ *  no links to follow, the scheduler goes through the two arrays with an
+ *  index.
+ *  @code
+ *  const uKernelTableEntry tasks[] = {
+ *      {SensorTask, 100, UKERNEL_IMMEDIATESTART, UKERNEL_PRIORITY_NORMAL},
+ *      {RadioTask, UKERNEL_NO_TIMEOUT, UKERNEL_EVENT, UKERNEL_PRIORITY_HIGH},
+ *  };
+ *  UKERNEL_TABLE_STATE(taskState, tasks);
+ *
+ *  uKernelTableInit(tasks, taskState, UKERNEL_TABLE_COUNT(tasks));
+ *  uKernelTableScheduler();
+ *  @endcode
+ *
+ *  The tasks are the ones of uKernel without what a fixed set doesn't need:
+ *  periodic, one time and event tasks, with the priorities of uKernel, tasks of
+ *  the same priority run in the order of the table. A periodic task runs at a fixed
+ *  rate and skips the periods it missed completely (UKERNEL_POLICY_SKIP).
+ *  The tasks are reached by their index in the table. _counterMs, the
+ *  delays, UKERNEL_IDLE() and the deferred work are the ones of uKernel.c,
+ *  which is linked with this file but whose scheduler is not started: the
+ *  drivers that take an uKernelTaskDescriptor need uKernel itself.
+ */
+
+#ifndef UKERNEL_TABLE_H
+#define	UKERNEL_TABLE_H
+
+#include "uKernel.h"
+
+/**Number of tasks of a table.*/
+#define UKERNEL_TABLE_COUNT(table)  ((uint8_t) (sizeof (table) / sizeof ((table)[0])))
+
+/**Declares the RAM of the tasks of a table.*/
+#define UKERNEL_TABLE_STATE(name, table)    uKernelTableState name[UKERNEL_TABLE_COUNT(table)]
+
+/**Value returned for an index out of the table.*/
+#define UKERNEL_TABLE_NONE          0xFF
+
+/**
+ * Constant part of a task, in ROM.
+ */
+typedef struct
+{
+    /**Body of the task.*/
+    TaskBody body;
+    /**Interval in ms, or the timeout of an event task (UKERNEL_NO_TIMEOUT).*/
+    uint32_t interval;
+    /**Status at start: UKERNEL_PAUSED, UKERNEL_SCHEDULED, UKERNEL_ONETIME,
+     UKERNEL_EVENT or their immediate start versions.*/
+    uKernelTaskStatus status;
+    uKernelTaskPriority priority;
+} uKernelTableEntry;
+
+/**
+ * Changing part of a task, in RAM.
+ */
+typedef struct
+{
+    /**Next start, in ms of _counterMs.*/
+    uint32_t plannedTask;
+    /**UKERNEL_PAUSED, UKERNEL_SCHEDULED, UKERNEL_ONETIME or UKERNEL_EVENT.*/
+    uint8_t status;
+    /**Set by uKernelTableSignal(), cleared when the task is dispatched.*/
+    volatile uint8_t signaled;
+} uKernelTableState;
+
+void uKernelTableInit(const uKernelTableEntry *table, uKernelTableState *state,
+                      uint8_t count);
+void uKernelTableScheduler(void);
+bool uKernelTableSignal(uint8_t index);
+bool uKernelTablePause(uint8_t index);
+bool uKernelTableResume(uint8_t index);
+uKernelTaskStatus uKernelTableGetStatus(uint8_t index);
+uint8_t uKernelTableCurrent(void);
+
+#endif	/* UKERNEL_TABLE_H */
@@ -0,0 +1,23 @@
+/**
+ *  @file       BenchmarkConfig.h
+ *  @author     Luis Maduro
+ *  @version    1.00
+ *  @date       14/10/2026
+ *  @brief      Workloads of the driver benchmark on the PIC18F board.
+ */
+
+#ifndef BENCHMARKCONFIG_H
+#define BENCHMARKCONFIG_H
+
+#define BENCHMARK_PLATFORM          "pic18f"
+
+/**Fewer repetitions, the PIC18F is about 20 times slower.*/
+#define BENCHMARK_REPEAT            100
+/**The RAM of the PIC18F has no room for more.*/
+#define BENCHMARK_BUFFER_SIZE       128
+#define BENCHMARK_RADIO_PACKETS     50
+
+#define BENCHMARK_I2C
+#define BENCHMARK_RFM23
+
+#endif /* BENCHMARKCONFIG_H */
@@ -0,0 +1,206 @@
+/**
+ *  @file       main.c
+ *  @author     Luis Maduro
+ *  @version    1.00
+ *  @date       14/10/2026
+ *  @brief      Driver benchmark of the PIC18F, the results on the USART.
+ *
+ *  Runs DriverBenchmarkRun() once after the reset, the lines go out on the
+ *  USART at 115200 baud. Timer1, at FOSC / 32, gives the microseconds and
+ *  Timer0 the millisecond of the Tasker, used by the RFM23 driver. The
+ *  nIRQ of the RFM23 is on INT0. Built with XC8, with MASTER_RFM23 and
+ *  UKERNEL_STATIC_TASKS (for the Tasker) defined:
+ *  @code
+ *  PIC18F/Benchmark/main.c Common/Benchmark/DriverBenchmark.c
+ *  PIC18F/I2CDevice.c PIC18F/SPIDevice.c PIC18F/USARTDevice.c
+ *  Common/RFM23.c Common/Tasker/Tasker.c Common/uKernel/uKernel.c
+ *  Common/uCFIFO/uFIFO.c
+ *  @endcode
+ *  with PIC18F, Common and PIC18F/Benchmark in the include paths.
+ *
+ *  Copyright (C) 2026  Luis Maduro
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma config FOSC = HS
+#pragma config PLLEN = ON
+#pragma config PCLKEN = ON
+#pragma config FCMEN = ON
+#pragma config IESO = ON
+#pragma config PWRTEN = ON
+#pragma config BOREN = OFF
+#pragma config BORV = 19
+#pragma config WDTEN = OFF
+#pragma config WDTPS = 32768
+#pragma config HFOFST = OFF
+#pragma config MCLRE = ON
+#pragma config STVREN = ON
+#pragma config LVP = ON
+#pragma config BBSIZ = OFF
+#pragma config XINST = OFF
+#pragma config CP0 = OFF
+#pragma config CP1 = OFF
+#pragma config CPB = OFF
+#pragma config CPD = OFF
+#pragma config WRT0 = OFF
+#pragma config WRT1 = OFF
+#pragma config WRTC = OFF
+#pragma config WRTB = OFF
+#pragma config WRTD = OFF
+#pragma config EBTR0 = OFF
+#pragma config EBTR1 = OFF
+#pragma config EBTRB = OFF
+
+#include <xc.h>
+#include "BenchmarkConfig.h"
+#include "I2CDevice.h"
+#include "SPIDevice.h"
+#include "USARTDevice.h"
+#include "InterruptPriority.h"
+#include "Tasker/Tasker.h"
+#ifdef BENCHMARK_RFM23
+#include "RFM23.h"
+#endif
+#include "Benchmark/DriverBenchmark.h"
+
+#define BENCHMARK_BAUDRATE          115200
+
+/**Overflows of Timer1, every 65536 ticks of 0.5 us.*/
+static volatile uint32_t timer1Overflows;
+
+/**
+ * The tick and the time of the benchmark, the radio can't delay them.
+ */
+void interrupt HighIRQ(void)
+{
+    if (INTCONbits.TMR0IF == 1 && INTCONbits.TMR0IE == 1)
+    {
+        INTCONbits.TMR0IF = 0;
+        TMR0H = 0xE0;
+        TMR0L = 0xBE;
+        TaskerTimerInterruptHandler();
+    }
+
+    if (PIR1bits.TMR1IF == 1 && PIE1bits.TMR1IE == 1)
+    {
+        PIR1bits.TMR1IF = 0;
+        timer1Overflows++;
+    }
+}
+
+/**
+ * The radio, its FIFO is drained over the SPI inside the handler.
+ */
+void interrupt low_priority LowIRQ(void)
+{
+#ifdef BENCHMARK_RFM23
+    if (INTCON3bits.INT1IF == 1 && INTCON3bits.INT1IE == 1)
+    {
+        INTCON3bits.INT1IF = 0;
+        RFM2xInterruptHandler();
+    }
+#endif
+}
+
+/**
+ * Microseconds since BenchmarkInit(), from Timer1 and its overflows.
+ */
+uint32_t BenchmarkMicros(void)
+{
+    uint32_t overflows;
+    unsigned int ticks;
+
+    PIE1bits.TMR1IE = 0;
+
+    //TMR1H is latched by the read of TMR1L, RD16
+    ticks = TMR1L;
+    ticks |= (unsigned int) TMR1H << 8;
+    overflows = timer1Overflows;
+
+    //an overflow not yet counted by the interrupt
+    if ((PIR1bits.TMR1IF == 1) && (ticks < 0x8000))
+        overflows++;
+
+    PIE1bits.TMR1IE = 1;
+
+    return (overflows << 15) | (ticks >> 1);
+}
+
+/**
+ * Writes a line on the USART, waiting for every byte.
+ */
+void BenchmarkPrint(const char *line)
+{
+    USARTSendRAMString((char *) line);
+    USARTSendRAMString((char *) "\r\n");
+}
+
+static void BenchmarkInit(void)
+{
+    //Analog pins select
+    ANSEL = 0x00;
+    ANSELH = 0x00;
+
+    //Timer 0 - 1 ms @ 64MHz, for the Tasker
+    T0CONbits.TMR0ON = 1;
+    T0CONbits.T08BIT = 0;
+    T0CONbits.T0CS = 0;
+    T0CONbits.T0SE = 0;
+    T0CONbits.PSA = 0;
+    T0CONbits.T0PS = 0b000;
+
+    TMR0H = 0xE0;
+    TMR0L = 0xBE;
+    INTCONbits.TMR0IF = 0;
+    INTCON2bits.TMR0IP = INTERRUPT_PRIORITY_HIGH;
+    INTCONbits.TMR0IE = 1;
+
+    //Timer1 on FOSC / 4, prescaler 1:8, 16 bits read
+    TMR1H = 0;
+    TMR1L = 0;
+    T1CONbits.T1CKPS = 3;
+    T1CONbits.RD16 = 1;
+    PIR1bits.TMR1IF = 0;
+    IPR1bits.TMR1IP = INTERRUPT_PRIORITY_HIGH;
+    PIE1bits.TMR1IE = 1;
+    T1CONbits.TMR1ON = 1;
+
+#ifdef BENCHMARK_RFM23
+    //nIRQ of the RFM23, active low, on INT1: INT0 is always high priority
+    INTCON2bits.INTEDG1 = 0;
+    INTCON3bits.INT1IF = 0;
+    INTCON3bits.INT1IP = INTERRUPT_PRIORITY_LOW;
+    INTCON3bits.INT1IE = 1;
+#endif
+
+    InterruptPriorityEnable();
+}
+
+void main(void)
+{
+    BenchmarkInit();
+
+    USARTInit();
+    USARTSetBaudrate(BENCHMARK_BAUDRATE);
+    I2CInit();
+    SPIInit();
+#ifdef BENCHMARK_RFM23
+    RFM2xInit();
+#endif
+
+    DriverBenchmarkRun();
+
+    while (1);
+}
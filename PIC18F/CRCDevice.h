@@ -0,0 +1,55 @@
+/**
+ *  @file       CRCDevice.h
+ *  @brief      CRC-32 by table, the one of the CRC unit of the STM32F1
+ *  @author     Luis Maduro
+ *  @version    1.00
+ *  @date       14/10/2026
+ *
+ *  The CRC is the one of the CRC unit of the STM32F1: polynomial
+ *  0x04C11DB7, MSB first, no final complement (CRC-32/MPEG-2), computed on
+ *  the data taken as little endian 32 bit words from the start of every call
+ *  and the last 1 to 3 bytes one at a time. The checks written by one port
+ *  are read by the other. A check is computed with the same lengths of call
+ *  as it was written, or every call but the last is a multiple of 4 bytes.
+ *
+ *  There is no DMA, CRCDeviceStart() computes the CRC at once and
+ *  CRCDeviceIsBusy() is always false.
+ *
+ *  Copyright (C) 2026  Luis Maduro
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef _CRCDEV_H_
+#define _CRCDEV_H_
+
+#include <xc.h>
+#include <stdbool.h>
+#include <stdint.h>
+
+/**CRC of no data, the first value of a CRC carried over several calls.*/
+#define CRC_DEVICE_INIT         0xFFFFFFFFUL
+
+/**Set to 1 for a table of 256 entries (1 Kbyte of program memory, one
+ lookup per byte), 0 for a table of 16 entries (two lookups per byte).*/
+#ifndef CRC_DEVICE_TABLE
+#define CRC_DEVICE_TABLE        0
+#endif
+
+void CRCDeviceInit(void);
+uint32_t CRCDeviceCompute(uint32_t crc, const void *data, unsigned long length);
+void CRCDeviceStart(uint32_t crc, const void *data, unsigned long length);
+bool CRCDeviceIsBusy(void);
+uint32_t CRCDeviceGetResult(void);
+
+#endif /* _CRCDEV_H_ */
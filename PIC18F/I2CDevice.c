@@ -32,12 +32,71 @@
  *
  */
 
+#include <stddef.h>
 #include "I2CDevice.h"
 
+/**
+ * Steps of the interrupt driven transaction, each one ends with an
+ * interrupt of the MSSP.
+ */
+typedef enum
+{
+    I2C_STATE_IDLE,
+    I2C_STATE_START,
+    I2C_STATE_ADDRESS,
+    I2C_STATE_REGISTER,
+    I2C_STATE_WRITE,
+    I2C_STATE_RESTART,
+    I2C_STATE_READ_ADDRESS,
+    I2C_STATE_READ,
+    I2C_STATE_ACK,
+    I2C_STATE_STOP
+} tI2CState;
+
 /**This variable contains the address to read from the current device.*/
-unsigned char deviceAddressRead;
+ACCESS_RAM_DRIVER unsigned char deviceAddressRead;
 /**This variable contains the address to write to the current device.*/
-unsigned char deviceAddressWrite;
+ACCESS_RAM_DRIVER unsigned char deviceAddressWrite;
+
+/**Queue of transactions, the first one is being done by the interrupt.*/
+static tI2CTransaction *volatile queueHead = NULL;
+static tI2CTransaction *queueTail = NULL;
+/**Step of the current transaction.*/
+static volatile ACCESS_RAM_DRIVER tI2CState transactionState = I2C_STATE_IDLE;
+/**Next byte of the current transaction.*/
+static ACCESS_RAM_DRIVER unsigned char transactionIndex;
+/**Status given to the transaction after the stop.*/
+static tI2CTransactionStatus transactionResult;
+#ifdef I2C_USE_REGISTER_CACHE
+/**Device selected by I2CDeviceSelect(), NULL after
+ I2CDeviceSetDeviceAddress().*/
+static tI2CDevice *deviceCurrent = NULL;
+
+static void I2CDeviceCacheStore(tI2CDevice *device,
+                                unsigned char address,
+                                unsigned char length,
+                                unsigned char *data);
+#endif
+
+static unsigned char I2CDeviceReadForWrite(unsigned char address);
+
+/**
+ * Configures the MSSP as I2C master at I2C_SPEED.
+ * @warning Hardware specific!
+ */
+void I2CInit(void)
+{
+    I2CSCLPIN = 1;
+    I2CSDAPIN = 1;
+
+    I2CCON1bits.SSPEN = 0;
+    SSPCON1 = 0x08; //I2C master, clock = FOSC/(4 * (SSPADD + 1))
+    SSPCON2 = 0x00;
+    I2CSTATbits.SMP = (I2C_SPEED == 100000); //slew rate control off at 100 kHz
+    I2CBAUDREGISTER = I2CBAUDVALUE;
+    I2CINTERRUPTPRIORITY = I2C_DEVICE_HIGH_PRIORITY;
+    I2CCON1bits.SSPEN = 1;
+}
 
 /**
  * Sends a start condition to the I2C bus.
@@ -167,6 +226,9 @@ void I2CDeviceSetDeviceAddress(unsigned char address)
 {
     deviceAddressRead = (address << 1) | 0x01;
     deviceAddressWrite = (address << 1) & 0xFE;
+#ifdef I2C_USE_REGISTER_CACHE
+    deviceCurrent = NULL;
+#endif
 }
 
 /**
@@ -181,6 +243,8 @@ void I2CDeviceReadBytes(unsigned char address,
 {
     unsigned char i = 0;
 
+    while (I2CDeviceIsBusy());
+
     I2CStart();
     I2CWrite(deviceAddressWrite);
     I2CWrite(address);
@@ -202,6 +266,45 @@ void I2CDeviceReadBytes(unsigned char address,
         }
     }
 
+    I2CStop();
+
+#ifdef I2C_USE_REGISTER_CACHE
+    I2CDeviceCacheStore(deviceCurrent, address, length, data);
+#endif
+}
+
+/**
+ * Read multiple bytes from the current register of the device, without
+ * writing the register address first. For the devices whose register
+ * pointer moves by itself (i.e. the HMC5883L wraps back to its first data
+ * register), one transfer less per read.
+ * @param length Number of bytes to read
+ * @param data Buffer to store read data in
+ */
+void I2CDeviceReadCurrentBytes(unsigned char length,
+                               unsigned char *data)
+{
+    unsigned char i = 0;
+
+    while (I2CDeviceIsBusy());
+
+    I2CStart();
+    I2CWrite(deviceAddressRead);
+
+    for (i = 0; i < length; i++)
+    {
+        data[i] = I2CRead();
+
+        if (i == (length - 1))
+        {
+            I2CNotAck();
+        }
+        else
+        {
+            I2CAck();
+        }
+    }
+
     I2CStop();
 }
 
@@ -217,6 +320,8 @@ void I2CDeviceWriteBytes(unsigned char address,
 {
     unsigned char i;
 
+    while (I2CDeviceIsBusy());
+
     I2CStart();
     I2CWrite(deviceAddressWrite);
     I2CWrite(address);
@@ -226,50 +331,45 @@ void I2CDeviceWriteBytes(unsigned char address,
         I2CWrite(data[i]);
     }
     I2CStop();
+
+#ifdef I2C_USE_REGISTER_CACHE
+    I2CDeviceCacheStore(deviceCurrent, address, length, data);
+#endif
 }
 
 /**
- * Read a single bit from a device register.
- * @param address Register address to read from
- * @param _bit Bit in register position to read (0-7)
- * @return Single bit value
+ * Write several messages to the device in one transaction, joined by
+ * repeated starts, for devices that take a new address for every command.
+ * @param count Number of messages
+ * @param size Bytes of every message
+ * @param data Buffer with the messages one after the other
  */
-unsigned char I2CDeviceReadBit(unsigned char address,
-                               unsigned char _bit)
+void I2CDeviceWriteMessages(unsigned char count,
+                            unsigned char size,
+                            unsigned char *data)
 {
-    return (I2CDeviceReadByte(address) & (1 << _bit));
-}
-
-/**
- * Read multiple bits from a device register.
- * @param address Register address to read from
- * @param bitStart First bit position to read (0-7)
- * @param length Number of bits to read (not more than 8)
- * @return Right-aligned value (i.e. '101' read from any bitStart position will
- *                              equal 0x05)
- */
-unsigned char I2CDeviceReadBits(unsigned char address,
-                                unsigned char bitStart,
-                                unsigned char length)
-{
-    // 01101001 read byte
-    // 76543210 bit numbers
-    //    xxx   args: bitStart=4, length=3
-    //    010   masked
-    //   -> 010 shifted
     unsigned char i;
-    unsigned char b;
-    unsigned char r = 0;
 
-    b = I2CDeviceReadByte(address);
+    while (I2CDeviceIsBusy());
 
-    for (i = bitStart; i > bitStart - length; i--)
+    I2CStart();
+
+    while (count--)
     {
-        r |= (b & (1 << i));
+        I2CWrite(deviceAddressWrite);
+
+        for (i = 0; i < size; i++)
+        {
+            I2CWrite(*data++);
+        }
+
+        if (count)
+        {
+            I2CRestart();
+        }
     }
-    r >>= (bitStart - length + 1);
 
-    return r;
+    I2CStop();
 }
 
 /**
@@ -285,71 +385,504 @@ unsigned char I2CDeviceReadByte(unsigned char address)
 }
 
 /**
- * Write a single bit to a device register.
+ * Write some bits of a device register, the others keep their value.
  * @param address Register address to write to
- * @param _bit Bit position to write (0-7)
- * @param value New bit value to write
+ * @param mask Bits to write, i.e. REGISTER_FIELD_MASK() of the fields
+ * @param value New value of the bits, in place (REGISTER_FIELD_VALUE())
  */
-void I2CDeviceWriteBit(unsigned char address,
-                       unsigned char _bit,
-                       unsigned char value)
+void I2CDeviceUpdateByte(unsigned char address,
+                         unsigned char mask,
+                         unsigned char value)
 {
     unsigned char b;
 
-    b = I2CDeviceReadByte(address);
+    b = I2CDeviceReadForWrite(address);
 
-    b = value ? (b | (1 << _bit)) : (b & ~(1 << _bit));
+    b = (b & ~mask) | (value & mask);
 
     I2CDeviceWriteByte(address, b);
 }
 
 /**
- * Write multiple bits to a device register.
+ * Value of a register before changing some of its bits, from the cache of
+ * the selected device when possible.
+ * @param address Register address.
+ * @return Value of the register.
+ */
+static unsigned char I2CDeviceReadForWrite(unsigned char address)
+{
+#ifdef I2C_USE_REGISTER_CACHE
+    tI2CDevice *device = deviceCurrent;
+
+    if (device != NULL && device->cache != NULL &&
+        address < device->cacheSize &&
+        (device->cacheValid[address >> 3] & (1 << (address & 0x07))))
+    {
+        return device->cache[address];
+    }
+#endif
+
+    return I2CDeviceReadByte(address);
+}
+
+/**
+ * Write single byte to a device register.
  * @param address Register address to write to
- * @param bitStart First bit position to write (0-7)
- * @param length Number of bits to write (not more than 8)
- * @param value Right-aligned value to write
+ * @param value New byte value write
  */
-void I2CDeviceWriteBits(unsigned char address,
-                        unsigned char bitStart,
-                        unsigned char length,
+void I2CDeviceWriteByte(unsigned char address,
                         unsigned char value)
 {
-    //      010 value to write
-    // 76543210 bit numbers
-    //    xxx   args: bitStart=4, length=3
-    // 01000000 shift left (8 - length)    ]
-    // 00001000 shift right (7 - bitStart) ] ---    two shifts ensure all
-    //                                              non-important bits are 0
-    // 11100011 mask byte
-    // 10101111 original value (sample)
-    // 10100011 original & mask
-    // 10101011 masked | value
-    unsigned char b;
+    I2CDeviceWriteBytes(address, 1, &value);
+}
+
+/**
+ * Starts a transaction that runs in the background, driven by the MSSP
+ * interrupt: start, device address, register address, then the bytes to
+ * write or a repeated start and the bytes to read, and the stop. The CPU
+ * only works at each interrupt, so the scheduler keeps running during the
+ * transfer. The end is given by the callback of the transaction, from the
+ * interrupt, or by its status.
+ *
+ * If the bus is busy the transaction waits in a queue, so several drivers
+ * can use the bus without waiting for each other, and the transactions run
+ * in order. Consecutive transactions to the same device are joined with a
+ * repeated start instead of a stop and a start.
+ * @param transaction Transaction to do, it must stay valid until it ends.
+ * @return 0 if the transaction was started or queued, !=0 if it is not
+ *         valid or already queued.
+ */
+unsigned char I2CDeviceStartTransaction(tI2CTransaction *transaction)
+{
+    unsigned char interruptEnable;
+
+    if (transaction == NULL || transaction->status == I2C_TRANSACTION_BUSY ||
+        (transaction->direction != I2C_Direction_Transmitter &&
+         transaction->length == 0))
+        return 1;
+
+    transaction->status = I2C_TRANSACTION_BUSY;
+    transaction->next = NULL;
+
+    //the interrupt also changes the queue
+    interruptEnable = I2CINTERRUPTENABLE;
+    I2CINTERRUPTENABLE = 0;
+
+    if (queueHead == NULL)
+    {
+        queueHead = transaction;
+        queueTail = transaction;
+        transactionIndex = 0;
+        transactionResult = I2C_TRANSACTION_DONE;
+        transactionState = I2C_STATE_START;
+
+        I2CINTERRUPTFLAG = 0;
+        I2CINTERRUPTENABLE = 1;
+        I2CCON2bits.SEN = 1;
+    }
+    else
+    {
+        queueTail->next = transaction;
+        queueTail = transaction;
+        I2CINTERRUPTENABLE = interruptEnable;
+    }
+
+    return 0;
+}
+
+/**
+ * Queues a transaction to a device.
+ * @param device Device of the transaction.
+ * @param transaction Transaction to do, its device address is set.
+ * @return 0 if the transaction was started or queued, !=0 otherwise.
+ */
+unsigned char I2CDeviceQueueTransaction(tI2CDevice *device,
+                                        tI2CTransaction *transaction)
+{
+    transaction->deviceAddress = device->address;
+
+    return I2CDeviceStartTransaction(transaction);
+}
+
+/**
+ * Tells if interrupt driven transactions are running or queued. The
+ * blocking functions wait for them to end before using the bus.
+ * @return !=0 while a transaction is running.
+ */
+unsigned char I2CDeviceIsBusy(void)
+{
+    return transactionState != I2C_STATE_IDLE;
+}
+
+/**
+ * Keeps the transactions from ending while a driver changes data shared
+ * with its callbacks, the MSSP interrupt is disabled until I2CDeviceUnlock().
+ * @return State to give to I2CDeviceUnlock().
+ */
+unsigned char I2CDeviceLock(void)
+{
+    unsigned char state = I2CINTERRUPTENABLE;
+
+    I2CINTERRUPTENABLE = 0;
+
+    return state;
+}
+
+/**
+ * Ends I2CDeviceLock().
+ * @param state Value returned by I2CDeviceLock().
+ */
+void I2CDeviceUnlock(unsigned char state)
+{
+    I2CINTERRUPTENABLE = state;
+}
+
+/**
+ * Initializes the handle of a device, the address is kept in it so the
+ * drivers don't change each other's address.
+ * @param device Handle of the device.
+ * @param address Address of the slave NOT SHIFTED.
+ */
+void I2CDeviceInitHandle(tI2CDevice *device, unsigned char address)
+{
+    device->address = address;
+#ifdef I2C_USE_REGISTER_CACHE
+    device->cache = NULL;
+#endif
+}
+
+/**
+ * Selects the device of the functions that don't take a handle
+ * (I2CDeviceReadByte(), I2CDeviceWriteBits()...), like
+ * I2CDeviceSetDeviceAddress() but also using the cache of the device.
+ * @param device Handle of the device.
+ */
+void I2CDeviceSelect(tI2CDevice *device)
+{
+    I2CDeviceSetDeviceAddress(device->address);
+#ifdef I2C_USE_REGISTER_CACHE
+    deviceCurrent = device;
+#endif
+}
+
+#ifdef I2C_USE_REGISTER_CACHE
+
+/**
+ * Gives a cache of registers to a device. The registers read or written
+ * are kept in it, and I2CDeviceWriteBit() and I2CDeviceWriteBits() change
+ * the copy instead of reading the register over the bus. The registers
+ * written with a bus transfer that is not done by this library keep their
+ * copy, call I2CDeviceInvalidateCache() after a reset of the device.
+ * @param device Handle of the device.
+ * @param cache Copy of the registers 0 to size - 1.
+ * @param valid One bit per register, (size + 7) / 8 bytes.
+ * @param size Number of registers of the cache.
+ * @param uncacheable One bit per register, set for the registers changed
+ *                    by the device, (size + 7) / 8 bytes. NULL if all the
+ *                    registers are configuration registers.
+ */
+void I2CDeviceSetCache(tI2CDevice *device,
+                       unsigned char *cache,
+                       unsigned char *valid,
+                       unsigned char size,
+                       const unsigned char *uncacheable)
+{
+    device->cache = cache;
+    device->cacheValid = valid;
+    device->cacheSize = size;
+    device->uncacheable = uncacheable;
+
+    I2CDeviceInvalidateCache(device);
+}
+
+/**
+ * Drops the copies of the registers, the next writes of bits read the
+ * registers again.
+ * @param device Handle of the device.
+ */
+void I2CDeviceInvalidateCache(tI2CDevice *device)
+{
+    unsigned char i;
+
+    if (device->cache == NULL)
+        return;
+
+    for (i = 0; i < (device->cacheSize + 7) >> 3; i++)
+    {
+        device->cacheValid[i] = 0;
+    }
+}
+
+/**
+ * Keeps a copy of the registers transferred, the device auto increments
+ * the register address.
+ */
+static void I2CDeviceCacheStore(tI2CDevice *device,
+                                unsigned char address,
+                                unsigned char length,
+                                unsigned char *data)
+{
     unsigned char mask;
 
-    b = I2CDeviceReadByte(address);
+    if (device == NULL || device->cache == NULL)
+        return;
 
-    mask = (0xFF << (8 - length)) | (0xFF >> (bitStart + length - 1));
+    for (; length != 0 && address < device->cacheSize; length--, address++)
+    {
+        mask = 1 << (address & 0x07);
 
-    value <<= (8 - length);
+        if (device->uncacheable == NULL ||
+            !(device->uncacheable[address >> 3] & mask))
+        {
+            device->cache[address] = *data;
+            device->cacheValid[address >> 3] |= mask;
+        }
 
-    value >>= (7 - bitStart);
+        data++;
+    }
+}
+#endif
 
-    b &= mask;
+/**
+ * Reads registers of a device through the transaction queue, waiting for
+ * the end. The global interrupts must be enabled, don't call it from an
+ * interrupt.
+ * @param device Device to read from.
+ * @param address First register address to read from
+ * @param length Number of bytes to read
+ * @param data Buffer to store read data in
+ * @return 0 if all went well, !=0 if the device didn't acknowledge.
+ */
+unsigned char I2CDeviceRead(tI2CDevice *device,
+                            unsigned char address,
+                            unsigned char length,
+                            unsigned char *data)
+{
+    tI2CTransaction transaction;
 
-    b |= value;
+    transaction.registerAddress = address;
+    transaction.direction = I2C_Direction_Receiver;
+    transaction.length = length;
+    transaction.data = data;
+    transaction.callback = NULL;
+    transaction.status = I2C_TRANSACTION_IDLE;
 
-    I2CDeviceWriteByte(address, b);
+    if (I2CDeviceQueueTransaction(device, &transaction))
+        return 1;
+
+    while (transaction.status == I2C_TRANSACTION_BUSY);
+
+#ifdef I2C_USE_REGISTER_CACHE
+    if (transaction.status == I2C_TRANSACTION_DONE)
+    {
+        I2CDeviceCacheStore(device, address, length, data);
+    }
+#endif
+
+    return transaction.status != I2C_TRANSACTION_DONE;
 }
 
 /**
- * Write single byte to a device register.
- * @param address Register address to write to
- * @param value New byte value write
+ * Writes registers of a device through the transaction queue, waiting for
+ * the end. The global interrupts must be enabled, don't call it from an
+ * interrupt.
+ * @param device Device to write to.
+ * @param address First register address to write to
+ * @param length Number of bytes to write
+ * @param data Buffer to copy new data from
+ * @return 0 if all went well, !=0 if the device didn't acknowledge.
  */
-void I2CDeviceWriteByte(unsigned char address,
-                        unsigned char value)
+unsigned char I2CDeviceWrite(tI2CDevice *device,
+                             unsigned char address,
+                             unsigned char length,
+                             unsigned char *data)
 {
-    I2CDeviceWriteBytes(address, 1, &value);
+    tI2CTransaction transaction;
+
+    transaction.registerAddress = address;
+    transaction.direction = I2C_Direction_Transmitter;
+    transaction.length = length;
+    transaction.data = data;
+    transaction.callback = NULL;
+    transaction.status = I2C_TRANSACTION_IDLE;
+
+    if (I2CDeviceQueueTransaction(device, &transaction))
+        return 1;
+
+    while (transaction.status == I2C_TRANSACTION_BUSY);
+
+#ifdef I2C_USE_REGISTER_CACHE
+    if (transaction.status == I2C_TRANSACTION_DONE)
+    {
+        I2CDeviceCacheStore(device, address, length, data);
+    }
+#endif
+
+    return transaction.status != I2C_TRANSACTION_DONE;
+}
+
+/**
+ * Ends the first transaction of the queue, from the interrupt.
+ */
+static void I2CDeviceComplete(void)
+{
+    tI2CTransaction *transaction = queueHead;
+
+    queueHead = transaction->next;
+
+    if (queueHead == NULL)
+    {
+        queueTail = NULL;
+    }
+
+    transaction->status = transactionResult;
+
+    if (transaction->callback != NULL)
+    {
+        transaction->callback(transaction);
+    }
+
+    transactionIndex = 0;
+    transactionResult = I2C_TRANSACTION_DONE;
+}
+
+/**
+ * The bytes of the current transaction are done: a repeated start if the
+ * next one is to the same device, a stop otherwise.
+ */
+static void I2CDeviceFinish(void)
+{
+    tI2CTransaction *next = queueHead->next;
+
+    if (transactionResult == I2C_TRANSACTION_DONE && next != NULL &&
+        next->deviceAddress == queueHead->deviceAddress)
+    {
+        I2CDeviceComplete();
+        I2CCON2bits.RSEN = 1;
+        transactionState = I2C_STATE_START;
+    }
+    else
+    {
+        I2CCON2bits.PEN = 1;
+        transactionState = I2C_STATE_STOP;
+    }
+}
+
+/**
+ * This funtion is intended to be put in the interrupt funtion, it does the
+ * next step of the current transaction.
+ * @remarks This funtion checks and clears the MSSP interrupt flag, it does
+ * nothing if the flag is not set or no transaction is running.
+ */
+void I2CDeviceInterruptHandler(void)
+{
+    tI2CTransaction *transaction = queueHead;
+
+    if (!I2CINTERRUPTFLAG)
+        return;
+
+    I2CINTERRUPTFLAG = 0;
+
+    if (transactionState == I2C_STATE_IDLE)
+        return;
+
+    //a byte sent without ack ends the transaction
+    if ((transactionState == I2C_STATE_ADDRESS ||
+         transactionState == I2C_STATE_REGISTER ||
+         transactionState == I2C_STATE_WRITE ||
+         transactionState == I2C_STATE_READ_ADDRESS) &&
+        I2CCON2bits.ACKSTAT)
+    {
+        transactionResult = I2C_TRANSACTION_ERROR;
+        I2CDeviceFinish();
+        return;
+    }
+
+    switch (transactionState)
+    {
+        case I2C_STATE_START:
+            if (transaction->direction == I2C_Direction_ReceiverCurrent)
+            {
+                I2CBUF = (transaction->deviceAddress << 1) | 0x01;
+                transactionState = I2C_STATE_READ_ADDRESS;
+            }
+            else
+            {
+                I2CBUF = (transaction->deviceAddress << 1) & 0xFE;
+                transactionState = I2C_STATE_ADDRESS;
+            }
+            break;
+
+        case I2C_STATE_ADDRESS:
+            I2CBUF = transaction->registerAddress;
+            transactionState = I2C_STATE_REGISTER;
+            break;
+
+        case I2C_STATE_REGISTER:
+        case I2C_STATE_WRITE:
+            if (transaction->direction == I2C_Direction_Receiver)
+            {
+                I2CCON2bits.RSEN = 1;
+                transactionState = I2C_STATE_RESTART;
+            }
+            else if (transactionIndex < transaction->length)
+            {
+                I2CBUF = transaction->data[transactionIndex++];
+                transactionState = I2C_STATE_WRITE;
+            }
+            else
+            {
+                I2CDeviceFinish();
+            }
+            break;
+
+        case I2C_STATE_RESTART:
+            I2CBUF = (transaction->deviceAddress << 1) | 0x01;
+            transactionState = I2C_STATE_READ_ADDRESS;
+            break;
+
+        case I2C_STATE_READ_ADDRESS:
+            I2CCON2bits.RCEN = 1;
+            transactionState = I2C_STATE_READ;
+            break;
+
+        case I2C_STATE_READ:
+            transaction->data[transactionIndex++] = I2CBUF;
+            //not ack on the last byte
+            I2CCON2bits.ACKDT = (transactionIndex == transaction->length);
+            I2CCON2bits.ACKEN = 1;
+            transactionState = I2C_STATE_ACK;
+            break;
+
+        case I2C_STATE_ACK:
+            if (transactionIndex < transaction->length)
+            {
+                I2CCON2bits.RCEN = 1;
+                transactionState = I2C_STATE_READ;
+            }
+            else
+            {
+                I2CDeviceFinish();
+            }
+            break;
+
+        case I2C_STATE_STOP:
+            I2CDeviceComplete();
+
+            if (queueHead != NULL)
+            {
+                //next transaction, queued by another driver or the callback
+                I2CCON2bits.SEN = 1;
+                transactionState = I2C_STATE_START;
+            }
+            else
+            {
+                I2CINTERRUPTENABLE = 0;
+                transactionState = I2C_STATE_IDLE;
+            }
+            break;
+
+        default:
+            break;
+    }
 }
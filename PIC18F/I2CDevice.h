@@ -36,9 +36,16 @@
 #define _I2CDEV_H_
 
 #include <xc.h>
+#include "RegisterField.h"
+#include "AccessRAM.h"
 
-extern unsigned char deviceAddressRead;
-extern unsigned char deviceAddressWrite;
+extern ACCESS_RAM_DRIVER unsigned char deviceAddressRead;
+extern ACCESS_RAM_DRIVER unsigned char deviceAddressWrite;
+
+/**Define to keep a copy of the configuration registers of the devices, so
+ I2CDeviceWriteBit() and I2CDeviceWriteBits() don't read them over the bus.
+ See I2CDeviceSetCache().*/
+//#define I2C_USE_REGISTER_CACHE
 
 #define SYSTEM_OSCILATOR    16000000UL
 /**Selects the desired I2C clock speed.*/
@@ -61,9 +68,86 @@ extern unsigned char deviceAddressWrite;
 #define I2CBUF              SSPBUF
 /**The register that controls the clock speed*/
 #define I2CBAUDREGISTER     SSPADD
+/**The interrupt enable of the I2C module*/
+#define I2CINTERRUPTENABLE  PIE1bits.SSPIE
+/**The interrupt flag of the I2C module*/
+#define I2CINTERRUPTFLAG    PIR1bits.SSPIF
+/**The interrupt priority of the I2C module*/
+#define I2CINTERRUPTPRIORITY IPR1bits.SSPIP
+
+/**Priority of the interrupt, 1 for high, see InterruptPriority.h. I2C and
+ SPI share the SSPIP bit of MSSP1, the last Init sets it.*/
+#ifndef I2C_DEVICE_HIGH_PRIORITY
+#define I2C_DEVICE_HIGH_PRIORITY    0
+#endif
 
 #define  I2C_Direction_Transmitter      0x00
 #define  I2C_Direction_Receiver         0x01
+/**Direction of a transaction that reads from the current register of the
+ device, without writing the register first (i.e. status registers).*/
+#define  I2C_Direction_ReceiverCurrent  0x02
+
+/**
+ * Status of an interrupt driven transaction.
+ */
+typedef enum
+{
+    /**Not started or already seen by the user.*/
+    I2C_TRANSACTION_IDLE,
+    /**Running in the background.*/
+    I2C_TRANSACTION_BUSY,
+    /**Finished, all the bytes were transferred.*/
+    I2C_TRANSACTION_DONE,
+    /**Finished, the device didn't acknowledge.*/
+    I2C_TRANSACTION_ERROR
+} tI2CTransactionStatus;
+
+/**
+ * Register read or write done by the MSSP interrupt, see
+ * I2CDeviceStartTransaction(). The structure and the data buffer must stay
+ * valid until the transaction finishes.
+ */
+typedef struct _tI2CTransaction
+{
+    /**Address of the slave NOT SHIFTED.*/
+    unsigned char deviceAddress;
+    /**First register to read or write.*/
+    unsigned char registerAddress;
+    /**I2C_Direction_Transmitter to write, I2C_Direction_Receiver to read,
+     I2C_Direction_ReceiverCurrent to read without the register.*/
+    unsigned char direction;
+    /**Number of bytes to transfer.*/
+    unsigned char length;
+    /**Bytes to write or buffer for the bytes read.*/
+    unsigned char *data;
+    /**Called from the interrupt when the transaction finishes, can be NULL.*/
+    void (*callback)(struct _tI2CTransaction *transaction);
+    /**Status, can be polled instead of using the callback.*/
+    volatile tI2CTransactionStatus status;
+    /**Next transaction in the queue.*/
+    struct _tI2CTransaction *next;
+} tI2CTransaction;
+
+/**
+ * Handle of a device on the bus, each driver keeps its own.
+ */
+typedef struct _tI2CDevice
+{
+    /**Address of the slave NOT SHIFTED.*/
+    unsigned char address;
+#ifdef I2C_USE_REGISTER_CACHE
+    /**Copy of the registers 0 to cacheSize - 1, NULL for no cache.*/
+    unsigned char *cache;
+    /**One bit per register, set when its copy is valid.*/
+    unsigned char *cacheValid;
+    /**One bit per register, set for the registers changed by the device
+     (status, data, FIFO...), they are never cached. NULL if all the
+     registers are configuration registers.*/
+    const unsigned char *uncacheable;
+    /**Number of registers of the cache.*/
+    unsigned char cacheSize;
+#endif
+} tI2CDevice;
 
 void I2CInit(void);
 void I2CStart(void);
@@ -75,26 +159,60 @@ void I2CSendAddress(unsigned char Address, unsigned char I2C_Direction);
 unsigned char I2CWrite(unsigned char data_out);
 unsigned char I2CRead(void);
 void I2CDeviceSetDeviceAddress(unsigned char address);
-unsigned char I2CDeviceReadBit(unsigned char address,
-                               unsigned char _bit);
-unsigned char I2CDeviceReadBits(unsigned char address,
-                                unsigned char bitStart,
-                                unsigned char length);
 unsigned char I2CDeviceReadByte(unsigned char address);
 void I2CDeviceReadBytes(unsigned char address,
                         unsigned char length,
                         unsigned char *data);
-void I2CDeviceWriteBit(unsigned char address,
-                       unsigned char _bit,
-                       unsigned char value);
-void I2CDeviceWriteBits(unsigned char address,
-                        unsigned char bitStart,
-                        unsigned char length,
-                        unsigned char value);
+void I2CDeviceReadCurrentBytes(unsigned char length,
+                               unsigned char *data);
+void I2CDeviceUpdateByte(unsigned char address,
+                         unsigned char mask,
+                         unsigned char value);
 void I2CDeviceWriteByte(unsigned char address,
                         unsigned char value);
 void I2CDeviceWriteBytes(unsigned char address,
                          unsigned char length,
                          unsigned char *data);
+void I2CDeviceWriteMessages(unsigned char count,
+                            unsigned char size,
+                            unsigned char *data);
+unsigned char I2CDeviceStartTransaction(tI2CTransaction *transaction);
+unsigned char I2CDeviceQueueTransaction(tI2CDevice *device,
+                                        tI2CTransaction *transaction);
+unsigned char I2CDeviceIsBusy(void);
+unsigned char I2CDeviceLock(void);
+void I2CDeviceUnlock(unsigned char state);
+void I2CDeviceInitHandle(tI2CDevice *device, unsigned char address);
+void I2CDeviceSelect(tI2CDevice *device);
+#ifdef I2C_USE_REGISTER_CACHE
+void I2CDeviceSetCache(tI2CDevice *device,
+                       unsigned char *cache,
+                       unsigned char *valid,
+                       unsigned char size,
+                       const unsigned char *uncacheable);
+void I2CDeviceInvalidateCache(tI2CDevice *device);
+#endif
+unsigned char I2CDeviceRead(tI2CDevice *device,
+                            unsigned char address,
+                            unsigned char length,
+                            unsigned char *data);
+unsigned char I2CDeviceWrite(tI2CDevice *device,
+                             unsigned char address,
+                             unsigned char length,
+                             unsigned char *data);
+void I2CDeviceInterruptHandler(void);
+
+/**The bit accessors are macros over I2CDeviceReadByte() and
+ I2CDeviceUpdateByte(): with the positions of the drivers, constants, the
+ masks and the shifts are folded at compile time. See RegisterField.h.*/
+#define I2CDeviceReadBit(address, _bit)                                     \
+    (I2CDeviceReadByte(address) & REGISTER_BIT_MASK(_bit))
+#define I2CDeviceReadBits(address, bitStart, length)                        \
+    REGISTER_FIELD_GET(I2CDeviceReadByte(address), bitStart, length)
+#define I2CDeviceWriteBit(address, _bit, value)                             \
+    I2CDeviceUpdateByte((address), REGISTER_BIT_MASK(_bit), (value) ? 0xFF : 0)
+#define I2CDeviceWriteBits(address, bitStart, length, value)                \
+    I2CDeviceUpdateByte((address), REGISTER_FIELD_MASK(bitStart, length),  \
+                        REGISTER_FIELD_VALUE(bitStart, length, value))
 
 #endif /* _I2CDEV_H_ */
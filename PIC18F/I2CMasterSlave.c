@@ -38,6 +38,9 @@ unsigned int TXBufferIndex;
 
 FlagType Flag;
 
+/** Register map served by I2CSlaveRegisterMapInterrupt()*/
+static tI2CSlaveRegisterMap *slaveMap;
+
 /**
  * This funtion configures the I2C module to the specified parameters.
  * @param role Microcontroller role, defined by the DEVICE_TYPE enumerator.
@@ -61,10 +64,10 @@ void ConfigureI2CModule(DEVICE_TYPE role, I2C_SPEED speed, unsigned char address
      *                                                       ^
      *                                                       |
      *
-     * Also in slave mode, the default priority of the interrupt is high, and
-     * will be activated by default. The apropriate code must be written on the
-     * interrupts funtions to deal with the interrupts of I2C. You can change
-     * the interrupt priotity bellow in the respective bit.
+     * Also in slave mode, the interrupt will be activated by default, its
+     * priority is given by I2C_DEVICE_HIGH_PRIORITY (low by default). The
+     * apropriate code must be written on the interrupts funtions to deal with
+     * the interrupts of I2C.
      */
 
     /** The formula is:
@@ -98,7 +101,7 @@ void ConfigureI2CModule(DEVICE_TYPE role, I2C_SPEED speed, unsigned char address
         }
 
         I2C_INTERRUPT_FLAG = 0; //Clear the I2C interrut flag.
-        I2C_INTERRUPT_PRIORITY = 0; //Set the I2C interrupt priority to high.
+        I2C_INTERRUPT_PRIORITY = I2C_DEVICE_HIGH_PRIORITY; //Set the I2C interrupt priority.
         I2C_INTERRUPT_ENABLE = 0; //Enable the I2C interrupt.
         I2CCON1bits.SSPEN = 1;
     }
@@ -130,7 +133,7 @@ void ConfigureI2CModule(DEVICE_TYPE role, I2C_SPEED speed, unsigned char address
         I2C_CLOCK_OR_ADDRESS = (address << 1); // Sets the slave address to the specified address.
 
         I2C_INTERRUPT_FLAG = 0; //Clear the I2C interrut flag.
-        I2C_INTERRUPT_PRIORITY = 1; //Set the I2C interrupt priority to high.
+        I2C_INTERRUPT_PRIORITY = I2C_DEVICE_HIGH_PRIORITY; //Set the I2C interrupt priority.
         I2C_INTERRUPT_ENABLE = 1; //Enable the I2C interrupt.
         I2CCON1bits.SSPEN = 1;
     }
@@ -150,7 +153,7 @@ void ConfigureI2CModule(DEVICE_TYPE role, I2C_SPEED speed, unsigned char address
 void I2CSlaveParseInterrupt(void)
 {
     volatile unsigned char dummy = 0;
-    volatile unsigned char I2cState;
+    static unsigned char I2cState = I2C_ADDRESS_IN;
 
     /* have we just received a valid slave address? */
     if (I2CSTATbits.DA == MSSP_DA_ADDRESS)
@@ -171,16 +174,20 @@ void I2CSlaveParseInterrupt(void)
             /* master wants to read data so get byte from
                circular buffer and write it to SSPBUF */
             I2CCON1bits.WCOL = 0;
-            do
-            {
-                I2C_BUFFER = *TXDataPtr; //Read data from RAM & send data to I2C master device
-            }
-            while (I2CCON1bits.WCOL);
 
             if (TXBufferIndex < TXBufferSize)
             {
-                TXBufferIndex++;
-                TXDataPtr++;
+                do
+                {
+                    I2C_BUFFER = *TXDataPtr; //Read data from RAM & send data to I2C master device
+                }
+                while (I2CCON1bits.WCOL);
+
+                //the pointer stays on the last byte of the buffer
+                if (++TXBufferIndex < TXBufferSize)
+                {
+                    TXDataPtr++;
+                }
                 I2cState = I2C_DATA_OUT;
             }
             else
@@ -222,18 +229,22 @@ void I2CSlaveParseInterrupt(void)
             }
             else if (Flag.DataFlag)
             {
-                *RXDataPtr = (unsigned char) I2C_BUFFER; // store data into RAM
-
                 if (RXBufferIndex < RXBufferSize)
                 {
-                    RXBufferIndex++;
-                    RXDataPtr++;
+                    *RXDataPtr = (unsigned char) I2C_BUFFER; // store data into RAM
+
+                    //the pointer stays on the last byte of the buffer
+                    if (++RXBufferIndex < RXBufferSize)
+                    {
+                        RXDataPtr++;
+                    }
                     Flag.AddrFlag = 0; //next byte
                     Flag.DataFlag = 1;
                 }
                 else
                 {
                     /* oh dear, an overflow. Ignore rest of incomming data */
+                    dummy = I2C_BUFFER;
                     I2cState = I2C_DATA_DISCARD;
                 }
             }
@@ -247,16 +258,20 @@ void I2CSlaveParseInterrupt(void)
         if (!I2CSTATbits.BF && !I2CCON1bits.CKP)
         {
             I2CCON1bits.WCOL = 0;
-            do
-            {
-                I2C_BUFFER = *TXDataPtr; //Read data from RAM & send data to I2C master device
-            }
-            while (I2CCON1bits.WCOL);
 
             if (TXBufferIndex < TXBufferSize)
             {
-                TXBufferIndex++;
-                TXDataPtr++;
+                do
+                {
+                    I2C_BUFFER = *TXDataPtr; //Read data from RAM & send data to I2C master device
+                }
+                while (I2CCON1bits.WCOL);
+
+                //the pointer stays on the last byte of the buffer
+                if (++TXBufferIndex < TXBufferSize)
+                {
+                    TXDataPtr++;
+                }
                 I2cState = I2C_DATA_OUT;
             }
             else
@@ -293,3 +308,233 @@ void I2CSlaveParseInterrupt(void)
 
     I2C_INTERRUPT_FLAG = 0;
 }
+
+/**
+ * Configures the module as a slave serving a register map. The start and
+ * stop interrupts are enabled, to know the end of the transactions, and the
+ * clock stretching on reception is disabled. The banks start with the same
+ * content as bankA.
+ * @param map Register map.
+ * @param speed I2C bus speed, defined by the I2C_SPEED enumerator.
+ * @param address Slave address, 7 bits.
+ * @param bankA First bank of registers.
+ * @param bankB Second bank of registers, of the same size.
+ * @param size Number of registers of each bank.
+ */
+void I2CSlaveRegisterMapInit(tI2CSlaveRegisterMap *map, I2C_SPEED speed,
+                             unsigned char address, unsigned char *bankA,
+                             unsigned char *bankB, unsigned char size)
+{
+    unsigned char i;
+
+    I2C_INTERRUPT_ENABLE = 0;
+    I2CCON1bits.SSPEN = 0;
+
+    map->bank[0] = bankA;
+    map->bank[1] = bankB;
+    map->size = size;
+    map->writeFirst = 0;
+    map->writeCount = 0;
+    map->callback = NULL;
+    map->front = 0;
+    map->pointer = 0;
+    map->reading = 0;
+    map->pointerNext = 0;
+    map->writtenCount = 0;
+
+    for (i = 0; i < size; i++)
+    {
+        bankB[i] = bankA[i];
+    }
+
+    slaveMap = map;
+
+    I2CSTATbits.CKE = 0;
+    I2CSTATbits.SMP = (speed == I2C_SPEED_400KHZ) ? 1 : 0;
+    I2CCON1bits.WCOL = 0;
+    I2CCON1bits.SSPOV = 0;
+    //7 bit slave with start and stop interrupts
+    I2CCON1bits.SSPM = 0b1110;
+    I2CCON2bits.SEN = 0;
+    I2CCON1bits.CKP = 1;
+    I2C_CLOCK_OR_ADDRESS = (address << 1);
+
+    I2C_INTERRUPT_FLAG = 0;
+    I2C_INTERRUPT_PRIORITY = I2C_DEVICE_HIGH_PRIORITY;
+    I2C_INTERRUPT_ENABLE = 1;
+    I2CCON1bits.SSPEN = 1;
+}
+
+/**
+ * Sets the registers the master can write, in both banks. By default they
+ * are all read only.
+ * @param map Register map.
+ * @param first First register the master can write.
+ * @param count Number of registers.
+ * @param callback Called from the interrupt at the stop after a write, NULL
+ *                 to poll the registers.
+ */
+void I2CSlaveRegisterMapSetWritable(tI2CSlaveRegisterMap *map,
+                                    unsigned char first, unsigned char count,
+                                    tI2CSlaveWriteCallback callback)
+{
+    unsigned char interrupt = I2C_INTERRUPT_ENABLE;
+
+    I2C_INTERRUPT_ENABLE = 0;
+    map->writeFirst = first;
+    map->writeCount = count;
+    map->callback = callback;
+    I2C_INTERRUPT_ENABLE = interrupt;
+}
+
+/**
+ * Bank the application updates, not seen by the master until
+ * I2CSlaveRegisterMapPublish(). It changes on every publish.
+ * @param map Register map.
+ * @return The back bank.
+ */
+unsigned char *I2CSlaveRegisterMapBack(tI2CSlaveRegisterMap *map)
+{
+    return map->bank[map->front ^ 1];
+}
+
+/**
+ * Gives the back bank to the master, all the registers at once. The new
+ * back bank is loaded with it, so the application only updates the
+ * registers that change. The interrupt is off while it is copied, keep the
+ * map small (the module holds a byte of the master while it is off).
+ * @param map Register map.
+ * @return 0 if published, 1 if the master is reading, try again later.
+ */
+unsigned char I2CSlaveRegisterMapPublish(tI2CSlaveRegisterMap *map)
+{
+    unsigned char interrupt = I2C_INTERRUPT_ENABLE;
+    unsigned char *front;
+    unsigned char *back;
+    unsigned char i;
+
+    I2C_INTERRUPT_ENABLE = 0;
+
+    if (map->reading)
+    {
+        I2C_INTERRUPT_ENABLE = interrupt;
+        return 1;
+    }
+
+    map->front ^= 1;
+    front = map->bank[map->front];
+    back = map->bank[map->front ^ 1];
+
+    for (i = 0; i < map->size; i++)
+    {
+        back[i] = front[i];
+    }
+
+    I2C_INTERRUPT_ENABLE = interrupt;
+
+    return 0;
+}
+
+/**
+ * Interrupt handler of the register map, it has to be called from the
+ * interrupt routine instead of I2CSlaveParseInterrupt(). It checks and
+ * clears the flag itself.
+ */
+void I2CSlaveRegisterMapInterrupt(void)
+{
+    tI2CSlaveRegisterMap *map = slaveMap;
+    unsigned char data;
+    unsigned char pointer;
+
+    if (!I2C_INTERRUPT_FLAG)
+    {
+        return;
+    }
+
+    I2C_INTERRUPT_FLAG = 0;
+
+    if (I2CCON1bits.SSPOV)
+    {
+        //a byte of the master was lost, drop the rest of the write
+        data = I2C_BUFFER;
+        I2CCON1bits.SSPOV = 0;
+        map->pointerNext = 0;
+        map->writtenCount = 0;
+        return;
+    }
+
+    if (I2CSTATbits.RW == MSSP_RW_READ)
+    {
+        if (I2CSTATbits.DA == MSSP_DA_ADDRESS)
+        {
+            data = I2C_BUFFER;
+            map->reading = 1;
+        }
+
+        //the master ACKed the byte before, or this is the address
+        pointer = map->pointer;
+        I2CCON1bits.WCOL = 0;
+
+        if (pointer < map->size)
+        {
+            I2C_BUFFER = map->bank[map->front][pointer];
+            map->pointer = pointer + 1;
+        }
+        else
+        {
+            //past the end, 0xFF doesn't hold SDA low
+            I2C_BUFFER = 0xFF;
+        }
+
+        I2CCON1bits.CKP = 1;
+    }
+    else if (I2CSTATbits.BF)
+    {
+        data = I2C_BUFFER;
+
+        if (I2CSTATbits.DA == MSSP_DA_ADDRESS)
+        {
+            map->reading = 0;
+            map->pointerNext = 1;
+        }
+        else if (map->pointerNext)
+        {
+            map->pointerNext = 0;
+            map->pointer = data;
+        }
+        else
+        {
+            pointer = map->pointer;
+
+            if ((pointer >= map->writeFirst) &&
+                (pointer - map->writeFirst < map->writeCount) &&
+                (pointer < map->size))
+            {
+                //in both banks, the application sees it after a publish
+                map->bank[0][pointer] = data;
+                map->bank[1][pointer] = data;
+
+                if (map->writtenCount == 0)
+                {
+                    map->writtenFirst = pointer;
+                }
+
+                map->writtenCount++;
+            }
+
+            map->pointer = pointer + 1;
+        }
+    }
+    else if (I2CSTATbits.P)
+    {
+        map->reading = 0;
+        map->pointerNext = 0;
+
+        if ((map->writtenCount != 0) && (map->callback != NULL))
+        {
+            map->callback(map->writtenFirst, map->writtenCount);
+        }
+
+        map->writtenCount = 0;
+    }
+}
@@ -47,6 +47,12 @@
 /** Define to the I2C interrupt flag.*/
 #define I2C_INTERRUPT_FLAG      PIR1bits.SSPIF
 
+/**Priority of the interrupt, 1 for high, see InterruptPriority.h. The same
+ option and bit as I2CDevice.*/
+#ifndef I2C_DEVICE_HIGH_PRIORITY
+#define I2C_DEVICE_HIGH_PRIORITY    0
+#endif
+
 /** DO NOT MODIFY THE CODE BELLOW UNLESS YOU NOW WHAT YOU ARE DOING!*/
 
 /**
@@ -85,10 +91,62 @@ typedef struct
 
 extern FlagType Flag;
 
+/**
+ * Called from the interrupt, at the stop, after the master wrote registers.
+ * @param first First register written.
+ * @param count Number of registers written.
+ */
+typedef void (*tI2CSlaveWriteCallback)(unsigned char first, unsigned char count);
+
+/**
+ * Bank of registers seen by the master, for the slave register map.
+ *
+ * The master writes the register pointer and then the registers, or reads
+ * from the pointer on, and the pointer moves on by one for every byte. The
+ * registers are in two banks of the same size: the master reads from the
+ * front one while the application updates the back one, and
+ * I2CSlaveRegisterMapPublish() swaps them between two reads, so the
+ * multi-byte values read by the master are always from the same update.
+ * Every byte is ready in the interrupt, nothing is computed or copied
+ * there, and the reception doesn't stretch the clock.
+ */
+typedef struct
+{
+    /** The two banks, given by the application*/
+    unsigned char *bank[2];
+    /** Number of registers of each bank*/
+    unsigned char size;
+    /** Registers the master can write, the others are read only*/
+    unsigned char writeFirst;
+    unsigned char writeCount;
+    /** Called when the master wrote registers, can be NULL*/
+    tI2CSlaveWriteCallback callback;
+    /** Bank read by the master, 0 or 1*/
+    volatile unsigned char front;
+    /** Register pointer*/
+    volatile unsigned char pointer;
+    /** Set from the address of a read to the stop*/
+    volatile unsigned char reading;
+    /** Next byte written by the master is the pointer*/
+    unsigned char pointerNext;
+    /** Registers written by the master in this transaction*/
+    unsigned char writtenFirst;
+    unsigned char writtenCount;
+} tI2CSlaveRegisterMap;
+
 void ConfigureI2CModule(DEVICE_TYPE role, I2C_SPEED speed, unsigned char address,
                         unsigned char *RXBuffer, unsigned int RXBSize,
                         unsigned char *TXBuffer, unsigned int TXBSize);
 void I2CSlaveParseInterrupt(void);
+void I2CSlaveRegisterMapInit(tI2CSlaveRegisterMap *map, I2C_SPEED speed,
+                             unsigned char address, unsigned char *bankA,
+                             unsigned char *bankB, unsigned char size);
+void I2CSlaveRegisterMapSetWritable(tI2CSlaveRegisterMap *map,
+                                    unsigned char first, unsigned char count,
+                                    tI2CSlaveWriteCallback callback);
+unsigned char *I2CSlaveRegisterMapBack(tI2CSlaveRegisterMap *map);
+unsigned char I2CSlaveRegisterMapPublish(tI2CSlaveRegisterMap *map);
+void I2CSlaveRegisterMapInterrupt(void);
 
 
 #define MSSP_DA_DATA        1
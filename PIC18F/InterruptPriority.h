@@ -0,0 +1,89 @@
+/**
+ *  @file       InterruptPriority.h
+ *  @brief      Two levels of interrupts for the drivers of the PIC18.
+ *  @author     Luis Maduro
+ *  @version    1.00
+ *  @date       14/10/2026
+ *
+ *  With IPEN clear every interrupt goes to the vector at 0x0008 and a slow
+ *  handler, i.e. the drain of the FIFO of a radio over the SPI, holds the
+ *  timer of the tick and the reception of the USART until it returns. With
+ *  InterruptPriorityEnable() the interrupts of IPRx set go to the high
+ *  vector and the others to the low vector at 0x0018. A high interrupt
+ *  stops a low handler, so the delay of the tick is only the one of the
+ *  other high handlers.
+ *
+ *  Each driver sets the IPRx bit of its interrupt in its Init from its
+ *  _HIGH_PRIORITY option:
+ *  - USART_HIGH_PRIORITY, 1: the 2 bytes of the module overrun in 170 us at
+ *    115200 baud;
+ *  - I2C_DEVICE_HIGH_PRIORITY and SPI_DEVICE_HIGH_PRIORITY, 0: the MSSP
+ *    waits for its interrupt, the clock is held. Both set the same SSPIP
+ *    bit of MSSP1, the last Init of I2C or SPI wins, so give them the same
+ *    value;
+ *  - ONEWIRE_ASYNC_HIGH_PRIORITY, 1: a slot is timed by the interrupt.
+ *  The application sets the bits of its own interrupts, the timer of the
+ *  tick high (INTCON2bits.TMR0IP), the pin of a radio low. INT0 has no
+ *  priority bit, it is always high: a radio goes on INT1 or INT2.
+ *
+ *  The application defines the two handlers and calls the handlers of the
+ *  drivers of each level, each one checks its own flags:
+ *  @code
+ *  void interrupt HighIRQ(void)
+ *  {
+ *      if (INTCONbits.TMR0IF == 1 && INTCONbits.TMR0IE == 1)
+ *      {
+ *          INTCONbits.TMR0IF = 0;
+ *          TaskerTimerInterruptHandler();
+ *      }
+ *      USARTInterruptHandler();
+ *  }
+ *
+ *  void interrupt low_priority LowIRQ(void)
+ *  {
+ *      SPIDeviceInterruptHandler();
+ *      if (INTCON3bits.INT1IF == 1 && INTCON3bits.INT1IE == 1)
+ *      {
+ *          INTCON3bits.INT1IF = 0;
+ *          RFM2xInterruptHandler();
+ *      }
+ *  }
+ *  @endcode
+ *  XC8 returns from the high handler with RETFIE FAST, WREG, STATUS and BSR
+ *  are in the shadow registers. The low handler saves them itself, a high
+ *  interrupt taken meanwhile would overwrite the shadow registers. With C18
+ *  the handlers are given by #pragma interrupt and #pragma interruptlow.
+ *
+ *  A function called from both levels is duplicated by XC8. The main loop
+ *  masks a single interrupt with its PIExbits enable bit, as the drivers
+ *  do. Clearing INTCONbits.GIEH masks both levels, and clearing
+ *  INTCONbits.GIEL masks only the low one.
+ *
+ *  Copyright (C) 2026  Luis Maduro
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef INTERRUPTPRIORITY_H
+#define INTERRUPTPRIORITY_H
+
+#include <xc.h>
+
+#define INTERRUPT_PRIORITY_HIGH         1
+#define INTERRUPT_PRIORITY_LOW          0
+
+/**Two vectors, then both levels enabled.*/
+#define InterruptPriorityEnable()       (RCONbits.IPEN = 1, INTCONbits.GIEH = 1, INTCONbits.GIEL = 1)
+
+#endif /* INTERRUPTPRIORITY_H */
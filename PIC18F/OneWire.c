@@ -116,6 +116,15 @@ sample code bearing this copyright.
 
 #include "OneWire.h"
 
+#if ONEWIRE_OVERDRIVE
+// Delays of the overdrive slots, too short for Timer 3 and a call
+#ifndef ONEWIRE_OVERDRIVE_DELAY
+#define ONEWIRE_OVERDRIVE_DELAY(uSec) __delay_us(uSec)
+#endif
+
+static unsigned char oneWireSpeed = ONEWIRE_SPEED_STANDARD;
+#endif
+
 void OneWireInit(void)
 {
     //Timer 3 incretments at 1us @ 32MHz
@@ -175,6 +184,30 @@ unsigned char OneWireReset(void)
     unsigned char r;
     unsigned char retries = 125;
 
+#if ONEWIRE_OVERDRIVE
+    if (oneWireSpeed == ONEWIRE_SPEED_OVERDRIVE)
+    {
+        // overdrive: 70us low, presence sampled at 8.5us
+        InterruptsOFF();
+        ONEWIRE_PIN_DIRECTION = INPUT;
+        ONEWIRE_OVERDRIVE_DELAY(3);
+        ONEWIRE_PIN_WRITE = LOW;
+        ONEWIRE_PIN_DIRECTION = OUTPUT; // drive output low
+        ONEWIRE_OVERDRIVE_DELAY(70);
+        ONEWIRE_PIN_DIRECTION = INPUT; // allow it to float
+        ONEWIRE_OVERDRIVE_DELAY(8);
+        r = !ONEWIRE_PIN_READ;
+        InterruptsON();
+        ONEWIRE_OVERDRIVE_DELAY(40);
+
+        if (r)
+            return r;
+
+        // nobody at overdrive, back to the standard speed
+        oneWireSpeed = ONEWIRE_SPEED_STANDARD;
+    }
+#endif
+
     InterruptsOFF();
     ONEWIRE_PIN_DIRECTION = INPUT;
     InterruptsON();
@@ -207,6 +240,30 @@ unsigned char OneWireReset(void)
 
 void OneWireWriteBit(unsigned char v)
 {
+#if ONEWIRE_OVERDRIVE
+    if (oneWireSpeed == ONEWIRE_SPEED_OVERDRIVE)
+    {
+        // the whole overdrive slot is shorter than an interrupt
+        InterruptsOFF();
+        ONEWIRE_PIN_WRITE = LOW;
+        ONEWIRE_PIN_DIRECTION = OUTPUT; // drive output low
+        if (v & 1)
+        {
+            ONEWIRE_OVERDRIVE_DELAY(1);
+            ONEWIRE_PIN_WRITE = HIGH; // drive output high
+            ONEWIRE_OVERDRIVE_DELAY(8);
+        }
+        else
+        {
+            ONEWIRE_OVERDRIVE_DELAY(8);
+            ONEWIRE_PIN_WRITE = HIGH; // drive output high
+            ONEWIRE_OVERDRIVE_DELAY(3);
+        }
+        InterruptsON();
+        return;
+    }
+#endif
+
     if (v & 1)
     {
         InterruptsOFF();
@@ -238,6 +295,22 @@ unsigned char OneWireReadBit(void)
 {
     unsigned char r;
 
+#if ONEWIRE_OVERDRIVE
+    if (oneWireSpeed == ONEWIRE_SPEED_OVERDRIVE)
+    {
+        InterruptsOFF();
+        ONEWIRE_PIN_DIRECTION = OUTPUT;
+        ONEWIRE_PIN_WRITE = LOW;
+        ONEWIRE_OVERDRIVE_DELAY(1);
+        ONEWIRE_PIN_DIRECTION = INPUT; // let pin float, pull up will raise
+        ONEWIRE_OVERDRIVE_DELAY(1);
+        r = ONEWIRE_PIN_READ;
+        ONEWIRE_OVERDRIVE_DELAY(7);
+        InterruptsON();
+        return r;
+    }
+#endif
+
     InterruptsOFF();
     ONEWIRE_PIN_DIRECTION = OUTPUT;
     ONEWIRE_PIN_WRITE = LOW;
@@ -318,6 +391,49 @@ void OneWireSkip(void)
     OneWireWrite(0xCC); // Skip ROM
 }
 
+#if ONEWIRE_OVERDRIVE
+
+void OneWireSetSpeed(unsigned char speed)
+{
+    oneWireSpeed = speed;
+}
+
+unsigned char OneWireGetSpeed(void)
+{
+    return oneWireSpeed;
+}
+
+unsigned char OneWireOverdriveSkip(void)
+{
+    // the command is sent at standard speed, the devices change after it
+    oneWireSpeed = ONEWIRE_SPEED_STANDARD;
+    OneWireWrite(OVERDRIVE_SKIP_ROM);
+    oneWireSpeed = ONEWIRE_SPEED_OVERDRIVE;
+
+    // OneWireReset() falls back to the standard speed if nobody answers
+    OneWireReset();
+
+    return oneWireSpeed == ONEWIRE_SPEED_OVERDRIVE;
+}
+
+unsigned char OneWireOverdriveSelect(tLaseredROMCode *device)
+{
+    unsigned char i;
+
+    oneWireSpeed = ONEWIRE_SPEED_STANDARD;
+    OneWireWrite(OVERDRIVE_MATCH_ROM);
+    // the ROM already goes at overdrive speed
+    oneWireSpeed = ONEWIRE_SPEED_OVERDRIVE;
+
+    for (i = 0; i < 8; i++)
+        OneWireWrite(device->Array[i]);
+
+    OneWireReset();
+
+    return oneWireSpeed == ONEWIRE_SPEED_OVERDRIVE;
+}
+#endif
+
 #if ONEWIRE_SEARCH
 
 //
@@ -370,7 +486,7 @@ void OneWireTargetSearch(unsigned char family_code)
 //        FALSE : device not found, end of search
 //
 
-unsigned char OneWireSearch()
+static unsigned char OneWireSearchCommand(unsigned char command)
 {
     unsigned char id_bit_number;
     unsigned char last_zero, rom_byte_number, search_result;
@@ -399,7 +515,7 @@ unsigned char OneWireSearch()
         }
 
         // issue the search command
-        OneWireWrite(0xF0);
+        OneWireWrite(command);
 
         // loop to do the search
         do
@@ -488,6 +604,16 @@ unsigned char OneWireSearch()
     return search_result;
 }
 
+unsigned char OneWireSearch(void)
+{
+    return OneWireSearchCommand(0xF0);
+}
+
+unsigned char OneWireAlarmSearch(void)
+{
+    return OneWireSearchCommand(0xEC);
+}
+
 /**
  * @brief Performs a full search for devices on 1-Wire Bus.
  * @param romcode Pointer to Lasered_ROM_Code type array to store the devices
@@ -528,6 +654,221 @@ void OneWireFindAllDevicesOnBus(tLaseredROMCode *romcode, unsigned char *num_dev
 
     *num_devices = devNum;
 }
+
+//
+// Verify a device: a search with the state set so that the only branch
+// taken is its ROM, the device is there if the search ends on it.
+//
+
+unsigned char OneWireVerify(tLaseredROMCode *device)
+{
+    unsigned char rom_backup[8];
+    unsigned char ld_backup, ldf_backup, lfd_backup;
+    unsigned char i, result;
+
+    // keep the search state
+    for (i = 0; i < 8; i++)
+    {
+        rom_backup[i] = ROM_NO[i];
+        ROM_NO[i] = device->Array[i];
+    }
+    ld_backup = LastDiscrepancy;
+    ldf_backup = LastDeviceFlag;
+    lfd_backup = LastFamilyDiscrepancy;
+
+    LastDiscrepancy = 64;
+    LastDeviceFlag = FALSE;
+
+    result = OneWireSearch();
+
+    for (i = 0; i < 8; i++)
+    {
+        if (ROM_NO[i] != device->Array[i])
+            result = FALSE;
+
+        ROM_NO[i] = rom_backup[i];
+    }
+    LastDiscrepancy = ld_backup;
+    LastDeviceFlag = ldf_backup;
+    LastFamilyDiscrepancy = lfd_backup;
+
+    return result;
+}
+
+static void OneWireInventorySetPresent(tOneWireInventory *inventory,
+                                       unsigned char index,
+                                       unsigned char present)
+{
+    if (present)
+        inventory->present[index >> 3] |= (1 << (index & 0x07));
+    else
+        inventory->present[index >> 3] &= ~(1 << (index & 0x07));
+}
+
+//
+// Adds the device of the last search (ROM_NO) if it isn't in the inventory
+// and marks it present. Returns its index, ONEWIRE_INVENTORY_NONE if the ROM
+// is not valid or the inventory is full. *added is set if it is new.
+//
+
+static unsigned char OneWireInventoryAddFound(tOneWireInventory *inventory,
+                                              unsigned char *added)
+{
+    unsigned char rom[8];
+    unsigned char i, index;
+
+    for (i = 0; i < 8; i++)
+        rom[i] = ROM_NO[i];
+
+    *added = FALSE;
+
+    if (rom[7] != OneWireCRC8(rom, 7))
+        return ONEWIRE_INVENTORY_NONE;
+
+    index = OneWireInventoryFind(inventory, rom);
+
+    if (index == ONEWIRE_INVENTORY_NONE)
+    {
+        if (inventory->count >= ONEWIRE_INVENTORY_SIZE)
+            return ONEWIRE_INVENTORY_NONE;
+
+        index = inventory->count++;
+        for (i = 0; i < 8; i++)
+            inventory->devices[index].Array[i] = rom[i];
+        *added = TRUE;
+    }
+
+    OneWireInventorySetPresent(inventory, index, TRUE);
+    return index;
+}
+
+void OneWireInventoryClear(tOneWireInventory *inventory)
+{
+    unsigned char i;
+
+    inventory->count = 0;
+    for (i = 0; i < sizeof (inventory->present); i++)
+        inventory->present[i] = 0;
+    OneWireInventorySeal(inventory);
+}
+
+unsigned char OneWireInventoryFind(tOneWireInventory *inventory,
+                                   const unsigned char *rom)
+{
+    unsigned char index, i;
+
+    for (index = 0; index < inventory->count; index++)
+    {
+        for (i = 0; i < 8; i++)
+        {
+            if (inventory->devices[index].Array[i] != rom[i])
+                break;
+        }
+
+        if (i == 8)
+            return index;
+    }
+
+    return ONEWIRE_INVENTORY_NONE;
+}
+
+unsigned char OneWireInventoryDiscover(tOneWireInventory *inventory,
+                                       unsigned char family)
+{
+    unsigned char added, new_devices = 0;
+
+    if (family != 0)
+        OneWireTargetSearch(family);
+    else
+        OneWireResetSearch();
+
+    while (OneWireSearch())
+    {
+        // the targeted search goes on to the other families at the end
+        if ((family != 0) && (ROM_NO[0] != family))
+            break;
+
+        OneWireInventoryAddFound(inventory, &added);
+        new_devices += added;
+    }
+
+    OneWireResetSearch();
+    OneWireInventorySeal(inventory);
+
+    return new_devices;
+}
+
+unsigned char OneWireInventoryVerify(tOneWireInventory *inventory)
+{
+    unsigned char index, found, present = 0;
+
+    for (index = 0; index < inventory->count; index++)
+    {
+        found = OneWireVerify(&inventory->devices[index]);
+        OneWireInventorySetPresent(inventory, index, found);
+        present += found;
+    }
+
+    return present;
+}
+
+unsigned char OneWireInventoryIsPresent(tOneWireInventory *inventory,
+                                        unsigned char index)
+{
+    if (index >= inventory->count)
+        return FALSE;
+
+    return (inventory->present[index >> 3] >> (index & 0x07)) & 0x01;
+}
+
+unsigned char OneWireInventoryAlarms(tOneWireInventory *inventory,
+                                     unsigned char *alarms, unsigned char max)
+{
+    unsigned char index, added, number = 0;
+
+    OneWireResetSearch();
+
+    while ((number < max) && OneWireAlarmSearch())
+    {
+        index = OneWireInventoryAddFound(inventory, &added);
+
+        if (index != ONEWIRE_INVENTORY_NONE)
+            alarms[number++] = index;
+    }
+
+    OneWireResetSearch();
+    OneWireInventorySeal(inventory);
+
+    return number;
+}
+
+//
+// CRC8 of the devices and the count, OneWireCRC8() is limited to 255 bytes.
+//
+
+static unsigned char OneWireInventoryCRC(tOneWireInventory *inventory)
+{
+    unsigned char *data = inventory->devices[0].Array;
+    unsigned int len = sizeof (inventory->devices) + 1;
+    unsigned char crc = 0;
+
+    while (len--)
+    {
+        crc = OneWireCRC8Update(crc, *data++);
+    }
+    return crc;
+}
+
+void OneWireInventorySeal(tOneWireInventory *inventory)
+{
+    inventory->crc = OneWireInventoryCRC(inventory);
+}
+
+bool OneWireInventoryIsValid(tOneWireInventory *inventory)
+{
+    return (inventory->count <= ONEWIRE_INVENTORY_SIZE) &&
+            (inventory->crc == OneWireInventoryCRC(inventory));
+}
 #endif
 
 #if ONEWIRE_CRC
@@ -535,7 +876,7 @@ void OneWireFindAllDevicesOnBus(tLaseredROMCode *romcode, unsigned char *num_dev
 // "Understanding and Using Cyclic Redundancy Checks with Maxim iButton Products"
 //
 
-#if ONEWIRE_CRC8_TABLE
+#if ONEWIRE_CRC8_TABLE == 1
 // This table comes from Dallas sample code where it is freely reusable,
 // though Copyright (C) 2000 Dallas Semiconductor Corporation
 static const unsigned char dscrc_table[] = {
@@ -558,27 +899,57 @@ static const unsigned char dscrc_table[] = {
 };
 
 //
-// Compute a Dallas Semiconductor 8 bit CRC. These show up in the ROM
+// Fold a byte in a Dallas Semiconductor 8 bit CRC. These show up in the ROM
 // and the registers.  (note: this might better be done without to
 // table, it would probably be smaller and certainly fast enough
 // compared to all those delayMicrosecond() calls.  But I got
 // confused, so I use this table from the examples.)
 //
 
-unsigned char OneWireCRC8(const unsigned char *addr, unsigned char len)
+unsigned char OneWireCRC8Update(unsigned char crc, unsigned char inbyte)
 {
-    unsigned char crc = 0;
+    return dscrc_table[crc ^ inbyte];
+}
+#elif ONEWIRE_CRC8_TABLE == 2
+// CRC of the 16 values of a nibble, the byte is folded in two lookups:
+// crc = table[low nibble] ^ (crc >> 4), twice.
+static const unsigned char dscrc_nibble_table[16] = {
+    0x00, 0x9D, 0x23, 0xBE, 0x46, 0xDB, 0x65, 0xF8,
+    0x8C, 0x11, 0xAF, 0x32, 0xCA, 0x57, 0xE9, 0x74
+};
 
-    while (len--)
+//
+// Fold a byte in a Dallas Semiconductor 8 bit CRC with the nibble table,
+// about 4 times faster than bit by bit for 16 bytes of ROM.
+//
+
+unsigned char OneWireCRC8Update(unsigned char crc, unsigned char inbyte)
+{
+    crc ^= inbyte;
+    crc = dscrc_nibble_table[crc & 0x0F] ^ (crc >> 4);
+    return dscrc_nibble_table[crc & 0x0F] ^ (crc >> 4);
+}
+#else
+//
+// Fold a byte in a Dallas Semiconductor 8 bit CRC directly.
+// this is much slower, but much smaller, than the lookup table.
+//
+
+unsigned char OneWireCRC8Update(unsigned char crc, unsigned char inbyte)
+{
+    for (unsigned char i = 8; i; i--)
     {
-        crc = dscrc_table[crc ^ *addr++];
+        unsigned char mix = (crc ^ inbyte) & 0x01;
+        crc >>= 1;
+        if (mix) crc ^= 0x8C;
+        inbyte >>= 1;
     }
     return crc;
 }
-#else
+#endif
+
 //
-// Compute a Dallas Semiconductor 8 bit CRC directly.
-// this is much slower, but much smaller, than the lookup table.
+// Compute a Dallas Semiconductor 8 bit CRC.
 //
 
 unsigned char OneWireCRC8(unsigned char *addr, unsigned char len)
@@ -587,18 +958,27 @@ unsigned char OneWireCRC8(unsigned char *addr, unsigned char len)
 
     while (len--)
     {
-        unsigned char inbyte = *addr++;
-        for (unsigned char i = 8; i; i--)
-        {
-            unsigned char mix = (crc ^ inbyte) & 0x01;
-            crc >>= 1;
-            if (mix) crc ^= 0x8C;
-            inbyte >>= 1;
-        }
+        crc = OneWireCRC8Update(crc, *addr++);
+    }
+    return crc;
+}
+
+//
+// Read bytes computing their CRC as they arrive, the CRC of a scratchpad
+// read with its CRC byte is 0 when it is right.
+//
+
+unsigned char OneWireReadBytesCRC8(unsigned char *buf, unsigned int count)
+{
+    unsigned char crc = 0;
+
+    for (unsigned int i = 0; i < count; i++)
+    {
+        buf[i] = OneWireRead();
+        crc = OneWireCRC8Update(crc, buf[i]);
     }
     return crc;
 }
-#endif
 
 #if ONEWIRE_CRC16
 
@@ -608,25 +988,42 @@ bool OneWireCheckCRC16(const unsigned char* input, unsigned int len, const unsig
     return (crc & 0xFF) == inverted_crc[0] && (crc >> 8) == inverted_crc[1];
 }
 
-unsigned int OneWireCRC16(const unsigned char* input, unsigned int len, unsigned int crc)
+unsigned int OneWireCRC16Update(unsigned int crc, unsigned char inbyte)
 {
     static const unsigned char oddparity[16] = {0, 1, 1, 0, 1, 0, 0, 1, 1, 0, 0, 1, 0, 1, 1, 0};
 
+    // Even though we're just copying a byte from the input,
+    // we'll be doing 16-bit computation with it.
+    unsigned int cdata = inbyte;
+    cdata = (cdata ^ crc) & 0xff;
+    crc >>= 8;
+
+    if (oddparity[cdata & 0x0F] ^ oddparity[cdata >> 4])
+        crc ^= 0xC001;
+
+    cdata <<= 6;
+    crc ^= cdata;
+    cdata <<= 1;
+    crc ^= cdata;
+
+    return crc;
+}
+
+unsigned int OneWireCRC16(const unsigned char* input, unsigned int len, unsigned int crc)
+{
     for (unsigned int i = 0; i < len; i++)
     {
-        // Even though we're just copying a byte from the input,
-        // we'll be doing 16-bit computation with it.
-        unsigned int cdata = input[i];
-        cdata = (cdata ^ crc) & 0xff;
-        crc >>= 8;
-
-        if (oddparity[cdata & 0x0F] ^ oddparity[cdata >> 4])
-            crc ^= 0xC001;
-
-        cdata <<= 6;
-        crc ^= cdata;
-        cdata <<= 1;
-        crc ^= cdata;
+        crc = OneWireCRC16Update(crc, input[i]);
+    }
+    return crc;
+}
+
+unsigned int OneWireReadBytesCRC16(unsigned char *buf, unsigned int count, unsigned int crc)
+{
+    for (unsigned int i = 0; i < count; i++)
+    {
+        buf[i] = OneWireRead();
+        crc = OneWireCRC16Update(crc, buf[i]);
     }
     return crc;
 }
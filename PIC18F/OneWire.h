@@ -37,8 +37,9 @@
 // Select the table-lookup method of computing the 8-bit CRC
 // by setting this to 1.  The lookup table enlarges code size by
 // about 250 bytes.  It does NOT consume RAM (but did in very
-// old versions of OneWire).  If you disable this, a slower
-// but very compact algorithm is used.
+// old versions of OneWire).  Setting this to 2 uses a table of
+// 16 bytes, two lookups per byte, for the parts short of ROM.
+// If you disable this, a slower but very compact algorithm is used.
 #ifndef ONEWIRE_CRC8_TABLE
 #define ONEWIRE_CRC8_TABLE 0
 #endif
@@ -49,6 +50,18 @@
 #define ONEWIRE_CRC16 0
 #endif
 
+// Overdrive speed support (about 10 times faster, DS2438, DS2431...). The
+// overdrive slots are a few us long, they are timed with __delay_us()
+// (_XTAL_FREQ must be defined) instead of Timer 3.
+#ifndef ONEWIRE_OVERDRIVE
+#define ONEWIRE_OVERDRIVE 1
+#endif
+
+// Number of devices a tOneWireInventory can keep
+#ifndef ONEWIRE_INVENTORY_SIZE
+#define ONEWIRE_INVENTORY_SIZE 16
+#endif
+
 #define FALSE 0
 #define TRUE  1
 
@@ -81,6 +94,21 @@
  */
 #define RECALL_E_E              0xB8
 
+/**
+ * Overdrive Skip Rom Command, all the devices that can go to overdrive.
+ */
+#define OVERDRIVE_SKIP_ROM      0x3C
+
+/**
+ * Overdrive Match Rom Command, only the device selected goes to overdrive.
+ */
+#define OVERDRIVE_MATCH_ROM     0x69
+
+/** Standard speed of the bus*/
+#define ONEWIRE_SPEED_STANDARD  0
+/** Overdrive speed of the bus*/
+#define ONEWIRE_SPEED_OVERDRIVE 1
+
 #if ONEWIRE_SEARCH
 // global search state
 volatile unsigned char ROM_NO[8];
@@ -111,11 +139,32 @@ typedef union
     }; /*!< Variable type to store the devices Rom Codes.*/
 } tLaseredROMCode;
 
+#if ONEWIRE_SEARCH
+// Devices known on a bus, so they don't have to be searched for every time.
+// It is a plain block of bytes: it can be saved as it is in the EEPROM or in
+// the flash and checked with OneWireInventoryIsValid() when loaded back.
+typedef struct
+{
+    tLaseredROMCode devices[ONEWIRE_INVENTORY_SIZE];
+    unsigned char count;
+    // CRC8 of the devices and the count, see OneWireInventorySeal()
+    unsigned char crc;
+    // A bit per device, set if it answered the last verify or search
+    unsigned char present[(ONEWIRE_INVENTORY_SIZE + 7) / 8];
+} tOneWireInventory;
+
+// Value of an index that is not in the inventory
+#define ONEWIRE_INVENTORY_NONE 0xFF
+#endif
+
 void OneWireInit(void);
 
 // Perform a 1-Wire reset cycle. Returns 1 if a device responds
 // with a presence pulse.  Returns 0 if there is no device or the
-// bus is shorted or otherwise held low for more than 250uS
+// bus is shorted or otherwise held low for more than 250uS.
+// At overdrive, if no device answers the bus goes back to the standard
+// speed and a standard reset is done, as the devices may have fallen back
+// to it.
 unsigned char OneWireReset(void);
 
 // Issue a 1-Wire rom select command, you do the reset first.
@@ -124,6 +173,27 @@ void OneWireSelect(tLaseredROMCode *device);
 // Issue a 1-Wire rom skip command, to address all on bus.
 void OneWireSkip(void);
 
+#if ONEWIRE_OVERDRIVE
+// Issue an Overdrive Skip ROM (you do the reset first, at standard speed):
+// the devices that can go to overdrive do it, and so does the bus. Returns 1
+// if a device answers the overdrive reset. If not, the bus goes back to the
+// standard speed and 0 is returned. A reset at standard speed, or
+// OneWireSetSpeed(ONEWIRE_SPEED_STANDARD) and a reset, brings all the devices
+// back to the standard speed.
+unsigned char OneWireOverdriveSkip(void);
+
+// The same as OneWireOverdriveSkip() for a single device (Overdrive Match
+// ROM), the device is selected at overdrive speed. Returns 1 if it answers
+// the overdrive reset, then select it again with OneWireSelect() at
+// overdrive speed. If not, the bus is back at standard speed.
+unsigned char OneWireOverdriveSelect(tLaseredROMCode *device);
+
+// Speed of the slots and of the resets, ONEWIRE_SPEED_STANDARD or
+// ONEWIRE_SPEED_OVERDRIVE. It doesn't change the speed of the devices.
+void OneWireSetSpeed(unsigned char speed);
+unsigned char OneWireGetSpeed(void);
+#endif
+
 // Write a byte. If 'power' is one then the wire is held high at
 // the end for parasitically powered devices. You are responsible
 // for eventually depowering it by calling depower() or doing
@@ -161,6 +231,47 @@ void OneWireTargetSearch(unsigned char family_code);
 unsigned char OneWireSearch(void);
 void OneWireFindAllDevicesOnBus(tLaseredROMCode *romcode, unsigned char *num_devices);
 
+// The same as OneWireSearch() but only the devices with an alarm condition
+// answer (Alarm Search, 0xEC).
+unsigned char OneWireAlarmSearch(void);
+
+// Checks if a device is on the bus, with a search for its ROM only (64 bit
+// slots). The search state is kept. Returns 1 if it answered.
+unsigned char OneWireVerify(tLaseredROMCode *device);
+
+// Empties the inventory.
+void OneWireInventoryClear(tOneWireInventory *inventory);
+
+// Index of a ROM in the inventory, ONEWIRE_INVENTORY_NONE if not there.
+unsigned char OneWireInventoryFind(tOneWireInventory *inventory,
+                                   const unsigned char *rom);
+
+// Searches the whole bus, or only the devices of a family if family is not
+// 0, and adds the devices that are not in the inventory yet. The devices
+// found are marked present. Returns the number of devices added.
+unsigned char OneWireInventoryDiscover(tOneWireInventory *inventory,
+                                       unsigned char family);
+
+// Verifies all the devices of the inventory and marks them present or not.
+// Returns the number of devices present.
+unsigned char OneWireInventoryVerify(tOneWireInventory *inventory);
+
+// Returns 1 if the device at index answered the last verify or search.
+unsigned char OneWireInventoryIsPresent(tOneWireInventory *inventory,
+                                        unsigned char index);
+
+// Finds the devices with an alarm condition, with an alarm search. The
+// devices that are not in the inventory are added. Returns the number of
+// indexes stored in alarms, max at most.
+unsigned char OneWireInventoryAlarms(tOneWireInventory *inventory,
+                                     unsigned char *alarms, unsigned char max);
+
+// Computes the CRC of the inventory, before saving it.
+void OneWireInventorySeal(tOneWireInventory *inventory);
+
+// Checks the CRC of an inventory loaded from the EEPROM or the flash.
+bool OneWireInventoryIsValid(tOneWireInventory *inventory);
+
 #endif
 
 #if ONEWIRE_CRC
@@ -168,6 +279,17 @@ void OneWireFindAllDevicesOnBus(tLaseredROMCode *romcode, unsigned char *num_dev
 // ROM and scratchpad registers.
 unsigned char OneWireCRC8(unsigned char *addr, unsigned char len);
 
+// Fold a byte in a running 8 bit CRC, starting from 0.
+unsigned char OneWireCRC8Update(unsigned char crc, unsigned char inbyte);
+
+// Read bytes and compute their CRC8 on the way, so there is no second pass
+// over the buffer.  Read the CRC byte too: the result is 0 if it matches.
+//    OneWireWrite(0xBE);
+//    if (OneWireReadBytesCRC8(scratchpad, 9) != 0) {
+//        // Handle error.
+//    }
+unsigned char OneWireReadBytesCRC8(unsigned char *buf, unsigned int count);
+
 #if ONEWIRE_CRC16
 // Compute the 1-Wire CRC16 and compare it against the received CRC.
 // Example usage (reading a DS2408):
@@ -204,6 +326,14 @@ bool OneWireCheckCRC16(const unsigned char* input, unsigned int len, const unsig
 // @param crc - The crc starting value (optional)
 // @return The CRC16, as defined by Dallas Semiconductor.
 unsigned int OneWireCRC16(const unsigned char* input, unsigned int len, unsigned int crc);
+
+// Fold a byte in a running 16 bit CRC.
+unsigned int OneWireCRC16Update(unsigned int crc, unsigned char inbyte);
+
+// Read bytes and compute their CRC16 on the way, starting from crc (the
+// CRC of the command bytes sent before).  Read the two inverted CRC bytes
+// too: the result is 0xB001 if they match.
+unsigned int OneWireReadBytesCRC16(unsigned char *buf, unsigned int count, unsigned int crc);
 #endif
 #endif
 void delayMicroseconds(unsigned int uSec);
@@ -0,0 +1,319 @@
+/**
+ *  @file       OneWireAsync.c
+ *  @brief      Interrupt driven 1-Wire master on the pin of OneWire.h.
+ *  @author     Luis Maduro
+ *  @version    1.00
+ *  @date       14/10/2026
+ *
+ *  Copyright (C) 2026  Luis Maduro
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <stddef.h>
+#include "OneWireAsync.h"
+
+/**Longest wait of the timer, the longer ones are split.*/
+#define ONEWIRE_ASYNC_MAX_WAIT      240
+
+/**
+ * What the end of the wait of the timer does.
+ */
+typedef enum
+{
+    ONEWIRE_STATE_IDLE,
+    /**480 us low done, release and wait for the presence.*/
+    ONEWIRE_STATE_RESET_LOW,
+    /**Sample the presence pulse.*/
+    ONEWIRE_STATE_RESET_SAMPLE,
+    /**End of the reset.*/
+    ONEWIRE_STATE_RESET_END,
+    /**60 us low of a 0 done, drive the wire high.*/
+    ONEWIRE_STATE_WRITE_ZERO,
+    /**End of the slot, start the next one.*/
+    ONEWIRE_STATE_SLOT_END
+} tOneWireAsyncState;
+
+static volatile tOneWireAsyncState state = ONEWIRE_STATE_IDLE;
+static volatile tOneWireAsyncStatus status = ONEWIRE_ASYNC_IDLE;
+static tOneWireAsyncCallback callback;
+/**Part of a long wait left.*/
+static unsigned int waitRemaining;
+/**Bytes of the operation.*/
+static unsigned char *data;
+static unsigned char count;
+static unsigned char reading;
+/**Bit of the slot and byte being written or read.*/
+static unsigned char bitMask;
+static unsigned char current;
+static unsigned char presence;
+
+/**
+ * Starts the timer for a wait, the interrupt comes at its end.
+ * @param uSec Microseconds.
+ */
+static void OneWireAsyncWait(unsigned int uSec)
+{
+    if (uSec > ONEWIRE_ASYNC_MAX_WAIT)
+    {
+        waitRemaining = uSec - ONEWIRE_ASYNC_MAX_WAIT;
+        uSec = ONEWIRE_ASYNC_MAX_WAIT;
+    }
+    else
+    {
+        waitRemaining = 0;
+    }
+
+    ONEWIRE_ASYNC_TIMER_ON = 0;
+    ONEWIRE_ASYNC_TIMER = 0;
+    ONEWIRE_ASYNC_PERIOD = ONEWIRE_ASYNC_TICKS(uSec) - 1;
+    ONEWIRE_ASYNC_INTERRUPT_FLAG = 0;
+    ONEWIRE_ASYNC_TIMER_ON = 1;
+}
+
+static void OneWireAsyncFinish(tOneWireAsyncStatus result)
+{
+    ONEWIRE_ASYNC_TIMER_ON = 0;
+    state = ONEWIRE_STATE_IDLE;
+    status = result;
+
+    if (callback != NULL)
+        callback(result);
+}
+
+/**
+ * Starts the slot of bitMask, the low pulse and the sample of a read are
+ * timed here, as in OneWireWriteBit() and OneWireReadBit().
+ */
+static void OneWireAsyncSlot(void)
+{
+    ONEWIRE_PIN_WRITE = LOW;
+    ONEWIRE_PIN_DIRECTION = OUTPUT; // drive output low
+
+    if (reading)
+    {
+        ONEWIRE_ASYNC_DELAY(3);
+        ONEWIRE_PIN_DIRECTION = INPUT; // let pin float, pull up will raise
+        ONEWIRE_ASYNC_DELAY(10);
+        if (ONEWIRE_PIN_READ)
+            current |= bitMask;
+        OneWireAsyncWait(53);
+        state = ONEWIRE_STATE_SLOT_END;
+    }
+    else if (current & bitMask)
+    {
+        ONEWIRE_ASYNC_DELAY(10);
+        ONEWIRE_PIN_WRITE = HIGH; // drive output high
+        OneWireAsyncWait(55);
+        state = ONEWIRE_STATE_SLOT_END;
+    }
+    else
+    {
+        OneWireAsyncWait(65);
+        state = ONEWIRE_STATE_WRITE_ZERO;
+    }
+
+    bitMask <<= 1;
+}
+
+/**
+ * Goes to the next bit, and the next byte after the eighth.
+ */
+static void OneWireAsyncNextBit(void)
+{
+    if (bitMask == 0)
+    {
+        if (reading)
+            *data = current;
+
+        if (--count == 0)
+        {
+            OneWireAsyncFinish(ONEWIRE_ASYNC_DONE);
+            return;
+        }
+
+        data++;
+        bitMask = 0x01;
+        current = reading ? 0 : *data;
+    }
+
+    OneWireAsyncSlot();
+}
+
+/**
+ * Configures the timer, call OneWireInit() for the pin.
+ */
+void OneWireAsyncInit(void)
+{
+    ONEWIRE_ASYNC_TIMER_ON = 0;
+    ONEWIRE_ASYNC_TIMER_PRESCALER = ONEWIRE_ASYNC_PRESCALER;
+    ONEWIRE_ASYNC_TIMER_POSTSCALER = 0;
+    ONEWIRE_ASYNC_INTERRUPT_FLAG = 0;
+    ONEWIRE_ASYNC_INTERRUPT_PRIORITY = ONEWIRE_ASYNC_HIGH_PRIORITY;
+    ONEWIRE_ASYNC_INTERRUPT_ENABLE = 1;
+
+    state = ONEWIRE_STATE_IDLE;
+    status = ONEWIRE_ASYNC_IDLE;
+}
+
+/**
+ * Tells if an operation is running.
+ * @return 1 if busy.
+ */
+unsigned char OneWireAsyncIsBusy(void)
+{
+    return state != ONEWIRE_STATE_IDLE;
+}
+
+/**
+ * Gets the status of the last operation.
+ * @return ONEWIRE_ASYNC_BUSY while it runs.
+ */
+tOneWireAsyncStatus OneWireAsyncGetStatus(void)
+{
+    return status;
+}
+
+/**
+ * Starts a reset, the status is ONEWIRE_ASYNC_DONE if a device answered.
+ * @param cb Called at the end, can be NULL.
+ * @return 0 if an operation is already running.
+ */
+unsigned char OneWireAsyncReset(tOneWireAsyncCallback cb)
+{
+    if (state != ONEWIRE_STATE_IDLE)
+        return 0;
+
+    callback = cb;
+    status = ONEWIRE_ASYNC_BUSY;
+
+    ONEWIRE_PIN_DIRECTION = INPUT;
+
+    //the wire must be high before the reset, the blocking one waits for it
+    if (!ONEWIRE_PIN_READ)
+    {
+        OneWireAsyncFinish(ONEWIRE_ASYNC_ERROR);
+        return 1;
+    }
+
+    InterruptsOFF();
+    ONEWIRE_PIN_WRITE = LOW;
+    ONEWIRE_PIN_DIRECTION = OUTPUT; // drive output low
+    state = ONEWIRE_STATE_RESET_LOW;
+    OneWireAsyncWait(480);
+    InterruptsON();
+
+    return 1;
+}
+
+static unsigned char OneWireAsyncStart(unsigned char *buf, unsigned char n,
+                                       unsigned char read,
+                                       tOneWireAsyncCallback cb)
+{
+    if ((state != ONEWIRE_STATE_IDLE) || (n == 0))
+        return 0;
+
+    callback = cb;
+    status = ONEWIRE_ASYNC_BUSY;
+    data = buf;
+    count = n;
+    reading = read;
+    bitMask = 0x01;
+    current = read ? 0 : *buf;
+
+    InterruptsOFF();
+    OneWireAsyncSlot();
+    InterruptsON();
+
+    return 1;
+}
+
+/**
+ * Starts writing bytes, least significant bit first.
+ * @param buf Bytes, valid until the end.
+ * @param length Number of bytes, 1 to 255.
+ * @param cb Called at the end, can be NULL.
+ * @return 0 if an operation is already running.
+ */
+unsigned char OneWireAsyncWrite(const unsigned char *buf, unsigned char length,
+                                tOneWireAsyncCallback cb)
+{
+    return OneWireAsyncStart((unsigned char *) buf, length, 0, cb);
+}
+
+/**
+ * Starts reading bytes.
+ * @param buf Buffer of the bytes, valid until the end.
+ * @param length Number of bytes, 1 to 255.
+ * @param cb Called at the end, can be NULL.
+ * @return 0 if an operation is already running.
+ */
+unsigned char OneWireAsyncRead(unsigned char *buf, unsigned char length,
+                               tOneWireAsyncCallback cb)
+{
+    return OneWireAsyncStart(buf, length, 1, cb);
+}
+
+/**
+ * This funtion is intended to be put in the interrupt funtion of the
+ * priority of the timer, it ends the wait and starts the next step.
+ * @remarks This funtion checks and clears the interrupt flag of the timer.
+ */
+void OneWireAsyncInterruptHandler(void)
+{
+    if (!ONEWIRE_ASYNC_INTERRUPT_FLAG)
+        return;
+
+    ONEWIRE_ASYNC_INTERRUPT_FLAG = 0;
+
+    if (waitRemaining != 0)
+    {
+        OneWireAsyncWait(waitRemaining);
+        return;
+    }
+
+    ONEWIRE_ASYNC_TIMER_ON = 0;
+
+    switch (state)
+    {
+        case ONEWIRE_STATE_RESET_LOW:
+            ONEWIRE_PIN_DIRECTION = INPUT; // allow it to float
+            OneWireAsyncWait(70);
+            state = ONEWIRE_STATE_RESET_SAMPLE;
+            break;
+
+        case ONEWIRE_STATE_RESET_SAMPLE:
+            presence = !ONEWIRE_PIN_READ;
+            OneWireAsyncWait(410);
+            state = ONEWIRE_STATE_RESET_END;
+            break;
+
+        case ONEWIRE_STATE_RESET_END:
+            OneWireAsyncFinish(presence ? ONEWIRE_ASYNC_DONE : ONEWIRE_ASYNC_ERROR);
+            break;
+
+        case ONEWIRE_STATE_WRITE_ZERO:
+            ONEWIRE_PIN_WRITE = HIGH; // drive output high
+            OneWireAsyncWait(5);
+            state = ONEWIRE_STATE_SLOT_END;
+            break;
+
+        case ONEWIRE_STATE_SLOT_END:
+            OneWireAsyncNextBit();
+            break;
+
+        default:
+            break;
+    }
+}
@@ -0,0 +1,107 @@
+/**
+ *  @file       OneWireAsync.h
+ *  @brief      Interrupt driven 1-Wire master on the pin of OneWire.h.
+ *  @author     Luis Maduro
+ *  @version    1.00
+ *  @date       14/10/2026
+ *
+ *  The blocking functions of OneWire.c spin on Timer 3 for every slot, the
+ *  CPU is taken for 70 us per bit and 1 ms per reset. Here the slots are
+ *  run by the period match interrupt of Timer 4: the interrupt starts the
+ *  slot, drives the short low pulse and, for a read, samples the wire
+ *  (13 us), then the timer waits for the rest of the slot while the main
+ *  loop runs. A write 0 slot is two interrupts, before and after the 60 us
+ *  low. The CPU is taken about 20% of the time of a transfer and not at all
+ *  during the waits of the reset.
+ *
+ *  A reset, a write or a read of bytes is started and the end is told by the
+ *  callback, from the interrupt, or by polling the status. The blocking
+ *  functions must not be used while an operation runs. Only the standard
+ *  speed is run here, the slots of the overdrive are shorter than an
+ *  interrupt.
+ *
+ *  The interrupt is high priority by default, a high priority interrupt
+ *  taken during the low pulse of a slot would stretch it.
+ *
+ *  Copyright (C) 2026  Luis Maduro
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef ONEWIREASYNC_H
+#define ONEWIREASYNC_H
+
+#include "OneWire.h"
+
+/**Registers of the timer, Timer 4 by default (any of Timer 2/4/6).*/
+#ifndef ONEWIRE_ASYNC_TIMER
+#define ONEWIRE_ASYNC_TIMER             TMR4
+#define ONEWIRE_ASYNC_PERIOD            PR4
+#define ONEWIRE_ASYNC_TIMER_ON          T4CONbits.TMR4ON
+#define ONEWIRE_ASYNC_TIMER_PRESCALER   T4CONbits.T4CKPS
+#define ONEWIRE_ASYNC_TIMER_POSTSCALER  T4CONbits.T4OUTPS
+#define ONEWIRE_ASYNC_INTERRUPT_ENABLE  PIE5bits.TMR4IE
+#define ONEWIRE_ASYNC_INTERRUPT_FLAG    PIR5bits.TMR4IF
+#define ONEWIRE_ASYNC_INTERRUPT_PRIORITY IPR5bits.TMR4IP
+#endif
+
+/**Prescaler of the timer, 1:16 counts 1 us at 64 MHz.*/
+#ifndef ONEWIRE_ASYNC_PRESCALER
+#define ONEWIRE_ASYNC_PRESCALER         0b10
+#endif
+
+/**Counts of the timer for a time in us, i.e. ((us) / 2) at 32 MHz.*/
+#ifndef ONEWIRE_ASYNC_TICKS
+#define ONEWIRE_ASYNC_TICKS(us)         (us)
+#endif
+
+/**Priority of the interrupt, 1 for high.*/
+#ifndef ONEWIRE_ASYNC_HIGH_PRIORITY
+#define ONEWIRE_ASYNC_HIGH_PRIORITY     1
+#endif
+
+/**Busy wait for the pulses inside a slot.*/
+#ifndef ONEWIRE_ASYNC_DELAY
+#define ONEWIRE_ASYNC_DELAY(uSec)       __delay_us(uSec)
+#endif
+
+/**
+ * Status of the operation.
+ */
+typedef enum
+{
+    /**No operation started.*/
+    ONEWIRE_ASYNC_IDLE,
+    /**Running in the background.*/
+    ONEWIRE_ASYNC_BUSY,
+    /**Finished, a device answered the reset.*/
+    ONEWIRE_ASYNC_DONE,
+    /**Finished, no device answered the reset or the wire is held low.*/
+    ONEWIRE_ASYNC_ERROR
+} tOneWireAsyncStatus;
+
+/**Called from the interrupt at the end of an operation.*/
+typedef void (*tOneWireAsyncCallback)(tOneWireAsyncStatus status);
+
+void OneWireAsyncInit(void);
+unsigned char OneWireAsyncIsBusy(void);
+tOneWireAsyncStatus OneWireAsyncGetStatus(void);
+unsigned char OneWireAsyncReset(tOneWireAsyncCallback callback);
+unsigned char OneWireAsyncWrite(const unsigned char *buf, unsigned char length,
+                                tOneWireAsyncCallback callback);
+unsigned char OneWireAsyncRead(unsigned char *buf, unsigned char length,
+                               tOneWireAsyncCallback callback);
+void OneWireAsyncInterruptHandler(void);
+
+#endif /* ONEWIREASYNC_H */
@@ -20,7 +20,24 @@
  *  You should have received a copy of the GNU General Public License
  *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
  */
+#include <stddef.h>
 #include "SPIDevice.h"
+#include "AccessRAM.h"
+
+/**Queue of transfers, the first one is being done by the interrupt.*/
+static tSPITransfer *volatile queueHead = NULL;
+static tSPITransfer *queueTail = NULL;
+/**Next byte of the current transfer.*/
+static ACCESS_RAM_DRIVER unsigned int transferIndex;
+/**Device the bus is configured for, NULL before the first select.*/
+static tSPIDevice *deviceConfigured = NULL;
+/**Device kept selected by a transfer with keepSelected.*/
+static tSPIDevice *deviceSelected = NULL;
+/**The head of the queue was started, by the callback of the last one.*/
+static unsigned char transferBegun;
+
+static void SPIDeviceConfigure(tSPIDevice *device);
+static void SPIDeviceTransferBegin(tSPITransfer *transfer);
 
 /**
  * Initiates the MSSP module to work as an SPI master.
@@ -38,9 +55,81 @@ void SPIInit(void)
     SPICON1bits.SSPOV = 0; //clear overflow bit
     SPICON1bits.CKP = 0; //idle state for clock is a low level
     SPICON1bits.SSPM = SPI_CLOCK;
+    SPIINTPRIORITY = SPI_DEVICE_HIGH_PRIORITY;
     SPICON1bits.SSPEN = 1; //enables the serial port pins to work with the MSSP
 }
 
+/**
+ * Sets the clock of the bus to the fastest of Fosc/4, Fosc/16 and Fosc/64
+ * that is not above a rate, or to Fosc/64 if they all are. For a driver
+ * that raises the clock once the device tells its rate (i.e. a SD card),
+ * the devices of SPIDeviceSelect() are configured again with their clock.
+ * @param kHz Highest clock.
+ * @return Clock set, in kHz.
+ */
+unsigned long SPISetClock(unsigned long kHz)
+{
+    unsigned char clock;
+    unsigned long set;
+
+    if (SPI_FOSC_KHZ / 4 <= kHz)
+    {
+        clock = SPI_DEVICE_CLOCK_FOSC_4;
+        set = SPI_FOSC_KHZ / 4;
+    }
+    else if (SPI_FOSC_KHZ / 16 <= kHz)
+    {
+        clock = SPI_DEVICE_CLOCK_FOSC_16;
+        set = SPI_FOSC_KHZ / 16;
+    }
+    else
+    {
+        clock = SPI_DEVICE_CLOCK_FOSC_64;
+        set = SPI_FOSC_KHZ / 64;
+    }
+
+    while (SPIDeviceIsBusy());
+
+    SPICON1bits.SSPEN = 0;
+    SPICON1bits.SSPM = clock;
+    SPICON1bits.SSPEN = 1;
+
+    deviceConfigured = NULL;
+
+    return set;
+}
+
+/**
+ * Gives the clock the bus is set to, for the descriptor of a device that
+ * keeps the clock set by SPISetClock().
+ * @return SPI_DEVICE_CLOCK_FOSC_4, _16 or _64.
+ */
+unsigned char SPIGetClock(void)
+{
+    return SPICON1bits.SSPM;
+}
+
+/**Sends the byte fetched and fetches the next one while it is shifting.*/
+#define SPI_SEND_NEXT()                                                 \
+    do                                                                  \
+    {                                                                   \
+        SPIBUF = next;                                                  \
+        next = *data++;                                                 \
+        while (!SPISTATbits.BF);                                        \
+        dummy = SPIBUF;                                                 \
+    } while (0)
+
+/**Reads the byte received, starts the next one and stores it while the
+ next one is shifting.*/
+#define SPI_RECEIVE_NEXT()                                              \
+    do                                                                  \
+    {                                                                   \
+        while (!SPISTATbits.BF);                                        \
+        received = SPIBUF;                                              \
+        SPIBUF = 0xFF;                                                  \
+        *buffer++ = received;                                           \
+    } while (0)
+
 /**
  * Hardware dependent funtion to write to SPI module. The module must be
  * configured by the user.
@@ -87,12 +176,7 @@ unsigned char SPIRead(void)
 void SPIDeviceReadBytes(unsigned char length,
                         unsigned char *data)
 {
-    unsigned char i = 0;
-
-    for (i = 0; i < length; i++)
-    {
-        data[i] = SPIRead();
-    }
+    SPIDeviceReceiveData(data, length);
 }
 
 /**
@@ -103,12 +187,7 @@ void SPIDeviceReadBytes(unsigned char length,
 void SPIDeviceWriteBytes(unsigned char length,
                          unsigned char *data)
 {
-    unsigned char i;
-
-    for (i = 0; i < length; i++)
-    {
-        SPIWrite(data[i]);
-    }
+    SPIDeviceSendData(data, length);
 }
 
 ///**
@@ -237,39 +316,318 @@ void SPIDeviceWriteBytes(unsigned char length,
 //    SPIDeviceWriteBytes(address, 1, &value);
 //}
 //
-///**
-// * Sends data contained in a buffer over the SPI bus.
-// *
-// * \param[in] data A pointer to the buffer which contains the data to send.
-// * \param[in] data_len The number of bytes to send.
-// */
-//void SPIDeviceSendData(const unsigned char *data, unsigned int data_len)
-//{
-//    do
-//    {
-//        unsigned char b = *data++;
-//
-//        SPIWrite(b);
-//
-//    }
-//    while (--data_len);
-//}
-//
-///**
-// * Receives multiple bytes from the SPI bus and writes them to a buffer.
-// *
-// * \param[out] buffer A pointer to the buffer into which the data gets written.
-// * \param[in] buffer_len The number of bytes to read.
-// */
-//void SPIDeviceReceiveData(unsigned char *buffer, unsigned int buffer_len)
-//{
-//    --buffer;
-//
-//    do
-//    {
-//        ++buffer;
-//        *buffer = SPIRead();
-//
-//    }
-//    while (--buffer_len);
-//}
+/**
+ * Sends data contained in a buffer over the SPI bus.
+ * The next byte is fetched while the current one is shifting and the bytes
+ * are sent four per loop, so the bus is idle only for the test of BF and
+ * the reload of SPIBUF between bytes, instead of a call of SPIWrite() and a
+ * poll of the interrupt flag per byte.
+ *
+ * \param[in] data A pointer to the buffer which contains the data to send.
+ * \param[in] data_len The number of bytes to send.
+ */
+void SPIDeviceSendData(const unsigned char *data, unsigned int data_len)
+{
+    unsigned char next;
+    volatile unsigned char dummy;
+
+    if (data_len == 0)
+        return;
+
+    SPICON1bits.WCOL = 0;
+    dummy = SPIBUF; //clears BF
+
+    next = *data++;
+
+    //the last byte is sent without fetching past the end of the buffer
+    while (--data_len & 0x03)
+    {
+        SPI_SEND_NEXT();
+    }
+
+    for (data_len >>= 2; data_len != 0; data_len--)
+    {
+        SPI_SEND_NEXT();
+        SPI_SEND_NEXT();
+        SPI_SEND_NEXT();
+        SPI_SEND_NEXT();
+    }
+
+    SPIBUF = next;
+    while (!SPISTATbits.BF);
+    dummy = SPIBUF;
+    SPIINTFLAG = 0;
+}
+
+/**
+ * Receives multiple bytes from the SPI bus and writes them to a buffer.
+ * The next byte starts shifting as soon as the current one is read from
+ * SPIBUF, before it is stored, and 0xFF is sent (the idle level of MOSI
+ * that SD cards need while sending).
+ *
+ * \param[out] buffer A pointer to the buffer into which the data gets written.
+ * \param[in] buffer_len The number of bytes to read.
+ */
+void SPIDeviceReceiveData(unsigned char *buffer, unsigned int buffer_len)
+{
+    unsigned char received;
+    volatile unsigned char dummy;
+
+    if (buffer_len == 0)
+        return;
+
+    SPICON1bits.WCOL = 0;
+    dummy = SPIBUF; //clears BF
+
+    SPIBUF = 0xFF;
+
+    while (--buffer_len & 0x03)
+    {
+        SPI_RECEIVE_NEXT();
+    }
+
+    for (buffer_len >>= 2; buffer_len != 0; buffer_len--)
+    {
+        SPI_RECEIVE_NEXT();
+        SPI_RECEIVE_NEXT();
+        SPI_RECEIVE_NEXT();
+        SPI_RECEIVE_NEXT();
+    }
+
+    while (!SPISTATbits.BF);
+    *buffer = SPIBUF;
+    SPIINTFLAG = 0;
+}
+
+/**
+ * Initializes the descriptor of a device, with its chip select deselected.
+ * @param device Descriptor of the device.
+ * @param csRegister Register of the chip select pin, e.g. &LATB.
+ * @param csMask Bit of the chip select pin, e.g. 1 << 4.
+ * @param mode SPI mode, 0 to 3.
+ * @param clock SPI_DEVICE_CLOCK_FOSC_4, _16 or _64.
+ */
+void SPIDeviceInit(tSPIDevice *device,
+                   volatile unsigned char *csRegister,
+                   unsigned char csMask,
+                   unsigned char mode,
+                   unsigned char clock)
+{
+    device->csRegister = csRegister;
+    device->csMask = csMask;
+    device->mode = mode;
+    device->clock = clock;
+
+    *csRegister |= csMask;
+}
+
+/**
+ * Changes the clock of a device, e.g. an SD card after its initialization.
+ * Used from the next select.
+ * @param device Descriptor of the device.
+ * @param clock SPI_DEVICE_CLOCK_FOSC_4, _16 or _64.
+ */
+void SPIDeviceSetClock(tSPIDevice *device, unsigned char clock)
+{
+    device->clock = clock;
+
+    if (deviceConfigured == device)
+    {
+        deviceConfigured = NULL;
+    }
+}
+
+/**
+ * Selects a device for the polled functions (SPIWrite(), SPIDeviceSendData()
+ * ...), after the queued transfers end.
+ * @param device Descriptor of the device.
+ */
+void SPIDeviceSelect(tSPIDevice *device)
+{
+    while (SPIDeviceIsBusy());
+
+    if (deviceSelected != NULL && deviceSelected != device)
+    {
+        *deviceSelected->csRegister |= deviceSelected->csMask;
+    }
+
+    deviceSelected = NULL;
+    SPIDeviceConfigure(device);
+    *device->csRegister &= ~device->csMask;
+}
+
+/**
+ * Deselects a device selected by SPIDeviceSelect().
+ * @param device Descriptor of the device.
+ */
+void SPIDeviceDeselect(tSPIDevice *device)
+{
+    *device->csRegister |= device->csMask;
+}
+
+/**
+ * Starts a full duplex transfer that runs in the background, one SPI
+ * interrupt per byte. The device is configured and selected at the start
+ * and deselected at the end. If the bus is busy the transfer waits in a
+ * queue, so the drivers of several devices share the bus, and the
+ * transfers run in order.
+ * @param transfer Transfer to do, it must stay valid until it ends.
+ * @return 0 if the transfer was started or queued, !=0 if it is not valid
+ *         or already queued.
+ */
+unsigned char SPIDeviceStartTransfer(tSPITransfer *transfer)
+{
+    unsigned char interruptEnable;
+
+    if (transfer == NULL || transfer->device == NULL ||
+        transfer->length == 0 || transfer->status == SPI_TRANSFER_BUSY)
+        return 1;
+
+    transfer->status = SPI_TRANSFER_BUSY;
+    transfer->next = NULL;
+
+    //the interrupt also changes the queue
+    interruptEnable = SPIINTENABLE;
+    SPIINTENABLE = 0;
+
+    if (queueHead == NULL)
+    {
+        queueHead = transfer;
+        queueTail = transfer;
+        SPIDeviceTransferBegin(transfer);
+        SPIINTENABLE = 1;
+    }
+    else
+    {
+        queueTail->next = transfer;
+        queueTail = transfer;
+        SPIINTENABLE = interruptEnable;
+    }
+
+    return 0;
+}
+
+/**
+ * Tells if interrupt driven transfers are running or queued.
+ * @return !=0 while a transfer is running.
+ */
+unsigned char SPIDeviceIsBusy(void)
+{
+    return queueHead != NULL;
+}
+
+/**
+ * This funtion is intended to be put in the interrupt funtion, it stores
+ * the byte received and sends the next one of the current transfer.
+ * @remarks This funtion checks and clears the SPI interrupt flag, it does
+ * nothing if the flag is not set or no transfer is running.
+ */
+void SPIDeviceInterruptHandler(void)
+{
+    tSPITransfer *transfer = queueHead;
+    unsigned char received;
+
+    if (!SPIINTFLAG)
+        return;
+
+    SPIINTFLAG = 0;
+
+    if (transfer == NULL)
+        return;
+
+    received = SPIBUF;
+
+    if (transfer->rxData != NULL)
+    {
+        transfer->rxData[transferIndex] = received;
+    }
+
+    transferIndex++;
+
+    if (transferIndex < transfer->length)
+    {
+        SPIBUF = (transfer->txData != NULL) ? transfer->txData[transferIndex] : 0xFF;
+        return;
+    }
+
+    if (transfer->keepSelected)
+    {
+        deviceSelected = transfer->device;
+    }
+    else
+    {
+        deviceSelected = NULL;
+        *transfer->device->csRegister |= transfer->device->csMask;
+    }
+
+    queueHead = transfer->next;
+
+    if (queueHead == NULL)
+    {
+        queueTail = NULL;
+    }
+
+    transfer->status = SPI_TRANSFER_DONE;
+    transferBegun = 0;
+
+    if (transfer->callback != NULL)
+    {
+        transfer->callback(transfer);
+    }
+
+    //next transfer, queued by another driver or the callback, which starts
+    //it itself when the queue was empty
+    if (queueHead != NULL)
+    {
+        if (!transferBegun)
+        {
+            SPIDeviceTransferBegin(queueHead);
+        }
+    }
+    else
+    {
+        SPIINTENABLE = 0;
+    }
+}
+
+/**
+ * Sets the mode and the clock of a device, if the bus is not already set
+ * for it. The module is disabled while they change.
+ */
+static void SPIDeviceConfigure(tSPIDevice *device)
+{
+    if (deviceConfigured == device)
+        return;
+
+    SPICON1bits.SSPEN = 0;
+    SPICON1bits.CKP = (device->mode >> 1) & 0x01;
+    SPISTATbits.CKE = !(device->mode & 0x01); //CPHA = 0, data changes to idle
+    SPICON1bits.SSPM = device->clock;
+    SPICON1bits.WCOL = 0;
+    SPICON1bits.SSPOV = 0;
+    SPICON1bits.SSPEN = 1;
+
+    deviceConfigured = device;
+}
+
+/**
+ * Configures the bus, selects the device and sends the first byte.
+ */
+static void SPIDeviceTransferBegin(tSPITransfer *transfer)
+{
+    //a device left selected is released unless the transfer continues it
+    if (deviceSelected != NULL && deviceSelected != transfer->device)
+    {
+        *deviceSelected->csRegister |= deviceSelected->csMask;
+    }
+
+    deviceSelected = NULL;
+    transferIndex = 0;
+    transferBegun = 1;
+
+    SPIDeviceConfigure(transfer->device);
+    *transfer->device->csRegister &= ~transfer->device->csMask;
+
+    SPIINTFLAG = 0;
+    SPIBUF = (transfer->txData != NULL) ? transfer->txData[0] : 0xFF;
+}
@@ -62,8 +62,87 @@
 #define SPIBUF              SSP1BUF
 
 #define SPIINTFLAG          PIR1bits.SSP1IF
+/**The interrupt enable of the SPI module*/
+#define SPIINTENABLE        PIE1bits.SSP1IE
+/**The interrupt priority of the SPI module*/
+#define SPIINTPRIORITY      IPR1bits.SSP1IP
+
+/**Priority of the interrupt, 1 for high, see InterruptPriority.h. I2C and
+ SPI share the SSPIP bit of MSSP1, the last Init sets it.*/
+#ifndef SPI_DEVICE_HIGH_PRIORITY
+#define SPI_DEVICE_HIGH_PRIORITY    0
+#endif
+
+/**Oscillator frequency in kHz, for SPISetClock().*/
+#ifndef SPI_FOSC_KHZ
+#ifdef _XTAL_FREQ
+#define SPI_FOSC_KHZ                (_XTAL_FREQ / 1000UL)
+#else
+#define SPI_FOSC_KHZ                48000UL
+#endif
+#endif
+
+/**Clock values of a device, FOSC divided by 4, 16 or 64.*/
+#define SPI_DEVICE_CLOCK_FOSC_4     0b0000
+#define SPI_DEVICE_CLOCK_FOSC_16    0b0001
+#define SPI_DEVICE_CLOCK_FOSC_64    0b0010
+
+/**
+ * A device on the SPI bus. The bus is configured with its mode and clock
+ * every time it is selected, so devices with different settings share it.
+ */
+typedef struct _tSPIDevice
+{
+    /**Register of the chip select pin (LATx, or TRISx for an open drain
+     select), the select is active low.*/
+    volatile unsigned char *csRegister;
+    /**Bit of the chip select pin.*/
+    unsigned char csMask;
+    /**SPI mode, 0 to 3 (CPOL << 1 | CPHA).*/
+    unsigned char mode;
+    /**Clock, SPI_DEVICE_CLOCK_FOSC_4, _16 or _64.*/
+    unsigned char clock;
+} tSPIDevice;
+
+/**
+ * Status of an interrupt driven transfer.
+ */
+typedef enum
+{
+    SPI_TRANSFER_IDLE,
+    SPI_TRANSFER_BUSY,
+    SPI_TRANSFER_DONE
+} tSPITransferStatus;
+
+/**
+ * Full duplex transfer done by the SPI interrupt, see
+ * SPIDeviceStartTransfer(). The structure and the buffers must stay valid
+ * until the transfer ends.
+ */
+typedef struct _tSPITransfer
+{
+    /**Device of the transfer.*/
+    tSPIDevice *device;
+    /**Bytes to send, NULL to send 0xFF.*/
+    const unsigned char *txData;
+    /**Buffer for the bytes received, NULL to drop them.*/
+    unsigned char *rxData;
+    /**Number of bytes.*/
+    unsigned int length;
+    /**Not 0 to keep the device selected at the end, for a command in
+     several transfers. The next transfer must be to the same device.*/
+    unsigned char keepSelected;
+    /**Called from the interrupt when the transfer ends, can be NULL.*/
+    void (*callback)(struct _tSPITransfer *transfer);
+    /**Status, can be polled instead of using the callback.*/
+    volatile tSPITransferStatus status;
+    /**Next transfer in the queue.*/
+    struct _tSPITransfer *next;
+} tSPITransfer;
 
 void SPIInit(void);
+unsigned long SPISetClock(unsigned long kHz);
+unsigned char SPIGetClock(void);
 unsigned char SPIWrite(unsigned char data);
 unsigned char SPIRead(void);
 
@@ -89,4 +168,16 @@ void SPIDeviceWriteBytes(unsigned char length,
                          unsigned char *data);
 void SPIDeviceSendData(const unsigned char *data, unsigned int data_len);
 void SPIDeviceReceiveData(unsigned char *buffer, unsigned int buffer_len);
+
+void SPIDeviceInit(tSPIDevice *device,
+                   volatile unsigned char *csRegister,
+                   unsigned char csMask,
+                   unsigned char mode,
+                   unsigned char clock);
+void SPIDeviceSetClock(tSPIDevice *device, unsigned char clock);
+void SPIDeviceSelect(tSPIDevice *device);
+void SPIDeviceDeselect(tSPIDevice *device);
+unsigned char SPIDeviceStartTransfer(tSPITransfer *transfer);
+unsigned char SPIDeviceIsBusy(void);
+void SPIDeviceInterruptHandler(void);
 #endif /* _SPIDEV_H_ */
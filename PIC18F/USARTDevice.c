@@ -21,13 +21,57 @@
  *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
  */
 #include <p18cxxx.h>
+#include <string.h>
 #include "USARTDevice.h"
 
-void USARTInit(void)
+static unsigned char usartTxBuffer[USART_TX_BUFFER_SIZE];
+static unsigned char usartRxBuffer[USART_RX_BUFFER_SIZE];
+static tFIFO usartTxFIFO;
+static tFIFO usartRxFIFO;
+/** Bytes lost on reception, ring full or overrun of the module*/
+static unsigned int usartRxOverruns = 0;
+/** USART_AUTOBAUD_BUSY while the auto-baud is measuring*/
+static volatile unsigned char usartAutoBaud = USART_AUTOBAUD_DONE;
+
+/**
+ * Divisors of the common rates at USART_FOSC, computed by the compiler so
+ * USARTSetBaudrate() doesn't divide for them.
+ */
+typedef struct
+{
+    unsigned long baudrate;
+    unsigned int divisor;
+    unsigned char brgh;
+} tUSARTBaud;
+
+#define USART_BAUD_ENTRY(baud)  {baud, (unsigned int) USART_DIVISOR(baud), USART_BRGH(baud)}
+
+static const tUSARTBaud usartBaudTable[] = {
+    USART_BAUD_ENTRY(9600),
+    USART_BAUD_ENTRY(19200),
+    USART_BAUD_ENTRY(38400),
+    USART_BAUD_ENTRY(57600),
+    USART_BAUD_ENTRY(115200),
+    USART_BAUD_ENTRY(230400),
+    USART_BAUD_ENTRY(250000),
+    USART_BAUD_ENTRY(460800),
+    USART_BAUD_ENTRY(500000),
+    USART_BAUD_ENTRY(921600),
+    USART_BAUD_ENTRY(1000000)
+};
+
+/**
+ * Loads the baud rate generator.
+ */
+static void USARTLoadDivisor(unsigned int divisor, unsigned char brgh)
 {
-    unsigned int baud = 0;
-    unsigned char low, high;
+    USART_TXSTATbits.BRGH = brgh;
+    SPBRG_HIGH = (unsigned char) (divisor >> 8);
+    SPBRG_LOW = (unsigned char) (divisor & 0x00FF);
+}
 
+void USARTInit(void)
+{
     USART_TXSTATbits.CSRC = 1;
     USART_TXSTATbits.TX9 = 0;
     USART_TXSTATbits.TXEN = 1;
@@ -50,32 +94,120 @@ void USARTInit(void)
     USART_BAUDCONbits.RCIDL = 1;
     USART_BAUDCONbits.RXDTP = 0;
     USART_BAUDCONbits.TXCKP = 1;
-    USART_BAUDCONbits.BRG16 = 0;
+    USART_BAUDCONbits.BRG16 = 1;
     USART_BAUDCONbits.WUE = 0;
     USART_BAUDCONbits.ABDEN = 0;
 
-    baud = USART_SPBRG;
-    low = (unsigned char) (baud & 0x00FF);
-    high = (unsigned char) (baud >> 8);
-    SPBRG_LOW = low;
-    SPBRG_HIGH = high;
+    USARTLoadDivisor((unsigned int) USART_SPBRG, USART_BRGH(BAUDRATE));
 
+    USART_RX_INT_PRIORITY = USART_HIGH_PRIORITY;
+    USART_TX_INT_PRIORITY = USART_HIGH_PRIORITY;
 }
 
 /**
- * Set the baudrate on the fly based on the requested.
+ * Set the baudrate on the fly based on the requested. The 16 bit generator
+ * is used at FOSC/4 when the divisor fits, the lowest error for every
+ * rate. The rates of the table are set without a division.
  * @param baudrate
  */
 void USARTSetBaudrate(unsigned long baudrate)
 {
-    unsigned int baud = 0;
-    unsigned char low, high;
+    unsigned char i;
+    unsigned long divisor;
 
-    baud = ((USART_FOSC/baudrate/16)-1);
-    low = (unsigned char) (baud & 0x00FF);
-    high = (unsigned char) (baud >> 8);
-    SPBRG_LOW = low;
-    SPBRG_HIGH = high;
+    for (i = 0; i < sizeof (usartBaudTable) / sizeof (usartBaudTable[0]); i++)
+    {
+        if (usartBaudTable[i].baudrate == baudrate)
+        {
+            USARTLoadDivisor(usartBaudTable[i].divisor, usartBaudTable[i].brgh);
+            return;
+        }
+    }
+
+    divisor = USART_DIVISOR_4(baudrate);
+
+    if (divisor <= 0xFFFF)
+    {
+        USARTLoadDivisor((unsigned int) divisor, 1);
+    }
+    else
+    {
+        USARTLoadDivisor((unsigned int) USART_DIVISOR_16(baudrate), 0);
+    }
+}
+
+/**
+ * Baud rate the generator is set to, as measured by the auto-baud.
+ * @return Rate, in bit/s.
+ */
+unsigned long USARTGetBaudrate(void)
+{
+    unsigned long divisor = ((unsigned int) SPBRG_HIGH << 8) | SPBRG_LOW;
+
+    return USART_FOSC / ((USART_TXSTATbits.BRGH ? 4UL : 16UL) * (divisor + 1));
+}
+
+/**
+ * Starts the auto-baud detection of the EUSART. The other side has to send
+ * a 'U' (0x55), the module measures it and loads the generator. The byte is
+ * not received. The speed of the counter is the one of BRGH, so a rate
+ * slower than the FOSC/4 generator allows needs BRGH = 0 first
+ * (USARTSetBaudrate() with a slow rate).
+ */
+void USARTAutoBaudStart(void)
+{
+    unsigned char interrupt = USART_RX_INT_ENABLE;
+
+    USART_RX_INT_ENABLE = 0;
+    USART_BAUDCONbits.ABDOVF = 0;
+    usartAutoBaud = USART_AUTOBAUD_BUSY;
+    USART_BAUDCONbits.ABDEN = 1;
+    USART_RX_INT_ENABLE = interrupt;
+}
+
+/**
+ * Ends the auto-baud when the module is done, called from
+ * USARTAutoBaudPoll() and from the interrupt handler.
+ */
+static void USARTAutoBaudCheck(void)
+{
+    if (USART_BAUDCONbits.ABDOVF)
+    {
+        //the rate is too slow for the counter
+        USART_BAUDCONbits.ABDEN = 0;
+        USART_BAUDCONbits.ABDOVF = 0;
+        usartAutoBaud = USART_AUTOBAUD_OVERFLOW;
+    }
+    else if (!USART_BAUDCONbits.ABDEN && USART_RX_FLAG)
+    {
+        //the flag is set at the end of the measure, the byte has no meaning,
+        //the read clears it
+        (void) USART_RX_REG;
+        usartAutoBaud = USART_AUTOBAUD_DONE;
+    }
+}
+
+/**
+ * State of the auto-baud detection. It can be polled with or without the
+ * reception interrupt.
+ * @return USART_AUTOBAUD_DONE when the generator is loaded,
+ *         USART_AUTOBAUD_BUSY while waiting for the 'U',
+ *         USART_AUTOBAUD_OVERFLOW if the rate couldn't be measured.
+ */
+unsigned char USARTAutoBaudPoll(void)
+{
+    unsigned char interrupt = USART_RX_INT_ENABLE;
+
+    USART_RX_INT_ENABLE = 0;
+
+    if (usartAutoBaud == USART_AUTOBAUD_BUSY)
+    {
+        USARTAutoBaudCheck();
+    }
+
+    USART_RX_INT_ENABLE = interrupt;
+
+    return usartAutoBaud;
 }
 
 /**
@@ -131,4 +263,199 @@ void USARTSendROMString(const char *string)
         if (c != 0) USARTPutChar(c);
     }
     while (c != 0);
-}
\ No newline at end of file
+}
+
+/**
+ * Initiates the USART for the buffered functions. The reception interrupt
+ * is enabled, the transmission one is enabled while there are bytes to
+ * send. The peripheral and global interrupts must be enabled by the user,
+ * and USARTInterruptHandler() called from the interrupt routine. The
+ * blocking functions must not be used after this, they would pass the bytes
+ * still in the rings.
+ */
+void USARTBufferedInit(void)
+{
+    unsigned char dummy;
+
+    USART_RX_INT_ENABLE = 0;
+    USART_TX_INT_ENABLE = 0;
+
+    USARTInit();
+
+    uFIFOInit(&usartTxFIFO, usartTxBuffer, USART_TX_BUFFER_SIZE);
+    uFIFOInit(&usartRxFIFO, usartRxBuffer, USART_RX_BUFFER_SIZE);
+    usartRxOverruns = 0;
+
+    while (USART_RX_FLAG)
+    {
+        dummy = USART_RX_REG;
+    }
+
+    USART_RX_INT_ENABLE = 1;
+}
+
+/**
+ * Puts a character in the transmission ring, without waiting.
+ * @param c Char to be sent.
+ * @return 0 if queued, 1 if the ring is full.
+ */
+unsigned char USARTBufferedPutChar(char c)
+{
+    return (USARTBufferedWrite(&c, 1) == 1) ? 0 : 1;
+}
+
+/**
+ * Takes a character from the reception ring, without waiting.
+ * @param c Where the char received is stored.
+ * @return 0 if a char was read, 1 if the ring is empty.
+ */
+unsigned char USARTBufferedGetChar(char *c)
+{
+    return (USARTBufferedRead(c, 1) == 1) ? 0 : 1;
+}
+
+/**
+ * Puts the bytes in the transmission ring, as many as there is room for,
+ * and starts the transmission.
+ * @param data Bytes to be sent.
+ * @param length Number of bytes.
+ * @return Number of bytes queued.
+ */
+unsigned int USARTBufferedWrite(const char *data, unsigned int length)
+{
+    unsigned int queued;
+
+    //the interrupt routine can't take bytes while the ring is changed
+    USART_TX_INT_ENABLE = 0;
+    queued = uFIFOPut(&usartTxFIFO, (unsigned char *) data, length);
+
+    if (!uFIFOisEmpty(&usartTxFIFO))
+    {
+        USART_TX_INT_ENABLE = 1;
+    }
+
+    return queued;
+}
+
+/**
+ * Takes the bytes received from the reception ring, without waiting.
+ * @param data Where the bytes are stored.
+ * @param length Maximum number of bytes.
+ * @return Number of bytes read.
+ */
+unsigned int USARTBufferedRead(char *data, unsigned int length)
+{
+    unsigned int read;
+    unsigned char interrupt = USART_RX_INT_ENABLE;
+
+    USART_RX_INT_ENABLE = 0;
+    read = uFIFOGet(&usartRxFIFO, (unsigned char *) data, length);
+    USART_RX_INT_ENABLE = interrupt;
+
+    return read;
+}
+
+/**
+ * Puts a string in the transmission ring, without waiting. If there isn't
+ * room for all of it the end of the string is not sent.
+ * @param string String to be sent.
+ * @return Number of characters queued.
+ */
+unsigned int USARTBufferedSendString(const char *string)
+{
+    return USARTBufferedWrite(string, strlen(string));
+}
+
+/**
+ * Number of bytes received waiting in the reception ring.
+ */
+unsigned int USARTBufferedRxCount(void)
+{
+    unsigned int count;
+    unsigned char interrupt = USART_RX_INT_ENABLE;
+
+    USART_RX_INT_ENABLE = 0;
+    count = uFIFOSpaceOcupied(&usartRxFIFO);
+    USART_RX_INT_ENABLE = interrupt;
+
+    return count;
+}
+
+/**
+ * Room left in the transmission ring.
+ */
+unsigned int USARTBufferedTxFree(void)
+{
+    unsigned int count;
+    unsigned char interrupt = USART_TX_INT_ENABLE;
+
+    USART_TX_INT_ENABLE = 0;
+    count = USART_TX_BUFFER_SIZE - uFIFOSpaceOcupied(&usartTxFIFO);
+    USART_TX_INT_ENABLE = interrupt;
+
+    return count;
+}
+
+/**
+ * Number of bytes lost on reception since USARTBufferedInit(), because the
+ * ring was full or the module had an overrun.
+ */
+unsigned int USARTBufferedRxOverruns(void)
+{
+    unsigned int count;
+    unsigned char interrupt = USART_RX_INT_ENABLE;
+
+    USART_RX_INT_ENABLE = 0;
+    count = usartRxOverruns;
+    USART_RX_INT_ENABLE = interrupt;
+
+    return count;
+}
+
+/**
+ * Interrupt handler of the buffered functions, it has to be called from the
+ * interrupt routine. It checks the flags itself.
+ */
+void USARTInterruptHandler(void)
+{
+    unsigned char c;
+
+    if (usartAutoBaud == USART_AUTOBAUD_BUSY)
+    {
+        USARTAutoBaudCheck();
+    }
+    else if (USART_RX_INT_ENABLE && USART_RX_FLAG)
+    {
+        if (USART_RCSTATbits.OERR)
+        {
+            //the reception stops on an overrun until CREN is cleared
+            USART_RCSTATbits.CREN = 0;
+            USART_RCSTATbits.CREN = 1;
+            usartRxOverruns++;
+        }
+
+        //the module holds two bytes, reading them clears the flag
+        while (USART_RX_FLAG)
+        {
+            c = USART_RX_REG;
+
+            if (uFIFOPut(&usartRxFIFO, &c, 1) == 0)
+            {
+                usartRxOverruns++;
+            }
+        }
+    }
+
+    //the flag is set while TXREG is empty, the interrupt is stopped instead
+    if (USART_TX_INT_ENABLE && USART_TX_FLAG)
+    {
+        if (uFIFOGet(&usartTxFIFO, &c, 1) == 1)
+        {
+            USART_TX_REG = c;
+        }
+        else
+        {
+            USART_TX_INT_ENABLE = 0;
+        }
+    }
+}
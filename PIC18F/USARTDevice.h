@@ -25,10 +25,22 @@
 #define	USARTDEVICE_H
 
 #include <p18cxxx.h>
+#include "uCFIFO/uFIFO.h"
 
 #define BAUDRATE                115200
 #define USART_FOSC              64000000
-#define USART_SPBRG             ((USART_FOSC/BAUDRATE/16)-1)
+
+/** Divisor of the baud rate generator with BRG16 = 1 and BRGH = 1 (FOSC/4),
+ rounded to the nearest, the lowest error the module can do*/
+#define USART_DIVISOR_4(baud)   ((((unsigned long) USART_FOSC + 2UL * (baud)) / (4UL * (baud))) - 1)
+/** Divisor with BRG16 = 1 and BRGH = 0 (FOSC/16), for the rates too slow for
+ 16 bits at FOSC/4*/
+#define USART_DIVISOR_16(baud)  ((((unsigned long) USART_FOSC + 8UL * (baud)) / (16UL * (baud))) - 1)
+/** BRGH of a rate, 1 when its FOSC/4 divisor fits in 16 bits*/
+#define USART_BRGH(baud)        (USART_DIVISOR_4(baud) <= 0xFFFFUL)
+/** Divisor of a rate, resolved by the compiler for a constant rate*/
+#define USART_DIVISOR(baud)     (USART_BRGH(baud) ? USART_DIVISOR_4(baud) : USART_DIVISOR_16(baud))
+#define USART_SPBRG             USART_DIVISOR(BAUDRATE)
 #define USART_TXSTATbits        TXSTAbits
 #define USART_RCSTATbits        RCSTAbits
 #define USART_BAUDCONbits       BAUDCONbits
@@ -38,13 +50,49 @@
 #define USART_TX_REG            TXREG1
 #define USART_RX_FLAG           PIR1bits.RC1IF
 #define USART_TX_FLAG           PIR1bits.TX1IF
+#define USART_RX_INT_ENABLE     PIE1bits.RC1IE
+#define USART_TX_INT_ENABLE     PIE1bits.TX1IE
+#define USART_RX_INT_PRIORITY   IPR1bits.RC1IP
+#define USART_TX_INT_PRIORITY   IPR1bits.TX1IP
+
+/** Priority of the interrupts, 1 for high, see InterruptPriority.h*/
+#ifndef USART_HIGH_PRIORITY
+#define USART_HIGH_PRIORITY     1
+#endif
+
+/** Results of USARTAutoBaudPoll()*/
+#define USART_AUTOBAUD_DONE     0
+#define USART_AUTOBAUD_BUSY     1
+#define USART_AUTOBAUD_OVERFLOW 2
+
+/** Size of the transmission ring of the buffered functions*/
+#ifndef USART_TX_BUFFER_SIZE
+#define USART_TX_BUFFER_SIZE    64
+#endif
+/** Size of the reception ring of the buffered functions*/
+#ifndef USART_RX_BUFFER_SIZE
+#define USART_RX_BUFFER_SIZE    32
+#endif
 
 
 void USARTInit(void);
 void USARTSetBaudrate(unsigned long baudrate);
+void USARTAutoBaudStart(void);
+unsigned char USARTAutoBaudPoll(void);
+unsigned long USARTGetBaudrate(void);
 void USARTPutChar(char c);
 char USARTGetChar(void);
 void USARTSendRAMString(char *string);
 void USARTSendROMString(const char *string);
+void USARTBufferedInit(void);
+unsigned char USARTBufferedPutChar(char c);
+unsigned char USARTBufferedGetChar(char *c);
+unsigned int USARTBufferedWrite(const char *data, unsigned int length);
+unsigned int USARTBufferedRead(char *data, unsigned int length);
+unsigned int USARTBufferedSendString(const char *string);
+unsigned int USARTBufferedRxCount(void);
+unsigned int USARTBufferedTxFree(void);
+unsigned int USARTBufferedRxOverruns(void);
+void USARTInterruptHandler(void);
 #endif	/* USARTDEVICE_H */
 
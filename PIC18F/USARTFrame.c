@@ -0,0 +1,267 @@
+/**
+ *  @file       USARTFrame.c
+ *  @brief      Binary frames over the buffered USART.
+ *  @author     Luis Maduro
+ *  @version    1.00
+ *  @date       14/10/2026
+ *
+ *  Copyright (C) 2026  Luis Maduro
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <stddef.h>
+#include "USARTFrame.h"
+
+/** Longest COBS block, 254 bytes without a zero*/
+#define COBS_MAXIMUM_RUN            254
+
+/** Frame being received, decoded in place, payload and CRC*/
+static unsigned char frameBuffer[USART_FRAME_MAXIMUM_LENGTH + 2];
+static unsigned int frameLength;
+/** Code of the COBS block being received, 0 before the first one*/
+static unsigned char frameCode;
+/** Bytes still to come in the block*/
+static unsigned char frameRemaining;
+/** Set when the frame doesn't fit, it is dropped at the delimiter*/
+static unsigned char frameDiscard;
+static unsigned int frameErrors;
+
+/**
+ * Restarts the reception of a frame.
+ */
+static void USARTFrameRestart(void)
+{
+    frameLength = 0;
+    frameCode = 0;
+    frameRemaining = 0;
+    frameDiscard = 0;
+}
+
+/**
+ * Stores a decoded byte of the frame being received.
+ */
+static void USARTFrameStore(unsigned char value)
+{
+    if (frameLength < sizeof (frameBuffer))
+    {
+        frameBuffer[frameLength++] = value;
+    }
+    else
+    {
+        frameDiscard = 1;
+    }
+}
+
+/**
+ * Byte of a frame to send, the payload and then the CRC.
+ */
+static unsigned char USARTFrameByte(const unsigned char *data,
+                                    unsigned int length,
+                                    const unsigned char *crc,
+                                    unsigned int position)
+{
+    return (position < length) ? data[position] : crc[position - length];
+}
+
+/**
+ * Initiates the reception of frames. USARTBufferedInit() has to be called
+ * before.
+ */
+void USARTFrameInit(void)
+{
+    USARTFrameRestart();
+    frameErrors = 0;
+}
+
+/**
+ * Computes the CRC-16 of the frames, the same as OneWireCRC16() (polynomial
+ * 0xA001, not inverted). The frames start it at USART_FRAME_CRC_INITIAL,
+ * the CRC of a frame followed by its CRC, low byte first, is then 0.
+ * @param data Bytes to compute.
+ * @param length Number of bytes.
+ * @param crc Initial value, or the CRC of the bytes before.
+ * @return The CRC.
+ */
+unsigned int USARTFrameCRC16(const unsigned char *data, unsigned int length,
+                             unsigned int crc)
+{
+    static const unsigned char oddparity[16] = {0, 1, 1, 0, 1, 0, 0, 1, 1, 0, 0, 1, 0, 1, 1, 0};
+    unsigned int cdata;
+    unsigned int i;
+
+    for (i = 0; i < length; i++)
+    {
+        cdata = (data[i] ^ crc) & 0xff;
+        crc >>= 8;
+
+        if (oddparity[cdata & 0x0F] ^ oddparity[cdata >> 4])
+            crc ^= 0xC001;
+
+        cdata <<= 6;
+        crc ^= cdata;
+        cdata <<= 1;
+        crc ^= cdata;
+    }
+
+    return crc;
+}
+
+/**
+ * Sends a frame. It is encoded straight into the TX ring, the runs of the
+ * payload without zeros are copied by USARTBufferedWrite() from the data of
+ * the caller, and it is queued whole or not at all. A frame longer than
+ * the TX ring allows, USART_FRAME_ENCODED_LENGTH(), can never be sent.
+ * @param data Payload of the frame.
+ * @param length Number of bytes of the payload.
+ * @return 0 if queued, 1 if there is no room for it in the TX ring yet.
+ */
+unsigned char USARTFrameSend(const unsigned char *data, unsigned int length)
+{
+    unsigned char crc[2];
+    unsigned int total = length + 2;
+    unsigned int position = 0;
+    unsigned int run;
+    unsigned int i;
+
+    //only this side puts bytes in the ring, the room can only grow
+    if (USARTBufferedTxFree() < USART_FRAME_ENCODED_LENGTH(length))
+    {
+        return 1;
+    }
+
+    i = USARTFrameCRC16(data, length, USART_FRAME_CRC_INITIAL);
+    crc[0] = (unsigned char) (i & 0xFF);
+    crc[1] = (unsigned char) (i >> 8);
+
+    for (;;)
+    {
+        for (run = 0; (position + run < total) && (run < COBS_MAXIMUM_RUN); run++)
+        {
+            if (USARTFrameByte(data, length, crc, position + run) == 0)
+            {
+                break;
+            }
+        }
+
+        USARTBufferedPutChar((char) (run + 1));
+
+        //the part of the run in the payload in one go, then the CRC
+        i = 0;
+        if (position < length)
+        {
+            i = (position + run <= length) ? run : length - position;
+            USARTBufferedWrite((const char *) &data[position], i);
+        }
+
+        for (; i < run; i++)
+        {
+            USARTBufferedPutChar((char) crc[position + i - length]);
+        }
+
+        position += run;
+
+        if (position == total)
+        {
+            break;
+        }
+
+        //the zero that ended the run is the code of the next block
+        if (run < COBS_MAXIMUM_RUN)
+        {
+            position++;
+        }
+    }
+
+    USARTBufferedPutChar(USART_FRAME_DELIMITER);
+
+    return 0;
+}
+
+/**
+ * Takes the bytes received from the RX ring and decodes them, in place, up
+ * to the end of a frame. The frames with a wrong CRC or too long are
+ * dropped.
+ * @param length Where the length of the payload is stored.
+ * @return Payload of the frame received, in the buffer of the library, NULL
+ *         if there isn't a whole frame yet. It is valid until the next call.
+ */
+unsigned char *USARTFrameReceive(unsigned int *length)
+{
+    char c;
+    unsigned char value;
+    unsigned char valid;
+
+    while (USARTBufferedGetChar(&c) == 0)
+    {
+        value = (unsigned char) c;
+
+        if (value == USART_FRAME_DELIMITER)
+        {
+            valid = !frameDiscard && (frameRemaining == 0) &&
+                    (frameLength >= 2) &&
+                    (USARTFrameCRC16(frameBuffer, frameLength,
+                                     USART_FRAME_CRC_INITIAL) == 0);
+
+            //a delimiter alone is only a start of frame
+            if (!valid && (frameCode != 0))
+            {
+                frameErrors++;
+            }
+
+            if (valid)
+            {
+                *length = frameLength - 2;
+            }
+
+            USARTFrameRestart();
+
+            if (valid)
+            {
+                return frameBuffer;
+            }
+        }
+        else if (frameDiscard)
+        {
+            continue;
+        }
+        else if (frameRemaining == 0)
+        {
+            //a block shorter than the maximum was ended by a zero
+            if ((frameCode != 0) && (frameCode != COBS_MAXIMUM_RUN + 1))
+            {
+                USARTFrameStore(0);
+            }
+
+            frameCode = value;
+            frameRemaining = value - 1;
+        }
+        else
+        {
+            USARTFrameStore(value);
+            frameRemaining--;
+        }
+    }
+
+    return NULL;
+}
+
+/**
+ * Number of frames dropped since USARTFrameInit(), wrong CRC, too long or
+ * cut by a delimiter.
+ */
+unsigned int USARTFrameErrors(void)
+{
+    return frameErrors;
+}
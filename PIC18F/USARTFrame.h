@@ -0,0 +1,60 @@
+/**
+ *  @file       USARTFrame.h
+ *  @brief      Binary frames over the buffered USART.
+ *  @author     Luis Maduro
+ *  @version    1.00
+ *  @date       14/10/2026
+ *
+ *  Every frame is the payload followed by its CRC-16, low byte first, COBS
+ *  encoded and ended by a 0x00. The CRC is the one of 1-Wire (polynomial
+ *  0xA001) started at 0xFFFF, so the zeros at the start of a frame count.
+ *  There are no zeros inside an encoded frame, so the receiver always finds
+ *  the start of the next frame after an error, and the overhead is one byte
+ *  every 254 plus the delimiter, whatever the payload.
+ *
+ *  Copyright (C) 2026  Luis Maduro
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef USARTFRAME_H
+#define USARTFRAME_H
+
+#include "USARTDevice.h"
+
+/** Maximum payload of a received frame, the receive buffer takes this plus
+ the two CRC bytes*/
+#ifndef USART_FRAME_MAXIMUM_LENGTH
+#define USART_FRAME_MAXIMUM_LENGTH  64
+#endif
+
+/** Initial value of the CRC of the frames*/
+#define USART_FRAME_CRC_INITIAL     0xFFFF
+
+/** Delimiter of the frames*/
+#define USART_FRAME_DELIMITER       0x00
+
+/** Largest number of bytes on the line of a frame with length bytes of
+ payload, the TX ring must have this much room for USARTFrameSend()*/
+#define USART_FRAME_ENCODED_LENGTH(length) \
+    ((length) + 2 + ((length) + 2) / 254 + 2)
+
+void USARTFrameInit(void);
+unsigned int USARTFrameCRC16(const unsigned char *data, unsigned int length,
+                             unsigned int crc);
+unsigned char USARTFrameSend(const unsigned char *data, unsigned int length);
+unsigned char *USARTFrameReceive(unsigned int *length);
+unsigned int USARTFrameErrors(void);
+
+#endif /* USARTFRAME_H */
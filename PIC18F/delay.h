@@ -8,21 +8,106 @@
  * Nilesh Rajbharti     5/9/02  Original        (Rev 1.0)
  * Nilesh Rajbharti     6/10/02 Fixed C18 ms and us routines
  * Howard Schlunder     4/04/06	Changed for C30
+ * Luis Maduro          14/10/26 Delays of exact cycles for constants
  ********************************************************************/
 #ifndef __DELAY_H
 #define __DELAY_H
 
-#include <delays.h>
+/*
+ * DelayCycles(), DelayUs() and DelayMs() take constant arguments, the number
+ * of instruction cycles is computed by the compiler.
+ *
+ * With XC8 the delays are _delay() of the compiler, exact to the cycle.
+ *
+ * With C18 the cycles are split into one Delay1KTCYx(), one Delay10TCYx()
+ * and up to 9 + DELAY_CALL_CYCLES Nop(), the cost of each call of the
+ * library (DELAY_CALL_CYCLES) taken out of the delay. The delay is then
+ * exact for DELAY_CALL_CYCLES cycles and more, a shorter one is only the
+ * Nop(). DelayCycles() is limited to DELAY_MAX_CYCLES, DelayUs() to
+ * DELAY_MAX_US and DelayMs() to 65535 ms, its loop adds a few cycles per ms.
+ * A variable argument builds all the arithmetic in the code, use the
+ * functions of delays.h for them.
+ */
 
+#ifndef SYSTEM_CLOCK
 #define SYSTEM_CLOCK        64000000UL
+#endif
 #define INSTRUCTION_CLOCK   (SYSTEM_CLOCK/4)
 
-#define Delay10us(us)   Delay10TCYx(((INSTRUCTION_CLOCK/1000000)*(us)))
+/**Instruction cycles in a time.*/
+#define DELAY_US_CYCLES(us) ((unsigned long) (us) * (INSTRUCTION_CLOCK / 1000UL) / 1000UL)
+#define DELAY_MS_CYCLES     (INSTRUCTION_CLOCK / 1000UL)
+
+#if defined(__XC8)
+#include <xc.h>
+
+#define DELAY_MAX_CYCLES    50463240UL
+
+#define DelayCycles(cycles) _delay((unsigned long) (cycles))
+#else
+#include <p18cxxx.h>
+#include <delays.h>
+
+/**Cycles of the movlw, the push of the argument, the call and the return
+ * around a delay of the library, check in the simulator with the version of
+ * C18 and the memory model.*/
+#ifndef DELAY_CALL_CYCLES
+#define DELAY_CALL_CYCLES   6
+#endif
+
+#define DELAY_MAX_CYCLES    (255UL * 1000UL)
+
+/** @cond IGNORE*/
+//count of units of a call, if the call fits in the cycles
+#define DELAY_COUNT(c, unit)    (((c) >= (unit) + DELAY_CALL_CYCLES) ? (((c) - DELAY_CALL_CYCLES) / (unit)) : 0)
+//cycles left after the call
+#define DELAY_LEFT(c, unit)     ((c) - (DELAY_COUNT(c, unit) ? DELAY_COUNT(c, unit) * (unit) + DELAY_CALL_CYCLES : 0))
+
+#define DELAY_NOPS(n)                                                   \
+    do                                                                  \
+    {                                                                   \
+        if ((n) > 0) Nop();                                             \
+        if ((n) > 1) Nop();                                             \
+        if ((n) > 2) Nop();                                             \
+        if ((n) > 3) Nop();                                             \
+        if ((n) > 4) Nop();                                             \
+        if ((n) > 5) Nop();                                             \
+        if ((n) > 6) Nop();                                             \
+        if ((n) > 7) Nop();                                             \
+        if ((n) > 8) Nop();                                             \
+        if ((n) > 9) Nop();                                             \
+        if ((n) > 10) Nop();                                            \
+        if ((n) > 11) Nop();                                            \
+        if ((n) > 12) Nop();                                            \
+        if ((n) > 13) Nop();                                            \
+        if ((n) > 14) Nop();                                            \
+        if ((n) > 15) Nop();                                            \
+        if ((n) > 16) Nop();                                            \
+        if ((n) > 17) Nop();                                            \
+        if ((n) > 18) Nop();                                            \
+    } while(0)
+/** @endcond*/
+
+#define DelayCycles(cycles)                                             \
+    do                                                                  \
+    {                                                                   \
+        if (DELAY_COUNT((cycles), 1000UL))                              \
+            Delay1KTCYx((unsigned char) DELAY_COUNT((cycles), 1000UL)); \
+        if (DELAY_COUNT(DELAY_LEFT((cycles), 1000UL), 10UL))            \
+            Delay10TCYx((unsigned char) DELAY_COUNT(DELAY_LEFT((cycles), 1000UL), 10UL)); \
+        DELAY_NOPS(DELAY_LEFT(DELAY_LEFT((cycles), 1000UL), 10UL));     \
+    } while(0)
+#endif
+
+#define DELAY_MAX_US        (DELAY_MAX_CYCLES / (INSTRUCTION_CLOCK / 1000000UL))
+
+#define DelayUs(us)         DelayCycles(DELAY_US_CYCLES(us))
+#define Delay10us(us)       DelayUs(10UL * (us))
 #define DelayMs(ms)                                                 \
     do                                                              \
     {                                                               \
         unsigned int _iTemp = (ms);                                 \
         while(_iTemp--)                                             \
-            Delay1KTCYx((INSTRUCTION_CLOCK+999999)/1000000);    \
+            DelayCycles(DELAY_MS_CYCLES);                           \
     } while(0)
 #endif
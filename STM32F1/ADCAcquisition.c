@@ -0,0 +1,536 @@
+/**
+ *  @file       ADCAcquisition.c
+ *  @author     Luis Maduro
+ *  @version    1.00
+ *  @date       14/10/2026
+ *  @brief      Continuous ADC acquisition by DMA into a ping-pong buffer.
+ *
+ *  Copyright (C) 2026  Luis Maduro
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <stddef.h>
+#include "ADCAcquisition.h"
+#include "PowerManager.h"
+
+/**Highest ADC clock of the STM32F1.*/
+#define ADC_ACQUISITION_MAX_CLOCK   14000000UL
+
+static tADCAcquisitionConfig acquisition;
+/**Samples of a scan, count or 2 * count in dual mode.*/
+static unsigned int scanSamples;
+/**Samples of a half of the buffer.*/
+static unsigned int halfSamples;
+/**Scans converted since the start, the timestamp of the ring.*/
+static volatile unsigned long scanCount;
+/**Halves not given before the DMA came back to them.*/
+static volatile unsigned int overruns;
+static bool running = false;
+/**State of the trigger mode.*/
+static volatile tADCAcquisitionTrigger triggerState = ADC_ACQUISITION_STOPPED;
+/**The DMA has filled the whole buffer since the start.*/
+static volatile bool primed;
+/**Scan of the buffer holding the trigger, and the scans kept before it.*/
+static unsigned int triggerScan;
+static unsigned int triggerPre;
+
+/**
+ * Configures the pin of a channel as an analog input: channels 0 to 7 are
+ * PA0 to PA7, 8 and 9 are PB0 and PB1, 10 to 15 are PC0 to PC5.
+ */
+static void ADCAcquisitionConfigurePin(uint8_t channel)
+{
+    GPIO_InitTypeDef GPIO_InitStructure;
+
+    GPIO_InitStructure.GPIO_Mode = GPIO_Mode_AIN;
+    GPIO_InitStructure.GPIO_Speed = GPIO_Speed_50MHz;
+
+    if (channel < 8)
+    {
+        GPIO_InitStructure.GPIO_Pin = 1 << channel;
+        GPIO_Init(GPIOA, &GPIO_InitStructure);
+    }
+    else if (channel < 10)
+    {
+        GPIO_InitStructure.GPIO_Pin = 1 << (channel - 8);
+        GPIO_Init(GPIOB, &GPIO_InitStructure);
+    }
+    else if (channel < 16)
+    {
+        GPIO_InitStructure.GPIO_Pin = 1 << (channel - 10);
+        GPIO_Init(GPIOC, &GPIO_InitStructure);
+    }
+    else
+    {
+        //16 and 17 are the temperature sensor and Vrefint
+        ADC_TempSensorVrefintCmd(ENABLE);
+    }
+}
+
+/**
+ * Configures the regular channels of an ADC, for the trigger given.
+ */
+static void ADCAcquisitionConfigureADC(ADC_TypeDef *ADCx,
+                                       const uint8_t *channels,
+                                       uint32_t trigger)
+{
+    ADC_InitTypeDef ADC_InitStructure;
+    uint8_t i;
+
+    ADC_DeInit(ADCx);
+    ADC_InitStructure.ADC_Mode = acquisition.dual ? ADC_Mode_RegSimult : ADC_Mode_Independent;
+    ADC_InitStructure.ADC_ScanConvMode = (acquisition.count > 1) ? ENABLE : DISABLE;
+    ADC_InitStructure.ADC_ContinuousConvMode = DISABLE;
+    ADC_InitStructure.ADC_ExternalTrigConv = trigger;
+    ADC_InitStructure.ADC_DataAlign = ADC_DataAlign_Right;
+    ADC_InitStructure.ADC_NbrOfChannel = acquisition.count;
+    ADC_Init(ADCx, &ADC_InitStructure);
+
+    for (i = 0; i < acquisition.count; i++)
+    {
+        ADCAcquisitionConfigurePin(channels[i]);
+        ADC_RegularChannelConfig(ADCx, channels[i], i + 1, acquisition.sampleTime);
+    }
+
+    //ADC2 follows ADC1 in dual mode, its trigger must be enabled too
+    ADC_ExternalTrigConvCmd(ADCx, ENABLE);
+
+    ADC_Cmd(ADCx, ENABLE);
+
+    ADC_ResetCalibration(ADCx);
+    while (ADC_GetResetCalibrationStatus(ADCx));
+    ADC_StartCalibration(ADCx);
+    while (ADC_GetCalibrationStatus(ADCx));
+}
+
+/**
+ * Sets TIM3 to give a trigger (TRGO on update) at a rate.
+ */
+static void ADCAcquisitionConfigureTimer(uint32_t rate)
+{
+    TIM_TimeBaseInitTypeDef TIM_TimeBaseStructure;
+    RCC_ClocksTypeDef clocks;
+    uint32_t clock;
+    uint32_t ticks;
+    uint16_t prescaler;
+
+    RCC_GetClocksFreq(&clocks);
+
+    //the timers of APB1 run at twice PCLK1 when APB1 is divided
+    clock = clocks.PCLK1_Frequency;
+    if (RCC->CFGR & RCC_CFGR_PPRE1_2)
+    {
+        clock *= 2;
+    }
+
+    ticks = clock / rate;
+    prescaler = (uint16_t) ((ticks - 1) >> 16);
+    ticks /= prescaler + 1;
+
+    TIM_DeInit(TIM3);
+    TIM_TimeBaseStructure.TIM_Period = (uint16_t) (ticks - 1);
+    TIM_TimeBaseStructure.TIM_Prescaler = prescaler;
+    TIM_TimeBaseStructure.TIM_ClockDivision = TIM_CKD_DIV1;
+    TIM_TimeBaseStructure.TIM_CounterMode = TIM_CounterMode_Up;
+    TIM_TimeBaseStructure.TIM_RepetitionCounter = 0;
+    TIM_TimeBaseInit(TIM3, &TIM_TimeBaseStructure);
+
+    TIM_SelectOutputTrigger(TIM3, TIM_TRGOSource_Update);
+}
+
+/**
+ * Configures the ADCs, the DMA and the timer of an acquisition, stopped.
+ * The analog pins of the channels are configured.
+ * @param config Acquisition, it is copied.
+ * @return False if the configuration is not valid.
+ */
+bool ADCAcquisitionInit(const tADCAcquisitionConfig *config)
+{
+    DMA_InitTypeDef DMA_InitStructure;
+    NVIC_InitTypeDef NVIC_InitStructure;
+    RCC_ClocksTypeDef clocks;
+    uint32_t divider;
+
+    if (config->count == 0 || config->count > ADC_ACQUISITION_MAX_CHANNELS ||
+        config->buffer == NULL || config->scans == 0 || config->rate == 0 ||
+        config->oversampling > 8 ||
+        (config->scans & ((1 << config->oversampling) - 1)) != 0 ||
+        2UL * config->scans * config->count > 0xFFFF)
+    {
+        return false;
+    }
+
+    if (config->trigger &&
+        (config->capture == NULL || config->postTrigger == 0 ||
+         (unsigned long) config->preTrigger + config->postTrigger > config->scans ||
+         config->watchdogHigh > 0xFFF || config->watchdogLow > config->watchdogHigh))
+    {
+        return false;
+    }
+
+    ADCAcquisitionStop();
+
+    acquisition = *config;
+    scanSamples = acquisition.dual ? 2 * acquisition.count : acquisition.count;
+    halfSamples = scanSamples * acquisition.scans;
+
+    RCC_AHBPeriphClockCmd(RCC_AHBPeriph_DMA1, ENABLE);
+    RCC_APB1PeriphClockCmd(RCC_APB1Periph_TIM3, ENABLE);
+    RCC_APB2PeriphClockCmd(RCC_APB2Periph_GPIOA | RCC_APB2Periph_GPIOB |
+                           RCC_APB2Periph_GPIOC | RCC_APB2Periph_ADC1, ENABLE);
+    if (acquisition.dual)
+    {
+        RCC_APB2PeriphClockCmd(RCC_APB2Periph_ADC2, ENABLE);
+    }
+
+    //fastest ADC clock, PCLK2 divided by 2, 4, 6 or 8
+    RCC_GetClocksFreq(&clocks);
+    for (divider = 2; divider < 8 && clocks.PCLK2_Frequency / divider > ADC_ACQUISITION_MAX_CLOCK;
+         divider += 2);
+    RCC_ADCCLKConfig((divider / 2 - 1) << 14);
+
+    ADCAcquisitionConfigureTimer(acquisition.rate);
+
+    DMA_DeInit(DMA1_Channel1);
+    DMA_InitStructure.DMA_PeripheralBaseAddr = (uint32_t) &ADC1->DR;
+    DMA_InitStructure.DMA_MemoryBaseAddr = (uint32_t) acquisition.buffer;
+    DMA_InitStructure.DMA_DIR = DMA_DIR_PeripheralSRC;
+    DMA_InitStructure.DMA_BufferSize = 2 * acquisition.scans * acquisition.count;
+    DMA_InitStructure.DMA_PeripheralInc = DMA_PeripheralInc_Disable;
+    DMA_InitStructure.DMA_MemoryInc = DMA_MemoryInc_Enable;
+    //the data of ADC2 is in the upper half-word in dual mode
+    DMA_InitStructure.DMA_PeripheralDataSize = acquisition.dual ? DMA_PeripheralDataSize_Word : DMA_PeripheralDataSize_HalfWord;
+    DMA_InitStructure.DMA_MemoryDataSize = acquisition.dual ? DMA_MemoryDataSize_Word : DMA_MemoryDataSize_HalfWord;
+    DMA_InitStructure.DMA_Mode = DMA_Mode_Circular;
+    DMA_InitStructure.DMA_Priority = DMA_Priority_VeryHigh;
+    DMA_InitStructure.DMA_M2M = DMA_M2M_Disable;
+    DMA_Init(DMA1_Channel1, &DMA_InitStructure);
+    DMA_ITConfig(DMA1_Channel1, DMA_IT_HT | DMA_IT_TC, ENABLE);
+
+    ADCAcquisitionConfigureADC(ADC1, acquisition.channels, ADC_ExternalTrigConv_T3_TRGO);
+    if (acquisition.dual)
+    {
+        ADCAcquisitionConfigureADC(ADC2, acquisition.channels2, ADC_ExternalTrigConv_None);
+    }
+    ADC_DMACmd(ADC1, ENABLE);
+
+    NVIC_InitStructure.NVIC_IRQChannel = DMA1_Channel1_IRQn;
+    NVIC_InitStructure.NVIC_IRQChannelPreemptionPriority = ADC_ACQUISITION_IRQ_PRIORITY;
+    NVIC_InitStructure.NVIC_IRQChannelSubPriority = 0;
+    NVIC_InitStructure.NVIC_IRQChannelCmd = ENABLE;
+    NVIC_Init(&NVIC_InitStructure);
+
+    if (acquisition.trigger)
+    {
+        ADC_AnalogWatchdogThresholdsConfig(ADC1, acquisition.watchdogHigh, acquisition.watchdogLow);
+
+        if (acquisition.watchdogChannel == ADC_ACQUISITION_ALL_CHANNELS)
+        {
+            ADC_AnalogWatchdogCmd(ADC1, ADC_AnalogWatchdog_AllRegEnable);
+        }
+        else
+        {
+            ADC_AnalogWatchdogSingleChannelConfig(ADC1, acquisition.watchdogChannel);
+            ADC_AnalogWatchdogCmd(ADC1, ADC_AnalogWatchdog_SingleRegEnable);
+        }
+
+        //the same priority, the two handlers don't preempt each other
+        NVIC_InitStructure.NVIC_IRQChannel = ADC1_2_IRQn;
+        NVIC_Init(&NVIC_InitStructure);
+    }
+
+    return true;
+}
+
+/**
+ * Starts the conversions, from the first half of the buffer.
+ */
+void ADCAcquisitionStart(void)
+{
+    scanCount = 0;
+    overruns = 0;
+
+    DMA_Cmd(DMA1_Channel1, DISABLE);
+    DMA_SetCurrDataCounter(DMA1_Channel1, 2 * acquisition.scans * acquisition.count);
+    DMA_ClearFlag(DMA1_FLAG_GL1);
+
+    if (acquisition.trigger)
+    {
+        //only the end of the first pass, for the scans before the trigger
+        primed = false;
+        triggerState = ADC_ACQUISITION_ARMED;
+        DMA_ITConfig(DMA1_Channel1, DMA_IT_HT, DISABLE);
+        DMA_ITConfig(DMA1_Channel1, DMA_IT_TC, ENABLE);
+        ADC_ClearITPendingBit(ADC1, ADC_IT_AWD);
+        ADC_ITConfig(ADC1, ADC_IT_AWD, ENABLE);
+    }
+
+    DMA_Cmd(DMA1_Channel1, ENABLE);
+
+    TIM_SetCounter(TIM3, 0);
+    TIM_Cmd(TIM3, ENABLE);
+
+    if (!running)
+    {
+        running = true;
+#ifdef USE_POWER_MANAGER
+        PowerManagerKeepAwake(POWER_MODE_STOP);
+#endif
+    }
+}
+
+/**
+ * Stops the trigger of the conversions, the half being filled is dropped.
+ */
+void ADCAcquisitionStop(void)
+{
+    TIM_Cmd(TIM3, DISABLE);
+    DMA_Cmd(DMA1_Channel1, DISABLE);
+
+    if (acquisition.trigger)
+    {
+        ADC_ITConfig(ADC1, ADC_IT_AWD, DISABLE);
+        triggerState = ADC_ACQUISITION_STOPPED;
+    }
+
+    if (running)
+    {
+        running = false;
+#ifdef USE_POWER_MANAGER
+        PowerManagerAllow(POWER_MODE_STOP);
+#endif
+    }
+}
+
+/**
+ * Gives the scans converted and handed over since the start.
+ * @return Scans, before the decimation.
+ */
+unsigned long ADCAcquisitionGetScans(void)
+{
+    return scanCount;
+}
+
+/**
+ * Gives the halves the interrupt was late for, their first samples were
+ * already overwritten when they were given.
+ * @return Overruns since the start.
+ */
+unsigned int ADCAcquisitionGetOverruns(void)
+{
+    return overruns;
+}
+
+/**
+ * Decimates a half in place and hands it over.
+ */
+static void ADCAcquisitionProcess(uint16_t *samples)
+{
+    tSample *sample;
+    unsigned int scans = acquisition.scans;
+    unsigned int group = 1U << acquisition.oversampling;
+    unsigned int copy = scanSamples;
+    unsigned int i;
+    unsigned int j;
+    unsigned int k;
+    uint32_t sum;
+
+    if (acquisition.oversampling)
+    {
+        //the averages are written before the samples still to be read
+        scans >>= acquisition.oversampling;
+
+        for (i = 0; i < scans; i++)
+        {
+            for (j = 0; j < scanSamples; j++)
+            {
+                sum = 0;
+                for (k = 0; k < group; k++)
+                {
+                    sum += samples[(i * group + k) * scanSamples + j];
+                }
+                samples[i * scanSamples + j] = (uint16_t) (sum >> acquisition.oversampling);
+            }
+        }
+    }
+
+    if (acquisition.ring != NULL)
+    {
+        if (copy > USAMPLERING_PAYLOAD_SIZE / 2)
+        {
+            copy = USAMPLERING_PAYLOAD_SIZE / 2;
+        }
+
+        for (i = 0; i < scans; i++)
+        {
+            sample = uSampleRingReserve(acquisition.ring);
+            sample->sensor = acquisition.sensor;
+            sample->length = (uint8_t) (copy * 2);
+            sample->timestamp = scanCount + i * group;
+
+            for (j = 0; j < copy; j++)
+            {
+                sample->payload.values[j] = (int16_t) samples[i * scanSamples + j];
+            }
+
+            uSampleRingPublish(acquisition.ring);
+        }
+    }
+
+    if (acquisition.callback != NULL)
+    {
+        acquisition.callback(samples, scans);
+    }
+
+    scanCount += acquisition.scans;
+}
+
+/**
+ * Tells the state of the trigger mode.
+ * @return ADC_ACQUISITION_STOPPED out of the trigger mode.
+ */
+tADCAcquisitionTrigger ADCAcquisitionGetTrigger(void)
+{
+    return triggerState;
+}
+
+/**
+ * Ends a capture at the boundary of a half, once the scans after the
+ * trigger are all converted.
+ * @param boundary Next scan written by the DMA, 0 or scans.
+ */
+static void ADCAcquisitionTriggerBoundary(unsigned int boundary)
+{
+    unsigned int total = 2U * acquisition.scans;
+    unsigned int first;
+    unsigned int length;
+    unsigned int part;
+
+    if (triggerState == ADC_ACQUISITION_ARMED)
+    {
+        //the whole buffer holds scans from now on, nothing to do until the
+        //trigger
+        primed = true;
+        DMA_ITConfig(DMA1_Channel1, DMA_IT_HT | DMA_IT_TC, DISABLE);
+        return;
+    }
+
+    if (triggerState != ADC_ACQUISITION_TRIGGERED ||
+        (boundary + total - triggerScan) % total < acquisition.postTrigger)
+    {
+        return;
+    }
+
+    ADCAcquisitionStop();
+    DMA_ITConfig(DMA1_Channel1, DMA_IT_HT | DMA_IT_TC, DISABLE);
+    triggerState = ADC_ACQUISITION_CAPTURED;
+
+    first = (triggerScan + total - triggerPre) % total;
+    length = triggerPre + acquisition.postTrigger;
+    part = total - first;
+
+    if (length <= part)
+    {
+        acquisition.capture(acquisition.buffer + first * scanSamples, length, NULL, 0);
+    }
+    else
+    {
+        acquisition.capture(acquisition.buffer + first * scanSamples, part,
+                            acquisition.buffer, length - part);
+    }
+}
+
+/**
+ * This funtion is intended to be put in ADC1_2_IRQHandler() in the trigger
+ * mode, it places the sample out of the window in the buffer.
+ */
+void ADCAcquisitionWatchdogHandler(void)
+{
+    unsigned int transfers = 2U * acquisition.scans * acquisition.count;
+    unsigned int moved;
+
+    if (ADC_GetITStatus(ADC1, ADC_IT_AWD) == RESET)
+    {
+        return;
+    }
+
+    //one trigger for each start
+    ADC_ITConfig(ADC1, ADC_IT_AWD, DISABLE);
+    ADC_ClearITPendingBit(ADC1, ADC_IT_AWD);
+
+    if (triggerState != ADC_ACQUISITION_ARMED)
+    {
+        return;
+    }
+
+    //the DMA has already moved the sample, it is the last transfer
+    moved = transfers - DMA_GetCurrDataCounter(DMA1_Channel1);
+    triggerScan = ((moved + transfers - 1) % transfers) / acquisition.count;
+
+    //before the first pass only the scans since the start are valid
+    triggerPre = acquisition.preTrigger;
+    if (!primed && triggerPre > triggerScan)
+    {
+        triggerPre = triggerScan;
+    }
+
+    triggerState = ADC_ACQUISITION_TRIGGERED;
+
+    //the halves count the scans after the trigger, the older flags don't
+    DMA_ClearFlag(DMA1_FLAG_HT1 | DMA1_FLAG_TC1);
+    DMA_ITConfig(DMA1_Channel1, DMA_IT_HT | DMA_IT_TC, ENABLE);
+}
+
+/**
+ * This funtion is intended to be put in DMA1_Channel1_IRQHandler(), it
+ * hands over the half of the buffer just filled.
+ */
+void ADCAcquisitionInterruptHandler(void)
+{
+    if (acquisition.trigger)
+    {
+        if (DMA_GetITStatus(DMA1_IT_HT1) != RESET)
+        {
+            DMA_ClearITPendingBit(DMA1_IT_HT1);
+            ADCAcquisitionTriggerBoundary(acquisition.scans);
+        }
+        else if (DMA_GetITStatus(DMA1_IT_TC1) != RESET)
+        {
+            DMA_ClearITPendingBit(DMA1_IT_TC1);
+            ADCAcquisitionTriggerBoundary(0);
+        }
+
+        return;
+    }
+
+    if (DMA_GetITStatus(DMA1_IT_HT1) != RESET)
+    {
+        DMA_ClearITPendingBit(DMA1_IT_HT1);
+
+        //the second half is already full, the first one was filled again
+        if (DMA_GetFlagStatus(DMA1_FLAG_TC1) != RESET)
+        {
+            overruns++;
+        }
+
+        ADCAcquisitionProcess(acquisition.buffer);
+    }
+    else if (DMA_GetITStatus(DMA1_IT_TC1) != RESET)
+    {
+        DMA_ClearITPendingBit(DMA1_IT_TC1);
+
+        ADCAcquisitionProcess(acquisition.buffer + halfSamples);
+    }
+}
@@ -0,0 +1,173 @@
+/**
+ *  @file       ADCAcquisition.h
+ *  @author     Luis Maduro
+ *  @version    1.00
+ *  @date       14/10/2026
+ *  @brief      Continuous ADC acquisition by DMA into a ping-pong buffer.
+ *
+ *  TIM3 triggers a scan of the regular channels of ADC1 at a fixed rate,
+ *  and in dual mode ADC2 converts its own channels at the same time
+ *  (regular simultaneous mode). DMA1 channel 1 moves every conversion into
+ *  a circular buffer of two halves, so the CPU does nothing per sample:
+ *  the half transfer and transfer complete interrupts give each half to the
+ *  application while the DMA fills the other one.
+ *
+ *  A filled half is optionally decimated, the scans are averaged by groups
+ *  of 2^oversampling, in place. It is then given to the callback, and/or
+ *  every scan is published in a sample ring. Without decimation and ring
+ *  the interrupt costs the same for any rate.
+ *
+ *  In single mode a scan is count half-words, the channels in order. In
+ *  dual mode the DMA moves the 32 bit data register of ADC1, so a scan is
+ *  count pairs of half-words, ADC1 then ADC2 of each rank, and the buffer
+ *  must be 4 byte aligned.
+ *
+ *  Each ADC converts in 12.5 + sample time ADC clocks, the shortest sample
+ *  time (1.5) at the 12 MHz ADC clock of a 72 MHz PCLK2 gives 857 kSPS,
+ *  the rate divided by count is the highest scan rate. Dual mode doubles
+ *  the samples per second at the same scan rate.
+ *
+ *  In the trigger mode the halves are not handed over and the CPU is not
+ *  interrupted while the signal stays in its window: the analog watchdog
+ *  of ADC1 compares every conversion of a channel (or of all of them) with
+ *  the thresholds. Once the DMA has filled the whole buffer, the only
+ *  interrupt left is the watchdog's, when a sample leaves the window. That
+ *  trigger is placed in the buffer from the counter of the DMA. The
+ *  interrupts of the halves then run until postTrigger scans are
+ *  converted, the acquisition stops and the capture callback gets the
+ *  preTrigger scans before the trigger and the postTrigger scans from it,
+ *  where they are in the buffer: one span, or two when they wrap around its
+ *  end. The buffer stays as it is until ADCAcquisitionStart() arms the
+ *  next capture, like the single mode of an oscilloscope. oversampling, the
+ *  callback and the ring are not used.
+ *
+ *  Copyright (C) 2026  Luis Maduro
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef ADCACQUISITION_H
+#define ADCACQUISITION_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stm32f10x.h>
+#include "uCFIFO/uSampleRing.h"
+
+/**Most regular channels of a scan, per ADC.*/
+#define ADC_ACQUISITION_MAX_CHANNELS    16
+
+/**watchdogChannel to watch all the regular channels of ADC1.*/
+#define ADC_ACQUISITION_ALL_CHANNELS    0xFF
+
+/**Priority of the DMA1 channel 1 interrupt, and of the ADC1_2 interrupt in
+ the trigger mode.*/
+#ifndef ADC_ACQUISITION_IRQ_PRIORITY
+#define ADC_ACQUISITION_IRQ_PRIORITY    1
+#endif
+
+/**
+ * Called from the interrupt with a half of the buffer, after the
+ * decimation. The DMA fills the other half meanwhile, the samples must be
+ * used or copied before it is filled again.
+ * @param samples First sample of the first scan.
+ * @param scans Number of scans.
+ */
+typedef void (*tADCAcquisitionCallback)(const uint16_t *samples, unsigned int scans);
+
+/**
+ * Called from the interrupt with a capture of the trigger mode, the oldest
+ * scan first. The acquisition is stopped, the samples stay in the buffer
+ * until it is started again.
+ * @param samples First scan.
+ * @param scans Number of scans from it.
+ * @param wrapped Scans that follow from the start of the buffer, NULL if the
+ *                capture doesn't wrap.
+ * @param wrappedScans Number of scans from wrapped.
+ */
+typedef void (*tADCAcquisitionCaptureCallback)(const uint16_t *samples, unsigned int scans,
+                                               const uint16_t *wrapped, unsigned int wrappedScans);
+
+/**
+ * State of the trigger mode.
+ */
+typedef enum
+{
+    ADC_ACQUISITION_STOPPED,
+    /**Waiting for a sample out of the window.*/
+    ADC_ACQUISITION_ARMED,
+    /**Converting the scans after the trigger.*/
+    ADC_ACQUISITION_TRIGGERED,
+    /**Stopped with a capture in the buffer.*/
+    ADC_ACQUISITION_CAPTURED
+} tADCAcquisitionTrigger;
+
+/**
+ * Configuration of an acquisition.
+ */
+typedef struct
+{
+    /**Channels of ADC1, ADC_Channel_0 to ADC_Channel_17, in scan order.*/
+    uint8_t channels[ADC_ACQUISITION_MAX_CHANNELS];
+    /**Channels of ADC2 in dual mode, converted with the same ranks.*/
+    uint8_t channels2[ADC_ACQUISITION_MAX_CHANNELS];
+    /**Number of channels of a scan, 1 to ADC_ACQUISITION_MAX_CHANNELS.*/
+    uint8_t count;
+    /**Not 0 for ADC1 and ADC2 in regular simultaneous mode.*/
+    uint8_t dual;
+    /**ADC_SampleTime_1Cycles5 to ADC_SampleTime_239Cycles5.*/
+    uint8_t sampleTime;
+    /**Scans averaged into one are 2^oversampling, 0 for none.*/
+    uint8_t oversampling;
+    /**Scans per second.*/
+    uint32_t rate;
+    /**Buffer of the two halves, 2 * scans samples (4 * scans in dual mode)
+     per channel.*/
+    uint16_t *buffer;
+    /**Scans of a half, a multiple of 2^oversampling. The DMA counts up to
+     65535 transfers for the whole buffer.*/
+    uint16_t scans;
+    /**Called with every half, can be NULL.*/
+    tADCAcquisitionCallback callback;
+    /**Ring receiving every scan, can be NULL. A scan of more than
+     USAMPLERING_PAYLOAD_SIZE / 2 samples is cut.*/
+    tSampleRing *ring;
+    /**Sensor of the samples in the ring, e.g. USAMPLERING_SENSOR_ADC.*/
+    uint8_t sensor;
+    /**Not 0 for the trigger mode.*/
+    uint8_t trigger;
+    /**Channel of ADC1 watched, or ADC_ACQUISITION_ALL_CHANNELS.*/
+    uint8_t watchdogChannel;
+    /**Window of the samples, 0 to 4095, a sample below watchdogLow or above
+     watchdogHigh is the trigger.*/
+    uint16_t watchdogLow;
+    uint16_t watchdogHigh;
+    /**Scans captured before the trigger, and from it (at least 1). The two
+     are scans at most.*/
+    uint16_t preTrigger;
+    uint16_t postTrigger;
+    /**Called with the capture.*/
+    tADCAcquisitionCaptureCallback capture;
+} tADCAcquisitionConfig;
+
+bool ADCAcquisitionInit(const tADCAcquisitionConfig *config);
+void ADCAcquisitionStart(void);
+void ADCAcquisitionStop(void);
+unsigned long ADCAcquisitionGetScans(void);
+unsigned int ADCAcquisitionGetOverruns(void);
+void ADCAcquisitionInterruptHandler(void);
+tADCAcquisitionTrigger ADCAcquisitionGetTrigger(void);
+void ADCAcquisitionWatchdogHandler(void);
+
+#endif /* ADCACQUISITION_H */
@@ -0,0 +1,19 @@
+/**
+ *  @file       BenchmarkConfig.h
+ *  @author     Luis Maduro
+ *  @version    1.00
+ *  @date       14/10/2026
+ *  @brief      Workloads of the driver benchmark on the STM32F1 board.
+ */
+
+#ifndef BENCHMARKCONFIG_H
+#define BENCHMARKCONFIG_H
+
+#define BENCHMARK_PLATFORM          "stm32f1"
+
+#define BENCHMARK_I2C
+#define BENCHMARK_SD
+#define BENCHMARK_FLASH
+#define BENCHMARK_MRF24J
+
+#endif /* BENCHMARKCONFIG_H */
@@ -0,0 +1,134 @@
+/**
+ *  @file       main.c
+ *  @author     Luis Maduro
+ *  @version    1.00
+ *  @date       14/10/2026
+ *  @brief      Driver benchmark of the STM32F1, the results on USART1.
+ *
+ *  Runs DriverBenchmarkRun() once after the reset, the lines go out on
+ *  USART1 (PA9 TX) at 115200 baud, the time is the DWT cycle counter. The
+ *  board has the MPU9150 on I2C1, the SD card and the SST25VF064C on SPI1
+ *  and the MRF24J40 on SPI1, remove the defines of the parts not fitted
+ *  from BenchmarkConfig.h. Built with the drivers of the root and Common:
+ *  @code
+ *  STM32F1/Benchmark/main.c Common/Benchmark/DriverBenchmark.c
+ *  STM32F1/I2CDevice.c STM32F1/SPIDevice.c Common/SDCardRaw.c
+ *  Common/SST25VF064C.c Common/MRF24J.c Common/uCFIFO/uFIFO.c
+ *  @endcode
+ *  with STM32F1, Common and STM32F1/Benchmark in the include paths. Collect
+ *  the output on the host, i.e. with "cat /dev/ttyUSB0 > stm32f1.csv".
+ *
+ *  Copyright (C) 2026  Luis Maduro
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <stm32f10x.h>
+#include "BenchmarkConfig.h"
+#include "I2CDevice.h"
+#include "SPIDevice.h"
+#ifdef BENCHMARK_MRF24J
+#include "MRF24J.h"
+#endif
+#include "Benchmark/DriverBenchmark.h"
+
+#define BENCHMARK_BAUDRATE          115200
+
+/**Cycles of the DWT per microsecond, and the counts extended to 64 bits.*/
+static uint32_t cyclesPerUs;
+static uint32_t lastCycles;
+static uint64_t totalCycles;
+
+/**
+ * Microseconds since BenchmarkInit(), it has to be called at least once per
+ * wrap of the cycle counter, 59 s at 72 MHz, every workload does.
+ */
+uint32_t BenchmarkMicros(void)
+{
+    uint32_t now = DWT->CYCCNT;
+
+    totalCycles += now - lastCycles;
+    lastCycles = now;
+
+    return (uint32_t) (totalCycles / cyclesPerUs);
+}
+
+/**
+ * Writes a line on USART1, waiting for every byte.
+ */
+void BenchmarkPrint(const char *line)
+{
+    while (*line != '\0')
+    {
+        while (USART_GetFlagStatus(USART1, USART_FLAG_TXE) == RESET);
+        USART_SendData(USART1, *line++);
+    }
+
+    while (USART_GetFlagStatus(USART1, USART_FLAG_TXE) == RESET);
+    USART_SendData(USART1, '\r');
+    while (USART_GetFlagStatus(USART1, USART_FLAG_TXE) == RESET);
+    USART_SendData(USART1, '\n');
+    while (USART_GetFlagStatus(USART1, USART_FLAG_TC) == RESET);
+}
+
+static void BenchmarkInit(void)
+{
+    GPIO_InitTypeDef GPIO_InitStructure;
+    USART_InitTypeDef USART_InitStructure;
+    RCC_ClocksTypeDef RCC_ClocksStatus;
+
+    RCC_APB2PeriphClockCmd(RCC_APB2Periph_GPIOA | RCC_APB2Periph_USART1, ENABLE);
+
+    GPIO_InitStructure.GPIO_Pin = GPIO_Pin_9;
+    GPIO_InitStructure.GPIO_Speed = GPIO_Speed_50MHz;
+    GPIO_InitStructure.GPIO_Mode = GPIO_Mode_AF_PP;
+    GPIO_Init(GPIOA, &GPIO_InitStructure);
+
+    GPIO_InitStructure.GPIO_Pin = GPIO_Pin_10;
+    GPIO_InitStructure.GPIO_Mode = GPIO_Mode_IN_FLOATING;
+    GPIO_Init(GPIOA, &GPIO_InitStructure);
+
+    USART_InitStructure.USART_BaudRate = BENCHMARK_BAUDRATE;
+    USART_InitStructure.USART_WordLength = USART_WordLength_8b;
+    USART_InitStructure.USART_StopBits = USART_StopBits_1;
+    USART_InitStructure.USART_Parity = USART_Parity_No;
+    USART_InitStructure.USART_HardwareFlowControl = USART_HardwareFlowControl_None;
+    USART_InitStructure.USART_Mode = USART_Mode_Tx;
+    USART_Init(USART1, &USART_InitStructure);
+    USART_Cmd(USART1, ENABLE);
+
+    RCC_GetClocksFreq(&RCC_ClocksStatus);
+    cyclesPerUs = RCC_ClocksStatus.HCLK_Frequency / 1000000UL;
+
+    CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+    DWT->CYCCNT = 0;
+    DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+    lastCycles = 0;
+    totalCycles = 0;
+}
+
+int main(void)
+{
+    BenchmarkInit();
+
+    I2CInit();
+    SPIInit();
+#ifdef BENCHMARK_MRF24J
+    MRF24J40Init(11, 0, 0x1234, 0x0001);
+#endif
+
+    DriverBenchmarkRun();
+
+    while (1);
+}
@@ -0,0 +1,139 @@
+/**
+ *  @file       BitBand.h
+ *  @author     Luis Maduro
+ *  @version    1.00
+ *  @date       14/10/2026
+ *  @brief      Atomic flags and bitmaps in the bit-band regions of the
+ *              Cortex-M3.
+ *
+ *  Every bit of the first MB of the SRAM (0x20000000) and of the
+ *  peripherals (0x40000000) has a word of its own in the alias regions
+ *  (0x22000000 and 0x42000000): a write of 0 or 1 to that word clears or
+ *  sets the bit, in a single bus cycle that an interrupt can not split, and
+ *  a read gives the bit. A flag set from an interrupt and cleared by a task
+ *  needs no critical section, where |= and &= read, modify and write.
+ *
+ *  The bits are numbered from the address given, any size of variable: the
+ *  bit 9 of a uint8_t array is the bit 1 of its second byte, a bitmap is a
+ *  uint32_t array of any length. The variable must be in the internal
+ *  SRAM, not in the CCM or the FSMC, nor in the flash.
+ *
+ *  The ports of the schedulers use them with, i.e. for uKernel:
+ *  #define UKERNEL_SET_BIT(variable, bit)      BITBAND_SET_BIT(variable, bit)
+ *  #define UKERNEL_CLEAR_BIT(variable, bit)    BITBAND_CLEAR_BIT(variable, bit)
+ *
+ *  Copyright (C) 2026  Luis Maduro
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef BITBAND_H
+#define BITBAND_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stm32f10x.h>
+
+/**
+ * Word of the alias region for a bit of the SRAM or of the peripherals.
+ * Constant when the address is, for the registers.
+ */
+#define BITBAND_ALIAS(address, bit) ((volatile uint32_t *) ((((uint32_t) (address)) & 0xF0000000UL) + 0x02000000UL \
+                                    + ((((uint32_t) (address)) & 0x000FFFFFUL) << 5) + ((uint32_t) (bit) << 2)))
+
+/**Tells if the address is in a bit-band region.*/
+#define BITBAND_IS_ADDRESS(address) (((((uint32_t) (address)) & 0xFFF00000UL) == 0x20000000UL) \
+                                    || ((((uint32_t) (address)) & 0xFFF00000UL) == 0x40000000UL))
+
+#define BITBAND_SET_BIT(variable, bit)      (*BITBAND_ALIAS(&(variable), bit) = 1)
+#define BITBAND_CLEAR_BIT(variable, bit)    (*BITBAND_ALIAS(&(variable), bit) = 0)
+#define BITBAND_READ_BIT(variable, bit)     (*BITBAND_ALIAS(&(variable), bit))
+
+/**
+ * Sets a bit of a bitmap.
+ * @param bitmap First word.
+ * @param bit Number of the bit from the first word.
+ */
+static inline void BitBandSet(volatile void *bitmap, uint32_t bit)
+{
+    *BITBAND_ALIAS(bitmap, bit) = 1;
+}
+
+/**
+ * Clears a bit of a bitmap.
+ * @param bitmap First word.
+ * @param bit Number of the bit from the first word.
+ */
+static inline void BitBandClear(volatile void *bitmap, uint32_t bit)
+{
+    *BITBAND_ALIAS(bitmap, bit) = 0;
+}
+
+/**
+ * Writes a bit of a bitmap.
+ * @param bitmap First word.
+ * @param bit Number of the bit from the first word.
+ * @param value Value of the bit.
+ */
+static inline void BitBandWrite(volatile void *bitmap, uint32_t bit, bool value)
+{
+    *BITBAND_ALIAS(bitmap, bit) = value;
+}
+
+/**
+ * Reads a bit of a bitmap.
+ * @param bitmap First word.
+ * @param bit Number of the bit from the first word.
+ * @return Value of the bit.
+ */
+static inline bool BitBandTest(volatile void *bitmap, uint32_t bit)
+{
+    return *BITBAND_ALIAS(bitmap, bit) != 0;
+}
+
+/**
+ * Sets the bits of a mask one by one, each of them atomically, for a set of
+ * flags given as a mask.
+ * @param word Word of the flags.
+ * @param mask Bits to set.
+ */
+static inline void BitBandSetMask(volatile uint32_t *word, uint32_t mask)
+{
+    volatile uint32_t *alias = BITBAND_ALIAS(word, 0);
+
+    while (mask != 0)
+    {
+        //the lowest bit set, trailing zeros by CLZ of the reversed mask
+        alias[__CLZ(__RBIT(mask))] = 1;
+        mask &= mask - 1;
+    }
+}
+
+/**
+ * Clears the bits of a mask one by one, each of them atomically.
+ * @param word Word of the flags.
+ * @param mask Bits to clear.
+ */
+static inline void BitBandClearMask(volatile uint32_t *word, uint32_t mask)
+{
+    volatile uint32_t *alias = BITBAND_ALIAS(word, 0);
+
+    while (mask != 0)
+    {
+        alias[__CLZ(__RBIT(mask))] = 0;
+        mask &= mask - 1;
+    }
+}
+
+#endif /* BITBAND_H */
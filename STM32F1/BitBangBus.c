@@ -0,0 +1,500 @@
+/**
+ *  @file       BitBangBus.c
+ *  @author     Luis Maduro
+ *  @version    1.00
+ *  @date       14/10/2026
+ *  @brief      Software buses played by DMA from precomputed BSRR words.
+ *
+ *  Copyright (C) 2026  Luis Maduro
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <stddef.h>
+#include "BitBangBus.h"
+#include "PowerManager.h"
+#include "DMAManager.h"
+
+#if BIT_BANG_TIMER == 1
+#define BB_TIMER                    TIM1
+#define BB_TIMER_RCC                RCC_APB2Periph_TIM1
+#define BB_DMA_RCC                  RCC_AHBPeriph_DMA1
+#define BB_WORD_CHANNEL             DMA1_Channel5
+#define BB_WORD_REQUEST             DMA_REQUEST_TIM1_UP
+#define BB_WORD_FLAGS               DMA1_FLAG_GL5
+#define BB_WORD_IT_TC               DMA1_IT_TC5
+#define BB_WORD_IRQ                 DMA1_Channel5_IRQn
+#define BB_SAMPLE_CHANNEL           DMA1_Channel2
+#define BB_SAMPLE_REQUEST           DMA_REQUEST_TIM1_CH1
+#define BB_SAMPLE_FLAGS             DMA1_FLAG_GL2
+#define BB_SAMPLE_IT_TC             DMA1_IT_TC2
+#define BB_SAMPLE_IRQ               DMA1_Channel2_IRQn
+#elif BIT_BANG_TIMER == 8
+#define BB_TIMER                    TIM8
+#define BB_TIMER_RCC                RCC_APB2Periph_TIM8
+#define BB_DMA_RCC                  RCC_AHBPeriph_DMA2
+#define BB_WORD_CHANNEL             DMA2_Channel1
+#define BB_WORD_REQUEST             DMA_REQUEST_TIM8_UP
+#define BB_WORD_FLAGS               DMA2_FLAG_GL1
+#define BB_WORD_IT_TC               DMA2_IT_TC1
+#define BB_WORD_IRQ                 DMA2_Channel1_IRQn
+#define BB_SAMPLE_CHANNEL           DMA2_Channel3
+#define BB_SAMPLE_REQUEST           DMA_REQUEST_TIM8_CH1
+#define BB_SAMPLE_FLAGS             DMA2_FLAG_GL3
+#define BB_SAMPLE_IT_TC             DMA2_IT_TC3
+#define BB_SAMPLE_IRQ               DMA2_Channel3_IRQn
+#else
+#error "BIT_BANG_TIMER must be 1 or 8"
+#endif
+
+/**Ticks of the 1-Wire frames, at BIT_BANG_ONE_WIRE_FREQUENCY.*/
+#define ONE_WIRE_RESET_TICKS        96
+#define ONE_WIRE_PRESENCE_TICK      (ONE_WIRE_RESET_TICKS + 14)
+#define ONE_WIRE_SLOT_TICKS         13
+#define ONE_WIRE_SAMPLE_TICK        2
+
+#ifdef USE_DMA_MANAGER
+/**The two channels, taken for each frame, the lower one first.*/
+static tDMAManagerUser dmaWord = {BB_WORD_REQUEST, 0, NULL, BitBangInterruptHandler, NULL};
+static tDMAManagerUser dmaSample = {BB_SAMPLE_REQUEST, 0, NULL, BitBangInterruptHandler, NULL};
+#if BB_WORD_REQUEST < BB_SAMPLE_REQUEST
+#define BB_DMA_FIRST                dmaWord
+#define BB_DMA_SECOND               dmaSample
+#else
+#define BB_DMA_FIRST                dmaSample
+#define BB_DMA_SECOND               dmaWord
+#endif
+#endif
+
+static volatile bool busy = false;
+static bool initialised = false;
+/**Interrupt of the channel ending the frame running.*/
+static uint32_t lastTransfer;
+static tBitBangDone frameDone;
+
+/**
+ * Clock of the GPIO port, the ports are 0x400 apart as their enable bits,
+ * from GPIOA.
+ */
+static void BitBangPortClock(GPIO_TypeDef *port)
+{
+    RCC_APB2PeriphClockCmd(RCC_APB2Periph_GPIOA << (((uint32_t) port - GPIOA_BASE) / 0x400), ENABLE);
+}
+
+/**
+ * Sets up the timer of the engine, once or between two frames.
+ * @param frequency Words a second.
+ * @return Frequency set, the nearest below, 0 if it is too high or a frame
+ * is running.
+ */
+uint32_t BitBangInit(uint32_t frequency)
+{
+    TIM_TimeBaseInitTypeDef TIM_TimeBaseStructure;
+    TIM_OCInitTypeDef TIM_OCInitStructure;
+    NVIC_InitTypeDef NVIC_InitStructure;
+    RCC_ClocksTypeDef clocks;
+    uint32_t clock;
+    uint32_t ticks;
+    uint16_t prescaler;
+
+    if (busy || frequency == 0)
+    {
+        return 0;
+    }
+
+    //the timers of APB2 run at twice PCLK2 when APB2 is divided
+    RCC_GetClocksFreq(&clocks);
+    clock = clocks.PCLK2_Frequency;
+    if (RCC->CFGR & RCC_CFGR_PPRE2_2)
+    {
+        clock *= 2;
+    }
+
+    ticks = clock / frequency;
+    if ((ticks < BIT_BANG_MIN_TICKS) || (ticks > 0xFFFF0000UL))
+    {
+        return 0;
+    }
+    prescaler = (uint16_t) ((ticks - 1) / 0xFFFF);
+    ticks /= prescaler + 1;
+
+    RCC_AHBPeriphClockCmd(BB_DMA_RCC, ENABLE);
+    RCC_APB2PeriphClockCmd(BB_TIMER_RCC, ENABLE);
+
+    TIM_DeInit(BB_TIMER);
+    TIM_TimeBaseStructInit(&TIM_TimeBaseStructure);
+    TIM_TimeBaseStructure.TIM_Prescaler = prescaler;
+    TIM_TimeBaseStructure.TIM_Period = (uint16_t) (ticks - 1);
+    TIM_TimeBaseInit(BB_TIMER, &TIM_TimeBaseStructure);
+
+    //the samples half a tick after the words, no output
+    TIM_OCStructInit(&TIM_OCInitStructure);
+    TIM_OCInitStructure.TIM_OCMode = TIM_OCMode_Timing;
+    TIM_OCInitStructure.TIM_Pulse = (uint16_t) (ticks / 2);
+    TIM_OC1Init(BB_TIMER, &TIM_OCInitStructure);
+
+    if (!initialised)
+    {
+        initialised = true;
+
+        NVIC_InitStructure.NVIC_IRQChannelPreemptionPriority = BIT_BANG_IRQ_PRIORITY;
+        NVIC_InitStructure.NVIC_IRQChannelSubPriority = 0;
+        NVIC_InitStructure.NVIC_IRQChannelCmd = ENABLE;
+        NVIC_InitStructure.NVIC_IRQChannel = BB_WORD_IRQ;
+        NVIC_Init(&NVIC_InitStructure);
+        NVIC_InitStructure.NVIC_IRQChannel = BB_SAMPLE_IRQ;
+        NVIC_Init(&NVIC_InitStructure);
+    }
+
+    return clock / ((prescaler + 1) * ticks);
+}
+
+/**
+ * Sets up a channel for a frame.
+ */
+static void BitBangChannel(DMA_Channel_TypeDef *channel, uint32_t peripheral,
+                           uint32_t memory, uint16_t count, bool write)
+{
+    DMA_InitTypeDef DMA_InitStructure;
+
+    DMA_DeInit(channel);
+    DMA_InitStructure.DMA_PeripheralBaseAddr = peripheral;
+    DMA_InitStructure.DMA_MemoryBaseAddr = memory;
+    DMA_InitStructure.DMA_DIR = write ? DMA_DIR_PeripheralDST : DMA_DIR_PeripheralSRC;
+    DMA_InitStructure.DMA_BufferSize = count;
+    DMA_InitStructure.DMA_PeripheralInc = DMA_PeripheralInc_Disable;
+    DMA_InitStructure.DMA_MemoryInc = DMA_MemoryInc_Enable;
+    DMA_InitStructure.DMA_PeripheralDataSize = write ? DMA_PeripheralDataSize_Word : DMA_PeripheralDataSize_HalfWord;
+    DMA_InitStructure.DMA_MemoryDataSize = write ? DMA_MemoryDataSize_Word : DMA_MemoryDataSize_HalfWord;
+    DMA_InitStructure.DMA_Mode = DMA_Mode_Normal;
+    DMA_InitStructure.DMA_Priority = DMA_Priority_VeryHigh;
+    DMA_InitStructure.DMA_M2M = DMA_M2M_Disable;
+    DMA_Init(channel, &DMA_InitStructure);
+}
+
+/**
+ * Plays a frame, the first word at once and the next ones at each tick.
+ * @param port Port of the bus.
+ * @param words BSRR words, they must stay until the end of the frame.
+ * @param samples Levels of the port, one per word, NULL if the frame reads
+ * nothing.
+ * @param count Words.
+ * @param done Called at the end of the frame, can be NULL.
+ * @return False if a frame is running, if the engine is not initialised or,
+ * with USE_DMA_MANAGER, if the channels are busy.
+ */
+bool BitBangStart(GPIO_TypeDef *port, const uint32_t *words, uint16_t *samples,
+                  uint16_t count, tBitBangDone done)
+{
+    uint16_t requests = TIM_DMA_Update;
+
+    if (busy || !initialised || words == NULL || count == 0)
+    {
+        return false;
+    }
+
+#ifdef USE_DMA_MANAGER
+    if (!DMAManagerTryAcquire(&BB_DMA_FIRST) || !DMAManagerTryAcquire(&BB_DMA_SECOND))
+    {
+        DMAManagerRelease(&BB_DMA_FIRST);
+        return false;
+    }
+#endif
+
+    busy = true;
+    frameDone = done;
+
+#ifdef USE_POWER_MANAGER
+    PowerManagerKeepAwake(POWER_MODE_STOP);
+#endif
+
+    BitBangChannel(BB_WORD_CHANNEL, (uint32_t) &port->BSRR, (uint32_t) words, count, true);
+    DMA_ClearFlag(BB_WORD_FLAGS);
+
+    //the last sample is taken half a tick after the last word
+    if (samples != NULL)
+    {
+        BitBangChannel(BB_SAMPLE_CHANNEL, (uint32_t) &port->IDR, (uint32_t) samples, count, false);
+        DMA_ClearFlag(BB_SAMPLE_FLAGS);
+        DMA_ITConfig(BB_SAMPLE_CHANNEL, DMA_IT_TC, ENABLE);
+        DMA_Cmd(BB_SAMPLE_CHANNEL, ENABLE);
+        lastTransfer = BB_SAMPLE_IT_TC;
+        requests |= TIM_DMA_CC1;
+    }
+    else
+    {
+        DMA_ITConfig(BB_WORD_CHANNEL, DMA_IT_TC, ENABLE);
+        lastTransfer = BB_WORD_IT_TC;
+    }
+
+    DMA_Cmd(BB_WORD_CHANNEL, ENABLE);
+
+    //the update generated writes the first word and clears the counter
+    TIM_DMACmd(BB_TIMER, requests, ENABLE);
+    TIM_GenerateEvent(BB_TIMER, TIM_EventSource_Update);
+    TIM_Cmd(BB_TIMER, ENABLE);
+
+    return true;
+}
+
+/**
+ * Tells if a frame is running.
+ * @return True until the end of the frame, before its done callback.
+ */
+bool BitBangIsBusy(void)
+{
+    return busy;
+}
+
+/**
+ * This funtion is intended to be put in the interrupts of the two DMA
+ * channels, DMA1_Channel2_IRQHandler() and DMA1_Channel5_IRQHandler() for
+ * TIM1, DMA2_Channel1_IRQHandler() and DMA2_Channel3_IRQHandler() for TIM8,
+ * it ends the frame.
+ */
+void BitBangInterruptHandler(void)
+{
+    if (!busy || DMA_GetITStatus(lastTransfer) == RESET)
+    {
+        return;
+    }
+
+    TIM_Cmd(BB_TIMER, DISABLE);
+    //a request left pending would move a word early in the next frame
+    TIM_DMACmd(BB_TIMER, TIM_DMA_Update | TIM_DMA_CC1, DISABLE);
+
+    DMA_Cmd(BB_WORD_CHANNEL, DISABLE);
+    DMA_Cmd(BB_SAMPLE_CHANNEL, DISABLE);
+    DMA_ITConfig(BB_WORD_CHANNEL, DMA_IT_TC, DISABLE);
+    DMA_ITConfig(BB_SAMPLE_CHANNEL, DMA_IT_TC, DISABLE);
+    DMA_ClearFlag(BB_WORD_FLAGS);
+    DMA_ClearFlag(BB_SAMPLE_FLAGS);
+
+#ifdef USE_DMA_MANAGER
+    DMAManagerRelease(&BB_DMA_SECOND);
+    DMAManagerRelease(&BB_DMA_FIRST);
+#endif
+
+#ifdef USE_POWER_MANAGER
+    PowerManagerAllow(POWER_MODE_STOP);
+#endif
+
+    //the callback can start the next frame
+    busy = false;
+
+    if (frameDone != NULL)
+    {
+        frameDone();
+    }
+}
+
+/**
+ * Configures the pins of a SPI bus, the clock at its idle level and the
+ * chip select high.
+ * @param bus Bus.
+ */
+void BitBangSPIInit(const tBitBangSPI *bus)
+{
+    GPIO_InitTypeDef GPIO_InitStructure;
+
+    BitBangPortClock(bus->port);
+
+    bus->port->BSRR = BIT_BANG_SET(bus->cs) | BIT_BANG_LEVEL(bus->sck, bus->mode & 2);
+
+    GPIO_InitStructure.GPIO_Pin = bus->cs | bus->sck | bus->mosi;
+    GPIO_InitStructure.GPIO_Mode = GPIO_Mode_Out_PP;
+    GPIO_InitStructure.GPIO_Speed = GPIO_Speed_50MHz;
+    GPIO_Init(bus->port, &GPIO_InitStructure);
+
+    GPIO_InitStructure.GPIO_Pin = bus->miso;
+    GPIO_InitStructure.GPIO_Mode = GPIO_Mode_IN_FLOATING;
+    GPIO_Init(bus->port, &GPIO_InitStructure);
+}
+
+/**
+ * Builds the frame of a SPI transfer: the chip select goes low, two words
+ * a bit, MSB first, then the chip select goes high.
+ * @param bus Bus.
+ * @param words Frame, BIT_BANG_SPI_WORDS(length) words.
+ * @param data Bytes sent, NULL to send 0xFF.
+ * @param length Bytes.
+ * @return Words of the frame.
+ */
+uint16_t BitBangSPIEncode(const tBitBangSPI *bus, uint32_t *words,
+                          const uint8_t *data, uint16_t length)
+{
+    bool idle = (bus->mode & 2) != 0;
+    //the level of the clock while the data is set, the edge after it samples
+    uint32_t setup = BIT_BANG_LEVEL(bus->sck, idle != ((bus->mode & 1) != 0));
+    uint32_t sample = BIT_BANG_LEVEL(bus->sck, idle == ((bus->mode & 1) != 0));
+    uint32_t *word = words;
+    uint16_t i;
+    uint8_t byte;
+    uint8_t mask;
+
+    *word++ = BIT_BANG_RESET(bus->cs) | BIT_BANG_LEVEL(bus->sck, idle);
+
+    for (i = 0; i < length; i++)
+    {
+        byte = (data != NULL) ? data[i] : 0xFF;
+
+        for (mask = 0x80; mask != 0; mask >>= 1)
+        {
+            *word++ = setup | BIT_BANG_LEVEL(bus->mosi, byte & mask);
+            *word++ = sample;
+        }
+    }
+
+    *word++ = BIT_BANG_SET(bus->cs) | BIT_BANG_LEVEL(bus->sck, idle);
+
+    return (uint16_t) (word - words);
+}
+
+/**
+ * Takes the bytes received out of the samples of a SPI frame.
+ * @param bus Bus.
+ * @param samples Samples of the frame.
+ * @param data Bytes received.
+ * @param length Bytes.
+ */
+void BitBangSPIDecode(const tBitBangSPI *bus, const uint16_t *samples,
+                      uint8_t *data, uint16_t length)
+{
+    //the second word of each bit, half a tick after the sampling edge
+    const uint16_t *sample = samples + 2;
+    uint16_t i;
+    uint8_t byte;
+    uint8_t bit;
+
+    for (i = 0; i < length; i++)
+    {
+        byte = 0;
+
+        for (bit = 0; bit < 8; bit++)
+        {
+            byte = (uint8_t) ((byte << 1) | ((*sample & bus->miso) != 0));
+            sample += 2;
+        }
+
+        data[i] = byte;
+    }
+}
+
+/**
+ * Configures the pin of a 1-Wire bus, open drain and released.
+ * @param port Port.
+ * @param pin Pin, with a pull-up to the supply of the slaves.
+ */
+void BitBangOneWireInit(GPIO_TypeDef *port, uint16_t pin)
+{
+    GPIO_InitTypeDef GPIO_InitStructure;
+
+    BitBangPortClock(port);
+
+    port->BSRR = BIT_BANG_SET(pin);
+
+    GPIO_InitStructure.GPIO_Pin = pin;
+    GPIO_InitStructure.GPIO_Mode = GPIO_Mode_Out_OD;
+    GPIO_InitStructure.GPIO_Speed = GPIO_Speed_2MHz;
+    GPIO_Init(port, &GPIO_InitStructure);
+}
+
+/**
+ * Builds the frame of 1-Wire bytes, LSB first, with the engine at
+ * BIT_BANG_ONE_WIRE_FREQUENCY. A slot is 65 us: low for 5 us for a 1 or a
+ * read, sampled at 12.5 us, low for 60 us for a 0.
+ * @param pin Pin.
+ * @param words Frame, BIT_BANG_ONE_WIRE_WORDS(reset, length) words.
+ * @param reset Begins with a reset, 480 us low and 480 us released for the
+ * presence pulse.
+ * @param data Bytes sent, 0xFF to read a byte.
+ * @param length Bytes, can be 0 for a reset alone.
+ * @return Words of the frame.
+ */
+uint16_t BitBangOneWireEncode(uint16_t pin, uint32_t *words, bool reset,
+                              const uint8_t *data, uint16_t length)
+{
+    uint32_t *word = words;
+    uint16_t i;
+    uint8_t mask;
+    uint8_t tick;
+
+    //the words of 0 change nothing, they hold the levels for a tick
+    if (reset)
+    {
+        for (tick = 0; tick < 2 * ONE_WIRE_RESET_TICKS; tick++)
+        {
+            word[tick] = 0;
+        }
+        word[0] = BIT_BANG_RESET(pin);
+        word[ONE_WIRE_RESET_TICKS] = BIT_BANG_SET(pin);
+        word += 2 * ONE_WIRE_RESET_TICKS;
+    }
+
+    for (i = 0; i < length; i++)
+    {
+        for (mask = 0x01; mask != 0; mask <<= 1)
+        {
+            for (tick = 0; tick < ONE_WIRE_SLOT_TICKS; tick++)
+            {
+                word[tick] = 0;
+            }
+            word[0] = BIT_BANG_RESET(pin);
+            word[(data[i] & mask) ? 1 : ONE_WIRE_SLOT_TICKS - 1] = BIT_BANG_SET(pin);
+            word += ONE_WIRE_SLOT_TICKS;
+        }
+    }
+
+    return (uint16_t) (word - words);
+}
+
+/**
+ * Takes the bits of the bus out of the samples of a 1-Wire frame, the
+ * bytes read and the echo of the ones written.
+ * @param pin Pin.
+ * @param samples Samples of the frame.
+ * @param reset The frame begins with a reset.
+ * @param data Bytes of the bus.
+ * @param length Bytes.
+ * @return False if no slave answered the reset.
+ */
+bool BitBangOneWireDecode(uint16_t pin, const uint16_t *samples, bool reset,
+                          uint8_t *data, uint16_t length)
+{
+    bool presence = true;
+    uint16_t i;
+    uint8_t mask;
+
+    if (reset)
+    {
+        presence = (samples[ONE_WIRE_PRESENCE_TICK] & pin) == 0;
+        samples += 2 * ONE_WIRE_RESET_TICKS;
+    }
+
+    for (i = 0; i < length; i++)
+    {
+        data[i] = 0;
+
+        for (mask = 0x01; mask != 0; mask <<= 1)
+        {
+            if (samples[ONE_WIRE_SAMPLE_TICK] & pin)
+            {
+                data[i] |= mask;
+            }
+            samples += ONE_WIRE_SLOT_TICKS;
+        }
+    }
+
+    return presence;
+}
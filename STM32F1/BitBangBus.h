@@ -0,0 +1,141 @@
+/**
+ *  @file       BitBangBus.h
+ *  @author     Luis Maduro
+ *  @version    1.00
+ *  @date       14/10/2026
+ *  @brief      Software buses played by DMA from precomputed BSRR words.
+ *
+ *  A software bus written with GPIO_SetBits() and GPIO_ResetBits() calls a
+ *  function for each edge, its timing moves with the interrupts and the CPU
+ *  does nothing else meanwhile. Here a whole frame is computed first as
+ *  words of the BSRR of the port, the bits to set in the low half-word and
+ *  the bits to reset in the high one, so one write changes all the pins of
+ *  the bus at once without read-modify-write. The update event of the timer
+ *  then moves one word per tick to GPIOx->BSRR by DMA: the edges are on the
+ *  ticks of the timer, whatever the CPU does.
+ *
+ *  The frames that read the bus give a buffer of samples: the compare event
+ *  of channel 1, half a tick after each word, moves GPIOx->IDR to it by a
+ *  second DMA channel, one sample per word. The sample of a word is the
+ *  level of the pins half a tick after it.
+ *
+ *  Two encoders build the frames:
+ *  - SPI master in the four modes, MSB first, two words a bit, so the clock
+ *    is half the frequency of the engine. BitBangSPIDecode() takes the
+ *    received bytes out of the samples;
+ *  - 1-Wire, on an open drain pin with its pull-up, with the engine at
+ *    BIT_BANG_ONE_WIRE_FREQUENCY. A byte of 0xFF is read slots, the bits of
+ *    the slave are given by BitBangOneWireDecode().
+ *  The engine runs one frame at a time, at the frequency of the last
+ *  BitBangInit(), which can be called again between the frames of buses of
+ *  different speeds.
+ *  @code
+ *  static const tBitBangSPI sensor = {GPIOB, GPIO_Pin_12, GPIO_Pin_13, GPIO_Pin_14, GPIO_Pin_15, 0};
+ *  static uint32_t words[BIT_BANG_SPI_WORDS(4)];
+ *  static uint16_t samples[BIT_BANG_SPI_WORDS(4)];
+ *
+ *  BitBangInit(4000000);
+ *  BitBangSPIInit(&sensor);
+ *  BitBangStart(sensor.port, words, samples,
+ *               BitBangSPIEncode(&sensor, words, command, 4), NULL);
+ *  while (BitBangIsBusy())
+ *      ;
+ *  BitBangSPIDecode(&sensor, samples, answer, 4);
+ *  @endcode
+ *
+ *  The timer is TIM1 (DMA1 channels 5 and 2) or TIM8 (DMA2 channels 1 and
+ *  3), no pin of the timer is used. Each word is a DMA transfer to the APB2
+ *  and the channels share the bus with the others, so the engine runs at
+ *  BIT_BANG_MIN_TICKS timer ticks a word at least: some 6 MHz at 72 MHz, a
+ *  SPI clock of 3 MHz. A frame costs a word (4 bytes) and a sample (2 bytes)
+ *  per tick: 16 ticks a byte for SPI, 104 for 1-Wire.
+ *
+ *  Copyright (C) 2026  Luis Maduro
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef BITBANGBUS_H
+#define BITBANGBUS_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stm32f10x.h>
+
+/**Timer of the engine, 1 or 8.*/
+#ifndef BIT_BANG_TIMER
+#define BIT_BANG_TIMER              1
+#endif
+
+/**Priority of the interrupts of the two DMA channels.*/
+#ifndef BIT_BANG_IRQ_PRIORITY
+#define BIT_BANG_IRQ_PRIORITY       2
+#endif
+
+/**Timer ticks of a word at least.*/
+#ifndef BIT_BANG_MIN_TICKS
+#define BIT_BANG_MIN_TICKS          12
+#endif
+
+/**Frequency of the engine for 1-Wire, a tick of 5 us.*/
+#define BIT_BANG_ONE_WIRE_FREQUENCY 200000
+
+/**Words of the BSRR.*/
+#define BIT_BANG_SET(pins)          ((uint32_t) (pins))
+#define BIT_BANG_RESET(pins)        ((uint32_t) (pins) << 16)
+#define BIT_BANG_LEVEL(pins, level) ((level) ? BIT_BANG_SET(pins) : BIT_BANG_RESET(pins))
+
+/**Words of the frames of the encoders.*/
+#define BIT_BANG_SPI_WORDS(length)  (16U * (length) + 2)
+#define BIT_BANG_ONE_WIRE_WORDS(reset, length) (((reset) ? 192U : 0U) + 104U * (length))
+
+/**
+ * End of a frame, called from the interrupt of the DMA.
+ */
+typedef void (*tBitBangDone)(void);
+
+/**
+ * A SPI bus, all its pins on one port.
+ */
+typedef struct
+{
+    GPIO_TypeDef *port;
+    /**Chip select, active low, 0 for none.*/
+    uint16_t cs;
+    uint16_t sck;
+    uint16_t miso;
+    uint16_t mosi;
+    /**Mode 0 to 3, CPOL in bit 1 and CPHA in bit 0.*/
+    uint8_t mode;
+} tBitBangSPI;
+
+uint32_t BitBangInit(uint32_t frequency);
+bool BitBangStart(GPIO_TypeDef *port, const uint32_t *words, uint16_t *samples,
+                  uint16_t count, tBitBangDone done);
+bool BitBangIsBusy(void);
+void BitBangInterruptHandler(void);
+
+void BitBangSPIInit(const tBitBangSPI *bus);
+uint16_t BitBangSPIEncode(const tBitBangSPI *bus, uint32_t *words,
+                          const uint8_t *data, uint16_t length);
+void BitBangSPIDecode(const tBitBangSPI *bus, const uint16_t *samples,
+                      uint8_t *data, uint16_t length);
+
+void BitBangOneWireInit(GPIO_TypeDef *port, uint16_t pin);
+uint16_t BitBangOneWireEncode(uint16_t pin, uint32_t *words, bool reset,
+                              const uint8_t *data, uint16_t length);
+bool BitBangOneWireDecode(uint16_t pin, const uint16_t *samples, bool reset,
+                          uint8_t *data, uint16_t length);
+
+#endif /* BITBANGBUS_H */
@@ -0,0 +1,624 @@
+/**
+ *  @file       CANDevice.c
+ *  @brief      CAN device library, hardware filtered reception and
+ *              prioritized transmission on CAN1
+ *  @author     Luis Maduro
+ *  @version    1.00
+ *  @date       14/10/2026
+ *
+ *  Copyright (C) 2026  Luis Maduro
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <stddef.h>
+#include <string.h>
+#include "CANDevice.h"
+
+#ifdef STM32F10X_CL
+#define CAN_DEVICE_TX_IRQn          CAN1_TX_IRQn
+#define CAN_DEVICE_RX0_IRQn         CAN1_RX0_IRQn
+#else
+#define CAN_DEVICE_TX_IRQn          USB_HP_CAN1_TX_IRQn
+#define CAN_DEVICE_RX0_IRQn         USB_LP_CAN1_RX0_IRQn
+#endif
+
+/**Kinds of filter bank, in the order they are filled.*/
+#define CAN_BANK_LIST16             0
+#define CAN_BANK_MASK16             1
+#define CAN_BANK_LIST32             2
+#define CAN_BANK_MASK32             3
+
+/**Filters of a bank of each kind.*/
+static const uint8_t bankFilters[4] = {4, 2, 2, 1};
+
+/**Filter numbers (FMI) of each FIFO, 4 in a bank at most.*/
+#define CAN_DEVICE_FILTER_NUMBERS   (CAN_DEVICE_FILTER_BANKS * 4)
+
+tCANDeviceStatistics CANDeviceStatistics;
+
+/**Index of the filter of every filter number of each FIFO.*/
+static uint8_t filterIndex[2][CAN_DEVICE_FILTER_NUMBERS];
+static uint8_t filterNumbers[2];
+static uint8_t banks;
+
+/**Reception ring, Head is only written by the interrupts and Tail by
+ CANDeviceReceive(). Both run freely and are masked.*/
+static tCANFrame rxRing[CAN_DEVICE_RX_RING_SIZE];
+static volatile unsigned int rxHead;
+static volatile unsigned int rxTail;
+
+/**Frames waiting for a mailbox, sorted by priority, and their keys.*/
+static tCANFrame txQueue[CAN_DEVICE_TX_QUEUE_SIZE];
+static uint32_t txKey[CAN_DEVICE_TX_QUEUE_SIZE];
+static unsigned int txCount;
+/**Frames in the mailboxes, and the mailboxes being aborted.*/
+static tCANFrame txMailbox[3];
+static uint32_t txMailboxKey[3];
+static uint8_t txAborting;
+
+/**
+ * Configures CAN1, its pins and interrupts. No frame is received until
+ * CANDeviceSetFilters() is called.
+ * @param bitrate Bits per second, PCLK1 must be a multiple of 8 to 16 times
+ * it.
+ * @param mode CAN_Mode_Normal, CAN_Mode_LoopBack, CAN_Mode_Silent or
+ * CAN_Mode_Silent_LoopBack.
+ * @return False if the bit rate can't be made or CAN1 didn't start.
+ */
+bool CANDeviceInit(uint32_t bitrate, uint8_t mode)
+{
+    GPIO_InitTypeDef GPIO_InitStructure;
+    CAN_InitTypeDef CAN_InitStructure;
+    NVIC_InitTypeDef NVIC_InitStructure;
+    RCC_ClocksTypeDef clocks;
+    GPIO_TypeDef *port;
+    uint8_t quanta;
+
+    //the most time quanta that divide the clock, sampled at 87.5 %
+    RCC_GetClocksFreq(&clocks);
+    for (quanta = 16; quanta >= 8; quanta--)
+    {
+        if ((clocks.PCLK1_Frequency % (bitrate * quanta)) == 0 &&
+            (clocks.PCLK1_Frequency / (bitrate * quanta)) <= 1024)
+        {
+            break;
+        }
+    }
+
+    if (quanta < 8)
+    {
+        return false;
+    }
+
+    RCC_APB2PeriphClockCmd(RCC_APB2Periph_AFIO, ENABLE);
+    RCC_APB1PeriphClockCmd(RCC_APB1Periph_CAN1, ENABLE);
+
+#if CAN_DEVICE_REMAP == 0
+    port = GPIOA;
+    RCC_APB2PeriphClockCmd(RCC_APB2Periph_GPIOA, ENABLE);
+    GPIO_InitStructure.GPIO_Pin = GPIO_Pin_11;
+#elif CAN_DEVICE_REMAP == 1
+    port = GPIOB;
+    RCC_APB2PeriphClockCmd(RCC_APB2Periph_GPIOB, ENABLE);
+    GPIO_PinRemapConfig(GPIO_Remap1_CAN1, ENABLE);
+    GPIO_InitStructure.GPIO_Pin = GPIO_Pin_8;
+#else
+    port = GPIOD;
+    RCC_APB2PeriphClockCmd(RCC_APB2Periph_GPIOD, ENABLE);
+    GPIO_PinRemapConfig(GPIO_Remap2_CAN1, ENABLE);
+    GPIO_InitStructure.GPIO_Pin = GPIO_Pin_0;
+#endif
+
+    //RX, then TX on the next pin
+    GPIO_InitStructure.GPIO_Mode = GPIO_Mode_IPU;
+    GPIO_InitStructure.GPIO_Speed = GPIO_Speed_50MHz;
+    GPIO_Init(port, &GPIO_InitStructure);
+    GPIO_InitStructure.GPIO_Pin <<= 1;
+    GPIO_InitStructure.GPIO_Mode = GPIO_Mode_AF_PP;
+    GPIO_Init(port, &GPIO_InitStructure);
+
+    CAN_DeInit(CAN1);
+    CAN_StructInit(&CAN_InitStructure);
+    CAN_InitStructure.CAN_ABOM = ENABLE;
+    CAN_InitStructure.CAN_TXFP = DISABLE;
+    CAN_InitStructure.CAN_Mode = mode;
+    CAN_InitStructure.CAN_SJW = CAN_SJW_1tq;
+    CAN_InitStructure.CAN_BS1 = quanta * 7 / 8 - 2;
+    CAN_InitStructure.CAN_BS2 = quanta - quanta * 7 / 8 - 1;
+    CAN_InitStructure.CAN_Prescaler = clocks.PCLK1_Frequency / (bitrate * quanta);
+
+    if (CAN_Init(CAN1, &CAN_InitStructure) != CAN_InitStatus_Success)
+    {
+        return false;
+    }
+
+    memset(&CANDeviceStatistics, 0, sizeof (CANDeviceStatistics));
+    rxHead = 0;
+    rxTail = 0;
+    txCount = 0;
+    txAborting = 0;
+
+    CANDeviceSetFilters(NULL, 0);
+
+    CAN_ITConfig(CAN1, CAN_IT_FMP0 | CAN_IT_FOV0 | CAN_IT_FMP1 | CAN_IT_FOV1 |
+                 CAN_IT_TME, ENABLE);
+
+    NVIC_InitStructure.NVIC_IRQChannelPreemptionPriority = CAN_DEVICE_IRQ_PRIORITY;
+    NVIC_InitStructure.NVIC_IRQChannelSubPriority = 0;
+    NVIC_InitStructure.NVIC_IRQChannelCmd = ENABLE;
+    NVIC_InitStructure.NVIC_IRQChannel = CAN_DEVICE_RX0_IRQn;
+    NVIC_Init(&NVIC_InitStructure);
+    NVIC_InitStructure.NVIC_IRQChannel = CAN1_RX1_IRQn;
+    NVIC_Init(&NVIC_InitStructure);
+    NVIC_InitStructure.NVIC_IRQChannel = CAN_DEVICE_TX_IRQn;
+    NVIC_Init(&NVIC_InitStructure);
+
+    return true;
+}
+
+/**
+ * Gives the kind of bank of a filter.
+ */
+static uint8_t CANDeviceBankKind(const tCANFilter *filter)
+{
+    bool exact = !(filter->flags & CAN_FILTER_ANY_TYPE);
+
+    if (filter->flags & CAN_FILTER_EXTENDED)
+    {
+        exact = exact && ((filter->mask & 0x1FFFFFFF) == 0x1FFFFFFF);
+        return exact ? CAN_BANK_LIST32 : CAN_BANK_MASK32;
+    }
+
+    exact = exact && ((filter->mask & 0x7FF) == 0x7FF);
+    return exact ? CAN_BANK_LIST16 : CAN_BANK_MASK16;
+}
+
+/**
+ * Gives the identifier and the mask of a filter as in its bank, the
+ * identifier extension always compared and the remote bit unless
+ * CAN_FILTER_ANY_TYPE.
+ */
+static void CANDeviceBankValues(const tCANFilter *filter, uint8_t kind,
+                                uint32_t *id, uint32_t *mask)
+{
+    uint32_t remote = (filter->flags & CAN_FILTER_REMOTE) ? 1 : 0;
+    uint32_t compareRemote = (filter->flags & CAN_FILTER_ANY_TYPE) ? 0 : 1;
+
+    if (kind == CAN_BANK_LIST32 || kind == CAN_BANK_MASK32)
+    {
+        //STID[10:0] EXID[17:0] IDE RTR 0
+        *id = ((filter->id & 0x1FFFFFFF) << 3) | CAN_TI0R_IDE | (remote << 1);
+        *mask = ((filter->mask & 0x1FFFFFFF) << 3) | CAN_TI0R_IDE | (compareRemote << 1);
+    }
+    else
+    {
+        //STID[10:0] RTR IDE EXID[17:15]
+        *id = ((filter->id & 0x7FF) << 5) | (remote << 4);
+        *mask = ((filter->mask & 0x7FF) << 5) | 0x08 | (compareRemote << 4);
+    }
+}
+
+/**
+ * Writes the next bank, its unused filters repeat the last one.
+ * @return False if there is no bank left.
+ */
+static bool CANDeviceWriteBank(uint8_t kind, uint32_t *id, uint32_t *mask,
+                               uint8_t *index, uint8_t used)
+{
+    uint32_t bit = 1UL << banks;
+    uint8_t fifo = banks & 1;
+    uint8_t i;
+
+    if (banks == CAN_DEVICE_FILTER_BANKS)
+    {
+        return false;
+    }
+
+    for (i = used; i < bankFilters[kind]; i++)
+    {
+        id[i] = id[used - 1];
+        mask[i] = mask[used - 1];
+        index[i] = index[used - 1];
+    }
+
+    //the filter numbers of a FIFO count the filters of its banks in order
+    for (i = 0; i < bankFilters[kind]; i++)
+    {
+        filterIndex[fifo][filterNumbers[fifo]++] = index[i];
+    }
+
+    switch (kind)
+    {
+        case CAN_BANK_LIST16:
+            CAN1->sFilterRegister[banks].FR1 = id[0] | (id[1] << 16);
+            CAN1->sFilterRegister[banks].FR2 = id[2] | (id[3] << 16);
+            break;
+        case CAN_BANK_MASK16:
+            CAN1->sFilterRegister[banks].FR1 = id[0] | (mask[0] << 16);
+            CAN1->sFilterRegister[banks].FR2 = id[1] | (mask[1] << 16);
+            break;
+        case CAN_BANK_LIST32:
+            CAN1->sFilterRegister[banks].FR1 = id[0];
+            CAN1->sFilterRegister[banks].FR2 = id[1];
+            break;
+        default:
+            CAN1->sFilterRegister[banks].FR1 = id[0];
+            CAN1->sFilterRegister[banks].FR2 = mask[0];
+            break;
+    }
+
+    if (kind == CAN_BANK_LIST16 || kind == CAN_BANK_LIST32)
+    {
+        CAN1->FM1R |= bit;
+    }
+    if (kind == CAN_BANK_LIST32 || kind == CAN_BANK_MASK32)
+    {
+        CAN1->FS1R |= bit;
+    }
+    if (fifo)
+    {
+        CAN1->FFA1R |= bit;
+    }
+    CAN1->FA1R |= bit;
+
+    banks++;
+
+    return true;
+}
+
+/**
+ * Compiles filters into the filter banks of CAN1, replacing the ones
+ * before. The frames are received while the banks are written.
+ * @param filters Filters, NULL for none.
+ * @param count Number of filters, 0 receives nothing.
+ * @return False if the filters don't fit in the banks, the ones that fit
+ * are used.
+ */
+bool CANDeviceSetFilters(const tCANFilter *filters, uint8_t count)
+{
+    uint32_t all = (1UL << CAN_DEVICE_FILTER_BANKS) - 1;
+    uint32_t id[4];
+    uint32_t mask[4];
+    uint8_t index[4];
+    uint8_t used;
+    uint8_t kind;
+    uint8_t i;
+    bool fit = true;
+
+    CAN1->FMR |= CAN_FMR_FINIT;
+    CAN1->FA1R &= ~all;
+    CAN1->FM1R &= ~all;
+    CAN1->FS1R &= ~all;
+    CAN1->FFA1R &= ~all;
+
+    banks = 0;
+    filterNumbers[0] = 0;
+    filterNumbers[1] = 0;
+
+    for (kind = CAN_BANK_LIST16; kind <= CAN_BANK_MASK32 && fit; kind++)
+    {
+        used = 0;
+
+        for (i = 0; i < count && fit; i++)
+        {
+            if (CANDeviceBankKind(&filters[i]) != kind)
+            {
+                continue;
+            }
+
+            CANDeviceBankValues(&filters[i], kind, &id[used], &mask[used]);
+            index[used++] = i;
+
+            if (used == bankFilters[kind])
+            {
+                fit = CANDeviceWriteBank(kind, id, mask, index, used);
+                used = 0;
+            }
+        }
+
+        if (used != 0 && fit)
+        {
+            fit = CANDeviceWriteBank(kind, id, mask, index, used);
+        }
+    }
+
+    CAN1->FMR &= ~CAN_FMR_FINIT;
+
+    return fit;
+}
+
+/**
+ * Moves the frames of a FIFO into the ring.
+ */
+static void CANDeviceDrain(uint8_t fifo)
+{
+    CAN_FIFOMailBox_TypeDef *box = &CAN1->sFIFOMailBox[fifo];
+    __IO uint32_t *rfr = fifo ? &CAN1->RF1R : &CAN1->RF0R;
+    tCANFrame *frame;
+    unsigned int head;
+    uint32_t rir;
+    uint32_t rdtr;
+    uint8_t number;
+
+    while (*rfr & CAN_RF0R_FMP0)
+    {
+        head = rxHead;
+
+        if (head - rxTail < CAN_DEVICE_RX_RING_SIZE)
+        {
+            frame = &rxRing[head & (CAN_DEVICE_RX_RING_SIZE - 1)];
+            rir = box->RIR;
+            rdtr = box->RDTR;
+            number = (uint8_t) (rdtr >> 8);
+
+            frame->extended = (rir & CAN_TI0R_IDE) ? 1 : 0;
+            frame->id = frame->extended ? (rir >> 3) : (rir >> 21);
+            frame->remote = (rir & CAN_TI0R_RTR) ? 1 : 0;
+            frame->length = (uint8_t) (rdtr & 0x0F);
+            frame->filter = (number < filterNumbers[fifo]) ? filterIndex[fifo][number] : 0xFF;
+            ((uint32_t *) frame->data)[0] = box->RDLR;
+            ((uint32_t *) frame->data)[1] = box->RDHR;
+
+            //the frame before the index that publishes it
+            __DMB();
+            rxHead = head + 1;
+        }
+        else
+        {
+            CANDeviceStatistics.Dropped++;
+        }
+
+        *rfr = CAN_RF0R_RFOM0;
+    }
+
+    if (*rfr & CAN_RF0R_FOVR0)
+    {
+        CANDeviceStatistics.Overruns++;
+        *rfr = CAN_RF0R_FOVR0;
+    }
+}
+
+/**
+ * Takes the oldest frame received.
+ * @param frame Frame.
+ * @return False if there is none.
+ */
+bool CANDeviceReceive(tCANFrame *frame)
+{
+    unsigned int tail = rxTail;
+
+    if (tail == rxHead)
+    {
+        return false;
+    }
+
+    *frame = rxRing[tail & (CAN_DEVICE_RX_RING_SIZE - 1)];
+    __DMB();
+    rxTail = tail + 1;
+
+    return true;
+}
+
+/**
+ * Gives the frames received not taken yet.
+ * @return Frames.
+ */
+unsigned int CANDeviceAvailable(void)
+{
+    return rxHead - rxTail;
+}
+
+/**
+ * Gives the priority of a frame in the arbitration, lower first: the 11
+ * bits of the base identifier, then the identifier extension, then the 18
+ * bits of the extension.
+ */
+static uint32_t CANDeviceKey(const tCANFrame *frame)
+{
+    if (frame->extended)
+    {
+        return (((frame->id >> 18) & 0x7FF) << 19) | 0x40000 | (frame->id & 0x3FFFF);
+    }
+
+    return (frame->id & 0x7FF) << 19;
+}
+
+/**
+ * Puts a frame in the queue after the ones of the same priority, or before
+ * them for an aborted frame, which was queued first.
+ * @return False if the queue is full.
+ */
+static bool CANDeviceQueue(const tCANFrame *frame, uint32_t key, bool ahead)
+{
+    unsigned int i;
+
+    if (txCount == CAN_DEVICE_TX_QUEUE_SIZE)
+    {
+        return false;
+    }
+
+    for (i = txCount; i > 0 && (txKey[i - 1] > key || (ahead && txKey[i - 1] == key)); i--)
+    {
+        txQueue[i] = txQueue[i - 1];
+        txKey[i] = txKey[i - 1];
+    }
+
+    txQueue[i] = *frame;
+    txKey[i] = key;
+    txCount++;
+
+    return true;
+}
+
+/**
+ * Tells if a frame of the same priority is in a mailbox. The mailboxes go
+ * out by identifier, so of two equal ones the later could be sent first.
+ */
+static bool CANDeviceInFlight(uint32_t key)
+{
+    unsigned int i;
+
+    for (i = 0; i < 3; i++)
+    {
+        if (!(CAN1->TSR & (CAN_TSR_TME0 << i)) && txMailboxKey[i] == key)
+        {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+/**
+ * Fills the free mailboxes from the queue, or aborts the mailbox of lowest
+ * priority when the head of the queue beats it.
+ */
+static void CANDeviceTxService(void)
+{
+    CAN_TxMailBox_TypeDef *box;
+    unsigned int mailbox;
+    unsigned int lowest;
+    unsigned int i;
+
+    //the frames of the same identifier leave in order, one at a time
+    while (txCount != 0 && (CAN1->TSR & CAN_TSR_TME) && !CANDeviceInFlight(txKey[0]))
+    {
+        mailbox = (CAN1->TSR & CAN_TSR_CODE) >> 24;
+        box = &CAN1->sTxMailBox[mailbox];
+
+        txMailbox[mailbox] = txQueue[0];
+        txMailboxKey[mailbox] = txKey[0];
+        txCount--;
+        for (i = 0; i < txCount; i++)
+        {
+            txQueue[i] = txQueue[i + 1];
+            txKey[i] = txKey[i + 1];
+        }
+
+        box->TDTR = txMailbox[mailbox].length;
+        box->TDLR = ((uint32_t *) txMailbox[mailbox].data)[0];
+        box->TDHR = ((uint32_t *) txMailbox[mailbox].data)[1];
+        box->TIR = (txMailbox[mailbox].extended ?
+                    (((txMailbox[mailbox].id & 0x1FFFFFFF) << 3) | CAN_TI0R_IDE) :
+                    ((txMailbox[mailbox].id & 0x7FF) << 21)) |
+                (txMailbox[mailbox].remote ? CAN_TI0R_RTR : 0) | CAN_TI0R_TXRQ;
+    }
+
+    if (txCount == 0 || (CAN1->TSR & CAN_TSR_TME))
+    {
+        return;
+    }
+
+    lowest = 3;
+    for (i = 0; i < 3; i++)
+    {
+        if (!(txAborting & (1 << i)) &&
+            (lowest == 3 || txMailboxKey[i] > txMailboxKey[lowest]))
+        {
+            lowest = i;
+        }
+    }
+
+    if (lowest != 3 && txKey[0] < txMailboxKey[lowest])
+    {
+        txAborting |= 1 << lowest;
+        CAN1->TSR = CAN_TSR_ABRQ0 << (8 * lowest);
+    }
+}
+
+/**
+ * Queues a frame to send, it goes to a mailbox at once if one is free or
+ * holds a frame of lower priority.
+ * @param frame Frame, copied.
+ * @return False if the queue is full.
+ */
+bool CANDeviceSend(const tCANFrame *frame)
+{
+    uint32_t primask;
+    bool queued;
+
+    //the TX interrupt also takes from the queue
+    primask = __get_PRIMASK();
+    __disable_irq();
+
+    queued = CANDeviceQueue(frame, CANDeviceKey(frame), false);
+    CANDeviceTxService();
+
+    __set_PRIMASK(primask);
+
+    return queued;
+}
+
+/**
+ * Gives the frames waiting for a mailbox.
+ * @return Frames.
+ */
+unsigned int CANDevicePending(void)
+{
+    return txCount;
+}
+
+/**
+ * This funtion is intended to be put in USB_LP_CAN1_RX0_IRQHandler()
+ * (CAN1_RX0_IRQHandler() on the connectivity line).
+ */
+void CANDeviceRX0InterruptHandler(void)
+{
+    CANDeviceDrain(0);
+}
+
+/**
+ * This funtion is intended to be put in CAN1_RX1_IRQHandler().
+ */
+void CANDeviceRX1InterruptHandler(void)
+{
+    CANDeviceDrain(1);
+}
+
+/**
+ * This funtion is intended to be put in USB_HP_CAN1_TX_IRQHandler()
+ * (CAN1_TX_IRQHandler() on the connectivity line). An aborted frame goes
+ * back to the queue.
+ */
+void CANDeviceTXInterruptHandler(void)
+{
+    uint32_t tsr = CAN1->TSR;
+    unsigned int i;
+
+    for (i = 0; i < 3; i++)
+    {
+        if (!(tsr & (CAN_TSR_RQCP0 << (8 * i))))
+        {
+            continue;
+        }
+
+        if (tsr & (CAN_TSR_TXOK0 << (8 * i)))
+        {
+            CANDeviceStatistics.Sent++;
+        }
+        else
+        {
+            CANDeviceStatistics.Aborted++;
+            if (!CANDeviceQueue(&txMailbox[i], txMailboxKey[i], true))
+            {
+                CANDeviceStatistics.Dropped++;
+            }
+        }
+
+        txAborting &= ~(1 << i);
+        CAN1->TSR = CAN_TSR_RQCP0 << (8 * i);
+    }
+
+    CANDeviceTxService();
+}
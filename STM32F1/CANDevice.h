@@ -0,0 +1,142 @@
+/**
+ *  @file       CANDevice.h
+ *  @brief      CAN device library, hardware filtered reception and
+ *              prioritized transmission on CAN1
+ *  @author     Luis Maduro
+ *  @version    1.00
+ *  @date       14/10/2026
+ *
+ *  The identifiers wanted are given as a list of filters, compiled by
+ *  CANDeviceSetFilters() into the fewest filter banks of the bxCAN: the
+ *  exact standard identifiers 4 per bank (16 bit list mode), the masked
+ *  standard ones 2 per bank (16 bit mask mode), the exact extended ones 2
+ *  per bank (32 bit list mode) and the masked extended ones 1 per bank
+ *  (32 bit mask mode). The banks go to FIFO 0 and FIFO 1 in turn, the
+ *  frames not wanted never reach the CPU.
+ *
+ *  Both FIFOs are drained by their interrupts into a ring of frames, single
+ *  producer single consumer, read by CANDeviceReceive() without critical
+ *  section. Every frame gives the index of the filter that matched it.
+ *
+ *  The frames sent wait in a queue sorted by identifier, the mailboxes are
+ *  sent in identifier order (TXFP = 0) and when they are all taken by
+ *  frames of lower priority than the head of the queue, the lowest one is
+ *  aborted and queued again, so a frame never waits for less important
+ *  ones. The frames of the same identifier keep their order: only one of
+ *  them is in a mailbox at a time, and an aborted one goes back ahead of
+ *  the others.
+ *
+ *  On the devices other than the connectivity line CAN1 shares its TX and
+ *  RX0 interrupts with the USB, both can't be used at once.
+ *
+ *  Copyright (C) 2026  Luis Maduro
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef _CANDEV_H_
+#define _CANDEV_H_
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stm32f10x.h>
+
+/**Pins of CAN1: 0 for PA11/PA12, 1 for PB8/PB9, 2 for PD0/PD1.*/
+#ifndef CAN_DEVICE_REMAP
+#define CAN_DEVICE_REMAP            1
+#endif
+
+/**Frames of the reception ring, a power of 2.*/
+#ifndef CAN_DEVICE_RX_RING_SIZE
+#define CAN_DEVICE_RX_RING_SIZE     32
+#endif
+
+/**Frames waiting for a mailbox.*/
+#ifndef CAN_DEVICE_TX_QUEUE_SIZE
+#define CAN_DEVICE_TX_QUEUE_SIZE    16
+#endif
+
+/**Filter banks of CAN1, the connectivity line gives the others to CAN2.*/
+#ifndef CAN_DEVICE_FILTER_BANKS
+#define CAN_DEVICE_FILTER_BANKS     14
+#endif
+
+/**Priority of the CAN1 interrupts.*/
+#ifndef CAN_DEVICE_IRQ_PRIORITY
+#define CAN_DEVICE_IRQ_PRIORITY     1
+#endif
+
+/**Flags of a filter.*/
+/**29 bit identifier, 11 bit otherwise.*/
+#define CAN_FILTER_EXTENDED         0x01
+/**Remote frames instead of data frames.*/
+#define CAN_FILTER_REMOTE           0x02
+/**Data and remote frames.*/
+#define CAN_FILTER_ANY_TYPE         0x04
+
+/**
+ * Identifiers wanted, an identifier matches if (identifier & mask) ==
+ * (id & mask).
+ */
+typedef struct
+{
+    uint32_t id;
+    /**Bits of the identifier compared, 0x7FF (or 0x1FFFFFFF) for one
+     identifier.*/
+    uint32_t mask;
+    /**CAN_FILTER_...*/
+    uint8_t flags;
+} tCANFilter;
+
+/**
+ * Frame received or to send.
+ */
+typedef struct
+{
+    uint32_t id;
+    uint8_t extended;
+    uint8_t remote;
+    /**Bytes of data, 0 to 8.*/
+    uint8_t length;
+    /**Index of the filter that matched a frame received.*/
+    uint8_t filter;
+    uint8_t data[8];
+} tCANFrame;
+
+/**
+ * Counters of the device.
+ */
+typedef struct
+{
+    /**Frames dropped, the ring was full.*/
+    unsigned int Dropped;
+    /**Frames lost by a FIFO of the bxCAN, the interrupt was late.*/
+    unsigned int Overruns;
+    unsigned int Sent;
+    /**Mailboxes aborted for a frame of higher priority.*/
+    unsigned int Aborted;
+} tCANDeviceStatistics;
+
+extern tCANDeviceStatistics CANDeviceStatistics;
+
+bool CANDeviceInit(uint32_t bitrate, uint8_t mode);
+bool CANDeviceSetFilters(const tCANFilter *filters, uint8_t count);
+bool CANDeviceReceive(tCANFrame *frame);
+unsigned int CANDeviceAvailable(void);
+bool CANDeviceSend(const tCANFrame *frame);
+unsigned int CANDevicePending(void);
+void CANDeviceRX0InterruptHandler(void);
+void CANDeviceRX1InterruptHandler(void);
+void CANDeviceTXInterruptHandler(void);
+
+#endif /* _CANDEV_H_ */
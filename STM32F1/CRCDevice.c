@@ -0,0 +1,240 @@
+/**
+ *  @file       CRCDevice.c
+ *  @brief      CRC-32 on the CRC unit of the STM32F1
+ *  @author     Luis Maduro
+ *  @version    1.00
+ *  @date       14/10/2026
+ *
+ *  Copyright (C) 2026  Luis Maduro
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <stddef.h>
+#include "CRCDevice.h"
+
+#define CRC_DEVICE_POLYNOMIAL   0x04C11DB7UL
+
+/**CRC of the 16 values of a nibble, for the last bytes of a buffer.*/
+static const uint32_t crcTable[16] = {
+    0x00000000UL, 0x04C11DB7UL, 0x09823B6EUL, 0x0D4326D9UL,
+    0x130476DCUL, 0x17C56B6BUL, 0x1A864DB2UL, 0x1E475005UL,
+    0x2608EDB8UL, 0x22C9F00FUL, 0x2F8AD6D6UL, 0x2B4BCB61UL,
+    0x350C9B64UL, 0x31CD86D3UL, 0x3C8EA00AUL, 0x384FBDBDUL
+};
+
+/**Buffer being fed by the DMA: the next words, the words still to be
+ given to the DMA and the last bytes.*/
+static const uint32_t *pendingNext;
+static unsigned long pendingWords;
+static const uint8_t *pendingTail;
+static uint8_t pendingTailLength;
+static bool busy = false;
+static uint32_t result = CRC_DEVICE_INIT;
+
+/**
+ * Folds bytes in a CRC one at a time, two lookups per byte.
+ */
+static uint32_t CRCDeviceBytes(uint32_t crc, const uint8_t *data, unsigned int length)
+{
+    while (length--)
+    {
+        crc ^= (uint32_t) *data++ << 24;
+        crc = (crc << 4) ^ crcTable[crc >> 28];
+        crc = (crc << 4) ^ crcTable[crc >> 28];
+    }
+
+    return crc;
+}
+
+/**
+ * Resets the unit to a CRC. A word w takes the reset value to
+ * f(0xFFFFFFFF ^ w), f being the 32 shifts of a word, so w is found by
+ * running the shifts of the CRC backwards.
+ */
+static void CRCDeviceLoad(uint32_t crc)
+{
+    unsigned char i;
+
+    CRC_ResetDR();
+
+    if (crc != CRC_DEVICE_INIT)
+    {
+        for (i = 0; i < 32; i++)
+        {
+            crc = (crc & 1) ? ((crc ^ CRC_DEVICE_POLYNOMIAL) >> 1) | 0x80000000UL : crc >> 1;
+        }
+
+        CRC->DR = crc ^ CRC_DEVICE_INIT;
+    }
+}
+
+/**
+ * Gives the next words of the buffer to the DMA, up to the 65535 transfers
+ * of a channel.
+ */
+static void CRCDeviceStartDMA(void)
+{
+    uint16_t words = (pendingWords > 0xFFFF) ? 0xFFFF : (uint16_t) pendingWords;
+
+    DMA_Cmd(CRC_DMA_CHANNEL, DISABLE);
+    CRC_DMA_CHANNEL->CPAR = (uint32_t) pendingNext;
+    DMA_SetCurrDataCounter(CRC_DMA_CHANNEL, words);
+    DMA_ClearFlag(CRC_DMA_FLAG_TC);
+    DMA_Cmd(CRC_DMA_CHANNEL, ENABLE);
+
+    pendingNext += words;
+    pendingWords -= words;
+}
+
+/**
+ * Enables the CRC unit and configures the DMA channel, the drivers using
+ * the unit call it from their own initialization.
+ */
+void CRCDeviceInit(void)
+{
+    DMA_InitTypeDef DMA_InitStructure;
+
+    while (CRCDeviceIsBusy());
+
+    RCC_AHBPeriphClockCmd(RCC_AHBPeriph_CRC | RCC_AHBPeriph_DMA1, ENABLE);
+
+    //the buffer is the source "peripheral" of the memory to memory transfer
+    DMA_DeInit(CRC_DMA_CHANNEL);
+    DMA_InitStructure.DMA_PeripheralBaseAddr = 0;
+    DMA_InitStructure.DMA_MemoryBaseAddr = (uint32_t) &CRC->DR;
+    DMA_InitStructure.DMA_DIR = DMA_DIR_PeripheralSRC;
+    DMA_InitStructure.DMA_BufferSize = 1;
+    DMA_InitStructure.DMA_PeripheralInc = DMA_PeripheralInc_Enable;
+    DMA_InitStructure.DMA_MemoryInc = DMA_MemoryInc_Disable;
+    DMA_InitStructure.DMA_PeripheralDataSize = DMA_PeripheralDataSize_Word;
+    DMA_InitStructure.DMA_MemoryDataSize = DMA_MemoryDataSize_Word;
+    DMA_InitStructure.DMA_Mode = DMA_Mode_Normal;
+    DMA_InitStructure.DMA_Priority = DMA_Priority_Low;
+    DMA_InitStructure.DMA_M2M = DMA_M2M_Enable;
+    DMA_Init(CRC_DMA_CHANNEL, &DMA_InitStructure);
+}
+
+/**
+ * Computes the CRC of a buffer, by DMA if it is large and aligned.
+ * @param crc CRC of the data before, CRC_DEVICE_INIT for none.
+ * @param data Buffer.
+ * @param length Bytes of the buffer.
+ * @return The CRC.
+ */
+uint32_t CRCDeviceCompute(uint32_t crc, const void *data, unsigned long length)
+{
+    const uint8_t *bytes = (const uint8_t *) data;
+
+    if ((length >= CRC_DMA_MIN_LENGTH) && (((uint32_t) data & 3) == 0))
+    {
+        CRCDeviceStart(crc, data, length);
+        return CRCDeviceGetResult();
+    }
+
+    while (CRCDeviceIsBusy());
+
+    if (length >= 4)
+    {
+        CRCDeviceLoad(crc);
+
+        if (((uint32_t) data & 3) == 0)
+        {
+            for (; length >= 4; length -= 4, bytes += 4)
+            {
+                CRC->DR = *(const uint32_t *) bytes;
+            }
+        }
+        else
+        {
+            for (; length >= 4; length -= 4, bytes += 4)
+            {
+                CRC->DR = bytes[0] | ((uint32_t) bytes[1] << 8) |
+                        ((uint32_t) bytes[2] << 16) | ((uint32_t) bytes[3] << 24);
+            }
+        }
+
+        crc = CRC->DR;
+    }
+
+    return CRCDeviceBytes(crc, bytes, (unsigned int) length);
+}
+
+/**
+ * Starts the CRC of a buffer, DMA fed if it is large and aligned, and
+ * returns at once. The CRC is computed at once otherwise. The buffer is not
+ * modified until CRCDeviceIsBusy() is false.
+ * @param crc CRC of the data before, CRC_DEVICE_INIT for none.
+ * @param data Buffer.
+ * @param length Bytes of the buffer.
+ */
+void CRCDeviceStart(uint32_t crc, const void *data, unsigned long length)
+{
+    while (CRCDeviceIsBusy());
+
+    if ((length < CRC_DMA_MIN_LENGTH) || (((uint32_t) data & 3) != 0))
+    {
+        result = CRCDeviceCompute(crc, data, length);
+        return;
+    }
+
+    pendingNext = (const uint32_t *) data;
+    pendingWords = length / 4;
+    pendingTail = (const uint8_t *) data + (length & ~3UL);
+    pendingTailLength = (uint8_t) (length & 3);
+    busy = true;
+
+    CRCDeviceLoad(crc);
+    CRCDeviceStartDMA();
+}
+
+/**
+ * Tells if the CRC of CRCDeviceStart() is being computed. It hands the
+ * rest of a buffer longer than 65535 words to the DMA, so it is polled.
+ * @return True while busy.
+ */
+bool CRCDeviceIsBusy(void)
+{
+    if (!busy)
+    {
+        return false;
+    }
+
+    if (DMA_GetFlagStatus(CRC_DMA_FLAG_TC) == RESET)
+    {
+        return true;
+    }
+
+    if (pendingWords != 0)
+    {
+        CRCDeviceStartDMA();
+        return true;
+    }
+
+    DMA_Cmd(CRC_DMA_CHANNEL, DISABLE);
+    result = CRCDeviceBytes(CRC->DR, pendingTail, pendingTailLength);
+    busy = false;
+
+    return false;
+}
+
+/**
+ * Gives the CRC of CRCDeviceStart(), waiting for it.
+ * @return The CRC.
+ */
+uint32_t CRCDeviceGetResult(void)
+{
+    while (CRCDeviceIsBusy());
+
+    return result;
+}
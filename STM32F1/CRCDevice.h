@@ -0,0 +1,68 @@
+/**
+ *  @file       CRCDevice.h
+ *  @brief      CRC-32 on the CRC unit of the STM32F1
+ *  @author     Luis Maduro
+ *  @version    1.00
+ *  @date       14/10/2026
+ *
+ *  The CRC is the one of the CRC unit: polynomial 0x04C11DB7, MSB first,
+ *  no final complement (CRC-32/MPEG-2), computed on the data taken as little
+ *  endian 32 bit words from the start of every call and the last 1 to 3
+ *  bytes one at a time. The PIC18 port computes the same one with a table,
+ *  so the checks written by one are read by the other. A check is computed
+ *  with the same lengths of call as it was written, or every call but the
+ *  last is a multiple of 4 bytes.
+ *
+ *  The unit starts from CRC_DEVICE_INIT only, a CRC carried over from a call
+ *  before is loaded by writing the word that gives it.
+ *
+ *  Buffers from CRC_DMA_MIN_LENGTH bytes, 4 byte aligned, are fed to the
+ *  unit by memory to memory DMA. CRCDeviceStart() returns at once and the
+ *  CPU is free until CRCDeviceIsBusy() is false.
+ *
+ *  The unit is not shared with interrupts: CRCDeviceCompute() and
+ *  CRCDeviceStart() are called from the main loop (or tasks) only.
+ *
+ *  Copyright (C) 2026  Luis Maduro
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef _CRCDEV_H_
+#define _CRCDEV_H_
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stm32f10x.h>
+
+/**CRC of no data, the first value of a CRC carried over several calls.*/
+#define CRC_DEVICE_INIT         0xFFFFFFFFUL
+
+/**Shorter buffers are fed by the CPU, the DMA setup would take longer.*/
+#ifndef CRC_DMA_MIN_LENGTH
+#define CRC_DMA_MIN_LENGTH      64
+#endif
+
+/**DMA channel of the memory to memory transfers, any free one.*/
+#ifndef CRC_DMA_CHANNEL
+#define CRC_DMA_CHANNEL         DMA1_Channel4
+#define CRC_DMA_FLAG_TC         DMA1_FLAG_TC4
+#endif
+
+void CRCDeviceInit(void);
+uint32_t CRCDeviceCompute(uint32_t crc, const void *data, unsigned long length);
+void CRCDeviceStart(uint32_t crc, const void *data, unsigned long length);
+bool CRCDeviceIsBusy(void);
+uint32_t CRCDeviceGetResult(void);
+
+#endif /* _CRCDEV_H_ */
@@ -0,0 +1,136 @@
+/**
+ *  @file       CodePlacement.c
+ *  @author     Luis Maduro
+ *  @version    1.00
+ *  @date       14/10/2026
+ *  @brief      Cold code executed in place from the FSMC NOR, hot functions
+ *              copied to the SRAM.
+ *
+ *  Copyright (C) 2026  Luis Maduro
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "CodePlacement.h"
+
+#if USE_CODE_PLACEMENT
+
+/**Given by CodePlacement.ld: load address and bounds of .ramfunc.*/
+extern uint32_t _siramfunc;
+extern uint32_t _sramfunc;
+extern uint32_t _eramfunc;
+
+#if CODE_PLACEMENT_NOR
+
+/**
+ * Configures the pins and the timings of bank 1 NOR/SRAM2, those of the
+ * NOR of the STM3210E-EVAL, read only.
+ */
+static void CodePlacementConfigureNOR(void)
+{
+    FSMC_NORSRAMInitTypeDef FSMC_NORSRAMInitStructure;
+    FSMC_NORSRAMTimingInitTypeDef timing;
+    GPIO_InitTypeDef GPIO_InitStructure;
+
+    RCC_AHBPeriphClockCmd(RCC_AHBPeriph_FSMC, ENABLE);
+    RCC_APB2PeriphClockCmd(RCC_APB2Periph_GPIOD | RCC_APB2Periph_GPIOE |
+                           RCC_APB2Periph_GPIOF | RCC_APB2Periph_GPIOG, ENABLE);
+
+    GPIO_InitStructure.GPIO_Mode = GPIO_Mode_AF_PP;
+    GPIO_InitStructure.GPIO_Speed = GPIO_Speed_50MHz;
+
+    //D0-D3, D13-D15, A16-A18, NOE, NWE
+    GPIO_InitStructure.GPIO_Pin = GPIO_Pin_0 | GPIO_Pin_1 | GPIO_Pin_4 | GPIO_Pin_5 |
+            GPIO_Pin_8 | GPIO_Pin_9 | GPIO_Pin_10 | GPIO_Pin_11 | GPIO_Pin_12 |
+            GPIO_Pin_13 | GPIO_Pin_14 | GPIO_Pin_15;
+    GPIO_Init(GPIOD, &GPIO_InitStructure);
+
+    //A19-A22, D4-D12
+    GPIO_InitStructure.GPIO_Pin = GPIO_Pin_3 | GPIO_Pin_4 | GPIO_Pin_5 | GPIO_Pin_6 |
+            GPIO_Pin_7 | GPIO_Pin_8 | GPIO_Pin_9 | GPIO_Pin_10 | GPIO_Pin_11 |
+            GPIO_Pin_12 | GPIO_Pin_13 | GPIO_Pin_14 | GPIO_Pin_15;
+    GPIO_Init(GPIOE, &GPIO_InitStructure);
+
+    //A0-A9
+    GPIO_InitStructure.GPIO_Pin = GPIO_Pin_0 | GPIO_Pin_1 | GPIO_Pin_2 | GPIO_Pin_3 |
+            GPIO_Pin_4 | GPIO_Pin_5 | GPIO_Pin_12 | GPIO_Pin_13 | GPIO_Pin_14 |
+            GPIO_Pin_15;
+    GPIO_Init(GPIOF, &GPIO_InitStructure);
+
+    //A10-A15, NE2
+    GPIO_InitStructure.GPIO_Pin = GPIO_Pin_0 | GPIO_Pin_1 | GPIO_Pin_2 | GPIO_Pin_3 |
+            GPIO_Pin_4 | GPIO_Pin_5 | GPIO_Pin_9;
+    GPIO_Init(GPIOG, &GPIO_InitStructure);
+
+    timing.FSMC_AddressSetupTime = 0x02;
+    timing.FSMC_AddressHoldTime = 0x00;
+    timing.FSMC_DataSetupTime = 0x05;
+    timing.FSMC_BusTurnAroundDuration = 0x00;
+    timing.FSMC_CLKDivision = 0x00;
+    timing.FSMC_DataLatency = 0x00;
+    timing.FSMC_AccessMode = FSMC_AccessMode_B;
+
+    FSMC_NORSRAMInitStructure.FSMC_Bank = FSMC_Bank1_NORSRAM2;
+    FSMC_NORSRAMInitStructure.FSMC_DataAddressMux = FSMC_DataAddressMux_Disable;
+    FSMC_NORSRAMInitStructure.FSMC_MemoryType = FSMC_MemoryType_NOR;
+    FSMC_NORSRAMInitStructure.FSMC_MemoryDataWidth = FSMC_MemoryDataWidth_16b;
+    FSMC_NORSRAMInitStructure.FSMC_BurstAccessMode = FSMC_BurstAccessMode_Disable;
+    FSMC_NORSRAMInitStructure.FSMC_AsynchronousWait = FSMC_AsynchronousWait_Disable;
+    FSMC_NORSRAMInitStructure.FSMC_WaitSignalPolarity = FSMC_WaitSignalPolarity_Low;
+    FSMC_NORSRAMInitStructure.FSMC_WrapMode = FSMC_WrapMode_Disable;
+    FSMC_NORSRAMInitStructure.FSMC_WaitSignalActive = FSMC_WaitSignalActive_BeforeWaitState;
+    //the code is never written from the application
+    FSMC_NORSRAMInitStructure.FSMC_WriteOperation = FSMC_WriteOperation_Disable;
+    FSMC_NORSRAMInitStructure.FSMC_WaitSignal = FSMC_WaitSignal_Disable;
+    FSMC_NORSRAMInitStructure.FSMC_ExtendedMode = FSMC_ExtendedMode_Disable;
+    FSMC_NORSRAMInitStructure.FSMC_WriteBurst = FSMC_WriteBurst_Disable;
+    FSMC_NORSRAMInitStructure.FSMC_ReadWriteTimingStruct = &timing;
+    FSMC_NORSRAMInitStructure.FSMC_WriteTimingStruct = &timing;
+    FSMC_NORSRAMInit(&FSMC_NORSRAMInitStructure);
+
+    FSMC_NORSRAMCmd(FSMC_Bank1_NORSRAM2, ENABLE);
+}
+
+#endif
+
+/**
+ * Enables the NOR and copies the hot functions to the RAM, before any of
+ * them is called.
+ */
+void CodePlacementInit(void)
+{
+    const uint32_t *source = &_siramfunc;
+    uint32_t *destination = &_sramfunc;
+
+#if CODE_PLACEMENT_NOR
+    CodePlacementConfigureNOR();
+#endif
+
+    while (destination < &_eramfunc)
+    {
+        *destination++ = *source++;
+    }
+
+    //the functions copied are fetched from the RAM, not from a stale prefetch
+    __DSB();
+    __ISB();
+}
+
+#else
+
+void CodePlacementInit(void)
+{
+}
+
+#endif
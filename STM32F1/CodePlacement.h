@@ -0,0 +1,81 @@
+/**
+ *  @file       CodePlacement.h
+ *  @author     Luis Maduro
+ *  @version    1.00
+ *  @date       14/10/2026
+ *  @brief      Cold code executed in place from the FSMC NOR, hot functions
+ *              copied to the SRAM.
+ *
+ *  A large application keeps in the internal flash only what does not fit
+ *  elsewhere: the code run rarely (initialization, menus, commands) goes to
+ *  the NOR of bank 1 NOR/SRAM2, which fetches much slower, and the code run
+ *  at every interrupt or every byte (the handlers, the copies to the USB
+ *  packet memory, the FIFOs) runs from the SRAM, faster than the flash and
+ *  its wait states.
+ *
+ *  The placement is done by the linker, with CodePlacement.ld included in
+ *  the SECTIONS of the linker script before .text:
+ *  - .ramfunc is linked in the RAM and loaded in the flash, it takes the
+ *    functions marked RAM_FUNCTION and, built with -ffunction-sections, the
+ *    hot functions of the drivers listed in CodePlacement.ld by name, with
+ *    no change to their sources;
+ *  - .nortext is linked and loaded in the NOR, programmed with the flash
+ *    loader of the STM3210E-EVAL (FSMC/NOR_CodeExecute/binary), it takes the
+ *    functions marked NOR_FUNCTION and the objects listed there.
+ *  The MEMORY of the script must have a NOR region.
+ *
+ *  CodePlacementInit() is called first in main(), before any of those
+ *  functions: it enables the FSMC for the NOR and copies .ramfunc to the
+ *  RAM. A function of the NOR must not be called from an interrupt enabled
+ *  before it.
+ *
+ *  The three regions are further apart than the range of a BL, the calls
+ *  between them go through the veneers added by the linker, or are long
+ *  calls for the functions declared with these macros.
+ *
+ *  Copyright (C) 2026  Luis Maduro
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef CODEPLACEMENT_H
+#define CODEPLACEMENT_H
+
+#include <stm32f10x.h>
+
+/**Define to 0 to keep all the code in the internal flash, the macros
+ then place nothing.*/
+#ifndef USE_CODE_PLACEMENT
+#define USE_CODE_PLACEMENT          1
+#endif
+
+/**Configure the FSMC for the NOR in CodePlacementInit(), 0 when the
+ application is run with no NOR code.*/
+#ifndef CODE_PLACEMENT_NOR
+#define CODE_PLACEMENT_NOR          1
+#endif
+
+#if USE_CODE_PLACEMENT
+/**Runs the function from the SRAM.*/
+#define RAM_FUNCTION                __attribute__((section(".ramfunc"), noinline, long_call))
+/**Runs the function in place from the NOR.*/
+#define NOR_FUNCTION                __attribute__((section(".nortext"), noinline, long_call))
+#else
+#define RAM_FUNCTION
+#define NOR_FUNCTION
+#endif
+
+void CodePlacementInit(void);
+
+#endif /* CODEPLACEMENT_H */
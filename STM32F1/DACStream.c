@@ -0,0 +1,385 @@
+/**
+ *  @file       DACStream.c
+ *  @author     Luis Maduro
+ *  @version    1.00
+ *  @date       14/10/2026
+ *  @brief      DAC waveform streaming by DMA from a ping-pong buffer.
+ *
+ *  Copyright (C) 2026  Luis Maduro
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <stddef.h>
+#include "DACStream.h"
+#include "PowerManager.h"
+
+#ifdef STM32F10X_CL
+#define DAC_STREAM_DMA2_CHANNEL4_IRQn   DMA2_Channel4_IRQn
+#else
+#define DAC_STREAM_DMA2_CHANNEL4_IRQn   DMA2_Channel4_5_IRQn
+#endif
+
+static tDACStreamConfig stream;
+static DMA_Channel_TypeDef *streamDMA;
+static uint32_t streamHT;
+static uint32_t streamTC;
+/**Half-words of a frame, 1 or 2 in dual mode.*/
+static unsigned int frameSamples;
+/**Frames per second given by the timer.*/
+static uint32_t streamRate;
+/**Halves filled and not played yet.*/
+static volatile uint8_t ready[2];
+/**Next half to be filled, the halves are filled in the order they play.*/
+static volatile uint8_t fillHalf;
+/**Last half of the waveform, -1 until it is given.*/
+static volatile int8_t endHalf;
+static volatile bool playing;
+static volatile unsigned int underruns;
+
+/**
+ * Sets TIM6 to give a trigger (TRGO on update) at a rate.
+ * @return Rate given, the nearest one below.
+ */
+static uint32_t DACStreamConfigureTimer(uint32_t rate)
+{
+    TIM_TimeBaseInitTypeDef TIM_TimeBaseStructure;
+    RCC_ClocksTypeDef clocks;
+    uint32_t clock;
+    uint32_t ticks;
+    uint16_t prescaler;
+
+    RCC_GetClocksFreq(&clocks);
+
+    //the timers of APB1 run at twice PCLK1 when APB1 is divided
+    clock = clocks.PCLK1_Frequency;
+    if (RCC->CFGR & RCC_CFGR_PPRE1_2)
+    {
+        clock *= 2;
+    }
+
+    ticks = clock / rate;
+    prescaler = (uint16_t) ((ticks - 1) >> 16);
+    ticks /= prescaler + 1;
+
+    TIM_DeInit(TIM6);
+    TIM_TimeBaseStructInit(&TIM_TimeBaseStructure);
+    TIM_TimeBaseStructure.TIM_Period = (uint16_t) (ticks - 1);
+    TIM_TimeBaseStructure.TIM_Prescaler = prescaler;
+    TIM_TimeBaseInit(TIM6, &TIM_TimeBaseStructure);
+
+    TIM_SelectOutputTrigger(TIM6, TIM_TRGOSource_Update);
+
+    return clock / ((prescaler + 1) * ticks);
+}
+
+/**
+ * Configures the DAC, the DMA and the timer of a stream, stopped.
+ * @param config Stream, it is copied.
+ * @return False if the configuration is not valid.
+ */
+bool DACStreamInit(const tDACStreamConfig *config)
+{
+    GPIO_InitTypeDef GPIO_InitStructure;
+    DMA_InitTypeDef DMA_InitStructure;
+    DAC_InitTypeDef DAC_InitStructure;
+    NVIC_InitTypeDef NVIC_InitStructure;
+
+    if (config->channels < DAC_STREAM_CHANNEL_1 ||
+        config->channels > DAC_STREAM_CHANNEL_BOTH ||
+        config->buffer == NULL || config->frames == 0 || config->rate == 0 ||
+        2UL * config->frames > 0xFFFF)
+    {
+        return false;
+    }
+
+    DACStreamStop();
+
+    stream = *config;
+    frameSamples = (stream.channels == DAC_STREAM_CHANNEL_BOTH) ? 2 : 1;
+
+    RCC_AHBPeriphClockCmd(RCC_AHBPeriph_DMA2, ENABLE);
+    RCC_APB1PeriphClockCmd(RCC_APB1Periph_DAC | RCC_APB1Periph_TIM6, ENABLE);
+    RCC_APB2PeriphClockCmd(RCC_APB2Periph_GPIOA, ENABLE);
+
+    //analog to avoid the parasitic consumption of the pins
+    GPIO_InitStructure.GPIO_Pin = 0;
+    if (stream.channels & DAC_STREAM_CHANNEL_1)
+    {
+        GPIO_InitStructure.GPIO_Pin |= GPIO_Pin_4;
+    }
+    if (stream.channels & DAC_STREAM_CHANNEL_2)
+    {
+        GPIO_InitStructure.GPIO_Pin |= GPIO_Pin_5;
+    }
+    GPIO_InitStructure.GPIO_Mode = GPIO_Mode_AIN;
+    GPIO_InitStructure.GPIO_Speed = GPIO_Speed_50MHz;
+    GPIO_Init(GPIOA, &GPIO_InitStructure);
+
+    streamRate = DACStreamConfigureTimer(stream.rate);
+
+    DAC_InitStructure.DAC_Trigger = DAC_Trigger_T6_TRGO;
+    DAC_InitStructure.DAC_WaveGeneration = DAC_WaveGeneration_None;
+    DAC_InitStructure.DAC_LFSRUnmask_TriangleAmplitude = DAC_LFSRUnmask_Bit0;
+    DAC_InitStructure.DAC_OutputBuffer = stream.outputBuffer ? DAC_OutputBuffer_Enable : DAC_OutputBuffer_Disable;
+
+    //channel 1 requests DMA2 channel 3, channel 2 DMA2 channel 4
+    if (stream.channels == DAC_STREAM_CHANNEL_1)
+    {
+        streamDMA = DMA2_Channel3;
+        streamHT = DMA2_IT_HT3;
+        streamTC = DMA2_IT_TC3;
+        NVIC_InitStructure.NVIC_IRQChannel = DMA2_Channel3_IRQn;
+        DMA_InitStructure.DMA_PeripheralBaseAddr = (uint32_t) &DAC->DHR12R1;
+    }
+    else
+    {
+        streamDMA = DMA2_Channel4;
+        streamHT = DMA2_IT_HT4;
+        streamTC = DMA2_IT_TC4;
+        NVIC_InitStructure.NVIC_IRQChannel = DAC_STREAM_DMA2_CHANNEL4_IRQn;
+        DMA_InitStructure.DMA_PeripheralBaseAddr = (stream.channels == DAC_STREAM_CHANNEL_2) ?
+                (uint32_t) &DAC->DHR12R2 : (uint32_t) &DAC->DHR12RD;
+    }
+
+    DMA_DeInit(streamDMA);
+    DMA_InitStructure.DMA_MemoryBaseAddr = (uint32_t) stream.buffer;
+    DMA_InitStructure.DMA_DIR = DMA_DIR_PeripheralDST;
+    DMA_InitStructure.DMA_BufferSize = 2 * stream.frames;
+    DMA_InitStructure.DMA_PeripheralInc = DMA_PeripheralInc_Disable;
+    DMA_InitStructure.DMA_MemoryInc = DMA_MemoryInc_Enable;
+    //both channels are written at once by a word in dual mode
+    DMA_InitStructure.DMA_PeripheralDataSize = (frameSamples == 2) ? DMA_PeripheralDataSize_Word : DMA_PeripheralDataSize_HalfWord;
+    DMA_InitStructure.DMA_MemoryDataSize = (frameSamples == 2) ? DMA_MemoryDataSize_Word : DMA_MemoryDataSize_HalfWord;
+    DMA_InitStructure.DMA_Mode = DMA_Mode_Circular;
+    DMA_InitStructure.DMA_Priority = DMA_Priority_High;
+    DMA_InitStructure.DMA_M2M = DMA_M2M_Disable;
+    DMA_Init(streamDMA, &DMA_InitStructure);
+    DMA_ITConfig(streamDMA, DMA_IT_HT | DMA_IT_TC, ENABLE);
+
+    if (stream.channels & DAC_STREAM_CHANNEL_1)
+    {
+        DAC_Init(DAC_Channel_1, &DAC_InitStructure);
+        DAC_Cmd(DAC_Channel_1, ENABLE);
+    }
+    if (stream.channels & DAC_STREAM_CHANNEL_2)
+    {
+        DAC_Init(DAC_Channel_2, &DAC_InitStructure);
+        DAC_Cmd(DAC_Channel_2, ENABLE);
+    }
+    DAC_DMACmd((stream.channels == DAC_STREAM_CHANNEL_1) ? DAC_Channel_1 : DAC_Channel_2, ENABLE);
+
+    NVIC_InitStructure.NVIC_IRQChannelPreemptionPriority = DAC_STREAM_IRQ_PRIORITY;
+    NVIC_InitStructure.NVIC_IRQChannelSubPriority = 0;
+    NVIC_InitStructure.NVIC_IRQChannelCmd = ENABLE;
+    NVIC_Init(&NVIC_InitStructure);
+
+    return true;
+}
+
+/**
+ * Gives the rate the timer plays at, the nearest one below the rate asked
+ * for.
+ * @return Frames per second.
+ */
+uint32_t DACStreamGetRate(void)
+{
+    return streamRate;
+}
+
+/**
+ * Gives the next half to be filled by the application.
+ * @return First frame of the half, NULL if both halves are filled or the
+ * end was given.
+ */
+uint16_t *DACStreamGetHalf(void)
+{
+    if (ready[fillHalf] || endHalf >= 0)
+    {
+        return NULL;
+    }
+
+    return stream.buffer + fillHalf * stream.frames * frameSamples;
+}
+
+/**
+ * Gives back the half of DACStreamGetHalf() or of the fill function. A half
+ * not full is the end of the waveform, it is completed with its last frame.
+ * @param frames Frames written.
+ */
+void DACStreamCommit(unsigned int frames)
+{
+    uint16_t *half = stream.buffer + fillHalf * stream.frames * frameSamples;
+    const uint16_t *last;
+    unsigned int i;
+
+    if (frames < stream.frames)
+    {
+        //no frame at all holds the last one of the other half
+        last = frames ? half + (frames - 1) * frameSamples :
+                stream.buffer + ((fillHalf ^ 1) + 1) * stream.frames * frameSamples - frameSamples;
+
+        for (i = frames * frameSamples; i < stream.frames * frameSamples; i++)
+        {
+            half[i] = last[i % frameSamples];
+        }
+
+        endHalf = fillHalf;
+    }
+
+    ready[fillHalf] = 1;
+    fillHalf ^= 1;
+}
+
+/**
+ * Fills the next half with the fill function.
+ */
+static void DACStreamFill(void)
+{
+    uint16_t *half = DACStreamGetHalf();
+
+    if (half != NULL)
+    {
+        DACStreamCommit(stream.fill(half, stream.frames));
+    }
+}
+
+/**
+ * Starts playing from the first half. With a fill function both halves are
+ * filled first, otherwise the application already filled at least the
+ * first one.
+ * @return False if the first half is not filled.
+ */
+bool DACStreamStart(void)
+{
+    if (stream.fill != NULL)
+    {
+        DACStreamFill();
+        DACStreamFill();
+    }
+
+    if (!ready[0])
+    {
+        return false;
+    }
+
+    underruns = 0;
+
+    if (!playing)
+    {
+        playing = true;
+#ifdef USE_POWER_MANAGER
+        PowerManagerKeepAwake(POWER_MODE_STOP);
+#endif
+    }
+
+    DMA_Cmd(streamDMA, DISABLE);
+    DMA_SetCurrDataCounter(streamDMA, 2 * stream.frames);
+    DMA_ClearITPendingBit(streamHT | streamTC);
+    DMA_Cmd(streamDMA, ENABLE);
+
+    TIM_SetCounter(TIM6, 0);
+    TIM_Cmd(TIM6, ENABLE);
+
+    return true;
+}
+
+/**
+ * Stops playing, the output holds the last sample converted. The halves
+ * are all free again.
+ */
+void DACStreamStop(void)
+{
+    TIM_Cmd(TIM6, DISABLE);
+    if (streamDMA != NULL)
+    {
+        DMA_Cmd(streamDMA, DISABLE);
+    }
+
+    if (playing)
+    {
+        playing = false;
+#ifdef USE_POWER_MANAGER
+        PowerManagerAllow(POWER_MODE_STOP);
+#endif
+    }
+
+    ready[0] = 0;
+    ready[1] = 0;
+    fillHalf = 0;
+    endHalf = -1;
+}
+
+/**
+ * Tells if the stream is playing, it stops by itself at the end of the
+ * waveform.
+ * @return True while playing.
+ */
+bool DACStreamIsPlaying(void)
+{
+    return playing;
+}
+
+/**
+ * Gives the halves the application was late for, they were played again.
+ * @return Underruns since the start.
+ */
+unsigned int DACStreamGetUnderruns(void)
+{
+    return underruns;
+}
+
+/**
+ * Frees a half played.
+ */
+static void DACStreamHalfPlayed(uint8_t half)
+{
+    ready[half] = 0;
+
+    if (endHalf == half)
+    {
+        DACStreamStop();
+        return;
+    }
+
+    if (!ready[half ^ 1])
+    {
+        underruns++;
+    }
+
+    if (stream.fill != NULL)
+    {
+        DACStreamFill();
+    }
+}
+
+/**
+ * This funtion is intended to be put in DMA2_Channel3_IRQHandler() for
+ * channel 1, or in DMA2_Channel4_5_IRQHandler() (DMA2_Channel4_IRQHandler()
+ * on the connectivity line) for channel 2 and dual mode.
+ */
+void DACStreamInterruptHandler(void)
+{
+    if (DMA_GetITStatus(streamHT) != RESET)
+    {
+        DMA_ClearITPendingBit(streamHT);
+        DACStreamHalfPlayed(0);
+    }
+
+    if (DMA_GetITStatus(streamTC) != RESET)
+    {
+        DMA_ClearITPendingBit(streamTC);
+        DACStreamHalfPlayed(1);
+    }
+}
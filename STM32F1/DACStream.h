@@ -0,0 +1,108 @@
+/**
+ *  @file       DACStream.h
+ *  @author     Luis Maduro
+ *  @version    1.00
+ *  @date       14/10/2026
+ *  @brief      DAC waveform streaming by DMA from a ping-pong buffer.
+ *
+ *  TIM6 triggers a conversion of the DAC at a fixed rate and DMA2 moves the
+ *  next sample from a circular buffer of two halves. The half transfer and
+ *  transfer complete interrupts free the half just played, which is refilled
+ *  while the DMA plays the other one, so a waveform of any length plays
+ *  without a gap.
+ *
+ *  A half is refilled in one of two ways:
+ *  - by the fill function, from the interrupt, for waveforms synthesised by
+ *    the CPU (wavetables, sweeps);
+ *  - without fill function, by the application out of the interrupt: it
+ *    polls DACStreamGetHalf() and gives the half back with
+ *    DACStreamCommit(). This is the read-ahead of waveforms stored in SPI
+ *    flash or in a SD card, which can not be read from an interrupt. The
+ *    read of a half must take less time than playing a half.
+ *
+ *  A half given with less frames than its size is completed with its last
+ *  sample, the stream stops at the end of it and the output holds that
+ *  level.
+ *
+ *  A frame is a 12 bit right aligned half-word, or two in dual mode, the
+ *  sample of channel 1 then the one of channel 2, and the buffer must then be
+ *  4 byte aligned. Channel 1 is PA4 and channel 2 PA5, which is also the
+ *  clock of SPI1.
+ *
+ *  Only the devices with DMA2 (high density, XL density and connectivity
+ *  line) have the DAC.
+ *
+ *  Copyright (C) 2026  Luis Maduro
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef DACSTREAM_H
+#define DACSTREAM_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stm32f10x.h>
+
+/**Priority of the DMA2 channel 3 or 4 interrupt.*/
+#ifndef DAC_STREAM_IRQ_PRIORITY
+#define DAC_STREAM_IRQ_PRIORITY     1
+#endif
+
+/**Channels of a stream.*/
+#define DAC_STREAM_CHANNEL_1        1
+#define DAC_STREAM_CHANNEL_2        2
+#define DAC_STREAM_CHANNEL_BOTH     3
+
+/**
+ * Called from the interrupt with a free half of the buffer.
+ * @param samples First frame of the half.
+ * @param frames Frames of the half.
+ * @return Frames written, less than frames for the end of the waveform.
+ */
+typedef unsigned int (*tDACStreamFill)(uint16_t *samples, unsigned int frames);
+
+/**
+ * Configuration of a stream.
+ */
+typedef struct
+{
+    /**DAC_STREAM_CHANNEL_1, DAC_STREAM_CHANNEL_2 or DAC_STREAM_CHANNEL_BOTH.*/
+    uint8_t channels;
+    /**Not 0 to enable the output buffer of the DAC.*/
+    uint8_t outputBuffer;
+    /**Frames per second.*/
+    uint32_t rate;
+    /**Buffer of the two halves, 2 * frames half-words (4 * frames in dual
+     mode).*/
+    uint16_t *buffer;
+    /**Frames of a half. The DMA counts up to 65535 transfers for the whole
+     buffer.*/
+    uint16_t frames;
+    /**Fills the halves from the interrupt, NULL if the application fills
+     them with DACStreamGetHalf() and DACStreamCommit().*/
+    tDACStreamFill fill;
+} tDACStreamConfig;
+
+bool DACStreamInit(const tDACStreamConfig *config);
+uint32_t DACStreamGetRate(void);
+bool DACStreamStart(void);
+void DACStreamStop(void);
+bool DACStreamIsPlaying(void);
+uint16_t *DACStreamGetHalf(void);
+void DACStreamCommit(unsigned int frames);
+unsigned int DACStreamGetUnderruns(void);
+void DACStreamInterruptHandler(void);
+
+#endif /* DACSTREAM_H */
@@ -0,0 +1,280 @@
+/**
+ *  @file       DMAManager.c
+ *  @author     Luis Maduro
+ *  @version    1.00
+ *  @date       14/10/2026
+ *  @brief      Owner of the DMA channels, shared by the drivers one transfer
+ *              at a time.
+ *
+ *  Copyright (C) 2026  Luis Maduro
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <stddef.h>
+#include "DMAManager.h"
+
+typedef struct
+{
+    /**User owning the channel, NULL when it is free.*/
+    tDMAManagerUser *owner;
+    /**The owner keeps the channel for a stream.*/
+    bool reserved;
+    /**Users waiting, by priority.*/
+    tDMAManagerUser *waiting;
+} tDMAManagerChannel;
+
+tDMAManagerStatistics DMAManagerStatistics;
+
+static tDMAManagerChannel channels[DMA_MANAGER_CHANNELS];
+
+static DMA_Channel_TypeDef * const registers[DMA_MANAGER_CHANNELS] = {
+    DMA1_Channel1, DMA1_Channel2, DMA1_Channel3, DMA1_Channel4,
+    DMA1_Channel5, DMA1_Channel6, DMA1_Channel7,
+#ifdef DMA_MANAGER_USE_DMA2
+    DMA2_Channel1, DMA2_Channel2, DMA2_Channel3, DMA2_Channel4,
+    DMA2_Channel5,
+#endif
+};
+
+/**
+ * Frees all the channels, before the drivers are initialized.
+ */
+void DMAManagerInit(void)
+{
+    unsigned int i;
+
+    for (i = 0; i < DMA_MANAGER_CHANNELS; i++)
+    {
+        channels[i].owner = NULL;
+        channels[i].reserved = false;
+        channels[i].waiting = NULL;
+    }
+
+    DMAManagerStatistics.Granted = 0;
+    DMAManagerStatistics.Waited = 0;
+    DMAManagerStatistics.Refused = 0;
+}
+
+/**
+ * Puts a user in the waiting list of its channel, after the users of the
+ * same priority.
+ */
+static void DMAManagerWait(tDMAManagerChannel *channel, tDMAManagerUser *user)
+{
+    tDMAManagerUser **link = &channel->waiting;
+
+    while (*link != NULL)
+    {
+        if (*link == user)
+            return;
+
+        if ((*link)->priority < user->priority)
+            break;
+
+        link = &(*link)->next;
+    }
+
+    user->next = *link;
+    *link = user;
+}
+
+/**
+ * Takes the channel of a user for a transfer, or puts the user in the
+ * waiting list. The caller owns the channel again when it already owns it.
+ * @param user User.
+ * @return DMA_MANAGER_GRANTED if the channel is owned, DMA_MANAGER_WAITING
+ *         if its granted callback will be called, DMA_MANAGER_RESERVED if a
+ *         stream keeps the channel.
+ */
+tDMAManagerStatus DMAManagerAcquire(tDMAManagerUser *user)
+{
+    tDMAManagerChannel *channel = &channels[user->channel];
+    tDMAManagerStatus status;
+    uint32_t primask;
+
+    //the releases come from the interrupts
+    primask = __get_PRIMASK();
+    __disable_irq();
+
+    if (channel->owner == NULL || channel->owner == user)
+    {
+        channel->owner = user;
+        DMAManagerStatistics.Granted++;
+        status = DMA_MANAGER_GRANTED;
+    }
+    else if (channel->reserved)
+    {
+        DMAManagerStatistics.Refused++;
+        status = DMA_MANAGER_RESERVED;
+    }
+    else
+    {
+        DMAManagerWait(channel, user);
+        status = DMA_MANAGER_WAITING;
+    }
+
+    __set_PRIMASK(primask);
+
+    return status;
+}
+
+/**
+ * Takes the channel of a user only if it is free, for a transfer the
+ * driver waits for.
+ * @param user User.
+ * @return True if the channel is owned.
+ */
+bool DMAManagerTryAcquire(tDMAManagerUser *user)
+{
+    tDMAManagerChannel *channel = &channels[user->channel];
+    bool owned = false;
+    uint32_t primask;
+
+    primask = __get_PRIMASK();
+    __disable_irq();
+
+    if (channel->owner == NULL || channel->owner == user)
+    {
+        channel->owner = user;
+        DMAManagerStatistics.Granted++;
+        owned = true;
+    }
+    else
+    {
+        DMAManagerStatistics.Refused++;
+    }
+
+    __set_PRIMASK(primask);
+
+    return owned;
+}
+
+/**
+ * Takes the channel of a user until DMAManagerRelease(), for a circular
+ * transfer. The waiting users are not served meanwhile, the new ones are
+ * refused.
+ * @param user User.
+ * @return False if the channel is owned by another user.
+ */
+bool DMAManagerReserve(tDMAManagerUser *user)
+{
+    tDMAManagerChannel *channel = &channels[user->channel];
+    bool owned = false;
+    uint32_t primask;
+
+    primask = __get_PRIMASK();
+    __disable_irq();
+
+    if (channel->owner == NULL || channel->owner == user)
+    {
+        channel->owner = user;
+        channel->reserved = true;
+        DMAManagerStatistics.Granted++;
+        owned = true;
+    }
+    else
+    {
+        DMAManagerStatistics.Refused++;
+    }
+
+    __set_PRIMASK(primask);
+
+    return owned;
+}
+
+/**
+ * Gives back the channel of a user, or takes the user out of the waiting
+ * list. The channel goes to the waiting user of the highest priority, its
+ * granted callback is called before the return.
+ * @param user User.
+ */
+void DMAManagerRelease(tDMAManagerUser *user)
+{
+    tDMAManagerChannel *channel = &channels[user->channel];
+    tDMAManagerUser **link;
+    tDMAManagerUser *next = NULL;
+    uint32_t primask;
+
+    primask = __get_PRIMASK();
+    __disable_irq();
+
+    if (channel->owner == user)
+    {
+        next = channel->waiting;
+        channel->owner = next;
+        channel->reserved = false;
+
+        if (next != NULL)
+        {
+            channel->waiting = next->next;
+            DMAManagerStatistics.Waited++;
+        }
+    }
+    else
+    {
+        for (link = &channel->waiting; *link != NULL; link = &(*link)->next)
+        {
+            if (*link == user)
+            {
+                *link = user->next;
+                break;
+            }
+        }
+    }
+
+    __set_PRIMASK(primask);
+
+    //the new owner starts its transfer out of the critical section
+    if (next != NULL && next->granted != NULL)
+    {
+        next->granted(next);
+    }
+}
+
+/**
+ * Tells if a user owns its channel.
+ * @param user User.
+ * @return True if it owns it.
+ */
+bool DMAManagerIsOwner(const tDMAManagerUser *user)
+{
+    return channels[user->channel].owner == user;
+}
+
+/**
+ * Gives the registers of a channel.
+ * @param channel A DMA_REQUEST_ or a DMA_CHANNEL_ value.
+ * @return The channel, i.e. DMA1_Channel2.
+ */
+DMA_Channel_TypeDef *DMAManagerChannel(uint8_t channel)
+{
+    return registers[channel];
+}
+
+/**
+ * This funtion is intended to be put in the DMAx_Channely_IRQHandler() of
+ * the shared channels, it calls the interrupt callback of the owner. The
+ * flags of the channel are checked and cleared by the callback.
+ * @param channel DMA_CHANNEL_ value of the handler.
+ */
+void DMAManagerInterruptHandler(uint8_t channel)
+{
+    tDMAManagerUser *owner = channels[channel].owner;
+
+    if (owner != NULL && owner->interrupt != NULL)
+    {
+        owner->interrupt();
+    }
+}
@@ -0,0 +1,191 @@
+/**
+ *  @file       DMAManager.h
+ *  @author     Luis Maduro
+ *  @version    1.00
+ *  @date       14/10/2026
+ *  @brief      Owner of the DMA channels, shared by the drivers one transfer
+ *              at a time.
+ *
+ *  The request lines of the peripherals are wired to fixed channels, listed
+ *  by the DMA_REQUEST_ macros below: SPI1 RX and USART3 TX both need
+ *  channel 2 of DMA1, I2C1 and USART2 channels 6 and 7. A driver describes
+ *  its use of a channel with a tDMAManagerUser and takes the channel before
+ *  it configures it:
+ *  - DMAManagerAcquire() for a transfer, the channel is given back with
+ *    DMAManagerRelease() when it ends. When the channel is busy the user
+ *    waits, the waiting user of the highest priority gets the channel on
+ *    the next release and its granted callback starts its transfer, so the
+ *    users of a channel take turns by transfers;
+ *  - DMAManagerTryAcquire() for a blocking transfer, it never waits, the
+ *    driver moves the data without DMA when the channel is busy;
+ *  - DMAManagerReserve() for a circular stream (ADC, DAC, captures), the
+ *    channel is kept until DMAManagerRelease(), the users that would wait
+ *    are refused meanwhile, the ones already waiting wait for the release.
+ *  A driver that takes two channels, i.e. the RX and the TX of a bus, takes
+ *  the lower one first, so two such drivers do not wait for each other.
+ *
+ *  The interrupt of a channel goes to its owner: DMAManagerInterruptHandler()
+ *  is put in the DMAx_Channely_IRQHandler() and calls the interrupt callback
+ *  of the user owning the channel. The channel registers are DeInit by the
+ *  driver under the new owner, the priority of the channel in the DMA
+ *  controller stays the one of the DMA_Init() of the driver.
+ *
+ *  With USE_DMA_MANAGER defined, the drivers of this directory that share
+ *  their channels do it through this file.
+ *
+ *  Copyright (C) 2026  Luis Maduro
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef DMAMANAGER_H
+#define DMAMANAGER_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stm32f10x.h>
+
+/**Uncomment for the drivers to take their channels from the manager.*/
+//#define USE_DMA_MANAGER
+
+#if defined(STM32F10X_HD) || defined(STM32F10X_HD_VL) || defined(STM32F10X_XL) || defined(STM32F10X_CL)
+#define DMA_MANAGER_USE_DMA2
+#endif
+
+/**Channels, DMA1 then DMA2.*/
+#define DMA_CHANNEL_DMA1_1          0
+#define DMA_CHANNEL_DMA1_2          1
+#define DMA_CHANNEL_DMA1_3          2
+#define DMA_CHANNEL_DMA1_4          3
+#define DMA_CHANNEL_DMA1_5          4
+#define DMA_CHANNEL_DMA1_6          5
+#define DMA_CHANNEL_DMA1_7          6
+#define DMA_CHANNEL_DMA2_1          7
+#define DMA_CHANNEL_DMA2_2          8
+#define DMA_CHANNEL_DMA2_3          9
+#define DMA_CHANNEL_DMA2_4          10
+#define DMA_CHANNEL_DMA2_5          11
+
+#ifdef DMA_MANAGER_USE_DMA2
+#define DMA_MANAGER_CHANNELS        12
+#else
+#define DMA_MANAGER_CHANNELS        7
+#endif
+
+/**Channel of each request line, the table of the reference manual.*/
+#define DMA_REQUEST_ADC1            DMA_CHANNEL_DMA1_1
+#define DMA_REQUEST_TIM2_CH3        DMA_CHANNEL_DMA1_1
+#define DMA_REQUEST_TIM4_CH1        DMA_CHANNEL_DMA1_1
+#define DMA_REQUEST_SPI1_RX         DMA_CHANNEL_DMA1_2
+#define DMA_REQUEST_USART3_TX       DMA_CHANNEL_DMA1_2
+#define DMA_REQUEST_TIM1_CH1        DMA_CHANNEL_DMA1_2
+#define DMA_REQUEST_TIM2_UP         DMA_CHANNEL_DMA1_2
+#define DMA_REQUEST_TIM3_CH3        DMA_CHANNEL_DMA1_2
+#define DMA_REQUEST_SPI1_TX         DMA_CHANNEL_DMA1_3
+#define DMA_REQUEST_USART3_RX       DMA_CHANNEL_DMA1_3
+#define DMA_REQUEST_TIM1_CH2        DMA_CHANNEL_DMA1_3
+#define DMA_REQUEST_TIM3_CH4        DMA_CHANNEL_DMA1_3
+#define DMA_REQUEST_TIM3_UP         DMA_CHANNEL_DMA1_3
+#define DMA_REQUEST_SPI2_RX         DMA_CHANNEL_DMA1_4
+#define DMA_REQUEST_USART1_TX       DMA_CHANNEL_DMA1_4
+#define DMA_REQUEST_I2C2_TX         DMA_CHANNEL_DMA1_4
+#define DMA_REQUEST_TIM1_CH4        DMA_CHANNEL_DMA1_4
+#define DMA_REQUEST_TIM4_CH2        DMA_CHANNEL_DMA1_4
+#define DMA_REQUEST_SPI2_TX         DMA_CHANNEL_DMA1_5
+#define DMA_REQUEST_USART1_RX       DMA_CHANNEL_DMA1_5
+#define DMA_REQUEST_I2C2_RX         DMA_CHANNEL_DMA1_5
+#define DMA_REQUEST_TIM1_UP         DMA_CHANNEL_DMA1_5
+#define DMA_REQUEST_TIM2_CH1        DMA_CHANNEL_DMA1_5
+#define DMA_REQUEST_TIM4_CH3        DMA_CHANNEL_DMA1_5
+#define DMA_REQUEST_USART2_RX       DMA_CHANNEL_DMA1_6
+#define DMA_REQUEST_I2C1_TX         DMA_CHANNEL_DMA1_6
+#define DMA_REQUEST_TIM1_CH3        DMA_CHANNEL_DMA1_6
+#define DMA_REQUEST_TIM3_CH1        DMA_CHANNEL_DMA1_6
+#define DMA_REQUEST_USART2_TX       DMA_CHANNEL_DMA1_7
+#define DMA_REQUEST_I2C1_RX         DMA_CHANNEL_DMA1_7
+#define DMA_REQUEST_TIM2_CH2        DMA_CHANNEL_DMA1_7
+#define DMA_REQUEST_TIM2_CH4        DMA_CHANNEL_DMA1_7
+#define DMA_REQUEST_TIM4_UP         DMA_CHANNEL_DMA1_7
+#define DMA_REQUEST_SPI3_RX         DMA_CHANNEL_DMA2_1
+#define DMA_REQUEST_TIM5_CH4        DMA_CHANNEL_DMA2_1
+#define DMA_REQUEST_TIM8_UP         DMA_CHANNEL_DMA2_1
+#define DMA_REQUEST_SPI3_TX         DMA_CHANNEL_DMA2_2
+#define DMA_REQUEST_TIM5_UP         DMA_CHANNEL_DMA2_2
+#define DMA_REQUEST_TIM8_CH4        DMA_CHANNEL_DMA2_2
+#define DMA_REQUEST_UART4_RX        DMA_CHANNEL_DMA2_3
+#define DMA_REQUEST_DAC_CHANNEL1    DMA_CHANNEL_DMA2_3
+#define DMA_REQUEST_TIM8_CH1        DMA_CHANNEL_DMA2_3
+#define DMA_REQUEST_SDIO            DMA_CHANNEL_DMA2_4
+#define DMA_REQUEST_DAC_CHANNEL2    DMA_CHANNEL_DMA2_4
+#define DMA_REQUEST_TIM5_CH2        DMA_CHANNEL_DMA2_4
+#define DMA_REQUEST_UART4_TX        DMA_CHANNEL_DMA2_5
+#define DMA_REQUEST_ADC3            DMA_CHANNEL_DMA2_5
+#define DMA_REQUEST_TIM8_CH2        DMA_CHANNEL_DMA2_5
+
+/**
+ * Result of DMAManagerAcquire().
+ */
+typedef enum
+{
+    /**The channel is owned, the transfer can start.*/
+    DMA_MANAGER_GRANTED,
+    /**The user waits, its granted callback is called with the channel.*/
+    DMA_MANAGER_WAITING,
+    /**The channel is reserved by a stream, the user does not wait.*/
+    DMA_MANAGER_RESERVED
+} tDMAManagerStatus;
+
+/**
+ * A use of a channel by a driver, it must stay valid while it owns or waits
+ * for the channel.
+ */
+typedef struct _tDMAManagerUser
+{
+    /**Channel, a DMA_REQUEST_ or a DMA_CHANNEL_ value.*/
+    uint8_t channel;
+    /**Order of the waiting users, the highest first, equal ones by their
+     arrival.*/
+    uint8_t priority;
+    /**Called with the channel after a wait, from the DMAManagerRelease() of
+     the previous owner, which can be an interrupt. Can be NULL.*/
+    void (*granted)(struct _tDMAManagerUser *user);
+    /**Called from DMAManagerInterruptHandler() while the user owns the
+     channel, can be NULL.*/
+    void (*interrupt)(void);
+    /**Next waiting user.*/
+    struct _tDMAManagerUser *next;
+} tDMAManagerUser;
+
+typedef struct
+{
+    /**Channels given at once.*/
+    uint32_t Granted;
+    /**Channels given after a wait.*/
+    uint32_t Waited;
+    /**Requests refused, channel reserved or busy for DMAManagerTryAcquire().*/
+    uint32_t Refused;
+} tDMAManagerStatistics;
+
+extern tDMAManagerStatistics DMAManagerStatistics;
+
+void DMAManagerInit(void);
+tDMAManagerStatus DMAManagerAcquire(tDMAManagerUser *user);
+bool DMAManagerTryAcquire(tDMAManagerUser *user);
+bool DMAManagerReserve(tDMAManagerUser *user);
+void DMAManagerRelease(tDMAManagerUser *user);
+bool DMAManagerIsOwner(const tDMAManagerUser *user);
+DMA_Channel_TypeDef *DMAManagerChannel(uint8_t channel);
+void DMAManagerInterruptHandler(uint8_t channel);
+
+#endif /* DMAMANAGER_H */
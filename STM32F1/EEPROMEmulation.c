@@ -0,0 +1,343 @@
+/**
+ *  @file       EEPROMEmulation.c
+ *  @author     Luis Maduro
+ *  @version    1.00
+ *  @date       14/10/2026
+ *  @brief      16 bit variables kept in two pages of the internal flash.
+ *
+ *  Copyright (C) 2026  Luis Maduro
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "EEPROMEmulation.h"
+
+/**States of a page, in its first half-word. Each one is programmed over
+ the previous one, the flash takes 0x0000 over any value.*/
+#define EEPROM_PAGE_ERASED          0xFFFF
+#define EEPROM_PAGE_RECEIVE         0xEEEE
+#define EEPROM_PAGE_VALID           0x0000
+
+/**The state and a half-word left erased, the records are words.*/
+#define EEPROM_HEADER_SIZE          4
+#define EEPROM_RECORD_ERASED        0xFFFFFFFFUL
+/**Number of the variable of a move without a new value.*/
+#define EEPROM_NO_VARIABLE          0xFFFF
+
+/**Size of the flash in KB, in the device signature.*/
+#define EEPROM_FLASH_SIZE_KB        (*(const uint16_t *) 0x1FFFF7E0)
+
+tEEPROMEmulationStatistics EEPROMEmulationStatistics;
+
+static uint32_t pages[2];
+/**Page of the valid records.*/
+static uint8_t active;
+/**Address of the next record in the active page.*/
+static uint32_t nextRecord;
+/**Last values, and a bit per variable written.*/
+static uint16_t values[EEPROM_EMULATION_VARIABLES];
+static uint32_t written[(EEPROM_EMULATION_VARIABLES + 31) / 32];
+
+static uint16_t EEPROMPageState(uint8_t page)
+{
+    return *(const volatile uint16_t *) pages[page];
+}
+
+static bool EEPROMIsWritten(uint16_t variable)
+{
+    return (written[variable / 32] & (1UL << (variable % 32))) != 0;
+}
+
+static void EEPROMCache(uint16_t variable, uint16_t value)
+{
+    values[variable] = value;
+    written[variable / 32] |= 1UL << (variable % 32);
+}
+
+static bool EEPROMProgram(uint32_t address, uint16_t value)
+{
+    return FLASH_ProgramHalfWord(address, value) == FLASH_COMPLETE;
+}
+
+/**
+ * Erases a page, only if it is not blank: an erase stalls the CPU for
+ * tens of ms.
+ */
+static bool EEPROMErase(uint8_t page)
+{
+    const uint32_t *word = (const uint32_t *) pages[page];
+    const uint32_t *end = (const uint32_t *) (pages[page] + EEPROM_EMULATION_PAGE_SIZE);
+
+    while (word < end && *word == EEPROM_RECORD_ERASED)
+    {
+        word++;
+    }
+
+    if (word == end)
+        return true;
+
+    return FLASH_ErasePage(pages[page]) == FLASH_COMPLETE;
+}
+
+/**
+ * Puts the records of a page in the RAM copy, the later ones over the
+ * earlier ones.
+ * @return Address of the first free record.
+ */
+static uint32_t EEPROMScan(uint8_t page)
+{
+    uint32_t address = pages[page] + EEPROM_HEADER_SIZE;
+    uint32_t end = pages[page] + EEPROM_EMULATION_PAGE_SIZE;
+    uint32_t record;
+    uint16_t variable;
+
+    while (address < end)
+    {
+        record = *(const volatile uint32_t *) address;
+
+        //the records are appended, the first blank one ends them
+        if (record == EEPROM_RECORD_ERASED)
+            break;
+
+        variable = (uint16_t) (record >> 16);
+
+        //a number still erased is a record cut by a reset
+        if (variable < EEPROM_EMULATION_VARIABLES)
+            EEPROMCache(variable, (uint16_t) record);
+
+        address += 4;
+    }
+
+    return address;
+}
+
+/**
+ * Appends a record, the value first, a record with the number of the
+ * variable written is complete.
+ */
+static bool EEPROMAppend(uint32_t *address, uint16_t variable, uint16_t value)
+{
+    bool done;
+
+    done = EEPROMProgram(*address, value) && EEPROMProgram(*address + 2, variable);
+    *address += 4;
+
+    return done;
+}
+
+/**
+ * Moves the variables to the other page, with a new value for one of them.
+ * @param variable Variable written, EEPROM_NO_VARIABLE for none.
+ * @param value Its value.
+ */
+static bool EEPROMTransfer(uint16_t variable, uint16_t value)
+{
+    uint8_t target = active ^ 1;
+    uint32_t address = pages[target] + EEPROM_HEADER_SIZE;
+    uint16_t i;
+
+    if (!EEPROMErase(target) || !EEPROMProgram(pages[target], EEPROM_PAGE_RECEIVE))
+        return false;
+
+    if (variable != EEPROM_NO_VARIABLE && !EEPROMAppend(&address, variable, value))
+        return false;
+
+    for (i = 0; i < EEPROM_EMULATION_VARIABLES; i++)
+    {
+        if (i != variable && EEPROMIsWritten(i) && !EEPROMAppend(&address, i, values[i]))
+            return false;
+    }
+
+    //the old page is erased before the new one is valid, a reset in
+    //between leaves a RECEIVE page alone, complete
+    if (!EEPROMErase(active) || !EEPROMProgram(pages[target], EEPROM_PAGE_VALID))
+        return false;
+
+    active = target;
+    nextRecord = address;
+    EEPROMEmulationStatistics.Transfers++;
+
+    return true;
+}
+
+/**
+ * Erases both pages and starts with page 0, all the variables are lost.
+ * @return False on an error of the flash.
+ */
+static bool EEPROMFormat(void)
+{
+    unsigned int i;
+
+    for (i = 0; i < sizeof (written) / sizeof (written[0]); i++)
+    {
+        written[i] = 0;
+    }
+
+    active = 0;
+    nextRecord = pages[0] + EEPROM_HEADER_SIZE;
+
+    return EEPROMErase(0) && EEPROMErase(1) && EEPROMProgram(pages[0], EEPROM_PAGE_VALID);
+}
+
+/**
+ * Reads the variables from the pages into the RAM copy, and finishes a
+ * move cut by a reset. Pages in no valid state are formatted.
+ * @return False on an error of the flash.
+ */
+bool EEPROMEmulationInit(void)
+{
+    uint16_t state[2];
+    uint8_t other;
+    unsigned int i;
+    bool done = true;
+
+#ifdef EEPROM_EMULATION_PAGE0
+    pages[0] = EEPROM_EMULATION_PAGE0;
+#else
+    pages[0] = FLASH_BASE + (uint32_t) EEPROM_FLASH_SIZE_KB * 1024 - 2 * EEPROM_EMULATION_PAGE_SIZE;
+#endif
+    pages[1] = pages[0] + EEPROM_EMULATION_PAGE_SIZE;
+
+    for (i = 0; i < sizeof (written) / sizeof (written[0]); i++)
+    {
+        written[i] = 0;
+    }
+
+    state[0] = EEPROMPageState(0);
+    state[1] = EEPROMPageState(1);
+
+    FLASH_Unlock();
+
+    if (state[0] == EEPROM_PAGE_VALID || state[1] == EEPROM_PAGE_VALID)
+    {
+        active = (state[0] == EEPROM_PAGE_VALID) ? 0 : 1;
+        other = active ^ 1;
+
+        if (state[other] == EEPROM_PAGE_VALID)
+        {
+            done = EEPROMFormat();
+        }
+        else if (state[other] == EEPROM_PAGE_RECEIVE)
+        {
+            //cut during the copy: the records already moved are the newest
+            nextRecord = EEPROMScan(active);
+            EEPROMScan(other);
+            done = EEPROMTransfer(EEPROM_NO_VARIABLE, 0);
+        }
+        else
+        {
+            nextRecord = EEPROMScan(active);
+            done = EEPROMErase(other);
+        }
+    }
+    else if (state[0] == EEPROM_PAGE_RECEIVE && state[1] != EEPROM_PAGE_RECEIVE)
+    {
+        //cut after the copy, during the erase of the old page
+        active = 0;
+        nextRecord = EEPROMScan(0);
+        done = EEPROMErase(1) && EEPROMProgram(pages[0], EEPROM_PAGE_VALID);
+    }
+    else if (state[1] == EEPROM_PAGE_RECEIVE && state[0] != EEPROM_PAGE_RECEIVE)
+    {
+        active = 1;
+        nextRecord = EEPROMScan(1);
+        done = EEPROMErase(0) && EEPROMProgram(pages[1], EEPROM_PAGE_VALID);
+    }
+    else
+    {
+        done = EEPROMFormat();
+    }
+
+    FLASH_Lock();
+
+    return done;
+}
+
+/**
+ * Erases both pages, all the variables are lost.
+ * @return False on an error of the flash.
+ */
+bool EEPROMEmulationFormat(void)
+{
+    bool done;
+
+    FLASH_Unlock();
+    done = EEPROMFormat();
+    FLASH_Lock();
+
+    return done;
+}
+
+/**
+ * Reads a variable from the RAM copy.
+ * @param variable Variable, 0 to EEPROM_EMULATION_VARIABLES - 1.
+ * @param value Its last value.
+ * @return False if the variable was never written.
+ */
+bool EEPROMEmulationRead(uint16_t variable, uint16_t *value)
+{
+    if (variable >= EEPROM_EMULATION_VARIABLES || !EEPROMIsWritten(variable))
+        return false;
+
+    *value = values[variable];
+
+    return true;
+}
+
+/**
+ * Writes a variable, a record appended or, with the page full, the move of
+ * the variables to the other page.
+ * @param variable Variable, 0 to EEPROM_EMULATION_VARIABLES - 1.
+ * @param value Value.
+ * @return False on an error of the flash.
+ */
+bool EEPROMEmulationWrite(uint16_t variable, uint16_t value)
+{
+    bool done;
+
+    if (variable >= EEPROM_EMULATION_VARIABLES)
+        return false;
+
+    if (EEPROMIsWritten(variable) && values[variable] == value)
+    {
+        EEPROMEmulationStatistics.Skipped++;
+        return true;
+    }
+
+    FLASH_Unlock();
+
+    if (nextRecord < pages[active] + EEPROM_EMULATION_PAGE_SIZE)
+        done = EEPROMAppend(&nextRecord, variable, value);
+    else
+        done = EEPROMTransfer(variable, value);
+
+    FLASH_Lock();
+
+    if (done)
+    {
+        EEPROMCache(variable, value);
+        EEPROMEmulationStatistics.Writes++;
+    }
+
+    return done;
+}
+
+/**
+ * Tells how many records the valid page still takes before the next move.
+ * @return Free records.
+ */
+unsigned int EEPROMEmulationFreeRecords(void)
+{
+    return (pages[active] + EEPROM_EMULATION_PAGE_SIZE - nextRecord) / 4;
+}
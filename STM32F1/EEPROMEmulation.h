@@ -0,0 +1,96 @@
+/**
+ *  @file       EEPROMEmulation.h
+ *  @author     Luis Maduro
+ *  @version    1.00
+ *  @date       14/10/2026
+ *  @brief      16 bit variables kept in two pages of the internal flash.
+ *
+ *  A write appends a record to the valid page: the value then the number of
+ *  the variable, each one a half-word. A record with the number still
+ *  erased was cut by a reset and is skipped. The last record of a variable
+ *  is its value. A RAM copy of the values, built by EEPROMEmulationInit()
+ *  from the records, serves the reads without searching the flash. It also
+ *  skips the writes of a value the variable already has.
+ *
+ *  When the valid page is full, the next write moves the variables to the
+ *  other page, the only erases of the normal use:
+ *  - the other page is erased if it is not blank and marked RECEIVE;
+ *  - the new value and the last values of the other variables are written
+ *    to it from the RAM copy;
+ *  - the full page is erased, and the new one marked VALID.
+ *  EEPROMEmulationInit() finishes a move cut by a reset from the states of
+ *  the pages.
+ *
+ *  The STM32F1 programs the flash by half-words, it has no half-page
+ *  programming like the STM32L1. A record takes two program operations and
+ *  a move one per variable. The CPU stalls on its fetches from the flash
+ *  while a page is erased, 20 to 40 ms, and while a half-word is
+ *  programmed, about 50 us.
+ *
+ *  The pages are by default the last two of the flash, from the size in
+ *  the device signature. The linker script must keep the code out of them.
+ *
+ *  Copyright (C) 2026  Luis Maduro
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef EEPROMEMULATION_H
+#define EEPROMEMULATION_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stm32f10x.h>
+
+/**Bytes of a page of the flash.*/
+#ifndef EEPROM_EMULATION_PAGE_SIZE
+#if defined(STM32F10X_HD) || defined(STM32F10X_HD_VL) || defined(STM32F10X_XL) || defined(STM32F10X_CL)
+#define EEPROM_EMULATION_PAGE_SIZE  0x800
+#else
+#define EEPROM_EMULATION_PAGE_SIZE  0x400
+#endif
+#endif
+
+/**Address of the first page, define it to place the pages, the second one
+ follows it. Not defined, the last two pages of the flash.*/
+//#define EEPROM_EMULATION_PAGE0      0x0800F800UL
+
+/**Variables, numbered from 0.*/
+#ifndef EEPROM_EMULATION_VARIABLES
+#define EEPROM_EMULATION_VARIABLES  32
+#endif
+
+#if (EEPROM_EMULATION_PAGE_SIZE - 4) / 4 < EEPROM_EMULATION_VARIABLES
+#error "EEPROMEmulation: the variables do not fit in a page"
+#endif
+
+typedef struct
+{
+    /**Records written.*/
+    uint32_t Writes;
+    /**Writes of the value the variable already had.*/
+    uint32_t Skipped;
+    /**Moves to the other page.*/
+    uint32_t Transfers;
+} tEEPROMEmulationStatistics;
+
+extern tEEPROMEmulationStatistics EEPROMEmulationStatistics;
+
+bool EEPROMEmulationInit(void);
+bool EEPROMEmulationFormat(void);
+bool EEPROMEmulationRead(uint16_t variable, uint16_t *value);
+bool EEPROMEmulationWrite(uint16_t variable, uint16_t value);
+unsigned int EEPROMEmulationFreeRecords(void);
+
+#endif /* EEPROMEMULATION_H */
@@ -0,0 +1,258 @@
+/**
+ *  @file       ExternalSRAM.c
+ *  @author     Luis Maduro
+ *  @version    1.00
+ *  @date       14/10/2026
+ *  @brief      Arena and block pools in the external SRAM of the FSMC.
+ *
+ *  Copyright (C) 2026  Luis Maduro
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <stddef.h>
+#include "ExternalSRAM.h"
+
+/**Next free address of the arena.*/
+static uint32_t arenaNext;
+
+#if EXTERNAL_SRAM_INIT_FSMC
+
+/**
+ * Configures the pins and the timings of bank 1 NOR/SRAM3, those of the
+ * SRAM of the STM3210E-EVAL.
+ */
+static void ExternalSRAMConfigure(void)
+{
+    FSMC_NORSRAMInitTypeDef FSMC_NORSRAMInitStructure;
+    FSMC_NORSRAMTimingInitTypeDef timing;
+    GPIO_InitTypeDef GPIO_InitStructure;
+
+    RCC_AHBPeriphClockCmd(RCC_AHBPeriph_FSMC, ENABLE);
+    RCC_APB2PeriphClockCmd(RCC_APB2Periph_GPIOD | RCC_APB2Periph_GPIOE |
+                           RCC_APB2Periph_GPIOF | RCC_APB2Periph_GPIOG, ENABLE);
+
+    GPIO_InitStructure.GPIO_Mode = GPIO_Mode_AF_PP;
+    GPIO_InitStructure.GPIO_Speed = GPIO_Speed_50MHz;
+
+    //D0-D3, D13-D15, A16-A18, NOE, NWE
+    GPIO_InitStructure.GPIO_Pin = GPIO_Pin_0 | GPIO_Pin_1 | GPIO_Pin_4 | GPIO_Pin_5 |
+            GPIO_Pin_8 | GPIO_Pin_9 | GPIO_Pin_10 | GPIO_Pin_11 | GPIO_Pin_12 |
+            GPIO_Pin_13 | GPIO_Pin_14 | GPIO_Pin_15;
+    GPIO_Init(GPIOD, &GPIO_InitStructure);
+
+    //NBL0, NBL1, D4-D12
+    GPIO_InitStructure.GPIO_Pin = GPIO_Pin_0 | GPIO_Pin_1 | GPIO_Pin_7 | GPIO_Pin_8 |
+            GPIO_Pin_9 | GPIO_Pin_10 | GPIO_Pin_11 | GPIO_Pin_12 | GPIO_Pin_13 |
+            GPIO_Pin_14 | GPIO_Pin_15;
+    GPIO_Init(GPIOE, &GPIO_InitStructure);
+
+    //A0-A9
+    GPIO_InitStructure.GPIO_Pin = GPIO_Pin_0 | GPIO_Pin_1 | GPIO_Pin_2 | GPIO_Pin_3 |
+            GPIO_Pin_4 | GPIO_Pin_5 | GPIO_Pin_12 | GPIO_Pin_13 | GPIO_Pin_14 |
+            GPIO_Pin_15;
+    GPIO_Init(GPIOF, &GPIO_InitStructure);
+
+    //A10-A15, NE3
+    GPIO_InitStructure.GPIO_Pin = GPIO_Pin_0 | GPIO_Pin_1 | GPIO_Pin_2 | GPIO_Pin_3 |
+            GPIO_Pin_4 | GPIO_Pin_5 | GPIO_Pin_10;
+    GPIO_Init(GPIOG, &GPIO_InitStructure);
+
+    timing.FSMC_AddressSetupTime = 0;
+    timing.FSMC_AddressHoldTime = 0;
+    timing.FSMC_DataSetupTime = 1;
+    timing.FSMC_BusTurnAroundDuration = 0;
+    timing.FSMC_CLKDivision = 0;
+    timing.FSMC_DataLatency = 0;
+    timing.FSMC_AccessMode = FSMC_AccessMode_A;
+
+    FSMC_NORSRAMInitStructure.FSMC_Bank = FSMC_Bank1_NORSRAM3;
+    FSMC_NORSRAMInitStructure.FSMC_DataAddressMux = FSMC_DataAddressMux_Disable;
+    FSMC_NORSRAMInitStructure.FSMC_MemoryType = FSMC_MemoryType_SRAM;
+    FSMC_NORSRAMInitStructure.FSMC_MemoryDataWidth = FSMC_MemoryDataWidth_16b;
+    FSMC_NORSRAMInitStructure.FSMC_BurstAccessMode = FSMC_BurstAccessMode_Disable;
+    FSMC_NORSRAMInitStructure.FSMC_AsynchronousWait = FSMC_AsynchronousWait_Disable;
+    FSMC_NORSRAMInitStructure.FSMC_WaitSignalPolarity = FSMC_WaitSignalPolarity_Low;
+    FSMC_NORSRAMInitStructure.FSMC_WrapMode = FSMC_WrapMode_Disable;
+    FSMC_NORSRAMInitStructure.FSMC_WaitSignalActive = FSMC_WaitSignalActive_BeforeWaitState;
+    FSMC_NORSRAMInitStructure.FSMC_WriteOperation = FSMC_WriteOperation_Enable;
+    FSMC_NORSRAMInitStructure.FSMC_WaitSignal = FSMC_WaitSignal_Disable;
+    FSMC_NORSRAMInitStructure.FSMC_ExtendedMode = FSMC_ExtendedMode_Disable;
+    FSMC_NORSRAMInitStructure.FSMC_WriteBurst = FSMC_WriteBurst_Disable;
+    FSMC_NORSRAMInitStructure.FSMC_ReadWriteTimingStruct = &timing;
+    FSMC_NORSRAMInitStructure.FSMC_WriteTimingStruct = &timing;
+    FSMC_NORSRAMInit(&FSMC_NORSRAMInitStructure);
+
+    FSMC_NORSRAMCmd(FSMC_Bank1_NORSRAM3, ENABLE);
+}
+
+#endif
+
+/**
+ * Enables the SRAM and empties the arena, the pools taken from it are
+ * lost.
+ */
+void ExternalSRAMInit(void)
+{
+#if EXTERNAL_SRAM_INIT_FSMC
+    ExternalSRAMConfigure();
+#endif
+
+    arenaNext = EXTERNAL_SRAM_ARENA_START;
+}
+
+/**
+ * Takes a buffer from the arena.
+ * @param size Bytes of the buffer.
+ * @param align Alignment of the buffer, a power of 2, 4 for a word or a
+ * DMA of words.
+ * @return The buffer, NULL if the arena is full.
+ */
+void *ExternalSRAMAlloc(uint32_t size, uint32_t align)
+{
+    uint32_t address = (arenaNext + align - 1) & ~(align - 1);
+
+    if ((address < arenaNext) ||
+            (size > EXTERNAL_SRAM_BASE + EXTERNAL_SRAM_SIZE - address))
+    {
+        return NULL;
+    }
+
+    arenaNext = address + size;
+
+    return (void *) address;
+}
+
+/**
+ * Gives the bytes of the arena not taken.
+ * @return Bytes free.
+ */
+uint32_t ExternalSRAMAvailable(void)
+{
+    return EXTERNAL_SRAM_BASE + EXTERNAL_SRAM_SIZE - arenaNext;
+}
+
+/**
+ * Marks the arena, the buffers taken after are freed together by
+ * ExternalSRAMRelease().
+ * @return The mark.
+ */
+uint32_t ExternalSRAMMark(void)
+{
+    return arenaNext;
+}
+
+/**
+ * Frees the buffers taken since a mark.
+ * @param mark Mark of ExternalSRAMMark().
+ */
+void ExternalSRAMRelease(uint32_t mark)
+{
+    if ((mark >= EXTERNAL_SRAM_ARENA_START) && (mark <= arenaNext))
+    {
+        arenaNext = mark;
+    }
+}
+
+/**
+ * Takes a pool of blocks from the arena.
+ * @param pool Pool.
+ * @param blockSize Bytes of a block, rounded up to a multiple of 4.
+ * @param count Blocks.
+ * @return False if the arena is full.
+ */
+bool ExternalSRAMPoolInit(tExternalSRAMPool *pool, uint16_t blockSize, uint16_t count)
+{
+    uint8_t *block;
+    uint16_t i;
+
+    if (count == 0)
+    {
+        return false;
+    }
+
+    blockSize = (blockSize < sizeof (void *)) ? sizeof (void *) : (blockSize + 3) & ~3;
+
+    block = (uint8_t *) ExternalSRAMAlloc((uint32_t) blockSize * count, 4);
+    if (block == NULL)
+    {
+        return false;
+    }
+
+    pool->blockSize = blockSize;
+    pool->count = count;
+    pool->available = count;
+    pool->lowest = count;
+    pool->free = block;
+
+    for (i = 1; i < count; i++, block += blockSize)
+    {
+        *(void **) block = block + blockSize;
+    }
+    *(void **) block = NULL;
+
+    return true;
+}
+
+/**
+ * Takes a block of a pool.
+ * @param pool Pool.
+ * @return The block, NULL if none is free.
+ */
+void *ExternalSRAMPoolGet(tExternalSRAMPool *pool)
+{
+    void *block;
+    uint32_t primask;
+
+    primask = __get_PRIMASK();
+    __disable_irq();
+
+    block = pool->free;
+    if (block != NULL)
+    {
+        pool->free = *(void **) block;
+        if (--pool->available < pool->lowest)
+        {
+            pool->lowest = pool->available;
+        }
+    }
+
+    __set_PRIMASK(primask);
+
+    return block;
+}
+
+/**
+ * Gives a block back to its pool.
+ * @param pool Pool.
+ * @param block Block of ExternalSRAMPoolGet().
+ */
+void ExternalSRAMPoolPut(tExternalSRAMPool *pool, void *block)
+{
+    uint32_t primask;
+
+    if (block == NULL)
+    {
+        return;
+    }
+
+    primask = __get_PRIMASK();
+    __disable_irq();
+
+    *(void **) block = pool->free;
+    pool->free = block;
+    pool->available++;
+
+    __set_PRIMASK(primask);
+}
@@ -0,0 +1,106 @@
+/**
+ *  @file       ExternalSRAM.h
+ *  @author     Luis Maduro
+ *  @version    1.00
+ *  @date       14/10/2026
+ *  @brief      Arena and block pools in the external SRAM of the FSMC.
+ *
+ *  The large buffers (block caches of the SD card, frame buffers of the
+ *  LCD, audio rings, pools of packets) go to the external SRAM, the
+ *  internal SRAM is kept for the state used often.
+ *
+ *  A buffer is placed in the external SRAM in one of two ways:
+ *  - at link time, with EXTERNAL_SRAM_SECTION on a static buffer, the linker
+ *    script then has a NOLOAD output section at the base of the SRAM:
+ *
+ *        .extsram (NOLOAD) : { *(.extsram) _eextsram = .; } > EXTSRAM
+ *
+ *    and EXTERNAL_SRAM_ARENA_START is defined to ((uint32_t) &_eextsram),
+ *    so that the arena starts after those buffers;
+ *  - from the arena, at initialization, by ExternalSRAMAlloc().
+ *
+ *  The arena is a bump allocator, an allocation is O(1) and never
+ *  fragments, and it is freed in LIFO order with ExternalSRAMMark() and
+ *  ExternalSRAMRelease(). The buffers allocated and freed at run time come
+ *  from a pool of blocks of one size taken from the arena, also O(1), the
+ *  pools can be used from the interrupts. Nothing uses malloc.
+ *
+ *  ExternalSRAMInit() configures the FSMC for the SRAM of the STM3210E-EVAL
+ *  (bank 1 NOR/SRAM3, 16 bit), unless the startup code did it already
+ *  (DATA_IN_ExtSRAM in system_stm32f10x.c). The contents of the SRAM are
+ *  not initialized.
+ *
+ *  Copyright (C) 2026  Luis Maduro
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef EXTERNALSRAM_H
+#define EXTERNALSRAM_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stm32f10x.h>
+
+/**Address and size of the SRAM, 1 MB on NE3 for the STM3210E-EVAL.*/
+#ifndef EXTERNAL_SRAM_BASE
+#define EXTERNAL_SRAM_BASE          0x68000000UL
+#endif
+
+#ifndef EXTERNAL_SRAM_SIZE
+#define EXTERNAL_SRAM_SIZE          0x00100000UL
+#endif
+
+/**First address of the arena, after the buffers placed by the linker.*/
+#ifndef EXTERNAL_SRAM_ARENA_START
+#define EXTERNAL_SRAM_ARENA_START   EXTERNAL_SRAM_BASE
+#endif
+
+/**Configure the FSMC and its pins in ExternalSRAMInit().*/
+#ifndef EXTERNAL_SRAM_INIT_FSMC
+#ifdef DATA_IN_ExtSRAM
+#define EXTERNAL_SRAM_INIT_FSMC     0
+#else
+#define EXTERNAL_SRAM_INIT_FSMC     1
+#endif
+#endif
+
+/**Places a static buffer in the external SRAM, never initialized.*/
+#define EXTERNAL_SRAM_SECTION       __attribute__((section(".extsram")))
+
+/**
+ * Pool of blocks of one size, the free blocks are linked through their
+ * first word.
+ */
+typedef struct
+{
+    void *free;
+    uint16_t blockSize;
+    uint16_t count;
+    /**Blocks free.*/
+    uint16_t available;
+    /**Fewest blocks free since the initialization.*/
+    uint16_t lowest;
+} tExternalSRAMPool;
+
+void ExternalSRAMInit(void);
+void *ExternalSRAMAlloc(uint32_t size, uint32_t align);
+uint32_t ExternalSRAMAvailable(void);
+uint32_t ExternalSRAMMark(void);
+void ExternalSRAMRelease(uint32_t mark);
+bool ExternalSRAMPoolInit(tExternalSRAMPool *pool, uint16_t blockSize, uint16_t count);
+void *ExternalSRAMPoolGet(tExternalSRAMPool *pool);
+void ExternalSRAMPoolPut(tExternalSRAMPool *pool, void *block);
+
+#endif /* EXTERNALSRAM_H */
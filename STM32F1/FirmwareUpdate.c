@@ -0,0 +1,527 @@
+/**
+ *  @file       FirmwareUpdate.c
+ *  @author     Luis Maduro
+ *  @version    1.00
+ *  @date       14/10/2026
+ *  @brief      A/B firmware update of the XL density devices, the other bank
+ *              programmed in the background.
+ *
+ *  Copyright (C) 2026  Luis Maduro
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "FirmwareUpdate.h"
+#include "CRCDevice.h"
+
+#ifndef STM32F10X_XL
+#error "FirmwareUpdate needs the two banks of the XL density devices"
+#endif
+
+#define FIRMWARE_UPDATE_PAGE        0x800UL
+#define FIRMWARE_UPDATE_RING        (FIRMWARE_UPDATE_BUFFER / 2)
+#define FIRMWARE_UPDATE_SR_ERRORS   (FLASH_SR_PGERR | FLASH_SR_WRPRTERR)
+/**BFB2 in the user option byte of FLASH_GetUserOptionByte().*/
+#define FIRMWARE_UPDATE_USER_BFB2   0x08
+
+/**
+ * The registers of a bank, those of bank 2 are the same 0x40 further.
+ */
+typedef struct
+{
+    __IO uint32_t KEYR;
+    uint32_t RESERVED;
+    __IO uint32_t SR;
+    __IO uint32_t CR;
+    __IO uint32_t AR;
+} tFlashBank;
+
+#define FIRMWARE_UPDATE_REGS1       ((tFlashBank *) &FLASH->KEYR)
+#define FIRMWARE_UPDATE_REGS2       ((tFlashBank *) &FLASH->KEYR2)
+
+static volatile tFirmwareUpdateState state = FIRMWARE_UPDATE_IDLE;
+static tFirmwareUpdateError error;
+/**Bank programmed, its registers and those of the bank running.*/
+static uint32_t base;
+static tFlashBank *target;
+static tFlashBank *running;
+static uint32_t imageSize;
+/**Bytes taken by FirmwareUpdateWrite().*/
+static uint32_t received;
+static uint32_t expectedCrc;
+static bool finishing;
+/**Held back until FirmwareUpdateActivate().*/
+static uint32_t firstWord;
+static uint8_t oddByte;
+/**Next page to erase, next half-word to program.*/
+static uint32_t address;
+/**No operation running, the ring was empty at the last end of operation.*/
+static volatile bool flashIdle;
+
+static uint16_t ring[FIRMWARE_UPDATE_RING];
+static volatile uint16_t ringHead;
+static volatile uint16_t ringTail;
+
+/**
+ * Stops the update on an error.
+ */
+static void FirmwareUpdateFail(tFirmwareUpdateError cause)
+{
+    target->CR &= ~(FLASH_CR_PG | FLASH_CR_PER | FLASH_CR_EOPIE | FLASH_CR_ERRIE);
+    target->CR |= FLASH_CR_LOCK;
+    error = cause;
+    state = FIRMWARE_UPDATE_ERROR;
+}
+
+/**
+ * Starts the programming of the next half-word buffered, the erased ones
+ * are skipped. Called with the flash interrupt masked.
+ */
+static void FirmwareUpdateProgramNext(void)
+{
+    uint16_t value;
+
+    while (ringTail != ringHead)
+    {
+        value = ring[ringTail & (FIRMWARE_UPDATE_RING - 1)];
+        ringTail++;
+        address += 2;
+
+        if (value != 0xFFFF)
+        {
+            flashIdle = false;
+            target->CR |= FLASH_CR_PG;
+            *(__IO uint16_t *) (address - 2) = value;
+            return;
+        }
+    }
+
+    target->CR &= ~FLASH_CR_PG;
+    flashIdle = true;
+}
+
+/**
+ * Starts programming if data arrived while the flash was idle.
+ */
+static void FirmwareUpdateKick(void)
+{
+    uint32_t primask;
+
+    primask = __get_PRIMASK();
+    __disable_irq();
+
+    if ((state == FIRMWARE_UPDATE_PROGRAMMING) && flashIdle)
+    {
+        FirmwareUpdateProgramNext();
+    }
+
+    __set_PRIMASK(primask);
+}
+
+/**
+ * Programs a half-word, waiting for it. Only for the few writes of the
+ * flip.
+ */
+static bool FirmwareUpdateProgramHalfWord(tFlashBank *bank, uint32_t at, uint16_t value)
+{
+    bool done;
+
+    while (bank->SR & FLASH_SR_BSY);
+
+    bank->SR = FLASH_SR_EOP | FIRMWARE_UPDATE_SR_ERRORS;
+    bank->CR |= FLASH_CR_PG;
+    *(__IO uint16_t *) at = value;
+
+    while (bank->SR & FLASH_SR_BSY);
+
+    done = (bank->SR & FIRMWARE_UPDATE_SR_ERRORS) == 0 && *(__IO uint16_t *) at == value;
+    bank->SR = FLASH_SR_EOP | FIRMWARE_UPDATE_SR_ERRORS;
+    bank->CR &= ~FLASH_CR_PG;
+
+    return done;
+}
+
+/**
+ * Tells if the system memory chooses the boot bank (BFB2 reset).
+ * @return True if an update can be activated.
+ */
+bool FirmwareUpdateIsDualBoot(void)
+{
+    return (FLASH_GetUserOptionByte() & FIRMWARE_UPDATE_USER_BFB2) == 0;
+}
+
+/**
+ * Resets BFB2 once for all. The option bytes are erased first, the write
+ * protection and the other user options go back to their default, and a
+ * reset while it runs leaves them erased.
+ * @return False if the option bytes could not be programmed.
+ */
+bool FirmwareUpdateEnableDualBoot(void)
+{
+    bool done;
+
+    if (FirmwareUpdateIsDualBoot())
+    {
+        return true;
+    }
+
+    FLASH_Unlock();
+    done = (FLASH_EraseOptionBytes() == FLASH_COMPLETE) &&
+            (FLASH_BootConfig(FLASH_BOOT_Bank2) == FLASH_COMPLETE);
+    FLASH_Lock();
+
+    return done;
+}
+
+/**
+ * Gives the bank an update goes to, the one the application is not running
+ * from.
+ * @return FIRMWARE_UPDATE_BANK1 or FIRMWARE_UPDATE_BANK2.
+ */
+uint32_t FirmwareUpdateTargetBank(void)
+{
+    return ((uint32_t) FirmwareUpdateTargetBank < FIRMWARE_UPDATE_BANK2) ?
+            FIRMWARE_UPDATE_BANK2 : FIRMWARE_UPDATE_BANK1;
+}
+
+/**
+ * Starts an update, the pages of the image are erased in the background.
+ * @param size Bytes of the image.
+ * @return False if an update is running, if the image does not fit in a
+ * bank or if BFB2 is set.
+ */
+bool FirmwareUpdateBegin(uint32_t size)
+{
+    NVIC_InitTypeDef NVIC_InitStructure;
+
+    if ((state != FIRMWARE_UPDATE_IDLE && state != FIRMWARE_UPDATE_ERROR &&
+            state != FIRMWARE_UPDATE_READY) ||
+            (size < 8) || (size > FIRMWARE_UPDATE_BANK_SIZE) || !FirmwareUpdateIsDualBoot())
+    {
+        return false;
+    }
+
+    base = FirmwareUpdateTargetBank();
+    if (base == FIRMWARE_UPDATE_BANK1)
+    {
+        target = FIRMWARE_UPDATE_REGS1;
+        running = FIRMWARE_UPDATE_REGS2;
+        FLASH_UnlockBank1();
+    }
+    else
+    {
+        target = FIRMWARE_UPDATE_REGS2;
+        running = FIRMWARE_UPDATE_REGS1;
+        FLASH_UnlockBank2();
+    }
+
+    CRCDeviceInit();
+
+    imageSize = size;
+    received = 0;
+    finishing = false;
+    firstWord = 0;
+    error = FIRMWARE_UPDATE_OK;
+    ringHead = 0;
+    ringTail = 0;
+    flashIdle = false;
+
+    NVIC_InitStructure.NVIC_IRQChannel = FLASH_IRQn;
+    NVIC_InitStructure.NVIC_IRQChannelPreemptionPriority = FIRMWARE_UPDATE_IRQ_PRIORITY;
+    NVIC_InitStructure.NVIC_IRQChannelSubPriority = 0;
+    NVIC_InitStructure.NVIC_IRQChannelCmd = ENABLE;
+    NVIC_Init(&NVIC_InitStructure);
+
+    while (target->SR & FLASH_SR_BSY);
+    target->SR = FLASH_SR_EOP | FIRMWARE_UPDATE_SR_ERRORS;
+    target->CR |= FLASH_CR_EOPIE | FLASH_CR_ERRIE;
+
+    //the interrupt erases the next pages
+    state = FIRMWARE_UPDATE_ERASING;
+    address = base;
+    target->CR |= FLASH_CR_PER;
+    target->AR = address;
+    target->CR |= FLASH_CR_STRT;
+
+    return true;
+}
+
+/**
+ * Gives bytes of the image, in order.
+ * @param data Bytes.
+ * @param length Bytes given.
+ * @return Bytes taken, less than length when the buffer is full: the rest
+ * is given again later.
+ */
+uint32_t FirmwareUpdateWrite(const uint8_t *data, uint32_t length)
+{
+    uint32_t taken = 0;
+
+    if ((state != FIRMWARE_UPDATE_ERASING && state != FIRMWARE_UPDATE_PROGRAMMING) ||
+            finishing)
+    {
+        return 0;
+    }
+
+    while ((taken < length) && (received < imageSize))
+    {
+        if (received < 4)
+        {
+            firstWord |= (uint32_t) data[taken] << (8 * received);
+        }
+        else if ((received & 1) == 0)
+        {
+            oddByte = data[taken];
+        }
+        else
+        {
+            if ((uint16_t) (ringHead - ringTail) == FIRMWARE_UPDATE_RING)
+            {
+                break;
+            }
+
+            ring[ringHead & (FIRMWARE_UPDATE_RING - 1)] = oddByte | ((uint16_t) data[taken] << 8);
+            __DMB();
+            ringHead++;
+        }
+
+        received++;
+        taken++;
+    }
+
+    FirmwareUpdateKick();
+
+    return taken;
+}
+
+/**
+ * Ends the image, it is checked once programmed.
+ * @param crc CRC of the image.
+ * @return False if the image is not complete.
+ */
+bool FirmwareUpdateFinish(uint32_t crc)
+{
+    if ((state != FIRMWARE_UPDATE_ERASING && state != FIRMWARE_UPDATE_PROGRAMMING) ||
+            (received != imageSize))
+    {
+        return false;
+    }
+
+    //an odd length ends with an erased byte
+    if (imageSize & 1)
+    {
+        while ((uint16_t) (ringHead - ringTail) == FIRMWARE_UPDATE_RING)
+        {
+            FirmwareUpdateKick();
+        }
+
+        ring[ringHead & (FIRMWARE_UPDATE_RING - 1)] = oddByte | 0xFF00;
+        __DMB();
+        ringHead++;
+    }
+
+    expectedCrc = crc;
+    finishing = true;
+    FirmwareUpdateKick();
+
+    return true;
+}
+
+/**
+ * Stops an update, the bank is left as it is and never booted.
+ */
+void FirmwareUpdateAbort(void)
+{
+    if (state == FIRMWARE_UPDATE_IDLE || state == FIRMWARE_UPDATE_ACTIVATED)
+    {
+        return;
+    }
+
+    NVIC_DisableIRQ(FLASH_IRQn);
+    while (target->SR & FLASH_SR_BSY);
+    target->SR = FLASH_SR_EOP | FIRMWARE_UPDATE_SR_ERRORS;
+    target->CR &= ~(FLASH_CR_PG | FLASH_CR_PER | FLASH_CR_EOPIE | FLASH_CR_ERRIE);
+    target->CR |= FLASH_CR_LOCK;
+
+    while (CRCDeviceIsBusy());
+
+    state = FIRMWARE_UPDATE_IDLE;
+}
+
+/**
+ * Ends the programming and checks the image, to be called often from the
+ * main loop or a task during an update.
+ */
+void FirmwareUpdateTasks(void)
+{
+    uint32_t primask;
+    uint32_t reset;
+    bool drained;
+
+    FirmwareUpdateKick();
+
+    switch (state)
+    {
+        case FIRMWARE_UPDATE_PROGRAMMING:
+            primask = __get_PRIMASK();
+            __disable_irq();
+            drained = finishing && flashIdle && (ringTail == ringHead);
+            __set_PRIMASK(primask);
+
+            if (drained)
+            {
+                target->CR &= ~(FLASH_CR_EOPIE | FLASH_CR_ERRIE);
+                state = FIRMWARE_UPDATE_VERIFYING;
+                CRCDeviceStart(CRCDeviceCompute(CRC_DEVICE_INIT, &firstWord, 4),
+                               (const void *) (base + 4), imageSize - 4);
+            }
+            break;
+
+        case FIRMWARE_UPDATE_VERIFYING:
+            if (CRCDeviceIsBusy())
+            {
+                break;
+            }
+
+            reset = *(const uint32_t *) (base + 4);
+
+            if (CRCDeviceGetResult() != expectedCrc)
+            {
+                FirmwareUpdateFail(FIRMWARE_UPDATE_ERROR_CRC);
+            }
+            else if (((firstWord & 0x2FFE0000UL) != 0x20000000UL) ||
+                    (reset < base) || (reset >= base + imageSize))
+            {
+                FirmwareUpdateFail(FIRMWARE_UPDATE_ERROR_VECTORS);
+            }
+            else
+            {
+                state = FIRMWARE_UPDATE_READY;
+            }
+            break;
+
+        default:
+            break;
+    }
+}
+
+/**
+ * Gives the state of the update.
+ * @return State.
+ */
+tFirmwareUpdateState FirmwareUpdateGetState(void)
+{
+    return state;
+}
+
+/**
+ * Gives the cause of FIRMWARE_UPDATE_ERROR.
+ * @return Cause.
+ */
+tFirmwareUpdateError FirmwareUpdateGetError(void)
+{
+    return error;
+}
+
+/**
+ * Gives the bytes of the image taken by FirmwareUpdateWrite().
+ * @return Bytes.
+ */
+uint32_t FirmwareUpdateGetProgress(void)
+{
+    return received;
+}
+
+/**
+ * Makes the image checked the one booted from the next reset.
+ * @return False if it is not ready or the flash could not be programmed.
+ */
+bool FirmwareUpdateActivate(void)
+{
+    bool done;
+
+    if (state != FIRMWARE_UPDATE_READY)
+    {
+        return false;
+    }
+
+    //the stack pointer is invalid until its high half-word
+    done = FirmwareUpdateProgramHalfWord(target, base, (uint16_t) firstWord) &&
+            FirmwareUpdateProgramHalfWord(target, base + 2, (uint16_t) (firstWord >> 16));
+    target->CR |= FLASH_CR_LOCK;
+
+    //bank 2 is booted first while valid
+    if (done && base == FIRMWARE_UPDATE_BANK1)
+    {
+        FLASH_UnlockBank2();
+        done = FirmwareUpdateProgramHalfWord(running, FIRMWARE_UPDATE_BANK2 + 2, 0x0000);
+        running->CR |= FLASH_CR_LOCK;
+    }
+
+    if (!done)
+    {
+        FirmwareUpdateFail(FIRMWARE_UPDATE_ERROR_FLASH);
+        return false;
+    }
+
+    state = FIRMWARE_UPDATE_ACTIVATED;
+
+    return true;
+}
+
+/**
+ * This funtion is intended to be put in FLASH_IRQHandler(), it erases the
+ * next page or programs the next half-word.
+ */
+void FirmwareUpdateInterruptHandler(void)
+{
+    uint32_t status;
+
+    if (state != FIRMWARE_UPDATE_ERASING && state != FIRMWARE_UPDATE_PROGRAMMING)
+    {
+        return;
+    }
+
+    status = target->SR;
+    if ((status & (FLASH_SR_EOP | FIRMWARE_UPDATE_SR_ERRORS)) == 0)
+    {
+        return;
+    }
+    target->SR = FLASH_SR_EOP | FIRMWARE_UPDATE_SR_ERRORS;
+
+    if (status & FIRMWARE_UPDATE_SR_ERRORS)
+    {
+        FirmwareUpdateFail(FIRMWARE_UPDATE_ERROR_FLASH);
+        return;
+    }
+
+    if (state == FIRMWARE_UPDATE_ERASING)
+    {
+        address += FIRMWARE_UPDATE_PAGE;
+
+        if (address < base + imageSize)
+        {
+            target->AR = address;
+            target->CR |= FLASH_CR_STRT;
+            return;
+        }
+
+        //the first word is programmed last, by FirmwareUpdateActivate()
+        target->CR &= ~FLASH_CR_PER;
+        address = base + 4;
+        state = FIRMWARE_UPDATE_PROGRAMMING;
+    }
+
+    FirmwareUpdateProgramNext();
+}
@@ -0,0 +1,122 @@
+/**
+ *  @file       FirmwareUpdate.h
+ *  @author     Luis Maduro
+ *  @version    1.00
+ *  @date       14/10/2026
+ *  @brief      A/B firmware update of the XL density devices, the other bank
+ *              programmed in the background.
+ *
+ *  The XL density devices have two banks of flash with one controller each,
+ *  one can be erased and programmed while the application runs from the
+ *  other without stalling. The image is programmed in the bank the
+ *  application is not running from, the erase and the programming of every
+ *  half-word are started by the end of operation interrupt of that bank, the
+ *  application keeps running.
+ *
+ *  The image comes from any transport (USB, UART, radio) by
+ *  FirmwareUpdateWrite(), which takes bytes as long as its buffer has room
+ *  and tells how many it took, for the flow control of the transport. The
+ *  image must be linked for the bank it goes to: 0x08000000 or 0x08080000.
+ *
+ *  When all the image is written, it is checked with the CRC of CRCDevice,
+ *  by the CRC unit fed by DMA, and the address of its reset handler is
+ *  checked to be in the bank.
+ *
+ *  The boot bank is chosen by the system memory with the BFB2 option bit
+ *  reset: bank 2 if its first word is a valid stack pointer, bank 1
+ *  otherwise. The first word of the image is only programmed by
+ *  FirmwareUpdateActivate(), after the check, so an image partly written is
+ *  never booted, and the flip is a single half-word write:
+ *  - to bank 2, its first word is written low half-word first, it becomes
+ *    valid with its high half-word;
+ *  - to bank 1, its first word is written, then the high half-word of the
+ *    first word of bank 2 is programmed to 0, it becomes invalid.
+ *  The new image runs from the next reset. FirmwareUpdateEnableDualBoot()
+ *  resets BFB2 once, it erases the option bytes and it is not atomic.
+ *
+ *  The CRC is the CRC-32 of CRCDevice: polynomial 0x04C11DB7, initial value
+ *  0xFFFFFFFF, not reflected, over the image as little endian words.
+ *
+ *  Copyright (C) 2026  Luis Maduro
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef FIRMWAREUPDATE_H
+#define FIRMWAREUPDATE_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stm32f10x.h>
+
+/**Bytes buffered between the transport and the flash, a power of 2.*/
+#ifndef FIRMWARE_UPDATE_BUFFER
+#define FIRMWARE_UPDATE_BUFFER      1024
+#endif
+
+/**Priority of the flash interrupt.*/
+#ifndef FIRMWARE_UPDATE_IRQ_PRIORITY
+#define FIRMWARE_UPDATE_IRQ_PRIORITY 3
+#endif
+
+#define FIRMWARE_UPDATE_BANK1       0x08000000UL
+#define FIRMWARE_UPDATE_BANK2       0x08080000UL
+#define FIRMWARE_UPDATE_BANK_SIZE   0x00080000UL
+
+/**
+ * State of an update.
+ */
+typedef enum
+{
+    FIRMWARE_UPDATE_IDLE = 0,
+    /**The pages of the image are being erased, FirmwareUpdateWrite() already
+     buffers.*/
+    FIRMWARE_UPDATE_ERASING,
+    FIRMWARE_UPDATE_PROGRAMMING,
+    FIRMWARE_UPDATE_VERIFYING,
+    /**Checked, waiting for FirmwareUpdateActivate().*/
+    FIRMWARE_UPDATE_READY,
+    /**Boots from the next reset.*/
+    FIRMWARE_UPDATE_ACTIVATED,
+    FIRMWARE_UPDATE_ERROR
+} tFirmwareUpdateState;
+
+/**
+ * Cause of FIRMWARE_UPDATE_ERROR.
+ */
+typedef enum
+{
+    FIRMWARE_UPDATE_OK = 0,
+    FIRMWARE_UPDATE_ERROR_FLASH,
+    FIRMWARE_UPDATE_ERROR_CRC,
+    /**The stack pointer or the reset handler is not in the RAM or the
+     bank, the image is not linked for it.*/
+    FIRMWARE_UPDATE_ERROR_VECTORS
+} tFirmwareUpdateError;
+
+bool FirmwareUpdateIsDualBoot(void);
+bool FirmwareUpdateEnableDualBoot(void);
+uint32_t FirmwareUpdateTargetBank(void);
+bool FirmwareUpdateBegin(uint32_t size);
+uint32_t FirmwareUpdateWrite(const uint8_t *data, uint32_t length);
+bool FirmwareUpdateFinish(uint32_t crc);
+void FirmwareUpdateAbort(void);
+void FirmwareUpdateTasks(void);
+tFirmwareUpdateState FirmwareUpdateGetState(void);
+tFirmwareUpdateError FirmwareUpdateGetError(void);
+uint32_t FirmwareUpdateGetProgress(void);
+bool FirmwareUpdateActivate(void);
+void FirmwareUpdateInterruptHandler(void);
+
+#endif /* FIRMWAREUPDATE_H */
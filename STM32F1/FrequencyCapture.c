@@ -0,0 +1,400 @@
+/**
+ *  @file       FrequencyCapture.c
+ *  @author     Luis Maduro
+ *  @version    1.00
+ *  @date       14/10/2026
+ *  @brief      Period, duty and frequency of a signal by DMA input capture.
+ *
+ *  Copyright (C) 2026  Luis Maduro
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "FrequencyCapture.h"
+#include "PowerManager.h"
+
+/**Ranges 0 to 2 capture one rising edge in 8, 4 and 2 at the full clock,
+ from range 3 every edge is captured and the timer prescaler is
+ 2^(range - 3).*/
+#define FREQUENCY_CAPTURE_DIRECT        3
+#define FREQUENCY_CAPTURE_RANGES        (FREQUENCY_CAPTURE_DIRECT + 11)
+
+/**Half-words of the buffer, a CCR1 and CCR2 pair per capture.*/
+#define FREQUENCY_CAPTURE_BUFFER        (4 * FREQUENCY_CAPTURE_BATCH)
+
+static const uint16_t inputPrescaler[FREQUENCY_CAPTURE_DIRECT + 1] = {
+    TIM_ICPSC_DIV8, TIM_ICPSC_DIV4, TIM_ICPSC_DIV2, TIM_ICPSC_DIV1
+};
+
+static uint16_t captures[FREQUENCY_CAPTURE_BUFFER];
+/**Clock of TIM2.*/
+static uint32_t clock;
+static uint8_t range;
+/**Last rising edge of the half before, not valid after a range change.*/
+static uint16_t lastRise;
+static bool lastValid;
+/**Halves to drop, the range changed while they filled.*/
+static uint8_t skip;
+/**DMA counter at the last update, to find the counter periods without an
+ edge.*/
+static uint16_t lastRemaining;
+static uint8_t idle;
+
+static volatile tFrequencyCaptureResult latest;
+static uint32_t sequenceRead;
+static bool running = false;
+
+/**
+ * Gives the edges per capture of the current range.
+ */
+static uint32_t FrequencyCaptureDivider(void)
+{
+    return (range < FREQUENCY_CAPTURE_DIRECT) ? (8UL >> range) : 1;
+}
+
+/**
+ * Gives the timer prescaler of the current range, PSC + 1.
+ */
+static uint32_t FrequencyCapturePrescaler(void)
+{
+    return (range < FREQUENCY_CAPTURE_DIRECT) ? 1 : (1UL << (range - FREQUENCY_CAPTURE_DIRECT));
+}
+
+/**
+ * Sets a range, the counter restarts and the half being filled is dropped.
+ */
+static void FrequencyCaptureSetRange(uint8_t newRange)
+{
+    uint8_t input = (newRange < FREQUENCY_CAPTURE_DIRECT) ? newRange : FREQUENCY_CAPTURE_DIRECT;
+
+    range = newRange;
+
+    TIM_SetIC1Prescaler(TIM2, inputPrescaler[input]);
+    TIM_SetIC2Prescaler(TIM2, inputPrescaler[input]);
+    //URS is set, the update generated makes no interrupt
+    TIM_PrescalerConfig(TIM2, (uint16_t) (FrequencyCapturePrescaler() - 1),
+                        TIM_PSCReloadMode_Immediate);
+
+    skip = 1;
+    lastValid = false;
+    idle = 0;
+}
+
+/**
+ * Publishes a result.
+ */
+static void FrequencyCapturePublish(uint32_t frequency, uint32_t periodMin,
+                                    uint32_t periodMax, uint32_t periodMean,
+                                    uint16_t duty, uint16_t count)
+{
+    latest.frequency = frequency;
+    latest.periodMin = periodMin;
+    latest.periodMax = periodMax;
+    latest.periodMean = periodMean;
+    latest.duty = duty;
+    latest.count = count;
+    latest.sequence++;
+}
+
+/**
+ * Converts timer ticks of the current range to ns of one period.
+ */
+static uint32_t FrequencyCaptureNanoseconds(uint32_t ticks)
+{
+    return (uint32_t) ((uint64_t) ticks * FrequencyCapturePrescaler() * 1000000000ULL /
+                       ((uint64_t) clock * FrequencyCaptureDivider()));
+}
+
+/**
+ * Reduces a half of the buffer to a batch of statistics and follows the
+ * signal with the range.
+ */
+static void FrequencyCaptureBatch(const uint16_t *pairs)
+{
+    uint32_t sum = 0;
+    uint32_t sumHigh = 0;
+    uint32_t sumHighPeriod = 0;
+    uint16_t count = 0;
+    uint16_t minimum = 0xFFFF;
+    uint16_t maximum = 0;
+    uint16_t period;
+    uint16_t high;
+    uint32_t mean;
+    uint8_t newRange;
+    unsigned int i;
+
+    if (skip)
+    {
+        skip--;
+        lastValid = false;
+        return;
+    }
+
+    //CCR2 holds the falling edge between the rising edge before and this one
+    for (i = 0; i < 2 * FREQUENCY_CAPTURE_BATCH; i += 2)
+    {
+        if (lastValid)
+        {
+            period = pairs[i] - lastRise;
+            high = pairs[i + 1] - lastRise;
+
+            if (period != 0)
+            {
+                count++;
+                sum += period;
+                if (period < minimum)
+                    minimum = period;
+                if (period > maximum)
+                    maximum = period;
+
+                if (high < period)
+                {
+                    sumHigh += high;
+                    sumHighPeriod += period;
+                }
+            }
+        }
+
+        lastRise = pairs[i];
+        lastValid = true;
+    }
+
+    if (count == 0)
+    {
+        return;
+    }
+
+    mean = sum / count;
+
+    FrequencyCapturePublish(
+        (uint32_t) ((uint64_t) count * FrequencyCaptureDivider() * clock * 1000ULL /
+                    ((uint64_t) sum * FrequencyCapturePrescaler())),
+        FrequencyCaptureNanoseconds(minimum),
+        FrequencyCaptureNanoseconds(maximum),
+        FrequencyCaptureNanoseconds(mean),
+        (FrequencyCaptureDivider() == 1 && sumHighPeriod != 0) ?
+            (uint16_t) ((uint64_t) sumHigh * 10000 / sumHighPeriod) : FREQUENCY_CAPTURE_NO_DUTY,
+        count);
+
+    newRange = range;
+
+    if (maximum > 0xC000)
+    {
+        newRange = range + 1;
+    }
+    else if ((range > FREQUENCY_CAPTURE_DIRECT) ? (maximum < 0x4000) :
+             (range > 0 && mean < FREQUENCY_CAPTURE_MIN_TICKS))
+    {
+        newRange = range - 1;
+    }
+    else if (range < FREQUENCY_CAPTURE_DIRECT && mean > 4 * FREQUENCY_CAPTURE_MIN_TICKS)
+    {
+        newRange = range + 1;
+    }
+
+    if (newRange != range && newRange < FREQUENCY_CAPTURE_RANGES)
+    {
+        FrequencyCaptureSetRange(newRange);
+    }
+}
+
+/**
+ * Starts measuring the signal on PA0.
+ */
+void FrequencyCaptureInit(void)
+{
+    GPIO_InitTypeDef GPIO_InitStructure;
+    TIM_TimeBaseInitTypeDef TIM_TimeBaseStructure;
+    TIM_ICInitTypeDef TIM_ICInitStructure;
+    DMA_InitTypeDef DMA_InitStructure;
+    NVIC_InitTypeDef NVIC_InitStructure;
+    RCC_ClocksTypeDef clocks;
+
+    RCC_AHBPeriphClockCmd(RCC_AHBPeriph_DMA1, ENABLE);
+    RCC_APB1PeriphClockCmd(RCC_APB1Periph_TIM2, ENABLE);
+    RCC_APB2PeriphClockCmd(RCC_APB2Periph_GPIOA, ENABLE);
+
+    //the timers of APB1 run at twice PCLK1 when APB1 is divided
+    RCC_GetClocksFreq(&clocks);
+    clock = clocks.PCLK1_Frequency;
+    if (RCC->CFGR & RCC_CFGR_PPRE1_2)
+    {
+        clock *= 2;
+    }
+
+    GPIO_InitStructure.GPIO_Pin = GPIO_Pin_0;
+    GPIO_InitStructure.GPIO_Mode = GPIO_Mode_IN_FLOATING;
+    GPIO_InitStructure.GPIO_Speed = GPIO_Speed_50MHz;
+    GPIO_Init(GPIOA, &GPIO_InitStructure);
+
+    TIM_DeInit(TIM2);
+    TIM_TimeBaseStructInit(&TIM_TimeBaseStructure);
+    TIM_TimeBaseStructure.TIM_Period = 0xFFFF;
+    TIM_TimeBaseInit(TIM2, &TIM_TimeBaseStructure);
+    TIM_UpdateRequestConfig(TIM2, TIM_UpdateSource_Regular);
+
+    //both edges of TI1, CC2 captures the falling one
+    TIM_ICInitStructure.TIM_Channel = TIM_Channel_1;
+    TIM_ICInitStructure.TIM_ICPolarity = TIM_ICPolarity_Rising;
+    TIM_ICInitStructure.TIM_ICSelection = TIM_ICSelection_DirectTI;
+    TIM_ICInitStructure.TIM_ICPrescaler = TIM_ICPSC_DIV1;
+    TIM_ICInitStructure.TIM_ICFilter = FREQUENCY_CAPTURE_FILTER;
+    TIM_ICInit(TIM2, &TIM_ICInitStructure);
+    TIM_ICInitStructure.TIM_Channel = TIM_Channel_2;
+    TIM_ICInitStructure.TIM_ICPolarity = TIM_ICPolarity_Falling;
+    TIM_ICInitStructure.TIM_ICSelection = TIM_ICSelection_IndirectTI;
+    TIM_ICInit(TIM2, &TIM_ICInitStructure);
+
+    //every CC1 capture moves CCR1 and CCR2 through DMAR
+    TIM_DMAConfig(TIM2, TIM_DMABase_CCR1, TIM_DMABurstLength_2Transfers);
+    TIM_DMACmd(TIM2, TIM_DMA_CC1, ENABLE);
+
+    DMA_DeInit(DMA1_Channel5);
+    DMA_InitStructure.DMA_PeripheralBaseAddr = (uint32_t) &TIM2->DMAR;
+    DMA_InitStructure.DMA_MemoryBaseAddr = (uint32_t) captures;
+    DMA_InitStructure.DMA_DIR = DMA_DIR_PeripheralSRC;
+    DMA_InitStructure.DMA_BufferSize = FREQUENCY_CAPTURE_BUFFER;
+    DMA_InitStructure.DMA_PeripheralInc = DMA_PeripheralInc_Disable;
+    DMA_InitStructure.DMA_MemoryInc = DMA_MemoryInc_Enable;
+    DMA_InitStructure.DMA_PeripheralDataSize = DMA_PeripheralDataSize_HalfWord;
+    DMA_InitStructure.DMA_MemoryDataSize = DMA_MemoryDataSize_HalfWord;
+    DMA_InitStructure.DMA_Mode = DMA_Mode_Circular;
+    DMA_InitStructure.DMA_Priority = DMA_Priority_High;
+    DMA_InitStructure.DMA_M2M = DMA_M2M_Disable;
+    DMA_Init(DMA1_Channel5, &DMA_InitStructure);
+    DMA_ITConfig(DMA1_Channel5, DMA_IT_HT | DMA_IT_TC, ENABLE);
+    DMA_Cmd(DMA1_Channel5, ENABLE);
+
+    NVIC_InitStructure.NVIC_IRQChannelPreemptionPriority = FREQUENCY_CAPTURE_IRQ_PRIORITY;
+    NVIC_InitStructure.NVIC_IRQChannelSubPriority = 0;
+    NVIC_InitStructure.NVIC_IRQChannelCmd = ENABLE;
+    NVIC_InitStructure.NVIC_IRQChannel = DMA1_Channel5_IRQn;
+    NVIC_Init(&NVIC_InitStructure);
+    NVIC_InitStructure.NVIC_IRQChannel = TIM2_IRQn;
+    NVIC_Init(&NVIC_InitStructure);
+
+    lastRemaining = FREQUENCY_CAPTURE_BUFFER;
+    FrequencyCaptureSetRange(FREQUENCY_CAPTURE_DIRECT);
+    skip = 0;
+
+    TIM_ITConfig(TIM2, TIM_IT_Update, ENABLE);
+    TIM_Cmd(TIM2, ENABLE);
+
+    if (!running)
+    {
+        running = true;
+#ifdef USE_POWER_MANAGER
+        PowerManagerKeepAwake(POWER_MODE_STOP);
+#endif
+    }
+}
+
+/**
+ * Stops measuring.
+ */
+void FrequencyCaptureStop(void)
+{
+    TIM_Cmd(TIM2, DISABLE);
+    TIM_ITConfig(TIM2, TIM_IT_Update, DISABLE);
+    DMA_Cmd(DMA1_Channel5, DISABLE);
+
+    if (running)
+    {
+        running = false;
+#ifdef USE_POWER_MANAGER
+        PowerManagerAllow(POWER_MODE_STOP);
+#endif
+    }
+}
+
+/**
+ * Gives the last result.
+ * @param result Result.
+ * @return True if it is new since the last call.
+ */
+bool FrequencyCaptureGet(tFrequencyCaptureResult *result)
+{
+    uint32_t primask;
+
+    //the interrupts write it
+    primask = __get_PRIMASK();
+    __disable_irq();
+    *result = *(tFrequencyCaptureResult *) &latest;
+    __set_PRIMASK(primask);
+
+    if (result->sequence == sequenceRead)
+    {
+        return false;
+    }
+
+    sequenceRead = result->sequence;
+
+    return true;
+}
+
+/**
+ * This funtion is intended to be put in DMA1_Channel5_IRQHandler(), it
+ * reduces the half of the buffer just filled.
+ */
+void FrequencyCaptureDMAInterruptHandler(void)
+{
+    if (DMA_GetITStatus(DMA1_IT_HT5) != RESET)
+    {
+        DMA_ClearITPendingBit(DMA1_IT_HT5);
+        FrequencyCaptureBatch(captures);
+    }
+
+    if (DMA_GetITStatus(DMA1_IT_TC5) != RESET)
+    {
+        DMA_ClearITPendingBit(DMA1_IT_TC5);
+        FrequencyCaptureBatch(captures + FREQUENCY_CAPTURE_BUFFER / 2);
+    }
+}
+
+/**
+ * This funtion is intended to be put in TIM2_IRQHandler(). A counter
+ * period without an edge means a period longer than the counter, the range
+ * goes up, and at the slowest range the signal is reported lost.
+ */
+void FrequencyCaptureTimerInterruptHandler(void)
+{
+    uint16_t remaining;
+
+    if (TIM_GetITStatus(TIM2, TIM_IT_Update) == RESET)
+    {
+        return;
+    }
+
+    TIM_ClearITPendingBit(TIM2, TIM_IT_Update);
+
+    remaining = DMA_GetCurrDataCounter(DMA1_Channel5);
+
+    if (remaining != lastRemaining)
+    {
+        lastRemaining = remaining;
+        idle = 0;
+        return;
+    }
+
+    idle++;
+
+    if (range + 1 < FREQUENCY_CAPTURE_RANGES)
+    {
+        FrequencyCaptureSetRange(range + 1);
+    }
+    else if (idle == FREQUENCY_CAPTURE_TIMEOUT)
+    {
+        FrequencyCapturePublish(0, 0, 0, 0, FREQUENCY_CAPTURE_NO_DUTY, 0);
+    }
+}
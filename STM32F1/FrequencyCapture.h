@@ -0,0 +1,102 @@
+/**
+ *  @file       FrequencyCapture.h
+ *  @author     Luis Maduro
+ *  @version    1.00
+ *  @date       14/10/2026
+ *  @brief      Period, duty and frequency of a signal by DMA input capture.
+ *
+ *  The signal is on TIM2 channel 1 (PA0). The counter runs freely, CC1
+ *  captures the rising edges and CC2 the falling ones of the same input,
+ *  and every CC1 capture starts a DMA burst of CCR1 and CCR2 into a
+ *  circular buffer. The CPU sees one interrupt per half of the buffer,
+ *  where the periods and high times of the half are reduced to a batch of
+ *  statistics, so the load doesn't grow with the frequency.
+ *
+ *  The range follows the signal after every batch:
+ *  - a period close to the 16 bit counter doubles the timer prescaler, and
+ *    so does the update interrupt after a counter period without an
+ *    edge;
+ *  - a shorter one than a quarter of the counter halves it;
+ *  - from FREQUENCY_CAPTURE_MIN_TICKS (i.e. several hundred kHz at 72 MHz)
+ *    the input prescaler captures one edge in 2, 4 or 8, the DMA rate stays
+ *    bounded and the duty is not measured.
+ *  The batch during which the range changes is dropped.
+ *
+ *  Copyright (C) 2026  Luis Maduro
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef FREQUENCYCAPTURE_H
+#define FREQUENCYCAPTURE_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stm32f10x.h>
+
+/**Periods of a batch, the buffer holds two batches of captures.*/
+#ifndef FREQUENCY_CAPTURE_BATCH
+#define FREQUENCY_CAPTURE_BATCH         64
+#endif
+
+/**Mean period, in timer ticks, under which the input prescaler is used.*/
+#ifndef FREQUENCY_CAPTURE_MIN_TICKS
+#define FREQUENCY_CAPTURE_MIN_TICKS     256
+#endif
+
+/**Digital filter of the input, 0 to 15 (the ICF field).*/
+#ifndef FREQUENCY_CAPTURE_FILTER
+#define FREQUENCY_CAPTURE_FILTER        0
+#endif
+
+/**Counter periods without an edge, at the slowest range, before the signal
+ is reported lost.*/
+#ifndef FREQUENCY_CAPTURE_TIMEOUT
+#define FREQUENCY_CAPTURE_TIMEOUT       4
+#endif
+
+/**Priority of the TIM2 and DMA1 channel 5 interrupts.*/
+#ifndef FREQUENCY_CAPTURE_IRQ_PRIORITY
+#define FREQUENCY_CAPTURE_IRQ_PRIORITY  2
+#endif
+
+/**Duty of a result when it is not measured.*/
+#define FREQUENCY_CAPTURE_NO_DUTY       0xFFFF
+
+/**
+ * Statistics of a batch.
+ */
+typedef struct
+{
+    /**Mean frequency, in mHz.*/
+    uint32_t frequency;
+    /**Periods, in ns.*/
+    uint32_t periodMin;
+    uint32_t periodMax;
+    uint32_t periodMean;
+    /**Mean duty in 0.01 %, or FREQUENCY_CAPTURE_NO_DUTY.*/
+    uint16_t duty;
+    /**Periods measured, 0 when the signal is lost.*/
+    uint16_t count;
+    /**Incremented with every result.*/
+    uint32_t sequence;
+} tFrequencyCaptureResult;
+
+void FrequencyCaptureInit(void);
+void FrequencyCaptureStop(void);
+bool FrequencyCaptureGet(tFrequencyCaptureResult *result);
+void FrequencyCaptureDMAInterruptHandler(void);
+void FrequencyCaptureTimerInterruptHandler(void);
+
+#endif /* FREQUENCYCAPTURE_H */
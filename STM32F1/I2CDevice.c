@@ -32,13 +32,82 @@
  *
  */
 
+#include <stddef.h>
 #include "I2CDevice.h"
+#include "Trace.h"
+
+/**
+ * Steps of an interrupt driven transaction, done by the event interrupt of
+ * I2C1 and, for the bytes, by DMA1 channel 6 (transmit) and 7 (receive).
+ */
+typedef enum
+{
+    I2C_STATE_IDLE,
+    I2C_STATE_START,
+    I2C_STATE_ADDRESS,
+    I2C_STATE_REGISTER,
+    I2C_STATE_WRITE,
+    I2C_STATE_RESTART,
+    I2C_STATE_READ_ADDRESS,
+    I2C_STATE_READ
+} tI2CState;
 
 /**This variable contains the address to read from the current device.*/
 unsigned char deviceAddressRead;
 /**This variable contains the address to write to the current device.*/
 unsigned char deviceAddressWrite;
 
+/**Queue of transactions, the first one is being done by the interrupts.*/
+static tI2CTransaction *volatile queueHead = NULL;
+static tI2CTransaction *queueTail = NULL;
+/**Step of the current transaction.*/
+static volatile tI2CState transactionState = I2C_STATE_IDLE;
+/**Status given to the transaction after the stop.*/
+static tI2CTransactionStatus transactionResult;
+
+static void I2CDeviceTransactionBegin(void);
+
+/**
+ * Configures I2C1 as master at I2C_SPEED on PB6 (SCL) and PB7 (SDA), and the
+ * interrupts of the transactions.
+ * @warning Hardware specific!
+ */
+void I2CInit(void)
+{
+    GPIO_InitTypeDef GPIO_InitStructure;
+    I2C_InitTypeDef I2C_InitStructure;
+    NVIC_InitTypeDef NVIC_InitStructure;
+
+    RCC_APB2PeriphClockCmd(RCC_APB2Periph_GPIOB, ENABLE);
+    RCC_APB1PeriphClockCmd(RCC_APB1Periph_I2C1, ENABLE);
+    RCC_AHBPeriphClockCmd(RCC_AHBPeriph_DMA1, ENABLE);
+
+    GPIO_InitStructure.GPIO_Pin = GPIO_Pin_6 | GPIO_Pin_7;
+    GPIO_InitStructure.GPIO_Mode = GPIO_Mode_AF_OD;
+    GPIO_InitStructure.GPIO_Speed = GPIO_Speed_50MHz;
+    GPIO_Init(GPIOB, &GPIO_InitStructure);
+
+    I2C_DeInit(I2C1);
+    I2C_InitStructure.I2C_Mode = I2C_Mode_I2C;
+    I2C_InitStructure.I2C_DutyCycle = I2C_DutyCycle_2;
+    I2C_InitStructure.I2C_OwnAddress1 = 0x00;
+    I2C_InitStructure.I2C_Ack = I2C_Ack_Enable;
+    I2C_InitStructure.I2C_AcknowledgedAddress = I2C_AcknowledgedAddress_7bit;
+    I2C_InitStructure.I2C_ClockSpeed = I2C_SPEED;
+    I2C_Cmd(I2C1, ENABLE);
+    I2C_Init(I2C1, &I2C_InitStructure);
+
+    NVIC_InitStructure.NVIC_IRQChannelPreemptionPriority = I2C_IRQ_PRIORITY;
+    NVIC_InitStructure.NVIC_IRQChannelSubPriority = 0;
+    NVIC_InitStructure.NVIC_IRQChannelCmd = ENABLE;
+    NVIC_InitStructure.NVIC_IRQChannel = I2C1_EV_IRQn;
+    NVIC_Init(&NVIC_InitStructure);
+    NVIC_InitStructure.NVIC_IRQChannel = I2C1_ER_IRQn;
+    NVIC_Init(&NVIC_InitStructure);
+    NVIC_InitStructure.NVIC_IRQChannel = DMA1_Channel7_IRQn;
+    NVIC_Init(&NVIC_InitStructure);
+}
+
 /**
  * Sends a start condition to the I2C bus.
  * @warning Hardware specific!
@@ -87,27 +156,49 @@ void I2CNotAck(void)
 }
 
 /**
- * Send the address of the slave through the bus.
- * @param address Address of the slave.
+ * Sends an address byte and waits for the end of the address phase.
+ * @param address Address of the slave SHIFTED, the direction bit is set by
+ *                I2C_Send7bitAddress().
  */
-void I2CSendAddress(unsigned char Address, unsigned char I2C_Direction)
+static void I2CSend7bitAddress(unsigned char address, unsigned char I2C_Direction)
 {
-    I2C_Send7bitAddress(I2C1, Address, I2C_Direction);
+    I2C_Send7bitAddress(I2C1, address, I2C_Direction);
     if (I2C_Direction == I2C_Direction_Receiver)
         while (!I2C_CheckEvent(I2C1, I2C_EVENT_MASTER_RECEIVER_MODE_SELECTED));
     else if (I2C_Direction == I2C_Direction_Transmitter)
         while (!I2C_CheckEvent(I2C1, I2C_EVENT_MASTER_TRANSMITTER_MODE_SELECTED));
 }
 
+/**
+ * Send the address of the slave through the bus.
+ * @param address Address of the slave NOT SHIFTED.
+ */
+void I2CSendAddress(unsigned char Address, unsigned char I2C_Direction)
+{
+    I2CDeviceSetDeviceAddress(Address);
+    if (I2C_Direction == I2C_Direction_Receiver)
+        I2CSend7bitAddress(deviceAddressRead, I2C_Direction);
+    else if (I2C_Direction == I2C_Direction_Transmitter)
+        I2CSend7bitAddress(deviceAddressWrite, I2C_Direction);
+}
+
 /**
  * Sends a byte through the I2C bus.
  * @param data_out Data byte to be sent.
  * @return 0 if all went well !=0 if not.
  */
-void I2CWrite(unsigned char data_out)
+unsigned char I2CWrite(unsigned char data_out)
 {
     I2C_SendData(I2C1, data_out);
-    while (!I2C_CheckEvent(I2C1, I2C_EVENT_MASTER_BYTE_TRANSMITTED));
+    while (!I2C_CheckEvent(I2C1, I2C_EVENT_MASTER_BYTE_TRANSMITTED))
+    {
+        if (I2C_GetFlagStatus(I2C1, I2C_FLAG_AF) == SET)
+        {
+            I2C_ClearFlag(I2C1, I2C_FLAG_AF);
+            return 1;
+        }
+    }
+    return 0;
 }
 
 /**
@@ -127,12 +218,100 @@ unsigned char I2CRead(void)
  */
 void I2CDeviceSetDeviceAddress(unsigned char address)
 {
-    deviceAddressRead = (address << 1);
-    deviceAddressWrite = (address << 1);
+    deviceAddressRead = (address << 1) | 0x01;
+    deviceAddressWrite = (address << 1) & 0xFE;
+}
+
+/**
+ * Sets up a DMA1 channel of I2C1, channel 6 transmits and channel 7
+ * receives. The channel is enabled by the caller.
+ * @param channel DMA1_Channel6 or DMA1_Channel7.
+ * @param data Bytes to send or buffer of the bytes received.
+ * @param length Number of bytes, not more than 65535.
+ * @param interrupt ENABLE for the interrupt at the end of the transfer.
+ */
+static void I2CDeviceConfigureDMA(DMA_Channel_TypeDef *channel,
+                                  unsigned char *data,
+                                  unsigned int length,
+                                  FunctionalState interrupt)
+{
+    DMA_InitTypeDef DMA_InitStructure;
+
+    DMA_DeInit(channel);
+    DMA_InitStructure.DMA_PeripheralBaseAddr = (uint32_t) &I2C1->DR;
+    DMA_InitStructure.DMA_MemoryBaseAddr = (uint32_t) data;
+    DMA_InitStructure.DMA_DIR = (channel == DMA1_Channel6) ? DMA_DIR_PeripheralDST : DMA_DIR_PeripheralSRC;
+    DMA_InitStructure.DMA_BufferSize = length;
+    DMA_InitStructure.DMA_PeripheralInc = DMA_PeripheralInc_Disable;
+    DMA_InitStructure.DMA_MemoryInc = DMA_MemoryInc_Enable;
+    DMA_InitStructure.DMA_PeripheralDataSize = DMA_PeripheralDataSize_Byte;
+    DMA_InitStructure.DMA_MemoryDataSize = DMA_MemoryDataSize_Byte;
+    DMA_InitStructure.DMA_Mode = DMA_Mode_Normal;
+    DMA_InitStructure.DMA_Priority = DMA_Priority_High;
+    DMA_InitStructure.DMA_M2M = DMA_M2M_Disable;
+    DMA_Init(channel, &DMA_InitStructure);
+
+    DMA_ITConfig(channel, DMA_IT_TC, interrupt);
 }
 
 /**
- * Read multiple bytes from a device register.
+ * Stops the DMA requests of I2C1 and both of its channels.
+ */
+static void I2CDeviceStopDMA(void)
+{
+    I2C_DMACmd(I2C1, DISABLE);
+    I2C_DMALastTransferCmd(I2C1, DISABLE);
+    DMA_Cmd(DMA1_Channel6, DISABLE);
+    DMA_Cmd(DMA1_Channel7, DISABLE);
+    DMA_ClearFlag(DMA1_FLAG_GL6 | DMA1_FLAG_GL7);
+}
+
+/**
+ * Sends the read address and receives 2 bytes or more by DMA, the last one
+ * not acknowledged, then sends a stop. Called after the start.
+ * @param length Number of bytes to read
+ * @param data Buffer to store read data in
+ */
+static void I2CDeviceReceiveDMA(unsigned int length,
+                                unsigned char *data)
+{
+    //armed before the address, the first byte comes right after it
+    I2CDeviceConfigureDMA(DMA1_Channel7, data, length, DISABLE);
+    I2C_DMALastTransferCmd(I2C1, ENABLE);
+    I2CAck();
+    I2C_DMACmd(I2C1, ENABLE);
+    DMA_Cmd(DMA1_Channel7, ENABLE);
+
+    I2CSend7bitAddress(deviceAddressRead, I2C_Direction_Receiver);
+
+    while (DMA_GetFlagStatus(DMA1_FLAG_TC7) == RESET);
+
+    I2CStop();
+    I2CDeviceStopDMA();
+}
+
+/**
+ * Sends bytes by DMA and waits for the last one to leave the shift
+ * register. Called after the register address.
+ * @param length Number of bytes to write
+ * @param data Buffer to copy new data from
+ */
+static void I2CDeviceSendDMA(unsigned int length,
+                             unsigned char *data)
+{
+    I2CDeviceConfigureDMA(DMA1_Channel6, data, length, DISABLE);
+    I2C_DMACmd(I2C1, ENABLE);
+    DMA_Cmd(DMA1_Channel6, ENABLE);
+
+    while (DMA_GetFlagStatus(DMA1_FLAG_TC6) == RESET);
+    while (!I2C_CheckEvent(I2C1, I2C_EVENT_MASTER_BYTE_TRANSMITTED));
+
+    I2CDeviceStopDMA();
+}
+
+/**
+ * Read multiple bytes from a device register, by DMA from
+ * I2C_DMA_MIN_LENGTH bytes.
  * @param address First register address to read from
  * @param length Number of bytes to read
  * @param data Buffer to store read data in
@@ -141,11 +320,20 @@ void I2CDeviceReadBytes(unsigned char address,
                         unsigned int length,
                         unsigned char *data)
 {
+    while (I2CDeviceIsBusy());
+
     I2CStart();
-    I2CSendAddress(deviceAddressWrite, I2C_Direction_Transmitter);
+    I2CSend7bitAddress(deviceAddressWrite, I2C_Direction_Transmitter);
     I2CWrite(address);
     I2CRestart();
-    I2CSendAddress(deviceAddressRead, I2C_Direction_Receiver);
+
+    if (length >= I2C_DMA_MIN_LENGTH && length >= 2)
+    {
+        I2CDeviceReceiveDMA(length, data);
+        return;
+    }
+
+    I2CSend7bitAddress(deviceAddressRead, I2C_Direction_Receiver);
 
     I2CAck();
 
@@ -163,7 +351,46 @@ void I2CDeviceReadBytes(unsigned char address,
 }
 
 /**
- * Write multiple bytes to a device register.
+ * Read multiple bytes from the current register of the device, without
+ * writing the register address first. For the devices whose register
+ * pointer moves by itself (i.e. the HMC5883L wraps back to its first data
+ * register), one transfer less per read.
+ * @param length Number of bytes to read
+ * @param data Buffer to store read data in
+ */
+void I2CDeviceReadCurrentBytes(unsigned int length,
+                               unsigned char *data)
+{
+    while (I2CDeviceIsBusy());
+
+    I2CStart();
+
+    if (length >= I2C_DMA_MIN_LENGTH && length >= 2)
+    {
+        I2CDeviceReceiveDMA(length, data);
+        return;
+    }
+
+    I2CSend7bitAddress(deviceAddressRead, I2C_Direction_Receiver);
+
+    I2CAck();
+
+    while (length)
+    {
+        if (length == 1)
+        {
+            I2CNotAck();
+            I2CStop();
+        }
+
+        *data++ = I2CRead();
+        length--;
+    }
+}
+
+/**
+ * Write multiple bytes to a device register, by DMA from
+ * I2C_DMA_MIN_LENGTH bytes.
  * @param address First register address to write to
  * @param length Number of bytes to write
  * @param data Buffer to copy new data from
@@ -172,61 +399,61 @@ void I2CDeviceWriteBytes(unsigned char address,
                          unsigned int length,
                          unsigned char *data)
 {
+    while (I2CDeviceIsBusy());
+
     I2CStart();
-    I2CSendAddress(deviceAddressWrite, I2C_Direction_Transmitter);
+    I2CSend7bitAddress(deviceAddressWrite, I2C_Direction_Transmitter);
     I2CWrite(address);
 
-    while (length)
+    if (length >= I2C_DMA_MIN_LENGTH)
     {
-        I2CWrite(*data++);
-        length--;
+        I2CDeviceSendDMA(length, data);
+    }
+    else
+    {
+        while (length)
+        {
+            I2CWrite(*data++);
+            length--;
+        }
     }
 
     I2CStop();
 }
 
 /**
- * Read a single bit from a device register.
- * @param address Register address to read from
- * @param _bit Bit in register position to read (0-7)
- * @return Single bit value
+ * Write several messages to the device in one transaction, joined by
+ * repeated starts, for devices that take a new address for every command.
+ * @param count Number of messages
+ * @param size Bytes of every message
+ * @param data Buffer with the messages one after the other
  */
-unsigned char I2CDeviceReadBit(unsigned char address,
-                               unsigned char _bit)
+void I2CDeviceWriteMessages(unsigned char count,
+                            unsigned char size,
+                            unsigned char *data)
 {
-    return (I2CDeviceReadByte(address) & (1 << _bit));
-}
-
-/**
- * Read multiple bits from a device register.
- * @param address Register address to read from
- * @param bitStart First bit position to read (0-7)
- * @param length Number of bits to read (not more than 8)
- * @return Right-aligned value (i.e. '101' read from any bitStart position will
- *                              equal 0x05)
- */
-unsigned char I2CDeviceReadBits(unsigned char address,
-                                unsigned char bitStart,
-                                unsigned char length)
-{
-    // 01101001 read byte
-    // 76543210 bit numbers
-    //    xxx   args: bitStart=4, length=3
-    //    010   masked
-    //   -> 010 shifted
     unsigned char i;
-    unsigned char b;
-    unsigned char r = 0;
 
-    b = I2CDeviceReadByte(address);
+    while (I2CDeviceIsBusy());
 
-    for (i = bitStart; i > bitStart - length; i--)
+    I2CStart();
+
+    while (count--)
     {
-        r |= (b & (1 << i));
+        I2CSend7bitAddress(deviceAddressWrite, I2C_Direction_Transmitter);
+
+        for (i = 0; i < size; i++)
+        {
+            I2CWrite(*data++);
+        }
+
+        if (count)
+        {
+            I2CRestart();
+        }
     }
-    r >>= (bitStart - length + 1);
 
-    return r;
+    I2CStop();
 }
 
 /**
@@ -242,71 +469,458 @@ unsigned char I2CDeviceReadByte(unsigned char address)
 }
 
 /**
- * Write a single bit to a device register.
+ * Write some bits of a device register, the others keep their value.
  * @param address Register address to write to
- * @param _bit Bit position to write (0-7)
- * @param value New bit value to write
+ * @param mask Bits to write, i.e. REGISTER_FIELD_MASK() of the fields
+ * @param value New value of the bits, in place (REGISTER_FIELD_VALUE())
  */
-void I2CDeviceWriteBit(unsigned char address,
-                       unsigned char _bit,
-                       unsigned char value)
+void I2CDeviceUpdateByte(unsigned char address,
+                         unsigned char mask,
+                         unsigned char value)
 {
     unsigned char b;
 
     b = I2CDeviceReadByte(address);
 
-    b = value ? (b | (1 << _bit)) : (b & ~(1 << _bit));
+    b = (b & ~mask) | (value & mask);
 
     I2CDeviceWriteByte(address, b);
 }
 
 /**
- * Write multiple bits to a device register.
+ * Write single byte to a device register.
  * @param address Register address to write to
- * @param bitStart First bit position to write (0-7)
- * @param length Number of bits to write (not more than 8)
- * @param value Right-aligned value to write
+ * @param value New byte value write
  */
-void I2CDeviceWriteBits(unsigned char address,
-                        unsigned char bitStart,
-                        unsigned char length,
+void I2CDeviceWriteByte(unsigned char address,
                         unsigned char value)
 {
-    //      010 value to write
-    // 76543210 bit numbers
-    //    xxx   args: bitStart=4, length=3
-    // 01000000 shift left (8 - length)    ]
-    // 00001000 shift right (7 - bitStart) ] ---    two shifts ensure all
-    //                                              non-important bits are 0
-    // 11100011 mask byte
-    // 10101111 original value (sample)
-    // 10100011 original & mask
-    // 10101011 masked | value
-    unsigned char b;
-    unsigned char mask;
+    I2CDeviceWriteBytes(address, 1, &value);
+}
 
-    b = I2CDeviceReadByte(address);
+/**
+ * Starts a transaction that runs in the background, the address phases in
+ * the I2C1 event interrupt and the bytes by DMA. If the bus is busy the
+ * transaction waits in a queue, so the drivers of several devices share the
+ * bus, and the transactions run in order. I2CDeviceInterruptHandler(),
+ * I2CDeviceErrorInterruptHandler() and I2CDeviceDMAInterruptHandler() must
+ * be called from I2C1_EV_IRQHandler(), I2C1_ER_IRQHandler() and
+ * DMA1_Channel7_IRQHandler().
+ * @param transaction Transaction to do, it must stay valid until it ends.
+ * @return 0 if the transaction was started or queued, !=0 if it is not
+ *         valid or already queued.
+ */
+unsigned char I2CDeviceStartTransaction(tI2CTransaction *transaction)
+{
+    uint32_t primask;
 
-    mask = (0xFF << (8 - length)) | (0xFF >> (bitStart + length - 1));
+    if (transaction == NULL || transaction->status == I2C_TRANSACTION_BUSY ||
+        transaction->length > 0xFFFF ||
+        (transaction->direction != I2C_Direction_Transmitter &&
+         transaction->length == 0))
+        return 1;
 
-    value <<= (8 - length);
+    transaction->status = I2C_TRANSACTION_BUSY;
+    transaction->next = NULL;
 
-    value >>= (7 - bitStart);
+    //the interrupts also change the queue
+    primask = __get_PRIMASK();
+    __disable_irq();
 
-    b &= mask;
+    if (queueHead == NULL)
+    {
+        queueHead = transaction;
+        queueTail = transaction;
+        I2CDeviceTransactionBegin();
+    }
+    else
+    {
+        queueTail->next = transaction;
+        queueTail = transaction;
+    }
 
-    b |= value;
+    __set_PRIMASK(primask);
 
-    I2CDeviceWriteByte(address, b);
+    return 0;
 }
 
 /**
- * Write single byte to a device register.
- * @param address Register address to write to
- * @param value New byte value write
+ * Queues a transaction to a device.
+ * @param device Device of the transaction.
+ * @param transaction Transaction to do, its device address is set.
+ * @return 0 if the transaction was started or queued, !=0 otherwise.
  */
-void I2CDeviceWriteByte(unsigned char address,
-                        unsigned char value)
+unsigned char I2CDeviceQueueTransaction(tI2CDevice *device,
+                                        tI2CTransaction *transaction)
 {
-    I2CDeviceWriteBytes(address, 1, &value);
+    transaction->deviceAddress = device->address;
+
+    return I2CDeviceStartTransaction(transaction);
+}
+
+/**
+ * Tells if interrupt driven transactions are running or queued. The
+ * blocking functions wait for them to end before using the bus.
+ * @return !=0 while a transaction is running.
+ */
+unsigned char I2CDeviceIsBusy(void)
+{
+    return transactionState != I2C_STATE_IDLE || queueHead != NULL;
+}
+
+/**
+ * Keeps the transactions from ending while a driver changes data shared
+ * with its callbacks, the interrupts are disabled until I2CDeviceUnlock().
+ * @return State to give to I2CDeviceUnlock().
+ */
+unsigned char I2CDeviceLock(void)
+{
+    unsigned char state = (unsigned char) __get_PRIMASK();
+
+    __disable_irq();
+
+    return state;
+}
+
+/**
+ * Ends I2CDeviceLock().
+ * @param state Value returned by I2CDeviceLock().
+ */
+void I2CDeviceUnlock(unsigned char state)
+{
+    __set_PRIMASK(state);
+}
+
+/**
+ * Initializes the handle of a device, the address is kept in it so the
+ * drivers don't change each other's address.
+ * @param device Handle of the device.
+ * @param address Address of the slave NOT SHIFTED.
+ */
+void I2CDeviceInitHandle(tI2CDevice *device, unsigned char address)
+{
+    device->address = address;
+}
+
+/**
+ * Selects the device of the functions that don't take a handle
+ * (I2CDeviceReadByte(), I2CDeviceWriteBits()...).
+ * @param device Handle of the device.
+ */
+void I2CDeviceSelect(tI2CDevice *device)
+{
+    I2CDeviceSetDeviceAddress(device->address);
+}
+
+/**
+ * Reads registers of a device through the transaction queue, waiting for
+ * the end. The interrupts must be enabled, don't call it from an interrupt.
+ * @param device Device to read from.
+ * @param address First register address to read from
+ * @param length Number of bytes to read
+ * @param data Buffer to store read data in
+ * @return 0 if all went well, !=0 if the device didn't acknowledge.
+ */
+unsigned char I2CDeviceRead(tI2CDevice *device,
+                            unsigned char address,
+                            unsigned int length,
+                            unsigned char *data)
+{
+    tI2CTransaction transaction;
+
+    transaction.registerAddress = address;
+    transaction.direction = I2C_Direction_Receiver;
+    transaction.length = length;
+    transaction.data = data;
+    transaction.callback = NULL;
+    transaction.status = I2C_TRANSACTION_IDLE;
+
+    if (I2CDeviceQueueTransaction(device, &transaction))
+        return 1;
+
+    while (transaction.status == I2C_TRANSACTION_BUSY);
+
+    return transaction.status != I2C_TRANSACTION_DONE;
+}
+
+/**
+ * Writes registers of a device through the transaction queue, waiting for
+ * the end. The interrupts must be enabled, don't call it from an interrupt.
+ * @param device Device to write to.
+ * @param address First register address to write to
+ * @param length Number of bytes to write
+ * @param data Buffer to copy new data from
+ * @return 0 if all went well, !=0 if the device didn't acknowledge.
+ */
+unsigned char I2CDeviceWrite(tI2CDevice *device,
+                             unsigned char address,
+                             unsigned int length,
+                             unsigned char *data)
+{
+    tI2CTransaction transaction;
+
+    transaction.registerAddress = address;
+    transaction.direction = I2C_Direction_Transmitter;
+    transaction.length = length;
+    transaction.data = data;
+    transaction.callback = NULL;
+    transaction.status = I2C_TRANSACTION_IDLE;
+
+    if (I2CDeviceQueueTransaction(device, &transaction))
+        return 1;
+
+    while (transaction.status == I2C_TRANSACTION_BUSY);
+
+    return transaction.status != I2C_TRANSACTION_DONE;
+}
+
+/**
+ * Sends the start of the first transaction of the queue.
+ */
+static void I2CDeviceTransactionBegin(void)
+{
+    transactionResult = I2C_TRANSACTION_DONE;
+    transactionState = I2C_STATE_START;
+    TRACE(TRACE_EVENT_I2C_BEGIN, queueHead->deviceAddress | ((uint32_t) queueHead->length << 8));
+
+    I2C_ITConfig(I2C1, I2C_IT_EVT | I2C_IT_ERR, ENABLE);
+    I2C_GenerateSTART(I2C1, ENABLE);
+}
+
+/**
+ * Ends the first transaction of the queue, from the interrupts, once its
+ * stop is requested, and starts the next one.
+ */
+static void I2CDeviceComplete(void)
+{
+    tI2CTransaction *transaction = queueHead;
+
+    //the stop is sent before the start of the next transaction
+    while (I2C1->CR1 & I2C_CR1_STOP);
+
+    I2C_ITConfig(I2C1, I2C_IT_BUF, DISABLE);
+    I2CAck();
+
+    queueHead = transaction->next;
+
+    if (queueHead == NULL)
+    {
+        queueTail = NULL;
+    }
+
+    transactionState = I2C_STATE_IDLE;
+    transaction->status = transactionResult;
+    TRACE(TRACE_EVENT_I2C_END, transaction->deviceAddress | ((uint32_t) transactionResult << 8));
+
+    if (transaction->callback != NULL)
+    {
+        transaction->callback(transaction);
+    }
+
+    //next transaction, queued by another driver or the callback, which
+    //starts it itself when the queue was empty
+    if (queueHead == NULL)
+    {
+        I2C_ITConfig(I2C1, I2C_IT_EVT | I2C_IT_ERR, DISABLE);
+    }
+    else if (transactionState == I2C_STATE_IDLE)
+    {
+        I2CDeviceTransactionBegin();
+    }
+}
+
+/**
+ * Sends the read address of the current transaction, with the reception of
+ * its bytes set up: a not ack for a single byte, DMA for more.
+ */
+static void I2CDeviceReadAddress(tI2CTransaction *transaction)
+{
+    if (transaction->length == 1)
+    {
+        I2CNotAck();
+    }
+    else
+    {
+        //the last byte is not acknowledged, the DMA interrupt sends the
+        //stop
+        I2CDeviceConfigureDMA(DMA1_Channel7, transaction->data, transaction->length, ENABLE);
+        I2C_DMALastTransferCmd(I2C1, ENABLE);
+        I2CAck();
+        I2C_DMACmd(I2C1, ENABLE);
+        DMA_Cmd(DMA1_Channel7, ENABLE);
+    }
+
+    I2C_Send7bitAddress(I2C1, transaction->deviceAddress << 1, I2C_Direction_Receiver);
+    transactionState = I2C_STATE_READ_ADDRESS;
+}
+
+/**
+ * This funtion is intended to be put in I2C1_EV_IRQHandler(), it does the
+ * next step of the current transaction.
+ * @remarks It does nothing if no transaction is running or its event is not
+ * there yet.
+ */
+void I2CDeviceInterruptHandler(void)
+{
+    tI2CTransaction *transaction = queueHead;
+    uint16_t status = I2C1->SR1;
+
+    if (transactionState == I2C_STATE_IDLE || transaction == NULL)
+        return;
+
+    TRACE_ISR_ENTER(I2C1_EV_IRQn);
+
+    switch (transactionState)
+    {
+        case I2C_STATE_START:
+            if (!(status & I2C_SR1_SB))
+                break;
+
+            if (transaction->direction == I2C_Direction_ReceiverCurrent)
+            {
+                I2CDeviceReadAddress(transaction);
+            }
+            else
+            {
+                I2C_Send7bitAddress(I2C1, transaction->deviceAddress << 1, I2C_Direction_Transmitter);
+                transactionState = I2C_STATE_ADDRESS;
+            }
+            break;
+
+        case I2C_STATE_ADDRESS:
+            if (!(status & I2C_SR1_ADDR))
+                break;
+
+            (void) I2C1->SR2; //clears ADDR
+            I2C_SendData(I2C1, transaction->registerAddress);
+
+            if (transaction->direction == I2C_Direction_Transmitter &&
+                transaction->length != 0)
+            {
+                //DMA loads the bytes while the register address shifts
+                I2CDeviceConfigureDMA(DMA1_Channel6, transaction->data, transaction->length, DISABLE);
+                I2C_DMACmd(I2C1, ENABLE);
+                DMA_Cmd(DMA1_Channel6, ENABLE);
+                transactionState = I2C_STATE_WRITE;
+            }
+            else
+            {
+                transactionState = I2C_STATE_REGISTER;
+            }
+            break;
+
+        case I2C_STATE_REGISTER:
+            if (!(status & I2C_SR1_BTF))
+                break;
+
+            if (transaction->direction == I2C_Direction_Receiver)
+            {
+                I2C_GenerateSTART(I2C1, ENABLE);
+                transactionState = I2C_STATE_RESTART;
+            }
+            else
+            {
+                I2C_GenerateSTOP(I2C1, ENABLE);
+                I2CDeviceComplete();
+            }
+            break;
+
+        case I2C_STATE_WRITE:
+            //BTF before the DMA wrote the last byte is a late DMA request
+            if (!(status & I2C_SR1_BTF) || DMA_GetCurrDataCounter(DMA1_Channel6) != 0)
+                break;
+
+            I2CDeviceStopDMA();
+            I2C_GenerateSTOP(I2C1, ENABLE);
+            I2CDeviceComplete();
+            break;
+
+        case I2C_STATE_RESTART:
+            if (!(status & I2C_SR1_SB))
+                break;
+
+            I2CDeviceReadAddress(transaction);
+            break;
+
+        case I2C_STATE_READ_ADDRESS:
+            if (!(status & I2C_SR1_ADDR))
+                break;
+
+            (void) I2C1->SR2; //clears ADDR
+            transactionState = I2C_STATE_READ;
+
+            if (transaction->length == 1)
+            {
+                I2C_GenerateSTOP(I2C1, ENABLE);
+                I2C_ITConfig(I2C1, I2C_IT_BUF, ENABLE);
+            }
+            break;
+
+        case I2C_STATE_READ:
+            //a single byte, the longer reads end in the DMA interrupt
+            if (!(status & I2C_SR1_RXNE))
+                break;
+
+            transaction->data[0] = I2C_ReceiveData(I2C1);
+            I2CDeviceComplete();
+            break;
+
+        default:
+            break;
+    }
+
+    TRACE_ISR_EXIT(I2C1_EV_IRQn);
+}
+
+/**
+ * This funtion is intended to be put in I2C1_ER_IRQHandler(). A not ack,
+ * a bus error or a lost arbitration ends the current transaction with
+ * I2C_TRANSACTION_ERROR, and the next one is started.
+ */
+void I2CDeviceErrorInterruptHandler(void)
+{
+    uint16_t status = I2C1->SR1;
+
+    if (!(status & (I2C_SR1_AF | I2C_SR1_BERR | I2C_SR1_ARLO | I2C_SR1_OVR)))
+        return;
+
+    I2C_ClearFlag(I2C1, I2C_FLAG_AF | I2C_FLAG_BERR | I2C_FLAG_ARLO | I2C_FLAG_OVR);
+
+    if (transactionState == I2C_STATE_IDLE || queueHead == NULL)
+        return;
+
+    TRACE_ISR_ENTER(I2C1_ER_IRQn);
+    I2CDeviceStopDMA();
+
+    //the bus is not ours after a lost arbitration
+    if (!(status & I2C_SR1_ARLO))
+    {
+        I2C_GenerateSTOP(I2C1, ENABLE);
+    }
+
+    transactionResult = I2C_TRANSACTION_ERROR;
+    I2CDeviceComplete();
+    TRACE_ISR_EXIT(I2C1_ER_IRQn);
+}
+
+/**
+ * This funtion is intended to be put in DMA1_Channel7_IRQHandler(), it ends
+ * a read of 2 bytes or more when the last byte is received.
+ * @remarks This funtion checks and clears the transfer complete flag of the
+ * channel, it does nothing if the flag is not set.
+ */
+void I2CDeviceDMAInterruptHandler(void)
+{
+    if (DMA_GetITStatus(DMA1_IT_TC7) == RESET)
+        return;
+
+    I2CDeviceStopDMA();
+
+    if (transactionState != I2C_STATE_READ || queueHead == NULL)
+        return;
+
+    TRACE_ISR_ENTER(DMA1_Channel7_IRQn);
+    I2C_GenerateSTOP(I2C1, ENABLE);
+    I2CDeviceComplete();
+    TRACE_ISR_EXIT(DMA1_Channel7_IRQn);
 }
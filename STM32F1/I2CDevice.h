@@ -36,39 +36,137 @@
 #define _I2CDEV_H_
 
 #include <stm32f10x.h>
+#include "RegisterField.h"
 
 extern unsigned char deviceAddressRead;
 extern unsigned char deviceAddressWrite;
 
+/**Selects the desired I2C clock speed.*/
+#ifndef I2C_SPEED
+#define I2C_SPEED           400000
+#endif
+/**Shorter register reads and writes are moved byte by byte, the DMA setup
+ would take longer.*/
+#ifndef I2C_DMA_MIN_LENGTH
+#define I2C_DMA_MIN_LENGTH  4
+#endif
+/**Priority of the I2C1 and DMA1 channel 7 interrupts of the transactions.*/
+#ifndef I2C_IRQ_PRIORITY
+#define I2C_IRQ_PRIORITY    1
+#endif
+
+/**Direction of a transaction that reads from the current register of the
+ device, without writing the register first (i.e. status registers).*/
+#define  I2C_Direction_ReceiverCurrent  0x02
+
+/**
+ * Status of an interrupt driven transaction.
+ */
+typedef enum
+{
+    /**Not started or already seen by the user.*/
+    I2C_TRANSACTION_IDLE,
+    /**Running in the background.*/
+    I2C_TRANSACTION_BUSY,
+    /**Finished, all the bytes were transferred.*/
+    I2C_TRANSACTION_DONE,
+    /**Finished, the device didn't acknowledge.*/
+    I2C_TRANSACTION_ERROR
+} tI2CTransactionStatus;
+
+/**
+ * Register read or write done by the I2C1 interrupts and DMA, see
+ * I2CDeviceStartTransaction(). The structure and the data buffer must stay
+ * valid until the transaction finishes.
+ */
+typedef struct _tI2CTransaction
+{
+    /**Address of the slave NOT SHIFTED.*/
+    unsigned char deviceAddress;
+    /**First register to read or write.*/
+    unsigned char registerAddress;
+    /**I2C_Direction_Transmitter to write, I2C_Direction_Receiver to read,
+     I2C_Direction_ReceiverCurrent to read without the register.*/
+    unsigned char direction;
+    /**Number of bytes to transfer, not more than 65535.*/
+    unsigned int length;
+    /**Bytes to write or buffer for the bytes read.*/
+    unsigned char *data;
+    /**Called from the interrupt when the transaction finishes, can be NULL.*/
+    void (*callback)(struct _tI2CTransaction *transaction);
+    /**Status, can be polled instead of using the callback.*/
+    volatile tI2CTransactionStatus status;
+    /**Next transaction in the queue.*/
+    struct _tI2CTransaction *next;
+} tI2CTransaction;
+
+/**
+ * Handle of a device on the bus, each driver keeps its own.
+ */
+typedef struct _tI2CDevice
+{
+    /**Address of the slave NOT SHIFTED.*/
+    unsigned char address;
+} tI2CDevice;
+
+void I2CInit(void);
 void I2CStart(void);
 void I2CRestart(void);
 void I2CStop(void);
 void I2CAck(void);
 void I2CNotAck(void);
 void I2CSendAddress(unsigned char Address, unsigned char I2C_Direction);
-void I2CWrite(unsigned char data_out);
+unsigned char I2CWrite(unsigned char data_out);
 unsigned char I2CRead(void);
 void I2CDeviceSetDeviceAddress(unsigned char address);
-unsigned char I2CDeviceReadBit(unsigned char address,
-                               unsigned char _bit);
-unsigned char I2CDeviceReadBits(unsigned char address,
-                                unsigned char bitStart,
-                                unsigned char length);
 unsigned char I2CDeviceReadByte(unsigned char address);
 void I2CDeviceReadBytes(unsigned char address,
                         unsigned int length,
                         unsigned char *data);
-void I2CDeviceWriteBit(unsigned char address,
-                       unsigned char _bit,
-                       unsigned char value);
-void I2CDeviceWriteBits(unsigned char address,
-                        unsigned char bitStart,
-                        unsigned char length,
-                        unsigned char value);
+void I2CDeviceReadCurrentBytes(unsigned int length,
+                               unsigned char *data);
+void I2CDeviceUpdateByte(unsigned char address,
+                         unsigned char mask,
+                         unsigned char value);
 void I2CDeviceWriteByte(unsigned char address,
                         unsigned char value);
 void I2CDeviceWriteBytes(unsigned char address,
                          unsigned int length,
                          unsigned char *data);
+void I2CDeviceWriteMessages(unsigned char count,
+                            unsigned char size,
+                            unsigned char *data);
+unsigned char I2CDeviceStartTransaction(tI2CTransaction *transaction);
+unsigned char I2CDeviceQueueTransaction(tI2CDevice *device,
+                                        tI2CTransaction *transaction);
+unsigned char I2CDeviceIsBusy(void);
+unsigned char I2CDeviceLock(void);
+void I2CDeviceUnlock(unsigned char state);
+void I2CDeviceInitHandle(tI2CDevice *device, unsigned char address);
+void I2CDeviceSelect(tI2CDevice *device);
+unsigned char I2CDeviceRead(tI2CDevice *device,
+                            unsigned char address,
+                            unsigned int length,
+                            unsigned char *data);
+unsigned char I2CDeviceWrite(tI2CDevice *device,
+                             unsigned char address,
+                             unsigned int length,
+                             unsigned char *data);
+void I2CDeviceInterruptHandler(void);
+void I2CDeviceErrorInterruptHandler(void);
+void I2CDeviceDMAInterruptHandler(void);
+
+/**The bit accessors are macros over I2CDeviceReadByte() and
+ I2CDeviceUpdateByte(): with the positions of the drivers, constants, the
+ masks and the shifts are folded at compile time. See RegisterField.h.*/
+#define I2CDeviceReadBit(address, _bit)                                     \
+    (I2CDeviceReadByte(address) & REGISTER_BIT_MASK(_bit))
+#define I2CDeviceReadBits(address, bitStart, length)                        \
+    REGISTER_FIELD_GET(I2CDeviceReadByte(address), bitStart, length)
+#define I2CDeviceWriteBit(address, _bit, value)                             \
+    I2CDeviceUpdateByte((address), REGISTER_BIT_MASK(_bit), (value) ? 0xFF : 0)
+#define I2CDeviceWriteBits(address, bitStart, length, value)                \
+    I2CDeviceUpdateByte((address), REGISTER_FIELD_MASK(bitStart, length),  \
+                        REGISTER_FIELD_VALUE(bitStart, length, value))
 
 #endif /* _I2CDEV_H_ */
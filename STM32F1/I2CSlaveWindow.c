@@ -0,0 +1,155 @@
+/**
+ *  @file       I2CSlaveWindow.c
+ *  @author     Luis Maduro
+ *  @version    1.00
+ *  @date       14/10/2026
+ *  @brief      Double buffered register window of an I2C slave in the
+ *              listen mode of CPAL.
+ *
+ *  Copyright (C) 2026  Luis Maduro
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <stddef.h>
+#include "I2CSlaveWindow.h"
+
+/**
+ * Sets up a window, the two buffers are given as they are: the first one is
+ * the stable one until the first publish.
+ * @param window Window, kept by the application.
+ * @param first Buffer read by the master at first.
+ * @param second Back buffer.
+ * @param size Bytes of each buffer, at least 1.
+ */
+void I2CSlaveWindowInit(tI2CSlaveWindow *window, uint8_t *first,
+                        uint8_t *second, uint16_t size)
+{
+    window->buffer[0] = first;
+    window->buffer[1] = second;
+    window->size = size;
+    window->stable = 0;
+    window->offset = 0;
+    window->reading = false;
+    window->pending = false;
+    window->Reads = 0;
+    window->Publishes = 0;
+}
+
+/**
+ * Back buffer, to be filled with a whole sample set before
+ * I2CSlaveWindowPublish().
+ * @param window Window.
+ * @return NULL while the set published last waits for the end of a read,
+ *         it is in the back buffer still.
+ */
+uint8_t *I2CSlaveWindowGetWriteBuffer(tI2CSlaveWindow *window)
+{
+    if (window->pending)
+    {
+        return NULL;
+    }
+
+    return window->buffer[window->stable ^ 1];
+}
+
+/**
+ * Makes the back buffer the stable one, at once or at the end of the read
+ * that is running.
+ * @param window Window.
+ */
+void I2CSlaveWindowPublish(tI2CSlaveWindow *window)
+{
+    uint32_t primask;
+
+    //the address match of the master can come between the test and the swap
+    primask = __get_PRIMASK();
+    __disable_irq();
+
+    if (window->reading)
+    {
+        window->pending = true;
+    }
+    else
+    {
+        window->stable ^= 1;
+    }
+
+    window->Publishes++;
+
+    __set_PRIMASK(primask);
+}
+
+/**
+ * Sets the register the next reads start at.
+ * @param window Window.
+ * @param offset Byte of the window.
+ * @return False if it is out of the window.
+ */
+bool I2CSlaveWindowSeek(tI2CSlaveWindow *window, uint16_t offset)
+{
+    if (offset >= window->size)
+    {
+        return false;
+    }
+
+    window->offset = offset;
+
+    return true;
+}
+
+/**
+ * This funtion is intended to be put in the
+ * CPAL_I2C_SLAVE_WRITE_UserCallback(), it points the transmission of CPAL
+ * to the stable buffer and starts its DMA.
+ * @param window Window.
+ * @param pDevInitStruct Device of the callback.
+ */
+void I2CSlaveWindowServe(tI2CSlaveWindow *window, CPAL_InitTypeDef *pDevInitStruct)
+{
+    uint16_t offset = window->offset;
+
+    //called from the event interrupt, Publish() can't run in between
+    window->reading = true;
+    window->Reads++;
+
+    pDevInitStruct->pCPAL_TransferTx->pbBuffer = window->buffer[window->stable] + offset;
+    pDevInitStruct->pCPAL_TransferTx->wNumData = window->size - offset;
+
+    CPAL_I2C_Enable_DMA_IT(pDevInitStruct, CPAL_DIRECTION_TX);
+
+    __CPAL_I2C_HAL_ENABLE_EVTIT(pDevInitStruct->CPAL_Dev);
+}
+
+/**
+ * This funtion is intended to be put in the CPAL_I2C_TXTC_UserCallback() and
+ * in the error callback of the device, it ends a read and makes the set
+ * published during it the stable one.
+ * @param window Window.
+ */
+void I2CSlaveWindowDone(tI2CSlaveWindow *window)
+{
+    if (!window->reading)
+    {
+        return;
+    }
+
+    window->reading = false;
+
+    if (window->pending)
+    {
+        window->stable ^= 1;
+        window->pending = false;
+    }
+}
@@ -0,0 +1,103 @@
+/**
+ *  @file       I2CSlaveWindow.h
+ *  @author     Luis Maduro
+ *  @version    1.00
+ *  @date       14/10/2026
+ *  @brief      Double buffered register window of an I2C slave in the
+ *              listen mode of CPAL.
+ *
+ *  The slave keeps two buffers of the same size: the stable one, that the
+ *  master reads, and the back one, that the producer fills. When a sample
+ *  set is complete in the back buffer the producer publishes it and the two
+ *  swap, only an index changes, no byte is copied. A read of the master is
+ *  served by the DMA of CPAL straight from the stable buffer, so it always
+ *  gets a whole set, never half of the last one and half of the one before.
+ *  A set published while the DMA is reading is held and the swap is done
+ *  when the read ends.
+ *  @code
+ *  static uint8_t samples[2][SAMPLE_SET_SIZE];
+ *  static tI2CSlaveWindow window;
+ *
+ *  I2CSlaveWindowInit(&window, samples[0], samples[1], SAMPLE_SET_SIZE);
+ *
+ *  //producer, a task or the end of conversion of the ADC
+ *  uint8_t *set = I2CSlaveWindowGetWriteBuffer(&window);
+ *
+ *  if (set != NULL)
+ *  {
+ *      FillSampleSet(set);
+ *      I2CSlaveWindowPublish(&window);
+ *  }
+ *  @endcode
+ *  In cpal_usercallback.c, with CPAL_I2C_LISTEN_MODE and
+ *  CPAL_I2C_DMA_PROGMODEL in cpal_conf.h:
+ *  @code
+ *  void CPAL_I2C_SLAVE_WRITE_UserCallback(CPAL_InitTypeDef* pDevInitStruct)
+ *  {
+ *      I2CSlaveWindowServe(&window, pDevInitStruct);
+ *  }
+ *
+ *  void CPAL_I2C_TXTC_UserCallback(CPAL_InitTypeDef* pDevInitStruct)
+ *  {
+ *      I2CSlaveWindowDone(&window);
+ *  }
+ *  @endcode
+ *  A master that reads less than the window ends with a NACK, the AF error
+ *  of CPAL: CPAL_I2C_ERR_UserCallback() (or CPAL_I2C_AF_UserCallback())
+ *  calls I2CSlaveWindowDone() too. A master that writes a register address
+ *  first has it received by CPAL_I2C_SLAVE_READ_UserCallback() as in the
+ *  example, and CPAL_I2C_RXTC_UserCallback() gives it to
+ *  I2CSlaveWindowSeek(), the next read starts there.
+ *
+ *  Copyright (C) 2026  Luis Maduro
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef I2CSLAVEWINDOW_H
+#define I2CSLAVEWINDOW_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "cpal_i2c.h"
+
+/**
+ * A register window, kept by the application.
+ */
+typedef struct
+{
+    uint8_t *buffer[2];
+    uint16_t size;
+    /**Buffer read by the master, the other one is the back buffer.*/
+    volatile uint8_t stable;
+    /**Register the next read starts at.*/
+    volatile uint16_t offset;
+    /**The DMA is reading the stable buffer.*/
+    volatile bool reading;
+    /**A set is published, waiting for the end of the read.*/
+    volatile bool pending;
+    /**Reads served and sets published.*/
+    uint32_t Reads;
+    uint32_t Publishes;
+} tI2CSlaveWindow;
+
+void I2CSlaveWindowInit(tI2CSlaveWindow *window, uint8_t *first,
+                        uint8_t *second, uint16_t size);
+uint8_t *I2CSlaveWindowGetWriteBuffer(tI2CSlaveWindow *window);
+void I2CSlaveWindowPublish(tI2CSlaveWindow *window);
+bool I2CSlaveWindowSeek(tI2CSlaveWindow *window, uint16_t offset);
+void I2CSlaveWindowServe(tI2CSlaveWindow *window, CPAL_InitTypeDef *pDevInitStruct);
+void I2CSlaveWindowDone(tI2CSlaveWindow *window);
+
+#endif /* I2CSLAVEWINDOW_H */
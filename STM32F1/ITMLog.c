@@ -0,0 +1,264 @@
+/**
+ *  @file       ITMLog.c
+ *  @author     Luis Maduro
+ *  @version    1.00
+ *  @date       14/10/2026
+ *  @brief      Logs and traces over the ITM stimulus ports and the SWO pin.
+ *
+ *  Copyright (C) 2026  Luis Maduro
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "ITMLog.h"
+
+/**Key of the lock access register.*/
+#define ITM_LOG_UNLOCK              0xC5ACCE55UL
+/**Asynchronous NRZ (UART) protocol of the SWO.*/
+#define ITM_LOG_SPPR_NRZ            2
+/**Formatter off, the ITM packets go out as they are.*/
+#define ITM_LOG_FFCR                0x100
+
+tITMLogStatistics ITMLogStatistics;
+
+/**Ports enabled by the application.*/
+static uint32_t portMask = 0xFFFFFFFFUL;
+
+/**
+ * Sets the ITM up from the program, for the debuggers that only capture the
+ * SWO. With swoHz 0 the settings of the debugger are kept.
+ * @param swoHz Bit rate of the SWO, HCLK / swoHz must be an integer.
+ * @param mask Ports enabled, bit n for the port n.
+ */
+void ITMLogInit(uint32_t swoHz, uint32_t mask)
+{
+    RCC_ClocksTypeDef RCC_ClocksStatus;
+
+    portMask = mask;
+
+    if (swoHz == 0)
+        return;
+
+    RCC_GetClocksFreq(&RCC_ClocksStatus);
+
+    CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+
+    //TRACESWO on PB3, asynchronous mode
+    DBGMCU->CR = (DBGMCU->CR & ~DBGMCU_CR_TRACE_MODE) | DBGMCU_CR_TRACE_IOEN;
+
+    TPI->SPPR = ITM_LOG_SPPR_NRZ;
+    TPI->ACPR = RCC_ClocksStatus.HCLK_Frequency / swoHz - 1;
+    TPI->FFCR = ITM_LOG_FFCR;
+
+    ITM->LAR = ITM_LOG_UNLOCK;
+    ITM->TCR = 0;
+    ITM->TPR = 0;
+    ITM->TER = mask;
+    ITM->TCR = (1UL << ITM_TCR_TraceBusID_Pos) | ITM_TCR_SWOENA_Msk
+            | ITM_TCR_SYNCENA_Msk | ITM_TCR_ITMENA_Msk;
+}
+
+/**
+ * Enables and disables the ports, the debugger can still disable them.
+ * @param mask Ports enabled, bit n for the port n.
+ */
+void ITMLogSetMask(uint32_t mask)
+{
+    portMask = mask;
+}
+
+/**
+ * Tells if the data written to a port goes out, to skip the work of a
+ * message that would be dropped.
+ * @param port Port, 0 to 31.
+ * @return True if the ITM and the port are enabled.
+ */
+bool ITMLogIsEnabled(uint8_t port)
+{
+    uint32_t bit = 1UL << port;
+
+    return ((ITM->TCR & ITM_TCR_ITMENA_Msk) != 0) && ((portMask & ITM->TER & bit) != 0);
+}
+
+/**
+ * Tells if a port takes a write now, the port reads 1 then.
+ */
+static bool ITMLogIsReady(uint8_t port)
+{
+    return ITMLogIsEnabled(port) && (ITM->PORT[port].u32 != 0);
+}
+
+static bool ITMLogCount(bool written, unsigned int bytes)
+{
+    if (written)
+        ITMLogStatistics.Written += bytes;
+    else
+        ITMLogStatistics.Dropped += bytes;
+
+    return written;
+}
+
+/**
+ * Writes a byte.
+ * @param port Port, 0 to 31.
+ * @param value Byte.
+ * @return False if it was dropped.
+ */
+bool ITMLogPut8(uint8_t port, uint8_t value)
+{
+    if (!ITMLogIsReady(port))
+        return ITMLogCount(false, 1);
+
+    ITM->PORT[port].u8 = value;
+
+    return ITMLogCount(true, 1);
+}
+
+/**
+ * Writes a half word, a single packet of 2 bytes.
+ * @param port Port, 0 to 31.
+ * @param value Half word.
+ * @return False if it was dropped.
+ */
+bool ITMLogPut16(uint8_t port, uint16_t value)
+{
+    if (!ITMLogIsReady(port))
+        return ITMLogCount(false, 2);
+
+    ITM->PORT[port].u16 = value;
+
+    return ITMLogCount(true, 2);
+}
+
+/**
+ * Writes a word, a single packet of 4 bytes.
+ * @param port Port, 0 to 31.
+ * @param value Word.
+ * @return False if it was dropped.
+ */
+bool ITMLogPut32(uint8_t port, uint32_t value)
+{
+    if (!ITMLogIsReady(port))
+        return ITMLogCount(false, 4);
+
+    ITM->PORT[port].u32 = value;
+
+    return ITMLogCount(true, 4);
+}
+
+/**
+ * Writes bytes as words, the last ones as bytes, until the FIFO is full.
+ * @param port Port, 0 to 31.
+ * @param data Bytes.
+ * @param length Number of bytes.
+ * @return Bytes written, the others are dropped.
+ */
+unsigned int ITMLogWrite(uint8_t port, const void *data, unsigned int length)
+{
+    const uint8_t *bytes = data;
+    unsigned int written = 0;
+    uint32_t word;
+
+    if (!ITMLogIsEnabled(port))
+    {
+        ITMLogCount(false, length);
+        return 0;
+    }
+
+    while (length - written >= 4)
+    {
+        if (ITM->PORT[port].u32 == 0)
+            break;
+
+        //little endian, the bytes go out in their order
+        word = bytes[written] | ((uint32_t) bytes[written + 1] << 8)
+                | ((uint32_t) bytes[written + 2] << 16) | ((uint32_t) bytes[written + 3] << 24);
+        ITM->PORT[port].u32 = word;
+        written += 4;
+    }
+
+    while ((written < length) && (length - written < 4))
+    {
+        if (ITM->PORT[port].u32 == 0)
+            break;
+
+        ITM->PORT[port].u8 = bytes[written++];
+    }
+
+    ITMLogCount(true, written);
+    ITMLogCount(false, length - written);
+
+    return written;
+}
+
+/**
+ * Writes a string, without its end.
+ * @param port Port, 0 to 31.
+ * @param string String.
+ * @return Bytes written.
+ */
+unsigned int ITMLogString(uint8_t port, const char *string)
+{
+    unsigned int length = 0;
+
+    while (string[length] != '\0')
+    {
+        length++;
+    }
+
+    return ITMLogWrite(port, string, length);
+}
+
+#ifdef USE_TRACE
+
+/**
+ * Sends the records of the trace on ITM_LOG_PORT_TRACE, each one taken out
+ * of the ring only when the port is ready for it. Its second word waits for
+ * the first one to leave, 32 bits of the SWO, unless the ITM or the port is
+ * disabled meanwhile.
+ * @return Records sent.
+ */
+unsigned int ITMLogFlushTrace(void)
+{
+    uint8_t record[TRACE_RECORD_SIZE];
+    unsigned int sent = 0;
+
+    while ((TracePending() != 0) && ITMLogIsReady(ITM_LOG_PORT_TRACE))
+    {
+        TraceRead(record, sizeof (record));
+
+        ITM->PORT[ITM_LOG_PORT_TRACE].u32 = record[0] | ((uint32_t) record[1] << 8)
+                | ((uint32_t) record[2] << 16) | ((uint32_t) record[3] << 24);
+
+        while (ITM->PORT[ITM_LOG_PORT_TRACE].u32 == 0)
+        {
+            //the debugger turned the trace off, the port never frees
+            if (!ITMLogIsEnabled(ITM_LOG_PORT_TRACE))
+            {
+                ITMLogStatistics.Written += 4;
+                ITMLogStatistics.Dropped += TRACE_RECORD_SIZE - 4;
+                return sent;
+            }
+        }
+
+        ITM->PORT[ITM_LOG_PORT_TRACE].u32 = record[4] | ((uint32_t) record[5] << 8)
+                | ((uint32_t) record[6] << 16) | ((uint32_t) record[7] << 24);
+
+        ITMLogStatistics.Written += TRACE_RECORD_SIZE;
+        sent++;
+    }
+
+    return sent;
+}
+#endif
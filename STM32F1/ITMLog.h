@@ -0,0 +1,76 @@
+/**
+ *  @file       ITMLog.h
+ *  @author     Luis Maduro
+ *  @version    1.00
+ *  @date       14/10/2026
+ *  @brief      Logs and traces over the ITM stimulus ports and the SWO pin.
+ *
+ *  A write to a stimulus port of the ITM is one store, the byte or the word
+ *  leaves on the SWO pin (PB3) at up to HCLK / 2 without a UART, a DMA or
+ *  an interrupt. A port takes a new write once the last one went into the
+ *  FIFO of the ITM, the writes here check it and drop the data when it is
+ *  full, they never wait: the dropped bytes are counted in
+ *  ITMLogStatistics.
+ *
+ *  The 32 ports are the channels, a write goes out if the port is enabled
+ *  in the mask of ITMLogSetMask() and by the debugger (ITM->TER), and if a
+ *  debugger or ITMLogInit() enabled the ITM. A program without a debugger
+ *  attached runs the same, the writes are dropped. A message written by an
+ *  interrupt in the middle of another one on the same port is mixed with
+ *  it, the tasks and the interrupts use their own ports.
+ *
+ *  ITMLogFlushTrace() sends the records of Trace.h on ITM_LOG_PORT_TRACE,
+ *  the bytes of that port are read by TraceDecode.py.
+ *
+ *  Copyright (C) 2026  Luis Maduro
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef ITMLOG_H
+#define ITMLOG_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stm32f10x.h>
+#include "Trace.h"
+
+/**Port of the text, the one of printf for most of the SWO viewers.*/
+#define ITM_LOG_PORT_TEXT           0
+/**Port of the records of Trace.h.*/
+#define ITM_LOG_PORT_TRACE          1
+
+typedef struct
+{
+    /**Bytes written.*/
+    uint32_t Written;
+    /**Bytes dropped, the FIFO was full.*/
+    uint32_t Dropped;
+} tITMLogStatistics;
+
+extern tITMLogStatistics ITMLogStatistics;
+
+void ITMLogInit(uint32_t swoHz, uint32_t mask);
+void ITMLogSetMask(uint32_t mask);
+bool ITMLogIsEnabled(uint8_t port);
+bool ITMLogPut8(uint8_t port, uint8_t value);
+bool ITMLogPut16(uint8_t port, uint16_t value);
+bool ITMLogPut32(uint8_t port, uint32_t value);
+unsigned int ITMLogWrite(uint8_t port, const void *data, unsigned int length);
+unsigned int ITMLogString(uint8_t port, const char *string);
+#ifdef USE_TRACE
+unsigned int ITMLogFlushTrace(void);
+#endif
+
+#endif /* ITMLOG_H */
@@ -84,6 +84,7 @@ extern uint32_t SystemCoreClock;          /*!< System Clock Frequency (Core Cloc
   
 extern void SystemInit(void);
 extern void SystemCoreClockUpdate(void);
+extern uint32_t SystemClockSwitch(void);
 /**
   * @}
   */
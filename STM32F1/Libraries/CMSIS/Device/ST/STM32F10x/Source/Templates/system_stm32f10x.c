@@ -22,6 +22,9 @@
   *                                 be called whenever the core clock is changed
   *                                 during program execution.
   *
+  *      - SystemClockSwitch(): With SYSCLK_START_ON_HSI defined, switches the
+  *                             system clock to the PLL once the HSE is ready.
+  *
   * 2. After each device reset the HSI (8 MHz) is used as system clock source.
   *    Then SystemInit() function is called, in "startup_stm32f10x_xx.s" file, to
   *    configure the system clock before to branch to main program.
@@ -121,6 +124,14 @@
 #define SYSCLK_FREQ_72MHz  72000000
 #endif
 
+/*!< Uncomment the following line to branch to main program on the HSI: SystemInit()
+     starts the HSE without waiting for it, and SystemClockSwitch() configures the
+     System clock above once the HSE is ready. SystemClockSwitch() is put in
+     RCC_IRQHandler(), the HSERDY interrupt being enabled by SystemInit(), or
+     called from the main program. A missing crystal then never delays the start,
+     the HSI stays the System clock source. */
+/* #define SYSCLK_START_ON_HSI */
+
 /*!< Uncomment the following line if you need to use external SRAM mounted
      on STM3210E-EVAL board (STM32 High density and XL-density devices) or on 
      STM32100E-EVAL board (STM32 High-density value line devices) as data memory */ 
@@ -154,7 +165,9 @@
 /*******************************************************************************
 *  Clock Definitions
 *******************************************************************************/
-#ifdef SYSCLK_FREQ_HSE
+#ifdef SYSCLK_START_ON_HSI
+  uint32_t SystemCoreClock         = HSI_VALUE;        /*!< System Clock Frequency (Core Clock) */
+#elif defined SYSCLK_FREQ_HSE
   uint32_t SystemCoreClock         = SYSCLK_FREQ_HSE;        /*!< System Clock Frequency (Core Clock) */
 #elif defined SYSCLK_FREQ_24MHz
   uint32_t SystemCoreClock         = SYSCLK_FREQ_24MHz;        /*!< System Clock Frequency (Core Clock) */
@@ -263,9 +276,16 @@ void SystemInit (void)
   #endif /* DATA_IN_ExtSRAM */
 #endif 
 
+#ifdef SYSCLK_START_ON_HSI
+  /* Enable HSE without waiting, SystemClockSwitch() configures the System clock
+     on the HSERDY interrupt */
+  RCC->CR |= ((uint32_t)RCC_CR_HSEON);
+  RCC->CIR |= RCC_CIR_HSERDYIE;
+#else
   /* Configure the System clock frequency, HCLK, PCLK2 and PCLK1 prescalers */
   /* Configure the Flash Latency cycles and enable prefetch buffer */
   SetSysClock();
+#endif /* SYSCLK_START_ON_HSI */
 
 #ifdef VECT_TAB_SRAM
   SCB->VTOR = SRAM_BASE | VECT_TAB_OFFSET; /* Vector Table Relocation in Internal SRAM. */
@@ -417,6 +437,33 @@ void SystemCoreClockUpdate (void)
   SystemCoreClock >>= tmp;  
 }
 
+/**
+  * @brief  Configures the System clock frequency, HCLK, PCLK2 and PCLK1 prescalers
+  *         once the HSE is ready, when the application started on the HSI
+  *         (SYSCLK_START_ON_HSI defined), and updates SystemCoreClock. The
+  *         HSE is not waited for, the wait of SetSysClockToXX() then ends at
+  *         once, only the PLL lock is waited for.
+  * @note   The SysTick reload and the baud rates computed from SystemCoreClock
+  *         on the HSI have to be computed again when this function returns 1.
+  * @param  None
+  * @retval 1 if the System clock was switched by this call, else 0.
+  */
+uint32_t SystemClockSwitch(void)
+{
+  if (((RCC->CR & RCC_CR_HSERDY) == 0) || ((RCC->CFGR & RCC_CFGR_SWS) != RCC_CFGR_SWS_HSI))
+  {
+    return 0;
+  }
+
+  /* Disable the HSERDY interrupt and clear its pending bit */
+  RCC->CIR = (RCC->CIR & ~RCC_CIR_HSERDYIE) | RCC_CIR_HSERDYC;
+
+  SetSysClock();
+  SystemCoreClockUpdate();
+
+  return ((RCC->CFGR & RCC_CFGR_SWS) != RCC_CFGR_SWS_HSI) ? 1 : 0;
+}
+
 /**
   * @brief  Configures the System clock frequency, HCLK, PCLK2 and PCLK1 prescalers.
   * @param  None
@@ -32,13 +32,40 @@
 
 /* Includes ------------------------------------------------------------------*/
 /* Exported types ------------------------------------------------------------*/
+#ifdef USB_INT_STATS
+/* Statistics of CTR_LP, kept when USB_INT_STATS is defined in usb_conf.h.
+   The times are in CPU cycles, from the cycle counter of the core. */
+typedef struct
+{
+  uint32_t Transfers[8];       /* transfers served, per endpoint */
+  uint32_t Cycles[8];          /* time in the service routines, per endpoint */
+  uint32_t Max_Cycles;         /* longest CTR_LP run */
+  uint32_t Nak_Storms[8];      /* NAKing periods of USB_NAK_STORM_FRAMES or more */
+  uint16_t Nak_Max_Frames[8];  /* longest NAKing period, in frames */
+} USB_Int_Stats_TypeDef;
+#endif /* USB_INT_STATS */
+
 /* Exported constants --------------------------------------------------------*/
+#ifdef USB_INT_STATS
+/* An endpoint left NAKing by its service routine for this many frames or more
+   counts as a NAK storm: the host polls it meanwhile and gets NAKs */
+#ifndef USB_NAK_STORM_FRAMES
+ #define USB_NAK_STORM_FRAMES  8
+#endif
+#endif /* USB_INT_STATS */
+
 /* Exported macro ------------------------------------------------------------*/
 /* Exported functions ------------------------------------------------------- */
 void CTR_LP(void);
 void CTR_HP(void);
+#ifdef USB_INT_STATS
+void USB_Int_Stats_Reset(void);
+#endif /* USB_INT_STATS */
 
 /* External variables --------------------------------------------------------*/
+#ifdef USB_INT_STATS
+extern USB_Int_Stats_TypeDef USB_Int_Stats;
+#endif /* USB_INT_STATS */
 
 #endif /* __USB_INT_H */
 
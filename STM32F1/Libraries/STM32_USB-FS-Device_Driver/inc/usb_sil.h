@@ -32,6 +32,16 @@
 
 /* Includes ------------------------------------------------------------------*/
 /* Exported types ------------------------------------------------------------*/
+/* A packet written or read in place in the PMA of an endpoint. The PMA takes
+   16 bits per 32 bits slot, a byte is held until its halfword is complete. */
+typedef struct
+{
+  uint32_t *pdwVal;   /* next PMA slot */
+  uint16_t wCount;    /* bytes written or read */
+  uint16_t wHold;     /* halfword being assembled or taken apart */
+  uint8_t  bEpNum;
+} USB_SIL_Packet;
+
 /* Exported constants --------------------------------------------------------*/
 /* Exported macro ------------------------------------------------------------*/
 /* Exported functions ------------------------------------------------------- */
@@ -40,6 +50,16 @@ uint32_t USB_SIL_Init(void);
 uint32_t USB_SIL_Write(uint8_t bEpAddr, uint8_t* pBufferPointer, uint32_t wBufferSize);
 uint32_t USB_SIL_Read(uint8_t bEpAddr, uint8_t* pBufferPointer);
 
+void USB_SIL_Reserve(USB_SIL_Packet *pPacket, uint8_t bEpAddr);
+void USB_SIL_Put8(USB_SIL_Packet *pPacket, uint8_t bData);
+void USB_SIL_Put16(USB_SIL_Packet *pPacket, uint16_t wData);
+void USB_SIL_Put32(USB_SIL_Packet *pPacket, uint32_t dwData);
+void USB_SIL_Commit(USB_SIL_Packet *pPacket);
+uint32_t USB_SIL_Receive(USB_SIL_Packet *pPacket, uint8_t bEpAddr);
+uint8_t USB_SIL_Get8(USB_SIL_Packet *pPacket);
+uint16_t USB_SIL_Get16(USB_SIL_Packet *pPacket);
+uint32_t USB_SIL_Get32(USB_SIL_Packet *pPacket);
+
 /* External variables --------------------------------------------------------*/
 
 #endif /* __USB_SIL_H */
@@ -69,6 +69,9 @@ void USB_Init(void)
   pInformation->ControlState = 2;
   pProperty = &Device_Property;
   pUser_Standard_Requests = &User_Standard_Requests;
+#ifdef USB_INT_STATS
+  USB_Int_Stats_Reset();
+#endif /* USB_INT_STATS */
   /* Initialize devices one by one */
   pProperty->Init();
 }
@@ -31,34 +31,123 @@
 /* Private typedef -----------------------------------------------------------*/
 /* Private define ------------------------------------------------------------*/
 /* Private macro -------------------------------------------------------------*/
+#ifdef USB_INT_STATS
+ #define STATS_CYCLES()    (DWT->CYCCNT)
+#endif /* USB_INT_STATS */
+
 /* Private variables ---------------------------------------------------------*/
 __IO uint16_t SaveRState;
 __IO uint16_t SaveTState;
 
+#ifdef USB_INT_STATS
+USB_Int_Stats_TypeDef USB_Int_Stats;
+/* Frame a transfer left the endpoint NAKing, bit 15 set while it does */
+static uint16_t Nak_Frame[2][8];
+#endif /* USB_INT_STATS */
+
 /* Extern variables ----------------------------------------------------------*/
 extern void (*pEpInt_IN[7])(void);    /*  Handles IN  interrupts   */
 extern void (*pEpInt_OUT[7])(void);   /*  Handles OUT interrupts   */
 
 /* Private function prototypes -----------------------------------------------*/
+#ifdef USB_INT_STATS
+static void Stats_Nak(uint8_t bEpNum, uint8_t Dir, uint16_t NakStatus);
+#endif /* USB_INT_STATS */
+
 /* Private functions ---------------------------------------------------------*/
 
+#ifdef USB_INT_STATS
+/*******************************************************************************
+* Function Name  : Stats_Nak.
+* Description    : Counts the frames the host was NAKed on an endpoint
+*                  direction, from the transfer that left it NAKing to this
+*                  one, then notes if this one leaves it NAKing again.
+* Input          : bEpNum: endpoint number.
+*                  Dir: 0 for OUT, 1 for IN.
+*                  NakStatus: the direction is NAKing after its service.
+* Output         : None.
+* Return         : None.
+*******************************************************************************/
+static void Stats_Nak(uint8_t bEpNum, uint8_t Dir, uint16_t NakStatus)
+{
+  uint16_t wFrame = _GetFNR() & FNR_FN;
+  uint16_t wFrames;
+
+  if (Nak_Frame[Dir][bEpNum] & 0x8000)
+  {
+    wFrames = (wFrame - Nak_Frame[Dir][bEpNum]) & FNR_FN;
+    if (wFrames > USB_Int_Stats.Nak_Max_Frames[bEpNum])
+    {
+      USB_Int_Stats.Nak_Max_Frames[bEpNum] = wFrames;
+    }
+    if (wFrames >= USB_NAK_STORM_FRAMES)
+    {
+      USB_Int_Stats.Nak_Storms[bEpNum]++;
+    }
+  }
+
+  Nak_Frame[Dir][bEpNum] = NakStatus ? (wFrame | 0x8000) : 0;
+}
+
+/*******************************************************************************
+* Function Name  : USB_Int_Stats_Reset.
+* Description    : Clears the interrupt statistics and starts the cycle
+*                  counter of the core.
+* Input          : None.
+* Output         : None.
+* Return         : None.
+*******************************************************************************/
+void USB_Int_Stats_Reset(void)
+{
+  uint8_t *pbStats = (uint8_t *)&USB_Int_Stats;
+  uint32_t i;
+
+  for (i = 0; i < sizeof(USB_Int_Stats); i++)
+  {
+    pbStats[i] = 0;
+  }
+  for (i = 0; i < 8; i++)
+  {
+    Nak_Frame[0][i] = 0;
+    Nak_Frame[1][i] = 0;
+  }
+
+  CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+  DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+}
+#endif /* USB_INT_STATS */
+
 /*******************************************************************************
 * Function Name  : CTR_LP.
 * Description    : Low priority Endpoint Correct Transfer interrupt's service
-*                  routine.
+*                  routine. The endpoint register is read once per transfer,
+*                  the flags are taken from that copy.
 * Input          : None.
 * Output         : None.
 * Return         : None.
 *******************************************************************************/
 void CTR_LP(void)
 {
-  __IO uint16_t wEPVal = 0;
+  uint16_t wEPVal;
+  uint8_t bEpNum;
+#ifdef USB_INT_STATS
+  uint32_t dwEntry = STATS_CYCLES();
+  uint32_t dwStart;
+#endif /* USB_INT_STATS */
+
   /* stay in loop while pending interrupts */
   while (((wIstr = _GetISTR()) & ISTR_CTR) != 0)
   {
     /* extract highest priority endpoint number */
-    EPindex = (uint8_t)(wIstr & ISTR_EP_ID);
-    if (EPindex == 0)
+    bEpNum = (uint8_t)(wIstr & ISTR_EP_ID);
+    EPindex = bEpNum;
+    wEPVal = _GetENDPOINT(bEpNum);
+#ifdef USB_INT_STATS
+    dwStart = STATS_CYCLES();
+    USB_Int_Stats.Transfers[bEpNum]++;
+#endif /* USB_INT_STATS */
+
+    if (bEpNum == 0)
     {
       /* Decode and service control endpoint interrupt */
       /* calling related service routine */
@@ -66,12 +155,10 @@ void CTR_LP(void)
 
       /* save RX & TX status */
       /* and set both to NAK */
-      
-	    SaveRState = _GetENDPOINT(ENDP0);
-	    SaveTState = SaveRState & EPTX_STAT;
-	    SaveRState &=  EPRX_STAT;	
+      SaveRState = wEPVal & EPRX_STAT;
+      SaveTState = wEPVal & EPTX_STAT;
 
-	    _SetEPRxTxStatus(ENDP0,EP_RX_NAK,EP_TX_NAK);
+      _SetEPRxTxStatus(ENDP0,EP_RX_NAK,EP_TX_NAK);
 
       /* DIR bit = origin of the interrupt */
 
@@ -84,11 +171,6 @@ void CTR_LP(void)
 
         _ClearEP_CTR_TX(ENDP0);
         In0_Process();
-
-           /* before terminate set Tx & Rx status */
-
-            _SetEPRxTxStatus(ENDP0,SaveRState,SaveTState);
-		  return;
       }
       else
       {
@@ -96,58 +178,66 @@ void CTR_LP(void)
 
         /* DIR = 1 & CTR_RX       => SETUP or OUT int */
         /* DIR = 1 & (CTR_TX | CTR_RX) => 2 int pending */
+        /* SETUP and CTR_RX are kept frozen while CTR_RX = 1, the copy
+           read above still holds them */
 
-        wEPVal = _GetENDPOINT(ENDP0);
-        
-        if ((wEPVal &EP_SETUP) != 0)
+        if ((wEPVal & EP_SETUP) != 0)
         {
           _ClearEP_CTR_RX(ENDP0); /* SETUP bit kept frozen while CTR_RX = 1 */
           Setup0_Process();
-          /* before terminate set Tx & Rx status */
-
-		      _SetEPRxTxStatus(ENDP0,SaveRState,SaveTState);
-          return;
         }
-
         else if ((wEPVal & EP_CTR_RX) != 0)
         {
           _ClearEP_CTR_RX(ENDP0);
           Out0_Process();
-          /* before terminate set Tx & Rx status */
-     
-		     _SetEPRxTxStatus(ENDP0,SaveRState,SaveTState);
-          return;
         }
       }
-    }/* if(EPindex == 0) */
-    else
-    {
-      /* Decode and service non control endpoints interrupt  */
-
-      /* process related endpoint register */
-      wEPVal = _GetENDPOINT(EPindex);
-      if ((wEPVal & EP_CTR_RX) != 0)
-      {
-        /* clear int flag */
-        _ClearEP_CTR_RX(EPindex);
 
-        /* call OUT service function */
-        (*pEpInt_OUT[EPindex-1])();
+      /* before terminate set Tx & Rx status */
+      _SetEPRxTxStatus(ENDP0,SaveRState,SaveTState);
+#ifdef USB_INT_STATS
+      USB_Int_Stats.Cycles[0] += STATS_CYCLES() - dwStart;
+#endif /* USB_INT_STATS */
+      break;
+    }/* if(bEpNum == 0) */
 
-      } /* if((wEPVal & EP_CTR_RX) */
+    /* Decode and service non control endpoints interrupt  */
+    if ((wEPVal & EP_CTR_RX) != 0)
+    {
+      /* clear int flag */
+      _ClearEP_CTR_RX(bEpNum);
 
-      if ((wEPVal & EP_CTR_TX) != 0)
-      {
-        /* clear int flag */
-        _ClearEP_CTR_TX(EPindex);
+      /* call OUT service function */
+      (*pEpInt_OUT[bEpNum-1])();
+#ifdef USB_INT_STATS
+      Stats_Nak(bEpNum, 0, _GetEPRxStatus(bEpNum) == EP_RX_NAK);
+#endif /* USB_INT_STATS */
+    } /* if((wEPVal & EP_CTR_RX) */
 
-        /* call IN service function */
-        (*pEpInt_IN[EPindex-1])();
-      } /* if((wEPVal & EP_CTR_TX) != 0) */
+    if ((wEPVal & EP_CTR_TX) != 0)
+    {
+      /* clear int flag */
+      _ClearEP_CTR_TX(bEpNum);
 
-    }/* if(EPindex == 0) else */
+      /* call IN service function */
+      (*pEpInt_IN[bEpNum-1])();
+#ifdef USB_INT_STATS
+      Stats_Nak(bEpNum, 1, _GetEPTxStatus(bEpNum) == EP_TX_NAK);
+#endif /* USB_INT_STATS */
+    } /* if((wEPVal & EP_CTR_TX) != 0) */
 
+#ifdef USB_INT_STATS
+    USB_Int_Stats.Cycles[bEpNum] += STATS_CYCLES() - dwStart;
+#endif /* USB_INT_STATS */
   }/* while(...) */
+
+#ifdef USB_INT_STATS
+  dwStart = STATS_CYCLES() - dwEntry;
+  if (dwStart > USB_Int_Stats.Max_Cycles)
+  {
+    USB_Int_Stats.Max_Cycles = dwStart;
+  }
+#endif /* USB_INT_STATS */
 }
 
 /*******************************************************************************
@@ -39,6 +39,8 @@
 /*******************************************************************************
 * Function Name  : UserToPMABufferCopy
 * Description    : Copy a buffer from user memory area to packet memory area (PMA)
+*                  A word aligned buffer is read a word at a time, 8 bytes
+*                  per iteration.
 * Input          : - pbUsrBuf: pointer to user memory area.
 *                  - wPMABufAddr: address into PMA.
 *                  - wNBytes: no. of bytes to be copied.
@@ -49,8 +51,28 @@ void UserToPMABufferCopy(uint8_t *pbUsrBuf, uint16_t wPMABufAddr, uint16_t wNByt
 {
   uint32_t n = (wNBytes + 1) >> 1;   /* n = (wNBytes + 1) / 2 */
   uint32_t i, temp1, temp2;
+  uint32_t *pwUsrBuf;
   uint16_t *pdwVal;
   pdwVal = (uint16_t *)(wPMABufAddr * 2 + PMAAddr);
+
+  if (((uint32_t)pbUsrBuf & 0x03) == 0)
+  {
+    /* each halfword of the PMA takes a 32 bits slot */
+    pwUsrBuf = (uint32_t *)pbUsrBuf;
+    for (i = n >> 2; i != 0; i--)
+    {
+      temp1 = *pwUsrBuf++;
+      temp2 = *pwUsrBuf++;
+      pdwVal[0] = (uint16_t)temp1;
+      pdwVal[2] = (uint16_t)(temp1 >> 16);
+      pdwVal[4] = (uint16_t)temp2;
+      pdwVal[6] = (uint16_t)(temp2 >> 16);
+      pdwVal += 8;
+    }
+    pbUsrBuf = (uint8_t *)pwUsrBuf;
+    n &= 0x03;
+  }
+
   for (i = n; i != 0; i--)
   {
     temp1 = (uint16_t) * pbUsrBuf;
@@ -65,6 +87,8 @@ void UserToPMABufferCopy(uint8_t *pbUsrBuf, uint16_t wPMABufAddr, uint16_t wNByt
 /*******************************************************************************
 * Function Name  : PMAToUserBufferCopy
 * Description    : Copy a buffer from user memory area to packet memory area (PMA)
+*                  A word aligned buffer is written a word at a time, 8 bytes
+*                  per iteration. Only wNBytes bytes are written.
 * Input          : - pbUsrBuf    = pointer to user memory area.
 *                  - wPMABufAddr = address into PMA.
 *                  - wNBytes     = no. of bytes to be copied.
@@ -73,14 +97,34 @@ void UserToPMABufferCopy(uint8_t *pbUsrBuf, uint16_t wPMABufAddr, uint16_t wNByt
 *******************************************************************************/
 void PMAToUserBufferCopy(uint8_t *pbUsrBuf, uint16_t wPMABufAddr, uint16_t wNBytes)
 {
-  uint32_t n = (wNBytes + 1) >> 1;/* /2*/
   uint32_t i;
+  uint32_t *pwUsrBuf;
   uint32_t *pdwVal;
   pdwVal = (uint32_t *)(wPMABufAddr * 2 + PMAAddr);
-  for (i = n; i != 0; i--)
+
+  if (((uint32_t)pbUsrBuf & 0x03) == 0)
   {
-    *(uint16_t*)pbUsrBuf++ = *pdwVal++;
-    pbUsrBuf++;
+    pwUsrBuf = (uint32_t *)pbUsrBuf;
+    for (i = wNBytes >> 3; i != 0; i--)
+    {
+      pwUsrBuf[0] = (pdwVal[0] & 0xFFFF) | (pdwVal[1] << 16);
+      pwUsrBuf[1] = (pdwVal[2] & 0xFFFF) | (pdwVal[3] << 16);
+      pwUsrBuf += 2;
+      pdwVal += 4;
+    }
+    pbUsrBuf = (uint8_t *)pwUsrBuf;
+    wNBytes &= 0x07;
+  }
+
+  for (i = wNBytes >> 1; i != 0; i--)
+  {
+    *(uint16_t*)pbUsrBuf = *pdwVal++;
+    pbUsrBuf += 2;
+  }
+
+  if (wNBytes & 0x01)
+  {
+    *pbUsrBuf = (uint8_t)*pdwVal;
   }
 }
 
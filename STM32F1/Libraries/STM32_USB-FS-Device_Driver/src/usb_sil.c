@@ -100,4 +100,176 @@ uint32_t USB_SIL_Read(uint8_t bEpAddr, uint8_t* pBufferPointer)
   return DataLength;
 }
 
+/*******************************************************************************
+* Function Name  : USB_SIL_Reserve
+* Description    : Start a packet written in place in the transmit buffer of
+*                  an endpoint, field by field with USB_SIL_Put8/16/32, without
+*                  a copy in RAM. USB_SIL_Commit() ends it.
+* Input          : - pPacket: the packet.
+*                  - bEpAddr: The address of the non control endpoint.
+* Output         : None.
+* Return         : None.
+*******************************************************************************/
+void USB_SIL_Reserve(USB_SIL_Packet *pPacket, uint8_t bEpAddr)
+{
+  pPacket->bEpNum = bEpAddr & 0x7F;
+  pPacket->pdwVal = (uint32_t *)(GetEPTxAddr(pPacket->bEpNum) * 2 + PMAAddr);
+  pPacket->wCount = 0;
+  pPacket->wHold = 0;
+}
+
+/*******************************************************************************
+* Function Name  : USB_SIL_Put8
+* Description    : Append a byte to a packet started by USB_SIL_Reserve().
+* Input          : - pPacket: the packet.
+*                  - bData: the byte.
+* Output         : None.
+* Return         : None.
+*******************************************************************************/
+void USB_SIL_Put8(USB_SIL_Packet *pPacket, uint8_t bData)
+{
+  if (pPacket->wCount & 0x01)
+  {
+    *pPacket->pdwVal++ = pPacket->wHold | ((uint16_t)bData << 8);
+  }
+  else
+  {
+    pPacket->wHold = bData;
+  }
+  pPacket->wCount++;
+}
+
+/*******************************************************************************
+* Function Name  : USB_SIL_Put16
+* Description    : Append a halfword, little endian, to a packet started by
+*                  USB_SIL_Reserve().
+* Input          : - pPacket: the packet.
+*                  - wData: the halfword.
+* Output         : None.
+* Return         : None.
+*******************************************************************************/
+void USB_SIL_Put16(USB_SIL_Packet *pPacket, uint16_t wData)
+{
+  if (pPacket->wCount & 0x01)
+  {
+    USB_SIL_Put8(pPacket, (uint8_t)wData);
+    USB_SIL_Put8(pPacket, (uint8_t)(wData >> 8));
+  }
+  else
+  {
+    *pPacket->pdwVal++ = wData;
+    pPacket->wCount += 2;
+  }
+}
+
+/*******************************************************************************
+* Function Name  : USB_SIL_Put32
+* Description    : Append a word, little endian, to a packet started by
+*                  USB_SIL_Reserve().
+* Input          : - pPacket: the packet.
+*                  - dwData: the word.
+* Output         : None.
+* Return         : None.
+*******************************************************************************/
+void USB_SIL_Put32(USB_SIL_Packet *pPacket, uint32_t dwData)
+{
+  USB_SIL_Put16(pPacket, (uint16_t)dwData);
+  USB_SIL_Put16(pPacket, (uint16_t)(dwData >> 16));
+}
+
+/*******************************************************************************
+* Function Name  : USB_SIL_Commit
+* Description    : End a packet started by USB_SIL_Reserve() and update the
+*                  data length of the endpoint. As after USB_SIL_Write(), the
+*                  endpoint is then made valid by the caller.
+* Input          : - pPacket: the packet.
+* Output         : None.
+* Return         : None.
+*******************************************************************************/
+void USB_SIL_Commit(USB_SIL_Packet *pPacket)
+{
+  if (pPacket->wCount & 0x01)
+  {
+    *pPacket->pdwVal = pPacket->wHold;
+  }
+
+  SetEPTxCount(pPacket->bEpNum, pPacket->wCount);
+}
+
+/*******************************************************************************
+* Function Name  : USB_SIL_Receive
+* Description    : Start reading in place the packet received on an endpoint,
+*                  field by field with USB_SIL_Get8/16/32, without a copy in
+*                  RAM.
+* Input          : - pPacket: the packet.
+*                  - bEpAddr: The address of the non control endpoint.
+* Output         : None.
+* Return         : Number of received data (in Bytes).
+*******************************************************************************/
+uint32_t USB_SIL_Receive(USB_SIL_Packet *pPacket, uint8_t bEpAddr)
+{
+  pPacket->bEpNum = bEpAddr & 0x7F;
+  pPacket->pdwVal = (uint32_t *)(GetEPRxAddr(pPacket->bEpNum) * 2 + PMAAddr);
+  pPacket->wCount = 0;
+  pPacket->wHold = 0;
+
+  return GetEPRxCount(pPacket->bEpNum);
+}
+
+/*******************************************************************************
+* Function Name  : USB_SIL_Get8
+* Description    : Read the next byte of a packet started by USB_SIL_Receive().
+*                  Reading past the received data gives no error.
+* Input          : - pPacket: the packet.
+* Output         : None.
+* Return         : The byte.
+*******************************************************************************/
+uint8_t USB_SIL_Get8(USB_SIL_Packet *pPacket)
+{
+  if ((pPacket->wCount++ & 0x01) == 0)
+  {
+    pPacket->wHold = (uint16_t)*pPacket->pdwVal++;
+    return (uint8_t)pPacket->wHold;
+  }
+
+  return (uint8_t)(pPacket->wHold >> 8);
+}
+
+/*******************************************************************************
+* Function Name  : USB_SIL_Get16
+* Description    : Read the next halfword, little endian, of a packet started
+*                  by USB_SIL_Receive().
+* Input          : - pPacket: the packet.
+* Output         : None.
+* Return         : The halfword.
+*******************************************************************************/
+uint16_t USB_SIL_Get16(USB_SIL_Packet *pPacket)
+{
+  uint16_t wData;
+
+  if (pPacket->wCount & 0x01)
+  {
+    wData = USB_SIL_Get8(pPacket);
+    return wData | ((uint16_t)USB_SIL_Get8(pPacket) << 8);
+  }
+
+  pPacket->wCount += 2;
+  return (uint16_t)*pPacket->pdwVal++;
+}
+
+/*******************************************************************************
+* Function Name  : USB_SIL_Get32
+* Description    : Read the next word, little endian, of a packet started by
+*                  USB_SIL_Receive().
+* Input          : - pPacket: the packet.
+* Output         : None.
+* Return         : The word.
+*******************************************************************************/
+uint32_t USB_SIL_Get32(USB_SIL_Packet *pPacket)
+{
+  uint32_t dwData = USB_SIL_Get16(pPacket);
+
+  return dwData | ((uint32_t)USB_SIL_Get16(pPacket) << 16);
+}
+
 /************************ (C) COPYRIGHT STMicroelectronics *****END OF FILE****/
@@ -0,0 +1,254 @@
+/**
+ *  @file       PWMEngine.c
+ *  @author     Luis Maduro
+ *  @version    1.00
+ *  @date       14/10/2026
+ *  @brief      Multi-channel PWM with compare values committed by DMA burst.
+ *
+ *  Copyright (C) 2026  Luis Maduro
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "PWMEngine.h"
+#include "PowerManager.h"
+
+#if PWM_ENGINE_TIMER == 1
+#define PWM_TIMER                   TIM1
+#define PWM_TIMER_RCC               RCC_APB2Periph_TIM1
+#define PWM_GPIO                    GPIOA
+#define PWM_GPIO_RCC                RCC_APB2Periph_GPIOA
+#define PWM_GPIO_FIRST_PIN          GPIO_Pin_8
+#define PWM_DMA_CHANNEL             DMA1_Channel5
+#define PWM_DMA_RCC                 RCC_AHBPeriph_DMA1
+#elif PWM_ENGINE_TIMER == 8
+#define PWM_TIMER                   TIM8
+#define PWM_TIMER_RCC               RCC_APB2Periph_TIM8
+#define PWM_GPIO                    GPIOC
+#define PWM_GPIO_RCC                RCC_APB2Periph_GPIOC
+#define PWM_GPIO_FIRST_PIN          GPIO_Pin_6
+#define PWM_DMA_CHANNEL             DMA2_Channel1
+#define PWM_DMA_RCC                 RCC_AHBPeriph_DMA2
+#else
+#error "PWM_ENGINE_TIMER must be 1 or 8"
+#endif
+
+tPWMEngineStatistics PWMEngineStatistics;
+
+static uint16_t buffers[2][PWM_ENGINE_CHANNELS];
+/**Index of the staging buffer.*/
+static uint8_t stage;
+static uint8_t channelCount;
+static bool running = false;
+
+/**
+ * Starts the PWM, all the outputs low.
+ * @param frequency Frequency of the PWM in Hz.
+ * @param channels Channels used, 1 to 4, from channel 1.
+ * @return Timer ticks of a period, the compare value of 100 %, 0 if the
+ * arguments are wrong.
+ */
+uint16_t PWMEngineInit(uint32_t frequency, uint8_t channels)
+{
+    GPIO_InitTypeDef GPIO_InitStructure;
+    TIM_TimeBaseInitTypeDef TIM_TimeBaseStructure;
+    TIM_OCInitTypeDef TIM_OCInitStructure;
+    DMA_InitTypeDef DMA_InitStructure;
+    RCC_ClocksTypeDef clocks;
+    uint32_t clock;
+    uint32_t ticks;
+    uint16_t prescaler;
+
+    if ((channels == 0) || (channels > PWM_ENGINE_CHANNELS) || (frequency == 0))
+    {
+        return 0;
+    }
+
+    //the timers of APB2 run at twice PCLK2 when APB2 is divided
+    RCC_GetClocksFreq(&clocks);
+    clock = clocks.PCLK2_Frequency;
+    if (RCC->CFGR & RCC_CFGR_PPRE2_2)
+    {
+        clock *= 2;
+    }
+
+    ticks = clock / frequency;
+    if ((ticks < 2) || (ticks > 0xFFFF0000UL))
+    {
+        return 0;
+    }
+    //a period of 0xFFFF ticks at most, 100 % fits in a compare register
+    prescaler = (uint16_t) ((ticks - 1) / 0xFFFF);
+    ticks /= prescaler + 1;
+
+    channelCount = channels;
+    stage = 0;
+    buffers[0][0] = buffers[0][1] = buffers[0][2] = buffers[0][3] = 0;
+    buffers[1][0] = buffers[1][1] = buffers[1][2] = buffers[1][3] = 0;
+
+    RCC_AHBPeriphClockCmd(PWM_DMA_RCC, ENABLE);
+    RCC_APB2PeriphClockCmd(PWM_TIMER_RCC | PWM_GPIO_RCC, ENABLE);
+
+    GPIO_InitStructure.GPIO_Pin = (uint16_t) (((1U << channels) - 1) * PWM_GPIO_FIRST_PIN);
+    GPIO_InitStructure.GPIO_Mode = GPIO_Mode_AF_PP;
+    GPIO_InitStructure.GPIO_Speed = GPIO_Speed_50MHz;
+    GPIO_Init(PWM_GPIO, &GPIO_InitStructure);
+
+    TIM_DeInit(PWM_TIMER);
+    TIM_TimeBaseStructInit(&TIM_TimeBaseStructure);
+    TIM_TimeBaseStructure.TIM_Prescaler = prescaler;
+    TIM_TimeBaseStructure.TIM_Period = (uint16_t) (ticks - 1);
+    TIM_TimeBaseInit(PWM_TIMER, &TIM_TimeBaseStructure);
+    TIM_ARRPreloadConfig(PWM_TIMER, ENABLE);
+
+    //preloaded, the values of a burst become active together
+    TIM_OCStructInit(&TIM_OCInitStructure);
+    TIM_OCInitStructure.TIM_OCMode = TIM_OCMode_PWM1;
+    TIM_OCInitStructure.TIM_OutputState = TIM_OutputState_Enable;
+    TIM_OCInitStructure.TIM_Pulse = 0;
+    TIM_OCInitStructure.TIM_OCPolarity = TIM_OCPolarity_High;
+    TIM_OC1Init(PWM_TIMER, &TIM_OCInitStructure);
+    TIM_OC1PreloadConfig(PWM_TIMER, TIM_OCPreload_Enable);
+    if (channels >= 2)
+    {
+        TIM_OC2Init(PWM_TIMER, &TIM_OCInitStructure);
+        TIM_OC2PreloadConfig(PWM_TIMER, TIM_OCPreload_Enable);
+    }
+    if (channels >= 3)
+    {
+        TIM_OC3Init(PWM_TIMER, &TIM_OCInitStructure);
+        TIM_OC3PreloadConfig(PWM_TIMER, TIM_OCPreload_Enable);
+    }
+    if (channels >= 4)
+    {
+        TIM_OC4Init(PWM_TIMER, &TIM_OCInitStructure);
+        TIM_OC4PreloadConfig(PWM_TIMER, TIM_OCPreload_Enable);
+    }
+
+    //an update request writes CCR1 to CCRn through DMAR
+    TIM_DMAConfig(PWM_TIMER, TIM_DMABase_CCR1, (uint16_t) ((channels - 1) << 8));
+    TIM_DMACmd(PWM_TIMER, TIM_DMA_Update, ENABLE);
+
+    DMA_DeInit(PWM_DMA_CHANNEL);
+    DMA_InitStructure.DMA_PeripheralBaseAddr = (uint32_t) &PWM_TIMER->DMAR;
+    DMA_InitStructure.DMA_MemoryBaseAddr = (uint32_t) buffers[1];
+    DMA_InitStructure.DMA_DIR = DMA_DIR_PeripheralDST;
+    DMA_InitStructure.DMA_BufferSize = 0;
+    DMA_InitStructure.DMA_PeripheralInc = DMA_PeripheralInc_Disable;
+    DMA_InitStructure.DMA_MemoryInc = DMA_MemoryInc_Enable;
+    DMA_InitStructure.DMA_PeripheralDataSize = DMA_PeripheralDataSize_HalfWord;
+    DMA_InitStructure.DMA_MemoryDataSize = DMA_MemoryDataSize_HalfWord;
+    DMA_InitStructure.DMA_Mode = DMA_Mode_Normal;
+    DMA_InitStructure.DMA_Priority = DMA_Priority_VeryHigh;
+    DMA_InitStructure.DMA_M2M = DMA_M2M_Disable;
+    DMA_Init(PWM_DMA_CHANNEL, &DMA_InitStructure);
+
+    TIM_Cmd(PWM_TIMER, ENABLE);
+    TIM_CtrlPWMOutputs(PWM_TIMER, ENABLE);
+
+    if (!running)
+    {
+        running = true;
+#ifdef USE_POWER_MANAGER
+        PowerManagerKeepAwake(POWER_MODE_STOP);
+#endif
+    }
+
+    return (uint16_t) ticks;
+}
+
+/**
+ * Gives the staging buffer, one compare value per channel, holding the
+ * values of the last commit.
+ * @return The buffer.
+ */
+uint16_t *PWMEngineStage(void)
+{
+    return buffers[stage];
+}
+
+/**
+ * Commits the staging buffer, its values are active from the second update
+ * event from now.
+ */
+void PWMEngineCommit(void)
+{
+    uint16_t *committed = buffers[stage];
+    uint16_t remaining;
+    uint32_t primask;
+    uint8_t i;
+
+    primask = __get_PRIMASK();
+    __disable_irq();
+
+    DMA_Cmd(PWM_DMA_CHANNEL, DISABLE);
+    remaining = DMA_GetCurrDataCounter(PWM_DMA_CHANNEL);
+
+    if (remaining == channelCount)
+    {
+        PWMEngineStatistics.Superseded++;
+    }
+    else if (remaining != 0)
+    {
+        //a burst was cut just after an update, the shadow registers are
+        //completed now, long before the next update
+        for (i = 0; i < channelCount; i++)
+        {
+            (&PWM_TIMER->CCR1)[2 * i] = committed[i];
+        }
+    }
+
+    PWM_DMA_CHANNEL->CMAR = (uint32_t) committed;
+    DMA_SetCurrDataCounter(PWM_DMA_CHANNEL, channelCount);
+    DMA_Cmd(PWM_DMA_CHANNEL, ENABLE);
+
+    __set_PRIMASK(primask);
+
+    PWMEngineStatistics.Commits++;
+
+    //the buffer of the last commit was written by its burst or superseded
+    stage ^= 1;
+    for (i = 0; i < channelCount; i++)
+    {
+        buffers[stage][i] = committed[i];
+    }
+}
+
+/**
+ * Tells if a commit is waiting for its update event.
+ * @return True if pending.
+ */
+bool PWMEngineIsPending(void)
+{
+    return DMA_GetCurrDataCounter(PWM_DMA_CHANNEL) != 0;
+}
+
+/**
+ * Stops the PWM, the outputs are disabled.
+ */
+void PWMEngineStop(void)
+{
+    TIM_CtrlPWMOutputs(PWM_TIMER, DISABLE);
+    TIM_Cmd(PWM_TIMER, DISABLE);
+    DMA_Cmd(PWM_DMA_CHANNEL, DISABLE);
+    TIM_DMACmd(PWM_TIMER, TIM_DMA_Update, DISABLE);
+
+    if (running)
+    {
+        running = false;
+#ifdef USE_POWER_MANAGER
+        PowerManagerAllow(POWER_MODE_STOP);
+#endif
+    }
+}
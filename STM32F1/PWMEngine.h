@@ -0,0 +1,74 @@
+/**
+ *  @file       PWMEngine.h
+ *  @author     Luis Maduro
+ *  @version    1.00
+ *  @date       14/10/2026
+ *  @brief      Multi-channel PWM with compare values committed by DMA burst.
+ *
+ *  The compare values of the next period are written to a staging buffer
+ *  given by PWMEngineStage() and handed over at once with
+ *  PWMEngineCommit(). The commit arms a DMA burst on the update event of
+ *  the timer, which writes all the CCRx in one go through DMAR. The CCRx
+ *  are preloaded, so the values written in the burst become active
+ *  together at the update after, a period never mixes old and new values.
+ *
+ *  The buffer committed is not written until the next commit, the other
+ *  one becomes the staging buffer. Committing again before the update
+ *  replaces the values pending, only the last commit of a period is
+ *  applied.
+ *
+ *  The timer is TIM1 (PA8 to PA11, DMA1 channel 5, also used by
+ *  FrequencyCapture) or TIM8 (PC6 to PC9, DMA2 channel 1, high density, XL
+ *  density and connectivity line only), edge aligned, PWM mode 1 and active
+ *  high outputs.
+ *
+ *  Copyright (C) 2026  Luis Maduro
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef PWMENGINE_H
+#define PWMENGINE_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stm32f10x.h>
+
+/**Timer of the engine, 1 or 8.*/
+#ifndef PWM_ENGINE_TIMER
+#define PWM_ENGINE_TIMER            8
+#endif
+
+/**Maximum number of channels.*/
+#define PWM_ENGINE_CHANNELS         4
+
+/**
+ * Counters of the engine.
+ */
+typedef struct
+{
+    unsigned int Commits;
+    /**Commits replaced by an other one before the update.*/
+    unsigned int Superseded;
+} tPWMEngineStatistics;
+
+extern tPWMEngineStatistics PWMEngineStatistics;
+
+uint16_t PWMEngineInit(uint32_t frequency, uint8_t channels);
+uint16_t *PWMEngineStage(void);
+void PWMEngineCommit(void);
+bool PWMEngineIsPending(void);
+void PWMEngineStop(void);
+
+#endif /* PWMENGINE_H */
@@ -0,0 +1,250 @@
+/**
+ *  @file       PowerManager.c
+ *  @author     Luis Maduro
+ *  @version    1.00
+ *  @date       14/10/2026
+ *  @brief      Low power modes for the tickless scheduler, woken by the RTC
+ *              alarm.
+ *
+ *  Copyright (C) 2026  Luis Maduro
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "PowerManager.h"
+#include "uKernel.h"
+
+tPowerManagerStatistics PowerManagerStatistics;
+
+/**Drivers holding each mode off.*/
+static volatile uint8_t keepAwake[POWER_MODES];
+/**Part of a ms left over by the conversion of the time elapsed, in us.*/
+static uint32_t fraction;
+
+/**
+ * Restarts the clocks stopped in STOP as they were before, the
+ * microcontroller wakes up on the HSI.
+ * @param cr RCC->CR before STOP.
+ * @param cfgr RCC->CFGR before STOP.
+ */
+static void PowerManagerRestoreClocks(uint32_t cr, uint32_t cfgr)
+{
+    if (cr & RCC_CR_HSEON)
+    {
+        RCC->CR |= RCC_CR_HSEON;
+        while ((RCC->CR & RCC_CR_HSERDY) == 0);
+    }
+
+#ifdef STM32F10X_CL
+    if (cr & RCC_CR_PLL2ON)
+    {
+        RCC->CR |= RCC_CR_PLL2ON;
+        while ((RCC->CR & RCC_CR_PLL2RDY) == 0);
+    }
+#endif
+
+    if (cr & RCC_CR_PLLON)
+    {
+        RCC->CR |= RCC_CR_PLLON;
+        while ((RCC->CR & RCC_CR_PLLRDY) == 0);
+    }
+
+    //SWS is SW two bits up
+    if ((cfgr & RCC_CFGR_SWS) != RCC_CFGR_SWS_HSI)
+    {
+        RCC->CFGR = (RCC->CFGR & ~RCC_CFGR_SW) | ((cfgr & RCC_CFGR_SWS) >> 2);
+        while ((RCC->CFGR & RCC_CFGR_SWS) != (cfgr & RCC_CFGR_SWS));
+    }
+}
+
+/**
+ * Starts the RTC by TimeBaseInit() and the alarm interrupt on EXTI line 17.
+ */
+void PowerManagerInit(void)
+{
+    EXTI_InitTypeDef EXTI_InitStructure;
+    NVIC_InitTypeDef NVIC_InitStructure;
+
+    TimeBaseInit();
+
+    //the alarm reaches the EXTI, the only way out of STOP
+    EXTI_ClearITPendingBit(EXTI_Line17);
+    EXTI_InitStructure.EXTI_Line = EXTI_Line17;
+    EXTI_InitStructure.EXTI_Mode = EXTI_Mode_Interrupt;
+    EXTI_InitStructure.EXTI_Trigger = EXTI_Trigger_Rising;
+    EXTI_InitStructure.EXTI_LineCmd = ENABLE;
+    EXTI_Init(&EXTI_InitStructure);
+
+    RTC_ITConfig(RTC_IT_ALR, ENABLE);
+    RTC_WaitForLastTask();
+
+    NVIC_InitStructure.NVIC_IRQChannel = RTCAlarm_IRQn;
+    NVIC_InitStructure.NVIC_IRQChannelPreemptionPriority = POWER_MANAGER_IRQ_PRIORITY;
+    NVIC_InitStructure.NVIC_IRQChannelSubPriority = 0;
+    NVIC_InitStructure.NVIC_IRQChannelCmd = ENABLE;
+    NVIC_Init(&NVIC_InitStructure);
+}
+
+/**
+ * Holds a mode off, until PowerManagerAllow() of the same mode.
+ * @param mode POWER_MODE_SLEEP to keep the CPU running, POWER_MODE_STOP to
+ * keep the clocks running.
+ */
+void PowerManagerKeepAwake(tPowerMode mode)
+{
+    uint32_t primask;
+
+    primask = __get_PRIMASK();
+    __disable_irq();
+    keepAwake[mode]++;
+    __set_PRIMASK(primask);
+}
+
+/**
+ * Gives back a mode held off by PowerManagerKeepAwake().
+ * @param mode Mode.
+ */
+void PowerManagerAllow(tPowerMode mode)
+{
+    uint32_t primask;
+
+    primask = __get_PRIMASK();
+    __disable_irq();
+    if (keepAwake[mode] != 0)
+    {
+        keepAwake[mode]--;
+    }
+    __set_PRIMASK(primask);
+}
+
+/**
+ * Stops SysTick and sleeps in the deepest mode allowed until the deadline
+ * or an interrupt.
+ * @param sleepMs Time until the deadline.
+ * @return Milliseconds elapsed, SysTick is still stopped.
+ */
+uint32_t PowerManagerSleep(uint32_t sleepMs)
+{
+    uint32_t ticks = (uint32_t) ((uint64_t) sleepMs * TimeBaseGetRate() / 1000000);
+    uint64_t start;
+    uint64_t elapsed;
+    uint32_t cr;
+    uint32_t cfgr;
+    bool stop;
+
+    if ((keepAwake[POWER_MODE_SLEEP] != 0) || (ticks == 0))
+    {
+        return 0;
+    }
+
+    SysTick->CTRL &= ~SysTick_CTRL_ENABLE_Msk;
+
+    start = TimeBaseNowUs();
+    RTC_SetAlarm(RTC_GetCounter() + ticks);
+    RTC_WaitForLastTask();
+    RTC_ClearFlag(RTC_FLAG_ALR);
+    EXTI_ClearITPendingBit(EXTI_Line17);
+
+    //an interrupt from now on is pending and ends the sleep at once, the
+    //ones before may have signaled a task since the scheduler looked
+    __disable_irq();
+
+    if (uKernelSignalsPending())
+    {
+        __enable_irq();
+        return 0;
+    }
+
+#ifdef USE_DEFERRED_WORK
+    if (DeferredWorkPending())
+    {
+        __enable_irq();
+        return 0;
+    }
+#endif
+
+    stop = (keepAwake[POWER_MODE_STOP] == 0) && (sleepMs >= POWER_MANAGER_STOP_MIN_MS);
+
+    if (stop)
+    {
+        cr = RCC->CR;
+        cfgr = RCC->CFGR;
+
+        PWR_EnterSTOPMode(PWR_Regulator_LowPower, PWR_STOPEntry_WFI);
+
+        PowerManagerRestoreClocks(cr, cfgr);
+        PowerManagerStatistics.Stops++;
+    }
+    else
+    {
+        SCB->SCR &= ~SCB_SCR_SLEEPDEEP_Msk;
+        __WFI();
+        PowerManagerStatistics.Sleeps++;
+    }
+
+    if (RTC_GetFlagStatus(RTC_FLAG_ALR) == RESET)
+    {
+        PowerManagerStatistics.EarlyWakes++;
+    }
+
+    //the registers of the RTC are read again after the APB1 clock stopped
+    if (stop)
+    {
+        RTC_WaitForSynchro();
+    }
+
+    elapsed = TimeBaseNowUs() - start + fraction;
+
+    __enable_irq();
+
+    fraction = (uint32_t) (elapsed % 1000);
+
+    return (uint32_t) (elapsed / 1000);
+}
+
+/**
+ * Restarts SysTick after PowerManagerSleep().
+ */
+void PowerManagerResumeTick(void)
+{
+    SysTick->VAL = 0;
+    SysTick->CTRL |= SysTick_CTRL_ENABLE_Msk;
+}
+
+#ifdef UKERNEL_USE_TICKLESS
+
+uint32_t uKernelPortSleep(uint32_t sleepMs)
+{
+    return PowerManagerSleep(sleepMs);
+}
+
+void uKernelPortResumeTick(void)
+{
+    PowerManagerResumeTick();
+}
+
+#endif
+
+/**
+ * This funtion is intended to be put in RTCAlarm_IRQHandler().
+ */
+void PowerManagerAlarmInterruptHandler(void)
+{
+    if (RTC_GetITStatus(RTC_IT_ALR) != RESET)
+    {
+        EXTI_ClearITPendingBit(EXTI_Line17);
+        RTC_ClearITPendingBit(RTC_IT_ALR);
+        RTC_WaitForLastTask();
+    }
+}
@@ -0,0 +1,106 @@
+/**
+ *  @file       PowerManager.h
+ *  @author     Luis Maduro
+ *  @version    1.00
+ *  @date       14/10/2026
+ *  @brief      Low power modes for the tickless scheduler, woken by the RTC
+ *              alarm.
+ *
+ *  The tickless uKernel (UKERNEL_USE_TICKLESS) calls uKernelPortSleep()
+ *  with the time to the next task, this file supplies it and
+ *  uKernelPortResumeTick(). PowerManagerSleep() stops SysTick, sets the RTC
+ *  alarm at the deadline and enters the deepest mode allowed:
+ *  - STOP, the 1.8 V domain clocks stopped and the regulator in low power,
+ *    when no driver holds it off and the sleep is long enough to pay for
+ *    the restart of the HSE and the PLL;
+ *  - SLEEP otherwise, only the CPU clock stopped, while a DMA transfer, a
+ *    timer or a peripheral clocked from the APB is running;
+ *  - none, when a driver needs the CPU to keep running.
+ *  Any interrupt ends the sleep early, the time elapsed is read from
+ *  TimeBaseNowUs().
+ *
+ *  A driver holds a mode off with PowerManagerKeepAwake() when it starts
+ *  working and gives it back with PowerManagerAllow() when it is done, the
+ *  holds are counted per mode. With USE_POWER_MANAGER defined, the drivers
+ *  of this directory that run from a timer or a DMA do it by themselves.
+ *
+ *  The clocks are restored straight from the registers on the wake from
+ *  STOP: HSE, PLL2 on the connectivity line, PLL and SYSCLK as they were
+ *  before, the prescalers and the flash latency do not change in STOP. The
+ *  interrupt that woke the microcontroller runs after that.
+ *
+ *  The RTC is started by TimeBase.c and keeps counting, the time of
+ *  TimeBaseNowUs() goes on through the sleeps. STANDBY is not used, it
+ *  loses the RAM and resets.
+ *
+ *  Copyright (C) 2026  Luis Maduro
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef POWERMANAGER_H
+#define POWERMANAGER_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stm32f10x.h>
+#include "TimeBase.h"
+
+/**Uncomment for the drivers to hold the low power modes off while they
+ work.*/
+//#define USE_POWER_MANAGER
+
+/**Shortest sleep, in ms, worth the restart of the clocks after STOP.*/
+#ifndef POWER_MANAGER_STOP_MIN_MS
+#define POWER_MANAGER_STOP_MIN_MS   5
+#endif
+
+/**Priority of the RTC alarm interrupt.*/
+#ifndef POWER_MANAGER_IRQ_PRIORITY
+#define POWER_MANAGER_IRQ_PRIORITY  3
+#endif
+
+/**
+ * Modes a driver can hold off, from the lightest.
+ */
+typedef enum
+{
+    /**The CPU must run, no sleep at all.*/
+    POWER_MODE_SLEEP = 0,
+    /**The clocks must run, SLEEP at most.*/
+    POWER_MODE_STOP,
+    POWER_MODES
+} tPowerMode;
+
+/**
+ * Counters of the manager.
+ */
+typedef struct
+{
+    unsigned int Sleeps;
+    unsigned int Stops;
+    /**Sleeps ended by another interrupt than the alarm.*/
+    unsigned int EarlyWakes;
+} tPowerManagerStatistics;
+
+extern tPowerManagerStatistics PowerManagerStatistics;
+
+void PowerManagerInit(void);
+void PowerManagerKeepAwake(tPowerMode mode);
+void PowerManagerAllow(tPowerMode mode);
+uint32_t PowerManagerSleep(uint32_t sleepMs);
+void PowerManagerResumeTick(void);
+void PowerManagerAlarmInterruptHandler(void);
+
+#endif /* POWERMANAGER_H */
@@ -0,0 +1,180 @@
+/**
+ *  @file       Profiler.c
+ *  @author     Luis Maduro
+ *  @version    1.00
+ *  @date       14/10/2026
+ *  @brief      Named probes timed with the DWT cycle counter.
+ *
+ *  Copyright (C) 2026  Luis Maduro
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <stddef.h>
+#include "Profiler.h"
+
+#ifdef USE_PROFILER
+
+/**Characters of the name written in a line.*/
+#define PROFILER_NAME_LENGTH        40
+/**A line: the name, four values of up to 10 digits after a space and CRLF.*/
+#define PROFILER_LINE_LENGTH        (PROFILER_NAME_LENGTH + 4 * (1 + 10) + 2)
+
+/**End of the list, the Next of a probe not listed is NULL.*/
+static tProfilerProbe listEnd;
+static tProfilerProbe *probes = &listEnd;
+/**Cycles of an empty probe.*/
+static uint32_t overhead;
+
+/**
+ * Starts the cycle counter and measures the cost of a probe.
+ */
+void ProfilerInit(void)
+{
+    tProfilerProbe empty;
+    uint32_t end;
+
+    CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+    DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+
+    overhead = 0;
+    PROFILER_BEGIN(empty);
+    end = DWT->CYCCNT;
+    overhead = end - empty.Start;
+}
+
+/**
+ * Adds the time of a probe, called by PROFILER_END().
+ * @param probe Probe.
+ * @param end Cycle counter at the end.
+ */
+void ProfilerEnd(tProfilerProbe *probe, uint32_t end)
+{
+    uint32_t cycles = end - probe->Start - overhead;
+    uint32_t primask;
+
+    //wrong only if the probe lasts more than 2^32 cycles, 59 s at 72 MHz
+    if (cycles < probe->Min)
+        probe->Min = cycles;
+
+    if (cycles > probe->Max)
+        probe->Max = cycles;
+
+    probe->Sum += cycles;
+    probe->Count++;
+
+    if (probe->Next == NULL)
+    {
+        primask = __get_PRIMASK();
+        __disable_irq();
+        if (probe->Next == NULL)
+        {
+            probe->Next = probes;
+            probes = probe;
+        }
+        __set_PRIMASK(primask);
+    }
+}
+
+/**
+ * Clears the counts of all the probes listed.
+ */
+void ProfilerReset(void)
+{
+    tProfilerProbe *probe;
+    uint32_t primask;
+
+    for (probe = probes; probe != &listEnd; probe = probe->Next)
+    {
+        primask = __get_PRIMASK();
+        __disable_irq();
+        probe->Count = 0;
+        probe->Min = UINT32_MAX;
+        probe->Max = 0;
+        probe->Sum = 0;
+        __set_PRIMASK(primask);
+    }
+}
+
+/**
+ * Puts the decimal digits of a value at the end of a line.
+ * @param line Line.
+ * @param value Value.
+ * @return Characters put.
+ */
+static unsigned int ProfilerFormat(char *line, uint32_t value)
+{
+    char digits[10];
+    unsigned int length = 0;
+    unsigned int i = 0;
+
+    do
+    {
+        digits[i++] = (char) ('0' + value % 10);
+        value /= 10;
+    } while (value != 0);
+
+    line[length++] = ' ';
+    while (i != 0)
+    {
+        line[length++] = digits[--i];
+    }
+
+    return length;
+}
+
+/**
+ * Writes a line per probe: the name, the count and the minimum, average
+ * and maximum cycles. The counts are copied with the interrupts disabled,
+ * the text is written with them enabled.
+ * @param write Function that sends the text.
+ */
+void ProfilerDump(tProfilerWrite write)
+{
+    static const char header[] = "probe count min avg max (cycles)\r\n";
+    tProfilerProbe *probe;
+    tProfilerProbe copy;
+    char line[PROFILER_LINE_LENGTH];
+    unsigned int length;
+    uint32_t primask;
+
+    write(header, sizeof (header) - 1);
+
+    for (probe = probes; probe != &listEnd; probe = probe->Next)
+    {
+        primask = __get_PRIMASK();
+        __disable_irq();
+        copy = *probe;
+        __set_PRIMASK(primask);
+
+        for (length = 0; (copy.Name[length] != '\0') && (length < PROFILER_NAME_LENGTH); length++)
+        {
+            line[length] = copy.Name[length];
+        }
+
+        length += ProfilerFormat(&line[length], copy.Count);
+        if (copy.Count != 0)
+        {
+            length += ProfilerFormat(&line[length], copy.Min);
+            length += ProfilerFormat(&line[length], (uint32_t) (copy.Sum / copy.Count));
+            length += ProfilerFormat(&line[length], copy.Max);
+        }
+        line[length++] = '\r';
+        line[length++] = '\n';
+
+        write(line, length);
+    }
+}
+
+#endif
@@ -0,0 +1,99 @@
+/**
+ *  @file       Profiler.h
+ *  @author     Luis Maduro
+ *  @version    1.00
+ *  @date       14/10/2026
+ *  @brief      Named probes timed with the DWT cycle counter.
+ *
+ *  A probe is a static variable with a name, PROFILER_BEGIN() keeps the
+ *  cycle counter and PROFILER_END() adds the cycles since then to the count,
+ *  minimum, maximum and sum of the probe. Between the two reads of the
+ *  counter a probe adds one store, the cycles of an empty probe are
+ *  measured by ProfilerInit() and taken out. The update after the end costs
+ *  about 25 cycles, outside of the time measured.
+ *
+ *  PROFILER_DEFINE(spiTransfer);
+ *
+ *  void SPIWork(void)
+ *  {
+ *      PROFILER_BEGIN(spiTransfer);
+ *      SPIDeviceTransfer(...);
+ *      PROFILER_END(spiTransfer);
+ *  }
+ *
+ *  The probes are listed at their first end, ProfilerDump() writes one line
+ *  each through a function of the application, for the VCP or a USART. A
+ *  probe is used from one context, a task, a driver or an interrupt: an
+ *  interrupt ending the probe of the code it interrupted would mix the two
+ *  updates. The interrupts nested in a probe are counted in its time.
+ *
+ *  Without USE_PROFILER the macros are empty and the probes take no memory.
+ *
+ *  Copyright (C) 2026  Luis Maduro
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef PROFILER_H
+#define PROFILER_H
+
+#include <stdint.h>
+#include <stm32f10x.h>
+
+/**Uncomment to build the probes.*/
+//#define USE_PROFILER
+
+/**Writes the text of the dump, i.e. to the VCP or to a USART.*/
+typedef void (*tProfilerWrite)(const char *text, unsigned int length);
+
+typedef struct _tProfilerProbe
+{
+    /**Name in the dump.*/
+    const char *Name;
+    /**Cycle counter at the begin.*/
+    uint32_t Start;
+    uint32_t Count;
+    uint32_t Min;
+    uint32_t Max;
+    uint64_t Sum;
+    /**Next probe listed, NULL while not listed.*/
+    struct _tProfilerProbe *Next;
+} tProfilerProbe;
+
+#ifdef USE_PROFILER
+
+#define PROFILER_DEFINE(name)       tProfilerProbe name = {#name, 0, 0, UINT32_MAX, 0, 0, NULL}
+#define PROFILER_DECLARE(name)      extern tProfilerProbe name
+#define PROFILER_BEGIN(name)        ((name).Start = DWT->CYCCNT)
+#define PROFILER_END(name)          ProfilerEnd(&(name), DWT->CYCCNT)
+
+void ProfilerInit(void);
+void ProfilerEnd(tProfilerProbe *probe, uint32_t end);
+void ProfilerReset(void);
+void ProfilerDump(tProfilerWrite write);
+
+#else
+
+#define PROFILER_DEFINE(name)       extern int name##Unused
+#define PROFILER_DECLARE(name)      extern int name##Unused
+#define PROFILER_BEGIN(name)
+#define PROFILER_END(name)
+
+#define ProfilerInit()
+#define ProfilerReset()
+#define ProfilerDump(write)
+
+#endif
+
+#endif /* PROFILER_H */
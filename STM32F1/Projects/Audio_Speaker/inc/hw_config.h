@@ -51,6 +51,24 @@
 /* Exported constants --------------------------------------------------------*/
 /* Exported macro ------------------------------------------------------------*/
 /* Exported define -----------------------------------------------------------*/
+/* Ring buffer between the isochronous OUT endpoint and the audio output, a
+   power of 2. The output starts once it holds AUDIO_FIFO_TARGET samples, and
+   the output rate is trimmed at each SOF to keep it about there */
+#define AUDIO_FIFO_SIZE       256
+#define AUDIO_FIFO_TARGET     (AUDIO_FIFO_SIZE / 2)
+
+/* Largest trim of the sample timer period, in timer counts */
+#define AUDIO_TRIM_MAX        8
+
+/* Samples per half of the circular DMA buffer of the STM3210B and STM3210E
+   outputs, a half is refilled from the ring buffer while the other one plays.
+   The I2S buffer holds a left and a right word per sample */
+#define AUDIO_DMA_SAMPLES     32
+#ifdef USE_STM3210E_EVAL
+#define AUDIO_DMA_SIZE        (AUDIO_DMA_SAMPLES * 2 * 2)
+#else
+#define AUDIO_DMA_SIZE        (AUDIO_DMA_SAMPLES * 2)
+#endif
 /* Exported functions ------------------------------------------------------- */
 /* External variables --------------------------------------------------------*/
 void Set_System(void);
@@ -61,6 +79,8 @@ void USB_Config(void);
 void Audio_Config(void);
 void USB_Cable_Config (FunctionalState NewState);
 void Speaker_Config(void);
+void Audio_Trim(uint16_t Level);
+void Audio_Fill(uint16_t *Buffer);
 void NVIC_Config(void);
 void GPIO_Config(void);
 uint32_t Sound_release(uint16_t Standard, uint16_t MCLKOutput, uint16_t AudioFreq, uint8_t AudioRepetitions);
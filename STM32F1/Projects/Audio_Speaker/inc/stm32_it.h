@@ -52,9 +52,10 @@ void USB_LP_CAN1_RX0_IRQHandler(void);
 void USBWakeUp_IRQHandler(void);
 void USB_FS_WKUP_IRQHandler(void);
 #ifdef USE_STM3210B_EVAL
-void TIM2_IRQHandler(void);
+void DMA1_Channel2_IRQHandler(void);
 #endif /* USE_STM3210B_EVAL */
 #if defined (USE_STM3210E_EVAL)
+void DMA1_Channel5_IRQHandler(void);
 void SPI2_IRQHandler(void);
 #endif /* USE_STM3210E_EVAL */
 					 
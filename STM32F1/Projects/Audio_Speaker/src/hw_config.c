@@ -41,10 +41,20 @@
 /* Private variables ---------------------------------------------------------*/
 ErrorStatus HSEStartUpStatus;
 EXTI_InitTypeDef EXTI_InitStructure;
+#if defined(USE_STM32L152_EVAL) || defined(USE_STM3210B_EVAL)
+static uint16_t Audio_Period = TIM2ARRValue; /* nominal sample timer period */
+#endif
 
 /* Extern variables ----------------------------------------------------------*/
+extern int8_t Audio_Slip;
+#if defined(USE_STM3210B_EVAL) || defined(USE_STM3210E_EVAL)
+extern uint16_t Audio_Out[AUDIO_DMA_SIZE];
+#endif
 /* Private function prototypes -----------------------------------------------*/
 static void IntToUnicode (uint32_t value , uint8_t *pbuf , uint8_t len);
+#if defined(USE_STM3210B_EVAL) || defined(USE_STM3210E_EVAL)
+static void Audio_DMA_Config(DMA_Channel_TypeDef* Channel, __IO uint16_t* Register);
+#endif
 /* Private functions ---------------------------------------------------------*/
 
 /*******************************************************************************
@@ -245,20 +255,24 @@ void Audio_Config(void)
   NVIC_Init(&NVIC_InitStructure);
   
 #elif defined(USE_STM3210B_EVAL)
-  /* Enable the TIM2 Interrupt */
-  NVIC_InitStructure.NVIC_IRQChannel = TIM2_IRQn;
+  /* Enable the DMA1 Channel 2 Interrupt, the refills of the TIM2 update DMA */
+  NVIC_InitStructure.NVIC_IRQChannel = DMA1_Channel2_IRQn;
   NVIC_InitStructure.NVIC_IRQChannelPreemptionPriority = 2;
   NVIC_InitStructure.NVIC_IRQChannelSubPriority = 0;
   NVIC_InitStructure.NVIC_IRQChannelCmd = ENABLE;
   NVIC_Init(&NVIC_InitStructure);
   
 #elif defined(USE_STM3210E_EVAL)
-  /* SPI2 IRQ Channel configuration */
+  /* SPI2 IRQ Channel configuration, the dummy data of the codec setup */
   NVIC_InitStructure.NVIC_IRQChannel = SPI2_IRQn;
   NVIC_InitStructure.NVIC_IRQChannelPreemptionPriority = 2;
   NVIC_InitStructure.NVIC_IRQChannelSubPriority = 0;
   NVIC_InitStructure.NVIC_IRQChannelCmd = ENABLE;
   NVIC_Init(&NVIC_InitStructure);
+
+  /* DMA1 Channel 5 IRQ Channel configuration, the refills of the SPI2 TX DMA */
+  NVIC_InitStructure.NVIC_IRQChannel = DMA1_Channel5_IRQn;
+  NVIC_Init(&NVIC_InitStructure);
 #endif /* USE_STM3210B_EVAL */
 }
 /*******************************************************************************
@@ -321,10 +335,14 @@ void Speaker_Config(void)
   TIM_DeInit(TIM6);
 
   TIM6ARRValue = (uint32_t)(SystemCoreClock/22000); /* Audio Sample Rate = 22KHz */
+  Audio_Period = TIM6ARRValue;
 
   /* Set the timer auto reload value dependent on the audio frequency */  
   TIM_SetAutoreload(TIM6, TIM6ARRValue); /* 22.KHz = 32MHz / 1454 */  
 
+  /* Buffer the period, it is trimmed by Audio_Trim() while running */
+  TIM_ARRPreloadConfig(TIM6, ENABLE);
+
   /* TIM6 TRGO selection */
   TIM_SelectOutputTrigger(TIM6, TIM_TRGOSource_Update);
 
@@ -381,6 +399,8 @@ void Speaker_Config(void)
   TIM_TimeBaseStructure.TIM_ClockDivision = 0x0;
   TIM_TimeBaseStructure.TIM_CounterMode = TIM_CounterMode_Up;
   TIM_TimeBaseInit(TIM2, &TIM_TimeBaseStructure);
+  /* Buffer the period, it is trimmed by Audio_Trim() while running */
+  TIM_ARRPreloadConfig(TIM2, ENABLE);
   /* Output Compare Inactive Mode configuration: Channel1 */
   TIM_OCInitStructure.TIM_OCMode = TIM_OCMode_Timing;
   TIM_OCInitStructure.TIM_Pulse = 0x0;
@@ -390,19 +410,110 @@ void Speaker_Config(void)
   /* Start TIM4 */
   TIM_Cmd(TIM4, ENABLE);
 
+  /* Each TIM2 update writes the next sample to the TIM4 compare 3 register */
+  Audio_DMA_Config(DMA1_Channel2, &TIM4->CCR3);
+  TIM_DMACmd(TIM2, TIM_DMA_Update, ENABLE);
+
   /* Start TIM2 */
   TIM_Cmd(TIM2, ENABLE);
 
-  /* Enable TIM2 update interrupt */
-  TIM_ITConfig(TIM2, TIM_IT_Update, ENABLE);
-
 #else 
   /* Configure the initialization parameters */
   I2S_GPIO_Config();
   I2S_Config(I2S_Standard_Phillips, I2S_MCLKOutput_Enable, I2S_AudioFreq_22k);
   CODEC_Config(OutputDevice_SPEAKER, I2S_Standard_Phillips, I2S_MCLKOutput_Enable, 0x08);
-  SPI_I2S_ITConfig(SPI2, SPI_I2S_IT_TXE, ENABLE);
 
+  /* The samples go to the I2S by the SPI2 TX DMA */
+  Audio_DMA_Config(DMA1_Channel5, &SPI2->DR);
+  SPI_I2S_DMACmd(SPI2, SPI_I2S_DMAReq_Tx, ENABLE);
+
+#endif
+}
+
+#if defined(USE_STM3210B_EVAL) || defined(USE_STM3210E_EVAL)
+/*******************************************************************************
+* Function Name  : Audio_DMA_Config
+* Description    : Starts the circular DMA of Audio_Out to the data register of
+*                  the output, one half word per request. The half and the full
+*                  transfer interrupts refill the half just sent, see
+*                  Audio_Fill(). Both halves are filled before the start.
+* Input          :  - Channel: DMA1 channel of the request.
+*                :  - Register: register written at each request.
+* Return         : None.
+*******************************************************************************/
+static void Audio_DMA_Config(DMA_Channel_TypeDef* Channel, __IO uint16_t* Register)
+{
+  RCC_AHBPeriphClockCmd(RCC_AHBPeriph_DMA1, ENABLE);
+
+  Audio_Fill(&Audio_Out[0]);
+  Audio_Fill(&Audio_Out[AUDIO_DMA_SIZE / 2]);
+
+  Channel->CCR = 0;
+  Channel->CPAR = (uint32_t)Register;
+  Channel->CMAR = (uint32_t)Audio_Out;
+  Channel->CNDTR = AUDIO_DMA_SIZE;
+
+  /* Memory to peripheral, 16 bits both sides, circular, high priority */
+  Channel->CCR = DMA_CCR1_DIR | DMA_CCR1_CIRC | DMA_CCR1_MINC
+               | DMA_CCR1_PSIZE_0 | DMA_CCR1_MSIZE_0 | DMA_CCR1_PL_1
+               | DMA_CCR1_HTIE | DMA_CCR1_TCIE | DMA_CCR1_EN;
+}
+#endif /* USE_STM3210B_EVAL || USE_STM3210E_EVAL */
+
+/*******************************************************************************
+* Function Name  : Audio_Trim
+* Description    : Follows the host sample rate, called at each SOF with the
+*                  samples held in the ring buffer. The level is low pass
+*                  filtered, and its distance to AUDIO_FIFO_TARGET shortens or
+*                  lengthens the sample timer period by up to AUDIO_TRIM_MAX
+*                  counts. The I2S clock can't be trimmed finely, there a
+*                  sample is repeated or dropped in the next packet instead.
+* Input          : Level: samples held in the ring buffer.
+* Output         : None.
+* Return         : None.
+*******************************************************************************/
+void Audio_Trim(uint16_t Level)
+{
+  static uint32_t Level_Avg = AUDIO_FIFO_TARGET * 16; /* 16 times the level */
+  int32_t Error;
+
+  Level_Avg = Level_Avg - (Level_Avg >> 4) + Level;
+  Error = (int32_t)(Level_Avg >> 4) - AUDIO_FIFO_TARGET;
+
+#if defined(USE_STM32L152_EVAL) || defined(USE_STM3210B_EVAL)
+  /* One count every 8 samples off target, a fuller buffer plays faster */
+  Error /= 8;
+  if (Error > AUDIO_TRIM_MAX)
+  {
+    Error = AUDIO_TRIM_MAX;
+  }
+  else if (Error < -AUDIO_TRIM_MAX)
+  {
+    Error = -AUDIO_TRIM_MAX;
+  }
+ #ifdef USE_STM32L152_EVAL
+  TIM_SetAutoreload(TIM6, Audio_Period - Error);
+ #else
+  TIM_SetAutoreload(TIM2, Audio_Period - Error);
+ #endif
+#else
+  static uint8_t Slip_Wait = 0;
+
+  /* One sample at most every 16 frames, the time the level settles */
+  if (Slip_Wait != 0)
+  {
+    Slip_Wait--;
+  }
+  else if (Error > AUDIO_FIFO_SIZE / 8)
+  {
+    Audio_Slip = -1;
+    Slip_Wait = 16;
+  }
+  else if (Error < -(AUDIO_FIFO_SIZE / 8))
+  {
+    Audio_Slip = 1;
+    Slip_Wait = 16;
+  }
 #endif
 }
 
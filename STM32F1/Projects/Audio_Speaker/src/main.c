@@ -41,7 +41,7 @@
 extern uint32_t MUTE_DATA;
 extern uint16_t In_Data_Offset;
 extern uint16_t Out_Data_Offset;
-extern uint8_t Stream_Buff[24];
+extern uint8_t Stream_Buff[AUDIO_FIFO_SIZE];
 extern uint8_t IT_Clock_Sent;
 /* Private function prototypes -----------------------------------------------*/
 /* Private functions ---------------------------------------------------------*/
@@ -42,10 +42,14 @@
 /* Private variables ---------------------------------------------------------*/
 uint16_t Out_Data_Offset;
 extern uint16_t In_Data_Offset;
-extern uint8_t Stream_Buff[24];
+extern uint8_t Stream_Buff[AUDIO_FIFO_SIZE];
 extern uint32_t MUTE_DATA;
+#if defined(USE_STM3210B_EVAL) || defined(USE_STM3210E_EVAL)
+uint16_t Audio_Out[AUDIO_DMA_SIZE];
+#endif
 
 /* Private function prototypes -----------------------------------------------*/
+static uint8_t Audio_Ready(void);
 /* Private functions ---------------------------------------------------------*/
 
 /******************************************************************************/
@@ -201,42 +205,128 @@ void USB_LP_CAN1_RX0_IRQHandler(void)
   USB_Istr();
 }
 
-#ifdef USE_STM3210B_EVAL
 /*******************************************************************************
-* Function Name  : TIM2_IRQHandler
-* Description    : This function handles TIM2 global interrupt request.
+* Function Name  : Audio_Ready
+* Description    : Tells if a sample is played now. The output waits for the
+*                  ring buffer to fill up to AUDIO_FIFO_TARGET, and stops again
+*                  when it runs empty, so that an underrun restarts with the
+*                  same latency.
 * Input          : None
 * Output         : None
-* Return         : None
+* Return         : 1 if Stream_Buff holds a sample to play, 0 otherwise.
 *******************************************************************************/
-void TIM2_IRQHandler(void)
+static uint8_t Audio_Ready(void)
 {
-  if (TIM_GetITStatus(TIM2, TIM_IT_Update) != RESET)
+  static uint8_t Playing = 0;
+  uint16_t Level = In_Data_Offset - Out_Data_Offset;
+
+  if (Level == 0)
   {
-    /* Clear TIM2 update interrupt */
-    TIM_ClearITPendingBit(TIM2, TIM_IT_Update);
+    Playing = 0;
+  }
+  else if (Level >= AUDIO_FIFO_TARGET)
+  {
+    Playing = 1;
+  }
 
-    if ((Out_Data_Offset < In_Data_Offset) && ((uint8_t)(MUTE_DATA) == 0))
+  return (Playing && ((uint8_t)(MUTE_DATA) == 0));
+}
+
+#if defined(USE_STM3210B_EVAL) || defined(USE_STM3210E_EVAL)
+/*******************************************************************************
+* Function Name  : Audio_Fill
+* Description    : Refills one half of Audio_Out, the one the DMA just left,
+*                  with AUDIO_DMA_SAMPLES samples taken out of the ring buffer.
+*                  When no sample is ready the last one is held, so an
+*                  underrun or the mute don't click. The I2S output sends each
+*                  sample twice, on the left and on the right channel.
+* Input          : Buffer: half of Audio_Out to fill.
+* Output         : None
+* Return         : None
+*******************************************************************************/
+void Audio_Fill(uint16_t *Buffer)
+{
+  static uint16_t Sample = 0x7F; /* mid scale, the duty cycle at reset */
+  uint16_t i;
+
+  for (i = 0; i < AUDIO_DMA_SAMPLES; i++)
+  {
+    if (Audio_Ready())
     {
-      TIM_SetCompare3(TIM4, Stream_Buff[Out_Data_Offset]);
+      Sample = Stream_Buff[Out_Data_Offset & (AUDIO_FIFO_SIZE - 1)];
       Out_Data_Offset++;
     }
+#ifdef USE_STM3210E_EVAL
+    *Buffer++ = Sample;
+#endif
+    *Buffer++ = Sample;
+  }
+}
+#endif /* USE_STM3210B_EVAL || USE_STM3210E_EVAL */
+
+#ifdef USE_STM3210B_EVAL
+/*******************************************************************************
+* Function Name  : DMA1_Channel2_IRQHandler
+* Description    : This function handles DMA1 Channel 2 interrupt request, the
+*                  TIM2 update DMA that writes the TIM4 compare 3 register.
+* Input          : None
+* Output         : None
+* Return         : None
+*******************************************************************************/
+void DMA1_Channel2_IRQHandler(void)
+{
+  uint32_t Status = DMA1->ISR;
+
+  if ((Status & DMA_ISR_HTIF2) != 0)
+  {
+    DMA1->IFCR = DMA_IFCR_CHTIF2;
+    Audio_Fill(&Audio_Out[0]);
+  }
+
+  if ((Status & DMA_ISR_TCIF2) != 0)
+  {
+    DMA1->IFCR = DMA_IFCR_CTCIF2;
+    Audio_Fill(&Audio_Out[AUDIO_DMA_SIZE / 2]);
   }
 }
 #endif /* USE_STM3210B_EVAL */
 
 #if defined (USE_STM3210E_EVAL)
+/*******************************************************************************
+* Function Name  : DMA1_Channel5_IRQHandler
+* Description    : This function handles DMA1 Channel 5 interrupt request, the
+*                  SPI2 TX DMA that feeds the I2S.
+* Input          : None
+* Output         : None
+* Return         : None
+*******************************************************************************/
+void DMA1_Channel5_IRQHandler(void)
+{
+  uint32_t Status = DMA1->ISR;
+
+  if ((Status & DMA_ISR_HTIF5) != 0)
+  {
+    DMA1->IFCR = DMA_IFCR_CHTIF5;
+    Audio_Fill(&Audio_Out[0]);
+  }
+
+  if ((Status & DMA_ISR_TCIF5) != 0)
+  {
+    DMA1->IFCR = DMA_IFCR_CTCIF5;
+    Audio_Fill(&Audio_Out[AUDIO_DMA_SIZE / 2]);
+  }
+}
+
 /*******************************************************************************
 * Function Name  : SPI2_IRQHandler
-* Description    : This function handles SPI2 global interrupt request.
+* Description    : This function handles SPI2 global interrupt request. It only
+*                  runs while the codec is configured, the samples go by DMA.
 * Input          : None
 * Output         : None
 * Return         : None
 *******************************************************************************/
 void SPI2_IRQHandler(void)
 {
-  static uint8_t channel = 0;
-
   if ((SPI_I2S_GetITStatus(SPI2, SPI_I2S_IT_TXE) == SET))
   {
     /* Audio codec configuration section */
@@ -245,18 +335,6 @@ void SPI2_IRQHandler(void)
       /* Send a dummy data just to generate the I2S clock */
       SPI_I2S_SendData(SPI2, DUMMYDATA);
     }
-    
-   else if ((Out_Data_Offset < In_Data_Offset) && ((uint8_t)(MUTE_DATA) == 0))
-    {
-      if ((channel++) & 1)
-      {
-        SPI_I2S_SendData(SPI2, (uint16_t)Stream_Buff[Out_Data_Offset++]);
-      }
-      else
-      {
-        SPI_I2S_SendData(SPI2, (uint16_t)Stream_Buff[Out_Data_Offset]);
-      }
-    }
   }
 }
 
@@ -276,10 +354,10 @@ void TIM6_IRQHandler(void)
     /* Clear TIM6 update interrupt */
     TIM_ClearITPendingBit(TIM6, TIM_IT_Update);
 
-    if ((Out_Data_Offset < In_Data_Offset) && ((uint8_t)(MUTE_DATA) == 0))
+    if (Audio_Ready())
     {
       /* Set DAC Channel1 DHR register */
-      DAC_SetChannel1Data(DAC_Align_8b_R, Stream_Buff[Out_Data_Offset]);      
+      DAC_SetChannel1Data(DAC_Align_8b_R, Stream_Buff[Out_Data_Offset & (AUDIO_FIFO_SIZE - 1)]);      
       Out_Data_Offset++;
     }
   }
@@ -28,15 +28,19 @@
 /* Includes ------------------------------------------------------------------*/
 #include "usb_lib.h"
 #include "usb_istr.h"
+#include "hw_config.h"
 
 /* Private typedef -----------------------------------------------------------*/
 /* Private define ------------------------------------------------------------*/
 /* Private macro -------------------------------------------------------------*/
 /* Private variables ---------------------------------------------------------*/
-uint8_t Stream_Buff[24];
+uint8_t Stream_Buff[AUDIO_FIFO_SIZE];
 uint16_t In_Data_Offset;
+int8_t Audio_Slip = 0;    /* sample to repeat (1) or drop (-1) in the next packet */
+static uint8_t Packet_Buff[0x40];
 
 /* Extern variables ----------------------------------------------------------*/
+extern uint16_t Out_Data_Offset;
 /* Private function prototypes -----------------------------------------------*/
 /* Extern function prototypes ------------------------------------------------*/
 /* Private functions ---------------------------------------------------------*/
@@ -50,21 +54,42 @@ uint16_t In_Data_Offset;
 void EP1_OUT_Callback(void)
 {
   uint16_t Data_Len;       /* data length*/
+  uint16_t Offset = In_Data_Offset;
+  uint16_t i;
   
   if (GetENDPOINT(ENDP1) & EP_DTOG_TX)
   {
     /*read from ENDP1_BUF0Addr buffer*/
     Data_Len = GetEPDblBuf0Count(ENDP1);
-    PMAToUserBufferCopy(Stream_Buff, ENDP1_BUF0Addr, Data_Len);
+    PMAToUserBufferCopy(Packet_Buff, ENDP1_BUF0Addr, Data_Len);
   }
   else
   {
     /*read from ENDP1_BUF1Addr buffer*/
     Data_Len = GetEPDblBuf1Count(ENDP1);
-    PMAToUserBufferCopy(Stream_Buff, ENDP1_BUF1Addr, Data_Len);
+    PMAToUserBufferCopy(Packet_Buff, ENDP1_BUF1Addr, Data_Len);
   }
   FreeUserBuffer(ENDP1, EP_DBUF_OUT);
-  In_Data_Offset += Data_Len;
+
+  /* Repeat or drop the last sample when asked by Audio_Trim() */
+  if ((Audio_Slip < 0) && (Data_Len > 1))
+  {
+    Data_Len--;
+  }
+  else if ((Audio_Slip > 0) && (Data_Len != 0) && (Data_Len < sizeof(Packet_Buff)))
+  {
+    Packet_Buff[Data_Len] = Packet_Buff[Data_Len - 1];
+    Data_Len++;
+  }
+  Audio_Slip = 0;
+
+  /* Append the packet to the ring buffer, what does not fit is lost */
+  for (i = 0; (i < Data_Len) && ((uint16_t)(Offset - Out_Data_Offset) < AUDIO_FIFO_SIZE); i++)
+  {
+    Stream_Buff[Offset & (AUDIO_FIFO_SIZE - 1)] = Packet_Buff[i];
+    Offset++;
+  }
+  In_Data_Offset = Offset;
 }
 
 /************************ (C) COPYRIGHT STMicroelectronics *****END OF FILE****/
@@ -31,6 +31,7 @@
 #include "usb_prop.h"
 #include "usb_pwr.h"
 #include "usb_istr.h"
+#include "hw_config.h"
 
 /* Private typedef -----------------------------------------------------------*/
 /* Private define ------------------------------------------------------------*/
@@ -240,8 +241,7 @@ void USB_Istr(void)
 *******************************************************************************/
 void SOF_Callback(void)
 {
-  In_Data_Offset = 0;
-  Out_Data_Offset = 0;
+  Audio_Trim(In_Data_Offset - Out_Data_Offset);
 }
 
 /************************ (C) COPYRIGHT STMicroelectronics *****END OF FILE****/
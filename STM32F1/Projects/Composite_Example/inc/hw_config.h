@@ -52,6 +52,7 @@ void ADC30x_Configuration(void);
 void Get_SerialNum(void);
 void TimingDelay_Decrement(void);
 void Delay(__IO uint32_t nCount);
+void Endpoint_Service(void);
 
 #endif  /*__HW_CONFIG_H*/
 
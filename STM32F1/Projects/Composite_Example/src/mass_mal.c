@@ -38,6 +38,11 @@ uint32_t Mass_Memory_Size[2];
 uint32_t Mass_Block_Size[2];
 uint32_t Mass_Block_Count[2];
 __IO uint32_t Status = 0;
+/* Result of MAL_ReadStart, and a SDIO read in progress */
+static uint16_t Read_Status = MAL_OK;
+#if defined(USE_STM3210E_EVAL) || defined(USE_STM32L152D_EVAL)
+static uint8_t Read_Pending = 0;
+#endif
 
 #if defined(USE_STM3210E_EVAL) || defined(USE_STM32L152D_EVAL)
 SD_CardInfo mSDCardInfo;
@@ -144,6 +149,58 @@ uint16_t MAL_Read(uint8_t lun, uint32_t Memory_Offset, uint32_t *Readbuff, uint1
   return MAL_OK;
 }
 
+/*******************************************************************************
+* Function Name  : MAL_ReadStart
+* Description    : Start reading sectors, MAL_ReadWait() waits for the end of
+*                  the read. The SDIO cards are read by DMA meanwhile, the
+*                  other media are read before returning.
+* Input          : None
+* Output         : None
+* Return         : None
+*******************************************************************************/
+void MAL_ReadStart(uint8_t lun, uint32_t Memory_Offset, uint32_t *Readbuff, uint16_t Transfer_Length)
+{
+#if defined(USE_STM3210E_EVAL) || defined(USE_STM32L152D_EVAL)
+  if (lun == 0)
+  {
+    Status = SD_ReadMultiBlocks((uint8_t*)Readbuff, Memory_Offset, Transfer_Length, 1);
+    Read_Status = (Status == SD_OK) ? MAL_OK : MAL_FAIL;
+    Read_Pending = (Status == SD_OK);
+    return;
+  }
+#endif /* USE_STM3210E_EVAL || USE_STM32L152D_EVAL */
+  Read_Status = MAL_Read(lun, Memory_Offset, Readbuff, Transfer_Length);
+}
+
+/*******************************************************************************
+* Function Name  : MAL_ReadWait
+* Description    : Wait for the end of the read started by MAL_ReadStart()
+* Input          : None
+* Output         : None
+* Return         : MAL_OK or MAL_FAIL
+*******************************************************************************/
+uint16_t MAL_ReadWait(uint8_t lun)
+{
+  (void) lun;
+
+#if defined(USE_STM3210E_EVAL) || defined(USE_STM32L152D_EVAL)
+  if (Read_Pending)
+  {
+    Read_Pending = 0;
+    Status = SD_WaitReadOperation();
+    while(SD_GetStatus() != SD_TRANSFER_OK)
+    {
+    }
+
+    if ( Status != SD_OK )
+    {
+      Read_Status = MAL_FAIL;
+    }
+  }
+#endif /* USE_STM3210E_EVAL || USE_STM32L152D_EVAL */
+  return Read_Status;
+}
+
 /*******************************************************************************
 * Function Name  : MAL_GetStatus
 * Description    : Get status
@@ -47,7 +47,10 @@ __IO uint32_t Block_Read_count = 0;
 __IO uint32_t Block_offset;
 __IO uint32_t Counter = 0;
 uint32_t  Idx;
-uint32_t Data_Buffer[64 *2]; /* 512 bytes*/
+uint32_t Data_Buffer[2][64 *2]; /* 2 x 512 bytes*/
+/* Block being sent from Data_Buffer, the other one is read meanwhile */
+static uint8_t Read_Index = 0;
+static uint8_t Read_Ahead = 0;
 uint8_t TransferState = TXFR_IDLE;
 /* Extern variables ----------------------------------------------------------*/
 extern uint8_t Bulk_Data_Buff[64];  /* data buffer*/
@@ -78,25 +81,53 @@ void Read_Memory(uint8_t lun, uint32_t Memory_Offset, uint32_t Transfer_Length)
     Offset = Memory_Offset * Mass_Block_Size[lun];
     Length = Transfer_Length * Mass_Block_Size[lun];
     TransferState = TXFR_ONGOING;
+
+    /* Drop a block read ahead for a transfer that was aborted */
+    if (Read_Ahead)
+    {
+      MAL_ReadWait(lun);
+      Read_Ahead = 0;
+    }
+    Read_Index = 0;
   }
 
   if (TransferState == TXFR_ONGOING )
   {
     if (!Block_Read_count)
     {
-      MAL_Read(lun ,
-               Offset ,
-               Data_Buffer,
-               Mass_Block_Size[lun]);
-
-      USB_SIL_Write(EP2_IN, (uint8_t *)Data_Buffer, BULK_MAX_PACKET_SIZE);
+      if (Read_Ahead)
+      {
+        /* The block was read in the other buffer while the last one was sent */
+        MAL_ReadWait(lun);
+        Read_Ahead = 0;
+        Read_Index ^= 1;
+      }
+      else
+      {
+        MAL_Read(lun ,
+                 Offset ,
+                 Data_Buffer[Read_Index],
+                 Mass_Block_Size[lun]);
+      }
+
+      /* Start reading the next block, it goes on while this one is sent */
+      if (Length > Mass_Block_Size[lun])
+      {
+        MAL_ReadStart(lun ,
+                      Offset + Mass_Block_Size[lun] ,
+                      Data_Buffer[Read_Index ^ 1],
+                      Mass_Block_Size[lun]);
+        Read_Ahead = 1;
+      }
+
+      USB_SIL_Write(EP2_IN, (uint8_t *)Data_Buffer[Read_Index], BULK_MAX_PACKET_SIZE);
 
       Block_Read_count = Mass_Block_Size[lun] - BULK_MAX_PACKET_SIZE;
       Block_offset = BULK_MAX_PACKET_SIZE;
     }
     else
     {
-      USB_SIL_Write(EP2_IN, (uint8_t *)Data_Buffer + Block_offset, BULK_MAX_PACKET_SIZE);
+      USB_SIL_Write(EP2_IN, (uint8_t *)Data_Buffer[Read_Index] + Block_offset, BULK_MAX_PACKET_SIZE);
 
       Block_Read_count -= BULK_MAX_PACKET_SIZE;
       Block_offset += BULK_MAX_PACKET_SIZE;
@@ -114,6 +145,7 @@ void Read_Memory(uint8_t lun, uint32_t Memory_Offset, uint32_t Transfer_Length)
     Block_Read_count = 0;
     Block_offset = 0;
     Offset = 0;
+    Read_Index = 0;
     Bot_State = BOT_DATA_IN_LAST;
     TransferState = TXFR_IDLE;
   }
@@ -145,7 +177,7 @@ void Write_Memory (uint8_t lun, uint32_t Memory_Offset, uint32_t Transfer_Length
 
     for (Idx = 0 ; Counter < temp; Counter++)
     {
-      *((uint8_t *)Data_Buffer + Counter) = Bulk_Data_Buff[Idx++];
+      *((uint8_t *)Data_Buffer[0] + Counter) = Bulk_Data_Buff[Idx++];
     }
 
     W_Offset += Data_Len;
@@ -156,7 +188,7 @@ void Write_Memory (uint8_t lun, uint32_t Memory_Offset, uint32_t Transfer_Length
       Counter = 0;
       MAL_Write(lun ,
                 W_Offset - Mass_Block_Size[lun],
-                Data_Buffer,
+                Data_Buffer[0],
                 Mass_Block_Size[lun]);
     }
 
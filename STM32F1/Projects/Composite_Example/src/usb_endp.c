@@ -35,10 +35,17 @@
 
 /* Private typedef -----------------------------------------------------------*/
 /* Private define ------------------------------------------------------------*/
+/* Mass Storage events served back to back by Endpoint_Service(), 8 packets
+   are one 512 bytes block */
+#define MSC_SERVICE_BUDGET  8
+
 /* Private macro -------------------------------------------------------------*/
 /* Private variables ---------------------------------------------------------*/
 uint8_t Receive_Buffer[2];
 extern __IO uint8_t PrevXferComplete;
+/* Mass Storage transfers left to Endpoint_Service() by the USB interrupt */
+__IO uint8_t MSC_In_Pending = 0;
+__IO uint8_t MSC_Out_Pending = 0;
 
 /* Private function prototypes -----------------------------------------------*/
 /* Private functions ---------------------------------------------------------*/
@@ -141,7 +148,7 @@ void EP1_IN_Callback(void)
 *******************************************************************************/
 void EP2_IN_Callback(void)
 {
-  Mass_Storage_In();
+  MSC_In_Pending = 1;
 }
 
 /*******************************************************************************
@@ -153,7 +160,44 @@ void EP2_IN_Callback(void)
 *******************************************************************************/
 void EP2_OUT_Callback(void)
 {
-  Mass_Storage_Out();
+  MSC_Out_Pending = 1;
+}
+
+/*******************************************************************************
+* Function Name  : Endpoint_Service
+* Description    : Serves the Mass Storage transfers out of the USB interrupt,
+*                  called from the main loop. The HID endpoint stays served in
+*                  the USB interrupt, which preempts the media reads and
+*                  writes: a report never waits for a block. The Mass Storage
+*                  events are served up to MSC_SERVICE_BUDGET at a time. The
+*                  endpoint NAKs meanwhile, so a direction has no new event
+*                  until it is served.
+* Input          : None.
+* Output         : None.
+* Return         : None.
+*******************************************************************************/
+void Endpoint_Service(void)
+{
+  uint8_t Budget = MSC_SERVICE_BUDGET;
+
+  while (Budget != 0)
+  {
+    if (MSC_In_Pending)
+    {
+      MSC_In_Pending = 0;
+      Mass_Storage_In();
+    }
+    else if (MSC_Out_Pending)
+    {
+      MSC_Out_Pending = 0;
+      Mass_Storage_Out();
+    }
+    else
+    {
+      break;
+    }
+    Budget--;
+  }
 }
 /************************ (C) COPYRIGHT STMicroelectronics *****END OF FILE****/
 
@@ -126,6 +126,8 @@ uint8_t *CustomHID_SetReport_Feature(uint16_t Length);
 
 extern unsigned char Bot_State;
 extern Bulk_Only_CBW CBW;
+extern __IO uint8_t MSC_In_Pending;
+extern __IO uint8_t MSC_Out_Pending;
 uint32_t Max_Lun = 0; 
 
 
@@ -208,8 +210,8 @@ void CustomHID_Reset(void)
   SetEPTxStatus(ENDP1, EP_TX_NAK);
   /* Initialize Endpoint 2 IN */
   SetEPType(ENDP2, EP_BULK);
-  SetEPTxCount(ENDP1, 64);
-  SetEPTxAddr(ENDP2, ENDP1_TXADDR);
+  SetEPTxCount(ENDP2, 64);
+  SetEPTxAddr(ENDP2, ENDP2_TXADDR);
   SetEPTxStatus(ENDP2, EP_TX_NAK);
   
 
@@ -223,6 +225,8 @@ void CustomHID_Reset(void)
   SetDeviceAddress(0);
   CBW.dSignature = BOT_CBW_SIGNATURE;
   Bot_State = BOT_IDLE;
+  MSC_In_Pending = 0;
+  MSC_Out_Pending = 0;
   bDeviceState = ATTACHED;
 }
 /*******************************************************************************
@@ -47,7 +47,7 @@
 
 #define CUSTOMHID_SIZ_DEVICE_DESC               18
 #define CUSTOMHID_SIZ_CONFIG_DESC               41
-#define CUSTOMHID_SIZ_REPORT_DESC               163
+#define CUSTOMHID_SIZ_REPORT_DESC               190
 #define CUSTOMHID_SIZ_STRING_LANGID             4
 #define CUSTOMHID_SIZ_STRING_VENDOR             38
 #define CUSTOMHID_SIZ_STRING_PRODUCT            32
@@ -55,6 +55,16 @@
 
 #define STANDARD_ENDPOINT_DESC_SIZE             0x09
 
+/* Size of the EP1 packets and of the batch and ADC stream reports, report ID
+   included, up to 64 bytes */
+#define CUSTOMHID_REPORT_SIZE                   64
+/* ADC samples of 16 bits carried by an ADC stream report */
+#define CUSTOMHID_ADC_SAMPLES                   ((CUSTOMHID_REPORT_SIZE - 2) / 2)
+
+#if (CUSTOMHID_REPORT_SIZE < 4) || (CUSTOMHID_REPORT_SIZE > 64)
+ #error "CUSTOMHID_REPORT_SIZE must be from 4 to 64 bytes"
+#endif
+
 /* Exported functions ------------------------------------------------------- */
 extern const uint8_t CustomHID_DeviceDescriptor[CUSTOMHID_SIZ_DEVICE_DESC];
 extern const uint8_t CustomHID_ConfigDescriptor[CUSTOMHID_SIZ_CONFIG_DESC];
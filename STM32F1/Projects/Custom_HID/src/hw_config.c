@@ -40,6 +40,9 @@
 ErrorStatus HSEStartUpStatus;
 uint32_t ADC_ConvertedValueX = 0;
 uint32_t ADC_ConvertedValueX_1 = 0;
+/* Filled by the DMA, each half is sent as it is in an ADC stream report */
+uint16_t ADC_Stream_Buffer[2 * CUSTOMHID_ADC_SAMPLES];
+__IO uint8_t ADC_Stream = 0; /* ADC stream reports enabled by the host */
 __IO uint16_t  ADC1ConvertedValue = 0, ADC1ConvertedVoltage = 0, calibration_value = 0;
 
 /* Extern variables ----------------------------------------------------------*/
@@ -442,11 +445,11 @@ void ADC_Configuration(void)
   /* DMA1 channel1 configuration ---------------------------------------------*/
   DMA_DeInit(DMA1_Channel1);
   DMA_InitStructure.DMA_PeripheralBaseAddr = ADC1_DR_Address;
-  DMA_InitStructure.DMA_MemoryBaseAddr = (uint32_t)&ADC_ConvertedValueX;
+  DMA_InitStructure.DMA_MemoryBaseAddr = (uint32_t)ADC_Stream_Buffer;
   DMA_InitStructure.DMA_DIR = DMA_DIR_PeripheralSRC;
-  DMA_InitStructure.DMA_BufferSize = 1;
+  DMA_InitStructure.DMA_BufferSize = 2 * CUSTOMHID_ADC_SAMPLES;
   DMA_InitStructure.DMA_PeripheralInc = DMA_PeripheralInc_Disable;
-  DMA_InitStructure.DMA_MemoryInc = DMA_MemoryInc_Disable;
+  DMA_InitStructure.DMA_MemoryInc = DMA_MemoryInc_Enable;
   DMA_InitStructure.DMA_PeripheralDataSize = DMA_PeripheralDataSize_HalfWord;
   DMA_InitStructure.DMA_MemoryDataSize = DMA_MemoryDataSize_HalfWord;
   DMA_InitStructure.DMA_Mode = DMA_Mode_Circular;
@@ -457,8 +460,8 @@ void ADC_Configuration(void)
   /* Enable DMA1 channel1 */
   DMA_Cmd(DMA1_Channel1, ENABLE);
   
-  /* Enable the DMA1 Channel1 Transfer complete interrupt */
-  DMA_ITConfig(DMA1_Channel1, DMA_IT_TC, ENABLE);
+  /* Enable the DMA1 Channel1 Half and Transfer complete interrupts */
+  DMA_ITConfig(DMA1_Channel1, DMA_IT_HT | DMA_IT_TC, ENABLE);
   
 #if defined(STM32L1XX_MD) || defined(STM32L1XX_HD)|| defined(STM32L1XX_MD_PLUS)
   /* Enable the HSI for the ADC operations */
@@ -598,13 +601,13 @@ void ADC30x_Configuration(void)
   /* DMA1 channel1 configuration ---------------------------------------------*/
   DMA_DeInit(DMA1_Channel1);
   DMA_InitStructure.DMA_PeripheralBaseAddr = ADC1_DR_Address;
-  DMA_InitStructure.DMA_MemoryBaseAddr = (uint32_t)&ADC_ConvertedValueX;
+  DMA_InitStructure.DMA_MemoryBaseAddr = (uint32_t)ADC_Stream_Buffer;
   DMA_InitStructure.DMA_DIR = DMA_DIR_PeripheralSRC;
-  DMA_InitStructure.DMA_BufferSize = 1;
+  DMA_InitStructure.DMA_BufferSize = 2 * CUSTOMHID_ADC_SAMPLES;
   DMA_InitStructure.DMA_PeripheralInc = DMA_PeripheralInc_Disable;
-  DMA_InitStructure.DMA_MemoryInc = DMA_MemoryInc_Disable;
-  DMA_InitStructure.DMA_PeripheralDataSize = DMA_PeripheralDataSize_Word;
-  DMA_InitStructure.DMA_MemoryDataSize = DMA_MemoryDataSize_Word;
+  DMA_InitStructure.DMA_MemoryInc = DMA_MemoryInc_Enable;
+  DMA_InitStructure.DMA_PeripheralDataSize = DMA_PeripheralDataSize_HalfWord;
+  DMA_InitStructure.DMA_MemoryDataSize = DMA_MemoryDataSize_HalfWord;
   DMA_InitStructure.DMA_Mode = DMA_Mode_Circular;
   DMA_InitStructure.DMA_Priority = DMA_Priority_Medium;
   DMA_InitStructure.DMA_M2M = DMA_M2M_Disable;
@@ -613,8 +616,8 @@ void ADC30x_Configuration(void)
   /* Enable DMA1 channel1 */
   DMA_Cmd(DMA1_Channel1, ENABLE);
   
-  /* Enable the DMA1 Channel1 Transfer complete interrupt */
-  DMA_ITConfig(DMA1_Channel1, DMA_IT_TC, ENABLE);
+  /* Enable the DMA1 Channel1 Half and Transfer complete interrupts */
+  DMA_ITConfig(DMA1_Channel1, DMA_IT_HT | DMA_IT_TC, ENABLE);
   
   /* Configure the ADC clock */  
   RCC_ADCCLKConfig(RCC_ADC12PLLCLK_Div2);
@@ -35,6 +35,7 @@
 #include "usb_lib.h"
 #include "usb_pwr.h"
 #include "hw_config.h"
+#include "usb_desc.h"
 
 /* Private typedef -----------------------------------------------------------*/
 /* Private define ------------------------------------------------------------*/
@@ -44,6 +45,8 @@ __IO uint8_t Send_Buffer[2];
 extern __IO uint8_t PrevXferComplete;
 extern uint32_t ADC_ConvertedValueX;
 extern uint32_t ADC_ConvertedValueX_1;
+extern uint16_t ADC_Stream_Buffer[2 * CUSTOMHID_ADC_SAMPLES];
+extern __IO uint8_t ADC_Stream;
 extern __IO uint32_t TimingDelay;
 
 /* Private function prototypes -----------------------------------------------*/
@@ -257,30 +260,61 @@ void EXTI15_10_IRQHandler(void)
 #endif
 /*******************************************************************************
 * Function Name  : DMA1_Channel1_IRQHandler
-* Description    : This function handles DMA1 Channel 1 interrupt request.
+* Description    : This function handles DMA1 Channel 1 interrupt request,
+*                  when a half of ADC_Stream_Buffer is filled. The half is sent
+*                  from where it is as an ADC stream report (ID 9, sequence
+*                  number, CUSTOMHID_ADC_SAMPLES samples) while the host asks
+*                  for the stream, or else its last sample as the ADC report.
 * Input          : None
 * Output         : None
 * Return         : None
 *******************************************************************************/
 void DMA1_Channel1_IRQHandler(void)
 {  
-  Send_Buffer[0] = 0x07;
-  
-  if((ADC_ConvertedValueX >>4) - (ADC_ConvertedValueX_1 >>4) > 4)
+  static uint8_t Sequence = 0;
+  uint16_t *Samples;
+  USB_SIL_Packet Packet;
+
+  if (DMA_GetITStatus(DMA1_IT_TC1) != RESET)
   {
-    if ((PrevXferComplete) && (bDeviceState == CONFIGURED))
+    Samples = &ADC_Stream_Buffer[CUSTOMHID_ADC_SAMPLES];
+  }
+  else
+  {
+    Samples = ADC_Stream_Buffer;
+  }
+  DMA_ClearITPendingBit(DMA1_IT_GL1);
+
+  /* The host sees the halves that could not be sent as sequence gaps */
+  Sequence++;
+  ADC_ConvertedValueX = Samples[CUSTOMHID_ADC_SAMPLES - 1];
+
+  if ((PrevXferComplete) && (bDeviceState == CONFIGURED))
+  {
+    if (ADC_Stream != 0)
     {
-      Send_Buffer[1] = (uint8_t)(ADC_ConvertedValueX >>4);
-      
-      /* Write the descriptor through the endpoint */
-      USB_SIL_Write(EP1_IN, (uint8_t*) Send_Buffer, 2);  
+      /* Write the report header in place, then the samples, through the
+         endpoint */
+      USB_SIL_Reserve(&Packet, EP1_IN);
+      USB_SIL_Put8(&Packet, 0x09);
+      USB_SIL_Put8(&Packet, Sequence);
+      UserToPMABufferCopy((uint8_t*) Samples, ENDP1_TXADDR + 2, 2 * CUSTOMHID_ADC_SAMPLES);
+      SetEPTxCount(ENDP1, 2 + 2 * CUSTOMHID_ADC_SAMPLES);
+      SetEPTxValid(ENDP1);
+      PrevXferComplete = 0;
+    }
+    else if((ADC_ConvertedValueX >>4) - (ADC_ConvertedValueX_1 >>4) > 4)
+    {
+      /* Write the report in place through the endpoint */
+      USB_SIL_Reserve(&Packet, EP1_IN);
+      USB_SIL_Put8(&Packet, 0x07);
+      USB_SIL_Put8(&Packet, (uint8_t)(ADC_ConvertedValueX >>4));
+      USB_SIL_Commit(&Packet);
       SetEPTxValid(ENDP1);
       ADC_ConvertedValueX_1 = ADC_ConvertedValueX;
       PrevXferComplete = 0;
     }
   }
-  
-  DMA_ClearFlag(DMA1_FLAG_TC1);
 }
 
 /*******************************************************************************
@@ -111,9 +111,9 @@ const uint8_t CustomHID_ConfigDescriptor[CUSTOMHID_SIZ_CONFIG_DESC] =
 
     0x81,          /* bEndpointAddress: Endpoint Address (IN) */
     0x03,          /* bmAttributes: Interrupt endpoint */
-    0x02,          /* wMaxPacketSize: 2 Bytes max */
+    CUSTOMHID_REPORT_SIZE, /* wMaxPacketSize: CUSTOMHID_REPORT_SIZE Bytes max */
     0x00,
-    0x20,          /* bInterval: Polling Interval (32 ms) */
+    0x01,          /* bInterval: Polling Interval (1 ms) */
     /* 34 */
     	
     0x07,	/* bLength: Endpoint Descriptor size */
@@ -122,9 +122,9 @@ const uint8_t CustomHID_ConfigDescriptor[CUSTOMHID_SIZ_CONFIG_DESC] =
     0x01,	/* bEndpointAddress: */
 			/*	Endpoint Address (OUT) */
     0x03,	/* bmAttributes: Interrupt endpoint */
-    0x02,	/* wMaxPacketSize: 2 Bytes max  */
+    CUSTOMHID_REPORT_SIZE, /* wMaxPacketSize: CUSTOMHID_REPORT_SIZE Bytes max */
     0x00,
-    0x20,	/* bInterval: Polling Interval (20 ms) */
+    0x01,	/* bInterval: Polling Interval (1 ms) */
     /* 41 */
   }
   ; /* CustomHID_ConfigDescriptor */
@@ -243,6 +243,25 @@ const uint8_t CustomHID_ReportDescriptor[CUSTOMHID_SIZ_REPORT_DESC] =
     0xb1, 0x82,            /*     FEATURE (Data,Var,Abs,Vol) */                                 
     /* 161 */
 
+    /* Batch of 2 bytes OUT reports */
+    0x85, 0x08,            /*     REPORT_ID (8)              */
+    0x09, 0x08,            /*     USAGE (Batch)              */
+    0x15, 0x00,            /*     LOGICAL_MINIMUM (0)        */
+    0x26, 0xff, 0x00,      /*     LOGICAL_MAXIMUM (255)      */
+    0x75, 0x08,            /*     REPORT_SIZE (8)            */
+    0x95, CUSTOMHID_REPORT_SIZE - 1, /* REPORT_COUNT         */
+    0x91, 0x82,            /*     OUTPUT (Data,Var,Abs,Vol)  */
+    /* 176 */
+
+    /* ADC stream */
+    0x85, 0x09,            /*     REPORT_ID (9)              */
+    0x09, 0x09,            /*     USAGE (ADC stream)         */
+    0x81, 0x82,            /*     INPUT (Data,Var,Abs,Vol)   */
+    0x95, 0x01,            /*     REPORT_COUNT (1)           */
+    0x09, 0x09,            /*     USAGE (ADC stream)         */
+    0x91, 0x82,            /*     OUTPUT (Data,Var,Abs,Vol)  */
+    /* 188 */
+
     0xc0 	          /*     END_COLLECTION	             */
   }; /* CustomHID_ReportDescriptor */
 
@@ -31,30 +31,31 @@
 #include "hw_config.h"
 #include "usb_lib.h"
 #include "usb_istr.h"
+#include "usb_desc.h"
 
 /* Private typedef -----------------------------------------------------------*/
 /* Private define ------------------------------------------------------------*/
 /* Private macro -------------------------------------------------------------*/
 /* Private variables ---------------------------------------------------------*/
-uint8_t Receive_Buffer[2];
+uint8_t Receive_Buffer[CUSTOMHID_REPORT_SIZE];
 extern __IO uint8_t PrevXferComplete;
+extern __IO uint8_t ADC_Stream;
 /* Private function prototypes -----------------------------------------------*/
+static void CustomHID_Command(uint8_t Report_ID, uint8_t Value);
 /* Private functions ---------------------------------------------------------*/
 /*******************************************************************************
-* Function Name  : EP1_OUT_Callback.
-* Description    : EP1 OUT Callback Routine.
-* Input          : None.
+* Function Name  : CustomHID_Command.
+* Description    : Executes a 2 bytes OUT report.
+* Input          : Report_ID: report ID, the LED 1 to 4 or the ADC stream.
+*                  Value: new state, 0 for off.
 * Output         : None.
 * Return         : None.
 *******************************************************************************/
-void EP1_OUT_Callback(void)
+static void CustomHID_Command(uint8_t Report_ID, uint8_t Value)
 {
   BitAction Led_State;
 
-  /* Read received data (2 bytes) */  
-  USB_SIL_Read(EP1_OUT, Receive_Buffer);
-  
-  if (Receive_Buffer[1] == 0)
+  if (Value == 0)
   {
     Led_State = Bit_RESET;
   }
@@ -64,7 +65,7 @@ void EP1_OUT_Callback(void)
   }
  
  
-  switch (Receive_Buffer[0])
+  switch (Report_ID)
   {
     case 1: /* Led 1 */
      if (Led_State != Bit_RESET)
@@ -106,6 +107,9 @@ void EP1_OUT_Callback(void)
        STM_EVAL_LEDOff(LED4);
      }
       break;
+    case 9: /* ADC stream */
+     ADC_Stream = (Led_State != Bit_RESET);
+     break;
   default:
     STM_EVAL_LEDOff(LED1);
     STM_EVAL_LEDOff(LED2);
@@ -113,6 +117,36 @@ void EP1_OUT_Callback(void)
     STM_EVAL_LEDOff(LED4); 
     break;
   }
+}
+
+/*******************************************************************************
+* Function Name  : EP1_OUT_Callback.
+* Description    : EP1 OUT Callback Routine. A batch report (ID 8) carries up
+*                  to (CUSTOMHID_REPORT_SIZE - 1) / 2 reports of 2 bytes, report
+*                  ID and value, ended by a report ID 0 or by the packet end.
+* Input          : None.
+* Output         : None.
+* Return         : None.
+*******************************************************************************/
+void EP1_OUT_Callback(void)
+{
+  uint32_t Data_Len;
+  uint32_t i;
+
+  /* Read received data (up to CUSTOMHID_REPORT_SIZE bytes) */  
+  Data_Len = USB_SIL_Read(EP1_OUT, Receive_Buffer);
+  
+  if (Receive_Buffer[0] == 8)
+  {
+    for (i = 1; (i + 1 < Data_Len) && (Receive_Buffer[i] != 0); i += 2)
+    {
+      CustomHID_Command(Receive_Buffer[i], Receive_Buffer[i + 1]);
+    }
+  }
+  else
+  {
+    CustomHID_Command(Receive_Buffer[0], Receive_Buffer[1]);
+  }
  
   SetEPRxStatus(ENDP1, EP_RX_VALID);
  
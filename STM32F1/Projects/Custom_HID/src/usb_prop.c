@@ -44,6 +44,7 @@ uint32_t ProtocolValue;
 __IO uint8_t EXTI_Enable;
 __IO uint8_t Request = 0;
 uint8_t Report_Buf[2];   
+extern __IO uint8_t ADC_Stream;
 /* -------------------------------------------------------------------------- */
 /*  Structures initializations */
 /* -------------------------------------------------------------------------- */
@@ -178,10 +179,13 @@ void CustomHID_Reset(void)
   SetEPTxAddr(ENDP1, ENDP1_TXADDR);
   SetEPRxAddr(ENDP1, ENDP1_RXADDR);
   SetEPTxCount(ENDP1, 2);
-  SetEPRxCount(ENDP1, 2);
+  SetEPRxCount(ENDP1, CUSTOMHID_REPORT_SIZE);
   SetEPRxStatus(ENDP1, EP_RX_VALID);
   SetEPTxStatus(ENDP1, EP_TX_NAK);
 
+  /* The host starts the ADC stream again after a reset */
+  ADC_Stream = 0;
+
   /* Set this device to response on default address */
   SetDeviceAddress(0);
   bDeviceState = ATTACHED;
@@ -45,11 +45,17 @@
 #define INTERNAL_FLASH_BASE 0x08000000
 #define SPI_FLASH_BASE      0x00000000
 #define NOR_FLASH_BASE      0x64000000
+#define PATCH_BASE          0x0C000000
 
 #define NOR_M29W128F        0x2212
 #define NOR_M29W128G        0x2221
 #define NOR_S29GL128        0x2221
 
+/* Operations run by MAL_Process() */
+#define MAL_OP_NONE         0
+#define MAL_OP_ERASE        1
+#define MAL_OP_WRITE        2
+
 /* utils macro ---------------------------------------------------------------*/
 #define _1st_BYTE(x)  (uint8_t)((x)&0xFF)             /* 1st addressing cycle */
 #define _2nd_BYTE(x)  (uint8_t)(((x)&0xFF00)>>8)      /* 2nd addressing cycle */
@@ -67,8 +73,12 @@ uint16_t MAL_Erase (uint32_t SectorAddress);
 uint16_t MAL_Write (uint32_t SectorAddress, uint32_t DataLength);
 uint8_t  *MAL_Read (uint32_t SectorAddress, uint32_t DataLength);
 uint16_t MAL_GetStatus(uint32_t SectorAddress ,uint8_t Cmd, uint8_t *buffer);
+uint16_t MAL_Start(uint8_t Op, uint32_t SectorAddress, uint32_t DataLength);
+uint8_t  MAL_Busy(void);
+void     MAL_Process(void);
 
-extern uint8_t  MAL_Buffer[wTransferSize]; /* RAM Buffer for Downloaded Data */
+extern uint8_t  *MAL_Buffer;      /* RAM Buffer for Downloaded Data */
+extern uint8_t  *MAL_Prog_Buffer; /* RAM Buffer being written by MAL_Write */
 #endif /* __DFU_MAL_H */
 
 /************************ (C) COPYRIGHT STMicroelectronics *****END OF FILE****/
@@ -0,0 +1,80 @@
+/**
+  ******************************************************************************
+  * @file    patch_if.h
+  * @author  MCD Application Team
+  * @version V4.0.0
+  * @date    21-January-2013
+  * @brief   Header for patch_if.c file.
+  ******************************************************************************
+  * @attention
+  *
+  * <h2><center>&copy; COPYRIGHT 2013 STMicroelectronics</center></h2>
+  *
+  * Licensed under MCD-ST Liberty SW License Agreement V2, (the "License");
+  * You may not use this file except in compliance with the License.
+  * You may obtain a copy of the License at:
+  *
+  *        http://www.st.com/software_license_agreement_liberty_v2
+  *
+  * Unless required by applicable law or agreed to in writing, software 
+  * distributed under the License is distributed on an "AS IS" BASIS, 
+  * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  * See the License for the specific language governing permissions and
+  * limitations under the License.
+  *
+  ******************************************************************************
+  */
+
+
+/* Define to prevent recursive inclusion -------------------------------------*/
+#ifndef __PATCH_IF_MAL_H
+#define __PATCH_IF_MAL_H
+
+/* Includes ------------------------------------------------------------------*/
+#include "stm32f10x.h"
+/* Exported types ------------------------------------------------------------*/
+/* Exported constants --------------------------------------------------------*/
+/* A patch downloaded at PATCH_BASE rewrites the internal Flash page by page,
+   in a RAM window of PATCH_PAGE_SIZE bytes. A page that comes out the same is
+   neither erased nor written. The stream is:
+     - "DPT1" and the address the patch applies to (32 bits, little endian),
+       page aligned and from ApplicationAddress on,
+     - records, starting at the first page of that address:
+         PATCH_OP_KEEP, page count (16 bits): the pages stay as they are,
+         PATCH_OP_PAGE, tokens: the next page is rebuilt from the tokens,
+         PATCH_OP_CHECK, CRC (32 bits): the CRC of CRCDevice.h of the image
+                         from the patch address to the next page is checked,
+                         the patch fails if it doesn't match,
+         PATCH_OP_END: the end of the patch.
+   The tokens rebuild one page, the last one ends with its last byte:
+     0LLLLLLL, L + 1 bytes: L + 1 literal bytes,
+     10LLLLLL, offset (24 bits): L + 1 bytes of the current image at this
+               offset from the patch address, in a page not rewritten yet,
+     11LLLLLL, distance (16 bits): L + 1 bytes of the page being rebuilt, from
+               distance bytes back (they may overlap the bytes copied).
+   A patch cut by a power loss leaves a mix of the two images, a full image
+   must then be downloaded. */
+#define PATCH_OP_END        0x00
+#define PATCH_OP_KEEP       0x01
+#define PATCH_OP_PAGE       0x02
+#define PATCH_OP_CHECK      0x03
+
+#ifdef USE_STM3210B_EVAL
+ #define PATCH_PAGE_SIZE    0x400
+#else
+ #define PATCH_PAGE_SIZE    0x800
+#endif /* USE_STM3210B_EVAL */
+
+/* Flash size register, in Kbytes */
+#define PATCH_FLASH_SIZE    ((uint32_t)(*(__IO uint16_t *)0x1FFFF7E0) << 10)
+
+/* Exported macro ------------------------------------------------------------*/
+/* Exported functions ------------------------------------------------------- */
+
+uint16_t PATCH_If_Init(void);
+uint16_t PATCH_If_Erase(uint32_t SectorAddress);
+uint16_t PATCH_If_Write(uint32_t SectorAddress, uint32_t DataLength);
+
+#endif /* __PATCH_IF_MAL_H */
+
+/************************ (C) COPYRIGHT STMicroelectronics *****END OF FILE****/
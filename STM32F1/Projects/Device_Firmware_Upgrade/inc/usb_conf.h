@@ -65,6 +65,11 @@
 #define S29GL128_SECTOR_ERASE_TIME      1000
 #define S29GL128_SECTOR_WRITE_TIME      45
 
+/* A patch block of 1024 bytes may rebuild several pages of the internal
+   Flash, the host polls again when it is not done */
+#define PATCH_SECTOR_ERASE_TIME         1
+#define PATCH_SECTOR_WRITE_TIME         (2 * (INTERN_FLASH_SECTOR_ERASE_TIME + INTERN_FLASH_SECTOR_WRITE_TIME))
+
 /* Exported macro ------------------------------------------------------------*/
 /* Exported functions ------------------------------------------------------- */
 /* External variables --------------------------------------------------------*/
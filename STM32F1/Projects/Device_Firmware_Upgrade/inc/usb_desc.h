@@ -37,9 +37,9 @@
 #define DFU_SIZ_DEVICE_DESC            18
 
 #ifdef USE_STM3210B_EVAL
-  #define DFU_SIZ_CONFIG_DESC          36
-#elif defined(USE_STM3210E_EVAL)
   #define DFU_SIZ_CONFIG_DESC          45
+#elif defined(USE_STM3210E_EVAL)
+  #define DFU_SIZ_CONFIG_DESC          54
 #elif defined(USE_STM32L152_EVAL) || defined (USE_STM32L152D_EVAL) || defined(USE_STM32373C_EVAL) || defined(USE_STM32303C_EVAL)
   #define DFU_SIZ_CONFIG_DESC          27
 #endif /* USE_STM3210B_EVAL */
@@ -52,6 +52,7 @@
 
 #define DFU_SIZ_STRING_INTERFACE1       98     /* SPI Flash : M25P64*/
 #define DFU_SIZ_STRING_INTERFACE2       106    /* NOR Flash : M26M128*/
+#define DFU_SIZ_STRING_INTERFACE3       72     /* Patch of the Internal Flash */
 
 extern  uint8_t DFU_DeviceDescriptor[DFU_SIZ_DEVICE_DESC];
 extern  uint8_t DFU_ConfigDescriptor[DFU_SIZ_CONFIG_DESC];
@@ -64,13 +65,18 @@ extern  uint8_t DFU_StringInterface1 [DFU_SIZ_STRING_INTERFACE1];
 extern  uint8_t DFU_StringInterface2_1 [DFU_SIZ_STRING_INTERFACE2];
 extern  uint8_t DFU_StringInterface2_2 [DFU_SIZ_STRING_INTERFACE2];
 extern  uint8_t DFU_StringInterface2_3 [DFU_SIZ_STRING_INTERFACE2];
+extern  uint8_t DFU_StringInterface3 [DFU_SIZ_STRING_INTERFACE3];
 
 #define bMaxPacketSize0             0x40     /* bMaxPacketSize0 = 64 bytes   */
 
-#define wTransferSize               0x0400   /* wTransferSize   = 1024 bytes */
+/* Block size of the downloads, a multiple of 256 bytes. Two blocks of RAM
+   are used, one is programmed while the host sends the next one */
+#ifndef wTransferSize
+#define wTransferSize               0x0800   /* wTransferSize   = 2048 bytes */
+#endif
 /* bMaxPacketSize0 <= wTransferSize <= 32kbytes */
-#define wTransferSizeB0             0x00
-#define wTransferSizeB1             0x04
+#define wTransferSizeB0             (wTransferSize & 0xFF)
+#define wTransferSizeB1             ((wTransferSize >> 8) & 0xFF)
 
 /* Exported macro ------------------------------------------------------------*/
 /* Exported functions ------------------------------------------------------- */
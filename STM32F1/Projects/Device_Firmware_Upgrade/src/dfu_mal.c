@@ -39,6 +39,7 @@
 
  #include "nor_if.h"
  #include "fsmc_nor.h"
+ #include "patch_if.h"
 #endif /* STM32L1XX_MD && USE_STM32373C_EVAL*/
 /* Private typedef -----------------------------------------------------------*/
 /* Private define ------------------------------------------------------------*/
@@ -48,15 +49,24 @@ uint16_t (*pMAL_Init) (void);
 uint16_t (*pMAL_Erase) (uint32_t SectorAddress);
 uint16_t (*pMAL_Write) (uint32_t SectorAddress, uint32_t DataLength);
 uint8_t  *(*pMAL_Read)  (uint32_t SectorAddress, uint32_t DataLength);
-uint8_t  MAL_Buffer[wTransferSize]; /* RAM Buffer for Downloaded Data */
+static uint8_t  MAL_Buffers[2][wTransferSize];
+uint8_t  *MAL_Buffer = MAL_Buffers[0];      /* RAM Buffer for Downloaded Data */
+uint8_t  *MAL_Prog_Buffer = MAL_Buffers[1]; /* RAM Buffer being written by MAL_Write */
+
+/* Operation started by MAL_Start() and run by MAL_Process() */
+static __IO uint8_t  MAL_Op = MAL_OP_NONE;
+static uint32_t MAL_Op_Address;
+static uint32_t MAL_Op_Length;
+static uint16_t MAL_Op_Frame;   /* USB frame number at the start */
 
 #if !defined(STM32L1XX_MD) && !defined(STM32L1XX_HD) && !defined(STM32L1XX_MD_PLUS)&& !defined (USE_STM32373C_EVAL) && !defined (USE_STM32303C_EVAL)
   NOR_IDTypeDef NOR_ID;
 #endif /* STM32L1XX_XD */
 
-extern ONE_DESCRIPTOR DFU_String_Descriptor[7];
+extern ONE_DESCRIPTOR DFU_String_Descriptor[];
 
-/* This table holds the Typical Sector Erase and 1024 Bytes Write timings.
+/* This table holds the Typical Sector Erase and 1024 Bytes Write timings,
+   the write timing is scaled to wTransferSize.
    These timings will be returned to the host when it checks the device
    status during a write or erase operation to know how much time the host
    should wait before issuing the next get status request. 
@@ -68,13 +78,14 @@ extern ONE_DESCRIPTOR DFU_String_Descriptor[7];
    operations. It could be a sector, a page, a block, a word ...
    If the erase operation is not supported, it is advised to set the erase
    timing to 1 (which means 1ms: one USB frame). */
-static const uint16_t  TimingTable[5][2] =
+static const uint16_t  TimingTable[6][2] =
   { /*       Sector Erase time,            Sector Program time*/    
     { SPI_FLASH_SECTOR_ERASE_TIME,    SPI_FLASH_SECTOR_WRITE_TIME },    /* SPI Flash */
     { M29W128F_SECTOR_ERASE_TIME,     M29W128F_SECTOR_WRITE_TIME },     /* NOR Flash M29W128F */
     { INTERN_FLASH_SECTOR_ERASE_TIME, INTERN_FLASH_SECTOR_WRITE_TIME }, /* Internal Flash */
     { M29W128G_SECTOR_ERASE_TIME,     M29W128G_SECTOR_WRITE_TIME },     /* NOR Flash M29W128G */
-    { S29GL128_SECTOR_ERASE_TIME,     S29GL128_SECTOR_WRITE_TIME }      /* NOR Flash S29GL128 */
+    { S29GL128_SECTOR_ERASE_TIME,     S29GL128_SECTOR_WRITE_TIME },     /* NOR Flash S29GL128 */
+    { PATCH_SECTOR_ERASE_TIME,        PATCH_SECTOR_WRITE_TIME }         /* Patch of the Internal Flash */
   };
 
 /* Private function prototypes -----------------------------------------------*/
@@ -94,6 +105,7 @@ uint16_t MAL_Init(void)
 
 #if defined(USE_STM3210B_EVAL) || defined(USE_STM3210E_EVAL)
   SPI_If_Init();   /* SPI Flash */
+  PATCH_If_Init(); /* Patch of the Internal Flash */
 #endif /* USE_STM3210B_EVAL or USE_STM3210E_EVAL */
 
 #ifdef USE_STM3210E_EVAL 
@@ -138,6 +150,10 @@ uint16_t MAL_Erase(uint32_t SectorAddress)
     case SPI_FLASH_BASE:
       pMAL_Erase = SPI_If_Erase;
       break;
+
+    case PATCH_BASE:
+      pMAL_Erase = PATCH_If_Erase;
+      break;
 #endif /* USE_STM3210B_EVAL or USE_STM3210E_EVAL */
             
 #ifdef USE_STM3210E_EVAL  
@@ -172,6 +188,10 @@ uint16_t MAL_Write (uint32_t SectorAddress, uint32_t DataLength)
     case SPI_FLASH_BASE:
       pMAL_Write = SPI_If_Write;
       break;
+
+    case PATCH_BASE:
+      pMAL_Write = PATCH_If_Write;
+      break;
 #endif /* USE_STM3210B_EVAL || USE_STM3210E_EVAL */      
 
 #ifdef USE_STM3210E_EVAL
@@ -221,7 +241,8 @@ uint8_t *MAL_Read (uint32_t SectorAddress, uint32_t DataLength)
 
 /*******************************************************************************
 * Function Name  : MAL_GetStatus
-* Description    : Get status
+* Description    : Get status, sets the poll timeout to the time left of the
+*                  operation running, or to 0 when none is.
 * Input          : None
 * Output         : None
 * Return         : Buffer pointer
@@ -232,7 +253,25 @@ uint16_t MAL_GetStatus(uint32_t SectorAddress , uint8_t Cmd, uint8_t *buffer)
   /* 0x640000000 --> 1 */
   /* 0x080000000 --> 2 */
 
-  uint8_t y = Cmd & 0x01;
+  uint8_t y;
+  uint32_t Timing, Elapsed;
+
+  /* A new operation starts at once when none is running */
+  if (MAL_Op == MAL_OP_NONE)
+  {
+    SET_POLLING_TIMING(0);
+    return MAL_OK;
+  }
+
+  /* Otherwise the host waits for the one running */
+  SectorAddress = MAL_Op_Address;
+  x = (SectorAddress  >> 26) & 0x03 ;
+  y = (MAL_Op == MAL_OP_WRITE);
+
+  if ((SectorAddress & MAL_MASK) == PATCH_BASE)
+  {
+    x = 5;
+  }
 
 #if defined(USE_STM3210E_EVAL)  
   if ((x == 1) && (NOR_ID.Device_Code2 == NOR_M29W128G)&& (NOR_ID.Manufacturer_Code == 0x20))
@@ -245,9 +284,94 @@ uint16_t MAL_GetStatus(uint32_t SectorAddress , uint8_t Cmd, uint8_t *buffer)
   }  
 #endif /* USE_STM3210E_EVAL */
   
-  SET_POLLING_TIMING(TimingTable[x][y]);  /* x: Erase/Write Timing */
+  Timing = TimingTable[x][y];
+  if (y == 1)
+  {
+    Timing = (Timing * wTransferSize + 1023) / 1024;
+  }
+
+  /* Frames of 1 ms since the start, the frame number wraps every 2 s */
+  Elapsed = (GetFNR() - MAL_Op_Frame) & FNR_FN;
+  Timing = (Elapsed < Timing) ? (Timing - Elapsed) : 1;
+
+  SET_POLLING_TIMING(Timing);  /* x: Erase/Write Timing */
   /* y: Media              */
   return MAL_OK;
 }
 
+/*******************************************************************************
+* Function Name  : MAL_Start
+* Description    : Starts an erase, or a write of MAL_Buffer, run later by
+*                  MAL_Process() while the host sends the next request. For a
+*                  write the buffers are swapped, MAL_Buffer then receives the
+*                  next block while MAL_Prog_Buffer is written.
+* Input          : - Op: MAL_OP_ERASE or MAL_OP_WRITE.
+*                  - SectorAddress: address to erase or write.
+*                  - DataLength: bytes to write.
+* Output         : None
+* Return         : MAL_OK, or MAL_FAIL if an operation is running.
+*******************************************************************************/
+uint16_t MAL_Start(uint8_t Op, uint32_t SectorAddress, uint32_t DataLength)
+{
+  uint8_t *Buffer;
+
+  if (MAL_Op != MAL_OP_NONE)
+  {
+    return MAL_FAIL;
+  }
+
+  if (Op == MAL_OP_WRITE)
+  {
+    Buffer = MAL_Prog_Buffer;
+    MAL_Prog_Buffer = MAL_Buffer;
+    MAL_Buffer = Buffer;
+  }
+
+  MAL_Op_Address = SectorAddress;
+  MAL_Op_Length = DataLength;
+  MAL_Op_Frame = GetFNR();
+  MAL_Op = Op;
+
+  return MAL_OK;
+}
+
+/*******************************************************************************
+* Function Name  : MAL_Busy
+* Description    : Tells if an operation started by MAL_Start() is running.
+* Input          : None
+* Output         : None
+* Return         : 1 if busy, 0 otherwise.
+*******************************************************************************/
+uint8_t MAL_Busy(void)
+{
+  return (MAL_Op != MAL_OP_NONE);
+}
+
+/*******************************************************************************
+* Function Name  : MAL_Process
+* Description    : Runs the operation started by MAL_Start(), called from the
+*                  main loop so that the USB interrupt keeps receiving.
+* Input          : None
+* Output         : None
+* Return         : None
+*******************************************************************************/
+void MAL_Process(void)
+{
+  switch (MAL_Op)
+  {
+    case MAL_OP_ERASE:
+      MAL_Erase(MAL_Op_Address);
+      break;
+
+    case MAL_OP_WRITE:
+      MAL_Write(MAL_Op_Address, MAL_Op_Length);
+      break;
+
+    default:
+      return;
+  }
+
+  MAL_Op = MAL_OP_NONE;
+}
+
 /************************ (C) COPYRIGHT STMicroelectronics *****END OF FILE****/
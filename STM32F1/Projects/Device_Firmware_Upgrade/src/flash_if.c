@@ -85,7 +85,7 @@ uint16_t FLASH_If_Write(uint32_t SectorAddress, uint32_t DataLength)
 {
   uint32_t idx = 0;
 #if defined(STM32L1XX_MD) || defined(STM32L1XX_HD)|| defined(STM32L1XX_MD_PLUS)
-  __IO uint32_t* malPointer = (uint32_t *)MAL_Buffer;
+  __IO uint32_t* malPointer = (uint32_t *)MAL_Prog_Buffer;
   __IO uint32_t* memPointer = (uint32_t *)SectorAddress;
   __IO uint32_t memBuffer[32]; /* Temporary buffer holding data that will be written in a half-page space */
   __IO uint32_t* mempBuffer = memBuffer;  
@@ -96,7 +96,7 @@ uint16_t FLASH_If_Write(uint32_t SectorAddress, uint32_t DataLength)
   {
     for (idx = DataLength; idx < ((DataLength & 0xFFFC) + 4); idx++)
     {
-      MAL_Buffer[idx] = 0xFF;
+      MAL_Prog_Buffer[idx] = 0xFF;
     }
   } 
   
@@ -117,13 +117,13 @@ uint16_t FLASH_If_Write(uint32_t SectorAddress, uint32_t DataLength)
     }
   }    
   
-  while (malPointer < (uint32_t*)(MAL_Buffer + DataLength))
+  while (malPointer < (uint32_t*)(MAL_Prog_Buffer + DataLength))
   {    
     /* Fill with the received buffer */
     while (mempBuffer < (memBuffer + 32))
     {
       /* If there are still data available in the received buffer */
-      if (malPointer < ((uint32_t *)MAL_Buffer + DataLength))
+      if (malPointer < ((uint32_t *)MAL_Prog_Buffer + DataLength))
       {
         *(uint32_t *)(mempBuffer++) = *(uint32_t *)(malPointer++);
       }
@@ -133,8 +133,11 @@ uint16_t FLASH_If_Write(uint32_t SectorAddress, uint32_t DataLength)
       }
     }
    
-    /* Write the buffer to the memory*/    
+    /* Write the buffer to the memory, no interrupt may fetch from the flash
+       meanwhile */    
+    __disable_irq();
     FLASH_ProgramHalfPage(((uint32_t)memPointer & 0xFFFFFF80), (uint32_t *)(memBuffer));    
+    __enable_irq();
     
     /* Increment the memory pointer */ 
     memPointer = (uint32_t *)(((uint32_t)memPointer & 0xFFFFFF80) + (32*4));
@@ -148,7 +151,7 @@ uint16_t FLASH_If_Write(uint32_t SectorAddress, uint32_t DataLength)
   /* Data received are Word multiple */    
   for (idx = 0; idx <  DataLength; idx = idx + 4)
   {
-    FLASH_ProgramWord(SectorAddress, *(uint32_t *)(MAL_Buffer + idx));  
+    FLASH_ProgramWord(SectorAddress, *(uint32_t *)(MAL_Prog_Buffer + idx));  
     SectorAddress += 4;
   } 
 #endif /* STM32L1XX_XD */
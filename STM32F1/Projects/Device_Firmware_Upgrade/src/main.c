@@ -91,7 +91,10 @@ int main(void)
   
   /* Main loop */
   while (1)
-  {}
+  {
+    /* Erase or write the media while the next request is received */
+    MAL_Process();
+  }
 }
 
 
@@ -89,10 +89,10 @@ uint16_t NOR_If_Write(uint32_t Address, uint32_t DataLength)
   if ((DataLength & 1) == 1) /* Not an aligned data */
   {
     DataLength += 1;
-    MAL_Buffer[DataLength-1] = 0xFF;
+    MAL_Prog_Buffer[DataLength-1] = 0xFF;
   }
   
-  FSMC_NOR_WriteBuffer((uint16_t *)MAL_Buffer, (Address&0x00FFFFFF), DataLength >> 1);  
+  FSMC_NOR_WriteBuffer((uint16_t *)MAL_Prog_Buffer, (Address&0x00FFFFFF), DataLength >> 1);  
   
   return MAL_OK;
 }
@@ -0,0 +1,353 @@
+/**
+  ******************************************************************************
+  * @file    patch_if.c
+  * @author  MCD Application Team
+  * @version V4.0.0
+  * @date    21-January-2013
+  * @brief   Media access Layer applying delta patches to the internal Flash
+  ******************************************************************************
+  * @attention
+  *
+  * <h2><center>&copy; COPYRIGHT 2013 STMicroelectronics</center></h2>
+  *
+  * Licensed under MCD-ST Liberty SW License Agreement V2, (the "License");
+  * You may not use this file except in compliance with the License.
+  * You may obtain a copy of the License at:
+  *
+  *        http://www.st.com/software_license_agreement_liberty_v2
+  *
+  * Unless required by applicable law or agreed to in writing, software 
+  * distributed under the License is distributed on an "AS IS" BASIS, 
+  * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  * See the License for the specific language governing permissions and
+  * limitations under the License.
+  *
+  ******************************************************************************
+  */
+
+#include "platform_config.h"
+
+#if defined(USE_STM3210B_EVAL) || defined(USE_STM3210E_EVAL)
+
+/* Includes ------------------------------------------------------------------*/
+#include "hw_config.h"
+#include "patch_if.h"
+#include "flash_if.h"
+#include "dfu_mal.h"
+#include "CRCDevice.h"
+
+/* Private typedef -----------------------------------------------------------*/
+typedef enum
+{
+  PATCH_HEADER = 0,
+  PATCH_RECORD,
+  PATCH_KEEP,
+  PATCH_CHECK,
+  PATCH_TOKEN,
+  PATCH_ARGS,
+  PATCH_LITERAL,
+  PATCH_DONE,
+  PATCH_ERROR
+} PATCH_State;
+
+/* Private define ------------------------------------------------------------*/
+#define PATCH_HEADER_SIZE   8
+
+/* Private macro -------------------------------------------------------------*/
+/* Private variables ---------------------------------------------------------*/
+static PATCH_State State = PATCH_DONE;
+static uint32_t Window[PATCH_PAGE_SIZE / 4]; /* Page being rebuilt */
+static uint32_t Region;        /* Address the patch applies to */
+static uint32_t Page_Address;  /* Address of the page being rebuilt */
+static uint32_t Flash_End;
+static uint16_t Pos;           /* Bytes of the page rebuilt */
+static uint8_t  Args[PATCH_HEADER_SIZE];
+static uint8_t  Arg_Count, Arg_Needed;
+static uint8_t  Token;
+static uint8_t  Run;           /* Literal bytes left */
+
+/* Private function prototypes -----------------------------------------------*/
+static PATCH_State PATCH_Commit(void);
+static PATCH_State PATCH_Copy(void);
+static void PATCH_Byte(uint8_t Byte);
+
+/* Private functions ---------------------------------------------------------*/
+
+/*******************************************************************************
+* Function Name  : PATCH_Commit
+* Description    : Writes the page rebuilt in the window, unless the Flash
+*                  already holds it, and moves to the next page.
+* Input          : None
+* Output         : None
+* Return         : The next state.
+*******************************************************************************/
+static PATCH_State PATCH_Commit(void)
+{
+  uint32_t idx;
+  uint32_t *Flash = (uint32_t *)Page_Address;
+
+  for (idx = 0; idx < PATCH_PAGE_SIZE / 4; idx++)
+  {
+    if (Flash[idx] != Window[idx])
+    {
+      break;
+    }
+  }
+
+  if (idx < PATCH_PAGE_SIZE / 4)
+  {
+    FLASH_If_Erase(Page_Address);
+
+    for (idx = 0; idx < PATCH_PAGE_SIZE / 4; idx++)
+    {
+      if (FLASH_ProgramWord(Page_Address + idx * 4, Window[idx]) != FLASH_COMPLETE)
+      {
+        return PATCH_ERROR;
+      }
+    }
+  }
+
+  Page_Address += PATCH_PAGE_SIZE;
+  Pos = 0;
+
+  return PATCH_RECORD;
+}
+
+/*******************************************************************************
+* Function Name  : PATCH_Copy
+* Description    : Runs a copy token once its arguments are received.
+* Input          : None
+* Output         : None
+* Return         : The next state.
+*******************************************************************************/
+static PATCH_State PATCH_Copy(void)
+{
+  uint8_t *Page = (uint8_t *)Window;
+  uint8_t *Source;
+  uint32_t Count = (Token & 0x3F) + 1;
+  uint32_t Offset;
+
+  if (Pos + Count > PATCH_PAGE_SIZE)
+  {
+    return PATCH_ERROR;
+  }
+
+  if (Token & 0x40)
+  {
+    /* Bytes of the page being rebuilt, one at a time for the overlaps */
+    Offset = Args[0] | (Args[1] << 8);
+    if ((Offset == 0) || (Offset > Pos))
+    {
+      return PATCH_ERROR;
+    }
+    Source = &Page[Pos - Offset];
+  }
+  else
+  {
+    /* Bytes of the current image, the pages rewritten are lost */
+    Offset = Region + (Args[0] | (Args[1] << 8) | ((uint32_t)Args[2] << 16));
+    if ((Offset < Page_Address) || (Offset + Count > Flash_End))
+    {
+      return PATCH_ERROR;
+    }
+    Source = (uint8_t *)Offset;
+  }
+
+  while (Count-- != 0)
+  {
+    Page[Pos++] = *Source++;
+  }
+
+  return (Pos == PATCH_PAGE_SIZE) ? PATCH_Commit() : PATCH_TOKEN;
+}
+
+/*******************************************************************************
+* Function Name  : PATCH_Byte
+* Description    : Decodes the next byte of the patch.
+* Input          : - Byte: the byte.
+* Output         : None
+* Return         : None
+*******************************************************************************/
+static void PATCH_Byte(uint8_t Byte)
+{
+  switch (State)
+  {
+    case PATCH_HEADER:
+      Args[Arg_Count++] = Byte;
+      if (Arg_Count == PATCH_HEADER_SIZE)
+      {
+        Region = Args[4] | (Args[5] << 8) | ((uint32_t)Args[6] << 16) | ((uint32_t)Args[7] << 24);
+
+        if ((Args[0] != 'D') || (Args[1] != 'P') || (Args[2] != 'T') || (Args[3] != '1')
+            || (Region & (PATCH_PAGE_SIZE - 1)) || (Region < ApplicationAddress)
+            || (Region >= Flash_End))
+        {
+          State = PATCH_ERROR;
+        }
+        else
+        {
+          Page_Address = Region;
+          Pos = 0;
+          State = PATCH_RECORD;
+        }
+      }
+      break;
+
+    case PATCH_RECORD:
+      if (Byte == PATCH_OP_END)
+      {
+        State = PATCH_DONE;
+      }
+      else if (Byte == PATCH_OP_KEEP)
+      {
+        Arg_Count = 0;
+        State = PATCH_KEEP;
+      }
+      else if (Byte == PATCH_OP_CHECK)
+      {
+        Arg_Count = 0;
+        State = PATCH_CHECK;
+      }
+      else if ((Byte == PATCH_OP_PAGE) && (Page_Address < Flash_End))
+      {
+        State = PATCH_TOKEN;
+      }
+      else
+      {
+        State = PATCH_ERROR;
+      }
+      break;
+
+    case PATCH_KEEP:
+      Args[Arg_Count++] = Byte;
+      if (Arg_Count == 2)
+      {
+        /* The pages kept must be in the Flash, a check reads them back */
+        if ((uint32_t)(Args[0] | (Args[1] << 8)) * PATCH_PAGE_SIZE > Flash_End - Page_Address)
+        {
+          State = PATCH_ERROR;
+        }
+        else
+        {
+          Page_Address += (Args[0] | (Args[1] << 8)) * PATCH_PAGE_SIZE;
+          State = PATCH_RECORD;
+        }
+      }
+      break;
+
+    case PATCH_CHECK:
+      Args[Arg_Count++] = Byte;
+      if (Arg_Count == 4)
+      {
+        /* The pages written are read back from the Flash, DMA fed */
+        if (CRCDeviceCompute(CRC_DEVICE_INIT, (const void *)Region, Page_Address - Region)
+            == (Args[0] | (Args[1] << 8) | ((uint32_t)Args[2] << 16) | ((uint32_t)Args[3] << 24)))
+        {
+          State = PATCH_RECORD;
+        }
+        else
+        {
+          State = PATCH_ERROR;
+        }
+      }
+      break;
+
+    case PATCH_TOKEN:
+      Token = Byte;
+      if ((Byte & 0x80) == 0)
+      {
+        Run = Byte + 1;
+        State = PATCH_LITERAL;
+      }
+      else
+      {
+        Arg_Count = 0;
+        Arg_Needed = (Byte & 0x40) ? 2 : 3;
+        State = PATCH_ARGS;
+      }
+      break;
+
+    case PATCH_LITERAL:
+      ((uint8_t *)Window)[Pos++] = Byte;
+      Run--;
+      if (Pos == PATCH_PAGE_SIZE)
+      {
+        State = (Run == 0) ? PATCH_Commit() : PATCH_ERROR;
+      }
+      else if (Run == 0)
+      {
+        State = PATCH_TOKEN;
+      }
+      break;
+
+    case PATCH_ARGS:
+      Args[Arg_Count++] = Byte;
+      if (Arg_Count == Arg_Needed)
+      {
+        State = PATCH_Copy();
+      }
+      break;
+
+    default:
+      /* Done or failed, the padding of the last block is skipped */
+      break;
+  }
+}
+
+/*******************************************************************************
+* Function Name  : PATCH_If_Init
+* Description    : Initializes the patch decoder
+* Input          : None
+* Output         : None
+* Return         : None
+*******************************************************************************/
+uint16_t PATCH_If_Init(void)
+{
+  Flash_End = INTERNAL_FLASH_BASE + PATCH_FLASH_SIZE;
+  State = PATCH_DONE;
+  CRCDeviceInit();
+
+  return MAL_OK;
+}
+
+/*******************************************************************************
+* Function Name  : PATCH_If_Erase
+* Description    : Nothing to erase, the pages are erased as they are rebuilt
+* Input          : None
+* Output         : None
+* Return         : None
+*******************************************************************************/
+uint16_t PATCH_If_Erase(uint32_t SectorAddress)
+{
+  return MAL_OK;
+}
+
+/*******************************************************************************
+* Function Name  : PATCH_If_Write
+* Description    : Decodes a block of the patch, the block at PATCH_BASE
+*                  starts a new patch.
+* Input          : None
+* Output         : None
+* Return         : MAL_OK, or MAL_FAIL once the patch is found invalid.
+*******************************************************************************/
+uint16_t PATCH_If_Write(uint32_t SectorAddress, uint32_t DataLength)
+{
+  uint32_t idx;
+
+  if (SectorAddress == PATCH_BASE)
+  {
+    Arg_Count = 0;
+    State = PATCH_HEADER;
+  }
+
+  for (idx = 0; idx < DataLength; idx++)
+  {
+    PATCH_Byte(MAL_Prog_Buffer[idx]);
+  }
+
+  return (State == PATCH_ERROR) ? MAL_FAIL : MAL_OK;
+}
+
+#endif /* USE_STM3210B_EVAL or USE_STM3210E_EVAL */
+
+/************************ (C) COPYRIGHT STMicroelectronics *****END OF FILE****/
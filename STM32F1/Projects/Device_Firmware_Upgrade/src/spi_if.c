@@ -81,14 +81,14 @@ uint16_t SPI_If_Write(uint32_t SectorAddress, uint32_t DataLength)
   {
     for ( idx = DataLength; idx < ((DataLength & 0xFF00) + 0x100) ; idx++)
     {
-      MAL_Buffer[idx] = 0xFF;
+      MAL_Prog_Buffer[idx] = 0xFF;
     }
     pages = (((DataLength & 0xFF00)) >> 8 ) + 1;
   }
 
   for (idx = 0; idx < pages; idx++)
   {
-    sFLASH_WritePage(&MAL_Buffer[idx*256], SectorAddress, 256);
+    sFLASH_WritePage(&MAL_Prog_Buffer[idx*256], SectorAddress, 256);
     SectorAddress += 0x100;
   }
   return MAL_OK;
@@ -108,6 +108,21 @@ uint8_t DFU_ConfigDescriptor[DFU_SIZ_CONFIG_DESC] =
     /* Index of string descriptor */
     /* 27 */
 
+    /************ Descriptor of DFU interface 0 Alternate setting 2  **********/
+
+    0x09,   /* bLength: Interface Descriptor size */
+    0x04,   /* bDescriptorType: */
+    /*      Interface descriptor type */
+    0x00,   /* bInterfaceNumber: Number of Interface */
+    0x02,   /* bAlternateSetting: Alternate setting */
+    0x00,   /* bNumEndpoints*/
+    0xFE,   /* bInterfaceClass: Application Specific Class Code */
+    0x01,   /* bInterfaceSubClass : Device Firmware Upgrade Code */
+    0x02,   /* nInterfaceProtocol: DFU mode protocol */
+    0x06,   /* iInterface: */
+    /* Index of string descriptor */
+    /* 36 */
+
     /******************** DFU Functional Descriptor********************/
     0x09,   /*blength = 9 Bytes*/
     0x21,   /* DFU Functional Descriptor*/
@@ -122,11 +137,11 @@ uint8_t DFU_ConfigDescriptor[DFU_SIZ_CONFIG_DESC] =
     0xFF,   /*DetachTimeOut= 255 ms*/
     0x00,
     wTransferSizeB0,
-    wTransferSizeB1,          /* TransferSize = 1024 Byte*/
+    wTransferSizeB1,          /* TransferSize = wTransferSize */
     0x1A,                     /* bcdDFUVersion*/
     0x01
     /***********************************************************/
-    /*36*/
+    /*45*/
 
   };
 
@@ -192,6 +207,21 @@ uint8_t DFU_ConfigDescriptor[DFU_SIZ_CONFIG_DESC] =
     /* Index of string descriptor */
     /* 36 */    
 
+    /************ Descriptor of DFU interface 0 Alternate setting 3  **********/
+
+    0x09,   /* bLength: Interface Descriptor size */
+    0x04,   /* bDescriptorType: */
+    /*      Interface descriptor type */
+    0x00,   /* bInterfaceNumber: Number of Interface */
+    0x03,   /* bAlternateSetting: Alternate setting */
+    0x00,   /* bNumEndpoints*/
+    0xFE,   /* bInterfaceClass: Application Specific Class Code */
+    0x01,   /* bInterfaceSubClass : Device Firmware Upgrade Code */
+    0x02,   /* nInterfaceProtocol: DFU mode protocol */
+    0x07,   /* iInterface: */
+    /* Index of string descriptor */
+    /* 45 */
+
     /******************** DFU Functional Descriptor********************/
     0x09,   /*blength = 9 Bytes*/
     0x21,   /* DFU Functional Descriptor*/
@@ -206,11 +236,11 @@ uint8_t DFU_ConfigDescriptor[DFU_SIZ_CONFIG_DESC] =
     0xFF,   /*DetachTimeOut= 255 ms*/
     0x00,
     wTransferSizeB0,
-    wTransferSizeB1,          /* TransferSize = 1024 Byte*/
+    wTransferSizeB1,          /* TransferSize = wTransferSize */
     0x1A,                     /* bcdDFUVersion*/
     0x01
     /***********************************************************/
-    /*45*/
+    /*54*/
 
   };
 
@@ -260,7 +290,7 @@ uint8_t DFU_ConfigDescriptor[DFU_SIZ_CONFIG_DESC] =
     0xFF,   /*DetachTimeOut= 255 ms*/
     0x00,
     wTransferSizeB0,
-    wTransferSizeB1,          /* TransferSize = 128 Bytes */
+    wTransferSizeB1,          /* TransferSize = wTransferSize */
     0x1A,                     /* bcdDFUVersion*/
     0x01
     /***********************************************************/
@@ -314,7 +344,7 @@ uint8_t DFU_ConfigDescriptor[DFU_SIZ_CONFIG_DESC] =
     0xFF,   /*DetachTimeOut= 255 ms*/
     0x00,
     wTransferSizeB0,
-    wTransferSizeB1,          /* TransferSize = 128 Bytes */
+    wTransferSizeB1,          /* TransferSize = wTransferSize */
     0x1A,                     /* bcdDFUVersion*/
     0x01
     /***********************************************************/
@@ -486,4 +516,17 @@ uint8_t DFU_StringInterface2_3[DFU_SIZ_STRING_INTERFACE2] =
     '/', 0, '1', 0, '2', 0, '8', 0, '*', 0, '1', 0, '2', 0, '8', 0, 'K', 0, 'g', 0
   };
 #endif /* USE_STM3210E_EVAL */
+
+#if defined(USE_STM3210B_EVAL) || defined(USE_STM3210E_EVAL)
+uint8_t DFU_StringInterface3[DFU_SIZ_STRING_INTERFACE3] =
+  {
+    DFU_SIZ_STRING_INTERFACE3,
+    0x03,
+    // Interface 3: "@Delta Patch  /0x0C000000/128*001Kd", written only
+    '@', 0, 'D', 0, 'e', 0, 'l', 0, 't', 0, 'a', 0, ' ', 0, 'P', 0, 'a', 0,
+    't', 0, 'c', 0, 'h', 0, ' ', 0, ' ', 0, '/', 0, '0', 0, 'x', 0, '0', 0,
+    'C', 0, '0', 0, '0', 0, '0', 0, '0', 0, '0', 0, '0', 0, '/', 0, '1', 0,
+    '2', 0, '8', 0, '*', 0, '0', 0, '0', 0, '1', 0, 'K', 0, 'd', 0
+  };
+#endif /* USE_STM3210B_EVAL or USE_STM3210E_EVAL */
 /************************ (C) COPYRIGHT STMicroelectronics *****END OF FILE****/
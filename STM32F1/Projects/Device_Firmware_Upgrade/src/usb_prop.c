@@ -90,9 +90,9 @@ ONE_DESCRIPTOR Config_Descriptor =
     DFU_SIZ_CONFIG_DESC
   };
 #ifdef USE_STM3210E_EVAL
- ONE_DESCRIPTOR DFU_String_Descriptor[7] =
+ ONE_DESCRIPTOR DFU_String_Descriptor[8] =
 #elif defined(USE_STM3210B_EVAL) 
- ONE_DESCRIPTOR DFU_String_Descriptor[6] =
+ ONE_DESCRIPTOR DFU_String_Descriptor[7] =
 #elif defined(USE_STM32L152_EVAL) || defined(USE_STM32L152D_EVAL) ||defined(USE_STM32373C_EVAL) ||defined(USE_STM32303C_EVAL)
  ONE_DESCRIPTOR DFU_String_Descriptor[5] =
 #endif /* USE_STM3210E_EVAL */
@@ -104,12 +104,14 @@ ONE_DESCRIPTOR Config_Descriptor =
     {       (uint8_t*)DFU_StringInterface0,      DFU_SIZ_STRING_INTERFACE0   }
 #ifdef USE_STM3210B_EVAL
     ,
-    {       (uint8_t*)DFU_StringInterface1,      DFU_SIZ_STRING_INTERFACE1   }
+    {       (uint8_t*)DFU_StringInterface1,      DFU_SIZ_STRING_INTERFACE1   },
+    {       (uint8_t*)DFU_StringInterface3,      DFU_SIZ_STRING_INTERFACE3   }
 #endif /* USE_STM3210B_EVAL */
 #ifdef USE_STM3210E_EVAL 
     ,
     {       (uint8_t*)DFU_StringInterface1,      DFU_SIZ_STRING_INTERFACE1   },
-    {       (uint8_t*)DFU_StringInterface2_1,    DFU_SIZ_STRING_INTERFACE2   }    
+    {       (uint8_t*)DFU_StringInterface2_1,    DFU_SIZ_STRING_INTERFACE2   },
+    {       (uint8_t*)DFU_StringInterface3,      DFU_SIZ_STRING_INTERFACE3   }
 #endif /* USE_STM3210E_EVAL */
   };
 
@@ -235,6 +237,16 @@ void DFU_Status_Out (void)
   {
     if (DeviceState == STATE_dfuDNBUSY)
     {
+      /* Stay busy until the previous erase or write is done, the host polls
+         again after the poll timeout */
+      if (((wBlockNum == 0) && (MAL_Buffer[0] == CMD_ERASE)) || (wBlockNum > 1))
+      {
+        if (MAL_Busy())
+        {
+          return;
+        }
+      }
+
       if (wBlockNum == 0)   /* Decode the Special Command*/
       {
         if ((MAL_Buffer[0] ==  CMD_GETCOMMANDS) && (wlength == 1))
@@ -252,14 +264,14 @@ void DFU_Status_Out (void)
           Pointer += MAL_Buffer[2] << 8;
           Pointer += MAL_Buffer[3] << 16;
           Pointer += MAL_Buffer[4] << 24;
-          MAL_Erase(Pointer);
+          MAL_Start(MAL_OP_ERASE, Pointer, 0);
         }
       }
 
       else if (wBlockNum > 1)  // Download Command
       {
         Addr = ((wBlockNum - 2) * wTransferSize) + Pointer;
-        MAL_Write(Addr, wlength);
+        MAL_Start(MAL_OP_WRITE, Addr, wlength);
       }
       wlength = 0;
       wBlockNum = 0;
@@ -273,6 +285,11 @@ void DFU_Status_Out (void)
     }
     else if (DeviceState == STATE_dfuMANIFEST)/* Manifestation in progress*/
     {
+      /* The last block is still being written, the host polls again */
+      if (MAL_Busy())
+      {
+        return;
+      }
       DFU_write_crc();
       return;
     }
@@ -297,6 +314,12 @@ RESULT DFU_Data_Setup(uint8_t RequestNo)
     if (RequestNo == DFU_UPLOAD && (DeviceState == STATE_dfuIDLE
                                     || DeviceState == STATE_dfuUPLOAD_IDLE ))
     {
+      /* An aborted download may still be writing the media */
+      if (MAL_Busy())
+      {
+        return USB_UNSUPPORT;
+      }
+
       CopyRoutine = UPLOAD;
     }
     else if (RequestNo == DFU_DNLOAD && (DeviceState == STATE_dfuIDLE
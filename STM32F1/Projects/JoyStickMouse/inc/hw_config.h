@@ -45,6 +45,15 @@
 #define RIGHT           4
 #define UP              5
 
+/* Joystick sampled every 1 ms by the SysTick, from its first edge until it is
+   released: a direction is taken after JOY_DEBOUNCE_TICKS equal samples, and
+   reported again every JOY_REPEAT_TICKS while it is held */
+#define JOY_DEBOUNCE_TICKS   4
+#define JOY_REPEAT_TICKS     32
+
+#define JOY_EXTI_LINES  (RIGHT_BUTTON_EXTI_LINE | LEFT_BUTTON_EXTI_LINE | \
+                         UP_BUTTON_EXTI_LINE | DOWN_BUTTON_EXTI_LINE)
+
 /* Exported functions ------------------------------------------------------- */
 void Set_System(void);
 void Set_USBClock(void);
@@ -55,6 +64,8 @@ void USB_Interrupts_Config(void);
 void USB_Cable_Config (FunctionalState NewState);
 void Joystick_Send(uint8_t Keys);
 uint8_t JoyState(void);
+void Joystick_Wakeup(void);
+void Joystick_Tick(void);
 void Get_SerialNum(void);
 
 #endif  /*__HW_CONFIG_H*/
@@ -48,7 +48,17 @@ void DebugMon_Handler(void);
 void PendSV_Handler(void);
 void SysTick_Handler(void);
 void USB_LP_CAN1_RX0_IRQHandler(void);
+void EXTI0_IRQHandler(void);
+void EXTI1_IRQHandler(void);
+#if defined (STM32F37X) || defined (STM32F30X)
+void EXTI2_TS_IRQHandler(void);
+#else
+void EXTI2_IRQHandler(void);
+#endif
+void EXTI3_IRQHandler(void);
+void EXTI4_IRQHandler(void);
 void EXTI9_5_IRQHandler(void);
+void EXTI15_10_IRQHandler(void);
 void USBWakeUp_IRQHandler(void);
 
 #endif /* __STM32_IT_H */
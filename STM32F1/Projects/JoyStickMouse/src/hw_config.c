@@ -40,6 +40,15 @@
 ErrorStatus HSEStartUpStatus;
 EXTI_InitTypeDef EXTI_InitStructure;
 
+/* Joystick debouncing: last sample, ticks it has been the same, direction
+   taken and ticks to its next report */
+static uint8_t Joy_Sample = 0;
+static uint8_t Joy_Count = 0;
+static uint8_t Joy_Direction = 0;
+static uint8_t Joy_Repeat = 0;
+/* Set by an edge of the joystick, the SysTick is not stopped in between */
+static __IO uint8_t Joy_Edge = 0;
+
 /* Extern variables ----------------------------------------------------------*/
 extern __IO uint8_t PrevXferComplete;
 
@@ -155,11 +164,12 @@ void Set_System(void)
 #endif /* USB_USE_EXTERNAL_PULLUP */
 
   /* Joystick buttons configuration *******************************************/
-  /* Configure the Joystick buttons in GPIO mode */
-  STM_EVAL_PBInit(Button_RIGHT, Mode_GPIO);
-  STM_EVAL_PBInit(Button_LEFT, Mode_GPIO);
-  STM_EVAL_PBInit(Button_UP, Mode_GPIO);
-  STM_EVAL_PBInit(Button_DOWN, Mode_GPIO);
+  /* Configure the Joystick buttons in EXTI mode, their press starts the
+     SysTick sampling */
+  STM_EVAL_PBInit(Button_RIGHT, Mode_EXTI);
+  STM_EVAL_PBInit(Button_LEFT, Mode_EXTI);
+  STM_EVAL_PBInit(Button_UP, Mode_EXTI);
+  STM_EVAL_PBInit(Button_DOWN, Mode_EXTI);
 
   /* Configure the Key button in EXTI mode ************************************/
   STM_EVAL_PBInit(Button_KEY, Mode_EXTI);
@@ -172,6 +182,7 @@ void Set_System(void)
   EXTI_Init(&EXTI_InitStructure);
 
   EXTI_ClearITPendingBit(KEY_BUTTON_EXTI_LINE);
+  EXTI_ClearITPendingBit(JOY_EXTI_LINES);
 }
 
 /*******************************************************************************
@@ -435,6 +446,88 @@ uint8_t JoyState(void)
      } 
 }
 
+/*******************************************************************************
+* Function Name : Joystick_Wakeup.
+* Description   : Starts the 1 ms sampling of the joystick, called on the
+*                 edges of its EXTI lines.
+* Input         : None.
+* Output        : None.
+* Return value  : None.
+*******************************************************************************/
+void Joystick_Wakeup(void)
+{
+  Joy_Edge = 1;
+
+  if ((SysTick->CTRL & SysTick_CTRL_ENABLE_Msk) == 0)
+  {
+    Joy_Count = 0;
+    SysTick_Config(SystemCoreClock / 1000);
+  }
+}
+
+/*******************************************************************************
+* Function Name : Joystick_Tick.
+* Description   : Debounces the joystick and queues its reports, called every
+*                 1 ms by the SysTick. A direction is reported when it is taken
+*                 and every JOY_REPEAT_TICKS while it is held, the SysTick is
+*                 stopped once the joystick is released.
+* Input         : None.
+* Output        : None.
+* Return value  : None.
+*******************************************************************************/
+void Joystick_Tick(void)
+{
+  uint8_t State = JoyState();
+
+  Joy_Edge = 0;
+
+  if (State != Joy_Sample)
+  {
+    Joy_Sample = State;
+    Joy_Count = 0;
+  }
+  else if (Joy_Count < JOY_DEBOUNCE_TICKS)
+  {
+    Joy_Count++;
+  }
+
+  if (Joy_Count < JOY_DEBOUNCE_TICKS)
+  {
+    return;
+  }
+
+  if (Joy_Sample != Joy_Direction)
+  {
+    /* A new direction is reported on this frame */
+    Joy_Direction = Joy_Sample;
+    Joy_Repeat = 0;
+  }
+
+  if (Joy_Direction != 0)
+  {
+    if (Joy_Repeat != 0)
+    {
+      Joy_Repeat--;
+    }
+
+    if ((Joy_Repeat == 0) && (bDeviceState == CONFIGURED) && (PrevXferComplete))
+    {
+      Joystick_Send(Joy_Direction);
+      Joy_Repeat = JOY_REPEAT_TICKS;
+    }
+  }
+  else
+  {
+    /* Released: no report, sleep until the next edge */
+    __disable_irq();
+    if (Joy_Edge == 0)
+    {
+      SysTick->CTRL &= ~(SysTick_CTRL_TICKINT_Msk | SysTick_CTRL_ENABLE_Msk);
+    }
+    __enable_irq();
+  }
+}
+
 /*******************************************************************************
 * Function Name : Joystick_Send.
 * Description   : prepares buffer to be sent containing Joystick event infos.
@@ -60,14 +60,9 @@ int main(void)
 
   while (1)
   {
-    
-    if (bDeviceState == CONFIGURED)
-    {
-      if ((JoyState() != 0) && (PrevXferComplete))
-      {
-        Joystick_Send(JoyState());
-      }
-    }    
+    /* The joystick is read and reported by the EXTI and SysTick interrupts,
+       sleep until the next one */
+    __WFI();
   }
 }
 
@@ -34,6 +34,7 @@
 #include "usb_lib.h"
 #include "usb_pwr.h"
 #include "platform_config.h"
+#include "hw_config.h"
 
 
 /* Private typedef -----------------------------------------------------------*/
@@ -160,6 +161,7 @@ void PendSV_Handler(void)
 *******************************************************************************/
 void SysTick_Handler(void)
 {
+  Joystick_Tick();
 }
 
 /******************************************************************************/
@@ -196,19 +198,14 @@ void USB_FS_WKUP_IRQHandler(void)
 }
 #endif
 /*******************************************************************************
-* Function Name  : EXTI_IRQHandler
-* Description    : This function handles External lines  interrupt request.
+* Function Name  : EXTI_Buttons_IRQHandler
+* Description    : Handles the Key button and the joystick lines, shared by the
+*                  External lines interrupts they are on.
 * Input          : None
 * Output         : None
 * Return         : None
 *******************************************************************************/
-#if defined(STM32L1XX_MD) || defined(STM32L1XX_HD)|| defined(STM32L1XX_MD_PLUS)
-void EXTI0_IRQHandler(void)
-#elif defined (STM32F37X)
-void EXTI2_TS_IRQHandler(void)
-#else
-void EXTI9_5_IRQHandler(void)
-#endif
+static void EXTI_Buttons_IRQHandler(void)
 {
   if (EXTI_GetITStatus(KEY_BUTTON_EXTI_LINE) != RESET)
   {
@@ -224,6 +221,101 @@ void EXTI9_5_IRQHandler(void)
     /* Clear the EXTI line pending bit */
     EXTI_ClearITPendingBit(KEY_BUTTON_EXTI_LINE);
   }
+
+  if ((EXTI->PR & JOY_EXTI_LINES) != 0)
+  {
+    /* Clear the EXTI lines pending bits and start the joystick sampling */
+    EXTI_ClearITPendingBit(EXTI->PR & JOY_EXTI_LINES);
+    Joystick_Wakeup();
+  }
+}
+
+/*******************************************************************************
+* Function Name  : EXTI0_IRQHandler
+* Description    : This function handles External line 0 interrupt request.
+* Input          : None
+* Output         : None
+* Return         : None
+*******************************************************************************/
+void EXTI0_IRQHandler(void)
+{
+  EXTI_Buttons_IRQHandler();
+}
+
+/*******************************************************************************
+* Function Name  : EXTI1_IRQHandler
+* Description    : This function handles External line 1 interrupt request.
+* Input          : None
+* Output         : None
+* Return         : None
+*******************************************************************************/
+void EXTI1_IRQHandler(void)
+{
+  EXTI_Buttons_IRQHandler();
+}
+
+/*******************************************************************************
+* Function Name  : EXTI2_IRQHandler
+* Description    : This function handles External line 2 interrupt request.
+* Input          : None
+* Output         : None
+* Return         : None
+*******************************************************************************/
+#if defined (STM32F37X) || defined (STM32F30X)
+void EXTI2_TS_IRQHandler(void)
+#else
+void EXTI2_IRQHandler(void)
+#endif
+{
+  EXTI_Buttons_IRQHandler();
+}
+
+/*******************************************************************************
+* Function Name  : EXTI3_IRQHandler
+* Description    : This function handles External line 3 interrupt request.
+* Input          : None
+* Output         : None
+* Return         : None
+*******************************************************************************/
+void EXTI3_IRQHandler(void)
+{
+  EXTI_Buttons_IRQHandler();
+}
+
+/*******************************************************************************
+* Function Name  : EXTI4_IRQHandler
+* Description    : This function handles External line 4 interrupt request.
+* Input          : None
+* Output         : None
+* Return         : None
+*******************************************************************************/
+void EXTI4_IRQHandler(void)
+{
+  EXTI_Buttons_IRQHandler();
+}
+
+/*******************************************************************************
+* Function Name  : EXTI9_5_IRQHandler
+* Description    : This function handles External lines 9-5 interrupt request.
+* Input          : None
+* Output         : None
+* Return         : None
+*******************************************************************************/
+void EXTI9_5_IRQHandler(void)
+{
+  EXTI_Buttons_IRQHandler();
+}
+
+/*******************************************************************************
+* Function Name  : EXTI15_10_IRQHandler
+* Description    : This function handles External lines 15-10 interrupt request.
+* Input          : None
+* Output         : None
+* Return         : None
+*******************************************************************************/
+void EXTI15_10_IRQHandler(void)
+{
+  EXTI_Buttons_IRQHandler();
 }
 
 /*******************************************************************************
@@ -113,7 +113,7 @@ const uint8_t Joystick_ConfigDescriptor[JOYSTICK_SIZ_CONFIG_DESC] =
     0x03,          /*bmAttributes: Interrupt endpoint*/
     0x04,          /*wMaxPacketSize: 4 Byte max */
     0x00,
-    0x20,          /*bInterval: Polling Interval (32 ms)*/
+    0x01,          /*bInterval: Polling Interval (1 ms)*/
     /* 34 */
   }
   ; /* MOUSE_ConfigDescriptor */
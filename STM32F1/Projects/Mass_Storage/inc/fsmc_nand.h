@@ -79,12 +79,14 @@ typedef struct
 #define NAND_BUSY                  ((uint32_t)0x00000000)
 #define NAND_ERROR                 ((uint32_t)0x00000001)
 #define NAND_READY                 ((uint32_t)0x00000040)
+#define NAND_ECC_ERROR             ((uint32_t)0x00000800) /* more than one bit wrong */
 
 /* FSMC NAND memory parameters */
 #define NAND_PAGE_SIZE             ((uint16_t)0x0200) /* 512 bytes per page w/o Spare Area */
 #define NAND_BLOCK_SIZE            ((uint16_t)0x0020) /* 32x512 bytes pages per block */
 #define NAND_ZONE_SIZE             ((uint16_t)0x0400) /* 1024 Block per zone */
 #define NAND_SPARE_AREA_SIZE       ((uint16_t)0x0010) /* last 16 bytes as spare area */
+#define NAND_SPARE_ECC_OFFSET      ((uint16_t)0x0008) /* page ECC in the spare area, after SPARE_AREA */
 #define NAND_MAX_ZONE              ((uint16_t)0x0004) /* 4 zones of 1024 block */
 
 /* FSMC NAND memory address computation */
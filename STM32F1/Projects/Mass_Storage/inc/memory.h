@@ -37,10 +37,17 @@
 #define TXFR_IDLE     0
 #define TXFR_ONGOING  1
 
+/* Blocks moved by one MAL_Read or MAL_Write, the size of each of the two
+   transfer buffers. A write fills one buffer while the other one is written */
+#ifndef MASS_TRANSFER_BLOCKS
+#define MASS_TRANSFER_BLOCKS  8
+#endif
+
 /* Exported macro ------------------------------------------------------------*/
 /* Exported functions ------------------------------------------------------- */
 void Write_Memory (uint8_t lun, uint32_t Memory_Offset, uint32_t Transfer_Length);
 void Read_Memory (uint8_t lun, uint32_t Memory_Offset, uint32_t Transfer_Length);
+void Write_Memory_Resume(void);
 #endif /* __memory_H */
 
 /************************ (C) COPYRIGHT STMicroelectronics *****END OF FILE****/
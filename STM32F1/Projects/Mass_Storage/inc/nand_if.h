@@ -68,6 +68,10 @@ typedef enum {
 //#define WEAR_LEVELLING_SUPPORT
 #define WEAR_DEPTH         10
 #define PAGE_TO_WRITE      (Transfer_Length/512)
+/* ms without a write after which the cache is flushed by NAND_Idle */
+#ifndef NAND_CACHE_IDLE_TIME
+#define NAND_CACHE_IDLE_TIME  500
+#endif
 /* Private variables ----------------------------------------------------------*/
 /* Private function prototypes ------------------------------------------------*/
 /* exported functions ---------------------------------------------------------*/
@@ -75,6 +79,9 @@ uint16_t NAND_Init (void);
 uint16_t NAND_Write (uint32_t Memory_Offset, uint32_t *Writebuff, uint16_t Transfer_Length);
 uint16_t NAND_Read  (uint32_t Memory_Offset, uint32_t *Readbuff, uint16_t Transfer_Length);
 uint16_t NAND_Format (void);
+uint16_t NAND_Flush (void);
+void NAND_Idle (void);
+void NAND_Tick (void);
 SPARE_AREA ReadSpareArea (uint32_t address);
 #endif
 /************************ (C) COPYRIGHT STMicroelectronics *****END OF FILE****/
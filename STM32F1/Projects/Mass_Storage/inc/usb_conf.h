@@ -57,6 +57,9 @@
 
 
 /* ISTR events */
+/* The SOF resumes a write held by Write_Memory() */
+#define SOF_CALLBACK
+
 /* IMR_MSK */
 /* mask defining which events has to be handled */
 /* by the device application software */
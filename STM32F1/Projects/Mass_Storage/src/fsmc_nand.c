@@ -41,6 +41,8 @@
 
 /* Private variables ---------------------------------------------------------*/
 /* Private function prototypes -----------------------------------------------*/
+static uint32_t FSMC_NAND_CorrectECC(uint8_t *pPage, uint32_t StoredECC, uint32_t ComputedECC);
+
 /* Private functions ---------------------------------------------------------*/
 /*******************************************************************************
 * Function Name  : FSMC_NAND_Init
@@ -153,6 +155,7 @@ uint32_t FSMC_NAND_WriteSmallPage(uint8_t *pBuffer, NAND_ADDRESS Address, uint32
 {
   uint32_t index = 0x00, numpagewritten = 0x00, addressstatus = NAND_VALID_ADDRESS;
   uint32_t status = NAND_READY, size = 0x00;
+  uint32_t ecc = 0x00, spareindex = 0x00;
 
   while((NumPageToWrite != 0x00) && (addressstatus == NAND_VALID_ADDRESS) && (status == NAND_READY))
   {
@@ -168,12 +171,35 @@ uint32_t FSMC_NAND_WriteSmallPage(uint8_t *pBuffer, NAND_ADDRESS Address, uint32
     /* Calculate the size */
     size = NAND_PAGE_SIZE + (NAND_PAGE_SIZE * numpagewritten);
 
+    /* Restart the ECC of the FSMC, it covers the next 512 bytes */
+    FSMC_NANDECCCmd(FSMC_Bank_NAND, DISABLE);
+    FSMC_NANDECCCmd(FSMC_Bank_NAND, ENABLE);
+
     /* Write data */
     for(; index < size; index++)
     {
       *(__IO uint8_t *)(Bank_NAND_ADDR | DATA_AREA) = pBuffer[index];
     }
-    
+
+    while(FSMC_GetFlagStatus(FSMC_Bank_NAND, FSMC_FLAG_FEMPT) == RESET)
+    {
+    }
+    ecc = FSMC_GetECC(FSMC_Bank_NAND);
+
+    /* The spare area goes on with the page, only the ECC is programmed and
+       the SPARE_AREA fields are left erased */
+    for(spareindex = 0; spareindex < NAND_SPARE_AREA_SIZE; spareindex++)
+    {
+      if((spareindex >= NAND_SPARE_ECC_OFFSET) && (spareindex < NAND_SPARE_ECC_OFFSET + 4))
+      {
+        *(__IO uint8_t *)(Bank_NAND_ADDR | DATA_AREA) = (uint8_t)(ecc >> (8 * (spareindex - NAND_SPARE_ECC_OFFSET)));
+      }
+      else
+      {
+        *(__IO uint8_t *)(Bank_NAND_ADDR | DATA_AREA) = 0xFF;
+      }
+    }
+
     *(__IO uint8_t *)(Bank_NAND_ADDR | CMD_AREA) = NAND_CMD_WRITE_TRUE1;
 
     /* Check status for successful operation */
@@ -213,6 +239,8 @@ uint32_t FSMC_NAND_ReadSmallPage(uint8_t *pBuffer, NAND_ADDRESS Address, uint32_
 {
   uint32_t index = 0x00, numpageread = 0x00, addressstatus = NAND_VALID_ADDRESS;
   uint32_t status = NAND_READY, size = 0x00;
+  uint32_t ecc = 0x00, storedecc = 0x00, spareindex = 0x00, eccstatus = 0x00;
+  uint8_t data;
 
   while((NumPageToRead != 0x0) && (addressstatus == NAND_VALID_ADDRESS))
   {	   
@@ -228,13 +256,32 @@ uint32_t FSMC_NAND_ReadSmallPage(uint8_t *pBuffer, NAND_ADDRESS Address, uint32_
 
     /* Calculate the size */
     size = NAND_PAGE_SIZE + (NAND_PAGE_SIZE * numpageread);
-    
+
+    /* Restart the ECC of the FSMC, it covers the next 512 bytes */
+    FSMC_NANDECCCmd(FSMC_Bank_NAND, DISABLE);
+    FSMC_NANDECCCmd(FSMC_Bank_NAND, ENABLE);
+
     /* Get Data into Buffer */    
     for(; index < size; index++)
     {
       pBuffer[index]= *(__IO uint8_t *)(Bank_NAND_ADDR | DATA_AREA);
     }
 
+    ecc = FSMC_GetECC(FSMC_Bank_NAND);
+
+    /* The spare area follows, with the ECC stored by the page program */
+    storedecc = 0x00;
+    for(spareindex = 0; spareindex < NAND_SPARE_AREA_SIZE; spareindex++)
+    {
+      data = *(__IO uint8_t *)(Bank_NAND_ADDR | DATA_AREA);
+      if((spareindex >= NAND_SPARE_ECC_OFFSET) && (spareindex < NAND_SPARE_ECC_OFFSET + 4))
+      {
+        storedecc |= (uint32_t)data << (8 * (spareindex - NAND_SPARE_ECC_OFFSET));
+      }
+    }
+
+    eccstatus |= FSMC_NAND_CorrectECC(pBuffer + index - NAND_PAGE_SIZE, storedecc, ecc);
+
     numpageread++;
     
     NumPageToRead--;
@@ -245,7 +292,60 @@ uint32_t FSMC_NAND_ReadSmallPage(uint8_t *pBuffer, NAND_ADDRESS Address, uint32_
 
   status = FSMC_NAND_GetStatus();
   
-  return (status | addressstatus);
+  return (status | addressstatus | eccstatus);
+}
+
+/******************************************************************************
+* Function Name  : FSMC_NAND_CorrectECC
+* Description    : Checks a page read against the ECC stored when it was
+*                  programmed and corrects a single bit error. The odd bits of
+*                  the difference give the byte (bits 7 to 23) and the bit
+*                  (bits 1 to 5) of the error.
+* Input          : - pPage: page read
+*                  - StoredECC: ECC read from the spare area
+*                  - ComputedECC: ECC of the FSMC for the page read
+* Output         : None
+* Return         : 0 when the page is right or corrected, NAND_ECC_ERROR when
+*                  more than one bit is wrong
+*******************************************************************************/
+static uint32_t FSMC_NAND_CorrectECC(uint8_t *pPage, uint32_t StoredECC, uint32_t ComputedECC)
+{
+  uint32_t syndrome, position = 0x00, bit;
+
+  /* A page programmed without an ECC, e.g. erased */
+  if(StoredECC == 0xFFFFFFFF)
+  {
+    return 0x00;
+  }
+
+  syndrome = (StoredECC ^ ComputedECC) & 0x00FFFFFF;
+
+  if(syndrome == 0x00)
+  {
+    return 0x00;
+  }
+
+  /* A single bit error in the data flips one bit of every pair */
+  if(((syndrome ^ (syndrome >> 1)) & 0x00555555) == 0x00555555)
+  {
+    for(bit = 0; bit < 12; bit++)
+    {
+      if(syndrome & (1 << (2 * bit + 1)))
+      {
+        position |= 1 << bit;
+      }
+    }
+    pPage[position >> 3] ^= 1 << (position & 0x07);
+    return 0x00;
+  }
+
+  /* A single bit error in the ECC itself, the data is right */
+  if((syndrome & (syndrome - 1)) == 0x00)
+  {
+    return 0x00;
+  }
+
+  return NAND_ECC_ERROR;
 }
 
 /******************************************************************************
@@ -419,6 +419,11 @@ void MAL_Config(void)
   RCC_AHBPeriphClockCmd(RCC_AHBPeriph_FSMC, ENABLE);
   MAL_Init(1);
 #endif /* STM32F10X_HD | STM32F10X_XL */
+
+#ifdef USE_STM3210E_EVAL
+  /* 1 ms SysTick for the idle time of the NAND cache */
+  SysTick_Config(SystemCoreClock / 1000);
+#endif /* USE_STM3210E_EVAL */
 }
 
 #if !defined (USE_STM32L152_EVAL) 
@@ -59,7 +59,12 @@ int main(void)
   USB_Configured_LED();
 
   while (1)
-  {}
+  {
+#ifdef USE_STM3210E_EVAL
+    /* Write the NAND cache once the host stops writing */
+    NAND_Idle();
+#endif /* USE_STM3210E_EVAL */
+  }
 }
 
 #ifdef USE_FULL_ASSERT
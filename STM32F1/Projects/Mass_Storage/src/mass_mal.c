@@ -38,12 +38,26 @@ uint32_t Mass_Memory_Size[2];
 uint32_t Mass_Block_Size[2];
 uint32_t Mass_Block_Count[2];
 __IO uint32_t Status = 0;
+/* Result of MAL_ReadStart, and a SDIO read in progress */
+static uint16_t Read_Status = MAL_OK;
+#if defined(USE_STM3210E_EVAL) || defined(USE_STM32L152D_EVAL)
+static __IO uint8_t Read_Pending = 0;
+#endif
+/* Result of the writes since MAL_WriteWait, and the SDIO writes queued */
+static __IO uint16_t Write_Status = MAL_OK;
+#ifdef USE_STM3210E_EVAL
+static __IO uint8_t Write_Pending = 0;
+#endif
 
 #if defined(USE_STM3210E_EVAL) || defined(USE_STM32L152D_EVAL)
 SD_CardInfo mSDCardInfo;
 #endif
 
 /* Private function prototypes -----------------------------------------------*/
+#ifdef USE_STM3210E_EVAL
+static void MAL_ReadDone(SD_Error Status, uint8_t *Buffer);
+static void MAL_WriteDone(SD_Error Status, uint8_t *Buffer);
+#endif
 /* Private functions ---------------------------------------------------------*/
 /*******************************************************************************
 * Function Name  : MAL_Init
@@ -73,18 +87,23 @@ uint16_t MAL_Init(uint8_t lun)
 }
 /*******************************************************************************
 * Function Name  : MAL_Write
-* Description    : Write sectors
+* Description    : Write sectors, Transfer_Length bytes are a whole number of
+*                  blocks written with one multiple block command.
 * Input          : None
 * Output         : None
 * Return         : None
 *******************************************************************************/
 uint16_t MAL_Write(uint8_t lun, uint32_t Memory_Offset, uint32_t *Writebuff, uint16_t Transfer_Length)
 {
+#ifdef USE_STM3210E_EVAL
+  uint16_t i;
+#endif
 
   switch (lun)
   {
     case 0:
-    Status = SD_WriteMultiBlocks((uint8_t*)Writebuff, Memory_Offset, Transfer_Length,1);
+    Status = SD_WriteMultiBlocks((uint8_t*)Writebuff, Memory_Offset, Mass_Block_Size[0],
+                                 Transfer_Length / Mass_Block_Size[0]);
 #if defined(USE_STM3210E_EVAL) || defined(USE_STM32L152D_EVAL)
     Status = SD_WaitWriteOperation();  
     while(SD_GetStatus() != SD_TRANSFER_OK);
@@ -96,7 +115,11 @@ uint16_t MAL_Write(uint8_t lun, uint32_t Memory_Offset, uint32_t *Writebuff, uin
       break;
 #ifdef USE_STM3210E_EVAL
     case 1:
-      NAND_Write(Memory_Offset, Writebuff, Transfer_Length);
+      /* The NAND is written one page at a time */
+      for (i = 0; i < Transfer_Length; i += Mass_Block_Size[1])
+      {
+        NAND_Write(Memory_Offset + i, Writebuff + i / 4, Mass_Block_Size[1]);
+      }
       break;
 #endif /* USE_STM3210E_EVAL */  
     default:
@@ -107,19 +130,24 @@ uint16_t MAL_Write(uint8_t lun, uint32_t Memory_Offset, uint32_t *Writebuff, uin
 
 /*******************************************************************************
 * Function Name  : MAL_Read
-* Description    : Read sectors
+* Description    : Read sectors, Transfer_Length bytes are a whole number of
+*                  blocks read with one multiple block command.
 * Input          : None
 * Output         : None
 * Return         : Buffer pointer
 *******************************************************************************/
 uint16_t MAL_Read(uint8_t lun, uint32_t Memory_Offset, uint32_t *Readbuff, uint16_t Transfer_Length)
 {
+#ifdef USE_STM3210E_EVAL
+  uint16_t i;
+#endif
 
   switch (lun)
   {
     case 0:
 
-      SD_ReadMultiBlocks((uint8_t*)Readbuff, Memory_Offset, Transfer_Length, 1);
+      SD_ReadMultiBlocks((uint8_t*)Readbuff, Memory_Offset, Mass_Block_Size[0],
+                         Transfer_Length / Mass_Block_Size[0]);
 #if defined(USE_STM3210E_EVAL) || defined(USE_STM32L152D_EVAL)
       Status = SD_WaitReadOperation();
       while(SD_GetStatus() != SD_TRANSFER_OK)
@@ -134,8 +162,14 @@ uint16_t MAL_Read(uint8_t lun, uint32_t Memory_Offset, uint32_t *Readbuff, uint1
       break;
 #ifdef USE_STM3210E_EVAL
     case 1:
-      NAND_Read(Memory_Offset, Readbuff, Transfer_Length);
-      ;
+      /* The NAND is read one page at a time */
+      for (i = 0; i < Transfer_Length; i += Mass_Block_Size[1])
+      {
+        if (NAND_Read(Memory_Offset + i, Readbuff + i / 4, Mass_Block_Size[1]) != NAND_OK)
+        {
+          return MAL_FAIL;
+        }
+      }
       break;
 #endif
     default:
@@ -144,6 +178,235 @@ uint16_t MAL_Read(uint8_t lun, uint32_t Memory_Offset, uint32_t *Readbuff, uint1
   return MAL_OK;
 }
 
+/*******************************************************************************
+* Function Name  : MAL_ReadStart
+* Description    : Start reading sectors, MAL_ReadWait() waits for the end of
+*                  the read. The SDIO cards are read by DMA meanwhile, the
+*                  other media are read before returning.
+* Input          : None
+* Output         : None
+* Return         : None
+*******************************************************************************/
+void MAL_ReadStart(uint8_t lun, uint32_t Memory_Offset, uint32_t *Readbuff, uint16_t Transfer_Length)
+{
+#if defined(USE_STM3210E_EVAL)
+  if (lun == 0)
+  {
+    /* MAL_ReadDone() may run before SD_StreamRead() returns */
+    Read_Status = MAL_OK;
+    Read_Pending = 1;
+    Status = SD_StreamRead((uint8_t*)Readbuff, Memory_Offset,
+                           Transfer_Length / Mass_Block_Size[0], MAL_ReadDone);
+    if (Status != SD_OK)
+    {
+      Read_Status = MAL_FAIL;
+      Read_Pending = 0;
+    }
+    return;
+  }
+#elif defined(USE_STM32L152D_EVAL)
+  if (lun == 0)
+  {
+    Status = SD_ReadMultiBlocks((uint8_t*)Readbuff, Memory_Offset, Mass_Block_Size[0],
+                                Transfer_Length / Mass_Block_Size[0]);
+    Read_Status = (Status == SD_OK) ? MAL_OK : MAL_FAIL;
+    Read_Pending = (Status == SD_OK);
+    return;
+  }
+#endif /* USE_STM3210E_EVAL || USE_STM32L152D_EVAL */
+  Read_Status = MAL_Read(lun, Memory_Offset, Readbuff, Transfer_Length);
+}
+
+/*******************************************************************************
+* Function Name  : MAL_ReadWait
+* Description    : Wait for the end of the read started by MAL_ReadStart()
+* Input          : None
+* Output         : None
+* Return         : MAL_OK or MAL_FAIL
+*******************************************************************************/
+uint16_t MAL_ReadWait(uint8_t lun)
+{
+  (void) lun;
+
+#if defined(USE_STM3210E_EVAL)
+  /* Cleared by MAL_ReadDone() from the SDIO interrupt */
+  while (Read_Pending)
+  {
+  }
+#elif defined(USE_STM32L152D_EVAL)
+  if (Read_Pending)
+  {
+    Read_Pending = 0;
+    Status = SD_WaitReadOperation();
+    while(SD_GetStatus() != SD_TRANSFER_OK)
+    {
+    }
+
+    if ( Status != SD_OK )
+    {
+      Read_Status = MAL_FAIL;
+    }
+  }
+#endif /* USE_STM3210E_EVAL || USE_STM32L152D_EVAL */
+  return Read_Status;
+}
+
+#ifdef USE_STM3210E_EVAL
+/*******************************************************************************
+* Function Name  : MAL_ReadDone
+* Description    : End of the SD card read started by MAL_ReadStart()
+* Input          : - Status: result of the read.
+*                  - Buffer: data read.
+* Output         : None
+* Return         : None
+*******************************************************************************/
+static void MAL_ReadDone(SD_Error Status, uint8_t *Buffer)
+{
+  (void) Buffer;
+
+  if (Status != SD_OK)
+  {
+    Read_Status = MAL_FAIL;
+  }
+  Read_Pending = 0;
+}
+#endif /* USE_STM3210E_EVAL */
+
+/*******************************************************************************
+* Function Name  : MAL_WriteStart
+* Description    : Start writing sectors, the buffer can't be changed until
+*                  MAL_WritePending() tells the write has ended. The SDIO
+*                  cards are written by DMA meanwhile, one write after the
+*                  other, the other media are written before returning.
+* Input          : None
+* Output         : None
+* Return         : None
+*******************************************************************************/
+void MAL_WriteStart(uint8_t lun, uint32_t Memory_Offset, uint32_t *Writebuff, uint16_t Transfer_Length)
+{
+#ifdef USE_STM3210E_EVAL
+  uint32_t primask;
+
+  if (lun == 0)
+  {
+    /* MAL_WriteDone() may run before SD_StreamWrite() returns */
+    primask = __get_PRIMASK();
+    __disable_irq();
+    Write_Pending++;
+    __set_PRIMASK(primask);
+
+    Status = SD_StreamWrite((uint8_t*)Writebuff, Memory_Offset,
+                            Transfer_Length / Mass_Block_Size[0], MAL_WriteDone);
+    if (Status != SD_OK)
+    {
+      Write_Status = MAL_FAIL;
+      primask = __get_PRIMASK();
+      __disable_irq();
+      Write_Pending--;
+      __set_PRIMASK(primask);
+    }
+    return;
+  }
+#endif /* USE_STM3210E_EVAL */
+  if (MAL_Write(lun, Memory_Offset, Writebuff, Transfer_Length) != MAL_OK)
+  {
+    Write_Status = MAL_FAIL;
+  }
+}
+
+/*******************************************************************************
+* Function Name  : MAL_WritePending
+* Description    : Number of writes started by MAL_WriteStart() whose data
+*                  are not all sent yet. The next queued write starts from
+*                  here once the card has programmed the last one.
+* Input          : None
+* Output         : None
+* Return         : Writes still using their buffer
+*******************************************************************************/
+uint8_t MAL_WritePending(uint8_t lun)
+{
+#ifdef USE_STM3210E_EVAL
+  if (lun == 0)
+  {
+    SD_StreamTasks();
+    return Write_Pending;
+  }
+#endif /* USE_STM3210E_EVAL */
+  (void) lun;
+  return 0;
+}
+
+/*******************************************************************************
+* Function Name  : MAL_WriteWait
+* Description    : Wait for the end of the writes started by MAL_WriteStart(),
+*                  the card included
+* Input          : None
+* Output         : None
+* Return         : MAL_OK or MAL_FAIL if any of the writes failed
+*******************************************************************************/
+uint16_t MAL_WriteWait(uint8_t lun)
+{
+  uint16_t status;
+
+#ifdef USE_STM3210E_EVAL
+  if (lun == 0)
+  {
+    /* SD_StreamIdle() starts the queued writes as the card gets ready */
+    while (!SD_StreamIdle())
+    {
+    }
+  }
+#endif /* USE_STM3210E_EVAL */
+  (void) lun;
+
+  status = Write_Status;
+  Write_Status = MAL_OK;
+  return status;
+}
+
+#ifdef USE_STM3210E_EVAL
+/*******************************************************************************
+* Function Name  : MAL_WriteDone
+* Description    : End of the SD card write started by MAL_WriteStart(), its
+*                  buffer can be reused
+* Input          : - Status: result of the write.
+*                  - Buffer: data written.
+* Output         : None
+* Return         : None
+*******************************************************************************/
+static void MAL_WriteDone(SD_Error Status, uint8_t *Buffer)
+{
+  (void) Buffer;
+
+  if (Status != SD_OK)
+  {
+    Write_Status = MAL_FAIL;
+  }
+  Write_Pending--;
+}
+#endif /* USE_STM3210E_EVAL */
+
+/*******************************************************************************
+* Function Name  : MAL_Flush
+* Description    : Write the sectors kept in RAM to the media
+* Input          : None
+* Output         : None
+* Return         : Status
+*******************************************************************************/
+uint16_t MAL_Flush(uint8_t lun)
+{
+#ifdef USE_STM3210E_EVAL
+  if (lun == 1)
+  {
+    if (NAND_Flush() != NAND_OK)
+    {
+      return MAL_FAIL;
+    }
+  }
+#endif
+  return MAL_OK;
+}
+
 /*******************************************************************************
 * Function Name  : MAL_GetStatus
 * Description    : Get status
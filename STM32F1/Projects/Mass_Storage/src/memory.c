@@ -46,7 +46,19 @@ __IO uint32_t Block_Read_count = 0;
 __IO uint32_t Block_offset;
 __IO uint32_t Counter = 0;
 uint32_t  Idx;
-uint32_t Data_Buffer[BULK_MAX_PACKET_SIZE *2]; /* 512 bytes*/
+uint32_t Data_Buffer[2][MASS_TRANSFER_BLOCKS * BULK_MAX_PACKET_SIZE * 2]; /* 2 x MASS_TRANSFER_BLOCKS x 512 bytes*/
+/* Buffer being sent from Data_Buffer, the other one is read meanwhile */
+static uint8_t Read_Index = 0;
+static uint8_t Read_Ahead = 0;
+/* Bytes in the buffer being sent and in the one read ahead */
+static uint32_t Read_Length = 0;
+static uint32_t Ahead_Length = 0;
+/* Buffer filled from the OUT packets, the other one may be written meanwhile */
+static uint8_t Write_Index = 0;
+/* The OUT endpoint NAKs until a buffer is free, see Write_Memory_Resume() */
+static uint8_t Write_Held = 0;
+/* Media of the write in progress */
+static uint8_t Write_Lun = 0;
 uint8_t TransferState = TXFR_IDLE;
 /* Extern variables ----------------------------------------------------------*/
 extern uint8_t Bulk_Data_Buff[BULK_MAX_PACKET_SIZE];  /* data buffer*/
@@ -61,6 +73,21 @@ extern uint32_t Mass_Block_Size[2];
 /* Extern function prototypes ------------------------------------------------*/
 /* Private functions ---------------------------------------------------------*/
 
+/*******************************************************************************
+* Function Name  : Transfer_Chunk
+* Description    : Bytes of the next MAL transfer, up to MASS_TRANSFER_BLOCKS
+*                  blocks.
+* Input          : Bytes left in the SCSI transfer.
+* Output         : None.
+* Return         : Bytes to move.
+*******************************************************************************/
+static uint32_t Transfer_Chunk(uint8_t lun, uint32_t Length)
+{
+  uint32_t chunk = MASS_TRANSFER_BLOCKS * Mass_Block_Size[lun];
+
+  return (Length < chunk) ? Length : chunk;
+}
+
 /*******************************************************************************
 * Function Name  : Read_Memory
 * Description    : Handle the Read operation from the microSD card.
@@ -77,25 +104,56 @@ void Read_Memory(uint8_t lun, uint32_t Memory_Offset, uint32_t Transfer_Length)
     Offset = Memory_Offset * Mass_Block_Size[lun];
     Length = Transfer_Length * Mass_Block_Size[lun];
     TransferState = TXFR_ONGOING;
+
+    /* Drop the blocks read ahead for a transfer that was aborted */
+    if (Read_Ahead)
+    {
+      MAL_ReadWait(lun);
+      Read_Ahead = 0;
+    }
+    Read_Index = 0;
   }
 
   if (TransferState == TXFR_ONGOING )
   {
     if (!Block_Read_count)
     {
-      MAL_Read(lun ,
-               Offset ,
-               Data_Buffer,
-               Mass_Block_Size[lun]);
+      if (Read_Ahead)
+      {
+        /* The blocks were read in the other buffer while the last ones were sent */
+        MAL_ReadWait(lun);
+        Read_Ahead = 0;
+        Read_Index ^= 1;
+        Read_Length = Ahead_Length;
+      }
+      else
+      {
+        Read_Length = Transfer_Chunk(lun, Length);
+        MAL_Read(lun ,
+                 Offset ,
+                 Data_Buffer[Read_Index],
+                 Read_Length);
+      }
+
+      /* Start reading the next blocks, it goes on while these ones are sent */
+      if (Length > Read_Length)
+      {
+        Ahead_Length = Transfer_Chunk(lun, Length - Read_Length);
+        MAL_ReadStart(lun ,
+                      Offset + Read_Length ,
+                      Data_Buffer[Read_Index ^ 1],
+                      Ahead_Length);
+        Read_Ahead = 1;
+      }
 
-      USB_SIL_Write(EP1_IN, (uint8_t *)Data_Buffer, BULK_MAX_PACKET_SIZE);
+      USB_SIL_Write(EP1_IN, (uint8_t *)Data_Buffer[Read_Index], BULK_MAX_PACKET_SIZE);
 
-      Block_Read_count = Mass_Block_Size[lun] - BULK_MAX_PACKET_SIZE;
+      Block_Read_count = Read_Length - BULK_MAX_PACKET_SIZE;
       Block_offset = BULK_MAX_PACKET_SIZE;
     }
     else
     {
-      USB_SIL_Write(EP1_IN, (uint8_t *)Data_Buffer + Block_offset, BULK_MAX_PACKET_SIZE);
+      USB_SIL_Write(EP1_IN, (uint8_t *)Data_Buffer[Read_Index] + Block_offset, BULK_MAX_PACKET_SIZE);
 
       Block_Read_count -= BULK_MAX_PACKET_SIZE;
       Block_offset += BULK_MAX_PACKET_SIZE;
@@ -114,6 +172,7 @@ void Read_Memory(uint8_t lun, uint32_t Memory_Offset, uint32_t Transfer_Length)
     Block_Read_count = 0;
     Block_offset = 0;
     Offset = 0;
+    Read_Index = 0;
     Bot_State = BOT_DATA_IN_LAST;
     TransferState = TXFR_IDLE;
     Led_RW_OFF();
@@ -122,7 +181,10 @@ void Read_Memory(uint8_t lun, uint32_t Memory_Offset, uint32_t Transfer_Length)
 
 /*******************************************************************************
 * Function Name  : Write_Memory
-* Description    : Handle the Write operation to the microSD card.
+* Description    : Handle the Write operation to the microSD card. The OUT
+*                  packets fill one of the two buffers of Data_Buffer while
+*                  the other one is written, and the endpoint is only left
+*                  NAKing when both buffers wait for the media.
 * Input          : None.
 * Output         : None.
 * Return         : None.
@@ -139,6 +201,8 @@ void Write_Memory (uint8_t lun, uint32_t Memory_Offset, uint32_t Transfer_Length
     W_Offset = Memory_Offset * Mass_Block_Size[lun];
     W_Length = Transfer_Length * Mass_Block_Size[lun];
     TransferState = TXFR_ONGOING;
+    Write_Index = 0;
+    Write_Lun = lun;
   }
 
   if (TransferState == TXFR_ONGOING )
@@ -146,33 +210,74 @@ void Write_Memory (uint8_t lun, uint32_t Memory_Offset, uint32_t Transfer_Length
 
     for (Idx = 0 ; Counter < temp; Counter++)
     {
-      *((uint8_t *)Data_Buffer + Counter) = Bulk_Data_Buff[Idx++];
+      *((uint8_t *)Data_Buffer[Write_Index] + Counter) = Bulk_Data_Buff[Idx++];
     }
 
     W_Offset += Data_Len;
     W_Length -= Data_Len;
 
-    if (!(W_Length % Mass_Block_Size[lun]))
+    /* The blocks are written together once the buffer is full or the
+       transfer ends, the next ones are received in the other buffer */
+    if ((W_Length == 0) || (Counter == MASS_TRANSFER_BLOCKS * Mass_Block_Size[lun]))
     {
+      MAL_WriteStart(lun ,
+                     W_Offset - Counter,
+                     Data_Buffer[Write_Index],
+                     Counter);
+      Write_Index ^= 1;
       Counter = 0;
-      MAL_Write(lun ,
-                W_Offset - Mass_Block_Size[lun],
-                Data_Buffer,
-                Mass_Block_Size[lun]);
     }
 
     CSW.dDataResidue -= Data_Len;
-    SetEPRxStatus(ENDP2, EP_RX_VALID); /* enable the next transaction*/   
     Led_RW_ON();
+
+    /* Both buffers are still being written, the next packet waits */
+    if ((W_Length != 0) && (MAL_WritePending(lun) > 1))
+    {
+      Write_Held = 1;
+    }
+    else
+    {
+      SetEPRxStatus(ENDP2, EP_RX_VALID); /* enable the next transaction*/
+    }
   }
 
   if ((W_Length == 0) || (Bot_State == BOT_CSW_Send))
   {
     Counter = 0;
-    Set_CSW (CSW_CMD_PASSED, SEND_CSW_ENABLE);
+    Write_Held = 0;
+
+    /* The status tells the blocks are on the media */
+    if (MAL_WriteWait(lun) != MAL_OK)
+    {
+      Set_Scsi_Sense_Data(lun, MEDIUM_ERROR, WRITE_ERROR);
+      Set_CSW (CSW_CMD_FAILED, SEND_CSW_ENABLE);
+    }
+    else
+    {
+      Set_CSW (CSW_CMD_PASSED, SEND_CSW_ENABLE);
+    }
     TransferState = TXFR_IDLE;
     Led_RW_OFF();
   }
 }
+
+/*******************************************************************************
+* Function Name  : Write_Memory_Resume
+* Description    : Called at each SOF. Keeps the queued writes going while no
+*                  packet comes, and accepts the next OUT packet of a write
+*                  held by Write_Memory() once the older buffer is written.
+* Input          : None.
+* Output         : None.
+* Return         : None.
+*******************************************************************************/
+void Write_Memory_Resume(void)
+{
+  if ((TransferState == TXFR_ONGOING) && (MAL_WritePending(Write_Lun) < 2) && Write_Held)
+  {
+    Write_Held = 0;
+    SetEPRxStatus(ENDP2, EP_RX_VALID);
+  }
+}
 /************************ (C) COPYRIGHT STMicroelectronics *****END OF FILE****/
 
@@ -33,11 +33,22 @@
 #include "mass_mal.h"
 #include "fsmc_nand.h"
 #include "memory.h"
+#include <string.h>
 /* Private typedef -----------------------------------------------------------*/
 /* Private define ------------------------------------------------------------*/
+#define CACHE_ALL_PAGES   ((uint32_t)0xFFFFFFFF >> (32 - NAND_BLOCK_SIZE))
+
+/* Block of every zone keeping the checkpoint of the zone map: its first
+   MAP_PAGES pages hold the map, the spare areas of the next pages hold the
+   journal of the changes made since then */
+#define MAP_BLOCK         (MAX_PHY_BLOCKS_PER_ZONE - 1)
+#define MAP_PAGES         (MAX_PHY_BLOCKS_PER_ZONE * 2 / NAND_PAGE_SIZE)
+#define MAP_SIGNATURE     0x4D50
+#define JOURNAL_SIGNATURE 0x4A4C
+/* Zone map values, other ones are the logical index of the spare area */
+#define MAP_BAD_BLOCK     0x0000
+#define MAP_FREE_BLOCK    0xFFFF
 /* extern variables-----------------------------------------------------------*/
-extern uint32_t SCSI_LBA;
-extern uint32_t SCSI_BlkLen;
 /* Private variables ---------------------------------------------------------*/
 uint16_t LUT[1024]; //Look Up Table Buffer
 WRITE_STATE Write_State;
@@ -45,6 +56,21 @@ BLOCK_STATE Block_State;
 NAND_ADDRESS wAddress, fAddress;
 uint16_t  phBlock, LogAddress, Initial_Page, CurrentZone = 0;
 uint16_t  Written_Pages = 0;
+/* Pages programmed by the write going on */
+static uint16_t Program_Pages = 0;
+
+/* Write back cache of one logical block, the host sectors written in it are
+   merged and the block is programmed once by NAND_Flush */
+static uint32_t Cache_Buffer[NAND_BLOCK_SIZE][NAND_PAGE_SIZE / 4];
+static uint32_t Cache_Dirty = 0;   /* one bit per page of the block */
+static uint32_t Cache_Page;        /* first page of the block */
+static __IO uint32_t Cache_Idle = 0;
+
+/* Logical index in the spare area of every physical block of CurrentZone,
+   the LUT is built from it */
+static uint16_t Zone_Map[MAX_PHY_BLOCKS_PER_ZONE];
+static uint16_t Map_Generation = 0;
+static uint16_t Journal_Page = NAND_BLOCK_SIZE;
 
 uint16_t LUT[1024]; //Look Up Table Buffer
 /* Private function prototypes -----------------------------------------------*/
@@ -57,6 +83,13 @@ SPARE_AREA ReadSpareArea(uint32_t address);
 static uint16_t NAND_Copy(NAND_ADDRESS Address_Src, NAND_ADDRESS Address_Dest, uint16_t PageToCopy);
 static NAND_ADDRESS NAND_ConvertPhyAddress(uint32_t Address);
 static uint16_t NAND_BuildLUT(uint8_t ZoneNbr);
+static uint16_t NAND_MapToLUT(void);
+static uint16_t NAND_LoadMap(uint8_t ZoneNbr);
+static void NAND_ScanMap(uint8_t ZoneNbr);
+static void NAND_SaveMap(uint8_t ZoneNbr);
+static void NAND_JournalMap(uint8_t ZoneNbr, uint16_t Block1, uint16_t Block2);
+static uint16_t NAND_Program(uint32_t Memory_Offset, uint32_t *Writebuff, uint16_t Transfer_Length);
+static uint16_t NAND_ReadPages(uint32_t Memory_Offset, uint32_t *Readbuff, uint16_t Transfer_Length);
 
 /*******************************************************************************
 * Function Name  : NAND_Init
@@ -77,12 +110,135 @@ uint16_t NAND_Init(void)
 
 /*******************************************************************************
 * Function Name  : NAND_Write
-* Description    : write one sector by once
+* Description    : Write sectors in the cache. The cache is flushed first when
+*                  the sectors are in another block, and at once when the
+*                  whole block is written.
 * Input          : None
 * Output         : None
 * Return         : Status
 *******************************************************************************/
 uint16_t NAND_Write(uint32_t Memory_Offset, uint32_t *Writebuff, uint16_t Transfer_Length)
+{
+  uint32_t Page;
+  uint16_t Status = NAND_OK;
+
+  for (; Transfer_Length >= NAND_PAGE_SIZE; Transfer_Length -= NAND_PAGE_SIZE)
+  {
+    Page = Memory_Offset / NAND_PAGE_SIZE;
+
+    if (Cache_Dirty && ((Page & ~(NAND_BLOCK_SIZE - 1)) != Cache_Page))
+    {
+      Status |= NAND_Flush();
+    }
+    Cache_Page = Page & ~(NAND_BLOCK_SIZE - 1);
+
+    memcpy(Cache_Buffer[Page & (NAND_BLOCK_SIZE - 1)], Writebuff, NAND_PAGE_SIZE);
+    Cache_Dirty |= (uint32_t)1 << (Page & (NAND_BLOCK_SIZE - 1));
+
+    Memory_Offset += NAND_PAGE_SIZE;
+    Writebuff += NAND_PAGE_SIZE / 4;
+  }
+
+  Cache_Idle = NAND_CACHE_IDLE_TIME;
+
+  if (Cache_Dirty == CACHE_ALL_PAGES)
+  {
+    Status |= NAND_Flush();
+  }
+  return Status;
+}
+
+/*******************************************************************************
+* Function Name  : NAND_Flush
+* Description    : Program the sectors of the cache. The pages between the
+*                  first and the last written ones that were not written are
+*                  read first, so the block is rewritten once.
+* Input          : None
+* Output         : None
+* Return         : Status
+*******************************************************************************/
+uint16_t NAND_Flush(void)
+{
+  uint16_t First, Last, Index;
+
+  if (!Cache_Dirty)
+  {
+    return NAND_OK;
+  }
+
+  for (First = 0; !(Cache_Dirty & ((uint32_t)1 << First)); First++)
+  {
+  }
+  for (Last = NAND_BLOCK_SIZE - 1; !(Cache_Dirty & ((uint32_t)1 << Last)); Last--)
+  {
+  }
+
+  for (Index = First; Index <= Last; Index++)
+  {
+    if (!(Cache_Dirty & ((uint32_t)1 << Index)))
+    {
+      NAND_ReadPages((Cache_Page + Index) * NAND_PAGE_SIZE, Cache_Buffer[Index], NAND_PAGE_SIZE);
+    }
+  }
+
+  Write_State = WRITE_IDLE;
+  Written_Pages = 0;
+  Program_Pages = Last - First + 1;
+  for (Index = First; Index <= Last; Index++)
+  {
+    NAND_Program((Cache_Page + Index) * NAND_PAGE_SIZE, Cache_Buffer[Index], NAND_PAGE_SIZE);
+  }
+
+  Cache_Dirty = 0;
+  return NAND_OK;
+}
+
+/*******************************************************************************
+* Function Name  : NAND_Idle
+* Description    : Flush the cache once no sector was written for
+*                  NAND_CACHE_IDLE_TIME ms. Called from the main loop, the USB
+*                  interrupt is masked during the flush.
+* Input          : None
+* Output         : None
+* Return         : None
+*******************************************************************************/
+void NAND_Idle(void)
+{
+  if (Cache_Dirty && (Cache_Idle == 0))
+  {
+    NVIC_DisableIRQ(USB_LP_CAN1_RX0_IRQn);
+    /* a write may have come just before */
+    if (Cache_Idle == 0)
+    {
+      NAND_Flush();
+    }
+    NVIC_EnableIRQ(USB_LP_CAN1_RX0_IRQn);
+  }
+}
+
+/*******************************************************************************
+* Function Name  : NAND_Tick
+* Description    : Count the idle time of the cache, called every ms.
+* Input          : None
+* Output         : None
+* Return         : None
+*******************************************************************************/
+void NAND_Tick(void)
+{
+  if (Cache_Idle)
+  {
+    Cache_Idle--;
+  }
+}
+
+/*******************************************************************************
+* Function Name  : NAND_Program
+* Description    : write one sector by once
+* Input          : None
+* Output         : None
+* Return         : Status
+*******************************************************************************/
+static uint16_t NAND_Program(uint32_t Memory_Offset, uint32_t *Writebuff, uint16_t Transfer_Length)
 {
   /* check block status and calculate start and end addresses */
   wAddress    = NAND_GetAddress(Memory_Offset / 512);
@@ -119,7 +275,7 @@ uint16_t NAND_Write(uint32_t Memory_Offset, uint32_t *Writebuff, uint16_t Transf
       wAddress.Block = phBlock & 0x3FF;
 
 
-      if (Written_Pages == SCSI_BlkLen)
+      if (Written_Pages == Program_Pages)
       {
         NAND_Write_Cleanup();
         Written_Pages = 0;
@@ -145,7 +301,7 @@ uint16_t NAND_Write(uint32_t Memory_Offset, uint32_t *Writebuff, uint16_t Transf
       FSMC_NAND_WriteSmallPage( (uint8_t *)Writebuff , wAddress, PAGE_TO_WRITE);
 
       Written_Pages++;
-      if (Written_Pages == SCSI_BlkLen)
+      if (Written_Pages == Program_Pages)
       {
         Written_Pages = 0;
         NAND_Write_Cleanup();
@@ -175,7 +331,7 @@ uint16_t NAND_Write(uint32_t Memory_Offset, uint32_t *Writebuff, uint16_t Transf
         /* write Last page  */
         FSMC_NAND_WriteSmallPage( (uint8_t *)Writebuff , fAddress, PAGE_TO_WRITE);
         Written_Pages++;
-        if (Written_Pages == SCSI_BlkLen)
+        if (Written_Pages == Program_Pages)
         {
           Written_Pages = 0;
         }
@@ -188,7 +344,7 @@ uint16_t NAND_Write(uint32_t Memory_Offset, uint32_t *Writebuff, uint16_t Transf
       /* write next page */
       FSMC_NAND_WriteSmallPage( (uint8_t *)Writebuff , fAddress, PAGE_TO_WRITE);
       Written_Pages++;
-      if (Written_Pages == SCSI_BlkLen)
+      if (Written_Pages == Program_Pages)
       {
         Write_State = WRITE_IDLE;
         NAND_Write_Cleanup();
@@ -205,7 +361,7 @@ uint16_t NAND_Write(uint32_t Memory_Offset, uint32_t *Writebuff, uint16_t Transf
         /* write Last page  */
         FSMC_NAND_WriteSmallPage( (uint8_t *)Writebuff , wAddress, PAGE_TO_WRITE);
         Written_Pages++;
-        if (Written_Pages == SCSI_BlkLen)
+        if (Written_Pages == Program_Pages)
         {
           Written_Pages = 0;
         }
@@ -221,7 +377,7 @@ uint16_t NAND_Write(uint32_t Memory_Offset, uint32_t *Writebuff, uint16_t Transf
       /* write next page in same block */
       FSMC_NAND_WriteSmallPage( (uint8_t *)Writebuff , wAddress, PAGE_TO_WRITE);
       Written_Pages++;
-      if (Written_Pages == SCSI_BlkLen)
+      if (Written_Pages == Program_Pages)
       {
         Write_State = WRITE_IDLE;
         NAND_Write_Cleanup();
@@ -234,12 +390,44 @@ uint16_t NAND_Write(uint32_t Memory_Offset, uint32_t *Writebuff, uint16_t Transf
 
 /*******************************************************************************
 * Function Name  : NAND_Read
-* Description    : Read sectors
+* Description    : Read sectors, the ones written in the cache are read from it
 * Input          : None
 * Output         : None
 * Return         : Status
 *******************************************************************************/
 uint16_t NAND_Read(uint32_t Memory_Offset, uint32_t *Readbuff, uint16_t Transfer_Length)
+{
+  uint32_t Page;
+  uint16_t Status = NAND_OK;
+
+  for (; Transfer_Length >= NAND_PAGE_SIZE; Transfer_Length -= NAND_PAGE_SIZE)
+  {
+    Page = Memory_Offset / NAND_PAGE_SIZE;
+
+    if (((Page & ~(NAND_BLOCK_SIZE - 1)) == Cache_Page) &&
+        (Cache_Dirty & ((uint32_t)1 << (Page & (NAND_BLOCK_SIZE - 1)))))
+    {
+      memcpy(Readbuff, Cache_Buffer[Page & (NAND_BLOCK_SIZE - 1)], NAND_PAGE_SIZE);
+    }
+    else
+    {
+      Status |= NAND_ReadPages(Memory_Offset, Readbuff, NAND_PAGE_SIZE);
+    }
+
+    Memory_Offset += NAND_PAGE_SIZE;
+    Readbuff += NAND_PAGE_SIZE / 4;
+  }
+  return Status;
+}
+
+/*******************************************************************************
+* Function Name  : NAND_ReadPages
+* Description    : Read sectors from the NAND
+* Input          : None
+* Output         : None
+* Return         : Status
+*******************************************************************************/
+static uint16_t NAND_ReadPages(uint32_t Memory_Offset, uint32_t *Readbuff, uint16_t Transfer_Length)
 {
   NAND_ADDRESS phAddress;
 
@@ -258,7 +446,10 @@ uint16_t NAND_Read(uint32_t Memory_Offset, uint32_t *Readbuff, uint16_t Transfer
   else
   {
     phAddress.Block = LUT [phAddress.Block] & ~ (USED_BLOCK | VALID_BLOCK);
-    FSMC_NAND_ReadSmallPage ( (uint8_t *)Readbuff , phAddress, Transfer_Length / 512);
+    if (FSMC_NAND_ReadSmallPage ( (uint8_t *)Readbuff , phAddress, Transfer_Length / 512) & NAND_ECC_ERROR)
+    {
+      return NAND_FAIL;
+    }
   }
   return NAND_OK;
 }
@@ -276,7 +467,7 @@ static uint16_t NAND_CleanLUT (uint8_t ZoneNbr)
   uint16_t BlockIdx, LUT_Item;
 #endif
   /* Rebuild the LUT for the current zone */
-  NAND_BuildLUT (ZoneNbr);
+  NAND_MapToLUT ();
 
 #ifdef WEAR_LEVELLING_SUPPORT
   /* Wear Leveling : circular use of free blocks */
@@ -380,15 +571,21 @@ uint16_t NAND_Format (void)
   SPARE_AREA  SpareArea;
   uint32_t BlockIndex;
 
+  /* the sectors of the cache would be written on the formatted NAND */
+  Cache_Dirty = 0;
+
   for (BlockIndex = 0 ; BlockIndex < NAND_ZONE_SIZE * NAND_MAX_ZONE; BlockIndex++)
   {
     phAddress = NAND_ConvertPhyAddress(BlockIndex * NAND_BLOCK_SIZE );
     SpareArea = ReadSpareArea(BlockIndex * NAND_BLOCK_SIZE);
    
-    if((SpareArea.DataStatus != 0)||(SpareArea.BlockStatus != 0)){
+    /* the header of a checkpoint may look like a bad block */
+    if((SpareArea.DataStatus != 0)||(SpareArea.BlockStatus != 0)||
+       ((BlockIndex % MAX_PHY_BLOCKS_PER_ZONE) == MAP_BLOCK)){
         FSMC_NAND_EraseBlock (phAddress);
     }  
   }
+  CurrentZone = 0;
   NAND_BuildLUT(0);
   return NAND_OK;
 }
@@ -424,16 +621,23 @@ static uint16_t NAND_Write_Cleanup (void)
       NAND_Copy (wAddress, fAddress, NAND_BLOCK_SIZE - wAddress.Page);
     }
 
-    /* assign logical address to new block */
+    /* assign logical address to new block, the rest of the spare area
+       is left as it is (page ECC) */
     tempSpareArea [0] = LogAddress | USED_BLOCK ;
     tempSpareArea [1] = 0xFFFF;
     tempSpareArea [2] = 0xFFFF;
+    tempSpareArea [3] = tempSpareArea [4] = tempSpareArea [5] = 0xFFFF;
+    tempSpareArea [6] = tempSpareArea [7] = 0xFFFF;
 
     fAddress.Page     = 0x00;
     FSMC_NAND_WriteSpareArea( (uint8_t *)tempSpareArea , fAddress , 1);
 
     /* erase old block */
     FSMC_NAND_EraseBlock(wAddress);
+
+    Zone_Map[fAddress.Block] = LogAddress | USED_BLOCK;
+    Zone_Map[wAddress.Block] = MAP_FREE_BLOCK;
+    NAND_JournalMap(wAddress.Zone, fAddress.Block, wAddress.Block);
     NAND_CleanLUT(wAddress.Zone);
   }
   else
@@ -442,9 +646,14 @@ static uint16_t NAND_Write_Cleanup (void)
     tempSpareArea [0] = LogAddress | USED_BLOCK ;
     tempSpareArea [1] = 0xFFFF;
     tempSpareArea [2] = 0xFFFF;
+    tempSpareArea [3] = tempSpareArea [4] = tempSpareArea [5] = 0xFFFF;
+    tempSpareArea [6] = tempSpareArea [7] = 0xFFFF;
 
     wAddress.Page     = 0x00;
     FSMC_NAND_WriteSpareArea((uint8_t *)tempSpareArea , wAddress, 1);
+
+    Zone_Map[wAddress.Block] = LogAddress | USED_BLOCK;
+    NAND_JournalMap(wAddress.Zone, wAddress.Block, wAddress.Block);
     NAND_CleanLUT(wAddress.Zone);
   }
   return NAND_OK;
@@ -475,17 +684,198 @@ static NAND_ADDRESS NAND_ConvertPhyAddress (uint32_t Address)
 
 /*******************************************************************************
 * Function Name  : NAND_BuildLUT
-* Description    : Build the look up table
+* Description    : Build the look up table from the checkpoint of the zone,
+*                  the spare areas of the zone are read only when it is not
+*                  valid
 * Input          : None
 * Output         : None
 * Return         : Status
-* !!!! NOTE : THIS ALGORITHM IS A SUBJECT OF PATENT FOR STMICROELECTRONICS !!!!!
 *******************************************************************************/
 static uint16_t NAND_BuildLUT (uint8_t ZoneNbr)
 {
+  if (NAND_LoadMap(ZoneNbr) != NAND_OK)
+  {
+    NAND_ScanMap(ZoneNbr);
+    NAND_SaveMap(ZoneNbr);
+  }
+  return NAND_MapToLUT();
+}
 
-  uint16_t  pBadBlock, pCurrentBlock, pFreeBlock;
+/*******************************************************************************
+* Function Name  : NAND_ScanMap
+* Description    : Read the spare area of every block of the zone
+* Input          : None
+* Output         : None
+* Return         : None
+*******************************************************************************/
+static void NAND_ScanMap (uint8_t ZoneNbr)
+{
+  uint16_t  pCurrentBlock;
   SPARE_AREA  SpareArea;
+
+  for (pCurrentBlock = 0 ; pCurrentBlock < MAX_PHY_BLOCKS_PER_ZONE ; pCurrentBlock++)
+  {
+    SpareArea = ReadSpareArea(pCurrentBlock * NAND_BLOCK_SIZE + (ZoneNbr * NAND_BLOCK_SIZE * MAX_PHY_BLOCKS_PER_ZONE));
+
+    /* the checkpoint block is kept out like a bad one */
+    if ((pCurrentBlock == MAP_BLOCK) || (SpareArea.DataStatus == 0) || (SpareArea.BlockStatus == 0))
+    {
+      Zone_Map[pCurrentBlock] = MAP_BAD_BLOCK;
+    }
+    else
+    {
+      Zone_Map[pCurrentBlock] = SpareArea.LogicalIndex;
+    }
+  }
+}
+
+/*******************************************************************************
+* Function Name  : NAND_MapCheck
+* Description    : Check of the zone map
+* Input          : None
+* Output         : None
+* Return         : Check
+*******************************************************************************/
+static uint16_t NAND_MapCheck (void)
+{
+  uint16_t Index, Check = Map_Generation;
+
+  for (Index = 0 ; Index < MAX_PHY_BLOCKS_PER_ZONE ; Index++)
+  {
+    Check += Zone_Map[Index];
+  }
+  return Check;
+}
+
+/*******************************************************************************
+* Function Name  : NAND_LoadMap
+* Description    : Read the checkpoint of the zone map and replay its journal
+* Input          : None
+* Output         : None
+* Return         : Status, NAND_FAIL when the checkpoint is not valid
+*******************************************************************************/
+static uint16_t NAND_LoadMap (uint8_t ZoneNbr)
+{
+  NAND_ADDRESS Address;
+  uint16_t Spare[8];
+
+  Address.Zone = ZoneNbr;
+  Address.Block = MAP_BLOCK;
+  Address.Page = 0;
+
+  /* header: signature, generation and check of the map */
+  FSMC_NAND_ReadSpareArea((uint8_t *)Spare, Address, 1);
+  if (Spare[0] != MAP_SIGNATURE)
+  {
+    return NAND_FAIL;
+  }
+  Map_Generation = Spare[1];
+
+  FSMC_NAND_ReadSmallPage((uint8_t *)Zone_Map, Address, MAP_PAGES);
+  if (NAND_MapCheck() != Spare[2])
+  {
+    return NAND_FAIL;
+  }
+
+  /* journal: signature, generation, two blocks and their values, check */
+  for (Journal_Page = MAP_PAGES ; Journal_Page < NAND_BLOCK_SIZE ; Journal_Page++)
+  {
+    Address.Page = Journal_Page;
+    FSMC_NAND_ReadSpareArea((uint8_t *)Spare, Address, 1);
+
+    if (Spare[0] == 0xFFFF)
+    {
+      break;
+    }
+    if ((Spare[0] != JOURNAL_SIGNATURE) || (Spare[1] != Map_Generation) ||
+        (Spare[2] >= MAX_PHY_BLOCKS_PER_ZONE) || (Spare[4] >= MAX_PHY_BLOCKS_PER_ZONE) ||
+        ((uint16_t)(Spare[1] + Spare[2] + Spare[3] + Spare[4] + Spare[5]) != Spare[6]))
+    {
+      return NAND_FAIL;
+    }
+    Zone_Map[Spare[2]] = Spare[3];
+    Zone_Map[Spare[4]] = Spare[5];
+  }
+  return NAND_OK;
+}
+
+/*******************************************************************************
+* Function Name  : NAND_SaveMap
+* Description    : Write a new checkpoint of the zone map
+* Input          : None
+* Output         : None
+* Return         : None
+*******************************************************************************/
+static void NAND_SaveMap (uint8_t ZoneNbr)
+{
+  NAND_ADDRESS Address;
+  uint16_t Spare[8];
+
+  Address.Zone = ZoneNbr;
+  Address.Block = MAP_BLOCK;
+  Address.Page = 0;
+
+  FSMC_NAND_EraseBlock(Address);
+
+  Map_Generation++;
+  FSMC_NAND_WriteSmallPage((uint8_t *)Zone_Map, Address, MAP_PAGES);
+
+  /* the header is written last, a checkpoint cut by a power loss is not valid */
+  Spare[0] = MAP_SIGNATURE;
+  Spare[1] = Map_Generation;
+  Spare[2] = NAND_MapCheck();
+  Spare[3] = Spare[4] = Spare[5] = Spare[6] = Spare[7] = 0xFFFF;
+  FSMC_NAND_WriteSpareArea((uint8_t *)Spare, Address, 1);
+
+  Journal_Page = MAP_PAGES;
+}
+
+/*******************************************************************************
+* Function Name  : NAND_JournalMap
+* Description    : Append the new values of two blocks of the zone map to the
+*                  journal, a new checkpoint is written once it is full
+* Input          : None
+* Output         : None
+* Return         : None
+*******************************************************************************/
+static void NAND_JournalMap (uint8_t ZoneNbr, uint16_t Block1, uint16_t Block2)
+{
+  NAND_ADDRESS Address;
+  uint16_t Spare[8];
+
+  if (Journal_Page >= NAND_BLOCK_SIZE)
+  {
+    NAND_SaveMap(ZoneNbr);
+    return;
+  }
+
+  Address.Zone = ZoneNbr;
+  Address.Block = MAP_BLOCK;
+  Address.Page = Journal_Page++;
+
+  Spare[0] = JOURNAL_SIGNATURE;
+  Spare[1] = Map_Generation;
+  Spare[2] = Block1;
+  Spare[3] = Zone_Map[Block1];
+  Spare[4] = Block2;
+  Spare[5] = Zone_Map[Block2];
+  Spare[6] = Spare[1] + Spare[2] + Spare[3] + Spare[4] + Spare[5];
+  Spare[7] = 0xFFFF;
+  FSMC_NAND_WriteSpareArea((uint8_t *)Spare, Address, 1);
+}
+
+/*******************************************************************************
+* Function Name  : NAND_MapToLUT
+* Description    : Build the look up table from the zone map
+* Input          : None
+* Output         : None
+* Return         : Status
+* !!!! NOTE : THIS ALGORITHM IS A SUBJECT OF PATENT FOR STMICROELECTRONICS !!!!!
+*******************************************************************************/
+static uint16_t NAND_MapToLUT (void)
+{
+
+  uint16_t  pBadBlock, pCurrentBlock, pFreeBlock;
   /*****************************************************************************
                                   1st step : Init.
   *****************************************************************************/
@@ -506,9 +896,7 @@ static uint16_t NAND_BuildLUT (uint8_t ZoneNbr)
   while (pCurrentBlock < MAX_PHY_BLOCKS_PER_ZONE)
   {
 
-    SpareArea = ReadSpareArea(pCurrentBlock * NAND_BLOCK_SIZE + (ZoneNbr * NAND_BLOCK_SIZE * MAX_PHY_BLOCKS_PER_ZONE));
-
-    if ((SpareArea.DataStatus == 0) || (SpareArea.BlockStatus == 0))
+    if (Zone_Map[pCurrentBlock] == MAP_BAD_BLOCK)
     {
 
       LUT[pBadBlock--]    |= pCurrentBlock | (uint16_t)BAD_BLOCK ;
@@ -518,10 +906,10 @@ static uint16_t NAND_BuildLUT (uint8_t ZoneNbr)
         return NAND_FAIL;
       }
     }
-    else if (SpareArea.LogicalIndex != 0xFFFF)
+    else if (Zone_Map[pCurrentBlock] != MAP_FREE_BLOCK)
     {
 
-      LUT[SpareArea.LogicalIndex & 0x3FF] |= pCurrentBlock | VALID_BLOCK | USED_BLOCK;
+      LUT[Zone_Map[pCurrentBlock] & 0x3FF] |= pCurrentBlock | VALID_BLOCK | USED_BLOCK;
       LUT[pCurrentBlock] &= (uint16_t)( ~FREE_BLOCK);
     }
     pCurrentBlock++ ;
@@ -159,6 +159,9 @@ void PendSV_Handler(void)
 *******************************************************************************/
 void SysTick_Handler(void)
 {
+#ifdef USE_STM3210E_EVAL
+  NAND_Tick();
+#endif /* USE_STM3210E_EVAL */
 }
 
 /******************************************************************************/
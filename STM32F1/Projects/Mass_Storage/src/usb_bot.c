@@ -185,6 +185,9 @@ void CBW_Decode(void)
         case SCSI_START_STOP_UNIT:
           SCSI_Start_Stop_Unit_Cmd(CBW.bLUN);
           break;
+        case SCSI_SYNCHRONIZE_CACHE10:
+          SCSI_Synchronize_Cache10_Cmd(CBW.bLUN);
+          break;
         case SCSI_ALLOW_MEDIUM_REMOVAL:
           SCSI_Start_Stop_Unit_Cmd(CBW.bLUN);
           break;
@@ -301,10 +304,18 @@ void Transfer_Data_Request(uint8_t* Data_Pointer, uint16_t Data_Len)
 *******************************************************************************/
 void Set_CSW (uint8_t CSW_Status, uint8_t Send_Permission)
 {
+  USB_SIL_Packet Packet;
+
   CSW.dSignature = BOT_CSW_SIGNATURE;
   CSW.bStatus = CSW_Status;
 
-  USB_SIL_Write(EP1_IN, ((uint8_t *)& CSW), CSW_DATA_LENGTH);
+  /* The CSW_DATA_LENGTH bytes are written field by field in the PMA */
+  USB_SIL_Reserve(&Packet, EP1_IN);
+  USB_SIL_Put32(&Packet, CSW.dSignature);
+  USB_SIL_Put32(&Packet, CSW.dTag);
+  USB_SIL_Put32(&Packet, CSW.dDataResidue);
+  USB_SIL_Put8(&Packet, CSW.bStatus);
+  USB_SIL_Commit(&Packet);
 
   Bot_State = BOT_ERROR;
   if (Send_Permission)
@@ -35,6 +35,7 @@
 #include "usb_init.h"
 #include "usb_int.h"
 #include "usb_lib.h"
+#include "memory.h"
 
 /* Private typedef -----------------------------------------------------------*/
 /* Private define ------------------------------------------------------------*/
@@ -182,4 +183,16 @@ void USB_Istr(void)
 #endif
 } /* USB_Istr */
 
+/*******************************************************************************
+* Function Name  : SOF_Callback
+* Description    : Start of frame callback function.
+* Input          : None.
+* Output         : None.
+* Return         : None.
+*******************************************************************************/
+void SOF_Callback(void)
+{
+  Write_Memory_Resume();
+}
+
 /************************ (C) COPYRIGHT STMicroelectronics *****END OF FILE****/
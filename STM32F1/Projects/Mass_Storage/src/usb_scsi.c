@@ -216,6 +216,26 @@ void Set_Scsi_Sense_Data(uint8_t lun, uint8_t Sens_Key, uint8_t Asc)
 *******************************************************************************/
 void SCSI_Start_Stop_Unit_Cmd(uint8_t lun)
 {
+  /* the medium may be removed next */
+  MAL_Flush(lun);
+  Set_CSW (CSW_CMD_PASSED, SEND_CSW_ENABLE);
+}
+
+/*******************************************************************************
+* Function Name  : SCSI_Synchronize_Cache10_Cmd
+* Description    : SCSI Synchronize_Cache10 Command routine.
+* Input          : None.
+* Output         : None.
+* Return         : None.
+*******************************************************************************/
+void SCSI_Synchronize_Cache10_Cmd(uint8_t lun)
+{
+  if (MAL_Flush(lun) != MAL_OK)
+  {
+    Set_Scsi_Sense_Data(CBW.bLUN, MEDIUM_ERROR, WRITE_ERROR);
+    Set_CSW (CSW_CMD_FAILED, SEND_CSW_ENABLE);
+    return;
+  }
   Set_CSW (CSW_CMD_PASSED, SEND_CSW_ENABLE);
 }
 
@@ -0,0 +1,103 @@
+/**
+  ******************************************************************************
+  * @file    usb_prop.h
+  * @author  MCD Application Team
+  * @version V4.0.0
+  * @date    21-January-2013
+  * @brief   All processing related to USB Benchmark Demo (Endpoint 0)
+  ******************************************************************************
+  * @attention
+  *
+  * <h2><center>&copy; COPYRIGHT 2013 STMicroelectronics</center></h2>
+  *
+  * Licensed under MCD-ST Liberty SW License Agreement V2, (the "License");
+  * You may not use this file except in compliance with the License.
+  * You may obtain a copy of the License at:
+  *
+  *        http://www.st.com/software_license_agreement_liberty_v2
+  *
+  * Unless required by applicable law or agreed to in writing, software 
+  * distributed under the License is distributed on an "AS IS" BASIS, 
+  * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  * See the License for the specific language governing permissions and
+  * limitations under the License.
+  *
+  ******************************************************************************
+  */
+
+
+/* Define to prevent recursive inclusion -------------------------------------*/
+#ifndef __usb_prop_H
+#define __usb_prop_H
+
+/* Includes ------------------------------------------------------------------*/
+/* Exported types ------------------------------------------------------------*/
+/* Counters returned by BENCHMARK_GET_STATS, 64 bytes little endian. The times
+   are in CPU cycles of the free running cycle counter, Clock per second. */
+typedef struct
+{
+  uint32_t Clock;            /* SystemCoreClock */
+  uint32_t Now;              /* time the counters were taken */
+  uint32_t Source_Packets;   /* IN packets taken by the host on EP1 */
+  uint32_t Source_Bytes;
+  uint32_t Source_First;     /* time of the first and the last of them */
+  uint32_t Source_Last;
+  uint32_t Sink_Packets;     /* OUT packets received on EP3 */
+  uint32_t Sink_Bytes;
+  uint32_t Sink_First;       /* time of the first and the last of them */
+  uint32_t Sink_Last;
+  uint32_t Sink_Errors;      /* packets out of sequence */
+  uint32_t Ping_Count;       /* ping replies taken by the host on EP2 */
+  uint32_t Ping_Cycles;      /* last one, from the request to the reply taken */
+  uint32_t Ping_Max_Cycles;
+  uint32_t Isr_Max_Cycles;   /* longest CTR_LP run */
+  uint32_t Isr_Cycles;       /* time in the endpoint service routines */
+} BENCHMARK_STATS;
+
+/* Exported constants --------------------------------------------------------*/
+/* Exported macro ------------------------------------------------------------*/
+/* Exported define -----------------------------------------------------------*/
+
+#define Benchmark_GetConfiguration          NOP_Process
+//#define Benchmark_SetConfiguration          NOP_Process
+#define Benchmark_GetInterface              NOP_Process
+#define Benchmark_SetInterface              NOP_Process
+#define Benchmark_GetStatus                 NOP_Process
+#define Benchmark_ClearFeature              NOP_Process
+#define Benchmark_SetEndPointFeature        NOP_Process
+#define Benchmark_SetDeviceFeature          NOP_Process
+//#define Benchmark_SetDeviceAddress          NOP_Process
+
+/* Vendor requests to the device */
+#define BENCHMARK_RESET             0x01  /* clear the counters, stop the source */
+#define BENCHMARK_SOURCE            0x02  /* wValue: mode, wIndex: packet size */
+#define BENCHMARK_SINK              0x03  /* wValue: mode */
+#define BENCHMARK_PING              0x04  /* wValue: tag sent back on EP2 */
+#define BENCHMARK_GET_STATS         0x05  /* BENCHMARK_STATS */
+
+/* Modes of the source and of the sink. A packet starts with its sequence
+   number, 32 bits little endian, the rest of it is not checked. */
+#define BENCHMARK_OFF               0     /* source stopped, sink only counts */
+#define BENCHMARK_COPY              1     /* packets go through a RAM buffer */
+#define BENCHMARK_IN_PLACE          2     /* packets built or read in the PMA */
+
+/* Exported functions ------------------------------------------------------- */
+void Benchmark_init(void);
+void Benchmark_Reset(void);
+void Benchmark_SetConfiguration(void);
+void Benchmark_SetDeviceAddress (void);
+void Benchmark_Status_In (void);
+void Benchmark_Status_Out (void);
+RESULT Benchmark_Data_Setup(uint8_t);
+RESULT Benchmark_NoData_Setup(uint8_t);
+RESULT Benchmark_Get_Interface_Setting(uint8_t Interface, uint8_t AlternateSetting);
+uint8_t *Benchmark_GetDeviceDescriptor(uint16_t );
+uint8_t *Benchmark_GetConfigDescriptor(uint16_t);
+uint8_t *Benchmark_GetStringDescriptor(uint16_t);
+
+uint8_t *Benchmark_GetStats(uint16_t Length);
+void Benchmark_Snapshot(BENCHMARK_STATS *pStats);
+
+#endif /* __usb_prop_H */
+
+/************************ (C) COPYRIGHT STMicroelectronics *****END OF FILE****/
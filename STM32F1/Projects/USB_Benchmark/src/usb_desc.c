@@ -0,0 +1,140 @@
+/**
+  ******************************************************************************
+  * @file    usb_desc.c
+  * @author  MCD Application Team
+  * @version V4.0.0
+  * @date    21-January-2013
+  * @brief   Descriptors for USB Benchmark Demo
+  ******************************************************************************
+  * @attention
+  *
+  * <h2><center>&copy; COPYRIGHT 2013 STMicroelectronics</center></h2>
+  *
+  * Licensed under MCD-ST Liberty SW License Agreement V2, (the "License");
+  * You may not use this file except in compliance with the License.
+  * You may obtain a copy of the License at:
+  *
+  *        http://www.st.com/software_license_agreement_liberty_v2
+  *
+  * Unless required by applicable law or agreed to in writing, software 
+  * distributed under the License is distributed on an "AS IS" BASIS, 
+  * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  * See the License for the specific language governing permissions and
+  * limitations under the License.
+  *
+  ******************************************************************************
+  */
+
+
+/* Includes ------------------------------------------------------------------*/
+#include "usb_lib.h"
+#include "usb_desc.h"
+
+/* USB Standard Device Descriptor */
+const uint8_t Benchmark_DeviceDescriptor[] =
+  {
+    0x12,   /* bLength */
+    USB_DEVICE_DESCRIPTOR_TYPE,     /* bDescriptorType */
+    0x00,
+    0x02,   /* bcdUSB = 2.00 */
+    0xFF,   /* bDeviceClass: Vendor specific */
+    0x00,   /* bDeviceSubClass */
+    0x00,   /* bDeviceProtocol */
+    0x40,   /* bMaxPacketSize0 */
+    0x83,
+    0x04,   /* idVendor = 0x0483 */
+    0x60,
+    0x57,   /* idProduct = 0x5760 */
+    0x00,
+    0x02,   /* bcdDevice = 2.00 */
+    1,              /* Index of string descriptor describing manufacturer */
+    2,              /* Index of string descriptor describing product */
+    3,              /* Index of string descriptor describing the device's serial number */
+    0x01    /* bNumConfigurations */
+  };
+
+const uint8_t Benchmark_ConfigDescriptor[] =
+  {
+    /*Configuration Descriptor*/
+    0x09,   /* bLength: Configuration Descriptor size */
+    USB_CONFIGURATION_DESCRIPTOR_TYPE,      /* bDescriptorType: Configuration */
+    BENCHMARK_SIZ_CONFIG_DESC,              /* wTotalLength:no of returned bytes */
+    0x00,
+    0x01,   /* bNumInterfaces: 1 interface */
+    0x01,   /* bConfigurationValue: Configuration value */
+    0x00,   /* iConfiguration: Index of string descriptor describing the configuration */
+    0xC0,   /* bmAttributes: self powered */
+    0x32,   /* MaxPower 100 mA */
+    /*Interface Descriptor*/
+    0x09,   /* bLength: Interface Descriptor size */
+    USB_INTERFACE_DESCRIPTOR_TYPE,  /* bDescriptorType: Interface */
+    0x00,   /* bInterfaceNumber: Number of Interface */
+    0x00,   /* bAlternateSetting: Alternate setting */
+    0x03,   /* bNumEndpoints: Three endpoints used */
+    0xFF,   /* bInterfaceClass: Vendor specific */
+    0x00,   /* bInterfaceSubClass */
+    0x00,   /* bInterfaceProtocol */
+    0x00,   /* iInterface: */
+    /*Endpoint 1 Descriptor*/
+    0x07,   /* bLength: Endpoint Descriptor size */
+    USB_ENDPOINT_DESCRIPTOR_TYPE,   /* bDescriptorType: Endpoint */
+    0x81,   /* bEndpointAddress: (IN1), source */
+    0x02,   /* bmAttributes: Bulk */
+    BENCHMARK_DATA_SIZE,            /* wMaxPacketSize: */
+    0x00,
+    0x00,   /* bInterval: ignore for Bulk transfer */
+    /*Endpoint 3 Descriptor*/
+    0x07,   /* bLength: Endpoint Descriptor size */
+    USB_ENDPOINT_DESCRIPTOR_TYPE,   /* bDescriptorType: Endpoint */
+    0x03,   /* bEndpointAddress: (OUT3), sink */
+    0x02,   /* bmAttributes: Bulk */
+    BENCHMARK_DATA_SIZE,            /* wMaxPacketSize: */
+    0x00,
+    0x00,   /* bInterval: ignore for Bulk transfer */
+    /*Endpoint 2 Descriptor*/
+    0x07,   /* bLength: Endpoint Descriptor size */
+    USB_ENDPOINT_DESCRIPTOR_TYPE,   /* bDescriptorType: Endpoint */
+    0x82,   /* bEndpointAddress: (IN2), ping replies */
+    0x03,   /* bmAttributes: Interrupt */
+    BENCHMARK_PING_SIZE,            /* wMaxPacketSize: */
+    0x00,
+    0x01    /* bInterval: 1 ms */
+  };
+
+/* USB String Descriptors */
+const uint8_t Benchmark_StringLangID[BENCHMARK_SIZ_STRING_LANGID] =
+  {
+    BENCHMARK_SIZ_STRING_LANGID,
+    USB_STRING_DESCRIPTOR_TYPE,
+    0x09,
+    0x04 /* LangID = 0x0409: U.S. English */
+  };
+
+const uint8_t Benchmark_StringVendor[BENCHMARK_SIZ_STRING_VENDOR] =
+  {
+    BENCHMARK_SIZ_STRING_VENDOR,    /* Size of Vendor string */
+    USB_STRING_DESCRIPTOR_TYPE,     /* bDescriptorType*/
+    /* Manufacturer: "STMicroelectronics" */
+    'S', 0, 'T', 0, 'M', 0, 'i', 0, 'c', 0, 'r', 0, 'o', 0, 'e', 0,
+    'l', 0, 'e', 0, 'c', 0, 't', 0, 'r', 0, 'o', 0, 'n', 0, 'i', 0,
+    'c', 0, 's', 0
+  };
+
+const uint8_t Benchmark_StringProduct[BENCHMARK_SIZ_STRING_PRODUCT] =
+  {
+    BENCHMARK_SIZ_STRING_PRODUCT,   /* bLength */
+    USB_STRING_DESCRIPTOR_TYPE,     /* bDescriptorType */
+    /* Product name: "STM32 USB Benchmark" */
+    'S', 0, 'T', 0, 'M', 0, '3', 0, '2', 0, ' ', 0, 'U', 0, 'S', 0,
+    'B', 0, ' ', 0, 'B', 0, 'e', 0, 'n', 0, 'c', 0, 'h', 0, 'm', 0,
+    'a', 0, 'r', 0, 'k', 0
+  };
+
+uint8_t Benchmark_StringSerial[BENCHMARK_SIZ_STRING_SERIAL] =
+  {
+    BENCHMARK_SIZ_STRING_SERIAL,    /* bLength */
+    USB_STRING_DESCRIPTOR_TYPE,     /* bDescriptorType */
+    'S', 0, 'T', 0, 'M', 0, '3', 0, '2', 0
+  };
+
+/************************ (C) COPYRIGHT STMicroelectronics *****END OF FILE****/
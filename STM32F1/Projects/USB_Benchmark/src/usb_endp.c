@@ -0,0 +1,309 @@
+/**
+  ******************************************************************************
+  * @file    usb_endp.c
+  * @author  MCD Application Team
+  * @version V4.0.0
+  * @date    21-January-2013
+  * @brief   Endpoint routines
+  ******************************************************************************
+  * @attention
+  *
+  * <h2><center>&copy; COPYRIGHT 2013 STMicroelectronics</center></h2>
+  *
+  * Licensed under MCD-ST Liberty SW License Agreement V2, (the "License");
+  * You may not use this file except in compliance with the License.
+  * You may obtain a copy of the License at:
+  *
+  *        http://www.st.com/software_license_agreement_liberty_v2
+  *
+  * Unless required by applicable law or agreed to in writing, software 
+  * distributed under the License is distributed on an "AS IS" BASIS, 
+  * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  * See the License for the specific language governing permissions and
+  * limitations under the License.
+  *
+  ******************************************************************************
+  */
+
+
+/* Includes ------------------------------------------------------------------*/
+#include "usb_lib.h"
+#include "usb_desc.h"
+#include "usb_mem.h"
+#include "usb_prop.h"
+#include "hw_config.h"
+#include "usb_istr.h"
+#include "usb_pwr.h"
+
+/* Private typedef -----------------------------------------------------------*/
+/* Private define ------------------------------------------------------------*/
+/* Private macro -------------------------------------------------------------*/
+#define BENCHMARK_CYCLES()      (DWT->CYCCNT)
+
+/* Private variables ---------------------------------------------------------*/
+static BENCHMARK_STATS Counters;
+static __IO uint8_t Source_Mode = BENCHMARK_OFF;
+static uint8_t Source_Size = BENCHMARK_DATA_SIZE;
+static uint32_t Source_Sequence = 0;
+static uint8_t Sink_Mode = BENCHMARK_OFF;
+static uint32_t Sink_Sequence = 0;
+static __IO uint8_t Ping_Pending = 0;
+static uint32_t Ping_Start;
+
+/* RAM side of the BENCHMARK_COPY mode, word aligned as the class buffers */
+static uint32_t Source_Buffer[BENCHMARK_DATA_SIZE / 4];
+static uint32_t Sink_Buffer[BENCHMARK_DATA_SIZE / 4];
+
+/* Private function prototypes -----------------------------------------------*/
+static void Benchmark_Load(void);
+
+/* Private functions ---------------------------------------------------------*/
+
+/*******************************************************************************
+* Function Name  : Benchmark_Load
+* Description    : Load the next source packet in the EP1 buffer and send it.
+* Input          : None.
+* Output         : None.
+* Return         : None.
+*******************************************************************************/
+static void Benchmark_Load(void)
+{
+  USB_SIL_Packet Packet;
+  uint8_t Count;
+
+  if (Source_Mode == BENCHMARK_COPY)
+  {
+    Source_Buffer[0] = Source_Sequence;
+    USB_SIL_Write(EP1_IN, (uint8_t *)Source_Buffer, Source_Size);
+  }
+  else
+  {
+    USB_SIL_Reserve(&Packet, EP1_IN);
+    for (Count = 0; Count + 4 <= Source_Size; Count += 4)
+    {
+      USB_SIL_Put32(&Packet, (Count == 0) ? Source_Sequence : 0);
+    }
+    for (; Count < Source_Size; Count++)
+    {
+      USB_SIL_Put8(&Packet, (Count < 4) ? (uint8_t)(Source_Sequence >> (8 * Count)) : 0);
+    }
+    USB_SIL_Commit(&Packet);
+  }
+
+  Source_Sequence++;
+  SetEPTxValid(ENDP1);
+}
+
+/*******************************************************************************
+* Function Name  : Benchmark_Clear
+* Description    : Stop the source and clear the counters and the sequences.
+* Input          : None.
+* Output         : None.
+* Return         : None.
+*******************************************************************************/
+void Benchmark_Clear(void)
+{
+  uint8_t *pbCounters = (uint8_t *)&Counters;
+  uint32_t i;
+
+  Source_Mode = BENCHMARK_OFF;
+  SetEPTxStatus(ENDP1, EP_TX_NAK);
+
+  for (i = 0; i < sizeof(Counters); i++)
+  {
+    pbCounters[i] = 0;
+  }
+  Source_Sequence = 0;
+  Sink_Sequence = 0;
+  Ping_Pending = 0;
+
+#ifdef USB_INT_STATS
+  USB_Int_Stats_Reset();
+#endif /* USB_INT_STATS */
+}
+
+/*******************************************************************************
+* Function Name  : Benchmark_Source
+* Description    : Start, change or stop the source of EP1. While it runs, the
+*                  next packet is loaded as soon as the last one is taken.
+* Input          : - Mode: BENCHMARK_OFF, BENCHMARK_COPY or BENCHMARK_IN_PLACE.
+*                  - Size: bytes per packet, 0 for BENCHMARK_DATA_SIZE.
+* Output         : None.
+* Return         : None.
+*******************************************************************************/
+void Benchmark_Source(uint8_t Mode, uint8_t Size)
+{
+  uint8_t Running = (Source_Mode != BENCHMARK_OFF);
+
+  Source_Size = (Size != 0) ? Size : BENCHMARK_DATA_SIZE;
+  Source_Mode = Mode;
+
+  if (Mode == BENCHMARK_OFF)
+  {
+    /* A packet not taken yet is dropped */
+    SetEPTxStatus(ENDP1, EP_TX_NAK);
+  }
+  else if (!Running)
+  {
+    Benchmark_Load();
+  }
+}
+
+/*******************************************************************************
+* Function Name  : Benchmark_Sink
+* Description    : Select how the sink of EP3 reads the packets.
+* Input          : - Mode: BENCHMARK_OFF, BENCHMARK_COPY or BENCHMARK_IN_PLACE.
+* Output         : None.
+* Return         : None.
+*******************************************************************************/
+void Benchmark_Sink(uint8_t Mode)
+{
+  Sink_Mode = Mode;
+}
+
+/*******************************************************************************
+* Function Name  : Benchmark_Ping
+* Description    : Send a ping reply on EP2: the tag, the frame number and the
+*                  time (16, 16 and 32 bits, little endian).
+* Input          : - Tag: value sent back.
+* Output         : None.
+* Return         : 0 while the last reply was not taken, else 1.
+*******************************************************************************/
+uint8_t Benchmark_Ping(uint16_t Tag)
+{
+  USB_SIL_Packet Packet;
+
+  if (Ping_Pending)
+  {
+    return 0;
+  }
+
+  Ping_Start = BENCHMARK_CYCLES();
+  USB_SIL_Reserve(&Packet, EP2_IN);
+  USB_SIL_Put16(&Packet, Tag);
+  USB_SIL_Put16(&Packet, _GetFNR() & FNR_FN);
+  USB_SIL_Put32(&Packet, Ping_Start);
+  USB_SIL_Commit(&Packet);
+
+  Ping_Pending = 1;
+  SetEPTxValid(ENDP2);
+
+  return 1;
+}
+
+/*******************************************************************************
+* Function Name  : Benchmark_Snapshot
+* Description    : Copy the counters, with the clock and the time they are
+*                  taken at.
+* Input          : - pStats: where the counters are copied.
+* Output         : None.
+* Return         : None.
+*******************************************************************************/
+void Benchmark_Snapshot(BENCHMARK_STATS *pStats)
+{
+#ifdef USB_INT_STATS
+  uint32_t i;
+#endif /* USB_INT_STATS */
+
+  *pStats = Counters;
+  pStats->Clock = SystemCoreClock;
+  pStats->Now = BENCHMARK_CYCLES();
+
+#ifdef USB_INT_STATS
+  pStats->Isr_Max_Cycles = USB_Int_Stats.Max_Cycles;
+  pStats->Isr_Cycles = 0;
+  for (i = 0; i < 8; i++)
+  {
+    pStats->Isr_Cycles += USB_Int_Stats.Cycles[i];
+  }
+#endif /* USB_INT_STATS */
+}
+
+/*******************************************************************************
+* Function Name  : EP1_IN_Callback
+* Description    : Source packet taken by the host, the next one is loaded.
+* Input          : None.
+* Output         : None.
+* Return         : None.
+*******************************************************************************/
+void EP1_IN_Callback (void)
+{
+  uint32_t Now = BENCHMARK_CYCLES();
+
+  if (Counters.Source_Packets++ == 0)
+  {
+    Counters.Source_First = Now;
+  }
+  Counters.Source_Last = Now;
+  Counters.Source_Bytes += GetEPTxCount(ENDP1);
+
+  if (Source_Mode != BENCHMARK_OFF)
+  {
+    Benchmark_Load();
+  }
+}
+
+/*******************************************************************************
+* Function Name  : EP2_IN_Callback
+* Description    : Ping reply taken by the host.
+* Input          : None.
+* Output         : None.
+* Return         : None.
+*******************************************************************************/
+void EP2_IN_Callback (void)
+{
+  Counters.Ping_Cycles = BENCHMARK_CYCLES() - Ping_Start;
+  if (Counters.Ping_Cycles > Counters.Ping_Max_Cycles)
+  {
+    Counters.Ping_Max_Cycles = Counters.Ping_Cycles;
+  }
+  Counters.Ping_Count++;
+  Ping_Pending = 0;
+}
+
+/*******************************************************************************
+* Function Name  : EP3_OUT_Callback
+* Description    : Sink packet received, its sequence number is checked unless
+*                  the sink only counts.
+* Input          : None.
+* Output         : None.
+* Return         : None.
+*******************************************************************************/
+void EP3_OUT_Callback(void)
+{
+  USB_SIL_Packet Packet;
+  uint32_t Now = BENCHMARK_CYCLES();
+  uint32_t Length = GetEPRxCount(ENDP3);
+  uint32_t Sequence = Sink_Sequence;
+
+  if (Sink_Mode == BENCHMARK_COPY)
+  {
+    USB_SIL_Read(EP3_OUT, (uint8_t *)Sink_Buffer);
+    Sequence = Sink_Buffer[0];
+  }
+  else if (Sink_Mode == BENCHMARK_IN_PLACE)
+  {
+    USB_SIL_Receive(&Packet, EP3_OUT);
+    Sequence = USB_SIL_Get32(&Packet);
+  }
+
+  if ((Sink_Mode != BENCHMARK_OFF) && (Length >= 4))
+  {
+    if (Sequence != Sink_Sequence)
+    {
+      Counters.Sink_Errors++;
+    }
+    Sink_Sequence = Sequence + 1;
+  }
+
+  if (Counters.Sink_Packets++ == 0)
+  {
+    Counters.Sink_First = Now;
+  }
+  Counters.Sink_Last = Now;
+  Counters.Sink_Bytes += Length;
+
+  SetEPRxValid(ENDP3);
+}
+
+/************************ (C) COPYRIGHT STMicroelectronics *****END OF FILE****/
@@ -0,0 +1,400 @@
+/**
+  ******************************************************************************
+  * @file    usb_prop.c
+  * @author  MCD Application Team
+  * @version V4.0.0
+  * @date    21-January-2013
+  * @brief   All processing related to USB Benchmark Demo
+  ******************************************************************************
+  * @attention
+  *
+  * <h2><center>&copy; COPYRIGHT 2013 STMicroelectronics</center></h2>
+  *
+  * Licensed under MCD-ST Liberty SW License Agreement V2, (the "License");
+  * You may not use this file except in compliance with the License.
+  * You may obtain a copy of the License at:
+  *
+  *        http://www.st.com/software_license_agreement_liberty_v2
+  *
+  * Unless required by applicable law or agreed to in writing, software 
+  * distributed under the License is distributed on an "AS IS" BASIS, 
+  * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  * See the License for the specific language governing permissions and
+  * limitations under the License.
+  *
+  ******************************************************************************
+  */
+
+
+/* Includes ------------------------------------------------------------------*/
+#include "usb_lib.h"
+#include "usb_conf.h"
+#include "usb_prop.h"
+#include "usb_desc.h"
+#include "usb_pwr.h"
+#include "hw_config.h"
+
+/* Private typedef -----------------------------------------------------------*/
+/* Private define ------------------------------------------------------------*/
+/* Private macro -------------------------------------------------------------*/
+/* Private variables ---------------------------------------------------------*/
+/* Counters taken for the BENCHMARK_GET_STATS request in progress */
+BENCHMARK_STATS Stats;
+
+/* -------------------------------------------------------------------------- */
+/*  Structures initializations */
+/* -------------------------------------------------------------------------- */
+
+DEVICE Device_Table =
+  {
+    EP_NUM,
+    1
+  };
+
+DEVICE_PROP Device_Property =
+  {
+    Benchmark_init,
+    Benchmark_Reset,
+    Benchmark_Status_In,
+    Benchmark_Status_Out,
+    Benchmark_Data_Setup,
+    Benchmark_NoData_Setup,
+    Benchmark_Get_Interface_Setting,
+    Benchmark_GetDeviceDescriptor,
+    Benchmark_GetConfigDescriptor,
+    Benchmark_GetStringDescriptor,
+    0,
+    0x40 /*MAX PACKET SIZE*/
+  };
+
+USER_STANDARD_REQUESTS User_Standard_Requests =
+  {
+    Benchmark_GetConfiguration,
+    Benchmark_SetConfiguration,
+    Benchmark_GetInterface,
+    Benchmark_SetInterface,
+    Benchmark_GetStatus,
+    Benchmark_ClearFeature,
+    Benchmark_SetEndPointFeature,
+    Benchmark_SetDeviceFeature,
+    Benchmark_SetDeviceAddress
+  };
+
+ONE_DESCRIPTOR Device_Descriptor =
+  {
+    (uint8_t*)Benchmark_DeviceDescriptor,
+    BENCHMARK_SIZ_DEVICE_DESC
+  };
+
+ONE_DESCRIPTOR Config_Descriptor =
+  {
+    (uint8_t*)Benchmark_ConfigDescriptor,
+    BENCHMARK_SIZ_CONFIG_DESC
+  };
+
+ONE_DESCRIPTOR String_Descriptor[4] =
+  {
+    {(uint8_t*)Benchmark_StringLangID, BENCHMARK_SIZ_STRING_LANGID},
+    {(uint8_t*)Benchmark_StringVendor, BENCHMARK_SIZ_STRING_VENDOR},
+    {(uint8_t*)Benchmark_StringProduct, BENCHMARK_SIZ_STRING_PRODUCT},
+    {(uint8_t*)Benchmark_StringSerial, BENCHMARK_SIZ_STRING_SERIAL}
+  };
+
+/* Extern variables ----------------------------------------------------------*/
+/* Private function prototypes -----------------------------------------------*/
+/* Extern function prototypes ------------------------------------------------*/
+/* Private functions ---------------------------------------------------------*/
+/*******************************************************************************
+* Function Name  : Benchmark_init.
+* Description    : Benchmark init routine.
+* Input          : None.
+* Output         : None.
+* Return         : None.
+*******************************************************************************/
+void Benchmark_init(void)
+{
+
+  /* Update the serial number string descriptor with the data from the unique
+  ID*/
+  Get_SerialNum();
+
+  pInformation->Current_Configuration = 0;
+
+  /* Connect the device */
+  PowerOn();
+
+  /* Perform basic device initialization operations */
+  USB_SIL_Init();
+
+  bDeviceState = UNCONNECTED;
+}
+
+/*******************************************************************************
+* Function Name  : Benchmark_Reset
+* Description    : Benchmark reset routine
+* Input          : None.
+* Output         : None.
+* Return         : None.
+*******************************************************************************/
+void Benchmark_Reset(void)
+{
+  /* Set Benchmark DEVICE as not configured */
+  pInformation->Current_Configuration = 0;
+
+  /* Current Feature initialization */
+  pInformation->Current_Feature = Benchmark_ConfigDescriptor[7];
+
+  /* Set Benchmark DEVICE with the default Interface*/
+  pInformation->Current_Interface = 0;
+
+  SetBTABLE(BTABLE_ADDRESS);
+
+  /* Initialize Endpoint 0 */
+  SetEPType(ENDP0, EP_CONTROL);
+  SetEPTxStatus(ENDP0, EP_TX_STALL);
+  SetEPRxAddr(ENDP0, ENDP0_RXADDR);
+  SetEPTxAddr(ENDP0, ENDP0_TXADDR);
+  Clear_Status_Out(ENDP0);
+  SetEPRxCount(ENDP0, Device_Property.MaxPacketSize);
+  SetEPRxValid(ENDP0);
+
+  /* Initialize Endpoint 1 */
+  SetEPType(ENDP1, EP_BULK);
+  SetEPTxAddr(ENDP1, ENDP1_TXADDR);
+  SetEPTxStatus(ENDP1, EP_TX_NAK);
+  SetEPRxStatus(ENDP1, EP_RX_DIS);
+
+  /* Initialize Endpoint 2 */
+  SetEPType(ENDP2, EP_INTERRUPT);
+  SetEPTxAddr(ENDP2, ENDP2_TXADDR);
+  SetEPRxStatus(ENDP2, EP_RX_DIS);
+  SetEPTxStatus(ENDP2, EP_TX_NAK);
+
+  /* Initialize Endpoint 3 */
+  SetEPType(ENDP3, EP_BULK);
+  SetEPRxAddr(ENDP3, ENDP3_RXADDR);
+  SetEPRxCount(ENDP3, BENCHMARK_DATA_SIZE);
+  SetEPRxStatus(ENDP3, EP_RX_VALID);
+  SetEPTxStatus(ENDP3, EP_TX_DIS);
+
+  /* Stop the source and clear the counters */
+  Benchmark_Clear();
+
+  /* Set this device to response on default address */
+  SetDeviceAddress(0);
+  
+  bDeviceState = ATTACHED;
+}
+
+/*******************************************************************************
+* Function Name  : Benchmark_SetConfiguration.
+* Description    : Update the device state to configured.
+* Input          : None.
+* Output         : None.
+* Return         : None.
+*******************************************************************************/
+void Benchmark_SetConfiguration(void)
+{
+  DEVICE_INFO *pInfo = &Device_Info;
+
+  if (pInfo->Current_Configuration != 0)
+  {
+    /* Device configured */
+    bDeviceState = CONFIGURED;
+  }
+}
+
+/*******************************************************************************
+* Function Name  : Benchmark_SetDeviceAddress.
+* Description    : Update the device state to addressed.
+* Input          : None.
+* Output         : None.
+* Return         : None.
+*******************************************************************************/
+void Benchmark_SetDeviceAddress (void)
+{
+  bDeviceState = ADDRESSED;
+}
+
+/*******************************************************************************
+* Function Name  : Benchmark_Status_In.
+* Description    : Benchmark Status In Routine.
+* Input          : None.
+* Output         : None.
+* Return         : None.
+*******************************************************************************/
+void Benchmark_Status_In(void)
+{}
+
+/*******************************************************************************
+* Function Name  : Benchmark_Status_Out
+* Description    : Benchmark Status OUT Routine.
+* Input          : None.
+* Output         : None.
+* Return         : None.
+*******************************************************************************/
+void Benchmark_Status_Out(void)
+{}
+
+/*******************************************************************************
+* Function Name  : Benchmark_Data_Setup
+* Description    : handle the vendor requests with a data stage
+* Input          : Request Nb.
+* Output         : None.
+* Return         : USB_UNSUPPORT or USB_SUCCESS.
+*******************************************************************************/
+RESULT Benchmark_Data_Setup(uint8_t RequestNo)
+{
+  uint8_t    *(*CopyRoutine)(uint16_t);
+
+  CopyRoutine = NULL;
+
+  if ((RequestNo == BENCHMARK_GET_STATS)
+      && (Type_Recipient == (VENDOR_REQUEST | DEVICE_RECIPIENT)))
+  {
+    CopyRoutine = Benchmark_GetStats;
+  }
+
+  if (CopyRoutine == NULL)
+  {
+    return USB_UNSUPPORT;
+  }
+
+  pInformation->Ctrl_Info.CopyData = CopyRoutine;
+  pInformation->Ctrl_Info.Usb_wOffset = 0;
+  (*CopyRoutine)(0);
+  return USB_SUCCESS;
+}
+
+/*******************************************************************************
+* Function Name  : Benchmark_NoData_Setup.
+* Description    : handle the vendor requests without a data stage.
+* Input          : Request Nb.
+* Output         : None.
+* Return         : USB_UNSUPPORT or USB_SUCCESS.
+*******************************************************************************/
+RESULT Benchmark_NoData_Setup(uint8_t RequestNo)
+{
+  if (Type_Recipient != (VENDOR_REQUEST | DEVICE_RECIPIENT))
+  {
+    return USB_UNSUPPORT;
+  }
+
+  switch (RequestNo)
+  {
+    case BENCHMARK_RESET:
+      Benchmark_Clear();
+      return USB_SUCCESS;
+
+    case BENCHMARK_SOURCE:
+      if ((pInformation->USBwValue > BENCHMARK_IN_PLACE)
+          || (pInformation->USBwIndex > BENCHMARK_DATA_SIZE))
+      {
+        return USB_UNSUPPORT;
+      }
+      Benchmark_Source(pInformation->USBwValue0, pInformation->USBwIndex0);
+      return USB_SUCCESS;
+
+    case BENCHMARK_SINK:
+      if (pInformation->USBwValue > BENCHMARK_IN_PLACE)
+      {
+        return USB_UNSUPPORT;
+      }
+      Benchmark_Sink(pInformation->USBwValue0);
+      return USB_SUCCESS;
+
+    case BENCHMARK_PING:
+      /* Stalled while the last reply was not taken */
+      return Benchmark_Ping(pInformation->USBwValue) ? USB_SUCCESS : USB_UNSUPPORT;
+
+    default:
+      return USB_UNSUPPORT;
+  }
+}
+
+/*******************************************************************************
+* Function Name  : Benchmark_GetDeviceDescriptor.
+* Description    : Gets the device descriptor.
+* Input          : Length.
+* Output         : None.
+* Return         : The address of the device descriptor.
+*******************************************************************************/
+uint8_t *Benchmark_GetDeviceDescriptor(uint16_t Length)
+{
+  return Standard_GetDescriptorData(Length, &Device_Descriptor);
+}
+
+/*******************************************************************************
+* Function Name  : Benchmark_GetConfigDescriptor.
+* Description    : get the configuration descriptor.
+* Input          : Length.
+* Output         : None.
+* Return         : The address of the configuration descriptor.
+*******************************************************************************/
+uint8_t *Benchmark_GetConfigDescriptor(uint16_t Length)
+{
+  return Standard_GetDescriptorData(Length, &Config_Descriptor);
+}
+
+/*******************************************************************************
+* Function Name  : Benchmark_GetStringDescriptor
+* Description    : Gets the string descriptors according to the needed index
+* Input          : Length.
+* Output         : None.
+* Return         : The address of the string descriptors.
+*******************************************************************************/
+uint8_t *Benchmark_GetStringDescriptor(uint16_t Length)
+{
+  uint8_t wValue0 = pInformation->USBwValue0;
+  if (wValue0 > 3)
+  {
+    return NULL;
+  }
+  else
+  {
+    return Standard_GetDescriptorData(Length, &String_Descriptor[wValue0]);
+  }
+}
+
+/*******************************************************************************
+* Function Name  : Benchmark_Get_Interface_Setting.
+* Description    : test the interface and the alternate setting according to the
+*                  supported one.
+* Input1         : uint8_t: Interface : interface number.
+* Input2         : uint8_t: AlternateSetting : Alternate Setting number.
+* Output         : None.
+* Return         : The address of the string descriptors.
+*******************************************************************************/
+RESULT Benchmark_Get_Interface_Setting(uint8_t Interface, uint8_t AlternateSetting)
+{
+  if (AlternateSetting > 0)
+  {
+    return USB_UNSUPPORT;
+  }
+  else if (Interface > 0)
+  {
+    return USB_UNSUPPORT;
+  }
+  return USB_SUCCESS;
+}
+
+/*******************************************************************************
+* Function Name  : Benchmark_GetStats.
+* Description    : send the benchmark counters to the PC host, taken when the
+*                  request is received.
+* Input          : Length.
+* Output         : None.
+* Return         : Counters base address.
+*******************************************************************************/
+uint8_t *Benchmark_GetStats(uint16_t Length)
+{
+  if (Length == 0)
+  {
+    Benchmark_Snapshot(&Stats);
+    pInformation->Ctrl_Info.Usb_wLength = sizeof(Stats);
+    return NULL;
+  }
+  return (uint8_t *)&Stats + pInformation->Ctrl_Info.Usb_wOffset;
+}
+
+/************************ (C) COPYRIGHT STMicroelectronics *****END OF FILE****/
@@ -44,6 +44,13 @@
 #define LED_OFF               0xFF
 
 #define USART_RX_DATA_SIZE   2048
+/* OUT packets of ENDP3 waiting for the TX DMA of EVAL_COM1, ENDP3 NAKs the
+   host while they are all used */
+#define USART_TX_PACKETS     4
+/* Longest time in ms between two checks of USART_Rx_Buffer for RTS, and the
+   bytes the other side sends after RTS is deasserted */
+#define USART_RX_RTS_LATENCY 10
+#define USART_RX_RTS_SLACK    16
 /* Exported functions ------------------------------------------------------- */
 void Set_System(void);
 void Set_USBClock(void);
@@ -53,9 +60,18 @@ void USB_Interrupts_Config(void);
 void USB_Cable_Config (FunctionalState NewState);
 void USART_Config_Default(void);
 bool USART_Config(void);
-void USB_To_USART_Send_Data(uint8_t* data_buffer, uint8_t Nb_bytes);
 void USART_To_USB_Send_Data(void);
 void Handle_USBAsynchXfer (void);
+#ifdef EVAL_COM1_TX_DMA_CHANNEL
+uint8_t *USB_To_USART_Buffer(void);
+void USB_To_USART_Commit(uint16_t Nb_bytes);
+void USART_Tx_DMA_Done(void);
+#else
+void USB_To_USART_Send_Data(uint8_t* data_buffer, uint8_t Nb_bytes);
+#endif /* EVAL_COM1_TX_DMA_CHANNEL */
+#ifdef EVAL_COM1_FLOW_CONTROL
+void USART_CTS_Update(void);
+#endif /* EVAL_COM1_FLOW_CONTROL */
 void Get_SerialNum(void);
 
 /* External variables --------------------------------------------------------*/
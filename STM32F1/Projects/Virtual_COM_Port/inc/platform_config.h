@@ -99,11 +99,61 @@
   #define RCC_APB2Periph_GPIO_DISCONNECT      RCC_APB2Periph_GPIOD
   #define EVAL_COM1_IRQHandler                USART1_IRQHandler 
 
+  /* EVAL_COM1 data moved by DMA1: TX on channel 4, RX on channel 5 */
+  #define EVAL_COM1_DMA_CLK                   RCC_AHBPeriph_DMA1
+  #define EVAL_COM1_DR_ADDRESS                ((uint32_t)&USART1->DR)
+  #define EVAL_COM1_TX_DMA_CHANNEL            DMA1_Channel4
+  #define EVAL_COM1_TX_DMA_FLAG_TC            DMA1_FLAG_TC4
+  #define EVAL_COM1_TX_DMA_IRQn               DMA1_Channel4_IRQn
+  #define EVAL_COM1_TX_DMA_IRQHandler         DMA1_Channel4_IRQHandler
+  #define EVAL_COM1_RX_DMA_CHANNEL            DMA1_Channel5
+
+  /* RTS and CTS of EVAL_COM1 are driven by the firmware, PA12 and PA11 (RTS
+     and CTS of USART1) are the USB D+ and D-. Uncomment the following define
+     to use them. PB12 and PB13 are chosen just as illustrating example, you
+     should modify the defines below according to your hardware configuration. */
+/* #define EVAL_COM1_FLOW_CONTROL */
+  #define EVAL_COM1_FLOW_GPIO_CLK             RCC_APB2Periph_GPIOB
+  #define EVAL_COM1_RTS_GPIO_PORT             GPIOB
+  #define EVAL_COM1_RTS_PIN                   GPIO_Pin_12
+  #define EVAL_COM1_CTS_GPIO_PORT             GPIOB
+  #define EVAL_COM1_CTS_PIN                   GPIO_Pin_13
+  #define EVAL_COM1_CTS_PORT_SOURCE           GPIO_PortSourceGPIOB
+  #define EVAL_COM1_CTS_PIN_SOURCE            GPIO_PinSource13
+  #define EVAL_COM1_CTS_EXTI_LINE             EXTI_Line13
+  #define EVAL_COM1_CTS_IRQn                  EXTI15_10_IRQn
+  #define EVAL_COM1_CTS_IRQHandler            EXTI15_10_IRQHandler
+
 #elif defined (USE_STM3210E_EVAL)
   #define USB_DISCONNECT                      GPIOB  
   #define USB_DISCONNECT_PIN                  GPIO_Pin_14
   #define RCC_APB2Periph_GPIO_DISCONNECT      RCC_APB2Periph_GPIOB
   #define EVAL_COM1_IRQHandler                USART1_IRQHandler 
+
+  /* EVAL_COM1 data moved by DMA1: TX on channel 4, RX on channel 5 */
+  #define EVAL_COM1_DMA_CLK                   RCC_AHBPeriph_DMA1
+  #define EVAL_COM1_DR_ADDRESS                ((uint32_t)&USART1->DR)
+  #define EVAL_COM1_TX_DMA_CHANNEL            DMA1_Channel4
+  #define EVAL_COM1_TX_DMA_FLAG_TC            DMA1_FLAG_TC4
+  #define EVAL_COM1_TX_DMA_IRQn               DMA1_Channel4_IRQn
+  #define EVAL_COM1_TX_DMA_IRQHandler         DMA1_Channel4_IRQHandler
+  #define EVAL_COM1_RX_DMA_CHANNEL            DMA1_Channel5
+
+  /* RTS and CTS of EVAL_COM1 are driven by the firmware, PA12 and PA11 (RTS
+     and CTS of USART1) are the USB D+ and D-. Uncomment the following define
+     to use them. PB12 and PB13 are chosen just as illustrating example, you
+     should modify the defines below according to your hardware configuration. */
+/* #define EVAL_COM1_FLOW_CONTROL */
+  #define EVAL_COM1_FLOW_GPIO_CLK             RCC_APB2Periph_GPIOB
+  #define EVAL_COM1_RTS_GPIO_PORT             GPIOB
+  #define EVAL_COM1_RTS_PIN                   GPIO_Pin_12
+  #define EVAL_COM1_CTS_GPIO_PORT             GPIOB
+  #define EVAL_COM1_CTS_PIN                   GPIO_Pin_13
+  #define EVAL_COM1_CTS_PORT_SOURCE           GPIO_PortSourceGPIOB
+  #define EVAL_COM1_CTS_PIN_SOURCE            GPIO_PinSource13
+  #define EVAL_COM1_CTS_EXTI_LINE             EXTI_Line13
+  #define EVAL_COM1_CTS_IRQn                  EXTI15_10_IRQn
+  #define EVAL_COM1_CTS_IRQHandler            EXTI15_10_IRQHandler
  
 
 #elif defined (USE_STM32L152_EVAL) || defined (USE_STM32L152D_EVAL)
@@ -54,6 +54,13 @@ void USART2_IRQHandler(void);
 #else
 void USART1_IRQHandler(void);
 #endif /* USE_STM32L152_EVAL */
+
+#ifdef EVAL_COM1_TX_DMA_CHANNEL
+void EVAL_COM1_TX_DMA_IRQHandler(void);
+#endif /* EVAL_COM1_TX_DMA_CHANNEL */
+#ifdef EVAL_COM1_FLOW_CONTROL
+void EVAL_COM1_CTS_IRQHandler(void);
+#endif /* EVAL_COM1_FLOW_CONTROL */
 #endif /* __STM32_IT_H */
 
 /************************ (C) COPYRIGHT STMicroelectronics *****END OF FILE****/
@@ -34,10 +34,15 @@
 #include "usb_desc.h"
 #include "hw_config.h"
 #include "usb_pwr.h"
+#include <string.h>
 
 
 /* Private typedef -----------------------------------------------------------*/
 /* Private define ------------------------------------------------------------*/
+#if defined(EVAL_COM1_FLOW_CONTROL) && !defined(EVAL_COM1_RX_DMA_CHANNEL)
+#error "EVAL_COM1_FLOW_CONTROL needs the DMA of EVAL_COM1"
+#endif /* EVAL_COM1_FLOW_CONTROL */
+
 /* Private macro -------------------------------------------------------------*/
 /* Private variables ---------------------------------------------------------*/
 ErrorStatus HSEStartUpStatus;
@@ -48,8 +53,35 @@ uint32_t USART_Rx_ptr_in = 0;
 uint32_t USART_Rx_ptr_out = 0;
 uint32_t USART_Rx_length  = 0;
 
+/* Packets given to the two buffers of ENDP1 and not sent yet */
 uint8_t  USB_Tx_State = 0;
+/* The last packet was full, a zero length packet ends the transfer */
+static uint8_t  USB_Tx_ZLP = 0;
+/* A packet across the end of USART_Rx_Buffer */
+static uint32_t USB_Tx_Wrap[VIRTUAL_COM_PORT_DATA_SIZE / 4];
+#ifdef EVAL_COM1_TX_DMA_CHANNEL
+/* OUT packets of ENDP3 sent by the TX DMA one after the other, the indices
+   run freely (USART_TX_PACKETS is a power of two) */
+static uint8_t  USART_Tx_Ring[USART_TX_PACKETS][VIRTUAL_COM_PORT_DATA_SIZE];
+static uint8_t  USART_Tx_Length[USART_TX_PACKETS];
+static __IO uint8_t USART_Tx_Head = 0;
+static __IO uint8_t USART_Tx_Tail = 0;
+/* The TX DMA is sending a packet */
+static __IO uint8_t USART_Tx_Busy = 0;
+/* ENDP3 is left NAKing the host until a packet is free */
+static __IO uint8_t USART_Tx_Throttled = 0;
+#endif /* EVAL_COM1_TX_DMA_CHANNEL */
 static void IntToUnicode (uint32_t value , uint8_t *pbuf , uint8_t len);
+#ifdef EVAL_COM1_RX_DMA_CHANNEL
+static void USART_DMA_Config(void);
+#endif /* EVAL_COM1_RX_DMA_CHANNEL */
+#ifdef EVAL_COM1_TX_DMA_CHANNEL
+static void USART_Tx_Start(void);
+#endif /* EVAL_COM1_TX_DMA_CHANNEL */
+#ifdef EVAL_COM1_FLOW_CONTROL
+static void USART_Flow_Config(void);
+static void USART_RTS_Update(void);
+#endif /* EVAL_COM1_FLOW_CONTROL */
 /* Extern variables ----------------------------------------------------------*/
 
 extern LINE_CODING linecoding;
@@ -252,8 +284,13 @@ void USB_Interrupts_Config(void)
   NVIC_Init(&NVIC_InitStructure);
 #endif /* STM32L1XX_XD */
 
+#ifdef EVAL_COM1_TX_DMA_CHANNEL
+  /* Enable the USART TX DMA Interrupt */
+  NVIC_InitStructure.NVIC_IRQChannel = EVAL_COM1_TX_DMA_IRQn;
+#else
   /* Enable USART Interrupt */
   NVIC_InitStructure.NVIC_IRQChannel = EVAL_COM1_IRQn;
+#endif /* EVAL_COM1_TX_DMA_CHANNEL */
   NVIC_InitStructure.NVIC_IRQChannelPreemptionPriority = 1;
   NVIC_Init(&NVIC_InitStructure);
 }
@@ -315,10 +352,175 @@ void USART_Config_Default(void)
   /* Configure and enable the USART */
   STM_EVAL_COMInit(COM1, &USART_InitStructure);
 
+#ifdef EVAL_COM1_RX_DMA_CHANNEL
+  USART_DMA_Config();
+#else
   /* Enable the USART Receive interrupt */
   USART_ITConfig(EVAL_COM1, USART_IT_RXNE, ENABLE);
+#endif /* EVAL_COM1_RX_DMA_CHANNEL */
+}
+
+#ifdef EVAL_COM1_RX_DMA_CHANNEL
+/*******************************************************************************
+* Function Name  :  USART_DMA_Config.
+* Description    :  Start the circular RX DMA of EVAL_COM1 into USART_Rx_Buffer
+*                   and set up the TX DMA. The RX DMA keeps running when the
+*                   line coding changes.
+* Input          :  None.
+* Return         :  None.
+*******************************************************************************/
+static void USART_DMA_Config(void)
+{
+  DMA_InitTypeDef DMA_InitStructure;
+
+  if (EVAL_COM1_RX_DMA_CHANNEL->CCR & DMA_CCR1_EN)
+  {
+    return;
+  }
+
+  RCC_AHBPeriphClockCmd(EVAL_COM1_DMA_CLK, ENABLE);
+
+  DMA_DeInit(EVAL_COM1_RX_DMA_CHANNEL);
+  DMA_InitStructure.DMA_PeripheralBaseAddr = EVAL_COM1_DR_ADDRESS;
+  DMA_InitStructure.DMA_MemoryBaseAddr = (uint32_t)USART_Rx_Buffer;
+  DMA_InitStructure.DMA_DIR = DMA_DIR_PeripheralSRC;
+  DMA_InitStructure.DMA_BufferSize = USART_RX_DATA_SIZE;
+  DMA_InitStructure.DMA_PeripheralInc = DMA_PeripheralInc_Disable;
+  DMA_InitStructure.DMA_MemoryInc = DMA_MemoryInc_Enable;
+  DMA_InitStructure.DMA_PeripheralDataSize = DMA_PeripheralDataSize_Byte;
+  DMA_InitStructure.DMA_MemoryDataSize = DMA_MemoryDataSize_Byte;
+  DMA_InitStructure.DMA_Mode = DMA_Mode_Circular;
+  DMA_InitStructure.DMA_Priority = DMA_Priority_High;
+  DMA_InitStructure.DMA_M2M = DMA_M2M_Disable;
+  DMA_Init(EVAL_COM1_RX_DMA_CHANNEL, &DMA_InitStructure);
+
+  /* The TX DMA gets its buffer from USART_Tx_Start */
+  DMA_DeInit(EVAL_COM1_TX_DMA_CHANNEL);
+  DMA_InitStructure.DMA_DIR = DMA_DIR_PeripheralDST;
+  DMA_InitStructure.DMA_BufferSize = 1;
+  DMA_InitStructure.DMA_Mode = DMA_Mode_Normal;
+  DMA_InitStructure.DMA_Priority = DMA_Priority_Medium;
+  DMA_Init(EVAL_COM1_TX_DMA_CHANNEL, &DMA_InitStructure);
+  DMA_ITConfig(EVAL_COM1_TX_DMA_CHANNEL, DMA_IT_TC, ENABLE);
+
+  USART_Rx_ptr_in = 0;
+  USART_Rx_ptr_out = 0;
+  USART_Rx_length = 0;
+  USART_Tx_Head = 0;
+  USART_Tx_Tail = 0;
+  USART_Tx_Busy = 0;
+  USART_Tx_Throttled = 0;
+
+  USART_DMACmd(EVAL_COM1, USART_DMAReq_Rx | USART_DMAReq_Tx, ENABLE);
+  DMA_Cmd(EVAL_COM1_RX_DMA_CHANNEL, ENABLE);
+
+#ifdef EVAL_COM1_FLOW_CONTROL
+  USART_Flow_Config();
+#endif /* EVAL_COM1_FLOW_CONTROL */
+}
+#endif /* EVAL_COM1_RX_DMA_CHANNEL */
+
+#ifdef EVAL_COM1_FLOW_CONTROL
+/*******************************************************************************
+* Function Name  :  USART_Flow_Config.
+* Description    :  Configure the RTS output and the CTS input of EVAL_COM1.
+*                   RTS is deasserted when USART_Rx_Buffer is almost full, and
+*                   CTS gates the requests of the TX DMA from its interrupt.
+* Input          :  None.
+* Return         :  None.
+*******************************************************************************/
+static void USART_Flow_Config(void)
+{
+  GPIO_InitTypeDef GPIO_InitStructure;
+  NVIC_InitTypeDef NVIC_InitStructure;
+
+  RCC_APB2PeriphClockCmd(EVAL_COM1_FLOW_GPIO_CLK | RCC_APB2Periph_AFIO, ENABLE);
+
+  /* RTS asserted (low), USART_Rx_Buffer is empty */
+  GPIO_ResetBits(EVAL_COM1_RTS_GPIO_PORT, EVAL_COM1_RTS_PIN);
+  GPIO_InitStructure.GPIO_Pin = EVAL_COM1_RTS_PIN;
+  GPIO_InitStructure.GPIO_Speed = GPIO_Speed_2MHz;
+  GPIO_InitStructure.GPIO_Mode = GPIO_Mode_Out_PP;
+  GPIO_Init(EVAL_COM1_RTS_GPIO_PORT, &GPIO_InitStructure);
+
+  /* CTS pulled up, nothing is sent while the other side doesn't assert it */
+  GPIO_InitStructure.GPIO_Pin = EVAL_COM1_CTS_PIN;
+  GPIO_InitStructure.GPIO_Mode = GPIO_Mode_IPU;
+  GPIO_Init(EVAL_COM1_CTS_GPIO_PORT, &GPIO_InitStructure);
+
+  GPIO_EXTILineConfig(EVAL_COM1_CTS_PORT_SOURCE, EVAL_COM1_CTS_PIN_SOURCE);
+  EXTI_ClearITPendingBit(EVAL_COM1_CTS_EXTI_LINE);
+  EXTI_InitStructure.EXTI_Line = EVAL_COM1_CTS_EXTI_LINE;
+  EXTI_InitStructure.EXTI_Mode = EXTI_Mode_Interrupt;
+  EXTI_InitStructure.EXTI_Trigger = EXTI_Trigger_Rising_Falling;
+  EXTI_InitStructure.EXTI_LineCmd = ENABLE;
+  EXTI_Init(&EXTI_InitStructure);
+
+  /* The same priority as the TX DMA interrupt */
+  NVIC_InitStructure.NVIC_IRQChannel = EVAL_COM1_CTS_IRQn;
+  NVIC_InitStructure.NVIC_IRQChannelPreemptionPriority = 1;
+  NVIC_InitStructure.NVIC_IRQChannelSubPriority = 0;
+  NVIC_InitStructure.NVIC_IRQChannelCmd = ENABLE;
+  NVIC_Init(&NVIC_InitStructure);
+
+  USART_CTS_Update();
+}
+
+/*******************************************************************************
+* Function Name  :  USART_CTS_Update.
+* Description    :  Follow the CTS input, called from its EXTI interrupt. The
+*                   TX DMA gets no request while CTS is deasserted, the byte
+*                   being sent by EVAL_COM1 ends as with the CTS of the USART.
+* Input          :  None.
+* Return         :  None.
+*******************************************************************************/
+void USART_CTS_Update(void)
+{
+  if (GPIO_ReadInputDataBit(EVAL_COM1_CTS_GPIO_PORT, EVAL_COM1_CTS_PIN) == Bit_RESET)
+  {
+    USART_DMACmd(EVAL_COM1, USART_DMAReq_Tx, ENABLE);
+  }
+  else
+  {
+    USART_DMACmd(EVAL_COM1, USART_DMAReq_Tx, DISABLE);
+  }
 }
 
+/*******************************************************************************
+* Function Name  :  USART_RTS_Update.
+* Description    :  Deassert RTS when the free bytes of USART_Rx_Buffer are
+*                   fewer than the bytes received in USART_RX_RTS_LATENCY ms,
+*                   and assert it again at twice as many.
+* Input          :  None.
+* Return         :  None.
+*******************************************************************************/
+static void USART_RTS_Update(void)
+{
+  uint32_t headroom;
+  uint32_t free_bytes;
+
+  /* 10 bits by character, the RX DMA keeps a quarter of the buffer at most */
+  headroom = USART_InitStructure.USART_BaudRate / 10 * USART_RX_RTS_LATENCY / 1000
+             + USART_RX_RTS_SLACK;
+  if (headroom > USART_RX_DATA_SIZE / 4)
+  {
+    headroom = USART_RX_DATA_SIZE / 4;
+  }
+
+  free_bytes = USART_RX_DATA_SIZE - 1
+               - (USART_Rx_ptr_in + USART_RX_DATA_SIZE - USART_Rx_ptr_out) % USART_RX_DATA_SIZE;
+
+  if (free_bytes < headroom)
+  {
+    GPIO_SetBits(EVAL_COM1_RTS_GPIO_PORT, EVAL_COM1_RTS_PIN);
+  }
+  else if (free_bytes >= 2 * headroom)
+  {
+    GPIO_ResetBits(EVAL_COM1_RTS_GPIO_PORT, EVAL_COM1_RTS_PIN);
+  }
+}
+#endif /* EVAL_COM1_FLOW_CONTROL */
+
 /*******************************************************************************
 * Function Name  :  USART_Config.
 * Description    :  Configure the EVAL_COM1 according to the line coding structure.
@@ -400,9 +602,105 @@ bool USART_Config(void)
   /* Configure and enable the USART */
   STM_EVAL_COMInit(COM1, &USART_InitStructure);
 
+#ifdef EVAL_COM1_RX_DMA_CHANNEL
+  USART_DMA_Config();
+#endif /* EVAL_COM1_RX_DMA_CHANNEL */
+
   return (TRUE);
 }
 
+#ifdef EVAL_COM1_TX_DMA_CHANNEL
+/*******************************************************************************
+* Function Name  : USB_To_USART_Buffer.
+* Description    : Packet of the TX ring the next OUT packet of ENDP3 is read
+*                  into, ENDP3 is only enabled while one is free.
+* Input          : None.
+* Return         : Buffer of VIRTUAL_COM_PORT_DATA_SIZE bytes.
+*******************************************************************************/
+uint8_t *USB_To_USART_Buffer(void)
+{
+  return USART_Tx_Ring[USART_Tx_Head % USART_TX_PACKETS];
+}
+
+/*******************************************************************************
+* Function Name  : USB_To_USART_Commit.
+* Description    : Queue the packet read into USB_To_USART_Buffer() for the TX
+*                  DMA and enable ENDP3 again, or leave it NAKing the host
+*                  while all the packets of the ring are waiting.
+* Input          : Nb_bytes: number of bytes of the packet.
+* Return         : none.
+*******************************************************************************/
+void USB_To_USART_Commit(uint16_t Nb_bytes)
+{
+  uint32_t primask;
+
+  /* USART_Tx_DMA_Done() runs at a higher priority */
+  primask = __get_PRIMASK();
+  __disable_irq();
+
+  if (Nb_bytes != 0)
+  {
+    USART_Tx_Length[USART_Tx_Head % USART_TX_PACKETS] = (uint8_t)Nb_bytes;
+    USART_Tx_Head++;
+    if (!USART_Tx_Busy)
+    {
+      USART_Tx_Start();
+    }
+  }
+
+  if ((uint8_t)(USART_Tx_Head - USART_Tx_Tail) < USART_TX_PACKETS)
+  {
+    SetEPRxValid(ENDP3);
+  }
+  else
+  {
+    USART_Tx_Throttled = 1;
+  }
+
+  __set_PRIMASK(primask);
+}
+
+/*******************************************************************************
+* Function Name  : USART_Tx_Start.
+* Description    : Start the TX DMA on the oldest packet of the ring.
+* Input          : None.
+* Return         : none.
+*******************************************************************************/
+static void USART_Tx_Start(void)
+{
+  uint8_t index = USART_Tx_Tail % USART_TX_PACKETS;
+
+  USART_Tx_Busy = 1;
+  EVAL_COM1_TX_DMA_CHANNEL->CMAR = (uint32_t)USART_Tx_Ring[index];
+  DMA_SetCurrDataCounter(EVAL_COM1_TX_DMA_CHANNEL, USART_Tx_Length[index]);
+  DMA_Cmd(EVAL_COM1_TX_DMA_CHANNEL, ENABLE);
+}
+
+/*******************************************************************************
+* Function Name  : USART_Tx_DMA_Done.
+* Description    : End of the TX DMA of a packet, called from its interrupt
+*                  once the channel is disabled. The next packet is started
+*                  and ENDP3 is enabled again if it was NAKing the host.
+* Input          : None.
+* Return         : none.
+*******************************************************************************/
+void USART_Tx_DMA_Done(void)
+{
+  USART_Tx_Tail++;
+  USART_Tx_Busy = 0;
+
+  if (USART_Tx_Head != USART_Tx_Tail)
+  {
+    USART_Tx_Start();
+  }
+
+  if (USART_Tx_Throttled)
+  {
+    USART_Tx_Throttled = 0;
+    SetEPRxValid(ENDP3);
+  }
+}
+#else
 /*******************************************************************************
 * Function Name  : USB_To_USART_Send_Data.
 * Description    : send the received data from USB to the UART 0.
@@ -412,7 +710,6 @@ bool USART_Config(void)
 *******************************************************************************/
 void USB_To_USART_Send_Data(uint8_t* data_buffer, uint8_t Nb_bytes)
 {
-  
   uint32_t i;
   
   for (i = 0; i < Nb_bytes; i++)
@@ -421,64 +718,98 @@ void USB_To_USART_Send_Data(uint8_t* data_buffer, uint8_t Nb_bytes)
     while(USART_GetFlagStatus(EVAL_COM1, USART_FLAG_TXE) == RESET); 
   }  
 }
+#endif /* EVAL_COM1_TX_DMA_CHANNEL */
 
 /*******************************************************************************
 * Function Name  : Handle_USBAsynchXfer.
-* Description    : send data to USB.
+* Description    : send data to USB. Both buffers of ENDP1 are filled, with
+*                  full packets across the wrap of USART_Rx_Buffer, and a zero
+*                  length packet ends a transfer of full packets.
 * Input          : None.
 * Return         : none.
 *******************************************************************************/
 void Handle_USBAsynchXfer (void)
 {
   
-  uint16_t USB_Tx_ptr;
   uint16_t USB_Tx_length;
-  
-  if(USB_Tx_State != 1)
+  uint16_t USB_Tx_addr;
+  uint32_t part;
+#ifdef EVAL_COM1_RX_DMA_CHANNEL
+  uint32_t ptr_in;
+
+  /* The bytes written by the RX DMA since the last call */
+  ptr_in = USART_RX_DATA_SIZE - DMA_GetCurrDataCounter(EVAL_COM1_RX_DMA_CHANNEL);
+  if (ptr_in == USART_RX_DATA_SIZE)
   {
-    if (USART_Rx_ptr_out == USART_RX_DATA_SIZE)
-    {
-      USART_Rx_ptr_out = 0;
-    }
-    
-    if(USART_Rx_ptr_out == USART_Rx_ptr_in) 
+    ptr_in = 0;
+  }
+  if (linecoding.datatype == 7)
+  {
+    while (USART_Rx_ptr_in != ptr_in)
     {
-      USB_Tx_State = 0; 
-      return;
+      USART_Rx_Buffer[USART_Rx_ptr_in] &= 0x7F;
+      USART_Rx_ptr_in = (USART_Rx_ptr_in + 1) % USART_RX_DATA_SIZE;
     }
-    
+  }
+  USART_Rx_ptr_in = ptr_in;
+#endif /* EVAL_COM1_RX_DMA_CHANNEL */
+
+  while (USB_Tx_State < 2)
+  {
     if(USART_Rx_ptr_out > USART_Rx_ptr_in) /* rollback */
     { 
-      USART_Rx_length = USART_RX_DATA_SIZE - USART_Rx_ptr_out;
+      USART_Rx_length = USART_RX_DATA_SIZE - USART_Rx_ptr_out + USART_Rx_ptr_in;
     }
     else 
     {
       USART_Rx_length = USART_Rx_ptr_in - USART_Rx_ptr_out;
     }
     
-    if (USART_Rx_length > VIRTUAL_COM_PORT_DATA_SIZE)
+    if ((USART_Rx_length == 0) && !USB_Tx_ZLP)
     {
-      USB_Tx_ptr = USART_Rx_ptr_out;
-      USB_Tx_length = VIRTUAL_COM_PORT_DATA_SIZE;
-      
-      USART_Rx_ptr_out += VIRTUAL_COM_PORT_DATA_SIZE;	
-      USART_Rx_length -= VIRTUAL_COM_PORT_DATA_SIZE;	
+      break;
+    }
+
+    USB_Tx_length = (USART_Rx_length > VIRTUAL_COM_PORT_DATA_SIZE) ?
+                    VIRTUAL_COM_PORT_DATA_SIZE : USART_Rx_length;
+
+    /* The buffer of the application is given by SW_BUF (DTOG_RX) */
+    USB_Tx_addr = (GetENDPOINT(ENDP1) & EP_DTOG_RX) ? ENDP1_BUF1Addr : ENDP1_BUF0Addr;
+
+    part = USART_RX_DATA_SIZE - USART_Rx_ptr_out;
+    if (USB_Tx_length <= part)
+    {
+      UserToPMABufferCopy(&USART_Rx_Buffer[USART_Rx_ptr_out], USB_Tx_addr, USB_Tx_length);
     }
     else
     {
-      USB_Tx_ptr = USART_Rx_ptr_out;
-      USB_Tx_length = USART_Rx_length;
-      
-      USART_Rx_ptr_out += USART_Rx_length;
-      USART_Rx_length = 0;
+      memcpy(USB_Tx_Wrap, &USART_Rx_Buffer[USART_Rx_ptr_out], part);
+      memcpy((uint8_t *)USB_Tx_Wrap + part, USART_Rx_Buffer, USB_Tx_length - part);
+      UserToPMABufferCopy((uint8_t *)USB_Tx_Wrap, USB_Tx_addr, USB_Tx_length);
     }
-    USB_Tx_State = 1; 
-    UserToPMABufferCopy(&USART_Rx_Buffer[USB_Tx_ptr], ENDP1_TXADDR, USB_Tx_length);
-    SetEPTxCount(ENDP1, USB_Tx_length);
-    SetEPTxValid(ENDP1); 
-  }  
-  
+    USART_Rx_ptr_out = (USART_Rx_ptr_out + USB_Tx_length) % USART_RX_DATA_SIZE;
+    USART_Rx_length -= USB_Tx_length;
+
+    if (USB_Tx_addr == ENDP1_BUF1Addr)
+    {
+      SetEPDblBuf1Count(ENDP1, EP_DBUF_IN, USB_Tx_length);
+    }
+    else
+    {
+      SetEPDblBuf0Count(ENDP1, EP_DBUF_IN, USB_Tx_length);
+    }
+    FreeUserBuffer(ENDP1, EP_DBUF_IN);
+
+    USB_Tx_State++;
+    USB_Tx_ZLP = (USB_Tx_length == VIRTUAL_COM_PORT_DATA_SIZE);
+  }
+
+#ifdef EVAL_COM1_FLOW_CONTROL
+  /* The space freed by the packets just given to ENDP1 */
+  USART_RTS_Update();
+#endif /* EVAL_COM1_FLOW_CONTROL */
 }
+
 /*******************************************************************************
 * Function Name  : UART_To_USB_Send_Data.
 * Description    : send the received data from UART 0 to USB.
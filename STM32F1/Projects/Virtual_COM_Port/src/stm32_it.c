@@ -197,6 +197,45 @@ void EVAL_COM1_IRQHandler(void)
   }
 }
 
+#ifdef EVAL_COM1_TX_DMA_CHANNEL
+/*******************************************************************************
+* Function Name  : EVAL_COM1_TX_DMA_IRQHandler
+* Description    : This function handles the end of the EVAL_COM1 TX DMA.
+* Input          : None
+* Output         : None
+* Return         : None
+*******************************************************************************/
+void EVAL_COM1_TX_DMA_IRQHandler(void)
+{
+  if (DMA_GetFlagStatus(EVAL_COM1_TX_DMA_FLAG_TC) != RESET)
+  {
+    DMA_ClearFlag(EVAL_COM1_TX_DMA_FLAG_TC);
+    DMA_Cmd(EVAL_COM1_TX_DMA_CHANNEL, DISABLE);
+
+    /* The OUT packet is sent, start the next one */
+    USART_Tx_DMA_Done();
+  }
+}
+#endif /* EVAL_COM1_TX_DMA_CHANNEL */
+
+#ifdef EVAL_COM1_FLOW_CONTROL
+/*******************************************************************************
+* Function Name  : EVAL_COM1_CTS_IRQHandler
+* Description    : This function handles the edges of the EVAL_COM1 CTS input.
+* Input          : None
+* Output         : None
+* Return         : None
+*******************************************************************************/
+void EVAL_COM1_CTS_IRQHandler(void)
+{
+  if (EXTI_GetITStatus(EVAL_COM1_CTS_EXTI_LINE) != RESET)
+  {
+    EXTI_ClearITPendingBit(EVAL_COM1_CTS_EXTI_LINE);
+    USART_CTS_Update();
+  }
+}
+#endif /* EVAL_COM1_FLOW_CONTROL */
+
 /*******************************************************************************
 * Function Name  : USB_FS_WKUP_IRQHandler
 * Description    : This function handles USB WakeUp interrupt request.
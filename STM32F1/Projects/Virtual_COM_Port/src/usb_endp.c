@@ -42,10 +42,9 @@
 
 /* Private macro -------------------------------------------------------------*/
 /* Private variables ---------------------------------------------------------*/
+#ifndef EVAL_COM1_TX_DMA_CHANNEL
 uint8_t USB_Rx_Buffer[VIRTUAL_COM_PORT_DATA_SIZE];
-extern  uint8_t USART_Rx_Buffer[];
-extern uint32_t USART_Rx_ptr_out;
-extern uint32_t USART_Rx_length;
+#endif /* EVAL_COM1_TX_DMA_CHANNEL, read into the TX ring */
 extern uint8_t  USB_Tx_State;
 
 /* Private function prototypes -----------------------------------------------*/
@@ -60,37 +59,12 @@ extern uint8_t  USB_Tx_State;
 *******************************************************************************/
 void EP1_IN_Callback (void)
 {
-  uint16_t USB_Tx_ptr;
-  uint16_t USB_Tx_length;
-  
-  if (USB_Tx_State == 1)
+  /* One of the buffers is sent, fill it again at once */
+  if (USB_Tx_State != 0)
   {
-    if (USART_Rx_length == 0) 
-    {
-      USB_Tx_State = 0;
-    }
-    else 
-    {
-      if (USART_Rx_length > VIRTUAL_COM_PORT_DATA_SIZE){
-        USB_Tx_ptr = USART_Rx_ptr_out;
-        USB_Tx_length = VIRTUAL_COM_PORT_DATA_SIZE;
-        
-        USART_Rx_ptr_out += VIRTUAL_COM_PORT_DATA_SIZE;
-        USART_Rx_length -= VIRTUAL_COM_PORT_DATA_SIZE;    
-      }
-      else 
-      {
-        USB_Tx_ptr = USART_Rx_ptr_out;
-        USB_Tx_length = USART_Rx_length;
-        
-        USART_Rx_ptr_out += USART_Rx_length;
-        USART_Rx_length = 0;
-      }
-      UserToPMABufferCopy(&USART_Rx_Buffer[USB_Tx_ptr], ENDP1_TXADDR, USB_Tx_length);
-      SetEPTxCount(ENDP1, USB_Tx_length);
-      SetEPTxValid(ENDP1); 
-    }
+    USB_Tx_State--;
   }
+  Handle_USBAsynchXfer();
 }
 
 /*******************************************************************************
@@ -104,6 +78,12 @@ void EP3_OUT_Callback(void)
 {
   uint16_t USB_Rx_Cnt;
   
+#ifdef EVAL_COM1_TX_DMA_CHANNEL
+  /* The packet goes to the TX ring, the next ones are received while the TX
+  DMA sends it and NAKed while the ring is full */
+  USB_Rx_Cnt = USB_SIL_Read(EP3_OUT, USB_To_USART_Buffer());
+  USB_To_USART_Commit(USB_Rx_Cnt);
+#else
   /* Get the received data buffer and update the counter */
   USB_Rx_Cnt = USB_SIL_Read(EP3_OUT, USB_Rx_Buffer);
   
@@ -114,6 +94,7 @@ void EP3_OUT_Callback(void)
  
   /* Enable the receive of data on EP3 */
   SetEPRxValid(ENDP3);
+#endif /* EVAL_COM1_TX_DMA_CHANNEL */
 }
 
 
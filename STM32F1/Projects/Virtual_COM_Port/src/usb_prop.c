@@ -39,6 +39,7 @@
 /* Private macro -------------------------------------------------------------*/
 /* Private variables ---------------------------------------------------------*/
 uint8_t Request = 0;
+extern uint8_t USB_Tx_State;
 
 LINE_CODING linecoding =
   {
@@ -168,11 +169,17 @@ void Virtual_Com_Port_Reset(void)
   SetEPRxCount(ENDP0, Device_Property.MaxPacketSize);
   SetEPRxValid(ENDP0);
 
-  /* Initialize Endpoint 1 */
+  /* Initialize Endpoint 1, double buffered: it NAKs while both buffers
+     are free */
   SetEPType(ENDP1, EP_BULK);
-  SetEPTxAddr(ENDP1, ENDP1_TXADDR);
-  SetEPTxStatus(ENDP1, EP_TX_NAK);
+  SetEPDoubleBuff(ENDP1);
+  SetEPDblBuffAddr(ENDP1, ENDP1_BUF0Addr, ENDP1_BUF1Addr);
+  SetEPDblBuffCount(ENDP1, EP_DBUF_IN, 0);
+  ClearDTOG_RX(ENDP1);
+  ClearDTOG_TX(ENDP1);
   SetEPRxStatus(ENDP1, EP_RX_DIS);
+  SetEPTxStatus(ENDP1, EP_TX_VALID);
+  USB_Tx_State = 0;
 
   /* Initialize Endpoint 2 */
   SetEPType(ENDP2, EP_INTERRUPT);
@@ -20,7 +20,101 @@
  *  You should have received a copy of the GNU General Public License
  *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
  */
+#include <stddef.h>
 #include "SPIDevice.h"
+#include "PowerManager.h"
+#include "DMAManager.h"
+#include "Trace.h"
+
+/**Queue of transfers, the first one is being done by the DMA.*/
+static tSPITransfer *volatile queueHead = NULL;
+static tSPITransfer *queueTail = NULL;
+/**Device the bus is configured for, NULL before the first select.*/
+static tSPIDevice *deviceConfigured = NULL;
+/**Device kept selected by a transfer with keepSelected.*/
+static tSPIDevice *deviceSelected = NULL;
+/**The head of the queue was started, by the callback of the last one.*/
+static unsigned char transferBegun;
+/**Byte sent and byte dropped by the transfers without a buffer.*/
+static const unsigned char transferIdle = 0xFF;
+static unsigned char transferDummy;
+
+static void SPIDeviceConfigure(tSPIDevice *device);
+static void SPIDeviceTransferBegin(tSPITransfer *transfer);
+
+#ifdef USE_DMA_MANAGER
+static void SPIDeviceGranted(tDMAManagerUser *user);
+
+/**Channels 2 (RX) and 3 (TX) of DMA1, taken for each transfer.*/
+static tDMAManagerUser dmaRx = {DMA_REQUEST_SPI1_RX, SPI_DMA_PRIORITY, SPIDeviceGranted, SPIDeviceInterruptHandler, NULL};
+static tDMAManagerUser dmaTx = {DMA_REQUEST_SPI1_TX, SPI_DMA_PRIORITY, SPIDeviceGranted, NULL, NULL};
+/**The same channels for the blocking transfers, which never wait.*/
+static tDMAManagerUser blockingRx = {DMA_REQUEST_SPI1_RX, SPI_DMA_PRIORITY, NULL, NULL, NULL};
+static tDMAManagerUser blockingTx = {DMA_REQUEST_SPI1_TX, SPI_DMA_PRIORITY, NULL, NULL, NULL};
+#endif
+
+/**
+ * Configures SPI1 as master on PA5 (SCK), PA6 (MISO) and PA7 (MOSI), mode 0
+ * at PCLK2 / 256, and the interrupt of the queued transfers.
+ */
+void SPIInit(void)
+{
+    GPIO_InitTypeDef GPIO_InitStructure;
+    SPI_InitTypeDef SPI_InitStructure;
+    NVIC_InitTypeDef NVIC_InitStructure;
+
+    RCC_APB2PeriphClockCmd(RCC_APB2Periph_GPIOA | RCC_APB2Periph_SPI1, ENABLE);
+    RCC_AHBPeriphClockCmd(RCC_AHBPeriph_DMA1, ENABLE);
+
+    GPIO_InitStructure.GPIO_Pin = GPIO_Pin_5 | GPIO_Pin_7;
+    GPIO_InitStructure.GPIO_Mode = GPIO_Mode_AF_PP;
+    GPIO_InitStructure.GPIO_Speed = GPIO_Speed_50MHz;
+    GPIO_Init(GPIOA, &GPIO_InitStructure);
+
+    GPIO_InitStructure.GPIO_Pin = GPIO_Pin_6;
+    GPIO_InitStructure.GPIO_Mode = GPIO_Mode_IN_FLOATING;
+    GPIO_Init(GPIOA, &GPIO_InitStructure);
+
+    SPI_InitStructure.SPI_Direction = SPI_Direction_2Lines_FullDuplex;
+    SPI_InitStructure.SPI_Mode = SPI_Mode_Master;
+    SPI_InitStructure.SPI_DataSize = SPI_DataSize_8b;
+    SPI_InitStructure.SPI_CPOL = SPI_CPOL_Low;
+    SPI_InitStructure.SPI_CPHA = SPI_CPHA_1Edge;
+    SPI_InitStructure.SPI_NSS = SPI_NSS_Soft;
+    SPI_InitStructure.SPI_BaudRatePrescaler = SPI_BaudRatePrescaler_256;
+    SPI_InitStructure.SPI_FirstBit = SPI_FirstBit_MSB;
+    SPI_InitStructure.SPI_CRCPolynomial = 7;
+    SPI_Init(SPI1, &SPI_InitStructure);
+    SPI_Cmd(SPI1, ENABLE);
+
+    NVIC_InitStructure.NVIC_IRQChannel = DMA1_Channel2_IRQn;
+    NVIC_InitStructure.NVIC_IRQChannelPreemptionPriority = SPI_IRQ_PRIORITY;
+    NVIC_InitStructure.NVIC_IRQChannelSubPriority = 0;
+    NVIC_InitStructure.NVIC_IRQChannelCmd = ENABLE;
+    NVIC_Init(&NVIC_InitStructure);
+
+    deviceConfigured = NULL;
+}
+
+/**
+ * Configures a chip select pin as a push-pull output, deselected.
+ * @param port Port of the pin, e.g. GPIOB.
+ * @param pin Pin, e.g. GPIO_Pin_4.
+ */
+void SPIInitSelect(GPIO_TypeDef *port, uint16_t pin)
+{
+    GPIO_InitTypeDef GPIO_InitStructure;
+
+    //the clock enables of GPIOA to GPIOG follow the order of the ports
+    RCC_APB2PeriphClockCmd(RCC_APB2Periph_GPIOA << (((uint32_t) port - GPIOA_BASE) / 0x400), ENABLE);
+
+    GPIO_SetBits(port, pin);
+
+    GPIO_InitStructure.GPIO_Pin = pin;
+    GPIO_InitStructure.GPIO_Mode = GPIO_Mode_Out_PP;
+    GPIO_InitStructure.GPIO_Speed = GPIO_Speed_50MHz;
+    GPIO_Init(port, &GPIO_InitStructure);
+}
 
 /**
  * Hardware dependent funtion to write to SPI module. The module must be
@@ -43,6 +137,51 @@ unsigned char SPIWrite(unsigned char data)
     return SPI_I2S_ReceiveData(SPI1);
 }
 
+/**
+ * Sets the clock of SPI1 to the fastest PCLK2 prescaler (2 to 256) that is
+ * not above a rate, or to PCLK2 / 256 if they all are. The rest of the
+ * configuration of the module is kept.
+ * @param kHz Highest clock.
+ * @return Clock set, in kHz.
+ */
+unsigned long SPISetClock(unsigned long kHz)
+{
+    RCC_ClocksTypeDef clocks;
+    unsigned long set;
+    uint16_t prescaler = 0;
+
+    RCC_GetClocksFreq(&clocks);
+    set = clocks.PCLK2_Frequency / 2000;
+
+    while ((set > kHz) && (prescaler < 7))
+    {
+        set >>= 1;
+        prescaler++;
+    }
+
+    while (SPIDeviceIsBusy());
+
+    /*!< The baud rate is changed with the module disabled */
+    while (SPI_I2S_GetFlagStatus(SPI1, SPI_I2S_FLAG_BSY) == SET);
+    SPI1->CR1 &= ~SPI_CR1_SPE;
+    SPI1->CR1 = (SPI1->CR1 & ~SPI_CR1_BR) | (prescaler << 3);
+    SPI1->CR1 |= SPI_CR1_SPE;
+
+    deviceConfigured = NULL;
+
+    return set;
+}
+
+/**
+ * Gives the clock the bus is set to, for the descriptor of a device that
+ * keeps the clock set by SPISetClock().
+ * @return SPI_DEVICE_CLOCK_DIV_2 to _256.
+ */
+unsigned char SPIGetClock(void)
+{
+    return (unsigned char) ((SPI1->CR1 & SPI_CR1_BR) >> 3);
+}
+
 /**
  * Hardware dependent funtion to read from SPI module. The module must be
  * configured by the user.
@@ -53,6 +192,441 @@ unsigned char SPIRead(void)
     return (SPIWrite(0x00));
 }
 
+/**
+ * Starts moving a buffer through SPI1 with DMA1, channel 2 receives and
+ * channel 3 transmits.
+ * @param tx Bytes to send, or a single byte sent again if txIncrement is not
+ *           set.
+ * @param rx Buffer of the bytes received, or a single byte written again if
+ *           rxIncrement is not set.
+ * @param length Number of bytes, not more than 65535.
+ * @param interrupt ENABLE for the interrupt of channel 2 when the last byte
+ *                  is received.
+ */
+static void SPIDeviceStartDMA(const unsigned char *tx, unsigned char txIncrement,
+                              unsigned char *rx, unsigned char rxIncrement,
+                              unsigned int length, FunctionalState interrupt)
+{
+    DMA_InitTypeDef DMA_InitStructure;
+
+    RCC_AHBPeriphClockCmd(RCC_AHBPeriph_DMA1, ENABLE);
+
+    /*!< Byte left in DR by a previous transfer */
+    while (SPI_I2S_GetFlagStatus(SPI1, SPI_I2S_FLAG_BSY) == SET);
+    SPI_I2S_ReceiveData(SPI1);
+
+    DMA_InitStructure.DMA_PeripheralBaseAddr = (uint32_t) &SPI1->DR;
+    DMA_InitStructure.DMA_BufferSize = length;
+    DMA_InitStructure.DMA_PeripheralInc = DMA_PeripheralInc_Disable;
+    DMA_InitStructure.DMA_PeripheralDataSize = DMA_PeripheralDataSize_Byte;
+    DMA_InitStructure.DMA_MemoryDataSize = DMA_MemoryDataSize_Byte;
+    DMA_InitStructure.DMA_Mode = DMA_Mode_Normal;
+    DMA_InitStructure.DMA_M2M = DMA_M2M_Disable;
+
+    DMA_DeInit(DMA1_Channel2);
+    DMA_InitStructure.DMA_MemoryBaseAddr = (uint32_t) rx;
+    DMA_InitStructure.DMA_DIR = DMA_DIR_PeripheralSRC;
+    DMA_InitStructure.DMA_MemoryInc = rxIncrement ? DMA_MemoryInc_Enable : DMA_MemoryInc_Disable;
+    /*!< The receive channel goes first so that no byte is overrun */
+    DMA_InitStructure.DMA_Priority = DMA_Priority_VeryHigh;
+    DMA_Init(DMA1_Channel2, &DMA_InitStructure);
+
+    DMA_DeInit(DMA1_Channel3);
+    DMA_InitStructure.DMA_MemoryBaseAddr = (uint32_t) tx;
+    DMA_InitStructure.DMA_DIR = DMA_DIR_PeripheralDST;
+    DMA_InitStructure.DMA_MemoryInc = txIncrement ? DMA_MemoryInc_Enable : DMA_MemoryInc_Disable;
+    DMA_InitStructure.DMA_Priority = DMA_Priority_High;
+    DMA_Init(DMA1_Channel3, &DMA_InitStructure);
+
+    DMA_ITConfig(DMA1_Channel2, DMA_IT_TC, interrupt);
+    DMA_Cmd(DMA1_Channel2, ENABLE);
+    DMA_Cmd(DMA1_Channel3, ENABLE);
+    SPI_I2S_DMACmd(SPI1, SPI_I2S_DMAReq_Rx | SPI_I2S_DMAReq_Tx, ENABLE);
+}
+
+/**
+ * Stops the channels of a transfer started by SPIDeviceStartDMA(), after
+ * the last byte is received.
+ */
+static void SPIDeviceStopDMA(void)
+{
+    SPI_I2S_DMACmd(SPI1, SPI_I2S_DMAReq_Rx | SPI_I2S_DMAReq_Tx, DISABLE);
+    DMA_Cmd(DMA1_Channel3, DISABLE);
+    DMA_Cmd(DMA1_Channel2, DISABLE);
+    DMA_ClearFlag(DMA1_FLAG_GL2 | DMA1_FLAG_GL3);
+}
+
+/**
+ * Moves a buffer through SPI1 with DMA1, see SPIDeviceStartDMA(). Returns
+ * when the last byte is received.
+ */
+static void SPIDeviceTransferDMA(const unsigned char *tx, unsigned char txIncrement,
+                                 unsigned char *rx, unsigned char rxIncrement,
+                                 unsigned int length)
+{
+#ifdef USE_DMA_MANAGER
+    uint32_t primask;
+    bool acquired;
+
+    //both channels or none, a queued transfer can't take one in between
+    primask = __get_PRIMASK();
+    __disable_irq();
+
+    acquired = DMAManagerTryAcquire(&blockingRx);
+    if (acquired && !DMAManagerTryAcquire(&blockingTx))
+    {
+        DMAManagerRelease(&blockingRx);
+        acquired = false;
+    }
+
+    __set_PRIMASK(primask);
+
+    //byte by byte while another driver or a queued transfer has them
+    if (!acquired)
+    {
+        while (length--)
+        {
+            *rx = SPIWrite(*tx);
+            tx += txIncrement;
+            rx += rxIncrement;
+        }
+        return;
+    }
+#endif
+
+    SPIDeviceStartDMA(tx, txIncrement, rx, rxIncrement, length, DISABLE);
+
+    while (DMA_GetFlagStatus(DMA1_FLAG_TC2) == RESET);
+
+    SPIDeviceStopDMA();
+
+#ifdef USE_DMA_MANAGER
+    DMAManagerRelease(&blockingTx);
+    DMAManagerRelease(&blockingRx);
+#endif
+}
+
+/**
+ * Sends data contained in a buffer over the SPI bus, with DMA from
+ * SPI_DMA_MIN_LENGTH bytes.
+ *
+ * \param[in] data A pointer to the buffer which contains the data to send.
+ * \param[in] data_len The number of bytes to send.
+ */
+void SPIDeviceSendData(const unsigned char *data, unsigned int data_len)
+{
+    unsigned char dummy;
+
+    if (data_len < SPI_DMA_MIN_LENGTH)
+    {
+        while (data_len--)
+        {
+            SPIWrite(*data++);
+        }
+        return;
+    }
+
+    while (data_len != 0)
+    {
+        unsigned int part = (data_len > 0xFFFF) ? 0xFFFF : data_len;
+
+        SPIDeviceTransferDMA(data, 1, &dummy, 0, part);
+        data += part;
+        data_len -= part;
+    }
+}
+
+/**
+ * Receives multiple bytes from the SPI bus and writes them to a buffer, with
+ * DMA from SPI_DMA_MIN_LENGTH bytes. 0xFF is sent meanwhile.
+ *
+ * \param[out] buffer A pointer to the buffer into which the data gets written.
+ * \param[in] buffer_len The number of bytes to read.
+ */
+void SPIDeviceReceiveData(unsigned char *buffer, unsigned int buffer_len)
+{
+    static const unsigned char idle = 0xFF;
+
+    if (buffer_len < SPI_DMA_MIN_LENGTH)
+    {
+        while (buffer_len--)
+        {
+            *buffer++ = SPIWrite(0xFF);
+        }
+        return;
+    }
+
+    while (buffer_len != 0)
+    {
+        unsigned int part = (buffer_len > 0xFFFF) ? 0xFFFF : buffer_len;
+
+        SPIDeviceTransferDMA(&idle, 0, buffer, 1, part);
+        buffer += part;
+        buffer_len -= part;
+    }
+}
+
+/**
+ * Initializes the descriptor of a device, with its chip select configured
+ * and deselected.
+ * @param device Descriptor of the device.
+ * @param csPort Port of the chip select pin, e.g. GPIOB.
+ * @param csMask Pin of the chip select, e.g. GPIO_Pin_4.
+ * @param mode SPI mode, 0 to 3.
+ * @param clock SPI_DEVICE_CLOCK_DIV_2 to _256.
+ */
+void SPIDeviceInit(tSPIDevice *device,
+                   GPIO_TypeDef *csPort,
+                   uint16_t csMask,
+                   unsigned char mode,
+                   unsigned char clock)
+{
+    device->csPort = csPort;
+    device->csMask = csMask;
+    device->mode = mode;
+    device->clock = clock;
+
+    SPIInitSelect(csPort, csMask);
+}
+
+/**
+ * Changes the clock of a device, e.g. an SD card after its initialization.
+ * Used from the next select.
+ * @param device Descriptor of the device.
+ * @param clock SPI_DEVICE_CLOCK_DIV_2 to _256.
+ */
+void SPIDeviceSetClock(tSPIDevice *device, unsigned char clock)
+{
+    device->clock = clock;
+
+    if (deviceConfigured == device)
+    {
+        deviceConfigured = NULL;
+    }
+}
+
+/**
+ * Selects a device for the polled functions (SPIWrite(), SPIDeviceSendData()
+ * ...), after the queued transfers end.
+ * @param device Descriptor of the device.
+ */
+void SPIDeviceSelect(tSPIDevice *device)
+{
+    while (SPIDeviceIsBusy());
+
+    if (deviceSelected != NULL && deviceSelected != device)
+    {
+        GPIO_SetBits(deviceSelected->csPort, deviceSelected->csMask);
+    }
+
+    deviceSelected = NULL;
+    SPIDeviceConfigure(device);
+    GPIO_ResetBits(device->csPort, device->csMask);
+}
+
+/**
+ * Deselects a device selected by SPIDeviceSelect().
+ * @param device Descriptor of the device.
+ */
+void SPIDeviceDeselect(tSPIDevice *device)
+{
+    GPIO_SetBits(device->csPort, device->csMask);
+}
+
+/**
+ * Starts a full duplex transfer that runs in the background, the whole
+ * buffer by DMA and one interrupt at the end. The device is configured and
+ * selected at the start and deselected at the end. If the bus is busy the
+ * transfer waits in a queue, so the drivers of several devices share the
+ * bus, and the transfers run in order. SPIDeviceInterruptHandler() must be
+ * called from DMA1_Channel2_IRQHandler().
+ * @param transfer Transfer to do, it must stay valid until it ends.
+ * @return 0 if the transfer was started or queued, !=0 if it is not valid
+ *         or already queued.
+ */
+unsigned char SPIDeviceStartTransfer(tSPITransfer *transfer)
+{
+    uint32_t primask;
+
+    if (transfer == NULL || transfer->device == NULL ||
+        transfer->length == 0 || transfer->length > 0xFFFF ||
+        transfer->status == SPI_TRANSFER_BUSY)
+        return 1;
+
+    transfer->status = SPI_TRANSFER_BUSY;
+    transfer->next = NULL;
+
+    //the interrupt also changes the queue
+    primask = __get_PRIMASK();
+    __disable_irq();
+
+    if (queueHead == NULL)
+    {
+        queueHead = transfer;
+        queueTail = transfer;
+#ifdef USE_POWER_MANAGER
+        PowerManagerKeepAwake(POWER_MODE_STOP);
+#endif
+        SPIDeviceTransferBegin(transfer);
+    }
+    else
+    {
+        queueTail->next = transfer;
+        queueTail = transfer;
+    }
+
+    __set_PRIMASK(primask);
+
+    return 0;
+}
+
+/**
+ * Tells if interrupt driven transfers are running or queued.
+ * @return !=0 while a transfer is running.
+ */
+unsigned char SPIDeviceIsBusy(void)
+{
+    return queueHead != NULL;
+}
+
+/**
+ * This funtion is intended to be put in DMA1_Channel2_IRQHandler(), it ends
+ * the current transfer and starts the next one.
+ * @remarks This funtion checks and clears the transfer complete flag of the
+ * channel, it does nothing if the flag is not set or no transfer is
+ * running.
+ */
+void SPIDeviceInterruptHandler(void)
+{
+    tSPITransfer *transfer = queueHead;
+
+    if (DMA_GetITStatus(DMA1_IT_TC2) == RESET)
+        return;
+
+    SPIDeviceStopDMA();
+
+    if (transfer == NULL)
+        return;
+
+    TRACE_ISR_ENTER(DMA1_Channel2_IRQn);
+
+#ifdef USE_DMA_MANAGER
+    //the channels go to the waiting drivers between the transfers
+    DMAManagerRelease(&dmaTx);
+    DMAManagerRelease(&dmaRx);
+#endif
+
+    if (transfer->keepSelected)
+    {
+        deviceSelected = transfer->device;
+    }
+    else
+    {
+        deviceSelected = NULL;
+        GPIO_SetBits(transfer->device->csPort, transfer->device->csMask);
+    }
+
+    queueHead = transfer->next;
+
+    if (queueHead == NULL)
+    {
+        queueTail = NULL;
+#ifdef USE_POWER_MANAGER
+        PowerManagerAllow(POWER_MODE_STOP);
+#endif
+    }
+
+    transfer->status = SPI_TRANSFER_DONE;
+    transferBegun = 0;
+    TRACE(TRACE_EVENT_SPI_END, transfer->length);
+
+    if (transfer->callback != NULL)
+    {
+        transfer->callback(transfer);
+    }
+
+    //next transfer, queued by another driver or the callback, which starts
+    //it itself when the queue was empty
+    if (queueHead != NULL && !transferBegun)
+    {
+        SPIDeviceTransferBegin(queueHead);
+    }
+
+    TRACE_ISR_EXIT(DMA1_Channel2_IRQn);
+}
+
+/**
+ * Sets the mode and the clock of a device, if the bus is not already set
+ * for it. The module is disabled while they change.
+ */
+static void SPIDeviceConfigure(tSPIDevice *device)
+{
+    if (deviceConfigured == device)
+        return;
+
+    while (SPI_I2S_GetFlagStatus(SPI1, SPI_I2S_FLAG_BSY) == SET);
+    SPI1->CR1 &= ~SPI_CR1_SPE;
+    SPI1->CR1 = (SPI1->CR1 & ~(SPI_CR1_BR | SPI_CR1_CPOL | SPI_CR1_CPHA)) |
+        ((uint16_t) device->clock << 3) | (device->mode & 0x03);
+    SPI1->CR1 |= SPI_CR1_SPE;
+
+    deviceConfigured = device;
+}
+
+/**
+ * Configures the bus, selects the device and starts the DMA of the
+ * transfer.
+ */
+static void SPIDeviceTransferBegin(tSPITransfer *transfer)
+{
+#ifdef USE_DMA_MANAGER
+    //the transfer waits for the channels, SPIDeviceGranted() begins it
+    if (DMAManagerAcquire(&dmaRx) != DMA_MANAGER_GRANTED ||
+        DMAManagerAcquire(&dmaTx) != DMA_MANAGER_GRANTED)
+        return;
+#endif
+
+    //a device left selected is released unless the transfer continues it
+    if (deviceSelected != NULL && deviceSelected != transfer->device)
+    {
+        GPIO_SetBits(deviceSelected->csPort, deviceSelected->csMask);
+    }
+
+    deviceSelected = NULL;
+    transferBegun = 1;
+    TRACE(TRACE_EVENT_SPI_BEGIN, transfer->length);
+
+    SPIDeviceConfigure(transfer->device);
+    GPIO_ResetBits(transfer->device->csPort, transfer->device->csMask);
+
+    SPIDeviceStartDMA(transfer->txData != NULL ? transfer->txData : &transferIdle,
+                      transfer->txData != NULL,
+                      transfer->rxData != NULL ? transfer->rxData : &transferDummy,
+                      transfer->rxData != NULL,
+                      transfer->length, ENABLE);
+}
+
+#ifdef USE_DMA_MANAGER
+
+/**
+ * Begins the head of the queue when a channel it waited for is given.
+ */
+static void SPIDeviceGranted(tDMAManagerUser *user)
+{
+    uint32_t primask;
+
+    primask = __get_PRIMASK();
+    __disable_irq();
+
+    if (queueHead != NULL && !transferBegun)
+    {
+        SPIDeviceTransferBegin(queueHead);
+    }
+
+    __set_PRIMASK(primask);
+}
+#endif
+
 /**
  * Read multiple bytes from a device register.
  * @param length Number of bytes to read
@@ -210,40 +784,3 @@ void SPIDeviceWriteBytes(unsigned char length,
 //{
 //    SPIDeviceWriteBytes(address, 1, &value);
 //}
-//
-///**
-// * Sends data contained in a buffer over the SPI bus.
-// *
-// * \param[in] data A pointer to the buffer which contains the data to send.
-// * \param[in] data_len The number of bytes to send.
-// */
-//void SPIDeviceSendData(const unsigned char *data, unsigned int data_len)
-//{
-//    do
-//    {
-//        unsigned char b = *data++;
-//
-//        SPIWrite(b);
-//
-//    }
-//    while (--data_len);
-//}
-//
-///**
-// * Receives multiple bytes from the SPI bus and writes them to a buffer.
-// *
-// * \param[out] buffer A pointer to the buffer into which the data gets written.
-// * \param[in] buffer_len The number of bytes to read.
-// */
-//void SPIDeviceReceiveData(unsigned char *buffer, unsigned int buffer_len)
-//{
-//    --buffer;
-//
-//    do
-//    {
-//        ++buffer;
-//        *buffer = SPIRead();
-//
-//    }
-//    while (--buffer_len);
-//}
@@ -25,7 +25,89 @@
 
 #include <stm32f10x.h>
 
+/**Shorter buffers are moved byte by byte, the DMA setup would take longer.*/
+#ifndef SPI_DMA_MIN_LENGTH
+#define SPI_DMA_MIN_LENGTH      16
+#endif
+
+/**Priority of the DMA1 channel 2 interrupt of the queued transfers.*/
+#ifndef SPI_IRQ_PRIORITY
+#define SPI_IRQ_PRIORITY        2
+#endif
+
+/**Order of the queued transfers among the drivers waiting for channels 2
+ and 3 of DMA1, with USE_DMA_MANAGER.*/
+#ifndef SPI_DMA_PRIORITY
+#define SPI_DMA_PRIORITY        1
+#endif
+
+/**Clock values of a device, PCLK2 divided by 2 to 256 (the BR field of
+ SPI1 CR1).*/
+#define SPI_DEVICE_CLOCK_DIV_2      0
+#define SPI_DEVICE_CLOCK_DIV_4      1
+#define SPI_DEVICE_CLOCK_DIV_8      2
+#define SPI_DEVICE_CLOCK_DIV_16     3
+#define SPI_DEVICE_CLOCK_DIV_32     4
+#define SPI_DEVICE_CLOCK_DIV_64     5
+#define SPI_DEVICE_CLOCK_DIV_128    6
+#define SPI_DEVICE_CLOCK_DIV_256    7
+
+/**
+ * A device on the SPI bus. The bus is configured with its mode and clock
+ * every time it is selected, so devices with different settings share it.
+ */
+typedef struct _tSPIDevice
+{
+    /**Port of the chip select pin, the select is active low.*/
+    GPIO_TypeDef *csPort;
+    /**Pin of the chip select, GPIO_Pin_0 to GPIO_Pin_15.*/
+    uint16_t csMask;
+    /**SPI mode, 0 to 3 (CPOL << 1 | CPHA).*/
+    unsigned char mode;
+    /**Clock, SPI_DEVICE_CLOCK_DIV_2 to _256.*/
+    unsigned char clock;
+} tSPIDevice;
+
+/**
+ * Status of an interrupt driven transfer.
+ */
+typedef enum
+{
+    SPI_TRANSFER_IDLE,
+    SPI_TRANSFER_BUSY,
+    SPI_TRANSFER_DONE
+} tSPITransferStatus;
+
+/**
+ * Full duplex transfer done by DMA, see SPIDeviceStartTransfer(). The
+ * structure and the buffers must stay valid until the transfer ends.
+ */
+typedef struct _tSPITransfer
+{
+    /**Device of the transfer.*/
+    tSPIDevice *device;
+    /**Bytes to send, NULL to send 0xFF.*/
+    const unsigned char *txData;
+    /**Buffer for the bytes received, NULL to drop them.*/
+    unsigned char *rxData;
+    /**Number of bytes, not more than 65535.*/
+    unsigned int length;
+    /**Not 0 to keep the device selected at the end, for a command in
+     several transfers. The next transfer must be to the same device.*/
+    unsigned char keepSelected;
+    /**Called from the interrupt when the transfer ends, can be NULL.*/
+    void (*callback)(struct _tSPITransfer *transfer);
+    /**Status, can be polled instead of using the callback.*/
+    volatile tSPITransferStatus status;
+    /**Next transfer in the queue.*/
+    struct _tSPITransfer *next;
+} tSPITransfer;
+
+void SPIInit(void);
+void SPIInitSelect(GPIO_TypeDef *port, uint16_t pin);
 unsigned char SPIWrite(unsigned char data);
+unsigned long SPISetClock(unsigned long kHz);
+unsigned char SPIGetClock(void);
 unsigned char SPIRead(void);
 
 unsigned char SPIDeviceReadBit(unsigned char address,
@@ -50,4 +132,16 @@ void SPIDeviceWriteBytes(unsigned char length,
                          unsigned char *data);
 void SPIDeviceSendData(const unsigned char *data, unsigned int data_len);
 void SPIDeviceReceiveData(unsigned char *buffer, unsigned int buffer_len);
+
+void SPIDeviceInit(tSPIDevice *device,
+                   GPIO_TypeDef *csPort,
+                   uint16_t csMask,
+                   unsigned char mode,
+                   unsigned char clock);
+void SPIDeviceSetClock(tSPIDevice *device, unsigned char clock);
+void SPIDeviceSelect(tSPIDevice *device);
+void SPIDeviceDeselect(tSPIDevice *device);
+unsigned char SPIDeviceStartTransfer(tSPITransfer *transfer);
+unsigned char SPIDeviceIsBusy(void);
+void SPIDeviceInterruptHandler(void);
 #endif /* _SPIDEV_H_ */
@@ -0,0 +1,175 @@
+/**
+ *  @file       StackMonitor.c
+ *  @author     Luis Maduro
+ *  @version    1.00
+ *  @date       14/10/2026
+ *  @brief      High-water mark of the stack, nesting and times of the
+ *              interrupts.
+ *
+ *  Copyright (C) 2026  Luis Maduro
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "StackMonitor.h"
+
+/**Bytes left unpainted below the stack pointer, for the calls of the
+ * painting.*/
+#define STACK_MONITOR_MARGIN        64
+
+tStackMonitorStatistics StackMonitorStatistics;
+
+/**Interrupts running, and the cycle counter at their entry.*/
+static volatile uint8_t nesting;
+static uint32_t entryTime[STACK_MONITOR_MAX_NESTING];
+
+/**
+ * Paints the stack below the stack pointer and starts the cycle counter.
+ * Called early in main(), before the deepest calls.
+ */
+void StackMonitorInit(void)
+{
+    volatile uint32_t *word = (volatile uint32_t *) ((STACK_MONITOR_BOTTOM + 3) & ~3UL);
+    uint32_t end = __get_MSP() - STACK_MONITOR_MARGIN;
+
+    while ((uint32_t) word < end)
+    {
+        *word++ = STACK_MONITOR_PAINT;
+    }
+
+    CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+    DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+
+    StackMonitorStatistics.StackSize = STACK_MONITOR_TOP - STACK_MONITOR_BOTTOM;
+    StackMonitorReset();
+    StackMonitorUpdate();
+}
+
+/**
+ * Finds the lowest word of the stack written since StackMonitorInit(), from
+ * a low priority task: it reads the stack from the bottom until the first
+ * word not painted.
+ * @return Most bytes of the stack used.
+ */
+uint32_t StackMonitorUpdate(void)
+{
+    const uint32_t *word = (const uint32_t *) ((STACK_MONITOR_BOTTOM + 3) & ~3UL);
+
+    while (((uint32_t) word < STACK_MONITOR_TOP) && (*word == STACK_MONITOR_PAINT))
+    {
+        word++;
+    }
+
+    StackMonitorStatistics.StackUsed = STACK_MONITOR_TOP - (uint32_t) word;
+
+    return StackMonitorStatistics.StackUsed;
+}
+
+/**
+ * Clears the nesting and the times of the interrupts, the stack is not
+ * painted again.
+ */
+void StackMonitorReset(void)
+{
+    uint32_t primask;
+    unsigned int i;
+
+    primask = __get_PRIMASK();
+    __disable_irq();
+
+    StackMonitorStatistics.MinStackPointer = STACK_MONITOR_TOP;
+    StackMonitorStatistics.MaxNesting = 0;
+
+    for (i = 0; i < STACK_MONITOR_EXCEPTIONS; i++)
+    {
+        StackMonitorStatistics.MaxRunTime[i] = 0;
+        StackMonitorStatistics.MaxLatency[i] = 0;
+    }
+
+    __set_PRIMASK(primask);
+}
+
+/**
+ * Keeps the latency of the current interrupt, measured by its routine.
+ * @param cycles Cycles between the event and the entry.
+ */
+void StackMonitorIsrLatency(uint32_t cycles)
+{
+    uint32_t exception = __get_IPSR();
+
+    if ((exception < STACK_MONITOR_EXCEPTIONS) &&
+        (cycles > StackMonitorStatistics.MaxLatency[exception]))
+        StackMonitorStatistics.MaxLatency[exception] = cycles;
+}
+
+/**
+ * This funtion is intended to be put at the start of an interrupt routine,
+ * through STACK_MONITOR_ISR_ENTER().
+ */
+void StackMonitorIsrEnter(void)
+{
+    uint32_t time = DWT->CYCCNT;
+    uint32_t sp = __get_MSP();
+    uint32_t primask;
+    uint8_t level;
+
+    //a higher priority interrupt can come in between
+    primask = __get_PRIMASK();
+    __disable_irq();
+
+    level = nesting++;
+
+    if (level < STACK_MONITOR_MAX_NESTING)
+        entryTime[level] = time;
+
+    if (nesting > StackMonitorStatistics.MaxNesting)
+        StackMonitorStatistics.MaxNesting = nesting;
+
+    if (sp < StackMonitorStatistics.MinStackPointer)
+        StackMonitorStatistics.MinStackPointer = sp;
+
+    __set_PRIMASK(primask);
+}
+
+/**
+ * This funtion is intended to be put at the end of an interrupt routine,
+ * through STACK_MONITOR_ISR_EXIT(), every return of the routine after
+ * STACK_MONITOR_ISR_ENTER() has to go through it.
+ */
+void StackMonitorIsrExit(void)
+{
+    uint32_t time = DWT->CYCCNT;
+    uint32_t exception = __get_IPSR();
+    uint32_t primask;
+    uint32_t run;
+    uint8_t level;
+
+    primask = __get_PRIMASK();
+    __disable_irq();
+
+    if (nesting != 0)
+    {
+        level = --nesting;
+
+        if ((level < STACK_MONITOR_MAX_NESTING) && (exception < STACK_MONITOR_EXCEPTIONS))
+        {
+            run = time - entryTime[level];
+
+            if (run > StackMonitorStatistics.MaxRunTime[exception])
+                StackMonitorStatistics.MaxRunTime[exception] = run;
+        }
+    }
+
+    __set_PRIMASK(primask);
+}
@@ -0,0 +1,112 @@
+/**
+ *  @file       StackMonitor.h
+ *  @author     Luis Maduro
+ *  @version    1.00
+ *  @date       14/10/2026
+ *  @brief      High-water mark of the stack, nesting and times of the
+ *              interrupts.
+ *
+ *  The kernels are cooperative, the tasks and all the interrupts share the
+ *  main stack, the interrupts nest on it by their priorities.
+ *  StackMonitorInit() paints the free stack, from STACK_MONITOR_BOTTOM to
+ *  the stack pointer, and StackMonitorUpdate() finds the lowest word
+ *  written since, the deepest the stack went.
+ *
+ *  STACK_MONITOR_ISR_ENTER() and STACK_MONITOR_ISR_EXIT(), at the start and
+ *  the end of the interrupt routines, keep in StackMonitorStatistics:
+ *  - the deepest nesting of the interrupts,
+ *  - the lowest stack pointer at the entry of an interrupt,
+ *  - the longest run, in cycles of the DWT, of each exception, with the
+ *    time of the interrupts nested in it.
+ *  The exception is read from the IPSR, the macros take no argument. The
+ *  latency between the event and the entry is only known by the routine,
+ *  i.e. from the counter of a timer, it gives it to
+ *  StackMonitorIsrLatency().
+ *
+ *  The bounds of the stack are the symbols of the linker scripts of
+ *  TrueSTUDIO and the GCC builds (_ebss and _estack), other toolchains
+ *  define STACK_MONITOR_BOTTOM and STACK_MONITOR_TOP. Without a heap the
+ *  whole RAM above the bss is the stack.
+ *
+ *  Copyright (C) 2026  Luis Maduro
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef STACKMONITOR_H
+#define STACKMONITOR_H
+
+#include <stdint.h>
+#include <stm32f10x.h>
+
+/**Uncomment to build the interrupt macros.*/
+//#define USE_STACK_MONITOR
+
+/**Lowest and highest address of the stack.*/
+#ifndef STACK_MONITOR_BOTTOM
+extern uint32_t _ebss;
+extern uint32_t _estack;
+#define STACK_MONITOR_BOTTOM        ((uint32_t) &_ebss)
+#define STACK_MONITOR_TOP           ((uint32_t) &_estack)
+#endif
+
+#define STACK_MONITOR_PAINT         0xC5C5C5C5UL
+
+/**Exceptions kept, the 16 of the core and the IRQs.*/
+#ifndef STACK_MONITOR_EXCEPTIONS
+#define STACK_MONITOR_EXCEPTIONS    (16 + 60)
+#endif
+
+/**Deepest nesting kept for the run times.*/
+#define STACK_MONITOR_MAX_NESTING   8
+
+typedef struct
+{
+    /**Bytes from STACK_MONITOR_BOTTOM to STACK_MONITOR_TOP.*/
+    uint32_t StackSize;
+    /**Most bytes of the stack used, by StackMonitorUpdate().*/
+    uint32_t StackUsed;
+    /**Lowest stack pointer at the entry of an interrupt.*/
+    uint32_t MinStackPointer;
+    /**Most interrupts nested.*/
+    uint8_t MaxNesting;
+    /**Longest run of each exception, by exception number (IRQn + 16).*/
+    uint32_t MaxRunTime[STACK_MONITOR_EXCEPTIONS];
+    /**Longest latency given by the routine of each exception.*/
+    uint32_t MaxLatency[STACK_MONITOR_EXCEPTIONS];
+} tStackMonitorStatistics;
+
+extern tStackMonitorStatistics StackMonitorStatistics;
+
+void StackMonitorInit(void);
+uint32_t StackMonitorUpdate(void);
+void StackMonitorReset(void);
+void StackMonitorIsrLatency(uint32_t cycles);
+
+#ifdef USE_STACK_MONITOR
+
+void StackMonitorIsrEnter(void);
+void StackMonitorIsrExit(void);
+
+#define STACK_MONITOR_ISR_ENTER()   StackMonitorIsrEnter()
+#define STACK_MONITOR_ISR_EXIT()    StackMonitorIsrExit()
+
+#else
+
+#define STACK_MONITOR_ISR_ENTER()
+#define STACK_MONITOR_ISR_EXIT()
+
+#endif
+
+#endif /* STACKMONITOR_H */
@@ -0,0 +1,325 @@
+/**
+ *  @file       TimeBase.c
+ *  @author     Luis Maduro
+ *  @version    1.00
+ *  @date       14/10/2026
+ *  @brief      64 bit monotonic time in microseconds from the RTC.
+ *
+ *  Copyright (C) 2026  Luis Maduro
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "TimeBase.h"
+
+#if TIME_BASE_USE_LSI
+/**40 kHz nominal.*/
+#define TIME_BASE_DIVIDER           39
+#define TIME_BASE_CLOCK_SOURCE      RCC_RTCCLKSource_LSI
+#define TIME_BASE_RTCSEL            RCC_BDCR_RTCSEL_LSI
+#define TIME_BASE_NOMINAL_HZ        40000UL
+#else
+#define TIME_BASE_DIVIDER           (32768 / TIME_BASE_RTC_HZ)
+#define TIME_BASE_CLOCK_SOURCE      RCC_RTCCLKSource_LSE
+#define TIME_BASE_RTCSEL            RCC_BDCR_RTCSEL_LSE
+#define TIME_BASE_NOMINAL_HZ        32768UL
+#endif
+
+#define TIME_BASE_MAGIC             0x7B5E
+
+/**Backup registers, TIME_BASE_BKP_COUNT of them.*/
+#define BKP_MAGIC                   (TIME_BASE_BKP_DR + 0)
+#define BKP_EPOCH                   (TIME_BASE_BKP_DR + 4)
+#define BKP_RATE                    (TIME_BASE_BKP_DR + 8)
+#define BKP_OFFSET                  (TIME_BASE_BKP_DR + 16)
+
+/**Overflows of the counter.*/
+static uint16_t epoch;
+/**Rate of the counter in mHz.*/
+static uint32_t rate;
+/**Microseconds per tick, 16.16 fixed point.*/
+static uint32_t usPerTick;
+/**Time at the tick 0 of the epoch 0.*/
+static uint64_t offset;
+
+static uint32_t TimeBaseReadBackup(uint16_t dr, uint8_t words)
+{
+    uint32_t value = 0;
+
+    while (words-- != 0)
+    {
+        value = (value << 16) | BKP_ReadBackupRegister(dr + 4 * words);
+    }
+
+    return value;
+}
+
+static void TimeBaseWriteBackup(uint16_t dr, uint32_t value, uint8_t words)
+{
+    while (words-- != 0)
+    {
+        BKP_WriteBackupRegister(dr, (uint16_t) value);
+        value >>= 16;
+        dr += 4;
+    }
+}
+
+static void TimeBaseSave(void)
+{
+    TimeBaseWriteBackup(BKP_EPOCH, epoch, 1);
+    TimeBaseWriteBackup(BKP_RATE, rate, 2);
+    TimeBaseWriteBackup(BKP_OFFSET, (uint32_t) offset, 2);
+    TimeBaseWriteBackup(BKP_OFFSET + 8, (uint32_t) (offset >> 32), 2);
+    TimeBaseWriteBackup(BKP_MAGIC, TIME_BASE_MAGIC, 1);
+}
+
+static void TimeBaseSetRate(uint32_t mHz)
+{
+    rate = mHz;
+    usPerTick = (uint32_t) ((1000000000ULL << 16) / mHz);
+}
+
+/**
+ * Converts ticks to microseconds, without overflowing 64 bits.
+ * @param ticks Ticks of the counter.
+ * @return Microseconds.
+ */
+static uint64_t TimeBaseTicksToUs(uint64_t ticks)
+{
+    return (ticks >> 16) * usPerTick + (((ticks & 0xFFFF) * usPerTick) >> 16);
+}
+
+/**
+ * Reads the counter and its divider together, and counts the overflow.
+ * Called with the interrupts disabled.
+ * @param divider Where to put the divider.
+ * @return Ticks since the epoch 0.
+ */
+static uint64_t TimeBaseRead(uint32_t *divider)
+{
+    uint32_t counter;
+
+    //the divider reloads with the increment of the counter
+    do
+    {
+        counter = RTC_GetCounter();
+        *divider = RTC_GetDivider();
+    } while (counter != RTC_GetCounter());
+
+    //an overflow after the read is counted by the next read
+    if ((RTC_GetFlagStatus(RTC_FLAG_OW) != RESET) && (counter < 0x80000000UL))
+    {
+        RTC_ClearFlag(RTC_FLAG_OW);
+        epoch++;
+        TimeBaseWriteBackup(BKP_EPOCH, epoch, 1);
+    }
+
+    return ((uint64_t) epoch << 32) | counter;
+}
+
+/**
+ * Starts the RTC, unless it already runs and the backup registers hold a
+ * time, else the time starts from 0. A RTC running from the other clock is
+ * restarted by a reset of the backup domain, as the clock can only be
+ * changed that way.
+ */
+void TimeBaseInit(void)
+{
+    RCC_APB1PeriphClockCmd(RCC_APB1Periph_PWR | RCC_APB1Periph_BKP, ENABLE);
+    PWR_BackupAccessCmd(ENABLE);
+
+#if TIME_BASE_USE_LSI
+    //in the VDD domain, stopped by the reset
+    RCC_LSICmd(ENABLE);
+    while (RCC_GetFlagStatus(RCC_FLAG_LSIRDY) == RESET);
+#endif
+
+    if (((RCC->BDCR & RCC_BDCR_RTCSEL) != TIME_BASE_RTCSEL) && ((RCC->BDCR & RCC_BDCR_RTCSEL) != RCC_BDCR_RTCSEL_NOCLOCK))
+    {
+        RCC_BackupResetCmd(ENABLE);
+        RCC_BackupResetCmd(DISABLE);
+    }
+
+    if (((RCC->BDCR & RCC_BDCR_RTCEN) == 0) || (BKP_ReadBackupRegister(BKP_MAGIC) != TIME_BASE_MAGIC))
+    {
+#if !TIME_BASE_USE_LSI
+        RCC_LSEConfig(RCC_LSE_ON);
+        while (RCC_GetFlagStatus(RCC_FLAG_LSERDY) == RESET);
+#endif
+
+        RCC_RTCCLKConfig(TIME_BASE_CLOCK_SOURCE);
+        RCC_RTCCLKCmd(ENABLE);
+
+        RTC_WaitForSynchro();
+        RTC_WaitForLastTask();
+        RTC_SetPrescaler(TIME_BASE_DIVIDER - 1);
+        RTC_WaitForLastTask();
+        RTC_SetCounter(0);
+        RTC_WaitForLastTask();
+        RTC_ClearFlag(RTC_FLAG_OW);
+
+        epoch = 0;
+        offset = 0;
+        TimeBaseSetRate(TIME_BASE_NOMINAL_HZ * 1000 / TIME_BASE_DIVIDER);
+        TimeBaseSave();
+    }
+    else
+    {
+        RTC_WaitForSynchro();
+
+        epoch = (uint16_t) TimeBaseReadBackup(BKP_EPOCH, 1);
+        offset = ((uint64_t) TimeBaseReadBackup(BKP_OFFSET + 8, 2) << 32) | TimeBaseReadBackup(BKP_OFFSET, 2);
+        TimeBaseSetRate(TimeBaseReadBackup(BKP_RATE, 2));
+    }
+}
+
+/**
+ * Gets the time, never going back.
+ * @return Microseconds since the RTC was started.
+ */
+uint64_t TimeBaseNowUs(void)
+{
+    uint32_t primask;
+    uint32_t divider;
+    uint64_t ticks;
+
+    primask = __get_PRIMASK();
+    __disable_irq();
+    ticks = TimeBaseRead(&divider);
+    __set_PRIMASK(primask);
+
+    //the divider counts down from TIME_BASE_DIVIDER - 1 in the tick
+    divider = (TIME_BASE_DIVIDER - 1) - divider;
+
+    return offset + TimeBaseTicksToUs(ticks) + (((uint64_t) divider * usPerTick / TIME_BASE_DIVIDER) >> 16);
+}
+
+/**
+ * Gets a timestamp for the samples and the messages, it wraps after 71
+ * minutes, the difference of two is right across the wrap.
+ * @return Low 32 bits of TimeBaseNowUs().
+ */
+uint32_t TimeBaseStamp(void)
+{
+    return (uint32_t) TimeBaseNowUs();
+}
+
+/**
+ * Gets the rate of the counter, for the alarms.
+ * @return Ticks per 1000 s.
+ */
+uint32_t TimeBaseGetRate(void)
+{
+    return rate;
+}
+
+/**
+ * Measures the LSI with TIM5, 64 of its periods against the timer clock,
+ * and goes on at the rate found. It takes under 2 ms at 40 kHz, the
+ * interrupts are disabled during the update of the RTC, 3 periods of the
+ * LSI.
+ * @return Frequency of the LSI in mHz, 0 if not measured.
+ */
+uint32_t TimeBaseCalibrateLSI(void)
+{
+#if TIME_BASE_USE_LSI && (defined(STM32F10X_HD) || defined(STM32F10X_XL) || defined(STM32F10X_CL))
+    TIM_TimeBaseInitTypeDef TIM_TimeBaseStructure;
+    TIM_ICInitTypeDef TIM_ICInitStructure;
+    RCC_ClocksTypeDef RCC_ClocksStatus;
+    uint32_t clock;
+    uint32_t primask;
+    uint32_t divider;
+    uint32_t timeout;
+    uint32_t sum = 0;
+    uint32_t lsi = 0;
+    uint16_t last = 0;
+    uint8_t captures;
+
+    RCC_GetClocksFreq(&RCC_ClocksStatus);
+    clock = RCC_ClocksStatus.PCLK1_Frequency;
+    if (RCC->CFGR & RCC_CFGR_PPRE1_2)
+    {
+        clock *= 2;
+    }
+
+    RCC_APB1PeriphClockCmd(RCC_APB1Periph_TIM5, ENABLE);
+    RCC_APB2PeriphClockCmd(RCC_APB2Periph_AFIO, ENABLE);
+    GPIO_PinRemapConfig(GPIO_Remap_TIM5CH4_LSI, ENABLE);
+
+    TIM_TimeBaseStructInit(&TIM_TimeBaseStructure);
+    TIM_TimeBaseStructure.TIM_Period = 0xFFFF;
+    TIM_TimeBaseInit(TIM5, &TIM_TimeBaseStructure);
+
+    //8 periods of the LSI per capture, 14400 counts at 72 MHz
+    TIM_ICInitStructure.TIM_Channel = TIM_Channel_4;
+    TIM_ICInitStructure.TIM_ICPolarity = TIM_ICPolarity_Rising;
+    TIM_ICInitStructure.TIM_ICSelection = TIM_ICSelection_DirectTI;
+    TIM_ICInitStructure.TIM_ICPrescaler = TIM_ICPSC_DIV8;
+    TIM_ICInitStructure.TIM_ICFilter = 0;
+    TIM_ICInit(TIM5, &TIM_ICInitStructure);
+
+    TIM5->SR = 0;
+    TIM_Cmd(TIM5, ENABLE);
+
+    for (captures = 0; captures <= 8; captures++)
+    {
+        timeout = clock / 1000;
+        while ((TIM5->SR & TIM_SR_CC4IF) == 0)
+        {
+            if (--timeout == 0)
+            {
+                break;
+            }
+        }
+
+        if (timeout == 0)
+        {
+            sum = 0;
+            break;
+        }
+
+        if (captures != 0)
+        {
+            sum += (uint16_t) (TIM5->CCR4 - last);
+        }
+        last = TIM5->CCR4;
+    }
+
+    TIM_Cmd(TIM5, DISABLE);
+    TIM_DeInit(TIM5);
+    GPIO_PinRemapConfig(GPIO_Remap_TIM5CH4_LSI, DISABLE);
+
+    if (sum != 0)
+    {
+        lsi = (uint32_t) ((uint64_t) clock * 64 * 1000 / sum);
+
+        //from the next tick at the new rate, a jump ahead of under a tick
+        primask = __get_PRIMASK();
+        __disable_irq();
+        offset += TimeBaseTicksToUs(TimeBaseRead(&divider) + 1);
+        RTC_WaitForLastTask();
+        RTC_SetCounter(0);
+        RTC_WaitForLastTask();
+        RTC_ClearFlag(RTC_FLAG_OW);
+        epoch = 0;
+        TimeBaseSetRate(lsi / TIME_BASE_DIVIDER);
+        TimeBaseSave();
+        __set_PRIMASK(primask);
+    }
+
+    return lsi;
+#else
+    return 0;
+#endif
+}
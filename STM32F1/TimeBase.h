@@ -0,0 +1,74 @@
+/**
+ *  @file       TimeBase.h
+ *  @author     Luis Maduro
+ *  @version    1.00
+ *  @date       14/10/2026
+ *  @brief      64 bit monotonic time in microseconds from the RTC.
+ *
+ *  _counterMs of the kernels starts again at every reset, wraps after 49
+ *  days and stops in STOP. The time of this file comes from the RTC, which
+ *  keeps counting in STOP and, from the LSE with the backup battery, through
+ *  the resets: it is the same timebase for the samples, the logs and the
+ *  packets, from the first start until the backup domain is lost.
+ *
+ *  The counter of the RTC runs at about TIME_BASE_RTC_HZ and its prescaler
+ *  divider gives the part of the tick, so a time has the resolution of one
+ *  period of the RTC clock, 30.5 us from the LSE. The overflows of the
+ *  32 bit counter are counted in a backup register, with the rate of the
+ *  counter and an offset, in TIME_BASE_BKP_COUNT registers from
+ *  TIME_BASE_BKP_DR.
+ *
+ *  The LSI can clock the RTC when there is no crystal, it is then measured
+ *  against the system clock by TimeBaseCalibrateLSI() (TIM5 channel 4,
+ *  high density, XL density and connectivity line), and the time goes on at
+ *  the new rate from there, without a jump back. The LSI stops on a reset,
+ *  the time then does not go on while the microcontroller is in reset.
+ *
+ *  TimeBaseNowUs() is called at least once in every overflow of the
+ *  counter, 48 days at 1024 Hz, for the overflow to be counted.
+ *
+ *  Copyright (C) 2026  Luis Maduro
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef TIMEBASE_H
+#define TIMEBASE_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stm32f10x.h>
+
+/**Clock of the RTC, 0 for the LSE, 1 for the LSI.*/
+#ifndef TIME_BASE_USE_LSI
+#define TIME_BASE_USE_LSI           0
+#endif
+
+/**First backup register used, TIME_BASE_BKP_COUNT of them follow.*/
+#ifndef TIME_BASE_BKP_DR
+#define TIME_BASE_BKP_DR            BKP_DR1
+#endif
+
+#define TIME_BASE_BKP_COUNT         8
+
+/**Nominal rate of the counter, exact from the LSE.*/
+#define TIME_BASE_RTC_HZ            1024
+
+void TimeBaseInit(void);
+uint64_t TimeBaseNowUs(void);
+uint32_t TimeBaseStamp(void);
+uint32_t TimeBaseGetRate(void);
+uint32_t TimeBaseCalibrateLSI(void);
+
+#endif /* TIMEBASE_H */
@@ -0,0 +1,261 @@
+/**
+ *  @file       USARTReceiver.c
+ *  @author     Luis Maduro
+ *  @version    1.00
+ *  @date       14/10/2026
+ *  @brief      USART reception by circular DMA and the idle line interrupt.
+ *
+ *  Copyright (C) 2026  Luis Maduro
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <stddef.h>
+#include "USARTReceiver.h"
+
+/**GIF, TCIF, HTIF and TEIF of a channel.*/
+#define USART_RECEIVER_CHANNEL_FLAGS    0x0FUL
+
+/**
+ * Finds the RX channel of a USART.
+ * @return False if it has none.
+ */
+static bool USARTReceiverChannel(tUSARTReceiver *receiver, uint8_t *channel,
+                                 IRQn_Type *usartIRQ, IRQn_Type *dmaIRQ)
+{
+    if (receiver->usart == USART1)
+    {
+        *channel = DMA_REQUEST_USART1_RX;
+        *usartIRQ = USART1_IRQn;
+        *dmaIRQ = DMA1_Channel5_IRQn;
+        receiver->channel = DMA1_Channel5;
+    }
+    else if (receiver->usart == USART2)
+    {
+        *channel = DMA_REQUEST_USART2_RX;
+        *usartIRQ = USART2_IRQn;
+        *dmaIRQ = DMA1_Channel6_IRQn;
+        receiver->channel = DMA1_Channel6;
+    }
+    else if (receiver->usart == USART3)
+    {
+        *channel = DMA_REQUEST_USART3_RX;
+        *usartIRQ = USART3_IRQn;
+        *dmaIRQ = DMA1_Channel3_IRQn;
+        receiver->channel = DMA1_Channel3;
+    }
+#ifdef DMA_MANAGER_USE_DMA2
+    else if (receiver->usart == UART4)
+    {
+        *channel = DMA_REQUEST_UART4_RX;
+        *usartIRQ = UART4_IRQn;
+        *dmaIRQ = DMA2_Channel3_IRQn;
+        receiver->channel = DMA2_Channel3;
+    }
+#endif
+    else
+    {
+        return false;
+    }
+
+    if (*channel >= DMA_CHANNEL_DMA2_1)
+    {
+#ifdef DMA_MANAGER_USE_DMA2
+        receiver->dma = DMA2;
+        receiver->flagShift = 4 * (*channel - DMA_CHANNEL_DMA2_1);
+        RCC_AHBPeriphClockCmd(RCC_AHBPeriph_DMA2, ENABLE);
+#endif
+    }
+    else
+    {
+        receiver->dma = DMA1;
+        receiver->flagShift = 4 * (*channel - DMA_CHANNEL_DMA1_1);
+        RCC_AHBPeriphClockCmd(RCC_AHBPeriph_DMA1, ENABLE);
+    }
+
+    return true;
+}
+
+/**
+ * Starts the reception of a USART, already configured, into a circular
+ * buffer.
+ * @param receiver Receiver, kept by the application while it runs.
+ * @param usart USART1, USART2, USART3 or UART4.
+ * @param buffer Buffer of the DMA, twice the longest time between two calls
+ *               of the consumer (the interrupt latency) in bytes of the
+ *               line at least.
+ * @param size Bytes of the buffer, 2 to 65535.
+ * @param consumer Takes the bytes received.
+ * @return False if the USART has no DMA channel, if the channel is reserved
+ *         by another driver or if a parameter is not valid.
+ */
+bool USARTReceiverInit(tUSARTReceiver *receiver, USART_TypeDef *usart,
+                       uint8_t *buffer, uint16_t size,
+                       tUSARTReceiverConsumer consumer)
+{
+    DMA_InitTypeDef DMA_InitStructure;
+    NVIC_InitTypeDef NVIC_InitStructure;
+    uint8_t channel;
+    IRQn_Type usartIRQ;
+    IRQn_Type dmaIRQ;
+
+    if (buffer == NULL || size < 2 || consumer == NULL)
+    {
+        return false;
+    }
+
+    receiver->usart = usart;
+
+    if (!USARTReceiverChannel(receiver, &channel, &usartIRQ, &dmaIRQ))
+    {
+        return false;
+    }
+
+#ifdef USE_DMA_MANAGER
+    receiver->user.channel = channel;
+    receiver->user.priority = 0;
+    receiver->user.granted = NULL;
+    //the interrupts of the channel come straight to this receiver
+    receiver->user.interrupt = NULL;
+
+    if (!DMAManagerReserve(&receiver->user))
+    {
+        return false;
+    }
+#endif
+
+    receiver->buffer = buffer;
+    receiver->size = size;
+    receiver->tail = 0;
+    receiver->consumer = consumer;
+    receiver->Bytes = 0;
+    receiver->Spans = 0;
+    receiver->Overruns = 0;
+
+    DMA_DeInit(receiver->channel);
+    DMA_InitStructure.DMA_PeripheralBaseAddr = (uint32_t) &usart->DR;
+    DMA_InitStructure.DMA_MemoryBaseAddr = (uint32_t) buffer;
+    DMA_InitStructure.DMA_DIR = DMA_DIR_PeripheralSRC;
+    DMA_InitStructure.DMA_BufferSize = size;
+    DMA_InitStructure.DMA_PeripheralInc = DMA_PeripheralInc_Disable;
+    DMA_InitStructure.DMA_MemoryInc = DMA_MemoryInc_Enable;
+    DMA_InitStructure.DMA_PeripheralDataSize = DMA_PeripheralDataSize_Byte;
+    DMA_InitStructure.DMA_MemoryDataSize = DMA_MemoryDataSize_Byte;
+    DMA_InitStructure.DMA_Mode = DMA_Mode_Circular;
+    DMA_InitStructure.DMA_Priority = DMA_Priority_High;
+    DMA_InitStructure.DMA_M2M = DMA_M2M_Disable;
+    DMA_Init(receiver->channel, &DMA_InitStructure);
+    receiver->dma->IFCR = USART_RECEIVER_CHANNEL_FLAGS << receiver->flagShift;
+    DMA_ITConfig(receiver->channel, DMA_IT_HT | DMA_IT_TC, ENABLE);
+
+    //an idle line already pending is not a burst
+    (void) usart->SR;
+    (void) usart->DR;
+
+    USART_DMACmd(usart, USART_DMAReq_Rx, ENABLE);
+    USART_ITConfig(usart, USART_IT_IDLE, ENABLE);
+    DMA_Cmd(receiver->channel, ENABLE);
+
+    NVIC_InitStructure.NVIC_IRQChannelPreemptionPriority = USART_RECEIVER_IRQ_PRIORITY;
+    NVIC_InitStructure.NVIC_IRQChannelSubPriority = 0;
+    NVIC_InitStructure.NVIC_IRQChannelCmd = ENABLE;
+    NVIC_InitStructure.NVIC_IRQChannel = usartIRQ;
+    NVIC_Init(&NVIC_InitStructure);
+    NVIC_InitStructure.NVIC_IRQChannel = dmaIRQ;
+    NVIC_Init(&NVIC_InitStructure);
+
+    return true;
+}
+
+/**
+ * Stops the reception, the bytes not given to the consumer yet are lost.
+ * @param receiver Receiver.
+ */
+void USARTReceiverStop(tUSARTReceiver *receiver)
+{
+    USART_ITConfig(receiver->usart, USART_IT_IDLE, DISABLE);
+    USART_DMACmd(receiver->usart, USART_DMAReq_Rx, DISABLE);
+    DMA_Cmd(receiver->channel, DISABLE);
+    DMA_ITConfig(receiver->channel, DMA_IT_HT | DMA_IT_TC, DISABLE);
+    receiver->dma->IFCR = USART_RECEIVER_CHANNEL_FLAGS << receiver->flagShift;
+
+#ifdef USE_DMA_MANAGER
+    DMAManagerRelease(&receiver->user);
+#endif
+}
+
+/**
+ * Gives a span of the buffer to the consumer.
+ */
+static void USARTReceiverGive(tUSARTReceiver *receiver, uint16_t from, uint16_t to)
+{
+    receiver->consumer(&receiver->buffer[from], to - from);
+    receiver->Bytes += to - from;
+    receiver->Spans++;
+}
+
+/**
+ * This funtion is intended to be put in the USARTx_IRQHandler() and in the
+ * DMAx_Channely_IRQHandler() of the receiver, it gives the bytes received
+ * since the last call to the consumer.
+ * @param receiver Receiver.
+ */
+void USARTReceiverInterruptHandler(tUSARTReceiver *receiver)
+{
+    uint16_t status = receiver->usart->SR;
+    uint16_t head;
+
+    if (status & (USART_SR_IDLE | USART_SR_ORE))
+    {
+        //SR then DR clears them, the line is idle so there is no byte in DR
+        //for the DMA
+        (void) receiver->usart->DR;
+
+        if (status & USART_SR_ORE)
+        {
+            receiver->Overruns++;
+        }
+    }
+
+    receiver->dma->IFCR = USART_RECEIVER_CHANNEL_FLAGS << receiver->flagShift;
+
+    head = receiver->size - DMA_GetCurrDataCounter(receiver->channel);
+
+    if (head == receiver->size)
+    {
+        head = 0;
+    }
+
+    if (head == receiver->tail)
+    {
+        return;
+    }
+
+    if (head > receiver->tail)
+    {
+        USARTReceiverGive(receiver, receiver->tail, head);
+    }
+    else
+    {
+        //wrapped around the end of the buffer
+        USARTReceiverGive(receiver, receiver->tail, receiver->size);
+
+        if (head != 0)
+        {
+            USARTReceiverGive(receiver, 0, head);
+        }
+    }
+
+    receiver->tail = head;
+}
@@ -0,0 +1,108 @@
+/**
+ *  @file       USARTReceiver.h
+ *  @author     Luis Maduro
+ *  @version    1.00
+ *  @date       14/10/2026
+ *  @brief      USART reception by circular DMA and the idle line interrupt.
+ *
+ *  The DMA channel of the RX of a USART writes every byte into a circular
+ *  buffer, there is no interrupt per byte. The new bytes are handed to a
+ *  consumer on three interrupts: the idle line of the USART, raised one
+ *  character time after the end of a burst (an NMEA sentence, a UBX
+ *  message, an answer of a modem), and the half transfer and transfer
+ *  complete of the channel, so a burst longer than half the buffer is given
+ *  in parts before the DMA writes over it. The consumer gets the bytes in
+ *  place, as one span or two when they wrap around the end of the buffer,
+ *  from the interrupt: it must take them before the DMA comes back to them,
+ *  half a buffer later.
+ *  @code
+ *  static void GPSConsumer(const uint8_t *data, uint16_t length)
+ *  {
+ *      while (length--)
+ *      {
+ *          nmeaParseByte((char) *data);
+ *          ubxParseByte(*data++);
+ *      }
+ *  }
+ *
+ *  USARTReceiverInit(&gps, USART2, gpsBuffer, sizeof (gpsBuffer), GPSConsumer);
+ *  @endcode
+ *  and void USART2_IRQHandler(void) and DMA1_Channel6_IRQHandler() both call
+ *  USARTReceiverInterruptHandler(&gps). A consumer that is not quick enough
+ *  for an interrupt copies the span to a uFIFO with uFIFOSPSCPut() and a
+ *  task reads it. The baud rate, the pins and the USART itself are set up
+ *  by the application before, the other interrupts of the USART are left
+ *  as they are.
+ *
+ *  The channels are the RX ones of DMA_REQUEST_ of DMAManager.h, UART5 has
+ *  none. With USE_DMA_MANAGER the channel is reserved for as long as the
+ *  reception runs.
+ *
+ *  Copyright (C) 2026  Luis Maduro
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef USARTRECEIVER_H
+#define USARTRECEIVER_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stm32f10x.h>
+#include "DMAManager.h"
+
+/**Priority of the USART and DMA interrupts of the receivers.*/
+#ifndef USART_RECEIVER_IRQ_PRIORITY
+#define USART_RECEIVER_IRQ_PRIORITY 2
+#endif
+
+/**
+ * Takes bytes received, called from the interrupts.
+ * @param data First byte, in the buffer of the receiver.
+ * @param length Bytes, at least 1.
+ */
+typedef void (*tUSARTReceiverConsumer)(const uint8_t *data, uint16_t length);
+
+/**
+ * A USART received by DMA, kept by the application.
+ */
+typedef struct
+{
+    USART_TypeDef *usart;
+    DMA_Channel_TypeDef *channel;
+    /**Controller of the channel, and the position of its flags in IFCR.*/
+    DMA_TypeDef *dma;
+    uint8_t flagShift;
+    uint8_t *buffer;
+    uint16_t size;
+    /**Next byte to give to the consumer.*/
+    uint16_t tail;
+    tUSARTReceiverConsumer consumer;
+#ifdef USE_DMA_MANAGER
+    tDMAManagerUser user;
+#endif
+    /**Bytes and spans given to the consumer.*/
+    uint32_t Bytes;
+    uint32_t Spans;
+    /**Overrun errors of the USART, bytes lost before the DMA took them.*/
+    uint32_t Overruns;
+} tUSARTReceiver;
+
+bool USARTReceiverInit(tUSARTReceiver *receiver, USART_TypeDef *usart,
+                       uint8_t *buffer, uint16_t size,
+                       tUSARTReceiverConsumer consumer);
+void USARTReceiverStop(tUSARTReceiver *receiver);
+void USARTReceiverInterruptHandler(tUSARTReceiver *receiver);
+
+#endif /* USARTRECEIVER_H */
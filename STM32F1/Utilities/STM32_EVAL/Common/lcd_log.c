@@ -100,6 +100,10 @@ FunctionalState LCD_Lock;
 FunctionalState LCD_Scrolled;
 uint16_t LCD_ScrollBackStep;
 
+/* Text and color currently shown on every line of the window */
+static uint8_t LCD_WindowText[YWINDOW_SIZE][XWINDOW_MAX];
+static uint16_t LCD_WindowColor[YWINDOW_SIZE];
+
 /**
 * @}
 */ 
@@ -109,6 +113,8 @@ uint16_t LCD_ScrollBackStep;
 * @{
 */ 
 static void LCD_LOG_UpdateDisplay (void);
+static void LCD_LOG_SetWindow (uint8_t Ch);
+static void LCD_LOG_DrawLine (uint16_t Row, uint16_t Index);
 /**
 * @}
 */ 
@@ -131,6 +137,7 @@ void LCD_LOG_Init ( void)
   LCD_LOG_DeInit();
   /* Clear the LCD */
   LCD_Clear(Black);  
+  LCD_LOG_SetWindow(' ');
 }
 
 /**
@@ -153,6 +160,9 @@ void LCD_LOG_DeInit(void)
   LCD_Lock = DISABLE;
   LCD_Scrolled = DISABLE;
   LCD_ScrollBackStep = 0;
+  
+  /* The window content is unknown: redraw all of it on the next update */
+  LCD_LOG_SetWindow(0xFF);
 }
 
 /**
@@ -188,6 +198,7 @@ void LCD_LOG_SetHeader (uint8_t *Title)
   
   /* Clear the LCD */
   LCD_Clear(Black);
+  LCD_LOG_SetWindow(' ');
     
   /* Set the LCD Font */
   LCD_SetFont (&Font12x12);
@@ -243,6 +254,7 @@ void LCD_LOG_ClearTextZone(void)
   }
   
   LCD_LOG_DeInit();
+  LCD_LOG_SetWindow(' ');
 }
 
 /**
@@ -324,6 +336,9 @@ PUTCHAR_PROTOTYPE
   
 /**
 * @brief  Update the text area display
+* @note   Only the characters that differ from the ones already shown are
+*         drawn, so the trailing blanks and the text shared by consecutive
+*         lines cost nothing when the window rolls.
 * @param  None
 * @retval None
 */
@@ -333,14 +348,10 @@ static void LCD_LOG_UpdateDisplay (void)
   uint16_t length = 0 ;
   uint16_t ptr = 0, index = 0;
   
-  sFONT *cFont = LCD_GetFont();
-  
   if((LCD_CacheBuffer_yptr_bottom  < (YWINDOW_SIZE -1)) && 
      (LCD_CacheBuffer_yptr_bottom  >= LCD_CacheBuffer_yptr_top))
   {
-    LCD_SetTextColor(LCD_CacheBuffer[cnt + LCD_CacheBuffer_yptr_bottom].color);
-    LCD_DisplayStringLine ((YWINDOW_MIN + LCD_CacheBuffer_yptr_bottom) * cFont->Height,
-                           (uint8_t *)(LCD_CacheBuffer[cnt + LCD_CacheBuffer_yptr_bottom].line));
+    LCD_LOG_DrawLine(LCD_CacheBuffer_yptr_bottom, LCD_CacheBuffer_yptr_bottom);
   }
   else
   {
@@ -362,15 +373,69 @@ static void LCD_LOG_UpdateDisplay (void)
       
       index = (cnt + ptr )% LCD_CACHE_DEPTH ;
       
-      LCD_SetTextColor(LCD_CacheBuffer[index].color);
-      LCD_DisplayStringLine ((cnt + YWINDOW_MIN) * cFont->Height, 
-                             (uint8_t *)(LCD_CacheBuffer[index].line));
+      LCD_LOG_DrawLine(cnt, index);
       
     }
   }
   
 }
 
+/**
+* @brief  Set the content known for the whole window
+* @param  Ch: character shown everywhere, 0xFF when unknown
+* @retval None
+*/
+static void LCD_LOG_SetWindow (uint8_t Ch)
+{
+  uint16_t row, col;
+  
+  for (row = 0 ; row < YWINDOW_SIZE ; row ++)
+  {
+    for (col = 0 ; col < XWINDOW_MAX ; col ++)
+    {
+      LCD_WindowText[row][col] = Ch;
+    }
+    LCD_WindowColor[row] = LCD_LOG_DEFAULT_COLOR;
+  }
+}
+
+/**
+* @brief  Draw a cached line on a row of the window
+* @param  Row: row of the window, 0..YWINDOW_SIZE-1
+* @param  Index: line of the cache
+* @retval None
+*/
+static void LCD_LOG_DrawLine (uint16_t Row, uint16_t Index)
+{
+  sFONT *cFont = LCD_GetFont();
+  uint16_t col, columns = LCD_PIXEL_WIDTH / cFont->Width;
+  uint16_t color = LCD_CacheBuffer[Index].color;
+  uint8_t *text = LCD_CacheBuffer[Index].line;
+  uint8_t *shown = LCD_WindowText[Row];
+  FunctionalState recolor = (color != LCD_WindowColor[Row]) ? ENABLE : DISABLE;
+  
+  if (columns > XWINDOW_MAX)
+  {
+    columns = XWINDOW_MAX;
+  }
+  
+  LCD_SetTextColor(color);
+  
+  for (col = 0 ; (col < columns) && (text[col] != 0) ; col ++)
+  {
+    /* A blank looks the same in any text color */
+    if ((text[col] != shown[col]) || 
+        ((recolor == ENABLE) && (text[col] != ' ')))
+    {
+      LCD_DisplayChar((YWINDOW_MIN + Row) * cFont->Height, 
+                      LCD_PIXEL_WIDTH - 1 - col * cFont->Width, text[col]);
+      shown[col] = text[col];
+    }
+  }
+  
+  LCD_WindowColor[Row] = color;
+}
+
 #ifdef LCD_SCROLL_ENABLED
 /**
 * @brief  Display previous text frame
@@ -31,6 +31,15 @@
   *                completed (variable decremented to 0). Stopping transfer tasks
   *                are performed into DMA interrupt handlers (which are integrated
   *                into this driver).
+  *
+  *          @note sEE_WriteBufferAsync() queues a write and returns at once. 
+  *                sEE_WriteTimerTask(), called from a periodic interrupt (1 ms 
+  *                SysTick for example), writes it page by page: each page is 
+  *                sent by DMA, then the end of its write cycle is polled once 
+  *                per call instead of in a loop. The callback of the write is
+  *                called from sEE_WriteTimerTask() when it is complete. 
+  *                Don't use the other read and write functions while 
+  *                sEE_GetWriteState() returns sEE_STATE_BUSY.
   *            
   *     +-----------------------------------------------------------------+
   *     |                        Pin assignment                           |                 
@@ -62,6 +71,7 @@
 
 /* Includes ------------------------------------------------------------------*/
 #include "stm32_eval_i2c_ee.h"
+#include "stm32_eval_wait.h"
 
 /** @addtogroup Utilities
   * @{
@@ -83,6 +93,13 @@
 /** @defgroup STM32_EVAL_I2C_EE_Private_Types
   * @{
   */ 
+typedef struct
+{
+  uint8_t*          pBuffer;
+  uint16_t          WriteAddr;
+  uint16_t          NumByteToWrite;
+  sEE_WriteCallback Callback;
+} sEE_WriteRequest;
 /**
   * @}
   */ 
@@ -91,6 +108,10 @@
 /** @defgroup STM32_EVAL_I2C_EE_Private_Defines
   * @{
   */  
+/* Steps of the write at the head of the queue */
+#define sEE_STEP_IDLE             0
+#define sEE_STEP_DMA              1
+#define sEE_STEP_POLL             2
 /**
   * @}
   */ 
@@ -112,6 +133,14 @@ __IO uint32_t  sEETimeout = sEE_LONG_TIMEOUT;
 __IO uint16_t* sEEDataReadPointer;   
 __IO uint8_t*  sEEDataWritePointer;  
 __IO uint8_t   sEEDataNum;
+
+static sEE_WriteRequest sEEWriteQueue[sEE_WRITE_QUEUE_SIZE];
+static __IO uint8_t     sEEWriteHead = 0;
+static __IO uint8_t     sEEWriteTail = 0;
+static uint8_t          sEEWriteStep = sEE_STEP_IDLE;
+static __IO uint8_t     sEEWriteNum;
+static uint8_t          sEEWritePart;
+static uint16_t         sEEWriteTrials;
 /**
   * @}
   */ 
@@ -120,6 +149,8 @@ __IO uint8_t   sEEDataNum;
 /** @defgroup STM32_EVAL_I2C_EE_Private_Function_Prototypes
   * @{
   */ 
+static uint32_t sEE_ProbeEeprom(void);
+static void     sEE_WriteEnd(uint32_t Status);
 /**
   * @}
   */ 
@@ -496,10 +527,8 @@ void sEE_WriteBuffer(uint8_t* pBuffer, uint16_t WriteAddr, uint16_t NumByteToWri
       sEE_WritePage(pBuffer, WriteAddr, (uint8_t*)(&sEEDataNum));
       /* Wait transfer through DMA to be complete */
       sEETimeout = sEE_LONG_TIMEOUT;
-      while (sEEDataNum > 0)
-      {
-        if((sEETimeout--) == 0) {sEE_TIMEOUT_UserCallback(); return;};
-      }
+      EVAL_WAIT_WHILE(sEEDataNum > 0, sEETimeout);
+      if (sEEDataNum > 0) {sEE_TIMEOUT_UserCallback(); return;};
       sEE_WaitEepromStandbyState();
     }
     /*!< If NumByteToWrite > sEE_PAGESIZE */
@@ -512,10 +541,8 @@ void sEE_WriteBuffer(uint8_t* pBuffer, uint16_t WriteAddr, uint16_t NumByteToWri
         sEE_WritePage(pBuffer, WriteAddr, (uint8_t*)(&sEEDataNum)); 
         /* Wait transfer through DMA to be complete */
         sEETimeout = sEE_LONG_TIMEOUT;
-        while (sEEDataNum > 0)
-        {
-          if((sEETimeout--) == 0) {sEE_TIMEOUT_UserCallback(); return;};
-        }      
+        EVAL_WAIT_WHILE(sEEDataNum > 0, sEETimeout);
+        if (sEEDataNum > 0) {sEE_TIMEOUT_UserCallback(); return;};
         sEE_WaitEepromStandbyState();
         WriteAddr +=  sEE_PAGESIZE;
         pBuffer += sEE_PAGESIZE;
@@ -528,10 +555,8 @@ void sEE_WriteBuffer(uint8_t* pBuffer, uint16_t WriteAddr, uint16_t NumByteToWri
         sEE_WritePage(pBuffer, WriteAddr, (uint8_t*)(&sEEDataNum));
         /* Wait transfer through DMA to be complete */
         sEETimeout = sEE_LONG_TIMEOUT;
-        while (sEEDataNum > 0)
-        {
-          if((sEETimeout--) == 0) {sEE_TIMEOUT_UserCallback(); return;};
-        }    
+        EVAL_WAIT_WHILE(sEEDataNum > 0, sEETimeout);
+        if (sEEDataNum > 0) {sEE_TIMEOUT_UserCallback(); return;};
         sEE_WaitEepromStandbyState();
       }
     }
@@ -552,10 +577,8 @@ void sEE_WriteBuffer(uint8_t* pBuffer, uint16_t WriteAddr, uint16_t NumByteToWri
         sEE_WritePage(pBuffer, WriteAddr, (uint8_t*)(&sEEDataNum));
         /* Wait transfer through DMA to be complete */
         sEETimeout = sEE_LONG_TIMEOUT;
-        while (sEEDataNum > 0)
-        {
-          if((sEETimeout--) == 0) {sEE_TIMEOUT_UserCallback(); return;};
-        }          
+        EVAL_WAIT_WHILE(sEEDataNum > 0, sEETimeout);
+        if (sEEDataNum > 0) {sEE_TIMEOUT_UserCallback(); return;};
         sEE_WaitEepromStandbyState();      
         
         /* Store the number of data to be written */
@@ -564,10 +587,8 @@ void sEE_WriteBuffer(uint8_t* pBuffer, uint16_t WriteAddr, uint16_t NumByteToWri
         sEE_WritePage((uint8_t*)(pBuffer + count), (WriteAddr + count), (uint8_t*)(&sEEDataNum));
         /* Wait transfer through DMA to be complete */
         sEETimeout = sEE_LONG_TIMEOUT;
-        while (sEEDataNum > 0)
-        {
-          if((sEETimeout--) == 0) {sEE_TIMEOUT_UserCallback(); return;};
-        }     
+        EVAL_WAIT_WHILE(sEEDataNum > 0, sEETimeout);
+        if (sEEDataNum > 0) {sEE_TIMEOUT_UserCallback(); return;};
         sEE_WaitEepromStandbyState();        
       }      
       else      
@@ -577,10 +598,8 @@ void sEE_WriteBuffer(uint8_t* pBuffer, uint16_t WriteAddr, uint16_t NumByteToWri
         sEE_WritePage(pBuffer, WriteAddr, (uint8_t*)(&sEEDataNum));
         /* Wait transfer through DMA to be complete */
         sEETimeout = sEE_LONG_TIMEOUT;
-        while (sEEDataNum > 0)
-        {
-          if((sEETimeout--) == 0) {sEE_TIMEOUT_UserCallback(); return;};
-        }          
+        EVAL_WAIT_WHILE(sEEDataNum > 0, sEETimeout);
+        if (sEEDataNum > 0) {sEE_TIMEOUT_UserCallback(); return;};
         sEE_WaitEepromStandbyState();        
       }     
     }
@@ -598,10 +617,8 @@ void sEE_WriteBuffer(uint8_t* pBuffer, uint16_t WriteAddr, uint16_t NumByteToWri
         sEE_WritePage(pBuffer, WriteAddr, (uint8_t*)(&sEEDataNum));
         /* Wait transfer through DMA to be complete */
         sEETimeout = sEE_LONG_TIMEOUT;
-        while (sEEDataNum > 0)
-        {
-          if((sEETimeout--) == 0) {sEE_TIMEOUT_UserCallback(); return;};
-        }     
+        EVAL_WAIT_WHILE(sEEDataNum > 0, sEETimeout);
+        if (sEEDataNum > 0) {sEE_TIMEOUT_UserCallback(); return;};
         sEE_WaitEepromStandbyState();
         WriteAddr += count;
         pBuffer += count;
@@ -614,10 +631,8 @@ void sEE_WriteBuffer(uint8_t* pBuffer, uint16_t WriteAddr, uint16_t NumByteToWri
         sEE_WritePage(pBuffer, WriteAddr, (uint8_t*)(&sEEDataNum));
         /* Wait transfer through DMA to be complete */
         sEETimeout = sEE_LONG_TIMEOUT;
-        while (sEEDataNum > 0)
-        {
-          if((sEETimeout--) == 0) {sEE_TIMEOUT_UserCallback(); return;};
-        }        
+        EVAL_WAIT_WHILE(sEEDataNum > 0, sEETimeout);
+        if (sEEDataNum > 0) {sEE_TIMEOUT_UserCallback(); return;};
         sEE_WaitEepromStandbyState();
         WriteAddr +=  sEE_PAGESIZE;
         pBuffer += sEE_PAGESIZE;  
@@ -629,10 +644,8 @@ void sEE_WriteBuffer(uint8_t* pBuffer, uint16_t WriteAddr, uint16_t NumByteToWri
         sEE_WritePage(pBuffer, WriteAddr, (uint8_t*)(&sEEDataNum)); 
         /* Wait transfer through DMA to be complete */
         sEETimeout = sEE_LONG_TIMEOUT;
-        while (sEEDataNum > 0)
-        {
-          if((sEETimeout--) == 0) {sEE_TIMEOUT_UserCallback(); return;};
-        }         
+        EVAL_WAIT_WHILE(sEEDataNum > 0, sEETimeout);
+        if (sEEDataNum > 0) {sEE_TIMEOUT_UserCallback(); return;};
         sEE_WaitEepromStandbyState();
       }
     }
@@ -718,6 +731,13 @@ uint32_t sEE_WaitEepromStandbyState(void)
     {
       /*!< Clear AF flag */
       I2C_ClearFlag(sEE_I2C, I2C_FLAG_AF);                  
+
+      /*!< The write cycle lasts some ms: sleep until the next interrupt, at
+           most a SysTick period, before the next trial */
+      if (EVAL_WaitCanSleep())
+      {
+        __WFI();
+      }
     }
     
     /* Check if the maximum allowed numbe of trials has bee reached */
@@ -729,6 +749,206 @@ uint32_t sEE_WaitEepromStandbyState(void)
   }
 }
 
+/**
+  * @brief  Queues a buffer to be written to the I2C EEPROM by 
+  *         sEE_WriteTimerTask().
+  * @note   The buffer is read until the callback is called, it must not be
+  *         modified meanwhile. This function must be called from a single 
+  *         context (typically the main loop).
+  * @param  pBuffer : pointer to the buffer  containing the data to be written 
+  *         to the EEPROM.
+  * @param  WriteAddr : EEPROM's internal address to write to.
+  * @param  NumByteToWrite : number of bytes to write to the EEPROM.
+  * @param  Callback : function called when the write is complete, or 0.
+  * @retval sEE_OK (0) if the write is queued, sEE_FAIL if the queue is full.
+  */
+uint32_t sEE_WriteBufferAsync(uint8_t* pBuffer, uint16_t WriteAddr, uint16_t NumByteToWrite, sEE_WriteCallback Callback)
+{
+  uint8_t tail = sEEWriteTail;
+  uint8_t next = (tail + 1) % sEE_WRITE_QUEUE_SIZE;
+  
+  if (next == sEEWriteHead)
+  {
+    return sEE_FAIL;
+  }
+  
+  sEEWriteQueue[tail].pBuffer = pBuffer;
+  sEEWriteQueue[tail].WriteAddr = WriteAddr;
+  sEEWriteQueue[tail].NumByteToWrite = NumByteToWrite;
+  sEEWriteQueue[tail].Callback = Callback;
+  
+  /* The request is complete before the timer task can see it */
+  sEEWriteTail = next;
+  
+  return sEE_OK;
+}
+
+/**
+  * @brief  Gives the state of the writes queued by sEE_WriteBufferAsync().
+  * @param  None
+  * @retval sEE_STATE_BUSY while a write is queued, else sEE_STATE_READY.
+  */
+uint32_t sEE_GetWriteState(void)
+{
+  return (sEEWriteHead != sEEWriteTail) ? sEE_STATE_BUSY : sEE_STATE_READY;
+}
+
+/**
+  * @brief  Performs one step of the write at the head of the queue: starts 
+  *         the DMA transfer of a page, or checks once whether the EEPROM has 
+  *         completed its write cycle.
+  * @note   This function should be called from a periodic interrupt, with a
+  *         lower priority than the DMA Tx Channel interrupt. The EEPROM is
+  *         polled at most sEE_MAX_TRIALS_NUMBER times per page.
+  * @param  None
+  * @retval None
+  */
+void sEE_WriteTimerTask(void)
+{
+  sEE_WriteRequest* request;
+  uint32_t status = sEE_OK;
+  uint16_t room = 0;
+  
+  if (sEEWriteHead == sEEWriteTail)
+  {
+    return;
+  }
+  request = &sEEWriteQueue[sEEWriteHead];
+  
+  if (sEEWriteStep == sEE_STEP_DMA)
+  {
+    /* Wait transfer through DMA to be complete */
+    if (sEEWriteNum > 0)
+    {
+      return;
+    }
+    /* The write cycle of the EEPROM is checked on the next calls */
+    sEEWriteStep = sEE_STEP_POLL;
+    sEEWriteTrials = 0;
+    return;
+  }
+  
+  if (sEEWriteStep == sEE_STEP_POLL)
+  {
+    status = sEE_ProbeEeprom();
+    
+    if (status == sEE_FAIL)
+    {
+      if (++sEEWriteTrials < sEE_MAX_TRIALS_NUMBER)
+      {
+        return;
+      }
+      status = sEE_TIMEOUT_UserCallback();
+    }
+    if (status != sEE_OK)
+    {
+      sEE_WriteEnd(status);
+      return;
+    }
+    
+    /* The page is written */
+    request->pBuffer += sEEWritePart;
+    request->WriteAddr += sEEWritePart;
+    request->NumByteToWrite -= sEEWritePart;
+    sEEWriteStep = sEE_STEP_IDLE;
+    
+    if (request->NumByteToWrite == 0)
+    {
+      sEE_WriteEnd(sEE_OK);
+      return;
+    }
+  }
+  
+  /* Write up to the end of the page */
+  room = sEE_PAGESIZE - (request->WriteAddr % sEE_PAGESIZE);
+  sEEWritePart = (request->NumByteToWrite < room) ? request->NumByteToWrite : room;
+  sEEWriteNum = sEEWritePart;
+  status = sEE_WritePage(request->pBuffer, request->WriteAddr, (uint8_t*)(&sEEWriteNum));
+  if (status != sEE_OK)
+  {
+    sEE_WriteEnd(status);
+    return;
+  }
+  sEEWriteStep = sEE_STEP_DMA;
+}
+
+/**
+  * @brief  Checks once whether the EEPROM acknowledges its address, i.e. has
+  *         completed its last write cycle.
+  * @param  None
+  * @retval sEE_OK (0) if the EEPROM is ready, sEE_FAIL if it is still busy, 
+  *         else the timeout user callback.
+  */
+static uint32_t sEE_ProbeEeprom(void)
+{
+  __IO uint16_t tmpSR1 = 0;
+  
+  /*!< While the bus is busy */
+  sEETimeout = sEE_LONG_TIMEOUT;
+  while(I2C_GetFlagStatus(sEE_I2C, I2C_FLAG_BUSY))
+  {
+    if((sEETimeout--) == 0) return sEE_TIMEOUT_UserCallback();
+  }
+
+  /*!< Send START condition */
+  I2C_GenerateSTART(sEE_I2C, ENABLE);
+
+  /*!< Test on EV5 and clear it */
+  sEETimeout = sEE_FLAG_TIMEOUT;
+  while(!I2C_CheckEvent(sEE_I2C, I2C_EVENT_MASTER_MODE_SELECT))
+  {
+    if((sEETimeout--) == 0) return sEE_TIMEOUT_UserCallback();
+  }    
+
+  /*!< Send EEPROM address for write */
+  I2C_Send7bitAddress(sEE_I2C, sEEAddress, I2C_Direction_Transmitter);
+  
+  /* Wait for ADDR flag to be set (Slave acknowledged his address) or AF flag 
+     (address not acknowledged) */
+  sEETimeout = sEE_LONG_TIMEOUT;
+  do
+  {     
+    tmpSR1 = sEE_I2C->SR1;
+    if((sEETimeout--) == 0) return sEE_TIMEOUT_UserCallback();
+  }
+  while((tmpSR1 & (I2C_SR1_ADDR | I2C_SR1_AF)) == 0);
+  
+  if (tmpSR1 & I2C_SR1_ADDR)
+  {
+    /* Clear ADDR Flag by reading SR1 then SR2 registers (SR1 have already 
+       been read) */
+    (void)sEE_I2C->SR2;
+  }
+  else
+  {
+    /*!< Clear AF flag */
+    I2C_ClearFlag(sEE_I2C, I2C_FLAG_AF);
+  }
+  
+  /*!< STOP condition: the bus is released until the next call */
+  I2C_GenerateSTOP(sEE_I2C, ENABLE);
+  
+  return (tmpSR1 & I2C_SR1_ADDR) ? sEE_OK : sEE_FAIL;
+}
+
+/**
+  * @brief  Removes the write at the head of the queue and calls its callback.
+  * @param  Status : sEE_OK (0) or the error status of the write.
+  * @retval None
+  */
+static void sEE_WriteEnd(uint32_t Status)
+{
+  sEE_WriteCallback callback = sEEWriteQueue[sEEWriteHead].Callback;
+  
+  sEEWriteStep = sEE_STEP_IDLE;
+  sEEWriteHead = (sEEWriteHead + 1) % sEE_WRITE_QUEUE_SIZE;
+  
+  if (callback != 0)
+  {
+    callback(Status);
+  }
+}
+
 /**
   * @brief  This function handles the DMA Tx Channel interrupt Handler.
   * @param  None
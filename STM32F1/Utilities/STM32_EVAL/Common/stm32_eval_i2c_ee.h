@@ -50,6 +50,9 @@
 /** @defgroup STM32_EVAL_I2C_EE_Exported_Types
   * @{
   */ 
+/* Called from sEE_WriteTimerTask() at the end of a write started by 
+   sEE_WriteBufferAsync(), with sEE_OK (0) or the error status */
+typedef void (*sEE_WriteCallback)(uint32_t Status);
 
 /**
   * @}
@@ -118,8 +121,13 @@
 #define sEE_FLAG_TIMEOUT         ((uint32_t)0x1000)
 #define sEE_LONG_TIMEOUT         ((uint32_t)(10 * sEE_FLAG_TIMEOUT))
 
-/* Maximum number of trials for sEE_WaitEepromStandbyState() function */
+/* Maximum number of trials for sEE_WaitEepromStandbyState() function, and of
+   sEE_WriteTimerTask() calls waiting for the end of a write cycle */
 #define sEE_MAX_TRIALS_NUMBER     150
+
+/* Size of the queue of sEE_WriteBufferAsync(), it holds up to 
+   sEE_WRITE_QUEUE_SIZE - 1 writes */
+#define sEE_WRITE_QUEUE_SIZE      5
    
 /* Defintions for the state of the DMA transfer */   
 #define sEE_STATE_READY           0
@@ -149,6 +157,9 @@ uint32_t sEE_ReadBuffer(uint8_t* pBuffer, uint16_t ReadAddr, uint16_t* NumByteTo
 uint32_t sEE_WritePage(uint8_t* pBuffer, uint16_t WriteAddr, uint8_t* NumByteToWrite);
 void     sEE_WriteBuffer(uint8_t* pBuffer, uint16_t WriteAddr, uint16_t NumByteToWrite);
 uint32_t sEE_WaitEepromStandbyState(void);
+uint32_t sEE_WriteBufferAsync(uint8_t* pBuffer, uint16_t WriteAddr, uint16_t NumByteToWrite, sEE_WriteCallback Callback);
+uint32_t sEE_GetWriteState(void);
+void     sEE_WriteTimerTask(void);
 
 /* USER Callbacks: These are functions for which prototypes only are declared in
    EEPROM driver and that should be implemented into user applicaiton. */  
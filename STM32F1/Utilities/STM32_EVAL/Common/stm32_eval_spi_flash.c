@@ -90,6 +90,10 @@
 /** @defgroup STM32_EVAL_SPI_FLASH_Private_Variables
   * @{
   */ 
+static sFLASH_DMACallback_t sFLASH_DMACallback;
+static volatile uint8_t sFLASH_DMABusy = 0;
+static uint8_t sFLASH_DMADummy;
+static const uint8_t sFLASH_DMAIdle = sFLASH_DUMMY_BYTE;
 /**
   * @}
   */ 
@@ -98,6 +102,9 @@
 /** @defgroup STM32_EVAL_SPI_FLASH_Private_Function_Prototypes
   * @{
   */ 
+static void sFLASH_SendAddress(uint8_t Instruction, uint32_t Addr);
+static void sFLASH_StartDMA(uint8_t* pTx, FunctionalState TxInc, uint8_t* pRx,
+                            FunctionalState RxInc, uint16_t Length);
 /**
   * @}
   */ 
@@ -158,6 +165,20 @@ void sFLASH_Init(void)
   * @retval None
   */
 void sFLASH_EraseSector(uint32_t SectorAddr)
+{
+  sFLASH_StartEraseSector(SectorAddr);
+
+  /*!< Wait the end of Flash writing */
+  sFLASH_WaitForWriteEnd();
+}
+
+/**
+  * @brief  Starts the erase of the specified FLASH sector and returns without
+  *         waiting for it, sFLASH_IsBusy() tells when it has completed.
+  * @param  SectorAddr: address of the sector to erase.
+  * @retval None
+  */
+void sFLASH_StartEraseSector(uint32_t SectorAddr)
 {
   /*!< Send write enable instruction */
   sFLASH_WriteEnable();
@@ -175,9 +196,6 @@ void sFLASH_EraseSector(uint32_t SectorAddr)
   sFLASH_SendByte(SectorAddr & 0xFF);
   /*!< Deselect the FLASH: Chip Select high */
   sFLASH_CS_HIGH();
-
-  /*!< Wait the end of Flash writing */
-  sFLASH_WaitForWriteEnd();
 }
 
 /**
@@ -359,6 +377,204 @@ void sFLASH_ReadBuffer(uint8_t* pBuffer, uint32_t ReadAddr, uint16_t NumByteToRe
   sFLASH_CS_HIGH();
 }
 
+/**
+  * @brief  Enables the DMA clock and the interrupt of the DMA receive channel,
+  *         called once after sFLASH_Init(). sFLASH_DMA_IRQHandler() is called
+  *         from the interrupt routine of the DMA receive channel.
+  * @param  None
+  * @retval None
+  */
+void sFLASH_DMA_Init(void)
+{
+  NVIC_InitTypeDef NVIC_InitStructure;
+
+  /*!< Enable the DMA clock */
+  RCC_AHBPeriphClockCmd(RCC_AHBPeriph_DMA1, ENABLE);
+
+  /*!< The end of a transfer is the end of the receive channel */
+  NVIC_InitStructure.NVIC_IRQChannel = sFLASH_DMA_RX_IRQn;
+  NVIC_InitStructure.NVIC_IRQChannelPreemptionPriority = 1;
+  NVIC_InitStructure.NVIC_IRQChannelSubPriority = 0;
+  NVIC_InitStructure.NVIC_IRQChannelCmd = ENABLE;
+  NVIC_Init(&NVIC_InitStructure);
+}
+
+/**
+  * @brief  Reads a block of data from the FLASH with DMA. The function returns
+  *         once the transfer has started, the FLASH stays selected until its
+  *         end.
+  * @param  pBuffer: pointer to the buffer that receives the data read from the FLASH.
+  * @param  ReadAddr: FLASH's internal address to read from.
+  * @param  NumByteToRead: number of bytes to read from the FLASH.
+  * @param  Callback: called from the DMA interrupt once the data is read, can
+  *         be 0.
+  * @retval None
+  */
+void sFLASH_ReadBufferDMA(uint8_t* pBuffer, uint32_t ReadAddr, uint16_t NumByteToRead, sFLASH_DMACallback_t Callback)
+{
+  /*!< Wait the end of the previous DMA transfer */
+  while (sFLASH_DMABusy);
+
+  sFLASH_DMACallback = Callback;
+
+  /*!< Select the FLASH and send the instruction and the address */
+  sFLASH_SendAddress(sFLASH_CMD_READ, ReadAddr);
+
+  /*!< The dummy byte is sent again for every byte received */
+  sFLASH_StartDMA((uint8_t*) &sFLASH_DMAIdle, DISABLE, pBuffer, ENABLE, NumByteToRead);
+}
+
+/**
+  * @brief  Writes up to a page of the FLASH with DMA. The function returns
+  *         once the transfer has started, the page is programmed after its end
+  *         and sFLASH_IsBusy() tells when it has been.
+  * @note   The number of byte can't exceed the FLASH page size.
+  * @param  pBuffer: pointer to the buffer containing the data to be written
+  *         to the FLASH, it is not copied.
+  * @param  WriteAddr: FLASH's internal address to write to.
+  * @param  NumByteToWrite: number of bytes to write to the FLASH, must be equal
+  *         or less than "sFLASH_PAGESIZE" value.
+  * @param  Callback: called from the DMA interrupt once the data is sent, can
+  *         be 0.
+  * @retval None
+  */
+void sFLASH_WritePageDMA(uint8_t* pBuffer, uint32_t WriteAddr, uint16_t NumByteToWrite, sFLASH_DMACallback_t Callback)
+{
+  /*!< Wait the end of the previous DMA transfer */
+  while (sFLASH_DMABusy);
+
+  sFLASH_DMACallback = Callback;
+
+  /*!< Enable the write access to the FLASH */
+  sFLASH_WriteEnable();
+
+  /*!< Select the FLASH and send the instruction and the address */
+  sFLASH_SendAddress(sFLASH_CMD_WRITE, WriteAddr);
+
+  /*!< The bytes received are dropped */
+  sFLASH_StartDMA(pBuffer, ENABLE, &sFLASH_DMADummy, DISABLE, NumByteToWrite);
+}
+
+/**
+  * @brief  Tells if a DMA transfer is in progress.
+  * @param  None
+  * @retval 1 until the end of the transfer, 0 otherwise.
+  */
+uint8_t sFLASH_DMA_IsBusy(void)
+{
+  return sFLASH_DMABusy;
+}
+
+/**
+  * @brief  Ends a DMA transfer, to be called from the interrupt routine of
+  *         the DMA receive channel (DMA1_Channel2_IRQHandler for SPI1).
+  * @param  None
+  * @retval None
+  */
+void sFLASH_DMA_IRQHandler(void)
+{
+  if (DMA_GetITStatus(sFLASH_DMA_RX_IT_TC) == RESET)
+  {
+    return;
+  }
+
+  DMA_ClearITPendingBit(sFLASH_DMA_RX_IT_TC);
+
+  /*!< The last byte is received, the bus is idle */
+  SPI_I2S_DMACmd(sFLASH_SPI, SPI_I2S_DMAReq_Rx | SPI_I2S_DMAReq_Tx, DISABLE);
+  DMA_Cmd(sFLASH_DMA_TX_CHANNEL, DISABLE);
+  DMA_Cmd(sFLASH_DMA_RX_CHANNEL, DISABLE);
+
+  /*!< Deselect the FLASH: Chip Select high */
+  sFLASH_CS_HIGH();
+
+  sFLASH_DMABusy = 0;
+
+  if (sFLASH_DMACallback != 0)
+  {
+    sFLASH_DMACallback();
+  }
+}
+
+/**
+  * @brief  Selects the FLASH and sends an instruction with a 24-bit address.
+  * @param  Instruction: the instruction.
+  * @param  Addr: FLASH's internal address.
+  * @retval None
+  */
+static void sFLASH_SendAddress(uint8_t Instruction, uint32_t Addr)
+{
+  /*!< Select the FLASH: Chip Select low */
+  sFLASH_CS_LOW();
+
+  sFLASH_SendByte(Instruction);
+  sFLASH_SendByte((Addr & 0xFF0000) >> 16);
+  sFLASH_SendByte((Addr & 0xFF00) >> 8);
+  sFLASH_SendByte(Addr & 0xFF);
+}
+
+/**
+  * @brief  Starts moving bytes through sFLASH_SPI with its DMA channels. The
+  *         FLASH is deselected by sFLASH_DMA_IRQHandler() at the end.
+  * @param  pTx: bytes sent, or a single byte sent again if TxInc is DISABLE.
+  * @param  TxInc: memory increment of the transmit channel.
+  * @param  pRx: buffer of the bytes received, or a single byte written again
+  *         if RxInc is DISABLE.
+  * @param  RxInc: memory increment of the receive channel.
+  * @param  Length: number of bytes.
+  * @retval None
+  */
+static void sFLASH_StartDMA(uint8_t* pTx, FunctionalState TxInc, uint8_t* pRx,
+                            FunctionalState RxInc, uint16_t Length)
+{
+  DMA_InitTypeDef DMA_InitStructure;
+
+  if (Length == 0)
+  {
+    sFLASH_CS_HIGH();
+
+    if (sFLASH_DMACallback != 0)
+    {
+      sFLASH_DMACallback();
+    }
+    return;
+  }
+
+  /*!< Drop the byte of the address left in DR */
+  SPI_I2S_ReceiveData(sFLASH_SPI);
+
+  DMA_InitStructure.DMA_PeripheralBaseAddr = (uint32_t) &sFLASH_SPI->DR;
+  DMA_InitStructure.DMA_BufferSize = Length;
+  DMA_InitStructure.DMA_PeripheralInc = DMA_PeripheralInc_Disable;
+  DMA_InitStructure.DMA_PeripheralDataSize = DMA_PeripheralDataSize_Byte;
+  DMA_InitStructure.DMA_MemoryDataSize = DMA_MemoryDataSize_Byte;
+  DMA_InitStructure.DMA_Mode = DMA_Mode_Normal;
+  DMA_InitStructure.DMA_M2M = DMA_M2M_Disable;
+
+  /*!< Receive channel, it has the higher priority so no byte is overrun */
+  DMA_DeInit(sFLASH_DMA_RX_CHANNEL);
+  DMA_InitStructure.DMA_MemoryBaseAddr = (uint32_t) pRx;
+  DMA_InitStructure.DMA_DIR = DMA_DIR_PeripheralSRC;
+  DMA_InitStructure.DMA_MemoryInc = (RxInc == ENABLE) ? DMA_MemoryInc_Enable : DMA_MemoryInc_Disable;
+  DMA_InitStructure.DMA_Priority = DMA_Priority_VeryHigh;
+  DMA_Init(sFLASH_DMA_RX_CHANNEL, &DMA_InitStructure);
+
+  /*!< Transmit channel */
+  DMA_DeInit(sFLASH_DMA_TX_CHANNEL);
+  DMA_InitStructure.DMA_MemoryBaseAddr = (uint32_t) pTx;
+  DMA_InitStructure.DMA_DIR = DMA_DIR_PeripheralDST;
+  DMA_InitStructure.DMA_MemoryInc = (TxInc == ENABLE) ? DMA_MemoryInc_Enable : DMA_MemoryInc_Disable;
+  DMA_InitStructure.DMA_Priority = DMA_Priority_High;
+  DMA_Init(sFLASH_DMA_TX_CHANNEL, &DMA_InitStructure);
+
+  sFLASH_DMABusy = 1;
+
+  DMA_ITConfig(sFLASH_DMA_RX_CHANNEL, DMA_IT_TC, ENABLE);
+  DMA_Cmd(sFLASH_DMA_RX_CHANNEL, ENABLE);
+  DMA_Cmd(sFLASH_DMA_TX_CHANNEL, ENABLE);
+  SPI_I2S_DMACmd(sFLASH_SPI, SPI_I2S_DMAReq_Rx | SPI_I2S_DMAReq_Tx, ENABLE);
+}
+
 /**
   * @brief  Reads FLASH identification.
   * @param  None
@@ -488,6 +704,31 @@ void sFLASH_WriteEnable(void)
   sFLASH_CS_HIGH();
 }
 
+/**
+  * @brief  Reads the Write In Progress (WIP) flag in the FLASH's status
+  *         register once.
+  * @param  None
+  * @retval 1 while a write or erase operation is in progress, 0 otherwise.
+  */
+uint8_t sFLASH_IsBusy(void)
+{
+  uint8_t flashstatus = 0;
+
+  /*!< Select the FLASH: Chip Select low */
+  sFLASH_CS_LOW();
+
+  /*!< Send "Read Status Register" instruction */
+  sFLASH_SendByte(sFLASH_CMD_RDSR);
+
+  /*!< Get the status register */
+  flashstatus = sFLASH_SendByte(sFLASH_DUMMY_BYTE);
+
+  /*!< Deselect the FLASH: Chip Select high */
+  sFLASH_CS_HIGH();
+
+  return (flashstatus & sFLASH_WIP_FLAG) == SET;
+}
+
 /**
   * @brief  Polls the status of the Write In Progress (WIP) flag in the FLASH's
   *         status register and loop until write opertaion has completed.
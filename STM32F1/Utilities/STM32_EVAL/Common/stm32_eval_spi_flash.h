@@ -50,6 +50,10 @@
 /** @defgroup STM32_EVAL_SPI_FLASH_Exported_Types
   * @{
   */ 
+/**
+  * @brief  Called from the DMA interrupt at the end of a DMA transfer
+  */
+typedef void (*sFLASH_DMACallback_t)(void);
 /**
   * @}
   */
@@ -76,6 +80,19 @@
 
 #define sFLASH_M25P128_ID         0x202018
 #define sFLASH_M25P64_ID          0x202017
+
+/**
+  * @brief  DMA channels of sFLASH_SPI, the ones of SPI1 by default. For SPI2
+  *         use DMA1_Channel4 (Rx) and DMA1_Channel5 (Tx), DMA1_FLAG_TC4 and
+  *         DMA1_Channel4_IRQn.
+  */
+#ifndef sFLASH_DMA_RX_CHANNEL
+#define sFLASH_DMA_RX_CHANNEL     DMA1_Channel2
+#define sFLASH_DMA_TX_CHANNEL     DMA1_Channel3
+#define sFLASH_DMA_RX_FLAG_TC     DMA1_FLAG_TC2
+#define sFLASH_DMA_RX_IT_TC       DMA1_IT_TC2
+#define sFLASH_DMA_RX_IRQn        DMA1_Channel2_IRQn
+#endif
   
 /**
   * @}
@@ -107,6 +124,7 @@
 void sFLASH_DeInit(void);
 void sFLASH_Init(void);
 void sFLASH_EraseSector(uint32_t SectorAddr);
+void sFLASH_StartEraseSector(uint32_t SectorAddr);
 void sFLASH_EraseBulk(void);
 void sFLASH_WritePage(uint8_t* pBuffer, uint32_t WriteAddr, uint16_t NumByteToWrite);
 void sFLASH_WriteBuffer(uint8_t* pBuffer, uint32_t WriteAddr, uint16_t NumByteToWrite);
@@ -114,6 +132,15 @@ void sFLASH_ReadBuffer(uint8_t* pBuffer, uint32_t ReadAddr, uint16_t NumByteToRe
 uint32_t sFLASH_ReadID(void);
 void sFLASH_StartReadSequence(uint32_t ReadAddr);
 
+/**
+  * @brief  DMA functions
+  */
+void sFLASH_DMA_Init(void);
+void sFLASH_ReadBufferDMA(uint8_t* pBuffer, uint32_t ReadAddr, uint16_t NumByteToRead, sFLASH_DMACallback_t Callback);
+void sFLASH_WritePageDMA(uint8_t* pBuffer, uint32_t WriteAddr, uint16_t NumByteToWrite, sFLASH_DMACallback_t Callback);
+uint8_t sFLASH_DMA_IsBusy(void);
+void sFLASH_DMA_IRQHandler(void);
+
 /**
   * @brief  Low layer functions
   */
@@ -121,6 +148,7 @@ uint8_t sFLASH_ReadByte(void);
 uint8_t sFLASH_SendByte(uint8_t byte);
 uint16_t sFLASH_SendHalfWord(uint16_t HalfWord);
 void sFLASH_WriteEnable(void);
+uint8_t sFLASH_IsBusy(void);
 void sFLASH_WaitForWriteEnd(void);
 
 #ifdef __cplusplus
@@ -74,6 +74,10 @@
 /** @defgroup STM32_EVAL_SPI_SD_Private_Defines
   * @{
   */ 
+/**
+  * @brief  CRC16 of the data blocks: x^16 + x^12 + x^5 + 1
+  */
+#define SD_CRC16_POLYNOMIAL   0x1021
 /**
   * @}
   */ 
@@ -89,6 +93,10 @@
 /** @defgroup STM32_EVAL_SPI_SD_Private_Variables
   * @{
   */ 
+#ifdef SD_USE_CRC
+static uint16_t SD_DMADummy;
+static const uint16_t SD_DMAIdle = 0xFFFF;
+#endif
 /**
   * @}
   */ 
@@ -97,6 +105,15 @@
 /** @defgroup STM32_EVAL_SPI_SD_Private_Function_Prototypes
   * @{
   */
+static SD_Error SD_ReadData(uint8_t* pBuffer, uint16_t BlockSize);
+static void SD_WriteData(uint8_t* pBuffer, uint16_t BlockSize);
+#ifdef SD_USE_CRC
+static uint8_t SD_CRC7(uint8_t* pFrame, uint8_t Length);
+static void SD_DataMode(FunctionalState CRC16);
+static void SD_SwapBytes(uint8_t* pBuffer, uint16_t Length);
+static void SD_TransferDMA(uint8_t* pTx, FunctionalState TxInc, uint8_t* pRx,
+                           FunctionalState RxInc, uint16_t Length);
+#endif
 /**
   * @}
   */ 
@@ -130,6 +147,11 @@ SD_Error SD_Init(void)
   /*!< Initialize SD_SPI */
   SD_LowLevel_Init(); 
 
+#ifdef SD_USE_CRC
+  /*!< Enable the DMA clock */
+  RCC_AHBPeriphClockCmd(SD_DMA_CLK, ENABLE);
+#endif
+
   /*!< SD chip select high */
   SD_CS_HIGH();
 
@@ -197,7 +219,6 @@ SD_Error SD_GetCardInfo(SD_CardInfo *cardinfo)
   */
 SD_Error SD_ReadBlock(uint8_t* pBuffer, uint32_t ReadAddr, uint16_t BlockSize)
 {
-  uint32_t i = 0;
   SD_Error rvalue = SD_RESPONSE_FAILURE;
 
   /*!< SD chip select low */
@@ -212,20 +233,8 @@ SD_Error SD_ReadBlock(uint8_t* pBuffer, uint32_t ReadAddr, uint16_t BlockSize)
     /*!< Now look for the data token to signify the start of the data */
     if (!SD_GetResponse(SD_START_DATA_SINGLE_BLOCK_READ))
     {
-      /*!< Read the SD block data : read NumByteToRead data */
-      for (i = 0; i < BlockSize; i++)
-      {
-        /*!< Save the received data */
-        *pBuffer = SD_ReadByte();
-       
-        /*!< Point to the next location where the byte read will be saved */
-        pBuffer++;
-      }
-      /*!< Get CRC bytes (not really needed by us, but required by SD) */
-      SD_ReadByte();
-      SD_ReadByte();
-      /*!< Set response value to success */
-      rvalue = SD_RESPONSE_NO_ERROR;
+      /*!< Read the SD block data and its CRC */
+      rvalue = SD_ReadData(pBuffer, BlockSize);
     }
   }
   /*!< SD chip select high */
@@ -251,7 +260,7 @@ SD_Error SD_ReadBlock(uint8_t* pBuffer, uint32_t ReadAddr, uint16_t BlockSize)
   */
 SD_Error SD_ReadMultiBlocks(uint8_t* pBuffer, uint32_t ReadAddr, uint16_t BlockSize, uint32_t NumberOfBlocks)
 {
-  uint32_t i = 0, Offset = 0;
+  uint32_t Offset = 0;
   SD_Error rvalue = SD_RESPONSE_FAILURE;
   
   /*!< SD chip select low */
@@ -269,21 +278,16 @@ SD_Error SD_ReadMultiBlocks(uint8_t* pBuffer, uint32_t ReadAddr, uint16_t BlockS
     /*!< Now look for the data token to signify the start of the data */
     if (!SD_GetResponse(SD_START_DATA_SINGLE_BLOCK_READ))
     {
-      /*!< Read the SD block data : read NumByteToRead data */
-      for (i = 0; i < BlockSize; i++)
+      /*!< Read the SD block data and its CRC */
+      rvalue = SD_ReadData(pBuffer, BlockSize);
+      if (rvalue != SD_RESPONSE_NO_ERROR)
       {
-        /*!< Read the pointed data */
-        *pBuffer = SD_ReadByte();
-        /*!< Point to the next location where the byte read will be saved */
-        pBuffer++;
+        break;
       }
+      /*!< Point to the next location where the block read will be saved */
+      pBuffer += BlockSize;
       /*!< Set next read address*/
       Offset += 512;
-      /*!< get CRC bytes (not really needed by us, but required by SD) */
-      SD_ReadByte();
-      SD_ReadByte();
-      /*!< Set response value to success */
-      rvalue = SD_RESPONSE_NO_ERROR;
     }
     else
     {
@@ -311,7 +315,6 @@ SD_Error SD_ReadMultiBlocks(uint8_t* pBuffer, uint32_t ReadAddr, uint16_t BlockS
   */
 SD_Error SD_WriteBlock(uint8_t* pBuffer, uint32_t WriteAddr, uint16_t BlockSize)
 {
-  uint32_t i = 0;
   SD_Error rvalue = SD_RESPONSE_FAILURE;
 
   /*!< SD chip select low */
@@ -329,17 +332,8 @@ SD_Error SD_WriteBlock(uint8_t* pBuffer, uint32_t WriteAddr, uint16_t BlockSize)
     /*!< Send the data token to signify the start of the data */
     SD_WriteByte(0xFE);
 
-    /*!< Write the block data to SD : write count data by block */
-    for (i = 0; i < BlockSize; i++)
-    {
-      /*!< Send the pointed byte */
-      SD_WriteByte(*pBuffer);
-      /*!< Point to the next location where the byte read will be saved */
-      pBuffer++;
-    }
-    /*!< Put CRC bytes (not really needed by us, but required by SD) */
-    SD_ReadByte();
-    SD_ReadByte();
+    /*!< Write the block data to SD and its CRC */
+    SD_WriteData(pBuffer, BlockSize);
 
     /*!< Read data response */
     if (SD_GetDataResponse() == SD_DATA_OK)
@@ -369,7 +363,7 @@ SD_Error SD_WriteBlock(uint8_t* pBuffer, uint32_t WriteAddr, uint16_t BlockSize)
   */
 SD_Error SD_WriteMultiBlocks(uint8_t* pBuffer, uint32_t WriteAddr, uint16_t BlockSize, uint32_t NumberOfBlocks)
 {
-  uint32_t i = 0, Offset = 0;
+  uint32_t Offset = 0;
   SD_Error rvalue = SD_RESPONSE_FAILURE;
 
   /*!< SD chip select low */
@@ -388,19 +382,12 @@ SD_Error SD_WriteMultiBlocks(uint8_t* pBuffer, uint32_t WriteAddr, uint16_t Bloc
     SD_WriteByte(SD_DUMMY_BYTE);
     /*!< Send the data token to signify the start of the data */
     SD_WriteByte(SD_START_DATA_SINGLE_BLOCK_WRITE);
-    /*!< Write the block data to SD : write count data by block */
-    for (i = 0; i < BlockSize; i++)
-    {
-      /*!< Send the pointed byte */
-      SD_WriteByte(*pBuffer);
-      /*!< Point to the next location where the byte read will be saved */
-      pBuffer++;
-    }
+    /*!< Write the block data to SD and its CRC */
+    SD_WriteData(pBuffer, BlockSize);
+    /*!< Point to the next block to write */
+    pBuffer += BlockSize;
     /*!< Set next write address */
     Offset += 512;
-    /*!< Put CRC bytes (not really needed by us, but required by SD) */
-    SD_ReadByte();
-    SD_ReadByte();
     /*!< Read data response */
     if (SD_GetDataResponse() == SD_DATA_OK)
     {
@@ -663,7 +650,11 @@ void SD_SendCmd(uint8_t Cmd, uint32_t Arg, uint8_t Crc)
   
   Frame[4] = (uint8_t)(Arg); /*!< Construct byte 5 */
   
+#ifdef SD_USE_CRC
+  Frame[5] = (SD_CRC7(Frame, 5) << 1) | 0x01; /*!< Construct CRC: byte 6, the CRC given is not used */
+#else
   Frame[5] = (Crc); /*!< Construct CRC: byte 6 */
+#endif
   
   for (i = 0; i < 6; i++)
   {
@@ -815,6 +806,25 @@ SD_Error SD_GoIdleState(void)
     /*!< Wait for no error Response (R1 Format) equal to 0x00 */
   }
   while (SD_GetResponse(SD_RESPONSE_NO_ERROR));
+
+#ifdef SD_USE_CRC
+  /*!< SD chip select high */
+  SD_CS_HIGH();
+
+  /*!< Send Dummy byte 0xFF */
+  SD_WriteByte(SD_DUMMY_BYTE);
+
+  /*!< SD chip select low */
+  SD_CS_LOW();
+
+  /*!< Send CMD59 (SD_CMD_CRC_ON_OFF) to turn the CRC checks of the card on */
+  SD_SendCmd(SD_CMD_CRC_ON_OFF, 1, 0xFF);
+  if (SD_GetResponse(SD_RESPONSE_NO_ERROR))
+  {
+    SD_CS_HIGH();
+    return SD_RESPONSE_FAILURE;
+  }
+#endif
   
   /*!< SD chip select high */
   SD_CS_HIGH();
@@ -876,6 +886,248 @@ uint8_t SD_ReadByte(void)
   return Data;
 }
 
+/**
+  * @brief  Reads the data of a block after its start token, and its CRC.
+  * @param  pBuffer: pointer to the buffer that receives the data, half-word
+  *         aligned with SD_USE_CRC.
+  * @param  BlockSize: the SD card Data block size.
+  * @retval The SD Response:
+  *         - SD_DATA_CRC_ERROR: the CRC of the block is wrong
+  *         - SD_RESPONSE_NO_ERROR: Sequence succeed
+  */
+static SD_Error SD_ReadData(uint8_t* pBuffer, uint16_t BlockSize)
+{
+#ifdef SD_USE_CRC
+  SD_Error rvalue = SD_RESPONSE_NO_ERROR;
+
+  SD_DataMode(ENABLE);
+
+  /*!< The dummy half-word is sent again for every half-word received */
+  SD_TransferDMA((uint8_t*) &SD_DMAIdle, DISABLE, pBuffer, ENABLE, BlockSize / 2);
+
+  /*!< The CRC of the card follows, received while SD_SPI sends its own */
+  while (SPI_I2S_GetFlagStatus(SD_SPI, SPI_I2S_FLAG_RXNE) == RESET)
+  {
+  }
+  SPI_I2S_ReceiveData(SD_SPI);
+
+  if (SPI_I2S_GetFlagStatus(SD_SPI, SPI_FLAG_CRCERR) != RESET)
+  {
+    SPI_I2S_ClearFlag(SD_SPI, SPI_FLAG_CRCERR);
+    rvalue = SD_DATA_CRC_ERROR;
+  }
+
+  SD_DataMode(DISABLE);
+
+  /*!< The first byte of each half-word was received in its high byte */
+  SD_SwapBytes(pBuffer, BlockSize);
+
+  return rvalue;
+#else
+  uint32_t i = 0;
+
+  /*!< Read the SD block data : read NumByteToRead data */
+  for (i = 0; i < BlockSize; i++)
+  {
+    /*!< Save the received data */
+    *pBuffer = SD_ReadByte();
+
+    /*!< Point to the next location where the byte read will be saved */
+    pBuffer++;
+  }
+  /*!< Get CRC bytes (not really needed by us, but required by SD) */
+  SD_ReadByte();
+  SD_ReadByte();
+
+  return SD_RESPONSE_NO_ERROR;
+#endif
+}
+
+/**
+  * @brief  Writes the data of a block after its start token, and its CRC.
+  * @param  pBuffer: pointer to the buffer containing the data, half-word
+  *         aligned with SD_USE_CRC. Its bytes are swapped during the transfer.
+  * @param  BlockSize: the SD card Data block size.
+  * @retval None
+  */
+static void SD_WriteData(uint8_t* pBuffer, uint16_t BlockSize)
+{
+#ifdef SD_USE_CRC
+  /*!< A half-word is sent high byte first */
+  SD_SwapBytes(pBuffer, BlockSize);
+
+  SD_DataMode(ENABLE);
+
+  /*!< The bytes received are dropped */
+  SD_TransferDMA(pBuffer, ENABLE, (uint8_t*) &SD_DMADummy, DISABLE, BlockSize / 2);
+
+  /*!< SD_SPI sends the CRC after the last half-word */
+  while (SPI_I2S_GetFlagStatus(SD_SPI, SPI_I2S_FLAG_RXNE) == RESET)
+  {
+  }
+  SPI_I2S_ReceiveData(SD_SPI);
+  SPI_I2S_ClearFlag(SD_SPI, SPI_FLAG_CRCERR);
+
+  SD_DataMode(DISABLE);
+
+  SD_SwapBytes(pBuffer, BlockSize);
+#else
+  uint32_t i = 0;
+
+  /*!< Write the block data to SD : write count data by block */
+  for (i = 0; i < BlockSize; i++)
+  {
+    /*!< Send the pointed byte */
+    SD_WriteByte(*pBuffer);
+    /*!< Point to the next location where the byte read will be saved */
+    pBuffer++;
+  }
+  /*!< Put CRC bytes (not really needed by us, but required by SD) */
+  SD_ReadByte();
+  SD_ReadByte();
+#endif
+}
+
+#ifdef SD_USE_CRC
+/**
+  * @brief  Computes the CRC7 of a command, x^7 + x^3 + 1. It is computed as
+  *         the 8-bit CRC x^8 + x^4 + x, which is the CRC7 shifted left.
+  * @param  pFrame: the bytes of the command.
+  * @param  Length: number of bytes.
+  * @retval The CRC7.
+  */
+static uint8_t SD_CRC7(uint8_t* pFrame, uint8_t Length)
+{
+  uint8_t Crc = 0, i = 0;
+
+  while (Length--)
+  {
+    Crc ^= *pFrame++;
+    for (i = 0; i < 8; i++)
+    {
+      Crc = (Crc & 0x80) ? ((Crc << 1) ^ 0x12) : (Crc << 1);
+    }
+  }
+
+  return Crc >> 1;
+}
+
+/**
+  * @brief  Switches SD_SPI between the 8-bit frames of the commands and the
+  *         16-bit frames with the CRC16 of the data blocks. The CRC is reset.
+  * @param  CRC16: ENABLE for the data blocks.
+  * @retval None
+  */
+static void SD_DataMode(FunctionalState CRC16)
+{
+  /*!< The frame size and the CRC are only changed with SD_SPI disabled */
+  while (SPI_I2S_GetFlagStatus(SD_SPI, SPI_I2S_FLAG_BSY) == SET)
+  {
+  }
+  SPI_Cmd(SD_SPI, DISABLE);
+
+  /*!< Clearing CRCEN resets the CRC */
+  SPI_CalculateCRC(SD_SPI, DISABLE);
+
+  if (CRC16 == ENABLE)
+  {
+    SPI_DataSizeConfig(SD_SPI, SPI_DataSize_16b);
+    SD_SPI->CRCPR = SD_CRC16_POLYNOMIAL;
+    SPI_CalculateCRC(SD_SPI, ENABLE);
+  }
+  else
+  {
+    SPI_DataSizeConfig(SD_SPI, SPI_DataSize_8b);
+  }
+
+  SPI_Cmd(SD_SPI, ENABLE);
+}
+
+/**
+  * @brief  Swaps the two bytes of every half-word, by words when the buffer
+  *         is word aligned.
+  * @param  pBuffer: half-word aligned buffer.
+  * @param  Length: number of bytes, even.
+  * @retval None
+  */
+static void SD_SwapBytes(uint8_t* pBuffer, uint16_t Length)
+{
+  uint32_t* pWord = (uint32_t*) pBuffer;
+  uint16_t* pHalfWord = (uint16_t*) pBuffer;
+
+  if (((uint32_t) pBuffer & 0x03) == 0)
+  {
+    for (; Length >= 4; Length -= 4)
+    {
+      *pWord = __REV16(*pWord);
+      pWord++;
+    }
+    pHalfWord = (uint16_t*) pWord;
+  }
+
+  for (; Length >= 2; Length -= 2)
+  {
+    *pHalfWord = (uint16_t) __REV16(*pHalfWord);
+    pHalfWord++;
+  }
+}
+
+/**
+  * @brief  Moves half-words through SD_SPI with its DMA channels, SD_SPI
+  *         sends its CRC after the last one. Returns when the last half-word
+  *         is received.
+  * @param  pTx: half-words sent, or a single half-word sent again if TxInc is
+  *         DISABLE.
+  * @param  TxInc: memory increment of the transmit channel.
+  * @param  pRx: buffer of the half-words received, or a single half-word
+  *         written again if RxInc is DISABLE.
+  * @param  RxInc: memory increment of the receive channel.
+  * @param  Length: number of half-words.
+  * @retval None
+  */
+static void SD_TransferDMA(uint8_t* pTx, FunctionalState TxInc, uint8_t* pRx,
+                           FunctionalState RxInc, uint16_t Length)
+{
+  DMA_InitTypeDef DMA_InitStructure;
+
+  DMA_InitStructure.DMA_PeripheralBaseAddr = (uint32_t) &SD_SPI->DR;
+  DMA_InitStructure.DMA_BufferSize = Length;
+  DMA_InitStructure.DMA_PeripheralInc = DMA_PeripheralInc_Disable;
+  DMA_InitStructure.DMA_PeripheralDataSize = DMA_PeripheralDataSize_HalfWord;
+  DMA_InitStructure.DMA_MemoryDataSize = DMA_MemoryDataSize_HalfWord;
+  DMA_InitStructure.DMA_Mode = DMA_Mode_Normal;
+  DMA_InitStructure.DMA_M2M = DMA_M2M_Disable;
+
+  /*!< Receive channel, it has the higher priority so no half-word is overrun */
+  DMA_DeInit(SD_DMA_RX_CHANNEL);
+  DMA_InitStructure.DMA_MemoryBaseAddr = (uint32_t) pRx;
+  DMA_InitStructure.DMA_DIR = DMA_DIR_PeripheralSRC;
+  DMA_InitStructure.DMA_MemoryInc = (RxInc == ENABLE) ? DMA_MemoryInc_Enable : DMA_MemoryInc_Disable;
+  DMA_InitStructure.DMA_Priority = DMA_Priority_VeryHigh;
+  DMA_Init(SD_DMA_RX_CHANNEL, &DMA_InitStructure);
+
+  /*!< Transmit channel */
+  DMA_DeInit(SD_DMA_TX_CHANNEL);
+  DMA_InitStructure.DMA_MemoryBaseAddr = (uint32_t) pTx;
+  DMA_InitStructure.DMA_DIR = DMA_DIR_PeripheralDST;
+  DMA_InitStructure.DMA_MemoryInc = (TxInc == ENABLE) ? DMA_MemoryInc_Enable : DMA_MemoryInc_Disable;
+  DMA_InitStructure.DMA_Priority = DMA_Priority_High;
+  DMA_Init(SD_DMA_TX_CHANNEL, &DMA_InitStructure);
+
+  DMA_Cmd(SD_DMA_RX_CHANNEL, ENABLE);
+  DMA_Cmd(SD_DMA_TX_CHANNEL, ENABLE);
+  SPI_I2S_DMACmd(SD_SPI, SPI_I2S_DMAReq_Rx | SPI_I2S_DMAReq_Tx, ENABLE);
+
+  while (DMA_GetFlagStatus(SD_DMA_RX_FLAG_TC) == RESET)
+  {
+  }
+
+  SPI_I2S_DMACmd(SD_SPI, SPI_I2S_DMAReq_Rx | SPI_I2S_DMAReq_Tx, DISABLE);
+  DMA_Cmd(SD_DMA_TX_CHANNEL, DISABLE);
+  DMA_Cmd(SD_DMA_RX_CHANNEL, DISABLE);
+}
+#endif
+
 /**
   * @}
   */
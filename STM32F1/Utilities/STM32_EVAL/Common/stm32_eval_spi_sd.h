@@ -209,6 +209,29 @@ typedef struct
 #define SD_CMD_ERASE_GRP_END          36  /*!< CMD36 = 0x64 */
 #define SD_CMD_UNTAG_ERASE_GROUP      37  /*!< CMD37 = 0x65 */
 #define SD_CMD_ERASE                  38  /*!< CMD38 = 0x66 */
+#define SD_CMD_CRC_ON_OFF             59  /*!< CMD59 = 0x7B */
+
+/**
+  * @brief  Uncomment to check the transfers with CRCs: the commands carry their
+  *         CRC7, CMD59 makes the card check them and the CRC16 of the blocks
+  *         written, and the blocks move by DMA in 16-bit frames with the CRC16
+  *         computed, sent and checked by SD_SPI. The buffers of the blocks are
+  *         then half-word aligned.
+  */
+/* #define SD_USE_CRC */
+
+/**
+  * @brief  DMA channels of SD_SPI for SD_USE_CRC, the ones of SPI1 by default.
+  *         For SPI2 use DMA1_Channel4 (Rx), DMA1_Channel5 (Tx) and
+  *         DMA1_FLAG_TC4, for SPI3 DMA2_Channel1 (Rx), DMA2_Channel2 (Tx),
+  *         DMA2_FLAG_TC1 and RCC_AHBPeriph_DMA2.
+  */
+#ifndef SD_DMA_RX_CHANNEL
+#define SD_DMA_RX_CHANNEL             DMA1_Channel2
+#define SD_DMA_TX_CHANNEL             DMA1_Channel3
+#define SD_DMA_RX_FLAG_TC             DMA1_FLAG_TC2
+#define SD_DMA_CLK                    RCC_AHBPeriph_DMA1
+#endif
 
 /**
   * @}
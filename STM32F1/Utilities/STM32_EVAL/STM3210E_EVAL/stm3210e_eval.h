@@ -219,14 +219,20 @@
 #define SD_DETECT_GPIO_CLK               RCC_APB2Periph_GPIOF
 
 #define SDIO_FIFO_ADDRESS                ((uint32_t)0x40018080)
+#define SD_SDIO_DMA_IRQn                 DMA2_Channel4_5_IRQn
+#define SD_SDIO_DMA_IRQHANDLER           DMA2_Channel4_5_IRQHandler
 /** 
   * @brief  SDIO Intialization Frequency (400KHz max)
   */
 #define SDIO_INIT_CLK_DIV                ((uint8_t)0xB2)
 /** 
-  * @brief  SDIO Data Transfer Frequency (25MHz max) 
+  * @brief  SDIO Data Transfer Frequency (25MHz max), 24MHz
   */
-#define SDIO_TRANSFER_CLK_DIV            ((uint8_t)0x00) 
+#define SDIO_TRANSFER_CLK_DIV            ((uint8_t)0x01) 
+/** 
+  * @brief  SDIO Data Transfer Frequency in High Speed mode (50MHz max), 36MHz
+  */
+#define SDIO_HS_TRANSFER_CLK_DIV         ((uint8_t)0x00) 
 
 /**
   * @}
@@ -52,6 +52,17 @@ typedef struct
   __IO uint16_t LCD_REG;
   __IO uint16_t LCD_RAM;
 } LCD_TypeDef;
+
+/* Glyph expanded for a font and a pair of colors, column after column */
+typedef struct
+{
+  const sFONT *Font;
+  uint32_t Stamp;
+  uint16_t TextColor;
+  uint16_t BackColor;
+  uint8_t Ascii;
+  uint16_t Pixels[16 * 24];
+} LCD_Glyph;
 /**
   * @}
   */ 
@@ -66,6 +77,15 @@ typedef struct
 #define MAX_POLY_CORNERS   200
 #define POLY_Y(Z)          ((int32_t)((Points + Z)->X))
 #define POLY_X(Z)          ((int32_t)((Points + Z)->Y))                                
+#define LCD_DMA_MAX_COUNT  0xFFFF
+/* Settings restored once the DMA transfer in progress is complete */
+#define LCD_RESTORE_WINDOW 0x01
+#define LCD_RESTORE_ENTRY  0x02
+#define LCD_GLYPH_PIXELS   (sizeof(((LCD_Glyph *)0)->Pixels) / sizeof(uint16_t))
+
+#if LCD_GLYPH_CACHE_SIZE < 2
+ #error "LCD_GLYPH_CACHE_SIZE must be 2 or more"
+#endif
 /**
   * @}
   */ 
@@ -84,6 +104,12 @@ typedef struct
 static sFONT *LCD_Currentfonts;
 /* Global variables to set the written text color */
 static  __IO uint16_t TextColor = 0x0000, BackColor = 0xFFFF;
+/* Source of the DMA fills and of the monocolor picture lines */
+static uint16_t LCD_DMAColor;
+static uint16_t LCD_DMALine[2][LCD_PIXEL_WIDTH];
+static uint8_t LCD_DMARestore = 0;
+static LCD_Glyph LCD_GlyphCache[LCD_GLYPH_CACHE_SIZE];
+static uint32_t LCD_GlyphStamp = 0;
   
 /**
   * @}
@@ -98,6 +124,10 @@ static void delay(vu32 nCount);
 #endif /* USE_Delay*/
 static void PutPixel(int16_t x, int16_t y);
 static void LCD_PolyLineRelativeClosed(pPoint Points, uint16_t PointCount, uint16_t Closed);
+static void LCD_DMAComplete(void);
+static void LCD_DMAWrite(const uint16_t *Source, FunctionalState Increment, uint32_t Count);
+static const uint16_t *LCD_GetGlyph(uint8_t Ascii);
+static void LCD_DrawGlyphRun(uint8_t Line, uint16_t Column, const uint8_t *ptr, uint16_t Count);
 /**
   * @}
   */ 
@@ -402,14 +432,10 @@ void LCD_ClearLine(uint8_t Line)
   */
 void LCD_Clear(uint16_t Color)
 {
-  uint32_t index = 0;
-  
   LCD_SetCursor(0x00, 0x013F); 
   LCD_WriteRAM_Prepare(); /* Prepare to write GRAM */
-  for(index = 0; index < 76800; index++)
-  {
-    LCD->LCD_RAM = Color;
-  }  
+  LCD_DMAColor = Color;
+  LCD_DMAWrite(&LCD_DMAColor, DISABLE, (uint32_t)LCD_PIXEL_WIDTH * LCD_PIXEL_HEIGHT);
 }
 
 
@@ -475,8 +501,7 @@ void LCD_DrawChar(uint8_t Xpos, uint16_t Ypos, const uint16_t *c)
   */
 void LCD_DisplayChar(uint8_t Line, uint16_t Column, uint8_t Ascii)
 {
-  Ascii -= 32;
-  LCD_DrawChar(Line, Column, &LCD_Currentfonts->table[Ascii * LCD_Currentfonts->Height]);
+  LCD_DrawGlyphRun(Line, Column, &Ascii, 1);
 }
 
 
@@ -490,18 +515,30 @@ void LCD_DisplayChar(uint8_t Line, uint16_t Column, uint8_t Ascii)
   */
 void LCD_DisplayStringLine(uint8_t Line, uint8_t *ptr)
 {
-  uint16_t refcolumn = LCD_PIXEL_WIDTH - 1;
+  LCD_DisplayString(Line, LCD_PIXEL_WIDTH - 1, ptr);
+}
 
-  /* Send the string character by character on lCD */
-  while ((*ptr != 0) & (((refcolumn + 1) & 0xFFFF) >= LCD_Currentfonts->Width))
+
+/**
+  * @brief  Displays the characters of a string that fit from a column to the
+  *         right edge of the LCD, in a single display window.
+  * @param  Line: the Line where to display the character shape .
+  * @param  Column: start column address.
+  * @param  *ptr: pointer to string to display on LCD.
+  * @retval None
+  */
+void LCD_DisplayString(uint8_t Line, uint16_t Column, uint8_t *ptr)
+{
+  uint16_t refcolumn = Column, count = 0;
+
+  /* Count the characters that fit on the line */
+  while ((ptr[count] != 0) & (((refcolumn + 1) & 0xFFFF) >= LCD_Currentfonts->Width))
   {
-    /* Display one character on LCD */
-    LCD_DisplayChar(Line, refcolumn, *ptr);
-    /* Decrement the column position by 16 */
     refcolumn -= LCD_Currentfonts->Width;
-    /* Point on the next character */
-    ptr++;
+    count++;
   }
+
+  LCD_DrawGlyphRun(Line, Column, ptr, count);
 }
 
 
@@ -670,28 +707,37 @@ void LCD_DrawCircle(uint8_t Xpos, uint16_t Ypos, uint16_t Radius)
   */
 void LCD_DrawMonoPict(const uint32_t *Pict)
 {
-  uint32_t index = 0, i = 0;
+  uint32_t index = 0, i = 0, line = 0;
+  uint16_t *pixel;
   LCD_SetCursor(0, (LCD_PIXEL_WIDTH - 1));
   LCD_WriteRAM_Prepare(); /* Prepare to write GRAM */
-  for(index = 0; index < 2400; index++)
+  for(line = 0; line < LCD_PIXEL_HEIGHT; line++)
   {
-    for(i = 0; i < 32; i++)
+    /* Expand a line while the DMA sends the previous one */
+    pixel = LCD_DMALine[line & 1];
+    for(index = 0; index < (LCD_PIXEL_WIDTH / 32); index++, Pict++)
     {
-      if((Pict[index] & (1 << i)) == 0x00)
-      {
-        LCD_WriteRAM(BackColor);
-      }
-      else
+      for(i = 0; i < 32; i++)
       {
-        LCD_WriteRAM(TextColor);
+        if((*Pict & (1 << i)) == 0x00)
+        {
+          *pixel++ = BackColor;
+        }
+        else
+        {
+          *pixel++ = TextColor;
+        }
       }
     }
+    LCD_DMAWrite(LCD_DMALine[line & 1], ENABLE, LCD_PIXEL_WIDTH);
   }
 }
 
 
 /**
   * @brief  Displays a bitmap picture loaded in the internal Flash.
+  * @note   The picture is sent by DMA and may still be read when the function
+  *         returns: call LCD_WaitTransfer() before changing a picture in RAM.
   * @param  BmpAddress: Bmp picture address in the internal Flash.
   * @retval None
   */
@@ -713,6 +759,15 @@ void LCD_WriteBMP(uint32_t BmpAddress)
  
   LCD_WriteRAM_Prepare();
  
+  if((BmpAddress & 0x1) == 0)
+  {
+    LCD_DMAWrite((const uint16_t *)BmpAddress, ENABLE, size);
+    /* The write direction is set back at the end of the transfer */
+    LCD_DMARestore |= LCD_RESTORE_ENTRY;
+    return;
+  }
+
+  /* The DMA can't read halfwords at an odd address */
   for(index = 0; index < size; index++)
   {
     LCD_WriteRAM(*(__IO uint16_t *)BmpAddress);
@@ -743,18 +798,22 @@ void LCD_DrawFullRect(uint16_t Xpos, uint16_t Ypos, uint16_t Width, uint16_t Hei
   LCD_DrawLine(Xpos, Ypos, Height, LCD_DIR_VERTICAL);
   LCD_DrawLine(Xpos, (Ypos - Width + 1), Height, LCD_DIR_VERTICAL);
 
+  if((Width <= 2) || (Height <= 1))
+  {
+    return;
+  }
+
   Width -= 2;
   Height--;
   Ypos--;
 
-  LCD_SetTextColor(BackColor);
-
-  while(Height--)
-  {
-    LCD_DrawLine(++Xpos, Ypos, Width, LCD_DIR_HORIZONTAL);    
-  }
-
-  LCD_SetTextColor(TextColor);
+  /* Fill the inside as a single window */
+  LCD_SetDisplayWindow(Xpos + Height, Ypos, Height, Width);
+  LCD_WriteRAM_Prepare(); /* Prepare to write GRAM */
+  LCD_DMAColor = BackColor;
+  LCD_DMAWrite(&LCD_DMAColor, DISABLE, (uint32_t)Width * Height);
+  /* The full window is set back at the end of the transfer */
+  LCD_DMARestore |= LCD_RESTORE_WINDOW;
 }
 
 /**
@@ -1087,6 +1146,7 @@ void LCD_FillPolyLine(pPoint Points, uint16_t PointCount)
   */
 void LCD_WriteReg(uint8_t LCD_Reg, uint16_t LCD_RegValue)
 {
+  LCD_WaitTransfer();
   /* Write 16-bit Index, then Write Reg */
   LCD->LCD_REG = LCD_Reg;
   /* Write 16-bit Reg */
@@ -1101,6 +1161,7 @@ void LCD_WriteReg(uint8_t LCD_Reg, uint16_t LCD_RegValue)
   */
 uint16_t LCD_ReadReg(uint8_t LCD_Reg)
 {
+  LCD_WaitTransfer();
   /* Write 16-bit Index (then Read Reg) */
   LCD->LCD_REG = LCD_Reg;
   /* Read 16-bit Reg */
@@ -1115,6 +1176,7 @@ uint16_t LCD_ReadReg(uint8_t LCD_Reg)
   */
 void LCD_WriteRAM_Prepare(void)
 {
+  LCD_WaitTransfer();
   LCD->LCD_REG = LCD_REG_34;
 }
 
@@ -1138,6 +1200,7 @@ void LCD_WriteRAM(uint16_t RGB_Code)
   */
 uint16_t LCD_ReadRAM(void)
 {
+  LCD_WaitTransfer();
   /* Write 16-bit Index (then Read Reg) */
   LCD->LCD_REG = LCD_REG_34; /* Select GRAM Reg */
   /* Read 16-bit Reg */
@@ -1145,6 +1208,36 @@ uint16_t LCD_ReadRAM(void)
 }
 
 
+/**
+  * @brief  Waits for the end of the DMA fill or blit in progress.
+  * @note   Called before any access to the LCD registers, so the drawing
+  *         functions that follow a DMA transfer don't need it.
+  * @param  None
+  * @retval None
+  */
+void LCD_WaitTransfer(void)
+{
+  uint8_t restore = 0;
+
+  LCD_DMAComplete();
+
+  restore = LCD_DMARestore;
+  LCD_DMARestore = 0;
+
+  if((restore & LCD_RESTORE_WINDOW) != 0)
+  {
+    LCD_SetDisplayWindow(239, 0x13F, 240, 320);
+  }
+  if((restore & LCD_RESTORE_ENTRY) != 0)
+  {
+    /* Set GRAM write direction and BGR = 1 */
+    /* I/D = 01 (Horizontal : increment, Vertical : decrement) */
+    /* AM = 1 (address is updated in vertical writing direction) */
+    LCD_WriteReg(LCD_REG_3, 0x1018);
+  }
+}
+
+
 /**
   * @brief  Power on the LCD.
   * @param  None
@@ -1202,8 +1295,8 @@ void LCD_DisplayOff(void)
 void LCD_CtrlLinesConfig(void)
 {
   GPIO_InitTypeDef GPIO_InitStructure;
-  /* Enable FSMC, GPIOD, GPIOE, GPIOF, GPIOG and AFIO clocks */
-  RCC_AHBPeriphClockCmd(RCC_AHBPeriph_FSMC, ENABLE);
+  /* Enable FSMC, DMA, GPIOD, GPIOE, GPIOF, GPIOG and AFIO clocks */
+  RCC_AHBPeriphClockCmd(RCC_AHBPeriph_FSMC | LCD_DMA_CLK, ENABLE);
   RCC_APB2PeriphClockCmd(RCC_APB2Periph_GPIOD | RCC_APB2Periph_GPIOE |
                          RCC_APB2Periph_GPIOF | RCC_APB2Periph_GPIOG |
                          RCC_APB2Periph_AFIO, ENABLE);
@@ -1292,6 +1385,175 @@ static void PutPixel(int16_t x, int16_t y)
   LCD_DrawLine(x, y, 1, LCD_DIR_HORIZONTAL);
 }
 
+/**
+  * @brief  Waits for the end of the current DMA transfer and disables it.
+  * @param  None
+  * @retval None
+  */
+static void LCD_DMAComplete(void)
+{
+  if((LCD_DMA_CHANNEL->CCR & DMA_CCR1_EN) != 0)
+  {
+    while(DMA_GetFlagStatus(LCD_DMA_FLAG_TC) == RESET)
+    {
+    }
+    DMA_Cmd(LCD_DMA_CHANNEL, DISABLE);
+    DMA_ClearFlag(LCD_DMA_FLAG_TC);
+  }
+}
+
+/**
+  * @brief  Sends pixels to the LCD RAM by memory to memory DMA.
+  * @note   The GRAM must be prepared for writing. The last part of the
+  *         transfer is still in progress when the function returns.
+  * @param  Source: pixels, or the color of a fill.
+  * @param  Increment: ENABLE to send successive pixels, DISABLE for a fill.
+  * @param  Count: number of pixels.
+  * @retval None
+  */
+static void LCD_DMAWrite(const uint16_t *Source, FunctionalState Increment, uint32_t Count)
+{
+  DMA_InitTypeDef DMA_InitStructure;
+  uint32_t part = 0;
+
+  DMA_InitStructure.DMA_MemoryBaseAddr = (uint32_t)&LCD->LCD_RAM;
+  DMA_InitStructure.DMA_DIR = DMA_DIR_PeripheralSRC;
+  DMA_InitStructure.DMA_PeripheralInc = (Increment == ENABLE) ? DMA_PeripheralInc_Enable : DMA_PeripheralInc_Disable;
+  DMA_InitStructure.DMA_MemoryInc = DMA_MemoryInc_Disable;
+  DMA_InitStructure.DMA_PeripheralDataSize = DMA_PeripheralDataSize_HalfWord;
+  DMA_InitStructure.DMA_MemoryDataSize = DMA_MemoryDataSize_HalfWord;
+  DMA_InitStructure.DMA_Mode = DMA_Mode_Normal;
+  DMA_InitStructure.DMA_Priority = DMA_Priority_High;
+  DMA_InitStructure.DMA_M2M = DMA_M2M_Enable;
+
+  while(Count != 0)
+  {
+    part = (Count > LCD_DMA_MAX_COUNT) ? LCD_DMA_MAX_COUNT : Count;
+
+    LCD_DMAComplete();
+
+    DMA_InitStructure.DMA_PeripheralBaseAddr = (uint32_t)Source;
+    DMA_InitStructure.DMA_BufferSize = part;
+    DMA_Init(LCD_DMA_CHANNEL, &DMA_InitStructure);
+    DMA_Cmd(LCD_DMA_CHANNEL, ENABLE);
+
+    if(Increment == ENABLE)
+    {
+      Source += part;
+    }
+    Count -= part;
+  }
+}
+
+/**
+  * @brief  Gives a character of the current font expanded in the current
+  *         colors, from the glyph cache or expanded in place of the least
+  *         recently used glyph.
+  * @note   The glyph sent last by DMA is the most recently used one, so it is
+  *         never replaced while the transfer is in progress.
+  * @param  Ascii: character ascii code, must be between 0x20 and 0x7E.
+  * @retval Pixels of the glyph, one column of Height pixels after the other.
+  */
+static const uint16_t *LCD_GetGlyph(uint8_t Ascii)
+{
+  LCD_Glyph *glyph;
+  const uint16_t *c;
+  uint32_t index = 0, i = 0, mask = 0, oldest = 0;
+  uint16_t *pixel;
+
+  for(index = 0; index < LCD_GLYPH_CACHE_SIZE; index++)
+  {
+    glyph = &LCD_GlyphCache[index];
+    if((glyph->Font == LCD_Currentfonts) && (glyph->Ascii == Ascii) &&
+       (glyph->TextColor == TextColor) && (glyph->BackColor == BackColor))
+    {
+      glyph->Stamp = ++LCD_GlyphStamp;
+      return glyph->Pixels;
+    }
+    if(glyph->Stamp < LCD_GlyphCache[oldest].Stamp)
+    {
+      oldest = index;
+    }
+  }
+
+  glyph = &LCD_GlyphCache[oldest];
+  glyph->Font = LCD_Currentfonts;
+  glyph->Ascii = Ascii;
+  glyph->TextColor = TextColor;
+  glyph->BackColor = BackColor;
+  glyph->Stamp = ++LCD_GlyphStamp;
+
+  c = &LCD_Currentfonts->table[(Ascii - 32) * LCD_Currentfonts->Height];
+  pixel = glyph->Pixels;
+  for(i = 0; i < LCD_Currentfonts->Width; i++)
+  {
+    if(LCD_Currentfonts->Width <= 12)
+    {
+      mask = (0x80 << ((LCD_Currentfonts->Width / 12 ) * 8 ) ) >> i;
+    }
+    else
+    {
+      mask = 0x1 << i;
+    }
+    for(index = 0; index < LCD_Currentfonts->Height; index++)
+    {
+      *pixel++ = ((c[index] & mask) == 0x00) ? BackColor : TextColor;
+    }
+  }
+
+  return glyph->Pixels;
+}
+
+/**
+  * @brief  Draws characters side by side in one display window.
+  * @note   With AM = 0 the GRAM is written one column after the other, so
+  *         every glyph of the cache is one DMA transfer.
+  * @param  Line: the Line where to display the character shape.
+  * @param  Column: start column address.
+  * @param  ptr: pointer to the characters.
+  * @param  Count: number of characters.
+  * @retval None
+  */
+static void LCD_DrawGlyphRun(uint8_t Line, uint16_t Column, const uint8_t *ptr, uint16_t Count)
+{
+  uint32_t width = (uint32_t)Count * LCD_Currentfonts->Width;
+  uint32_t size = (uint32_t)LCD_Currentfonts->Width * LCD_Currentfonts->Height;
+
+  if(Count == 0)
+  {
+    return;
+  }
+
+  /* Fonts too large for the cache and glyphs out of the screen: pixel by pixel */
+  if((size > LCD_GLYPH_PIXELS) || (width > ((uint32_t)Column + 1)) ||
+     (((uint32_t)Line + LCD_Currentfonts->Height) > LCD_PIXEL_HEIGHT))
+  {
+    while(Count--)
+    {
+      LCD_DrawChar(Line, Column, &LCD_Currentfonts->table[(*ptr++ - 32) * LCD_Currentfonts->Height]);
+      Column -= LCD_Currentfonts->Width;
+    }
+    return;
+  }
+
+  LCD_SetDisplayWindow(Line + LCD_Currentfonts->Height - 1, Column, LCD_Currentfonts->Height, width);
+  LCD_SetCursor(Line, Column);
+  /* Set GRAM write direction and BGR = 1 */
+  /* I/D = 01 (Horizontal : increment, Vertical : decrement) */
+  /* AM = 0 (address is updated in horizontal writing direction) */
+  LCD_WriteReg(LCD_REG_3, 0x1010);
+  LCD_WriteRAM_Prepare(); /* Prepare to write GRAM */
+
+  while(Count--)
+  {
+    LCD_DMAWrite(LCD_GetGlyph(*ptr++), ENABLE, size);
+  }
+
+  /* The full window and the write direction are set back at the end of the
+     transfer */
+  LCD_DMARestore |= LCD_RESTORE_WINDOW | LCD_RESTORE_ENTRY;
+}
+
 #ifndef USE_Delay
 /**
   * @brief  Inserts a delay time.
@@ -257,6 +257,21 @@ typedef struct
 #define LCD_PIXEL_WIDTH          0x0140
 #define LCD_PIXEL_HEIGHT         0x00F0
 
+/** 
+  * @brief  DMA channel used for the memory to LCD fills and blits  
+  */ 
+#define LCD_DMA_CHANNEL          DMA2_Channel1
+#define LCD_DMA_FLAG_TC          DMA2_FLAG_TC1
+#define LCD_DMA_CLK              RCC_AHBPeriph_DMA2
+
+/** 
+  * @brief  Glyphs kept expanded in RAM by the text functions, 2 or more
+  *         (768 bytes each)  
+  */ 
+#ifndef LCD_GLYPH_CACHE_SIZE
+ #define LCD_GLYPH_CACHE_SIZE    16
+#endif
+
 /**
   * @}
   */ 
@@ -289,6 +304,7 @@ void LCD_DisplayChar(uint8_t Line, uint16_t Column, uint8_t Ascii);
 void LCD_SetFont(sFONT *fonts);
 sFONT *LCD_GetFont(void);
 void LCD_DisplayStringLine(uint8_t Line, uint8_t *ptr);
+void LCD_DisplayString(uint8_t Line, uint16_t Column, uint8_t *ptr);
 void LCD_SetDisplayWindow(uint8_t Xpos, uint16_t Ypos, uint8_t Height, uint16_t Width);
 void LCD_WindowModeDisable(void);
 void LCD_DrawLine(uint8_t Xpos, uint16_t Ypos, uint16_t Length, uint8_t Direction);
@@ -316,6 +332,7 @@ uint16_t LCD_ReadReg(uint8_t LCD_Reg);
 void LCD_WriteRAM_Prepare(void);
 void LCD_WriteRAM(uint16_t RGB_Code);
 uint16_t LCD_ReadRAM(void);
+void LCD_WaitTransfer(void);
 void LCD_PowerOn(void);
 void LCD_DisplayOn(void);
 void LCD_DisplayOff(void);
@@ -67,6 +67,11 @@
   *
   *              5 -  Configure the SD Card in wide bus mode: 4-bits data.
   *
+  *              6 -  Switch the cards of version 1.10 and later to High Speed
+  *                   mode (CMD6) and use the "SDIO_HS_TRANSFER_CLK_DIV" define
+  *                   instead of "SDIO_TRANSFER_CLK_DIV". The cards that don't
+  *                   switch stay at the default speed.
+  *
   *          B - SD Card Read operation
   *          ========================== 
   *           - You can read SD card by using two function: SD_ReadBlock() and
@@ -129,7 +134,23 @@
   *           - You can also get the SD card SD Status register by using the 
   *             SD_SendSDStatus() function.
   *
-  *          E - Programming Model (Selecting DMA for SDIO data Transfer)
+  *          E - Stream transfers
+  *          ======================== 
+  *           - SD_StreamRead() and SD_StreamWrite() queue multi block transfers
+  *             (up to SD_STREAM_QUEUE_SIZE) and return at once. The transfers
+  *             run one after the other by DMA, each one is started from the
+  *             interrupt that ends the previous one, and its callback is
+  *             called from SD_ProcessIRQSrc() or SD_ProcessDMAIRQ() once its
+  *             buffer can be reused. Both interrupts must be enabled, at the
+  *             same preemption priority.
+  *           - After a write the card is programming and takes no command,
+  *             SD_StreamTasks() starts the next transfer once it is done.
+  *             Call it from the main loop or a periodic interrupt.
+  *           - SD_StreamIdle() tells when nothing is queued and the card is
+  *             ready. The other read and write functions must not be used
+  *             before.
+  *
+  *          F - Programming Model (Selecting DMA for SDIO data Transfer)
   *          ============================================================ 
   *             Status = SD_Init(); // Initialization Step as described in section A
   *
@@ -172,7 +193,7 @@
   *                   SD_ProcessDMAIRQ();  
   *                 }     
   *
-  *          F - Programming Model (Selecting Polling for SDIO data Transfer)
+  *          G - Programming Model (Selecting Polling for SDIO data Transfer)
   *          ================================================================
   *            //Only SD Card Single Block operation are managed.   
   *            Status = SD_Init(); // Initialization Step as described in section
@@ -224,6 +245,7 @@
 
 /* Includes ------------------------------------------------------------------*/
 #include "stm3210e_eval_sdio_sd.h"
+#include "stm32_eval_wait.h"
 
 
 /** @addtogroup Utilities
@@ -246,6 +268,17 @@
 /** @defgroup STM3210E_EVAL_SDIO_SD_Private_Types
   * @{
   */ 
+/** 
+  * @brief  Transfer queued by SD_StreamRead() or SD_StreamWrite()
+  */
+typedef struct
+{
+  uint8_t *Buffer;
+  uint64_t Addr;
+  uint32_t NumberOfBlocks;
+  uint8_t Write;
+  SD_StreamCallback Callback;
+} SD_StreamRequest;
 /**
   * @}
   */ 
@@ -322,6 +355,17 @@
 #define SD_CCCC_WRITE_PROT              ((uint32_t)0x00000040)
 #define SD_CCCC_ERASE                   ((uint32_t)0x00000020)
 
+/** 
+  * @brief  SD_SPEC field of the SCR, CMD6 is supported from version 1.10 on
+  */
+#define SD_SCR_SPEC_MASK                ((uint32_t)0x0F000000)
+#define SD_SCR_SPEC_1_10                ((uint32_t)0x01000000)
+
+/** 
+  * @brief  CMD6 argument switching function group 1 to High Speed
+  */
+#define SD_HIGH_SPEED_SWITCH            ((uint32_t)0x80FFFFF1)
+
 /** 
   * @brief  Following commands are SD Card Specific commands.
   *         SDIO_APP_CMD should be sent before sending these commands. 
@@ -351,6 +395,12 @@ __IO SD_Error TransferError = SD_OK;
 __IO uint32_t TransferEnd = 0, DMAEndOfTransfer = 0;
 SD_CardInfo SDCardInfo;
 
+static uint8_t TransferClockDiv = SDIO_TRANSFER_CLK_DIV;
+static SD_StreamRequest StreamQueue[SD_STREAM_QUEUE_SIZE];
+static __IO uint8_t StreamFirst = 0, StreamCount = 0;
+/*!< A stream transfer is on the bus, or the card programs the last write */
+static __IO uint8_t StreamActive = 0, StreamProgramming = 0;
+
 SDIO_InitTypeDef SDIO_InitStructure;
 SDIO_CmdInitTypeDef SDIO_CmdInitStructure;
 SDIO_DataInitTypeDef SDIO_DataInitStructure;
@@ -371,6 +421,11 @@ static SD_Error CmdResp6Error(uint8_t cmd, uint16_t *prca);
 static SD_Error SDEnWideBus(FunctionalState NewState);
 static SD_Error IsCardProgramming(uint8_t *pstatus);
 static SD_Error FindSCR(uint16_t rca, uint32_t *pscr);
+static SD_Error SDEnHighSpeed(void);
+static SD_Error StreamQueueRequest(uint8_t *buff, uint64_t Addr, uint32_t NumberOfBlocks, uint8_t Write, SD_StreamCallback Callback);
+static void StreamStart(void);
+static void StreamService(void);
+static uint8_t StreamEnd(SD_StreamCallback *pcallback, uint8_t **pbuffer);
 uint8_t convert_from_bytes_to_power_of_two(uint16_t NumberOfBytes);
   
 /**
@@ -425,7 +480,8 @@ SD_Error SD_Init(void)
 
   /*!< Configure the SDIO peripheral */
   /*!< SDIO_CK = SDIOCLK / (SDIO_TRANSFER_CLK_DIV + 2) */
-  SDIO_InitStructure.SDIO_ClockDiv = SDIO_TRANSFER_CLK_DIV;
+  TransferClockDiv = SDIO_TRANSFER_CLK_DIV;
+  SDIO_InitStructure.SDIO_ClockDiv = TransferClockDiv;
   SDIO_InitStructure.SDIO_ClockEdge = SDIO_ClockEdge_Rising;
   SDIO_InitStructure.SDIO_ClockBypass = SDIO_ClockBypass_Disable;
   SDIO_InitStructure.SDIO_ClockPowerSave = SDIO_ClockPowerSave_Disable;
@@ -447,6 +503,17 @@ SD_Error SD_Init(void)
     errorstatus = SD_EnableWideBusOperation(SDIO_BusWide_4b);
   }  
 
+  if (errorstatus == SD_OK)
+  {
+    /*!< The card stays at the default speed if it can't switch */
+    if (SDEnHighSpeed() == SD_OK)
+    {
+      TransferClockDiv = SDIO_HS_TRANSFER_CLK_DIV;
+      SDIO_InitStructure.SDIO_ClockDiv = TransferClockDiv;
+      SDIO_Init(&SDIO_InitStructure);
+    }
+  }
+
   return(errorstatus);
 }
 
@@ -1096,7 +1163,7 @@ SD_Error SD_EnableWideBusOperation(uint32_t WideMode)
       if (SD_OK == errorstatus)
       {
         /*!< Configure the SDIO peripheral */
-        SDIO_InitStructure.SDIO_ClockDiv = SDIO_TRANSFER_CLK_DIV; 
+        SDIO_InitStructure.SDIO_ClockDiv = TransferClockDiv; 
         SDIO_InitStructure.SDIO_ClockEdge = SDIO_ClockEdge_Rising;
         SDIO_InitStructure.SDIO_ClockBypass = SDIO_ClockBypass_Disable;
         SDIO_InitStructure.SDIO_ClockPowerSave = SDIO_ClockPowerSave_Disable;
@@ -1112,7 +1179,7 @@ SD_Error SD_EnableWideBusOperation(uint32_t WideMode)
       if (SD_OK == errorstatus)
       {
         /*!< Configure the SDIO peripheral */
-        SDIO_InitStructure.SDIO_ClockDiv = SDIO_TRANSFER_CLK_DIV; 
+        SDIO_InitStructure.SDIO_ClockDiv = TransferClockDiv; 
         SDIO_InitStructure.SDIO_ClockEdge = SDIO_ClockEdge_Rising;
         SDIO_InitStructure.SDIO_ClockBypass = SDIO_ClockBypass_Disable;
         SDIO_InitStructure.SDIO_ClockPowerSave = SDIO_ClockPowerSave_Disable;
@@ -1369,10 +1436,8 @@ SD_Error SD_WaitReadOperation(void)
 
   timeout = SD_DATATIMEOUT;
   
-  while ((DMAEndOfTransfer == 0x00) && (TransferEnd == 0) && (TransferError == SD_OK) && (timeout > 0))
-  {
-    timeout--;
-  }
+  /*!< Sleeps until the DMA or the SDIO interrupt ends the transfer */
+  EVAL_WAIT_WHILE((DMAEndOfTransfer == 0x00) && (TransferEnd == 0) && (TransferError == SD_OK), timeout);
   
   DMAEndOfTransfer = 0x00;
 
@@ -1660,10 +1725,8 @@ SD_Error SD_WaitWriteOperation(void)
 
   timeout = SD_DATATIMEOUT;
   
-  while ((DMAEndOfTransfer == 0x00) && (TransferEnd == 0) && (TransferError == SD_OK) && (timeout > 0))
-  {
-    timeout--;
-  }
+  /*!< Sleeps until the DMA or the SDIO interrupt ends the transfer */
+  EVAL_WAIT_WHILE((DMAEndOfTransfer == 0x00) && (TransferEnd == 0) && (TransferError == SD_OK), timeout);
   
   DMAEndOfTransfer = 0x00;
 
@@ -2030,6 +2093,11 @@ SD_Error SD_ProcessIRQSrc(void)
   SDIO_ITConfig(SDIO_IT_DCRCFAIL | SDIO_IT_DTIMEOUT | SDIO_IT_DATAEND |
                 SDIO_IT_TXFIFOHE | SDIO_IT_RXFIFOHF | SDIO_IT_TXUNDERR |
                 SDIO_IT_RXOVERR | SDIO_IT_STBITERR, DISABLE);
+
+  if (StreamActive)
+  {
+    StreamService();
+  }
   return(TransferError);
 }
 
@@ -2044,9 +2112,90 @@ void SD_ProcessDMAIRQ(void)
   {
     DMAEndOfTransfer = 0x01;
     DMA_ClearFlag(DMA2_FLAG_TC4 | DMA2_FLAG_TE4 | DMA2_FLAG_HT4 | DMA2_FLAG_GL4);
+
+    if (StreamActive)
+    {
+      StreamService();
+    }
   }
 }
 
+/**
+  * @brief  Queues a multi block read, it starts after the transfers queued
+  *         before and Callback is called at its end.
+  * @param  readbuff: pointer to the buffer that will contain the received data.
+  * @param  ReadAddr: Address from where data are to be read.
+  * @param  NumberOfBlocks: number of 512-byte blocks to be read.
+  * @param  Callback: called at the end of the read, or NULL.
+  * @retval SD_Error: SD_REQUEST_PENDING if the queue is full, else SD_OK.
+  */
+SD_Error SD_StreamRead(uint8_t *readbuff, uint64_t ReadAddr, uint32_t NumberOfBlocks, SD_StreamCallback Callback)
+{
+  return(StreamQueueRequest(readbuff, ReadAddr, NumberOfBlocks, 0, Callback));
+}
+
+/**
+  * @brief  Queues a multi block write, it starts after the transfers queued
+  *         before and Callback is called once the data are sent.
+  * @param  writebuff: pointer to the buffer that contain the data to be transferred.
+  * @param  WriteAddr: Address where data are to be written.
+  * @param  NumberOfBlocks: number of 512-byte blocks to be written.
+  * @param  Callback: called at the end of the write, or NULL.
+  * @retval SD_Error: SD_REQUEST_PENDING if the queue is full, else SD_OK.
+  */
+SD_Error SD_StreamWrite(uint8_t *writebuff, uint64_t WriteAddr, uint32_t NumberOfBlocks, SD_StreamCallback Callback)
+{
+  return(StreamQueueRequest(writebuff, WriteAddr, NumberOfBlocks, 1, Callback));
+}
+
+/**
+  * @brief  Starts the next stream transfer once the card has programmed the
+  *         last write. Returns at once while the card is busy.
+  * @param  None
+  * @retval None
+  */
+void SD_StreamTasks(void)
+{
+  uint32_t primask;
+  uint8_t start = 0;
+
+  /*!< Nothing else uses the bus while the card programs, a card in error
+       fails the next transfer */
+  if (!StreamProgramming || (SD_GetStatus() == SD_TRANSFER_BUSY))
+  {
+    return;
+  }
+
+  primask = __get_PRIMASK();
+  __disable_irq();
+  StreamProgramming = 0;
+  if (StreamCount != 0)
+  {
+    StreamActive = 1;
+    start = 1;
+  }
+  __set_PRIMASK(primask);
+
+  if (start)
+  {
+    StreamStart();
+  }
+}
+
+/**
+  * @brief  Tells if the stream transfers are all done.
+  * @param  None
+  * @retval 1 if no transfer is queued and the card is not programming, else 0.
+  */
+uint8_t SD_StreamIdle(void)
+{
+  if (StreamProgramming)
+  {
+    SD_StreamTasks();
+  }
+  return((StreamCount == 0) && !StreamActive && !StreamProgramming);
+}
+
 /**
   * @brief  Checks for error conditions for CMD0.
   * @param  None
@@ -2776,6 +2925,279 @@ static SD_Error FindSCR(uint16_t rca, uint32_t *pscr)
   return(errorstatus);
 }
 
+/**
+  * @brief  Switches the card to High Speed mode.
+  * @param  None
+  * @retval SD_Error: SD_OK if the card has switched, SD_UNSUPPORTED_FEATURE if
+  *         it can't.
+  */
+static SD_Error SDEnHighSpeed(void)
+{
+  SD_Error errorstatus = SD_OK;
+  uint32_t scr[2] = {0, 0};
+  uint32_t status[16];
+  uint32_t index = 0;
+
+  errorstatus = FindSCR(RCA, scr);
+
+  if (errorstatus != SD_OK)
+  {
+    return(errorstatus);
+  }
+
+  /*!< CMD6 is an illegal command for the cards of version 1.0 */
+  if ((scr[1] & SD_SCR_SPEC_MASK) < SD_SCR_SPEC_1_10)
+  {
+    return(SD_UNSUPPORTED_FEATURE);
+  }
+
+  /*!< The switch status is a 64-byte data block */
+  SDIO_DataInitStructure.SDIO_DataTimeOut = SD_DATATIMEOUT;
+  SDIO_DataInitStructure.SDIO_DataLength = 64;
+  SDIO_DataInitStructure.SDIO_DataBlockSize = SDIO_DataBlockSize_64b;
+  SDIO_DataInitStructure.SDIO_TransferDir = SDIO_TransferDir_ToSDIO;
+  SDIO_DataInitStructure.SDIO_TransferMode = SDIO_TransferMode_Block;
+  SDIO_DataInitStructure.SDIO_DPSM = SDIO_DPSM_Enable;
+  SDIO_DataConfig(&SDIO_DataInitStructure);
+
+  /*!< Send CMD6 SWITCH_FUNC setting the function of group 1 to High Speed */
+  SDIO_CmdInitStructure.SDIO_Argument = SD_HIGH_SPEED_SWITCH;
+  SDIO_CmdInitStructure.SDIO_CmdIndex = SD_CMD_HS_SWITCH;
+  SDIO_CmdInitStructure.SDIO_Response = SDIO_Response_Short;
+  SDIO_CmdInitStructure.SDIO_Wait = SDIO_Wait_No;
+  SDIO_CmdInitStructure.SDIO_CPSM = SDIO_CPSM_Enable;
+  SDIO_SendCommand(&SDIO_CmdInitStructure);
+
+  errorstatus = CmdResp1Error(SD_CMD_HS_SWITCH);
+
+  if (errorstatus != SD_OK)
+  {
+    return(errorstatus);
+  }
+
+  while (!(SDIO->STA & (SDIO_FLAG_RXOVERR | SDIO_FLAG_DCRCFAIL | SDIO_FLAG_DTIMEOUT | SDIO_FLAG_DBCKEND | SDIO_FLAG_STBITERR)))
+  {
+    if ((SDIO_GetFlagStatus(SDIO_FLAG_RXDAVL) != RESET) && (index < 16))
+    {
+      status[index] = SDIO_ReadData();
+      index++;
+    }
+  }
+
+  if (SDIO_GetFlagStatus(SDIO_FLAG_DTIMEOUT) != RESET)
+  {
+    SDIO_ClearFlag(SDIO_FLAG_DTIMEOUT);
+    return(SD_DATA_TIMEOUT);
+  }
+  else if (SDIO_GetFlagStatus(SDIO_FLAG_DCRCFAIL) != RESET)
+  {
+    SDIO_ClearFlag(SDIO_FLAG_DCRCFAIL);
+    return(SD_DATA_CRC_FAIL);
+  }
+  else if (SDIO_GetFlagStatus(SDIO_FLAG_RXOVERR) != RESET)
+  {
+    SDIO_ClearFlag(SDIO_FLAG_RXOVERR);
+    return(SD_RX_OVERRUN);
+  }
+  else if (SDIO_GetFlagStatus(SDIO_FLAG_STBITERR) != RESET)
+  {
+    SDIO_ClearFlag(SDIO_FLAG_STBITERR);
+    return(SD_START_BIT_ERR);
+  }
+
+  /*!< Read the words left in the FIFO */
+  while ((SDIO_GetFlagStatus(SDIO_FLAG_RXDAVL) != RESET) && (index < 16))
+  {
+    status[index] = SDIO_ReadData();
+    index++;
+  }
+
+  /*!< Clear all the static flags */
+  SDIO_ClearFlag(SDIO_STATIC_FLAGS);
+
+  /*!< Bits 379:376, the function selected in group 1, are in byte 16 */
+  if ((index < 5) || ((status[4] & 0x0F) != 0x01))
+  {
+    return(SD_UNSUPPORTED_FEATURE);
+  }
+
+  return(errorstatus);
+}
+
+/**
+  * @brief  Queues a stream transfer and starts it if the bus is free.
+  * @param  buff: pointer to the data buffer.
+  * @param  Addr: card address of the data.
+  * @param  NumberOfBlocks: number of 512-byte blocks.
+  * @param  Write: 1 for a write, 0 for a read.
+  * @param  Callback: called at the end of the transfer, or NULL.
+  * @retval SD_Error: SD_REQUEST_PENDING if the queue is full, else SD_OK.
+  */
+static SD_Error StreamQueueRequest(uint8_t *buff, uint64_t Addr, uint32_t NumberOfBlocks, uint8_t Write, SD_StreamCallback Callback)
+{
+  SD_StreamRequest *request;
+  uint32_t primask;
+  uint8_t start = 0;
+
+  primask = __get_PRIMASK();
+  __disable_irq();
+
+  if (StreamCount == SD_STREAM_QUEUE_SIZE)
+  {
+    __set_PRIMASK(primask);
+    return(SD_REQUEST_PENDING);
+  }
+
+  request = &StreamQueue[(StreamFirst + StreamCount) % SD_STREAM_QUEUE_SIZE];
+  request->Buffer = buff;
+  request->Addr = Addr;
+  request->NumberOfBlocks = NumberOfBlocks;
+  request->Write = Write;
+  request->Callback = Callback;
+  StreamCount++;
+
+  if (!StreamActive && !StreamProgramming)
+  {
+    StreamActive = 1;
+    start = 1;
+  }
+  __set_PRIMASK(primask);
+
+  if (start)
+  {
+    StreamStart();
+  }
+
+  return(SD_OK);
+}
+
+/**
+  * @brief  Starts the first queued stream transfer. StreamActive is set by
+  *         the caller, the transfers whose commands fail are ended at once.
+  * @param  None
+  * @retval None
+  */
+static void StreamStart(void)
+{
+  SD_StreamRequest *request;
+  SD_StreamCallback callback;
+  uint8_t *buffer;
+  SD_Error errorstatus;
+  uint8_t next;
+
+  do
+  {
+    request = &StreamQueue[StreamFirst];
+    DMAEndOfTransfer = 0x00;
+
+    if (request->Write)
+    {
+      errorstatus = SD_WriteMultiBlocks(request->Buffer, request->Addr, 512, request->NumberOfBlocks);
+    }
+    else
+    {
+      errorstatus = SD_ReadMultiBlocks(request->Buffer, request->Addr, 512, request->NumberOfBlocks);
+    }
+
+    if (errorstatus == SD_OK)
+    {
+      return;
+    }
+
+    next = StreamEnd(&callback, &buffer);
+    if (callback != NULL)
+    {
+      callback(errorstatus, buffer);
+    }
+  } while (next);
+}
+
+/**
+  * @brief  Ends the stream transfer in progress once the SDIO and the DMA are
+  *         both done with it, or at the first error.
+  * @param  None
+  * @retval None
+  */
+static void StreamService(void)
+{
+  SD_StreamCallback callback;
+  uint8_t *buffer;
+  SD_Error errorstatus = TransferError;
+
+  if ((TransferEnd == 0) && (errorstatus == SD_OK))
+  {
+    return;
+  }
+
+  /*!< The last words of a read are still in the FIFO */
+  if ((errorstatus == SD_OK) && !StreamQueue[StreamFirst].Write && (DMAEndOfTransfer == 0x00))
+  {
+    return;
+  }
+
+  TransferEnd = 0;
+  TransferError = SD_OK;
+  DMAEndOfTransfer = 0x00;
+
+  if (StopCondition == 1)
+  {
+    if (SD_StopTransfer() != SD_OK && errorstatus == SD_OK)
+    {
+      errorstatus = SD_ERROR;
+    }
+  }
+  SDIO_ClearFlag(SDIO_STATIC_FLAGS);
+
+  /*!< The next transfer runs while the callback of this one does */
+  if (StreamEnd(&callback, &buffer))
+  {
+    StreamStart();
+  }
+  if (callback != NULL)
+  {
+    callback(errorstatus, buffer);
+  }
+}
+
+/**
+  * @brief  Removes the first stream transfer from the queue.
+  * @param  pcallback: where the callback of the transfer is returned.
+  * @param  pbuffer: where the buffer of the transfer is returned.
+  * @retval 1 if the caller starts the next transfer, else 0.
+  */
+static uint8_t StreamEnd(SD_StreamCallback *pcallback, uint8_t **pbuffer)
+{
+  SD_StreamRequest *request = &StreamQueue[StreamFirst];
+  uint32_t primask;
+  uint8_t next = 0;
+
+  *pcallback = request->Callback;
+  *pbuffer = request->Buffer;
+
+  primask = __get_PRIMASK();
+  __disable_irq();
+  StreamFirst = (StreamFirst + 1) % SD_STREAM_QUEUE_SIZE;
+  StreamCount--;
+
+  if (request->Write)
+  {
+    /*!< SD_StreamTasks() goes on once the card is programmed */
+    StreamActive = 0;
+    StreamProgramming = 1;
+  }
+  else if (StreamCount != 0)
+  {
+    next = 1;
+  }
+  else
+  {
+    StreamActive = 0;
+  }
+  __set_PRIMASK(primask);
+
+  return(next);
+}
+
 /**
   * @brief  Converts the number of bytes in power of two and returns the power.
   * @param  NumberOfBytes: number of bytes.
@@ -109,6 +109,12 @@ typedef enum
   SD_OK = 0 
 } SD_Error;
 
+/** 
+  * @brief  SDIO stream transfer done callback, called from the SDIO or the DMA
+  *         interrupt with the status of the transfer and its buffer
+  */
+typedef void (*SD_StreamCallback)(SD_Error Status, uint8_t *Buffer);
+
 /** 
   * @brief  SDIO Transfer state  
   */   
@@ -339,6 +345,13 @@ typedef struct
 #define SDIO_SECURE_DIGITAL_IO_COMBO_CARD          ((uint32_t)0x00000006)
 #define SDIO_HIGH_CAPACITY_MMC_CARD                ((uint32_t)0x00000007)
 
+/** 
+  * @brief Stream transfers queued by SD_StreamRead() and SD_StreamWrite()
+  */
+#ifndef SD_STREAM_QUEUE_SIZE
+#define SD_STREAM_QUEUE_SIZE                       ((uint8_t)4)
+#endif
+
 /**
   * @}
   */ 
@@ -378,6 +391,10 @@ SD_Error SD_ProcessIRQSrc(void);
 void SD_ProcessDMAIRQ(void);
 SD_Error SD_WaitReadOperation(void);
 SD_Error SD_WaitWriteOperation(void);
+SD_Error SD_StreamRead(uint8_t *readbuff, uint64_t ReadAddr, uint32_t NumberOfBlocks, SD_StreamCallback Callback);
+SD_Error SD_StreamWrite(uint8_t *writebuff, uint64_t WriteAddr, uint32_t NumberOfBlocks, SD_StreamCallback Callback);
+void SD_StreamTasks(void);
+uint8_t SD_StreamIdle(void);
 #ifdef __cplusplus
 }
 #endif
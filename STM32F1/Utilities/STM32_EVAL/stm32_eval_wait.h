@@ -0,0 +1,104 @@
+/**
+  ******************************************************************************
+  * @file    stm32_eval_wait.h
+  * @author  MCD Application Team
+  * @version V4.5.0
+  * @date    14-October-2026
+  * @brief   Waits of the evaluation board drivers for a flag set by an
+  *          interrupt, with the core sleeping in WFI meanwhile.
+  *
+  *          EVAL_WAIT_WHILE(Condition, Timeout) waits while Condition is
+  *          true and Timeout, a variable, is not 0. The condition is checked
+  *          with PRIMASK set, and the interrupt that ends the wait still ends
+  *          the WFI when it comes right after the check. Its handler runs
+  *          before the next check.
+  *
+  *          The core sleeps only in thread mode, with the interrupts enabled
+  *          and the SysTick interrupt running. The SysTick then wakes the
+  *          core at least once per period, and a transfer that never ends
+  *          cannot hold the wait past its timeout. Otherwise the wait spins
+  *          as before. Timeout counts loops when spinning and wake-ups when
+  *          sleeping, so a timeout sized for the loops lasts much longer
+  *          while sleeping. The timeouts of the drivers only catch a
+  *          transfer that never ends.
+  ******************************************************************************
+  * @attention
+  *
+  * THE PRESENT FIRMWARE WHICH IS FOR GUIDANCE ONLY AIMS AT PROVIDING CUSTOMERS
+  * WITH CODING INFORMATION REGARDING THEIR PRODUCTS IN ORDER FOR THEM TO SAVE
+  * TIME. AS A RESULT, STMICROELECTRONICS SHALL NOT BE HELD LIABLE FOR ANY
+  * DIRECT, INDIRECT OR CONSEQUENTIAL DAMAGES WITH RESPECT TO ANY CLAIMS ARISING
+  * FROM THE CONTENT OF SUCH FIRMWARE AND/OR THE USE MADE BY CUSTOMERS OF THE
+  * CODING INFORMATION CONTAINED HEREIN IN CONNECTION WITH THEIR PRODUCTS.
+  *
+  * <h2><center>&copy; COPYRIGHT 2011 STMicroelectronics</center></h2>
+  ******************************************************************************
+  */
+
+/* Define to prevent recursive inclusion -------------------------------------*/
+#ifndef __STM32_EVAL_WAIT_H
+#define __STM32_EVAL_WAIT_H
+
+#ifdef __cplusplus
+ extern "C" {
+#endif
+
+/* Includes ------------------------------------------------------------------*/
+#include "stm32_eval.h"
+
+/* Exported constants --------------------------------------------------------*/
+#define EVAL_WAIT_SYSTICK_RUNNING   (SysTick_CTRL_ENABLE_Msk | SysTick_CTRL_TICKINT_Msk)
+
+/* Exported macro ------------------------------------------------------------*/
+/**
+  * @brief  Waits while Condition is true and Timeout is not 0, Timeout is
+  *         decremented on every loop or wake-up.
+  * @param  Condition: expression of the flags set by the interrupt.
+  * @param  Timeout: variable of the timeout, 0 at the return if it expired.
+  */
+#define EVAL_WAIT_WHILE(Condition, Timeout)                                  \
+  do                                                                         \
+  {                                                                          \
+    if (EVAL_WaitCanSleep())                                                 \
+    {                                                                        \
+      __disable_irq();                                                       \
+      while ((Condition) && ((Timeout) != 0))                                \
+      {                                                                      \
+        /* A pending interrupt ends the WFI, its handler runs when the */    \
+        /* interrupts are enabled again */                                   \
+        __WFI();                                                             \
+        __enable_irq();                                                      \
+        (Timeout)--;                                                         \
+        __disable_irq();                                                     \
+      }                                                                      \
+      __enable_irq();                                                        \
+    }                                                                        \
+    else                                                                     \
+    {                                                                        \
+      while ((Condition) && ((Timeout) != 0))                                \
+      {                                                                      \
+        (Timeout)--;                                                         \
+      }                                                                      \
+    }                                                                        \
+  } while (0)
+
+/* Exported functions ------------------------------------------------------- */
+/**
+  * @brief  Tells if a wait can sleep: thread mode, interrupts enabled and the
+  *         SysTick interrupt running.
+  * @param  None
+  * @retval 1 if the wait can execute WFI, else 0.
+  */
+static __INLINE uint32_t EVAL_WaitCanSleep(void)
+{
+  return (__get_IPSR() == 0) && (__get_PRIMASK() == 0) &&
+         ((SysTick->CTRL & EVAL_WAIT_SYSTICK_RUNNING) == EVAL_WAIT_SYSTICK_RUNNING);
+}
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __STM32_EVAL_WAIT_H */
+
+/******************* (C) COPYRIGHT 2011 STMicroelectronics *****END OF FILE****/
@@ -0,0 +1,424 @@
+/**
+  ******************************************************************************
+  * @file    STM32_EVAL_CPAL/Common/stm32_eval_i2c_queue_cpal.c
+  * @author  MCD Application Team
+  * @version V1.2.0
+  * @date    21-December-2012
+  * @brief   This file provides a set of functions needed to share one I2C bus
+  *          between several slave devices (EEPROM, temperature sensor, IO
+  *          expander ...) through a queue of transactions.
+  *
+  *          Each transaction is transferred by the CPAL library (DMA or
+  *          interrupt programming model). The end of a transfer is handled in
+  *          the CPAL transfer complete callbacks, which start the next queued
+  *          transaction at once: consecutive transfers are chained without
+  *          going through the main loop. Transactions are served by device
+  *          priority, and each device has its own transfer timeout managed by
+  *          I2CQ_TIMEOUT_Manager().
+  *
+  *          @note Refer to the User NOTES of stm32_eval_i2c_queue_cpal.h file
+  *                for the required callbacks and configuration.
+  ******************************************************************************
+  * @attention
+  *
+  * <h2><center>&copy; COPYRIGHT 2012 STMicroelectronics</center></h2>
+  *
+  * Licensed under MCD-ST Liberty SW License Agreement V2, (the "License");
+  * You may not use this file except in compliance with the License.
+  * You may obtain a copy of the License at:
+  *
+  *        http://www.st.com/software_license_agreement_liberty_v2
+  *
+  * Unless required by applicable law or agreed to in writing, software
+  * distributed under the License is distributed on an "AS IS" BASIS,
+  * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  * See the License for the specific language governing permissions and
+  * limitations under the License.
+  *
+  ******************************************************************************
+  */
+
+/* Includes ------------------------------------------------------------------*/
+#include "stm32_eval_i2c_queue_cpal.h"
+
+/* Private typedef -----------------------------------------------------------*/
+/* Private defines -----------------------------------------------------------*/
+/* Private macro -------------------------------------------------------------*/
+/* Private variables ---------------------------------------------------------*/
+
+/*========= Local Structures declaration =========*/
+
+#ifdef CPAL_USE_I2C1
+ I2CQ_InitTypeDef I2CQ1_DevStructure = {&I2C1_DevStructure, pNULL, pNULL, {pNULL, 0, 0, 0}, 0};
+#endif /* CPAL_USE_I2C1 */
+
+#ifdef CPAL_USE_I2C2
+ I2CQ_InitTypeDef I2CQ2_DevStructure = {&I2C2_DevStructure, pNULL, pNULL, {pNULL, 0, 0, 0}, 0};
+#endif /* CPAL_USE_I2C2 */
+
+#if defined (STM32F2XX) || defined (STM32F4XX)
+#ifdef CPAL_USE_I2C3
+ I2CQ_InitTypeDef I2CQ3_DevStructure = {&I2C3_DevStructure, pNULL, pNULL, {pNULL, 0, 0, 0}, 0};
+#endif /* CPAL_USE_I2C3 */
+#endif /* STM32F2XX  || STM32F4XX */
+
+I2CQ_InitTypeDef* I2CQ_DevStructures[CPAL_I2C_DEV_NUM] =
+{
+#ifdef CPAL_USE_I2C1
+  &I2CQ1_DevStructure,
+#else
+  pNULL,
+#endif /* CPAL_USE_I2C1 */
+
+#ifdef CPAL_USE_I2C2
+  &I2CQ2_DevStructure,
+#else
+  pNULL,
+#endif /* CPAL_USE_I2C2 */
+
+#if defined (STM32F2XX) || defined (STM32F4XX)
+#ifdef CPAL_USE_I2C3
+  &I2CQ3_DevStructure,
+#else
+  pNULL,
+#endif /* CPAL_USE_I2C3 */
+#endif /* STM32F2XX  || STM32F4XX */
+};
+
+/* Private function prototypes -----------------------------------------------*/
+
+static I2CQ_TransactionTypeDef* I2CQ_Next(I2CQ_InitTypeDef* I2CQInitStruct);
+static void I2CQ_Run(I2CQ_InitTypeDef* I2CQInitStruct, I2CQ_TransactionTypeDef* pTransaction);
+static void I2CQ_End(I2CQ_InitTypeDef* I2CQInitStruct, I2CQ_StateTypeDef State);
+static void I2CQ_Recover(I2CQ_InitTypeDef* I2CQInitStruct);
+
+/* Private functions ---------------------------------------------------------*/
+
+/**
+  * @brief  DeInitialize peripherals used by the I2C transaction queue.
+  * @param  I2CQInitStruct : Pointer to I2CQ Device structure
+  * @retval None
+  */
+void I2CQ_DeInit(I2CQ_InitTypeDef* I2CQInitStruct)
+{
+  /* Deinitialize CPAL peripheral */
+  CPAL_I2C_DeInit(I2CQInitStruct->I2CQ_CPALStructure);
+}
+
+/**
+  * @brief  Initialize peripherals used by the I2C transaction queue.
+  * @param  I2CQInitStruct : Pointer to I2CQ Device structure
+  * @retval None
+  */
+void I2CQ_Init(I2CQ_InitTypeDef* I2CQInitStruct)
+{
+  /* Empty the queue */
+  I2CQInitStruct->pI2CQQueue = pNULL;
+  I2CQInitStruct->pI2CQCurrent = pNULL;
+  I2CQInitStruct->I2CQTicks = 0;
+
+  /* Initialize CPAL peripheral */
+  CPAL_I2C_Init(I2CQInitStruct->I2CQ_CPALStructure);
+}
+
+/**
+  * @brief  Initialize I2CQ CPAL Structure used by the I2C transaction queue.
+  * @param  I2CQInitStruct : Pointer to I2CQ Device structure
+  * @retval None
+  */
+void I2CQ_StructInit(I2CQ_InitTypeDef* I2CQInitStruct)
+{
+  /* Set CPAL structure parameters to their default values */
+  CPAL_I2C_StructInit(I2CQInitStruct->I2CQ_CPALStructure);
+
+  /* Set I2C clock speed */
+  I2CQInitStruct->I2CQ_CPALStructure->pCPAL_I2C_Struct->I2C_ClockSpeed = I2CQ_SPEED;
+
+  /* Select DMA programming model and disable all options */
+  I2CQInitStruct->I2CQ_CPALStructure->CPAL_ProgModel = CPAL_PROGMODEL_DMA;
+  I2CQInitStruct->I2CQ_CPALStructure->wCPAL_Options = 0;
+
+  /* point to CPAL_TransferTypeDef structure */
+  I2CQInitStruct->I2CQ_CPALStructure->pCPAL_TransferTx = &I2CQInitStruct->I2CQTransfer;
+  I2CQInitStruct->I2CQ_CPALStructure->pCPAL_TransferRx = &I2CQInitStruct->I2CQTransfer;
+}
+
+/**
+  * @brief  Queue a transaction, and start it if the bus is idle.
+  * @param  I2CQInitStruct : Pointer to I2CQ Device structure
+  * @param  pTransaction : Pointer to the transaction structure
+  * @retval CPAL_PASS if the transaction is queued, CPAL_FAIL if it is already
+  *         queued or ongoing.
+  */
+uint32_t I2CQ_Submit(I2CQ_InitTypeDef* I2CQInitStruct, I2CQ_TransactionTypeDef* pTransaction)
+{
+  I2CQ_TransactionTypeDef** pLink;
+  I2CQ_TransactionTypeDef* pNextTransaction = pNULL;
+  uint32_t primask = __get_PRIMASK();
+
+  __disable_irq();
+
+  if ((pTransaction->I2CQState == I2CQ_STATE_QUEUED) || (pTransaction->I2CQState == I2CQ_STATE_BUSY))
+  {
+    __set_PRIMASK(primask);
+    return CPAL_FAIL;
+  }
+
+  /* Insert after the transactions of higher or equal priority */
+  pLink = &I2CQInitStruct->pI2CQQueue;
+  while ((*pLink != pNULL) && \
+         ((*pLink)->pI2CQDevice->I2CQPriority <= pTransaction->pI2CQDevice->I2CQPriority))
+  {
+    pLink = &(*pLink)->pNext;
+  }
+  pTransaction->pNext = *pLink;
+  pTransaction->I2CQState = I2CQ_STATE_QUEUED;
+  *pLink = pTransaction;
+
+  /* Take the bus if it is idle */
+  if (I2CQInitStruct->pI2CQCurrent == pNULL)
+  {
+    pNextTransaction = I2CQ_Next(I2CQInitStruct);
+  }
+
+  __set_PRIMASK(primask);
+
+  /* The transfer is started with interrupts enabled (CPAL timeouts) */
+  I2CQ_Run(I2CQInitStruct, pNextTransaction);
+
+  return CPAL_PASS;
+}
+
+/**
+  * @brief  Check that no transaction is queued or ongoing.
+  * @param  I2CQInitStruct : Pointer to I2CQ Device structure
+  * @retval 1 if the queue is idle, else 0.
+  */
+uint32_t I2CQ_IsIdle(I2CQ_InitTypeDef* I2CQInitStruct)
+{
+  return ((I2CQInitStruct->pI2CQCurrent == pNULL) && (I2CQInitStruct->pI2CQQueue == pNULL));
+}
+
+/**
+  * @brief  Handle the end of a transmission: must be called in
+  *         CPAL_I2C_TXTC_UserCallback().
+  * @param  pDevInitStruct : Pointer to the CPAL Device structure
+  * @retval None
+  */
+void I2CQ_TXTC_Handler(CPAL_InitTypeDef* pDevInitStruct)
+{
+  I2CQ_InitTypeDef* I2CQInitStruct = I2CQ_DevStructures[pDevInitStruct->CPAL_Dev];
+
+  if ((I2CQInitStruct->pI2CQCurrent != pNULL) && \
+      (I2CQInitStruct->pI2CQCurrent->I2CQDirection == I2CQ_DIRECTION_TX))
+  {
+    I2CQ_End(I2CQInitStruct, I2CQ_STATE_DONE);
+  }
+}
+
+/**
+  * @brief  Handle the end of a reception: must be called in
+  *         CPAL_I2C_RXTC_UserCallback().
+  * @param  pDevInitStruct : Pointer to the CPAL Device structure
+  * @retval None
+  */
+void I2CQ_RXTC_Handler(CPAL_InitTypeDef* pDevInitStruct)
+{
+  I2CQ_InitTypeDef* I2CQInitStruct = I2CQ_DevStructures[pDevInitStruct->CPAL_Dev];
+
+  if ((I2CQInitStruct->pI2CQCurrent != pNULL) && \
+      (I2CQInitStruct->pI2CQCurrent->I2CQDirection == I2CQ_DIRECTION_RX))
+  {
+    I2CQ_End(I2CQInitStruct, I2CQ_STATE_DONE);
+  }
+}
+
+/**
+  * @brief  Handle a device error or a CPAL timeout: must be called in
+  *         CPAL_I2C_ERR_UserCallback() and CPAL_TIMEOUT_UserCallback().
+  *         The bus is reinitialized and the next transaction is started.
+  * @param  Device : CPAL device instance
+  * @retval None
+  */
+void I2CQ_ERR_Handler(CPAL_DevTypeDef Device)
+{
+  I2CQ_InitTypeDef* I2CQInitStruct = I2CQ_DevStructures[Device];
+
+  I2CQ_Recover(I2CQInitStruct);
+
+  if (I2CQInitStruct->pI2CQCurrent != pNULL)
+  {
+    I2CQ_End(I2CQInitStruct, I2CQ_STATE_ERROR);
+  }
+}
+
+/**
+  * @brief  Manage the timeouts of the devices: must be called from a periodic
+  *         interrupt (ie. SysTick every 1 ms).
+  * @note   The interrupt priority must be lower than (or equal to) the I2C and
+  *         DMA interrupt priorities.
+  * @param  None
+  * @retval None
+  */
+void I2CQ_TIMEOUT_Manager(void)
+{
+  I2CQ_InitTypeDef* I2CQInitStruct;
+  uint32_t index = 0;
+
+  for (index = 0; index < CPAL_I2C_DEV_NUM; index++)
+  {
+    I2CQInitStruct = I2CQ_DevStructures[index];
+
+    if ((I2CQInitStruct != pNULL) && (I2CQInitStruct->pI2CQCurrent != pNULL) && \
+        (I2CQInitStruct->I2CQTicks != 0))
+    {
+      if (--I2CQInitStruct->I2CQTicks == 0)
+      {
+        /* Abort the transfer and go on with the next transaction */
+        I2CQ_Recover(I2CQInitStruct);
+        I2CQ_End(I2CQInitStruct, I2CQ_STATE_TIMEOUT);
+      }
+    }
+  }
+}
+
+/**
+  * @brief  Remove the first transaction from the queue and make it the
+  *         ongoing one. Must be called with interrupts disabled.
+  * @param  I2CQInitStruct : Pointer to I2CQ Device structure
+  * @retval The transaction to be started by I2CQ_Run(), or pNULL.
+  */
+static I2CQ_TransactionTypeDef* I2CQ_Next(I2CQ_InitTypeDef* I2CQInitStruct)
+{
+  I2CQ_TransactionTypeDef* pTransaction = I2CQInitStruct->pI2CQQueue;
+
+  if (pTransaction != pNULL)
+  {
+    I2CQInitStruct->pI2CQQueue = pTransaction->pNext;
+    pTransaction->pNext = pNULL;
+    pTransaction->I2CQState = I2CQ_STATE_BUSY;
+    I2CQInitStruct->I2CQTicks = pTransaction->pI2CQDevice->I2CQTimeout;
+  }
+  I2CQInitStruct->pI2CQCurrent = pTransaction;
+
+  return pTransaction;
+}
+
+/**
+  * @brief  Start the transfer of the ongoing transaction. When the transfer
+  *         can't be started, the transaction ends in error and the next one
+  *         is started.
+  * @param  I2CQInitStruct : Pointer to I2CQ Device structure
+  * @param  pTransaction : Ongoing transaction returned by I2CQ_Next(), or pNULL
+  * @retval None
+  */
+static void I2CQ_Run(I2CQ_InitTypeDef* I2CQInitStruct, I2CQ_TransactionTypeDef* pTransaction)
+{
+  CPAL_InitTypeDef* pDevInitStruct = I2CQInitStruct->I2CQ_CPALStructure;
+  uint32_t status = CPAL_PASS;
+
+  if (pTransaction == pNULL)
+  {
+    return;
+  }
+
+  /* Configure transfer parameters */
+  I2CQInitStruct->I2CQTransfer.pbBuffer = pTransaction->pbBuffer;
+  I2CQInitStruct->I2CQTransfer.wNumData = pTransaction->wNumData;
+  I2CQInitStruct->I2CQTransfer.wAddr1   = (uint32_t)pTransaction->pI2CQDevice->I2CQAddress;
+  I2CQInitStruct->I2CQTransfer.wAddr2   = pTransaction->wRegister;
+  pDevInitStruct->wCPAL_Options = pTransaction->pI2CQDevice->I2CQOptions;
+
+  if (pTransaction->I2CQDirection == I2CQ_DIRECTION_TX)
+  {
+    pDevInitStruct->pCPAL_TransferTx = &I2CQInitStruct->I2CQTransfer;
+    status = CPAL_I2C_Write(pDevInitStruct);
+  }
+  else
+  {
+    pDevInitStruct->pCPAL_TransferRx = &I2CQInitStruct->I2CQTransfer;
+    status = CPAL_I2C_Read(pDevInitStruct);
+  }
+
+  if (status != CPAL_PASS)
+  {
+    /* Release the bus in case the error callback was not called */
+    if ((pDevInitStruct->CPAL_State == CPAL_STATE_ERROR) && (I2CQInitStruct->pI2CQCurrent == pTransaction))
+    {
+      I2CQ_Recover(I2CQInitStruct);
+    }
+    if (I2CQInitStruct->pI2CQCurrent == pTransaction)
+    {
+      I2CQ_End(I2CQInitStruct, I2CQ_STATE_ERROR);
+    }
+  }
+}
+
+/**
+  * @brief  End the ongoing transaction, call its callback and start the next
+  *         queued transaction.
+  * @param  I2CQInitStruct : Pointer to I2CQ Device structure
+  * @param  State : I2CQ_STATE_DONE, I2CQ_STATE_ERROR or I2CQ_STATE_TIMEOUT
+  * @retval None
+  */
+static void I2CQ_End(I2CQ_InitTypeDef* I2CQInitStruct, I2CQ_StateTypeDef State)
+{
+  I2CQ_TransactionTypeDef* pTransaction;
+  uint32_t primask = __get_PRIMASK();
+
+  __disable_irq();
+  pTransaction = I2CQInitStruct->pI2CQCurrent;
+  I2CQInitStruct->pI2CQCurrent = pNULL;
+  I2CQInitStruct->I2CQTicks = 0;
+  __set_PRIMASK(primask);
+
+  if (pTransaction == pNULL)
+  {
+    return;
+  }
+
+  if (State != I2CQ_STATE_DONE)
+  {
+    pTransaction->pI2CQDevice->I2CQErrors++;
+  }
+  pTransaction->I2CQState = State;
+
+  /* The callback may submit the transaction again */
+  if (pTransaction->I2CQCallback != pNULL)
+  {
+    pTransaction->I2CQCallback(pTransaction);
+  }
+
+  __disable_irq();
+  if (I2CQInitStruct->pI2CQCurrent == pNULL)
+  {
+    pTransaction = I2CQ_Next(I2CQInitStruct);
+  }
+  else
+  {
+    /* Already started by a submission from the callback */
+    pTransaction = pNULL;
+  }
+  __set_PRIMASK(primask);
+
+  I2CQ_Run(I2CQInitStruct, pTransaction);
+}
+
+/**
+  * @brief  Stop the ongoing transfer and reinitialize the CPAL device.
+  * @param  I2CQInitStruct : Pointer to I2CQ Device structure
+  * @retval None
+  */
+static void I2CQ_Recover(I2CQ_InitTypeDef* I2CQInitStruct)
+{
+  CPAL_InitTypeDef* pDevInitStruct = I2CQInitStruct->I2CQ_CPALStructure;
+
+  /* Generate STOP */
+  __CPAL_I2C_HAL_STOP(pDevInitStruct->CPAL_Dev);
+
+  /* Deinitialize then initialize peripheral */
+  CPAL_I2C_DeInit(pDevInitStruct);
+  CPAL_I2C_Init(pDevInitStruct);
+}
+
+/************************ (C) COPYRIGHT STMicroelectronics *****END OF FILE****/
@@ -0,0 +1,239 @@
+/**
+  ******************************************************************************
+  * @file    STM32_EVAL_CPAL/Common/stm32_eval_i2c_queue_cpal.h
+  * @author  MCD Application Team
+  * @version V1.2.0
+  * @date    21-December-2012
+  * @brief   This file contains all the functions prototypes for the I2C
+  *          transaction queue driver (several slave devices on one bus).
+  ******************************************************************************
+  * @attention
+  *
+  * <h2><center>&copy; COPYRIGHT 2012 STMicroelectronics</center></h2>
+  *
+  * Licensed under MCD-ST Liberty SW License Agreement V2, (the "License");
+  * You may not use this file except in compliance with the License.
+  * You may obtain a copy of the License at:
+  *
+  *        http://www.st.com/software_license_agreement_liberty_v2
+  *
+  * Unless required by applicable law or agreed to in writing, software
+  * distributed under the License is distributed on an "AS IS" BASIS,
+  * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  * See the License for the specific language governing permissions and
+  * limitations under the License.
+  *
+  ******************************************************************************
+  */
+
+/* Define to prevent recursive inclusion -------------------------------------*/
+#ifndef __STM32_EVAL_I2C_QUEUE_CPAL_H
+#define __STM32_EVAL_I2C_QUEUE_CPAL_H
+
+#ifdef __cplusplus
+ extern "C" {
+#endif
+
+/*==========================================================================================================
+                                             User NOTES
+============================================================================================================
+
+-----------------------------------------
+   How To use the I2C Transaction Queue:
+-----------------------------------------
+----- The queue serializes the transfers of several slave devices sharing one
+      I2C bus. Each transfer is described by a transaction structure owned by
+      the application (or by a sensor driver), so no memory is allocated by the
+      queue. When a transfer completes, the next queued transaction is started
+      from the CPAL transfer complete callback: the bus never waits for the
+      main loop.
+
+----- User should follow these steps to use this driver correctly :
+
+      -1-  DEVICE DESCRIPTION
+      Describe every slave device with an I2CQ_DeviceTypeDef structure:
+           *- uint8_t I2CQAddress : Device address.
+           *- uint8_t I2CQPriority : Priority of its transactions, 0 is the highest.
+                                     Transactions of equal priority are served in order.
+           *- uint32_t I2CQOptions : CPAL options of its transfers (ie. CPAL_OPT_NO_MEM_ADDR,
+                                     CPAL_OPT_16BIT_REG).
+           *- uint32_t I2CQTimeout : Maximum duration of one of its transfers in
+                                     I2CQ_TIMEOUT_Manager() calls, 0 to rely on the CPAL
+                                     timeouts only.
+           *- __IO uint32_t I2CQErrors : Number of its transfers that failed or timed out.
+       Example:
+         I2CQ_DeviceTypeDef Sensor = {0x90, 0, 0, 5, 0}; // address 0x90, highest priority, 5 ms
+
+      -2- BUS CONFIGURATION
+      Call I2CQ_StructInit() then I2CQ_Init() with the global structure of the
+      I2C device (I2CQ1_DevStructure for I2C1, I2CQ2_DevStructure for I2C2 ...).
+      Call I2CQ_TIMEOUT_Manager() from a 1 ms periodic interrupt (ie. SysTick).
+
+      -3- CALLBACKS
+      The queue handlers must be called from the CPAL user callbacks implemented in
+      "cpal_usercallback.c" file (and the relative defines commented in cpal_conf.h):
+            void CPAL_I2C_TXTC_UserCallback(CPAL_InitTypeDef* pDevInitStruct)
+            {
+              I2CQ_TXTC_Handler(pDevInitStruct);
+            }
+            void CPAL_I2C_RXTC_UserCallback(CPAL_InitTypeDef* pDevInitStruct)
+            {
+              I2CQ_RXTC_Handler(pDevInitStruct);
+            }
+            void CPAL_I2C_ERR_UserCallback(CPAL_DevTypeDef pDevInstance, uint32_t DeviceError)
+            {
+              I2CQ_ERR_Handler(pDevInstance);
+            }
+            uint32_t CPAL_TIMEOUT_UserCallback(CPAL_InitTypeDef* pDevInitStruct)
+            {
+              I2CQ_ERR_Handler(pDevInitStruct->CPAL_Dev);
+              return CPAL_PASS;
+            }
+
+      -4- TRANSACTIONS
+      Fill in an I2CQ_TransactionTypeDef structure (device, direction, buffer,
+      number of data, register address and callback) and call I2CQ_Submit().
+      The callback is called from interrupt context when the transaction is
+      complete, with I2CQState set to I2CQ_STATE_DONE, I2CQ_STATE_ERROR or
+      I2CQ_STATE_TIMEOUT. The structure and its buffer must not be modified
+      while I2CQState is I2CQ_STATE_QUEUED or I2CQ_STATE_BUSY. A transaction may
+      be submitted again from its own callback (ie. periodic sensor reads).
+
+      While the queue is used, the CPAL device structure must not be used
+      directly by other drivers.
+
+*********END OF User Notes**********************************************************************************/
+
+/* Includes ------------------------------------------------------------------*/
+#include "cpal_i2c.h"
+
+/* Exported types ------------------------------------------------------------*/
+
+/*========= I2CQ_State_Enum =========*/
+/* State of a transaction */
+
+typedef enum
+{
+  I2CQ_STATE_IDLE       = 0x00,         /*!<The transaction has never been submitted */
+  I2CQ_STATE_QUEUED     = 0x01,         /*!<The transaction waits for the bus */
+  I2CQ_STATE_BUSY       = 0x02,         /*!<The transfer of the transaction is ongoing */
+  I2CQ_STATE_DONE       = 0x03,         /*!<The transfer completed successfully */
+  I2CQ_STATE_ERROR      = 0x04,         /*!<The transfer failed (device error or CPAL timeout) */
+  I2CQ_STATE_TIMEOUT    = 0x05,         /*!<The transfer exceeded the timeout of the device */
+}I2CQ_StateTypeDef;
+
+/*========= I2CQ_Device_TypeDef =========*/
+/* Slave device structure definition */
+
+typedef struct
+{
+  uint8_t I2CQAddress;                  /*!< Device address */
+
+  uint8_t I2CQPriority;                 /*!< Priority of the transactions of the device, 0 is the highest */
+
+  uint32_t I2CQOptions;                 /*!< CPAL options of the transfers of the device */
+
+  uint32_t I2CQTimeout;                 /*!< Maximum duration of a transfer in I2CQ_TIMEOUT_Manager()
+                                             calls, 0 for none */
+
+  __IO uint32_t I2CQErrors;             /*!< Number of transfers that failed or timed out */
+
+} I2CQ_DeviceTypeDef;
+
+/*========= I2CQ_Transaction_TypeDef =========*/
+/* Transaction structure definition */
+
+typedef struct I2CQ_Transaction I2CQ_TransactionTypeDef;
+
+typedef void (*I2CQ_CallbackTypeDef)(I2CQ_TransactionTypeDef* pTransaction);
+
+struct I2CQ_Transaction
+{
+  I2CQ_DeviceTypeDef* pI2CQDevice;      /*!< Device addressed by the transaction */
+
+  uint8_t I2CQDirection;                /*!< I2CQ_DIRECTION_TX or I2CQ_DIRECTION_RX */
+
+  uint8_t* pbBuffer;                    /*!< Data to be written or buffer of the data read */
+
+  uint32_t wNumData;                    /*!< Number of data to be transferred */
+
+  uint32_t wRegister;                   /*!< Register/Physical address in the device */
+
+  I2CQ_CallbackTypeDef I2CQCallback;    /*!< Called when the transaction is complete, or pNULL */
+
+  __IO I2CQ_StateTypeDef I2CQState;     /*!< State of the transaction: I2CQ_State_Enum */
+
+  I2CQ_TransactionTypeDef* pNext;       /*!< Next queued transaction, managed by the queue */
+};
+
+/*========= I2CQ_Init_TypeDef =========*/
+/* Bus structure definition */
+
+typedef struct
+{
+  CPAL_InitTypeDef* I2CQ_CPALStructure; /*!< Pointer on the CPAL Device structure of the bus */
+
+  I2CQ_TransactionTypeDef* pI2CQQueue;  /*!< Queued transactions, by priority */
+
+  I2CQ_TransactionTypeDef* pI2CQCurrent;/*!< Transaction of the ongoing transfer */
+
+  CPAL_TransferTypeDef I2CQTransfer;    /*!< CPAL transfer of the ongoing transaction */
+
+  __IO uint32_t I2CQTicks;              /*!< Remaining duration of the ongoing transfer */
+
+} I2CQ_InitTypeDef;
+
+/*========= I2CQ_Global_Device_Structures =========*/
+/* I2CQ Global Device Structures are the Global default structures which
+   are used to handle the queue of each I2C device.*/
+
+extern I2CQ_InitTypeDef* I2CQ_DevStructures[];
+
+#ifdef CPAL_USE_I2C1
+extern I2CQ_InitTypeDef I2CQ1_DevStructure;
+#endif /* CPAL_USE_I2C1 */
+
+#ifdef CPAL_USE_I2C2
+extern I2CQ_InitTypeDef I2CQ2_DevStructure;
+#endif /* CPAL_USE_I2C2 */
+
+#if defined (STM32F2XX) || defined (STM32F4XX)
+#ifdef CPAL_USE_I2C3
+extern I2CQ_InitTypeDef I2CQ3_DevStructure;
+#endif /* CPAL_USE_I2C3 */
+#endif /* STM32F2XX || STM32F4XX */
+
+/* Exported constants --------------------------------------------------------*/
+
+/* Select clock Speed */
+/* To use the I2C at 400 KHz (in fast mode), the PCLK1 frequency (I2C peripheral
+   input clock) must be a multiple of 10 MHz */
+
+#define I2CQ_SPEED                       300000
+
+/*========= I2CQ_Direction_Defines =========*/
+
+#define I2CQ_DIRECTION_TX              ((uint8_t)0x01)  /*!<Write wNumData data to the device */
+
+#define I2CQ_DIRECTION_RX              ((uint8_t)0x02)  /*!<Read wNumData data from the device */
+
+/* Exported macro ------------------------------------------------------------*/
+/* Exported functions ------------------------------------------------------- */
+
+void I2CQ_DeInit(I2CQ_InitTypeDef* I2CQInitStruct);
+void I2CQ_Init(I2CQ_InitTypeDef* I2CQInitStruct);
+void I2CQ_StructInit(I2CQ_InitTypeDef* I2CQInitStruct);
+uint32_t I2CQ_Submit(I2CQ_InitTypeDef* I2CQInitStruct, I2CQ_TransactionTypeDef* pTransaction);
+uint32_t I2CQ_IsIdle(I2CQ_InitTypeDef* I2CQInitStruct);
+void I2CQ_TXTC_Handler(CPAL_InitTypeDef* pDevInitStruct);
+void I2CQ_RXTC_Handler(CPAL_InitTypeDef* pDevInitStruct);
+void I2CQ_ERR_Handler(CPAL_DevTypeDef Device);
+void I2CQ_TIMEOUT_Manager(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __STM32_EVAL_I2C_QUEUE_CPAL_H */
+
+/************************ (C) COPYRIGHT STMicroelectronics *****END OF FILE****/
@@ -0,0 +1,181 @@
+/**
+ *  @file       WarmRestart.c
+ *  @author     Luis Maduro
+ *  @version    1.00
+ *  @date       14/10/2026
+ *  @brief      Snapshot of the state found at the start, kept in the backup
+ *              registers through the watchdog and software resets.
+ *
+ *  Copyright (C) 2026  Luis Maduro
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "WarmRestart.h"
+#include "CRCDevice.h"
+
+#if WARM_RESTART_CAPACITY < 2
+#error "WarmRestart: no room in the backup registers, define WARM_RESTART_BKP_FIRST"
+#endif
+
+#define WARM_RESTART_MAGIC          0x3A7C
+
+/**Header, in the first registers: the magic, the loads and the length,
+ and the CRC of the snapshot.*/
+#define HEADER_MAGIC                0
+#define HEADER_LENGTH               1
+#define HEADER_CRC                  2
+#define HEADER_REGISTERS            4
+
+/**Reset flags of the last reset.*/
+static uint32_t cause;
+
+/**
+ * Gives the offset of a backup register, DR11 and the next ones are after
+ * a gap.
+ * @param number Register, from 0 for WARM_RESTART_BKP_FIRST.
+ */
+static uint16_t WarmRestartRegister(unsigned int number)
+{
+    number += WARM_RESTART_BKP_FIRST;
+
+    if (number <= 10)
+        return (uint16_t) (BKP_DR1 + 4 * (number - 1));
+
+    return (uint16_t) (BKP_DR11 + 4 * (number - 11));
+}
+
+static uint16_t WarmRestartRead(unsigned int number)
+{
+    return BKP_ReadBackupRegister(WarmRestartRegister(number));
+}
+
+static void WarmRestartWrite(unsigned int number, uint16_t value)
+{
+    BKP_WriteBackupRegister(WarmRestartRegister(number), value);
+}
+
+/**
+ * Gives access to the backup registers and takes the cause of the reset,
+ * its flags are cleared. Called at the start, before any other function of
+ * the file.
+ */
+void WarmRestartInit(void)
+{
+    RCC_APB1PeriphClockCmd(RCC_APB1Periph_PWR | RCC_APB1Periph_BKP, ENABLE);
+    PWR_BackupAccessCmd(ENABLE);
+
+    cause = RCC->CSR & (RCC_CSR_PINRSTF | RCC_CSR_PORRSTF | RCC_CSR_SFTRSTF |
+            RCC_CSR_IWDGRSTF | RCC_CSR_WWDGRSTF | RCC_CSR_LPWRRSTF);
+    RCC_ClearFlag();
+}
+
+/**
+ * Gives the cause of the last reset.
+ * @return RCC_CSR_ flags of the reset, read by WarmRestartInit().
+ */
+uint32_t WarmRestartGetCause(void)
+{
+    return cause;
+}
+
+/**
+ * Gives back the snapshot after a warm reset, and counts the load.
+ * @param snapshot Where to put it, its content is undefined on a false.
+ * @param length Bytes of the snapshot, the length it was saved with.
+ * @return True if the snapshot was loaded, false for a cold start.
+ */
+bool WarmRestartLoad(void *snapshot, unsigned int length)
+{
+    uint8_t *bytes = (uint8_t *) snapshot;
+    uint16_t header;
+    uint16_t value;
+    uint32_t crc;
+    unsigned int i;
+
+    if (((cause & RCC_CSR_PORRSTF) != 0) || ((cause & WARM_RESTART_CAUSES) == 0))
+        return false;
+
+    if (WarmRestartRead(HEADER_MAGIC) != WARM_RESTART_MAGIC)
+        return false;
+
+    header = WarmRestartRead(HEADER_LENGTH);
+
+    if (((header & 0xFF) != length) || ((header >> 8) >= WARM_RESTART_MAX_LOADS))
+        return false;
+
+    for (i = 0; i < length; i += 2)
+    {
+        value = WarmRestartRead(HEADER_REGISTERS + i / 2);
+        bytes[i] = (uint8_t) value;
+
+        if (i + 1 < length)
+            bytes[i + 1] = (uint8_t) (value >> 8);
+    }
+
+    crc = ((uint32_t) WarmRestartRead(HEADER_CRC + 1) << 16) | WarmRestartRead(HEADER_CRC);
+
+    if (CRCDeviceCompute(CRC_DEVICE_INIT, snapshot, length) != crc)
+        return false;
+
+    //a snapshot that resets the application again is not loaded forever
+    WarmRestartWrite(HEADER_LENGTH, header + 0x100);
+
+    return true;
+}
+
+/**
+ * Saves the snapshot, for the next warm start. The previous one is
+ * invalid during the save, a reset then starts cold.
+ * @param snapshot Snapshot.
+ * @param length Bytes, up to WARM_RESTART_CAPACITY.
+ */
+void WarmRestartSave(const void *snapshot, unsigned int length)
+{
+    const uint8_t *bytes = (const uint8_t *) snapshot;
+    uint32_t crc;
+    uint16_t value;
+    unsigned int i;
+
+    if (length > WARM_RESTART_CAPACITY)
+        return;
+
+    crc = CRCDeviceCompute(CRC_DEVICE_INIT, snapshot, length);
+
+    WarmRestartWrite(HEADER_MAGIC, 0);
+
+    for (i = 0; i < length; i += 2)
+    {
+        value = bytes[i];
+
+        if (i + 1 < length)
+            value |= (uint16_t) bytes[i + 1] << 8;
+
+        WarmRestartWrite(HEADER_REGISTERS + i / 2, value);
+    }
+
+    WarmRestartWrite(HEADER_CRC, (uint16_t) crc);
+    WarmRestartWrite(HEADER_CRC + 1, (uint16_t) (crc >> 16));
+    WarmRestartWrite(HEADER_LENGTH, (uint16_t) length);
+    WarmRestartWrite(HEADER_MAGIC, WARM_RESTART_MAGIC);
+}
+
+/**
+ * Discards the snapshot, the next start is cold. Called before a reset
+ * meant to find the state again, i.e. after a change of the sensors.
+ */
+void WarmRestartInvalidate(void)
+{
+    WarmRestartWrite(HEADER_MAGIC, 0);
+}
@@ -0,0 +1,89 @@
+/**
+ *  @file       WarmRestart.h
+ *  @author     Luis Maduro
+ *  @version    1.00
+ *  @date       14/10/2026
+ *  @brief      Snapshot of the state found at the start, kept in the backup
+ *              registers through the watchdog and software resets.
+ *
+ *  The state that takes long to find at every start, the calibration, the
+ *  ROM codes of the 1-Wire enumeration, the channel of the radio, is put by
+ *  the application in one structure, saved with WarmRestartSave() each time
+ *  it changes. After a reset of the causes of WARM_RESTART_CAUSES,
+ *  WarmRestartLoad() gives it back and the application skips the
+ *  discovery. After a power on, or with a snapshot cut by a reset or of
+ *  another length, it returns false and the application starts cold. The
+ *  snapshot is then saved again.
+ *
+ *  A snapshot that makes the application reset again is not loaded more
+ *  than WARM_RESTART_MAX_LOADS times without a WarmRestartSave() between:
+ *  the start after is cold. The application calls WarmRestartSave() once
+ *  it runs, even without a change, to allow the next warm start.
+ *
+ *  The clocks and the peripherals are always configured again, they are
+ *  reset with the core. Only the results of the discovery are kept. The
+ *  snapshot is checked by a CRC of CRCDevice.c, CRCDeviceInit() is called
+ *  before WarmRestartLoad().
+ *
+ *  The snapshot takes the registers WARM_RESTART_BKP_FIRST to
+ *  WARM_RESTART_BKP_LAST, 4 of them for its header. The default ones follow
+ *  those of TimeBase.c, 68 bytes of snapshot on the high density parts. The
+ *  other parts have 10 registers: WARM_RESTART_BKP_FIRST is then defined
+ *  lower, without TimeBase.c.
+ *
+ *  Copyright (C) 2026  Luis Maduro
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef WARMRESTART_H
+#define WARMRESTART_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stm32f10x.h>
+
+/**Numbers of the first and the last backup registers used, 1 for BKP_DR1.*/
+#ifndef WARM_RESTART_BKP_FIRST
+#define WARM_RESTART_BKP_FIRST      9
+#endif
+
+#ifndef WARM_RESTART_BKP_LAST
+#if defined(STM32F10X_HD) || defined(STM32F10X_HD_VL) || defined(STM32F10X_XL) || defined(STM32F10X_CL)
+#define WARM_RESTART_BKP_LAST       42
+#else
+#define WARM_RESTART_BKP_LAST       10
+#endif
+#endif
+
+/**Bytes of the largest snapshot.*/
+#define WARM_RESTART_CAPACITY       (2 * (WARM_RESTART_BKP_LAST - WARM_RESTART_BKP_FIRST + 1 - 4))
+
+/**Reset flags of the CSR of the RCC that start warm, never with PORRSTF.*/
+#ifndef WARM_RESTART_CAUSES
+#define WARM_RESTART_CAUSES         (RCC_CSR_SFTRSTF | RCC_CSR_IWDGRSTF | RCC_CSR_WWDGRSTF)
+#endif
+
+/**Warm starts in a row from the same snapshot.*/
+#ifndef WARM_RESTART_MAX_LOADS
+#define WARM_RESTART_MAX_LOADS      3
+#endif
+
+void WarmRestartInit(void);
+uint32_t WarmRestartGetCause(void);
+bool WarmRestartLoad(void *snapshot, unsigned int length);
+void WarmRestartSave(const void *snapshot, unsigned int length);
+void WarmRestartInvalidate(void);
+
+#endif /* WARMRESTART_H */
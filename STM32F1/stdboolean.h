@@ -0,0 +1,31 @@
+/**
+ *  @file       stdboolean.h
+ *  @brief      Defines the boolean typedef of the Common drivers for GCC
+ *  @author     Luis Maduro
+ *  @version    1.00
+ *  @date       4 de Outubro de 2012, 0:39
+ *
+ *  Copyright (C) 2012  Luis Maduro
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef __bool_true_and_false
+#define __bool_true_and_false
+
+#include <stdbool.h>
+
+typedef unsigned char boolean;
+
+#endif